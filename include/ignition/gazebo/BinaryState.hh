@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_BINARYSTATE_HH_
+#define IGNITION_GAZEBO_BINARYSTATE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include <ignition/gazebo/components/Component.hh>
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Writes entity component state into a single contiguous buffer.
+    ///
+    /// Components are grouped into one block per component type, and each
+    /// component is serialized straight into the buffer, instead of into a
+    /// string of its own as with msgs::SerializedStateMap. Values are
+    /// stored in the byte order of the host, so buffers are meant to be
+    /// exchanged between processes on the same kind of machine. The layout
+    /// is:
+    ///
+    /// * uint32 magic number, which also detects mismatched byte order
+    /// * uint16 format version
+    /// * uint16 flags, where bit 0 means there are one-time changes
+    /// * uint64 number of removed entities, followed by their uint64 ids
+    /// * uint64 number of component type blocks, each holding:
+    ///   * uint64 component type id
+    ///   * uint64 number of components, each holding:
+    ///     * uint64 entity id
+    ///     * uint32 size of the serialized component, which is
+    ///       kBinaryStateRemoved if the component was removed
+    ///     * the serialized component
+    class IGNITION_GAZEBO_VISIBLE BinaryStateWriter
+    {
+      /// \brief Constructor
+      /// \param[in] _oneTimeChanges Whether the state has one-time changes,
+      /// which readers should process immediately.
+      public: explicit BinaryStateWriter(bool _oneTimeChanges = false);
+
+      /// \brief Add an entity which has been removed.
+      /// \param[in] _entity Removed entity.
+      public: void AddRemovedEntity(const Entity _entity);
+
+      /// \brief Add a component. The component is only serialized by Write,
+      /// so it must stay valid until then.
+      /// \param[in] _entity Entity which owns the component.
+      /// \param[in] _component Component.
+      public: void AddComponent(const Entity _entity,
+                  const components::BaseComponent *_component);
+
+      /// \brief Add a component which has been removed.
+      /// \param[in] _entity Entity which owned the component.
+      /// \param[in] _type Type of the removed component.
+      public: void AddRemovedComponent(const Entity _entity,
+                  const ComponentTypeId _type);
+
+      /// \brief Serialize everything added so far.
+      /// \param[out] _buffer Buffer which is overwritten with the state.
+      public: void Write(std::string &_buffer) const;
+
+      /// \brief Whether there are one-time changes.
+      private: bool oneTimeChanges;
+
+      /// \brief Removed entities.
+      private: std::vector<Entity> removedEntities;
+
+      /// \brief Components grouped by type. Removed components are null.
+      private: std::map<ComponentTypeId, std::vector<
+          std::pair<Entity, const components::BaseComponent *>>> blocks;
+    };
+
+    /// \brief Reads state written by BinaryStateWriter, without copying the
+    /// buffer. Components are deserialized from streams over the buffer
+    /// itself.
+    class IGNITION_GAZEBO_VISIBLE BinaryStateReader
+    {
+      /// \brief Function called for each component of the state.
+      /// \param[in] _entity Entity which owns the component.
+      /// \param[in] _type Component type.
+      /// \param[in] _data Stream holding the serialized component, or
+      /// nullptr if the component was removed.
+      /// \return False to stop reading.
+      public: using ComponentCallback = std::function<bool(
+          const Entity _entity, const ComponentTypeId _type,
+          std::istream *_data)>;
+
+      /// \brief Constructor. The buffer must outlive the reader.
+      /// \param[in] _data Start of the buffer.
+      /// \param[in] _size Size of the buffer in bytes.
+      public: BinaryStateReader(const char *_data, const std::size_t _size);
+
+      /// \brief Get whether the buffer starts with a valid header and list
+      /// of removed entities.
+      /// \return True if valid.
+      public: bool Valid() const;
+
+      /// \brief Get whether the state has one-time changes.
+      /// \return True if there are one-time changes.
+      public: bool OneTimeChanges() const;
+
+      /// \brief Get the removed entities.
+      /// \return Removed entities.
+      public: const std::vector<Entity> &RemovedEntities() const;
+
+      /// \brief Call a function for each component, in the order they were
+      /// written.
+      /// \param[in] _callback Function to call.
+      /// \return False if the buffer is malformed.
+      public: bool EachComponent(const ComponentCallback &_callback) const;
+
+      /// \brief Convert the state to a message, as if it had been created
+      /// with EntityComponentManager::State. Components are copied without
+      /// being deserialized, so this doesn't need an ECM and can run on any
+      /// thread.
+      /// \param[out] _msg Message which the state is added to.
+      /// \return False if the buffer is malformed.
+      public: bool ToMsg(msgs::SerializedStateMap &_msg) const;
+
+      /// \brief Read a value, advancing the read position.
+      /// \param[in, out] _pos Read position.
+      /// \param[out] _value Value read.
+      /// \return False if the buffer is too short.
+      private: template<typename T>
+               bool Read(std::size_t &_pos, T &_value) const;
+
+      /// \brief Start of the buffer.
+      private: const char *data;
+
+      /// \brief Size of the buffer.
+      private: std::size_t size;
+
+      /// \brief Position of the first component type block.
+      private: std::size_t blocksPos{0};
+
+      /// \brief Whether the header is valid.
+      private: bool valid{false};
+
+      /// \brief Whether there are one-time changes.
+      private: bool oneTimeChanges{false};
+
+      /// \brief Removed entities.
+      private: std::vector<Entity> removedEntities;
+    };
+
+    /// \brief Size which marks a removed component in binary state.
+    const uint32_t kBinaryStateRemoved{UINT32_MAX};
+    }
+  }
+}
+#endif
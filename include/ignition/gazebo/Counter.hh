@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_COUNTER_HH_
+#define IGNITION_GAZEBO_COUNTER_HH_
+
+#include <atomic>
+#include <cstdint>
+
+#include <ignition/gazebo/config.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class Counter Counter.hh ignition/gazebo/Counter.hh
+    /// \brief A counter which is cheap enough to stay enabled in release
+    /// builds, unlike IGN_PROFILE. It can be incremented from several
+    /// threads, without ordering them, and read at any time.
+    ///
+    /// Copies start with the value of the original, so classes holding
+    /// counters stay copyable and movable.
+    class Counter
+    {
+      /// \brief Constructor
+      public: Counter() = default;
+
+      /// \brief Copy constructor
+      /// \param[in] _other Counter to copy.
+      public: Counter(const Counter &_other)
+        : value(_other.Value())
+      {
+      }
+
+      /// \brief Copy assignment
+      /// \param[in] _other Counter to copy.
+      /// \return Reference to this counter.
+      public: Counter &operator=(const Counter &_other)
+      {
+        this->value.store(_other.Value(), std::memory_order_relaxed);
+        return *this;
+      }
+
+      /// \brief Add to the counter.
+      /// \param[in] _count Amount to add.
+      public: void Add(uint64_t _count = 1)
+      {
+        this->value.fetch_add(_count, std::memory_order_relaxed);
+      }
+
+      /// \brief Get the current value.
+      /// \return Sum of everything added since construction.
+      public: uint64_t Value() const
+      {
+        return this->value.load(std::memory_order_relaxed);
+      }
+
+      /// \brief Current value.
+      private: std::atomic<uint64_t> value{0};
+    };
+    }
+  }
+}
+#endif
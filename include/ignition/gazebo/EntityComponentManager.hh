@@ -20,6 +20,9 @@
 #include <ignition/msgs/serialized.pb.h>
 #include <ignition/msgs/serialized_map.pb.h>
 
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
 #include <set>
@@ -31,6 +34,7 @@
 #include <vector>
 
 #include <ignition/common/Console.hh>
+#include <ignition/math/Pose3.hh>
 #include <ignition/math/graph/Graph.hh>
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/Export.hh"
@@ -41,6 +45,12 @@
 
 namespace ignition
 {
+  namespace common
+  {
+    // Forward declarations.
+    class WorkerPool;
+  }
+
   namespace gazebo
   {
     // Inline bracket to help doxygen filtering.
@@ -54,6 +64,166 @@ namespace ignition
     /// All edges are positive booleans.
     using EntityGraph = math::graph::DirectedGraph<Entity, bool>;
 
+    /// \brief Work done by an EntityComponentManager since it was created,
+    /// see EntityComponentManager::Counters.
+    struct EcmCounters
+    {
+      /// \brief Work done through one view.
+      struct View
+      {
+        /// \brief Component types of the view.
+        std::vector<ComponentTypeId> types;
+
+        /// \brief Number of calls to Each, ParallelEach, EachNew,
+        /// EachRemoved and Query.
+        uint64_t eachCalls{0};
+
+        /// \brief Number of entities those calls visited.
+        uint64_t entitiesVisited{0};
+      };
+
+      /// \brief All views. Counts of views which were dropped, like when all
+      /// entities are removed, are lost.
+      std::vector<View> views;
+
+      /// \brief Number of components created.
+      uint64_t componentsCreated{0};
+
+      /// \brief Number of components removed, including those of removed
+      /// entities.
+      uint64_t componentsRemoved{0};
+
+      /// \brief Number of views created.
+      uint64_t viewsCreated{0};
+
+      /// \brief Number of times all views were rebuilt.
+      uint64_t viewRebuilds{0};
+
+      /// \brief Bytes of component data serialized into state messages and
+      /// buffers.
+      uint64_t stateBytes{0};
+    };
+
+    /// \brief Accesses recorded while access tracing is on, see
+    /// EntityComponentManager::SetAccessTracing. Accesses are grouped by the
+    /// context set on the accessing thread, usually the system's name.
+    struct EcmAccessStats
+    {
+      /// \brief Accesses to one component type through
+      /// EntityComponentManager::Component.
+      struct ComponentAccess
+      {
+        /// \brief Context of the accesses, empty if none was set.
+        std::string context;
+
+        /// \brief Component type.
+        ComponentTypeId type{0};
+
+        /// \brief Number of const accesses.
+        uint64_t reads{0};
+
+        /// \brief Number of mutable accesses, which may have written.
+        uint64_t writes{0};
+      };
+
+      /// \brief Iterations of one view, through Each, ParallelEach, EachNew,
+      /// EachChanged, EachRemoved and Query.
+      struct ViewAccess
+      {
+        /// \brief Context of the iterations, empty if none was set.
+        std::string context;
+
+        /// \brief Component types of the view.
+        std::vector<ComponentTypeId> types;
+
+        /// \brief Number of const iterations.
+        uint64_t readCalls{0};
+
+        /// \brief Number of mutable iterations.
+        uint64_t writeCalls{0};
+
+        /// \brief Number of entities visited by those iterations. Query
+        /// doesn't count them.
+        uint64_t entitiesVisited{0};
+      };
+
+      /// \brief Component accesses, sorted by context then type.
+      std::vector<ComponentAccess> components;
+
+      /// \brief View iterations, sorted by context then types.
+      std::vector<ViewAccess> views;
+    };
+
+    /// \brief Memory used by an EntityComponentManager, see
+    /// EntityComponentManager::MemoryUsage. Bytes are estimates of what its
+    /// containers allocate. Memory which components allocate themselves,
+    /// like the contents of strings, isn't included.
+    struct EcmMemoryUsage
+    {
+      /// \brief Memory used by the storage of one component type.
+      struct Storage
+      {
+        /// \brief Component type.
+        ComponentTypeId type{0};
+
+        /// \brief Number of components, which is also the number of entities
+        /// with a component of this type.
+        std::size_t size{0};
+
+        /// \brief Number of components the allocated memory can hold.
+        std::size_t capacity{0};
+
+        /// \brief Bytes allocated for components and their ids.
+        std::size_t bytes{0};
+      };
+
+      /// \brief Memory used by one view.
+      struct View
+      {
+        /// \brief Component types of the view.
+        std::vector<ComponentTypeId> types;
+
+        /// \brief Number of entities in the view.
+        std::size_t size{0};
+
+        /// \brief Bytes allocated by the view.
+        std::size_t bytes{0};
+      };
+
+      /// \brief Storage of each component type.
+      std::vector<Storage> storages;
+
+      /// \brief All views.
+      std::vector<View> views;
+
+      /// \brief Number of entities.
+      std::size_t entityCount{0};
+
+      /// \brief Bytes used by the entity graph and by the maps from entities
+      /// to their components.
+      std::size_t entityBytes{0};
+
+      /// \brief Bytes used to track new, removed and changed entities and
+      /// components.
+      std::size_t changeTrackingBytes{0};
+
+      /// \brief Bytes used by cached descendants and world poses.
+      std::size_t cacheBytes{0};
+
+      /// \brief Get the total of all bytes.
+      /// \return Number of bytes.
+      std::size_t TotalBytes() const
+      {
+        std::size_t total =
+            this->entityBytes + this->changeTrackingBytes + this->cacheBytes;
+        for (const auto &storage : this->storages)
+          total += storage.bytes;
+        for (const auto &view : this->views)
+          total += view.bytes;
+        return total;
+      }
+    };
+
     /** \class EntityComponentManager EntityComponentManager.hh \
      * ignition/gazebo/EntityComponentManager.hh
     **/
@@ -73,6 +243,29 @@ namespace ignition
       /// \return An id for the Entity, or kNullEntity on failure.
       public: Entity CreateEntity();
 
+      /// \brief Create multiple new entities at once. This is cheaper than
+      /// calling CreateEntity repeatedly.
+      /// \param[in] _count Number of entities to create.
+      /// \return Ids of the new entities, which may have fewer than _count
+      /// elements if the maximum number of entities is reached.
+      public: std::vector<Entity> CreateEntities(std::size_t _count);
+
+      /// \brief Start a batch of entity and component changes. Until the
+      /// matching call to EndBatch, views aren't updated every time a
+      /// component is created or removed. Instead, each affected entity is
+      /// updated once, when the batch ends or when a view is queried, such
+      /// as through Each. Batches may be nested, and only the outermost
+      /// EndBatch applies the pending updates.
+      ///
+      /// \detail Creating many entities and components, for example when
+      /// loading a world or spawning many models, is much faster within a
+      /// batch. `gazebo::SdfEntityCreator` already uses batches.
+      public: void BeginBatch();
+
+      /// \brief End a batch started by BeginBatch, updating the views with
+      /// all the changes made during the batch.
+      public: void EndBatch();
+
       /// \brief Get the number of entities on the server.
       /// \return Entity count.
       public: size_t EntityCount() const;
@@ -96,6 +289,28 @@ namespace ignition
       /// update step.
       public: void RequestRemoveEntities();
 
+      /// \brief Enable or disable an entity. Disabled entities keep all their
+      /// components, but they're left out of views, so Each, Query and
+      /// the other view based iterations skip them, and they're left out of
+      /// the serialized state.
+      ///
+      /// Systems see an entity which is disabled as removed, through
+      /// EachRemoved, until the end of the step. An entity which is enabled
+      /// again is seen as new, through EachNew, so systems such as Physics
+      /// and rendering tear down and recreate what they built for it.
+      /// \param[in] _entity Entity.
+      /// \param[in] _enabled False to disable the entity, true to enable it
+      /// again.
+      /// \param[in] _recursive Whether to also enable or disable all
+      /// descendants. True by default.
+      public: void SetEnabled(const Entity _entity, const bool _enabled,
+          const bool _recursive = true);
+
+      /// \brief Get whether an entity is enabled, see SetEnabled.
+      /// \param[in] _entity Entity.
+      /// \return False if the entity was disabled.
+      public: bool IsEnabled(const Entity _entity) const;
+
       /// \brief Get whether an Entity exists.
       /// \param[in] _entity Entity to confirm.
       /// \return True if the Entity exists.
@@ -119,6 +334,34 @@ namespace ignition
       /// \return True if successful. Will fail if entities don't exist.
       public: bool SetParentEntity(const Entity _child, const Entity _parent);
 
+      /// \brief Get all the ancestors of an entity by walking up the entity
+      /// graph.
+      /// \param[in] _entity Entity.
+      /// \return The ancestors of the entity, starting with its parent and
+      /// ending with the root of its tree. It will be empty if the entity
+      /// doesn't exist or has no parent.
+      public: std::vector<Entity> Ancestors(const Entity _entity) const;
+
+      /// \brief Get the top level model of an entity, which is the outermost
+      /// model among the entity itself and its ancestors. This supports
+      /// nested models.
+      /// \param[in] _entity Entity.
+      /// \return The top level model or kNullEntity if neither the entity
+      /// nor any of its ancestors is a model.
+      public: Entity TopLevelModel(const Entity _entity) const;
+
+      /// \brief Get the pose of an entity in the world frame, composing the
+      /// Pose components along its chain of ParentEntity components. The
+      /// chain stops at the first ancestor without a Pose.
+      /// \detail While the simulation runner updates PostUpdate systems,
+      /// poses can't change, so world poses are cached and each entity's
+      /// pose is only composed once per iteration, no matter how many
+      /// systems query it or its descendants.
+      /// \param[in] _entity Entity.
+      /// \return The world pose, or a zero pose if the entity has no Pose
+      /// component.
+      public: math::Pose3d WorldPose(const Entity _entity) const;
+
       /// \brief Get whether a component type has ever been created.
       /// \param[in] _typeId ID of the component type to check.
       /// \return True if the provided _typeId has been created.
@@ -278,6 +521,10 @@ namespace ignition
       ///  auto entity = EntityByComponents(components::Name("name"),
       ///    components::Model());
       ///
+      /// If any of the component types has a value index, see
+      /// EnableValueIndex, only the entities with that value are checked.
+      /// Otherwise all entities with the component types are.
+      ///
       /// \detail Component type must have inequality operator.
       ///
       /// \param[in] _desiredComponents All the components which must match.
@@ -293,6 +540,8 @@ namespace ignition
       ///  auto entities = EntitiesByComponents(components::Name("camera"),
       ///    components::Sensor());
       ///
+      /// Value indexes are used like in EntityByComponents.
+      ///
       /// \detail Component type must have inequality operator.
       ///
       /// \param[in] _desiredComponents All the components which must match.
@@ -310,6 +559,9 @@ namespace ignition
       ///
       ///  auto entity = ChildrenByComponents(parent, 123, std::string("name"));
       ///
+      /// Value indexes are used like in EntityByComponents. Otherwise, only
+      /// the children of the parent are checked.
+      ///
       /// \detail Component type must have inequality operator.
       ///
       /// \param[in] _parent Entity which should be an immediate parent of the
@@ -321,6 +573,74 @@ namespace ignition
               std::vector<Entity> ChildrenByComponents(Entity _parent,
                    const ComponentTypeTs &..._desiredComponents) const;
 
+      /// \brief Index the values of a component type, so that
+      /// EntityByComponents, EntitiesByComponents and ChildrenByComponents
+      /// only check the entities whose component has the desired value,
+      /// instead of all entities with that component type. Name and
+      /// ParentEntity components are indexed by default.
+      ///
+      /// The index follows components as they're created, removed, set with
+      /// SetComponentData or SetState, and marked as changed with
+      /// SetChanged. Values modified in place through Component must be
+      /// marked as changed for lookups to find them.
+      ///
+      /// \detail The component's data type must be hashable with std::hash.
+      /// \tparam ComponentTypeT Component type.
+      public: template<typename ComponentTypeT>
+              void EnableValueIndex();
+
+      /// \brief Whether the values of a component type are indexed, see
+      /// EnableValueIndex.
+      /// \param[in] _typeId Component type.
+      /// \return True if the values are indexed.
+      public: bool HasValueIndex(const ComponentTypeId _typeId) const;
+
+      /// \brief Function which hashes the value of a component.
+      private: using ValueHasher =
+          std::function<std::size_t(const components::BaseComponent &)>;
+
+      /// \brief Implementation of EnableValueIndex, which indexes the
+      /// components which already exist.
+      /// \param[in] _typeId Component type.
+      /// \param[in] _hasher Hashes the value of components of that type.
+      private: void EnableValueIndexImplementation(
+                   const ComponentTypeId _typeId, ValueHasher _hasher);
+
+      /// \brief Get the entities which may have a component with a value,
+      /// from a value index.
+      /// \param[in] _typeId Component type.
+      /// \param[in] _hash Hash of the value.
+      /// \return Entities whose value has the same hash, in no particular
+      /// order, or nullptr if the type isn't indexed.
+      private: const std::vector<Entity> *ValueIndexCandidates(
+                   const ComponentTypeId _typeId,
+                   const std::size_t _hash) const;
+
+      /// \brief Get the fewest entities which may match all the given
+      /// components, from the value indexes of their types.
+      /// \param[in] _desiredComponents All the components which must match.
+      /// \return Entities in no particular order, or nullptr if none of the
+      /// types is indexed.
+      private: template<typename ...ComponentTypeTs>
+               const std::vector<Entity> *IndexedCandidates(
+                   const ComponentTypeTs &..._desiredComponents) const;
+
+      /// \brief Whether an entity has all the given components, with equal
+      /// values.
+      /// \param[in] _entity Entity.
+      /// \param[in] _desiredComponents All the components which must match.
+      /// \return True if all of them match.
+      private: template<typename ...ComponentTypeTs>
+               bool EntityMatchesComponents(const Entity _entity,
+                   const ComponentTypeTs &..._desiredComponents) const;
+
+      /// \brief Update the value index of an entity's component after its
+      /// value may have changed. Does nothing if the type isn't indexed.
+      /// \param[in] _entity Entity.
+      /// \param[in] _typeId Component type.
+      private: void UpdateValueIndex(const Entity _entity,
+                   const ComponentTypeId _typeId);
+
       /// why is this required?
       private: template <typename T>
                struct identity;  // NOLINT
@@ -393,6 +713,83 @@ namespace ignition
                   bool(const Entity &_entity,
                        ComponentTypeTs *...)>>::type _f);
 
+      /// \brief Get a range over all entities which contain given component
+      /// types, as well as the mutable components. Unlike Each(), the loop
+      /// body isn't called through a std::function, and the components are
+      /// resolved once per view instead of once per entity, so the loop can
+      /// be inlined. For example:
+      ///
+      ///   for (auto [entity, link, pose] : _ecm.Query<Link, Pose>())
+      ///   {
+      ///     ...
+      ///   }
+      ///
+      /// Note that an entity marked for removal (but not processed yet) will
+      /// be included in the range. Entities added to the view while iterating
+      /// are visited, but removing entities from the view invalidates the
+      /// iteration.
+      /// \tparam ComponentTypeTs All the desired mutable component types.
+      /// \return Range over tuples of an entity followed by its components,
+      /// in the order they're listed on the template.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              detail::ViewRange<ComponentTypeTs...> Query();
+
+      /// \brief Get a range over all entities which contain given component
+      /// types, as well as the components. See the non-const version for
+      /// details.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \return Range over tuples of an entity followed by its components,
+      /// in the order they're listed on the template.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              detail::ViewRange<const ComponentTypeTs...> Query() const;
+
+      /// \brief Get all entities which contain given component types, as well
+      /// as the mutable components, and process them in parallel. The view is
+      /// split into chunks which are processed by the simulation runner's
+      /// worker pool and the calling thread, and this call returns once all
+      /// entities have been processed. If no worker pool is available, the
+      /// entities are processed sequentially on the calling thread.
+      ///
+      /// The callback runs concurrently for different entities, so it must
+      /// follow these rules:
+      /// * Only modify the data of the components passed to it, which belong
+      ///   to the entity being processed.
+      /// * Reading other components of any entity is allowed, as long as no
+      ///   other invocation modifies them.
+      /// * Don't create or remove entities or components, and don't call
+      ///   SetChanged or any other non-const function of the
+      ///   EntityComponentManager. Collect such changes and apply them after
+      ///   ParallelEach returns.
+      ///
+      /// \param[in] _f Callback function to be called for each matching
+      /// entity. The function parameter are all the desired component types,
+      /// in the order they're listed on the template.
+      /// \tparam ComponentTypeTs All the desired mutable component types.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              void ParallelEach(typename identity<std::function<
+                  void(const Entity &_entity,
+                       ComponentTypeTs *...)>>::type _f);
+
+      /// \brief Get all entities which contain given component types, as well
+      /// as the components, and process them in parallel. See the non-const
+      /// version for the rules the callback must follow.
+      /// \param[in] _f Callback function to be called for each matching
+      /// entity. The function parameter are all the desired component types,
+      /// in the order they're listed on the template.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              void ParallelEach(typename identity<std::function<
+                  void(const Entity &_entity,
+                       const ComponentTypeTs *...)>>::type _f) const;
+
       /// \brief Call a function for each parameter in a pack.
       /// \param[in] _f Function to be called.
       /// \param[in] _components Parameters which should be passed to the
@@ -447,6 +844,50 @@ namespace ignition
                   bool(const Entity &_entity,
                        const ComponentTypeTs *...)>>::type _f) const;
 
+      /// \brief Get all entities which contain given component types, and
+      /// have at least one of them marked as changed since the last
+      /// simulation step, as well as the components. Only the changed
+      /// entities are visited, instead of every entity with those components.
+      /// Changes are tracked through new components, SetChanged and
+      /// SetState. Values modified in place without SetChanged aren't seen.
+      /// \param[in] _f Callback function to be called for each matching
+      /// entity. The function parameter are all the desired component types,
+      /// in the order they're listed on the template. The callback function
+      /// can return false to stop subsequent calls to the callback,
+      /// otherwise a true value should be returned.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              void EachChanged(typename identity<std::function<
+                  bool(const Entity &_entity,
+                       const ComponentTypeTs *...)>>::type _f) const;
+
+      /// \brief Get all entities which contain given component types, and
+      /// have at least one of them marked as changed since the last
+      /// simulation step, as well as the mutable components. See the const
+      /// version for details.
+      /// \param[in] _f Callback function to be called for each matching
+      /// entity. The function parameter are all the desired component types,
+      /// in the order they're listed on the template. The callback function
+      /// can return false to stop subsequent calls to the callback,
+      /// otherwise a true value should be returned.
+      /// \tparam ComponentTypeTs All the desired mutable component types.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              void EachChanged(typename identity<std::function<
+                  bool(const Entity &_entity,
+                       ComponentTypeTs *...)>>::type _f);
+
+      /// \brief Get the entities which have a component of any of the given
+      /// types marked as changed since the last simulation step. The cost is
+      /// proportional to the number of changes.
+      /// \param[in] _typeIds Component types.
+      /// \return Entities sorted by id, without duplicates.
+      public: std::vector<Entity> ChangedEntities(
+                  const std::vector<ComponentTypeId> &_typeIds) const;
+
       /// \brief Get a graph with all the entities. Entities are vertices and
       /// edges point from parent to children.
       /// \return Entity graph.
@@ -559,6 +1000,85 @@ namespace ignition
       /// \param[in] _stateMsg Message containing state to be set.
       public: void SetState(const msgs::SerializedStateMap &_stateMsg);
 
+      /// \brief Serialize the state of the given entities and components
+      /// into a compact binary buffer. This is cheaper to create and to set
+      /// than a msgs::SerializedStateMap, because all components are
+      /// serialized into a single contiguous buffer, grouped by type.
+      /// \detail The buffer uses the byte order of the host, so it should
+      /// only be read on the same kind of machine.
+      /// \param[out] _buffer Buffer which is overwritten with the state.
+      /// \param[in] _entities Entities to be serialized. Leave empty to get
+      /// all entities.
+      /// \param[in] _types Type ID of components to be serialized. Leave empty
+      /// to get all components.
+      /// \param[in] _full True to get all the entities and components.
+      /// False will get only components and entities that have changed.
+      public: void BinaryState(std::string &_buffer,
+                  const std::unordered_set<Entity> &_entities = {},
+                  const std::unordered_set<ComponentTypeId> &_types = {},
+                  bool _full = false) const;
+
+      /// \brief Set the state of the ECM from a buffer created by
+      /// BinaryState. This has the same effect as SetState. Components are
+      /// deserialized straight from the buffer, without copying it.
+      /// \param[in] _data Start of the buffer.
+      /// \param[in] _size Size of the buffer in bytes.
+      /// \return False if the buffer is malformed. Changes read before the
+      /// error was found are kept.
+      public: bool SetBinaryState(const char *_data, std::size_t _size);
+
+      /// \brief Get the memory used by the entity component manager, by
+      /// component storage, view, and bookkeeping structure. This goes
+      /// through all storages and views, so it's meant for introspection
+      /// rather than for every iteration.
+      /// \return Memory usage.
+      public: EcmMemoryUsage MemoryUsage() const;
+
+      /// \brief Get counters of the work done by the entity component
+      /// manager. They're always updated, and cheap enough to be read
+      /// periodically.
+      /// \return Counters.
+      public: EcmCounters Counters() const;
+
+      /// \brief Record which component types are accessed, and which views
+      /// are iterated, grouped by the context of the accessing thread. This
+      /// is meant to find out how systems use components, for example to
+      /// choose how to lay them out in memory. Tracing adds a lock to every
+      /// access, so it's off by default.
+      /// \param[in] _enabled True to record accesses. Disabling keeps the
+      /// accesses recorded so far.
+      public: void SetAccessTracing(bool _enabled);
+
+      /// \brief Get whether accesses are recorded.
+      /// \return True if tracing, see SetAccessTracing.
+      public: bool AccessTracing() const;
+
+      /// \brief Set the context which the calling thread's accesses are
+      /// recorded under, such as the name of the system about to run.
+      /// \param[in] _context Context, or an empty string to clear it.
+      public: static void SetAccessContext(const std::string &_context);
+
+      /// \brief Get the accesses recorded while tracing.
+      /// \return Accesses, see SetAccessTracing.
+      public: EcmAccessStats AccessStats() const;
+
+      /// \brief Release memory left unused after entities were removed.
+      /// Component storages, hash tables and views never shrink on their
+      /// own, so after unloading a large part of the world memory would stay
+      /// at its peak. Containers are only shrunk once they're mostly empty,
+      /// see kCompactRatio.
+      ///
+      /// Compaction is incremental: each call does as much as it can within
+      /// the budget, and the next call continues where it left off. It's
+      /// meant to be called between steps, and does nothing until entities
+      /// are removed again once a compaction is complete.
+      /// \param[in] _budget Time after which the call returns, even if the
+      /// compaction isn't complete. The container being compacted when the
+      /// budget runs out is always completed.
+      /// \return True if there's nothing left to compact.
+      public: bool Compact(
+                  const std::chrono::steady_clock::duration &_budget);
+
       /// \brief Set the changed state of a component.
       /// \param[in] _entity The entity.
       /// \param[in] _type Type of the component.
@@ -580,6 +1100,57 @@ namespace ignition
       /// \param[in] _offset Offset value.
       public: void SetEntityCreateOffset(uint64_t _offset);
 
+      /// \brief Set the worker pool used by ParallelEach and State. The pool
+      /// is owned by the caller and must outlive any call to those functions.
+      /// This function is protected to facilitate testing.
+      /// \param[in] _pool Worker pool, or nullptr to process entities on the
+      /// calling thread only.
+      /// \param[in] _threads Maximum number of threads, including the calling
+      /// thread, which process entities at the same time. Zero uses one
+      /// thread per hardware core.
+      protected: void SetWorkerPool(common::WorkerPool *_pool,
+                                    unsigned int _threads = 0);
+
+      /// \brief Set the number of components allocated at once by the
+      /// storage of each component type. It only affects component types
+      /// which haven't been created yet. This function is protected to
+      /// facilitate testing.
+      /// \param[in] _size Number of components per block, or zero to use the
+      /// default.
+      protected: void SetComponentBlockSize(const std::size_t _size);
+
+      /// \brief Enable or disable caching of world poses. The cache must
+      /// only be enabled while Pose and ParentEntity components don't
+      /// change, such as during PostUpdate. Disabling it drops all cached
+      /// poses. This function is protected to facilitate testing.
+      /// \param[in] _enabled True to cache the results of WorldPose.
+      protected: void SetWorldPoseCacheEnabled(bool _enabled);
+
+      /// \brief Start recording the structural changes made on threads
+      /// which called DeferChanges, instead of applying them. Structural
+      /// changes are entities and components being created or removed, and
+      /// parents being changed. An entity created meanwhile gets an id which
+      /// only depends on its buffer and on the number of entities created
+      /// into that buffer before it, but the entity, like components created
+      /// meanwhile, can't be queried until the changes are applied.
+      /// Functions making changes meanwhile return as if they had succeeded.
+      /// Other threads must not create entities meanwhile. This function is
+      /// protected to facilitate testing.
+      /// \param[in] _buffers Number of buffers to record changes into.
+      protected: void BeginDeferredChanges(std::size_t _buffers);
+
+      /// \brief Record the structural changes made on the calling thread
+      /// into a buffer, until EndDeferredChanges is called. This function is
+      /// protected to facilitate testing.
+      /// \param[in] _buffer Index of the buffer, less than the number of
+      /// buffers given to BeginDeferredChanges.
+      protected: void DeferChanges(std::size_t _buffer);
+
+      /// \brief Stop recording structural changes, and apply the recorded
+      /// ones, buffer by buffer, in the order they were made. This function
+      /// is protected to facilitate testing.
+      protected: void EndDeferredChanges();
+
       /// \brief Clear the list of newly added entities so that a call to
       /// EachAdded after this will have no entities to iterate. This function
       /// is protected to facilitate testing.
@@ -610,6 +1181,21 @@ namespace ignition
       /// \return True if the Entity has been marked to be removed.
       private: bool IsMarkedForRemoval(const Entity _entity) const;
 
+      /// \brief Get whether an entity is about to leave views, because it's
+      /// marked to be removed or it was disabled during this step.
+      /// \param[in] _entity Entity id to check.
+      /// \return True if the entity should be added to the removed entities
+      /// of views.
+      private: bool IsLeavingViews(const Entity _entity) const;
+
+      /// \brief Get whether an entity belongs in a view, which requires
+      /// having all of its types and not being disabled.
+      /// \param[in] _entity The entity to check.
+      /// \param[in] _types Component types of the view.
+      /// \return True if the entity belongs in the view.
+      private: bool ViewMatches(Entity _entity,
+          const std::set<ComponentTypeId> &_types) const;
+
       /// \brief Delete an existing Entity.
       /// \param[in] _entity The entity to remove.
       /// \returns True if the Entity existed and was deleted.
@@ -650,6 +1236,27 @@ namespace ignition
                    const Entity _entity,
                    const ComponentTypeId _type);
 
+      /// \brief Get the storage holding an entity's component of a given
+      /// type. Templated accessors use it to call into the storage without
+      /// virtual calls.
+      /// \param[in] _entity The entity.
+      /// \param[in] _type Id of the component type.
+      /// \param[out] _id Id of the component within the storage.
+      /// \param[in] _mutable True if the component will be mutable, only
+      /// used when tracing accesses.
+      /// \return The storage, or nullptr if the entity doesn't have a
+      /// component of that type.
+      private: ComponentStorageBase *StorageImplementation(
+                   const Entity _entity, const ComponentTypeId _type,
+                   ComponentId &_id, bool _mutable) const;
+
+      /// \brief Record an iteration of a view, if tracing accesses.
+      /// \param[in] _view The view.
+      /// \param[in] _visited Number of entities visited.
+      /// \param[in] _mutable True if the components were mutable.
+      private: void TraceViewAccess(const detail::View &_view,
+                   uint64_t _visited, bool _mutable) const;
+
       /// \brief Get a component based on a key.
       /// \param[in] _key A key that uniquely identifies a component.
       /// \return The component associated with the key, or nullptr if the
@@ -664,29 +1271,13 @@ namespace ignition
       private: components::BaseComponent *ComponentImplementation(
                    const ComponentKey &_key);
 
-      /// \brief End of the AddComponentToView recursion. This function is
-      /// called when Rest is empty.
-      /// \param[in, out] _view The FirstComponent will be added to the
-      /// _view.
-      /// \param[in] _entity The entity.
-      private: template<typename FirstComponent,
-                        typename ...RemainingComponents,
-                        typename std::enable_if<
-                          sizeof...(RemainingComponents) == 0, int>::type = 0>
-          void AddComponentsToView(detail::View &_view,
-               const Entity _entity) const;
-
-      /// \brief Recursively add components to a view. This function is
-      /// called when Rest is NOT empty.
-      /// \param[in, out] _view The FirstComponent will be added to the
-      /// _view.
+      /// \brief Add all the components of an entity which match the view's
+      /// component types to the view. The entity must have already been
+      /// added to the view.
+      /// \param[in, out] _view The view.
       /// \param[in] _entity The entity.
-      private: template<typename FirstComponent,
-                        typename ...RemainingComponents,
-                        typename std::enable_if<
-                          sizeof...(RemainingComponents) != 0, int>::type = 0>
-          void AddComponentsToView(detail::View &_view,
-              const Entity _entity) const;
+      private: void AddComponentsToView(detail::View &_view,
+                   const Entity _entity) const;
 
       /// \brief Find a View that matches the set of ComponentTypeIds. If
       /// a match is not found, then a new view is created.
@@ -705,6 +1296,17 @@ namespace ignition
           std::map<detail::ComponentTypeKey,
           detail::View>::iterator &_iter) const;  // NOLINT
 
+      /// \brief Find a view by the slot of its component type pack.
+      /// \param[in] _slot Slot given by detail::NextViewSlot.
+      /// \return The view, or nullptr if the slot hasn't been set yet.
+      private: detail::View *FindView(const std::size_t _slot) const;
+
+      /// \brief Associate a view with the slot of a component type pack.
+      /// \param[in] _slot Slot given by detail::NextViewSlot.
+      /// \param[in] _view The view, which must be stored in the view map.
+      private: void SetViewSlot(const std::size_t _slot,
+          detail::View &_view) const;
+
       /// \brief Add a new view to the set of stored views.
       /// \param[in] _types The set of component type ids that is the key
       /// for the view.
@@ -714,10 +1316,42 @@ namespace ignition
           AddView(const std::set<ComponentTypeId> &_types,
               detail::View &&_view) const;
 
-      /// \brief Update views that contain the provided entity.
+      /// \brief Update views that contain the provided entity. Within a
+      /// batch, the update is deferred until the batch ends.
       /// \param[in] _entity The entity.
       private: void UpdateViews(const Entity _entity);
 
+      /// \brief Update the views that contain a component type after an
+      /// entity gained or lost a component of that type. Only those views
+      /// can change. Within a batch, the update is deferred until the batch
+      /// ends.
+      /// \param[in] _entity The entity.
+      /// \param[in] _typeId Type of the component which was added or
+      /// removed.
+      private: void UpdateViews(const Entity _entity,
+          const ComponentTypeId _typeId);
+
+      /// \brief Add, update or remove an entity in a view, according to
+      /// whether its components match the view's types.
+      /// \param[in] _view The view.
+      /// \param[in] _types The view's component types.
+      /// \param[in] _entity The entity.
+      private: void UpdateView(detail::View &_view,
+          const detail::ComponentTypeKey &_types, const Entity _entity);
+
+      /// \brief Apply the view updates deferred during a batch.
+      private: void ApplyPendingViewUpdates() const;
+
+      /// \brief Split a range of indices into chunks and process them on the
+      /// worker pool and the calling thread. Returns once all chunks have been
+      /// processed.
+      /// \param[in] _count Number of indices, starting at zero.
+      /// \param[in] _work Function which processes the indices in
+      /// [_begin, _end).
+      private: void ParallelFor(const std::size_t _count,
+          const std::function<void(std::size_t _begin, std::size_t _end)>
+          &_work) const;
+
       /// \brief Get a component ID based on an entity and the component's type.
       /// \param[in] _entity The entity.
       /// \param[in] _type Component type ID.
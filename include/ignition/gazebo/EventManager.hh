@@ -17,11 +17,12 @@
 #ifndef IGNITION_GAZEBO_EVENTMANAGER_HH_
 #define IGNITION_GAZEBO_EVENTMANAGER_HH_
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <typeinfo>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Event.hh>
@@ -64,23 +65,7 @@ namespace ignition
               ignition::common::ConnectionPtr
               Connect(const typename E::CallbackT &_subscriber)
               {
-                if (this->events.find(typeid(E)) == this->events.end()) {
-                  this->events[typeid(E)] = std::make_unique<E>();
-                }
-
-                E *eventPtr = dynamic_cast<E *>(this->events[typeid(E)].get());
-                // All values in the map should be derived from Event,
-                // so this shouldn't be an issue, but it doesn't hurt to check.
-                if (eventPtr != nullptr)
-                {
-                  return eventPtr->Connect(_subscriber);
-                }
-                else
-                {
-                  ignerr << "Failed to connect event: "
-                    << typeid(E).name() << std::endl;
-                  return nullptr;
-                }
+                return this->Event<E>()->Connect(_subscriber);
               }
 
       /// \brief Emit an event signal to connected subscribers.
@@ -89,57 +74,60 @@ namespace ignition
       public: template <typename E, typename ... Args>
               void Emit(Args && ... _args)
               {
-                if (this->events.find(typeid(E)) == this->events.end())
+                const std::size_t index = EventIndex<E>();
+                if (index >= this->events.size() || !this->events[index])
                 {
-                  // If there are no events of type E in the map, create it.
+                  // If there is no event of type E yet, create it.
                   // But it also means there is nothing to signal.
                   //
                   // This is also needed to suppress unused function warnings
                   // for Events that are purely emitted, with no connections.
-                  this->events[typeid(E)] = std::make_unique<E>();
+                  this->Event<E>();
                   return;
                 }
 
-                E *eventPtr = dynamic_cast<E *>(this->events[typeid(E)].get());
-                // All values in the map should be derived from Event,
-                // so this shouldn't be an issue, but it doesn't hurt to check.
-                if (eventPtr != nullptr)
-                {
-                  eventPtr->Signal(std::forward<Args>(_args) ...);
-                }
-                else
-                {
-                  ignerr << "Failed to signal event: "
-                    << typeid(E).name() << std::endl;
-                }
+                // The index identifies the type, so the cast is safe
+                static_cast<E *>(this->events[index].get())->Signal(
+                    std::forward<Args>(_args) ...);
               }
 
-
-      /// \brief Convenience type for storing typeinfo references.
-      private: using TypeInfoRef = std::reference_wrapper<const std::type_info>;
-
-      /// \brief Hash functor for TypeInfoRef
-      private: struct Hasher
+      /// \brief Get the event of type E, creating it if needed.
+      /// \return The event.
+      private: template <typename E>
+               E *Event()
                {
-                 std::size_t operator()(TypeInfoRef _code) const
-                 {
-                   return _code.get().hash_code();
-                 }
-               };
-
-      /// \brief Equality functor for TypeInfoRef
-      private: struct EqualTo
+                 const std::size_t index = EventIndex<E>();
+                 if (index >= this->events.size())
+                   this->events.resize(index + 1);
+
+                 auto &event = this->events[index];
+                 if (!event)
+                   event = std::make_unique<E>();
+                 return static_cast<E *>(event.get());
+               }
+
+      /// \brief Get the index of the slot of an event type. Indices are
+      /// shared by all event managers, so each event type only looks its
+      /// index up once per library, instead of hashing its type on every
+      /// emit.
+      /// \return Index of the event type.
+      private: template <typename E>
+               static std::size_t EventIndex()
                {
-                 bool operator()(TypeInfoRef _lhs, TypeInfoRef _rhs) const
-                 {
-                   return _lhs.get() == _rhs.get();
-                 }
-               };
-
-      /// \brief Container of used signals.
-      private: std::unordered_map<TypeInfoRef,
-                                  std::unique_ptr<ignition::common::Event>,
-                                  Hasher, EqualTo> events;
+                 static const std::size_t index = RegisterEvent(typeid(E));
+                 return index;
+               }
+
+      /// \brief Get the index of an event type, assigning the next free one
+      /// the first time the type is seen. Types are compared through
+      /// type_info, so the same event gets the same index in all libraries.
+      /// \param[in] _type Type of the event.
+      /// \return Index of the event type.
+      private: static std::size_t RegisterEvent(const std::type_info &_type);
+
+      /// \brief Used signals, indexed by EventIndex. Null for event types
+      /// which weren't used by this manager.
+      private: std::vector<std::unique_ptr<ignition::common::Event>> events;
     };
     }
   }
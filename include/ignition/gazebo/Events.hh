@@ -17,6 +17,8 @@
 #ifndef IGNITION_GAZEBO_EVENTS_HH_
 #define IGNITION_GAZEBO_EVENTS_HH_
 
+#include <chrono>
+
 #include <sdf/Element.hh>
 
 #include <ignition/common/Event.hh>
@@ -58,6 +60,28 @@ namespace ignition
       /// the entity, which may contain multiple <plugin> tags.
       using LoadPlugins = common::EventT<void(Entity, sdf::ElementPtr),
           struct LoadPluginsTag>;
+
+      /// \brief Event used to request a step size smaller than the world's
+      /// `<max_step_size>`, starting from the next iteration. The request
+      /// holds until another one replaces it. A zero duration goes back to
+      /// the world's step size. Requests larger than the world's step size
+      /// are clamped to it.
+      ///
+      /// For example, to halve the step of the last iteration:
+      /// \code
+      /// eventManager.Emit<ignition::gazebo::events::RequestStepSize>(
+      ///     _info.dt / 2);
+      /// \endcode
+      using RequestStepSize = common::EventT<
+          void(const std::chrono::steady_clock::duration &),
+          struct RequestStepSizeTag>;
+
+      /// \brief Event emitted by the simulation runner when the step size
+      /// changes, before the first iteration which uses the new step. The
+      /// step of each iteration is also given by UpdateInfo::dt.
+      using StepSizeChanged = common::EventT<
+          void(const std::chrono::steady_clock::duration &),
+          struct StepSizeChangedTag>;
       }
     }  // namespace events
   }  // namespace gazebo
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_LOCALSTATECHANNEL_HH_
+#define IGNITION_GAZEBO_LOCALSTATECHANNEL_HH_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations
+    class LocalStateChannelPrivate;
+
+    /// \class LocalStateChannel LocalStateChannel.hh
+    /// ignition/gazebo/LocalStateChannel.hh
+    /// \brief Passes the state of a world from its simulation runner to a
+    /// GUI runner in the same process, without going through the
+    /// SceneBroadcaster and transport.
+    ///
+    /// The runner creates a channel for its world. Once a consumer attaches
+    /// to it, the runner publishes the changes of each step, serialized
+    /// with EntityComponentManager::BinaryState, the same way they're
+    /// copied for the PostUpdate systems which overlap the next step. The
+    /// consumer applies them with EntityComponentManager::SetBinaryState.
+    /// The first state published after attaching, or after a consumer
+    /// fell too far behind, is a full state.
+    ///
+    /// A channel has at most one consumer.
+    class IGNITION_GAZEBO_VISIBLE LocalStateChannel
+    {
+      /// \brief Constructor. Use Create to make a channel which can be
+      /// found by consumers.
+      public: LocalStateChannel();
+
+      /// \brief Destructor.
+      public: ~LocalStateChannel();
+
+      /// \brief Create the channel of a world, which can be found with Find
+      /// until it's destroyed.
+      /// \param[in] _worldName Name of the world.
+      /// \return The channel, or nullptr if the world already has one in
+      /// this process.
+      public: static std::shared_ptr<LocalStateChannel> Create(
+          const std::string &_worldName);
+
+      /// \brief Find the channel of a world.
+      /// \param[in] _worldName Name of the world.
+      /// \return The channel, or nullptr if no runner in this process
+      /// simulates the world.
+      public: static std::shared_ptr<LocalStateChannel> Find(
+          const std::string &_worldName);
+
+      /// \brief Attach a consumer. The next published state will be full.
+      /// \return False if another consumer is attached already.
+      public: bool Attach();
+
+      /// \brief Detach the consumer, so states aren't published anymore.
+      public: void Detach();
+
+      /// \brief Whether a consumer is attached, that is, whether states
+      /// should be published.
+      /// \return True if a consumer is attached.
+      public: bool Attached() const;
+
+      /// \brief Ask for the next published state to be full, such as when
+      /// new GUI plugins need to see all components.
+      public: void RequestFullState();
+
+      /// \brief Get whether the next published state must be full, and
+      /// clear the request.
+      /// \return True if the next state must be full.
+      public: bool TakeFullStateRequest();
+
+      /// \brief Publish a state. If the consumer fell too far behind, the
+      /// pending states are dropped and a full state is requested.
+      /// \param[in] _state State serialized with BinaryState.
+      /// \param[in] _full Whether the state is full.
+      /// \param[in] _info Info of the step the state belongs to.
+      public: void Publish(std::string &&_state, bool _full,
+          const UpdateInfo &_info);
+
+      /// \brief Take the states published since the last call. States before
+      /// the latest full state are dropped.
+      /// \param[out] _states States, oldest first.
+      /// \param[out] _full Whether the first state is full.
+      /// \param[out] _info Info of the latest state.
+      /// \return False if nothing was published.
+      public: bool Take(std::vector<std::string> &_states, bool &_full,
+          UpdateInfo &_info);
+
+      /// \brief Private data pointer
+      private: std::unique_ptr<LocalStateChannelPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
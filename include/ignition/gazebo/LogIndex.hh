@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_LOGINDEX_HH_
+#define IGNITION_GAZEBO_LOGINDEX_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations
+    class LogIndexPrivate;
+
+    /// \brief Activity recorded within one bucket of a log index's timeline.
+    struct LogIndexBucket
+    {
+      /// \brief Number of state and pose messages.
+      uint32_t messages;
+
+      /// \brief Number of entities created, changed, moved or removed by
+      /// those messages, counting an entity once per message.
+      uint32_t entities;
+
+      /// \brief Index of the latest keyframe recorded at or before the
+      /// start of the bucket, or -1 if there's none.
+      int64_t keyframe;
+    };
+
+    /// \brief Activity of one entity over a whole log.
+    struct LogIndexEntity
+    {
+      /// \brief Entity id.
+      uint64_t entity;
+
+      /// \brief Sim time in nanoseconds of the first message holding the
+      /// entity.
+      int64_t firstTime;
+
+      /// \brief Sim time in nanoseconds of the last message holding the
+      /// entity, which is when it's removed if it is.
+      int64_t lastTime;
+
+      /// \brief Number of messages holding the entity.
+      uint64_t messages;
+    };
+
+    /// \class LogIndex LogIndex.hh ignition/gazebo/LogIndex.hh
+    /// \brief Timeline index of a recorded log, stored in a file which is
+    /// memory mapped, so tools like the playback scrubber can draw a
+    /// timeline of a long log and find keyframes in constant time, without
+    /// reading the log itself.
+    ///
+    /// The timeline is split into buckets of equal duration, so the bucket
+    /// of a time is found with a division. Each bucket holds its activity
+    /// and its latest keyframe. Values are stored in the byte order of the
+    /// host, as in BinaryStateWriter. The layout is:
+    ///
+    /// * uint32 magic number, which also detects mismatched byte order
+    /// * uint16 format version
+    /// * uint16 reserved
+    /// * int64 start, end and bucket duration, in nanoseconds of sim time
+    /// * uint64 number of buckets, keyframes and entities
+    /// * the LogIndexBucket of each bucket
+    /// * the int64 sim time in nanoseconds of each keyframe, sorted
+    /// * the LogIndexEntity of each entity, sorted by id
+    class IGNITION_GAZEBO_VISIBLE LogIndex
+    {
+      /// \brief Constructor
+      public: LogIndex();
+
+      /// \brief Destructor, unmaps the index.
+      public: ~LogIndex();
+
+      /// \brief Build the index of a log recorded by LogRecord. The index
+      /// is written to a temporary file first, which then replaces
+      /// _indexPath, so it can be built while it's mapped elsewhere.
+      /// \param[in] _logPath Log directory, or its state.tlog file.
+      /// \param[in] _indexPath Path of the index file to write.
+      /// \param[in] _bucketDuration Duration of each timeline bucket. It's
+      /// increased for very long logs, to bound the size of the index.
+      /// \return True if the index was written.
+      public: static bool Build(const std::string &_logPath,
+          const std::string &_indexPath,
+          const std::chrono::steady_clock::duration &_bucketDuration =
+          std::chrono::milliseconds(100));
+
+      /// \brief Map an index file, unmapping any previous one.
+      /// \param[in] _indexPath Path of the index file.
+      /// \return True if the file is a valid index.
+      public: bool Open(const std::string &_indexPath);
+
+      /// \brief Get whether an index is open.
+      /// \return True if open.
+      public: bool Valid() const;
+
+      /// \brief Get the sim time of the first message of the log.
+      /// \return Start time.
+      public: std::chrono::steady_clock::duration StartTime() const;
+
+      /// \brief Get the sim time of the last message of the log.
+      /// \return End time.
+      public: std::chrono::steady_clock::duration EndTime() const;
+
+      /// \brief Get the duration of each bucket.
+      /// \return Bucket duration.
+      public: std::chrono::steady_clock::duration BucketDuration() const;
+
+      /// \brief Get the number of buckets.
+      /// \return Bucket count, 0 if no index is open.
+      public: std::size_t BucketCount() const;
+
+      /// \brief Get the buckets, which are valid until the index is closed.
+      /// \return Pointer to BucketCount() buckets.
+      public: const LogIndexBucket *Buckets() const;
+
+      /// \brief Get the bucket holding a time.
+      /// \param[in] _time Sim time, clamped to the log's timeline.
+      /// \return Bucket index.
+      public: std::size_t BucketIndex(
+          const std::chrono::steady_clock::duration &_time) const;
+
+      /// \brief Get the number of keyframes.
+      /// \return Keyframe count.
+      public: std::size_t KeyframeCount() const;
+
+      /// \brief Get the time of a keyframe.
+      /// \param[in] _index Keyframe index, less than KeyframeCount().
+      /// \return Sim time of the keyframe.
+      public: std::chrono::steady_clock::duration KeyframeTime(
+          std::size_t _index) const;
+
+      /// \brief Find the latest keyframe recorded at or before a time.
+      /// \param[in] _time Sim time.
+      /// \return Sim time of the keyframe, or nullopt if there's none.
+      public: std::optional<std::chrono::steady_clock::duration>
+          KeyframeBefore(const std::chrono::steady_clock::duration &_time)
+          const;
+
+      /// \brief Get the number of entities.
+      /// \return Entity count.
+      public: std::size_t EntityCount() const;
+
+      /// \brief Get the entities, which are valid until the index is
+      /// closed.
+      /// \return Pointer to EntityCount() entities, sorted by id.
+      public: const LogIndexEntity *Entities() const;
+
+      /// \brief Find the activity of an entity.
+      /// \param[in] _entity Entity id.
+      /// \return Pointer to its activity, or nullptr if it's not in the log.
+      public: const LogIndexEntity *FindEntity(const Entity _entity) const;
+
+      /// \brief Private data pointer
+      private: std::unique_ptr<LogIndexPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_LOGREADER_HH_
+#define IGNITION_GAZEBO_LOGREADER_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class LogReaderPrivate;
+
+    /// \class LogReader LogReader.hh ignition/gazebo/LogReader.hh
+    /// \brief Reconstructs the state of a log recorded by the LogRecord
+    /// system, one frame at a time, without running a server.
+    ///
+    /// Each frame holds all the messages recorded at the same sim time. The
+    /// state messages are set on an entity component manager owned by the
+    /// reader, and the dynamic poses, if recorded, are set on the Pose
+    /// components. This can be used to compute metrics over many logs:
+    ///
+    ///     LogReader::ProcessLogs(paths,
+    ///         [&](std::size_t _index, LogReader &_reader)
+    ///     {
+    ///       while (_reader.Step())
+    ///         metrics[_index].Add(_reader.Time(), _reader.Ecm());
+    ///     });
+    ///
+    /// Between frames, entities which were removed are deleted and all
+    /// components are marked as unchanged, so `EachNew`, `EachRemoved` and
+    /// `ComponentState` describe what the current frame changed.
+    class IGNITION_GAZEBO_VISIBLE LogReader
+    {
+      /// \brief Constructor
+      public: LogReader();
+
+      /// \brief Destructor
+      public: ~LogReader();
+
+      /// \brief Open a log.
+      /// \param[in] _path Recorded directory holding a `state.tlog` file, or
+      /// path to the `.tlog` file itself. Compressed recordings need to be
+      /// extracted first.
+      /// \return True if the log was opened.
+      public: bool Open(const std::string &_path);
+
+      /// \brief Apply the next frame of the log.
+      /// \return False if there are no more frames.
+      public: bool Step();
+
+      /// \brief Get the state reconstructed up to the current frame.
+      /// \return Entity component manager holding the state.
+      public: const EntityComponentManager &Ecm() const;
+
+      /// \brief Get the sim time of the current frame.
+      /// \return Sim time, zero before the first frame.
+      public: std::chrono::steady_clock::duration Time() const;
+
+      /// \brief Get the sim time of the last message in the log.
+      /// \return Sim time, zero if no log is open.
+      public: std::chrono::steady_clock::duration EndTime() const;
+
+      /// \brief Get the world SDF recorded in the log, once the frame
+      /// holding it has been applied.
+      /// \return SDF string, empty if not read yet.
+      public: const std::string &WorldSdf() const;
+
+      /// \brief Open several logs and process each of them with its own
+      /// reader. Logs are processed concurrently, so the callback must be
+      /// thread safe.
+      /// \param[in] _paths Paths of the logs, see Open.
+      /// \param[in] _work Called once for each log which could be opened,
+      /// with the index of its path and its reader.
+      /// \param[in] _threads Maximum number of logs processed at the same
+      /// time. Zero uses one per hardware core.
+      /// \return Number of logs which could be opened.
+      public: static std::size_t ProcessLogs(
+          const std::vector<std::string> &_paths,
+          const std::function<void(std::size_t _index, LogReader &_reader)>
+          &_work, unsigned int _threads = 0);
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<LogReaderPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_PARALLELTASKS_HH_
+#define IGNITION_GAZEBO_PARALLELTASKS_HH_
+
+#include <cstddef>
+#include <functional>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace common
+  {
+    // Forward declarations.
+    class WorkerPool;
+  }
+
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Run tasks on a worker pool and the calling thread, and wait for
+    /// all of them to finish.
+    ///
+    /// Tasks are claimed in order by whichever thread is free. The calling
+    /// thread claims tasks too, so progress is guaranteed even if all pool
+    /// threads are busy, and this function can be called from within a task.
+    /// \param[in] _pool Worker pool. If nullptr, all tasks run on the calling
+    /// thread.
+    /// \param[in] _threads Maximum number of threads, including the calling
+    /// thread, running tasks at the same time. Zero uses one thread per
+    /// hardware core.
+    /// \param[in] _taskCount Number of tasks.
+    /// \param[in] _task Function which runs the task with the given index.
+    void IGNITION_GAZEBO_VISIBLE RunParallelTasks(common::WorkerPool *_pool,
+        unsigned int _threads, const std::size_t _taskCount,
+        const std::function<void(std::size_t _index)> &_task);
+    }
+  }
+}
+#endif
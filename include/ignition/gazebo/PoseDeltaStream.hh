@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_POSEDELTASTREAM_HH_
+#define IGNITION_GAZEBO_POSEDELTASTREAM_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class PoseDeltaEncoderPrivate;
+    class PoseDeltaDecoderPrivate;
+
+    /// \brief Kinds of frames in a pose delta stream.
+    enum class PoseDeltaFrameType : uint8_t
+    {
+      /// \brief Holds every entity of the stream. Entities which are missing
+      /// from a keyframe have been removed.
+      KEYFRAME = 0,
+
+      /// \brief Holds only the entities whose pose changed since the
+      /// previous frame, relative to the poses of that frame.
+      DELTA = 1
+    };
+
+    /// \class PoseDeltaEncoder PoseDeltaStream.hh
+    /// ignition/gazebo/PoseDeltaStream.hh
+    /// \brief Encodes a stream of entity poses into compact binary frames.
+    ///
+    /// Positions and orientation quaternions are quantized to a fixed
+    /// resolution and written as variable length integers. A keyframe holds
+    /// every entity, and the following delta frames hold only entities which
+    /// moved more than a tolerance since they were last sent, as differences
+    /// from the quantized values last sent. The decoder keeps the same
+    /// quantized values, so errors don't accumulate over deltas.
+    ///
+    /// Deltas depend on every frame since the last keyframe, so frames must
+    /// not be dropped by the transport, for example by throttling the
+    /// publisher. A decoder which misses a frame waits for the next keyframe.
+    class IGNITION_GAZEBO_VISIBLE PoseDeltaEncoder
+    {
+      /// \brief Constructor
+      public: PoseDeltaEncoder();
+
+      /// \brief Destructor
+      public: ~PoseDeltaEncoder();
+
+      /// \brief Set the resolution used to quantize positions. Takes effect
+      /// on the next keyframe.
+      /// \param[in] _resolution Resolution in meters, defaults to 1e-4.
+      public: void SetPositionResolution(double _resolution);
+
+      /// \brief Set the resolution used to quantize each component of the
+      /// orientation quaternions. Takes effect on the next keyframe.
+      /// \param[in] _resolution Resolution, defaults to 1e-5.
+      public: void SetOrientationResolution(double _resolution);
+
+      /// \brief Set how far an entity has to move before it is sent again.
+      /// \param[in] _tolerance Distance in meters, defaults to 1e-4.
+      public: void SetPositionTolerance(double _tolerance);
+
+      /// \brief Set how far an entity has to rotate before it is sent again.
+      /// \param[in] _tolerance Angle in radians, defaults to 1e-4.
+      public: void SetOrientationTolerance(double _tolerance);
+
+      /// \brief Set how many frames there are between keyframes, including
+      /// the keyframe.
+      /// \param[in] _period Keyframe period, defaults to 60. A period of 1
+      /// sends only keyframes.
+      public: void SetKeyframePeriod(unsigned int _period);
+
+      /// \brief Make the next frame a keyframe, for example when a new
+      /// subscriber connects.
+      public: void ForceKeyframe();
+
+      /// \brief Encode the next frame.
+      /// \param[in] _poses Latest pose of every entity in the stream.
+      /// Entities which are added or removed cause a keyframe.
+      /// \param[in] _time Time of the poses, usually the simulation time.
+      /// \param[out] _frame Buffer which is overwritten with the frame.
+      /// \return True if a frame was written. False if it would be a delta
+      /// without any entities, in which case there is nothing to send.
+      public: bool Encode(const std::map<Entity, math::Pose3d> &_poses,
+                  const std::chrono::steady_clock::duration &_time,
+                  std::string &_frame);
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<PoseDeltaEncoderPrivate> dataPtr;
+    };
+
+    /// \class PoseDeltaDecoder PoseDeltaStream.hh
+    /// ignition/gazebo/PoseDeltaStream.hh
+    /// \brief Decodes frames written by PoseDeltaEncoder.
+    class IGNITION_GAZEBO_VISIBLE PoseDeltaDecoder
+    {
+      /// \brief Constructor
+      public: PoseDeltaDecoder();
+
+      /// \brief Destructor
+      public: ~PoseDeltaDecoder();
+
+      /// \brief Decode a frame. Deltas are ignored until a keyframe has been
+      /// decoded, and after a frame has been missed.
+      /// \param[in] _frame Frame written by PoseDeltaEncoder.
+      /// \param[out] _changed Entities whose pose changed with this frame.
+      /// \return True if the frame was applied.
+      public: bool Decode(const std::string &_frame,
+                  std::vector<Entity> &_changed);
+
+      /// \brief Get the decoded poses.
+      /// \return Latest pose of every entity in the stream.
+      public: const std::map<Entity, math::Pose3d> &Poses() const;
+
+      /// \brief Get the time of the last decoded frame.
+      /// \return Time passed to PoseDeltaEncoder::Encode.
+      public: std::chrono::steady_clock::duration Time() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<PoseDeltaDecoderPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
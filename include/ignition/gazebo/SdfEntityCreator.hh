@@ -18,6 +18,7 @@
 #define IGNITION_GAZEBO_CREATEREMOVE_HH_
 
 #include <memory>
+#include <vector>
 
 #include <sdf/Actor.hh>
 #include <sdf/Collision.hh>
@@ -38,6 +39,12 @@
 
 namespace ignition
 {
+  namespace common
+  {
+    // Forward declarations.
+    class WorkerPool;
+  }
+
   namespace gazebo
   {
     // Inline bracket to help doxygen filtering.
@@ -85,6 +92,17 @@ namespace ignition
       /// \brief Destructor.
       public: ~SdfEntityCreator();
 
+      /// \brief Set the worker pool used to convert several models in
+      /// parallel, see CreateEntities(const std::vector<const sdf::Model *> &).
+      /// \param[in] _pool Worker pool, or nullptr to convert models on the
+      /// calling thread. The pool is owned by the caller and must outlive
+      /// this object.
+      /// \param[in] _threads Maximum number of threads, including the calling
+      /// thread, converting models at the same time. Zero uses one thread
+      /// per hardware core.
+      public: void SetWorkerPool(common::WorkerPool *_pool,
+                  unsigned int _threads = 0);
+
       /// \brief Create all entities that exist in the sdf::World object and
       /// load their plugins.
       /// \param[in] _world SDF world object.
@@ -97,6 +115,16 @@ namespace ignition
       /// \return Model entity.
       public: Entity CreateEntities(const sdf::Model *_model);
 
+      /// \brief Create all entities of several models and load their
+      /// plugins. If a worker pool was given through SetWorkerPool, the
+      /// models are converted to components in parallel, and then all the
+      /// entities are added to the ECM at once. Entities are added in the
+      /// order of the models, so their ids are the same on every run.
+      /// \param[in] _models SDF model objects.
+      /// \return Model entities, in the same order as _models.
+      public: std::vector<Entity> CreateEntities(
+                  const std::vector<const sdf::Model *> &_models);
+
       /// \brief Create all entities that exist in the sdf::Actor object and
       /// load their plugins.
       /// \param[in] _actor SDF actor object.
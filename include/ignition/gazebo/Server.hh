@@ -17,9 +17,11 @@
 #ifndef IGNITION_GAZEBO_SERVER_HH_
 #define IGNITION_GAZEBO_SERVER_HH_
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/EntityComponentManager.hh>
 #include <ignition/gazebo/Export.hh>
@@ -34,6 +36,7 @@ namespace ignition
     inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     // Forware declarations
     class ServerPrivate;
+    class ServerTemplate;
 
     /// \class Server Server.hh ignition/gazebo/Server.hh
     /// \brief The server instantiates and controls simulation.
@@ -196,6 +199,22 @@ namespace ignition
       public: std::optional<uint64_t> IterationCount(
                   const unsigned int _worldIndex = 0) const;
 
+      /// \brief Get the simulation time of a world.
+      /// \param[in] _worldIndex Index of the world to query.
+      /// \return The simulation time, or std::nullopt if _worldIndex is
+      /// invalid.
+      public: std::optional<std::chrono::steady_clock::duration> SimTime(
+                  const unsigned int _worldIndex = 0) const;
+
+      /// \brief Get the real time factor of a world, averaged over its
+      /// latest iterations. This is useful to compare worlds which share the
+      /// worker threads, see ServerConfig::SetWorkerThreads.
+      /// \param[in] _worldIndex Index of the world to query.
+      /// \return The real time factor, or std::nullopt if _worldIndex is
+      /// invalid.
+      public: std::optional<double> RealTimeFactor(
+                  const unsigned int _worldIndex = 0) const;
+
       /// \brief Get the number of entities on the server.
       /// \param[in] _worldIndex Index of the world to query.
       /// \return Entity count, or std::nullopt if _worldIndex is invalid.
@@ -270,9 +289,101 @@ namespace ignition
                                       bool _recursive = true,
                                       const unsigned int _worldIndex = 0);
 
+      /// \brief Get the data of a component of an entity in every world, in
+      /// world order. This is meant for batched copies of a world, see
+      /// ServerConfig::SetBatchSize, where each entity has the same ID in
+      /// all copies, for example to read the observations of all the copies
+      /// into one buffer after Server::RunOnce. The server must not be
+      /// running.
+      /// \param[in] _entity The entity.
+      /// \param[out] _data Data of the component in each world. Worlds in
+      /// which the entity doesn't have the component get a default value.
+      /// \tparam ComponentTypeT Component type.
+      /// \return True if the entity has the component in every world, false
+      /// otherwise or if the server is running.
+      public: template<typename ComponentTypeT>
+              bool BatchComponentData(const Entity _entity,
+                  std::vector<typename ComponentTypeT::Type> &_data) const;
+
+      /// \brief Set the data of a component of an entity in every world, in
+      /// world order, creating the component where needed. This is meant
+      /// for batched copies of a world, see ServerConfig::SetBatchSize, for
+      /// example to apply the actions of all the copies before
+      /// Server::RunOnce. The server must not be running.
+      /// \param[in] _entity The entity.
+      /// \param[in] _data Data of the component in each world, one element
+      /// per world.
+      /// \tparam ComponentTypeT Component type.
+      /// \return False if the size of _data doesn't match the number of
+      /// worlds, or if the server is running.
+      public: template<typename ComponentTypeT>
+              bool SetBatchComponentData(const Entity _entity,
+                  const std::vector<typename ComponentTypeT::Type> &_data);
+
+      /// \brief Constructor for a server whose world was already loaded,
+      /// see ServerTemplate.
+      /// \param[in] _dataPtr Private data, with the world loaded.
+      private: explicit Server(std::unique_ptr<ServerPrivate> _dataPtr);
+
+      /// \brief Create the worlds of the loaded SDF root, and set up
+      /// transport.
+      private: void CreateWorlds();
+
+      /// \brief Get the entity component managers of all worlds.
+      /// \return The entity component managers in world order, or an empty
+      /// vector if the server is running.
+      private: std::vector<EntityComponentManager *> EntityCompMgrs() const;
+
       /// \brief Private data
       private: std::unique_ptr<ServerPrivate> dataPtr;
+
+      friend class ServerTemplate;
     };
+
+    //////////////////////////////////////////////////
+    template<typename ComponentTypeT>
+    bool Server::BatchComponentData(const Entity _entity,
+        std::vector<typename ComponentTypeT::Type> &_data) const
+    {
+      auto ecms = this->EntityCompMgrs();
+      if (ecms.empty())
+        return false;
+
+      bool all{true};
+      _data.resize(ecms.size());
+      for (std::size_t i = 0; i < ecms.size(); ++i)
+      {
+        auto comp = ecms[i]->Component<ComponentTypeT>(_entity);
+        if (nullptr == comp)
+        {
+          _data[i] = typename ComponentTypeT::Type();
+          all = false;
+          continue;
+        }
+        _data[i] = comp->Data();
+      }
+      return all;
+    }
+
+    //////////////////////////////////////////////////
+    template<typename ComponentTypeT>
+    bool Server::SetBatchComponentData(const Entity _entity,
+        const std::vector<typename ComponentTypeT::Type> &_data)
+    {
+      auto ecms = this->EntityCompMgrs();
+      if (ecms.empty() || ecms.size() != _data.size())
+        return false;
+
+      for (std::size_t i = 0; i < ecms.size(); ++i)
+      {
+        if (ecms[i]->SetComponentData<ComponentTypeT>(_entity, _data[i]))
+        {
+          ecms[i]->SetChanged(_entity, components::TypeIdOf<ComponentTypeT>(),
+              ComponentState::OneTimeChange);
+        }
+      }
+      return true;
+    }
     }
   }
 }
@@ -18,6 +18,7 @@
 #define IGNITION_GAZEBO_SERVERCONFIG_HH_
 
 #include <chrono>
+#include <functional>
 #include <list>
 #include <memory>
 #include <optional> // NOLINT(*)
@@ -299,6 +300,231 @@ namespace ignition
       /// \param[in] _seed The seed.
       public: void SetSeed(unsigned int _seed);
 
+      /// \brief Get the number of worker threads used to process entities in
+      /// parallel, such as when serializing the simulation state.
+      /// \return Number of worker threads, or 0 to use one thread per
+      /// hardware core.
+      public: unsigned int WorkerThreads() const;
+
+      /// \brief Set the number of worker threads used to process entities in
+      /// parallel, such as when serializing the simulation state. The threads
+      /// are created once when the server starts. When the server runs
+      /// several worlds, this is the budget shared by all of them: worlds
+      /// take turns on these threads instead of each getting its own.
+      /// \param[in] _threads Number of worker threads, or 0 to use one thread
+      /// per hardware core.
+      public: void SetWorkerThreads(unsigned int _threads);
+
+      /// \brief Get the number of components of each type which are
+      /// allocated at once.
+      /// \return Number of components per allocation, or 0 for the default.
+      public: std::size_t ComponentBlockSize() const;
+
+      /// \brief Set the number of components of each type which are
+      /// allocated at once. Components never move when more are added, so
+      /// this trades fewer allocations while loading large worlds against
+      /// memory left unused for rare component types. It is rounded up to a
+      /// power of two.
+      /// \param[in] _size Number of components per allocation, or 0 for the
+      /// default.
+      public: void SetComponentBlockSize(std::size_t _size);
+
+      /// \brief Get the number of copies of the world which are simulated
+      /// in lockstep.
+      /// \return Number of copies, 1 when not batching.
+      public: unsigned int BatchSize() const;
+
+      /// \brief Simulate several copies of the world in lockstep, for
+      /// example to train reinforcement learning agents. The SDF must
+      /// contain a single world. Copies are created from the same SDF, so
+      /// each entity has the same ID in every copy, and the first copy
+      /// keeps the world's name while the others get an index appended,
+      /// as in "shapes_1". Every iteration, such as Server::RunOnce, steps
+      /// all copies, sharing the worker threads, see SetWorkerThreads.
+      /// See also Server::BatchComponentData.
+      /// \param[in] _size Number of copies, 1 to disable batching.
+      public: void SetBatchSize(unsigned int _size);
+
+      /// \brief How iterations are paced to match the update period.
+      public: enum class PacingMode
+      {
+        /// \brief Sleep until the next iteration is due. This is the
+        /// cheapest, but iterations may start late by the granularity of
+        /// the operating system's timers.
+        Sleep,
+
+        /// \brief Busy-wait until the next iteration is due. This is the
+        /// most accurate, but keeps a core busy.
+        Spin,
+
+        /// \brief Sleep until shortly before the next iteration is due,
+        /// then busy-wait, see SetPacingSpinTime.
+        Hybrid,
+
+        /// \brief Wait with a function given by the user, for example to
+        /// follow a hardware clock, see SetExternalPacing.
+        External
+      };
+
+      /// \brief Function which returns once the iteration due at the given
+      /// time should start.
+      public: using PacingFunction =
+          std::function<void(const std::chrono::steady_clock::time_point &)>;
+
+      /// \brief Get how iterations are paced.
+      /// \return The pacing mode, PacingMode::Sleep by default.
+      public: PacingMode Pacing() const;
+
+      /// \brief Set how iterations are paced to match the update period,
+      /// see SetUpdateRate. Iterations which run as fast as possible aren't
+      /// paced. How late iterations start is published with the world
+      /// statistics.
+      /// \param[in] _mode The pacing mode.
+      public: void SetPacing(PacingMode _mode);
+
+      /// \brief Get how long PacingMode::Hybrid busy-waits for.
+      /// \return Duration of the busy-wait.
+      public: std::chrono::steady_clock::duration PacingSpinTime() const;
+
+      /// \brief Set how long PacingMode::Hybrid busy-waits for before each
+      /// iteration. It should be a bit longer than the timer granularity.
+      /// \param[in] _time Duration of the busy-wait, 200us by default.
+      public: void SetPacingSpinTime(
+                  const std::chrono::steady_clock::duration &_time);
+
+      /// \brief Get the function used by PacingMode::External.
+      /// \return The function, empty if it hasn't been set.
+      public: const PacingFunction &ExternalPacing() const;
+
+      /// \brief Set the function used by PacingMode::External. It's called
+      /// from the simulation thread.
+      /// \param[in] _function Function which returns once the iteration
+      /// should start. Without a function, iterations are paced by sleeping.
+      public: void SetExternalPacing(const PacingFunction &_function);
+
+      /// \brief Get the number of steps kept in the step timeline.
+      /// \return Number of steps, 0 when the timeline is disabled.
+      public: std::size_t TimelineSteps() const;
+
+      /// \brief Keep a timeline of the last steps, with the duration of each
+      /// phase and system, and the number of entities created and removed.
+      /// It's written in the Chrome trace event format, viewable with
+      /// chrome://tracing or Perfetto, when requested on the
+      /// `/world/<world>/timeline` service, or when a step is slower than
+      /// the threshold, see SetTimelineThreshold.
+      /// \param[in] _steps Number of steps to keep, 0 to disable the
+      /// timeline, which is the default.
+      public: void SetTimelineSteps(std::size_t _steps);
+
+      /// \brief Get how slow a step must be for the timeline to be written
+      /// automatically.
+      /// \return Duration, 0 to never write it automatically.
+      public: std::chrono::steady_clock::duration TimelineThreshold() const;
+
+      /// \brief Set how slow a step must be for the timeline to be written
+      /// automatically. After that, it's only written again once all the
+      /// steps it holds have been replaced.
+      /// \param[in] _threshold Duration, 0 to never write the timeline
+      /// automatically, which is the default.
+      public: void SetTimelineThreshold(
+                  const std::chrono::steady_clock::duration &_threshold);
+
+      /// \brief Get the directory where timelines are written.
+      /// \return Path to a directory, empty for the console log directory.
+      public: const std::string &TimelinePath() const;
+
+      /// \brief Set the directory where timelines are written. Files are
+      /// named after the world and the last step they hold.
+      /// \param[in] _path Path to a directory, empty for the console log
+      /// directory, or the working directory when there isn't one.
+      public: void SetTimelinePath(const std::string &_path);
+
+      /// \brief Get the time spent per step releasing memory left unused
+      /// after entities were removed.
+      /// \return Duration, 0 when memory isn't released.
+      public: std::chrono::steady_clock::duration CompactionBudget() const;
+
+      /// \brief Set the time spent per step releasing memory left unused
+      /// after entities were removed, see EntityComponentManager::Compact.
+      /// Compaction runs at the end of steps, and is spread over several
+      /// steps if it takes longer than the budget.
+      /// \param[in] _budget Duration, 0 to keep memory at its peak. Defaults
+      /// to 1 ms.
+      public: void SetCompactionBudget(
+                  const std::chrono::steady_clock::duration &_budget);
+
+      /// \brief Get the CPUs the simulation thread runs on.
+      /// \return Indices of the CPUs, empty for any CPU.
+      public: const std::vector<unsigned int> &SimulationCpus() const;
+
+      /// \brief Restrict the thread running simulation iterations to some
+      /// CPUs, so it doesn't migrate across cores or sockets. Memory the
+      /// simulation allocates as it runs, such as component storage, is
+      /// placed on the NUMA node of the CPU which first writes to it, so this
+      /// also keeps it local. Only supported on Linux. See also
+      /// ParseCpuList.
+      /// \param[in] _cpus Indices of the CPUs, empty for any CPU, which is
+      /// the default.
+      public: void SetSimulationCpus(const std::vector<unsigned int> &_cpus);
+
+      /// \brief Get the CPUs the worker threads run on.
+      /// \return Indices of the CPUs, empty for any CPU.
+      public: const std::vector<unsigned int> &WorkerCpus() const;
+
+      /// \brief Restrict the worker threads, see SetWorkerThreads, and the
+      /// thread running PostUpdate concurrently, see SetOverlapPostUpdate,
+      /// to some CPUs. Only supported on Linux.
+      /// \param[in] _cpus Indices of the CPUs, empty for any CPU, which is
+      /// the default.
+      public: void SetWorkerCpus(const std::vector<unsigned int> &_cpus);
+
+      /// \brief Get the real-time priority of the simulation thread.
+      /// \return Priority, 0 for the normal scheduling policy.
+      public: int RealtimePriority() const;
+
+      /// \brief Run the simulation thread with the first in first out
+      /// real-time scheduling policy, for hardware in the loop setups. This
+      /// usually requires privileges. Only supported on Linux.
+      /// \param[in] _priority Priority, from 1 to 99. 0 for the normal
+      /// scheduling policy, which is the default.
+      public: void SetRealtimePriority(int _priority);
+
+      /// \brief Get whether systems which only implement PostUpdate run
+      /// concurrently with the next step.
+      /// \return True if they overlap the next step.
+      public: bool OverlapPostUpdate() const;
+
+      /// \brief Run the systems which only implement PostUpdate, such as
+      /// the SceneBroadcaster or LogRecord, concurrently with the PreUpdate
+      /// and Update of the next step, so that slow consumers don't hold back
+      /// physics. They read a copy of the entity-component manager taken at
+      /// the end of Update, which is updated with the components marked as
+      /// changed. Components modified without being marked as changed aren't
+      /// copied. Systems which also implement PreUpdate or Update keep
+      /// running PostUpdate at the end of their step. Not supported with
+      /// distributed simulation.
+      /// \param[in] _overlap True to overlap them, false by default.
+      public: void SetOverlapPostUpdate(bool _overlap);
+
+      /// \brief Get whether systems running concurrently have their
+      /// structural changes to entities and components merged in a fixed
+      /// order.
+      /// \return True if they're merged in a fixed order.
+      public: bool Deterministic() const;
+
+      /// \brief Make runs reproducible regardless of how concurrent systems
+      /// are interleaved. Entities and components created or removed, and
+      /// parents changed, by systems which run concurrently during
+      /// PreUpdate or Update are recorded per system, and applied in the
+      /// order the systems were added once all of them are done. Entities
+      /// created meanwhile get ids which only depend on the system and on
+      /// the number of entities it created before, and they can't be
+      /// queried until the changes are applied. Components created
+      /// meanwhile can't be queried either.
+      /// \param[in] _deterministic True to merge changes in a fixed order,
+      /// false by default.
+      public: void SetDeterministic(bool _deterministic);
+
       /// \brief Get the update period duration.
       /// \return The desired update period, or nullopt if
       /// an UpdateRate has not been set.
@@ -319,6 +545,51 @@ namespace ignition
       /// ~/.ignition/fuel.
       public: void SetResourceCache(const std::string &_path);
 
+      /// \brief Directory of the world cache.
+      /// \return Path to a directory, or an empty string if the cache is
+      /// disabled. Defaults to the IGN_GAZEBO_WORLD_CACHE_PATH environment
+      /// variable.
+      public: const std::string &WorldCachePath() const;
+
+      /// \brief Set the directory of the world cache. After an SDF file is
+      /// loaded, the world is stored there with its includes expanded and
+      /// relative paths made absolute. Later loads of the same file read
+      /// the stored world instead, which skips finding, downloading and
+      /// parsing included models. A stored world is ignored once the world
+      /// file or any file it includes changes.
+      /// \param[in] _path Path to a directory, or an empty string to
+      /// disable the cache.
+      public: void SetWorldCachePath(const std::string &_path);
+
+      /// \brief Path of the report of entity-component manager accesses.
+      /// \return Path to a file, or an empty string if accesses aren't
+      /// traced. Defaults to the IGN_GAZEBO_ECM_ACCESS_REPORT environment
+      /// variable.
+      public: const std::string &EcmAccessReportPath() const;
+
+      /// \brief Trace which component types each system reads and writes,
+      /// and which views it iterates, see
+      /// EntityComponentManager::SetAccessTracing. The counts are written
+      /// to a file when the server shuts down, one section per world. This
+      /// slows down simulation, so it's meant for profiling runs.
+      /// \param[in] _path Path to the report file, or an empty string to
+      /// disable tracing.
+      public: void SetEcmAccessReportPath(const std::string &_path);
+
+      /// \brief Number of Fuel resources downloaded at the same time while
+      /// loading a world.
+      /// \return Number of downloads.
+      public: unsigned int FuelDownloadThreads() const;
+
+      /// \brief Set the number of Fuel resources downloaded at the same time
+      /// while loading a world. Before the world is parsed, the Fuel URIs it
+      /// references, and those referenced by the downloaded models, are
+      /// fetched concurrently, so that parsing finds them in the cache.
+      /// The default is 8.
+      /// \param[in] _threads Number of downloads, 1 or 0 to only download
+      /// resources one by one as they're parsed.
+      public: void SetFuelDownloadThreads(unsigned int _threads);
+
       /// \brief Physics engine plugin library to load.
       /// \return File containing physics engine library.
       public: const std::string &PhysicsEngine() const;
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SERVERTEMPLATE_HH_
+#define IGNITION_GAZEBO_SERVERTEMPLATE_HH_
+
+#include <memory>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Server.hh>
+#include <ignition/gazebo/ServerConfig.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations
+    class ServerTemplatePrivate;
+
+    /// \class ServerTemplate ServerTemplate.hh
+    /// ignition/gazebo/ServerTemplate.hh
+    /// \brief Loads a world once, so that many worker processes forked from
+    /// it can start simulating it without parsing SDF or loading plugin
+    /// libraries again. Memory which isn't written after forking, such as
+    /// the parsed world and the code of the plugins, is shared between the
+    /// workers.
+    ///
+    /// Forking is only safe while the process has a single thread, so the
+    /// template only does the work which doesn't start threads or
+    /// transport: the world is parsed, including its included models, and
+    /// the plugin libraries are loaded without instantiating any plugin.
+    /// Entities, systems and physics are created by each worker in
+    /// CreateServer. The template must be created before any Server,
+    /// transport node or thread exists in the process.
+    ///
+    /// Example:
+    ///
+    /// \code
+    /// ServerTemplate serverTemplate(config);
+    /// for (int i = 0; i < 64; ++i)
+    /// {
+    ///   if (serverTemplate.Fork("worker_" + std::to_string(i)) == 0)
+    ///   {
+    ///     auto server = serverTemplate.CreateServer();
+    ///     server->Run(true, 0, false);
+    ///     _exit(0);
+    ///   }
+    /// }
+    /// \endcode
+    ///
+    /// Forking isn't supported on Windows.
+    class IGNITION_GAZEBO_VISIBLE ServerTemplate
+    {
+      /// \brief Constructor. Loads the world of the configuration.
+      /// \param[in] _config Configuration of the servers created from this
+      /// template.
+      public: explicit ServerTemplate(const ServerConfig &_config);
+
+      /// \brief Destructor.
+      public: ~ServerTemplate();
+
+      /// \brief Whether the world was loaded, and a server can still be
+      /// created.
+      /// \return True if CreateServer will succeed.
+      public: bool Valid() const;
+
+      /// \brief Fork a worker process. The worker uses its own transport
+      /// partition, so that the topics and services of workers don't
+      /// collide.
+      /// \param[in] _partition Transport partition of the worker. If
+      /// empty, the worker keeps the partition of this process.
+      /// \return 0 in the worker, the process ID of the worker in this
+      /// process, or -1 if the worker couldn't be forked.
+      public: int Fork(const std::string &_partition);
+
+      /// \brief Create the server of the loaded world. Call it in the
+      /// worker, after forking. It can be called once per process.
+      /// \return The server, or nullptr if the template isn't valid.
+      public: std::unique_ptr<Server> CreateServer();
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<ServerTemplatePrivate> dataPtr;
+    };
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_SERVERTEMPLATE_HH_
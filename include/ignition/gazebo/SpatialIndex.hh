@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SPATIALINDEX_HH_
+#define IGNITION_GAZEBO_SPATIALINDEX_HH_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <ignition/math/AxisAlignedBox.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations
+    class SpatialIndexPrivate;
+
+    /// \class SpatialIndex SpatialIndex.hh ignition/gazebo/SpatialIndex.hh
+    /// \brief Finds the entities whose axis aligned boxes intersect a region,
+    /// without testing every entity.
+    ///
+    /// Boxes are stored in a uniform hashed grid, so moving an entity only
+    /// costs something when it changes cells, and a query only visits the
+    /// cells it overlaps. It's safe to query from several threads at once.
+    ///
+    /// Systems which look for models in a region, like LogicalCamera and
+    /// PerformerDetector, share one index per world through Models, which
+    /// is refreshed from the ECM at most once per iteration.
+    class IGNITION_GAZEBO_VISIBLE SpatialIndex
+    {
+      /// \brief Constructor
+      /// \param[in] _cellSize Size of the grid cells, in meters. Cells a bit
+      /// larger than the typical query are a good choice.
+      public: explicit SpatialIndex(double _cellSize = 10.0);
+
+      /// \brief Destructor
+      public: ~SpatialIndex();
+
+      /// \brief Get the index shared by all systems of a world, which holds
+      /// models and performers. Call UpdateModels before querying it.
+      /// \param[in] _ecm The world's entity component manager.
+      /// \return The shared index. It lives as long as anyone holds it.
+      public: static std::shared_ptr<SpatialIndex> Models(
+          const EntityComponentManager &_ecm);
+
+      /// \brief Refresh the index from the ECM, unless it was already
+      /// refreshed on this iteration. Each model is indexed at the position
+      /// of its pose component, and each performer by its box around the pose
+      /// of its parent. Other entities are removed.
+      /// \param[in] _info Current simulation iteration.
+      /// \param[in] _ecm Entity component manager.
+      public: void UpdateModels(const UpdateInfo &_info,
+          const EntityComponentManager &_ecm);
+
+      /// \brief Add an entity, or move it if it's already indexed.
+      /// \param[in] _entity Entity.
+      /// \param[in] _box Its box, in the world frame.
+      public: void Set(Entity _entity, const math::AxisAlignedBox &_box);
+
+      /// \brief Remove an entity.
+      /// \param[in] _entity Entity.
+      /// \return False if it wasn't indexed.
+      public: bool Remove(Entity _entity);
+
+      /// \brief Get the entities whose boxes intersect a region. Touching
+      /// boxes count as intersecting.
+      /// \param[in] _region Region, in the world frame.
+      /// \return Entities, in no particular order.
+      public: std::vector<Entity> Query(
+          const math::AxisAlignedBox &_region) const;
+
+      /// \brief Number of indexed entities.
+      /// \return Number of entities.
+      public: std::size_t Size() const;
+
+      /// \brief Private data pointer
+      private: std::unique_ptr<SpatialIndexPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_STATEDELTA_HH_
+#define IGNITION_GAZEBO_STATEDELTA_HH_
+
+#include <memory>
+#include <string>
+
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations
+    class StateDeltaEncoderPrivate;
+    class StateDeltaDecoderPrivate;
+
+    /// \brief Header data key listing the components of a state message
+    /// which hold deltas. Each value is "<entity> <component type>".
+    const std::string kStateDeltaKey{"delta_components"};
+
+    /// \class StateDeltaEncoder StateDelta.hh ignition/gazebo/StateDelta.hh
+    /// \brief Replaces large components in a stream of state messages with
+    /// deltas against the value the stream sent last, so a component which
+    /// changed a little doesn't have to be sent in full again.
+    ///
+    /// Only components whose serializer is a serializers::DeltaSerializer
+    /// are delta encoded, and only when the delta is smaller than the
+    /// serialized component. The receiving end of the stream must pass every
+    /// message, in order, through a StateDeltaDecoder.
+    ///
+    /// Each delta carries hashes of the value it applies to and of the
+    /// value it produces, so a decoder detects a missing base, and skips
+    /// deltas it already applied, such as when replaying a log from a
+    /// keyframe.
+    class IGNITION_GAZEBO_VISIBLE StateDeltaEncoder
+    {
+      /// \brief Constructor
+      public: StateDeltaEncoder();
+
+      /// \brief Destructor
+      public: ~StateDeltaEncoder();
+
+      /// \brief Delta encode the components of a state message which
+      /// changed since the last message, and remember their values for the
+      /// next one.
+      /// \param[in, out] _msg Message created with
+      /// EntityComponentManager::State or ChangedState.
+      public: void Encode(msgs::SerializedStateMap &_msg);
+
+      /// \brief Forget all values sent so far, so the next message carries
+      /// every component in full.
+      public: void Reset();
+
+      /// \brief Private data pointer
+      private: std::unique_ptr<StateDeltaEncoderPrivate> dataPtr;
+    };
+
+    /// \class StateDeltaDecoder StateDelta.hh ignition/gazebo/StateDelta.hh
+    /// \brief Restores state messages encoded by StateDeltaEncoder.
+    class IGNITION_GAZEBO_VISIBLE StateDeltaDecoder
+    {
+      /// \brief Constructor
+      public: StateDeltaDecoder();
+
+      /// \brief Destructor
+      public: ~StateDeltaDecoder();
+
+      /// \brief Replace the deltas of a state message with full components,
+      /// and remember the values for the next message. Messages which hold
+      /// no deltas, such as keyframes, are remembered too.
+      /// \param[in, out] _msg Message to decode.
+      /// \return False if a delta couldn't be applied because its base is
+      /// unknown, in which case the component is cleared so that
+      /// EntityComponentManager::SetState skips it.
+      public: bool Decode(msgs::SerializedStateMap &_msg);
+
+      /// \brief Forget all values received so far, e.g. when seeking.
+      public: void Reset();
+
+      /// \brief Private data pointer
+      private: std::unique_ptr<StateDeltaDecoderPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
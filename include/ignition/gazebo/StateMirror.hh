@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_STATEMIRROR_HH_
+#define IGNITION_GAZEBO_STATEMIRROR_HH_
+
+#include <ignition/msgs/serialized.pb.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations
+    class StateMirrorPrivate;
+
+    /// \brief Changes applied to a StateMirror's entity-component manager in
+    /// one update.
+    struct StateMirrorChanges
+    {
+      /// \brief Entities which were created or removed.
+      std::unordered_set<Entity> entities;
+
+      /// \brief Types of the created, updated or removed components of each
+      /// entity.
+      std::unordered_map<Entity, std::unordered_set<ComponentTypeId>>
+          components;
+    };
+
+    /// \class StateMirror StateMirror.hh ignition/gazebo/StateMirror.hh
+    /// \brief Keeps a copy of a running world's entity-component manager,
+    /// updated from the state published by the SceneBroadcaster system.
+    ///
+    /// It ingests state the same way the GUI does, without depending on Qt:
+    /// state messages received between two updates are merged, so only the
+    /// latest value of each component is applied, and the delta encoded
+    /// dynamic poses can optionally be used to update poses in between
+    /// state messages. This makes it suitable for processes which serve
+    /// world state to many clients, such as web dashboards, from a single
+    /// subscription.
+    ///
+    /// Change callbacks are called after each update which changed
+    /// something, on the thread which runs the update.
+    class IGNITION_GAZEBO_VISIBLE StateMirror
+    {
+      /// \brief Function called after an update.
+      /// \param[in] _info Simulation time and iteration of the latest state.
+      /// \param[in] _ecm The mirrored entity-component manager.
+      /// \param[in] _changes Changes applied in this update.
+      public: using ChangeCallback = std::function<void(
+          const UpdateInfo &_info, const EntityComponentManager &_ecm,
+          const StateMirrorChanges &_changes)>;
+
+      /// \brief Constructor. Nothing is received until Start is called.
+      /// \param[in] _worldName Name of the world to mirror.
+      public: explicit StateMirror(const std::string &_worldName);
+
+      /// \brief Destructor. Stops the mirror.
+      public: ~StateMirror();
+
+      /// \brief Set the rate at which received state is applied and change
+      /// callbacks are called. It's independent of the rate at which state
+      /// is received. Must be called before Start.
+      /// \param[in] _hz Rate in Hz. Zero doesn't start an update thread, so
+      /// Update must be called by the user.
+      public: void SetUpdateRate(double _hz);
+
+      /// \brief Also subscribe to the delta encoded dynamic poses, so that
+      /// poses are updated in between state messages. It's useful with a low
+      /// `<state_hertz>` in the SceneBroadcaster. Must be called before Start.
+      /// \param[in] _enabled True to use the delta encoded poses.
+      public: void SetPoseDeltaEnabled(bool _enabled);
+
+      /// \brief Request the initial state and start receiving updates.
+      /// \return False if the topics for the world couldn't be created.
+      public: bool Start();
+
+      /// \brief Stop receiving updates and join the update thread. The
+      /// mirrored state is kept.
+      public: void Stop();
+
+      /// \brief Apply the state received since the last update and call the
+      /// change callbacks. It's called by the update thread, and only needs
+      /// to be called by the user if the update rate is zero.
+      /// \return True if anything changed.
+      public: bool Update();
+
+      /// \brief Add a function to be called after each update which changed
+      /// something. It must not add or remove callbacks.
+      /// \param[in] _cb Function to call.
+      /// \return Id to remove the callback with.
+      public: uint64_t AddChangeCallback(ChangeCallback _cb);
+
+      /// \brief Remove a change callback.
+      /// \param[in] _id Id returned by AddChangeCallback.
+      /// \return False if there's no callback with the given id.
+      public: bool RemoveChangeCallback(uint64_t _id);
+
+      /// \brief Call a function with the mirrored entity-component manager,
+      /// while no update happens. Useful to send the whole state to a new
+      /// client.
+      /// \param[in] _fn Function to call.
+      public: void WithState(const std::function<void(const UpdateInfo &,
+          const EntityComponentManager &)> &_fn) const;
+
+      /// \brief Whether any state was received yet.
+      /// \return True once the first state was applied.
+      public: bool HasState() const;
+
+      /// \brief Merge a state message into an older one which hasn't been
+      /// applied yet. Components in the newer message replace those in the
+      /// older one, and a removed entity replaces all its previous
+      /// components.
+      /// \param[in, out] _pending Older message, which receives the merge.
+      /// \param[in] _msg Newer message.
+      public: static void MergeState(msgs::SerializedStepMap &_pending,
+          const msgs::SerializedStepMap &_msg);
+
+      /// \brief Private data pointer
+      private: std::unique_ptr<StateMirrorPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -17,7 +17,10 @@
 #ifndef IGNITION_GAZEBO_SYSTEM_HH_
 #define IGNITION_GAZEBO_SYSTEM_HH_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <set>
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/EntityComponentManager.hh>
@@ -58,10 +61,16 @@ namespace ignition
     ///      time UpdateInfo::simTime).
     ///  * PostUpdate
     ///    * Has read-only access to world entities and components.
+    ///    * Systems run concurrently on a pool of worker threads sized to
+    ///      the hardware. Entities and components can't change during this
+    ///      phase, so component access is lock-free.
     ///    * Captures everything that happened at time UpdateInfo::simTime.
     ///    * Used to read out results at the end of a simulation step to be used
     ///      for sensor or controller updates.
     ///
+    /// Computations which take longer than a step can implement
+    /// ISystemAsyncUpdate instead, which runs across several steps.
+    ///
     /// It's important to note that UpdateInfo::simTime does not refer to the
     /// current time, but the time reached after the PreUpdate and Update calls
     /// have finished. So, if any of the *Update functions are called with
@@ -114,12 +123,79 @@ namespace ignition
                                   EntityComponentManager &_ecm) = 0;
     };
 
+    /// \class ISystemAccess ISystem.hh ignition/gazebo/System.hh
+    /// \brief Optional interface for a system that declares which component
+    /// types it reads and writes during PreUpdate and Update.
+    ///
+    /// Systems which implement this interface may run at the same time as
+    /// other declaring systems whose accesses don't conflict, that is, when
+    /// neither system writes a component type which the other one reads or
+    /// writes. Conflicting systems, and all systems which don't implement
+    /// this interface, keep running in the order they were added.
+    ///
+    /// While running concurrently, a declaring system must only modify the
+    /// data of the component types it writes, and must not create or remove
+    /// entities or components, nor mark components as changed. Systems which
+    /// need to do so shouldn't implement this interface, unless the server
+    /// is deterministic, see ServerConfig::SetDeterministic. Then entities
+    /// and components may be created and removed, and parents changed, and
+    /// these changes are applied once all concurrent systems are done.
+    class IGNITION_GAZEBO_VISIBLE ISystemAccess {
+      /// \brief Get the component types which the system reads.
+      /// \return Set of component type IDs.
+      public: virtual std::set<ComponentTypeId> ComponentsRead() const = 0;
+
+      /// \brief Get the component types which the system writes.
+      /// \return Set of component type IDs.
+      public: virtual std::set<ComponentTypeId> ComponentsWritten() const = 0;
+    };
+
     /// \class ISystemPostUpdate ISystem.hh ignition/gazebo/System.hh
     /// \brief Interface for a system that uses the PostUpdate phase
     class IGNITION_GAZEBO_VISIBLE ISystemPostUpdate{
       public: virtual void PostUpdate(const UpdateInfo &_info,
                                       const EntityComponentManager &_ecm) = 0;
     };
+
+    /// \class ISystemAsyncUpdate ISystem.hh ignition/gazebo/System.hh
+    /// \brief Interface for a system which runs computations spanning
+    /// several steps, such as planners, without holding back the loop.
+    ///
+    /// AsyncUpdate is called on a worker thread with a read-only copy of the
+    /// entity-component manager, taken at the end of the Update phase. It
+    /// runs while simulation goes on. The commands it returns are applied
+    /// to the entity-component manager at the start of the PreUpdate phase,
+    /// AsyncUpdateIterations iterations after the copy was taken, waiting
+    /// for AsyncUpdate to finish if needed. So results are deterministic,
+    /// no matter how long the computation takes. The next AsyncUpdate is
+    /// started at the end of that same step.
+    ///
+    /// The copy holds the entities and components as they were when it was
+    /// taken, and entities and components which changed since the previous
+    /// AsyncUpdate are reported as new, removed or changed. Components
+    /// modified without being marked as changed aren't copied.
+    ///
+    /// AsyncUpdate may run at the same time as the system's other phases,
+    /// so state shared with them must be protected.
+    class IGNITION_GAZEBO_VISIBLE ISystemAsyncUpdate {
+      /// \brief Changes to the entity-component manager, returned by
+      /// AsyncUpdate. They're applied on the simulation thread.
+      public: using Commands = std::function<void(const UpdateInfo &_info,
+                                  EntityComponentManager &_ecm)>;
+
+      /// \brief Get the number of iterations between the start of an
+      /// AsyncUpdate and the application of its commands. It's read once,
+      /// when the system is added.
+      /// \return Number of iterations, at least 1.
+      public: virtual uint64_t AsyncUpdateIterations() const = 0;
+
+      /// \brief Compute, based on a copy of the entities and components.
+      /// \param[in] _info Info of the step at which the copy was taken.
+      /// \param[in] _ecm Copy of the entity-component manager.
+      /// \return Commands to apply, can be empty.
+      public: virtual Commands AsyncUpdate(const UpdateInfo &_info,
+                  const EntityComponentManager &_ecm) = 0;
+    };
   }
   }
 }
@@ -50,6 +50,20 @@ namespace ignition
       /// \param[in] _path New path to be added.
       public: void AddSystemPluginPath(const std::string &_path);
 
+      /// \brief Load a plugin library without instantiating any of its
+      /// plugins, so that plugins loaded later from it are only
+      /// instantiated.
+      /// \param[in] _filename Name of the library, as in the filename
+      /// attribute of plugins.
+      /// \return True if the library is loaded.
+      public: bool PreloadLibrary(const std::string &_filename);
+
+      /// \brief Preload the libraries of all the plugins within an SDF
+      /// element and its descendants, see PreloadLibrary.
+      /// \param[in] _sdf SDF element, such as a world.
+      /// \return Number of distinct libraries which were loaded.
+      public: std::size_t PreloadLibraries(const sdf::ElementPtr &_sdf);
+
       /// \brief Load and instantiate system plugin from an SDF element.
       /// \param[in] _sdf SDF Element describing plugin instance to be loaded.
       /// \returns Shared pointer to system instance or nullptr.
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_THREADAFFINITY_HH_
+#define IGNITION_GAZEBO_THREADAFFINITY_HH_
+
+#include <string>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace common
+  {
+    // Forward declarations.
+    class WorkerPool;
+  }
+
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Parse a list of CPUs written as comma separated indices and
+    /// ranges, such as "0-3,8", like the lists of taskset and numactl.
+    /// \param[in] _list List of CPUs.
+    /// \param[out] _cpus Sorted indices of the CPUs, without duplicates.
+    /// \return False if the list is malformed.
+    bool IGNITION_GAZEBO_VISIBLE ParseCpuList(const std::string &_list,
+        std::vector<unsigned int> &_cpus);
+
+    /// \brief Restrict the calling thread to run on some CPUs. Memory is
+    /// allocated on the NUMA node of the CPU which first writes to it, so
+    /// memory such as component storage, which grows as the thread runs,
+    /// ends up on the node of these CPUs. Only supported on Linux.
+    /// \param[in] _cpus Indices of the CPUs. Empty to leave the thread as
+    /// it is.
+    /// \return False if the affinity couldn't be set.
+    bool IGNITION_GAZEBO_VISIBLE SetThreadCpus(
+        const std::vector<unsigned int> &_cpus);
+
+    /// \brief Run the calling thread with the first in first out real-time
+    /// scheduling policy, which usually requires privileges, such as the
+    /// CAP_SYS_NICE capability or an rtprio limit. Only supported on Linux.
+    /// \param[in] _priority Priority, from 1 to 99. 0 to leave the thread
+    /// as it is.
+    /// \return False if the priority couldn't be set.
+    bool IGNITION_GAZEBO_VISIBLE SetThreadRealtimePriority(int _priority);
+
+    /// \brief Restrict all threads of a worker pool to run on some CPUs.
+    /// Each thread is given a task which sets its affinity, and which
+    /// waits for the other threads, so that no thread runs two of them.
+    /// This returns once all threads are done, so it must be called while
+    /// the pool is idle.
+    /// \param[in] _pool Worker pool.
+    /// \param[in] _minThreads Number of threads the pool was constructed
+    /// with. Like the pool, at least one thread per hardware core is
+    /// assumed.
+    /// \param[in] _cpus Indices of the CPUs. Empty to leave the threads as
+    /// they are.
+    /// \return False if the affinity of any thread couldn't be set.
+    bool IGNITION_GAZEBO_VISIBLE SetWorkerPoolCpus(common::WorkerPool &_pool,
+        unsigned int _minThreads, const std::vector<unsigned int> &_cpus);
+    }
+  }
+}
+#endif
@@ -126,11 +126,23 @@ namespace ignition
 
     /// \brief Add resource paths based on latest environment variables.
     /// This will update the SDF and Ignition environment variables, and
-    /// optionally add more paths to the list.
+    /// optionally add more paths to the list. Clears the files remembered
+    /// by findResource.
     /// \param[in] _paths Optional paths to add.
     void IGNITION_GAZEBO_VISIBLE addResourcePaths(
         const std::vector<std::string> &_paths = {});
 
+    /// \brief Find a file with common::findFile, remembering the result,
+    /// including when the file isn't found, so that resources used by many
+    /// entities are only searched for once. Results are forgotten when
+    /// addResourcePaths is called, or when the IGN_GAZEBO_RESOURCE_PATH or
+    /// Ignition file path variables change. Safe to call from several
+    /// threads.
+    /// \param[in] _uri URI or path of the file, as given to
+    /// common::findFile.
+    /// \return Full path to the file, or an empty string if not found.
+    std::string IGNITION_GAZEBO_VISIBLE findResource(const std::string &_uri);
+
     /// \brief Get the top level model of an entity
     /// \param[in] _entity Input entity
     /// \param[in] _ecm Constant reference to ECM.
@@ -168,6 +180,15 @@ namespace ignition
     /// \brief Environment variable holding paths to custom rendering engine
     /// plugins.
     const std::string kRenderPluginPathEnv{"IGN_GAZEBO_RENDER_ENGINE_PATH"};
+
+    /// \brief Environment variable holding the directory of the world cache.
+    /// See ServerConfig::SetWorldCachePath.
+    const std::string kWorldCachePathEnv{"IGN_GAZEBO_WORLD_CACHE_PATH"};
+
+    /// \brief Environment variable holding the path of the report of
+    /// entity-component manager accesses. See
+    /// ServerConfig::SetEcmAccessReportPath.
+    const std::string kEcmAccessReportEnv{"IGN_GAZEBO_ECM_ACCESS_REPORT"};
     }
   }
 }
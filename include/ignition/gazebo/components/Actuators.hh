@@ -37,7 +37,8 @@ namespace components
   using Actuators = Component<msgs::Actuators, class ActuatorsTag,
                               serializers::MsgSerializer>;
 
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Actuators", Actuators)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.Actuators", Actuators)
 }
 }
 }
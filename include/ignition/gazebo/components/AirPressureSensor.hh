@@ -36,8 +36,8 @@ namespace components
   /// sdf::AirPressure, information.
   using AirPressureSensor = Component<sdf::Sensor, class AirPressureSensorTag,
       serializers::SensorSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.AirPressureSensor",
-      AirPressureSensor)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.AirPressureSensor", AirPressureSensor)
 }
 }
 }
@@ -36,7 +36,8 @@ namespace components
   /// sdf::Altimeter, information.
   using Altimeter =
       Component<sdf::Sensor, class AltimeterTag, serializers::SensorSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Altimeter", Altimeter)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.Altimeter", Altimeter)
 }
 }
 }
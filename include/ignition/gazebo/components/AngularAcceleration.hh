@@ -37,14 +37,14 @@ namespace components
   /// represented by ignition::math::Vector3d.
   using AngularAcceleration =
       Component<math::Vector3d, class AngularAccelerationTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.AngularAcceleration",
-                                AngularAcceleration)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.AngularAcceleration", AngularAcceleration)
 
   /// \brief A component type that contains angular acceleration of an entity in
   /// the world frame represented by ignition::math::Vector3d.
   using WorldAngularAcceleration =
       Component<math::Vector3d, class WorldAngularAccelerationTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.WorldAngularAcceleration",
       WorldAngularAcceleration)
 }
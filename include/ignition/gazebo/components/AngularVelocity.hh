@@ -37,15 +37,15 @@ namespace components
   /// represented by ignition::math::Vector3d.
   using AngularVelocity =
     Component<math::Vector3d, class AngularVelocityTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.AngularVelocity",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.AngularVelocity",
       AngularVelocity)
 
   /// \brief A component type that contains angular velocity of an entity in the
   /// world frame represented by ignition::math::Vector3d.
   using WorldAngularVelocity =
       Component<math::Vector3d, class WorldAngularVelocityTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.WorldAngularVelocity",
-      WorldAngularVelocity)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.WorldAngularVelocity", WorldAngularVelocity)
 }
 }
 }
@@ -42,7 +42,7 @@ namespace components
   using Atmosphere =
       Component<sdf::Atmosphere, class AtmosphereTag,
       serializers::AtmosphereSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.Atmosphere", Atmosphere)
 }
 }
@@ -45,7 +45,7 @@ namespace components
   /// The axis aligned box is created from collisions in the entity
   using AxisAlignedBox = Component<ignition::math::AxisAlignedBox,
       class AxisAlignedBoxTag, serializers::AxisAlignedBoxSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.AxisAlignedBox",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.AxisAlignedBox",
       AxisAlignedBox)
 }
 }
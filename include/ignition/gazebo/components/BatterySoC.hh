@@ -32,7 +32,8 @@ namespace components
   /// A component that identifies an entity as being a battery.
   ///   Float value indicates state of charge.
   using BatterySoC = Component<float, class BatterySoCTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.BatterySoC", BatterySoC)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.BatterySoC", BatterySoC)
 }
 }
 }
@@ -36,7 +36,7 @@ namespace components
   /// sdf::Camera, information.
   using Camera = Component<sdf::Sensor, class CameraTag,
       serializers::SensorSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Camera", Camera)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Camera", Camera)
 }
 }
 }
@@ -32,7 +32,7 @@ namespace components
   /// \brief A component used to indicate that an entity casts shadows
   /// e.g. visual entities
   using CastShadows = Component<bool, class CastShadowsTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.CastShadows",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.CastShadows",
       CastShadows)
 }
 }
@@ -35,7 +35,7 @@ namespace components
   /// position of the center of volume is relative to the pose of the parent
   /// entity.
   using CenterOfVolume = Component<math::Vector3d, class CenterOfVolumeTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.CenterOfVolume",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.CenterOfVolume",
       CenterOfVolume)
 }
 }
@@ -35,7 +35,7 @@ namespace components
   /// not moveable).
   using ChildLinkName = Component<std::string, class ChildLinkNameTag,
       serializers::StringSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
     "ign_gazebo_components.ChildLinkName", ChildLinkName)
 }
 }
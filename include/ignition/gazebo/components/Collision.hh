@@ -40,7 +40,7 @@ namespace components
 {
   /// \brief A component that identifies an entity as being a collision.
   using Collision = Component<NoData, class CollisionTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.Collision", Collision)
 
   // TODO(anyone) The sdf::Collision DOM object does not yet contain
@@ -49,8 +49,8 @@ namespace components
   using CollisionElement =
       Component<sdf::Collision, class CollisionElementTag,
     serializers::CollisionElementSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.CollisionElement",
-                                CollisionElement)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.CollisionElement", CollisionElement)
 }
 }
 }
@@ -18,12 +18,19 @@
 #define IGNITION_GAZEBO_COMPONENTS_COMPONENT_HH_
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <sstream>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 
 #include <ignition/common/Console.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Quaternion.hh>
+#include <ignition/math/Vector2.hh>
+#include <ignition/math/Vector3.hh>
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/Export.hh>
@@ -96,16 +103,124 @@ namespace traits
     public: static constexpr bool value =  // NOLINT
                 decltype(Test<Stream, DataType>(0))::value;
   };
+
+  /// \brief Type trait that determines if serializers::DefaultSerializer
+  /// writes a type as raw bytes instead of text: arithmetic types, and math
+  /// vectors, quaternions and poses of them.
+  template <typename DataType>
+  struct IsBinarySerializable : std::is_arithmetic<DataType>
+  {
+    /// \brief Number of bytes of serialized data, for arithmetic types.
+    static constexpr std::size_t kSize{sizeof(
+        std::conditional_t<std::is_arithmetic_v<DataType>, DataType, char>)};
+  };
+
+  /// \brief Binary serializable 2D vectors.
+  template <typename T>
+  struct IsBinarySerializable<math::Vector2<T>> : std::is_arithmetic<T>
+  {
+    /// \brief Number of bytes of serialized data.
+    static constexpr std::size_t kSize{2 * sizeof(T)};
+  };
+
+  /// \brief Binary serializable 3D vectors.
+  template <typename T>
+  struct IsBinarySerializable<math::Vector3<T>> : std::is_arithmetic<T>
+  {
+    /// \brief Number of bytes of serialized data.
+    static constexpr std::size_t kSize{3 * sizeof(T)};
+  };
+
+  /// \brief Binary serializable quaternions.
+  template <typename T>
+  struct IsBinarySerializable<math::Quaternion<T>> : std::is_arithmetic<T>
+  {
+    /// \brief Number of bytes of serialized data.
+    static constexpr std::size_t kSize{4 * sizeof(T)};
+  };
+
+  /// \brief Binary serializable poses.
+  template <typename T>
+  struct IsBinarySerializable<math::Pose3<T>> : std::is_arithmetic<T>
+  {
+    /// \brief Number of bytes of serialized data.
+    static constexpr std::size_t kSize{7 * sizeof(T)};
+  };
+
+  /// \brief Type trait that determines if a serializer opted into delta
+  /// encoding by defining `static constexpr bool kDeltaEncoded = true`, see
+  /// serializers::DeltaSerializer.
+  template <typename Serializer, typename = void>
+  struct IsDeltaEncoded : std::false_type
+  {
+  };
+
+  /// \brief Type trait that determines if a serializer opted into delta
+  /// encoding.
+  template <typename Serializer>
+  struct IsDeltaEncoded<Serializer,
+      std::void_t<decltype(Serializer::kDeltaEncoded)>>
+    : std::bool_constant<Serializer::kDeltaEncoded>
+  {
+  };
+
+  /// \brief Type trait that determines if a serializer can write `DataType`
+  /// to a buffer and read it from one, through static
+  /// `void SerializeToBuffer(std::string &, const DataType &)` and
+  /// `void DeserializeFromBuffer(std::string_view, DataType &)` functions.
+  template <typename Serializer, typename DataType, typename = void>
+  struct HasBufferSerializer : std::false_type
+  {
+  };
+
+  /// \brief Type trait that determines if a serializer can write `DataType`
+  /// to a buffer and read it from one.
+  template <typename Serializer, typename DataType>
+  struct HasBufferSerializer<Serializer, DataType, std::void_t<
+      decltype(Serializer::SerializeToBuffer(std::declval<std::string &>(),
+          std::declval<const DataType &>())),
+      decltype(Serializer::DeserializeFromBuffer(
+          std::declval<std::string_view>(), std::declval<DataType &>()))>>
+    : std::true_type
+  {
+  };
+
+  /// \brief Type trait that determines if a component type has a type id
+  /// known at compile time. IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT gives one
+  /// to the components it registers, so this holds wherever the
+  /// registration is visible.
+  template <typename ComponentTypeT, typename = void>
+  struct HasStaticTypeId : std::false_type
+  {
+  };
+
+  /// \brief Type trait that determines if a component type has a type id
+  /// known at compile time.
+  template <typename ComponentTypeT>
+  struct HasStaticTypeId<ComponentTypeT,
+      std::void_t<decltype(IgnGazeboComponentStaticTypeId(
+          std::declval<const ComponentTypeT *>()))>>
+    : std::true_type
+  {
+  };
 }
 
 namespace serializers
 {
-  /// \brief Default serializer template to call stream operators only on types
+  /// \brief Serializer template to call stream operators only on types
   /// that support them. If the stream operator is not available, a warning
   /// message is printed.
+  ///
+  /// This is what DefaultSerializer uses for types which aren't binary
+  /// serializable. Components with binary serializable data can use it to
+  /// get human readable state while debugging, for example:
+  /// \code
+  ///   using Pose = Component<math::Pose3d, class PoseTag,
+  ///       serializers::TextSerializer<math::Pose3d>>;
+  /// \endcode
   /// \tparam DataType Type on which the operator will be called.
   template <typename DataType>
-  class DefaultSerializer
+  class TextSerializer
   {
     /// Serialization
     public: static std::ostream &Serialize(std::ostream &_out,
@@ -196,6 +311,216 @@ namespace serializers
       return _in;
     }
   };
+
+  /// \brief Serializer which writes data as raw bytes, for types in
+  /// traits::IsBinarySerializable. Unlike text, it doesn't lose precision
+  /// and costs little more than a copy. Bytes are in host order.
+  ///
+  /// Serialized data starts with kMarker, which text never starts with, so
+  /// data serialized as text, like logs recorded by older versions, can
+  /// still be deserialized.
+  /// \tparam DataType Serialized type.
+  template <typename DataType>
+  class BinarySerializer
+  {
+    static_assert(traits::IsBinarySerializable<DataType>::value,
+        "BinarySerializer only supports types in IsBinarySerializable");
+
+    /// \brief First byte of binary serialized data.
+    public: static constexpr char kMarker{'\0'};
+
+    /// \brief Serialization
+    /// \param[in] _out Output stream.
+    /// \param[in] _data Data to stream.
+    /// \return The stream.
+    public: static std::ostream &Serialize(std::ostream &_out,
+                                           const DataType &_data)
+    {
+      char bytes[1 + kSize];
+      bytes[0] = kMarker;
+      char *pos = bytes + 1;
+      Write(pos, _data);
+      _out.write(bytes, sizeof(bytes));
+      return _out;
+    }
+
+    /// \brief Deserialization, of either binary or text data.
+    /// \param[in] _in Input stream.
+    /// \param[out] _data Data resulting from deserialization.
+    /// \return The stream.
+    public: static std::istream &Deserialize(std::istream &_in,
+                                             DataType &_data)
+    {
+      if (_in.peek() != kMarker)
+        return TextSerializer<DataType>::Deserialize(_in, _data);
+
+      _in.get();
+      char bytes[kSize];
+      if (_in.read(bytes, sizeof(bytes)))
+      {
+        const char *pos = bytes;
+        Read(pos, _data);
+      }
+      return _in;
+    }
+
+    /// \brief Serialization into a buffer.
+    /// \param[in, out] _buffer Buffer to append to.
+    /// \param[in] _data Data to serialize.
+    public: static void SerializeToBuffer(std::string &_buffer,
+                                          const DataType &_data)
+    {
+      const std::size_t start = _buffer.size();
+      _buffer.resize(start + 1 + kSize);
+      _buffer[start] = kMarker;
+      char *pos = &_buffer[start + 1];
+      Write(pos, _data);
+    }
+
+    /// \brief Deserialization from a buffer, of either binary or text data.
+    /// \param[in] _bytes Serialized data.
+    /// \param[out] _data Data resulting from deserialization.
+    public: static void DeserializeFromBuffer(std::string_view _bytes,
+                                              DataType &_data)
+    {
+      if (_bytes.empty() || _bytes[0] != kMarker)
+      {
+        std::istringstream istr{std::string(_bytes)};
+        TextSerializer<DataType>::Deserialize(istr, _data);
+        return;
+      }
+
+      if (_bytes.size() < 1 + kSize)
+        return;
+
+      const char *pos = _bytes.data() + 1;
+      Read(pos, _data);
+    }
+
+    /// \brief Number of bytes of binary data, after the marker.
+    private: static constexpr std::size_t kSize{
+        traits::IsBinarySerializable<DataType>::kSize};
+
+    /// \brief Copy values to memory and advance past them.
+    /// \param[in, out] _pos Destination.
+    /// \param[in] _values Values.
+    private: template <typename T, std::size_t N>
+             static void Copy(char *&_pos, const T (&_values)[N])
+             {
+               std::memcpy(_pos, _values, sizeof(_values));
+               _pos += sizeof(_values);
+             }
+
+    /// \brief Copy values from memory and advance past them.
+    /// \param[in, out] _pos Source.
+    /// \param[out] _values Values.
+    private: template <typename T, std::size_t N>
+             static void Copy(const char *&_pos, T (&_values)[N])
+             {
+               std::memcpy(_values, _pos, sizeof(_values));
+               _pos += sizeof(_values);
+             }
+
+    /// \brief Write an arithmetic value.
+    private: template <typename T>
+             static std::enable_if_t<std::is_arithmetic_v<T>> Write(
+                 char *&_pos, const T &_value)
+             {
+               const T values[] = {_value};
+               Copy(_pos, values);
+             }
+
+    /// \brief Write a 2D vector.
+    private: template <typename T>
+             static void Write(char *&_pos, const math::Vector2<T> &_v)
+             {
+               const T values[] = {_v.X(), _v.Y()};
+               Copy(_pos, values);
+             }
+
+    /// \brief Write a 3D vector.
+    private: template <typename T>
+             static void Write(char *&_pos, const math::Vector3<T> &_v)
+             {
+               const T values[] = {_v.X(), _v.Y(), _v.Z()};
+               Copy(_pos, values);
+             }
+
+    /// \brief Write a quaternion.
+    private: template <typename T>
+             static void Write(char *&_pos, const math::Quaternion<T> &_q)
+             {
+               const T values[] = {_q.W(), _q.X(), _q.Y(), _q.Z()};
+               Copy(_pos, values);
+             }
+
+    /// \brief Write a pose.
+    private: template <typename T>
+             static void Write(char *&_pos, const math::Pose3<T> &_p)
+             {
+               Write(_pos, _p.Pos());
+               Write(_pos, _p.Rot());
+             }
+
+    /// \brief Read an arithmetic value.
+    private: template <typename T>
+             static std::enable_if_t<std::is_arithmetic_v<T>> Read(
+                 const char *&_pos, T &_value)
+             {
+               T values[1]{};
+               Copy(_pos, values);
+               _value = values[0];
+             }
+
+    /// \brief Read a 2D vector.
+    private: template <typename T>
+             static void Read(const char *&_pos, math::Vector2<T> &_v)
+             {
+               T values[2]{};
+               Copy(_pos, values);
+               _v.Set(values[0], values[1]);
+             }
+
+    /// \brief Read a 3D vector.
+    private: template <typename T>
+             static void Read(const char *&_pos, math::Vector3<T> &_v)
+             {
+               T values[3]{};
+               Copy(_pos, values);
+               _v.Set(values[0], values[1], values[2]);
+             }
+
+    /// \brief Read a quaternion.
+    private: template <typename T>
+             static void Read(const char *&_pos, math::Quaternion<T> &_q)
+             {
+               T values[4]{};
+               Copy(_pos, values);
+               _q.Set(values[0], values[1], values[2], values[3]);
+             }
+
+    /// \brief Read a pose.
+    private: template <typename T>
+             static void Read(const char *&_pos, math::Pose3<T> &_p)
+             {
+               math::Vector3<T> pos;
+               math::Quaternion<T> rot;
+               Read(_pos, pos);
+               Read(_pos, rot);
+               _p.Set(pos, rot);
+             }
+  };
+
+  /// \brief Default serializer of components. Types in
+  /// traits::IsBinarySerializable use BinarySerializer, and everything else
+  /// uses TextSerializer.
+  /// \tparam DataType Serialized type.
+  template <typename DataType>
+  class DefaultSerializer
+    : public std::conditional_t<traits::IsBinarySerializable<DataType>::value,
+        BinarySerializer<DataType>, TextSerializer<DataType>>
+  {
+  };
 }
 
 namespace components
@@ -221,6 +546,15 @@ namespace serializers
     {
       return _in;
     }
+
+    public: static void SerializeToBuffer(std::string &_buffer)
+    {
+      _buffer.push_back('-');
+    }
+
+    public: static void DeserializeFromBuffer(std::string_view)
+    {
+    }
   };
 }
 
@@ -270,11 +604,43 @@ namespace components
       }
     };
 
+    /// \brief Append a serialized version of the component to a buffer.
+    /// This is what the EntityComponentManager uses to fill state messages.
+    /// By default, it goes through Serialize. Derived classes which override
+    /// Serialize should override this too, to avoid a stream per component.
+    ///
+    /// \param[in, out] _buffer Buffer to append to.
+    public: virtual void SerializeToBuffer(std::string &_buffer) const
+    {
+      std::ostringstream ostr;
+      this->Serialize(ostr);
+      _buffer.append(ostr.str());
+    }
+
+    /// \brief Fills a component from serialized data, as written by
+    /// SerializeToBuffer. By default, it goes through Deserialize.
+    ///
+    /// \param[in] _data Serialized data.
+    public: virtual void DeserializeFromBuffer(std::string_view _data)
+    {
+      std::istringstream istr{std::string(_data)};
+      this->Deserialize(istr);
+    }
+
     /// \brief Returns the unique ID for the component's type.
     /// The ID is derived from the name that is manually chosen during the
     /// Factory registration and is guaranteed to be the same across compilers
     /// and runs.
     public: virtual ComponentTypeId TypeId() const = 0;
+
+    /// \brief Get whether state streams may send this component as a delta
+    /// against the value they sent last, see StateDeltaEncoder. Large
+    /// components opt in through serializers::DeltaSerializer.
+    /// \return True if the component may be delta encoded.
+    public: virtual bool DeltaEncoded() const
+    {
+      return false;
+    }
   };
 
   /// \brief A component type that wraps any data type. The intention is for
@@ -347,6 +713,15 @@ namespace components
     // Documentation inherited
     public: void Deserialize(std::istream &_in) override;
 
+    // Documentation inherited
+    public: void SerializeToBuffer(std::string &_buffer) const override;
+
+    // Documentation inherited
+    public: void DeserializeFromBuffer(std::string_view _data) override;
+
+    // Documentation inherited
+    public: bool DeltaEncoded() const override;
+
     /// \brief Get the mutable component data. This function will be
     /// deprecated in Gazebo 3, replaced by const DataType &Data() const.
     /// Use void SetData(const DataType &) to modify data.
@@ -414,6 +789,12 @@ namespace components
     // Documentation inherited
     public: void Deserialize(std::istream &_in) override;
 
+    // Documentation inherited
+    public: void SerializeToBuffer(std::string &_buffer) const override;
+
+    // Documentation inherited
+    public: void DeserializeFromBuffer(std::string_view _data) override;
+
     /// \brief Unique ID for this component type. This is set through the
     /// Factory registration.
     public: inline static ComponentTypeId typeId{0};
@@ -487,6 +868,28 @@ namespace components
     Serializer::Deserialize(_in, this->Data());
   }
 
+  //////////////////////////////////////////////////
+  template <typename DataType, typename Identifier, typename Serializer>
+  void Component<DataType, Identifier, Serializer>::SerializeToBuffer(
+      std::string &_buffer) const
+  {
+    if constexpr (traits::HasBufferSerializer<Serializer, DataType>::value)
+      Serializer::SerializeToBuffer(_buffer, this->Data());
+    else
+      BaseComponent::SerializeToBuffer(_buffer);
+  }
+
+  //////////////////////////////////////////////////
+  template <typename DataType, typename Identifier, typename Serializer>
+  void Component<DataType, Identifier, Serializer>::DeserializeFromBuffer(
+      std::string_view _data)
+  {
+    if constexpr (traits::HasBufferSerializer<Serializer, DataType>::value)
+      Serializer::DeserializeFromBuffer(_data, this->Data());
+    else
+      BaseComponent::DeserializeFromBuffer(_data);
+  }
+
   //////////////////////////////////////////////////
   template <typename DataType, typename Identifier, typename Serializer>
   ComponentTypeId Component<DataType, Identifier, Serializer>::TypeId() const
@@ -494,6 +897,13 @@ namespace components
     return typeId;
   }
 
+  //////////////////////////////////////////////////
+  template <typename DataType, typename Identifier, typename Serializer>
+  bool Component<DataType, Identifier, Serializer>::DeltaEncoded() const
+  {
+    return traits::IsDeltaEncoded<Serializer>::value;
+  }
+
   //////////////////////////////////////////////////
   template <typename Identifier, typename Serializer>
   bool Component<NoData, Identifier, Serializer>::operator==(
@@ -532,6 +942,60 @@ namespace components
   {
     Serializer::Deserialize(_in);
   }
+
+  //////////////////////////////////////////////////
+  template <typename Identifier, typename Serializer>
+  void Component<NoData, Identifier, Serializer>::SerializeToBuffer(
+      std::string &_buffer) const
+  {
+    if constexpr (std::is_same_v<Serializer,
+        serializers::DefaultSerializer<NoData>>)
+    {
+      Serializer::SerializeToBuffer(_buffer);
+    }
+    else
+    {
+      BaseComponent::SerializeToBuffer(_buffer);
+    }
+  }
+
+  //////////////////////////////////////////////////
+  template <typename Identifier, typename Serializer>
+  void Component<NoData, Identifier, Serializer>::DeserializeFromBuffer(
+      std::string_view _data)
+  {
+    if constexpr (std::is_same_v<Serializer,
+        serializers::DefaultSerializer<NoData>>)
+    {
+      Serializer::DeserializeFromBuffer(_data);
+    }
+    else
+    {
+      BaseComponent::DeserializeFromBuffer(_data);
+    }
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Get the unique ID of a component type. It's a compile time
+  /// constant for components registered with
+  /// IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT, which avoids reading the static
+  /// typeId, and comes from the Factory registration otherwise. Both give
+  /// the same ID.
+  /// \tparam ComponentTypeT Component type.
+  /// \return The component type's ID.
+  template <typename ComponentTypeT>
+  constexpr ComponentTypeId TypeIdOf()
+  {
+    if constexpr (traits::HasStaticTypeId<ComponentTypeT>::value)
+    {
+      return IgnGazeboComponentStaticTypeId(
+          static_cast<const ComponentTypeT *>(nullptr));
+    }
+    else
+    {
+      return ComponentTypeT::typeId;
+    }
+  }
 }
 }
 }
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_COMPONENTS_CONTACTCHANGES_HH_
+#define IGNITION_GAZEBO_COMPONENTS_CONTACTCHANGES_HH_
+
+#include <initializer_list>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/components/Component.hh"
+#include "ignition/gazebo/components/Factory.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+  /// \brief Changes in the collisions touched by a collision, between the
+  /// last two physics steps. All lists are sorted.
+  struct ContactPairChanges
+  {
+    /// \brief Collisions which started touching on the last step
+    std::vector<Entity> began;
+
+    /// \brief Collisions which stopped touching on the last step
+    std::vector<Entity> ended;
+
+    /// \brief All collisions touching after the last step, including those
+    /// which began
+    std::vector<Entity> touching;
+
+    /// \brief Whether anything began or ended.
+    /// \return True if the touched collisions changed.
+    bool Changed() const
+    {
+      return !this->began.empty() || !this->ended.empty();
+    }
+
+    /// \brief Equality operator.
+    /// \param[in] _other Changes to compare to.
+    /// \return True if equal.
+    bool operator==(const ContactPairChanges &_other) const
+    {
+      return this->began == _other.began && this->ended == _other.ended &&
+          this->touching == _other.touching;
+    }
+  };
+
+namespace serializers
+{
+  class ContactPairChangesSerializer
+  {
+    /// \brief Serialization for `ContactPairChanges`.
+    /// \param[in] _out Output stream.
+    /// \param[in] _changes Changes to stream
+    /// \return The stream.
+    public: static std::ostream &Serialize(std::ostream &_out,
+                                           const ContactPairChanges &_changes)
+    {
+      for (const auto *list :
+          {&_changes.began, &_changes.ended, &_changes.touching})
+      {
+        _out << list->size() << " ";
+        for (auto entity : *list)
+          _out << entity << " ";
+      }
+      return _out;
+    }
+
+    /// \brief Deserialization for `ContactPairChanges`.
+    /// \param[in] _in Input stream.
+    /// \param[out] _changes Changes to populate
+    /// \return The stream.
+    public: static std::istream &Deserialize(std::istream &_in,
+                                             ContactPairChanges &_changes)
+    {
+      for (auto *list :
+          {&_changes.began, &_changes.ended, &_changes.touching})
+      {
+        std::size_t size{0};
+        _in >> size;
+        list->resize(size);
+        for (auto &entity : *list)
+          _in >> entity;
+      }
+      return _in;
+    }
+  };
+}
+
+namespace components
+{
+  /// \brief Changes in the collisions touched by a collision. Systems which
+  /// only need to know when contacts begin or end create this component on
+  /// a collision which has a ContactSensorData component, and the Physics
+  /// system fills it on every step, so they don't need to scan all contact
+  /// points.
+  using ContactChanges = Component<ContactPairChanges,
+      class ContactChangesTag, serializers::ContactPairChangesSerializer>;
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.ContactChanges", ContactChanges)
+}
+}
+}
+}
+
+#endif
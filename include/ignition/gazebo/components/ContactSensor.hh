@@ -33,7 +33,7 @@ namespace components
   /// \brief TODO(anyone) Substitute with sdf::Contact once that exists?
   /// This is currently the whole <sensor> element.
   using ContactSensor = Component<sdf::ElementPtr, class ContactSensorTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.ContactSensor",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.ContactSensor",
                                 ContactSensor)
 }
 }
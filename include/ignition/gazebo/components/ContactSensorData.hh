@@ -35,9 +35,10 @@ namespace components
   /// \brief A component type that contains a list of contacts.
   using ContactSensorData =
       Component<msgs::Contacts,
-      class ContactSensorDataTag, serializers::MsgSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.ContactSensorData",
-                                ContactSensorData)
+      class ContactSensorDataTag,
+      serializers::DeltaSerializer<serializers::MsgSerializer>>;
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.ContactSensorData", ContactSensorData)
 }
 }
 }
@@ -36,7 +36,7 @@ namespace components
   /// sdf::Camera, information.
   using DepthCamera = Component<sdf::Sensor, class DepthCameraTag,
       serializers::SensorSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.DepthCamera",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.DepthCamera",
       DepthCamera)
 }
 }
@@ -94,7 +94,7 @@ namespace components
   using DetachableJoint =
       Component<DetachableJointInfo, class DetachableJointTag,
                 serializers::DetachableJointInfoSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.DetachableJoint",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.DetachableJoint",
                                 DetachableJoint)
 }
 }
@@ -41,8 +41,8 @@ namespace components
   using ExternalWorldWrenchCmd =
       Component<msgs::Wrench, class ExternalWorldWrenchCmdTag,
       serializers::MsgSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.ExternalWorldWrenchCmd",
-                                ExternalWorldWrenchCmd)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.ExternalWorldWrenchCmd", ExternalWorldWrenchCmd)
 }
 }
 }
@@ -21,6 +21,7 @@
 #include <cstring>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -92,6 +93,8 @@ namespace components
   };
 
   /// \brief A factory that generates a component based on a string type.
+  /// It's safe to use from several threads, since plugin libraries, which
+  /// register their components, may be loaded while entities are created.
   class IGNITION_GAZEBO_VISIBLE Factory
       : public ignition::common::SingletonT<Factory>
   {
@@ -114,6 +117,8 @@ namespace components
         return;
       }
 
+      std::lock_guard<std::mutex> lock(this->mutex);
+
       auto typeHash = ignition::common::hash64(_type);
 
       // Initialize static member variable - we need to set these
@@ -183,6 +188,8 @@ namespace components
         return;
       }
 
+      std::lock_guard<std::mutex> lock(this->mutex);
+
       {
         auto it = this->compsById.find(_typeId);
         if (it != this->compsById.end())
@@ -238,6 +245,7 @@ namespace components
     {
       // Create a new component if a FactoryFn has been assigned to this type.
       std::unique_ptr<components::BaseComponent> comp;
+      std::lock_guard<std::mutex> lock(this->mutex);
       auto it = this->compsById.find(_type);
       if (it != this->compsById.end() && nullptr != it->second)
         comp = it->second->Create();
@@ -253,6 +261,7 @@ namespace components
         const ComponentTypeId &_typeId)
     {
       std::unique_ptr<ComponentStorageBase> storage;
+      std::lock_guard<std::mutex> lock(this->mutex);
       auto it = this->storagesById.find(_typeId);
       if (it != this->storagesById.end() && nullptr != it->second)
         storage = it->second->Create();
@@ -265,6 +274,7 @@ namespace components
     public: std::vector<ComponentTypeId> TypeIds() const
     {
       std::vector<ComponentTypeId> types;
+      std::lock_guard<std::mutex> lock(this->mutex);
 
       // Return the list of all known component types.
       for (const auto &comp : this->compsById)
@@ -277,6 +287,7 @@ namespace components
     /// return True if registered.
     public: bool HasType(ComponentTypeId _typeId)
     {
+      std::lock_guard<std::mutex> lock(this->mutex);
       return this->compsById.find(_typeId) != this->compsById.end();
     }
 
@@ -284,12 +295,16 @@ namespace components
     /// return Unique component name.
     public: std::string Name(ComponentTypeId _typeId) const
     {
+      std::lock_guard<std::mutex> lock(this->mutex);
       if (this->namesById.find(_typeId) != this->namesById.end())
         return namesById.at(_typeId);
 
       return "";
     }
 
+    /// \brief Mutex to protect the maps below.
+    private: mutable std::mutex mutex;
+
     /// \brief A list of registered components where the key is its id.
     ///
     /// Note about compsByName and compsById. The maps store pointers as the
@@ -344,6 +359,26 @@ namespace components
   }; \
   static IgnGazeboComponents##_classname\
     IgnitionGazeboComponentsInitializer##_classname;
+
+  /// \brief Registration macro for the components which come with Gazebo.
+  ///
+  /// It registers the component like IGN_GAZEBO_REGISTER_COMPONENT, and
+  /// also gives it a type ID known at compile time. The ID is a hash of the
+  /// name, returned by a constexpr function which TypeIdOf finds through
+  /// argument dependent lookup, so accessing the component doesn't read the
+  /// static typeId.
+  ///
+  /// \detail A type can only be registered once with this macro, while
+  /// IGN_GAZEBO_REGISTER_COMPONENT can register a type under several names.
+  /// \param[in] _compType Component type name.
+  /// \param[in] _classname Class name for component.
+  #define IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(_compType, _classname) \
+  IGN_GAZEBO_REGISTER_COMPONENT(_compType, _classname) \
+  constexpr ignition::gazebo::ComponentTypeId \
+  IgnGazeboComponentStaticTypeId(const _classname *) \
+  { \
+    return ignition::common::hash64(_compType); \
+  }
 }
 }
 }
@@ -43,9 +43,10 @@ namespace components
 {
   /// \brief This component holds an entity's geometry.
   using Geometry = Component<sdf::Geometry, class GeometryTag,
-                             serializers::GeometrySerializer>;
+      serializers::DeltaSerializer<serializers::GeometrySerializer>>;
 
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Geometry", Geometry)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.Geometry", Geometry)
 
 }
 }
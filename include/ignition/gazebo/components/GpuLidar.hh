@@ -35,7 +35,8 @@ namespace components
   /// sdf::Lidar, information.
   using GpuLidar = Component<sdf::Sensor, class GpuLidarTag,
       serializers::SensorSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.GpuLidar", GpuLidar)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.GpuLidar", GpuLidar)
 }
 }
 }
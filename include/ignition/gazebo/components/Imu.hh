@@ -38,7 +38,7 @@ namespace components
   /// sdf::IMU, information.
   using Imu = Component<sdf::Sensor, class ImuTag,
       serializers::SensorSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Imu", Imu)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Imu", Imu)
 }
 }
 }
@@ -42,7 +42,8 @@ namespace components
   /// \brief This component holds an entity's inertial.
   using Inertial = Component<math::Inertiald, class InertialTag,
                              serializers::InertialSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Inertial", Inertial)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.Inertial", Inertial)
 }
 }
 }
@@ -31,7 +31,7 @@ namespace components
 {
   /// \brief A component that identifies an entity as being a joint.
   using Joint = Component<NoData, class JointTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Joint", Joint)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Joint", Joint)
 }
 }
 }
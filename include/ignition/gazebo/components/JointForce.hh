@@ -36,7 +36,7 @@ namespace components
   /// prismatic).
   using JointForce = Component<std::vector<double>, class JointForceTag,
                                serializers::VectorDoubleSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.JointForce", JointForce)
 }
 }
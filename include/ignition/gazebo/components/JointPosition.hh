@@ -36,8 +36,8 @@ namespace components
   /// The component wraps a std::vector of size equal to the degrees of freedom
   /// of the joint.
   using JointPosition = Component<std::vector<double>, class JointPositionTag,
-                                  serializers::VectorDoubleSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+      serializers::DeltaSerializer<serializers::VectorDoubleSerializer>>;
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.JointPosition", JointPosition)
 }
 }
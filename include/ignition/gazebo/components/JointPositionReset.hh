@@ -39,7 +39,7 @@ namespace components
   using JointPositionReset = Component<std::vector<double>,
                                        class JointPositionResetTag,
                                        serializers::VectorDoubleSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.JointPositionReset", JointPositionReset)
 }
 }
@@ -64,7 +64,7 @@ namespace components
   /// around sdf::JointType
   using JointType = Component<sdf::JointType, class JointTypeTag,
                               serializers::JointTypeSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.JointType", JointType)
 }
 }
@@ -35,8 +35,8 @@ namespace components
 {
   /// \brief Base class which can be extended to add serialization
   using JointVelocity = Component<std::vector<double>, class JointVelocityTag,
-                                  serializers::VectorDoubleSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+      serializers::DeltaSerializer<serializers::VectorDoubleSerializer>>;
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.JointVelocity", JointVelocity)
 }
 }
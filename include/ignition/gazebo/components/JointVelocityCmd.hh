@@ -38,7 +38,7 @@ namespace components
       Component<std::vector<double>, class JointVelocityCmdTag,
                 serializers::VectorDoubleSerializer>;
 
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.JointVelocityCmd", JointVelocityCmd)
 }
 }
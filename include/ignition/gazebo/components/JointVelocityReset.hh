@@ -40,7 +40,7 @@ namespace components
   using JointVelocityReset = Component<std::vector<double>,
                                        class JointVelocityResetTag,
                                        serializers::VectorDoubleSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.JointVelocityReset", JointVelocityReset)
 }
 }
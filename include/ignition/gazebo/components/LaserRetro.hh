@@ -31,7 +31,7 @@ namespace components
 {
   /// \brief A component used to indicate an lidar reflective value
   using LaserRetro = Component<double, class LaserRetroTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.LaserRetro",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.LaserRetro",
       LaserRetro)
 }
 }
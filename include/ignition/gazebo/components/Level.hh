@@ -33,11 +33,11 @@ namespace components
 {
   /// \brief This component identifies an entity as being a level.
   using Level = Component<NoData, class LevelTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Level", Level)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Level", Level)
 
   /// \brief This component identifies an entity as being a default level.
   using DefaultLevel = Component<NoData, class DefaultLevelTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.DefaultLevel",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.DefaultLevel",
       DefaultLevel)
 }
 }
@@ -33,7 +33,7 @@ namespace components
 {
   /// \brief A component that holds the buffer setting of a level's geometry
   using LevelBuffer = Component<double, class LevelBufferTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.LevelBuffer",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.LevelBuffer",
       LevelBuffer)
 }
 }
@@ -81,8 +81,8 @@ namespace components
       Component<std::set<std::string>, class LevelEntityNamesTag,
                 serializers::LevelEntityNamesSerializer>;
 
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.LevelEntityNames",
-      LevelEntityNames)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.LevelEntityNames", LevelEntityNames)
 }
 }
 }
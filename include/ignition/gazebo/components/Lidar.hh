@@ -35,7 +35,7 @@ namespace components
   /// sdf::Lidar, information.
   using Lidar = Component<sdf::Sensor, class LidarTag,
       serializers::SensorSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Lidar", Lidar)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Lidar", Lidar)
 }
 }
 }
@@ -46,7 +46,7 @@ namespace components
   /// element](http://sdformat.org/spec?ver=1.6&elem=light).
   using Light =
       Component<sdf::Light, class LightTag, serializers::LightSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Light", Light)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Light", Light)
 }
 }
 }
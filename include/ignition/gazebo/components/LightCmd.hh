@@ -39,7 +39,7 @@ namespace components
   /// entity in the world frame represented by msgs::Light.
   using LightCmd = Component<ignition::msgs::Light,
     class LightCmdTag, serializers::MsgSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.LightCmd",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.LightCmd",
       LightCmd)
 }
 }
@@ -37,15 +37,15 @@ namespace components
   /// represented by ignition::math::Vector3d.
   using LinearAcceleration =
     Component<math::Vector3d, class LinearAccelerationTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.LinearAcceleration",
-      LinearAcceleration)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.LinearAcceleration", LinearAcceleration)
 
   /// \brief A component type that contains linear acceleration of an entity
   /// in the world frame represented by ignition::math::Vector3d.
   using WorldLinearAcceleration =
       Component<math::Vector3d, class WorldLinearAccelerationTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.WorldLinearAcceleration",
-      WorldLinearAcceleration)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.WorldLinearAcceleration", WorldLinearAcceleration)
 }
 }
 }
@@ -33,14 +33,14 @@ namespace components
   /// \brief A component type that contains linear velocity of an entity
   /// represented by ignition::math::Vector3d.
   using LinearVelocity = Component<math::Vector3d, class LinearVelocityTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.LinearVelocity", LinearVelocity)
 
   /// \brief A component type that contains linear velocity of an entity in the
   /// world frame represented by ignition::math::Vector3d.
   using WorldLinearVelocity =
       Component<math::Vector3d, class WorldLinearVelocityTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.WorldLinearVelocity", WorldLinearVelocity)
 }
 }
@@ -36,8 +36,8 @@ namespace components
   /// by applying transformations and adding noise.
   using LinearVelocitySeed =
       Component<math::Vector3d, class LinearVelocitySeedTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.LinearVelocitySeed",
-                                LinearVelocitySeed)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.LinearVelocitySeed", LinearVelocitySeed)
 
   /// \brief A component type that contains linear velocity seed of an entity in
   /// the world frame represented by ignition::math::Vector3d. This seed can
@@ -45,8 +45,8 @@ namespace components
   /// noise.
   using WorldLinearVelocitySeed =
       Component<math::Vector3d, class WorldLinearVelocitySeedTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.WorldLinearVelocitySeed",
-                                WorldLinearVelocitySeed)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.WorldLinearVelocitySeed", WorldLinearVelocitySeed)
 }
 }
 }
@@ -31,7 +31,7 @@ namespace components
 {
   /// \brief A component that identifies an entity as being a link.
   using Link = Component<NoData, class LinkTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Link", Link)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Link", Link)
 }
 }
 }
@@ -38,8 +38,8 @@ namespace components
   /// being loaded
   using LogPlaybackStatistics = Component<ignition::msgs::LogPlaybackStatistics,
       class LogPlaybackStatisticsTag, serializers::MsgSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.LogPlaybackStatistics",
-      LogPlaybackStatistics)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.LogPlaybackStatistics", LogPlaybackStatistics)
 }
 }
 }
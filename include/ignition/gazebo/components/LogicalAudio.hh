@@ -292,8 +292,8 @@ namespace components
   using LogicalAudioSource = Component<logical_audio::Source,
         class LogicalAudioSourceTag,
         serializers::LogicalAudioSourceSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.LogicalAudioSource",
-      LogicalAudioSource)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.LogicalAudioSource", LogicalAudioSource)
 }
 
 namespace components
@@ -303,7 +303,7 @@ namespace components
   using LogicalAudioSourcePlayInfo = Component<logical_audio::SourcePlayInfo,
         class LogicalAudioSourcePlayInfoTag,
         serializers::LogicalAudioSourcePlayInfoSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.LogicalAudioSourcePlayInfo",
       LogicalAudioSourcePlayInfo)
 }
@@ -315,8 +315,8 @@ namespace components
   using LogicalMicrophone = Component<logical_audio::Microphone,
         class LogicalMicrophoneTag,
         serializers::LogicalMicrophoneSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.LogicalMicrophone",
-      LogicalMicrophone)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.LogicalMicrophone", LogicalMicrophone)
 }
 }
 }
@@ -33,7 +33,7 @@ namespace components
   /// \brief TODO(anyone) Substitute with sdf::LogicalCamera once that exists?
   /// This is currently the whole <sensor> element.
   using LogicalCamera = Component<sdf::ElementPtr, class LogicalCameraTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.LogicalCamera",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.LogicalCamera",
       LogicalCamera)
 }
 }
@@ -39,7 +39,7 @@ namespace components
   using Magnetometer = Component<sdf::Sensor, class MagnetometerTag,
                                  serializers::SensorSerializer>;
 
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.Magnetometer", Magnetometer)
 }
 }
@@ -42,7 +42,8 @@ namespace components
   /// \brief This component holds an entity's material.
   using Material = Component<sdf::Material, class MaterialTag,
                              serializers::MaterialSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Material", Material)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.Material", Material)
 }
 }
 }
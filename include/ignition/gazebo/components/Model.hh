@@ -33,11 +33,12 @@ namespace components
 {
   /// \brief A component that identifies an entity as being a model.
   using Model = Component<NoData, class ModelTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Model", Model)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Model", Model)
 
   /// \brief A component that holds the model's SDF DOM
   using ModelSdf = Component<sdf::Model, class ModelTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.ModelSdf", ModelSdf)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.ModelSdf", ModelSdf)
 }
 }
 }
@@ -35,7 +35,7 @@ namespace components
   /// of scoped names nor does it care about uniqueness.
   using Name = Component<std::string, class NameTag,
       serializers::StringSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Name", Name)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Name", Name)
 }
 }
 }
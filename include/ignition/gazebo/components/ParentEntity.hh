@@ -39,7 +39,7 @@ namespace components
   /// edited by hand, and instead, entities should be created using
   /// the `gazebo::SdfEntityCreator` class.
   using ParentEntity = Component<Entity, class ParentEntityTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.ParentEntity", ParentEntity)
 }
 }
@@ -34,7 +34,7 @@ namespace components
   /// \brief Holds the name of the entity's parent link.
   using ParentLinkName = Component<std::string, class ParentLinkNameTag,
       serializers::StringSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
     "ign_gazebo_components.ParentLinkName", ParentLinkName)
 }
 }
@@ -35,15 +35,15 @@ namespace components
   using ParticleEmitter = Component<msgs::ParticleEmitter,
         class ParticleEmitterTag,
         serializers::MsgSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.ParticleEmitter",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.ParticleEmitter",
       ParticleEmitter)
 
   /// \brief A component that contains a particle emitter command.
   using ParticleEmitterCmd = Component<msgs::ParticleEmitter,
         class ParticleEmitterCmdTag,
         serializers::MsgSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.ParticleEmitterCmd",
-      ParticleEmitterCmd)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.ParticleEmitterCmd", ParticleEmitterCmd)
 }
 }
 }
@@ -33,7 +33,8 @@ namespace components
 {
   /// \brief This component identifies an entity as being a performer.
   using Performer = Component<NoData, class PerformerTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Performer", Performer)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.Performer", Performer)
 }
 }
 }
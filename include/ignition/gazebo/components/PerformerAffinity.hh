@@ -38,8 +38,8 @@ namespace components
   /// this performer is associated with.
   using PerformerAffinity = Component<std::string, class PerformerAffinityTag,
       serializers::StringSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.PerformerAffinity",
-      PerformerAffinity)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.PerformerAffinity", PerformerAffinity)
 }
 }
 }
@@ -75,7 +75,7 @@ namespace components
   /// \brief Holds all the levels which a performer is in.
   using PerformerLevels = Component<std::set<Entity>, class PerformerLevelsTag,
                                     serializers::PerformerLevelsSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.PerformerLevels",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.PerformerLevels",
       PerformerLevels)
 }
 }
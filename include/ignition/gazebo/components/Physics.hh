@@ -46,7 +46,7 @@ namespace components
   /// the World entity.
   using Physics = Component<sdf::Physics, class PhysicsTag,
       serializers::PhysicsSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Physics",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Physics",
       Physics)
 }
 }
@@ -36,7 +36,7 @@ namespace components
   /// \brief A component type that contains the physics properties of
   /// the World entity.
   using PhysicsCmd = Component<msgs::Physics, class PhysicsCmdTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.PhysicsCmd",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.PhysicsCmd",
       PhysicsCmd)
 }
 }
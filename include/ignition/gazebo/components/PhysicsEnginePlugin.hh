@@ -34,8 +34,8 @@ namespace components
   /// \brief Holds the physics engine shared library.
   using PhysicsEnginePlugin = Component<std::string,
       class PhysicsEnginePluginTag, serializers::StringSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.PhysicsEnginePlugin",
-      PhysicsEnginePlugin)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.PhysicsEnginePlugin", PhysicsEnginePlugin)
 }
 }
 }
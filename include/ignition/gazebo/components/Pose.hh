@@ -33,19 +33,19 @@ namespace components
   /// \brief A component type that contains pose, ignition::math::Pose3d,
   /// information.
   using Pose = Component<ignition::math::Pose3d, class PoseTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Pose", Pose)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Pose", Pose)
 
   /// \brief A component type that contains pose, ignition::math::Pose3d,
   /// information in world frame.
   using WorldPose = Component<ignition::math::Pose3d, class WorldPoseTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.WorldPose", WorldPose)
 
   /// \brief A component type that contains pose, ignition::math::Pose3d,
   /// information within a trajectory.
   using TrajectoryPose =
       Component<ignition::math::Pose3d, class TrajectoryPoseTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.TrajectoryPose", TrajectoryPose)
 }
 }
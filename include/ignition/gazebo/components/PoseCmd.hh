@@ -36,7 +36,7 @@ namespace components
   /// \brief A component type that contains commanded pose of an
   /// entity in the world frame represented by ignition::math::Pose3d.
   using WorldPoseCmd = Component<math::Pose3d, class WorldPoseCmdTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.WorldPoseCmd",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.WorldPoseCmd",
       WorldPoseCmd)
 }
 }
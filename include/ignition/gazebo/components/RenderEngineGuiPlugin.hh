@@ -34,8 +34,8 @@ namespace components
   /// \brief Holds the render engine gui shared library.
   using RenderEngineGuiPlugin = Component<std::string,
       class RenderEngineGuiPluginTag, serializers::StringSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.RenderEngineGuiPlugin",
-      RenderEngineGuiPlugin)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.RenderEngineGuiPlugin", RenderEngineGuiPlugin)
 }
 }
 }
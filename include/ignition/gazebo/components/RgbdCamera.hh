@@ -36,7 +36,8 @@ namespace components
   /// sdf::Camera, information.
   using RgbdCamera = Component<sdf::Sensor, class RgbdCameraTag,
       serializers::SensorSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.RgbdCamera", RgbdCamera)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.RgbdCamera", RgbdCamera)
 }
 }
 }
@@ -43,7 +43,7 @@ namespace components
   /// \brief This component holds scene properties of the world.
   using Scene =
       Component<sdf::Scene, class SceneTag, serializers::SceneSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.Scene", Scene)
 }
 }
@@ -32,7 +32,7 @@ namespace components
   /// \brief A component used to hold a model's self collide property.
   using SelfCollide = Component<bool, class SelfCollideTag>;
 
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.SelfCollide",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.SelfCollide",
                                 SelfCollide)
 }
 }
@@ -33,7 +33,7 @@ namespace components
 {
   /// \brief A component that identifies an entity as being a link.
   using Sensor = Component<NoData, class SensorTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Sensor", Sensor)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Sensor", Sensor)
 
   /// \brief Name of the transport topic where a sensor is publishing its
   /// data.
@@ -41,7 +41,7 @@ namespace components
   /// prefix common to all topics of that sensor.
   using SensorTopic = Component<std::string, class SensorTopicTag,
       serializers::StringSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.SensorTopic",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.SensorTopic",
       SensorTopic)
 }
 }
@@ -20,7 +20,10 @@
 #include <google/protobuf/message_lite.h>
 #include <ignition/msgs/double_v.pb.h>
 
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <sdf/Sensor.hh>
 
@@ -53,6 +56,14 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 ///                                                DataType &_data)
 ///     };
 /// \endcode
+/// It may also implement buffer versions, which state messages use to
+/// avoid a stream per component. See traits::HasBufferSerializer.
+/// \code
+///       public: static void SerializeToBuffer(std::string &_buffer,
+///                                             const DataType &_data);
+///       public: static void DeserializeFromBuffer(std::string_view _bytes,
+///                                                 DataType &_data);
+/// \endcode
 
 namespace serializers
 {
@@ -96,14 +107,40 @@ namespace serializers
       _data = ignition::gazebo::convert<DataType>(msg);
       return _in;
     }
+
+    /// \brief Serialization into a buffer.
+    /// \param[in, out] _buffer Buffer to append to.
+    /// \param[in] _data Data to serialize.
+    public: static void SerializeToBuffer(std::string &_buffer,
+                                          const DataType &_data)
+    {
+      ignition::gazebo::convert<MsgType>(_data).AppendToString(&_buffer);
+    }
+
+    /// \brief Deserialization from a buffer.
+    /// \param[in] _bytes Serialized data.
+    /// \param[out] _data Data to populate.
+    public: static void DeserializeFromBuffer(std::string_view _bytes,
+                                              DataType &_data)
+    {
+      MsgType msg;
+      msg.ParseFromArray(_bytes.data(), static_cast<int>(_bytes.size()));
+      _data = ignition::gazebo::convert<DataType>(msg);
+    }
   };
 
   /// \brief Common serializer for sensors
   using SensorSerializer = ComponentToMsgSerializer<sdf::Sensor, msgs::Sensor>;
 
   /// \brief Serializer for components that hold `std::vector<double>`.
+  /// The values are written as raw bytes after their count. Data serialized
+  /// as a msgs::Double_V by older versions can still be deserialized, since
+  /// a protobuf message never starts with the marker byte.
   class VectorDoubleSerializer
   {
+    /// \brief First byte of binary serialized data.
+    public: static constexpr char kMarker{'\0'};
+
     /// \brief Serialization
     /// \param[in] _out Output stream.
     /// \param[in] _vec Vector to stream
@@ -111,9 +148,11 @@ namespace serializers
     public: static std::ostream &Serialize(std::ostream &_out,
                                            const std::vector<double> &_vec)
     {
-      ignition::msgs::Double_V msg;
-      *msg.mutable_data() = {_vec.begin(), _vec.end()};
-      msg.SerializeToOstream(&_out);
+      const uint64_t size = _vec.size();
+      _out.put(kMarker);
+      _out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+      _out.write(reinterpret_cast<const char *>(_vec.data()),
+          static_cast<std::streamsize>(size * sizeof(double)));
       return _out;
     }
 
@@ -124,12 +163,75 @@ namespace serializers
     public: static std::istream &Deserialize(std::istream &_in,
                                              std::vector<double> &_vec)
     {
+      if (_in.peek() == kMarker)
+      {
+        _in.get();
+        uint64_t size{0};
+        if (!_in.read(reinterpret_cast<char *>(&size), sizeof(size)))
+          return _in;
+
+        // Don't trust the size of truncated or corrupt data. Components are
+        // always deserialized from memory, so all the data is available.
+        const auto available = _in.rdbuf()->in_avail();
+        if (available < 0 ||
+            size > static_cast<uint64_t>(available) / sizeof(double))
+        {
+          _in.setstate(std::ios::failbit);
+          return _in;
+        }
+
+        _vec.resize(size);
+        _in.read(reinterpret_cast<char *>(_vec.data()),
+            static_cast<std::streamsize>(size * sizeof(double)));
+        return _in;
+      }
+
       ignition::msgs::Double_V msg;
       msg.ParseFromIstream(&_in);
 
       _vec = {msg.data().begin(), msg.data().end()};
       return _in;
     }
+
+    /// \brief Serialization into a buffer.
+    /// \param[in, out] _buffer Buffer to append to.
+    /// \param[in] _vec Vector to serialize.
+    public: static void SerializeToBuffer(std::string &_buffer,
+                                          const std::vector<double> &_vec)
+    {
+      const uint64_t size = _vec.size();
+      _buffer.push_back(kMarker);
+      _buffer.append(reinterpret_cast<const char *>(&size), sizeof(size));
+      _buffer.append(reinterpret_cast<const char *>(_vec.data()),
+          size * sizeof(double));
+    }
+
+    /// \brief Deserialization from a buffer.
+    /// \param[in] _bytes Serialized data.
+    /// \param[out] _vec Vector to populate.
+    public: static void DeserializeFromBuffer(std::string_view _bytes,
+                                              std::vector<double> &_vec)
+    {
+      if (!_bytes.empty() && _bytes[0] == kMarker)
+      {
+        uint64_t size{0};
+        if (_bytes.size() < 1 + sizeof(size))
+          return;
+        std::memcpy(&size, _bytes.data() + 1, sizeof(size));
+        _bytes.remove_prefix(1 + sizeof(size));
+
+        if (size > _bytes.size() / sizeof(double))
+          return;
+
+        _vec.resize(size);
+        std::memcpy(_vec.data(), _bytes.data(), size * sizeof(double));
+        return;
+      }
+
+      ignition::msgs::Double_V msg;
+      msg.ParseFromArray(_bytes.data(), static_cast<int>(_bytes.size()));
+      _vec = {msg.data().begin(), msg.data().end()};
+    }
   };
 
   /// \brief Serializer for components that hold protobuf messages.
@@ -156,6 +258,41 @@ namespace serializers
       _msg.ParseFromIstream(&_in);
       return _in;
     }
+
+    /// \brief Serialization into a buffer.
+    /// \param[in, out] _buffer Buffer to append to.
+    /// \param[in] _msg Message to serialize.
+    public: static void SerializeToBuffer(std::string &_buffer,
+        const google::protobuf::Message &_msg)
+    {
+      _msg.AppendToString(&_buffer);
+    }
+
+    /// \brief Deserialization from a buffer.
+    /// \param[in] _bytes Serialized data.
+    /// \param[out] _msg Message to populate.
+    public: static void DeserializeFromBuffer(std::string_view _bytes,
+        google::protobuf::Message &_msg)
+    {
+      _msg.ParseFromArray(_bytes.data(), static_cast<int>(_bytes.size()));
+    }
+  };
+
+  /// \brief Wraps another serializer to mark the components using it as
+  /// large enough to be worth sending as deltas against their previous
+  /// value, instead of in full, whenever they change. See
+  /// StateDeltaEncoder. Serialization itself is unchanged.
+  /// \code
+  ///   using JointPosition = Component<std::vector<double>,
+  ///       class JointPositionTag,
+  ///       DeltaSerializer<serializers::VectorDoubleSerializer>>;
+  /// \endcode
+  /// \tparam Serializer Serializer to wrap.
+  template <typename Serializer>
+  class DeltaSerializer : public Serializer
+  {
+    /// \brief Marks the serializer for delta encoding.
+    public: static constexpr bool kDeltaEncoded{true};
   };
 
   /// \brief Serializer for components that hold std::string.
@@ -182,6 +319,24 @@ namespace serializers
       _data = std::string(std::istreambuf_iterator<char>(_in), {});
       return _in;
     }
+
+    /// \brief Serialization into a buffer.
+    /// \param[in, out] _buffer Buffer to append to.
+    /// \param[in] _data Data to serialize.
+    public: static void SerializeToBuffer(std::string &_buffer,
+        const std::string &_data)
+    {
+      _buffer.append(_data);
+    }
+
+    /// \brief Deserialization from a buffer.
+    /// \param[in] _bytes Serialized data.
+    /// \param[out] _data Data to populate.
+    public: static void DeserializeFromBuffer(std::string_view _bytes,
+        std::string &_data)
+    {
+      _data.assign(_bytes.data(), _bytes.size());
+    }
   };
 }
 }
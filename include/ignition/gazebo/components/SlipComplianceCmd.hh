@@ -40,8 +40,8 @@ namespace components
   /// direction 2 (fdir2) respectively.
   using SlipComplianceCmd =
     Component<std::vector<double>, class SlipComplianceCmdTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.SlipComplianceCmd ",
-      SlipComplianceCmd)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.SlipComplianceCmd ", SlipComplianceCmd)
 }
 }
 }
@@ -37,7 +37,7 @@ namespace components
   using SourceFilePath = Component<std::string, class SourceFilePathTag,
       serializers::StringSerializer>;
 
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.SourceFilePath",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.SourceFilePath",
                                 SourceFilePath)
 }
 }
@@ -33,12 +33,12 @@ namespace components
 {
   /// \brief A component that stores temperature data in Kelvin
   using Temperature = Component<math::Temperature, class TemperatureTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Temperature",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Temperature",
       Temperature)
 
   /// \brief A component that stores temperature linear resolution in Kelvin
   using TemperatureLinearResolution = Component<double, class TemperatureTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT(
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
       "ign_gazebo_components.TemperatureLinearResolution",
       TemperatureLinearResolution)
 }
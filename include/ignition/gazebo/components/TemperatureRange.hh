@@ -89,8 +89,8 @@ namespace components
   /// \brief A component that stores a temperature range in kelvin
   using TemperatureRange = Component<TemperatureRangeInfo,
         class TemperatureRangeTag, serializers::TemperatureRangeInfoSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.TemperatureRange",
-      TemperatureRange)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.TemperatureRange", TemperatureRange)
 }
 }
 }
@@ -36,7 +36,7 @@ namespace components
   /// sdf::Sensor, information.
   using ThermalCamera = Component<sdf::Sensor, class ThermalCameraTag,
       serializers::SensorSerializer>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.ThermalCamera",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.ThermalCamera",
       ThermalCamera)
 }
 }
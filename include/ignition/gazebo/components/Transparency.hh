@@ -33,7 +33,7 @@ namespace components
   /// e.g. visual entities. Value is in the range from 0 (opaque) to
   /// 1 (transparent).
   using Transparency = Component<float, class TransparencyTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Transparency",
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Transparency",
       Transparency)
 }
 }
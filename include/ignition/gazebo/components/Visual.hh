@@ -31,7 +31,7 @@ namespace components
 {
   /// \brief A component that identifies an entity as being a visual.
   using Visual = Component<NoData, class VisualTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Visual", Visual)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Visual", Visual)
 }
 }
 }
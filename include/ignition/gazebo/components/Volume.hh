@@ -32,7 +32,7 @@ namespace components
   /// \brief A volume component where the units are m^3.
   /// Double value indicates volume of an entity.
   using Volume = Component<double, class VolumeTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Volume", Volume)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Volume", Volume)
 }
 }
 }
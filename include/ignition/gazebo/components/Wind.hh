@@ -31,7 +31,7 @@ namespace components
 {
   /// \brief A component that identifies an entity as being a wind.
   using Wind = Component<NoData, class WindTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Wind", Wind)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.Wind", Wind)
 }
 }
 }
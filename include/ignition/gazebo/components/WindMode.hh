@@ -31,7 +31,8 @@ namespace components
 {
   /// \brief A component used to indicate whether an entity is affected by wind.
   using WindMode = Component<bool, class WindModeTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.WindMode", WindMode)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.WindMode", WindMode)
 }
 }
 }
@@ -33,11 +33,12 @@ namespace components
 {
   /// \brief A component that identifies an entity as being a world.
   using World = Component<NoData, class WorldTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.World", World)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT("ign_gazebo_components.World", World)
 
   /// \brief A component that holds the world's SDF DOM
   using WorldSdf = Component<sdf::World, class WorldTag>;
-  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.WorldSdf", WorldSdf)
+  IGN_GAZEBO_REGISTER_BUILTIN_COMPONENT(
+      "ign_gazebo_components.WorldSdf", WorldSdf)
 }
 }
 }
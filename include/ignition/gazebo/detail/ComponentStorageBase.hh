@@ -17,7 +17,9 @@
 #ifndef IGNITION_GAZEBO_DETAIL_COMPONENTSTORAGEBASE_HH_
 #define IGNITION_GAZEBO_DETAIL_COMPONENTSTORAGEBASE_HH_
 
-#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <utility>
 #include <vector>
 #include "ignition/gazebo/components/Component.hh"
@@ -30,10 +32,28 @@ namespace ignition
   {
     // Inline bracket to help doxygen filtering.
     inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Log2 of the default number of components which component
+    /// storages allocate at once.
+    const std::size_t kDefaultComponentBlockShift{8};
+
+    /// \brief Containers are compacted once they hold less than
+    /// 1/kCompactRatio of what their allocated memory can hold.
+    const std::size_t kCompactRatio{4};
+
     //
     /// \brief All component instances of the same type are stored
     /// squentially in memory. This is a base class for storing components
     /// of a particular type.
+    ///
+    /// Storages don't lock. Creating and removing components requires
+    /// exclusive access to the EntityComponentManager, which the simulation
+    /// runner guarantees during the PreUpdate and Update phases. During
+    /// PostUpdate, systems only get a const EntityComponentManager, so
+    /// concurrent reads never overlap with writes and can be lock-free.
+    ///
+    /// The storage also tracks the change state of each component, densely
+    /// stored next to the components, so marking a change is constant time
+    /// and clearing all changes is a single fill.
     class IGNITION_GAZEBO_HIDDEN ComponentStorageBase
     {
       /// \brief Constructor
@@ -44,9 +64,9 @@ namespace ignition
 
       /// \brief Create a new component using the provided data.
       /// \param[in] _data Data used to construct the component.
-      /// \return Id of the new component, and whether the components array
-      /// was expanded. kComponentIdInvalid is returned
-      /// if the component could not be created.
+      /// \return Id of the new component, and whether existing components
+      /// were moved in memory to make room for it. kComponentIdInvalid is
+      /// returned if the component could not be created.
       public: virtual std::pair<ComponentId, bool> Create(
                   const components::BaseComponent *_data) = 0;
 
@@ -55,9 +75,71 @@ namespace ignition
       /// \return True if the component was removed.
       public: virtual bool Remove(const ComponentId _id) = 0;
 
+      /// \brief Remove multiple components in a single pass. This is
+      /// preferred to calling Remove repeatedly when removing many entities.
+      /// \param[in] _ids Ids of the components to remove. Ids which aren't
+      /// found are ignored.
+      /// \return Number of components removed.
+      public: virtual std::size_t Remove(
+                  const std::vector<ComponentId> &_ids) = 0;
+
       /// \brief Remove all components
       public: virtual void RemoveAll() = 0;
 
+      /// \brief Set the number of components allocated at once. Blocks
+      /// are never reallocated, so larger blocks mean fewer allocations and
+      /// smaller ones less unused memory. This can only be set before the
+      /// first component is created.
+      /// \param[in] _size Number of components per block, rounded up to a
+      /// power of two.
+      /// \return True if the size was set.
+      public: virtual bool SetBlockSize(const std::size_t _size) = 0;
+
+      /// \brief Get the number of components allocated at once.
+      /// \return Number of components per block.
+      public: virtual std::size_t BlockSize() const = 0;
+
+      /// \brief Get the number of components the allocated blocks can hold.
+      /// \return Number of components.
+      public: virtual std::size_t Capacity() const = 0;
+
+      /// \brief Get the bytes allocated for components. Memory which
+      /// components allocate themselves, like the contents of a string, isn't
+      /// included.
+      /// \return Number of bytes.
+      public: virtual std::size_t ComponentBytes() const = 0;
+
+      /// \brief Release memory left unused after many components were
+      /// removed, such as empty blocks and the capacity of the containers
+      /// mapping ids to slots. Containers are only shrunk below
+      /// 1/kCompactRatio occupancy, since shrinking copies them.
+      /// \return True if any memory was released.
+      public: virtual bool Compact() = 0;
+
+      /// \brief Get the number of components.
+      /// \return Number of components.
+      public: std::size_t Size() const
+      {
+        return this->slotIds.size();
+      }
+
+      /// \brief Get the bytes allocated to map component ids to slots.
+      /// They grow with the number of ids ever handed out, since ids aren't
+      /// reused.
+      /// \return Number of bytes.
+      public: std::size_t IndexBytes() const
+      {
+        return this->idSlots.capacity() * sizeof(std::size_t) +
+            this->slotIds.capacity() * sizeof(ComponentId);
+      }
+
+      /// \brief Get the bytes allocated to track component changes.
+      /// \return Number of bytes.
+      public: std::size_t ChangeTrackingBytes() const
+      {
+        return this->slotStates.capacity() * sizeof(uint8_t);
+      }
+
       /// \brief Get a component based on an id.
       /// \param[in] _id Id of the component to get.
       /// \return A pointer to the component, or nullptr if the component
@@ -76,11 +158,256 @@ namespace ignition
       /// \return First component or nullptr if there are no components.
       public: virtual components::BaseComponent *First() = 0;
 
-      /// \brief Mutex used to prevent data corruption.
-      protected: mutable std::mutex mutex;
+      /// \brief Get the number of times components have been moved in
+      /// memory, invalidating pointers to them. Callers which cache component
+      /// pointers can compare this value to know when to refresh them.
+      /// \return Number of relocations since the storage was created.
+      public: uint64_t Relocations() const
+      {
+        return this->relocations;
+      }
+
+      /// \brief Get the change state of a component.
+      /// \param[in] _id Id of the component.
+      /// \return The component's state, or NoChange if the component could
+      /// not be found.
+      public: ComponentState State(const ComponentId _id) const
+      {
+        const std::size_t slot = this->Slot(_id);
+        if (slot == kInvalidSlot)
+          return ComponentState::NoChange;
+
+        return static_cast<ComponentState>(this->slotStates[slot]);
+      }
+
+      /// \brief Set the change state of a component.
+      /// \param[in] _id Id of the component.
+      /// \param[in] _state New state.
+      /// \return True if the component was found.
+      public: bool SetState(const ComponentId _id, const ComponentState _state)
+      {
+        const std::size_t slot = this->Slot(_id);
+        if (slot == kInvalidSlot)
+          return false;
+
+        this->SetSlotState(slot, _state);
+        return true;
+      }
+
+      /// \brief Mark all components as unchanged.
+      public: void SetAllUnchanged()
+      {
+        if (this->oneTimeChangeCount == 0 && this->periodicChangeCount == 0)
+          return;
+
+        std::fill(this->slotStates.begin(), this->slotStates.end(),
+            static_cast<uint8_t>(ComponentState::NoChange));
+        this->oneTimeChangeCount = 0;
+        this->periodicChangeCount = 0;
+      }
+
+      /// \brief Get whether any component has a one-time change.
+      /// \return True if there's at least one one-time change.
+      public: bool HasOneTimeChanges() const
+      {
+        return this->oneTimeChangeCount > 0;
+      }
+
+      /// \brief Get whether any component has a periodic change.
+      /// \return True if there's at least one periodic change.
+      public: bool HasPeriodicChanges() const
+      {
+        return this->periodicChangeCount > 0;
+      }
+
+      /// \brief Get whether the values of these components are indexed by
+      /// the EntityComponentManager, which must then be told when they
+      /// change.
+      /// \return True if the values are indexed.
+      public: bool ValueIndexed() const
+      {
+        return this->valueIndexed;
+      }
+
+      /// \brief Set whether the values of these components are indexed.
+      /// \param[in] _indexed True if the values are indexed.
+      public: void SetValueIndexed(const bool _indexed)
+      {
+        this->valueIndexed = _indexed;
+      }
+
+      /// \brief Set the change state of the component at a slot, keeping
+      /// the change counts up to date.
+      /// \param[in] _slot Slot index.
+      /// \param[in] _state New state.
+      protected: void SetSlotState(const std::size_t _slot,
+                                   const ComponentState _state)
+      {
+        this->CountState(this->slotStates[_slot], -1);
+        this->slotStates[_slot] = static_cast<uint8_t>(_state);
+        this->CountState(this->slotStates[_slot], 1);
+      }
+
+      /// \brief Add a slot for a new component, which starts with a
+      /// one-time change.
+      /// \param[in] _id Id of the new component.
+      /// \param[in] _slot Slot index of the new component, which must be
+      /// the current number of slots.
+      protected: void AddSlot(const ComponentId _id, const std::size_t _slot)
+      {
+        // Ids are handed out in order, so this only appends
+        const std::size_t index = static_cast<std::size_t>(_id - this->idBase);
+        if (index >= this->idSlots.size())
+          this->idSlots.resize(index + 1, kInvalidSlot);
+        this->idSlots[index] = _slot;
+        this->slotIds.push_back(_id);
+        this->slotStates.push_back(
+            static_cast<uint8_t>(ComponentState::OneTimeChange));
+        ++this->oneTimeChangeCount;
+      }
+
+      /// \brief Get the slot of a component.
+      /// \param[in] _id Id of the component.
+      /// \return The slot, or kInvalidSlot if there's no such component.
+      protected: std::size_t Slot(const ComponentId _id) const
+      {
+        if (_id < this->idBase)
+          return kInvalidSlot;
+        const std::size_t index = static_cast<std::size_t>(_id - this->idBase);
+        if (index >= this->idSlots.size())
+          return kInvalidSlot;
+        return this->idSlots[index];
+      }
+
+      /// \brief Remove the slot of a component, moving the last slot into
+      /// its place. The caller must move the component data the same way.
+      /// \param[in] _id Id of the removed component.
+      /// \param[in] _slot Slot of the removed component.
+      protected: void RemoveSlot(const ComponentId _id, const std::size_t _slot)
+      {
+        const std::size_t last = this->slotIds.size() - 1;
+
+        this->CountState(this->slotStates[_slot], -1);
+
+        if (_slot != last)
+        {
+          const ComponentId movedId = this->slotIds[last];
+          this->slotIds[_slot] = movedId;
+          this->slotStates[_slot] = this->slotStates[last];
+          this->idSlots[movedId - this->idBase] = _slot;
+        }
+
+        this->slotIds.pop_back();
+        this->slotStates.pop_back();
+        this->idSlots[_id - this->idBase] = kInvalidSlot;
+      }
+
+      /// \brief Remove all slots.
+      protected: void RemoveAllSlots()
+      {
+        this->idCounter = 0;
+        this->idBase = 0;
+        this->idSlots.clear();
+        this->slotIds.clear();
+        this->slotStates.clear();
+        this->oneTimeChangeCount = 0;
+        this->periodicChangeCount = 0;
+      }
+
+      /// \brief Release the memory of slots of removed components. Ids below
+      /// the lowest id still in use, and above the highest, are dropped from
+      /// idSlots.
+      /// \return True if any memory was released.
+      protected: bool CompactSlots()
+      {
+        bool released{false};
+
+        if (this->slotIds.empty())
+        {
+          released = this->idSlots.capacity() > 0;
+          this->idBase = this->idCounter;
+          std::vector<std::size_t>().swap(this->idSlots);
+        }
+        else
+        {
+          const auto [lowest, highest] = std::minmax_element(
+              this->slotIds.begin(), this->slotIds.end());
+          const std::size_t first =
+              static_cast<std::size_t>(*lowest - this->idBase);
+          const std::size_t last =
+              static_cast<std::size_t>(*highest - this->idBase);
+          if ((last - first + 1) * kCompactRatio < this->idSlots.capacity())
+          {
+            std::vector<std::size_t>(this->idSlots.begin() + first,
+                this->idSlots.begin() + last + 1).swap(this->idSlots);
+            this->idBase = *lowest;
+            released = true;
+          }
+        }
+
+        if (this->slotIds.size() * kCompactRatio < this->slotIds.capacity())
+        {
+          this->slotIds.shrink_to_fit();
+          this->slotStates.shrink_to_fit();
+          released = true;
+        }
+        return released;
+      }
+
+      /// \brief Update the change counts for a state.
+      /// \param[in] _state State, as stored in slotStates.
+      /// \param[in] _delta 1 to count the state, -1 to uncount it.
+      private: void CountState(const uint8_t _state, const int _delta)
+      {
+        if (_state == static_cast<uint8_t>(ComponentState::OneTimeChange))
+          this->oneTimeChangeCount += _delta;
+        else if (_state == static_cast<uint8_t>(ComponentState::PeriodicChange))
+          this->periodicChangeCount += _delta;
+      }
+
+      /// \brief Number of times components have been moved in memory.
+      protected: uint64_t relocations{0};
+
+      /// \brief The id counter is used to get unique ids within this
+      /// storage class.
+      protected: ComponentId idCounter = 0;
+
+      /// \brief Id of the first entry of idSlots. Ids below it were removed.
+      protected: ComponentId idBase = 0;
+
+      /// \brief Marks ids without a slot in idSlots.
+      protected: static constexpr std::size_t kInvalidSlot{
+          std::numeric_limits<std::size_t>::max()};
+
+      /// \brief Slot index of each ComponentId from idBase, or kInvalidSlot
+      /// if the component was removed. Ids are assigned sequentially, so this
+      /// is indexed by id instead of hashing it.
+      protected: std::vector<std::size_t> idSlots;
+
+      /// \brief Id of the component stored at each slot. This is the
+      /// reverse of idSlots.
+      protected: std::vector<ComponentId> slotIds;
+
+      /// \brief ComponentState of the component stored at each slot.
+      private: std::vector<uint8_t> slotStates;
+
+      /// \brief Number of components with a one-time change.
+      private: std::size_t oneTimeChangeCount{0};
+
+      /// \brief Number of components with a periodic change.
+      private: std::size_t periodicChangeCount{0};
+
+      /// \brief Whether the values of these components are indexed.
+      private: bool valueIndexed{false};
     };
 
     /// \brief Templated implementation of component storage.
+    ///
+    /// Components are stored in fixed-size blocks. Adding components never
+    /// moves existing ones, so growing the storage doesn't invalidate
+    /// pointers held by views, and loading large worlds doesn't repeatedly
+    /// copy all components into bigger arrays. Removing a component moves
+    /// the last component into its slot, which keeps the storage dense.
     template<typename ComponentTypeT>
     class IGNITION_GAZEBO_HIDDEN ComponentStorage : public ComponentStorageBase
     {
@@ -88,67 +415,107 @@ namespace ignition
       public: explicit ComponentStorage()
               : ComponentStorageBase()
       {
-        // Reserve a chunk of memory for the components. The size here will
-        // effect how often Views are rebuilt when
-        // EntityComponentManager::CreateComponent() is called.
-        //
-        // Views would be rebuilt if the components vector capacity is
-        // exceeded after an EntityComponentManager::Each call has already
-        // been executed.
-        //
-        // See also this class's Create() function, which expands the value
-        // of components vector whenever the capacity is reached.
-        this->components.reserve(100);
+      }
+
+      // Documentation inherited.
+      public: bool SetBlockSize(const std::size_t _size) final
+      {
+        if (!this->blocks.empty())
+          return false;
+
+        // Round up to a power of two, so that finding the block of a slot
+        // is a shift and a mask.
+        std::size_t shift{0};
+        while ((std::size_t{1} << shift) < _size)
+          ++shift;
+
+        this->blockShift = shift;
+        this->blockMask = (std::size_t{1} << shift) - 1;
+        return true;
+      }
+
+      // Documentation inherited.
+      public: std::size_t BlockSize() const final
+      {
+        return this->blockMask + 1;
+      }
+
+      // Documentation inherited.
+      public: std::size_t Capacity() const final
+      {
+        std::size_t capacity{0};
+        for (const auto &block : this->blocks)
+          capacity += block.capacity();
+        return capacity;
+      }
+
+      // Documentation inherited.
+      public: std::size_t ComponentBytes() const final
+      {
+        return this->Capacity() * sizeof(ComponentTypeT) +
+            this->blocks.capacity() * sizeof(std::vector<ComponentTypeT>);
       }
 
       // Documentation inherited.
       public: bool Remove(const ComponentId _id) final
       {
-        std::lock_guard<std::mutex> lock(this->mutex);
+        if (!this->RemoveImplementation(_id))
+          return false;
 
-        // Get an iterator to the component that should be removed.
-        auto iter = this->idMap.find(_id);
+        this->ReleaseBlocks();
+        ++this->relocations;
+        return true;
+      }
 
-        // Make sure the component exists.
-        if (iter != this->idMap.end())
+      // Documentation inherited.
+      public: std::size_t Remove(const std::vector<ComponentId> &_ids) final
+      {
+        std::size_t count{0};
+        for (const ComponentId id : _ids)
         {
-          // Handle the case where there are more components than the
-          // component to be removed
-          if (this->components.size() > 1)
-          {
-            // Swap the component to be removed with the component at the
-            // back of the vector.
-            std::swap(this->components[iter->second],
-                      this->components.back());
-
-            // After the swap, we have to fix all the id mappings.
-            for (auto idIter =this->idMap.begin();
-                idIter != this->idMap.end(); ++idIter)
-            {
-              if (static_cast<unsigned int>(idIter->second) ==
-                  this->components.size()-1)
-              {
-                idIter->second = iter->second;
-              }
-            }
-          }
+          if (this->RemoveImplementation(id))
+            ++count;
+        }
+
+        if (count > 0)
+        {
+          this->ReleaseBlocks();
+          ++this->relocations;
+        }
+        return count;
+      }
 
-          // Remove the component.
-          this->components.pop_back();
+      // Documentation inherited.
+      public: bool Compact() final
+      {
+        bool released = this->CompactSlots();
 
-          // Remove the id mapping.
-          this->idMap.erase(iter);
-          return true;
+        // Drop the spare block kept by ReleaseBlocks
+        const std::size_t used =
+            (this->count + this->blockMask) >> this->blockShift;
+        if (this->blocks.size() > used)
+        {
+          this->blocks.resize(used);
+          released = true;
         }
-        return false;
+
+        if (this->blocks.size() * kCompactRatio < this->blocks.capacity())
+        {
+          this->blocks.shrink_to_fit();
+          released = true;
+        }
+
+        // Components themselves don't move, so this isn't a relocation
+        return released;
       }
 
       // Documentation inherited.
       public: void RemoveAll() final
       {
-        this->idCounter = 0;
-        this->idMap.clear();
-        this->components.clear();
+        this->RemoveAllSlots();
+        this->blocks.clear();
+        this->count = 0;
+        ++this->relocations;
       }
 
       // Documentation inherited.
@@ -156,23 +523,26 @@ namespace ignition
                   const components::BaseComponent *_data) final
       {
         ComponentId result;  // = kComponentIdInvalid;
-        bool expanded = false;
-        if (this->components.size() == this->components.capacity())
+
+        // Start a new block once the current ones are full. Existing
+        // components stay where they are.
+        const std::size_t block = this->count >> this->blockShift;
+        if (block == this->blocks.size())
         {
-          this->components.reserve(this->components.capacity() + 100);
-          expanded = true;
+          this->blocks.emplace_back();
+          this->blocks.back().reserve(this->BlockSize());
         }
 
-        std::lock_guard<std::mutex> lock(this->mutex);
         // cppcheck-suppress unmatchedSuppression
         // cppcheck-suppress postfixOperator
         result = this->idCounter++;
-        this->idMap[result] = this->components.size();
+        this->AddSlot(result, this->count);
         // Copy the component
-        this->components.push_back(std::move(
-              ComponentTypeT(*static_cast<const ComponentTypeT *>(_data))));
+        this->blocks[block].push_back(
+            ComponentTypeT(*static_cast<const ComponentTypeT *>(_data)));
+        ++this->count;
 
-        return {result, expanded};
+        return {result, false};
       }
 
       // Documentation inherited.
@@ -186,36 +556,89 @@ namespace ignition
 
       public: components::BaseComponent *Component(const ComponentId _id) final
       {
-        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->TypedComponent(_id);
+      }
 
-        auto iter = this->idMap.find(_id);
+      /// \brief Get a component by id, without a virtual call.
+      /// \param[in] _id Id of the component to get.
+      /// \return Pointer to the component, or nullptr if not found.
+      public: ComponentTypeT *TypedComponent(const ComponentId _id)
+      {
+        const std::size_t slot = this->Slot(_id);
+        if (slot == kInvalidSlot)
+          return nullptr;
 
-        if (iter != this->idMap.end())
-        {
-          return static_cast<components::BaseComponent *>(
-              &this->components.at(iter->second));
-        }
-        return nullptr;
+        return &this->At(slot);
       }
 
       // Documentation inherited.
       public: components::BaseComponent *First() final
       {
-        std::lock_guard<std::mutex> lock(this->mutex);
-        if (!this->components.empty())
-          return static_cast<components::BaseComponent *>(&this->components[0]);
+        if (this->count > 0)
+          return static_cast<components::BaseComponent *>(&this->At(0));
         return nullptr;
       }
 
-      /// \brief The id counter is used to get unique ids within this
-      /// storage class.
-      private: ComponentId idCounter = 0;
+      /// \brief Get the component at a slot.
+      /// \param[in] _slot Slot index, which must be lower than the number of
+      /// components.
+      /// \return The component.
+      private: ComponentTypeT &At(const std::size_t _slot)
+      {
+        return this->blocks[_slot >> this->blockShift][_slot & this->blockMask];
+      }
+
+      /// \brief Remove a component based on an id, without counting the
+      /// relocation. The last component is moved into the removed
+      /// component's slot, so removal is constant time.
+      /// \param[in] _id Id of the component to remove.
+      /// \return True if the component was removed.
+      private: bool RemoveImplementation(const ComponentId _id)
+      {
+        // Make sure the component exists.
+        const std::size_t slot = this->Slot(_id);
+        if (slot == kInvalidSlot)
+          return false;
+
+        const std::size_t last = this->count - 1;
+
+        // Move the last component into the slot of the component to be
+        // removed, and fix the moved component's mapping.
+        if (slot != last)
+          std::swap(this->At(slot), this->At(last));
+
+        // Remove the component and its slot.
+        this->blocks[last >> this->blockShift].pop_back();
+        --this->count;
+        this->RemoveSlot(_id, slot);
+        return true;
+      }
+
+      /// \brief Free empty blocks at the end, keeping one spare block so that
+      /// alternating creation and removal at a block boundary doesn't
+      /// allocate each time.
+      private: void ReleaseBlocks()
+      {
+        const std::size_t used =
+            (this->count + this->blockMask) >> this->blockShift;
+        while (this->blocks.size() > used + 1)
+          this->blocks.pop_back();
+      }
+
+      /// \brief Blocks of components. Each block has a capacity of
+      /// BlockSize() and is never reallocated.
+      private: std::vector<std::vector<ComponentTypeT>> blocks;
+
+      /// \brief Number of components.
+      private: std::size_t count{0};
 
-      /// \brief Map of ComponentId to Components (see the components vector).
-      private: std::map<ComponentId, int> idMap;
+      /// \brief Log2 of the block size.
+      private: std::size_t blockShift{kDefaultComponentBlockShift};
 
-      /// \brief Sequential storage of components.
-      public: std::vector<ComponentTypeT> components;
+      /// \brief Block size minus one, to find the offset of a slot in its
+      /// block.
+      private: std::size_t blockMask{
+          (std::size_t{1} << kDefaultComponentBlockShift) - 1};
     };
     }
   }
@@ -17,9 +17,12 @@
 #ifndef IGNITION_GAZEBO_DETAIL_ENTITYCOMPONENTMANAGER_HH_
 #define IGNITION_GAZEBO_DETAIL_ENTITYCOMPONENTMANAGER_HH_
 
+#include <algorithm>
 #include <cstring>
+#include <functional>
 #include <map>
 #include <set>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -27,6 +30,7 @@
 #include <ignition/math/Helpers.hh>
 
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/detail/ComponentStorageBase.hh"
 
 namespace ignition
 {
@@ -54,6 +58,21 @@ namespace traits
       value = !std::is_same<decltype(*(T*)(0) == *(T*)(0)), TestEqualityOperator>::value // NOLINT
     };
   };
+
+  /// \brief Type trait that determines if the data of component `T` can be
+  /// hashed with std::hash, so its values can be indexed.
+  template<typename T, typename = void>
+  struct HasHashableData : std::false_type
+  {
+  };
+
+  /// \brief Specialization for components with hashable data.
+  template<typename T>
+  struct HasHashableData<T, std::void_t<decltype(
+      std::hash<typename T::Type>()(std::declval<const typename T::Type &>()))>>
+    : std::true_type
+  {
+  };
 }
 
 //////////////////////////////////////////////////
@@ -83,8 +102,8 @@ template<typename ComponentTypeT>
 ComponentKey EntityComponentManager::CreateComponent(const Entity _entity,
             const ComponentTypeT &_data)
 {
-  return this->CreateComponentImplementation(_entity, ComponentTypeT::typeId,
-      &_data);
+  return this->CreateComponentImplementation(_entity,
+      components::TypeIdOf<ComponentTypeT>(), &_data);
 }
 
 //////////////////////////////////////////////////
@@ -93,10 +112,17 @@ const ComponentTypeT *EntityComponentManager::Component(
     const Entity _entity) const
 {
   // Get a unique identifier to the component type
-  const ComponentTypeId typeId = ComponentTypeT::typeId;
+  const ComponentTypeId typeId = components::TypeIdOf<ComponentTypeT>();
 
-  return static_cast<const ComponentTypeT *>(
-      this->ComponentImplementation(_entity, typeId));
+  // The storage of a type always holds that type, so skip the virtual call
+  // into the storage.
+  ComponentId id;
+  auto storage = this->StorageImplementation(_entity, typeId, id, false);
+  if (nullptr == storage)
+    return nullptr;
+
+  return static_cast<ComponentStorage<ComponentTypeT> *>(storage)
+      ->TypedComponent(id);
 }
 
 //////////////////////////////////////////////////
@@ -104,10 +130,17 @@ template<typename ComponentTypeT>
 ComponentTypeT *EntityComponentManager::Component(const Entity _entity)
 {
   // Get a unique identifier to the component type
-  const ComponentTypeId typeId = ComponentTypeT::typeId;
+  const ComponentTypeId typeId = components::TypeIdOf<ComponentTypeT>();
 
-  return static_cast<ComponentTypeT *>(
-      this->ComponentImplementation(_entity, typeId));
+  // The storage of a type always holds that type, so skip the virtual call
+  // into the storage.
+  ComponentId id;
+  auto storage = this->StorageImplementation(_entity, typeId, id, true);
+  if (nullptr == storage)
+    return nullptr;
+
+  return static_cast<ComponentStorage<ComponentTypeT> *>(storage)
+      ->TypedComponent(id);
 }
 
 //////////////////////////////////////////////////
@@ -166,7 +199,11 @@ bool EntityComponentManager::SetComponentData(const Entity _entity,
     return true;
   }
 
-  return comp->SetData(_data, CompareData<typename ComponentTypeT::Type>);
+  if (!comp->SetData(_data, CompareData<typename ComponentTypeT::Type>))
+    return false;
+
+  this->UpdateValueIndex(_entity, components::TypeIdOf<ComponentTypeT>());
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -174,7 +211,7 @@ template<typename ComponentTypeT>
 const ComponentTypeT *EntityComponentManager::First() const
 {
   return static_cast<const ComponentTypeT *>(
-      this->First(ComponentTypeT::typeId));
+      this->First(components::TypeIdOf<ComponentTypeT>()));
 }
 
 //////////////////////////////////////////////////
@@ -182,7 +219,7 @@ template<typename ComponentTypeT>
 ComponentTypeT *EntityComponentManager::First()
 {
   return static_cast<ComponentTypeT *>(
-      this->First(ComponentTypeT::typeId));
+      this->First(components::TypeIdOf<ComponentTypeT>()));
 }
 
 //////////////////////////////////////////////////
@@ -190,6 +227,23 @@ template<typename ...ComponentTypeTs>
 Entity EntityComponentManager::EntityByComponents(
     const ComponentTypeTs &..._desiredComponents) const
 {
+  // Only check the entities with the desired value, if it's indexed. They're
+  // in no particular order, so return the first one created, like the view.
+  auto candidates = this->IndexedCandidates(_desiredComponents...);
+  if (nullptr != candidates)
+  {
+    Entity result{kNullEntity};
+    for (const Entity entity : *candidates)
+    {
+      if ((kNullEntity == result || entity < result) &&
+          this->EntityMatchesComponents(entity, _desiredComponents...))
+      {
+        result = entity;
+      }
+    }
+    return result;
+  }
+
   // Get all entities which have components of the desired types
   const auto &view = this->FindView<ComponentTypeTs...>();
 
@@ -228,6 +282,20 @@ template<typename ...ComponentTypeTs>
 std::vector<Entity> EntityComponentManager::EntitiesByComponents(
     const ComponentTypeTs &..._desiredComponents) const
 {
+  // Only check the entities with the desired value, if it's indexed
+  auto candidates = this->IndexedCandidates(_desiredComponents...);
+  if (nullptr != candidates)
+  {
+    std::vector<Entity> result;
+    for (const Entity entity : *candidates)
+    {
+      if (this->EntityMatchesComponents(entity, _desiredComponents...))
+        result.push_back(entity);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
   // Get all entities which have components of the desired types
   const auto &view = this->FindView<ComponentTypeTs...>();
 
@@ -265,45 +333,109 @@ template<typename ...ComponentTypeTs>
 std::vector<Entity> EntityComponentManager::ChildrenByComponents(Entity _parent,
      const ComponentTypeTs &..._desiredComponents) const
 {
-  // Get all entities which have components of the desired types
-  const auto &view = this->FindView<ComponentTypeTs...>();
-
-  // Get all entities which are immediate children of the given parent
-  auto children = this->Entities().AdjacentsFrom(_parent);
-
-  // Iterate over entities
   std::vector<Entity> result;
-  for (const Entity entity : view.entities)
+
+  // Only check the entities with the desired value, if it's indexed
+  auto candidates = this->IndexedCandidates(_desiredComponents...);
+  if (nullptr != candidates)
   {
-    if (children.find(entity) == children.end())
+    for (const Entity entity : *candidates)
     {
-      continue;
+      if (this->ParentEntity(entity) == _parent &&
+          this->EntityMatchesComponents(entity, _desiredComponents...))
+      {
+        result.push_back(entity);
+      }
     }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
 
-    // Iterate over desired components, comparing each of them to the
-    // equivalent component in the entity.
-    bool different{false};
-    ForEach([&](const auto &_desiredComponent)
-    {
-      auto entityComponent = this->Component<
-          std::remove_cv_t<std::remove_reference_t<
-              decltype(_desiredComponent)>>>(entity);
+  // Otherwise only check the immediate children of the given parent, which
+  // are usually far fewer than the entities with the desired types
+  for (const auto &child : this->Entities().AdjacentsFrom(_parent))
+  {
+    if (this->EntityMatchesComponents(child.first, _desiredComponents...))
+      result.push_back(child.first);
+  }
 
-      if (*entityComponent != _desiredComponent)
+  return result;
+}
+
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+void EntityComponentManager::EnableValueIndex()
+{
+  static_assert(traits::HasHashableData<ComponentTypeT>::value,
+      "Only components whose data can be hashed with std::hash can be "
+      "indexed.");
+  static_assert(
+      !std::is_floating_point<typename ComponentTypeT::Type>::value,
+      "Floating point components are compared with a tolerance, so equal "
+      "values may have different hashes.");
+
+  this->EnableValueIndexImplementation(
+      components::TypeIdOf<ComponentTypeT>(),
+      [](const components::BaseComponent &_component) -> std::size_t
       {
-        different = true;
-      }
-    }, _desiredComponents...);
+        return std::hash<typename ComponentTypeT::Type>()(
+            static_cast<const ComponentTypeT &>(_component).Data());
+      });
+}
 
-    if (!different)
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+const std::vector<Entity> *EntityComponentManager::IndexedCandidates(
+    const ComponentTypeTs &..._desiredComponents) const
+{
+  // Use the index with the fewest candidates
+  const std::vector<Entity> *result{nullptr};
+  ForEach([&](const auto &_desiredComponent)
+  {
+    using ComponentT = std::remove_cv_t<std::remove_reference_t<
+        decltype(_desiredComponent)>>;
+    if constexpr (traits::HasHashableData<ComponentT>::value)
     {
-      result.push_back(entity);
+      auto candidates = this->ValueIndexCandidates(
+          components::TypeIdOf<ComponentT>(),
+          std::hash<typename ComponentT::Type>()(_desiredComponent.Data()));
+      if (nullptr != candidates &&
+          (nullptr == result || candidates->size() < result->size()))
+      {
+        result = candidates;
+      }
     }
-  }
+  }, _desiredComponents...);
 
   return result;
 }
 
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+bool EntityComponentManager::EntityMatchesComponents(const Entity _entity,
+    const ComponentTypeTs &..._desiredComponents) const
+{
+  // Compare each desired component to the equivalent component in the
+  // entity
+  bool different{false};
+  ForEach([&](const auto &_desiredComponent)
+  {
+    if (different)
+      return;
+
+    auto entityComponent = this->Component<
+        std::remove_cv_t<std::remove_reference_t<
+            decltype(_desiredComponent)>>>(_entity);
+
+    if (nullptr == entityComponent || *entityComponent != _desiredComponent)
+    {
+      different = true;
+    }
+  }, _desiredComponents...);
+
+  return !different;
+}
+
 //////////////////////////////////////////////////
 template <typename T>
 struct EntityComponentManager::identity  // NOLINT
@@ -319,7 +451,8 @@ void EntityComponentManager::EachNoCache(typename identity<std::function<
   for (const auto &vertex : this->Entities().Vertices())
   {
     Entity entity = vertex.first;
-    auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
+    auto types = std::set<ComponentTypeId>{
+        components::TypeIdOf<ComponentTypeTs>()...};
 
     if (this->EntityMatches(entity, types))
     {
@@ -340,7 +473,8 @@ void EntityComponentManager::EachNoCache(typename identity<std::function<
   for (const auto &vertex : this->Entities().Vertices())
   {
     Entity entity = vertex.first;
-    auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
+    auto types = std::set<ComponentTypeId>{
+        components::TypeIdOf<ComponentTypeTs>()...};
 
     if (this->EntityMatches(entity, types))
     {
@@ -364,13 +498,19 @@ void EntityComponentManager::Each(typename identity<std::function<
 
   // Iterate over the entities in the view, and invoke the callback
   // function.
-  for (const Entity entity : view.entities)
+  uint64_t visited{0};
+  for (const auto &entityComponents :
+      detail::ViewRange<const ComponentTypeTs...>(&view))
   {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
+    ++visited;
+    if (!std::apply(_f, entityComponents))
     {
       break;
     }
   }
+  view.eachCalls.Add();
+  view.entitiesVisited.Add(visited);
+  this->TraceViewAccess(view, visited, false);
 }
 
 //////////////////////////////////////////////////
@@ -384,13 +524,82 @@ void EntityComponentManager::Each(typename identity<std::function<
 
   // Iterate over the entities in the view, and invoke the callback
   // function.
-  for (const Entity entity : view.entities)
+  uint64_t visited{0};
+  for (const auto &entityComponents :
+      detail::ViewRange<ComponentTypeTs...>(&view))
   {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
+    ++visited;
+    if (!std::apply(_f, entityComponents))
     {
       break;
     }
   }
+  view.eachCalls.Add();
+  view.entitiesVisited.Add(visited);
+  this->TraceViewAccess(view, visited, true);
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::ParallelEach(typename identity<std::function<
+    void(const Entity &_entity, ComponentTypeTs *...)>>::type _f)
+{
+  // Getting the view refreshes its cached components, so workers only read
+  // from it.
+  detail::View &view = this->FindView<ComponentTypeTs...>();
+  const detail::ViewRange<ComponentTypeTs...> range(&view);
+
+  this->ParallelFor(range.Size(),
+      [&](std::size_t _begin, std::size_t _end)
+      {
+        for (std::size_t row = _begin; row < _end; ++row)
+          std::apply(_f, range.At(row));
+      });
+  view.eachCalls.Add();
+  view.entitiesVisited.Add(range.Size());
+  this->TraceViewAccess(view, range.Size(), true);
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::ParallelEach(typename identity<std::function<
+    void(const Entity &_entity, const ComponentTypeTs *...)>>::type _f) const
+{
+  // Getting the view refreshes its cached components, so workers only read
+  // from it.
+  detail::View &view = this->FindView<ComponentTypeTs...>();
+  const detail::ViewRange<const ComponentTypeTs...> range(&view);
+
+  this->ParallelFor(range.Size(),
+      [&](std::size_t _begin, std::size_t _end)
+      {
+        for (std::size_t row = _begin; row < _end; ++row)
+          std::apply(_f, range.At(row));
+      });
+  view.eachCalls.Add();
+  view.entitiesVisited.Add(range.Size());
+  this->TraceViewAccess(view, range.Size(), false);
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+detail::ViewRange<ComponentTypeTs...> EntityComponentManager::Query()
+{
+  detail::View &view = this->FindView<ComponentTypeTs...>();
+  view.eachCalls.Add();
+  this->TraceViewAccess(view, 0, true);
+  return detail::ViewRange<ComponentTypeTs...>(&view);
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+detail::ViewRange<const ComponentTypeTs...> EntityComponentManager::Query()
+    const
+{
+  detail::View &view = this->FindView<ComponentTypeTs...>();
+  view.eachCalls.Add();
+  this->TraceViewAccess(view, 0, false);
+  return detail::ViewRange<const ComponentTypeTs...>(&view);
 }
 
 //////////////////////////////////////////////////
@@ -413,13 +622,18 @@ void EntityComponentManager::EachNew(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
+  uint64_t visited{0};
   for (const Entity entity : view.newEntities)
   {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
+    ++visited;
+    if (!_f(entity, view.Component<ComponentTypeTs>(entity)...))
     {
       break;
     }
   }
+  view.eachCalls.Add();
+  view.entitiesVisited.Add(visited);
+  this->TraceViewAccess(view, visited, true);
 }
 
 //////////////////////////////////////////////////
@@ -434,13 +648,18 @@ void EntityComponentManager::EachNew(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
+  uint64_t visited{0};
   for (const Entity entity : view.newEntities)
   {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
+    ++visited;
+    if (!_f(entity, view.Component<ComponentTypeTs>(entity)...))
     {
       break;
     }
   }
+  view.eachCalls.Add();
+  view.entitiesVisited.Add(visited);
+  this->TraceViewAccess(view, visited, false);
 }
 
 //////////////////////////////////////////////////
@@ -455,102 +674,122 @@ void EntityComponentManager::EachRemoved(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
+  uint64_t visited{0};
   for (const Entity entity : view.toRemoveEntities)
   {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
+    ++visited;
+    if (!_f(entity, view.Component<ComponentTypeTs>(entity)...))
     {
       break;
     }
   }
+  view.eachCalls.Add();
+  view.entitiesVisited.Add(visited);
+  this->TraceViewAccess(view, visited, false);
 }
 
 //////////////////////////////////////////////////
-template<typename FirstComponent,
-         typename ...RemainingComponents,
-         typename std::enable_if<
-           sizeof...(RemainingComponents) == 0, int>::type>
-void EntityComponentManager::AddComponentsToView(detail::View &_view,
-    const Entity _entity) const
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EachChanged(typename identity<std::function<
+    bool(const Entity &_entity, const ComponentTypeTs *...)>>::type _f) const
 {
-  const ComponentTypeId typeId = FirstComponent::typeId;
+  detail::View &view = this->FindView<ComponentTypeTs...>();
 
-  const ComponentId compId =
-      this->EntityComponentIdFromType(_entity, typeId);
-  if (compId >= 0)
-  {
-    // Add the component to the view.
-    _view.AddComponent(_entity, typeId, compId);
-  }
-  else
+  // Only the changed entities are looked up in the view
+  uint64_t visited{0};
+  for (const Entity entity : this->ChangedEntities(
+      {components::TypeIdOf<ComponentTypeTs>()...}))
   {
-    ignerr << "Entity[" << _entity << "] has no component of type["
-      << typeId << "]. This should never happen.\n";
+    auto rowIter = view.entityRows.find(entity);
+    if (rowIter == view.entityRows.end())
+      continue;
+
+    ++visited;
+    if (!_f(entity, view.ComponentAt<ComponentTypeTs>(rowIter->second)...))
+    {
+      break;
+    }
   }
+  view.eachCalls.Add();
+  view.entitiesVisited.Add(visited);
+  this->TraceViewAccess(view, visited, false);
 }
 
 //////////////////////////////////////////////////
-template<typename FirstComponent,
-         typename ...RemainingComponents,
-         typename std::enable_if<
-           sizeof...(RemainingComponents) != 0, int>::type>
-void EntityComponentManager::AddComponentsToView(detail::View &_view,
-    const Entity _entity) const
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EachChanged(typename identity<std::function<
+    bool(const Entity &_entity, ComponentTypeTs *...)>>::type _f)
 {
-  const ComponentTypeId typeId = FirstComponent::typeId;
-  const ComponentId compId =
-      this->EntityComponentIdFromType(_entity, typeId);
-  if (compId >= 0)
-  {
-    // Add the component to the view.
-    _view.AddComponent(_entity, typeId, compId);
-  }
-  else
+  detail::View &view = this->FindView<ComponentTypeTs...>();
+
+  // Only the changed entities are looked up in the view
+  uint64_t visited{0};
+  for (const Entity entity : this->ChangedEntities(
+      {components::TypeIdOf<ComponentTypeTs>()...}))
   {
-    ignerr << "Entity[" << _entity << "] has no component of type["
-      << typeId << "]. This should never happen.\n";
-  }
+    auto rowIter = view.entityRows.find(entity);
+    if (rowIter == view.entityRows.end())
+      continue;
 
-  // Add the remaining components to the view.
-  this->AddComponentsToView<RemainingComponents...>(_view, _entity);
+    ++visited;
+    if (!_f(entity, view.ComponentAt<ComponentTypeTs>(rowIter->second)...))
+    {
+      break;
+    }
+  }
+  view.eachCalls.Add();
+  view.entitiesVisited.Add(visited);
+  this->TraceViewAccess(view, visited, true);
 }
 
 //////////////////////////////////////////////////
 template<typename ...ComponentTypeTs>
 detail::View &EntityComponentManager::FindView() const
 {
-  auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
+  // Each component type pack gets its own slot, so after the first call the
+  // view is found without building and comparing sets of types.
+  static const std::size_t slot = detail::NextViewSlot();
+  auto cached = this->FindView(slot);
+  if (nullptr != cached)
+    return *cached;
+
+  auto types = std::set<ComponentTypeId>{
+      components::TypeIdOf<ComponentTypeTs>()...};
 
   std::map<detail::ComponentTypeKey, detail::View>::iterator viewIter;
 
   // Find the view. If the view doesn't exist, then create a new view.
   if (!this->FindView(types, viewIter))
   {
-    detail::View view;
+    detail::View view(types);
     // Add all the entities that match the component types to the
     // view.
     for (const auto &vertex : this->Entities().Vertices())
     {
       Entity entity = vertex.first;
-      if (this->EntityMatches(entity, types))
+      if (this->ViewMatches(entity, types))
       {
         view.AddEntity(entity, this->IsNewEntity(entity));
         // If there is a request to delete this entity, update the view as
         // well
-        if (this->IsMarkedForRemoval(entity))
+        if (this->IsLeavingViews(entity))
         {
           view.AddEntityToRemoved(entity);
         }
 
-        // Store pointers to all the components. This recursively adds
-        // all the ComponentTypeTs that belong to the entity to the view.
-        this->AddComponentsToView<ComponentTypeTs...>(view, entity);
+        // Store pointers to all the components of the view's types that
+        // belong to the entity.
+        this->AddComponentsToView(view, entity);
       }
     }
 
     // Store the view.
-    return this->AddView(types, std::move(view))->second;
+    auto &added = this->AddView(types, std::move(view))->second;
+    this->SetViewSlot(slot, added);
+    return added;
   }
 
+  this->SetViewSlot(slot, viewIter->second);
   return viewIter->second;
 }
 
@@ -558,7 +797,7 @@ detail::View &EntityComponentManager::FindView() const
 template<typename ComponentTypeT>
 bool EntityComponentManager::RemoveComponent(Entity _entity)
 {
-  const auto typeId = ComponentTypeT::typeId;
+  const auto typeId = components::TypeIdOf<ComponentTypeT>();
   return this->RemoveComponent(_entity, typeId);
 }
 }
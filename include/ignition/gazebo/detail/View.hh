@@ -17,11 +17,18 @@
 #ifndef IGNITION_GAZEBO_DETAIL_VIEW_HH_
 #define IGNITION_GAZEBO_DETAIL_VIEW_HH_
 
+#include <array>
+#include <cstdint>
 #include <map>
 #include <set>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include "ignition/gazebo/components/Component.hh"
+#include "ignition/gazebo/detail/ComponentStorageBase.hh"
+#include "ignition/gazebo/Counter.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/Export.hh"
 #include "ignition/gazebo/Types.hh"
@@ -37,6 +44,12 @@ namespace detail
 /// \brief A key into the map of views
 using ComponentTypeKey = std::set<ComponentTypeId>;
 
+/// \brief Get a new slot for caching views. Each component type pack used
+/// to query the EntityComponentManager takes one slot the first time it's
+/// used.
+/// \return A slot which hasn't been returned before.
+std::size_t IGNITION_GAZEBO_VISIBLE NextViewSlot();
+
 /// \brief A view is a cache to entities, and their components, that
 /// match a set of component types. A cache is used because systems will
 /// frequently, potentially every iteration, query the
@@ -45,33 +58,95 @@ using ComponentTypeKey = std::set<ComponentTypeId>;
 /// use a cache to improve performance. The assumption is that entities
 /// and the types of components assigned to entities change infrequently
 /// compared to the frequency of queries performed by systems.
+///
+/// All entities in a view share the same set of component types, so the
+/// view lays them out as a struct of arrays: one contiguous row per entity
+/// and one column per component type. Each column caches pointers to the
+/// components, so iterating a view is a linear scan which doesn't need to
+/// look up components in the EntityComponentManager. Cached pointers are
+/// refreshed whenever the storage of a column's type moves its components
+/// in memory.
 class IGNITION_GAZEBO_VISIBLE View
 {
+  /// \brief Default constructor.
+  public: View() = default;
+
+  /// \brief Constructor
+  /// \param[in] _types The component types of this view. There will be one
+  /// column per type.
+  public: explicit View(const ComponentTypeKey &_types);
+
   /// Get a pointer to a component for an entity based on a component type.
   /// \param[in] _entity The entity.
-  /// \param[in] _ecm Pointer to the entity component manager.
-  /// \return Pointer to the component.
+  /// \return Pointer to the component, or nullptr if the entity or the
+  /// component type are not part of the view.
   public: template<typename ComponentTypeT>
-          const ComponentTypeT *Component(const Entity _entity,
-              const EntityComponentManager *_ecm) const
+          const ComponentTypeT *Component(const Entity _entity) const
   {
-    ComponentTypeId typeId = ComponentTypeT::typeId;
-    return static_cast<const ComponentTypeT *>(
-        this->ComponentImplementation(_entity, typeId, _ecm));
+    auto rowIter = this->entityRows.find(_entity);
+    if (rowIter == this->entityRows.end())
+      return nullptr;
+    return this->ComponentAt<ComponentTypeT>(rowIter->second);
   }
 
   /// Get a pointer to a component for an entity based on a component type.
   /// \param[in] _entity The entity.
-  /// \param[in] _ecm Pointer to the entity component manager.
-  /// \return Pointer to the component.
+  /// \return Pointer to the component, or nullptr if the entity or the
+  /// component type are not part of the view.
   public: template<typename ComponentTypeT>
-          ComponentTypeT *Component(const Entity _entity,
-              const EntityComponentManager *_ecm)
+          ComponentTypeT *Component(const Entity _entity)
   {
-    ComponentTypeId typeId = ComponentTypeT::typeId;
-    return static_cast<ComponentTypeT *>(
-        const_cast<components::BaseComponent *>(
-          this->ComponentImplementation(_entity, typeId, _ecm)));
+    auto rowIter = this->entityRows.find(_entity);
+    if (rowIter == this->entityRows.end())
+      return nullptr;
+    return this->ComponentAt<ComponentTypeT>(rowIter->second);
+  }
+
+  /// \brief Get a pointer to the component of a given type stored at a row.
+  /// \param[in] _row Row index, must be smaller than `rows.size()`.
+  /// \return Pointer to the component, or nullptr if the component type is
+  /// not part of the view.
+  public: template<typename ComponentTypeT>
+          ComponentTypeT *ComponentAt(const std::size_t _row) const
+  {
+    const int column =
+        this->ColumnIndex(components::TypeIdOf<ComponentTypeT>());
+    if (column < 0)
+      return nullptr;
+    return static_cast<ComponentTypeT *>(this->ComponentAt(column, _row));
+  }
+
+  /// \brief Get the column index of a component type.
+  /// \param[in] _typeId Component type id.
+  /// \return Column index, or -1 if the type is not part of the view.
+  public: int ColumnIndex(const ComponentTypeId _typeId) const
+  {
+    // Views usually hold a handful of types, so a linear search beats
+    // hashing here.
+    for (std::size_t i = 0; i < this->columnTypes.size(); ++i)
+    {
+      if (this->columnTypes[i] == _typeId)
+        return static_cast<int>(i);
+    }
+    return -1;
+  }
+
+  /// \brief Get a pointer to the component stored at a column and row.
+  /// The column is refreshed first if its storage moved components since
+  /// the column was last updated.
+  /// \param[in] _column Column index.
+  /// \param[in] _row Row index.
+  /// \return Pointer to the component.
+  public: components::BaseComponent *ComponentAt(const int _column,
+              const std::size_t _row) const
+  {
+    const ComponentStorageBase *storage = this->columnStorages[_column];
+    if (nullptr != storage &&
+        storage->Relocations() != this->columnRelocations[_column])
+    {
+      const_cast<View *>(this)->RefreshColumn(_column);
+    }
+    return this->componentPtrs[_column][_row];
   }
 
   /// \brief Add an entity to the view.
@@ -96,27 +171,32 @@ class IGNITION_GAZEBO_VISIBLE View
   /// did not exist in the view.
   public: bool AddEntityToRemoved(const Entity _entity);
 
-  /// \brief Add a component to an entity.
+  /// \brief Add a component to an entity. The entity must have already been
+  /// added to the view.
   /// \param[in] _entity The entity.
   /// \param[in] _compTypeId Component type id.
   /// \param[in] _compId Component id.
+  /// \param[in] _storage Storage holding components of type _compTypeId.
   public: void AddComponent(const Entity _entity,
                             const ComponentTypeId _compTypeId,
-                            const ComponentId _compId);
+                            const ComponentId _compId,
+                            ComponentStorageBase *_storage);
 
-  /// \brief Implementation of the Component accessor.
-  /// \param[in] _entity The entity.
-  /// \param[in] _typeId Type id of the component.
-  /// \param[in] _ecm Pointer to the EntityComponentManager.
-  /// \return Pointer to the component, or nullptr if not found.
-  private: const components::BaseComponent *ComponentImplementation(
-               const Entity _entity,
-               ComponentTypeId _typeId,
-               const EntityComponentManager *_ecm) const;
+  /// \brief Refresh the cached component pointers of all columns whose
+  /// storage moved components since they were last updated.
+  public: void Refresh();
+
+  /// \brief Remove all entities and components from the view, including
+  /// new and removed entities, keeping its component types.
+  public: void Clear();
 
   /// \brief Clear the list of new entities
   public: void ClearNewEntities();
 
+  /// \brief Refresh the cached component pointers of a column.
+  /// \param[in] _column Column index.
+  private: void RefreshColumn(const int _column);
+
   /// \brief All the entities that belong to this view.
   public: std::set<Entity> entities;
 
@@ -126,9 +206,155 @@ class IGNITION_GAZEBO_VISIBLE View
   /// \brief List of entities about to be removed
   public: std::set<Entity> toRemoveEntities;
 
-  /// \brief All of the components for each entity.
-  public: std::map<std::pair<Entity, ComponentTypeId>,
-          ComponentId> components;
+  /// \brief Entities of the view in contiguous memory. The components of
+  /// `rows[i]` are found at index `i` of each column.
+  public: std::vector<Entity> rows;
+
+  /// \brief Row index of each entity in `rows`.
+  public: std::unordered_map<Entity, std::size_t> entityRows;
+
+  /// \brief Component type of each column.
+  public: std::vector<ComponentTypeId> columnTypes;
+
+  /// \brief Component ids, one column per component type and one row per
+  /// entity.
+  public: std::vector<std::vector<ComponentId>> componentIds;
+
+  /// \brief Cached component pointers, one column per component type and
+  /// one row per entity.
+  public: std::vector<std::vector<components::BaseComponent *>>
+          componentPtrs;
+
+  /// \brief Storage of each column's component type, or nullptr if no
+  /// component of that type has been added to the view yet.
+  public: std::vector<ComponentStorageBase *> columnStorages;
+
+  /// \brief Storage relocation count at the time each column's pointers
+  /// were last updated. See ComponentStorageBase::Relocations.
+  public: std::vector<uint64_t> columnRelocations;
+
+  /// \brief Number of times the view was iterated or queried.
+  public: Counter eachCalls;
+
+  /// \brief Number of entities visited by those iterations.
+  public: Counter entitiesVisited;
+};
+/// \brief A range over the entities of a view and their components of
+/// types `ComponentTypeTs`. The view's columns for these types are resolved
+/// once when the range is created, so iterating is a linear scan that the
+/// compiler can inline. Dereferencing an iterator gives a tuple with the
+/// entity and pointers to its components, which works with structured
+/// bindings:
+///
+///   for (auto [entity, name, pose] : _ecm.Query<Name, Pose>())
+///
+/// Rows are visited by index, so entities added to the view while
+/// iterating don't invalidate the range.
+template<typename ...ComponentTypeTs>
+class ViewRange
+{
+  /// \brief Marks the end of the range.
+  public: class Sentinel
+  {
+  };
+
+  /// \brief Iterator over the rows of the view.
+  public: class Iterator
+  {
+    /// \brief Constructor
+    /// \param[in] _range Range being iterated.
+    /// \param[in] _row Row to start at.
+    public: Iterator(const ViewRange *_range, const std::size_t _row)
+            : range(_range), row(_row)
+    {
+    }
+
+    /// \brief Get the entity and components at the current row.
+    /// \return Tuple with the entity followed by its components.
+    public: std::tuple<Entity, ComponentTypeTs *...> operator*() const
+    {
+      return this->range->Row(this->row,
+          std::index_sequence_for<ComponentTypeTs...>());
+    }
+
+    /// \brief Advance to the next row.
+    /// \return Reference to this iterator.
+    public: Iterator &operator++()
+    {
+      ++this->row;
+      return *this;
+    }
+
+    /// \brief Check whether there are rows left.
+    /// \return True if the iterator hasn't reached the end of the view.
+    public: bool operator!=(const Sentinel &) const
+    {
+      return this->row < this->range->view->rows.size();
+    }
+
+    /// \brief Range being iterated.
+    private: const ViewRange *range;
+
+    /// \brief Current row.
+    private: std::size_t row;
+  };
+
+  /// \brief Constructor
+  /// \param[in] _view View to iterate.
+  public: explicit ViewRange(View *_view)
+          : view(_view),
+            columns{{_view->ColumnIndex(
+                components::TypeIdOf<ComponentTypeTs>())...}}
+  {
+  }
+
+  /// \brief Iterator to the first row.
+  /// \return Iterator.
+  public: Iterator begin() const
+  {
+    return Iterator(this, 0u);
+  }
+
+  /// \brief End of the range.
+  /// \return Sentinel.
+  public: Sentinel end() const
+  {
+    return Sentinel();
+  }
+
+  /// \brief Get the number of entities in the range.
+  /// \return Number of entities.
+  public: std::size_t Size() const
+  {
+    return this->view->rows.size();
+  }
+
+  /// \brief Get the entity and components at a row.
+  /// \param[in] _row Row index, must be smaller than Size().
+  /// \return Tuple with the entity followed by its components.
+  public: std::tuple<Entity, ComponentTypeTs *...> At(
+              const std::size_t _row) const
+  {
+    return this->Row(_row, std::index_sequence_for<ComponentTypeTs...>());
+  }
+
+  /// \brief Get the entity and components at a row.
+  /// \param[in] _row Row index.
+  /// \return Tuple with the entity followed by its components.
+  private: template<std::size_t ...Is>
+           std::tuple<Entity, ComponentTypeTs *...> Row(const std::size_t _row,
+               std::index_sequence<Is...>) const
+  {
+    return std::tuple<Entity, ComponentTypeTs *...>(this->view->rows[_row],
+        static_cast<ComponentTypeTs *>(
+          this->view->ComponentAt(this->columns[Is], _row))...);
+  }
+
+  /// \brief View being iterated.
+  private: View *view;
+
+  /// \brief Column of each component type in the view.
+  private: std::array<int, sizeof...(ComponentTypeTs)> columns;
 };
 /// \endcond
 }
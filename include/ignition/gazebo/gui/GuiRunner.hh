@@ -57,10 +57,21 @@ class IGNITION_GAZEBO_VISIBLE GuiRunner : public QObject
   /// \param[in] _res Response containing new state.
   private: void OnStateAsyncService(const msgs::SerializedStepMap &_res);
 
-  /// \brief Callback when a new state is received from the server.
+  /// \brief Callback when a new state is received from the server. The
+  /// state is merged with any other state received since the last update,
+  /// and applied on the next plugin update.
   /// \param[in] _msg New state message.
   private: void OnState(const msgs::SerializedStepMap &_msg);
 
+  /// \brief Apply the state received since the last update, if any.
+  /// \return True if there was new state.
+  /// \todo(anyone) Move to GuiRunner::Implementation when porting to v5
+  private: bool ProcessState();
+
+  /// \brief Refresh the list of GUI systems to update.
+  /// \todo(anyone) Move to GuiRunner::Implementation when porting to v5
+  private: void RefreshPlugins();
+
   /// \brief Update the plugins.
   /// \todo(anyone) Move to GuiRunner::Implementation when porting to v5
   private: void UpdatePlugins();
@@ -18,10 +18,13 @@
 #define IGNITION_GAZEBO_GUI_GUISYSTEM_HH_
 
 #include <QtCore>
+#include <unordered_set>
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Entity.hh>
 #include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
 #include <ignition/gui/Plugin.hh>
 
 #include <sdf/Element.hh>
@@ -41,6 +44,11 @@ namespace gazebo
   /// GUI systems are different from `ignition::gazebo::System`s because they
   /// don't run in the same process as the physics. Instead, they run in a
   /// separate process that is stepped by updates coming through the network
+  ///
+  /// By default, Update is called on every GUI update. Systems which only
+  /// care about a few component types or entities can call
+  /// SubscribeToChanges, so that Update is only called when those change,
+  /// and then look at ChangedEntities instead of scanning the whole ECM.
   class IGNITION_GAZEBO_VISIBLE GuiSystem : public ignition::gui::Plugin
   {
     Q_OBJECT
@@ -53,6 +61,29 @@ namespace gazebo
     /// and write entities and their components.
     public: virtual void Update(const UpdateInfo &/*_info*/,
                                 EntityComponentManager &/*_ecm*/){}
+
+    /// \brief Only call Update when entities are created or removed, or when
+    /// some components change. Calling it again replaces the previous
+    /// subscription.
+    /// \param[in] _types Component types to watch, all types if empty.
+    /// \param[in] _entities Entities to watch, all entities if empty.
+    public: void SubscribeToChanges(
+                const std::unordered_set<ComponentTypeId> &_types,
+                const std::unordered_set<Entity> &_entities = {});
+
+    /// \brief Go back to having Update called on every GUI update.
+    public: void UnsubscribeFromChanges();
+
+    /// \brief Whether this system subscribed to changes.
+    /// \return True if subscribed.
+    public: bool SubscribedToChanges() const;
+
+    /// \brief Entities matching the subscription which were created,
+    /// removed, or had watched components change since the previous call to
+    /// Update. Only valid from within Update, and empty if the system hasn't
+    /// subscribed to changes.
+    /// \return Changed entities.
+    public: const std::unordered_set<Entity> &ChangedEntities() const;
   };
 }
 }
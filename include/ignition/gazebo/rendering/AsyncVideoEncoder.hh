@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_ASYNCVIDEOENCODER_HH_
+#define IGNITION_GAZEBO_ASYNCVIDEOENCODER_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+  // Forward declaration
+  class AsyncVideoEncoderPrivate;
+
+  /// \brief Encodes video frames on a thread of its own, so the thread
+  /// producing the frames, usually the rendering thread, only pays for
+  /// copying them into a queue.
+  ///
+  /// Frames which arrive while the queue is full are dropped, unless
+  /// dropping is disabled, in which case AddFrame waits for the encoder
+  /// to catch up. The latter is meant for lockstep recording, where every
+  /// frame is needed.
+  class IGNITION_GAZEBO_VISIBLE AsyncVideoEncoder
+  {
+    /// \brief Constructor
+    public: AsyncVideoEncoder();
+
+    /// \brief Destructor, stops encoding.
+    public: ~AsyncVideoEncoder();
+
+    /// \brief Start encoding.
+    /// \param[in] _format Video format, such as "mp4".
+    /// \param[in] _filename File to encode to.
+    /// \param[in] _width Frame width in pixels.
+    /// \param[in] _height Frame height in pixels.
+    /// \param[in] _fps Video frame rate.
+    /// \param[in] _bitRate Video bit rate.
+    /// \param[in] _queueSize Maximum number of frames waiting to be encoded.
+    /// \param[in] _dropFrames True to drop frames when the queue is full,
+    /// false to wait.
+    /// \return True if the encoder started.
+    public: bool Start(const std::string &_format,
+        const std::string &_filename, unsigned int _width,
+        unsigned int _height, unsigned int _fps = 25,
+        unsigned int _bitRate = 2070000, std::size_t _queueSize = 8,
+        bool _dropFrames = true);
+
+    /// \brief Get whether the encoder is started.
+    /// \return True between Start and Stop.
+    public: bool IsEncoding() const;
+
+    /// \brief Get whether a frame would be queued. The video has a fixed
+    /// frame rate, so frames arriving faster than it are skipped. Checking
+    /// first lets the caller skip reading those frames back altogether.
+    /// \param[in] _timestamp Time of the frame.
+    /// \return True if encoding and the frame isn't too close to the
+    /// latest queued frame.
+    public: bool WantsFrame(
+        const std::chrono::steady_clock::time_point &_timestamp) const;
+
+    /// \brief Queue a frame to be encoded. The frame is copied.
+    /// \param[in] _frame RGB frame data.
+    /// \param[in] _width Frame width in pixels.
+    /// \param[in] _height Frame height in pixels.
+    /// \param[in] _timestamp Time of the frame.
+    /// \return False if the frame was dropped, or skipped because it's too
+    /// close to the latest queued frame, see WantsFrame.
+    public: bool AddFrame(const unsigned char *_frame, unsigned int _width,
+        unsigned int _height,
+        const std::chrono::steady_clock::time_point &_timestamp);
+
+    /// \brief Encode the frames still queued and finish the video file.
+    /// Blocks until done.
+    /// \return True if the video was written.
+    public: bool Stop();
+
+    /// \brief Set a callback which is called from the encoder thread each
+    /// time the underlying encoder accepts a frame, with the frame's time.
+    /// The encoder itself skips frames arriving faster than its frame rate.
+    /// \param[in] _cb Callback, or nullptr to clear it.
+    public: void SetFrameEncodedCallback(
+        const std::function<void(
+        const std::chrono::steady_clock::time_point &)> &_cb);
+
+    /// \brief Number of frames queued since Start.
+    /// \return Frame count.
+    public: uint64_t QueuedFrames() const;
+
+    /// \brief Number of frames the underlying encoder accepted since Start.
+    /// \return Frame count.
+    public: uint64_t EncodedFrames() const;
+
+    /// \brief Number of frames dropped because the queue was full, since
+    /// Start.
+    /// \return Frame count.
+    public: uint64_t DroppedFrames() const;
+
+    /// \brief Private data pointer
+    private: std::unique_ptr<AsyncVideoEncoderPrivate> dataPtr;
+  };
+}
+}
+}
+#endif
@@ -55,6 +55,11 @@ class IGNITION_GAZEBO_VISIBLE MarkerManager
   /// \brief Update MarkerManager
   public: void Update();
 
+  /// \brief Whether the last Update processed any marker request. Markers
+  /// which expire are only removed when simulation time changes.
+  /// \return True if markers were added, modified or deleted.
+  public: bool Changed() const;
+
   /// \brief Initialize the marker manager.
   /// \param[in] _scene Reference to the scene.
   /// \return True on success
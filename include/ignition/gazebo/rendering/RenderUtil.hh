@@ -17,8 +17,10 @@
 #ifndef IGNITION_GAZEBO_RENDERUTIL_HH_
 #define IGNITION_GAZEBO_RENDERUTIL_HH_
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <sdf/Sensor.hh>
@@ -62,6 +64,12 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \brief Main update function. Must be called in the rendering thread.
     public: void Update();
 
+    /// \brief Whether the last call to Update changed the scene. That is,
+    /// entities were added, removed or modified, markers were requested, or
+    /// simulation time changed. Must be called in the rendering thread.
+    /// \return True if the scene changed.
+    public: bool SceneChanged() const;
+
     /// \brief Get a pointer to the scene
     /// \return Pointer to the scene
     public: rendering::ScenePtr Scene() const;
@@ -76,6 +84,15 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     public: void UpdateFromECM(const UpdateInfo &_info,
                                const EntityComponentManager &_ecm);
 
+    /// \brief Set entity poses without going through the ECM, for example
+    /// from the dynamic pose stream. From then on, these poses take
+    /// precedence over the poses in the ECM for the same entities. Entities
+    /// are still created and removed from the ECM. Can be called from any
+    /// thread.
+    /// \param[in] _poses Pose of each entity, relative to its parent.
+    public: void UpdateFromPoses(
+                const std::vector<std::pair<Entity, math::Pose3d>> &_poses);
+
     /// \brief Set the rendering engine to use
     /// \param[in] _engineName Name of the rendering engine.
     public: void SetEngineName(const std::string &_engineName);
@@ -116,6 +133,24 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
         std::string(const gazebo::Entity &, const sdf::Sensor &,
           const std::string &)> _createSensorCb = {});
 
+    /// \brief Set whether to skip pose updates of top level models which
+    /// are out of range of all rendering sensors. A sensor's range is its
+    /// far clip distance or maximum lidar range, in any direction. Models
+    /// carrying sensors are never skipped. A skipped model gets its latest
+    /// poses once it comes back in range.
+    /// \param[in] _enable True to skip out of range models
+    /// \param[in] _margin Distance added to each sensor's range, in meters
+    public: void SetSensorCulling(bool _enable, double _margin);
+
+    /// \brief Set how much real time each call to Update may spend creating
+    /// visuals. Visuals left over are created on the following calls, so a
+    /// large scene appears over several frames instead of blocking the first
+    /// one. Sensors need the whole scene, so this is meant for user views.
+    /// \param[in] _budget Time budget, zero for no limit, which is the
+    /// default.
+    public: void SetCreationBudget(
+        const std::chrono::steady_clock::duration &_budget);
+
     /// \brief Set the callback function for removing the sensors
     /// \param[in] _removeSensorCb Callback function for removing the sensors
     /// The callback function arg is the sensor entity to remove
@@ -21,6 +21,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <sdf/Geometry.hh>
 #include <sdf/Actor.hh>
@@ -34,6 +35,8 @@
 #include <ignition/common/Animation.hh>
 #include <ignition/common/graphics/Types.hh>
 
+#include <ignition/math/Vector3.hh>
+
 #include <ignition/msgs/particle_emitter.pb.h>
 
 #include <ignition/rendering/RenderTypes.hh>
@@ -102,6 +105,45 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \return Pointer to scene
     public: rendering::ScenePtr Scene() const;
 
+    /// \brief Set whether visuals with identical materials should share a
+    /// single rendering material instead of each getting a copy. Sharing
+    /// lets the render engine batch draws of identical visuals, but
+    /// changing a shared material affects all visuals using it, so it
+    /// should only be enabled where materials aren't modified after
+    /// creation. Only affects visuals created afterwards.
+    /// \param[in] _share True to share materials.
+    public: void SetShareMaterials(bool _share);
+
+    /// \brief Set the distances at which mesh visuals switch to simpler
+    /// levels of detail. Level N, starting at 1, is loaded from
+    /// `<name>_lod<N>.<extension>` next to the visual's mesh, and is shown
+    /// from the Nth distance on. Meshes without such files keep a single
+    /// level. Only affects visuals created afterwards.
+    /// \param[in] _distances Switching distances in meters, empty to disable
+    /// levels of detail.
+    public: void SetLodDistances(const std::vector<double> &_distances);
+
+    /// \brief Set whether meshes which aren't loaded yet are loaded on
+    /// background threads, so that creating visuals doesn't block the
+    /// render thread. Until its mesh is loaded, a visual has no geometry;
+    /// call AddLoadedMeshes regularly to add the geometry once ready.
+    /// Sensors which need the exact geometry from the start should leave
+    /// this disabled, which is the default. Only affects visuals created
+    /// afterwards.
+    /// \param[in] _async True to load meshes in the background.
+    public: void SetAsyncMeshLoading(bool _async);
+
+    /// \brief Add the geometry of visuals whose mesh finished loading in
+    /// the background since the last call. See SetAsyncMeshLoading.
+    /// \return True if any geometry was added.
+    public: bool AddLoadedMeshes();
+
+    /// \brief Show the level of detail of each mesh visual matching its
+    /// distance to the closest viewpoint.
+    /// \param[in] _viewpoints World positions the scene is viewed from. If
+    /// empty, the positions of the scene's sensors are used.
+    public: void UpdateLod(const std::vector<math::Vector3d> &_viewpoints);
+
     /// \brief Set the world's ID.
     /// \param[in] _id World ID.
     public: void SetWorldId(Entity _id);
@@ -259,6 +301,14 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     private: rendering::GeometryPtr LoadGeometry(const sdf::Geometry &_geom,
         math::Vector3d &_scale, math::Pose3d &_localPose);
 
+    /// \brief Load a visual's geometry and material and add them to its
+    /// rendering visual.
+    /// \param[in] _id Visual entity.
+    /// \param[in] _visual Visual SDF.
+    /// \param[in] _visualVis Rendering visual of the entity.
+    private: void AddGeometry(Entity _id, const sdf::Visual &_visual,
+        const rendering::VisualPtr &_visualVis);
+
     /// \brief Load a material
     /// \param[in] _material Material sdf dom
     /// \return Material object loaded from the sdf dom
@@ -14,6 +14,7 @@
  * limitations under the License.
  *
  */
+#include <algorithm>
 
 #include "Barrier.hh"
 
@@ -32,20 +33,39 @@ class ignition::gazebo::BarrierPrivate
   public: unsigned int threadCount;
 
   /// \brief Current remaining thread count (decrements from threadCount)
-  public: unsigned int count;
+  public: std::atomic<unsigned int> count;
 
   /// \brief Barrier generation, incremented when all threads report
-  public: unsigned int generation{0};
+  public: std::atomic<unsigned int> generation{0};
+
+  /// \brief Number of threads blocked on the condition variable. Protected
+  /// by the mutex.
+  public: unsigned int sleeping{0};
+
+  /// \brief Maximum number of spins before blocking.
+  public: unsigned int maxSpin;
+
+  /// \brief Current number of spins before blocking, adapted between
+  /// maxSpin / 64 and maxSpin.
+  public: std::atomic<unsigned int> spin;
 };
 
 using namespace ignition::gazebo;
 
 //////////////////////////////////////////////////
 Barrier::Barrier(unsigned int _threadCount)
+  : Barrier(_threadCount, kDefaultMaxSpin)
+{
+}
+
+//////////////////////////////////////////////////
+Barrier::Barrier(unsigned int _threadCount, unsigned int _maxSpin)
   : dataPtr(std::make_unique<BarrierPrivate>())
 {
   this->dataPtr->threadCount = _threadCount;
   this->dataPtr->count = _threadCount;
+  this->dataPtr->maxSpin = _maxSpin;
+  this->dataPtr->spin = _maxSpin;
 }
 
 //////////////////////////////////////////////////
@@ -59,23 +79,51 @@ Barrier::ExitStatus Barrier::Wait()
     return Barrier::ExitStatus::CANCELLED;
   }
 
-  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
   unsigned int gen = this->dataPtr->generation;
 
   if (--this->dataPtr->count == 0)
   {
-    // All threads have reached the wait, so reset the barrier.
-    this->dataPtr->generation++;
+    // All threads have reached the wait, so reset the barrier. No thread can
+    // arrive for the next generation until the generation is incremented.
     this->dataPtr->count = this->dataPtr->threadCount;
-    this->dataPtr->cv.notify_all();
+
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->generation++;
+    if (this->dataPtr->sleeping > 0)
+      this->dataPtr->cv.notify_all();
     return Barrier::ExitStatus::DONE_LAST;
   }
 
-  while (gen == this->dataPtr->generation && !this->dataPtr->cancelled)
+  // Spin for a while before blocking
+  const unsigned int spin = this->dataPtr->spin;
+  unsigned int i = 0;
+  while (i < spin && gen == this->dataPtr->generation)
+    ++i;
+
+  if (gen != this->dataPtr->generation)
   {
-    // All threads haven't reached, so wait until generation is reached
-    // or a cancel occurs
-    this->dataPtr->cv.wait(lock);
+    // Spinning paid off, allow spinning longer next time
+    if (spin < this->dataPtr->maxSpin)
+    {
+      this->dataPtr->spin = std::min(this->dataPtr->maxSpin,
+          std::max(1u, spin * 2));
+    }
+  }
+  else
+  {
+    // Spinning was wasted, spin less next time. Keep spinning a little, so
+    // the limit can grow again when waits become short.
+    this->dataPtr->spin = std::max(spin / 2, this->dataPtr->maxSpin / 64);
+
+    std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+    ++this->dataPtr->sleeping;
+    while (gen == this->dataPtr->generation && !this->dataPtr->cancelled)
+    {
+      // All threads haven't reached, so wait until generation is reached
+      // or a cancel occurs
+      this->dataPtr->cv.wait(lock);
+    }
+    --this->dataPtr->sleeping;
   }
 
   if (this->dataPtr->cancelled)
@@ -93,8 +141,7 @@ void Barrier::Cancel()
 {
   std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
   // This forces pending threads to release
-  this->dataPtr->generation++;
   this->dataPtr->cancelled = true;
+  this->dataPtr->generation++;
   this->dataPtr->cv.notify_all();
 }
-
@@ -42,6 +42,13 @@ namespace ignition
     /// all required threads have reached the wait() method.  This is useful
     /// for syncronizing work across many threads.
     ///
+    /// Threads which have to wait first spin on a generation counter, and
+    /// only block on a condition variable if the other threads take longer.
+    /// The spin limit adapts: it grows while generations complete during the
+    /// spin and shrinks when threads end up blocking anyway, so short waits
+    /// avoid the wake up latency of blocking without burning CPU on long
+    /// ones.
+    ///
     /// Note that this can likely be replaced once the C++ concurrency TS
     /// is ratified: https://en.cppreference.com/w/cpp/experimental/barrier
     class IGNITION_GAZEBO_VISIBLE Barrier
@@ -53,6 +60,16 @@ namespace ignition
       ///       1 main thread would require _threadCount=11.
       public: explicit Barrier(unsigned int _threadCount);
 
+      /// \brief Constructor
+      /// \param[in] _threadCount Number of threads to syncronize, including
+      /// a main thread if used.
+      /// \param[in] _maxSpin Maximum number of times a waiting thread checks
+      /// the barrier before blocking. Zero always blocks right away.
+      public: Barrier(unsigned int _threadCount, unsigned int _maxSpin);
+
+      /// \brief Default maximum number of spins before blocking.
+      public: static constexpr unsigned int kDefaultMaxSpin{4096};
+
       /// \brief Destructor
       public: ~Barrier();
 
@@ -17,7 +17,9 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <thread>
+#include <vector>
 
 #include "Barrier.hh"
 
@@ -120,6 +122,53 @@ TEST(Barrier, Sync50Threads)
   syncThreadsTest(50);
 }
 
+//////////////////////////////////////////////////
+/// \brief Reuse a barrier for many generations, checking that exactly one
+/// thread is last on each.
+void generationsTest(unsigned int _maxSpin)
+{
+  const unsigned int threadCount{4};
+  const unsigned int generations{1000};
+  gazebo::Barrier barrier(threadCount, _maxSpin);
+
+  std::atomic<unsigned int> lastCount{0};
+  std::atomic<unsigned int> arrived{0};
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < threadCount; ++t)
+  {
+    threads.push_back(std::thread([&]()
+    {
+      for (unsigned int g = 0; g < generations; ++g)
+      {
+        ++arrived;
+        auto ret = barrier.Wait();
+        EXPECT_FALSE(wasCancelled(ret));
+        // Everyone arrived on this generation before anyone left
+        EXPECT_GE(arrived, (g + 1) * threadCount);
+        if (ret == gazebo::Barrier::ExitStatus::DONE_LAST)
+          ++lastCount;
+      }
+    }));
+  }
+
+  for (auto &t : threads)
+    t.join();
+
+  EXPECT_EQ(generations, lastCount);
+}
+
+//////////////////////////////////////////////////
+TEST(Barrier, Generations)
+{
+  generationsTest(gazebo::Barrier::kDefaultMaxSpin);
+}
+
+//////////////////////////////////////////////////
+TEST(Barrier, GenerationsNoSpin)
+{
+  generationsTest(0);
+}
+
 //////////////////////////////////////////////////
 TEST(Barrier, Cancel)
 {
@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+
+#include "ignition/gazebo/BinaryState.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Identifies binary state buffers. Read with the wrong byte order,
+/// it doesn't match.
+static const uint32_t kMagic{0x53474E49};
+
+/// \brief Version of the layout.
+static const uint16_t kVersion{1};
+
+/// \brief Flag set when there are one-time changes.
+static const uint16_t kOneTimeChangesFlag{1};
+
+/// \brief Read-only stream buffer over memory it doesn't own, so components
+/// can be deserialized without copying their data.
+class MemoryBuffer : public std::streambuf
+{
+  /// \brief Point the buffer to a new range of memory.
+  /// \param[in] _begin Start of the range.
+  /// \param[in] _size Size of the range.
+  public: void Reset(const char *_begin, const std::size_t _size)
+  {
+    // The get area is only read from, so casting away const is safe
+    char *begin = const_cast<char *>(_begin);
+    this->setg(begin, begin, begin + _size);
+  }
+};
+
+/// \brief Append a value to a buffer.
+/// \param[in, out] _out Buffer.
+/// \param[in] _value Value.
+template<typename T>
+static void Put(std::string &_out, const T &_value)
+{
+  _out.append(reinterpret_cast<const char *>(&_value), sizeof(T));
+}
+
+//////////////////////////////////////////////////
+template<typename T>
+bool BinaryStateReader::Read(std::size_t &_pos, T &_value) const
+{
+  if (this->size - _pos < sizeof(T))
+    return false;
+
+  std::memcpy(&_value, this->data + _pos, sizeof(T));
+  _pos += sizeof(T);
+  return true;
+}
+
+//////////////////////////////////////////////////
+BinaryStateWriter::BinaryStateWriter(bool _oneTimeChanges)
+  : oneTimeChanges(_oneTimeChanges)
+{
+}
+
+//////////////////////////////////////////////////
+void BinaryStateWriter::AddRemovedEntity(const Entity _entity)
+{
+  this->removedEntities.push_back(_entity);
+}
+
+//////////////////////////////////////////////////
+void BinaryStateWriter::AddComponent(const Entity _entity,
+    const components::BaseComponent *_component)
+{
+  if (nullptr == _component)
+    return;
+
+  this->blocks[_component->TypeId()].emplace_back(_entity, _component);
+}
+
+//////////////////////////////////////////////////
+void BinaryStateWriter::AddRemovedComponent(const Entity _entity,
+    const ComponentTypeId _type)
+{
+  this->blocks[_type].emplace_back(_entity, nullptr);
+}
+
+//////////////////////////////////////////////////
+void BinaryStateWriter::Write(std::string &_buffer) const
+{
+  std::string out;
+
+  Put(out, kMagic);
+  Put(out, kVersion);
+  Put(out, static_cast<uint16_t>(
+      this->oneTimeChanges ? kOneTimeChangesFlag : 0));
+
+  Put(out, static_cast<uint64_t>(this->removedEntities.size()));
+  for (const Entity entity : this->removedEntities)
+    Put(out, static_cast<uint64_t>(entity));
+
+  Put(out, static_cast<uint64_t>(this->blocks.size()));
+  for (const auto &block : this->blocks)
+  {
+    Put(out, static_cast<uint64_t>(block.first));
+    Put(out, static_cast<uint64_t>(block.second.size()));
+    for (const auto &[entity, component] : block.second)
+    {
+      Put(out, static_cast<uint64_t>(entity));
+      if (nullptr == component)
+      {
+        Put(out, kBinaryStateRemoved);
+        continue;
+      }
+
+      // Serialize in place, then go back to fill in the size
+      const std::size_t sizePos = out.size();
+      Put(out, uint32_t{0});
+      component->SerializeToBuffer(out);
+
+      const auto size = static_cast<uint32_t>(
+          out.size() - sizePos - sizeof(uint32_t));
+      std::memcpy(&out[sizePos], &size, sizeof(size));
+    }
+  }
+
+  _buffer = std::move(out);
+}
+
+//////////////////////////////////////////////////
+BinaryStateReader::BinaryStateReader(const char *_data,
+    const std::size_t _size)
+  : data(_data), size(nullptr == _data ? 0 : _size)
+{
+  std::size_t pos{0};
+  uint32_t magic{0};
+  uint16_t version{0};
+  uint16_t flags{0};
+  uint64_t removedCount{0};
+  if (!this->Read(pos, magic) || magic != kMagic ||
+      !this->Read(pos, version) || !this->Read(pos, flags) ||
+      !this->Read(pos, removedCount))
+  {
+    return;
+  }
+
+  if (version != kVersion)
+  {
+    ignerr << "Unsupported binary state version [" << version << "]."
+           << std::endl;
+    return;
+  }
+
+  // Check the size before reserving, so a corrupt count can't exhaust memory
+  if (removedCount > (this->size - pos) / sizeof(uint64_t))
+    return;
+
+  this->removedEntities.reserve(removedCount);
+  for (uint64_t i = 0; i < removedCount; ++i)
+  {
+    uint64_t entity{0};
+    this->Read(pos, entity);
+    this->removedEntities.push_back(entity);
+  }
+
+  this->oneTimeChanges = (flags & kOneTimeChangesFlag) != 0;
+  this->blocksPos = pos;
+  this->valid = true;
+}
+
+//////////////////////////////////////////////////
+bool BinaryStateReader::Valid() const
+{
+  return this->valid;
+}
+
+//////////////////////////////////////////////////
+bool BinaryStateReader::OneTimeChanges() const
+{
+  return this->oneTimeChanges;
+}
+
+//////////////////////////////////////////////////
+const std::vector<Entity> &BinaryStateReader::RemovedEntities() const
+{
+  return this->removedEntities;
+}
+
+//////////////////////////////////////////////////
+bool BinaryStateReader::EachComponent(
+    const ComponentCallback &_callback) const
+{
+  if (!this->valid)
+    return false;
+
+  MemoryBuffer buffer;
+  std::istream stream(&buffer);
+
+  std::size_t pos = this->blocksPos;
+  uint64_t blockCount{0};
+  if (!this->Read(pos, blockCount))
+    return false;
+
+  for (uint64_t b = 0; b < blockCount; ++b)
+  {
+    uint64_t type{0};
+    uint64_t count{0};
+    if (!this->Read(pos, type) || !this->Read(pos, count))
+      return false;
+
+    for (uint64_t c = 0; c < count; ++c)
+    {
+      uint64_t entity{0};
+      uint32_t componentSize{0};
+      if (!this->Read(pos, entity) || !this->Read(pos, componentSize))
+        return false;
+
+      if (componentSize == kBinaryStateRemoved)
+      {
+        if (!_callback(entity, type, nullptr))
+          return true;
+        continue;
+      }
+
+      if (componentSize > this->size - pos)
+        return false;
+
+      buffer.Reset(this->data + pos, componentSize);
+      stream.clear();
+      pos += componentSize;
+
+      if (!_callback(entity, type, &stream))
+        return true;
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool BinaryStateReader::ToMsg(msgs::SerializedStateMap &_msg) const
+{
+  if (!this->valid)
+    return false;
+
+  auto &entities = *_msg.mutable_entities();
+  for (const Entity entity : this->removedEntities)
+  {
+    auto &entityMsg = entities[entity];
+    entityMsg.set_id(entity);
+    entityMsg.set_remove(true);
+  }
+
+  return this->EachComponent(
+      [&](const Entity _entity, const ComponentTypeId _type,
+          std::istream *_data) -> bool
+  {
+    auto &entityMsg = entities[_entity];
+    entityMsg.set_id(_entity);
+
+    auto &componentMsg = (*entityMsg.mutable_components())[
+        static_cast<int64_t>(_type)];
+    componentMsg.set_type(_type);
+    if (nullptr == _data)
+    {
+      componentMsg.set_remove(true);
+    }
+    else
+    {
+      componentMsg.set_component(std::string(
+          std::istreambuf_iterator<char>(*_data),
+          std::istreambuf_iterator<char>()));
+    }
+    return true;
+  });
+}
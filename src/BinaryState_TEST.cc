@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ignition/gazebo/components/Factory.hh"
+
+#include "ignition/gazebo/BinaryState.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+using IntComponent = components::Component<int, class IntComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.IntComponent",
+    IntComponent)
+
+//////////////////////////////////////////////////
+TEST(BinaryState, RoundTrip)
+{
+  IntComponent a(10);
+  IntComponent b(-20);
+
+  BinaryStateWriter writer(true);
+  writer.AddRemovedEntity(7u);
+  writer.AddComponent(1u, &a);
+  writer.AddRemovedComponent(2u, IntComponent::typeId);
+  writer.AddComponent(3u, &b);
+  writer.AddComponent(4u, nullptr);
+
+  std::string buffer;
+  writer.Write(buffer);
+
+  BinaryStateReader reader(buffer.data(), buffer.size());
+  ASSERT_TRUE(reader.Valid());
+  EXPECT_TRUE(reader.OneTimeChanges());
+  EXPECT_EQ(std::vector<Entity>({7u}), reader.RemovedEntities());
+
+  std::vector<Entity> entities;
+  std::vector<int> values;
+  EXPECT_TRUE(reader.EachComponent(
+      [&](const Entity _entity, const ComponentTypeId _type,
+          std::istream *_data)
+      {
+        EXPECT_EQ(IntComponent::typeId, _type);
+        entities.push_back(_entity);
+        if (nullptr == _data)
+        {
+          values.push_back(0);
+          return true;
+        }
+
+        IntComponent comp;
+        comp.Deserialize(*_data);
+        values.push_back(comp.Data());
+        return true;
+      }));
+
+  // Components of the same type keep the order they were added in
+  EXPECT_EQ(std::vector<Entity>({1u, 2u, 3u}), entities);
+  EXPECT_EQ(std::vector<int>({10, 0, -20}), values);
+}
+
+//////////////////////////////////////////////////
+TEST(BinaryState, ToMsg)
+{
+  IntComponent a(10);
+
+  BinaryStateWriter writer;
+  writer.AddRemovedEntity(7u);
+  writer.AddComponent(1u, &a);
+  writer.AddRemovedComponent(2u, IntComponent::typeId);
+
+  std::string buffer;
+  writer.Write(buffer);
+
+  msgs::SerializedStateMap msg;
+  BinaryStateReader reader(buffer.data(), buffer.size());
+  ASSERT_TRUE(reader.ToMsg(msg));
+  ASSERT_EQ(3, msg.entities_size());
+
+  EXPECT_TRUE(msg.entities().at(7u).remove());
+  EXPECT_EQ(0, msg.entities().at(7u).components_size());
+
+  const auto &entity1 = msg.entities().at(1u);
+  EXPECT_FALSE(entity1.remove());
+  ASSERT_EQ(1, entity1.components_size());
+  const auto &comp = entity1.components().at(IntComponent::typeId);
+  EXPECT_EQ(IntComponent::typeId, comp.type());
+  EXPECT_FALSE(comp.remove());
+
+  // Same bytes as the component would serialize to
+  std::ostringstream ostr;
+  a.Serialize(ostr);
+  EXPECT_EQ(ostr.str(), comp.component());
+
+  EXPECT_TRUE(msg.entities().at(2u).components().at(
+      IntComponent::typeId).remove());
+
+  EXPECT_FALSE(BinaryStateReader(nullptr, 0).ToMsg(msg));
+}
+
+//////////////////////////////////////////////////
+TEST(BinaryState, StopEarly)
+{
+  IntComponent a(1);
+  BinaryStateWriter writer;
+  writer.AddComponent(1u, &a);
+  writer.AddComponent(2u, &a);
+
+  std::string buffer;
+  writer.Write(buffer);
+
+  BinaryStateReader reader(buffer.data(), buffer.size());
+  EXPECT_FALSE(reader.OneTimeChanges());
+
+  int count{0};
+  EXPECT_TRUE(reader.EachComponent(
+      [&](const Entity, const ComponentTypeId, std::istream *)
+      {
+        ++count;
+        return false;
+      }));
+  EXPECT_EQ(1, count);
+}
+
+//////////////////////////////////////////////////
+TEST(BinaryState, Malformed)
+{
+  EXPECT_FALSE(BinaryStateReader(nullptr, 10).Valid());
+
+  std::string garbage(32, 'x');
+  EXPECT_FALSE(BinaryStateReader(garbage.data(), garbage.size()).Valid());
+
+  IntComponent a(1);
+  BinaryStateWriter writer;
+  writer.AddRemovedEntity(3u);
+  writer.AddComponent(1u, &a);
+
+  std::string buffer;
+  writer.Write(buffer);
+
+  // Every truncation is detected, either by the header or while reading
+  // components
+  for (std::size_t size = 0; size < buffer.size(); ++size)
+  {
+    BinaryStateReader reader(buffer.data(), size);
+    if (!reader.Valid())
+      continue;
+
+    EXPECT_FALSE(reader.EachComponent(
+        [](const Entity, const ComponentTypeId, std::istream *)
+        {
+          return true;
+        })) << size;
+  }
+}
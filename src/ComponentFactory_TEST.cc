@@ -127,3 +127,28 @@ TEST_F(ComponentFactoryTest, New)
   }
 }
 
+
+/////////////////////////////////////////////////
+TEST_F(ComponentFactoryTest, StaticTypeId)
+{
+  // Builtin components have an ID known at compile time, which matches the
+  // one set by the registration
+  static_assert(traits::HasStaticTypeId<components::Pose>::value);
+  constexpr ComponentTypeId poseId = components::TypeIdOf<components::Pose>();
+  EXPECT_EQ(components::Pose::typeId, poseId);
+  EXPECT_EQ(common::hash64("ign_gazebo_components.Pose"), poseId);
+
+  // Other components get theirs from the registration
+  using MyStatic = components::Component<int, class MyStaticTag>;
+  static_assert(!traits::HasStaticTypeId<MyStatic>::value);
+  EXPECT_EQ(0u, components::TypeIdOf<MyStatic>());
+
+  components::Factory::Instance()->Register<MyStatic>(
+      "ign_gazebo_components.MyStatic",
+      new components::ComponentDescriptor<MyStatic>(),
+      new components::StorageDescriptor<MyStatic>());
+  EXPECT_EQ(MyStatic::typeId, components::TypeIdOf<MyStatic>());
+  EXPECT_NE(0u, components::TypeIdOf<MyStatic>());
+
+  components::Factory::Instance()->Unregister<MyStatic>();
+}
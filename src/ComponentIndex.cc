@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ComponentIndex.hh"
+
+#include <algorithm>
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Largest gap between entity ids which is filled with unused rows
+/// instead of starting a new range.
+static const Entity kMaxRangeGap{64};
+
+//////////////////////////////////////////////////
+ComponentIndex::Lookup ComponentIndex::Find(const Entity _entity,
+    const ComponentTypeId _type) const
+{
+  Lookup result;
+
+  auto column = this->columns.find(_type);
+  if (column == this->columns.end())
+    return result;
+
+  const std::size_t row = this->Row(_entity);
+  if (row == kNoRow || row >= column->second.ids.size())
+    return result;
+
+  const ComponentId id = column->second.ids[row];
+  if (id == kComponentIdInvalid)
+    return result;
+
+  result.storage = column->second.storage;
+  result.id = id;
+  return result;
+}
+
+//////////////////////////////////////////////////
+void ComponentIndex::Set(const Entity _entity, const ComponentTypeId _type,
+    const ComponentId _id, ComponentStorageBase *_storage)
+{
+  auto &range = this->ranges[this->AddRow(_entity)];
+  const std::size_t row = range.row + (_entity - range.first);
+
+  auto &column = this->columns[_type];
+  column.storage = _storage;
+  if (row >= column.ids.size())
+    column.ids.resize(row + 1, kComponentIdInvalid);
+
+  if (column.ids[row] == kComponentIdInvalid &&
+      this->rowComponents[row]++ == 0)
+  {
+    ++range.used;
+  }
+  column.ids[row] = _id;
+}
+
+//////////////////////////////////////////////////
+void ComponentIndex::Remove(const Entity _entity, const ComponentTypeId _type)
+{
+  auto column = this->columns.find(_type);
+  if (column == this->columns.end())
+    return;
+
+  const std::size_t rangeIndex = this->RangeIndex(_entity);
+  if (rangeIndex == kNoRow)
+    return;
+
+  auto &range = this->ranges[rangeIndex];
+  const std::size_t row = range.row + (_entity - range.first);
+  if (row >= column->second.ids.size() ||
+      column->second.ids[row] == kComponentIdInvalid)
+  {
+    return;
+  }
+  column->second.ids[row] = kComponentIdInvalid;
+
+  if (--this->rowComponents[row] > 0 || --range.used > 0)
+    return;
+
+  // None of the range's entities have components, so all of its rows are
+  // invalid in every column and the block can be given to another range
+  this->freeBlocks.push_back(range.row);
+  this->ranges.erase(this->ranges.begin() + rangeIndex);
+}
+
+//////////////////////////////////////////////////
+void ComponentIndex::Clear()
+{
+  this->ranges.clear();
+  this->rowCount = 0;
+  this->freeBlocks.clear();
+  this->rowComponents.clear();
+  this->columns.clear();
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentIndex::RowCount() const
+{
+  return this->rowCount;
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentIndex::RangeCount() const
+{
+  return this->ranges.size();
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentIndex::Bytes() const
+{
+  std::size_t bytes = this->ranges.capacity() * sizeof(Range) +
+      this->freeBlocks.capacity() * sizeof(std::size_t) +
+      this->rowComponents.capacity() * sizeof(uint32_t) +
+      this->columns.bucket_count() * sizeof(void *);
+  for (const auto &column : this->columns)
+  {
+    bytes += sizeof(void *) + sizeof(column) +
+        column.second.ids.capacity() * sizeof(ComponentId);
+  }
+  return bytes;
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentIndex::RangeIndex(const Entity _entity) const
+{
+  // Most worlds have a single range
+  if (this->ranges.size() == 1)
+  {
+    const auto &range = this->ranges.front();
+    if (_entity >= range.first && _entity < range.end)
+      return 0;
+    return kNoRow;
+  }
+
+  // Last range starting at or before the entity
+  auto it = std::upper_bound(this->ranges.begin(), this->ranges.end(),
+      _entity, [](const Entity _e, const Range &_range)
+      {
+        return _e < _range.first;
+      });
+  if (it == this->ranges.begin())
+    return kNoRow;
+  --it;
+
+  if (_entity >= it->end)
+    return kNoRow;
+  return static_cast<std::size_t>(it - this->ranges.begin());
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentIndex::Row(const Entity _entity) const
+{
+  const std::size_t rangeIndex = this->RangeIndex(_entity);
+  if (rangeIndex == kNoRow)
+    return kNoRow;
+
+  const auto &range = this->ranges[rangeIndex];
+  return range.row + (_entity - range.first);
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentIndex::AddRow(const Entity _entity)
+{
+  const std::size_t rangeIndex = this->RangeIndex(_entity);
+  if (rangeIndex != kNoRow)
+    return rangeIndex;
+
+  auto next = std::upper_bound(this->ranges.begin(), this->ranges.end(),
+      _entity, [](const Entity _e, const Range &_range)
+      {
+        return _e < _range.first;
+      });
+
+  // Grow the previous range if the entity is close enough and still fits
+  // in its block. The entity comes before the next range, if any.
+  if (next != this->ranges.begin())
+  {
+    auto &previous = *(next - 1);
+    if (_entity - previous.end < kMaxRangeGap &&
+        _entity - previous.first < kBlockRows)
+    {
+      previous.end = _entity + 1;
+      return static_cast<std::size_t>(next - 1 - this->ranges.begin());
+    }
+  }
+
+  Range range;
+  range.first = _entity;
+  range.end = _entity + 1;
+  if (this->freeBlocks.empty())
+  {
+    range.row = this->rowCount;
+    this->rowCount += kBlockRows;
+    this->rowComponents.resize(this->rowCount, 0);
+  }
+  else
+  {
+    range.row = this->freeBlocks.back();
+    this->freeBlocks.pop_back();
+  }
+  auto inserted = this->ranges.insert(next, range);
+  return static_cast<std::size_t>(inserted - this->ranges.begin());
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_COMPONENTINDEX_HH_
+#define IGNITION_GAZEBO_COMPONENTINDEX_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class ComponentStorageBase;
+
+    /// \brief Finds the component of a given type that belongs to an entity
+    /// by indexing arrays, instead of going through maps keyed by entity.
+    ///
+    /// Entities are given a row the first time one of their components is
+    /// added. Entity ids are mostly sequential, so they're grouped into
+    /// ranges of consecutive ids with consecutive rows, and finding a row
+    /// is a search among a handful of ranges. Small gaps between ids are
+    /// absorbed by a range, which then wastes a few rows. Ids far from any
+    /// range, such as those given after
+    /// EntityComponentManager::SetEntityCreateOffset, start a new range.
+    ///
+    /// Each range owns a block of kBlockRows rows, so it covers at most that
+    /// many ids. Once none of the entities of a range have components, the
+    /// range is dropped and its block is reused by the next new range.
+    /// Entity ids aren't reused, but worlds which keep spawning and removing
+    /// entities keep a number of rows proportional to the live entities.
+    ///
+    /// Each component type has a column holding the id of each row's
+    /// component, and the storage of that type.
+    class IGNITION_GAZEBO_VISIBLE ComponentIndex
+    {
+      /// \brief Component of an entity.
+      public: struct Lookup
+      {
+        /// \brief Storage of the component's type, or nullptr if the entity
+        /// doesn't have a component of that type.
+        ComponentStorageBase *storage{nullptr};
+
+        /// \brief Id of the component within its storage.
+        ComponentId id{kComponentIdInvalid};
+      };
+
+      /// \brief Find the component of an entity.
+      /// \param[in] _entity Entity.
+      /// \param[in] _type Component type.
+      /// \return The component's storage and id. The storage is nullptr if
+      /// the entity doesn't have a component of that type.
+      public: Lookup Find(const Entity _entity,
+                  const ComponentTypeId _type) const;
+
+      /// \brief Record that an entity has a component.
+      /// \param[in] _entity Entity.
+      /// \param[in] _type Component type.
+      /// \param[in] _id Id of the component within its storage.
+      /// \param[in] _storage Storage of the component type.
+      public: void Set(const Entity _entity, const ComponentTypeId _type,
+                  const ComponentId _id, ComponentStorageBase *_storage);
+
+      /// \brief Record that an entity no longer has a component.
+      /// \param[in] _entity Entity.
+      /// \param[in] _type Component type.
+      public: void Remove(const Entity _entity, const ComponentTypeId _type);
+
+      /// \brief Forget all entities and components.
+      public: void Clear();
+
+      /// \brief Number of rows allocated, including those of blocks which
+      /// are free to be reused.
+      /// \return Number of rows, a multiple of kBlockRows.
+      public: std::size_t RowCount() const;
+
+      /// \brief Number of ranges of consecutive entity ids.
+      /// \return Number of ranges.
+      public: std::size_t RangeCount() const;
+
+      /// \brief Bytes allocated by the index.
+      /// \return Number of bytes.
+      public: std::size_t Bytes() const;
+
+      /// \brief Number of rows in each block, which is also the most ids a
+      /// range can cover.
+      public: static constexpr std::size_t kBlockRows{256};
+
+      /// \brief Find the range holding an entity.
+      /// \param[in] _entity Entity.
+      /// \return Index of the range, or kNoRow if the entity isn't in any.
+      private: std::size_t RangeIndex(const Entity _entity) const;
+
+      /// \brief Find the row of an entity.
+      /// \param[in] _entity Entity.
+      /// \return The row, or kNoRow if the entity doesn't have one.
+      private: std::size_t Row(const Entity _entity) const;
+
+      /// \brief Find the range of an entity, adding the entity to a range
+      /// if needed.
+      /// \param[in] _entity Entity.
+      /// \return Index of the range.
+      private: std::size_t AddRow(const Entity _entity);
+
+      /// \brief Marks entities without a row.
+      private: static constexpr std::size_t kNoRow{
+          std::numeric_limits<std::size_t>::max()};
+
+      /// \brief Consecutive entity ids with consecutive rows.
+      private: struct Range
+      {
+        /// \brief First entity of the range.
+        Entity first{kNullEntity};
+
+        /// \brief One past the last entity of the range.
+        Entity end{kNullEntity};
+
+        /// \brief Row of the first entity, which is the first row of the
+        /// range's block.
+        std::size_t row{0};
+
+        /// \brief Number of rows of the range which have components.
+        std::size_t used{0};
+      };
+
+      /// \brief Components of one type.
+      private: struct Column
+      {
+        /// \brief Storage of the type.
+        ComponentStorageBase *storage{nullptr};
+
+        /// \brief Component id of each row, kComponentIdInvalid for rows
+        /// without a component of this type. Rows past the end don't have
+        /// one either.
+        std::vector<ComponentId> ids;
+      };
+
+      /// \brief Ranges sorted by their first entity.
+      private: std::vector<Range> ranges;
+
+      /// \brief Number of rows allocated so far.
+      private: std::size_t rowCount{0};
+
+      /// \brief First row of the blocks which aren't used by any range.
+      private: std::vector<std::size_t> freeBlocks;
+
+      /// \brief Number of components of each row.
+      private: std::vector<uint32_t> rowComponents;
+
+      /// \brief Column of each component type.
+      private: std::unordered_map<ComponentTypeId, Column> columns;
+    };
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_COMPONENTINDEX_HH_
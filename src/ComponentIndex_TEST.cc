@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "ignition/gazebo/components/Component.hh"
+#include "ignition/gazebo/detail/ComponentStorageBase.hh"
+
+#include "ComponentIndex.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+using IntComponent = components::Component<int, class IntComponentTag>;
+using DoubleComponent =
+    components::Component<double, class DoubleComponentTag>;
+
+//////////////////////////////////////////////////
+TEST(ComponentIndex, FindSetRemove)
+{
+  ComponentStorage<IntComponent> ints;
+  ComponentStorage<DoubleComponent> doubles;
+
+  ComponentIndex index;
+  EXPECT_EQ(nullptr, index.Find(1, 10).storage);
+
+  index.Set(1, 10, 5, &ints);
+  auto lookup = index.Find(1, 10);
+  EXPECT_EQ(&ints, lookup.storage);
+  EXPECT_EQ(5, lookup.id);
+
+  // Another type of the same entity, and a type the entity doesn't have
+  index.Set(1, 20, 7, &doubles);
+  EXPECT_EQ(&doubles, index.Find(1, 20).storage);
+  EXPECT_EQ(7, index.Find(1, 20).id);
+  EXPECT_EQ(nullptr, index.Find(1, 30).storage);
+
+  // An entity without components of that type
+  EXPECT_EQ(nullptr, index.Find(2, 10).storage);
+
+  index.Remove(1, 10);
+  EXPECT_EQ(nullptr, index.Find(1, 10).storage);
+  EXPECT_EQ(kComponentIdInvalid, index.Find(1, 10).id);
+  EXPECT_EQ(&doubles, index.Find(1, 20).storage);
+
+  // Removing again, or something which was never there, is harmless
+  index.Remove(1, 10);
+  index.Remove(3, 30);
+
+  index.Clear();
+  EXPECT_EQ(nullptr, index.Find(1, 20).storage);
+  EXPECT_EQ(0u, index.RowCount());
+  EXPECT_EQ(0u, index.RangeCount());
+}
+
+//////////////////////////////////////////////////
+TEST(ComponentIndex, Ranges)
+{
+  ComponentStorage<IntComponent> ints;
+  ComponentIndex index;
+
+  // Sequential entities share a range
+  for (Entity entity = 1; entity <= 100; ++entity)
+    index.Set(entity, 10, static_cast<ComponentId>(entity), &ints);
+  EXPECT_EQ(1u, index.RangeCount());
+  EXPECT_EQ(ComponentIndex::kBlockRows, index.RowCount());
+
+  // A small gap is absorbed
+  index.Set(110, 10, 110, &ints);
+  EXPECT_EQ(1u, index.RangeCount());
+  EXPECT_EQ(ComponentIndex::kBlockRows, index.RowCount());
+  EXPECT_EQ(nullptr, index.Find(105, 10).storage);
+
+  // Entities far away, as after SetEntityCreateOffset, start a new range
+  const Entity offset = 1000000;
+  index.Set(offset, 10, 1000, &ints);
+  index.Set(offset + 1, 10, 1001, &ints);
+  EXPECT_EQ(2u, index.RangeCount());
+  EXPECT_EQ(2 * ComponentIndex::kBlockRows, index.RowCount());
+
+  // And so do entities before the first range
+  index.Set(0, 10, 0, &ints);
+  EXPECT_EQ(3u, index.RangeCount());
+
+  for (Entity entity = 0; entity <= 100; ++entity)
+    EXPECT_EQ(static_cast<ComponentId>(entity), index.Find(entity, 10).id);
+  EXPECT_EQ(110, index.Find(110, 10).id);
+  EXPECT_EQ(1000, index.Find(offset, 10).id);
+  EXPECT_EQ(1001, index.Find(offset + 1, 10).id);
+  EXPECT_EQ(nullptr, index.Find(offset + 2, 10).storage);
+  EXPECT_EQ(nullptr, index.Find(offset - 1, 10).storage);
+}
+
+//////////////////////////////////////////////////
+TEST(ComponentIndex, ReuseBlocks)
+{
+  ComponentStorage<IntComponent> ints;
+  ComponentStorage<DoubleComponent> doubles;
+  ComponentIndex index;
+
+  // A range covers at most one block
+  const Entity blockRows = ComponentIndex::kBlockRows;
+  for (Entity entity = 1; entity <= blockRows + 1; ++entity)
+    index.Set(entity, 10, static_cast<ComponentId>(entity), &ints);
+  index.Set(1, 20, 1, &doubles);
+  EXPECT_EQ(2u, index.RangeCount());
+  EXPECT_EQ(2 * ComponentIndex::kBlockRows, index.RowCount());
+
+  // The block is kept while any of its entities has a component
+  for (Entity entity = 1; entity <= blockRows; ++entity)
+    index.Remove(entity, 10);
+  EXPECT_EQ(2u, index.RangeCount());
+  EXPECT_EQ(&doubles, index.Find(1, 20).storage);
+
+  index.Remove(1, 20);
+  EXPECT_EQ(1u, index.RangeCount());
+  EXPECT_EQ(nullptr, index.Find(1, 20).storage);
+  EXPECT_EQ(nullptr, index.Find(2, 10).storage);
+
+  // New entities take the free block instead of growing the index
+  const Entity later = 10 * blockRows;
+  for (Entity entity = later; entity < later + 10; ++entity)
+    index.Set(entity, 10, static_cast<ComponentId>(entity), &ints);
+  EXPECT_EQ(2u, index.RangeCount());
+  EXPECT_EQ(2 * ComponentIndex::kBlockRows, index.RowCount());
+
+  EXPECT_EQ(static_cast<ComponentId>(blockRows + 1),
+      index.Find(blockRows + 1, 10).id);
+  for (Entity entity = later; entity < later + 10; ++entity)
+    EXPECT_EQ(static_cast<ComponentId>(entity), index.Find(entity, 10).id);
+
+  // Reused rows start without components
+  EXPECT_EQ(nullptr, index.Find(later, 20).storage);
+  EXPECT_EQ(nullptr, index.Find(1, 10).storage);
+
+  // An entity which gets a component again is given a new range
+  index.Set(1, 10, 1, &ints);
+  EXPECT_EQ(3u, index.RangeCount());
+  EXPECT_EQ(1, index.Find(1, 10).id);
+}
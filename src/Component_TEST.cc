@@ -16,13 +16,19 @@
  */
 
 #include <gtest/gtest.h>
+#include <ignition/msgs/double_v.pb.h>
 #include <ignition/msgs/int32.pb.h>
 
 #include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <sdf/Element.hh>
 #include <ignition/common/Console.hh>
 #include <ignition/math/Inertial.hh>
+#include <ignition/math/Pose3.hh>
 
 #include "ignition/gazebo/components/Component.hh"
 #include "ignition/gazebo/components/Serialization.hh"
@@ -548,3 +554,140 @@ TEST_F(ComponentTest, TypeName)
     EXPECT_EQ("123456", comp.typeName);
   }
 }
+
+//////////////////////////////////////////////////
+TEST_F(ComponentTest, BinarySerialization)
+{
+  // Math types are serialized as raw bytes, without losing precision
+  {
+    using Custom = components::Component<math::Pose3d, class CustomTag>;
+    Custom comp(math::Pose3d(1.0 / 3.0, 2, 3, 0.1, 0.2, 0.3));
+
+    std::ostringstream ostr;
+    comp.Serialize(ostr);
+    EXPECT_EQ(1 + 7 * sizeof(double), ostr.str().size());
+
+    std::istringstream istr(ostr.str());
+    Custom comp2;
+    comp2.Deserialize(istr);
+    EXPECT_DOUBLE_EQ(1.0 / 3.0, comp2.Data().Pos().X());
+    EXPECT_EQ(comp.Data(), comp2.Data());
+
+    // Text is still deserialized
+    std::istringstream textIstr("3 2 1 0 0 0");
+    comp2.Deserialize(textIstr);
+    EXPECT_EQ(math::Pose3d(3, 2, 1, 0, 0, 0), comp2.Data());
+  }
+
+  // Text can be chosen instead
+  {
+    using Custom = components::Component<double, class CustomTag,
+        serializers::TextSerializer<double>>;
+    Custom comp(1.5);
+
+    std::ostringstream ostr;
+    comp.Serialize(ostr);
+    EXPECT_EQ("1.5", ostr.str());
+  }
+
+  // Vectors of doubles, and the older protobuf format
+  {
+    using Custom = components::Component<std::vector<double>,
+        class CustomTag, serializers::VectorDoubleSerializer>;
+    Custom comp({1.0 / 3.0, 2.0, 3.0});
+
+    std::ostringstream ostr;
+    comp.Serialize(ostr);
+
+    std::istringstream istr(ostr.str());
+    Custom comp2;
+    comp2.Deserialize(istr);
+    EXPECT_EQ(comp.Data(), comp2.Data());
+
+    msgs::Double_V msg;
+    msg.add_data(4.0);
+    msg.add_data(5.0);
+    std::istringstream msgIstr(msg.SerializeAsString());
+    comp2.Deserialize(msgIstr);
+    EXPECT_EQ(std::vector<double>({4.0, 5.0}), comp2.Data());
+
+    // Truncated data is rejected
+    std::istringstream truncatedIstr(ostr.str().substr(0, 12));
+    Custom comp3;
+    comp3.Deserialize(truncatedIstr);
+    EXPECT_TRUE(comp3.Data().empty());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(ComponentTest, BufferSerialization)
+{
+  // Appends to the buffer, and matches stream serialization
+  {
+    using Custom = components::Component<math::Pose3d, class CustomTag>;
+    Custom comp(math::Pose3d(1.0 / 3.0, 2, 3, 0.1, 0.2, 0.3));
+
+    std::string buffer{"x"};
+    comp.SerializeToBuffer(buffer);
+    std::ostringstream ostr;
+    comp.Serialize(ostr);
+    EXPECT_EQ("x" + ostr.str(), buffer);
+
+    Custom comp2;
+    comp2.DeserializeFromBuffer(std::string_view(buffer).substr(1));
+    EXPECT_EQ(comp.Data(), comp2.Data());
+
+    // Text is still deserialized, and truncated data is ignored
+    comp2.DeserializeFromBuffer("3 2 1 0 0 0");
+    EXPECT_EQ(math::Pose3d(3, 2, 1, 0, 0, 0), comp2.Data());
+    comp2.DeserializeFromBuffer(std::string_view(buffer).substr(1, 12));
+    EXPECT_EQ(math::Pose3d(3, 2, 1, 0, 0, 0), comp2.Data());
+  }
+
+  // Vectors of doubles, and the older protobuf format
+  {
+    using Custom = components::Component<std::vector<double>,
+        class CustomTag, serializers::VectorDoubleSerializer>;
+    Custom comp({1.0 / 3.0, 2.0, 3.0});
+
+    std::string buffer;
+    comp.SerializeToBuffer(buffer);
+    Custom comp2;
+    comp2.DeserializeFromBuffer(buffer);
+    EXPECT_EQ(comp.Data(), comp2.Data());
+
+    msgs::Double_V msg;
+    msg.add_data(4.0);
+    comp2.DeserializeFromBuffer(msg.SerializeAsString());
+    EXPECT_EQ(std::vector<double>({4.0}), comp2.Data());
+  }
+
+  // Strings and components without data
+  {
+    components::Name comp("name");
+    std::string buffer;
+    comp.SerializeToBuffer(buffer);
+    EXPECT_EQ("name", buffer);
+
+    components::Name comp2;
+    comp2.DeserializeFromBuffer(buffer);
+    EXPECT_EQ("name", comp2.Data());
+
+    using Tag = components::Component<components::NoData, class TagTag>;
+    Tag tag;
+    buffer.clear();
+    tag.SerializeToBuffer(buffer);
+    EXPECT_EQ("-", buffer);
+  }
+
+  // Serializers without buffer functions go through streams
+  {
+    CustomOperator comp;
+    std::string buffer;
+    comp.SerializeToBuffer(buffer);
+    EXPECT_EQ("simple_operator", buffer);
+
+    comp.DeserializeFromBuffer(buffer);
+    EXPECT_EQ(456, comp.Data().data);
+  }
+}
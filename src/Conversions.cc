@@ -128,7 +128,7 @@ msgs::Collision ignition::gazebo::convert(const sdf::Collision &_in)
   msgs::Collision out;
   out.set_name(_in.Name());
   msgs::Set(out.mutable_pose(), _in.RawPose());
-  out.mutable_geometry()->CopyFrom(convert<msgs::Geometry>(*_in.Geom()));
+  set(out.mutable_geometry(), *_in.Geom());
 
   return out;
 }
@@ -151,6 +151,15 @@ IGNITION_GAZEBO_VISIBLE
 msgs::Geometry ignition::gazebo::convert(const sdf::Geometry &_in)
 {
   msgs::Geometry out;
+  set(&out, _in);
+  return out;
+}
+
+//////////////////////////////////////////////////
+void ignition::gazebo::set(msgs::Geometry *_msg, const sdf::Geometry &_in)
+{
+  _msg->Clear();
+  auto &out = *_msg;
   if (_in.Type() == sdf::GeometryType::BOX && _in.BoxShape())
   {
     out.set_type(msgs::Geometry::BOX);
@@ -192,7 +201,6 @@ msgs::Geometry ignition::gazebo::convert(const sdf::Geometry &_in)
     ignerr << "Geometry type [" << static_cast<int>(_in.Type())
            << "] not supported" << std::endl;
   }
-  return out;
 }
 
 //////////////////////////////////////////////////
@@ -265,6 +273,15 @@ IGNITION_GAZEBO_VISIBLE
 msgs::Material ignition::gazebo::convert(const sdf::Material &_in)
 {
   msgs::Material out;
+  set(&out, _in);
+  return out;
+}
+
+//////////////////////////////////////////////////
+void ignition::gazebo::set(msgs::Material *_msg, const sdf::Material &_in)
+{
+  _msg->Clear();
+  auto &out = *_msg;
   msgs::Set(out.mutable_ambient(), _in.Ambient());
   msgs::Set(out.mutable_diffuse(), _in.Diffuse());
   msgs::Set(out.mutable_specular(), _in.Specular());
@@ -316,7 +333,6 @@ msgs::Material ignition::gazebo::convert(const sdf::Material &_in)
           asFullPath(workflow->EmissiveMap(), _in.FilePath()));
     }
   }
-  return out;
 }
 
 //////////////////////////////////////////////////
@@ -455,6 +471,15 @@ IGNITION_GAZEBO_VISIBLE
 msgs::Light ignition::gazebo::convert(const sdf::Light &_in)
 {
   msgs::Light out;
+  set(&out, _in);
+  return out;
+}
+
+//////////////////////////////////////////////////
+void ignition::gazebo::set(msgs::Light *_msg, const sdf::Light &_in)
+{
+  _msg->Clear();
+  auto &out = *_msg;
   out.set_name(_in.Name());
   msgs::Set(out.mutable_pose(), _in.RawPose());
   msgs::Set(out.mutable_diffuse(), _in.Diffuse());
@@ -474,7 +499,6 @@ msgs::Light ignition::gazebo::convert(const sdf::Light &_in)
     out.set_type(msgs::Light_LightType_SPOT);
   else if (_in.Type() == sdf::LightType::DIRECTIONAL)
     out.set_type(msgs::Light_LightType_DIRECTIONAL);
-  return out;
 }
 
 //////////////////////////////////////////////////
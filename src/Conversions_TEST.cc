@@ -773,3 +773,48 @@ TEST(Conversions, Actor)
   EXPECT_EQ(math::Pose3d(6, 5, 4, 0, 0, 0),
       newActor.TrajectoryByIndex(0)->WaypointByIndex(0)->Pose());
 }
+
+/////////////////////////////////////////////////
+TEST(Conversions, SetInPlace)
+{
+  sdf::Box boxShape;
+  boxShape.SetSize(ignition::math::Vector3d(1, 2, 3));
+  sdf::Geometry box;
+  box.SetType(sdf::GeometryType::BOX);
+  box.SetBoxShape(boxShape);
+
+  sdf::Sphere sphereShape;
+  sphereShape.SetRadius(1.5);
+  sdf::Geometry sphere;
+  sphere.SetType(sdf::GeometryType::SPHERE);
+  sphere.SetSphereShape(sphereShape);
+
+  // Reusing a message leaves nothing from its previous contents
+  msgs::Geometry geometryMsg;
+  set(&geometryMsg, box);
+  EXPECT_EQ(convert<msgs::Geometry>(box).DebugString(),
+      geometryMsg.DebugString());
+  set(&geometryMsg, sphere);
+  EXPECT_EQ(msgs::Geometry::SPHERE, geometryMsg.type());
+  EXPECT_FALSE(geometryMsg.has_box());
+  EXPECT_DOUBLE_EQ(1.5, geometryMsg.sphere().radius());
+
+  sdf::Material material;
+  material.SetDiffuse(ignition::math::Color(0.1f, 0.2f, 0.3f, 0.4f));
+  msgs::Material materialMsg;
+  set(&materialMsg, material);
+  set(&materialMsg, material);
+  EXPECT_EQ(convert<msgs::Material>(material).DebugString(),
+      materialMsg.DebugString());
+  EXPECT_EQ(1, materialMsg.header().data_size());
+
+  sdf::Light light;
+  light.SetName("light");
+  light.SetType(sdf::LightType::SPOT);
+  msgs::Light lightMsg;
+  lightMsg.set_id(123);
+  set(&lightMsg, light);
+  EXPECT_EQ(convert<msgs::Light>(light).DebugString(),
+      lightMsg.DebugString());
+  EXPECT_EQ(0u, lightMsg.id());
+}
@@ -15,23 +15,116 @@
  *
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <map>
+#include <mutex>
 #include <set>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <ignition/common/Profiler.hh>
 #include <ignition/math/graph/GraphAlgorithms.hh>
 #include "ignition/gazebo/components/Component.hh"
 #include "ignition/gazebo/components/Factory.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/BinaryState.hh"
+#include "ignition/gazebo/Counter.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/ParallelTasks.hh"
+
+#include "ComponentIndex.hh"
+#include "Tracepoints.hh"
+#include "ValueIndex.hh"
 
 using namespace ignition;
 using namespace gazebo;
 
+/// \brief Structural change recorded while changes are deferred.
+struct DeferredChange
+{
+  /// \brief Kind of change.
+  enum class Kind
+  {
+    CreateEntity,
+    CreateComponent,
+    RemoveComponent,
+    RemoveEntity,
+    RemoveAllEntities,
+    SetParent
+  };
+
+  /// \brief Kind of change.
+  Kind kind;
+
+  /// \brief Entity which is changed.
+  Entity entity{kNullEntity};
+
+  /// \brief New parent, for SetParent.
+  Entity parent{kNullEntity};
+
+  /// \brief Component type, for CreateComponent and RemoveComponent.
+  ComponentTypeId typeId{0};
+
+  /// \brief Id of the created component in the buffer's storage.
+  ComponentId componentId{-1};
+
+  /// \brief Whether descendants are removed too, for RemoveEntity.
+  bool recursive{false};
+};
+
+/// \brief Structural changes recorded by one thread at a time.
+struct ChangeBuffer
+{
+  /// \brief Changes in the order they were made.
+  std::vector<DeferredChange> changes;
+
+  /// \brief Copies of the created components, by type.
+  std::unordered_map<ComponentTypeId, std::unique_ptr<ComponentStorageBase>>
+      components;
+
+  /// \brief Number of entities created into this buffer.
+  uint64_t entities{0};
+};
+
+/// \brief Buffer which the calling thread records changes into.
+struct ThreadChangeBuffer
+{
+  /// \brief Deferral the buffer belongs to, see deferGeneration.
+  uint64_t generation{0};
+
+  /// \brief Index of the buffer.
+  std::size_t index{0};
+};
+
+/// \brief Buffer of the calling thread.
+static thread_local ThreadChangeBuffer tChangeBuffer;
+
+/// \brief Source of deferral generations, shared by all managers, so a
+/// thread's buffer of a previous deferral is never mistaken for a current
+/// one.
+static std::atomic<uint64_t> gDeferGeneration{0};
+
+/// \brief Context which the calling thread's accesses are recorded under,
+/// see EntityComponentManager::SetAccessContext.
+static thread_local std::string tAccessContext;
+
 class ignition::gazebo::EntityComponentManagerPrivate
 {
+  /// \brief Get the buffer which the calling thread records changes into.
+  /// \return The buffer, or nullptr if the thread's changes are applied
+  /// immediately.
+  public: ChangeBuffer *DeferredBuffer();
+
   /// \brief Implementation of the CreateEntity function, which takes a specific
   /// entity as input.
   /// \param[in] _entity Entity to be created.
@@ -45,6 +138,18 @@ class ignition::gazebo::EntityComponentManagerPrivate
   public: void InsertEntityRecursive(Entity _entity,
       std::unordered_set<Entity> &_set);
 
+  /// \brief Get whether an entity is serialized as removed, because it's
+  /// marked to be removed or it was disabled during this step.
+  /// \param[in] _entity Entity to check.
+  /// \return True if the entity is serialized as removed.
+  public: bool SerializedAsRemoved(const Entity _entity) const;
+
+  /// \brief Get whether an entity is left out of serialized states, because
+  /// it was disabled during a previous step.
+  /// \param[in] _entity Entity to check.
+  /// \return True if the entity isn't serialized.
+  public: bool SerializationSkipped(const Entity _entity) const;
+
   /// \brief Register a new component type.
   /// \param[in] _typeId Type if of the new component.
   /// \return True if created successfully.
@@ -72,6 +177,15 @@ class ignition::gazebo::EntityComponentManagerPrivate
       msgs::SerializedStateMap &_msg,
       const std::unordered_set<ComponentTypeId> &_types = {});
 
+  /// \brief Compute the world pose of an entity, reusing and filling
+  /// worldPoseCache. The caller must hold worldPoseCacheMutex.
+  /// \param[in] _ecm Entity component manager owning this object.
+  /// \param[in] _entity Entity.
+  /// \param[in] _pose Pose of the entity relative to its parent.
+  /// \return The world pose.
+  public: math::Pose3d CachedWorldPose(const EntityComponentManager &_ecm,
+      Entity _entity, const math::Pose3d &_pose);
+
   /// \brief Map of component storage classes. The key is a component
   /// type id, and the value is a pointer to the component storage.
   public: std::unordered_map<ComponentTypeId,
@@ -81,12 +195,6 @@ class ignition::gazebo::EntityComponentManagerPrivate
   /// parenting.
   public: EntityGraph entities;
 
-  /// \brief Components that have been changed through a peridic change.
-  public: std::set<ComponentKey> periodicChangedComponents;
-
-  /// \brief Components that have been changed through a one-time change.
-  public: std::set<ComponentKey> oneTimeChangedComponents;
-
   /// \brief Entities that have just been created
   public: std::unordered_set<Entity> newlyCreatedEntities;
 
@@ -96,6 +204,14 @@ class ignition::gazebo::EntityComponentManagerPrivate
   /// \brief Flag that indicates if all entities should be removed.
   public: bool removeAllEntities{false};
 
+  /// \brief Entities disabled with SetEnabled.
+  public: std::unordered_set<Entity> disabledEntities;
+
+  /// \brief Entities disabled during this step. They stay in views as
+  /// removed entities until ProcessRemoveEntityRequests, and are serialized
+  /// as removed.
+  public: std::unordered_set<Entity> toDisableEntities;
+
   /// \brief True if the entityComponents map was changed.  Primarily used
   /// by the multithreading functionality in `State()` to allocate work to
   /// each thread.
@@ -107,6 +223,10 @@ class ignition::gazebo::EntityComponentManagerPrivate
   public: std::unordered_map<Entity,
           std::unordered_map<ComponentTypeId, ComponentKey>> entityComponents;
 
+  /// \brief Entities by the value of their components, for the types which
+  /// are indexed.
+  public: ValueIndex valueIndex;
+
   /// \brief A vector of iterators to evenly distributed spots in the
   /// `entityComponents` map.  Threads in the `State` function use this
   /// vector for easy access of their pre-allocated work.  This vector
@@ -116,6 +236,17 @@ class ignition::gazebo::EntityComponentManagerPrivate
           std::unordered_map<ComponentTypeId, ComponentKey>>::iterator>
             entityComponentIterators;
 
+  /// \brief Finds an entity's component of a given type without going
+  /// through entityComponents. Must be kept in sync with it.
+  public: ComponentIndex componentIndex;
+
+  /// \brief Entities whose component of each type was marked as changed
+  /// since the last SetAllComponentsUnchanged. Entities whose component was
+  /// removed since may still be here, so readers check the component's
+  /// state.
+  public: std::unordered_map<ComponentTypeId, std::unordered_set<Entity>>
+      changedEntities;
+
   /// \brief A mutex to protect newly created entities.
   public: std::mutex entityCreatedMutex;
 
@@ -131,25 +262,194 @@ class ignition::gazebo::EntityComponentManagerPrivate
   /// \brief The set of all views.
   public: mutable std::map<detail::ComponentTypeKey, detail::View> views;
 
+  /// \brief Views indexed by the slot of their component type pack, so
+  /// repeated calls to the templated FindView don't need to look up views
+  /// by their set of types. Null if the slot hasn't been used yet.
+  public: mutable std::vector<detail::View *> viewSlots;
+
+  /// \brief Views which contain each component type, so adding or removing
+  /// a component only updates the views it can affect.
+  public: mutable std::unordered_map<ComponentTypeId,
+      std::vector<std::pair<const detail::ComponentTypeKey *, detail::View *>>>
+      viewsByType;
+
+  /// \brief Number of batches started with BeginBatch and not ended yet.
+  public: mutable unsigned int batchDepth{0};
+
+  /// \brief Entities whose view updates were deferred during a batch.
+  public: mutable std::unordered_set<Entity> pendingViewEntities;
+
+  /// \brief True if all views should be rebuilt once the batch ends.
+  public: mutable bool pendingViewRebuild{false};
+
   /// \brief Cache of previously queried descendants. The key is the parent
   /// entity for which descendants were queried, and the value are all its
   /// descendants.
   public: mutable std::unordered_map<Entity, std::unordered_set<Entity>>
           descendantCache;
 
+  /// \brief A mutex to protect the descendant cache, which is filled by
+  /// const queries that may run concurrently during PostUpdate.
+  public: mutable std::mutex descendantCacheMutex;
+
+  /// \brief A mutex to protect the state thread load, which is calculated
+  /// by const State calls that may run concurrently during PostUpdate.
+  public: std::mutex stateThreadLoadMutex;
+
+  /// \brief World poses computed since the cache was enabled. Poses don't
+  /// change while the cache is enabled, so the pose of each entity, and of
+  /// the ancestors it shares with other entities, is only composed once.
+  public: std::unordered_map<Entity, math::Pose3d> worldPoseCache;
+
+  /// \brief True while world poses may be cached.
+  public: bool worldPoseCacheEnabled{false};
+
+  /// \brief A mutex to protect the world pose cache, which is filled by
+  /// const queries that may run concurrently during PostUpdate.
+  public: mutable std::mutex worldPoseCacheMutex;
+
+  /// \brief Number of components which new storages allocate at once, or
+  /// zero to use the storage default.
+  public: std::size_t componentBlockSize{0};
+
+  /// \brief Worker pool used by ParallelEach and State. Not owned.
+  public: common::WorkerPool *workerPool{nullptr};
+
+  /// \brief Maximum number of threads processing entities at the same time.
+  public: unsigned int workerThreads{1};
+
   /// \brief Keep track of entities already used to ensure uniqueness.
   public: uint64_t entityCount{0};
 
+  /// \brief Buffers of structural changes, see BeginDeferredChanges.
+  public: std::vector<ChangeBuffer> changeBuffers;
+
+  /// \brief True while structural changes may be deferred.
+  public: bool deferringChanges{false};
+
+  /// \brief Generation of the current deferral. Threads whose buffer has
+  /// another generation apply their changes immediately.
+  public: uint64_t deferGeneration{0};
+
+  /// \brief Value of entityCount when changes started being deferred.
+  /// Deferred entities get ids after it.
+  public: uint64_t deferEntityBase{0};
+
+  /// \brief Number of components created.
+  public: Counter componentsCreated;
+
+  /// \brief Number of components removed.
+  public: Counter componentsRemoved;
+
+  /// \brief Number of views created.
+  public: mutable Counter viewsCreated;
+
+  /// \brief Number of times all views were rebuilt.
+  public: Counter viewRebuilds;
+
+  /// \brief Bytes of component data serialized into state.
+  public: mutable Counter stateBytes;
+
+  /// \brief Whether component and view accesses are recorded.
+  public: std::atomic<bool> accessTracing{false};
+
+  /// \brief Protects componentAccesses and viewAccesses.
+  public: mutable std::mutex accessMutex;
+
+  /// \brief Const and mutable accesses, keyed by context then component
+  /// type.
+  public: mutable std::map<std::pair<std::string, ComponentTypeId>,
+      std::pair<uint64_t, uint64_t>> componentAccesses;
+
+  /// \brief View iterations, keyed by context then view types.
+  public: mutable std::map<std::pair<std::string,
+      std::vector<ComponentTypeId>>, EcmAccessStats::ViewAccess> viewAccesses;
+
   /// \brief Unordered multimap of removed components. The key is the entity to
   /// which belongs the component, and the value is the component being
   /// removed.
   std::unordered_multimap<Entity, ComponentKey> removedComponents;
+
+  /// \brief Whether entities were removed since the last complete
+  /// compaction.
+  public: bool compactionPending{false};
+
+  /// \brief Next unit of work of the compaction in progress, see
+  /// EntityComponentManager::Compact.
+  public: std::size_t compactionCursor{0};
+
+  /// \brief Component types whose storage is compacted by the compaction in
+  /// progress.
+  public: std::vector<ComponentTypeId> compactionTypes;
 };
 
+/// \brief Bytes a balanced tree node, like those of std::map and std::set,
+/// adds to its value: three links and a color.
+static constexpr std::size_t kTreeNodeBytes{4 * sizeof(void *)};
+
+/// \brief Estimate the bytes allocated by a vector.
+/// \param[in] _vector Vector.
+/// \return Number of bytes.
+template<typename T>
+static std::size_t VectorBytes(const std::vector<T> &_vector)
+{
+  return _vector.capacity() * sizeof(T);
+}
+
+/// \brief Estimate the bytes allocated by a std::map or std::set.
+/// \param[in] _tree Container.
+/// \return Number of bytes.
+template<typename TreeT>
+static std::size_t TreeBytes(const TreeT &_tree)
+{
+  return _tree.size() * (sizeof(typename TreeT::value_type) + kTreeNodeBytes);
+}
+
+/// \brief Estimate the bytes allocated by a hash container: a bucket array,
+/// and a node with a link and a cached hash for each value.
+/// \param[in] _hash Container.
+/// \return Number of bytes.
+template<typename HashT>
+static std::size_t HashBytes(const HashT &_hash)
+{
+  return _hash.bucket_count() * sizeof(void *) + _hash.size() *
+      (sizeof(typename HashT::value_type) + sizeof(void *) +
+       sizeof(std::size_t));
+}
+
+/// \brief Shrink a hash container if it's mostly empty.
+/// \param[in] _hash Container.
+/// \return True if it was shrunk.
+template<typename HashT>
+static bool CompactHash(HashT &_hash)
+{
+  if ((_hash.size() + 1) * kCompactRatio >= _hash.bucket_count())
+    return false;
+
+  _hash.rehash(0);
+  return true;
+}
+
+/// \brief Shrink a vector if it's mostly empty.
+/// \param[in] _vector Vector.
+/// \return True if it was shrunk.
+template<typename T>
+static bool CompactVector(std::vector<T> &_vector)
+{
+  if ((_vector.size() + 1) * kCompactRatio >= _vector.capacity())
+    return false;
+
+  _vector.shrink_to_fit();
+  return true;
+}
+
 //////////////////////////////////////////////////
 EntityComponentManager::EntityComponentManager()
   : dataPtr(new EntityComponentManagerPrivate)
 {
+  // Most lookups by value are by name or parent
+  this->EnableValueIndex<components::Name>();
+  this->EnableValueIndex<components::ParentEntity>();
 }
 
 //////////////////////////////////////////////////
@@ -161,9 +461,31 @@ size_t EntityComponentManager::EntityCount() const
   return this->dataPtr->entities.Vertices().size();
 }
 
+/////////////////////////////////////////////////
+ChangeBuffer *EntityComponentManagerPrivate::DeferredBuffer()
+{
+  if (!this->deferringChanges ||
+      tChangeBuffer.generation != this->deferGeneration)
+  {
+    return nullptr;
+  }
+  return &this->changeBuffers[tChangeBuffer.index];
+}
+
 /////////////////////////////////////////////////
 Entity EntityComponentManager::CreateEntity()
 {
+  // Ids are interleaved among buffers, so they don't depend on the order in
+  // which threads create entities
+  if (auto buffer = this->dataPtr->DeferredBuffer())
+  {
+    const Entity entity = this->dataPtr->deferEntityBase + 1 +
+        buffer->entities++ * this->dataPtr->changeBuffers.size() +
+        tChangeBuffer.index;
+    buffer->changes.push_back({DeferredChange::Kind::CreateEntity, entity});
+    return entity;
+  }
+
   Entity entity = ++this->dataPtr->entityCount;
 
   if (entity == std::numeric_limits<uint64_t>::max())
@@ -176,6 +498,97 @@ Entity EntityComponentManager::CreateEntity()
   return this->dataPtr->CreateEntityImplementation(entity);
 }
 
+/////////////////////////////////////////////////
+std::vector<Entity> EntityComponentManager::CreateEntities(
+    std::size_t _count)
+{
+  IGN_PROFILE("EntityComponentManager::CreateEntities");
+  std::vector<Entity> result;
+  result.reserve(_count);
+
+  if (nullptr != this->dataPtr->DeferredBuffer())
+  {
+    for (std::size_t i = 0; i < _count; ++i)
+      result.push_back(this->CreateEntity());
+    return result;
+  }
+
+  for (std::size_t i = 0; i < _count; ++i)
+  {
+    Entity entity = ++this->dataPtr->entityCount;
+    if (entity == std::numeric_limits<uint64_t>::max())
+    {
+      ignwarn << "Reached maximum number of entities [" << entity << "]"
+              << std::endl;
+      break;
+    }
+
+    this->dataPtr->entities.AddVertex(std::to_string(entity), entity, entity);
+    result.push_back(entity);
+  }
+
+  // Add all entities to the list of newly created entities at once
+  std::lock_guard<std::mutex> lock(this->dataPtr->entityCreatedMutex);
+  this->dataPtr->newlyCreatedEntities.insert(result.begin(), result.end());
+
+  return result;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::BeginBatch()
+{
+  ++this->dataPtr->batchDepth;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::EndBatch()
+{
+  if (this->dataPtr->batchDepth == 0)
+  {
+    ignwarn << "Ending a batch which wasn't started." << std::endl;
+    return;
+  }
+
+  if (--this->dataPtr->batchDepth == 0)
+    this->ApplyPendingViewUpdates();
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::ApplyPendingViewUpdates() const
+{
+  if (!this->dataPtr->pendingViewRebuild &&
+      this->dataPtr->pendingViewEntities.empty())
+  {
+    return;
+  }
+
+  // Views are mutable, so updating them doesn't change the observable state
+  // of the manager, and const queries may apply pending updates too.
+  auto self = const_cast<EntityComponentManager *>(this);
+
+  // Views are updated immediately while outside a batch
+  const unsigned int depth = this->dataPtr->batchDepth;
+  this->dataPtr->batchDepth = 0;
+
+  std::unordered_set<Entity> pending;
+  std::swap(pending, this->dataPtr->pendingViewEntities);
+  if (this->dataPtr->pendingViewRebuild)
+  {
+    this->dataPtr->pendingViewRebuild = false;
+    self->RebuildViews();
+  }
+  else
+  {
+    for (const Entity entity : pending)
+    {
+      if (this->HasEntity(entity))
+        self->UpdateViews(entity);
+    }
+  }
+
+  this->dataPtr->batchDepth = depth;
+}
+
 /////////////////////////////////////////////////
 Entity EntityComponentManagerPrivate::CreateEntityImplementation(Entity _entity)
 {
@@ -188,8 +601,8 @@ Entity EntityComponentManagerPrivate::CreateEntityImplementation(Entity _entity)
     this->newlyCreatedEntities.insert(_entity);
   }
 
-  // Reset descendants cache
-  this->descendantCache.clear();
+  // A new entity has no parent, so no cached descendant set contains it and
+  // the descendant cache remains valid.
 
   return _entity;
 }
@@ -198,12 +611,32 @@ Entity EntityComponentManagerPrivate::CreateEntityImplementation(Entity _entity)
 void EntityComponentManager::ClearNewlyCreatedEntities()
 {
   std::lock_guard<std::mutex> lock(this->dataPtr->entityCreatedMutex);
-  this->dataPtr->newlyCreatedEntities.clear();
+  if (this->dataPtr->newlyCreatedEntities.empty())
+    return;
 
-  for (auto &view : this->dataPtr->views)
+  // Only views holding one of the new entities have new entities, and they
+  // all have one of the entity's component types
+  std::unordered_set<detail::View *> newViews;
+  for (const Entity entity : this->dataPtr->newlyCreatedEntities)
   {
-    view.second.ClearNewEntities();
+    auto entityIter = this->dataPtr->entityComponents.find(entity);
+    if (entityIter == this->dataPtr->entityComponents.end())
+      continue;
+
+    for (const auto &key : entityIter->second)
+    {
+      auto typeIter = this->dataPtr->viewsByType.find(key.first);
+      if (typeIter == this->dataPtr->viewsByType.end())
+        continue;
+
+      for (const auto &typesView : typeIter->second)
+        newViews.insert(typesView.second);
+    }
   }
+  this->dataPtr->newlyCreatedEntities.clear();
+
+  for (auto view : newViews)
+    view->ClearNewEntities();
 }
 
 /////////////////////////////////////////////////
@@ -224,10 +657,37 @@ void EntityComponentManagerPrivate::InsertEntityRecursive(Entity _entity,
   _set.insert(_entity);
 }
 
+/////////////////////////////////////////////////
+bool EntityComponentManagerPrivate::SerializedAsRemoved(
+    const Entity _entity) const
+{
+  return this->toRemoveEntities.find(_entity) != this->toRemoveEntities.end()
+      || this->toDisableEntities.find(_entity) !=
+      this->toDisableEntities.end();
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManagerPrivate::SerializationSkipped(
+    const Entity _entity) const
+{
+  return !this->disabledEntities.empty() &&
+      this->disabledEntities.find(_entity) != this->disabledEntities.end() &&
+      this->toDisableEntities.find(_entity) == this->toDisableEntities.end();
+}
+
 /////////////////////////////////////////////////
 void EntityComponentManager::RequestRemoveEntity(Entity _entity,
     bool _recursive)
 {
+  // Descendants are found once the request is applied
+  if (auto buffer = this->dataPtr->DeferredBuffer())
+  {
+    DeferredChange change{DeferredChange::Kind::RemoveEntity, _entity};
+    change.recursive = _recursive;
+    buffer->changes.push_back(change);
+    return;
+  }
+
   // Store the to-be-removed entities in a temporary set so we can call
   // UpdateViews on each of them
   std::unordered_set<Entity> tmpToRemoveEntities;
@@ -255,6 +715,12 @@ void EntityComponentManager::RequestRemoveEntity(Entity _entity,
 /////////////////////////////////////////////////
 void EntityComponentManager::RequestRemoveEntities()
 {
+  if (auto buffer = this->dataPtr->DeferredBuffer())
+  {
+    buffer->changes.push_back({DeferredChange::Kind::RemoveAllEntities});
+    return;
+  }
+
   {
     std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
     this->dataPtr->removeAllEntities = true;
@@ -274,21 +740,61 @@ void EntityComponentManager::ProcessRemoveEntityRequests()
     this->dataPtr->removeAllEntities = false;
     this->dataPtr->entities = EntityGraph();
     this->dataPtr->entityComponents.clear();
+    this->dataPtr->componentIndex.Clear();
+    this->dataPtr->valueIndex.Clear();
     this->dataPtr->toRemoveEntities.clear();
+    this->dataPtr->disabledEntities.clear();
+    this->dataPtr->toDisableEntities.clear();
     this->dataPtr->entityComponentsDirty = true;
+    this->dataPtr->compactionPending = true;
 
     for (std::pair<const ComponentTypeId,
         std::unique_ptr<ComponentStorageBase>> &comp: this->dataPtr->components)
     {
+      this->dataPtr->componentsRemoved.Add(comp.second->Size());
       comp.second->RemoveAll();
     }
 
-    // All views are now invalid.
-    this->dataPtr->views.clear();
+    // All views are now empty. They're kept, so that they don't need to
+    // be found and rebuilt on the next Each.
+    for (auto &view : this->dataPtr->views)
+      view.second.Clear();
+
+    // So are all the cached descendants.
+    std::lock_guard<std::mutex> lockCache(this->dataPtr->descendantCacheMutex);
+    this->dataPtr->descendantCache.clear();
   }
   else
   {
     IGN_PROFILE("Remove");
+    // Components to remove, grouped by type so that each storage removes
+    // all of its components in one pass.
+    std::unordered_map<ComponentTypeId, std::vector<ComponentId>>
+        componentsToRemove;
+
+    // Drop the removed entities from the descendant cache while the graph
+    // still holds their ancestors.
+    {
+      std::lock_guard<std::mutex> lockCache(
+          this->dataPtr->descendantCacheMutex);
+      if (!this->dataPtr->descendantCache.empty())
+      {
+        for (const Entity entity : this->dataPtr->toRemoveEntities)
+        {
+          if (!this->HasEntity(entity))
+            continue;
+
+          this->dataPtr->descendantCache.erase(entity);
+          for (const Entity ancestor : this->Ancestors(entity))
+          {
+            auto cacheIter = this->dataPtr->descendantCache.find(ancestor);
+            if (cacheIter != this->dataPtr->descendantCache.end())
+              cacheIter->second.erase(entity);
+          }
+        }
+      }
+    }
+
     // Otherwise iterate through the list of entities to remove.
     for (const Entity entity : this->dataPtr->toRemoveEntities)
     {
@@ -296,6 +802,9 @@ void EntityComponentManager::ProcessRemoveEntityRequests()
       if (!this->HasEntity(entity))
         continue;
 
+      this->dataPtr->disabledEntities.erase(entity);
+      this->dataPtr->toDisableEntities.erase(entity);
+
       // Remove from graph
       this->dataPtr->entities.RemoveVertex(entity);
 
@@ -305,33 +814,73 @@ void EntityComponentManager::ProcessRemoveEntityRequests()
       {
         for (const auto &key : entityIter->second)
         {
-          this->dataPtr->components.at(key.second.first)->Remove(
-              key.second.second);
+          componentsToRemove[key.second.first].push_back(key.second.second);
+          this->dataPtr->componentIndex.Remove(entity, key.first);
+          this->dataPtr->valueIndex.Remove(entity, key.first);
+
+          // Remove the entity from the views of its component types, which
+          // are the only ones that can hold it.
+          auto typeIter = this->dataPtr->viewsByType.find(key.first);
+          if (typeIter == this->dataPtr->viewsByType.end())
+            continue;
+          for (auto &[types, view] : typeIter->second)
+            view->RemoveEntity(entity, *types);
         }
 
         // Remove the entry in the entityComponent map
-        this->dataPtr->entityComponents.erase(entity);
+        this->dataPtr->entityComponents.erase(entityIter);
         this->dataPtr->entityComponentsDirty = true;
       }
+    }
 
-      // Remove the entity from views.
-      for (auto &view : this->dataPtr->views)
-      {
-        view.second.RemoveEntity(entity, view.first);
-      }
+    if (!componentsToRemove.empty())
+      this->dataPtr->compactionPending = true;
+
+    for (const auto &typeComponents : componentsToRemove)
+    {
+      this->dataPtr->componentsRemoved.Add(
+          this->dataPtr->components.at(typeComponents.first)->Remove(
+          typeComponents.second));
     }
+
     // Clear the set of entities to remove.
     this->dataPtr->toRemoveEntities.clear();
-  }
 
-  // Reset descendants cache
-  this->dataPtr->descendantCache.clear();
+    // Entities disabled during this step now leave the views, keeping their
+    // components.
+    for (const Entity entity : this->dataPtr->toDisableEntities)
+    {
+      auto entityIter = this->dataPtr->entityComponents.find(entity);
+      if (entityIter == this->dataPtr->entityComponents.end())
+        continue;
+
+      for (const auto &key : entityIter->second)
+      {
+        auto typeIter = this->dataPtr->viewsByType.find(key.first);
+        if (typeIter == this->dataPtr->viewsByType.end())
+          continue;
+        for (auto &[types, view] : typeIter->second)
+          view->RemoveEntity(entity, *types);
+      }
+    }
+    this->dataPtr->toDisableEntities.clear();
+  }
 }
 
 /////////////////////////////////////////////////
 bool EntityComponentManager::RemoveComponent(
     const Entity _entity, const ComponentTypeId &_typeId)
 {
+  // The component may be created by a deferred change, so it's only looked
+  // up once the change is applied
+  if (auto buffer = this->dataPtr->DeferredBuffer())
+  {
+    DeferredChange change{DeferredChange::Kind::RemoveComponent, _entity};
+    change.typeId = _typeId;
+    buffer->changes.push_back(change);
+    return true;
+  }
+
   auto componentId = this->EntityComponentIdFromType(_entity, _typeId);
   ComponentKey key{_typeId, componentId};
   return this->RemoveComponent(_entity, key);
@@ -342,17 +891,22 @@ bool EntityComponentManager::RemoveComponent(
     const Entity _entity, const ComponentKey &_key)
 {
   IGN_PROFILE("EntityComponentManager::RemoveComponent");
+  if (nullptr != this->dataPtr->DeferredBuffer())
+    return this->RemoveComponent(_entity, _key.first);
+
   // Make sure the entity exists and has the component.
   if (!this->EntityHasComponent(_entity, _key))
     return false;
 
   this->dataPtr->components.at(_key.first)->Remove(_key.second);
+  this->dataPtr->componentsRemoved.Add();
+  IGN_GAZEBO_TRACEPOINT2(component_removed, _entity, _key.first);
   this->dataPtr->entityComponents[_entity].erase(_key.first);
-  this->dataPtr->oneTimeChangedComponents.erase(_key);
-  this->dataPtr->periodicChangedComponents.erase(_key);
+  this->dataPtr->componentIndex.Remove(_entity, _key.first);
+  this->dataPtr->valueIndex.Remove(_entity, _key.first);
   this->dataPtr->entityComponentsDirty = true;
 
-  this->UpdateViews(_entity);
+  this->UpdateViews(_entity, _key.first);
 
   // Add component to map of removed components
   {
@@ -369,8 +923,13 @@ bool EntityComponentManager::EntityHasComponent(const Entity _entity,
 {
   if (!this->HasEntity(_entity))
     return false;
-  auto &compMap = this->dataPtr->entityComponents[_entity];
-  return compMap.find(_key.first) != compMap.end();
+
+  // Don't use operator[], this may be called concurrently by PostUpdate
+  // systems and must not modify the map.
+  auto iter = this->dataPtr->entityComponents.find(_entity);
+  if (iter == this->dataPtr->entityComponents.end())
+    return false;
+  return iter->second.find(_key.first) != iter->second.end();
 }
 
 /////////////////////////////////////////////////
@@ -380,13 +939,8 @@ bool EntityComponentManager::EntityHasComponentType(const Entity _entity,
   if (!this->HasEntity(_entity))
     return false;
 
-  auto iter = this->dataPtr->entityComponents.find(_entity);
-
-  if (iter == this->dataPtr->entityComponents.end())
-    return false;
-
-  auto typeIter = iter->second.find(_typeId);
-  return (typeIter != iter->second.end());
+  return nullptr !=
+      this->dataPtr->componentIndex.Find(_entity, _typeId).storage;
 }
 
 /////////////////////////////////////////////////
@@ -410,66 +964,152 @@ bool EntityComponentManager::IsMarkedForRemoval(const Entity _entity) const
 }
 
 /////////////////////////////////////////////////
-ComponentState EntityComponentManager::ComponentState(const Entity _entity,
-    const ComponentTypeId _typeId) const
+bool EntityComponentManager::IsLeavingViews(const Entity _entity) const
 {
-  auto result = ComponentState::NoChange;
-
-  auto ecIter = this->dataPtr->entityComponents.find(_entity);
-
-  if (ecIter == this->dataPtr->entityComponents.end())
-    return result;
-
-  auto typeKey = ecIter->second.find(_typeId);
-  if (typeKey == ecIter->second.end())
-    return result;
-
-  if (this->dataPtr->oneTimeChangedComponents.find(typeKey->second) !=
-      this->dataPtr->oneTimeChangedComponents.end())
-  {
-    result = ComponentState::OneTimeChange;
-  }
-  else if (this->dataPtr->periodicChangedComponents.find(typeKey->second) !=
-      this->dataPtr->periodicChangedComponents.end())
+  if (this->dataPtr->toDisableEntities.find(_entity) !=
+      this->dataPtr->toDisableEntities.end())
   {
-    result = ComponentState::PeriodicChange;
+    return true;
   }
-
-  return result;
-}
-
-/////////////////////////////////////////////////
-bool EntityComponentManager::HasNewEntities() const
-{
-  std::lock_guard<std::mutex> lock(this->dataPtr->entityCreatedMutex);
-  return !this->dataPtr->newlyCreatedEntities.empty();
+  return this->IsMarkedForRemoval(_entity);
 }
 
 /////////////////////////////////////////////////
-bool EntityComponentManager::HasEntitiesMarkedForRemoval() const
+bool EntityComponentManager::ViewMatches(Entity _entity,
+    const std::set<ComponentTypeId> &_types) const
 {
-  std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
-  return this->dataPtr->removeAllEntities ||
-      !this->dataPtr->toRemoveEntities.empty();
+  // Disabled entities are only kept until the end of the step they were
+  // disabled in, so systems see them as removed
+  if (!this->dataPtr->disabledEntities.empty() &&
+      this->dataPtr->disabledEntities.find(_entity) !=
+      this->dataPtr->disabledEntities.end() &&
+      this->dataPtr->toDisableEntities.find(_entity) ==
+      this->dataPtr->toDisableEntities.end())
+  {
+    return false;
+  }
+  return this->EntityMatches(_entity, _types);
 }
 
 /////////////////////////////////////////////////
-bool EntityComponentManager::HasOneTimeComponentChanges() const
+void EntityComponentManager::SetEnabled(const Entity _entity,
+    const bool _enabled, const bool _recursive)
 {
-  return !this->dataPtr->oneTimeChangedComponents.empty();
-}
+  std::unordered_set<Entity> entities;
+  if (_recursive)
+    this->dataPtr->InsertEntityRecursive(_entity, entities);
+  else
+    entities.insert(_entity);
 
-/////////////////////////////////////////////////
-std::unordered_set<ComponentTypeId>
-    EntityComponentManager::ComponentTypesWithPeriodicChanges() const
-{
-  std::unordered_set<ComponentTypeId> periodicComponents;
-  for (const auto& compPair : this->dataPtr->periodicChangedComponents)
+  for (const Entity entity : entities)
   {
-    periodicComponents.insert(compPair.first);
-  }
-  return periodicComponents;
-}
+    if (!this->HasEntity(entity))
+      continue;
+
+    auto &disabled = this->dataPtr->disabledEntities;
+    if (_enabled)
+    {
+      if (disabled.erase(entity) == 0)
+        continue;
+
+      // Enabled again before leaving the views, stay there as if nothing
+      // happened
+      if (this->dataPtr->toDisableEntities.erase(entity) > 0)
+      {
+        auto entityIter = this->dataPtr->entityComponents.find(entity);
+        if (entityIter != this->dataPtr->entityComponents.end())
+        {
+          for (const auto &key : entityIter->second)
+          {
+            auto typeIter = this->dataPtr->viewsByType.find(key.first);
+            if (typeIter == this->dataPtr->viewsByType.end())
+              continue;
+            for (auto &typesView : typeIter->second)
+              typesView.second->toRemoveEntities.erase(entity);
+          }
+        }
+      }
+      // Otherwise it comes back as a new entity, with all of its components
+      // in the next serialized state
+      else
+      {
+        {
+          std::lock_guard<std::mutex> lock(
+              this->dataPtr->entityCreatedMutex);
+          this->dataPtr->newlyCreatedEntities.insert(entity);
+        }
+        for (const ComponentTypeId type : this->ComponentTypes(entity))
+          this->SetChanged(entity, type, ComponentState::OneTimeChange);
+      }
+    }
+    else
+    {
+      if (!disabled.insert(entity).second)
+        continue;
+      this->dataPtr->toDisableEntities.insert(entity);
+    }
+
+    this->UpdateViews(entity);
+  }
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::IsEnabled(const Entity _entity) const
+{
+  return this->dataPtr->disabledEntities.find(_entity) ==
+      this->dataPtr->disabledEntities.end();
+}
+
+/////////////////////////////////////////////////
+ComponentState EntityComponentManager::ComponentState(const Entity _entity,
+    const ComponentTypeId _typeId) const
+{
+  auto lookup = this->dataPtr->componentIndex.Find(_entity, _typeId);
+  if (nullptr == lookup.storage)
+    return ComponentState::NoChange;
+
+  return lookup.storage->State(lookup.id);
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::HasNewEntities() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->entityCreatedMutex);
+  return !this->dataPtr->newlyCreatedEntities.empty();
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::HasEntitiesMarkedForRemoval() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
+  return this->dataPtr->removeAllEntities ||
+      !this->dataPtr->toRemoveEntities.empty() ||
+      !this->dataPtr->toDisableEntities.empty();
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::HasOneTimeComponentChanges() const
+{
+  for (const auto &storage : this->dataPtr->components)
+  {
+    if (storage.second->HasOneTimeChanges())
+      return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+std::unordered_set<ComponentTypeId>
+    EntityComponentManager::ComponentTypesWithPeriodicChanges() const
+{
+  std::unordered_set<ComponentTypeId> periodicComponents;
+  for (const auto &storage : this->dataPtr->components)
+  {
+    if (storage.second->HasPeriodicChanges())
+      periodicComponents.insert(storage.first);
+  }
+  return periodicComponents;
+}
 
 /////////////////////////////////////////////////
 bool EntityComponentManager::HasEntity(const Entity _entity) const
@@ -493,10 +1133,52 @@ Entity EntityComponentManager::ParentEntity(const Entity _entity) const
 bool EntityComponentManager::SetParentEntity(const Entity _child,
     const Entity _parent)
 {
+  if (auto buffer = this->dataPtr->DeferredBuffer())
+  {
+    DeferredChange change{DeferredChange::Kind::SetParent, _child};
+    change.parent = _parent;
+    buffer->changes.push_back(change);
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->descendantCacheMutex);
+
+  // The child's subtree moves along with it, so it has to be taken out of
+  // the cached descendants of the old ancestors and added to the cached
+  // descendants of the new ones.
+  std::vector<Entity> subtree;
+  if (!this->dataPtr->descendantCache.empty() && this->HasEntity(_child))
+  {
+    subtree = math::graph::BreadthFirstSort(this->dataPtr->entities, _child);
+  }
+
+  auto updateCache = [&](const Entity _entity, bool _insert)
+  {
+    if (subtree.empty() || _entity == kNullEntity)
+      return;
+
+    std::vector<Entity> chain = this->Ancestors(_entity);
+    chain.insert(chain.begin(), _entity);
+    for (const Entity ancestor : chain)
+    {
+      auto cacheIter = this->dataPtr->descendantCache.find(ancestor);
+      if (cacheIter == this->dataPtr->descendantCache.end())
+        continue;
+      for (const Entity descendant : subtree)
+      {
+        if (_insert)
+          cacheIter->second.insert(descendant);
+        else
+          cacheIter->second.erase(descendant);
+      }
+    }
+  };
+
   // Remove current parent(s)
   auto parents = this->Entities().AdjacentsTo(_child);
   for (const auto &parent : parents)
   {
+    updateCache(parent.first, false);
     auto edge = this->dataPtr->entities.EdgeFromVertices(parent.first, _child);
     this->dataPtr->entities.RemoveEdge(edge);
   }
@@ -509,7 +1191,52 @@ bool EntityComponentManager::SetParentEntity(const Entity _child,
 
   // Add edge
   auto edge = this->dataPtr->entities.AddEdge({_parent, _child}, true);
-  return (math::graph::kNullId != edge.Id());
+  if (math::graph::kNullId == edge.Id())
+    return false;
+
+  updateCache(_parent, true);
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::vector<Entity> EntityComponentManager::Ancestors(
+    const Entity _entity) const
+{
+  std::vector<Entity> ancestors;
+
+  Entity entity = this->ParentEntity(_entity);
+  while (entity != kNullEntity)
+  {
+    // Trees are shallow, so a linear search is enough to guard against a
+    // malformed graph with cycles.
+    if (entity == _entity ||
+        std::find(ancestors.begin(), ancestors.end(), entity) !=
+        ancestors.end())
+    {
+      break;
+    }
+    ancestors.push_back(entity);
+    entity = this->ParentEntity(entity);
+  }
+  return ancestors;
+}
+
+/////////////////////////////////////////////////
+Entity EntityComponentManager::TopLevelModel(const Entity _entity) const
+{
+  if (!this->HasEntity(_entity))
+    return kNullEntity;
+
+  Entity modelEntity = kNullEntity;
+  if (nullptr != this->Component<components::Model>(_entity))
+    modelEntity = _entity;
+
+  for (const Entity ancestor : this->Ancestors(_entity))
+  {
+    if (nullptr != this->Component<components::Model>(ancestor))
+      modelEntity = ancestor;
+  }
+  return modelEntity;
 }
 
 /////////////////////////////////////////////////
@@ -517,6 +1244,28 @@ ComponentKey EntityComponentManager::CreateComponentImplementation(
     const Entity _entity, const ComponentTypeId _componentTypeId,
     const components::BaseComponent *_data)
 {
+  // The data is copied into a storage of the buffer until the change is
+  // applied
+  if (auto buffer = this->dataPtr->DeferredBuffer())
+  {
+    auto &storage = buffer->components[_componentTypeId];
+    if (nullptr == storage)
+      storage = components::Factory::Instance()->NewStorage(_componentTypeId);
+    if (nullptr == storage)
+    {
+      ignerr << "Failed to create component of type [" << _componentTypeId
+             << "] for entity [" << _entity
+             << "]. Type has not been properly registered." << std::endl;
+      return ComponentKey();
+    }
+
+    DeferredChange change{DeferredChange::Kind::CreateComponent, _entity};
+    change.typeId = _componentTypeId;
+    change.componentId = storage->Create(_data).first;
+    buffer->changes.push_back(change);
+    return {_componentTypeId, -1};
+  }
+
   // If type hasn't been instantiated yet, create a storage for it
   if (!this->HasComponentType(_componentTypeId))
   {
@@ -530,20 +1279,33 @@ ComponentKey EntityComponentManager::CreateComponentImplementation(
   }
 
   // Instantiate the new component.
-  std::pair<ComponentId, bool> componentIdPair =
-    this->dataPtr->components[_componentTypeId]->Create(_data);
+  auto &storage = this->dataPtr->components[_componentTypeId];
+  std::pair<ComponentId, bool> componentIdPair = storage->Create(_data);
 
   ComponentKey componentKey{_componentTypeId, componentIdPair.first};
+  this->dataPtr->componentsCreated.Add();
+  IGN_GAZEBO_TRACEPOINT2(component_created, _entity, _componentTypeId);
+
+  // New components start with a one-time change, tracked by the storage
+  auto inserted = this->dataPtr->entityComponents[_entity].insert(
+      {_componentTypeId, componentKey}).second;
+  if (inserted)
+  {
+    this->dataPtr->componentIndex.Set(_entity, _componentTypeId,
+        componentIdPair.first, storage.get());
+    this->dataPtr->changedEntities[_componentTypeId].insert(_entity);
 
-  this->dataPtr->entityComponents[_entity].insert(
-      {_componentTypeId, componentKey});
-  this->dataPtr->oneTimeChangedComponents.insert(componentKey);
+    if (storage->ValueIndexed())
+    {
+      this->dataPtr->valueIndex.Set(_entity, _componentTypeId,
+          *storage->Component(componentIdPair.first));
+    }
+  }
   this->dataPtr->entityComponentsDirty = true;
 
-  if (componentIdPair.second)
-    this->RebuildViews();
-  else
-    this->UpdateViews(_entity);
+  // Views keep component ids and refresh their pointers when a storage
+  // relocates components, so they don't need a rebuild if the storage grew
+  this->UpdateViews(_entity, _componentTypeId);
 
   return componentKey;
 }
@@ -574,16 +1336,32 @@ bool EntityComponentManager::EntityMatches(Entity _entity,
 ComponentId EntityComponentManager::EntityComponentIdFromType(
     const Entity _entity, const ComponentTypeId _type) const
 {
-  auto ecIter = this->dataPtr->entityComponents.find(_entity);
-
-  if (ecIter == this->dataPtr->entityComponents.end())
+  auto lookup = this->dataPtr->componentIndex.Find(_entity, _type);
+  if (nullptr == lookup.storage)
     return -1;
 
-  auto typeIter = ecIter->second.find(_type);
-  if (typeIter != ecIter->second.end())
-    return typeIter->second.second;
+  return lookup.id;
+}
+
+/////////////////////////////////////////////////
+ComponentStorageBase *EntityComponentManager::StorageImplementation(
+    const Entity _entity, const ComponentTypeId _type, ComponentId &_id,
+    bool _mutable) const
+{
+  IGN_PROFILE("EntityComponentManager::StorageImplementation");
+  if (this->dataPtr->accessTracing)
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->accessMutex);
+    auto &count = this->dataPtr->componentAccesses[{tAccessContext, _type}];
+    if (_mutable)
+      ++count.second;
+    else
+      ++count.first;
+  }
 
-  return -1;
+  auto lookup = this->dataPtr->componentIndex.Find(_entity, _type);
+  _id = lookup.id;
+  return lookup.storage;
 }
 
 /////////////////////////////////////////////////
@@ -592,34 +1370,22 @@ const components::BaseComponent
     const Entity _entity, const ComponentTypeId _type) const
 {
   IGN_PROFILE("EntityComponentManager::ComponentImplementation");
-  auto ecIter = this->dataPtr->entityComponents.find(_entity);
-
-  if (ecIter == this->dataPtr->entityComponents.end())
+  auto lookup = this->dataPtr->componentIndex.Find(_entity, _type);
+  if (nullptr == lookup.storage)
     return nullptr;
 
-  auto typeIter = ecIter->second.find(_type);
-  if (typeIter != ecIter->second.end())
-    return this->dataPtr->components.at(typeIter->second.first)->Component(
-        typeIter->second.second);
-
-  return nullptr;
+  return lookup.storage->Component(lookup.id);
 }
 
 /////////////////////////////////////////////////
 components::BaseComponent *EntityComponentManager::ComponentImplementation(
     const Entity _entity, const ComponentTypeId _type)
 {
-  auto ecIter = this->dataPtr->entityComponents.find(_entity);
-
-  if (ecIter == this->dataPtr->entityComponents.end())
+  auto lookup = this->dataPtr->componentIndex.Find(_entity, _type);
+  if (nullptr == lookup.storage)
     return nullptr;
 
-  auto typeIter = ecIter->second.find(_type);
-  if (typeIter != ecIter->second.end())
-    return this->dataPtr->components.at(typeIter->second.first)->Component(
-        typeIter->second.second);
-
-  return nullptr;
+  return lookup.storage->Component(lookup.id);
 }
 
 /////////////////////////////////////////////////
@@ -668,6 +1434,11 @@ bool EntityComponentManagerPrivate::CreateComponentStorage(
     return false;
   }
 
+  if (this->componentBlockSize > 0)
+    storage->SetBlockSize(this->componentBlockSize);
+
+  storage->SetValueIndexed(this->valueIndex.Enabled(_typeId));
+
   this->components[_typeId] = std::move(storage);
   igndbg << "Using components of type [" << _typeId << "] / ["
          << components::Factory::Instance()->Name(_typeId) << "].\n";
@@ -698,8 +1469,45 @@ bool EntityComponentManager::FindView(const std::set<ComponentTypeId> &_types,
     std::map<detail::ComponentTypeKey, detail::View>::iterator &_iter) const
 {
   std::lock_guard<std::mutex> lockViews(this->dataPtr->viewsMutex);
+
+  // Views must reflect changes made so far in an ongoing batch
+  this->ApplyPendingViewUpdates();
+
   _iter = this->dataPtr->views.find(_types);
-  return _iter != this->dataPtr->views.end();
+  if (_iter == this->dataPtr->views.end())
+    return false;
+
+  // Refresh cached component pointers while holding the lock, so that
+  // concurrent readers never update the same view.
+  _iter->second.Refresh();
+  return true;
+}
+
+//////////////////////////////////////////////////
+detail::View *EntityComponentManager::FindView(const std::size_t _slot) const
+{
+  std::lock_guard<std::mutex> lockViews(this->dataPtr->viewsMutex);
+  if (_slot >= this->dataPtr->viewSlots.size() ||
+      nullptr == this->dataPtr->viewSlots[_slot])
+  {
+    return nullptr;
+  }
+
+  this->ApplyPendingViewUpdates();
+
+  auto view = this->dataPtr->viewSlots[_slot];
+  view->Refresh();
+  return view;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::SetViewSlot(const std::size_t _slot,
+    detail::View &_view) const
+{
+  std::lock_guard<std::mutex> lockViews(this->dataPtr->viewsMutex);
+  if (_slot >= this->dataPtr->viewSlots.size())
+    this->dataPtr->viewSlots.resize(_slot + 1, nullptr);
+  this->dataPtr->viewSlots[_slot] = &_view;
 }
 
 //////////////////////////////////////////////////
@@ -710,36 +1518,72 @@ std::map<detail::ComponentTypeKey, detail::View>::iterator
   // If the view already exists, then the map will return the iterator to
   // the location that prevented the insertion.
   std::lock_guard<std::mutex> lockViews(this->dataPtr->viewsMutex);
-  return this->dataPtr->views.insert(
-      std::make_pair(_types, std::move(_view))).first;
+  auto result = this->dataPtr->views.insert(
+      std::make_pair(_types, std::move(_view)));
+  if (result.second)
+  {
+    this->dataPtr->viewsCreated.Add();
+    for (const auto &type : _types)
+    {
+      this->dataPtr->viewsByType[type].emplace_back(
+          &result.first->first, &result.first->second);
+    }
+  }
+  return result.first;
 }
 
 //////////////////////////////////////////////////
 void EntityComponentManager::UpdateViews(const Entity _entity)
 {
   IGN_PROFILE("EntityComponentManager::UpdateViews");
+  if (this->dataPtr->batchDepth > 0)
+  {
+    this->dataPtr->pendingViewEntities.insert(_entity);
+    return;
+  }
+
   for (auto &view : this->dataPtr->views)
+    this->UpdateView(view.second, view.first, _entity);
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::UpdateViews(const Entity _entity,
+    const ComponentTypeId _typeId)
+{
+  IGN_PROFILE("EntityComponentManager::UpdateViews");
+  if (this->dataPtr->batchDepth > 0)
   {
-    // Add/update the entity if it matches the view.
-    if (this->EntityMatches(_entity, view.first))
-    {
-      view.second.AddEntity(_entity, this->IsNewEntity(_entity));
-      // If there is a request to delete this entity, update the view as
-      // well
-      if (this->IsMarkedForRemoval(_entity))
-      {
-        view.second.AddEntityToRemoved(_entity);
-      }
-      for (const ComponentTypeId &compTypeId : view.first)
-      {
-        view.second.AddComponent(_entity, compTypeId,
-            this->EntityComponentIdFromType(_entity, compTypeId));
-      }
-    }
-    else
+    this->dataPtr->pendingViewEntities.insert(_entity);
+    return;
+  }
+
+  auto it = this->dataPtr->viewsByType.find(_typeId);
+  if (it == this->dataPtr->viewsByType.end())
+    return;
+
+  for (auto &[types, view] : it->second)
+    this->UpdateView(*view, *types, _entity);
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::UpdateView(detail::View &_view,
+    const detail::ComponentTypeKey &_types, const Entity _entity)
+{
+  // Add/update the entity if it matches the view.
+  if (this->ViewMatches(_entity, _types))
+  {
+    _view.AddEntity(_entity, this->IsNewEntity(_entity));
+    // If there is a request to delete this entity, update the view as
+    // well
+    if (this->IsLeavingViews(_entity))
     {
-      view.second.RemoveEntity(_entity, view.first);
+      _view.AddEntityToRemoved(_entity);
     }
+    this->AddComponentsToView(_view, _entity);
+  }
+  else
+  {
+    _view.RemoveEntity(_entity, _types);
   }
 }
 
@@ -747,37 +1591,60 @@ void EntityComponentManager::UpdateViews(const Entity _entity)
 void EntityComponentManager::RebuildViews()
 {
   IGN_PROFILE("EntityComponentManager::RebuildViews");
+  if (this->dataPtr->batchDepth > 0)
+  {
+    this->dataPtr->pendingViewRebuild = true;
+    return;
+  }
+
+  this->dataPtr->viewRebuilds.Add();
+  IGN_GAZEBO_TRACEPOINT1(view_rebuild, this->dataPtr->views.size());
+
   for (auto &view : this->dataPtr->views)
   {
-    view.second.entities.clear();
-    view.second.components.clear();
+    view.second.Clear();
     // Add all the entities that match the component types to the
     // view.
     for (const auto &vertex : this->dataPtr->entities.Vertices())
     {
       Entity entity = vertex.first;
-      if (this->EntityMatches(entity, view.first))
+      if (this->ViewMatches(entity, view.first))
       {
         view.second.AddEntity(entity, this->IsNewEntity(entity));
         // If there is a request to delete this entity, update the view as
         // well
-        if (this->IsMarkedForRemoval(entity))
+        if (this->IsLeavingViews(entity))
         {
           view.second.AddEntityToRemoved(entity);
         }
-        // Store pointers to all the components. This recursively adds
-        // all the ComponentTypeTs that belong to the entity to the view.
-        for (const ComponentTypeId &compTypeId : view.first)
-        {
-          view.second.AddComponent(entity, compTypeId,
-              this->EntityComponentIdFromType(
-                entity, compTypeId));
-        }
+        // Store pointers to all the components.
+        this->AddComponentsToView(view.second, entity);
       }
     }
   }
 }
 
+//////////////////////////////////////////////////
+void EntityComponentManager::AddComponentsToView(detail::View &_view,
+    const Entity _entity) const
+{
+  for (const ComponentTypeId &compTypeId : _view.columnTypes)
+  {
+    const ComponentId compId =
+        this->EntityComponentIdFromType(_entity, compTypeId);
+    auto storageIter = this->dataPtr->components.find(compTypeId);
+    if (compId < 0 || storageIter == this->dataPtr->components.end())
+    {
+      ignerr << "Entity[" << _entity << "] has no component of type["
+        << compTypeId << "]. This should never happen.\n";
+      continue;
+    }
+
+    // Add the component to the view.
+    _view.AddComponent(_entity, compTypeId, compId, storageIter->second.get());
+  }
+}
+
 //////////////////////////////////////////////////
 void EntityComponentManagerPrivate::SetRemovedComponentsMsgs(Entity &_entity,
     msgs::SerializedEntity *_entityMsg,
@@ -817,15 +1684,8 @@ void EntityComponentManagerPrivate::SetRemovedComponentsMsgs(Entity &_entity,
   // instance, when AddEntityToMessage() calls this function, the entity may
   // have some removed components but none in entityComponents that changed,
   // so the entity may not have been added to the message beforehand.
-  auto entIter = _msg.mutable_entities()->find(_entity);
-  if (entIter == _msg.mutable_entities()->end())
-  {
-    msgs::SerializedEntityMap ent;
-    ent.set_id(_entity);
-    entIter =
-      (_msg.mutable_entities())->insert({static_cast<uint64_t>(_entity), ent})
-      .first;
-  }
+  auto &entMsg = (*_msg.mutable_entities())[static_cast<uint64_t>(_entity)];
+  entMsg.set_id(_entity);
 
   auto entRemovedComps = this->removedComponents.equal_range(_entity);
   for (auto it = entRemovedComps.first; it != entRemovedComps.second; ++it)
@@ -837,15 +1697,13 @@ void EntityComponentManagerPrivate::SetRemovedComponentsMsgs(Entity &_entity,
       continue;
     }
 
-    msgs::SerializedComponent compMsg;
+    auto &compMsg = (*entMsg.mutable_components())[
+        static_cast<int64_t>(removedComponent.first)];
 
     // Empty data is needed for the component to be processed afterwards
     compMsg.set_component(" ");
     compMsg.set_type(removedComponent.first);
     compMsg.set_remove(true);
-
-    (*(entIter->second.mutable_components()))[
-      static_cast<int64_t>(removedComponent.first)] = compMsg;
   }
 }
 
@@ -853,14 +1711,16 @@ void EntityComponentManagerPrivate::SetRemovedComponentsMsgs(Entity &_entity,
 void EntityComponentManager::AddEntityToMessage(msgs::SerializedState &_msg,
     Entity _entity, const std::unordered_set<ComponentTypeId> &_types) const
 {
+  if (this->dataPtr->SerializationSkipped(_entity))
+    return;
+
   auto entityMsg = _msg.add_entities();
   entityMsg->set_id(_entity);
   auto iter = this->dataPtr->entityComponents.find(_entity);
   if (iter == this->dataPtr->entityComponents.end())
     return;
 
-  if (this->dataPtr->toRemoveEntities.find(_entity) !=
-      this->dataPtr->toRemoveEntities.end())
+  if (this->dataPtr->SerializedAsRemoved(_entity))
   {
     entityMsg->set_remove(true);
   }
@@ -870,7 +1730,7 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedState &_msg,
   auto types = _types;
   if (types.empty())
   {
-    for (auto &type : this->dataPtr->entityComponents[_entity])
+    for (auto &type : iter->second)
     {
       types.insert(type.first);
     }
@@ -891,10 +1751,10 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedState &_msg,
     auto compBase = this->ComponentImplementation(_entity, comp.first);
     compMsg->set_type(compBase->TypeId());
 
-    std::ostringstream ostr;
-    compBase->Serialize(ostr);
-
-    compMsg->set_component(ostr.str());
+    compBase->SerializeToBuffer(*compMsg->mutable_component());
+    this->dataPtr->stateBytes.Add(compMsg->component().size());
+    IGN_GAZEBO_TRACEPOINT2(state_serialized, _entity,
+        compMsg->component().size());
   }
 
   // Add a component to the message and set it to be removed if the component
@@ -908,95 +1768,69 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedStateMap &_msg,
     bool _full) const
 {
   auto iter = this->dataPtr->entityComponents.find(_entity);
-  if (iter == this->dataPtr->entityComponents.end())
+  if (iter == this->dataPtr->entityComponents.end() ||
+      this->dataPtr->SerializationSkipped(_entity))
+  {
     return;
+  }
 
-  // Set the default entity iterator to the end. This will allow us to know
-  // if the entity has been added to the message.
-  auto entIter = _msg.mutable_entities()->end();
-  // Add an entity to the message and set it to be removed if the entity
-  // exists in the toRemoveEntities list.
-  if (this->dataPtr->toRemoveEntities.find(_entity) !=
-      this->dataPtr->toRemoveEntities.end())
+  // The entity's message, created in place the first time it's needed
+  msgs::SerializedEntityMap *entMsg{nullptr};
+  auto entityMsg = [&]() -> msgs::SerializedEntityMap &
   {
-    // Find the entity in the message, and add if not present.
-    entIter = _msg.mutable_entities()->find(_entity);
-    if (entIter == _msg.mutable_entities()->end())
+    if (nullptr == entMsg)
     {
-      msgs::SerializedEntityMap ent;
-      ent.set_id(_entity);
-      (*_msg.mutable_entities())[static_cast<uint64_t>(_entity)] = ent;
-      entIter = _msg.mutable_entities()->find(_entity);
+      entMsg = &(*_msg.mutable_entities())[static_cast<uint64_t>(_entity)];
+      entMsg->set_id(_entity);
     }
+    return *entMsg;
+  };
 
-    entIter->second.set_remove(true);
-  }
-
-  // Insert all of the entity's components if the passed in types
-  // set is empty
-  auto types = _types;
-  if (types.empty())
+  // Add an entity to the message and set it to be removed if the entity
+  // exists in the toRemoveEntities list, or was just disabled.
+  if (this->dataPtr->SerializedAsRemoved(_entity))
   {
-    for (auto &type : this->dataPtr->entityComponents[_entity])
-    {
-      types.insert(type.first);
-    }
+    entityMsg().set_remove(true);
   }
 
-  // Empty means all types
-  for (const ComponentTypeId type : types)
+  auto addComponent = [&](const ComponentKey &_comp)
   {
-    std::unordered_map<ComponentTypeId, ComponentKey>::iterator typeIter =
-      iter->second.find(type);
-    if (typeIter == iter->second.end())
-    {
-      continue;
-    }
-
-    ComponentKey comp = typeIter->second;
     const components::BaseComponent *compBase =
-      this->ComponentImplementation(_entity, comp.first);
+      this->ComponentImplementation(_entity, _comp.first);
 
     // If not sending full state, skip unchanged components
-    if (!_full &&
-        this->dataPtr->oneTimeChangedComponents.find(comp) ==
-        this->dataPtr->oneTimeChangedComponents.end() &&
-        this->dataPtr->periodicChangedComponents.find(comp) ==
-        this->dataPtr->periodicChangedComponents.end())
+    if (!_full && this->dataPtr->components.at(_comp.first)->State(
+        _comp.second) == ComponentState::NoChange)
     {
-      continue;
+      return;
     }
 
-    /// Find the entity in the message, if not already found.
-    /// Add the entity to the message, if not already added.
-    if (entIter == _msg.mutable_entities()->end())
-    {
-      entIter = _msg.mutable_entities()->find(_entity);
-      if (entIter == _msg.mutable_entities()->end())
-      {
-        msgs::SerializedEntityMap ent;
-        ent.set_id(_entity);
-        (*_msg.mutable_entities())[static_cast<uint64_t>(_entity)] = ent;
-        entIter = _msg.mutable_entities()->find(_entity);
-      }
-    }
+    // Find the component in the message, adding it in place if it's not
+    // present, then serialize straight into it, reusing its buffer
+    auto &compMsg = (*entityMsg().mutable_components())[
+        static_cast<int64_t>(_comp.first)];
+    compMsg.set_type(compBase->TypeId());
+    auto *bytes = compMsg.mutable_component();
+    bytes->clear();
+    compBase->SerializeToBuffer(*bytes);
+    this->dataPtr->stateBytes.Add(bytes->size());
+    IGN_GAZEBO_TRACEPOINT2(state_serialized, _entity, bytes->size());
+  };
 
-    auto compIter = entIter->second.mutable_components()->find(comp.first);
-    // Find the component in the message, and add the component to the
-    // message if it's not present.
-    if (compIter == entIter->second.mutable_components()->end())
+  // Empty means all types
+  if (_types.empty())
+  {
+    for (const auto &type : iter->second)
+      addComponent(type.second);
+  }
+  else
+  {
+    for (const ComponentTypeId type : _types)
     {
-      msgs::SerializedComponent cmp;
-      cmp.set_type(compBase->TypeId());
-      (*(entIter->second.mutable_components()))[
-        static_cast<int64_t>(comp.first)] = cmp;
-      compIter = entIter->second.mutable_components()->find(comp.first);
+      auto typeIter = iter->second.find(type);
+      if (typeIter != iter->second.end())
+        addComponent(typeIter->second);
     }
-
-    // Serialize and store the message
-    std::ostringstream ostr;
-    compBase->Serialize(ostr);
-    compIter->second.set_component(ostr.str());
   }
 
   // Add a component to the message and set it to be removed if the component
@@ -1058,9 +1892,9 @@ void EntityComponentManagerPrivate::CalculateStateThreadLoad()
   auto startIt = this->entityComponents.begin();
   int numComponents = this->entityComponents.size();
 
-  // Set the number of threads to spawn to the min of the calculated thread
-  // count or max threads that the hardware supports
-  int maxThreads = std::thread::hardware_concurrency();
+  // Set the number of threads to use to the min of the calculated thread
+  // count or the threads available to process entities
+  int maxThreads = this->workerThreads;
   uint64_t numThreads = std::min(numComponents, maxThreads);
 
   int componentsPerThread = std::ceil(static_cast<double>(numComponents) /
@@ -1118,46 +1952,65 @@ void EntityComponentManager::State(
     const std::unordered_set<ComponentTypeId> &_types,
     bool _full) const
 {
-  std::mutex stateMapMutex;
-  std::vector<std::thread> workers;
+  // Copy the iterators so that concurrent calls don't see them change
+  std::vector<std::unordered_map<Entity,
+      std::unordered_map<ComponentTypeId, ComponentKey>>::iterator> iterators;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->stateThreadLoadMutex);
+    this->dataPtr->CalculateStateThreadLoad();
+    iterators = this->dataPtr->entityComponentIterators;
+  }
 
-  this->dataPtr->CalculateStateThreadLoad();
+  const std::size_t taskCount = iterators.size() - 1;
 
-  auto functor = [&](auto itStart, auto itEnd)
+  auto serialize = [&](msgs::SerializedStateMap &_map, std::size_t _task)
   {
-    msgs::SerializedStateMap threadMap;
-    while (itStart != itEnd)
+    for (auto it = iterators[_task]; it != iterators[_task + 1]; ++it)
     {
-      auto entity = (*itStart).first;
+      auto entity = it->first;
       if (_entities.empty() || _entities.find(entity) != _entities.end())
       {
-        this->AddEntityToMessage(threadMap, entity, _types, _full);
+        this->AddEntityToMessage(_map, entity, _types, _full);
       }
-      itStart++;
-    }
-    std::lock_guard<std::mutex> lock(stateMapMutex);
-
-    for (const auto &entity : threadMap.entities())
-    {
-      (*_state.mutable_entities())[static_cast<uint64_t>(entity.first)] =
-          entity.second;
     }
   };
 
-  // Spawn workers
-  uint64_t numThreads = this->dataPtr->entityComponentIterators.size() - 1;
-  for (uint64_t i = 0; i < numThreads; i++)
+  if (taskCount == 0)
+    return;
+
+  // A single task can write straight into an empty output
+  if (taskCount == 1 && _state.entities().empty())
   {
-    workers.push_back(std::thread(functor,
-        this->dataPtr->entityComponentIterators[i],
-        this->dataPtr->entityComponentIterators[i+1]));
+    serialize(_state, 0);
+    return;
   }
 
-  // Wait for each thread to finish processing its components
-  std::for_each(workers.begin(), workers.end(), [](std::thread &_t)
+  // Each task writes to its own map, which are merged once all tasks are
+  // done, so no locking is needed
+  std::vector<msgs::SerializedStateMap> taskMaps(taskCount);
+  RunParallelTasks(this->dataPtr->workerPool,
+      this->dataPtr->workerThreads, taskCount, [&](std::size_t _task)
   {
-    _t.join();
+    serialize(taskMaps[_task], _task);
   });
+
+  // Entities are swapped rather than copied, and the first task's map is
+  // taken whole when the output is empty
+  auto &stateEntities = *_state.mutable_entities();
+  std::size_t firstMerged{0};
+  if (stateEntities.empty())
+  {
+    stateEntities.swap(*taskMaps[0].mutable_entities());
+    firstMerged = 1;
+  }
+  for (std::size_t i = firstMerged; i < taskMaps.size(); ++i)
+  {
+    auto &taskMap = taskMaps[i];
+    for (auto &entity : *taskMap.mutable_entities())
+    {
+      stateEntities[static_cast<uint64_t>(entity.first)].Swap(&entity.second);
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -1224,8 +2077,7 @@ void EntityComponentManager::SetState(
         continue;
       }
 
-      std::istringstream istr(compMsg.component());
-      newComp->Deserialize(istr);
+      newComp->DeserializeFromBuffer(compMsg.component());
 
       // Get type id
       auto typeId = newComp->TypeId();
@@ -1267,69 +2119,94 @@ void EntityComponentManager::SetState(
     const ignition::msgs::SerializedStateMap &_stateMsg)
 {
   IGN_PROFILE("EntityComponentManager::SetState Map");
-  // Create / remove / update entities
-  for (const auto &iter : _stateMsg.entities())
-  {
-    const auto &entityMsg = iter.second;
 
-    Entity entity{entityMsg.id()};
-
-    // Remove entity
-    if (entityMsg.remove())
+  // Note on merging forward:
+  // `has_one_time_component_changes` field is available in Edifice so
+  // this workaround can be removed
+  auto flag = ComponentState::PeriodicChange;
+  for (int i = 0; i < _stateMsg.header().data_size(); ++i)
+  {
+    if (_stateMsg.header().data(i).key() ==
+        "has_one_time_component_changes")
     {
-      this->RequestRemoveEntity(entity);
-      continue;
+      int v = stoi(_stateMsg.header().data(i).value(0));
+      if (v)
+        flag = ComponentState::OneTimeChange;
+      break;
     }
+  }
 
-    // Create entity if it doesn't exist
-    if (!this->HasEntity(entity))
-    {
-      this->dataPtr->CreateEntityImplementation(entity);
-    }
+  // Components which already exist are only collected while entities and
+  // components are created and removed, because storages may relocate
+  // their components meanwhile.
+  std::vector<std::tuple<Entity, ComponentTypeId, const std::string *>>
+      updates;
 
-    // Create / remove / update components
-    for (const auto &compIter : iter.second.components())
+  // Create / remove entities and components
+  {
+    IGN_PROFILE("Structure");
+    for (const auto &iter : _stateMsg.entities())
     {
-      const auto &compMsg = compIter.second;
+      const auto &entityMsg = iter.second;
 
-      // Skip if component not set. Note that this will also skip components
-      // setting an empty value.
-      if (compMsg.component().empty())
+      Entity entity{entityMsg.id()};
+
+      // Remove entity
+      if (entityMsg.remove())
       {
+        this->RequestRemoveEntity(entity);
         continue;
       }
 
-      uint64_t type = compMsg.type();
+      // Create entity if it doesn't exist
+      if (!this->HasEntity(entity))
+      {
+        this->dataPtr->CreateEntityImplementation(entity);
+      }
 
-      // Components which haven't been registered in this process, such as 3rd
-      // party components streamed to other secondaries and the GUI.
-      if (!components::Factory::Instance()->HasType(type))
+      // Create / remove components
+      for (const auto &compIter : iter.second.components())
       {
-        static std::unordered_set<unsigned int> printedComps;
-        if (printedComps.find(type) == printedComps.end())
+        const auto &compMsg = compIter.second;
+
+        // Skip if component not set. Note that this will also skip
+        // components setting an empty value.
+        if (compMsg.component().empty())
         {
-          printedComps.insert(type);
-          ignwarn << "Component type [" << type << "] has not been "
-                  << "registered in this process, so it can't be deserialized."
-                  << std::endl;
+          continue;
         }
-        continue;
-      }
 
-      // Remove component
-      if (compMsg.remove())
-      {
-        this->RemoveComponent(entity, compIter.first);
-        continue;
-      }
+        uint64_t type = compMsg.type();
 
-      // Get Component
-      components::BaseComponent *comp =
-        this->ComponentImplementation(entity, compIter.first);
+        // Components which haven't been registered in this process, such as
+        // 3rd party components streamed to other secondaries and the GUI.
+        if (!components::Factory::Instance()->HasType(type))
+        {
+          static std::unordered_set<unsigned int> printedComps;
+          if (printedComps.find(type) == printedComps.end())
+          {
+            printedComps.insert(type);
+            ignwarn << "Component type [" << type << "] has not been "
+                    << "registered in this process, so it can't be "
+                    << "deserialized." << std::endl;
+          }
+          continue;
+        }
+
+        // Remove component
+        if (compMsg.remove())
+        {
+          this->RemoveComponent(entity, compIter.first);
+          continue;
+        }
+
+        // Update component value later
+        if (this->EntityHasComponentType(entity, compIter.first))
+        {
+          updates.emplace_back(entity, compIter.first, &compMsg.component());
+          continue;
+        }
 
-      // Create if new
-      if (nullptr == comp)
-      {
         // Create component
         auto newComp = components::Factory::Instance()->New(compMsg.type());
 
@@ -1340,47 +2217,190 @@ void EntityComponentManager::SetState(
           continue;
         }
 
-        std::istringstream istr(compMsg.component());
-        newComp->Deserialize(istr);
+        newComp->DeserializeFromBuffer(compMsg.component());
 
         this->CreateComponentImplementation(entity,
             newComp->TypeId(), newComp.get());
       }
-      // Update component value
-      else
+    }
+  }
+
+  // Each component is deserialized by a single thread, and no component is
+  // created or removed meanwhile
+  {
+    IGN_PROFILE("Data");
+    this->ParallelFor(updates.size(),
+        [&](std::size_t _begin, std::size_t _end)
+    {
+      for (std::size_t i = _begin; i < _end; ++i)
       {
-        std::istringstream istr(compMsg.component());
-        comp->Deserialize(istr);
-        // Note on merging forward:
-        // `has_one_time_component_changes` field is available in Edifice so
-        // this workaround can be removed
-        auto flag = ComponentState::PeriodicChange;
-        for (int i = 0; i < _stateMsg.header().data_size(); ++i)
-        {
-          if (_stateMsg.header().data(i).key() ==
-              "has_one_time_component_changes")
-          {
-            int v = stoi(_stateMsg.header().data(i).value(0));
-            if (v)
-              flag = ComponentState::OneTimeChange;
-            break;
-          }
-        }
-        this->SetChanged(entity, compIter.first, flag);
+        const auto &[entity, type, data] = updates[i];
+        this->ComponentImplementation(entity, type)->DeserializeFromBuffer(
+            *data);
       }
+    });
+  }
+
+  // Change tracking isn't thread safe
+  for (const auto &update : updates)
+    this->SetChanged(std::get<0>(update), std::get<1>(update), flag);
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::BinaryState(std::string &_buffer,
+    const std::unordered_set<Entity> &_entities,
+    const std::unordered_set<ComponentTypeId> &_types, bool _full) const
+{
+  IGN_PROFILE("EntityComponentManager::BinaryState");
+  BinaryStateWriter writer(this->HasOneTimeComponentChanges());
+
+  for (const auto &[entity, entityComponents] :
+      this->dataPtr->entityComponents)
+  {
+    if (!_entities.empty() && _entities.find(entity) == _entities.end())
+      continue;
+
+    if (this->dataPtr->SerializationSkipped(entity))
+      continue;
+
+    if (this->dataPtr->SerializedAsRemoved(entity))
+    {
+      // The components of removed entities aren't needed
+      writer.AddRemovedEntity(entity);
+      continue;
+    }
+
+    for (const auto &[type, key] : entityComponents)
+    {
+      if (!_types.empty() && _types.find(type) == _types.end())
+        continue;
+
+      // If not sending full state, skip unchanged components
+      const auto &storage = this->dataPtr->components.at(type);
+      if (!_full && storage->State(key.second) == ComponentState::NoChange)
+        continue;
+
+      writer.AddComponent(entity, storage->Component(key.second));
+    }
+
+    std::lock_guard<std::mutex> lock(this->dataPtr->removedComponentsMutex);
+    auto removed = this->dataPtr->removedComponents.equal_range(entity);
+    for (auto it = removed.first; it != removed.second; ++it)
+    {
+      if (_types.empty() || _types.find(it->second.first) != _types.end())
+        writer.AddRemovedComponent(entity, it->second.first);
+    }
+  }
+
+  writer.Write(_buffer);
+  this->dataPtr->stateBytes.Add(_buffer.size());
+}
+
+//////////////////////////////////////////////////
+bool EntityComponentManager::SetBinaryState(const char *_data,
+    std::size_t _size)
+{
+  IGN_PROFILE("EntityComponentManager::SetBinaryState");
+  BinaryStateReader reader(_data, _size);
+  if (!reader.Valid())
+  {
+    ignerr << "Failed to read binary state, the buffer is malformed."
+           << std::endl;
+    return false;
+  }
+
+  // Update views once per entity
+  this->BeginBatch();
+
+  std::unordered_set<Entity> removedEntities;
+  for (const Entity entity : reader.RemovedEntities())
+  {
+    this->RequestRemoveEntity(entity);
+    removedEntities.insert(entity);
+  }
+
+  const auto flag = reader.OneTimeChanges() ?
+      ComponentState::OneTimeChange : ComponentState::PeriodicChange;
+
+  bool result = reader.EachComponent(
+      [&](const Entity _entity, const ComponentTypeId _type,
+          std::istream *_data) -> bool
+  {
+    if (removedEntities.find(_entity) != removedEntities.end())
+      return true;
+
+    // Components which haven't been registered in this process, such as 3rd
+    // party components streamed to other secondaries and the GUI.
+    if (!components::Factory::Instance()->HasType(_type))
+    {
+      static std::unordered_set<ComponentTypeId> printedComps;
+      if (printedComps.find(_type) == printedComps.end())
+      {
+        printedComps.insert(_type);
+        ignwarn << "Component type [" << _type << "] has not been "
+                << "registered in this process, so it can't be deserialized."
+                << std::endl;
+      }
+      return true;
+    }
+
+    // Create entity if it doesn't exist
+    if (!this->HasEntity(_entity))
+      this->dataPtr->CreateEntityImplementation(_entity);
+
+    // Remove component
+    if (nullptr == _data)
+    {
+      this->RemoveComponent(_entity, _type);
+      return true;
+    }
+
+    components::BaseComponent *comp =
+        this->ComponentImplementation(_entity, _type);
+
+    // Update component value
+    if (nullptr != comp)
+    {
+      comp->Deserialize(*_data);
+      this->SetChanged(_entity, _type, flag);
+      return true;
+    }
+
+    // Create if new
+    auto newComp = components::Factory::Instance()->New(_type);
+    if (nullptr == newComp)
+    {
+      ignerr << "Failed to create component of type [" << _type << "]"
+             << std::endl;
+      return true;
     }
+
+    newComp->Deserialize(*_data);
+    this->CreateComponentImplementation(_entity, _type, newComp.get());
+    return true;
+  });
+
+  this->EndBatch();
+
+  if (!result)
+  {
+    ignerr << "Failed to read binary state, the buffer is malformed."
+           << std::endl;
   }
+  return result;
 }
 
 //////////////////////////////////////////////////
 std::unordered_set<Entity> EntityComponentManager::Descendants(Entity _entity)
     const
 {
+  std::lock_guard<std::mutex> lock(this->dataPtr->descendantCacheMutex);
+
   // Check cache
-  if (this->dataPtr->descendantCache.find(_entity) !=
-      this->dataPtr->descendantCache.end())
+  auto cacheIter = this->dataPtr->descendantCache.find(_entity);
+  if (cacheIter != this->dataPtr->descendantCache.end())
   {
-    return this->dataPtr->descendantCache[_entity];
+    return cacheIter->second;
   }
 
   std::unordered_set<Entity> descendants;
@@ -1397,11 +2417,230 @@ std::unordered_set<Entity> EntityComponentManager::Descendants(Entity _entity)
   return descendants;
 }
 
+//////////////////////////////////////////////////
+bool EntityComponentManager::Compact(
+    const std::chrono::steady_clock::duration &_budget)
+{
+  IGN_PROFILE("EntityComponentManager::Compact");
+  if (!this->dataPtr->compactionPending)
+    return true;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  // Storages are compacted one at a time, followed by the views and the
+  // maps of entities
+  auto &cursor = this->dataPtr->compactionCursor;
+  auto &types = this->dataPtr->compactionTypes;
+  if (cursor == 0)
+  {
+    types.clear();
+    for (const auto &storage : this->dataPtr->components)
+      types.push_back(storage.first);
+  }
+
+  while (true)
+  {
+    std::size_t unit = cursor++;
+    if (unit < types.size())
+    {
+      auto storageIter = this->dataPtr->components.find(types[unit]);
+      if (storageIter != this->dataPtr->components.end())
+        storageIter->second->Compact();
+    }
+    else if ((unit -= types.size()) < this->dataPtr->views.size())
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->viewsMutex);
+      auto &view = std::next(this->dataPtr->views.begin(), unit)->second;
+      CompactVector(view.rows);
+      CompactHash(view.entityRows);
+      for (auto &column : view.componentIds)
+        CompactVector(column);
+      for (auto &column : view.componentPtrs)
+        CompactVector(column);
+    }
+    else if ((unit -= this->dataPtr->views.size()) == 0)
+    {
+      // Rehashing invalidates the iterators used by State
+      if (CompactHash(this->dataPtr->entityComponents))
+        this->dataPtr->entityComponentsDirty = true;
+      CompactVector(this->dataPtr->entityComponentIterators);
+
+      for (auto typeIter = this->dataPtr->changedEntities.begin();
+           typeIter != this->dataPtr->changedEntities.end();)
+      {
+        if (typeIter->second.empty())
+          typeIter = this->dataPtr->changedEntities.erase(typeIter);
+        else
+          CompactHash((typeIter++)->second);
+      }
+    }
+    else if (unit == 1)
+    {
+      {
+        std::lock_guard<std::mutex> lock(this->dataPtr->entityCreatedMutex);
+        CompactHash(this->dataPtr->newlyCreatedEntities);
+      }
+      {
+        std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
+        CompactHash(this->dataPtr->toRemoveEntities);
+      }
+      {
+        std::lock_guard<std::mutex> lock(
+            this->dataPtr->removedComponentsMutex);
+        CompactHash(this->dataPtr->removedComponents);
+      }
+      std::lock_guard<std::mutex> lock(this->dataPtr->descendantCacheMutex);
+      CompactHash(this->dataPtr->descendantCache);
+    }
+    else
+    {
+      cursor = 0;
+      types.clear();
+      this->dataPtr->compactionPending = false;
+      return true;
+    }
+
+    if (std::chrono::steady_clock::now() - start >= _budget)
+      return false;
+  }
+}
+
+/////////////////////////////////////////////////
+EcmMemoryUsage EntityComponentManager::MemoryUsage() const
+{
+  EcmMemoryUsage usage;
+
+  // Components, and the entities which own them
+  for (const auto &[type, storage] : this->dataPtr->components)
+  {
+    EcmMemoryUsage::Storage storageUsage;
+    storageUsage.type = type;
+    storageUsage.size = storage->Size();
+    storageUsage.capacity = storage->Capacity();
+    storageUsage.bytes = storage->ComponentBytes() + storage->IndexBytes();
+    usage.storages.push_back(storageUsage);
+
+    usage.changeTrackingBytes += storage->ChangeTrackingBytes();
+  }
+  std::sort(usage.storages.begin(), usage.storages.end(),
+      [](const auto &_a, const auto &_b) {return _a.type < _b.type;});
+
+  const auto &entityComponents = this->dataPtr->entityComponents;
+  usage.entityCount = entityComponents.size();
+  usage.entityBytes = HashBytes(entityComponents) +
+      VectorBytes(this->dataPtr->entityComponentIterators) +
+      this->dataPtr->componentIndex.Bytes() +
+      this->dataPtr->valueIndex.Bytes();
+  for (const auto &entity : entityComponents)
+    usage.entityBytes += HashBytes(entity.second);
+
+  // The graph has a vertex, a parent edge and adjacency entries for each
+  // entity, all in trees
+  usage.entityBytes += usage.entityCount *
+      (sizeof(math::graph::Vertex<Entity>) +
+       sizeof(math::graph::DirectedEdge<bool>) + 4 * kTreeNodeBytes +
+       2 * sizeof(Entity) + 2 * sizeof(math::graph::EdgeId));
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->viewsMutex);
+    for (const auto &[types, view] : this->dataPtr->views)
+    {
+      EcmMemoryUsage::View viewUsage;
+      viewUsage.types.assign(types.begin(), types.end());
+      viewUsage.size = view.rows.size();
+      viewUsage.bytes = TreeBytes(types) + TreeBytes(view.entities) +
+          TreeBytes(view.newEntities) + TreeBytes(view.toRemoveEntities) +
+          VectorBytes(view.rows) + HashBytes(view.entityRows) +
+          VectorBytes(view.columnTypes) + VectorBytes(view.componentIds) +
+          VectorBytes(view.componentPtrs) + VectorBytes(view.columnStorages) +
+          VectorBytes(view.columnRelocations);
+      for (const auto &column : view.componentIds)
+        viewUsage.bytes += VectorBytes(column);
+      for (const auto &column : view.componentPtrs)
+        viewUsage.bytes += VectorBytes(column);
+      usage.views.push_back(std::move(viewUsage));
+    }
+
+    usage.changeTrackingBytes += HashBytes(this->dataPtr->pendingViewEntities);
+  }
+
+  usage.changeTrackingBytes +=
+      HashBytes(this->dataPtr->newlyCreatedEntities) +
+      HashBytes(this->dataPtr->toRemoveEntities);
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->removedComponentsMutex);
+    usage.changeTrackingBytes += HashBytes(this->dataPtr->removedComponents);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->descendantCacheMutex);
+    usage.cacheBytes += HashBytes(this->dataPtr->descendantCache);
+    for (const auto &descendants : this->dataPtr->descendantCache)
+      usage.cacheBytes += HashBytes(descendants.second);
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->worldPoseCacheMutex);
+    usage.cacheBytes += HashBytes(this->dataPtr->worldPoseCache);
+  }
+
+  return usage;
+}
+
+//////////////////////////////////////////////////
+EcmCounters EntityComponentManager::Counters() const
+{
+  EcmCounters counters;
+  counters.componentsCreated = this->dataPtr->componentsCreated.Value();
+  counters.componentsRemoved = this->dataPtr->componentsRemoved.Value();
+  counters.viewsCreated = this->dataPtr->viewsCreated.Value();
+  counters.viewRebuilds = this->dataPtr->viewRebuilds.Value();
+  counters.stateBytes = this->dataPtr->stateBytes.Value();
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->viewsMutex);
+  counters.views.reserve(this->dataPtr->views.size());
+  for (const auto &[types, view] : this->dataPtr->views)
+  {
+    EcmCounters::View viewCounters;
+    viewCounters.types.assign(types.begin(), types.end());
+    viewCounters.eachCalls = view.eachCalls.Value();
+    viewCounters.entitiesVisited = view.entitiesVisited.Value();
+    counters.views.push_back(std::move(viewCounters));
+  }
+  return counters;
+}
+
 //////////////////////////////////////////////////
 void EntityComponentManager::SetAllComponentsUnchanged()
 {
-  this->dataPtr->periodicChangedComponents.clear();
-  this->dataPtr->oneTimeChangedComponents.clear();
+  for (auto &storage : this->dataPtr->components)
+    storage.second->SetAllUnchanged();
+
+  // Keep the sets, the same types tend to change on every step
+  for (auto &changed : this->dataPtr->changedEntities)
+    changed.second.clear();
+}
+
+/////////////////////////////////////////////////
+std::vector<Entity> EntityComponentManager::ChangedEntities(
+    const std::vector<ComponentTypeId> &_typeIds) const
+{
+  std::vector<Entity> result;
+  for (const auto typeId : _typeIds)
+  {
+    auto iter = this->dataPtr->changedEntities.find(typeId);
+    if (iter == this->dataPtr->changedEntities.end())
+      continue;
+
+    for (const auto entity : iter->second)
+    {
+      if (this->ComponentState(entity, typeId) != ComponentState::NoChange)
+        result.push_back(entity);
+    }
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
 }
 
 /////////////////////////////////////////////////
@@ -1409,32 +2648,77 @@ void EntityComponentManager::SetChanged(
     const Entity _entity, const ComponentTypeId _type,
     gazebo::ComponentState _c)
 {
-  auto ecIter = this->dataPtr->entityComponents.find(_entity);
-
-  if (ecIter == this->dataPtr->entityComponents.end())
+  auto lookup = this->dataPtr->componentIndex.Find(_entity, _type);
+  if (nullptr == lookup.storage)
     return;
 
-  auto typeIter = ecIter->second.find(_type);
-  if (typeIter == ecIter->second.end())
-    return;
+  lookup.storage->SetState(lookup.id, _c);
 
-  if (_c == ComponentState::PeriodicChange)
-  {
-    this->dataPtr->periodicChangedComponents.insert(typeIter->second);
-    this->dataPtr->oneTimeChangedComponents.erase(typeIter->second);
-  }
-  else if (_c == ComponentState::OneTimeChange)
+  if (_c == ComponentState::NoChange)
+    this->dataPtr->changedEntities[_type].erase(_entity);
+  else
+    this->dataPtr->changedEntities[_type].insert(_entity);
+
+  // The value may have been modified in place
+  if (lookup.storage->ValueIndexed())
   {
-    this->dataPtr->periodicChangedComponents.erase(typeIter->second);
-    this->dataPtr->oneTimeChangedComponents.insert(typeIter->second);
+    this->dataPtr->valueIndex.Set(_entity, _type,
+        *lookup.storage->Component(lookup.id));
   }
-  else
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::HasValueIndex(const ComponentTypeId _typeId) const
+{
+  return this->dataPtr->valueIndex.Enabled(_typeId);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::EnableValueIndexImplementation(
+    const ComponentTypeId _typeId, ValueHasher _hasher)
+{
+  if (this->dataPtr->valueIndex.Enabled(_typeId))
+    return;
+
+  this->dataPtr->valueIndex.Enable(_typeId, std::move(_hasher));
+
+  auto storageIter = this->dataPtr->components.find(_typeId);
+  if (storageIter == this->dataPtr->components.end())
+    return;
+
+  // Index the components which already exist
+  storageIter->second->SetValueIndexed(true);
+  for (const auto &[entity, keys] : this->dataPtr->entityComponents)
   {
-    this->dataPtr->periodicChangedComponents.erase(typeIter->second);
-    this->dataPtr->oneTimeChangedComponents.erase(typeIter->second);
+    auto keyIter = keys.find(_typeId);
+    if (keyIter == keys.end())
+      continue;
+
+    auto component = storageIter->second->Component(keyIter->second.second);
+    if (nullptr != component)
+      this->dataPtr->valueIndex.Set(entity, _typeId, *component);
   }
 }
 
+/////////////////////////////////////////////////
+const std::vector<Entity> *EntityComponentManager::ValueIndexCandidates(
+    const ComponentTypeId _typeId, const std::size_t _hash) const
+{
+  return this->dataPtr->valueIndex.Find(_typeId, _hash);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::UpdateValueIndex(const Entity _entity,
+    const ComponentTypeId _typeId)
+{
+  if (!this->dataPtr->valueIndex.Enabled(_typeId))
+    return;
+
+  auto component = this->ComponentImplementation(_entity, _typeId);
+  if (nullptr != component)
+    this->dataPtr->valueIndex.Set(_entity, _typeId, *component);
+}
+
 /////////////////////////////////////////////////
 std::unordered_set<ComponentTypeId> EntityComponentManager::ComponentTypes(
     const Entity _entity) const
@@ -1465,3 +2749,250 @@ void EntityComponentManager::SetEntityCreateOffset(uint64_t _offset)
 
   this->dataPtr->entityCount = _offset;
 }
+
+/////////////////////////////////////////////////
+void EntityComponentManager::SetWorkerPool(common::WorkerPool *_pool,
+    unsigned int _threads)
+{
+  if (0 == _threads)
+    _threads = std::thread::hardware_concurrency();
+
+  this->dataPtr->workerPool = _pool;
+  this->dataPtr->workerThreads =
+      nullptr == _pool ? 1u : std::max(1u, _threads);
+
+  // Redistribute the work of State across the new number of threads
+  std::lock_guard<std::mutex> lock(this->dataPtr->stateThreadLoadMutex);
+  this->dataPtr->entityComponentsDirty = true;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::SetComponentBlockSize(const std::size_t _size)
+{
+  this->dataPtr->componentBlockSize = _size;
+}
+
+/////////////////////////////////////////////////
+math::Pose3d EntityComponentManager::WorldPose(const Entity _entity) const
+{
+  auto poseComp = this->Component<components::Pose>(_entity);
+  if (nullptr == poseComp)
+    return math::Pose3d::Zero;
+
+  if (this->dataPtr->worldPoseCacheEnabled)
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->worldPoseCacheMutex);
+    return this->dataPtr->CachedWorldPose(*this, _entity, poseComp->Data());
+  }
+
+  // work out pose in world frame
+  math::Pose3d pose = poseComp->Data();
+  auto p = this->Component<components::ParentEntity>(_entity);
+  while (p)
+  {
+    // get pose of parent entity
+    auto parentPose = this->Component<components::Pose>(p->Data());
+    if (!parentPose)
+      break;
+    // transform pose
+    pose = pose + parentPose->Data();
+    // keep going up the tree
+    p = this->Component<components::ParentEntity>(p->Data());
+  }
+  return pose;
+}
+
+/////////////////////////////////////////////////
+math::Pose3d EntityComponentManagerPrivate::CachedWorldPose(
+    const EntityComponentManager &_ecm, Entity _entity,
+    const math::Pose3d &_pose)
+{
+  auto cacheIter = this->worldPoseCache.find(_entity);
+  if (cacheIter != this->worldPoseCache.end())
+    return cacheIter->second;
+
+  math::Pose3d pose = _pose;
+  auto parentComp = _ecm.Component<components::ParentEntity>(_entity);
+  if (nullptr != parentComp)
+  {
+    auto parentPose = _ecm.Component<components::Pose>(parentComp->Data());
+    if (nullptr != parentPose)
+    {
+      pose = pose + this->CachedWorldPose(_ecm, parentComp->Data(),
+          parentPose->Data());
+    }
+  }
+
+  this->worldPoseCache[_entity] = pose;
+  return pose;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::SetWorldPoseCacheEnabled(bool _enabled)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->worldPoseCacheMutex);
+  this->dataPtr->worldPoseCacheEnabled = _enabled;
+  if (!_enabled)
+    this->dataPtr->worldPoseCache.clear();
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::BeginDeferredChanges(std::size_t _buffers)
+{
+  this->dataPtr->changeBuffers.clear();
+  this->dataPtr->changeBuffers.resize(_buffers);
+  this->dataPtr->deferEntityBase = this->dataPtr->entityCount;
+  this->dataPtr->deferGeneration = ++gDeferGeneration;
+  this->dataPtr->deferringChanges = true;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::DeferChanges(std::size_t _buffer)
+{
+  if (_buffer >= this->dataPtr->changeBuffers.size())
+  {
+    ignerr << "Deferring changes into buffer [" << _buffer << "], but only ["
+           << this->dataPtr->changeBuffers.size() << "] buffers exist."
+           << std::endl;
+    return;
+  }
+
+  tChangeBuffer.generation = this->dataPtr->deferGeneration;
+  tChangeBuffer.index = _buffer;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::EndDeferredChanges()
+{
+  IGN_PROFILE("EntityComponentManager::EndDeferredChanges");
+  this->dataPtr->deferringChanges = false;
+  auto buffers = std::move(this->dataPtr->changeBuffers);
+  this->dataPtr->changeBuffers.clear();
+
+  // Views are updated once, after all changes
+  this->BeginBatch();
+  for (auto &buffer : buffers)
+  {
+    for (const auto &change : buffer.changes)
+    {
+      switch (change.kind)
+      {
+        case DeferredChange::Kind::CreateEntity:
+          this->dataPtr->entityCount =
+              std::max(this->dataPtr->entityCount, change.entity);
+          this->dataPtr->CreateEntityImplementation(change.entity);
+          break;
+        case DeferredChange::Kind::CreateComponent:
+          this->CreateComponentImplementation(change.entity, change.typeId,
+              buffer.components[change.typeId]->Component(
+              change.componentId));
+          break;
+        case DeferredChange::Kind::RemoveComponent:
+          this->RemoveComponent(change.entity, change.typeId);
+          break;
+        case DeferredChange::Kind::RemoveEntity:
+          this->RequestRemoveEntity(change.entity, change.recursive);
+          break;
+        case DeferredChange::Kind::RemoveAllEntities:
+          this->RequestRemoveEntities();
+          break;
+        case DeferredChange::Kind::SetParent:
+          this->SetParentEntity(change.entity, change.parent);
+          break;
+      }
+    }
+  }
+  this->EndBatch();
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::ParallelFor(const std::size_t _count,
+    const std::function<void(std::size_t, std::size_t)> &_work) const
+{
+  // Below this many entities per chunk, the cost of scheduling outweighs the
+  // gain of running in parallel.
+  const std::size_t kMinChunkSize = 64;
+
+  const std::size_t threadCount = this->dataPtr->workerThreads;
+  if (threadCount < 2 || _count < 2 * kMinChunkSize)
+  {
+    if (_count > 0)
+      _work(0, _count);
+    return;
+  }
+
+  // A few chunks per thread to balance uneven per-entity costs.
+  const std::size_t chunkSize = std::max(kMinChunkSize,
+      (_count + 4 * threadCount - 1) / (4 * threadCount));
+  const std::size_t chunkCount = (_count + chunkSize - 1) / chunkSize;
+
+  RunParallelTasks(this->dataPtr->workerPool,
+      this->dataPtr->workerThreads, chunkCount, [&](std::size_t _chunk)
+  {
+    const std::size_t begin = _chunk * chunkSize;
+    _work(begin, std::min(begin + chunkSize, _count));
+  });
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::SetAccessTracing(bool _enabled)
+{
+  this->dataPtr->accessTracing = _enabled;
+}
+
+//////////////////////////////////////////////////
+bool EntityComponentManager::AccessTracing() const
+{
+  return this->dataPtr->accessTracing;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::SetAccessContext(const std::string &_context)
+{
+  tAccessContext = _context;
+}
+
+//////////////////////////////////////////////////
+EcmAccessStats EntityComponentManager::AccessStats() const
+{
+  EcmAccessStats stats;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->accessMutex);
+  stats.components.reserve(this->dataPtr->componentAccesses.size());
+  for (const auto &[key, count] : this->dataPtr->componentAccesses)
+  {
+    EcmAccessStats::ComponentAccess access;
+    access.context = key.first;
+    access.type = key.second;
+    access.reads = count.first;
+    access.writes = count.second;
+    stats.components.push_back(std::move(access));
+  }
+
+  stats.views.reserve(this->dataPtr->viewAccesses.size());
+  for (const auto &entry : this->dataPtr->viewAccesses)
+    stats.views.push_back(entry.second);
+  return stats;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::TraceViewAccess(const detail::View &_view,
+    uint64_t _visited, bool _mutable) const
+{
+  if (!this->dataPtr->accessTracing)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->accessMutex);
+  auto &access = this->dataPtr->viewAccesses[{tAccessContext,
+      _view.columnTypes}];
+  if (access.types.empty())
+  {
+    access.context = tAccessContext;
+    access.types = _view.columnTypes;
+  }
+  if (_mutable)
+    ++access.writeCalls;
+  else
+    ++access.readCalls;
+  access.entitiesVisited += _visited;
+}
@@ -17,11 +17,22 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <tuple>
+#include <utility>
+
 #include <ignition/common/Console.hh>
+#include <ignition/common/WorkerPool.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Rand.hh>
 
 #include "ignition/gazebo/components/Factory.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/config.hh"
@@ -95,6 +106,31 @@ class EntityCompMgrTest : public EntityComponentManager
   {
     this->ClearRemovedComponents();
   }
+  public: void RunSetWorkerPool(common::WorkerPool *_pool,
+      unsigned int _threads = 0)
+  {
+    this->SetWorkerPool(_pool, _threads);
+  }
+  public: void RunSetComponentBlockSize(std::size_t _size)
+  {
+    this->SetComponentBlockSize(_size);
+  }
+  public: void RunSetWorldPoseCacheEnabled(bool _enabled)
+  {
+    this->SetWorldPoseCacheEnabled(_enabled);
+  }
+  public: void RunBeginDeferredChanges(std::size_t _buffers)
+  {
+    this->BeginDeferredChanges(_buffers);
+  }
+  public: void RunDeferChanges(std::size_t _buffer)
+  {
+    this->DeferChanges(_buffer);
+  }
+  public: void RunEndDeferredChanges()
+  {
+    this->EndDeferredChanges();
+  }
 };
 
 class EntityComponentManagerFixture : public ::testing::TestWithParam<int>
@@ -209,11 +245,19 @@ TEST_P(EntityComponentManagerFixture, AdjacentMemoryTwoComponentTypes)
   const components::Pose *pose = nullptr, *prevPose = nullptr;
   const IntComponent *it = nullptr, *prevIt = nullptr;
 
-  // Check that each component is adjacent in memory
+  // Check that each component is adjacent in memory to the previous one,
+  // unless it starts a new block
+  const int blockSize = 1 << kDefaultComponentBlockShift;
   for (int i = 0; i < count; ++i)
   {
     pose = manager.Component<components::Pose>(poseKeys[i]);
     it = manager.Component<IntComponent>(intKeys[i]);
+    if (i % blockSize == 0)
+    {
+      prevPose = nullptr;
+      prevIt = nullptr;
+    }
+
     if (prevPose != nullptr)
     {
       EXPECT_EQ(poseSize, reinterpret_cast<uintptr_t>(pose) -
@@ -2098,6 +2142,313 @@ TEST_P(EntityComponentManagerFixture, Descendants)
   }
 }
 
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, DescendantsCacheReparent)
+{
+  // - 1
+  //   - 2
+  //     - 3
+  // - 4
+  auto e1 = manager.CreateEntity();
+  auto e2 = manager.CreateEntity();
+  manager.SetParentEntity(e2, e1);
+  auto e3 = manager.CreateEntity();
+  manager.SetParentEntity(e3, e2);
+  auto e4 = manager.CreateEntity();
+
+  // Fill the cache
+  EXPECT_EQ(3u, manager.Descendants(e1).size());
+  EXPECT_EQ(2u, manager.Descendants(e2).size());
+  EXPECT_EQ(1u, manager.Descendants(e4).size());
+
+  // Creating unrelated entities keeps the cache valid
+  auto e5 = manager.CreateEntity();
+  EXPECT_EQ(3u, manager.Descendants(e1).size());
+
+  // Move 2 and its child under 4
+  // - 1
+  // - 4
+  //   - 2
+  //     - 3
+  EXPECT_TRUE(manager.SetParentEntity(e2, e4));
+  {
+    auto ds = manager.Descendants(e1);
+    EXPECT_EQ(1u, ds.size());
+    EXPECT_NE(ds.end(), ds.find(e1));
+  }
+  {
+    auto ds = manager.Descendants(e4);
+    EXPECT_EQ(3u, ds.size());
+    EXPECT_NE(ds.end(), ds.find(e2));
+    EXPECT_NE(ds.end(), ds.find(e3));
+    EXPECT_NE(ds.end(), ds.find(e4));
+  }
+  EXPECT_EQ(2u, manager.Descendants(e2).size());
+
+  // Attach the new entity to 3
+  EXPECT_TRUE(manager.SetParentEntity(e5, e3));
+  EXPECT_EQ(4u, manager.Descendants(e4).size());
+  EXPECT_EQ(3u, manager.Descendants(e2).size());
+
+  // Remove 3 along with its child
+  manager.RequestRemoveEntity(e3);
+  manager.ProcessEntityRemovals();
+  {
+    auto ds = manager.Descendants(e4);
+    EXPECT_EQ(2u, ds.size());
+    EXPECT_EQ(ds.end(), ds.find(e3));
+    EXPECT_EQ(ds.end(), ds.find(e5));
+  }
+  EXPECT_EQ(1u, manager.Descendants(e2).size());
+  EXPECT_TRUE(manager.Descendants(e3).empty());
+
+  // Detach 2
+  EXPECT_TRUE(manager.SetParentEntity(e2, kNullEntity));
+  EXPECT_EQ(1u, manager.Descendants(e4).size());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, AncestorsAndTopLevelModel)
+{
+  // - world
+  //   - model
+  //     - nested model
+  //       - link
+  auto world = manager.CreateEntity();
+  auto model = manager.CreateEntity();
+  manager.CreateComponent(model, components::Model());
+  manager.SetParentEntity(model, world);
+  auto nested = manager.CreateEntity();
+  manager.CreateComponent(nested, components::Model());
+  manager.SetParentEntity(nested, model);
+  auto link = manager.CreateEntity();
+  manager.SetParentEntity(link, nested);
+
+  EXPECT_TRUE(manager.Ancestors(world).empty());
+  EXPECT_TRUE(manager.Ancestors(kNullEntity).empty());
+
+  auto ancestors = manager.Ancestors(link);
+  ASSERT_EQ(3u, ancestors.size());
+  EXPECT_EQ(nested, ancestors[0]);
+  EXPECT_EQ(model, ancestors[1]);
+  EXPECT_EQ(world, ancestors[2]);
+
+  EXPECT_EQ(model, manager.TopLevelModel(link));
+  EXPECT_EQ(model, manager.TopLevelModel(nested));
+  EXPECT_EQ(model, manager.TopLevelModel(model));
+  EXPECT_EQ(kNullEntity, manager.TopLevelModel(world));
+  EXPECT_EQ(kNullEntity, manager.TopLevelModel(kNullEntity));
+
+  // Reparenting is reflected right away
+  manager.SetParentEntity(nested, world);
+  EXPECT_EQ(2u, manager.Ancestors(link).size());
+  EXPECT_EQ(nested, manager.TopLevelModel(link));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, CreateEntities)
+{
+  auto entities = manager.CreateEntities(3);
+  ASSERT_EQ(3u, entities.size());
+  EXPECT_EQ(3u, manager.EntityCount());
+  for (auto entity : entities)
+  {
+    EXPECT_TRUE(manager.HasEntity(entity));
+    manager.CreateComponent(entity, IntComponent(1));
+  }
+  EXPECT_TRUE(manager.CreateEntities(0).empty());
+
+  int count{0};
+  manager.EachNew<IntComponent>(
+      [&](const Entity &, const IntComponent *) -> bool
+      {
+        ++count;
+        return true;
+      });
+  EXPECT_EQ(3, count);
+
+  // Entities keep being unique
+  EXPECT_EQ(entities.back() + 1, manager.CreateEntity());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, Batch)
+{
+  auto countInts = [&]()
+  {
+    int count{0};
+    manager.Each<IntComponent>(
+        [&](const Entity &, const IntComponent *) -> bool
+        {
+          ++count;
+          return true;
+        });
+    return count;
+  };
+
+  auto countBoth = [&]()
+  {
+    int count{0};
+    manager.Each<IntComponent, DoubleComponent>(
+        [&](const Entity &, const IntComponent *,
+            const DoubleComponent *) -> bool
+        {
+          ++count;
+          return true;
+        });
+    return count;
+  };
+
+  // Create the views before the batch
+  EXPECT_EQ(0, countInts());
+  EXPECT_EQ(0, countBoth());
+
+  manager.BeginBatch();
+  manager.BeginBatch();
+  auto entities = manager.CreateEntities(10);
+  for (auto entity : entities)
+  {
+    manager.CreateComponent(entity, IntComponent(1));
+    manager.CreateComponent(entity, DoubleComponent(1.0));
+  }
+  manager.EndBatch();
+
+  // Queries within a batch see all changes so far
+  EXPECT_EQ(10, countInts());
+  EXPECT_EQ(10, countBoth());
+
+  manager.RemoveComponent<DoubleComponent>(entities[0]);
+  manager.RemoveComponent<DoubleComponent>(entities[1]);
+  manager.EndBatch();
+
+  EXPECT_EQ(10, countInts());
+  EXPECT_EQ(8, countBoth());
+
+  // Unbalanced calls are ignored
+  manager.EndBatch();
+  auto entity = manager.CreateEntity();
+  manager.CreateComponent(entity, IntComponent(2));
+  EXPECT_EQ(11, countInts());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ComponentBlockSize)
+{
+  // Rounded up to 4
+  manager.RunSetComponentBlockSize(3);
+
+  std::vector<Entity> entities;
+  for (int i = 0; i < 10; ++i)
+  {
+    entities.push_back(manager.CreateEntity());
+    manager.CreateComponent(entities.back(), IntComponent(i));
+  }
+
+  // Growing the storage doesn't move existing components
+  const IntComponent *first = manager.Component<IntComponent>(entities[0]);
+  ASSERT_NE(nullptr, first);
+  for (int i = 10; i < 100; ++i)
+  {
+    entities.push_back(manager.CreateEntity());
+    manager.CreateComponent(entities.back(), IntComponent(i));
+  }
+  EXPECT_EQ(first, manager.Component<IntComponent>(entities[0]));
+
+  // Remove every other entity, across block boundaries
+  for (std::size_t i = 0; i < entities.size(); i += 2)
+    manager.RequestRemoveEntity(entities[i]);
+  manager.ProcessEntityRemovals();
+
+  for (std::size_t i = 0; i < entities.size(); ++i)
+  {
+    auto comp = manager.Component<IntComponent>(entities[i]);
+    if (i % 2 == 0)
+    {
+      EXPECT_EQ(nullptr, comp);
+    }
+    else
+    {
+      ASSERT_NE(nullptr, comp);
+      EXPECT_EQ(static_cast<int>(i), comp->Data());
+    }
+  }
+
+  int count{0};
+  manager.Each<IntComponent>(
+      [&](const Entity &, const IntComponent *_int) -> bool
+      {
+        EXPECT_EQ(1, _int->Data() % 2);
+        ++count;
+        return true;
+      });
+  EXPECT_EQ(50, count);
+
+  // Fill the freed slots again
+  for (int i = 0; i < 50; ++i)
+  {
+    auto entity = manager.CreateEntity();
+    manager.CreateComponent(entity, IntComponent(1000 + i));
+    EXPECT_EQ(1000 + i, manager.Component<IntComponent>(entity)->Data());
+  }
+  EXPECT_EQ(1, manager.Component<IntComponent>(entities[1])->Data());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, WorldPose)
+{
+  // - model
+  //   - link
+  //     - sensor A
+  //     - sensor B
+  auto model = manager.CreateEntity();
+  manager.CreateComponent(model,
+      components::Pose(math::Pose3d(1, 0, 0, 0, 0, IGN_PI_2)));
+
+  auto link = manager.CreateEntity();
+  manager.CreateComponent(link, components::Pose(math::Pose3d(0, 2, 0, 0, 0,
+      0)));
+  manager.CreateComponent(link, components::ParentEntity(model));
+
+  auto sensorA = manager.CreateEntity();
+  manager.CreateComponent(sensorA, components::Pose(math::Pose3d(0, 0, 3, 0,
+      0, 0)));
+  manager.CreateComponent(sensorA, components::ParentEntity(link));
+
+  auto sensorB = manager.CreateEntity();
+  manager.CreateComponent(sensorB, components::Pose(math::Pose3d(4, 0, 0, 0,
+      0, 0)));
+  manager.CreateComponent(sensorB, components::ParentEntity(link));
+
+  auto noPose = manager.CreateEntity();
+
+  const math::Pose3d expectedA(-1, 0, 3, 0, 0, IGN_PI_2);
+  const math::Pose3d expectedB(-1, 4, 0, 0, 0, IGN_PI_2);
+
+  EXPECT_EQ(math::Pose3d(1, 0, 0, 0, 0, IGN_PI_2), manager.WorldPose(model));
+  EXPECT_EQ(expectedA, manager.WorldPose(sensorA));
+  EXPECT_EQ(expectedB, manager.WorldPose(sensorB));
+  EXPECT_EQ(math::Pose3d::Zero, manager.WorldPose(noPose));
+  EXPECT_EQ(math::Pose3d::Zero, manager.WorldPose(kNullEntity));
+
+  // Cached poses match the uncached ones
+  manager.RunSetWorldPoseCacheEnabled(true);
+  EXPECT_EQ(expectedA, manager.WorldPose(sensorA));
+  EXPECT_EQ(expectedB, manager.WorldPose(sensorB));
+  EXPECT_EQ(math::Pose3d::Zero, manager.WorldPose(noPose));
+
+  // While enabled, the cache is not refreshed
+  manager.Component<components::Pose>(model)->Data() = math::Pose3d::Zero;
+  EXPECT_EQ(expectedA, manager.WorldPose(sensorA));
+
+  // Disabling drops the cache
+  manager.RunSetWorldPoseCacheEnabled(false);
+  EXPECT_EQ(math::Pose3d(0, 2, 3, 0, 0, 0), manager.WorldPose(sensorA));
+
+  manager.RunSetWorldPoseCacheEnabled(true);
+  EXPECT_EQ(math::Pose3d(4, 2, 0, 0, 0, 0), manager.WorldPose(sensorB));
+  manager.RunSetWorldPoseCacheEnabled(false);
+}
+
 //////////////////////////////////////////////////
 TEST_P(EntityComponentManagerFixture, SetChanged)
 {
@@ -2176,6 +2527,61 @@ TEST_P(EntityComponentManagerFixture, SetChanged)
       manager.ComponentState(e2, c2.first));
 }
 
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EachChanged)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  Entity e3 = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(e1, IntComponent(1));
+  manager.CreateComponent<DoubleComponent>(e1, DoubleComponent(1.0));
+  manager.CreateComponent<IntComponent>(e2, IntComponent(2));
+  manager.CreateComponent<DoubleComponent>(e2, DoubleComponent(2.0));
+  manager.CreateComponent<IntComponent>(e3, IntComponent(3));
+
+  auto changed = [&]()
+  {
+    std::vector<Entity> entities;
+    manager.EachChanged<IntComponent, DoubleComponent>(
+        [&](const Entity &_entity, const IntComponent *_int,
+            const DoubleComponent *_double) -> bool
+        {
+          EXPECT_NE(nullptr, _int);
+          EXPECT_NE(nullptr, _double);
+          entities.push_back(_entity);
+          return true;
+        });
+    return entities;
+  };
+
+  // New components are changed, e3 doesn't have all the components
+  EXPECT_EQ(std::vector<Entity>({e1, e2}), changed());
+  EXPECT_EQ(std::vector<Entity>({e1, e2, e3}),
+      manager.ChangedEntities({IntComponent::typeId}));
+
+  manager.RunSetAllComponentsUnchanged();
+  EXPECT_TRUE(changed().empty());
+  EXPECT_TRUE(manager.ChangedEntities({IntComponent::typeId}).empty());
+
+  // Any of the components may change
+  manager.SetChanged(e2, DoubleComponent::typeId,
+      ComponentState::PeriodicChange);
+  manager.SetChanged(e3, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  EXPECT_EQ(std::vector<Entity>({e2}), changed());
+
+  manager.SetChanged(e1, IntComponent::typeId);
+  manager.SetChanged(e2, IntComponent::typeId);
+  EXPECT_EQ(std::vector<Entity>({e1, e2}), changed());
+
+  // Marked back as unchanged or removed
+  manager.SetChanged(e1, IntComponent::typeId, ComponentState::NoChange);
+  EXPECT_TRUE(manager.RemoveComponent<DoubleComponent>(e2));
+  EXPECT_TRUE(changed().empty());
+  EXPECT_EQ(std::vector<Entity>({e2, e3}),
+      manager.ChangedEntities({IntComponent::typeId}));
+}
+
 //////////////////////////////////////////////////
 TEST_P(EntityComponentManagerFixture, SetEntityCreateOffset)
 {
@@ -2490,6 +2896,1064 @@ TEST_P(EntityComponentManagerFixture, RemovedComponentsSyncBetweenServerAndGUI)
   }
 }
 
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ViewsCachedComponentsAfterRemove)
+{
+  // Create some entities, all with components of the same types
+  std::vector<Entity> entities;
+  for (int i = 0; i < 5; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    manager.CreateComponent<DoubleComponent>(entity, DoubleComponent(i * 0.5));
+    entities.push_back(entity);
+  }
+
+  auto checkValues = [&](int _expectedCount)
+  {
+    int count = 0;
+    manager.Each<IntComponent, DoubleComponent>([&](const Entity &_entity,
+          const IntComponent *_int, const DoubleComponent *_double)->bool
+        {
+          EXPECT_NE(nullptr, _int);
+          EXPECT_NE(nullptr, _double);
+          const int index = static_cast<int>(std::distance(entities.begin(),
+              std::find(entities.begin(), entities.end(), _entity)));
+          EXPECT_EQ(index, _int->Data());
+          EXPECT_DOUBLE_EQ(index * 0.5, _double->Data());
+          ++count;
+          return true;
+        });
+    EXPECT_EQ(_expectedCount, count);
+  };
+
+  // Build the view
+  checkValues(5);
+
+  // Removing the first component moves the last component into its place in
+  // the storage. The view must not hand out stale pointers.
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entities[0]));
+  checkValues(4);
+
+  // Remove components of another entity while iterating
+  int count = 0;
+  manager.Each<IntComponent, DoubleComponent>([&](const Entity &_entity,
+        const IntComponent *_int, const DoubleComponent *)->bool
+      {
+        if (_entity == entities[1])
+        {
+          EXPECT_TRUE(manager.RemoveComponent<DoubleComponent>(entities[1]));
+          return false;
+        }
+        EXPECT_NE(nullptr, _int);
+        ++count;
+        return true;
+      });
+  checkValues(3);
+
+  // Removing entities also moves components in the storages
+  manager.RequestRemoveEntity(entities[2]);
+  manager.ProcessEntityRemovals();
+  checkValues(2);
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ViewSlots)
+{
+  auto countEntities = [](const EntityComponentManager &_ecm)
+  {
+    int count = 0;
+    _ecm.Each<IntComponent, DoubleComponent>([&](const Entity &,
+          const IntComponent *, const DoubleComponent *)->bool
+        {
+          ++count;
+          return true;
+        });
+    return count;
+  };
+
+  for (int i = 0; i < 3; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    manager.CreateComponent<DoubleComponent>(entity, DoubleComponent(i));
+  }
+  EXPECT_EQ(3, countEntities(manager));
+
+  // Another manager has its own views for the same component types
+  EntityComponentManager other;
+  EXPECT_EQ(0, countEntities(other));
+  Entity otherEntity = other.CreateEntity();
+  other.CreateComponent<IntComponent>(otherEntity, IntComponent(1));
+  other.CreateComponent<DoubleComponent>(otherEntity, DoubleComponent(1));
+  EXPECT_EQ(1, countEntities(other));
+  EXPECT_EQ(3, countEntities(manager));
+
+  // A pack with the same types in another order shares the view
+  int count = 0;
+  manager.Each<DoubleComponent, IntComponent>([&](const Entity &,
+        const DoubleComponent *, const IntComponent *)->bool
+      {
+        ++count;
+        return true;
+      });
+  EXPECT_EQ(3, count);
+
+  // Removing all entities clears the views, cached ones included
+  manager.RequestRemoveEntities();
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(0, countEntities(manager));
+
+  Entity entity = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(entity, IntComponent(5));
+  manager.CreateComponent<DoubleComponent>(entity, DoubleComponent(5));
+  EXPECT_EQ(1, countEntities(manager));
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ViewsUpdatedByComponentType)
+{
+  auto countInt = [&]
+  {
+    int count = 0;
+    manager.Each<IntComponent>([&](const Entity &,
+          const IntComponent *)->bool
+        {
+          ++count;
+          return true;
+        });
+    return count;
+  };
+  auto countDouble = [&]
+  {
+    int count = 0;
+    manager.Each<DoubleComponent>([&](const Entity &,
+          const DoubleComponent *)->bool
+        {
+          ++count;
+          return true;
+        });
+    return count;
+  };
+  auto countBoth = [&]
+  {
+    int count = 0;
+    manager.Each<IntComponent, DoubleComponent>([&](const Entity &,
+          const IntComponent *_int, const DoubleComponent *_double)->bool
+        {
+          EXPECT_NE(nullptr, _int);
+          EXPECT_NE(nullptr, _double);
+          ++count;
+          return true;
+        });
+    return count;
+  };
+
+  // Create the views before any component exists
+  EXPECT_EQ(0, countInt());
+  EXPECT_EQ(0, countDouble());
+  EXPECT_EQ(0, countBoth());
+
+  // Enough entities to start new storage blocks, which must not require
+  // rebuilding the views
+  std::vector<Entity> entities;
+  for (int i = 0; i < 200; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    entities.push_back(entity);
+  }
+  EXPECT_EQ(200, countInt());
+  EXPECT_EQ(0, countDouble());
+  EXPECT_EQ(0, countBoth());
+
+  for (int i = 0; i < 100; ++i)
+  {
+    manager.CreateComponent<DoubleComponent>(entities[i],
+        DoubleComponent(i));
+  }
+  EXPECT_EQ(200, countInt());
+  EXPECT_EQ(100, countDouble());
+  EXPECT_EQ(100, countBoth());
+
+  // Removing a component only drops the entity from views with its type
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entities[0]));
+  EXPECT_TRUE(manager.RemoveComponent<DoubleComponent>(entities[1]));
+  EXPECT_EQ(199, countInt());
+  EXPECT_EQ(99, countDouble());
+  EXPECT_EQ(98, countBoth());
+
+  // Adding it back restores the entity
+  manager.CreateComponent<IntComponent>(entities[0], IntComponent(0));
+  EXPECT_EQ(200, countInt());
+  EXPECT_EQ(99, countBoth());
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, RemoveManyEntities)
+{
+  // Create more entities than the storage reserves at once
+  std::vector<Entity> entities;
+  for (int i = 0; i < 250; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    if (i % 3 == 0)
+      manager.CreateComponent<DoubleComponent>(entity, DoubleComponent(i));
+    entities.push_back(entity);
+  }
+
+  // Remove every other entity in a single batch
+  for (std::size_t i = 0; i < entities.size(); i += 2)
+    manager.RequestRemoveEntity(entities[i]);
+  manager.ProcessEntityRemovals();
+
+  EXPECT_EQ(125u, manager.EntityCount());
+  for (std::size_t i = 0; i < entities.size(); ++i)
+  {
+    if (i % 2 == 0)
+    {
+      EXPECT_FALSE(manager.HasEntity(entities[i]));
+      continue;
+    }
+
+    auto intComp = manager.Component<IntComponent>(entities[i]);
+    ASSERT_NE(nullptr, intComp);
+    EXPECT_EQ(static_cast<int>(i), intComp->Data());
+
+    auto doubleComp = manager.Component<DoubleComponent>(entities[i]);
+    if (i % 3 == 0)
+    {
+      ASSERT_NE(nullptr, doubleComp);
+      EXPECT_DOUBLE_EQ(static_cast<double>(i), doubleComp->Data());
+    }
+    else
+    {
+      EXPECT_EQ(nullptr, doubleComp);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, Query)
+{
+  Entity eInt = manager.CreateEntity();
+  Entity eIntDouble = manager.CreateEntity();
+  Entity eDouble = manager.CreateEntity();
+
+  manager.CreateComponent<IntComponent>(eInt, IntComponent(1));
+  manager.CreateComponent<IntComponent>(eIntDouble, IntComponent(2));
+  manager.CreateComponent<DoubleComponent>(eIntDouble, DoubleComponent(0.2));
+  manager.CreateComponent<DoubleComponent>(eDouble, DoubleComponent(0.3));
+
+  // Mutable components
+  int count = 0;
+  for (auto [entity, intComp, doubleComp] :
+      manager.Query<IntComponent, DoubleComponent>())
+  {
+    EXPECT_EQ(eIntDouble, entity);
+    ASSERT_NE(nullptr, intComp);
+    ASSERT_NE(nullptr, doubleComp);
+    EXPECT_EQ(2, intComp->Data());
+    EXPECT_DOUBLE_EQ(0.2, doubleComp->Data());
+    intComp->Data() = 20;
+    ++count;
+  }
+  EXPECT_EQ(1, count);
+  EXPECT_EQ(20, manager.Component<IntComponent>(eIntDouble)->Data());
+
+  // Const components, the order of the template parameters doesn't matter
+  const EntityComponentManager &constManager = manager;
+  count = 0;
+  for (auto [entity, doubleComp, intComp] :
+      constManager.Query<DoubleComponent, IntComponent>())
+  {
+    EXPECT_EQ(eIntDouble, entity);
+    EXPECT_EQ(20, intComp->Data());
+    EXPECT_DOUBLE_EQ(0.2, doubleComp->Data());
+    ++count;
+  }
+  EXPECT_EQ(1, count);
+
+  // Single component
+  std::set<Entity> intEntities;
+  for (auto [entity, intComp] : manager.Query<IntComponent>())
+  {
+    EXPECT_NE(nullptr, intComp);
+    intEntities.insert(entity);
+  }
+  EXPECT_EQ(std::set<Entity>({eInt, eIntDouble}), intEntities);
+  EXPECT_EQ(2u, manager.Query<IntComponent>().Size());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ParallelEach)
+{
+  const int count = 1000;
+  for (int i = 0; i < count; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    if (i % 2 == 0)
+      manager.CreateComponent<DoubleComponent>(entity, DoubleComponent(0.5));
+  }
+
+  auto doubleAll = [&]()
+  {
+    manager.ParallelEach<IntComponent, DoubleComponent>(
+        [](const Entity &, IntComponent *_int, DoubleComponent *_double)
+        {
+          _int->Data() *= 2;
+          _double->Data() *= 2.0;
+        });
+  };
+
+  auto check = [&](int _factor)
+  {
+    std::atomic<int> visited{0};
+    std::atomic<int> sum{0};
+    const EntityComponentManager &constManager = manager;
+    constManager.ParallelEach<IntComponent>(
+        [&](const Entity &, const IntComponent *_int)
+        {
+          sum += _int->Data();
+          ++visited;
+        });
+    EXPECT_EQ(count, visited);
+
+    // Odd values are untouched, even values are multiplied
+    int expected = 0;
+    for (int i = 0; i < count; ++i)
+      expected += i % 2 == 0 ? i * _factor : i;
+    EXPECT_EQ(expected, sum);
+  };
+
+  // Without a pool, everything runs on the calling thread
+  doubleAll();
+  check(2);
+
+  // With a pool
+  common::WorkerPool pool;
+  manager.RunSetWorkerPool(&pool);
+  doubleAll();
+  check(4);
+
+  manager.Each<DoubleComponent>(
+      [&](const Entity &, const DoubleComponent *_double) -> bool
+      {
+        EXPECT_DOUBLE_EQ(2.0, _double->Data());
+        return true;
+      });
+
+  manager.RunSetWorkerPool(nullptr);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, StateWithWorkerPool)
+{
+  const int count = 500;
+  for (int i = 0; i < count; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+  }
+
+  msgs::SerializedStateMap sequential;
+  manager.State(sequential);
+  EXPECT_EQ(count, sequential.entities_size());
+
+  common::WorkerPool pool;
+  for (unsigned int threads : {1u, 2u, 7u})
+  {
+    manager.RunSetWorkerPool(&pool, threads);
+
+    msgs::SerializedStateMap parallel;
+    manager.State(parallel);
+    ASSERT_EQ(count, parallel.entities_size());
+
+    for (const auto &entity : sequential.entities())
+    {
+      auto iter = parallel.entities().find(entity.first);
+      ASSERT_NE(parallel.entities().end(), iter);
+      EXPECT_EQ(entity.second.SerializeAsString(),
+          iter->second.SerializeAsString());
+    }
+  }
+
+  manager.RunSetWorkerPool(nullptr);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, SetStateWithWorkerPool)
+{
+  const int count = 500;
+  std::vector<Entity> entities;
+  for (int i = 0; i < count; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    entities.push_back(entity);
+  }
+
+  common::WorkerPool pool;
+  EntityCompMgrTest copy;
+  copy.RunSetWorkerPool(&pool, 4);
+
+  msgs::SerializedStateMap full;
+  manager.State(full);
+  copy.SetState(full);
+  manager.RunSetAllComponentsUnchanged();
+  copy.RunSetAllComponentsUnchanged();
+
+  // Existing components are updated in parallel, while others are created
+  // and removed
+  for (int i = 0; i < count; ++i)
+    manager.SetComponentData<IntComponent>(entities[i], i + count);
+  manager.CreateComponent(entities[0], StringComponent("new"));
+  manager.RemoveComponent<IntComponent>(entities[1]);
+
+  msgs::SerializedStateMap changed;
+  manager.ChangedState(changed);
+  copy.SetState(changed);
+
+  EXPECT_EQ(nullptr, copy.Component<IntComponent>(entities[1]));
+  ASSERT_NE(nullptr, copy.Component<StringComponent>(entities[0]));
+  EXPECT_EQ("new", copy.Component<StringComponent>(entities[0])->Data());
+  for (int i = 0; i < count; ++i)
+  {
+    if (i == 1)
+      continue;
+    auto comp = copy.Component<IntComponent>(entities[i]);
+    ASSERT_NE(nullptr, comp);
+    EXPECT_EQ(i + count, comp->Data());
+    EXPECT_NE(ComponentState::NoChange,
+        copy.ComponentState(entities[i], IntComponent::typeId));
+  }
+
+  copy.RunSetWorkerPool(nullptr);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, BinaryState)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  Entity e3 = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(e1, IntComponent(1));
+  manager.CreateComponent<StringComponent>(e1, StringComponent("one"));
+  manager.CreateComponent<IntComponent>(e2, IntComponent(2));
+  manager.CreateComponent<DoubleComponent>(e3, DoubleComponent(3.5));
+
+  // Full state creates everything
+  std::string buffer;
+  manager.BinaryState(buffer, {}, {}, true);
+  EXPECT_FALSE(buffer.empty());
+
+  EntityCompMgrTest other;
+  EXPECT_TRUE(other.SetBinaryState(buffer.data(), buffer.size()));
+  EXPECT_EQ(3u, other.EntityCount());
+  ASSERT_NE(nullptr, other.Component<IntComponent>(e1));
+  EXPECT_EQ(1, other.Component<IntComponent>(e1)->Data());
+  ASSERT_NE(nullptr, other.Component<StringComponent>(e1));
+  EXPECT_EQ("one", other.Component<StringComponent>(e1)->Data());
+  ASSERT_NE(nullptr, other.Component<IntComponent>(e2));
+  EXPECT_EQ(2, other.Component<IntComponent>(e2)->Data());
+  ASSERT_NE(nullptr, other.Component<DoubleComponent>(e3));
+  EXPECT_DOUBLE_EQ(3.5, other.Component<DoubleComponent>(e3)->Data());
+
+  // Views are up to date
+  int count{0};
+  other.Each<IntComponent>([&](const Entity &, const IntComponent *) -> bool
+      {
+        ++count;
+        return true;
+      });
+  EXPECT_EQ(2, count);
+
+  // Only changes are serialized, and entity and type filters apply
+  manager.RunSetAllComponentsUnchanged();
+  other.RunSetAllComponentsUnchanged();
+  manager.Component<IntComponent>(e2)->Data() = 20;
+  manager.SetChanged(e2, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  manager.Component<DoubleComponent>(e3)->Data() = 30.5;
+  manager.SetChanged(e3, DoubleComponent::typeId,
+      ComponentState::PeriodicChange);
+
+  manager.BinaryState(buffer, {e2}, {});
+  EXPECT_TRUE(other.SetBinaryState(buffer.data(), buffer.size()));
+  EXPECT_EQ(20, other.Component<IntComponent>(e2)->Data());
+  EXPECT_DOUBLE_EQ(3.5, other.Component<DoubleComponent>(e3)->Data());
+  EXPECT_EQ(ComponentState::PeriodicChange,
+      other.ComponentState(e2, IntComponent::typeId));
+
+  manager.BinaryState(buffer, {}, {IntComponent::typeId});
+  EXPECT_TRUE(other.SetBinaryState(buffer.data(), buffer.size()));
+  EXPECT_DOUBLE_EQ(3.5, other.Component<DoubleComponent>(e3)->Data());
+
+  // Removed components and entities
+  EXPECT_TRUE(manager.RemoveComponent<StringComponent>(e1));
+  manager.RequestRemoveEntity(e3);
+  manager.BinaryState(buffer);
+  EXPECT_TRUE(other.SetBinaryState(buffer.data(), buffer.size()));
+  EXPECT_EQ(nullptr, other.Component<StringComponent>(e1));
+  EXPECT_NE(nullptr, other.Component<IntComponent>(e1));
+  EXPECT_TRUE(other.HasEntitiesMarkedForRemoval());
+
+  // Matches the protobuf state
+  manager.ProcessEntityRemovals();
+  other.ProcessEntityRemovals();
+  msgs::SerializedStateMap expected;
+  manager.State(expected, {}, {}, true);
+  msgs::SerializedStateMap actual;
+  other.State(actual, {}, {}, true);
+  EXPECT_EQ(expected.entities_size(), actual.entities_size());
+  for (const auto &entity : expected.entities())
+  {
+    auto iter = actual.entities().find(entity.first);
+    ASSERT_NE(actual.entities().end(), iter);
+    ASSERT_EQ(entity.second.components().size(),
+        iter->second.components().size());
+    for (const auto &comp : entity.second.components())
+    {
+      auto compIter = iter->second.components().find(comp.first);
+      ASSERT_NE(iter->second.components().end(), compIter);
+      EXPECT_EQ(comp.second.component(), compIter->second.component());
+    }
+  }
+
+  // Malformed buffers are rejected
+  EXPECT_FALSE(other.SetBinaryState(nullptr, 0));
+  EXPECT_FALSE(other.SetBinaryState(buffer.data(), 3));
+  std::string garbage(64, 'x');
+  EXPECT_FALSE(other.SetBinaryState(garbage.data(), garbage.size()));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ChangeStateAfterRemove)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  Entity e3 = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(e1, IntComponent(1));
+  manager.CreateComponent<IntComponent>(e2, IntComponent(2));
+  manager.CreateComponent<IntComponent>(e3, IntComponent(3));
+  EXPECT_TRUE(manager.HasOneTimeComponentChanges());
+
+  manager.RunSetAllComponentsUnchanged();
+  EXPECT_FALSE(manager.HasOneTimeComponentChanges());
+  EXPECT_TRUE(manager.ComponentTypesWithPeriodicChanges().empty());
+
+  manager.SetChanged(e3, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  EXPECT_EQ(ComponentState::PeriodicChange,
+      manager.ComponentState(e3, IntComponent::typeId));
+
+  // Removing the first component moves the last one into its place, and its
+  // state moves with it
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(e1));
+  EXPECT_EQ(ComponentState::NoChange,
+      manager.ComponentState(e2, IntComponent::typeId));
+  EXPECT_EQ(ComponentState::PeriodicChange,
+      manager.ComponentState(e3, IntComponent::typeId));
+  EXPECT_EQ(std::unordered_set<ComponentTypeId>({IntComponent::typeId}),
+      manager.ComponentTypesWithPeriodicChanges());
+
+  // Removing the changed component leaves no changes
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(e3));
+  EXPECT_TRUE(manager.ComponentTypesWithPeriodicChanges().empty());
+  EXPECT_FALSE(manager.HasOneTimeComponentChanges());
+
+  // A new component in the freed slot starts with a one-time change
+  manager.CreateComponent<IntComponent>(e1, IntComponent(4));
+  EXPECT_EQ(ComponentState::OneTimeChange,
+      manager.ComponentState(e1, IntComponent::typeId));
+  EXPECT_TRUE(manager.HasOneTimeComponentChanges());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, MemoryUsage)
+{
+  auto empty = manager.MemoryUsage();
+  EXPECT_EQ(0u, empty.entityCount);
+  EXPECT_TRUE(empty.storages.empty());
+  EXPECT_TRUE(empty.views.empty());
+
+  for (int i = 0; i < 10; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    if (i % 2 == 0)
+      manager.CreateComponent<DoubleComponent>(entity, DoubleComponent(i));
+  }
+  manager.Each<IntComponent, DoubleComponent>(
+      [](const Entity &, const IntComponent *, const DoubleComponent *)
+      {
+        return true;
+      });
+
+  auto usage = manager.MemoryUsage();
+  EXPECT_EQ(10u, usage.entityCount);
+  EXPECT_GT(usage.entityBytes, 0u);
+  EXPECT_GT(usage.changeTrackingBytes, 0u);
+
+  // Storages are sorted by type, and report entity counts per type
+  ASSERT_EQ(2u, usage.storages.size());
+  for (const auto &storage : usage.storages)
+  {
+    if (storage.type == IntComponent::typeId)
+      EXPECT_EQ(10u, storage.size);
+    else if (storage.type == DoubleComponent::typeId)
+      EXPECT_EQ(5u, storage.size);
+    else
+      ADD_FAILURE() << "Unexpected type " << storage.type;
+    EXPECT_GE(storage.capacity, storage.size);
+    EXPECT_GT(storage.bytes, 0u);
+  }
+  EXPECT_LT(usage.storages[0].type, usage.storages[1].type);
+
+  ASSERT_EQ(1u, usage.views.size());
+  EXPECT_EQ(5u, usage.views[0].size);
+  EXPECT_EQ(2u, usage.views[0].types.size());
+  EXPECT_GT(usage.views[0].bytes, 0u);
+
+  std::size_t total = usage.entityBytes + usage.changeTrackingBytes +
+      usage.cacheBytes + usage.storages[0].bytes + usage.storages[1].bytes +
+      usage.views[0].bytes;
+  EXPECT_EQ(total, usage.TotalBytes());
+  EXPECT_GT(usage.TotalBytes(), empty.TotalBytes());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, Compact)
+{
+  // Nothing to do before entities are removed
+  EXPECT_TRUE(manager.Compact(std::chrono::steady_clock::duration::zero()));
+
+  std::vector<Entity> entities;
+  for (int i = 0; i < 2000; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    entities.push_back(entity);
+  }
+  manager.Each<IntComponent>([](const Entity &, const IntComponent *)
+      {
+        return true;
+      });
+
+  // Keep the last entities only
+  for (std::size_t i = 0; i < entities.size() - 10; ++i)
+    manager.RequestRemoveEntity(entities[i]);
+  manager.ProcessEntityRemovals();
+  auto before = manager.MemoryUsage();
+
+  // Without a budget, a single container is compacted per call
+  EXPECT_FALSE(manager.Compact(std::chrono::steady_clock::duration::zero()));
+  EXPECT_TRUE(manager.Compact(std::chrono::hours(1)));
+  EXPECT_TRUE(manager.Compact(std::chrono::steady_clock::duration::zero()));
+
+  auto after = manager.MemoryUsage();
+  EXPECT_LT(after.TotalBytes(), before.TotalBytes());
+  ASSERT_EQ(1u, after.storages.size());
+  EXPECT_LT(after.storages[0].bytes, before.storages[0].bytes);
+  ASSERT_EQ(1u, after.views.size());
+  EXPECT_LT(after.views[0].bytes, before.views[0].bytes);
+
+  // Remaining and new components are still found
+  for (std::size_t i = entities.size() - 10; i < entities.size(); ++i)
+  {
+    auto comp = manager.Component<IntComponent>(entities[i]);
+    ASSERT_NE(nullptr, comp);
+    EXPECT_EQ(static_cast<int>(i), comp->Data());
+  }
+  Entity entity = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(entity, IntComponent(-1));
+  ASSERT_NE(nullptr, manager.Component<IntComponent>(entity));
+  EXPECT_EQ(-1, manager.Component<IntComponent>(entity)->Data());
+
+  int count = 0;
+  manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+      {
+        ++count;
+        return true;
+      });
+  EXPECT_EQ(11, count);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, Counters)
+{
+  auto empty = manager.Counters();
+  EXPECT_EQ(0u, empty.componentsCreated);
+  EXPECT_EQ(0u, empty.viewsCreated);
+  EXPECT_TRUE(empty.views.empty());
+
+  std::vector<Entity> entities;
+  for (int i = 0; i < 10; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    if (i % 2 == 0)
+      manager.CreateComponent<DoubleComponent>(entity, DoubleComponent(i));
+    entities.push_back(entity);
+  }
+
+  for (int i = 0; i < 3; ++i)
+  {
+    manager.Each<IntComponent, DoubleComponent>(
+        [](const Entity &, const IntComponent *, const DoubleComponent *)
+        {
+          return true;
+        });
+  }
+
+  manager.RemoveComponent<DoubleComponent>(entities[0]);
+  manager.RequestRemoveEntity(entities[1]);
+  manager.ProcessRemoveEntityRequests();
+
+  msgs::SerializedStateMap state;
+  manager.State(state, {}, {}, true);
+
+  auto counters = manager.Counters();
+  EXPECT_EQ(15u, counters.componentsCreated);
+  EXPECT_EQ(2u, counters.componentsRemoved);
+  EXPECT_EQ(1u, counters.viewsCreated);
+  EXPECT_GT(counters.stateBytes, 0u);
+
+  ASSERT_EQ(1u, counters.views.size());
+  EXPECT_EQ(2u, counters.views[0].types.size());
+  EXPECT_EQ(3u, counters.views[0].eachCalls);
+  EXPECT_EQ(15u, counters.views[0].entitiesVisited);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, AccessStats)
+{
+  Entity entity = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(entity, IntComponent(1));
+  manager.CreateComponent<DoubleComponent>(entity, DoubleComponent(2.0));
+  const auto &constManager = manager;
+
+  // Nothing is recorded by default
+  EXPECT_FALSE(manager.AccessTracing());
+  EXPECT_NE(nullptr, constManager.Component<IntComponent>(entity));
+  EXPECT_TRUE(manager.AccessStats().components.empty());
+
+  manager.SetAccessTracing(true);
+  EXPECT_TRUE(manager.AccessTracing());
+
+  EntityComponentManager::SetAccessContext("reader");
+  EXPECT_NE(nullptr, constManager.Component<IntComponent>(entity));
+  EXPECT_NE(nullptr, constManager.Component<IntComponent>(entity));
+  manager.Each<IntComponent, DoubleComponent>(
+      [](const Entity &, const IntComponent *, const DoubleComponent *)
+      {
+        return true;
+      });
+
+  EntityComponentManager::SetAccessContext("writer");
+  EXPECT_NE(nullptr, manager.Component<DoubleComponent>(entity));
+  manager.Each<IntComponent, DoubleComponent>(
+      [](const Entity &, IntComponent *, DoubleComponent *)
+      {
+        return true;
+      });
+  EntityComponentManager::SetAccessContext("");
+
+  // Accesses made while tracing are kept once it's off
+  manager.SetAccessTracing(false);
+  EXPECT_NE(nullptr, constManager.Component<IntComponent>(entity));
+
+  auto stats = manager.AccessStats();
+  ASSERT_EQ(2u, stats.components.size());
+  EXPECT_EQ("reader", stats.components[0].context);
+  EXPECT_EQ(IntComponent::typeId, stats.components[0].type);
+  EXPECT_EQ(2u, stats.components[0].reads);
+  EXPECT_EQ(0u, stats.components[0].writes);
+  EXPECT_EQ("writer", stats.components[1].context);
+  EXPECT_EQ(DoubleComponent::typeId, stats.components[1].type);
+  EXPECT_EQ(0u, stats.components[1].reads);
+  EXPECT_EQ(1u, stats.components[1].writes);
+
+  ASSERT_EQ(2u, stats.views.size());
+  EXPECT_EQ("reader", stats.views[0].context);
+  EXPECT_EQ(2u, stats.views[0].types.size());
+  EXPECT_EQ(1u, stats.views[0].readCalls);
+  EXPECT_EQ(0u, stats.views[0].writeCalls);
+  EXPECT_EQ(1u, stats.views[0].entitiesVisited);
+  EXPECT_EQ("writer", stats.views[1].context);
+  EXPECT_EQ(0u, stats.views[1].readCalls);
+  EXPECT_EQ(1u, stats.views[1].writeCalls);
+  EXPECT_EQ(1u, stats.views[1].entitiesVisited);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ViewsKeptAfterRemovals)
+{
+  auto count = [&]
+  {
+    int each = 0;
+    manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+        {
+          ++each;
+          return true;
+        });
+    int eachNew = 0;
+    manager.EachNew<IntComponent>([&](const Entity &, const IntComponent *)
+        {
+          ++eachNew;
+          return true;
+        });
+    return std::make_pair(each, eachNew);
+  };
+
+  std::vector<Entity> entities;
+  for (int i = 0; i < 3; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    entities.push_back(entity);
+  }
+  EXPECT_EQ(std::make_pair(3, 3), count());
+
+  manager.RunClearNewlyCreatedEntities();
+  EXPECT_EQ(std::make_pair(3, 0), count());
+
+  manager.RequestRemoveEntity(entities[0]);
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(std::make_pair(2, 0), count());
+
+  // Views are emptied instead of being recreated
+  manager.RequestRemoveEntities();
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(std::make_pair(0, 0), count());
+  EXPECT_EQ(1u, manager.Counters().viewsCreated);
+
+  Entity entity = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(entity, IntComponent(5));
+  EXPECT_EQ(std::make_pair(1, 1), count());
+  EXPECT_EQ(1u, manager.Counters().viewsCreated);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ValueIndex)
+{
+  EXPECT_TRUE(manager.HasValueIndex(components::Name::typeId));
+  EXPECT_TRUE(manager.HasValueIndex(components::ParentEntity::typeId));
+  EXPECT_FALSE(manager.HasValueIndex(StringComponent::typeId));
+
+  Entity parent = manager.CreateEntity();
+  std::vector<Entity> children;
+  for (int i = 0; i < 4; ++i)
+  {
+    Entity child = manager.CreateEntity();
+    manager.SetParentEntity(child, parent);
+    manager.CreateComponent(child, components::ParentEntity(parent));
+    manager.CreateComponent(child, components::Name(i < 2 ? "a" : "b"));
+    manager.CreateComponent(child, StringComponent(i < 2 ? "a" : "b"));
+    children.push_back(child);
+  }
+
+  // Indexing a type indexes the components which already exist
+  manager.EnableValueIndex<StringComponent>();
+  EXPECT_TRUE(manager.HasValueIndex(StringComponent::typeId));
+
+  EXPECT_EQ(children[0], manager.EntityByComponents(components::Name("a")));
+  EXPECT_EQ(children[2], manager.EntityByComponents(StringComponent("b")));
+  EXPECT_EQ(std::vector<Entity>({children[2], children[3]}),
+      manager.EntitiesByComponents(components::Name("b"),
+      StringComponent("b")));
+  EXPECT_TRUE(manager.EntitiesByComponents(components::Name("a"),
+      StringComponent("b")).empty());
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(components::Name("c")));
+  EXPECT_EQ(std::vector<Entity>({children[0], children[1]}),
+      manager.ChildrenByComponents(parent, components::Name("a")));
+  EXPECT_EQ(children, manager.ChildrenByComponents(parent,
+      components::ParentEntity(parent)));
+
+  // Values set through the manager are followed
+  EXPECT_TRUE(manager.SetComponentData<components::Name>(children[0], "c"));
+  EXPECT_EQ(children[0], manager.EntityByComponents(components::Name("c")));
+  EXPECT_EQ(children[1], manager.EntityByComponents(components::Name("a")));
+
+  // Values modified in place are followed once marked as changed
+  manager.Component<components::Name>(children[1])->Data() = "c";
+  manager.SetChanged(children[1], components::Name::typeId,
+      ComponentState::OneTimeChange);
+  EXPECT_EQ(std::vector<Entity>({children[0], children[1]}),
+      manager.EntitiesByComponents(components::Name("c")));
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(components::Name("a")));
+
+  // Removed components and entities aren't found
+  manager.RemoveComponent<components::Name>(children[0]);
+  EXPECT_EQ(children[1], manager.EntityByComponents(components::Name("c")));
+  manager.RequestRemoveEntity(children[1]);
+  manager.ProcessRemoveEntityRequests();
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(components::Name("c")));
+  EXPECT_EQ(std::vector<Entity>({children[0], children[2], children[3]}),
+      manager.ChildrenByComponents(parent,
+      components::ParentEntity(parent)));
+
+  manager.RequestRemoveEntities();
+  manager.ProcessRemoveEntityRequests();
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(components::Name("b")));
+  EXPECT_TRUE(manager.HasValueIndex(StringComponent::typeId));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, DeferredChanges)
+{
+  Entity existing = manager.CreateEntity();
+  manager.CreateComponent(existing, IntComponent(1));
+  manager.CreateComponent(existing, StringComponent("a"));
+  manager.RunClearNewlyCreatedEntities();
+
+  // Threads record into their buffer, the second buffer is filled first
+  manager.RunBeginDeferredChanges(2);
+  Entity created0{kNullEntity};
+  Entity created1{kNullEntity};
+  Entity created2{kNullEntity};
+  std::thread second([&]
+  {
+    manager.RunDeferChanges(1);
+    created1 = manager.CreateEntity();
+    manager.CreateComponent(created1, IntComponent(3));
+    manager.SetParentEntity(created1, existing);
+    manager.RemoveComponent<StringComponent>(existing);
+  });
+  second.join();
+  std::thread first([&]
+  {
+    manager.RunDeferChanges(0);
+    created0 = manager.CreateEntity();
+    created2 = manager.CreateEntity();
+    manager.CreateComponent(created0, IntComponent(2));
+    manager.RequestRemoveEntity(created2);
+  });
+  first.join();
+
+  // Ids only depend on the buffer, and nothing is applied yet
+  EXPECT_EQ(existing + 1, created0);
+  EXPECT_EQ(existing + 2, created1);
+  EXPECT_EQ(existing + 3, created2);
+  EXPECT_EQ(1u, manager.EntityCount());
+  EXPECT_NE(nullptr, manager.Component<StringComponent>(existing));
+
+  manager.RunEndDeferredChanges();
+  EXPECT_EQ(4u, manager.EntityCount());
+  ASSERT_NE(nullptr, manager.Component<IntComponent>(created0));
+  EXPECT_EQ(2, manager.Component<IntComponent>(created0)->Data());
+  ASSERT_NE(nullptr, manager.Component<IntComponent>(created1));
+  EXPECT_EQ(3, manager.Component<IntComponent>(created1)->Data());
+  EXPECT_EQ(existing, manager.ParentEntity(created1));
+  EXPECT_EQ(nullptr, manager.Component<StringComponent>(existing));
+
+  // Views see the changes
+  std::size_t count{0};
+  manager.EachNew<IntComponent>([&](const Entity &, const IntComponent *)
+  {
+    ++count;
+    return true;
+  });
+  EXPECT_EQ(2u, count);
+
+  manager.ProcessEntityRemovals();
+  EXPECT_FALSE(manager.HasEntity(created2));
+
+  // Changes are applied immediately again, and ids follow the deferred ones
+  EXPECT_EQ(created2 + 1, manager.CreateEntity());
+  EXPECT_EQ(4u, manager.EntityCount());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EnableDisable)
+{
+  auto count = [&]
+  {
+    int each = 0;
+    manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+        {
+          ++each;
+          return true;
+        });
+    int eachNew = 0;
+    manager.EachNew<IntComponent>([&](const Entity &, const IntComponent *)
+        {
+          ++eachNew;
+          return true;
+        });
+    int eachRemoved = 0;
+    manager.EachRemoved<IntComponent>([&](const Entity &,
+        const IntComponent *)
+        {
+          ++eachRemoved;
+          return true;
+        });
+    return std::make_tuple(each, eachNew, eachRemoved);
+  };
+
+  Entity parent = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(parent, IntComponent(1));
+  Entity child = manager.CreateEntity();
+  manager.SetParentEntity(child, parent);
+  manager.CreateComponent<IntComponent>(child, IntComponent(2));
+  manager.RunClearNewlyCreatedEntities();
+  EXPECT_EQ(std::make_tuple(2, 0, 0), count());
+  EXPECT_TRUE(manager.IsEnabled(parent));
+
+  // Disabled entities are seen as removed until the end of the step
+  manager.SetEnabled(parent, false);
+  EXPECT_FALSE(manager.IsEnabled(parent));
+  EXPECT_FALSE(manager.IsEnabled(child));
+  EXPECT_TRUE(manager.HasEntitiesMarkedForRemoval());
+  EXPECT_EQ(std::make_tuple(2, 0, 2), count());
+
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(std::make_tuple(0, 0, 0), count());
+  EXPECT_FALSE(manager.HasEntitiesMarkedForRemoval());
+  EXPECT_TRUE(manager.HasEntity(parent));
+  EXPECT_EQ(2, manager.Component<IntComponent>(child)->Data());
+
+  // New components don't bring them back to views
+  manager.CreateComponent<StringComponent>(child, StringComponent("a"));
+  EXPECT_EQ(std::make_tuple(0, 0, 0), count());
+
+  // Enabled entities are seen as new, with their components intact
+  manager.SetEnabled(child, true, false);
+  EXPECT_TRUE(manager.IsEnabled(child));
+  EXPECT_FALSE(manager.IsEnabled(parent));
+  EXPECT_EQ(std::make_tuple(1, 1, 0), count());
+  manager.Each<IntComponent, StringComponent>(
+      [&](const Entity &_entity, const IntComponent *_int,
+          const StringComponent *_string)
+      {
+        EXPECT_EQ(child, _entity);
+        EXPECT_EQ(2, _int->Data());
+        EXPECT_EQ("a", _string->Data());
+        return true;
+      });
+
+  manager.RunClearNewlyCreatedEntities();
+  manager.SetEnabled(parent, true);
+  EXPECT_EQ(std::make_tuple(2, 1, 0), count());
+  manager.RunClearNewlyCreatedEntities();
+
+  // Enabling an entity in the step it was disabled in keeps it in views
+  manager.SetEnabled(parent, false, false);
+  manager.SetEnabled(parent, true, false);
+  EXPECT_EQ(std::make_tuple(2, 0, 0), count());
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(std::make_tuple(2, 0, 0), count());
+
+  // Disabled entities are left out of the state
+  manager.SetEnabled(child, false);
+  manager.ProcessEntityRemovals();
+  auto state = manager.State();
+  ASSERT_EQ(1, state.entities_size());
+  EXPECT_EQ(parent, state.entities(0).id());
+}
+
 // Run multiple times. We want to make sure that static globals don't cause
 // problems.
 INSTANTIATE_TEST_SUITE_P(EntityComponentManagerRepeat,
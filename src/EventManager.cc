@@ -14,6 +14,10 @@
  * limitations under the License.
  *
 */
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+
 #include "ignition/gazebo/EventManager.hh"
 
 using namespace ignition;
@@ -24,3 +28,13 @@ EventManager::EventManager() = default;
 
 //////////////////////////////////////////////////
 EventManager::~EventManager() = default;
+
+//////////////////////////////////////////////////
+std::size_t EventManager::RegisterEvent(const std::type_info &_type)
+{
+  static std::mutex mutex;
+  static std::unordered_map<std::type_index, std::size_t> indices;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  return indices.emplace(_type, indices.size()).first->second;
+}
@@ -119,3 +119,31 @@ TEST(EventManager, Disambiguate)
   EXPECT_EQ(1, calls);
 }
 
+
+TEST(EventManager, SeveralManagers)
+{
+  using TestEvent = ignition::common::EventT<void(int),
+      struct SeveralManagersTag>;
+
+  EventManager eventManager1;
+  EventManager eventManager2;
+
+  // Emitting before connecting does nothing
+  eventManager2.Emit<TestEvent>(1);
+
+  int calls1 = 0;
+  int calls2 = 0;
+  auto connection1 = eventManager1.Connect<TestEvent>(
+      [&](int _value){ calls1 += _value;});
+  auto connection2 = eventManager2.Connect<TestEvent>(
+      [&](int _value){ calls2 += _value;});
+
+  // Each manager only signals its own connections
+  eventManager1.Emit<TestEvent>(1);
+  EXPECT_EQ(1, calls1);
+  EXPECT_EQ(0, calls2);
+
+  eventManager2.Emit<TestEvent>(2);
+  EXPECT_EQ(1, calls1);
+  EXPECT_EQ(2, calls2);
+}
@@ -18,6 +18,9 @@
 #include "LevelManager.hh"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 #include <sdf/Actor.hh>
 #include <sdf/Atmosphere.hh>
@@ -45,6 +48,7 @@
 #include "ignition/gazebo/components/MagneticField.hh"
 #include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/Performer.hh"
+#include "ignition/gazebo/components/PerformerAffinity.hh"
 #include "ignition/gazebo/components/PerformerLevels.hh"
 #include "ignition/gazebo/components/Physics.hh"
 #include "ignition/gazebo/components/PhysicsEnginePlugin.hh"
@@ -73,6 +77,8 @@ LevelManager::LevelManager(SimulationRunner *_runner, const bool _useLevels)
   this->entityCreator = std::make_unique<SdfEntityCreator>(
       this->runner->entityCompMgr,
       this->runner->eventMgr);
+  this->entityCreator->SetWorkerPool(this->runner->workerPool,
+      this->runner->workerThreads);
 
   this->ReadLevelPerformerInfo();
   this->CreatePerformers();
@@ -183,9 +189,14 @@ void LevelManager::ReadLevelPerformerInfo()
   {
     this->ReadPerformers(pluginElem);
     if (this->useLevels)
+    {
+      this->IndexLevelRefs();
       this->ReadLevels(pluginElem);
+    }
   }
 
+  if (this->levelRefs.empty())
+    this->IndexLevelRefs();
   this->ConfigureDefaultLevel();
 
   // Load world plugins.
@@ -342,6 +353,36 @@ void LevelManager::ReadLevels(const sdf::ElementPtr &_sdf)
   if (_sdf == nullptr)
     return;
 
+  this->performerUpdateThreshold =
+      _sdf->Get<double>("performer_update_threshold", 0.0).first;
+  if (this->performerUpdateThreshold < 0)
+  {
+    ignwarn << "The performer_update_threshold parameter cannot be a "
+            << "negative number. Setting to 0.0\n";
+    this->performerUpdateThreshold = 0.0;
+  }
+
+  this->entitiesPerStep =
+      _sdf->Get<unsigned int>("level_entities_per_step", 0u).first;
+
+  this->preloadTime = _sdf->Get<double>("level_preload_time", 0.0).first;
+  if (this->preloadTime < 0)
+  {
+    ignwarn << "The level_preload_time parameter cannot be a negative "
+            << "number. Setting to 0.0\n";
+    this->preloadTime = 0.0;
+  }
+
+  double poolSize = _sdf->Get<double>("dormant_pool_size", 0.0).first;
+  if (poolSize < 0)
+  {
+    ignwarn << "The dormant_pool_size parameter cannot be a negative number. "
+            << "Setting to 0.0\n";
+    poolSize = 0.0;
+  }
+  // Megabytes to bytes
+  this->dormantPoolSize = static_cast<std::size_t>(poolSize * 1024 * 1024);
+
   for (auto level = _sdf->GetElement("level"); level;
        level = level->GetNextElement("level"))
   {
@@ -365,20 +406,31 @@ void LevelManager::ReadLevels(const sdf::ElementPtr &_sdf)
       buffer = 0.0;
     }
 
+    // Entity
+    Entity levelEntity = this->runner->entityCompMgr.CreateEntity();
+
     std::set<std::string> entityNames;
+    auto &members = this->levelMembers[levelEntity];
 
     for (auto ref = level->GetElement("ref"); ref;
          ref = ref->GetNextElement("ref"))
     {
       std::string entityName = ref->GetValue()->GetAsString();
-      entityNames.insert(entityName);
+      if (!entityNames.insert(entityName).second)
+        continue;
 
-      this->entityNamesInLevels.insert(entityName);
+      auto refIt = this->levelRefsByName.find(entityName);
+      if (refIt == this->levelRefsByName.end())
+      {
+        ignwarn << "Level [" << name << "] refers to [" << entityName
+                << "], which isn't a model, actor or light of the world."
+                << std::endl;
+        continue;
+      }
+      members.insert(members.end(), refIt->second.begin(),
+          refIt->second.end());
     }
 
-    // Entity
-    Entity levelEntity = this->runner->entityCompMgr.CreateEntity();
-
     // Components
     this->runner->entityCompMgr.CreateComponent(
         levelEntity, components::Level());
@@ -394,84 +446,217 @@ void LevelManager::ReadLevels(const sdf::ElementPtr &_sdf)
         levelEntity, components::LevelBuffer(buffer));
 
     this->entityCreator->SetParent(levelEntity, this->worldEntity);
+
+    // Levels are static, so their volumes are cached here instead of being
+    // computed every update
+    const auto &size = geometry.BoxShape()->Size();
+    LevelRegion levelRegion;
+    levelRegion.entity = levelEntity;
+    levelRegion.region = math::AxisAlignedBox(
+        pose.Pos() - size / 2, pose.Pos() + size / 2);
+    levelRegion.outerRegion = math::AxisAlignedBox(
+        pose.Pos() - (size / 2 + buffer), pose.Pos() + (size / 2 + buffer));
+    this->levelRegions.push_back(levelRegion);
   }
+
+  this->BuildLevelGrid();
+}
+
+//////////////////////////////////////////////////
+/// \brief Key of a level grid cell.
+/// \param[in] _x Cell index along X.
+/// \param[in] _y Cell index along Y.
+/// \return Key combining both indices.
+static uint64_t cellKey(int64_t _x, int64_t _y)
+{
+  return (static_cast<uint64_t>(static_cast<uint32_t>(_x)) << 32) |
+      static_cast<uint64_t>(static_cast<uint32_t>(_y));
 }
 
 /////////////////////////////////////////////////
-void LevelManager::ConfigureDefaultLevel()
+void LevelManager::BuildLevelGrid()
 {
-  IGN_PROFILE("LevelManager::ConfigureDefaultLevel");
+  IGN_PROFILE("LevelManager::BuildLevelGrid");
 
-  // Create the default level. This level contains all entities not contained by
-  // any other level.
-  Entity defaultLevel = this->runner->entityCompMgr.CreateEntity();
+  // A level spanning more cells than this is kept out of the grid and
+  // checked against every performer instead.
+  const int64_t kMaxCellsPerLevel{4096};
 
-  // Go through all entities in the world and find ones not in the
-  // set entityNamesInLevels
+  this->levelGrid.clear();
+  this->largeLevels.clear();
+  this->gridCellSize = 0.0;
 
-  std::set<std::string> entityNamesInDefault;
+  if (this->levelRegions.empty())
+    return;
 
-  // Models
-  for (uint64_t modelIndex = 0;
-       modelIndex < this->runner->sdfWorld->ModelCount(); ++modelIndex)
+  // Size cells after the average level, so that a performer usually
+  // overlaps only a handful of cells, each holding a handful of levels.
+  for (const auto &level : this->levelRegions)
   {
-    // There is no sdf::World::ModelByName so we have to iterate by index and
-    // check if the model is in this level
-    auto model = this->runner->sdfWorld->ModelByIndex(modelIndex);
-    // If model is a performer, it will be handled separately
-    if (this->performerMap.find(model->Name()) != this->performerMap.end())
+    const auto size = level.outerRegion.Size();
+    this->gridCellSize += std::max(size.X(), size.Y());
+  }
+  this->gridCellSize /= static_cast<double>(this->levelRegions.size());
+  if (!std::isfinite(this->gridCellSize) || this->gridCellSize <= 0.0)
+  {
+    // Degenerate levels, fall back to checking everything.
+    this->gridCellSize = 0.0;
+    for (std::size_t i = 0; i < this->levelRegions.size(); ++i)
+      this->largeLevels.push_back(i);
+    return;
+  }
+
+  for (std::size_t i = 0; i < this->levelRegions.size(); ++i)
+  {
+    const auto &box = this->levelRegions[i].outerRegion;
+    const auto minX =
+        static_cast<int64_t>(std::floor(box.Min().X() / this->gridCellSize));
+    const auto minY =
+        static_cast<int64_t>(std::floor(box.Min().Y() / this->gridCellSize));
+    const auto maxX =
+        static_cast<int64_t>(std::floor(box.Max().X() / this->gridCellSize));
+    const auto maxY =
+        static_cast<int64_t>(std::floor(box.Max().Y() / this->gridCellSize));
+
+    if ((maxX - minX + 1) * (maxY - minY + 1) > kMaxCellsPerLevel)
     {
+      this->largeLevels.push_back(i);
       continue;
     }
 
-    if (this->entityNamesInLevels.find(model->Name()) ==
-        this->entityNamesInLevels.end())
+    for (auto x = minX; x <= maxX; ++x)
     {
-      entityNamesInDefault.insert(model->Name());
+      for (auto y = minY; y <= maxY; ++y)
+      {
+        this->levelGrid[cellKey(x, y)].push_back(i);
+      }
     }
   }
 
-  // Actors
-  for (uint64_t actorIndex = 0;
-       actorIndex < this->runner->sdfWorld->ActorCount(); ++actorIndex)
+  igndbg << "Indexed [" << this->levelRegions.size() << "] levels in ["
+         << this->levelGrid.size() << "] cells of [" << this->gridCellSize
+         << "] m" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void LevelManager::LevelCandidates(const math::AxisAlignedBox &_box,
+    std::vector<std::size_t> &_candidates) const
+{
+  _candidates = this->largeLevels;
+
+  if (this->gridCellSize <= 0.0)
+    return;
+
+  const double minX = std::floor(_box.Min().X() / this->gridCellSize);
+  const double minY = std::floor(_box.Min().Y() / this->gridCellSize);
+  const double maxX = std::floor(_box.Max().X() / this->gridCellSize);
+  const double maxY = std::floor(_box.Max().Y() / this->gridCellSize);
+
+  // If the box covers more cells than there are levels, it's cheaper to
+  // check all of them.
+  const double cellCount = (maxX - minX + 1) * (maxY - minY + 1);
+  if (!std::isfinite(cellCount) ||
+      cellCount > static_cast<double>(this->levelRegions.size()))
   {
-    // There is no sdf::World::ActorByName so we have to iterate by index and
-    // check if the actor is in this level
-    auto actor = this->runner->sdfWorld->ActorByIndex(actorIndex);
-    // If actor is a performer, it will be handled separately
-    if (this->performerMap.find(actor->Name()) != this->performerMap.end())
-    {
-      continue;
-    }
+    _candidates.resize(this->levelRegions.size());
+    for (std::size_t i = 0; i < _candidates.size(); ++i)
+      _candidates[i] = i;
+    return;
+  }
 
-    if (this->entityNamesInLevels.find(actor->Name()) ==
-        this->entityNamesInLevels.end())
+  for (auto x = static_cast<int64_t>(minX); x <= static_cast<int64_t>(maxX);
+      ++x)
+  {
+    for (auto y = static_cast<int64_t>(minY);
+        y <= static_cast<int64_t>(maxY); ++y)
     {
-      entityNamesInDefault.insert(actor->Name());
+      auto cell = this->levelGrid.find(cellKey(x, y));
+      if (cell == this->levelGrid.end())
+        continue;
+      _candidates.insert(_candidates.end(), cell->second.begin(),
+          cell->second.end());
     }
   }
 
-  // Lights
-  // We assume no performers are lights
-  for (uint64_t lightIndex = 0;
-       lightIndex < this->runner->sdfWorld->LightCount(); ++lightIndex)
+  std::sort(_candidates.begin(), _candidates.end());
+  _candidates.erase(std::unique(_candidates.begin(), _candidates.end()),
+      _candidates.end());
+}
+
+/////////////////////////////////////////////////
+void LevelManager::IndexLevelRefs()
+{
+  this->levelRefs.clear();
+  this->levelRefsByName.clear();
+
+  auto addRef = [&](RefType _type, uint64_t _index, const std::string &_name)
+  {
+    LevelRef ref;
+    ref.type = _type;
+    ref.index = _index;
+    ref.name = _name;
+    this->levelRefsByName[_name].push_back(this->levelRefs.size());
+    this->levelRefs.push_back(ref);
+  };
+
+  const auto *world = this->runner->sdfWorld;
+  for (uint64_t i = 0; i < world->ModelCount(); ++i)
+    addRef(RefType::MODEL, i, world->ModelByIndex(i)->Name());
+  for (uint64_t i = 0; i < world->ActorCount(); ++i)
+    addRef(RefType::ACTOR, i, world->ActorByIndex(i)->Name());
+  for (uint64_t i = 0; i < world->LightCount(); ++i)
+    addRef(RefType::LIGHT, i, world->LightByIndex(i)->Name());
+}
+
+/////////////////////////////////////////////////
+void LevelManager::ConfigureDefaultLevel()
+{
+  IGN_PROFILE("LevelManager::ConfigureDefaultLevel");
+
+  // Create the default level. This level contains all entities not contained by
+  // any other level.
+  this->defaultLevel = this->runner->entityCompMgr.CreateEntity();
+
+  // Go through all entities in the world and find ones which aren't part of
+  // any level
+  std::vector<bool> inLevel(this->levelRefs.size(), false);
+  for (const auto &members : this->levelMembers)
+  {
+    for (const auto &ref : members.second)
+      inLevel[ref] = true;
+  }
+
+  std::set<std::string> entityNamesInDefault;
+  auto &defaultMembers = this->levelMembers[this->defaultLevel];
+
+  for (std::size_t i = 0; i < this->levelRefs.size(); ++i)
   {
-    auto light = this->runner->sdfWorld->LightByIndex(lightIndex);
-    if (this->entityNamesInLevels.find(light->Name()) ==
-        this->entityNamesInLevels.end())
+    const auto &ref = this->levelRefs[i];
+
+    // If a model or actor is a performer, it will be handled separately.
+    // We assume no performers are lights
+    if (ref.type != RefType::LIGHT &&
+        this->performerMap.find(ref.name) != this->performerMap.end())
     {
-      entityNamesInDefault.insert(light->Name());
+      continue;
+    }
+
+    if (!inLevel[i])
+    {
+      entityNamesInDefault.insert(ref.name);
+      defaultMembers.push_back(i);
     }
   }
+
   // Components
   this->runner->entityCompMgr.CreateComponent(
-      defaultLevel, components::Level());
+      this->defaultLevel, components::Level());
   this->runner->entityCompMgr.CreateComponent(
-      defaultLevel, components::DefaultLevel());
+      this->defaultLevel, components::DefaultLevel());
   this->runner->entityCompMgr.CreateComponent(
-      defaultLevel, components::LevelEntityNames(entityNamesInDefault));
+      this->defaultLevel, components::LevelEntityNames(entityNamesInDefault));
 
-  this->entityCreator->SetParent(defaultLevel, this->worldEntity);
+  this->entityCreator->SetParent(this->defaultLevel, this->worldEntity);
 }
 
 /////////////////////////////////////////////////
@@ -527,6 +712,7 @@ void LevelManager::UpdateLevelsState()
   IGN_PROFILE("LevelManager::UpdateLevelsState");
 
   std::vector<Entity> levelsToLoad;
+  std::vector<Entity> levelsToPreload;
   std::vector<Entity> levelsToUnload;
 
   {
@@ -561,6 +747,15 @@ void LevelManager::UpdateLevelsState()
   // If levels are not being used, we only process the default level.
   if (this->useLevels)
   {
+    bool hasPerformers{false};
+    std::vector<std::size_t> candidates;
+
+    // A network secondary only simulates the performers assigned to it, so
+    // it only needs their levels.
+    std::string secondaryPrefix;
+    if (this->runner->networkMgr && this->runner->networkMgr->IsSecondary())
+      secondaryPrefix = this->runner->networkMgr->Namespace();
+
     this->runner->entityCompMgr.Each<
       components::Performer,
       components::PerformerLevels,
@@ -576,6 +771,8 @@ void LevelManager::UpdateLevelsState()
 
           auto pose = this->runner->entityCompMgr.Component<components::Pose>(
               _parent->Data());
+          if (nullptr == pose)
+            return true;
 
           // We assume the geometry contains a box.
           auto perfBox = _geometry->Data().BoxShape();
@@ -586,70 +783,93 @@ void LevelManager::UpdateLevelsState()
           return true;
           }
 
-          math::AxisAlignedBox performerVolume{
-            pose->Data().Pos() - perfBox->Size() / 2,
-              pose->Data().Pos() + perfBox->Size() / 2};
-
-          std::set<Entity> newPerfLevels;
-
-          // loop through levels and check for intersections
-          // Add all levels with intersections to the levelsToLoad even if they
-          // are currently active.
-          this->runner->entityCompMgr.Each<components::Level, components::Pose,
-            components::Geometry,
-            components::LevelBuffer >(
-                [&](const Entity &_entity, const components::Level *,
-                  const components::Pose *_pose,
-                  const components::Geometry *_levelGeometry,
-                  const components::LevelBuffer *_levelBuffer) -> bool
-                {
-                IGN_PROFILE("CheckPerformerAgainstLevel");
-                // Check if the performer is in this level
-                // assume a box for now
-                auto box = _levelGeometry->Data().BoxShape();
-                if (nullptr == box)
-                {
-                ignerr << "Level [" << _entity
-                << "]'s geometry is not a box." << std::endl;
-                return true;
-                }
-                auto buffer = _levelBuffer->Data();
-                auto center = _pose->Data().Pos();
-                math::AxisAlignedBox region{center - box->Size() / 2,
-                center + box->Size() / 2};
-
-                math::AxisAlignedBox outerRegion{
-                  center - (box->Size() / 2 + buffer),
-                         center + (box->Size() / 2 + buffer)};
-
-                if (region.Intersects(performerVolume))
-                {
-                  newPerfLevels.insert(_entity);
-                  levelsToLoad.push_back(_entity);
-                }
-                else
-                {
-                  // If the level is active, check if the performer is
-                  // outside of the buffer of this level
-                  if (this->IsLevelActive(_entity))
-                  {
-                    if (outerRegion.Intersects(performerVolume))
-                    {
-                      newPerfLevels.insert(_entity);
-                      levelsToLoad.push_back(_entity);
-                      return true;
-                    }
-                    // Otherwise, mark the level to be unloaded
-                    levelsToUnload.push_back(_entity);
-                  }
-                }
-                return true;
-                });
-
-          *_perfLevels = components::PerformerLevels(newPerfLevels);
+          hasPerformers = true;
+
+          if (!secondaryPrefix.empty())
+          {
+            auto affinity = this->runner->entityCompMgr.Component<
+                components::PerformerAffinity>(_perfEntity);
+            if (nullptr == affinity || affinity->Data() != secondaryPrefix)
+            {
+              this->performerStates.erase(_perfEntity);
+              if (!_perfLevels->Data().empty())
+                *_perfLevels = components::PerformerLevels();
+              return true;
+            }
+          }
+
+          // Only look for intersections again if the performer moved far
+          // enough since it was last checked. Levels are static, so the
+          // result can't change otherwise.
+          const auto &position = pose->Data().Pos();
+          auto stateIt = this->performerStates.find(_perfEntity);
+          const bool stale = stateIt == this->performerStates.end() ||
+              stateIt->second.size != perfBox->Size() ||
+              stateIt->second.position.Distance(position) >
+              this->performerUpdateThreshold;
+
+          auto &state = this->performerStates[_perfEntity];
+          if (stale)
+          {
+            IGN_PROFILE("CheckPerformerAgainstLevels");
+            state.position = position;
+            state.size = perfBox->Size();
+            state.inside.clear();
+            state.inBuffer.clear();
+
+            math::AxisAlignedBox performerVolume{
+              position - perfBox->Size() / 2,
+              position + perfBox->Size() / 2};
+
+            this->LevelCandidates(performerVolume, candidates);
+            for (const auto &index : candidates)
+            {
+              const auto &level = this->levelRegions[index];
+              if (level.region.Intersects(performerVolume))
+                state.inside.push_back(level.entity);
+              else if (level.outerRegion.Intersects(performerVolume))
+                state.inBuffer.push_back(level.entity);
+            }
+          }
+
+          // Levels intersecting the performer are loaded, and active levels
+          // are kept until the performer leaves their buffer zone.
+          std::set<Entity> newPerfLevels(state.inside.begin(),
+              state.inside.end());
+          for (const auto &level : state.inBuffer)
+          {
+            if (this->IsLevelActive(level))
+              newPerfLevels.insert(level);
+          }
+          levelsToLoad.insert(levelsToLoad.end(), newPerfLevels.begin(),
+              newPerfLevels.end());
+
+          if (_perfLevels->Data() != newPerfLevels)
+            *_perfLevels = components::PerformerLevels(newPerfLevels);
+
+          if (this->preloadTime > 0.0)
+          {
+            this->PredictLevels(state, position, _parent->Data(),
+                newPerfLevels, candidates, levelsToPreload);
+          }
 
           return true;
           });
+
+    // Active levels which no performer is close to are unloaded.
+    if (hasPerformers)
+    {
+      std::set<Entity> levelsToKeep(levelsToLoad.begin(), levelsToLoad.end());
+      levelsToKeep.insert(levelsToPreload.begin(), levelsToPreload.end());
+      for (const auto &level : this->activeLevels)
+      {
+        if (level != this->defaultLevel &&
+            levelsToKeep.find(level) == levelsToKeep.end())
+        {
+          levelsToUnload.push_back(level);
+        }
+      }
+    }
   }
 
   // Sort levelsToLoad and levelsToUnload so as to run std::unique on them.
@@ -664,30 +884,19 @@ void LevelManager::UpdateLevelsState()
     levelsToUnload.erase(pendingEnd, levelsToUnload.end());
   }
 
-  // Make a list of entity names from all the levels that have been marked to be
-  // loaded
-  std::set<std::string> entityNamesMarked;
-  for (const auto &toLoad : levelsToLoad)
+  // Levels on the predicted path of performers which they don't need yet
+  std::sort(levelsToPreload.begin(), levelsToPreload.end());
   {
-    const components::LevelEntityNames *lvlEntNames =
-      this->runner->entityCompMgr.Component<components::LevelEntityNames>(
-          toLoad);
-    const auto &entityNames = lvlEntNames->Data();
-    for (const auto &name : entityNames)
-    {
-      entityNamesMarked.insert(name);
-    }
-  }
-
-  // Filter out currently active entities from the marked entities and create a
-  // new set of entities. These entities will be the ones that are loaded
-  std::set<std::string> entityNamesToLoad;
-  for (const auto &name : entityNamesMarked)
-  {
-    if (this->activeEntityNames.find(name) == this->activeEntityNames.end())
-    {
-      entityNamesToLoad.insert(name);
-    }
+    auto pendingEnd = std::unique(levelsToPreload.begin(),
+        levelsToPreload.end());
+    levelsToPreload.erase(pendingEnd, levelsToPreload.end());
+    pendingEnd = std::remove_if(levelsToPreload.begin(),
+        levelsToPreload.end(), [&](Entity _entity)
+        {
+          return std::binary_search(levelsToLoad.begin(), levelsToLoad.end(),
+              _entity);
+        });
+    levelsToPreload.erase(pendingEnd, levelsToPreload.end());
   }
 
   // First filter levelsToUnload so it doesn't contain any levels that are
@@ -695,37 +904,93 @@ void LevelManager::UpdateLevelsState()
   auto pendingRemove = std::remove_if(
       levelsToUnload.begin(), levelsToUnload.end(), [&](Entity _entity)
       {
-        return std::find(levelsToLoad.begin(), levelsToLoad.end(), _entity) !=
-               levelsToLoad.end();
+        return std::binary_search(levelsToLoad.begin(), levelsToLoad.end(),
+            _entity);
       });
   levelsToUnload.erase(pendingRemove, levelsToUnload.end());
 
-  // Make a list of entity names to unload making sure to leave out the ones
-  // that have been marked to be loaded above
-  std::set<std::string> entityNamesToUnload;
+  // Mark the elements of all the levels to be loaded, and collect the ones
+  // which aren't loaded or queued yet. Preloaded levels come last, so the
+  // levels performers are already in are created first.
+  std::vector<std::size_t> markedRefs;
+  std::vector<std::size_t> refsToLoad;
+  for (const auto *levels : {&levelsToLoad, &levelsToPreload})
+  {
+    for (const auto &toLoad : *levels)
+    {
+      auto members = this->levelMembers.find(toLoad);
+      if (members == this->levelMembers.end())
+        continue;
+
+      for (const auto &index : members->second)
+      {
+        auto &ref = this->levelRefs[index];
+        if (ref.marked)
+          continue;
+        ref.marked = true;
+        markedRefs.push_back(index);
+
+        if (ref.entity == kNullEntity && !ref.queued)
+          refsToLoad.push_back(index);
+      }
+    }
+  }
+
+  // Elements of the levels to unload which aren't part of any level that
+  // stays loaded. Marking them as well prevents duplicates.
+  std::vector<std::size_t> refsToUnload;
+  bool dequeued{false};
   for (const auto &toUnload : levelsToUnload)
   {
-    auto entityNames = this->runner->entityCompMgr
-                           .Component<components::LevelEntityNames>(toUnload)
-                           ->Data();
+    auto members = this->levelMembers.find(toUnload);
+    if (members == this->levelMembers.end())
+      continue;
 
-    for (const auto &name : entityNames)
+    for (const auto &index : members->second)
     {
-      if (entityNamesMarked.find(name) == entityNamesMarked.end())
+      auto &ref = this->levelRefs[index];
+      if (ref.marked)
+        continue;
+      ref.marked = true;
+      markedRefs.push_back(index);
+
+      if (ref.entity != kNullEntity)
+        refsToUnload.push_back(index);
+
+      // Drop queued elements which have been unloaded before they were
+      // created
+      if (ref.queued)
       {
-        entityNamesToUnload.insert(name);
+        ref.queued = false;
+        dequeued = true;
       }
     }
   }
 
-  // Load and unload the entities
-  if (entityNamesToLoad.size() > 0)
+  for (const auto &index : markedRefs)
+    this->levelRefs[index].marked = false;
+
+  if (dequeued)
+  {
+    auto queueEnd = std::remove_if(this->loadQueue.begin(),
+        this->loadQueue.end(), [&](std::size_t _index)
+        {
+          return !this->levelRefs[_index].queued;
+        });
+    this->loadQueue.erase(queueEnd, this->loadQueue.end());
+  }
+
+  for (const auto &index : refsToLoad)
   {
-    this->LoadActiveEntities(entityNamesToLoad);
+    this->levelRefs[index].queued = true;
+    this->loadQueue.push_back(index);
   }
-  if (entityNamesToUnload.size() > 0)
+
+  // Load and unload the entities
+  this->LoadQueuedEntities();
+  if (!refsToUnload.empty())
   {
-    this->UnloadInactiveEntities(entityNamesToUnload);
+    this->UnloadInactiveEntities(refsToUnload);
   }
 
   // Finally, upadte the list of active levels
@@ -737,6 +1002,14 @@ void LevelManager::UpdateLevelsState()
       this->activeLevels.push_back(level);
     }
   }
+  for (const auto &level : levelsToPreload)
+  {
+    if (!this->IsLevelActive(level))
+    {
+      ignmsg << "Preloaded level [" << level << "]" << std::endl;
+      this->activeLevels.push_back(level);
+    }
+  }
 
   auto pendingEnd = this->activeLevels.end();
   for (const auto &toUnload : levelsToUnload)
@@ -749,7 +1022,94 @@ void LevelManager::UpdateLevelsState()
 }
 
 /////////////////////////////////////////////////
-void LevelManager::LoadActiveEntities(const std::set<std::string> &_namesToLoad)
+void LevelManager::PredictLevels(PerformerState &_state,
+    const math::Vector3d &_position, const Entity _model,
+    const std::set<Entity> &_performerLevels,
+    std::vector<std::size_t> &_candidates,
+    std::vector<Entity> &_levelsToPreload)
+{
+  IGN_PROFILE("LevelManager::PredictLevels");
+
+  // Use the velocity of the model if some system computes it, otherwise
+  // estimate it from the distance covered since the last update. It's kept
+  // while paused.
+  const auto simTime = this->runner->currentInfo.simTime;
+  auto velocity = this->runner->entityCompMgr.Component<
+      components::WorldLinearVelocity>(_model);
+  if (nullptr != velocity)
+  {
+    _state.velocity = velocity->Data();
+  }
+  else if (_state.lastSimTime >= std::chrono::steady_clock::duration::zero() &&
+      simTime > _state.lastSimTime)
+  {
+    _state.velocity = (_position - _state.lastPosition) /
+        std::chrono::duration<double>(simTime - _state.lastSimTime).count();
+  }
+  else if (simTime < _state.lastSimTime)
+  {
+    // Time went back, don't guess
+    _state.velocity = math::Vector3d::Zero;
+  }
+  _state.lastPosition = _position;
+  _state.lastSimTime = simTime;
+
+  const auto displacement = _state.velocity * this->preloadTime;
+  if (displacement == math::Vector3d::Zero)
+    return;
+
+  // Volume swept by the performer over the preload time
+  math::Vector3d min = _position - _state.size / 2;
+  math::Vector3d max = _position + _state.size / 2;
+  for (int i = 0; i < 3; ++i)
+  {
+    if (displacement[i] < 0)
+      min[i] += displacement[i];
+    else
+      max[i] += displacement[i];
+  }
+  math::AxisAlignedBox sweptVolume{min, max};
+
+  this->LevelCandidates(sweptVolume, _candidates);
+  for (const auto &index : _candidates)
+  {
+    const auto &level = this->levelRegions[index];
+    if (_performerLevels.find(level.entity) == _performerLevels.end() &&
+        level.outerRegion.Intersects(sweptVolume))
+    {
+      _levelsToPreload.push_back(level.entity);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void LevelManager::LoadQueuedEntities()
+{
+  if (this->loadQueue.empty())
+    return;
+
+  IGN_PROFILE("LevelManager::LoadQueuedEntities");
+
+  // Everything is created at once on the first update, so the world starts
+  // complete
+  std::size_t count = this->loadQueue.size();
+  if (this->entitiesPerStep > 0 && !this->activeLevels.empty())
+    count = std::min<std::size_t>(count, this->entitiesPerStep);
+
+  std::vector<std::size_t> refsToLoad(this->loadQueue.begin(),
+      this->loadQueue.begin() + count);
+  this->loadQueue.erase(this->loadQueue.begin(),
+      this->loadQueue.begin() + count);
+
+  for (const auto &index : refsToLoad)
+    this->levelRefs[index].queued = false;
+
+  this->LoadActiveEntities(refsToLoad);
+}
+
+/////////////////////////////////////////////////
+void LevelManager::LoadActiveEntities(
+    const std::vector<std::size_t> &_refsToLoad)
 {
   IGN_PROFILE("LevelManager::LoadActiveEntities");
 
@@ -759,93 +1119,152 @@ void LevelManager::LoadActiveEntities(const std::set<std::string> &_namesToLoad)
     return;
   }
 
-  // Models
-  for (uint64_t modelIndex = 0;
-       modelIndex < this->runner->sdfWorld->ModelCount(); ++modelIndex)
+  const auto *world = this->runner->sdfWorld;
+
+  // Consecutive models are created together, so they can be converted in
+  // parallel while keeping the order of entity ids
+  std::vector<std::size_t> pendingModels;
+  auto createModels = [&]()
   {
-    // There is no sdf::World::ModelByName so we have to iterate by index and
-    // check if the model is in this level
-    auto model = this->runner->sdfWorld->ModelByIndex(modelIndex);
-    if (_namesToLoad.find(model->Name()) != _namesToLoad.end())
-    {
-      Entity modelEntity = this->entityCreator->CreateEntities(model);
+    if (pendingModels.empty())
+      return;
 
-      this->entityCreator->SetParent(modelEntity, this->worldEntity);
+    std::vector<const sdf::Model *> models;
+    models.reserve(pendingModels.size());
+    for (const auto &index : pendingModels)
+      models.push_back(world->ModelByIndex(this->levelRefs[index].index));
+
+    auto entities = this->entityCreator->CreateEntities(models);
+    for (std::size_t i = 0; i < pendingModels.size(); ++i)
+    {
+      auto &ref = this->levelRefs[pendingModels[i]];
+      ref.entity = entities[i];
+      this->entityCreator->SetParent(ref.entity, this->worldEntity);
     }
-  }
+    pendingModels.clear();
+  };
 
-  // Actors
-  for (uint64_t actorIndex = 0;
-       actorIndex < this->runner->sdfWorld->ActorCount(); ++actorIndex)
+  for (const auto &index : _refsToLoad)
   {
-    // There is no sdf::World::ActorByName so we have to iterate by index and
-    // check if the actor is in this level
-    auto actor = this->runner->sdfWorld->ActorByIndex(actorIndex);
-    if (_namesToLoad.find(actor->Name()) != _namesToLoad.end())
+    auto &ref = this->levelRefs[index];
+    if (ref.entity != kNullEntity)
+      continue;
+
+    // Entities in the dormant pool are restored from their state, the rest
+    // are created from SDF
+    if (this->RestoreDormantEntity(index))
+      continue;
+
+    if (ref.type == RefType::MODEL)
     {
-      Entity actorEntity = this->entityCreator->CreateEntities(actor);
+      pendingModels.push_back(index);
+      continue;
+    }
+    createModels();
 
-      this->entityCreator->SetParent(actorEntity, this->worldEntity);
+    switch (ref.type)
+    {
+      // Models are created in batches
+      case RefType::MODEL:
+        continue;
+      case RefType::ACTOR:
+        ref.entity = this->entityCreator->CreateEntities(
+            world->ActorByIndex(ref.index));
+        break;
+      case RefType::LIGHT:
+        ref.entity = this->entityCreator->CreateEntities(
+            world->LightByIndex(ref.index));
+        break;
     }
+
+    this->entityCreator->SetParent(ref.entity, this->worldEntity);
   }
+  createModels();
+}
 
-  // Lights
-  for (uint64_t lightIndex = 0;
-       lightIndex < this->runner->sdfWorld->LightCount(); ++lightIndex)
+/////////////////////////////////////////////////
+void LevelManager::UnloadInactiveEntities(
+    const std::vector<std::size_t> &_refsToUnload)
+{
+  IGN_PROFILE("LevelManager::UnloadInactiveEntities");
+
+  for (const auto &index : _refsToUnload)
   {
-    auto light = this->runner->sdfWorld->LightByIndex(lightIndex);
-    if (_namesToLoad.find(light->Name()) != _namesToLoad.end())
-    {
-      Entity lightEntity = this->entityCreator->CreateEntities(light);
+    this->RemoveLevelEntity(index);
+  }
+}
 
-      this->entityCreator->SetParent(lightEntity, this->worldEntity);
+/////////////////////////////////////////////////
+void LevelManager::RemoveLevelEntity(const std::size_t _ref)
+{
+  auto &ref = this->levelRefs[_ref];
+  const Entity entity = ref.entity;
+  ref.entity = kNullEntity;
+
+  // The entity may have been removed by someone else in the meantime
+  if (entity == kNullEntity || !this->runner->entityCompMgr.HasEntity(entity))
+    return;
+
+  if (this->dormantPoolSize > 0)
+  {
+    IGN_PROFILE("LevelManager::StoreDormantEntity");
+
+    DormantEntity dormant;
+    dormant.entity = entity;
+    this->runner->entityCompMgr.BinaryState(dormant.state,
+        this->runner->entityCompMgr.Descendants(entity), {}, true);
+
+    this->EvictDormantEntity(_ref);
+    this->dormantLru.push_front(_ref);
+    dormant.lru = this->dormantLru.begin();
+    this->dormantBytes += dormant.state.size();
+    this->dormantEntities[_ref] = std::move(dormant);
+
+    // Drop the least recently unloaded entities until the pool fits
+    while (this->dormantBytes > this->dormantPoolSize &&
+        !this->dormantLru.empty())
+    {
+      this->EvictDormantEntity(this->dormantLru.back());
     }
   }
 
-  this->activeEntityNames.insert(_namesToLoad.begin(), _namesToLoad.end());
+  this->entityCreator->RequestRemoveEntity(entity, true);
 }
 
 /////////////////////////////////////////////////
-void LevelManager::UnloadInactiveEntities(
-    const std::set<std::string> &_namesToUnload)
+bool LevelManager::RestoreDormantEntity(const std::size_t _ref)
 {
-  this->runner->entityCompMgr.Each<components::Model, components::Name>(
-      [&](const Entity &_entity, const components::Model *,
-          const components::Name *_name) -> bool
-      {
-        if (_namesToUnload.find(_name->Data()) != _namesToUnload.end())
-        {
-          this->entityCreator->RequestRemoveEntity(_entity, true);
-        }
-        return true;
-      });
+  auto it = this->dormantEntities.find(_ref);
+  if (it == this->dormantEntities.end())
+    return false;
 
-  this->runner->entityCompMgr.Each<components::Actor, components::Name>(
-      [&](const Entity &_entity, const components::Actor *,
-          const components::Name *_name) -> bool
-      {
-        if (_namesToUnload.find(_name->Data()) != _namesToUnload.end())
-        {
-          this->entityCreator->RequestRemoveEntity(_entity, true);
-        }
-        return true;
-      });
+  IGN_PROFILE("LevelManager::RestoreDormantEntity");
 
-  this->runner->entityCompMgr.Each<components::Light, components::Name>(
-      [&](const Entity &_entity, const components::Light *,
-          const components::Name *_name) -> bool
-      {
-        if (_namesToUnload.find(_name->Data()) != _namesToUnload.end())
-        {
-          this->entityCreator->RequestRemoveEntity(_entity, true);
-        }
-        return true;
-      });
-
-  for (const auto &name : _namesToUnload)
+  // Entities are restored with their original IDs, which are never handed
+  // out again, so references between entities stay valid
+  const auto &state = it->second.state;
+  if (!this->runner->entityCompMgr.SetBinaryState(state.data(),
+      state.size()))
   {
-    this->activeEntityNames.erase(name);
+    ignerr << "Failed to restore entity [" << this->levelRefs[_ref].name
+           << "] from the dormant pool." << std::endl;
   }
+  this->levelRefs[_ref].entity = it->second.entity;
+
+  this->EvictDormantEntity(_ref);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void LevelManager::EvictDormantEntity(const std::size_t _ref)
+{
+  auto it = this->dormantEntities.find(_ref);
+  if (it == this->dormantEntities.end())
+    return;
+
+  this->dormantBytes -= it->second.state.size();
+  this->dormantLru.erase(it->second.lru);
+  this->dormantEntities.erase(it);
 }
 
 /////////////////////////////////////////////////
@@ -21,6 +21,9 @@
 #include <ignition/msgs/boolean.pb.h>
 #include <ignition/msgs/stringmsg.pb.h>
 
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <list>
 #include <memory>
 #include <set>
@@ -31,6 +34,8 @@
 
 #include <sdf/Element.hh>
 #include <sdf/Geometry.hh>
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Vector3.hh>
 #include <ignition/transport/Node.hh>
 
 #include "ignition/gazebo/config.hh"
@@ -89,19 +94,45 @@ namespace ignition
       public: void UpdateLevelsState();
 
       /// \brief Load entities that have been marked for loading.
-      /// \param[in] _namesToLoad List of of entity names to load
+      /// \param[in] _refsToLoad Indices into levelRefs of the entities to
+      /// load.
       private: void LoadActiveEntities(
-          const std::set<std::string> &_namesToLoad);
+          const std::vector<std::size_t> &_refsToLoad);
+
+      /// \brief Create entities waiting in loadQueue. After the initial
+      /// load, at most entitiesPerStep entities are created per call, so the
+      /// cost of entering a level is spread over several iterations.
+      private: void LoadQueuedEntities();
 
       /// \brief Unload entities that have been marked for unloading.
-      /// \param[in] _namesToUnload List of entity names to unload
+      /// \param[in] _refsToUnload Indices into levelRefs of the entities to
+      /// unload.
       private: void UnloadInactiveEntities(
-          const std::set<std::string> &_namesToUnload);
+          const std::vector<std::size_t> &_refsToUnload);
+
+      /// \brief Request an unloaded entity to be removed. If the dormant
+      /// pool is enabled, the state of the entity and its descendants is
+      /// stored first, so it can be restored without going through SDF.
+      /// \param[in] _ref Index into levelRefs of the entity to remove.
+      private: void RemoveLevelEntity(const std::size_t _ref);
+
+      /// \brief Restore an entity from the dormant pool.
+      /// \param[in] _ref Index into levelRefs of the entity.
+      /// \return True if the entity was in the pool and has been restored.
+      private: bool RestoreDormantEntity(const std::size_t _ref);
+
+      /// \brief Drop an entity from the dormant pool, if it's there.
+      /// \param[in] _ref Index into levelRefs of the entity.
+      private: void EvictDormantEntity(const std::size_t _ref);
 
       /// \brief Read level and performer information from the sdf::World
       /// object
       private: void ReadLevelPerformerInfo();
 
+      /// \brief Fill levelRefs with the top level models, actors and lights
+      /// of the SDF world, which are the entities levels can refer to.
+      private: void IndexLevelRefs();
+
       /// \brief Create performers
       /// Assuming that a simulation runner is performer-centered
       private: void CreatePerformers();
@@ -116,6 +147,17 @@ namespace ignition
       /// \param[in] _sdf sdf::ElementPtr of the ignition::gazebo plugin tag
       private: void ReadLevels(const sdf::ElementPtr &_sdf);
 
+      /// \brief Build the spatial grid used to find the levels close to a
+      /// performer. Called once all levels have been read.
+      private: void BuildLevelGrid();
+
+      /// \brief Get the levels whose buffer zone may intersect a volume.
+      /// \param[in] _box Volume to check, usually a performer's.
+      /// \param[out] _candidates Indices into levelRegions, sorted and
+      /// without duplicates.
+      private: void LevelCandidates(const math::AxisAlignedBox &_box,
+                   std::vector<std::size_t> &_candidates) const;
+
       /// \brief Determine which entities belong to the default level and
       /// schedule them to be loaded
       private: void ConfigureDefaultLevel();
@@ -145,11 +187,185 @@ namespace ignition
       private: int CreatePerformerEntity(const std::string &_name,
                    const sdf::Geometry &_geom);
 
+      /// \brief Type of the SDF element a level refers to.
+      private: enum class RefType
+      {
+        /// \brief sdf::Model
+        MODEL,
+
+        /// \brief sdf::Actor
+        ACTOR,
+
+        /// \brief sdf::Light
+        LIGHT
+      };
+
+      /// \brief Top level element of the SDF world which can be part of a
+      /// level, and the entity created for it.
+      private: struct LevelRef
+      {
+        /// \brief Type of the element.
+        RefType type{RefType::MODEL};
+
+        /// \brief Index of the element in the sdf::World.
+        uint64_t index{0};
+
+        /// \brief Name of the element.
+        std::string name;
+
+        /// \brief Entity created for the element, or kNullEntity if it's not
+        /// loaded.
+        Entity entity{kNullEntity};
+
+        /// \brief Whether the element is waiting in loadQueue.
+        bool queued{false};
+
+        /// \brief Scratch flag used while computing which elements to load
+        /// and unload.
+        bool marked{false};
+      };
+
+      /// \brief State of an unloaded entity kept in the dormant pool.
+      private: struct DormantEntity
+      {
+        /// \brief Binary state of the entity and its descendants, see
+        /// EntityComponentManager::BinaryState.
+        std::string state;
+
+        /// \brief Entity that was removed.
+        Entity entity{kNullEntity};
+
+        /// \brief Position of the entity in dormantLru.
+        std::list<std::size_t>::iterator lru;
+      };
+
+      /// \brief Volumes of a level, cached when the level is read.
+      private: struct LevelRegion
+      {
+        /// \brief Level entity.
+        Entity entity{kNullEntity};
+
+        /// \brief Volume of the level.
+        math::AxisAlignedBox region;
+
+        /// \brief Volume of the level inflated by its buffer.
+        math::AxisAlignedBox outerRegion;
+      };
+
+      /// \brief Result of the last intersection check of a performer.
+      private: struct PerformerState
+      {
+        /// \brief Position of the performer when it was last checked.
+        math::Vector3d position;
+
+        /// \brief Size of the performer's box when it was last checked.
+        math::Vector3d size;
+
+        /// \brief Levels whose volume intersects the performer.
+        std::vector<Entity> inside;
+
+        /// \brief Levels whose buffer zone, but not volume, intersects the
+        /// performer.
+        std::vector<Entity> inBuffer;
+
+        /// \brief Position of the performer on the last update, used to
+        /// estimate its velocity.
+        math::Vector3d lastPosition;
+
+        /// \brief Sim time of the last update, negative before the first.
+        std::chrono::steady_clock::duration lastSimTime{-1};
+
+        /// \brief Last known velocity of the performer.
+        math::Vector3d velocity;
+      };
+
+      /// \brief Find the levels a performer will reach within preloadTime
+      /// if it keeps its velocity, so they can be loaded before the
+      /// performer enters their buffer zone.
+      /// \param[in, out] _state State of the performer, whose velocity is
+      /// updated.
+      /// \param[in] _position Current position of the performer.
+      /// \param[in] _model Model the performer belongs to.
+      /// \param[in] _performerLevels Levels the performer already needs.
+      /// \param[out] _candidates Scratch vector for LevelCandidates.
+      /// \param[out] _levelsToPreload The levels found are appended to it.
+      private: void PredictLevels(PerformerState &_state,
+                   const math::Vector3d &_position, const Entity _model,
+                   const std::set<Entity> &_performerLevels,
+                   std::vector<std::size_t> &_candidates,
+                   std::vector<Entity> &_levelsToPreload);
+
       /// \brief List of currently active levels
       private: std::vector<Entity> activeLevels;
 
-      /// \brief Names of entities that are currently active (loaded).
-      private: std::set<std::string> activeEntityNames;
+      /// \brief Entity of the default level.
+      private: Entity defaultLevel{kNullEntity};
+
+      /// \brief Volumes of all levels, except the default level.
+      private: std::vector<LevelRegion> levelRegions;
+
+      /// \brief Uniform grid over the XY plane. Maps a cell key to the
+      /// indices in levelRegions of the levels whose buffer zone overlaps
+      /// that cell.
+      private: std::unordered_map<uint64_t, std::vector<std::size_t>>
+          levelGrid;
+
+      /// \brief Levels which span too many cells to be stored in levelGrid.
+      /// These are checked against every performer.
+      private: std::vector<std::size_t> largeLevels;
+
+      /// \brief Size of a levelGrid cell, in meters.
+      private: double gridCellSize{0.0};
+
+      /// \brief Last intersection check of each performer.
+      private: std::unordered_map<Entity, PerformerState> performerStates;
+
+      /// \brief Distance a performer must move, in meters, before its
+      /// levels are computed again.
+      private: double performerUpdateThreshold{0.0};
+
+      /// \brief All elements of the SDF world levels can refer to. Levels
+      /// refer to these by index, so loading and unloading don't need any
+      /// name lookups.
+      private: std::vector<LevelRef> levelRefs;
+
+      /// \brief Indices into levelRefs of the elements with a given name.
+      /// Only used while levels are read.
+      private: std::unordered_map<std::string, std::vector<std::size_t>>
+          levelRefsByName;
+
+      /// \brief Indices into levelRefs of the elements of each level,
+      /// including the default level.
+      private: std::unordered_map<Entity, std::vector<std::size_t>>
+          levelMembers;
+
+      /// \brief Indices into levelRefs of elements marked to be loaded which
+      /// haven't been created yet, in the order they were marked.
+      private: std::deque<std::size_t> loadQueue;
+
+      /// \brief Unloaded entities which can be restored from their state,
+      /// keyed by index into levelRefs.
+      private: std::unordered_map<std::size_t, DormantEntity>
+          dormantEntities;
+
+      /// \brief Keys of dormantEntities, most recently unloaded first.
+      private: std::list<std::size_t> dormantLru;
+
+      /// \brief Total size of the states in dormantEntities, in bytes.
+      private: std::size_t dormantBytes{0};
+
+      /// \brief Maximum total size of the dormant pool, in bytes. Zero
+      /// disables the pool.
+      private: std::size_t dormantPoolSize{0};
+
+      /// \brief Maximum number of top level entities to create per
+      /// iteration when levels are loaded. Zero means no limit.
+      private: unsigned int entitiesPerStep{0};
+
+      /// \brief Levels a performer would reach within this many seconds at
+      /// its current velocity are loaded ahead of time. Zero disables
+      /// preloading.
+      private: double preloadTime{0.0};
 
       /// \brief Pointer to the simulation runner associated with the level
       /// manager.
@@ -158,9 +374,6 @@ namespace ignition
       /// \brief Map of names of references to the containing performer
       private: std::unordered_map<std::string, Entity> performerMap;
 
-      /// \brief Names of all entities that have assigned levels
-      private: std::set<std::string> entityNamesInLevels;
-
       /// \brief Entity of the world.
       private: Entity worldEntity{kNullEntity};
 
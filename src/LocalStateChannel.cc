@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/LocalStateChannel.hh"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Number of states which may wait for the consumer. Past it, the
+/// consumer is sent a full state instead.
+static const std::size_t kMaxPendingStates{1000};
+
+/// \brief Mutex to protect gChannels.
+static std::mutex gChannelsMutex;
+
+/// \brief Channels by world name.
+static std::unordered_map<std::string, std::weak_ptr<LocalStateChannel>>
+    gChannels;
+
+class ignition::gazebo::LocalStateChannelPrivate
+{
+  /// \brief Whether a consumer is attached.
+  public: std::atomic<bool> attached{false};
+
+  /// \brief Whether the next published state must be full.
+  public: std::atomic<bool> fullStateRequested{false};
+
+  /// \brief Mutex to protect the pending states.
+  public: std::mutex mutex;
+
+  /// \brief States published since the consumer last took them.
+  public: std::vector<std::string> states;
+
+  /// \brief Whether the first pending state is full.
+  public: bool full{false};
+
+  /// \brief Info of the latest state.
+  public: UpdateInfo info;
+};
+
+//////////////////////////////////////////////////
+LocalStateChannel::LocalStateChannel()
+  : dataPtr(new LocalStateChannelPrivate)
+{
+}
+
+//////////////////////////////////////////////////
+LocalStateChannel::~LocalStateChannel() = default;
+
+//////////////////////////////////////////////////
+std::shared_ptr<LocalStateChannel> LocalStateChannel::Create(
+    const std::string &_worldName)
+{
+  std::lock_guard<std::mutex> lock(gChannelsMutex);
+  auto &channel = gChannels[_worldName];
+  if (!channel.expired())
+    return nullptr;
+
+  auto result = std::make_shared<LocalStateChannel>();
+  channel = result;
+  return result;
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<LocalStateChannel> LocalStateChannel::Find(
+    const std::string &_worldName)
+{
+  std::lock_guard<std::mutex> lock(gChannelsMutex);
+  auto iter = gChannels.find(_worldName);
+  if (iter == gChannels.end())
+    return nullptr;
+
+  auto result = iter->second.lock();
+  if (nullptr == result)
+    gChannels.erase(iter);
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool LocalStateChannel::Attach()
+{
+  if (this->dataPtr->attached.exchange(true))
+    return false;
+
+  this->dataPtr->fullStateRequested = true;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void LocalStateChannel::Detach()
+{
+  this->dataPtr->attached = false;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->states.clear();
+  this->dataPtr->full = false;
+}
+
+//////////////////////////////////////////////////
+bool LocalStateChannel::Attached() const
+{
+  return this->dataPtr->attached;
+}
+
+//////////////////////////////////////////////////
+void LocalStateChannel::RequestFullState()
+{
+  this->dataPtr->fullStateRequested = true;
+}
+
+//////////////////////////////////////////////////
+bool LocalStateChannel::TakeFullStateRequest()
+{
+  return this->dataPtr->fullStateRequested.exchange(false);
+}
+
+//////////////////////////////////////////////////
+void LocalStateChannel::Publish(std::string &&_state, bool _full,
+    const UpdateInfo &_info)
+{
+  if (!this->dataPtr->attached)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  // A full state makes the previous ones useless
+  if (_full)
+  {
+    this->dataPtr->states.clear();
+    this->dataPtr->full = true;
+  }
+  else if (this->dataPtr->states.size() >= kMaxPendingStates)
+  {
+    this->dataPtr->states.clear();
+    this->dataPtr->full = false;
+    this->dataPtr->fullStateRequested = true;
+    return;
+  }
+
+  this->dataPtr->states.push_back(std::move(_state));
+  this->dataPtr->info = _info;
+}
+
+//////////////////////////////////////////////////
+bool LocalStateChannel::Take(std::vector<std::string> &_states, bool &_full,
+    UpdateInfo &_info)
+{
+  _states.clear();
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (this->dataPtr->states.empty())
+    return false;
+
+  std::swap(_states, this->dataPtr->states);
+  _full = this->dataPtr->full;
+  _info = this->dataPtr->info;
+  this->dataPtr->full = false;
+  return true;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "ignition/gazebo/LocalStateChannel.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(LocalStateChannelTest, Registry)
+{
+  EXPECT_EQ(nullptr, LocalStateChannel::Find("registry"));
+
+  auto channel = LocalStateChannel::Create("registry");
+  ASSERT_NE(nullptr, channel);
+  EXPECT_EQ(channel, LocalStateChannel::Find("registry"));
+  EXPECT_EQ(nullptr, LocalStateChannel::Create("registry"));
+  EXPECT_EQ(nullptr, LocalStateChannel::Find("other"));
+
+  // The name is free again once the channel is gone
+  channel.reset();
+  EXPECT_EQ(nullptr, LocalStateChannel::Find("registry"));
+  EXPECT_NE(nullptr, LocalStateChannel::Create("registry"));
+}
+
+/////////////////////////////////////////////////
+TEST(LocalStateChannelTest, PublishAndTake)
+{
+  LocalStateChannel channel;
+  UpdateInfo info;
+  info.iterations = 1;
+
+  // Nothing is kept without a consumer
+  EXPECT_FALSE(channel.Attached());
+  channel.Publish("ignored", false, info);
+
+  std::vector<std::string> states;
+  bool full{false};
+  UpdateInfo taken;
+  EXPECT_FALSE(channel.Take(states, full, taken));
+
+  // Attaching requests a full state, once
+  EXPECT_TRUE(channel.Attach());
+  EXPECT_FALSE(channel.Attach());
+  EXPECT_TRUE(channel.Attached());
+  EXPECT_TRUE(channel.TakeFullStateRequest());
+  EXPECT_FALSE(channel.TakeFullStateRequest());
+
+  channel.Publish("a", false, info);
+  info.iterations = 2;
+  channel.Publish("full", true, info);
+  info.iterations = 3;
+  channel.Publish("b", false, info);
+
+  // States before the full one are dropped
+  ASSERT_TRUE(channel.Take(states, full, taken));
+  EXPECT_EQ(std::vector<std::string>({"full", "b"}), states);
+  EXPECT_TRUE(full);
+  EXPECT_EQ(3u, taken.iterations);
+  EXPECT_FALSE(channel.Take(states, full, taken));
+
+  channel.Publish("c", false, info);
+  ASSERT_TRUE(channel.Take(states, full, taken));
+  EXPECT_EQ(std::vector<std::string>({"c"}), states);
+  EXPECT_FALSE(full);
+
+  channel.RequestFullState();
+  EXPECT_TRUE(channel.TakeFullStateRequest());
+
+  channel.Detach();
+  EXPECT_FALSE(channel.Attached());
+  channel.Publish("d", false, info);
+  EXPECT_FALSE(channel.Take(states, full, taken));
+}
+
+/////////////////////////////////////////////////
+TEST(LocalStateChannelTest, SlowConsumer)
+{
+  LocalStateChannel channel;
+  ASSERT_TRUE(channel.Attach());
+  EXPECT_TRUE(channel.TakeFullStateRequest());
+
+  UpdateInfo info;
+  channel.Publish("full", true, info);
+
+  // A consumer which falls behind is sent a full state instead
+  for (int i = 0; i < 2000 && !channel.TakeFullStateRequest(); ++i)
+    channel.Publish("delta", false, info);
+
+  std::vector<std::string> states;
+  bool full{false};
+  UpdateInfo taken;
+  EXPECT_FALSE(channel.Take(states, full, taken));
+
+  channel.Publish("full", true, info);
+  ASSERT_TRUE(channel.Take(states, full, taken));
+  EXPECT_EQ(1u, states.size());
+  EXPECT_TRUE(full);
+}
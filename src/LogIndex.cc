@@ -0,0 +1,559 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <ignition/msgs/pose_v.pb.h>
+#include <ignition/msgs/serialized.pb.h>
+#include <ignition/msgs/serialized_map.pb.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/transport/log/Descriptor.hh>
+#include <ignition/transport/log/Log.hh>
+#include <ignition/transport/log/Message.hh>
+
+#include "ignition/gazebo/LogIndex.hh"
+
+#include "systems/log/StateCompression.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Identifies index files. Read with the wrong byte order, it
+/// doesn't match.
+static const uint32_t kMagic{0x58444E49};
+
+/// \brief Version of the layout.
+static const uint16_t kVersion{1};
+
+/// \brief Upper bound on the number of buckets, which bounds the size of
+/// the index to 16 MiB of buckets.
+static const uint64_t kMaxBuckets{1u << 20};
+
+/// \brief Start of an index file.
+struct LogIndexHeader
+{
+  /// \brief Magic number.
+  uint32_t magic;
+
+  /// \brief Format version.
+  uint16_t version;
+
+  /// \brief Reserved, zero.
+  uint16_t reserved;
+
+  /// \brief Start time in nanoseconds.
+  int64_t startTime;
+
+  /// \brief End time in nanoseconds.
+  int64_t endTime;
+
+  /// \brief Bucket duration in nanoseconds.
+  int64_t bucketDuration;
+
+  /// \brief Number of buckets.
+  uint64_t bucketCount;
+
+  /// \brief Number of keyframes.
+  uint64_t keyframeCount;
+
+  /// \brief Number of entities.
+  uint64_t entityCount;
+};
+
+static_assert(sizeof(LogIndexHeader) == 56, "Unexpected index header size");
+static_assert(sizeof(LogIndexBucket) == 16, "Unexpected index bucket size");
+static_assert(sizeof(LogIndexEntity) == 32, "Unexpected index entity size");
+
+/// \brief Private data class for LogIndex
+class ignition::gazebo::LogIndexPrivate
+{
+  /// \brief Unmap the index.
+  public: void Close();
+
+  /// \brief Start of the index.
+  public: const char *data{nullptr};
+
+  /// \brief Size of the index in bytes.
+  public: std::size_t size{0};
+
+  /// \brief True if data is a memory mapping, false if it's the buffer.
+  public: bool mapped{false};
+
+  /// \brief Index contents, where files can't be mapped.
+  public: std::vector<int64_t> buffer;
+
+  /// \brief Header of the index.
+  public: const LogIndexHeader *header{nullptr};
+
+  /// \brief Buckets of the index.
+  public: const LogIndexBucket *buckets{nullptr};
+
+  /// \brief Keyframe times of the index.
+  public: const int64_t *keyframes{nullptr};
+
+  /// \brief Entities of the index.
+  public: const LogIndexEntity *entities{nullptr};
+};
+
+/////////////////////////////////////////////////
+/// \brief Convert a duration to nanoseconds.
+/// \param[in] _time Duration.
+/// \return Nanoseconds.
+static int64_t ToNs(const std::chrono::steady_clock::duration &_time)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(_time).count();
+}
+
+/////////////////////////////////////////////////
+/// \brief Convert nanoseconds to a duration.
+/// \param[in] _ns Nanoseconds.
+/// \return Duration.
+static std::chrono::steady_clock::duration FromNs(int64_t _ns)
+{
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::nanoseconds(_ns));
+}
+
+/////////////////////////////////////////////////
+void LogIndexPrivate::Close()
+{
+#ifndef _WIN32
+  if (this->mapped && nullptr != this->data)
+    munmap(const_cast<char *>(this->data), this->size);
+#endif
+  this->data = nullptr;
+  this->size = 0;
+  this->mapped = false;
+  this->buffer.clear();
+  this->header = nullptr;
+  this->buckets = nullptr;
+  this->keyframes = nullptr;
+  this->entities = nullptr;
+}
+
+/////////////////////////////////////////////////
+LogIndex::LogIndex()
+  : dataPtr(std::make_unique<LogIndexPrivate>())
+{
+}
+
+/////////////////////////////////////////////////
+LogIndex::~LogIndex()
+{
+  this->dataPtr->Close();
+}
+
+/////////////////////////////////////////////////
+bool LogIndex::Build(const std::string &_logPath,
+    const std::string &_indexPath,
+    const std::chrono::steady_clock::duration &_bucketDuration)
+{
+  IGN_PROFILE("LogIndex::Build");
+  if (_bucketDuration <= std::chrono::steady_clock::duration::zero())
+  {
+    ignerr << "Log index bucket duration must be positive." << std::endl;
+    return false;
+  }
+
+  auto dbPath = _logPath;
+  if (common::isDirectory(dbPath))
+    dbPath = common::joinPaths(dbPath, "state.tlog");
+
+  transport::log::Log log;
+  if (!log.Open(dbPath))
+  {
+    ignerr << "Failed to open log file [" << dbPath << "]" << std::endl;
+    return false;
+  }
+
+  // Keyframes only mark seek positions, they're not activity
+  std::string keyframeTopic;
+  const std::string keyframeSuffix{"/changed_state_keyframe"};
+  for (const auto &topic : log.Descriptor()->TopicsToMsgTypesToId())
+  {
+    if (topic.first.size() > keyframeSuffix.size() &&
+        topic.first.compare(topic.first.size() - keyframeSuffix.size(),
+        keyframeSuffix.size(), keyframeSuffix) == 0)
+    {
+      keyframeTopic = topic.first;
+      break;
+    }
+  }
+
+  LogIndexHeader header{};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.startTime = ToNs(log.StartTime());
+  header.endTime = std::max(header.startTime, ToNs(log.EndTime()));
+  header.bucketDuration = ToNs(_bucketDuration);
+  const int64_t span = header.endTime - header.startTime;
+  if (static_cast<uint64_t>(span / header.bucketDuration) >= kMaxBuckets)
+    header.bucketDuration = span / (kMaxBuckets - 1) + 1;
+  header.bucketCount = span / header.bucketDuration + 1;
+
+  std::vector<LogIndexBucket> buckets(header.bucketCount,
+      LogIndexBucket{0, 0, -1});
+  std::vector<int64_t> keyframes;
+  std::map<uint64_t, LogIndexEntity> entities;
+
+  std::string type;
+  std::string buffer;
+  for (const auto &msg : log.QueryMessages())
+  {
+    const int64_t time = std::clamp(ToNs(msg.TimeReceived()),
+        header.startTime, header.endTime);
+    if (msg.Topic() == keyframeTopic)
+    {
+      keyframes.push_back(time);
+      continue;
+    }
+
+    type = msg.Type();
+    const std::string *data = &msg.Data();
+    if (systems::log_system::IsCompressedType(type))
+    {
+      type.resize(type.size() -
+          systems::log_system::kCompressedTypeSuffix.size());
+      if (!systems::log_system::DecompressData(msg.Data(), buffer))
+        continue;
+      data = &buffer;
+    }
+
+    auto &bucket = buckets[(time - header.startTime) / header.bucketDuration];
+    auto addEntity = [&](uint64_t _entity)
+    {
+      auto it = entities.find(_entity);
+      if (it == entities.end())
+      {
+        it = entities.insert({_entity,
+            LogIndexEntity{_entity, time, time, 0}}).first;
+      }
+      it->second.lastTime = time;
+      ++it->second.messages;
+      ++bucket.entities;
+    };
+
+    if (type == "ignition.msgs.SerializedStateMap")
+    {
+      msgs::SerializedStateMap stateMsg;
+      if (!stateMsg.ParseFromString(*data))
+        continue;
+      ++bucket.messages;
+      for (const auto &entity : stateMsg.entities())
+        addEntity(entity.second.id());
+    }
+    else if (type == "ignition.msgs.SerializedState")
+    {
+      msgs::SerializedState stateMsg;
+      if (!stateMsg.ParseFromString(*data))
+        continue;
+      ++bucket.messages;
+      for (const auto &entity : stateMsg.entities())
+        addEntity(entity.id());
+    }
+    else if (type == "ignition.msgs.Pose_V")
+    {
+      msgs::Pose_V poseMsg;
+      if (!poseMsg.ParseFromString(*data))
+        continue;
+      ++bucket.messages;
+      for (const auto &pose : poseMsg.pose())
+        addEntity(pose.id());
+    }
+  }
+
+  // Latest keyframe at or before the start of each bucket
+  std::sort(keyframes.begin(), keyframes.end());
+  int64_t keyframe{-1};
+  for (uint64_t i = 0; i < header.bucketCount; ++i)
+  {
+    const int64_t bucketStart =
+        header.startTime + static_cast<int64_t>(i) * header.bucketDuration;
+    while (keyframe + 1 < static_cast<int64_t>(keyframes.size()) &&
+        keyframes[keyframe + 1] <= bucketStart)
+    {
+      ++keyframe;
+    }
+    buckets[i].keyframe = keyframe;
+  }
+
+  header.keyframeCount = keyframes.size();
+  header.entityCount = entities.size();
+
+  // Write next to the index and then replace it, so readers never see a
+  // partially written index
+  const std::string tmpPath = _indexPath + ".tmp";
+  {
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(buckets.data()),
+        buckets.size() * sizeof(LogIndexBucket));
+    out.write(reinterpret_cast<const char *>(keyframes.data()),
+        keyframes.size() * sizeof(int64_t));
+    for (const auto &entity : entities)
+    {
+      out.write(reinterpret_cast<const char *>(&entity.second),
+          sizeof(LogIndexEntity));
+    }
+    if (!out)
+    {
+      ignerr << "Failed to write log index [" << tmpPath << "]" << std::endl;
+      out.close();
+      common::removeFile(tmpPath);
+      return false;
+    }
+  }
+
+  if (!common::moveFile(tmpPath, _indexPath))
+  {
+    ignerr << "Failed to move log index to [" << _indexPath << "]"
+           << std::endl;
+    common::removeFile(tmpPath);
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogIndex::Open(const std::string &_indexPath)
+{
+  this->dataPtr->Close();
+
+#ifndef _WIN32
+  int fd = open(_indexPath.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+      static_cast<std::size_t>(info.st_size) < sizeof(LogIndexHeader))
+  {
+    close(fd);
+    return false;
+  }
+
+  void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (MAP_FAILED == mapping)
+  {
+    ignerr << "Failed to map log index [" << _indexPath << "]" << std::endl;
+    return false;
+  }
+  this->dataPtr->data = static_cast<const char *>(mapping);
+  this->dataPtr->size = info.st_size;
+  this->dataPtr->mapped = true;
+#else
+  std::ifstream in(_indexPath, std::ios::binary | std::ios::ate);
+  if (!in)
+    return false;
+  const std::size_t size = in.tellg();
+  if (size < sizeof(LogIndexHeader))
+    return false;
+
+  // Read into int64 storage, which is aligned for all index records
+  this->dataPtr->buffer.resize((size + sizeof(int64_t) - 1) /
+      sizeof(int64_t));
+  in.seekg(0);
+  in.read(reinterpret_cast<char *>(this->dataPtr->buffer.data()), size);
+  if (!in)
+  {
+    this->dataPtr->Close();
+    return false;
+  }
+  this->dataPtr->data =
+      reinterpret_cast<const char *>(this->dataPtr->buffer.data());
+  this->dataPtr->size = size;
+#endif
+
+  const auto *header =
+      reinterpret_cast<const LogIndexHeader *>(this->dataPtr->data);
+  if (header->magic != kMagic || header->version != kVersion ||
+      header->bucketDuration <= 0 || header->bucketCount == 0 ||
+      header->bucketCount > kMaxBuckets ||
+      header->endTime < header->startTime)
+  {
+    ignerr << "Invalid log index [" << _indexPath << "]" << std::endl;
+    this->dataPtr->Close();
+    return false;
+  }
+
+  const uint64_t expectedSize = sizeof(LogIndexHeader) +
+      header->bucketCount * sizeof(LogIndexBucket) +
+      header->keyframeCount * sizeof(int64_t) +
+      header->entityCount * sizeof(LogIndexEntity);
+  if (header->keyframeCount > this->dataPtr->size ||
+      header->entityCount > this->dataPtr->size ||
+      expectedSize != this->dataPtr->size)
+  {
+    ignerr << "Truncated log index [" << _indexPath << "]" << std::endl;
+    this->dataPtr->Close();
+    return false;
+  }
+
+  const char *pos = this->dataPtr->data + sizeof(LogIndexHeader);
+  this->dataPtr->header = header;
+  this->dataPtr->buckets = reinterpret_cast<const LogIndexBucket *>(pos);
+  pos += header->bucketCount * sizeof(LogIndexBucket);
+  this->dataPtr->keyframes = reinterpret_cast<const int64_t *>(pos);
+  pos += header->keyframeCount * sizeof(int64_t);
+  this->dataPtr->entities = reinterpret_cast<const LogIndexEntity *>(pos);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogIndex::Valid() const
+{
+  return nullptr != this->dataPtr->header;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration LogIndex::StartTime() const
+{
+  if (!this->Valid())
+    return std::chrono::steady_clock::duration::zero();
+  return FromNs(this->dataPtr->header->startTime);
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration LogIndex::EndTime() const
+{
+  if (!this->Valid())
+    return std::chrono::steady_clock::duration::zero();
+  return FromNs(this->dataPtr->header->endTime);
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration LogIndex::BucketDuration() const
+{
+  if (!this->Valid())
+    return std::chrono::steady_clock::duration::zero();
+  return FromNs(this->dataPtr->header->bucketDuration);
+}
+
+/////////////////////////////////////////////////
+std::size_t LogIndex::BucketCount() const
+{
+  if (!this->Valid())
+    return 0u;
+  return this->dataPtr->header->bucketCount;
+}
+
+/////////////////////////////////////////////////
+const LogIndexBucket *LogIndex::Buckets() const
+{
+  return this->dataPtr->buckets;
+}
+
+/////////////////////////////////////////////////
+std::size_t LogIndex::BucketIndex(
+    const std::chrono::steady_clock::duration &_time) const
+{
+  if (!this->Valid())
+    return 0u;
+
+  const auto *header = this->dataPtr->header;
+  const int64_t time =
+      std::clamp(ToNs(_time), header->startTime, header->endTime);
+  return std::min<uint64_t>(
+      (time - header->startTime) / header->bucketDuration,
+      header->bucketCount - 1);
+}
+
+/////////////////////////////////////////////////
+std::size_t LogIndex::KeyframeCount() const
+{
+  if (!this->Valid())
+    return 0u;
+  return this->dataPtr->header->keyframeCount;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration LogIndex::KeyframeTime(
+    std::size_t _index) const
+{
+  if (_index >= this->KeyframeCount())
+    return std::chrono::steady_clock::duration::zero();
+  return FromNs(this->dataPtr->keyframes[_index]);
+}
+
+/////////////////////////////////////////////////
+std::optional<std::chrono::steady_clock::duration> LogIndex::KeyframeBefore(
+    const std::chrono::steady_clock::duration &_time) const
+{
+  if (!this->Valid())
+    return std::nullopt;
+
+  // Start from the bucket's keyframe and check the few recorded within the
+  // bucket
+  const int64_t time = ToNs(_time);
+  const auto count = static_cast<int64_t>(this->KeyframeCount());
+  int64_t keyframe = this->dataPtr->buckets[this->BucketIndex(_time)].keyframe;
+  while (keyframe >= 0 && this->dataPtr->keyframes[keyframe] > time)
+    --keyframe;
+  while (keyframe + 1 < count && this->dataPtr->keyframes[keyframe + 1] <= time)
+    ++keyframe;
+
+  if (keyframe < 0)
+    return std::nullopt;
+  return FromNs(this->dataPtr->keyframes[keyframe]);
+}
+
+/////////////////////////////////////////////////
+std::size_t LogIndex::EntityCount() const
+{
+  if (!this->Valid())
+    return 0u;
+  return this->dataPtr->header->entityCount;
+}
+
+/////////////////////////////////////////////////
+const LogIndexEntity *LogIndex::Entities() const
+{
+  return this->dataPtr->entities;
+}
+
+/////////////////////////////////////////////////
+const LogIndexEntity *LogIndex::FindEntity(const Entity _entity) const
+{
+  if (!this->Valid())
+    return nullptr;
+
+  const auto *begin = this->dataPtr->entities;
+  const auto *end = begin + this->EntityCount();
+  const auto *it = std::lower_bound(begin, end, _entity,
+      [](const LogIndexEntity &_a, const Entity _b)
+      {
+        return _a.entity < _b;
+      });
+  if (it == end || it->entity != _entity)
+    return nullptr;
+  return it;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/msgs/pose_v.pb.h>
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Filesystem.hh>
+#include <ignition/msgs/Utility.hh>
+#include <ignition/transport/log/Log.hh>
+
+#include "ignition/gazebo/LogIndex.hh"
+#include "ignition/gazebo/test_config.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/// \brief Insert a message into a log.
+/// \param[in] _log Log to write to.
+/// \param[in] _time Sim time of the message.
+/// \param[in] _topic Topic of the message.
+/// \param[in] _msg Message.
+void Insert(transport::log::Log &_log,
+    const std::chrono::steady_clock::duration &_time,
+    const std::string &_topic, const google::protobuf::Message &_msg)
+{
+  std::string data;
+  ASSERT_TRUE(_msg.SerializeToString(&data));
+  ASSERT_TRUE(_log.InsertMessage(_time, _topic, _msg.GetTypeName(),
+      data.data(), data.size()));
+}
+
+/// \brief State message holding entities.
+/// \param[in] _entities Entities.
+/// \param[in] _remove True to remove them.
+msgs::SerializedStateMap StateMsg(const std::vector<Entity> &_entities,
+    bool _remove = false)
+{
+  msgs::SerializedStateMap msg;
+  for (const auto &entity : _entities)
+  {
+    auto &entityMsg = (*msg.mutable_entities())[entity];
+    entityMsg.set_id(entity);
+    entityMsg.set_remove(_remove);
+  }
+  return msg;
+}
+
+/////////////////////////////////////////////////
+TEST(LogIndex, BuildAndOpen)
+{
+  auto dir = common::joinPaths(std::string(PROJECT_BINARY_PATH),
+      "test_log_index");
+  common::removeAll(dir);
+  ASSERT_TRUE(common::createDirectories(dir));
+
+  {
+    transport::log::Log log;
+    ASSERT_TRUE(log.Open(common::joinPaths(dir, "state.tlog"),
+        std::ios_base::out));
+
+    Insert(log, 0ms, "/world/default/changed_state", StateMsg({1, 2}));
+    Insert(log, 0ms, "/world/default/changed_state_keyframe",
+        StateMsg({1, 2}));
+
+    msgs::Pose_V poses;
+    poses.add_pose()->set_id(2);
+    Insert(log, 150ms, "/world/default/dynamic_pose/info", poses);
+    Insert(log, 250ms, "/world/default/dynamic_pose/info", poses);
+
+    Insert(log, 300ms, "/world/default/changed_state_keyframe",
+        StateMsg({1, 2}));
+    Insert(log, 450ms, "/world/default/changed_state",
+        StateMsg({2}, true));
+  }
+
+  const auto indexPath = common::joinPaths(dir, "timeline.idx");
+  LogIndex index;
+  EXPECT_FALSE(index.Valid());
+  EXPECT_FALSE(index.Open(indexPath));
+  EXPECT_FALSE(LogIndex::Build(common::joinPaths(dir, "missing"),
+      indexPath));
+  ASSERT_TRUE(LogIndex::Build(dir, indexPath, 100ms));
+  ASSERT_TRUE(index.Open(indexPath));
+  EXPECT_TRUE(index.Valid());
+
+  EXPECT_EQ(0ms, index.StartTime());
+  EXPECT_EQ(450ms, index.EndTime());
+  EXPECT_EQ(100ms, index.BucketDuration());
+  ASSERT_EQ(5u, index.BucketCount());
+  EXPECT_EQ(1u, index.BucketIndex(150ms));
+  EXPECT_EQ(4u, index.BucketIndex(10s));
+
+  // Keyframes aren't activity
+  const auto *buckets = index.Buckets();
+  EXPECT_EQ(1u, buckets[0].messages);
+  EXPECT_EQ(2u, buckets[0].entities);
+  EXPECT_EQ(1u, buckets[1].messages);
+  EXPECT_EQ(0u, buckets[3].messages);
+  EXPECT_EQ(1u, buckets[4].messages);
+
+  ASSERT_EQ(2u, index.KeyframeCount());
+  EXPECT_EQ(300ms, index.KeyframeTime(1));
+  EXPECT_EQ(0ms, index.KeyframeBefore(299ms));
+  EXPECT_EQ(300ms, index.KeyframeBefore(300ms));
+  EXPECT_EQ(300ms, index.KeyframeBefore(1s));
+
+  ASSERT_EQ(2u, index.EntityCount());
+  EXPECT_EQ(nullptr, index.FindEntity(3));
+  const auto *second = index.FindEntity(2);
+  ASSERT_NE(nullptr, second);
+  EXPECT_EQ(0, second->firstTime);
+  EXPECT_EQ(450000000, second->lastTime);
+  EXPECT_EQ(4u, second->messages);
+
+  // Truncated files are rejected
+  common::copyFile(indexPath, indexPath + ".copy");
+  {
+    std::ofstream out(indexPath + ".copy", std::ios::binary | std::ios::app);
+    out << "x";
+  }
+  LogIndex other;
+  EXPECT_FALSE(other.Open(indexPath + ".copy"));
+}
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <ignition/msgs/pose_v.pb.h>
+#include <ignition/msgs/serialized.pb.h>
+#include <ignition/msgs/serialized_map.pb.h>
+#include <ignition/msgs/stringmsg.pb.h>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/WorkerPool.hh>
+#include <ignition/msgs/Utility.hh>
+#include <ignition/transport/log/Batch.hh>
+#include <ignition/transport/log/Log.hh>
+#include <ignition/transport/log/MsgIter.hh>
+#include <ignition/transport/log/QueryOptions.hh>
+
+#include "ignition/gazebo/LogReader.hh"
+#include "ignition/gazebo/ParallelTasks.hh"
+#include "ignition/gazebo/StateDelta.hh"
+#include "ignition/gazebo/components/Pose.hh"
+
+#include "systems/log/StateCompression.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Gives the reader access to the maintenance functions which the
+/// simulation runner calls between iterations.
+class LogReaderEcm : public EntityComponentManager
+{
+  /// \brief Get ready for the next frame.
+  public: void NextFrame()
+  {
+    this->ClearNewlyCreatedEntities();
+    this->ProcessRemoveEntityRequests();
+    this->ClearRemovedComponents();
+    this->SetAllComponentsUnchanged();
+  }
+};
+
+/// \brief Private LogReader data class.
+class ignition::gazebo::LogReaderPrivate
+{
+  /// \brief Apply a recorded message to the ECM.
+  /// \param[in] _msg Recorded message.
+  public: void Apply(const transport::log::Message &_msg);
+
+  /// \brief Log being read.
+  public: std::unique_ptr<transport::log::Log> log;
+
+  /// \brief All messages of the log.
+  public: std::optional<transport::log::Batch> batch;
+
+  /// \brief Next message to apply.
+  public: std::optional<transport::log::MsgIter> iter;
+
+  /// \brief Reconstructed state.
+  public: LogReaderEcm ecm;
+
+  /// \brief Sim time of the current frame.
+  public: std::chrono::steady_clock::duration time{0};
+
+  /// \brief Recorded world SDF.
+  public: std::string worldSdf;
+
+  /// \brief Buffer for decompressed messages.
+  public: std::string buffer;
+
+  /// \brief Restores delta encoded components.
+  public: StateDeltaDecoder stateDecoder;
+};
+
+//////////////////////////////////////////////////
+void LogReaderPrivate::Apply(const transport::log::Message &_msg)
+{
+  std::string type = _msg.Type();
+  const std::string *data = &_msg.Data();
+  if (systems::log_system::IsCompressedType(type))
+  {
+    type.resize(type.size() -
+        systems::log_system::kCompressedTypeSuffix.size());
+    if (!systems::log_system::DecompressData(_msg.Data(), this->buffer))
+    {
+      ignerr << "Failed to decompress message of type [" << type << "] on ["
+             << _msg.Topic() << "]" << std::endl;
+      return;
+    }
+    data = &this->buffer;
+  }
+
+  // Keyframes only repeat the state, they're used to seek
+  const std::string keyframeSuffix{"/changed_state_keyframe"};
+  const auto &topic = _msg.Topic();
+  if (topic.size() > keyframeSuffix.size() &&
+      topic.compare(topic.size() - keyframeSuffix.size(),
+      keyframeSuffix.size(), keyframeSuffix) == 0)
+  {
+    return;
+  }
+
+  if (type == "ignition.msgs.SerializedStateMap")
+  {
+    msgs::SerializedStateMap msg;
+    if (msg.ParseFromString(*data))
+    {
+      this->stateDecoder.Decode(msg);
+      this->ecm.SetState(msg);
+    }
+  }
+  else if (type == "ignition.msgs.SerializedState")
+  {
+    msgs::SerializedState msg;
+    if (msg.ParseFromString(*data))
+      this->ecm.SetState(msg);
+  }
+  else if (type == "ignition.msgs.Pose_V")
+  {
+    msgs::Pose_V msg;
+    if (!msg.ParseFromString(*data))
+      return;
+
+    for (int i = 0; i < msg.pose_size(); ++i)
+    {
+      const auto &pose = msg.pose(i);
+      Entity entity = pose.id();
+      auto poseComp = this->ecm.Component<components::Pose>(entity);
+      if (nullptr == poseComp)
+        continue;
+
+      *poseComp = components::Pose(msgs::Convert(pose));
+      this->ecm.SetChanged(entity, components::Pose::typeId,
+          ComponentState::PeriodicChange);
+    }
+  }
+  else if (type == "ignition.msgs.StringMsg")
+  {
+    // We assume this is the SDF string
+    msgs::StringMsg msg;
+    if (msg.ParseFromString(*data))
+      this->worldSdf = msg.data();
+  }
+}
+
+//////////////////////////////////////////////////
+LogReader::LogReader()
+  : dataPtr(std::make_unique<LogReaderPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+LogReader::~LogReader() = default;
+
+//////////////////////////////////////////////////
+bool LogReader::Open(const std::string &_path)
+{
+  auto dbPath = _path;
+  if (common::isDirectory(dbPath))
+    dbPath = common::joinPaths(dbPath, "state.tlog");
+
+  if (!common::isFile(dbPath))
+  {
+    ignerr << "Log file [" << dbPath << "] does not exist." << std::endl;
+    return false;
+  }
+
+  auto log = std::make_unique<transport::log::Log>();
+  if (!log->Open(dbPath))
+  {
+    ignerr << "Failed to open log file [" << dbPath << "]" << std::endl;
+    return false;
+  }
+
+  // Start over with an empty state
+  this->dataPtr = std::make_unique<LogReaderPrivate>();
+  this->dataPtr->log = std::move(log);
+  this->dataPtr->batch.emplace(this->dataPtr->log->QueryMessages());
+  this->dataPtr->iter.emplace(this->dataPtr->batch->begin());
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool LogReader::Step()
+{
+  IGN_PROFILE("LogReader::Step");
+  if (!this->dataPtr->batch)
+    return false;
+
+  auto &iter = *this->dataPtr->iter;
+  const auto end = this->dataPtr->batch->end();
+  if (iter == end)
+    return false;
+
+  this->dataPtr->ecm.NextFrame();
+
+  this->dataPtr->time = iter->TimeReceived();
+  while (iter != end && iter->TimeReceived() == this->dataPtr->time)
+  {
+    this->dataPtr->Apply(*iter);
+    ++iter;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+const EntityComponentManager &LogReader::Ecm() const
+{
+  return this->dataPtr->ecm;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration LogReader::Time() const
+{
+  return this->dataPtr->time;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration LogReader::EndTime() const
+{
+  if (!this->dataPtr->log)
+    return std::chrono::steady_clock::duration::zero();
+  return this->dataPtr->log->EndTime();
+}
+
+//////////////////////////////////////////////////
+const std::string &LogReader::WorldSdf() const
+{
+  return this->dataPtr->worldSdf;
+}
+
+//////////////////////////////////////////////////
+std::size_t LogReader::ProcessLogs(const std::vector<std::string> &_paths,
+    const std::function<void(std::size_t, LogReader &)> &_work,
+    unsigned int _threads)
+{
+  std::atomic<std::size_t> opened{0};
+  common::WorkerPool pool;
+  RunParallelTasks(&pool, _threads, _paths.size(), [&](std::size_t _index)
+  {
+    // Each log gets its own reader, so nothing is shared between tasks
+    LogReader reader;
+    if (!reader.Open(_paths[_index]))
+      return;
+    ++opened;
+    _work(_index, reader);
+  });
+  return opened;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/msgs/pose_v.pb.h>
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Filesystem.hh>
+#include <ignition/msgs/Utility.hh>
+#include <ignition/transport/log/Log.hh>
+
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/LogReader.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/test_config.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/// \brief Insert a message into a log.
+/// \param[in] _log Log to write to.
+/// \param[in] _time Sim time of the message.
+/// \param[in] _topic Topic of the message.
+/// \param[in] _msg Message.
+void Insert(transport::log::Log &_log,
+    const std::chrono::steady_clock::duration &_time,
+    const std::string &_topic, const google::protobuf::Message &_msg)
+{
+  std::string data;
+  ASSERT_TRUE(_msg.SerializeToString(&data));
+  ASSERT_TRUE(_log.InsertMessage(_time, _topic, _msg.GetTypeName(),
+      data.data(), data.size()));
+}
+
+/// \brief Record a log with two models, the second of which is moved and
+/// then removed.
+/// \param[in] _dir Directory to record to.
+/// \param[out] _second Entity of the second model.
+void RecordLog(const std::string &_dir, Entity &_second)
+{
+  common::removeAll(_dir);
+  ASSERT_TRUE(common::createDirectories(_dir));
+
+  EntityComponentManager ecm;
+  for (const auto &name : {"first", "second"})
+  {
+    _second = ecm.CreateEntity();
+    ecm.CreateComponent(_second, components::Name(name));
+    ecm.CreateComponent(_second, components::Pose(math::Pose3d::Zero));
+  }
+
+  transport::log::Log log;
+  ASSERT_TRUE(log.Open(common::joinPaths(_dir, "state.tlog"),
+      std::ios_base::out));
+
+  msgs::SerializedStateMap state;
+  ecm.State(state, {}, {}, true);
+  Insert(log, 1ms, "/world/default/changed_state", state);
+
+  msgs::Pose_V poses;
+  auto pose = poses.add_pose();
+  msgs::Set(pose, math::Pose3d(1, 2, 3, 0, 0, 0));
+  pose->set_id(_second);
+  Insert(log, 2ms, "/world/default/dynamic_pose/info", poses);
+
+  msgs::SerializedStateMap removal;
+  auto &removed = (*removal.mutable_entities())[_second];
+  removed.set_id(_second);
+  removed.set_remove(true);
+  Insert(log, 3ms, "/world/default/changed_state", removal);
+}
+
+/////////////////////////////////////////////////
+TEST(LogReader, Frames)
+{
+  auto dir = common::joinPaths(std::string(PROJECT_BINARY_PATH),
+      "test_log_reader");
+  Entity second{kNullEntity};
+  RecordLog(dir, second);
+
+  LogReader reader;
+  EXPECT_FALSE(reader.Step());
+  EXPECT_FALSE(reader.Open(common::joinPaths(dir, "missing")));
+  ASSERT_TRUE(reader.Open(dir));
+  EXPECT_EQ(3ms, reader.EndTime());
+
+  // Both models are created
+  ASSERT_TRUE(reader.Step());
+  EXPECT_EQ(1ms, reader.Time());
+  EXPECT_EQ(2u, reader.Ecm().EntityCount());
+  EXPECT_TRUE(reader.Ecm().HasNewEntities());
+
+  // The second one moves
+  ASSERT_TRUE(reader.Step());
+  EXPECT_EQ(2ms, reader.Time());
+  EXPECT_FALSE(reader.Ecm().HasNewEntities());
+  auto poseComp = reader.Ecm().Component<components::Pose>(second);
+  ASSERT_NE(nullptr, poseComp);
+  EXPECT_EQ(math::Pose3d(1, 2, 3, 0, 0, 0), poseComp->Data());
+  EXPECT_EQ(ComponentState::PeriodicChange,
+      reader.Ecm().ComponentState(second, components::Pose::typeId));
+
+  // And is removed
+  ASSERT_TRUE(reader.Step());
+  EXPECT_EQ(3ms, reader.Time());
+  EXPECT_TRUE(reader.Ecm().HasEntitiesMarkedForRemoval());
+  EXPECT_FALSE(reader.Step());
+
+  common::removeAll(dir);
+}
+
+/////////////////////////////////////////////////
+TEST(LogReader, ProcessLogs)
+{
+  std::vector<std::string> paths;
+  for (int i = 0; i < 4; ++i)
+  {
+    paths.push_back(common::joinPaths(std::string(PROJECT_BINARY_PATH),
+        "test_log_reader_" + std::to_string(i)));
+    Entity second{kNullEntity};
+    RecordLog(paths.back(), second);
+  }
+  paths.push_back(common::joinPaths(std::string(PROJECT_BINARY_PATH),
+      "test_log_reader_missing"));
+
+  std::vector<int> frames(paths.size(), 0);
+  std::atomic<int> calls{0};
+  EXPECT_EQ(4u, LogReader::ProcessLogs(paths,
+      [&](std::size_t _index, LogReader &_reader)
+  {
+    ++calls;
+    while (_reader.Step())
+      ++frames[_index];
+  }, 2));
+
+  EXPECT_EQ(4, calls);
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(3, frames[i]);
+    common::removeAll(paths[i]);
+  }
+  EXPECT_EQ(0, frames[4]);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Pacer.hh"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+
+using namespace ignition;
+using namespace gazebo;
+
+using Clock = std::chrono::steady_clock;
+
+//////////////////////////////////////////////////
+Pacer::Pacer(ServerConfig::PacingMode _mode,
+    const Clock::duration &_spinTime, ServerConfig::PacingFunction _external)
+  : mode(_mode), spinTime(std::max(Clock::duration::zero(), _spinTime)),
+    external(std::move(_external))
+{
+  if (this->mode == ServerConfig::PacingMode::External && !this->external)
+  {
+    ignwarn << "External pacing requested without a pacing function, "
+            << "sleeping instead." << std::endl;
+    this->mode = ServerConfig::PacingMode::Sleep;
+  }
+}
+
+//////////////////////////////////////////////////
+Clock::duration Pacer::WaitUntil(const Clock::time_point &_time)
+{
+  IGN_PROFILE("Pacer::WaitUntil");
+
+  switch (this->mode)
+  {
+    case ServerConfig::PacingMode::External:
+      this->external(_time);
+      break;
+    case ServerConfig::PacingMode::Hybrid:
+      this->Sleep(_time - this->spinTime);
+      while (Clock::now() < _time)
+      {
+      }
+      break;
+    case ServerConfig::PacingMode::Spin:
+      while (Clock::now() < _time)
+      {
+      }
+      break;
+    case ServerConfig::PacingMode::Sleep:
+    default:
+      this->Sleep(_time);
+      break;
+  }
+
+  return Clock::now() - _time;
+}
+
+//////////////////////////////////////////////////
+ServerConfig::PacingMode Pacer::Mode() const
+{
+  return this->mode;
+}
+
+//////////////////////////////////////////////////
+void Pacer::Sleep(const Clock::time_point &_time)
+{
+  const auto sleepTime = std::max(Clock::duration::zero(),
+      _time - Clock::now() - this->sleepOffset);
+
+  Clock::duration actualSleep{0};
+
+  // Only sleep if needed.
+  if (sleepTime > Clock::duration::zero())
+  {
+    IGN_PROFILE("Sleep");
+    const auto startTime = Clock::now();
+    std::this_thread::sleep_for(sleepTime);
+    actualSleep = Clock::now() - startTime;
+  }
+
+  // Exponentially average out the difference between expected sleep time
+  // and actual sleep time.
+  this->sleepOffset =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+        (actualSleep - sleepTime) * 0.01 + this->sleepOffset * 0.99);
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_PACER_HH_
+#define IGNITION_GAZEBO_PACER_HH_
+
+#include <chrono>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/ServerConfig.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Waits until iterations are due, following one of the
+    /// ServerConfig::PacingMode strategies.
+    class IGNITION_GAZEBO_VISIBLE Pacer
+    {
+      /// \brief Constructor
+      /// \param[in] _mode How to wait.
+      /// \param[in] _spinTime How long to busy-wait for in hybrid mode.
+      /// \param[in] _external Function used in external mode. Sleep is used
+      /// instead if it's empty.
+      public: explicit Pacer(
+          ServerConfig::PacingMode _mode = ServerConfig::PacingMode::Sleep,
+          const std::chrono::steady_clock::duration &_spinTime =
+              std::chrono::microseconds(200),
+          ServerConfig::PacingFunction _external = nullptr);
+
+      /// \brief Wait until the given time. Returns immediately if it has
+      /// passed already.
+      /// \param[in] _time Time when the next iteration is due.
+      /// \return How late the wait ended, negative if it ended early.
+      public: std::chrono::steady_clock::duration WaitUntil(
+                  const std::chrono::steady_clock::time_point &_time);
+
+      /// \brief Get the pacing mode.
+      /// \return The mode actually used.
+      public: ServerConfig::PacingMode Mode() const;
+
+      /// \brief Sleep until shortly before the given time, accounting for
+      /// how much sleeps usually overshoot.
+      /// \param[in] _time Time to wake up at.
+      private: void Sleep(const std::chrono::steady_clock::time_point &_time);
+
+      /// \brief How to wait.
+      private: ServerConfig::PacingMode mode;
+
+      /// \brief How long to busy-wait for in hybrid mode.
+      private: std::chrono::steady_clock::duration spinTime;
+
+      /// \brief Function used in external mode.
+      private: ServerConfig::PacingFunction external;
+
+      /// \brief Exponential average of how much sleeps overshoot.
+      private: std::chrono::steady_clock::duration sleepOffset{0};
+    };
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_PACER_HH_
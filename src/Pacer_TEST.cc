@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "Pacer.hh"
+
+using namespace ignition::gazebo;
+using namespace std::chrono_literals;
+
+using Clock = std::chrono::steady_clock;
+using PacingMode = ServerConfig::PacingMode;
+
+//////////////////////////////////////////////////
+TEST(Pacer, Modes)
+{
+  // Busy-waiting never ends early
+  for (auto mode : {PacingMode::Spin, PacingMode::Hybrid})
+  {
+    Pacer pacer(mode, 1ms);
+    EXPECT_EQ(mode, pacer.Mode());
+
+    for (int i = 0; i < 3; ++i)
+    {
+      const auto due = Clock::now() + 2ms;
+      EXPECT_GE(pacer.WaitUntil(due), 0ns);
+      EXPECT_GE(Clock::now(), due);
+    }
+  }
+
+  // Sleeping ends about on time
+  Pacer sleeper;
+  EXPECT_EQ(PacingMode::Sleep, sleeper.Mode());
+  const auto due = Clock::now() + 2ms;
+  sleeper.WaitUntil(due);
+  EXPECT_GT(Clock::now(), due - 1ms);
+
+  // Times which have passed return immediately
+  Pacer spinner(PacingMode::Spin);
+  EXPECT_GE(spinner.WaitUntil(Clock::now() - 1s), 1s);
+}
+
+//////////////////////////////////////////////////
+TEST(Pacer, External)
+{
+  std::vector<Clock::time_point> calls;
+  Pacer pacer(PacingMode::External, 0ns,
+      [&](const Clock::time_point &_time)
+      {
+        calls.push_back(_time);
+      });
+  EXPECT_EQ(PacingMode::External, pacer.Mode());
+
+  const auto due = Clock::now() + 1h;
+  EXPECT_LT(pacer.WaitUntil(due), 0ns);
+  ASSERT_EQ(1u, calls.size());
+  EXPECT_EQ(due, calls[0]);
+
+  // Without a function, it sleeps
+  Pacer fallback(PacingMode::External);
+  EXPECT_EQ(PacingMode::Sleep, fallback.Mode());
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <ignition/common/WorkerPool.hh>
+
+#include "ignition/gazebo/ParallelTasks.hh"
+
+using namespace ignition;
+
+/// \brief Number of times the caller checks for completion before blocking.
+static constexpr unsigned int kSpinCount{4096};
+
+//////////////////////////////////////////////////
+void gazebo::RunParallelTasks(common::WorkerPool *_pool,
+    unsigned int _threads, const std::size_t _taskCount,
+    const std::function<void(std::size_t)> &_task)
+{
+  if (0 == _threads)
+    _threads = std::max(1u, std::thread::hardware_concurrency());
+
+  if (nullptr == _pool || _threads < 2 || _taskCount < 2)
+  {
+    for (std::size_t i = 0; i < _taskCount; ++i)
+      _task(i);
+    return;
+  }
+
+  // Shared with the pool tasks, which may still be queued after all tasks
+  // have been claimed and this function returns.
+  struct Shared
+  {
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+  };
+  auto shared = std::make_shared<Shared>();
+
+  // Claims and runs tasks until there are none left. The task function is
+  // only dereferenced after successfully claiming a task, which happens
+  // before this function returns.
+  const auto *task = &_task;
+  auto process = [shared, task, _taskCount]()
+  {
+    std::size_t processed = 0;
+    for (std::size_t i = shared->next++; i < _taskCount; i = shared->next++)
+    {
+      (*task)(i);
+      ++processed;
+    }
+
+    if (processed > 0 && (shared->done += processed) == _taskCount)
+    {
+      // Lock so the notification can't be missed by a caller about to block
+      std::lock_guard<std::mutex> lock(shared->mutex);
+      shared->cv.notify_all();
+    }
+  };
+
+  const std::size_t helperCount =
+      std::min<std::size_t>(_threads, _taskCount) - 1;
+  for (std::size_t i = 0; i < helperCount; ++i)
+    _pool->AddWork(process);
+
+  process();
+
+  // The remaining tasks are usually about to finish, so spin for a while
+  // before paying for blocking and being woken up
+  for (unsigned int i = 0; i < kSpinCount && shared->done != _taskCount; ++i)
+  {
+  }
+  if (shared->done == _taskCount)
+    return;
+
+  std::unique_lock<std::mutex> lock(shared->mutex);
+  shared->cv.wait(lock, [&]{return shared->done == _taskCount;});
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include <ignition/common/WorkerPool.hh>
+
+#include "ignition/gazebo/ParallelTasks.hh"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+TEST(ParallelTasks, NoPool)
+{
+  std::vector<std::size_t> order;
+  gazebo::RunParallelTasks(nullptr, 4u, 5u, [&](std::size_t _index)
+  {
+    order.push_back(_index);
+  });
+
+  // Without a pool, tasks run in order on the calling thread
+  EXPECT_EQ(std::vector<std::size_t>({0u, 1u, 2u, 3u, 4u}), order);
+
+  // No tasks
+  gazebo::RunParallelTasks(nullptr, 4u, 0u, [&](std::size_t)
+  {
+    FAIL();
+  });
+}
+
+//////////////////////////////////////////////////
+TEST(ParallelTasks, Pool)
+{
+  common::WorkerPool pool;
+
+  for (unsigned int threads : {0u, 1u, 2u, 8u})
+  {
+    const std::size_t count = 100;
+    std::vector<std::atomic<int>> runs(count);
+    gazebo::RunParallelTasks(&pool, threads, count, [&](std::size_t _index)
+    {
+      ++runs[_index];
+    });
+
+    // All tasks are done once the function returns, each exactly once
+    for (const auto &run : runs)
+      EXPECT_EQ(1, run);
+  }
+}
+
+//////////////////////////////////////////////////
+TEST(ParallelTasks, Nested)
+{
+  common::WorkerPool pool;
+
+  // Tasks which run tasks themselves can't deadlock, even if all pool
+  // threads are busy
+  std::atomic<int> total{0};
+  gazebo::RunParallelTasks(&pool, 8u, 8u, [&](std::size_t)
+  {
+    gazebo::RunParallelTasks(&pool, 8u, 8u, [&](std::size_t)
+    {
+      ++total;
+    });
+  });
+  EXPECT_EQ(64, total);
+}
@@ -0,0 +1,585 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#include <ignition/math/Quaternion.hh>
+
+#include "ignition/gazebo/PoseDeltaStream.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Version of the frame layout.
+static const uint8_t kVersion{1};
+
+/// \brief Quantized pose: x, y, z, then the w, x, y, z quaternion components.
+using QuantizedPose = std::array<int64_t, 7>;
+
+/// \brief Append an unsigned integer using 7 bits per byte.
+/// \param[in, out] _out Buffer.
+/// \param[in] _value Value.
+static void PutVarint(std::string &_out, uint64_t _value)
+{
+  while (_value >= 0x80)
+  {
+    _out.push_back(static_cast<char>((_value & 0x7F) | 0x80));
+    _value >>= 7;
+  }
+  _out.push_back(static_cast<char>(_value));
+}
+
+/// \brief Append a signed integer, zigzag encoded so that small negative
+/// values stay short.
+/// \param[in, out] _out Buffer.
+/// \param[in] _value Value.
+static void PutSigned(std::string &_out, int64_t _value)
+{
+  PutVarint(_out, (static_cast<uint64_t>(_value) << 1) ^
+      static_cast<uint64_t>(_value >> 63));
+}
+
+/// \brief Append a double in host byte order.
+/// \param[in, out] _out Buffer.
+/// \param[in] _value Value.
+static void PutDouble(std::string &_out, double _value)
+{
+  char bytes[sizeof(double)];
+  std::memcpy(bytes, &_value, sizeof(double));
+  _out.append(bytes, sizeof(double));
+}
+
+/// \brief Bounds-checked reader over a frame.
+class FrameReader
+{
+  /// \brief Constructor
+  /// \param[in] _frame Frame, which must outlive the reader.
+  public: explicit FrameReader(const std::string &_frame)
+    : frame(_frame)
+  {
+  }
+
+  /// \brief Read a byte.
+  /// \param[out] _value Value.
+  /// \return False if past the end of the frame.
+  public: bool Byte(uint8_t &_value)
+  {
+    if (this->pos >= this->frame.size())
+      return false;
+    _value = static_cast<uint8_t>(this->frame[this->pos++]);
+    return true;
+  }
+
+  /// \brief Read an unsigned integer written by PutVarint.
+  /// \param[out] _value Value.
+  /// \return False if malformed.
+  public: bool Varint(uint64_t &_value)
+  {
+    _value = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7)
+    {
+      uint8_t byte;
+      if (!this->Byte(byte))
+        return false;
+      _value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+        return true;
+    }
+    return false;
+  }
+
+  /// \brief Read a signed integer written by PutSigned.
+  /// \param[out] _value Value.
+  /// \return False if malformed.
+  public: bool Signed(int64_t &_value)
+  {
+    uint64_t zigzag;
+    if (!this->Varint(zigzag))
+      return false;
+    _value = static_cast<int64_t>(zigzag >> 1) ^
+        -static_cast<int64_t>(zigzag & 1);
+    return true;
+  }
+
+  /// \brief Read a double written by PutDouble.
+  /// \param[out] _value Value.
+  /// \return False if past the end of the frame.
+  public: bool Double(double &_value)
+  {
+    if (this->frame.size() - this->pos < sizeof(double))
+      return false;
+    std::memcpy(&_value, this->frame.data() + this->pos, sizeof(double));
+    this->pos += sizeof(double);
+    return true;
+  }
+
+  /// \brief Whether the whole frame has been read.
+  /// \return True at the end.
+  public: bool End() const
+  {
+    return this->pos == this->frame.size();
+  }
+
+  /// \brief Frame being read.
+  private: const std::string &frame;
+
+  /// \brief Read position.
+  private: std::size_t pos{0};
+};
+
+/// \brief Quantize a pose.
+/// \param[in] _pose Pose.
+/// \param[in] _posRes Position resolution.
+/// \param[in] _rotRes Orientation resolution.
+/// \return Quantized pose.
+static QuantizedPose Quantize(const math::Pose3d &_pose, double _posRes,
+    double _rotRes)
+{
+  math::Quaterniond rot = _pose.Rot();
+  rot.Normalize();
+
+  // q and -q are the same rotation, keep w positive so that deltas between
+  // similar orientations stay small
+  double sign = rot.W() < 0 ? -1.0 : 1.0;
+
+  return {std::llround(_pose.Pos().X() / _posRes),
+          std::llround(_pose.Pos().Y() / _posRes),
+          std::llround(_pose.Pos().Z() / _posRes),
+          std::llround(sign * rot.W() / _rotRes),
+          std::llround(sign * rot.X() / _rotRes),
+          std::llround(sign * rot.Y() / _rotRes),
+          std::llround(sign * rot.Z() / _rotRes)};
+}
+
+/// \brief Reconstruct a pose from its quantized values.
+/// \param[in] _pose Quantized pose.
+/// \param[in] _posRes Position resolution.
+/// \param[in] _rotRes Orientation resolution.
+/// \return Pose.
+static math::Pose3d Dequantize(const QuantizedPose &_pose, double _posRes,
+    double _rotRes)
+{
+  math::Quaterniond rot(_pose[3] * _rotRes, _pose[4] * _rotRes,
+      _pose[5] * _rotRes, _pose[6] * _rotRes);
+  rot.Normalize();
+
+  return math::Pose3d(math::Vector3d(_pose[0] * _posRes, _pose[1] * _posRes,
+      _pose[2] * _posRes), rot);
+}
+
+/// \brief Private data for PoseDeltaEncoder
+class ignition::gazebo::PoseDeltaEncoderPrivate
+{
+  /// \brief Whether the next frame has to be a keyframe.
+  /// \param[in] _poses Poses to encode.
+  /// \return True for a keyframe.
+  public: bool NeedsKeyframe(const std::map<Entity, math::Pose3d> &_poses)
+      const;
+
+  /// \brief Position resolution of the current keyframe.
+  public: double positionResolution{1e-4};
+
+  /// \brief Orientation resolution of the current keyframe.
+  public: double orientationResolution{1e-5};
+
+  /// \brief Position resolution for the next keyframe.
+  public: double nextPositionResolution{1e-4};
+
+  /// \brief Orientation resolution for the next keyframe.
+  public: double nextOrientationResolution{1e-5};
+
+  /// \brief Position tolerance in meters.
+  public: double positionTolerance{1e-4};
+
+  /// \brief Orientation tolerance in radians.
+  public: double orientationTolerance{1e-4};
+
+  /// \brief Number of frames between keyframes.
+  public: unsigned int keyframePeriod{60};
+
+  /// \brief Frames written since the last keyframe, including it.
+  public: unsigned int framesSinceKeyframe{0};
+
+  /// \brief Whether a keyframe was requested.
+  public: bool forceKeyframe{true};
+
+  /// \brief Sequence number of the next frame.
+  public: uint64_t sequence{0};
+
+  /// \brief Quantized pose last sent for each entity, which is what the
+  /// decoder holds.
+  public: std::map<Entity, QuantizedPose> sent;
+};
+
+/// \brief Private data for PoseDeltaDecoder
+class ignition::gazebo::PoseDeltaDecoderPrivate
+{
+  /// \brief Decode a keyframe.
+  /// \param[in] _reader Reader positioned after the common header.
+  /// \param[out] _changed Entities whose pose changed.
+  /// \return True if successful.
+  public: bool DecodeKeyframe(FrameReader &_reader,
+      std::vector<Entity> &_changed);
+
+  /// \brief Decode a delta.
+  /// \param[in] _reader Reader positioned after the common header.
+  /// \param[out] _changed Entities whose pose changed, must be empty.
+  /// \return True if successful.
+  public: bool DecodeDelta(FrameReader &_reader,
+      std::vector<Entity> &_changed);
+
+  /// \brief Whether every frame since the last keyframe has been decoded.
+  public: bool synced{false};
+
+  /// \brief Sequence number of the last frame decoded.
+  public: uint64_t sequence{0};
+
+  /// \brief Position resolution of the last keyframe.
+  public: double positionResolution{0};
+
+  /// \brief Orientation resolution of the last keyframe.
+  public: double orientationResolution{0};
+
+  /// \brief Time of the last frame decoded.
+  public: std::chrono::steady_clock::duration time{0};
+
+  /// \brief Quantized poses, which match those of the encoder.
+  public: std::map<Entity, QuantizedPose> quantized;
+
+  /// \brief Decoded poses.
+  public: std::map<Entity, math::Pose3d> poses;
+};
+
+//////////////////////////////////////////////////
+bool PoseDeltaEncoderPrivate::NeedsKeyframe(
+    const std::map<Entity, math::Pose3d> &_poses) const
+{
+  if (this->forceKeyframe || this->framesSinceKeyframe >= this->keyframePeriod)
+    return true;
+
+  // Any entity added or removed
+  if (_poses.size() != this->sent.size())
+    return true;
+
+  return !std::equal(_poses.begin(), _poses.end(), this->sent.begin(),
+      [](const auto &_a, const auto &_b)
+      {
+        return _a.first == _b.first;
+      });
+}
+
+//////////////////////////////////////////////////
+PoseDeltaEncoder::PoseDeltaEncoder()
+  : dataPtr(std::make_unique<PoseDeltaEncoderPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+PoseDeltaEncoder::~PoseDeltaEncoder() = default;
+
+//////////////////////////////////////////////////
+void PoseDeltaEncoder::SetPositionResolution(double _resolution)
+{
+  if (_resolution > 0)
+    this->dataPtr->nextPositionResolution = _resolution;
+}
+
+//////////////////////////////////////////////////
+void PoseDeltaEncoder::SetOrientationResolution(double _resolution)
+{
+  if (_resolution > 0)
+    this->dataPtr->nextOrientationResolution = _resolution;
+}
+
+//////////////////////////////////////////////////
+void PoseDeltaEncoder::SetPositionTolerance(double _tolerance)
+{
+  this->dataPtr->positionTolerance = std::max(0.0, _tolerance);
+}
+
+//////////////////////////////////////////////////
+void PoseDeltaEncoder::SetOrientationTolerance(double _tolerance)
+{
+  this->dataPtr->orientationTolerance = std::max(0.0, _tolerance);
+}
+
+//////////////////////////////////////////////////
+void PoseDeltaEncoder::SetKeyframePeriod(unsigned int _period)
+{
+  this->dataPtr->keyframePeriod = std::max(1u, _period);
+}
+
+//////////////////////////////////////////////////
+void PoseDeltaEncoder::ForceKeyframe()
+{
+  this->dataPtr->forceKeyframe = true;
+}
+
+//////////////////////////////////////////////////
+bool PoseDeltaEncoder::Encode(const std::map<Entity, math::Pose3d> &_poses,
+    const std::chrono::steady_clock::duration &_time, std::string &_frame)
+{
+  auto &d = *this->dataPtr;
+  bool keyframe = d.NeedsKeyframe(_poses);
+
+  std::string body;
+  uint64_t count{0};
+  Entity prevEntity{0};
+
+  if (keyframe)
+  {
+    d.positionResolution = d.nextPositionResolution;
+    d.orientationResolution = d.nextOrientationResolution;
+    d.sent.clear();
+
+    for (const auto &[entity, pose] : _poses)
+    {
+      auto q = Quantize(pose, d.positionResolution, d.orientationResolution);
+
+      // Entities are sorted, so only write the gap to the previous one
+      PutVarint(body, entity - prevEntity);
+      prevEntity = entity;
+      for (auto value : q)
+        PutSigned(body, value);
+
+      d.sent.emplace_hint(d.sent.end(), entity, q);
+    }
+    count = _poses.size();
+  }
+  else
+  {
+    // Same entities as the previous frame, checked by NeedsKeyframe
+    auto sentIt = d.sent.begin();
+    for (const auto &[entity, pose] : _poses)
+    {
+      auto &last = (sentIt++)->second;
+      auto lastPose = Dequantize(last, d.positionResolution,
+          d.orientationResolution);
+
+      double dot = std::abs(lastPose.Rot().W() * pose.Rot().W() +
+          lastPose.Rot().X() * pose.Rot().X() +
+          lastPose.Rot().Y() * pose.Rot().Y() +
+          lastPose.Rot().Z() * pose.Rot().Z());
+      double angle = 2.0 * std::acos(std::min(1.0, dot));
+
+      if (lastPose.Pos().Distance(pose.Pos()) <= d.positionTolerance &&
+          angle <= d.orientationTolerance)
+      {
+        continue;
+      }
+
+      auto q = Quantize(pose, d.positionResolution, d.orientationResolution);
+      if (q == last)
+        continue;
+
+      PutVarint(body, entity - prevEntity);
+      prevEntity = entity;
+      for (std::size_t i = 0; i < q.size(); ++i)
+        PutSigned(body, q[i] - last[i]);
+
+      last = q;
+      ++count;
+    }
+
+    if (count == 0)
+      return false;
+  }
+
+  _frame.clear();
+  _frame.push_back(static_cast<char>(kVersion));
+  _frame.push_back(static_cast<char>(keyframe ? PoseDeltaFrameType::KEYFRAME :
+      PoseDeltaFrameType::DELTA));
+  PutVarint(_frame, d.sequence);
+  PutSigned(_frame, std::chrono::duration_cast<std::chrono::nanoseconds>(
+      _time).count());
+  if (keyframe)
+  {
+    PutDouble(_frame, d.positionResolution);
+    PutDouble(_frame, d.orientationResolution);
+  }
+  PutVarint(_frame, count);
+  _frame += body;
+
+  ++d.sequence;
+  d.framesSinceKeyframe = keyframe ? 1 : d.framesSinceKeyframe + 1;
+  d.forceKeyframe = false;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool PoseDeltaDecoderPrivate::DecodeKeyframe(FrameReader &_reader,
+    std::vector<Entity> &_changed)
+{
+  double posRes, rotRes;
+  uint64_t count;
+  if (!_reader.Double(posRes) || !_reader.Double(rotRes) || !(posRes > 0) ||
+      !(rotRes > 0) || !_reader.Varint(count))
+  {
+    return false;
+  }
+
+  std::map<Entity, QuantizedPose> newQuantized;
+  Entity entity{0};
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    uint64_t gap;
+    if (!_reader.Varint(gap))
+      return false;
+    entity += gap;
+
+    QuantizedPose q;
+    for (auto &value : q)
+    {
+      if (!_reader.Signed(value))
+        return false;
+    }
+    newQuantized.emplace_hint(newQuantized.end(), entity, q);
+  }
+
+  if (!_reader.End())
+    return false;
+
+  bool sameResolution = posRes == this->positionResolution &&
+      rotRes == this->orientationResolution;
+  this->positionResolution = posRes;
+  this->orientationResolution = rotRes;
+
+  std::map<Entity, math::Pose3d> newPoses;
+  for (const auto &[ent, q] : newQuantized)
+  {
+    auto it = this->quantized.find(ent);
+    auto pose = Dequantize(q, posRes, rotRes);
+    if (!sameResolution || it == this->quantized.end() || it->second != q)
+      _changed.push_back(ent);
+    newPoses.emplace_hint(newPoses.end(), ent, pose);
+  }
+
+  this->quantized = std::move(newQuantized);
+  this->poses = std::move(newPoses);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool PoseDeltaDecoderPrivate::DecodeDelta(FrameReader &_reader,
+    std::vector<Entity> &_changed)
+{
+  uint64_t count;
+  if (!_reader.Varint(count))
+    return false;
+
+  // Validate the whole frame before applying it
+  std::vector<std::pair<QuantizedPose *, QuantizedPose>> updates;
+  Entity entity{0};
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    uint64_t gap;
+    if (!_reader.Varint(gap))
+      return false;
+    entity += gap;
+
+    auto it = this->quantized.find(entity);
+    if (it == this->quantized.end())
+      return false;
+
+    QuantizedPose q;
+    for (std::size_t j = 0; j < q.size(); ++j)
+    {
+      int64_t diff;
+      if (!_reader.Signed(diff))
+        return false;
+      q[j] = it->second[j] + diff;
+    }
+    updates.emplace_back(&it->second, q);
+    _changed.push_back(entity);
+  }
+
+  if (!_reader.End())
+    return false;
+
+  for (std::size_t i = 0; i < updates.size(); ++i)
+  {
+    *updates[i].first = updates[i].second;
+    this->poses[_changed[i]] = Dequantize(updates[i].second,
+        this->positionResolution, this->orientationResolution);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+PoseDeltaDecoder::PoseDeltaDecoder()
+  : dataPtr(std::make_unique<PoseDeltaDecoderPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+PoseDeltaDecoder::~PoseDeltaDecoder() = default;
+
+//////////////////////////////////////////////////
+bool PoseDeltaDecoder::Decode(const std::string &_frame,
+    std::vector<Entity> &_changed)
+{
+  _changed.clear();
+
+  FrameReader reader(_frame);
+  uint8_t version, type;
+  uint64_t sequence;
+  int64_t time;
+  if (!reader.Byte(version) || version != kVersion || !reader.Byte(type) ||
+      !reader.Varint(sequence) || !reader.Signed(time))
+  {
+    return false;
+  }
+
+  bool success{false};
+  if (type == static_cast<uint8_t>(PoseDeltaFrameType::KEYFRAME))
+  {
+    success = this->dataPtr->DecodeKeyframe(reader, _changed);
+  }
+  else if (type == static_cast<uint8_t>(PoseDeltaFrameType::DELTA))
+  {
+    // A delta only applies on top of the frame right before it
+    success = this->dataPtr->synced &&
+        sequence == this->dataPtr->sequence + 1 &&
+        this->dataPtr->DecodeDelta(reader, _changed);
+  }
+
+  this->dataPtr->synced = success;
+  if (!success)
+  {
+    _changed.clear();
+    return false;
+  }
+
+  this->dataPtr->sequence = sequence;
+  this->dataPtr->time = std::chrono::duration_cast<
+      std::chrono::steady_clock::duration>(std::chrono::nanoseconds(time));
+  return true;
+}
+
+//////////////////////////////////////////////////
+const std::map<Entity, math::Pose3d> &PoseDeltaDecoder::Poses() const
+{
+  return this->dataPtr->poses;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration PoseDeltaDecoder::Time() const
+{
+  return this->dataPtr->time;
+}
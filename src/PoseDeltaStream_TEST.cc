@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ignition/gazebo/PoseDeltaStream.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/// \brief Check that two poses are within the quantization error.
+/// \param[in] _expected Expected pose.
+/// \param[in] _actual Decoded pose.
+void ExpectNearPose(const math::Pose3d &_expected, const math::Pose3d &_actual)
+{
+  EXPECT_NEAR(_expected.Pos().X(), _actual.Pos().X(), 1e-4);
+  EXPECT_NEAR(_expected.Pos().Y(), _actual.Pos().Y(), 1e-4);
+  EXPECT_NEAR(_expected.Pos().Z(), _actual.Pos().Z(), 1e-4);
+
+  double dot = _expected.Rot().W() * _actual.Rot().W() +
+      _expected.Rot().X() * _actual.Rot().X() +
+      _expected.Rot().Y() * _actual.Rot().Y() +
+      _expected.Rot().Z() * _actual.Rot().Z();
+  EXPECT_NEAR(1.0, std::abs(dot), 1e-6);
+}
+
+//////////////////////////////////////////////////
+TEST(PoseDeltaStream, KeyframeAndDeltas)
+{
+  PoseDeltaEncoder encoder;
+  PoseDeltaDecoder decoder;
+
+  std::map<Entity, math::Pose3d> poses{
+      {3u, math::Pose3d(1, 2, 3, 0.1, 0.2, 0.3)},
+      {10u, math::Pose3d(-100, 0.5, 0, 0, 0, -3.0)},
+      {11u, math::Pose3d(0, 0, 0, 0, 0, 0)}};
+
+  // First frame is a keyframe with all entities
+  std::string keyframe;
+  ASSERT_TRUE(encoder.Encode(poses, 1s, keyframe));
+  EXPECT_EQ(static_cast<char>(PoseDeltaFrameType::KEYFRAME), keyframe[1]);
+
+  std::vector<Entity> changed;
+  ASSERT_TRUE(decoder.Decode(keyframe, changed));
+  EXPECT_EQ(std::vector<Entity>({3u, 10u, 11u}), changed);
+  EXPECT_EQ(std::chrono::steady_clock::duration(1s), decoder.Time());
+  ASSERT_EQ(3u, decoder.Poses().size());
+  for (const auto &[entity, pose] : poses)
+    ExpectNearPose(pose, decoder.Poses().at(entity));
+
+  // Nothing moved, there's nothing to send
+  std::string delta;
+  EXPECT_FALSE(encoder.Encode(poses, 2s, delta));
+
+  // Movement below the tolerance isn't sent
+  poses[3u] = math::Pose3d(1.00001, 2, 3, 0.1, 0.2, 0.3);
+  EXPECT_FALSE(encoder.Encode(poses, 2s, delta));
+
+  // Only the entity which moved is sent
+  poses[10u] = math::Pose3d(-100.01, 0.5, 0, 0, 0, -3.01);
+  ASSERT_TRUE(encoder.Encode(poses, 3s, delta));
+  EXPECT_EQ(static_cast<char>(PoseDeltaFrameType::DELTA), delta[1]);
+  EXPECT_LT(delta.size(), keyframe.size());
+
+  ASSERT_TRUE(decoder.Decode(delta, changed));
+  EXPECT_EQ(std::vector<Entity>({10u}), changed);
+  EXPECT_EQ(std::chrono::steady_clock::duration(3s), decoder.Time());
+  for (const auto &[entity, pose] : poses)
+    ExpectNearPose(pose, decoder.Poses().at(entity));
+
+  // Many small steps don't accumulate error
+  for (int i = 0; i < 50; ++i)
+  {
+    poses[11u] = math::Pose3d(i * 0.00123, -i * 0.00321, 0, 0, 0, i * 0.01);
+    if (encoder.Encode(poses, 4s, delta))
+    {
+      ASSERT_TRUE(decoder.Decode(delta, changed));
+    }
+  }
+  ExpectNearPose(poses[11u], decoder.Poses().at(11u));
+}
+
+//////////////////////////////////////////////////
+TEST(PoseDeltaStream, Keyframes)
+{
+  PoseDeltaEncoder encoder;
+  encoder.SetKeyframePeriod(3);
+
+  std::map<Entity, math::Pose3d> poses{{1u, math::Pose3d::Zero}};
+  std::string frame;
+
+  std::vector<char> types;
+  for (int i = 0; i < 7; ++i)
+  {
+    poses[1u] = math::Pose3d(i, 0, 0, 0, 0, 0);
+    ASSERT_TRUE(encoder.Encode(poses, 0s, frame));
+    types.push_back(frame[1]);
+  }
+  const char k = static_cast<char>(PoseDeltaFrameType::KEYFRAME);
+  const char d = static_cast<char>(PoseDeltaFrameType::DELTA);
+  EXPECT_EQ(std::vector<char>({k, d, d, k, d, d, k}), types);
+
+  // Added and removed entities cause a keyframe
+  poses[2u] = math::Pose3d::Zero;
+  ASSERT_TRUE(encoder.Encode(poses, 0s, frame));
+  EXPECT_EQ(k, frame[1]);
+
+  PoseDeltaDecoder decoder;
+  std::vector<Entity> changed;
+  ASSERT_TRUE(decoder.Decode(frame, changed));
+  EXPECT_EQ(2u, decoder.Poses().size());
+
+  poses.erase(1u);
+  ASSERT_TRUE(encoder.Encode(poses, 0s, frame));
+  EXPECT_EQ(k, frame[1]);
+  ASSERT_TRUE(decoder.Decode(frame, changed));
+  EXPECT_EQ(1u, decoder.Poses().size());
+  EXPECT_EQ(0u, decoder.Poses().count(1u));
+
+  // Requested keyframe
+  poses[2u] = math::Pose3d(1, 0, 0, 0, 0, 0);
+  encoder.ForceKeyframe();
+  ASSERT_TRUE(encoder.Encode(poses, 0s, frame));
+  EXPECT_EQ(k, frame[1]);
+}
+
+//////////////////////////////////////////////////
+TEST(PoseDeltaStream, MissedFrame)
+{
+  PoseDeltaEncoder encoder;
+  PoseDeltaDecoder decoder;
+  std::map<Entity, math::Pose3d> poses{{1u, math::Pose3d::Zero}};
+  std::vector<Entity> changed;
+
+  // Deltas before the first keyframe are ignored
+  std::string keyframe, delta1, delta2;
+  ASSERT_TRUE(encoder.Encode(poses, 0s, keyframe));
+  poses[1u] = math::Pose3d(1, 0, 0, 0, 0, 0);
+  ASSERT_TRUE(encoder.Encode(poses, 0s, delta1));
+  poses[1u] = math::Pose3d(2, 0, 0, 0, 0, 0);
+  ASSERT_TRUE(encoder.Encode(poses, 0s, delta2));
+
+  EXPECT_FALSE(decoder.Decode(delta1, changed));
+  EXPECT_TRUE(changed.empty());
+
+  // A missed delta stops decoding until the next keyframe
+  ASSERT_TRUE(decoder.Decode(keyframe, changed));
+  EXPECT_FALSE(decoder.Decode(delta2, changed));
+  EXPECT_FALSE(decoder.Decode(delta1, changed));
+  ExpectNearPose(math::Pose3d::Zero, decoder.Poses().at(1u));
+
+  encoder.ForceKeyframe();
+  ASSERT_TRUE(encoder.Encode(poses, 0s, keyframe));
+  ASSERT_TRUE(decoder.Decode(keyframe, changed));
+  ExpectNearPose(poses[1u], decoder.Poses().at(1u));
+
+  // Malformed frames
+  EXPECT_FALSE(decoder.Decode("", changed));
+  EXPECT_FALSE(decoder.Decode(keyframe.substr(0, keyframe.size() - 1),
+      changed));
+  EXPECT_FALSE(decoder.Decode(keyframe + "x", changed));
+}
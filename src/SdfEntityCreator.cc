@@ -15,10 +15,18 @@
  *
 */
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Profiler.hh>
 
 #include "ignition/gazebo/Events.hh"
+#include "ignition/gazebo/ParallelTasks.hh"
 #include "ignition/gazebo/SdfEntityCreator.hh"
 
 #include "ignition/gazebo/components/Actor.hh"
@@ -73,6 +81,89 @@
 
 class ignition::gazebo::SdfEntityCreatorPrivate
 {
+  /// \brief Entities and components converted from the SDF of one model,
+  /// waiting to be added to the ECM. Until then, entities are identified by
+  /// their index in the bundle.
+  public: class EntityBundle
+  {
+    /// \brief An entity in the bundle.
+    public: struct Entry
+    {
+      /// \brief Functions creating each of the entity's components.
+      std::vector<std::function<void(EntityComponentManager &, Entity)>>
+          components;
+
+      /// \brief Types of the entity's components.
+      std::vector<ComponentTypeId> types;
+
+      /// \brief Index of the parent entity in the bundle, if any.
+      std::optional<std::size_t> parent;
+    };
+
+    /// \brief Entities in the order they were created.
+    public: std::vector<Entry> entries;
+
+    /// \brief Index of the model entity.
+    public: Entity root{kNullEntity};
+
+    /// \brief Models, sensors and visuals whose plugins should be loaded,
+    /// keyed by index in the bundle.
+    public: std::map<Entity, sdf::ElementPtr> newModels;
+
+    /// \copydoc newModels
+    public: std::map<Entity, sdf::ElementPtr> newSensors;
+
+    /// \copydoc newModels
+    public: std::map<Entity, sdf::ElementPtr> newVisuals;
+  };
+
+  /// \brief Create an entity, or add it to the bundle.
+  /// \return The new entity, or its index in the bundle.
+  public: Entity NewEntity()
+  {
+    if (nullptr == this->bundle)
+      return this->ecm->CreateEntity();
+
+    this->bundle->entries.emplace_back();
+    return this->bundle->entries.size() - 1;
+  }
+
+  /// \brief Create a component, or add it to the bundle.
+  /// \param[in] _entity Entity, or its index in the bundle.
+  /// \param[in] _component Component to copy.
+  public: template<typename ComponentTypeT>
+          void AddComponent(Entity _entity, const ComponentTypeT &_component)
+  {
+    if (nullptr == this->bundle)
+    {
+      this->ecm->CreateComponent(_entity, _component);
+      return;
+    }
+
+    auto &entry = this->bundle->entries[_entity];
+    entry.components.push_back(
+        [_component](EntityComponentManager &_ecm, Entity _created)
+        {
+          _ecm.CreateComponent(_created, _component);
+        });
+    entry.types.push_back(components::TypeIdOf<ComponentTypeT>());
+  }
+
+  /// \brief Check whether an entity has a component, in the ECM or in the
+  /// bundle.
+  /// \param[in] _entity Entity, or its index in the bundle.
+  /// \return True if it has a component of the given type.
+  public: template<typename ComponentTypeT>
+          bool HasComponent(Entity _entity) const
+  {
+    if (nullptr == this->bundle)
+      return nullptr != this->ecm->Component<ComponentTypeT>(_entity);
+
+    const auto &types = this->bundle->entries[_entity].types;
+    return std::find(types.begin(), types.end(),
+        components::TypeIdOf<ComponentTypeT>()) != types.end();
+  }
+
   /// \brief Pointer to entity component manager. We don't assume ownership.
   public: EntityComponentManager *ecm{nullptr};
 
@@ -90,6 +181,16 @@ class ignition::gazebo::SdfEntityCreatorPrivate
   /// \brief Keep track of new visuals being added, so we load their plugins
   /// only after we have their scoped name.
   public: std::map<Entity, sdf::ElementPtr> newVisuals;
+
+  /// \brief Bundle which entities are added to instead of the ECM, while
+  /// converting models in parallel. Null to create entities in the ECM.
+  public: EntityBundle *bundle{nullptr};
+
+  /// \brief Worker pool used to convert models in parallel.
+  public: common::WorkerPool *workerPool{nullptr};
+
+  /// \brief Maximum number of threads converting models at once.
+  public: unsigned int workerThreads{0};
 };
 
 using namespace ignition;
@@ -148,6 +249,9 @@ Entity SdfEntityCreator::CreateEntities(const sdf::World *_world)
 {
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::World)");
 
+  // Update views once per entity instead of once per component
+  this->dataPtr->ecm->BeginBatch();
+
   // World entity
   Entity worldEntity = this->dataPtr->ecm->CreateEntity();
 
@@ -218,6 +322,8 @@ Entity SdfEntityCreator::CreateEntities(const sdf::World *_world)
   this->dataPtr->ecm->CreateComponent(worldEntity,
       components::MagneticField(_world->MagneticField()));
 
+  this->dataPtr->ecm->EndBatch();
+
   this->dataPtr->eventManager->Emit<events::LoadPlugins>(worldEntity,
       _world->Element());
 
@@ -238,7 +344,9 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model)
   // canonical link in a model tree using the second arg in this recursive
   // function. We also override child nested models static property if parent
   // model is static
+  this->dataPtr->ecm->BeginBatch();
   auto ent = this->CreateEntities(_model, true, false);
+  this->dataPtr->ecm->EndBatch();
 
   // Load all model plugins afterwards, so we get scoped name for nested models.
   for (const auto &[entity, element] : this->dataPtr->newModels)
@@ -264,27 +372,117 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model)
   return ent;
 }
 
+//////////////////////////////////////////////////
+std::vector<Entity> SdfEntityCreator::CreateEntities(
+    const std::vector<const sdf::Model *> &_models)
+{
+  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Model batch)");
+
+  std::vector<Entity> result;
+  result.reserve(_models.size());
+
+  // Not worth the bundles
+  if (nullptr == this->dataPtr->workerPool || _models.size() < 2)
+  {
+    for (const auto *model : _models)
+      result.push_back(this->CreateEntities(model));
+    return result;
+  }
+
+  // Convert each model to a bundle, in parallel. Nothing touches the ECM.
+  std::vector<SdfEntityCreatorPrivate::EntityBundle> bundles(_models.size());
+  RunParallelTasks(this->dataPtr->workerPool, this->dataPtr->workerThreads,
+      _models.size(), [&](std::size_t _index)
+      {
+        auto &bundle = bundles[_index];
+
+        SdfEntityCreator worker(*this->dataPtr->ecm,
+            *this->dataPtr->eventManager);
+        worker.dataPtr->bundle = &bundle;
+        bundle.root = worker.CreateEntities(_models[_index], true, false);
+
+        bundle.newModels = std::move(worker.dataPtr->newModels);
+        bundle.newSensors = std::move(worker.dataPtr->newSensors);
+        bundle.newVisuals = std::move(worker.dataPtr->newVisuals);
+      });
+
+  // Add bundles in order, so entity ids don't depend on which thread
+  // finished first
+  std::vector<std::vector<Entity>> bundleEntities(bundles.size());
+  this->dataPtr->ecm->BeginBatch();
+  for (std::size_t i = 0; i < bundles.size(); ++i)
+  {
+    auto &bundle = bundles[i];
+    auto &entities = bundleEntities[i];
+
+    entities.reserve(bundle.entries.size());
+    for (std::size_t e = 0; e < bundle.entries.size(); ++e)
+      entities.push_back(this->dataPtr->ecm->CreateEntity());
+
+    for (std::size_t e = 0; e < bundle.entries.size(); ++e)
+    {
+      for (const auto &createComponent : bundle.entries[e].components)
+        createComponent(*this->dataPtr->ecm, entities[e]);
+
+      if (bundle.entries[e].parent)
+        this->SetParent(entities[e], entities[*bundle.entries[e].parent]);
+    }
+
+    result.push_back(entities[bundle.root]);
+  }
+  this->dataPtr->ecm->EndBatch();
+
+  // Load plugins in the same order as CreateEntities(const sdf::Model *),
+  // once all entities exist
+  auto loadPlugins = [&](const std::map<Entity, sdf::ElementPtr> &_elements,
+      const std::vector<Entity> &_entities)
+  {
+    for (const auto &[index, element] : _elements)
+    {
+      this->dataPtr->eventManager->Emit<events::LoadPlugins>(
+          _entities[index], element);
+    }
+  };
+
+  for (std::size_t i = 0; i < bundles.size(); ++i)
+  {
+    loadPlugins(bundles[i].newModels, bundleEntities[i]);
+    loadPlugins(bundles[i].newSensors, bundleEntities[i]);
+    loadPlugins(bundles[i].newVisuals, bundleEntities[i]);
+  }
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+void SdfEntityCreator::SetWorkerPool(common::WorkerPool *_pool,
+    unsigned int _threads)
+{
+  this->dataPtr->workerPool = _pool;
+  this->dataPtr->workerThreads = _threads;
+}
+
 //////////////////////////////////////////////////
 Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
     bool _createCanonicalLink, bool _staticParent)
 {
   // Entity
-  Entity modelEntity = this->dataPtr->ecm->CreateEntity();
+  Entity modelEntity = this->dataPtr->NewEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(modelEntity, components::Model());
-  this->dataPtr->ecm->CreateComponent(modelEntity,
+  this->dataPtr->AddComponent(modelEntity, components::Model());
+  this->dataPtr->AddComponent(modelEntity,
       components::Pose(ResolveSdfPose(_model->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(modelEntity,
+  this->dataPtr->AddComponent(modelEntity,
       components::Name(_model->Name()));
   bool isStatic = _model->Static() || _staticParent;
-  this->dataPtr->ecm->CreateComponent(modelEntity,
+  this->dataPtr->AddComponent(modelEntity,
       components::Static(isStatic));
-  this->dataPtr->ecm->CreateComponent(
+  this->dataPtr->AddComponent(
       modelEntity, components::WindMode(_model->EnableWind()));
-  this->dataPtr->ecm->CreateComponent(
+  this->dataPtr->AddComponent(
       modelEntity, components::SelfCollide(_model->SelfCollide()));
-  this->dataPtr->ecm->CreateComponent(
+  this->dataPtr->AddComponent(
       modelEntity, components::SourceFilePath(_model->Element()->FilePath()));
 
   // NOTE: Pose components of links, visuals, and collisions are expressed in
@@ -304,15 +502,15 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
         ((_model->CanonicalLinkName().empty() && linkIndex == 0) ||
         (link == _model->CanonicalLink())))
     {
-      this->dataPtr->ecm->CreateComponent(linkEntity,
+      this->dataPtr->AddComponent(linkEntity,
           components::CanonicalLink());
       canonicalLinkCreated = true;
     }
 
     // Set wind mode if the link didn't override it
-    if (!this->dataPtr->ecm->Component<components::WindMode>(linkEntity))
+    if (!this->dataPtr->HasComponent<components::WindMode>(linkEntity))
     {
-      this->dataPtr->ecm->CreateComponent(
+      this->dataPtr->AddComponent(
           linkEntity, components::WindMode(_model->EnableWind()));
     }
   }
@@ -344,7 +542,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
   }
 
   // Store the model's SDF DOM to be used when saving the world to file
-  this->dataPtr->ecm->CreateComponent(
+  this->dataPtr->AddComponent(
       modelEntity, components::ModelSdf(*_model));
 
   // Keep track of models so we can load their plugins after loading the entire
@@ -360,13 +558,13 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Actor *_actor)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Actor)");
 
   // Entity
-  Entity actorEntity = this->dataPtr->ecm->CreateEntity();
+  Entity actorEntity = this->dataPtr->NewEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(actorEntity, components::Actor(*_actor));
-  this->dataPtr->ecm->CreateComponent(actorEntity,
+  this->dataPtr->AddComponent(actorEntity, components::Actor(*_actor));
+  this->dataPtr->AddComponent(actorEntity,
       components::Pose(_actor->RawPose()));
-  this->dataPtr->ecm->CreateComponent(actorEntity,
+  this->dataPtr->AddComponent(actorEntity,
       components::Name(_actor->Name()));
 
   // Actor plugins
@@ -382,13 +580,13 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Light *_light)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Light)");
 
   // Entity
-  Entity lightEntity = this->dataPtr->ecm->CreateEntity();
+  Entity lightEntity = this->dataPtr->NewEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(lightEntity, components::Light(*_light));
-  this->dataPtr->ecm->CreateComponent(lightEntity,
+  this->dataPtr->AddComponent(lightEntity, components::Light(*_light));
+  this->dataPtr->AddComponent(lightEntity,
       components::Pose(ResolveSdfPose(_light->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(lightEntity,
+  this->dataPtr->AddComponent(lightEntity,
       components::Name(_light->Name()));
 
   return lightEntity;
@@ -400,21 +598,21 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Link *_link)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Link)");
 
   // Entity
-  Entity linkEntity = this->dataPtr->ecm->CreateEntity();
+  Entity linkEntity = this->dataPtr->NewEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(linkEntity, components::Link());
+  this->dataPtr->AddComponent(linkEntity, components::Link());
 
-  this->dataPtr->ecm->CreateComponent(linkEntity,
+  this->dataPtr->AddComponent(linkEntity,
       components::Pose(ResolveSdfPose(_link->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(linkEntity,
+  this->dataPtr->AddComponent(linkEntity,
       components::Name(_link->Name()));
-  this->dataPtr->ecm->CreateComponent(linkEntity,
+  this->dataPtr->AddComponent(linkEntity,
       components::Inertial(_link->Inertial()));
 
   if (_link->EnableWind())
   {
-    this->dataPtr->ecm->CreateComponent(
+    this->dataPtr->AddComponent(
         linkEntity, components::WindMode(_link->EnableWind()));
   }
 
@@ -467,35 +665,35 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Joint)");
 
   // Entity
-  Entity jointEntity = this->dataPtr->ecm->CreateEntity();
+  Entity jointEntity = this->dataPtr->NewEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(jointEntity,
+  this->dataPtr->AddComponent(jointEntity,
       components::Joint());
-  this->dataPtr->ecm->CreateComponent(jointEntity,
+  this->dataPtr->AddComponent(jointEntity,
       components::JointType(_joint->Type()));
 
   if (_joint->Axis(0))
   {
-    this->dataPtr->ecm->CreateComponent(jointEntity,
+    this->dataPtr->AddComponent(jointEntity,
         components::JointAxis(*_joint->Axis(0)));
   }
 
   if (_joint->Axis(1))
   {
-    this->dataPtr->ecm->CreateComponent(jointEntity,
+    this->dataPtr->AddComponent(jointEntity,
         components::JointAxis2(*_joint->Axis(1)));
   }
 
-  this->dataPtr->ecm->CreateComponent(jointEntity,
+  this->dataPtr->AddComponent(jointEntity,
       components::Pose(ResolveSdfPose(_joint->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(jointEntity ,
+  this->dataPtr->AddComponent(jointEntity ,
       components::Name(_joint->Name()));
-  this->dataPtr->ecm->CreateComponent(jointEntity ,
+  this->dataPtr->AddComponent(jointEntity ,
       components::ThreadPitch(_joint->ThreadPitch()));
-  this->dataPtr->ecm->CreateComponent(jointEntity,
+  this->dataPtr->AddComponent(jointEntity,
       components::ParentLinkName(_joint->ParentLinkName()));
-  this->dataPtr->ecm->CreateComponent(jointEntity,
+  this->dataPtr->AddComponent(jointEntity,
       components::ChildLinkName(_joint->ChildLinkName()));
 
   return jointEntity;
@@ -507,37 +705,37 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Visual *_visual)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Visual)");
 
   // Entity
-  Entity visualEntity = this->dataPtr->ecm->CreateEntity();
+  Entity visualEntity = this->dataPtr->NewEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(visualEntity, components::Visual());
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  this->dataPtr->AddComponent(visualEntity, components::Visual());
+  this->dataPtr->AddComponent(visualEntity,
       components::Pose(ResolveSdfPose(_visual->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  this->dataPtr->AddComponent(visualEntity,
       components::Name(_visual->Name()));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  this->dataPtr->AddComponent(visualEntity,
       components::CastShadows(_visual->CastShadows()));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  this->dataPtr->AddComponent(visualEntity,
       components::Transparency(_visual->Transparency()));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  this->dataPtr->AddComponent(visualEntity,
       components::VisibilityFlags(_visual->VisibilityFlags()));
 
   if (_visual->HasLaserRetro())
   {
-    this->dataPtr->ecm->CreateComponent(visualEntity,
+    this->dataPtr->AddComponent(visualEntity,
         components::LaserRetro(_visual->LaserRetro()));
   }
 
   if (_visual->Geom())
   {
-    this->dataPtr->ecm->CreateComponent(visualEntity,
+    this->dataPtr->AddComponent(visualEntity,
         components::Geometry(*_visual->Geom()));
   }
 
   // \todo(louise) Populate with default material if undefined
   if (_visual->Material())
   {
-    this->dataPtr->ecm->CreateComponent(visualEntity,
+    this->dataPtr->AddComponent(visualEntity,
         components::Material(*_visual->Material()));
   }
 
@@ -554,23 +752,23 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Collision *_collision)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Collision)");
 
   // Entity
-  Entity collisionEntity = this->dataPtr->ecm->CreateEntity();
+  Entity collisionEntity = this->dataPtr->NewEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
+  this->dataPtr->AddComponent(collisionEntity,
       components::Collision());
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
+  this->dataPtr->AddComponent(collisionEntity,
       components::Pose(ResolveSdfPose(_collision->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
+  this->dataPtr->AddComponent(collisionEntity,
       components::Name(_collision->Name()));
 
   if (_collision->Geom())
   {
-    this->dataPtr->ecm->CreateComponent(collisionEntity,
+    this->dataPtr->AddComponent(collisionEntity,
         components::Geometry(*_collision->Geom()));
   }
 
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
+  this->dataPtr->AddComponent(collisionEntity,
       components::CollisionElement(*_collision));
 
   return collisionEntity;
@@ -582,107 +780,107 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Sensor *_sensor)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Sensor)");
 
   // Entity
-  Entity sensorEntity = this->dataPtr->ecm->CreateEntity();
+  Entity sensorEntity = this->dataPtr->NewEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(sensorEntity,
+  this->dataPtr->AddComponent(sensorEntity,
       components::Sensor());
-  this->dataPtr->ecm->CreateComponent(sensorEntity,
+  this->dataPtr->AddComponent(sensorEntity,
       components::Pose(ResolveSdfPose(_sensor->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(sensorEntity,
+  this->dataPtr->AddComponent(sensorEntity,
       components::Name(_sensor->Name()));
 
   if (_sensor->Type() == sdf::SensorType::CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::Camera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::GPU_LIDAR)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::GpuLidar(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::LIDAR)
   {
     // \todo(anyone) Implement CPU-base lidar
-    // this->dataPtr->ecm->CreateComponent(sensorEntity,
+    // this->dataPtr->AddComponent(sensorEntity,
     //     components::Lidar(*_sensor));
     ignwarn << "Sensor type LIDAR not supported yet. Try using"
       << "a GPU LIDAR instead." << std::endl;
   }
   else if (_sensor->Type() == sdf::SensorType::DEPTH_CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::DepthCamera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::RGBD_CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::RgbdCamera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::THERMAL_CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::ThermalCamera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::AIR_PRESSURE)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::AirPressureSensor(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::WorldPose(math::Pose3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::ALTIMETER)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::Altimeter(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::WorldPose(math::Pose3d::Zero));
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::WorldLinearVelocity(math::Vector3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::IMU)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
             components::Imu(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
             components::WorldPose(math::Pose3d::Zero));
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
             components::AngularVelocity(math::Vector3d::Zero));
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
             components::LinearAcceleration(math::Vector3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::LOGICAL_CAMERA)
   {
     auto elem = _sensor->Element();
 
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::LogicalCamera(elem));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::WorldPose(math::Pose3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::MAGNETOMETER)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::Magnetometer(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
         components::WorldPose(math::Pose3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::CONTACT)
   {
     auto elem = _sensor->Element();
 
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->AddComponent(sensorEntity,
             components::ContactSensor(elem));
     // We will let the contact system create the necessary components for
     // physics to populate.
@@ -721,6 +919,13 @@ void SdfEntityCreator::RequestRemoveEntity(Entity _entity, bool _recursive)
 //////////////////////////////////////////////////
 void SdfEntityCreator::SetParent(Entity _child, Entity _parent)
 {
+  // Bundles are parented once they're added to the ECM
+  if (nullptr != this->dataPtr->bundle)
+  {
+    this->dataPtr->bundle->entries[_child].parent = _parent;
+    return;
+  }
+
   // TODO(louise) Figure out a way to avoid duplication while keeping all
   // state in components and also keeping a convenient graph in the ECM
   this->dataPtr->ecm->SetParentEntity(_child, _parent);
@@ -16,7 +16,11 @@
 */
 
 #include <gtest/gtest.h>
+
+#include <vector>
+
 #include <ignition/common/Console.hh>
+#include <ignition/common/WorkerPool.hh>
 #include <sdf/Box.hh>
 #include <sdf/Cylinder.hh>
 #include <sdf/Joint.hh>
@@ -1134,3 +1138,60 @@ TEST_F(SdfEntityCreatorTest, EachRemovedRecursiveRemoved)
   EXPECT_EQ(0u, removedCount<components::Visual>(ecm));
 }
 
+
+/////////////////////////////////////////////////
+TEST_F(SdfEntityCreatorTest, CreateModelsInParallel)
+{
+  sdf::Root root;
+  root.Load(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+  ASSERT_EQ(1u, root.WorldCount());
+  const auto *world = root.WorldByIndex(0);
+
+  std::vector<const sdf::Model *> models;
+  for (uint64_t i = 0; i < world->ModelCount(); ++i)
+    models.push_back(world->ModelByIndex(i));
+  ASSERT_LT(1u, models.size());
+
+  // One model at a time
+  EntityCompMgrTest serialEcm;
+  SdfEntityCreator serialCreator(serialEcm, this->evm);
+  std::vector<Entity> serialEntities;
+  for (const auto *model : models)
+    serialEntities.push_back(serialCreator.CreateEntities(model));
+
+  // All models at once, converted in parallel
+  common::WorkerPool pool;
+  SdfEntityCreator creator(this->ecm, this->evm);
+  creator.SetWorkerPool(&pool);
+  auto entities = creator.CreateEntities(models);
+
+  // Same entities, with the same ids and components
+  EXPECT_EQ(serialEntities, entities);
+  EXPECT_EQ(serialEcm.EntityCount(), this->ecm.EntityCount());
+
+  serialEcm.Each<components::Name>(
+      [&](const Entity &_entity, const components::Name *_name) -> bool
+      {
+        auto name = this->ecm.Component<components::Name>(_entity);
+        EXPECT_NE(nullptr, name);
+        if (name)
+          EXPECT_EQ(_name->Data(), name->Data());
+
+        EXPECT_EQ(serialEcm.ComponentTypes(_entity),
+            this->ecm.ComponentTypes(_entity));
+        EXPECT_EQ(serialEcm.ParentEntity(_entity),
+            this->ecm.ParentEntity(_entity));
+        return true;
+      });
+
+  // Canonical links are only created once per model
+  std::size_t canonicalLinks{0};
+  this->ecm.Each<components::CanonicalLink>(
+      [&](const Entity &, const components::CanonicalLink *) -> bool
+      {
+        ++canonicalLinks;
+        return true;
+      });
+  EXPECT_EQ(models.size(), canonicalLinks);
+}
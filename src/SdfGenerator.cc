@@ -18,6 +18,8 @@
 #include "SdfGenerator.hh"
 
 #include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <sdf/sdf.hh>
@@ -43,23 +45,6 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
 {
 namespace sdf_generator
 {
-  /////////////////////////////////////////////////
-  /// \brief Copy sdf::Element from component
-  /// \param[in] _comp Component containing an sdf::Element. The component has
-  /// to be a DOM object
-  /// \param[out] _elem Output sdf::Element
-  /// \returns False if the component is nullptr
-  template <typename ComponentT>
-  static bool copySdf(ComponentT *_comp, const sdf::ElementPtr &_elem)
-  {
-    if (nullptr != _comp)
-    {
-      _elem->Copy(_comp->Data().Element());
-      return true;
-    }
-    return false;
-  }
-
   /////////////////////////////////////////////////
   /// \brief Remove version number from Fuel URI
   /// \param[in, out] _uri The URI from which the version number is removed.
@@ -244,38 +229,35 @@ namespace sdf_generator
   }
 
   /////////////////////////////////////////////////
-  std::optional<std::string> generateWorld(
-      const EntityComponentManager &_ecm, const Entity &_entity,
-      const IncludeUriMap &_includeUriMap,
-      const msgs::SdfGeneratorConfig &_config)
+  /// \brief Set the pose of an element, removing its attributes.
+  /// \param[in] _elem Element containing a <pose>
+  /// \param[in] _pose New pose
+  static void setPose(const sdf::ElementPtr &_elem, const math::Pose3d &_pose)
   {
-    sdf::ElementPtr elem = std::make_shared<sdf::Element>();
-    sdf::initFile("root.sdf", elem);
-    auto worldElem = elem->AddElement("world");
-    if (!updateWorldElement(worldElem, _ecm, _entity, _includeUriMap, _config))
-      return std::nullopt;
+    auto poseElem = _elem->GetElement("pose");
 
-    return elem->ToString("");
+    // Remove all attributes of poseElem
+    sdf::ParamPtr relativeTo = poseElem->GetAttribute("relative_to");
+    if (nullptr != relativeTo)
+    {
+      relativeTo->Reset();
+    }
+    poseElem->Set(_pose);
   }
 
   /////////////////////////////////////////////////
-  bool updateWorldElement(sdf::ElementPtr _elem,
-                          const EntityComponentManager &_ecm,
-                          const Entity &_entity,
-                          const IncludeUriMap &_includeUriMap,
-                          const msgs::SdfGeneratorConfig &_config)
+  /// \brief Copy a world element without its models, which are added back
+  /// from the ECM.
+  /// \param[in] _source Element the world was loaded from
+  /// \param[out] _elem Output sdf::Element
+  static void copyWorldWithoutModels(const sdf::ElementPtr &_source,
+                                     const sdf::ElementPtr &_elem)
   {
-    const auto *worldSdf = _ecm.Component<components::WorldSdf>(_entity);
+    _elem->Copy(_source);
 
-    if (nullptr == worldSdf)
-      return false;
-
-    if (!copySdf(_ecm.Component<components::WorldSdf>(_entity), _elem))
-      return false;
-
-    // First remove child entities of <world> whose names can be changed during
-    // simulation (eg. models). Then we add them back from the data in the
-    // ECM.
+    // First remove child entities of <world> whose names can be changed
+    // during simulation (eg. models). Then we add them back from the data in
+    // the ECM.
     // TODO(addisu) Remove actors and lights
     std::vector<sdf::ElementPtr> toRemove;
     if (_elem->HasElement("model"))
@@ -290,12 +272,49 @@ namespace sdf_generator
     {
       _elem->RemoveChild(e);
     }
+  }
+
+  /////////////////////////////////////////////////
+  ModelSnapshot snapshotModel(const EntityComponentManager &_ecm,
+                              const Entity &_entity)
+  {
+    ModelSnapshot snapshot;
+    snapshot.entity = _entity;
+
+    auto *modelSdf = _ecm.Component<components::ModelSdf>(_entity);
+    if (nullptr != modelSdf)
+      snapshot.sdf = modelSdf->Data().Element();
+
+    auto *nameComp = _ecm.Component<components::Name>(_entity);
+    if (nullptr != nameComp)
+      snapshot.name = nameComp->Data();
+
+    auto *poseComp = _ecm.Component<components::Pose>(_entity);
+    if (nullptr != poseComp)
+      snapshot.pose = poseComp->Data();
+
+    auto *pathComp = _ecm.Component<components::SourceFilePath>(_entity);
+    if (nullptr != pathComp)
+      snapshot.sourceFilePath = pathComp->Data();
+
+    snapshot.scopedName = scopedName(_entity, _ecm, "::", false);
+    return snapshot;
+  }
 
-    auto worldDir = common::parentPath(worldSdf->Data().Element()->FilePath());
+  /////////////////////////////////////////////////
+  WorldSnapshot snapshotWorld(const EntityComponentManager &_ecm,
+                              const Entity &_entity)
+  {
+    WorldSnapshot snapshot;
+
+    const auto *worldSdf = _ecm.Component<components::WorldSdf>(_entity);
+    if (nullptr == worldSdf)
+      return snapshot;
+    snapshot.sdf = worldSdf->Data().Element();
 
     _ecm.Each<components::Model, components::ModelSdf>(
         [&](const Entity &_modelEntity, const components::Model *,
-            const components::ModelSdf *_modelSdf)
+            const components::ModelSdf *)
         {
           // skip nested models as they are not direct children of world
           auto parentComp = _ecm.Component<components::ParentEntity>(
@@ -303,80 +322,192 @@ namespace sdf_generator
           if (parentComp && parentComp->Data() != _entity)
             return true;
 
-          auto modelDir =
-              common::parentPath(_modelSdf->Data().Element()->FilePath());
-          const std::string modelName =
-              scopedName(_modelEntity, _ecm, "::", false);
-
-          bool modelFromInclude = isModelFromInclude(modelDir, worldDir);
-
-          auto uriMapIt = _includeUriMap.find(modelDir);
-
-          auto modelConfig = _config.global_entity_gen_config();
-          auto modelConfigIt =
-              _config.override_entity_gen_configs().find(modelName);
-          if (modelConfigIt != _config.override_entity_gen_configs().end())
-          {
-            mergeWithOverride(modelConfig, modelConfigIt->second);
-          }
-
-          if (modelConfig.expand_include_tags().data() || !modelFromInclude)
-          {
-            auto modelElem = _elem->AddElement("model");
-            updateModelElement(modelElem, _ecm, _modelEntity);
-          }
-          else if (uriMapIt != _includeUriMap.end())
-          {
-            // The fuel URI might have a version number. If it does, we remove
-            // it unless saveFuelModelVersion is set to true.
-            // Check if this is a fuel URI. We assume that it is a fuel URI if
-            // the scheme is http or https.
-            common::URI uri(uriMapIt->second);
-            if (uri.Scheme() == "http" || uri.Scheme() == "https")
-            {
-              removeVersionFromUri(uri);
-            }
-
-            if (modelConfig.save_fuel_version().data())
-            {
-              // Find out the model version from the file path. Note that we
-              // do this from the file path instead of the Fuel URI because the
-              // URI may not contain version information.
-              //
-              // We are assuming here that, for Fuel models, the directory
-              // containing the sdf file has the same name as the model version.
-              // For example, if the uri is
-              // https://example.org/1.0/test/models/Backpack
-              // the path to the directory containing the sdf file (modelDir)
-              // will be:
-              // $HOME/.ignition/fuel/example.org/test/models/Backpack/2/
-              // and the basename of the directory is "1", which is the model
-              // version.
-              //
-              // However, if symlinks (or other types of indirection) are used,
-              // the pattern of modelDir will be different. The assumption here
-              // is that regardless of the indirection, the name of the
-              // directory containing the sdf file can be used as the version
-              // number
-              //
-              uri.Path() /= common::basename(modelDir);
-            }
-
-            auto includeElem = _elem->AddElement("include");
-            updateIncludeElement(includeElem, _ecm, _modelEntity, uri.Str());
-          }
-          else
-          {
-            // The model is not in the includeUriMap, but expandIncludeTags =
-            // false, so we will assume that its uri is the file path of the
-            // model on the local machine
-            auto includeElem = _elem->AddElement("include");
-            const std::string uri = "file://" + modelDir;
-            updateIncludeElement(includeElem, _ecm, _modelEntity, uri);
-          }
+          snapshot.models.push_back(snapshotModel(_ecm, _modelEntity));
           return true;
         });
 
+    return snapshot;
+  }
+
+  /////////////////////////////////////////////////
+  std::optional<std::string> generateWorld(
+      const EntityComponentManager &_ecm, const Entity &_entity,
+      const IncludeUriMap &_includeUriMap,
+      const msgs::SdfGeneratorConfig &_config)
+  {
+    return generateWorld(snapshotWorld(_ecm, _entity), _includeUriMap,
+        _config);
+  }
+
+  /////////////////////////////////////////////////
+  std::optional<std::string> generateWorld(
+      const WorldSnapshot &_snapshot,
+      const IncludeUriMap &_includeUriMap,
+      const msgs::SdfGeneratorConfig &_config,
+      ElementCache *_cache)
+  {
+    std::unique_lock<std::mutex> lock;
+    if (nullptr != _cache)
+      lock = std::unique_lock<std::mutex>(_cache->mutex);
+
+    sdf::ElementPtr elem = std::make_shared<sdf::Element>();
+    sdf::initFile("root.sdf", elem);
+    auto worldElem = elem->AddElement("world");
+    if (!updateWorldElement(worldElem, _snapshot, _includeUriMap, _config,
+        _cache))
+    {
+      return std::nullopt;
+    }
+
+    return elem->ToString("");
+  }
+
+  /////////////////////////////////////////////////
+  bool updateWorldElement(sdf::ElementPtr _elem,
+                          const EntityComponentManager &_ecm,
+                          const Entity &_entity,
+                          const IncludeUriMap &_includeUriMap,
+                          const msgs::SdfGeneratorConfig &_config)
+  {
+    return updateWorldElement(_elem, snapshotWorld(_ecm, _entity),
+        _includeUriMap, _config);
+  }
+
+  /////////////////////////////////////////////////
+  bool updateWorldElement(sdf::ElementPtr _elem,
+                          const WorldSnapshot &_snapshot,
+                          const IncludeUriMap &_includeUriMap,
+                          const msgs::SdfGeneratorConfig &_config,
+                          ElementCache *_cache)
+  {
+    if (nullptr == _snapshot.sdf)
+      return false;
+
+    if (nullptr == _cache)
+    {
+      copyWorldWithoutModels(_snapshot.sdf, _elem);
+    }
+    else
+    {
+      // Copying the cached world is cheap since it has no models
+      if (_cache->worldSource != _snapshot.sdf || nullptr == _cache->world)
+      {
+        _cache->world = std::make_shared<sdf::Element>();
+        copyWorldWithoutModels(_snapshot.sdf, _cache->world);
+        _cache->worldSource = _snapshot.sdf;
+      }
+      _elem->Copy(_cache->world);
+    }
+
+    auto worldDir = common::parentPath(_snapshot.sdf->FilePath());
+
+    std::unordered_map<Entity, ElementCache::Model> cachedModels;
+
+    for (const auto &model : _snapshot.models)
+    {
+      if (nullptr == model.sdf)
+        continue;
+
+      auto modelDir = common::parentPath(model.sdf->FilePath());
+
+      bool modelFromInclude = isModelFromInclude(modelDir, worldDir);
+
+      auto uriMapIt = _includeUriMap.find(modelDir);
+
+      auto modelConfig = _config.global_entity_gen_config();
+      auto modelConfigIt =
+          _config.override_entity_gen_configs().find(model.scopedName);
+      if (modelConfigIt != _config.override_entity_gen_configs().end())
+      {
+        mergeWithOverride(modelConfig, modelConfigIt->second);
+      }
+
+      if (modelConfig.expand_include_tags().data() || !modelFromInclude)
+      {
+        if (nullptr == _cache)
+        {
+          auto modelElem = _elem->AddElement("model");
+          updateModelElement(modelElem, model);
+          continue;
+        }
+
+        // Reuse the element generated last time, unless the model now comes
+        // from a different element
+        auto cachedIt = _cache->models.find(model.entity);
+        if (cachedIt != _cache->models.end() &&
+            cachedIt->second.source == model.sdf &&
+            cachedIt->second.sourceFilePath == model.sourceFilePath)
+        {
+          auto &modelElem = cachedIt->second.elem;
+          modelElem->SetParent(_elem);
+          _elem->InsertElement(modelElem);
+          modelElem->GetAttribute("name")->Set(model.name);
+          setPose(modelElem, model.pose);
+          cachedModels[model.entity] = std::move(cachedIt->second);
+        }
+        else
+        {
+          auto modelElem = _elem->AddElement("model");
+          updateModelElement(modelElem, model);
+          cachedModels[model.entity] =
+              {model.sdf, model.sourceFilePath, modelElem};
+        }
+      }
+      else if (uriMapIt != _includeUriMap.end())
+      {
+        // The fuel URI might have a version number. If it does, we remove
+        // it unless saveFuelModelVersion is set to true.
+        // Check if this is a fuel URI. We assume that it is a fuel URI if
+        // the scheme is http or https.
+        common::URI uri(uriMapIt->second);
+        if (uri.Scheme() == "http" || uri.Scheme() == "https")
+        {
+          removeVersionFromUri(uri);
+        }
+
+        if (modelConfig.save_fuel_version().data())
+        {
+          // Find out the model version from the file path. Note that we
+          // do this from the file path instead of the Fuel URI because the
+          // URI may not contain version information.
+          //
+          // We are assuming here that, for Fuel models, the directory
+          // containing the sdf file has the same name as the model version.
+          // For example, if the uri is
+          // https://example.org/1.0/test/models/Backpack
+          // the path to the directory containing the sdf file (modelDir)
+          // will be:
+          // $HOME/.ignition/fuel/example.org/test/models/Backpack/2/
+          // and the basename of the directory is "1", which is the model
+          // version.
+          //
+          // However, if symlinks (or other types of indirection) are used,
+          // the pattern of modelDir will be different. The assumption here
+          // is that regardless of the indirection, the name of the
+          // directory containing the sdf file can be used as the version
+          // number
+          //
+          uri.Path() /= common::basename(modelDir);
+        }
+
+        auto includeElem = _elem->AddElement("include");
+        updateIncludeElement(includeElem, model, uri.Str());
+      }
+      else
+      {
+        // The model is not in the includeUriMap, but expandIncludeTags =
+        // false, so we will assume that its uri is the file path of the
+        // model on the local machine
+        auto includeElem = _elem->AddElement("include");
+        const std::string uri = "file://" + modelDir;
+        updateIncludeElement(includeElem, model, uri);
+      }
+    }
+
+    // Models which were removed or aren't expanded anymore are dropped
+    if (nullptr != _cache)
+      _cache->models = std::move(cachedModels);
+
     return true;
   }
 
@@ -385,39 +516,34 @@ namespace sdf_generator
                           const EntityComponentManager &_ecm,
                           const Entity &_entity)
   {
-    if (!copySdf(_ecm.Component<components::ModelSdf>(_entity), _elem))
+    return updateModelElement(_elem, snapshotModel(_ecm, _entity));
+  }
+
+  /////////////////////////////////////////////////
+  bool updateModelElement(const sdf::ElementPtr &_elem,
+                          const ModelSnapshot &_snapshot)
+  {
+    if (nullptr == _snapshot.sdf)
       return false;
 
+    _elem->Copy(_snapshot.sdf);
+
     // Update sdf based current components. Here are the list of components to
     // be updated:
     // - Name
     // - Pose
     // This list is to be updated as other components become updateable during
     // simulation
-    auto *nameComp = _ecm.Component<components::Name>(_entity);
-    _elem->GetAttribute("name")->Set(nameComp->Data());
-
-    auto *poseComp = _ecm.Component<components::Pose>(_entity);
-
-    auto poseElem = _elem->GetElement("pose");
-
-    // Remove all attributes of poseElem
-    sdf::ParamPtr relativeTo = poseElem->GetAttribute("relative_to");
-    if (nullptr != relativeTo)
-    {
-      relativeTo->Reset();
-    }
-    poseElem->Set(poseComp->Data());
-
-    const auto *pathComp =
-      _ecm.Component<components::SourceFilePath>(_entity);
+    _elem->GetAttribute("name")->Set(_snapshot.name);
+    setPose(_elem, _snapshot.pose);
 
-    if (_elem->HasElement("link") && nullptr != pathComp)
+    if (_elem->HasElement("link") && !_snapshot.sourceFilePath.empty())
     {
       // Update relative URIs to use absolute paths. Relative URIs work fine in
       // included models, but they have to be converted to absolute URIs when
       // the included model is expanded.
-      relativeToAbsoluteUri(_elem, common::parentPath(pathComp->Data()));
+      relativeToAbsoluteUri(_elem,
+          common::parentPath(_snapshot.sourceFilePath));
     }
     return true;
   }
@@ -427,22 +553,17 @@ namespace sdf_generator
                             const EntityComponentManager &_ecm,
                             const Entity &_entity, const std::string &_uri)
   {
-    _elem->GetElement("uri")->Set(_uri);
-
-    auto *nameComp = _ecm.Component<components::Name>(_entity);
-    _elem->GetElement("name")->Set(nameComp->Data());
-
-    auto *poseComp = _ecm.Component<components::Pose>(_entity);
-
-    auto poseElem = _elem->GetElement("pose");
+    return updateIncludeElement(_elem, snapshotModel(_ecm, _entity), _uri);
+  }
 
-    // Remove all attributes of poseElem
-    sdf::ParamPtr relativeTo = poseElem->GetAttribute("relative_to");
-    if (nullptr != relativeTo)
-    {
-      relativeTo->Reset();
-    }
-    poseElem->Set(poseComp->Data());
+  /////////////////////////////////////////////////
+  bool updateIncludeElement(const sdf::ElementPtr &_elem,
+                            const ModelSnapshot &_snapshot,
+                            const std::string &_uri)
+  {
+    _elem->GetElement("uri")->Set(_uri);
+    _elem->GetElement("name")->Set(_snapshot.name);
+    setPose(_elem, _snapshot.pose);
     return true;
   }
 }
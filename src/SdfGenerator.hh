@@ -20,8 +20,13 @@
 #include <ignition/msgs/sdf_generator_config.pb.h>
 
 #include <sdf/Element.hh>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
 
 #include "ignition/gazebo/EntityComponentManager.hh"
 
@@ -36,6 +41,88 @@ namespace sdf_generator
 {
   using IncludeUriMap = std::unordered_map<std::string, std::string>;
 
+  /// \brief Data from the ECM needed to generate a top level model.
+  struct ModelSnapshot
+  {
+    /// \brief Model entity
+    Entity entity{kNullEntity};
+
+    /// \brief Name of the model
+    std::string name;
+
+    /// \brief Scoped name, used to look up per model configurations
+    std::string scopedName;
+
+    /// \brief Pose of the model
+    math::Pose3d pose;
+
+    /// \brief Element the model was loaded from. Null if the entity doesn't
+    /// have a ModelSdf component.
+    sdf::ElementPtr sdf;
+
+    /// \brief Value of the SourceFilePath component, empty if there's none
+    std::string sourceFilePath;
+  };
+
+  /// \brief Data from the ECM needed to generate a world. Taking it only
+  /// copies names and poses, so it can be done on the simulation thread and
+  /// the world generated from it on another thread.
+  struct WorldSnapshot
+  {
+    /// \brief Element the world was loaded from. Null if the entity isn't a
+    /// world.
+    sdf::ElementPtr sdf;
+
+    /// \brief Top level models of the world
+    std::vector<ModelSnapshot> models;
+  };
+
+  /// \brief Elements generated by a previous call to generateWorld, reused
+  /// by the next call. A model element is only copied again when the model
+  /// was loaded from a different element, otherwise just its name and pose
+  /// are refreshed. Calls sharing a cache are serialized through its mutex.
+  struct ElementCache
+  {
+    /// \brief A generated model element
+    struct Model
+    {
+      /// \brief Element the model was generated from
+      sdf::ElementPtr source;
+
+      /// \brief Source file path the URIs were made absolute with
+      std::string sourceFilePath;
+
+      /// \brief Generated element
+      sdf::ElementPtr elem;
+    };
+
+    /// \brief Protects the cache
+    std::mutex mutex;
+
+    /// \brief Element the cached world was generated from
+    sdf::ElementPtr worldSource;
+
+    /// \brief Copy of the world element without its models
+    sdf::ElementPtr world;
+
+    /// \brief Generated model elements, by model entity
+    std::unordered_map<Entity, Model> models;
+  };
+
+  /// \brief Take a snapshot of the data needed to generate a world.
+  /// \input[in] _ecm Immutable reference to the Entity Component Manager
+  /// \input[in] _entity World entity
+  /// \returns The snapshot.
+  WorldSnapshot snapshotWorld(const EntityComponentManager &_ecm,
+                              const Entity &_entity);
+
+  /// \brief Take a snapshot of the data needed to generate a model.
+  /// \input[in] _ecm Immutable reference to the Entity Component Manager
+  /// \input[in] _entity Model entity
+  /// \returns The snapshot.
+  ModelSnapshot snapshotModel(const EntityComponentManager &_ecm,
+                              const Entity &_entity);
+
   /// \brief Generate the SDFormat representation of a world
   /// \input[in] _ecm Immutable reference to the Entity Component Manager
   /// \input[in] _entity World entity
@@ -49,6 +136,20 @@ namespace sdf_generator
       const IncludeUriMap &_includeUriMap = IncludeUriMap(),
       const msgs::SdfGeneratorConfig &_config = msgs::SdfGeneratorConfig());
 
+  /// \brief Generate the SDFormat representation of a world from a snapshot.
+  /// \input[in] _snapshot Snapshot of the world
+  /// \input[in] _includeUriMap Map from file paths to URIs used to preserve
+  /// included Fuel models
+  /// \input[in] _config Configuration for the world generator
+  /// \input[in] _cache Optional cache of previously generated elements
+  /// \returns Generated world string if generation succeeded.
+  /// Otherwise, nullopt
+  std::optional<std::string> generateWorld(
+      const WorldSnapshot &_snapshot,
+      const IncludeUriMap &_includeUriMap = IncludeUriMap(),
+      const msgs::SdfGeneratorConfig &_config = msgs::SdfGeneratorConfig(),
+      ElementCache *_cache = nullptr);
+
   /// \brief Update a sdf::Element of a world. Intended for internal use.
   /// \input[in, out] _elem sdf::Element to update
   /// \input[in] _ecm Immutable reference to the Entity Component Manager
@@ -62,6 +163,22 @@ namespace sdf_generator
       const IncludeUriMap &_includeUriMap = IncludeUriMap(),
       const msgs::SdfGeneratorConfig &_config = msgs::SdfGeneratorConfig());
 
+  /// \brief Update a sdf::Element of a world from a snapshot. Intended for
+  /// internal use.
+  /// \input[in, out] _elem sdf::Element to update
+  /// \input[in] _snapshot Snapshot of the world
+  /// \input[in] _includeUriMap Map from file paths to URIs used to preserve
+  /// included Fuel models
+  /// \input[in] _config Configuration for the world generator
+  /// \input[in] _cache Optional cache of previously generated elements. It
+  /// must be locked by the caller.
+  bool updateWorldElement(
+      sdf::ElementPtr _elem,
+      const WorldSnapshot &_snapshot,
+      const IncludeUriMap &_includeUriMap = IncludeUriMap(),
+      const msgs::SdfGeneratorConfig &_config = msgs::SdfGeneratorConfig(),
+      ElementCache *_cache = nullptr);
+
   /// \brief Update a sdf::Element of an inlined model.
   /// Intended for internal use.
   /// \input[in, out] _elem sdf::Element to update
@@ -72,6 +189,14 @@ namespace sdf_generator
                           const EntityComponentManager &_ecm,
                           const Entity &_entity);
 
+  /// \brief Update a sdf::Element of an inlined model from a snapshot.
+  /// Intended for internal use.
+  /// \input[in, out] _elem sdf::Element to update
+  /// \input[in] _snapshot Snapshot of the model
+  /// \returns true if update succeeded.
+  bool updateModelElement(const sdf::ElementPtr &_elem,
+                          const ModelSnapshot &_snapshot);
+
   /// \brief Update a sdf::Element of an included resource.
   /// Intended for internal use.
   /// \input[in, out] _elem sdf::Element to update
@@ -83,6 +208,16 @@ namespace sdf_generator
                             const EntityComponentManager &_ecm,
                             const Entity &_entity, const std::string &_uri);
 
+  /// \brief Update a sdf::Element of an included resource from a snapshot.
+  /// Intended for internal use.
+  /// \input[in, out] _elem sdf::Element to update
+  /// \input[in] _snapshot Snapshot of the included model
+  /// \input[in] _uri Uri of the resource
+  /// \returns true if update succeeded.
+  bool updateIncludeElement(const sdf::ElementPtr &_elem,
+                            const ModelSnapshot &_snapshot,
+                            const std::string &_uri);
+
 }  // namespace sdf_generator
 }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
 }  // namespace gazebo
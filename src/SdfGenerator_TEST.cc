@@ -875,6 +875,55 @@ TEST_F(GenerateWorldFixture, ModelsInline)
   }
 }
 
+/////////////////////////////////////////////////
+TEST_F(GenerateWorldFixture, Cached)
+{
+  const std::string worldFile{"test/worlds/shapes.sdf"};
+  this->LoadWorld(worldFile);
+  Entity worldEntity = this->ecm.EntityByComponents(components::World());
+  Entity modelEntity = this->ecm.EntityByComponents(
+      components::Model(), components::Name("box"));
+
+  sdf_generator::ElementCache cache;
+  auto worldStr = sdf_generator::generateWorld(
+      sdf_generator::snapshotWorld(this->ecm, worldEntity),
+      this->includeUriMap, this->sdfGenConfig, &cache);
+  ASSERT_TRUE(worldStr.has_value());
+  ASSERT_EQ(1u, cache.models.count(modelEntity));
+  auto cachedElem = cache.models[modelEntity].elem;
+
+  // Same result as without a cache
+  EXPECT_EQ(*sdf_generator::generateWorld(this->ecm, worldEntity,
+      this->includeUriMap, this->sdfGenConfig), *worldStr);
+
+  // The cached element is reused, with the new pose
+  math::Pose3d newPose{0.1, 0.2, 0.3, 0, 0, 0};
+  *this->ecm.Component<components::Pose>(modelEntity) =
+      components::Pose(newPose);
+  worldStr = sdf_generator::generateWorld(
+      sdf_generator::snapshotWorld(this->ecm, worldEntity),
+      this->includeUriMap, this->sdfGenConfig, &cache);
+  ASSERT_TRUE(worldStr.has_value());
+  EXPECT_EQ(cachedElem, cache.models[modelEntity].elem);
+  EXPECT_EQ(newPose, cachedElem->Get<math::Pose3d>("pose"));
+
+  sdf::Root newRoot;
+  newRoot.LoadSdfString(*worldStr);
+  ASSERT_EQ(1u, newRoot.WorldCount());
+  auto *model = newRoot.WorldByIndex(0)->ModelByName("box");
+  ASSERT_NE(nullptr, model);
+  EXPECT_EQ(newPose, model->RawPose());
+
+  // Removed models are dropped from the cache
+  this->ecm.RequestRemoveEntity(modelEntity);
+  this->ecm.ProcessRemoveEntityRequests();
+  worldStr = sdf_generator::generateWorld(
+      sdf_generator::snapshotWorld(this->ecm, worldEntity),
+      this->includeUriMap, this->sdfGenConfig, &cache);
+  ASSERT_TRUE(worldStr.has_value());
+  EXPECT_EQ(0u, cache.models.count(modelEntity));
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int _argc, char **_argv)
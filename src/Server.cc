@@ -15,11 +15,10 @@
  *
 */
 
-#include <ignition/common/SystemPaths.hh>
-#include <ignition/fuel_tools/Interface.hh>
-#include <ignition/fuel_tools/ClientConfig.hh>
+#include <memory>
+#include <utility>
+
 #include <sdf/Root.hh>
-#include <sdf/Error.hh>
 
 #include "ignition/gazebo/config.hh"
 #include "ignition/gazebo/Server.hh"
@@ -31,170 +30,39 @@
 using namespace ignition;
 using namespace gazebo;
 
-//////////////////////////////////////////////////
-// Getting the first .sdf file in the path
-std::string findFuelResourceSdf(const std::string &_path)
-{
-  if (!common::exists(_path))
-    return "";
-
-  for (common::DirIter file(_path); file != common::DirIter(); ++file)
-  {
-    std::string current(*file);
-    if (!common::isFile(current))
-      continue;
-
-    auto fileName = common::basename(current);
-    auto fileExtensionIndex = fileName.rfind(".");
-    auto fileExtension = fileName.substr(fileExtensionIndex + 1);
-
-    if (fileExtension == "sdf")
-    {
-      return current;
-    }
-  }
-  return "";
-}
-
-/// \brief This struct provides access to the default world.
-struct DefaultWorld
-{
-  /// \brief Get the default world as a string.
-  /// Plugins will be loaded from the server.config file.
-  /// \return An SDF string that contains the default world.
-  public: static std::string &World()
-  {
-    static std::string world = std::string("<?xml version='1.0'?>"
-      "<sdf version='1.6'>"
-        "<world name='default'>") +
-        "</world>"
-      "</sdf>";
-
-    return world;
-  }
-};
-
 /////////////////////////////////////////////////
 Server::Server(const ServerConfig &_config)
   : dataPtr(new ServerPrivate)
 {
   this->dataPtr->config = _config;
+  if (this->dataPtr->LoadSdfRoot())
+    this->CreateWorlds();
+}
 
-  // Configure the fuel client
-  fuel_tools::ClientConfig config;
-  if (!_config.ResourceCache().empty())
-    config.SetCacheLocation(_config.ResourceCache());
-  this->dataPtr->fuelClient = std::make_unique<fuel_tools::FuelClient>(config);
-
-  // Configure SDF to fetch assets from ignition fuel.
-  sdf::setFindCallback(std::bind(&ServerPrivate::FetchResource,
-        this->dataPtr.get(), std::placeholders::_1));
-  common::addFindFileURICallback(std::bind(&ServerPrivate::FetchResourceUri,
-      this->dataPtr.get(), std::placeholders::_1));
-
-  addResourcePaths();
-
-  sdf::Errors errors;
-
-  // Load a world if specified. Check SDF string first, then SDF file
-  if (!_config.SdfString().empty())
-  {
-    std::string msg = "Loading SDF string. ";
-    if (_config.SdfFile().empty())
-    {
-      msg += "File path not available.\n";
-    }
-    else
-    {
-      msg += "File path [" + _config.SdfFile() + "].\n";
-    }
-    ignmsg <<  msg;
-    errors = this->dataPtr->sdfRoot.LoadSdfString(_config.SdfString());
-  }
-  else if (!_config.SdfFile().empty())
-  {
-    std::string filePath;
-
-    // Check Fuel if it's a URL
-    auto sdfUri = common::URI(_config.SdfFile());
-    if (sdfUri.Scheme() == "http" || sdfUri.Scheme() == "https")
-    {
-      std::string fuelCachePath;
-      if (this->dataPtr->fuelClient->CachedWorld(common::URI(_config.SdfFile()),
-          fuelCachePath))
-      {
-        filePath = findFuelResourceSdf(fuelCachePath);
-      }
-      else if (auto result = this->dataPtr->fuelClient->DownloadWorld(
-          common::URI(_config.SdfFile()), fuelCachePath))
-      {
-        filePath = findFuelResourceSdf(fuelCachePath);
-      }
-      else
-      {
-        ignwarn << "Fuel couldn't download URL [" << _config.SdfFile()
-                << "], error: [" << result.ReadableResult() << "]"
-                << std::endl;
-      }
-    }
-
-    if (filePath.empty())
-    {
-      common::SystemPaths systemPaths;
-
-      // Worlds from environment variable
-      systemPaths.SetFilePathEnv(kResourcePathEnv);
-
-      // Worlds installed with ign-gazebo
-      systemPaths.AddFilePaths(IGN_GAZEBO_WORLD_INSTALL_DIR);
-
-      filePath = systemPaths.FindFile(_config.SdfFile());
-    }
-
-    if (filePath.empty())
-    {
-      ignerr << "Failed to find world [" << _config.SdfFile() << "]"
-             << std::endl;
-      return;
-    }
-
-    ignmsg << "Loading SDF world file[" << filePath << "].\n";
-
-    // \todo(nkoenig) Async resource download.
-    // This call can block for a long period of time while
-    // resources are downloaded. Blocking here causes the GUI to block with
-    // a black screen (search for "Async resource download" in
-    // 'src/gui_main.cc'.
-    errors = this->dataPtr->sdfRoot.Load(filePath);
-  }
-  else
-  {
-    ignmsg << "Loading default world.\n";
-    // Load an empty world.
-    /// \todo(nkoenig) Add a "AddWorld" function to sdf::Root.
-    errors = this->dataPtr->sdfRoot.LoadSdfString(DefaultWorld::World());
-  }
-
-  if (!errors.empty())
-  {
-    for (auto &err : errors)
-      ignerr << err << "\n";
-    return;
-  }
+/////////////////////////////////////////////////
+Server::Server(std::unique_ptr<ServerPrivate> _dataPtr)
+  : dataPtr(std::move(_dataPtr))
+{
+  this->CreateWorlds();
+}
 
+/////////////////////////////////////////////////
+void Server::CreateWorlds()
+{
   // Add record plugin
-  if (_config.UseLogRecord())
+  if (this->dataPtr->config.UseLogRecord())
   {
-    this->dataPtr->AddRecordPlugin(_config);
+    this->dataPtr->AddRecordPlugin(this->dataPtr->config);
   }
 
   this->dataPtr->CreateEntities();
 
   // Set the desired update period, this will override the desired RTF given in
   // the world file which was parsed by CreateEntities.
-  if (_config.UpdatePeriod())
+  if (this->dataPtr->config.UpdatePeriod())
   {
-    this->SetUpdatePeriod(_config.UpdatePeriod().value());
+    for (unsigned int i = 0; i < this->dataPtr->simRunners.size(); ++i)
+      this->SetUpdatePeriod(this->dataPtr->config.UpdatePeriod().value(), i);
   }
 
   // Establish publishers and subscribers.
@@ -316,6 +184,41 @@ std::optional<uint64_t> Server::IterationCount(
   return std::nullopt;
 }
 
+//////////////////////////////////////////////////
+std::optional<std::chrono::steady_clock::duration> Server::SimTime(
+    const unsigned int _worldIndex) const
+{
+  if (_worldIndex < this->dataPtr->simRunners.size())
+    return this->dataPtr->simRunners[_worldIndex]->CurrentInfo().simTime;
+  return std::nullopt;
+}
+
+//////////////////////////////////////////////////
+std::optional<double> Server::RealTimeFactor(
+    const unsigned int _worldIndex) const
+{
+  if (_worldIndex < this->dataPtr->simRunners.size())
+    return this->dataPtr->simRunners[_worldIndex]->RealTimeFactor();
+  return std::nullopt;
+}
+
+//////////////////////////////////////////////////
+std::vector<EntityComponentManager *> Server::EntityCompMgrs() const
+{
+  std::vector<EntityComponentManager *> ecms;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->runMutex);
+  if (this->dataPtr->running)
+  {
+    ignerr << "Cannot access components while the server is running.\n";
+    return ecms;
+  }
+
+  for (auto &runner : this->dataPtr->simRunners)
+    ecms.push_back(&runner->EntityCompMgr());
+  return ecms;
+}
+
 //////////////////////////////////////////////////
 std::optional<size_t> Server::EntityCount(const unsigned int _worldIndex) const
 {
@@ -18,6 +18,8 @@
 
 #include <tinyxml2.h>
 
+#include <algorithm>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Filesystem.hh>
 #include <ignition/common/Util.hh>
@@ -200,6 +202,9 @@ class ignition::gazebo::ServerConfigPrivate
     std::string home;
     common::env(IGN_HOMEDIR, home);
 
+    common::env(kWorldCachePathEnv, this->worldCachePath);
+    common::env(kEcmAccessReportEnv, this->ecmAccessReportPath);
+
     this->timestamp = IGN_SYSTEM_TIME();
 
     // Set a default log record path
@@ -229,6 +234,9 @@ class ignition::gazebo::ServerConfigPrivate
             logRecordResources(_cfg->logRecordResources),
             logRecordCompressPath(_cfg->logRecordCompressPath),
             resourceCache(_cfg->resourceCache),
+            worldCachePath(_cfg->worldCachePath),
+            ecmAccessReportPath(_cfg->ecmAccessReportPath),
+            fuelDownloadThreads(_cfg->fuelDownloadThreads),
             physicsEngine(_cfg->physicsEngine),
             renderEngineServer(_cfg->renderEngineServer),
             renderEngineGui(_cfg->renderEngineGui),
@@ -236,6 +244,21 @@ class ignition::gazebo::ServerConfigPrivate
             networkRole(_cfg->networkRole),
             networkSecondaries(_cfg->networkSecondaries),
             seed(_cfg->seed),
+            workerThreads(_cfg->workerThreads),
+            componentBlockSize(_cfg->componentBlockSize),
+            batchSize(_cfg->batchSize),
+            pacing(_cfg->pacing),
+            pacingSpinTime(_cfg->pacingSpinTime),
+            externalPacing(_cfg->externalPacing),
+            timelineSteps(_cfg->timelineSteps),
+            timelineThreshold(_cfg->timelineThreshold),
+            timelinePath(_cfg->timelinePath),
+            compactionBudget(_cfg->compactionBudget),
+            simulationCpus(_cfg->simulationCpus),
+            workerCpus(_cfg->workerCpus),
+            realtimePriority(_cfg->realtimePriority),
+            overlapPostUpdate(_cfg->overlapPostUpdate),
+            deterministic(_cfg->deterministic),
             logRecordTopics(_cfg->logRecordTopics) { }
 
   // \brief The SDF file that the server should load
@@ -273,6 +296,15 @@ class ignition::gazebo::ServerConfigPrivate
   /// from fuel.ignitionrobotics.org, should be stored.
   public: std::string resourceCache = "";
 
+  /// \brief Directory of the world cache, empty if disabled.
+  public: std::string worldCachePath;
+
+  /// \brief Path of the ECM access report, empty if not tracing.
+  public: std::string ecmAccessReportPath;
+
+  /// \brief Number of concurrent Fuel downloads while loading a world.
+  public: unsigned int fuelDownloadThreads{8};
+
   /// \brief File containing physics engine plugin. If empty, DART will be used.
   public: std::string physicsEngine = "";
 
@@ -296,6 +328,56 @@ class ignition::gazebo::ServerConfigPrivate
   /// \brief The given random seed.
   public: unsigned int seed = 0;
 
+  /// \brief Number of worker threads, zero to match the hardware.
+  public: unsigned int workerThreads = 0;
+
+  /// \brief Number of components allocated at once per component type,
+  /// zero for the default.
+  public: std::size_t componentBlockSize = 0;
+
+  /// \brief Number of copies of the world simulated in lockstep.
+  public: unsigned int batchSize = 1;
+
+  /// \brief How iterations are paced.
+  public: ServerConfig::PacingMode pacing{ServerConfig::PacingMode::Sleep};
+
+  /// \brief Busy-wait duration of hybrid pacing.
+  public: std::chrono::steady_clock::duration pacingSpinTime{
+      std::chrono::microseconds(200)};
+
+  /// \brief Function used by external pacing.
+  public: ServerConfig::PacingFunction externalPacing;
+
+  /// \brief Number of steps kept in the timeline, zero to disable it.
+  public: std::size_t timelineSteps = 0;
+
+  /// \brief Step duration above which the timeline is written, zero for
+  /// never.
+  public: std::chrono::steady_clock::duration timelineThreshold{0};
+
+  /// \brief Directory where timelines are written.
+  public: std::string timelinePath = "";
+
+  /// \brief Time spent per step compacting the entity component manager.
+  public: std::chrono::steady_clock::duration compactionBudget{
+      std::chrono::milliseconds(1)};
+
+  /// \brief CPUs of the simulation thread, empty for any.
+  public: std::vector<unsigned int> simulationCpus;
+
+  /// \brief CPUs of the worker threads, empty for any.
+  public: std::vector<unsigned int> workerCpus;
+
+  /// \brief Real-time priority of the simulation thread, 0 for none.
+  public: int realtimePriority{0};
+
+  /// \brief Whether PostUpdate-only systems overlap the next step.
+  public: bool overlapPostUpdate{false};
+
+  /// \brief Whether changes of concurrent systems are merged in a fixed
+  /// order.
+  public: bool deterministic{false};
+
   /// \brief Timestamp that marks when this ServerConfig was created.
   public: std::chrono::time_point<std::chrono::system_clock> timestamp;
 
@@ -502,6 +584,189 @@ void ServerConfig::SetSeed(unsigned int _seed)
   ignition::math::Rand::Seed(_seed);
 }
 
+/////////////////////////////////////////////////
+unsigned int ServerConfig::WorkerThreads() const
+{
+  return this->dataPtr->workerThreads;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetWorkerThreads(unsigned int _threads)
+{
+  this->dataPtr->workerThreads = _threads;
+}
+
+/////////////////////////////////////////////////
+std::size_t ServerConfig::ComponentBlockSize() const
+{
+  return this->dataPtr->componentBlockSize;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetComponentBlockSize(std::size_t _size)
+{
+  this->dataPtr->componentBlockSize = _size;
+}
+
+/////////////////////////////////////////////////
+unsigned int ServerConfig::BatchSize() const
+{
+  return this->dataPtr->batchSize;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetBatchSize(unsigned int _size)
+{
+  this->dataPtr->batchSize = std::max(1u, _size);
+}
+
+/////////////////////////////////////////////////
+ServerConfig::PacingMode ServerConfig::Pacing() const
+{
+  return this->dataPtr->pacing;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetPacing(PacingMode _mode)
+{
+  this->dataPtr->pacing = _mode;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::PacingSpinTime() const
+{
+  return this->dataPtr->pacingSpinTime;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetPacingSpinTime(
+    const std::chrono::steady_clock::duration &_time)
+{
+  this->dataPtr->pacingSpinTime = _time;
+}
+
+/////////////////////////////////////////////////
+const ServerConfig::PacingFunction &ServerConfig::ExternalPacing() const
+{
+  return this->dataPtr->externalPacing;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetExternalPacing(const PacingFunction &_function)
+{
+  this->dataPtr->externalPacing = _function;
+}
+
+/////////////////////////////////////////////////
+std::size_t ServerConfig::TimelineSteps() const
+{
+  return this->dataPtr->timelineSteps;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetTimelineSteps(std::size_t _steps)
+{
+  this->dataPtr->timelineSteps = _steps;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::TimelineThreshold() const
+{
+  return this->dataPtr->timelineThreshold;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetTimelineThreshold(
+    const std::chrono::steady_clock::duration &_threshold)
+{
+  this->dataPtr->timelineThreshold = _threshold;
+}
+
+/////////////////////////////////////////////////
+const std::string &ServerConfig::TimelinePath() const
+{
+  return this->dataPtr->timelinePath;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetTimelinePath(const std::string &_path)
+{
+  this->dataPtr->timelinePath = _path;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::CompactionBudget() const
+{
+  return this->dataPtr->compactionBudget;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetCompactionBudget(
+    const std::chrono::steady_clock::duration &_budget)
+{
+  this->dataPtr->compactionBudget = _budget;
+}
+
+/////////////////////////////////////////////////
+const std::vector<unsigned int> &ServerConfig::SimulationCpus() const
+{
+  return this->dataPtr->simulationCpus;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetSimulationCpus(const std::vector<unsigned int> &_cpus)
+{
+  this->dataPtr->simulationCpus = _cpus;
+}
+
+/////////////////////////////////////////////////
+const std::vector<unsigned int> &ServerConfig::WorkerCpus() const
+{
+  return this->dataPtr->workerCpus;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetWorkerCpus(const std::vector<unsigned int> &_cpus)
+{
+  this->dataPtr->workerCpus = _cpus;
+}
+
+/////////////////////////////////////////////////
+int ServerConfig::RealtimePriority() const
+{
+  return this->dataPtr->realtimePriority;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetRealtimePriority(int _priority)
+{
+  this->dataPtr->realtimePriority = _priority;
+}
+
+/////////////////////////////////////////////////
+bool ServerConfig::OverlapPostUpdate() const
+{
+  return this->dataPtr->overlapPostUpdate;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetOverlapPostUpdate(bool _overlap)
+{
+  this->dataPtr->overlapPostUpdate = _overlap;
+}
+
+/////////////////////////////////////////////////
+bool ServerConfig::Deterministic() const
+{
+  return this->dataPtr->deterministic;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetDeterministic(bool _deterministic)
+{
+  this->dataPtr->deterministic = _deterministic;
+}
+
 /////////////////////////////////////////////////
 const std::string &ServerConfig::ResourceCache() const
 {
@@ -514,6 +779,42 @@ void ServerConfig::SetResourceCache(const std::string &_path)
   this->dataPtr->resourceCache = _path;
 }
 
+/////////////////////////////////////////////////
+const std::string &ServerConfig::WorldCachePath() const
+{
+  return this->dataPtr->worldCachePath;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetWorldCachePath(const std::string &_path)
+{
+  this->dataPtr->worldCachePath = _path;
+}
+
+/////////////////////////////////////////////////
+const std::string &ServerConfig::EcmAccessReportPath() const
+{
+  return this->dataPtr->ecmAccessReportPath;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetEcmAccessReportPath(const std::string &_path)
+{
+  this->dataPtr->ecmAccessReportPath = _path;
+}
+
+/////////////////////////////////////////////////
+unsigned int ServerConfig::FuelDownloadThreads() const
+{
+  return this->dataPtr->fuelDownloadThreads;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetFuelDownloadThreads(unsigned int _threads)
+{
+  this->dataPtr->fuelDownloadThreads = _threads;
+}
+
 /////////////////////////////////////////////////
 const std::string &ServerConfig::PhysicsEngine() const
 {
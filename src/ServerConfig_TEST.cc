@@ -17,6 +17,8 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/gazebo/ServerConfig.hh>
 #include <ignition/gazebo/Util.hh>
@@ -228,3 +230,170 @@ TEST(ServerConfig, GenerateRecordPlugin)
   EXPECT_EQ(plugin.Name(), "ignition::gazebo::systems::LogRecord");
 }
 
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, WorkerThreads)
+{
+  ServerConfig config;
+  EXPECT_EQ(0u, config.WorkerThreads());
+
+  config.SetWorkerThreads(4u);
+  EXPECT_EQ(4u, config.WorkerThreads());
+
+  ServerConfig copy(config);
+  EXPECT_EQ(4u, copy.WorkerThreads());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, ComponentBlockSize)
+{
+  ServerConfig config;
+  EXPECT_EQ(0u, config.ComponentBlockSize());
+
+  config.SetComponentBlockSize(1024u);
+  EXPECT_EQ(1024u, config.ComponentBlockSize());
+
+  ServerConfig copy(config);
+  EXPECT_EQ(1024u, copy.ComponentBlockSize());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, Pacing)
+{
+  ServerConfig config;
+  EXPECT_EQ(ServerConfig::PacingMode::Sleep, config.Pacing());
+  EXPECT_EQ(std::chrono::microseconds(200), config.PacingSpinTime());
+  EXPECT_FALSE(config.ExternalPacing());
+
+  config.SetPacing(ServerConfig::PacingMode::External);
+  config.SetPacingSpinTime(std::chrono::microseconds(50));
+  config.SetExternalPacing([](const std::chrono::steady_clock::time_point &)
+      {
+      });
+
+  ServerConfig copy(config);
+  EXPECT_EQ(ServerConfig::PacingMode::External, copy.Pacing());
+  EXPECT_EQ(std::chrono::microseconds(50), copy.PacingSpinTime());
+  EXPECT_TRUE(copy.ExternalPacing());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, Timeline)
+{
+  ServerConfig config;
+  EXPECT_EQ(0u, config.TimelineSteps());
+  EXPECT_EQ(std::chrono::steady_clock::duration::zero(),
+      config.TimelineThreshold());
+  EXPECT_TRUE(config.TimelinePath().empty());
+
+  config.SetTimelineSteps(500u);
+  config.SetTimelineThreshold(std::chrono::milliseconds(100));
+  config.SetTimelinePath("/tmp/timelines");
+
+  ServerConfig copy(config);
+  EXPECT_EQ(500u, copy.TimelineSteps());
+  EXPECT_EQ(std::chrono::milliseconds(100), copy.TimelineThreshold());
+  EXPECT_EQ("/tmp/timelines", copy.TimelinePath());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, CompactionBudget)
+{
+  ServerConfig config;
+  EXPECT_EQ(std::chrono::milliseconds(1), config.CompactionBudget());
+
+  config.SetCompactionBudget(std::chrono::steady_clock::duration::zero());
+  ServerConfig copy(config);
+  EXPECT_EQ(std::chrono::steady_clock::duration::zero(),
+      copy.CompactionBudget());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, ThreadPlacement)
+{
+  ServerConfig config;
+  EXPECT_TRUE(config.SimulationCpus().empty());
+  EXPECT_TRUE(config.WorkerCpus().empty());
+  EXPECT_EQ(0, config.RealtimePriority());
+
+  config.SetSimulationCpus({2u});
+  config.SetWorkerCpus({3u, 4u, 5u});
+  config.SetRealtimePriority(50);
+
+  ServerConfig copy(config);
+  EXPECT_EQ(std::vector<unsigned int>({2u}), copy.SimulationCpus());
+  EXPECT_EQ(std::vector<unsigned int>({3u, 4u, 5u}), copy.WorkerCpus());
+  EXPECT_EQ(50, copy.RealtimePriority());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, OverlapPostUpdate)
+{
+  ServerConfig config;
+  EXPECT_FALSE(config.OverlapPostUpdate());
+
+  config.SetOverlapPostUpdate(true);
+  EXPECT_TRUE(config.OverlapPostUpdate());
+
+  ServerConfig copy(config);
+  EXPECT_TRUE(copy.OverlapPostUpdate());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, Deterministic)
+{
+  ServerConfig config;
+  EXPECT_FALSE(config.Deterministic());
+
+  config.SetDeterministic(true);
+  EXPECT_TRUE(config.Deterministic());
+
+  ServerConfig copy(config);
+  EXPECT_TRUE(copy.Deterministic());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, WorldCachePath)
+{
+  ASSERT_TRUE(common::setenv(gazebo::kWorldCachePathEnv, "/tmp/world_cache"));
+  ServerConfig config;
+  EXPECT_EQ("/tmp/world_cache", config.WorldCachePath());
+  EXPECT_TRUE(common::unsetenv(gazebo::kWorldCachePathEnv));
+
+  config.SetWorldCachePath("");
+  EXPECT_TRUE(config.WorldCachePath().empty());
+
+  config.SetWorldCachePath("cache");
+  ServerConfig copy(config);
+  EXPECT_EQ("cache", copy.WorldCachePath());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, EcmAccessReportPath)
+{
+  ASSERT_TRUE(common::setenv(gazebo::kEcmAccessReportEnv,
+      "/tmp/ecm_access.tsv"));
+  ServerConfig config;
+  EXPECT_EQ("/tmp/ecm_access.tsv", config.EcmAccessReportPath());
+  EXPECT_TRUE(common::unsetenv(gazebo::kEcmAccessReportEnv));
+
+  config.SetEcmAccessReportPath("");
+  EXPECT_TRUE(config.EcmAccessReportPath().empty());
+
+  config.SetEcmAccessReportPath("report.tsv");
+  ServerConfig copy(config);
+  EXPECT_EQ("report.tsv", copy.EcmAccessReportPath());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, FuelDownloadThreads)
+{
+  ServerConfig config;
+  EXPECT_EQ(8u, config.FuelDownloadThreads());
+
+  config.SetFuelDownloadThreads(2u);
+  EXPECT_EQ(2u, config.FuelDownloadThreads());
+
+  ServerConfig copy(config);
+  EXPECT_EQ(2u, copy.FuelDownloadThreads());
+}
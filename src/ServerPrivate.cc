@@ -18,18 +18,34 @@
 
 #include <tinyxml2.h>
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <set>
+
+#include <sdf/Error.hh>
 #include <sdf/Root.hh>
 #include <sdf/World.hh>
 
 #include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/SystemPaths.hh>
 #include <ignition/common/Util.hh>
+#include <ignition/common/WorkerPool.hh>
 
+#include <ignition/fuel_tools/ClientConfig.hh>
 #include <ignition/fuel_tools/Interface.hh>
 
 #include <ignition/gui/Application.hh>
 
+#include "ignition/gazebo/ParallelTasks.hh"
+#include "ignition/gazebo/ThreadAffinity.hh"
 #include "ignition/gazebo/Util.hh"
+#include "Pacer.hh"
 #include "SimulationRunner.hh"
+#include "WorldCache.hh"
 
 using namespace ignition;
 using namespace gazebo;
@@ -83,6 +99,49 @@ struct LoggingPlugin
   }
 };
 
+//////////////////////////////////////////////////
+// Getting the first .sdf file in the path
+std::string findFuelResourceSdf(const std::string &_path)
+{
+  if (!common::exists(_path))
+    return "";
+
+  for (common::DirIter file(_path); file != common::DirIter(); ++file)
+  {
+    std::string current(*file);
+    if (!common::isFile(current))
+      continue;
+
+    auto fileName = common::basename(current);
+    auto fileExtensionIndex = fileName.rfind(".");
+    auto fileExtension = fileName.substr(fileExtensionIndex + 1);
+
+    if (fileExtension == "sdf")
+    {
+      return current;
+    }
+  }
+  return "";
+}
+
+/// \brief This struct provides access to the default world.
+struct DefaultWorld
+{
+  /// \brief Get the default world as a string.
+  /// Plugins will be loaded from the server.config file.
+  /// \return An SDF string that contains the default world.
+  public: static std::string &World()
+  {
+    static std::string world = std::string("<?xml version='1.0'?>"
+      "<sdf version='1.6'>"
+        "<world name='default'>") +
+        "</world>"
+      "</sdf>";
+
+    return world;
+  }
+};
+
 //////////////////////////////////////////////////
 ServerPrivate::ServerPrivate()
 : systemLoader(std::make_shared<SystemLoader>())
@@ -102,6 +161,147 @@ ServerPrivate::~ServerPrivate()
   }
 }
 
+//////////////////////////////////////////////////
+bool ServerPrivate::LoadSdfRoot()
+{
+  this->loadSdfStart = std::chrono::steady_clock::now();
+
+  // Configure the fuel client
+  fuel_tools::ClientConfig fuelConfig;
+  if (!this->config.ResourceCache().empty())
+    fuelConfig.SetCacheLocation(this->config.ResourceCache());
+  this->fuelClient = std::make_unique<fuel_tools::FuelClient>(fuelConfig);
+
+  // Configure SDF to fetch assets from ignition fuel.
+  sdf::setFindCallback(std::bind(&ServerPrivate::FetchResource,
+        this, std::placeholders::_1));
+  common::addFindFileURICallback(std::bind(&ServerPrivate::FetchResourceUri,
+      this, std::placeholders::_1));
+
+  addResourcePaths();
+
+  sdf::Errors errors;
+
+  // Load a world if specified. Check SDF string first, then SDF file
+  if (!this->config.SdfString().empty())
+  {
+    std::string msg = "Loading SDF string. ";
+    if (this->config.SdfFile().empty())
+    {
+      msg += "File path not available.\n";
+    }
+    else
+    {
+      msg += "File path [" + this->config.SdfFile() + "].\n";
+    }
+    ignmsg <<  msg;
+    this->PrefetchResources(this->config.SdfString());
+    errors = this->sdfRoot.LoadSdfString(this->config.SdfString());
+  }
+  else if (!this->config.SdfFile().empty())
+  {
+    std::string filePath;
+
+    // Check Fuel if it's a URL
+    auto sdfUri = common::URI(this->config.SdfFile());
+    if (sdfUri.Scheme() == "http" || sdfUri.Scheme() == "https")
+    {
+      std::string fuelCachePath;
+      if (this->fuelClient->CachedWorld(common::URI(this->config.SdfFile()),
+          fuelCachePath))
+      {
+        filePath = findFuelResourceSdf(fuelCachePath);
+      }
+      else if (auto result = this->fuelClient->DownloadWorld(
+          common::URI(this->config.SdfFile()), fuelCachePath))
+      {
+        filePath = findFuelResourceSdf(fuelCachePath);
+      }
+      else
+      {
+        ignwarn << "Fuel couldn't download URL [" << this->config.SdfFile()
+                << "], error: [" << result.ReadableResult() << "]"
+                << std::endl;
+      }
+    }
+
+    if (filePath.empty())
+    {
+      common::SystemPaths systemPaths;
+
+      // Worlds from environment variable
+      systemPaths.SetFilePathEnv(kResourcePathEnv);
+
+      // Worlds installed with ign-gazebo
+      systemPaths.AddFilePaths(IGN_GAZEBO_WORLD_INSTALL_DIR);
+
+      filePath = systemPaths.FindFile(this->config.SdfFile());
+    }
+
+    if (filePath.empty())
+    {
+      ignerr << "Failed to find world [" << this->config.SdfFile() << "]"
+             << std::endl;
+      return false;
+    }
+
+    ignmsg << "Loading SDF world file[" << filePath << "].\n";
+
+    // \todo(nkoenig) Async resource download.
+    // This call can block for a long period of time while
+    // resources are downloaded. Blocking here causes the GUI to block with
+    // a black screen (search for "Async resource download" in
+    // 'src/gui_main.cc'.
+    std::unique_ptr<WorldCache> worldCache;
+    std::string cachedSdf;
+    if (!this->config.WorldCachePath().empty())
+      worldCache = std::make_unique<WorldCache>(this->config.WorldCachePath());
+
+    if (worldCache && worldCache->Load(filePath, cachedSdf))
+    {
+      igndbg << "Loading cached world of [" << filePath << "].\n";
+      errors = this->sdfRoot.LoadSdfString(cachedSdf);
+
+      // A cached world which couldn't even be parsed, such as one which was
+      // truncated, leaves the root empty, so the file can still be loaded
+      if (!errors.empty() && this->sdfRoot.WorldCount() == 0)
+      {
+        ignwarn << "Failed to load cached world of [" << filePath
+                << "], loading the file instead.\n";
+        cachedSdf.clear();
+      }
+    }
+
+    if (cachedSdf.empty())
+    {
+      std::ifstream file(filePath);
+      this->PrefetchResources(std::string(
+          std::istreambuf_iterator<char>(file),
+          std::istreambuf_iterator<char>()));
+
+      errors = this->sdfRoot.Load(filePath);
+      if (errors.empty() && worldCache)
+        worldCache->Save(filePath, this->sdfRoot);
+    }
+  }
+  else
+  {
+    ignmsg << "Loading default world.\n";
+    // Load an empty world.
+    /// \todo(nkoenig) Add a "AddWorld" function to sdf::Root.
+    errors = this->sdfRoot.LoadSdfString(DefaultWorld::World());
+  }
+
+  if (!errors.empty())
+  {
+    for (auto &err : errors)
+      ignerr << err << "\n";
+    return false;
+  }
+  this->loadSdfEnd = std::chrono::steady_clock::now();
+  return true;
+}
+
 //////////////////////////////////////////////////
 void ServerPrivate::OnSignal(int _sig)
 {
@@ -129,6 +329,10 @@ bool ServerPrivate::Run(const uint64_t _iterations,
     _cond.value()->notify_all();
   this->runMutex.unlock();
 
+  // Keep this thread, which runs simulation iterations, where it was asked
+  SetThreadCpus(this->config.SimulationCpus());
+  SetThreadRealtimePriority(this->config.RealtimePriority());
+
   bool result = true;
 
   if (this->config.UseDistributedSimulation())
@@ -164,24 +368,176 @@ bool ServerPrivate::Run(const uint64_t _iterations,
   {
     result = this->simRunners[0]->Run(_iterations);
   }
-  else
+  else if (this->config.UseDistributedSimulation())
   {
+    // Runners with a network manager need their own thread for the
+    // handshake and for stepping through the network.
+    std::vector<std::thread> threads;
     for (std::unique_ptr<SimulationRunner> &runner : this->simRunners)
     {
-      this->workerPool.AddWork([&runner, &_iterations] ()
+      threads.emplace_back([this, &runner, &_iterations] ()
         {
+          SetThreadCpus(this->config.SimulationCpus());
+          SetThreadRealtimePriority(this->config.RealtimePriority());
           runner->Run(_iterations);
         });
     }
 
-    // Wait for the runner to complete.
-    result = this->workerPool.WaitForResults();
+    // Wait for the runners to complete.
+    for (auto &thread : threads)
+      thread.join();
+  }
+  else
+  {
+    result = this->RunWorlds(_iterations);
   }
 
   this->running = false;
   return result;
 }
 
+//////////////////////////////////////////////////
+bool ServerPrivate::RunWorlds(const uint64_t _iterations)
+{
+  using Clock = std::chrono::steady_clock;
+
+  unsigned int budget = this->config.WorkerThreads();
+  if (0 == budget)
+    budget = std::max(1u, std::thread::hardware_concurrency());
+
+  // Threads taking turns running world iterations. The others help the
+  // worlds run their systems.
+  const std::size_t worldCount = this->simRunners.size();
+  const auto worldThreads =
+      static_cast<unsigned int>(std::min<std::size_t>(budget, worldCount));
+
+  // Scheduling state, protected by the mutex
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<bool> busy(worldCount, false);
+  std::vector<uint64_t> processed(worldCount, 0);
+  std::vector<Clock::time_point> due(worldCount);
+
+  for (std::size_t i = 0; i < worldCount; ++i)
+  {
+    auto &runner = this->simRunners[i];
+    runner->SetWorkerThreads(budget - worldThreads + 1);
+    runner->StartRun();
+    due[i] = runner->NextIterationTime();
+  }
+
+  auto finished = [&](std::size_t _world)
+  {
+    return !this->simRunners[_world]->Running() ||
+        (_iterations > 0 && processed[_world] >= _iterations);
+  };
+
+  // Batched copies of a world run in lockstep: all of them run an
+  // iteration, in parallel, before any of them runs the next one.
+  const bool lockstep = !this->worldCopies.empty();
+  if (lockstep)
+  {
+    Pacer pacer(this->config.Pacing(), this->config.PacingSpinTime(),
+        this->config.ExternalPacing());
+    while (true)
+    {
+      std::vector<std::size_t> active;
+      Clock::time_point start;
+      for (std::size_t i = 0; i < worldCount; ++i)
+      {
+        if (finished(i))
+          continue;
+        active.push_back(i);
+        start = std::max(start, due[i]);
+      }
+
+      if (active.empty())
+        break;
+
+      if (start > Clock::now())
+        pacer.WaitUntil(start);
+
+      RunParallelTasks(this->workerPool.get(), worldThreads, active.size(),
+          [&](std::size_t _index)
+          {
+            auto &runner = this->simRunners[active[_index]];
+            processed[active[_index]] += runner->RunIteration();
+            due[active[_index]] = runner->NextIterationTime();
+          });
+    }
+  }
+
+  auto runWorlds = [&](std::size_t)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+      // Pick the world which is due first among the ones no other thread
+      // is running.
+      bool active{false};
+      std::optional<std::size_t> next;
+      for (std::size_t i = 0; i < worldCount; ++i)
+      {
+        if (finished(i))
+          continue;
+        active = true;
+        if (!busy[i] && (!next || due[i] < due[*next]))
+          next = i;
+      }
+
+      if (!active)
+      {
+        cv.notify_all();
+        return;
+      }
+
+      if (!next)
+      {
+        cv.wait(lock);
+        continue;
+      }
+
+      if (due[*next] > Clock::now())
+      {
+        cv.wait_until(lock, due[*next]);
+        continue;
+      }
+
+      const std::size_t world = *next;
+      busy[world] = true;
+      lock.unlock();
+
+      auto &runner = this->simRunners[world];
+      const uint64_t count = runner->RunIteration();
+      const auto nextTime = runner->NextIterationTime();
+
+      lock.lock();
+      processed[world] += count;
+      due[world] = nextTime;
+      busy[world] = false;
+      cv.notify_all();
+    }
+  };
+
+  if (!lockstep)
+  {
+    RunParallelTasks(this->workerPool.get(), worldThreads, worldThreads,
+        runWorlds);
+  }
+
+  std::lock_guard<std::mutex> namesLock(this->worldsMutex);
+  for (std::size_t i = 0; i < worldCount; ++i)
+  {
+    auto &runner = this->simRunners[i];
+    runner->FinishRun();
+    ignmsg << "World [" << this->worldNames[i] << "] ran " << processed[i]
+           << " iterations at a real time factor of "
+           << runner->RealTimeFactor() << std::endl;
+  }
+
+  return true;
+}
+
 //////////////////////////////////////////////////
 sdf::ElementPtr GetRecordPluginElem(sdf::Root &_sdfRoot)
 {
@@ -299,19 +655,63 @@ void ServerPrivate::AddRecordPlugin(const ServerConfig &_config)
 //////////////////////////////////////////////////
 void ServerPrivate::CreateEntities()
 {
-  // Create a simulation runner for each world.
+  std::vector<const sdf::World *> worlds;
   for (uint64_t worldIndex = 0; worldIndex <
        this->sdfRoot.WorldCount(); ++worldIndex)
   {
-    auto world = this->sdfRoot.WorldByIndex(worldIndex);
+    worlds.push_back(this->sdfRoot.WorldByIndex(worldIndex));
+  }
 
+  // Copies of the world for batched simulation
+  const unsigned int batchSize = this->config.BatchSize();
+  if (batchSize > 1 && worlds.size() != 1)
+  {
+    ignerr << "Batched simulation needs a single world, found ["
+           << worlds.size() << "]. Not batching." << std::endl;
+  }
+  else if (batchSize > 1 && this->config.UseDistributedSimulation())
+  {
+    ignerr << "Batched simulation isn't supported together with distributed "
+           << "simulation. Not batching." << std::endl;
+  }
+  else
+  {
+    for (unsigned int copy = 1; copy < batchSize; ++copy)
+    {
+      this->worldCopies.push_back(*worlds[0]);
+      this->worldCopies.back().SetName(
+          worlds[0]->Name() + "_" + std::to_string(copy));
+      worlds.push_back(&this->worldCopies.back());
+    }
+  }
+
+  // Several worlds share one pool of worker threads, see RunWorlds.
+  // Distributed simulation runs each world on its own thread.
+  if (worlds.size() > 1 && !this->config.UseDistributedSimulation())
+  {
+    this->workerPool = std::make_unique<common::WorkerPool>(
+        std::max(2u, this->config.WorkerThreads()));
+    SetWorkerPoolCpus(*this->workerPool,
+        std::max(2u, this->config.WorkerThreads()), this->config.WorkerCpus());
+  }
+
+  // Create a simulation runner for each world.
+  for (const auto *world : worlds)
+  {
     {
       std::lock_guard<std::mutex> lock(this->worldsMutex);
       this->worldNames.push_back(world->Name());
     }
     auto runner = std::make_unique<SimulationRunner>(
-        world, this->systemLoader, this->config);
+        world, this->systemLoader, this->config, this->workerPool.get());
     runner->SetFuelUriMap(this->fuelUriMap);
+
+    // Worlds are loaded together, so they share this phase
+    if (this->loadSdfEnd > this->loadSdfStart)
+    {
+      runner->AddStartupPhase("load_sdf", this->loadSdfStart,
+          this->loadSdfEnd);
+    }
     this->simRunners.push_back(std::move(runner));
   }
 }
@@ -453,3 +853,90 @@ std::string ServerPrivate::FetchResourceUri(const common::URI &_uri)
 {
   return this->FetchResource(_uri.Str());
 }
+
+//////////////////////////////////////////////////
+/// \brief Collect the Fuel URIs held by the <uri> elements of an XML
+/// element's descendants.
+/// \param[in] _elem XML element.
+/// \param[in, out] _seen URIs collected so far, which are skipped.
+/// \param[out] _uris New URIs.
+static void collectFuelUris(const tinyxml2::XMLElement *_elem,
+    std::set<std::string> &_seen, std::vector<std::string> &_uris)
+{
+  if (nullptr == _elem)
+    return;
+
+  for (auto child = _elem->FirstChildElement(); child;
+       child = child->NextSiblingElement())
+  {
+    if (std::string(child->Name()) == "uri" && child->GetText())
+    {
+      std::string uri = child->GetText();
+      uri.erase(0, uri.find_first_not_of(" \t\n\r"));
+      uri.erase(uri.find_last_not_of(" \t\n\r") + 1);
+      if ((uri.find("http://") == 0 || uri.find("https://") == 0) &&
+          _seen.insert(uri).second)
+      {
+        _uris.push_back(uri);
+      }
+    }
+    collectFuelUris(child, _seen, _uris);
+  }
+}
+
+//////////////////////////////////////////////////
+void ServerPrivate::PrefetchResources(const std::string &_sdf)
+{
+  const unsigned int threads = this->config.FuelDownloadThreads();
+  if (threads <= 1)
+    return;
+
+  tinyxml2::XMLDocument doc;
+  if (doc.Parse(_sdf.c_str()) != tinyxml2::XML_SUCCESS)
+    return;
+
+  std::set<std::string> seen;
+  std::vector<std::string> uris;
+  collectFuelUris(doc.RootElement(), seen, uris);
+  if (uris.empty())
+    return;
+
+  // The calling thread downloads too
+  common::WorkerPool pool(threads - 1);
+
+  // Each round downloads the resources found in the previous one, since
+  // models may include other models
+  while (!uris.empty())
+  {
+    igndbg << "Downloading [" << uris.size() << "] Fuel resources."
+           << std::endl;
+
+    std::vector<std::string> paths(uris.size());
+    RunParallelTasks(&pool, threads, uris.size(), [&](std::size_t _index)
+    {
+      paths[_index] = fuel_tools::fetchResourceWithClient(uris[_index],
+          *this->fuelClient.get());
+    });
+
+    uris.clear();
+    for (const auto &path : paths)
+    {
+      if (path.empty() || !common::isDirectory(path))
+        continue;
+
+      for (common::DirIter file(path); file != common::DirIter(); ++file)
+      {
+        const std::string filePath = *file;
+        if (filePath.size() < 4 ||
+            filePath.compare(filePath.size() - 4, 4, ".sdf") != 0)
+        {
+          continue;
+        }
+
+        tinyxml2::XMLDocument modelDoc;
+        if (modelDoc.LoadFile(filePath.c_str()) == tinyxml2::XML_SUCCESS)
+          collectFuelUris(modelDoc.RootElement(), seen, uris);
+      }
+    }
+  }
+}
@@ -20,7 +20,9 @@
 #include <ignition/msgs/stringmsg_v.pb.h>
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -30,6 +32,7 @@
 #include <vector>
 
 #include <sdf/Root.hh>
+#include <sdf/World.hh>
 
 #include <ignition/common/SignalHandler.hh>
 #include <ignition/common/URI.hh>
@@ -70,6 +73,21 @@ namespace ignition
       public: bool Run(const uint64_t _iterations,
                  std::optional<std::condition_variable *> _cond = std::nullopt);
 
+      /// \brief Run several worlds within one budget of worker threads,
+      /// given by ServerConfig::WorkerThreads. Instead of running each world
+      /// on its own thread, a few threads take turns running one iteration
+      /// of whichever world is due next. The remaining threads of the budget
+      /// are shared by the worlds' systems and entity processing.
+      /// \param[in] _iterations Number of iterations of each world.
+      /// \return True if all worlds ran successfully.
+      public: bool RunWorlds(const uint64_t _iterations);
+
+      /// \brief Configure the Fuel client and load the world of the
+      /// configuration into sdfRoot, from the SDF string, the SDF file, or
+      /// the default world, in that order.
+      /// \return False if the world couldn't be loaded.
+      public: bool LoadSdfRoot();
+
       /// \brief Add logging record plugin.
       /// \param[in] _config Server configuration parameters.
       public: void AddRecordPlugin(const ServerConfig &_config);
@@ -95,6 +113,14 @@ namespace ignition
       /// \return Path to the downloaded resource, empty on error.
       public: std::string FetchResourceUri(const common::URI &_uri);
 
+      /// \brief Download the Fuel resources referenced by an SDF document,
+      /// and by the models it includes, using up to
+      /// ServerConfig::FuelDownloadThreads concurrent downloads. Parsing
+      /// the document afterwards finds them in the cache instead of
+      /// downloading them one by one.
+      /// \param[in] _sdf SDF document.
+      public: void PrefetchResources(const std::string &_sdf);
+
       /// \brief Signal handler callback
       /// \param[in] _sig The signal number
       private: void OnSignal(int _sig);
@@ -114,8 +140,9 @@ namespace ignition
       /// \return True if successful.
       private: bool ResourcePathsService(ignition::msgs::StringMsg_V &_res);
 
-      /// \brief A pool of worker threads.
-      public: common::WorkerPool workerPool{2};
+      /// \brief A pool of worker threads shared by all simulation runners,
+      /// when there are several worlds. See RunWorlds.
+      public: std::unique_ptr<common::WorkerPool> workerPool;
 
       /// \brief All the simulation runners.
       public: std::vector<std::unique_ptr<SimulationRunner>> simRunners;
@@ -141,6 +168,17 @@ namespace ignition
       /// pointer to child nodes of the root
       public: sdf::Root sdfRoot;
 
+      /// \brief Real time when LoadSdfRoot started.
+      public: std::chrono::steady_clock::time_point loadSdfStart;
+
+      /// \brief Real time when LoadSdfRoot successfully finished.
+      public: std::chrono::steady_clock::time_point loadSdfEnd;
+
+      /// \brief Copies of the world for batched simulation, see
+      /// ServerConfig::SetBatchSize. A list, so that runners can keep
+      /// pointers to its elements.
+      public: std::list<sdf::World> worldCopies;
+
       /// \brief The server configuration.
       public: ServerConfig config;
 
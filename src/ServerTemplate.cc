@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/ServerTemplate.hh"
+
+#ifndef _WIN32
+  #include <stdlib.h>
+  #include <unistd.h>
+#endif
+
+#include <iostream>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+
+#include "ServerPrivate.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+class ignition::gazebo::ServerTemplatePrivate
+{
+  /// \brief Private data of the server, with its world loaded. Moved to
+  /// the server once it's created.
+  public: std::unique_ptr<ServerPrivate> server;
+
+  /// \brief Whether the world was loaded.
+  public: bool loaded{false};
+};
+
+//////////////////////////////////////////////////
+ServerTemplate::ServerTemplate(const ServerConfig &_config)
+  : dataPtr(new ServerTemplatePrivate)
+{
+  this->dataPtr->server = std::make_unique<ServerPrivate>();
+  this->dataPtr->server->config = _config;
+  this->dataPtr->loaded = this->dataPtr->server->LoadSdfRoot();
+  if (!this->dataPtr->loaded)
+    return;
+
+  // Plugins can start threads and create transport nodes when they're
+  // instantiated, so only their libraries are loaded before forking.
+  auto &systemLoader = this->dataPtr->server->systemLoader;
+  auto count = systemLoader->PreloadLibraries(
+      this->dataPtr->server->sdfRoot.Element());
+  for (const auto &plugin : _config.Plugins())
+    count += systemLoader->PreloadLibrary(plugin.Filename()) ? 1 : 0;
+
+  // Worlds without plugins are given the default ones
+  if (count == 0)
+  {
+    for (const auto &plugin :
+        loadPluginInfo(!_config.LogPlaybackPath().empty()))
+    {
+      systemLoader->PreloadLibrary(plugin.Filename());
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+ServerTemplate::~ServerTemplate() = default;
+
+//////////////////////////////////////////////////
+bool ServerTemplate::Valid() const
+{
+  return this->dataPtr->loaded && nullptr != this->dataPtr->server;
+}
+
+//////////////////////////////////////////////////
+int ServerTemplate::Fork(const std::string &_partition)
+{
+#ifdef _WIN32
+  ignerr << "Forking servers isn't supported on Windows, partition ["
+         << _partition << "] wasn't created." << std::endl;
+  return -1;
+#else
+  if (!this->Valid())
+  {
+    ignerr << "Can't fork a server from an invalid template." << std::endl;
+    return -1;
+  }
+
+  // Flush so that buffered output isn't written by both processes
+  std::cout.flush();
+  std::cerr.flush();
+
+  auto pid = fork();
+  if (pid < 0)
+  {
+    ignerr << "Failed to fork a server for partition [" << _partition
+           << "]" << std::endl;
+    return -1;
+  }
+
+  if (pid == 0 && !_partition.empty())
+    setenv("IGN_PARTITION", _partition.c_str(), 1);
+
+  return static_cast<int>(pid);
+#endif
+}
+
+//////////////////////////////////////////////////
+std::unique_ptr<Server> ServerTemplate::CreateServer()
+{
+  if (!this->Valid())
+  {
+    ignerr << "Can't create a server from an invalid template, or more than "
+           << "one server per process." << std::endl;
+    return nullptr;
+  }
+
+  return std::unique_ptr<Server>(
+      new Server(std::move(this->dataPtr->server)));
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#ifndef _WIN32
+  #include <sys/wait.h>
+  #include <unistd.h>
+#endif
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Filesystem.hh>
+
+#include "ignition/gazebo/ServerTemplate.hh"
+#include "ignition/gazebo/test_config.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(ServerTemplateTest, Invalid)
+{
+  ServerConfig config;
+  config.SetSdfFile("does_not_exist.sdf");
+
+  ServerTemplate serverTemplate(config);
+  EXPECT_FALSE(serverTemplate.Valid());
+  EXPECT_EQ(-1, serverTemplate.Fork("invalid"));
+  EXPECT_EQ(nullptr, serverTemplate.CreateServer());
+}
+
+#ifndef _WIN32
+/////////////////////////////////////////////////
+TEST(ServerTemplateTest, Fork)
+{
+  // Runs before any server is created in this process, since forking
+  // isn't safe once transport started its threads
+  ServerConfig config;
+  config.SetSdfFile(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+
+  ServerTemplate serverTemplate(config);
+  ASSERT_TRUE(serverTemplate.Valid());
+
+  const int workerCount{3};
+  std::vector<int> pids;
+  for (int i = 0; i < workerCount; ++i)
+  {
+    auto partition = "server_template_" + std::to_string(i);
+    auto pid = serverTemplate.Fork(partition);
+    if (pid == 0)
+    {
+      // Don't use gtest macros in the worker, its result is the exit code
+      auto server = serverTemplate.CreateServer();
+      bool ok = nullptr != server &&
+          std::string(getenv("IGN_PARTITION")) == partition &&
+          server->Run(true, 10 + i, false) &&
+          *server->IterationCount() == static_cast<uint64_t>(10 + i) &&
+          server->HasEntity("sphere");
+      _exit(ok ? 0 : 1);
+    }
+    ASSERT_GT(pid, 0);
+    pids.push_back(pid);
+  }
+
+  for (auto pid : pids)
+  {
+    int status{-1};
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(0, WEXITSTATUS(status));
+  }
+
+  // The template can still be used by this process
+  EXPECT_TRUE(serverTemplate.Valid());
+}
+#endif
+
+/////////////////////////////////////////////////
+TEST(ServerTemplateTest, CreateServer)
+{
+  ServerConfig config;
+  config.SetSdfFile(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+
+  ServerTemplate serverTemplate(config);
+  ASSERT_TRUE(serverTemplate.Valid());
+
+  auto server = serverTemplate.CreateServer();
+  ASSERT_NE(nullptr, server);
+  EXPECT_FALSE(serverTemplate.Valid());
+  EXPECT_EQ(nullptr, serverTemplate.CreateServer());
+
+  EXPECT_TRUE(server->Run(true, 10, false));
+  EXPECT_EQ(10u, *server->IterationCount());
+  EXPECT_TRUE(server->HasEntity("box"));
+}
+
@@ -17,6 +17,7 @@
 
 #include <gtest/gtest.h>
 #include <csignal>
+#include <string>
 #include <vector>
 #include <ignition/common/StringUtils.hh>
 #include <ignition/common/Util.hh>
@@ -27,6 +28,8 @@
 #include "ignition/gazebo/components/AxisAlignedBox.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/System.hh"
@@ -591,6 +594,82 @@ TEST_P(ServerFixture, RunNonBlockingMultiple)
   EXPECT_FALSE(*server.Running(0));
 }
 
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, RunMultipleWorlds)
+{
+  // More worlds than worker threads, so they take turns
+  std::string sdf = "<?xml version='1.0'?><sdf version='1.6'>";
+  for (int i = 0; i < 3; ++i)
+    sdf += "<world name='world_" + std::to_string(i) + "'/>";
+  sdf += "</sdf>";
+
+  ServerConfig serverConfig;
+  serverConfig.SetSdfString(sdf);
+  serverConfig.SetWorkerThreads(2);
+
+  gazebo::Server server(serverConfig);
+  for (unsigned int i = 0; i < 3; ++i)
+    server.SetUpdatePeriod(1ns, i);
+
+  EXPECT_TRUE(server.Run(true, 100, false));
+  EXPECT_FALSE(server.Running());
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    EXPECT_FALSE(*server.Running(i));
+    EXPECT_EQ(100u, *server.IterationCount(i));
+    ASSERT_TRUE(server.RealTimeFactor(i).has_value());
+    EXPECT_GT(*server.RealTimeFactor(i), 0.0);
+  }
+  EXPECT_FALSE(server.RealTimeFactor(3).has_value());
+}
+
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, RunBatch)
+{
+  ServerConfig serverConfig;
+  serverConfig.SetSdfString(TestWorldSansPhysics::World());
+  serverConfig.SetBatchSize(3);
+  EXPECT_EQ(3u, serverConfig.BatchSize());
+
+  gazebo::Server server(serverConfig);
+  ASSERT_TRUE(server.HasEntity("default", 0));
+  ASSERT_TRUE(server.HasEntity("default_1", 1));
+  ASSERT_TRUE(server.HasEntity("default_2", 2));
+
+  // Entities have the same ID in every copy
+  const Entity world = *server.EntityByName("default", 0);
+  EXPECT_EQ(world, *server.EntityByName("default_1", 1));
+  EXPECT_EQ(world, *server.EntityByName("default_2", 2));
+
+  std::vector<std::string> names;
+  EXPECT_TRUE(server.BatchComponentData<components::Name>(world, names));
+  EXPECT_EQ(std::vector<std::string>({"default", "default_1", "default_2"}),
+      names);
+
+  // A component the entity doesn't have yet
+  std::vector<math::Pose3d> poses;
+  EXPECT_FALSE(server.BatchComponentData<components::Pose>(world, poses));
+  EXPECT_EQ(3u, poses.size());
+
+  // Data for the wrong number of worlds
+  EXPECT_FALSE(server.SetBatchComponentData<components::Pose>(world,
+      {math::Pose3d::Zero}));
+
+  poses = {math::Pose3d(1, 0, 0, 0, 0, 0), math::Pose3d(2, 0, 0, 0, 0, 0),
+      math::Pose3d(3, 0, 0, 0, 0, 0)};
+  EXPECT_TRUE(server.SetBatchComponentData<components::Pose>(world, poses));
+
+  // All copies step together
+  EXPECT_TRUE(server.RunOnce(false));
+  for (unsigned int i = 0; i < 3; ++i)
+    EXPECT_EQ(1u, *server.IterationCount(i));
+
+  std::vector<math::Pose3d> result;
+  EXPECT_TRUE(server.BatchComponentData<components::Pose>(world, result));
+  EXPECT_EQ(poses, result);
+}
+
 /////////////////////////////////////////////////
 TEST_P(ServerFixture, SigInt)
 {
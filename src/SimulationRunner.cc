@@ -18,37 +18,154 @@
 #include "SimulationRunner.hh"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <future>
+#include <numeric>
+#include <set>
+#include <string>
+#include <utility>
 
 #include <sdf/Root.hh>
 
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+
 #include "ignition/common/Profiler.hh"
+#include "ignition/gazebo/components/AngularVelocityCmd.hh"
+#include "ignition/gazebo/components/Factory.hh"
+#include "ignition/gazebo/components/Joint.hh"
+#include "ignition/gazebo/components/JointAxis.hh"
+#include "ignition/gazebo/components/JointPositionReset.hh"
+#include "ignition/gazebo/components/JointVelocityReset.hh"
+#include "ignition/gazebo/components/LinearVelocityCmd.hh"
 #include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/PoseCmd.hh"
 #include "ignition/gazebo/components/Sensor.hh"
+#include "ignition/gazebo/components/Static.hh"
 #include "ignition/gazebo/components/Visual.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/components/Physics.hh"
 #include "ignition/gazebo/components/PhysicsCmd.hh"
 #include "ignition/gazebo/Events.hh"
+#include "ignition/gazebo/ParallelTasks.hh"
 #include "ignition/gazebo/SdfEntityCreator.hh"
+#include "ignition/gazebo/ThreadAffinity.hh"
 #include "ignition/gazebo/Util.hh"
 
 #include "network/NetworkManagerPrimary.hh"
-#include "SdfGenerator.hh"
+#include "Tracepoints.hh"
 
 using namespace ignition;
 using namespace gazebo;
 
 using StringSet = std::unordered_set<std::string>;
 
+/// \brief Records the ECM accesses of the calling thread under a system's
+/// name while it's in scope, if accesses are traced.
+class AccessContext
+{
+  /// \brief Constructor.
+  /// \param[in] _ecm Entity component manager which may be traced.
+  /// \param[in] _system Name of the system.
+  /// \param[in] _phase Name of the callback.
+  public: AccessContext(const EntityComponentManager &_ecm,
+              const std::string &_system, const char *_phase)
+    : enabled(_ecm.AccessTracing())
+  {
+    if (this->enabled)
+      EntityComponentManager::SetAccessContext(_system + " " + _phase);
+  }
+
+  /// \brief Destructor, clears the context.
+  public: ~AccessContext()
+  {
+    if (this->enabled)
+      EntityComponentManager::SetAccessContext("");
+  }
+
+  /// \brief Whether a context was set.
+  private: bool enabled;
+};
+
+//////////////////////////////////////////////////
+void SystemTiming::Add(const std::chrono::steady_clock::duration &_duration)
+{
+  if (this->samples.size() < kWindowSize)
+  {
+    this->samples.push_back(_duration);
+  }
+  else
+  {
+    this->samples[this->next] = _duration;
+    this->next = (this->next + 1) % kWindowSize;
+  }
+
+  this->smoothed = (this->smoothed * 7 + _duration) / 8;
+}
+
+//////////////////////////////////////////////////
+std::size_t SystemTiming::Count() const
+{
+  return this->samples.size();
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration SystemTiming::Mean() const
+{
+  if (this->samples.empty())
+    return std::chrono::steady_clock::duration::zero();
+
+  return std::accumulate(this->samples.begin(), this->samples.end(),
+      std::chrono::steady_clock::duration::zero()) /
+      static_cast<int64_t>(this->samples.size());
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration SystemTiming::Max() const
+{
+  if (this->samples.empty())
+    return std::chrono::steady_clock::duration::zero();
+
+  return *std::max_element(this->samples.begin(), this->samples.end());
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration SystemTiming::Percentile(
+    double _percentile) const
+{
+  if (this->samples.empty())
+    return std::chrono::steady_clock::duration::zero();
+
+  auto sorted = this->samples;
+  auto rank = static_cast<std::size_t>(std::ceil(
+      std::clamp(_percentile, 0.0, 100.0) / 100.0 * sorted.size()));
+  auto nth = sorted.begin() + (rank == 0 ? 0 : rank - 1);
+  std::nth_element(sorted.begin(), nth, sorted.end());
+  return *nth;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration SystemTiming::Smoothed() const
+{
+  return this->smoothed;
+}
 
 //////////////////////////////////////////////////
 SimulationRunner::SimulationRunner(const sdf::World *_world,
                                    const SystemLoaderPtr &_systemLoader,
-                                   const ServerConfig &_config)
+                                   const ServerConfig &_config,
+                                   common::WorkerPool *_workerPool)
+    : workerPool(_workerPool), workerThreads(_config.WorkerThreads()),
     // \todo(nkoenig) Either copy the world, or add copy constructor to the
     // World and other elements.
-    : sdfWorld(_world), serverConfig(_config)
+      sdfWorld(_world), serverConfig(_config),
+      timeline(_config.TimelineSteps()),
+      timelineThreshold(_config.TimelineThreshold())
 {
   if (nullptr == _world)
   {
@@ -56,12 +173,49 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
     return;
   }
 
+  auto phaseStart = std::chrono::steady_clock::now();
+
+  if (nullptr == this->workerPool)
+  {
+    this->ownWorkerPool = std::make_unique<common::WorkerPool>(
+        std::max(2u, _config.WorkerThreads()));
+    SetWorkerPoolCpus(*this->ownWorkerPool,
+        std::max(2u, _config.WorkerThreads()), _config.WorkerCpus());
+    this->workerPool = this->ownWorkerPool.get();
+  }
+
+  // Let the ECM process entities in parallel, for ParallelEach and State
+  this->entityCompMgr.SetWorkerPool(this->workerPool, this->workerThreads);
+  this->entityCompMgr.SetComponentBlockSize(_config.ComponentBlockSize());
+
   // Keep world name
   this->worldName = _world->Name();
+  this->localState = LocalStateChannel::Create(this->worldName);
 
   // Keep system loader so plugins can be loaded at runtime
   this->systemLoader = _systemLoader;
 
+  // Finding and opening plugin libraries is mostly disk access, so it's
+  // done in the background while entities are created. Plugins are still
+  // instantiated on this thread, from the loaded libraries.
+  std::future<std::chrono::steady_clock::time_point> preloadDone;
+  const auto preloadStart = std::chrono::steady_clock::now();
+  if (this->systemLoader)
+  {
+    std::vector<std::string> filenames;
+    for (const auto &plugin : _config.Plugins())
+      filenames.push_back(plugin.Filename());
+
+    preloadDone = std::async(std::launch::async,
+        [loader = this->systemLoader, elem = _world->Element(), filenames]
+        {
+          loader->PreloadLibraries(elem);
+          for (const auto &filename : filenames)
+            loader->PreloadLibrary(filename);
+          return std::chrono::steady_clock::now();
+        });
+  }
+
   // Get the physics profile
   // TODO(luca): remove duplicated logic in SdfEntityCreator and LevelManager
   auto physics = _world->PhysicsByIndex(0);
@@ -76,6 +230,8 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
   this->stepSize =
       std::chrono::duration_cast<std::chrono::steady_clock::duration>(
       dur);
+  this->lastStepSize = this->stepSize;
+  this->lastMaxStepSize = this->stepSize;
 
   // Desired real time factor
   this->desiredRtf = physics->RealTimeFactor();
@@ -106,6 +262,9 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
   this->updatePeriod = std::chrono::nanoseconds(
       static_cast<int>(this->stepSize.count() / this->desiredRtf));
 
+  this->pacer = Pacer(_config.Pacing(), _config.PacingSpinTime(),
+      _config.ExternalPacing());
+
   this->pauseConn = this->eventMgr.Connect<events::Pause>(
       std::bind(&SimulationRunner::SetPaused, this, std::placeholders::_1));
 
@@ -116,9 +275,20 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
       std::bind(&SimulationRunner::LoadPlugins, this, std::placeholders::_1,
       std::placeholders::_2));
 
+  this->requestStepSizeConn = this->eventMgr.Connect<events::RequestStepSize>(
+      [this](const std::chrono::steady_clock::duration &_step)
+      {
+        this->requestedStepSize = std::max<int64_t>(0,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+            _step).count());
+      });
+
   // Create the level manager
   this->levelMgr = std::make_unique<LevelManager>(this, _config.UseLevels());
 
+  auto phaseEnd = std::chrono::steady_clock::now();
+  this->AddStartupPhase("create_world", phaseStart, phaseEnd);
+
   // Check if this is going to be a distributed runner
   // Attempt to create the manager based on environment variables.
   // If the configuration is invalid, then networkMgr will be `nullptr`.
@@ -156,10 +326,37 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
     }
   }
 
+  if (_config.OverlapPostUpdate())
+  {
+    if (this->networkMgr)
+    {
+      ignwarn << "PostUpdate can't overlap the next step with distributed "
+              << "simulation, it will run at the end of each step."
+              << std::endl;
+    }
+    else
+    {
+      this->overlapPostUpdate = true;
+    }
+  }
+
+  this->deterministic = _config.Deterministic();
+
+  this->ecmAccessReportPath = _config.EcmAccessReportPath();
+  if (!this->ecmAccessReportPath.empty())
+    this->entityCompMgr.SetAccessTracing(true);
+
   // Load the active levels
+  phaseStart = std::chrono::steady_clock::now();
   this->levelMgr->UpdateLevelsState();
+  phaseEnd = std::chrono::steady_clock::now();
+  this->AddStartupPhase("create_entities", phaseStart, phaseEnd);
+
+  if (preloadDone.valid())
+    this->AddStartupPhase("preload_plugins", preloadStart, preloadDone.get());
 
   // Load any additional plugins from the Server Configuration
+  phaseStart = std::chrono::steady_clock::now();
   this->LoadServerPlugins(this->serverConfig.Plugins());
 
   // If we have reached this point and no systems have been loaded, then load
@@ -171,8 +368,14 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
     auto plugins = ignition::gazebo::loadPluginInfo(isPlayback);
     this->LoadServerPlugins(plugins);
   }
+  phaseEnd = std::chrono::steady_clock::now();
+  this->AddStartupPhase("load_plugins", phaseStart, phaseEnd);
 
+  phaseStart = phaseEnd;
   this->LoadLoggingPlugins(this->serverConfig);
+  phaseEnd = std::chrono::steady_clock::now();
+  this->AddStartupPhase("load_logging_plugins", phaseStart, phaseEnd);
+  phaseStart = phaseEnd;
 
   // World control
   transport::NodeOptions opts;
@@ -202,6 +405,20 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
          << "/control] and [" << opts.NameSpace() << "/playback/control]"
          << std::endl;
 
+  if (!this->serverConfig.LogPlaybackPath().empty())
+  {
+    this->node->Advertise("playback/rate", &SimulationRunner::OnPlaybackRate,
+        this);
+
+    ignmsg << "Serving playback rate on [" << opts.NameSpace()
+           << "/playback/rate]" << std::endl;
+  }
+
+  this->node->Advertise("reset", &SimulationRunner::ResetService, this);
+
+  ignmsg << "Serving world reset on [" << opts.NameSpace() << "/reset]"
+         << std::endl;
+
   // Publish empty GUI messages for worlds that have no GUI in the beginning.
   // In the future, support modifying GUI from the server at runtime.
   if (_world->Gui())
@@ -218,18 +435,74 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
   ignmsg << "World [" << _world->Name() << "] initialized with ["
          << physics->Name() << "] physics profile." << std::endl;
 
+  std::string systemStatsTopic{"stats/systems"};
+  this->systemStatsPub =
+      this->node->Advertise<msgs::Param_V>(systemStatsTopic);
+
+  std::string systemStatsService{"system_stats"};
+  this->node->Advertise(systemStatsService,
+      &SimulationRunner::SystemStatsService, this);
+
+  ignmsg << "Publishing system statistics on [" << opts.NameSpace() << "/"
+         << systemStatsTopic << "] and serving them on [" << opts.NameSpace()
+         << "/" << systemStatsService << "]" << std::endl;
+
+  std::string startupStatsService{"startup_stats"};
+  this->node->Advertise(startupStatsService,
+      &SimulationRunner::StartupStatsService, this);
+
+  ignmsg << "Serving startup statistics on [" << opts.NameSpace() << "/"
+         << startupStatsService << "]" << std::endl;
+
+  std::string countersTopic{"stats/counters"};
+  this->countersPub = this->node->Advertise<msgs::Param_V>(countersTopic);
+
+  ignmsg << "Publishing entity component manager counters on ["
+         << opts.NameSpace() << "/" << countersTopic << "]" << std::endl;
+
+  std::string ecmMemoryService{"ecm/memory"};
+  this->node->Advertise(ecmMemoryService,
+      &SimulationRunner::EcmMemoryService, this);
+
+  if (this->timeline.Enabled())
+  {
+    std::string timelineService{"timeline"};
+    this->node->Advertise(timelineService,
+        &SimulationRunner::TimelineService, this);
+
+    ignmsg << "Recording the last [" << _config.TimelineSteps()
+           << "] steps, written on request on [" << opts.NameSpace() << "/"
+           << timelineService << "]" << std::endl;
+  }
+
+  ignmsg << "Serving entity component manager memory usage on ["
+         << opts.NameSpace() << "/" << ecmMemoryService << "]" << std::endl;
+
   std::string genWorldSdfService{"generate_world_sdf"};
   this->node->Advertise(
       genWorldSdfService, &SimulationRunner::GenerateWorldSdf, this);
 
   ignmsg << "Serving world SDF generation service on [" << opts.NameSpace()
          << "/" << genWorldSdfService << "]" << std::endl;
+
+  this->AddStartupPhase("transport", phaseStart,
+      std::chrono::steady_clock::now());
 }
 
 //////////////////////////////////////////////////
 SimulationRunner::~SimulationRunner()
 {
-  this->StopWorkerThreads();
+  this->StopPostUpdate();
+
+  // Running AsyncUpdate calls use the systems and their copies of the ECM
+  for (auto &async : this->systemsAsync)
+  {
+    if (async.result.valid())
+      async.result.wait();
+  }
+
+  if (!this->ecmAccessReportPath.empty())
+    this->WriteEcmAccessReport();
 }
 
 /////////////////////////////////////////////////
@@ -326,9 +599,47 @@ void SimulationRunner::UpdateCurrentInfo()
   if (!this->currentInfo.paused &&
       (!this->networkMgr || this->networkMgr->IsPrimary()))
   {
-    this->currentInfo.simTime += this->stepSize;
+    const auto step = this->ActiveStepSize();
+    if (step != this->lastStepSize)
+    {
+      // Keep the real time factor when a system changed the step, scaling
+      // whatever update period is set. The period is left as is when the
+      // step size itself was set.
+      if (this->lastStepSize.count() > 0 &&
+          this->lastMaxStepSize == this->stepSize)
+      {
+        this->updatePeriod = std::chrono::duration_cast<
+            std::chrono::steady_clock::duration>(this->updatePeriod *
+            (static_cast<double>(step.count()) / this->lastStepSize.count()));
+      }
+      this->lastStepSize = step;
+      this->eventMgr.Emit<events::StepSizeChanged>(step);
+    }
+    this->lastMaxStepSize = this->stepSize;
+
+    if (this->playbackRate == 1.0)
+    {
+      this->currentInfo.simTime += step;
+      ++this->currentInfo.iterations;
+      this->currentInfo.dt = step;
+      return;
+    }
+
+    // Playback at another rate moves through the log by a scaled step, which
+    // is negative when playing backward. LogPlayback rebuilds each backward
+    // step from the latest keyframe before it.
+    auto scaledStep = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(step * this->playbackRate);
+    if (this->currentInfo.simTime + scaledStep <
+        std::chrono::steady_clock::duration::zero())
+    {
+      scaledStep = -this->currentInfo.simTime;
+      ignmsg << "Reached the start of the log, pausing." << std::endl;
+      this->SetPaused(true);
+    }
+    this->currentInfo.simTime += scaledStep;
     ++this->currentInfo.iterations;
-    this->currentInfo.dt = this->stepSize;
+    this->currentInfo.dt = scaledStep;
   }
 }
 
@@ -359,8 +670,9 @@ void SimulationRunner::UpdatePhysicsParams()
       std::chrono::duration_cast<std::chrono::steady_clock::duration>(
         newStepSize));
     this->desiredRtf = newRTF;
+
     this->updatePeriod = std::chrono::nanoseconds(
-        static_cast<int>(this->stepSize.count() / this->desiredRtf));
+        static_cast<int>(this->ActiveStepSize().count() / this->desiredRtf));
 
     this->simTimes.clear();
     this->realTimes.clear();
@@ -398,6 +710,29 @@ void SimulationRunner::PublishStats()
 
   msg.set_paused(this->currentInfo.paused);
 
+  // How far from their due time iterations start
+  if (this->pacingJitter.Count() > 0)
+  {
+    auto addJitter = [&](const std::string &_key,
+        const std::chrono::steady_clock::duration &_jitter)
+    {
+      auto data = msg.mutable_header()->add_data();
+      data->set_key(_key);
+      data->add_value(std::to_string(
+          std::chrono::duration<double, std::micro>(_jitter).count()));
+    };
+    addJitter("pacing_jitter_mean_us", this->pacingJitter.Mean());
+    addJitter("pacing_jitter_p99_us", this->pacingJitter.Percentile(99.0));
+    addJitter("pacing_jitter_max_us", this->pacingJitter.Max());
+  }
+
+  this->UpdateEcmMemoryStats();
+  {
+    auto data = msg.mutable_header()->add_data();
+    data->set_key("ecm_memory_bytes");
+    data->add_value(std::to_string(this->ecmMemoryBytes));
+  }
+
   // Publish the stats message. The stats message is throttled.
   this->statsPub.Publish(msg);
 
@@ -419,6 +754,254 @@ void SimulationRunner::PublishStats()
   // Only publish to root topic if no others are.
   if (this->rootClockPub.Valid())
     this->rootClockPub.Publish(clockMsg);
+
+  this->PublishSystemStats();
+  this->PublishCounters();
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::PublishSystemStats()
+{
+  auto now = std::chrono::steady_clock::now();
+  if (now - this->systemStatsPublishTime < std::chrono::seconds(1))
+    return;
+  this->systemStatsPublishTime = now;
+
+  IGN_PROFILE("SimulationRunner::PublishSystemStats");
+
+  auto toMs = [](const std::chrono::steady_clock::duration &_duration)
+  {
+    return std::chrono::duration<double, std::milli>(_duration).count();
+  };
+
+  auto setDouble = [](msgs::Param &_param, const std::string &_key,
+      double _value)
+  {
+    auto &any = (*_param.mutable_params())[_key];
+    any.set_type(msgs::Any::DOUBLE);
+    any.set_double_value(_value);
+  };
+
+  auto addPhase = [&](msgs::Param &_param, const std::string &_phase,
+      const SystemTiming &_timing)
+  {
+    setDouble(_param, _phase + "_mean_ms", toMs(_timing.Mean()));
+    setDouble(_param, _phase + "_p99_ms", toMs(_timing.Percentile(99.0)));
+    setDouble(_param, _phase + "_max_ms", toMs(_timing.Max()));
+  };
+
+  msgs::Param_V msg;
+  for (std::size_t i = 0; i < this->systems.size(); ++i)
+  {
+    const auto &system = this->systems[i];
+    auto *param = msg.add_param();
+
+    auto &name = (*param->mutable_params())["name"];
+    name.set_type(msgs::Any::STRING);
+    name.set_string_value(system.systemPlugin->Name());
+
+    // Several instances of the same plugin are told apart by their index
+    auto &index = (*param->mutable_params())["index"];
+    index.set_type(msgs::Any::INT32);
+    index.set_int_value(static_cast<int>(i));
+
+    if (system.preupdate)
+      addPhase(*param, "pre_update", system.preupdateTiming);
+    if (system.update)
+      addPhase(*param, "update", system.updateTiming);
+    if (system.postupdate)
+    {
+      // Overlapping systems may be recording their timing meanwhile
+      std::lock_guard<std::mutex> lock(this->postUpdateMutex);
+      addPhase(*param, "post_update", system.postupdateTiming);
+    }
+    if (system.asyncupdate)
+      addPhase(*param, "async_update", system.asyncupdateTiming);
+  }
+
+  this->systemStatsPub.Publish(msg);
+
+  std::lock_guard<std::mutex> lock(this->systemStatsMutex);
+  this->systemStatsMsg = std::move(msg);
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::PublishCounters()
+{
+  auto now = std::chrono::steady_clock::now();
+  if (now - this->countersPublishTime < std::chrono::seconds(1))
+    return;
+  this->countersPublishTime = now;
+
+  // Skip the work when nobody listens
+  if (!this->countersPub.HasConnections())
+    return;
+
+  IGN_PROFILE("SimulationRunner::PublishCounters");
+
+  // Any has no 64 bit integers, doubles are exact up to 2^53
+  auto setInt = [](msgs::Param &_param, const std::string &_key,
+      uint64_t _value)
+  {
+    auto &any = (*_param.mutable_params())[_key];
+    any.set_type(msgs::Any::DOUBLE);
+    any.set_double_value(static_cast<double>(_value));
+  };
+
+  const auto counters = this->entityCompMgr.Counters();
+
+  // The first param holds the totals, followed by one param per view
+  msgs::Param_V msg;
+  auto *total = msg.add_param();
+  setInt(*total, "components_created", counters.componentsCreated);
+  setInt(*total, "components_removed", counters.componentsRemoved);
+  setInt(*total, "views_created", counters.viewsCreated);
+  setInt(*total, "view_rebuilds", counters.viewRebuilds);
+  setInt(*total, "state_bytes", counters.stateBytes);
+
+  for (const auto &view : counters.views)
+  {
+    auto *param = msg.add_param();
+
+    std::string types;
+    for (const auto type : view.types)
+    {
+      if (!types.empty())
+        types += " ";
+      types += components::Factory::Instance()->Name(type);
+    }
+    auto &typesAny = (*param->mutable_params())["types"];
+    typesAny.set_type(msgs::Any::STRING);
+    typesAny.set_string_value(types);
+
+    setInt(*param, "each_calls", view.eachCalls);
+    setInt(*param, "entities_visited", view.entitiesVisited);
+  }
+
+  this->countersPub.Publish(msg);
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::WriteEcmAccessReport() const
+{
+  const auto stats = this->entityCompMgr.AccessStats();
+  auto *factory = components::Factory::Instance();
+
+  // Accesses made outside of systems, such as by the runner itself
+  auto contextName = [](const std::string &_context)
+  {
+    return _context.empty() ? std::string("(runner)") : _context;
+  };
+
+  // Several worlds may share a report, so each appends its own section.
+  // Columns are tab separated to ease loading them into other tools.
+  std::ofstream file(this->ecmAccessReportPath, std::ios::app);
+  file << "# world\t" << this->worldName << "\n"
+       << "# context\tcomponent\treads\twrites\n";
+  for (const auto &access : stats.components)
+  {
+    file << contextName(access.context) << "\t"
+         << factory->Name(access.type) << "\t"
+         << access.reads << "\t" << access.writes << "\n";
+  }
+
+  file << "# context\tview\tread_calls\twrite_calls\tentities_visited\n";
+  for (const auto &view : stats.views)
+  {
+    std::string types;
+    for (const auto type : view.types)
+    {
+      if (!types.empty())
+        types += " ";
+      types += factory->Name(type);
+    }
+    file << contextName(view.context) << "\t" << types << "\t"
+         << view.readCalls << "\t" << view.writeCalls << "\t"
+         << view.entitiesVisited << "\n";
+  }
+  file << "\n";
+
+  if (!file)
+  {
+    ignerr << "Failed to write ECM access report [" << this->ecmAccessReportPath
+           << "]" << std::endl;
+    return;
+  }
+  ignmsg << "Wrote ECM accesses of world [" << this->worldName << "] to ["
+         << this->ecmAccessReportPath << "]" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::UpdateEcmMemoryStats()
+{
+  auto now = std::chrono::steady_clock::now();
+  if (now - this->ecmMemoryTime < std::chrono::seconds(1))
+    return;
+  this->ecmMemoryTime = now;
+
+  IGN_PROFILE("SimulationRunner::UpdateEcmMemoryStats");
+
+  auto usage = this->entityCompMgr.MemoryUsage();
+  this->ecmMemoryBytes = usage.TotalBytes();
+
+  auto setDouble = [](msgs::Param &_param, const std::string &_key,
+      double _value)
+  {
+    auto &any = (*_param.mutable_params())[_key];
+    any.set_type(msgs::Any::DOUBLE);
+    any.set_double_value(_value);
+  };
+
+  auto setString = [](msgs::Param &_param, const std::string &_key,
+      const std::string &_value)
+  {
+    auto &any = (*_param.mutable_params())[_key];
+    any.set_type(msgs::Any::STRING);
+    any.set_string_value(_value);
+  };
+
+  msgs::Param_V msg;
+
+  auto *total = msg.add_param();
+  setString(*total, "name", "total");
+  setDouble(*total, "bytes", static_cast<double>(this->ecmMemoryBytes));
+  setDouble(*total, "entities", static_cast<double>(usage.entityCount));
+  setDouble(*total, "entity_bytes", static_cast<double>(usage.entityBytes));
+  setDouble(*total, "change_tracking_bytes",
+      static_cast<double>(usage.changeTrackingBytes));
+  setDouble(*total, "cache_bytes", static_cast<double>(usage.cacheBytes));
+  setDouble(*total, "views", static_cast<double>(usage.views.size()));
+
+  for (const auto &storage : usage.storages)
+  {
+    auto *param = msg.add_param();
+    setString(*param, "name",
+        components::Factory::Instance()->Name(storage.type));
+    setString(*param, "type", std::to_string(storage.type));
+    setDouble(*param, "size", static_cast<double>(storage.size));
+    setDouble(*param, "capacity", static_cast<double>(storage.capacity));
+    setDouble(*param, "bytes", static_cast<double>(storage.bytes));
+  }
+
+  for (const auto &view : usage.views)
+  {
+    std::string types;
+    for (const auto type : view.types)
+    {
+      if (!types.empty())
+        types += " ";
+      types += components::Factory::Instance()->Name(type);
+    }
+
+    auto *param = msg.add_param();
+    setString(*param, "name", "view");
+    setString(*param, "types", types);
+    setDouble(*param, "size", static_cast<double>(view.size));
+    setDouble(*param, "bytes", static_cast<double>(view.bytes));
+  }
+
+  std::lock_guard<std::mutex> lock(this->ecmMemoryMutex);
+  this->ecmMemoryMsg = std::move(msg);
 }
 
 /////////////////////////////////////////////////
@@ -435,14 +1018,99 @@ void SimulationRunner::AddSystemToRunner(const SystemPluginPtr &_system)
 
   const auto &system = this->systems.back();
 
-  if (system.preupdate)
-    this->systemsPreupdate.push_back(system.preupdate);
+  if (system.postupdate)
+  {
+    // Systems which implement other phases could race with themselves
+    if (this->overlapPostUpdate && !system.preupdate && !system.update)
+      this->systemsPostupdateOverlap.push_back(this->systems.size() - 1);
+    else
+      this->systemsPostupdate.push_back(this->systems.size() - 1);
+  }
+
+  if (system.asyncupdate)
+  {
+    AsyncSystemInternal async;
+    async.system = this->systems.size() - 1;
+    async.iterations =
+        std::max<uint64_t>(1u, system.asyncupdate->AsyncUpdateIterations());
+    async.ecm = std::make_unique<EntityComponentManager>();
+    async.ecm->SetWorkerPool(this->workerPool, this->workerThreads);
+    this->systemsAsync.push_back(std::move(async));
+  }
+}
 
-  if (system.update)
-    this->systemsUpdate.push_back(system.update);
+/////////////////////////////////////////////////
+void SimulationRunner::ScheduleSystems()
+{
+  // Component types accessed by a system. Systems which don't declare their
+  // access conflict with all other systems.
+  struct Access
+  {
+    bool declared{false};
+    std::set<ComponentTypeId> reads;
+    std::set<ComponentTypeId> writes;
+  };
 
-  if (system.postupdate)
-    this->systemsPostupdate.push_back(system.postupdate);
+  auto intersects = [](const std::set<ComponentTypeId> &_a,
+      const std::set<ComponentTypeId> &_b)
+  {
+    for (const auto &type : _a)
+    {
+      if (_b.find(type) != _b.end())
+        return true;
+    }
+    return false;
+  };
+
+  auto conflicts = [&](const Access &_a, const Access &_b)
+  {
+    return !_a.declared || !_b.declared ||
+        intersects(_a.writes, _b.writes) || intersects(_a.writes, _b.reads) ||
+        intersects(_a.reads, _b.writes);
+  };
+
+  // Each system must run after all earlier systems it conflicts with, so it's
+  // placed on the level after the latest of those. This keeps the order in
+  // which conflicting systems were added.
+  auto schedule = [&](auto _interface, auto &_levels)
+  {
+    std::vector<std::pair<Access, std::size_t>> scheduled;
+    _levels.clear();
+
+    for (std::size_t index = 0; index < this->systems.size(); ++index)
+    {
+      const auto &system = this->systems[index];
+      if (nullptr == system.*_interface)
+        continue;
+
+      Access access;
+      if (nullptr != system.access)
+      {
+        access.declared = true;
+        access.reads = system.access->ComponentsRead();
+        access.writes = system.access->ComponentsWritten();
+      }
+
+      std::size_t level = 0;
+      for (const auto &other : scheduled)
+      {
+        if (conflicts(access, other.first))
+          level = std::max(level, other.second + 1);
+      }
+
+      if (level == _levels.size())
+        _levels.emplace_back();
+      _levels[level].push_back(index);
+      scheduled.emplace_back(std::move(access), level);
+    }
+  };
+
+  schedule(&SystemInternal::preupdate, this->systemsPreupdate);
+  schedule(&SystemInternal::update, this->systemsUpdate);
+
+  igndbg << "Scheduled PreUpdate systems in [" << this->systemsPreupdate.size()
+         << "] levels and Update systems in [" << this->systemsUpdate.size()
+         << "] levels." << std::endl;
 }
 
 /////////////////////////////////////////////////
@@ -451,11 +1119,9 @@ void SimulationRunner::ProcessSystemQueue()
   std::lock_guard<std::mutex> lock(this->pendingSystemsMutex);
   auto pending = this->pendingSystems.size();
 
+  // Adding systems may move those which overlap the next step
   if (pending > 0)
-  {
-    // If additional systems are to be added, stop the existing threads.
-    this->StopWorkerThreads();
-  }
+    this->WaitForPostUpdate();
 
   for (const auto &system : this->pendingSystems)
   {
@@ -464,110 +1130,401 @@ void SimulationRunner::ProcessSystemQueue()
 
   this->pendingSystems.clear();
 
-  // If additional systems were added, recreate the worker threads.
   if (pending > 0)
-  {
-    igndbg << "Creating PostUpdate worker threads: "
-      << this->systemsPostupdate.size() + 1 << std::endl;
-
-    this->postUpdateStartBarrier =
-      std::make_unique<Barrier>(this->systemsPostupdate.size() + 1);
-    this->postUpdateStopBarrier =
-      std::make_unique<Barrier>(this->systemsPostupdate.size() + 1);
+    this->ScheduleSystems();
+}
 
-    this->postUpdateThreadsRunning = true;
-    int id = 0;
+/////////////////////////////////////////////////
+void SimulationRunner::UpdateSystems()
+{
+  IGN_PROFILE("SimulationRunner::UpdateSystems");
+  // Systems within a level don't conflict with each other, so they run
+  // concurrently. Most levels hold a single system, which runs on this thread
+  // without going through the worker pool. In deterministic mode, structural
+  // changes made by concurrent systems are applied in system order once the
+  // level is done.
+  const unsigned int threads = this->workerThreads;
+
+  if (!this->systemsAsync.empty())
+  {
+    IGN_PROFILE("AsyncUpdate");
+    StepTimeline::Scope scope(this->timeline, "ApplyAsyncUpdates");
+    this->ApplyAsyncUpdates();
+  }
 
-    for (auto &system : this->systemsPostupdate)
+  {
+    IGN_PROFILE("PreUpdate");
+    StepTimeline::Scope scope(this->timeline, "PreUpdate");
+    for (const auto &level : this->systemsPreupdate)
     {
-      igndbg << "Creating postupdate worker thread (" << id << ")" << std::endl;
+      const bool defer = this->deterministic && level.size() > 1;
+      if (defer)
+        this->entityCompMgr.BeginDeferredChanges(level.size());
+      RunParallelTasks(this->workerPool, threads, level.size(),
+          [&](std::size_t _index)
+          {
+            if (defer)
+              this->entityCompMgr.DeferChanges(_index);
+            auto &system = this->systems[level[_index]];
+            AccessContext context(this->entityCompMgr, system.name,
+                "PreUpdate");
+            const auto start = std::chrono::steady_clock::now();
+            system.preupdate->PreUpdate(this->currentInfo,
+                this->entityCompMgr);
+            const auto duration = std::chrono::steady_clock::now() - start;
+            system.preupdateTiming.Add(duration);
+            this->timeline.AddEvent(system.name, "pre_update", start,
+                start + duration);
+            IGN_GAZEBO_TRACEPOINT2(system_pre_update, level[_index],
+                duration.count());
+          });
+      if (defer)
+        this->entityCompMgr.EndDeferredChanges();
+    }
+  }
 
-      this->postUpdateThreads.push_back(std::thread([&, id]()
-      {
-        std::stringstream ss;
-        ss << "PostUpdateThread: " << id;
-        IGN_PROFILE_THREAD_NAME(ss.str().c_str());
-        while (this->postUpdateThreadsRunning)
-        {
-          this->postUpdateStartBarrier->Wait();
-          if (this->postUpdateThreadsRunning)
+  {
+    IGN_PROFILE("Update");
+    StepTimeline::Scope scope(this->timeline, "Update");
+    for (const auto &level : this->systemsUpdate)
+    {
+      const bool defer = this->deterministic && level.size() > 1;
+      if (defer)
+        this->entityCompMgr.BeginDeferredChanges(level.size());
+      RunParallelTasks(this->workerPool, threads, level.size(),
+          [&](std::size_t _index)
           {
-            system->PostUpdate(this->currentInfo, this->entityCompMgr);
-          }
-          this->postUpdateStopBarrier->Wait();
-        }
-        igndbg << "Exiting postupdate worker thread ("
-          << id << ")" << std::endl;
-      }));
-      id++;
+            if (defer)
+              this->entityCompMgr.DeferChanges(_index);
+            auto &system = this->systems[level[_index]];
+            AccessContext context(this->entityCompMgr, system.name,
+                "Update");
+            const auto start = std::chrono::steady_clock::now();
+            system.update->Update(this->currentInfo, this->entityCompMgr);
+            const auto duration = std::chrono::steady_clock::now() - start;
+            system.updateTiming.Add(duration);
+            this->timeline.AddEvent(system.name, "update", start,
+                start + duration);
+            IGN_GAZEBO_TRACEPOINT2(system_update, level[_index],
+                duration.count());
+          });
+      if (defer)
+        this->entityCompMgr.EndDeferredChanges();
     }
   }
+
+  // Systems which overlap the next step work on a copy of this step's state
+  if (!this->systemsPostupdateOverlap.empty())
+    this->StartPostUpdate();
+
+  if (nullptr != this->localState && this->localState->Attached())
+  {
+    StepTimeline::Scope scope(this->timeline, "PublishLocalState");
+    this->PublishLocalState();
+  }
+
+  if (!this->systemsAsync.empty())
+  {
+    StepTimeline::Scope scope(this->timeline, "StartAsyncUpdates");
+    this->StartAsyncUpdates();
+  }
+
+  {
+    IGN_PROFILE("PostUpdate");
+    StepTimeline::Scope scope(this->timeline, "PostUpdate");
+    // PostUpdate systems only read from the ECM, so they all run
+    // concurrently. Free threads claim the next system, starting with the
+    // slowest ones, so a slow system doesn't hold back the cheap ones.
+    // Poses can't change meanwhile, so world poses are shared among them.
+    this->entityCompMgr.SetWorldPoseCacheEnabled(true);
+    RunParallelTasks(this->workerPool, threads,
+        this->systemsPostupdate.size(), [&](std::size_t _index)
+        {
+          const auto systemIndex = this->systemsPostupdate[_index];
+          auto &system = this->systems[systemIndex];
+          AccessContext context(this->entityCompMgr, system.name,
+              "PostUpdate");
+          const auto start = std::chrono::steady_clock::now();
+          system.postupdate->PostUpdate(this->currentInfo, this->entityCompMgr);
+          const auto duration = std::chrono::steady_clock::now() - start;
+          system.postupdateTiming.Add(duration);
+          this->timeline.AddEvent(system.name, "post_update", start,
+              start + duration);
+          IGN_GAZEBO_TRACEPOINT2(system_post_update, systemIndex,
+              duration.count());
+        });
+    this->entityCompMgr.SetWorldPoseCacheEnabled(false);
+
+    // Use the smoothed duration so the order doesn't change on every spike
+    std::stable_sort(this->systemsPostupdate.begin(),
+        this->systemsPostupdate.end(),
+        [this](std::size_t _a, std::size_t _b)
+        {
+          return this->systems[_a].postupdateTiming.Smoothed() >
+              this->systems[_b].postupdateTiming.Smoothed();
+        });
+  }
 }
 
 /////////////////////////////////////////////////
-void SimulationRunner::UpdateSystems()
+void SimulationRunner::PublishLocalState()
 {
-  IGN_PROFILE("SimulationRunner::UpdateSystems");
-  // \todo(nkoenig)  Systems used to be updated in parallel using
-  // an ignition::common::WorkerPool. There is overhead associated with
-  // this, most notably the creation and destruction of WorkOrders (see
-  // WorkerPool.cc). We could turn on parallel updates in the future, and/or
-  // turn it on if there are sufficient systems. More testing is required.
+  IGN_PROFILE("SimulationRunner::PublishLocalState");
+  const bool full = this->localState->TakeFullStateRequest();
+  std::string state;
+  this->entityCompMgr.BinaryState(state, {}, {}, full);
+  this->localState->Publish(std::move(state), full, this->currentInfo);
+}
 
+/////////////////////////////////////////////////
+void SimulationRunner::StartPostUpdate()
+{
+  IGN_PROFILE("SimulationRunner::StartPostUpdate");
   {
-    IGN_PROFILE("PreUpdate");
-    for (auto& system : this->systemsPreupdate)
-      system->PreUpdate(this->currentInfo, this->entityCompMgr);
+    StepTimeline::Scope scope(this->timeline, "WaitForPostUpdate");
+    this->WaitForPostUpdate();
   }
 
+  // The copy is brought up to date on postUpdateThread, only the changes
+  // are serialized here
   {
-    IGN_PROFILE("Update");
-    for (auto& system : this->systemsUpdate)
-      system->Update(this->currentInfo, this->entityCompMgr);
+    StepTimeline::Scope scope(this->timeline, "CopyPostUpdateState");
+    this->entityCompMgr.BinaryState(this->postUpdateState, {}, {},
+        !this->postUpdateEcmSynced);
   }
+  this->postUpdateEcmSynced = true;
+  this->postUpdateInfo = this->currentInfo;
 
+  if (!this->postUpdateThread.joinable())
   {
-    IGN_PROFILE("PostUpdate");
-    // If no systems implementing PostUpdate have been added, then
-    // the barriers will be uninitialized, so guard against that condition.
-    if (this->postUpdateStartBarrier && this->postUpdateStopBarrier)
-    {
-      this->postUpdateStartBarrier->Wait();
-      this->postUpdateStopBarrier->Wait();
-    }
+    this->postUpdateEcm.SetWorkerPool(this->workerPool, this->workerThreads);
+    this->postUpdateThread =
+        std::thread(&SimulationRunner::PostUpdateLoop, this);
   }
+
+  {
+    std::lock_guard<std::mutex> lock(this->postUpdateMutex);
+    this->postUpdatePending = true;
+  }
+  this->postUpdateCv.notify_all();
 }
 
 /////////////////////////////////////////////////
-void SimulationRunner::Stop()
+void SimulationRunner::WaitForPostUpdate()
 {
-  this->eventMgr.Emit<events::Stop>();
+  std::unique_lock<std::mutex> lock(this->postUpdateMutex);
+  this->postUpdateCv.wait(lock, [this] {return !this->postUpdatePending;});
 }
 
 /////////////////////////////////////////////////
-void SimulationRunner::OnStop()
+void SimulationRunner::PostUpdateLoop()
 {
-  this->stopReceived = true;
-  this->running = false;
+  IGN_PROFILE_THREAD_NAME("PostUpdate");
+  SetThreadCpus(this->serverConfig.WorkerCpus());
+  auto &ecm = this->postUpdateEcm;
+
+  std::unique_lock<std::mutex> lock(this->postUpdateMutex);
+  while (true)
+  {
+    this->postUpdateCv.wait(lock, [this]
+        {
+          return this->postUpdatePending || this->postUpdateStop;
+        });
+    if (!this->postUpdatePending)
+      return;
+    lock.unlock();
+
+    ApplyCopiedState(ecm, this->postUpdateState);
+
+    {
+      IGN_PROFILE("PostUpdate");
+      this->postUpdateDurations.resize(this->systemsPostupdateOverlap.size());
+      ecm.SetWorldPoseCacheEnabled(true);
+      RunParallelTasks(this->workerPool, this->workerThreads,
+          this->systemsPostupdateOverlap.size(), [&](std::size_t _index)
+          {
+            const auto systemIndex = this->systemsPostupdateOverlap[_index];
+            auto &system = this->systems[systemIndex];
+            const auto start = std::chrono::steady_clock::now();
+            system.postupdate->PostUpdate(this->postUpdateInfo, ecm);
+            const auto duration = std::chrono::steady_clock::now() - start;
+            this->postUpdateDurations[_index] = duration;
+            this->timeline.AddEvent(system.name, "post_update", start,
+                start + duration);
+            IGN_GAZEBO_TRACEPOINT2(system_post_update, systemIndex,
+                duration.count());
+          });
+      ecm.SetWorldPoseCacheEnabled(false);
+    }
+
+    FinishCopiedStep(ecm);
+
+    lock.lock();
+    for (std::size_t i = 0; i < this->systemsPostupdateOverlap.size(); ++i)
+    {
+      this->systems[this->systemsPostupdateOverlap[i]].postupdateTiming.Add(
+          this->postUpdateDurations[i]);
+    }
+    std::stable_sort(this->systemsPostupdateOverlap.begin(),
+        this->systemsPostupdateOverlap.end(),
+        [this](std::size_t _a, std::size_t _b)
+        {
+          return this->systems[_a].postupdateTiming.Smoothed() >
+              this->systems[_b].postupdateTiming.Smoothed();
+        });
+    this->postUpdatePending = false;
+    this->postUpdateCv.notify_all();
+  }
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::ApplyAsyncUpdates()
+{
+  const uint64_t iteration = this->currentInfo.iterations;
+  for (auto &async : this->systemsAsync)
+  {
+    if (!async.result.valid())
+      continue;
+
+    // Commands are applied a fixed number of iterations after the start,
+    // or right away if the iterations went back
+    if (iteration >= async.startIteration &&
+        iteration - async.startIteration < async.iterations)
+    {
+      continue;
+    }
+
+    auto &system = this->systems[async.system];
+    auto result = async.result.get();
+    system.asyncupdateTiming.Add(result.duration);
+    if (result.commands)
+      result.commands(this->currentInfo, this->entityCompMgr);
+  }
 }
 
 /////////////////////////////////////////////////
-void SimulationRunner::StopWorkerThreads()
+void SimulationRunner::StartAsyncUpdates()
 {
-  this->postUpdateThreadsRunning = false;
-  if (this->postUpdateStartBarrier)
+  IGN_PROFILE("SimulationRunner::StartAsyncUpdates");
+
+  // Each step's changes are serialized once for all systems
+  std::shared_ptr<const std::string> changes;
+  std::shared_ptr<const std::string> full;
+  auto serialize = [this](bool _full)
+  {
+    auto state = std::make_shared<std::string>();
+    this->entityCompMgr.BinaryState(*state, {}, {}, _full);
+    return state;
+  };
+
+  for (auto &async : this->systemsAsync)
   {
-    this->postUpdateStartBarrier->Cancel();
+    if (async.synced)
+    {
+      if (!changes)
+        changes = serialize(false);
+      async.changes.push_back(changes);
+    }
+    else
+    {
+      if (!full)
+        full = serialize(true);
+      async.changes.push_back(full);
+      async.synced = true;
+    }
+
+    if (async.result.valid())
+      continue;
+
+    auto &system = this->systems[async.system];
+    async.startIteration = this->currentInfo.iterations;
+
+    // The task only holds what doesn't move when systems are added
+    auto task = std::make_shared<std::packaged_task<
+        AsyncSystemInternal::Result()>>(
+        [this, asyncupdate = system.asyncupdate, name = system.name,
+         ecm = async.ecm.get(), states = std::move(async.changes),
+         info = this->currentInfo]()
+        {
+          for (const auto &state : states)
+            ApplyCopiedState(*ecm, *state);
+
+          AsyncSystemInternal::Result result;
+          const auto start = std::chrono::steady_clock::now();
+          result.commands = asyncupdate->AsyncUpdate(info, *ecm);
+          result.duration = std::chrono::steady_clock::now() - start;
+          this->timeline.AddEvent(name, "async_update", start,
+              start + result.duration);
+
+          FinishCopiedStep(*ecm);
+          return result;
+        });
+    async.changes.clear();
+    async.result = task->get_future();
+    this->workerPool->AddWork([task] {(*task)();});
   }
-  if (this->postUpdateStopBarrier)
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::ApplyCopiedState(EntityComponentManager &_ecm,
+    const std::string &_state)
+{
+  IGN_PROFILE("SimulationRunner::ApplyCopiedState");
+  if (!_ecm.SetBinaryState(_state.data(), _state.size()))
   {
-    this->postUpdateStopBarrier->Cancel();
+    ignerr << "Failed to copy the state, systems may see outdated "
+           << "components." << std::endl;
   }
-  for (auto &thread : this->postUpdateThreads)
+
+  // Parents aren't part of the state, so follow their components, like the
+  // GUI does
+  _ecm.Each<components::ParentEntity>(
+      [&](const Entity &_entity, const components::ParentEntity *_parent)
+      {
+        if (_ecm.ComponentState(_entity, components::ParentEntity::typeId)
+            != ComponentState::NoChange)
+        {
+          _ecm.SetParentEntity(_entity, _parent->Data());
+        }
+        return true;
+      });
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::FinishCopiedStep(EntityComponentManager &_ecm)
+{
+  _ecm.ClearNewlyCreatedEntities();
+  _ecm.ProcessRemoveEntityRequests();
+  _ecm.ClearRemovedComponents();
+  _ecm.SetAllComponentsUnchanged();
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::StopPostUpdate()
+{
+  if (!this->postUpdateThread.joinable())
+    return;
+
   {
-    thread.join();
+    std::unique_lock<std::mutex> lock(this->postUpdateMutex);
+    this->postUpdateCv.wait(lock, [this] {return !this->postUpdatePending;});
+    this->postUpdateStop = true;
   }
-  this->postUpdateThreads.clear();
+  this->postUpdateCv.notify_all();
+  this->postUpdateThread.join();
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::Stop()
+{
+  this->eventMgr.Emit<events::Stop>();
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::OnStop()
+{
+  this->stopReceived = true;
+  this->running = false;
 }
 
 /////////////////////////////////////////////////
@@ -599,18 +1556,49 @@ bool SimulationRunner::Run(const uint64_t _iterations)
       return true;
     }
   }
+  this->StartRun();
+
+  // Keep number of iterations requested by caller
+  uint64_t processedIterations{0};
+
+  // Execute all the systems until we are told to stop, or the number of
+  // iterations is reached.
+  while (this->running && (_iterations == 0 ||
+       processedIterations < _iterations))
+  {
+    IGN_PROFILE("SimulationRunner::Run - Iteration");
+
+    // Wait in order to match, as closely as possible, the update period.
+    const auto nextTime = this->NextIterationTime();
+    if (!this->maxSpeed && nextTime > std::chrono::steady_clock::now())
+    {
+      const auto lateness = this->pacer.WaitUntil(nextTime);
+      this->pacingJitter.Add(lateness < 0ns ? -lateness : lateness);
+    }
+
+    processedIterations += this->RunIteration();
+  }
+
+  this->FinishRun();
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::StartRun()
+{
   // Keep track of wall clock time. Only start the realTimeWatch if this
   // runner is not paused.
   if (!this->currentInfo.paused)
     this->realTimeWatch.Start();
 
-  // Variables for time keeping.
-  std::chrono::steady_clock::time_point startTime;
-  std::chrono::steady_clock::duration sleepTime;
-  std::chrono::steady_clock::duration actualSleep;
-
   this->running = true;
 
+  {
+    std::lock_guard<std::mutex> lock(this->worldSnapshotMutex);
+    this->serveWorldSnapshots = true;
+  }
+
   // Create the world statistics publisher.
   if (!this->statsPub.Valid())
   {
@@ -680,100 +1668,156 @@ bool SimulationRunner::Run(const uint64_t _iterations)
           "/clock");
     }
   }
+}
 
-  // Keep number of iterations requested by caller
+/////////////////////////////////////////////////
+std::chrono::steady_clock::time_point SimulationRunner::NextIterationTime()
+{
+  // Update the step size and desired rtf
+  this->UpdatePhysicsParams();
+
+  if (this->maxSpeed)
+    return std::chrono::steady_clock::time_point();
+
+  return this->prevUpdateRealTime + this->updatePeriod;
+}
+
+/////////////////////////////////////////////////
+uint64_t SimulationRunner::RunIteration()
+{
   uint64_t processedIterations{0};
 
-  // Execute all the systems until we are told to stop, or the number of
-  // iterations is reached.
-  while (this->running && (_iterations == 0 ||
-       processedIterations < _iterations))
+  // Update time information. This will update the iteration count, RTF,
+  // and other values.
+  this->UpdateCurrentInfo();
+  if (!this->currentInfo.paused)
   {
-    IGN_PROFILE("SimulationRunner::Run - Iteration");
-
-    // Update the step size and desired rtf
-    this->UpdatePhysicsParams();
+    processedIterations++;
+  }
 
-    // Compute the time to sleep in order to match, as closely as possible,
-    // the update period.
-    sleepTime = 0ns;
-    actualSleep = 0ns;
+  // If network, wait for network step, otherwise do our own step
+  if (this->networkMgr)
+  {
+    auto netPrimary =
+        dynamic_cast<NetworkManagerPrimary *>(this->networkMgr.get());
+    netPrimary->Step(this->currentInfo);
+  }
+  else
+  {
+    this->Step(this->currentInfo);
+  }
 
-    sleepTime = std::max(0ns, this->prevUpdateRealTime +
-        this->updatePeriod - std::chrono::steady_clock::now() -
-        this->sleepOffset);
+  // Handle Server::RunOnce(false) in which a single paused run is executed
+  if (this->currentInfo.paused && this->blockingPausedStepPending)
+  {
+    processedIterations++;
+    this->currentInfo.iterations++;
+    this->blockingPausedStepPending = false;
+  }
 
-    // Only sleep if needed.
-    if (sleepTime > 0ns)
-    {
-      IGN_PROFILE("Sleep");
-      // Get the current time, sleep for the duration needed to match the
-      // updatePeriod, and then record the actual time slept.
-      startTime = std::chrono::steady_clock::now();
-      std::this_thread::sleep_for(sleepTime);
-      actualSleep = std::chrono::steady_clock::now() - startTime;
-    }
+  return processedIterations;
+}
 
-    // Exponentially average out the difference between expected sleep time
-    // and actual sleep time.
-    this->sleepOffset =
-      std::chrono::duration_cast<std::chrono::nanoseconds>(
-          (actualSleep - sleepTime) * 0.01 + this->sleepOffset * 0.99);
+/////////////////////////////////////////////////
+void SimulationRunner::FinishRun()
+{
+  this->running = false;
 
-    // Update time information. This will update the iteration count, RTF,
-    // and other values.
-    this->UpdateCurrentInfo();
-    if (!this->currentInfo.paused)
-    {
-      processedIterations++;
-    }
+  // The last step isn't done until its PostUpdate is
+  this->WaitForPostUpdate();
 
-    // If network, wait for network step, otherwise do our own step
-    if (this->networkMgr)
-    {
-      auto netPrimary =
-          dynamic_cast<NetworkManagerPrimary *>(this->networkMgr.get());
-      netPrimary->Step(this->currentInfo);
-    }
-    else
-    {
-      this->Step(this->currentInfo);
-    }
+  // Refresh the system statistics, so they cover the last steps of the run
+  this->systemStatsPublishTime = std::chrono::steady_clock::time_point();
+  this->PublishSystemStats();
 
-    // Handle Server::RunOnce(false) in which a single paused run is executed
-    if (this->currentInfo.paused && this->blockingPausedStepPending)
-    {
-      processedIterations++;
-      this->currentInfo.iterations++;
-      this->blockingPausedStepPending = false;
-    }
-  }
+  // Answer requests made before the last step finished, later ones take
+  // their own snapshot
+  std::lock_guard<std::mutex> lock(this->worldSnapshotMutex);
+  this->ServeWorldSnapshotRequests();
+  this->serveWorldSnapshots = false;
+}
 
-  this->running = false;
+/////////////////////////////////////////////////
+void SimulationRunner::AddStartupPhase(const std::string &_name,
+    const std::chrono::steady_clock::time_point &_start,
+    const std::chrono::steady_clock::time_point &_end)
+{
+  std::lock_guard<std::mutex> lock(this->startupMutex);
+  StartupPhase phase{_name, _start, _end};
+  auto it = std::upper_bound(this->startupPhases.begin(),
+      this->startupPhases.end(), phase,
+      [](const StartupPhase &_a, const StartupPhase &_b)
+      {
+        return _a.start < _b.start;
+      });
+  this->startupPhases.insert(it, phase);
+
+  igndbg << "Startup phase [" << _name << "] of world [" << this->worldName
+         << "] took ["
+         << std::chrono::duration<double, std::milli>(_end - _start).count()
+         << "] ms" << std::endl;
+}
 
-  return true;
+/////////////////////////////////////////////////
+std::vector<std::pair<std::string, std::chrono::steady_clock::duration>>
+    SimulationRunner::StartupPhases() const
+{
+  std::vector<std::pair<std::string, std::chrono::steady_clock::duration>>
+      result;
+  std::lock_guard<std::mutex> lock(this->startupMutex);
+  for (const auto &phase : this->startupPhases)
+    result.emplace_back(phase.name, phase.end - phase.start);
+  return result;
 }
 
 /////////////////////////////////////////////////
 void SimulationRunner::Step(const UpdateInfo &_info)
 {
   IGN_PROFILE("SimulationRunner::Step");
+  const auto stepStart = std::chrono::steady_clock::now();
   this->currentInfo = _info;
+  this->timeline.BeginStep(_info.iterations);
+  const auto entityCount = this->entityCompMgr.EntityCount();
 
   // Publish info
-  this->PublishStats();
+  {
+    StepTimeline::Scope scope(this->timeline, "PublishStats");
+    this->PublishStats();
+  }
 
   // Record when the update step starts.
   this->prevUpdateRealTime = std::chrono::steady_clock::now();
 
-  this->levelMgr->UpdateLevelsState();
+  {
+    StepTimeline::Scope scope(this->timeline, "UpdateLevels");
+    this->levelMgr->UpdateLevelsState();
+  }
 
   // Handle pending systems
-  this->ProcessSystemQueue();
+  {
+    StepTimeline::Scope scope(this->timeline, "ProcessSystemQueue");
+    this->ProcessSystemQueue();
+  }
+
+  // Keep the world as it was loaded, or bring it back to that state
+  if (this->initialState.empty())
+    this->SaveInitialState();
+  else if (this->requestedReset)
+    this->RestoreInitialState();
 
   // Update all the systems.
   this->UpdateSystems();
 
+  // Velocity commands given by a reset only last one iteration
+  for (const Entity entity : this->resetVelocityCmds)
+  {
+    this->entityCompMgr.RemoveComponent<components::LinearVelocityCmd>(
+        entity);
+    this->entityCompMgr.RemoveComponent<components::AngularVelocityCmd>(
+        entity);
+  }
+  this->resetVelocityCmds.clear();
+
   if (!this->Paused() && this->pendingSimIterations > 0)
   {
     // Decrement the pending sim iterations, if there are any.
@@ -787,20 +1831,82 @@ void SimulationRunner::Step(const UpdateInfo &_info)
   }
 
   // Process world control messages.
-  this->ProcessMessages();
+  {
+    StepTimeline::Scope scope(this->timeline, "ProcessMessages");
+    this->ProcessMessages();
+  }
 
   // Clear all new entities
   this->entityCompMgr.ClearNewlyCreatedEntities();
 
   // Process entity removals.
-  this->entityCompMgr.ProcessRemoveEntityRequests();
+  const auto createdCount = this->entityCompMgr.EntityCount();
+  {
+    StepTimeline::Scope scope(this->timeline, "RemoveEntities");
+    this->entityCompMgr.ProcessRemoveEntityRequests();
+  }
+  if (this->timeline.Enabled())
+  {
+    const auto removedCount = this->entityCompMgr.EntityCount();
+    this->timeline.AddValue("entities",
+        static_cast<int64_t>(removedCount));
+    this->timeline.AddValue("entities_created",
+        static_cast<int64_t>(createdCount) -
+        static_cast<int64_t>(entityCount));
+    this->timeline.AddValue("entities_removed",
+        static_cast<int64_t>(createdCount) -
+        static_cast<int64_t>(removedCount));
+  }
 
   // Process components removals
   this->entityCompMgr.ClearRemovedComponents();
 
+  // Release memory left by removed entities, a little at a time
+  const auto compactionBudget = this->serverConfig.CompactionBudget();
+  if (compactionBudget > std::chrono::steady_clock::duration::zero())
+  {
+    StepTimeline::Scope scope(this->timeline, "Compact");
+    this->entityCompMgr.Compact(compactionBudget);
+  }
+
   // Each network manager takes care of marking its components as unchanged
   if (!this->networkMgr)
     this->entityCompMgr.SetAllComponentsUnchanged();
+
+  if (this->worldSnapshotRequested)
+  {
+    std::lock_guard<std::mutex> lock(this->worldSnapshotMutex);
+    this->ServeWorldSnapshotRequests();
+  }
+
+  // Keep the timeline of a slow step, unless a recent one was kept already
+  const auto duration = this->timeline.EndStep();
+  if (this->timelineHoldoff > 0)
+  {
+    --this->timelineHoldoff;
+  }
+  else if (this->timelineThreshold > std::chrono::steady_clock::duration(0)
+      && duration > this->timelineThreshold)
+  {
+    auto path = this->SaveTimeline();
+    if (!path.empty())
+    {
+      ignwarn << "Iteration [" << _info.iterations << "] took ["
+              << std::chrono::duration<double, std::milli>(duration).count()
+              << "] ms, wrote the timeline of the last steps to [" << path
+              << "]" << std::endl;
+    }
+    this->timelineHoldoff = this->serverConfig.TimelineSteps();
+  }
+
+  // Systems usually do their own setup on the first iteration, such as
+  // physics creating its entities
+  if (!this->firstIterationRecorded)
+  {
+    this->firstIterationRecorded = true;
+    this->AddStartupPhase("first_iteration", stepStart,
+        std::chrono::steady_clock::now());
+  }
 }
 
 //////////////////////////////////////////////////
@@ -991,6 +2097,19 @@ uint64_t SimulationRunner::IterationCount() const
   return this->currentInfo.iterations;
 }
 
+/////////////////////////////////////////////////
+double SimulationRunner::RealTimeFactor() const
+{
+  return this->realTimeFactor;
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::SetWorkerThreads(unsigned int _threads)
+{
+  this->workerThreads = _threads;
+  this->entityCompMgr.SetWorkerPool(this->workerPool, this->workerThreads);
+}
+
 /////////////////////////////////////////////////
 size_t SimulationRunner::EntityCount() const
 {
@@ -1049,6 +2168,7 @@ bool SimulationRunner::OnWorldControl(const msgs::WorldControl &_req,
   if (_req.has_reset())
   {
     control.rewind = _req.reset().all() || _req.reset().time_only();
+    control.reset = _req.reset().all();
 
     if (_req.reset().model_only())
     {
@@ -1084,12 +2204,30 @@ bool SimulationRunner::OnPlaybackControl(const msgs::LogPlaybackControl &_req,
                    std::chrono::nanoseconds(_req.seek().nsec());
   }
 
-  if (_req.forward())
+  // Forwarding plays the log as fast as possible, until a request without
+  // it comes in
+  control.maxSpeed = _req.forward();
+
+  this->worldControls.push_back(control);
+
+  _res.set_data(true);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool SimulationRunner::OnPlaybackRate(const msgs::Double &_req,
+    msgs::Boolean &_res)
+{
+  if (!std::isfinite(_req.data()) || _req.data() == 0.0)
   {
-    ignwarn << "Log forwarding is not supported, use seek." << std::endl;
+    ignerr << "Playback rate must be finite and nonzero, got ["
+           << _req.data() << "]." << std::endl;
+    _res.set_data(false);
+    return true;
   }
 
-  this->worldControls.push_back(control);
+  std::lock_guard<std::mutex> lock(this->msgBufferMutex);
+  this->requestedPlaybackRate = _req.data();
 
   _res.set_data(true);
   return true;
@@ -1121,16 +2259,161 @@ void SimulationRunner::ProcessWorldControl()
     }
 
     // Rewind / reset
-    this->requestedRewind = control.rewind;
+    this->requestedRewind = control.rewind || control.reset;
+    this->requestedReset = control.reset;
 
     // Seek
     if (control.seek >= std::chrono::steady_clock::duration::zero())
     {
       this->requestedSeek = control.seek;
     }
+
+    if (control.maxSpeed && *control.maxSpeed != this->maxSpeed)
+    {
+      this->maxSpeed = *control.maxSpeed;
+      ignmsg << (this->maxSpeed ? "Running as fast as possible." :
+          "Running at the desired real time factor.") << std::endl;
+    }
   }
 
   this->worldControls.clear();
+
+  if (this->requestedPlaybackRate)
+  {
+    if (*this->requestedPlaybackRate != this->playbackRate)
+    {
+      this->playbackRate = *this->requestedPlaybackRate;
+      this->realTimes.clear();
+      this->simTimes.clear();
+      ignmsg << "Playing back at rate [" << this->playbackRate << "]."
+             << std::endl;
+    }
+    this->requestedPlaybackRate.reset();
+  }
+
+  if (this->pendingReset)
+  {
+    this->requestedRewind = true;
+    this->requestedReset = true;
+    this->pendingReset = false;
+  }
+}
+
+/////////////////////////////////////////////////
+bool SimulationRunner::ResetService(msgs::Boolean &_res)
+{
+  std::lock_guard<std::mutex> lock(this->msgBufferMutex);
+  this->pendingReset = true;
+
+  _res.set_data(true);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::SaveInitialState()
+{
+  IGN_PROFILE("SimulationRunner::SaveInitialState");
+
+  this->entityCompMgr.BinaryState(this->initialState, {}, {}, true);
+
+  this->initialEntities.clear();
+  for (const auto &vertex : this->entityCompMgr.Entities().Vertices())
+    this->initialEntities.insert(vertex.first);
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::RestoreInitialState()
+{
+  IGN_PROFILE("SimulationRunner::RestoreInitialState");
+  this->requestedReset = false;
+
+  igndbg << "Resetting world [" << this->worldName << "]." << std::endl;
+
+  // Entities created since the snapshot. They're removed at the end of this
+  // step, so systems get to see them go.
+  for (const auto &vertex : this->entityCompMgr.Entities().Vertices())
+  {
+    if (this->initialEntities.find(vertex.first) ==
+        this->initialEntities.end())
+    {
+      this->entityCompMgr.RequestRemoveEntity(vertex.first, false);
+    }
+  }
+
+  // Components are overwritten in place, and entities removed since the
+  // snapshot are created again
+  if (!this->entityCompMgr.SetBinaryState(this->initialState.data(),
+      this->initialState.size()))
+  {
+    ignerr << "Failed to reset world [" << this->worldName << "]."
+           << std::endl;
+    return;
+  }
+
+  // Physics keeps its own copy of poses and velocities, so command it to
+  // follow the restored state instead of rebuilding it
+  std::vector<std::pair<Entity, math::Pose3d>> models;
+  this->entityCompMgr.Each<components::Model, components::Pose,
+      components::ParentEntity>(
+      [&](const Entity &_entity, const components::Model *,
+          const components::Pose *_pose,
+          const components::ParentEntity *_parent) -> bool
+      {
+        // Only top level models can be moved
+        if (nullptr != this->entityCompMgr.Component<components::World>(
+            _parent->Data()))
+        {
+          models.emplace_back(_entity, _pose->Data());
+        }
+        return true;
+      });
+
+  std::vector<std::pair<Entity, std::size_t>> joints;
+  this->entityCompMgr.Each<components::Joint>(
+      [&](const Entity &_entity, const components::Joint *) -> bool
+      {
+        std::size_t dofs{0};
+        if (this->entityCompMgr.Component<components::JointAxis>(_entity))
+          ++dofs;
+        if (this->entityCompMgr.Component<components::JointAxis2>(_entity))
+          ++dofs;
+        if (dofs > 0)
+          joints.emplace_back(_entity, dofs);
+        return true;
+      });
+
+  for (const auto &[entity, pose] : models)
+  {
+    this->entityCompMgr.SetComponentData<components::WorldPoseCmd>(entity,
+        pose);
+
+    auto staticComp = this->entityCompMgr.Component<components::Static>(
+        entity);
+    if (staticComp && staticComp->Data())
+      continue;
+
+    // Stop free bodies, unless a system is commanding them
+    if (nullptr == this->entityCompMgr.Component<
+        components::LinearVelocityCmd>(entity) &&
+        nullptr == this->entityCompMgr.Component<
+        components::AngularVelocityCmd>(entity))
+    {
+      this->entityCompMgr.CreateComponent(entity,
+          components::LinearVelocityCmd(math::Vector3d::Zero));
+      this->entityCompMgr.CreateComponent(entity,
+          components::AngularVelocityCmd(math::Vector3d::Zero));
+      this->resetVelocityCmds.push_back(entity);
+    }
+  }
+
+  // Joints start at their zero position when loaded
+  for (const auto &[entity, dofs] : joints)
+  {
+    this->entityCompMgr.SetComponentData<components::JointPositionReset>(
+        entity, std::vector<double>(dofs, 0.0));
+    this->entityCompMgr.SetComponentData<components::JointVelocityReset>(
+        entity, std::vector<double>(dofs, 0.0));
+  }
 }
 
 /////////////////////////////////////////////////
@@ -1145,6 +2428,12 @@ const EntityComponentManager &SimulationRunner::EntityCompMgr() const
   return this->entityCompMgr;
 }
 
+/////////////////////////////////////////////////
+EntityComponentManager &SimulationRunner::EntityCompMgr()
+{
+  return this->entityCompMgr;
+}
+
 /////////////////////////////////////////////////
 EventManager &SimulationRunner::EventMgr()
 {
@@ -1176,6 +2465,16 @@ void SimulationRunner::SetStepSize(const ignition::math::clock::duration &_step)
   this->stepSize = _step;
 }
 
+/////////////////////////////////////////////////
+ignition::math::clock::duration SimulationRunner::ActiveStepSize() const
+{
+  const auto requested = std::chrono::nanoseconds(this->requestedStepSize);
+  if (requested.count() <= 0 || requested >= this->stepSize)
+    return this->stepSize;
+  return std::chrono::duration_cast<ignition::math::clock::duration>(
+      requested);
+}
+
 /////////////////////////////////////////////////
 bool SimulationRunner::HasEntity(const std::string &_name) const
 {
@@ -1256,15 +2555,132 @@ bool SimulationRunner::GuiInfoService(ignition::msgs::GUI &_res)
   return true;
 }
 
+//////////////////////////////////////////////////
+bool SimulationRunner::SystemStatsService(msgs::Param_V &_res)
+{
+  std::lock_guard<std::mutex> lock(this->systemStatsMutex);
+  _res.CopyFrom(this->systemStatsMsg);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SimulationRunner::StartupStatsService(msgs::Param_V &_res)
+{
+  auto toSeconds = [](const std::chrono::steady_clock::duration &_duration)
+  {
+    return std::chrono::duration<double>(_duration).count();
+  };
+
+  auto setDouble = [](msgs::Param &_param, const std::string &_key,
+      double _value)
+  {
+    auto &any = (*_param.mutable_params())[_key];
+    any.set_type(msgs::Any::DOUBLE);
+    any.set_double_value(_value);
+  };
+
+  _res.Clear();
+
+  std::lock_guard<std::mutex> lock(this->startupMutex);
+  if (this->startupPhases.empty())
+    return true;
+
+  const auto first = this->startupPhases.front().start;
+  for (const auto &phase : this->startupPhases)
+  {
+    auto *param = _res.add_param();
+
+    auto &name = (*param->mutable_params())["name"];
+    name.set_type(msgs::Any::STRING);
+    name.set_string_value(phase.name);
+
+    setDouble(*param, "start_s", toSeconds(phase.start - first));
+    setDouble(*param, "duration_s", toSeconds(phase.end - phase.start));
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SimulationRunner::EcmMemoryService(msgs::Param_V &_res)
+{
+  std::lock_guard<std::mutex> lock(this->ecmMemoryMutex);
+  _res.CopyFrom(this->ecmMemoryMsg);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SimulationRunner::TimelineService(msgs::StringMsg &_res)
+{
+  auto path = this->SaveTimeline();
+  _res.set_data(path);
+  return !path.empty();
+}
+
+//////////////////////////////////////////////////
+std::string SimulationRunner::SaveTimeline()
+{
+  if (!this->timeline.Enabled())
+    return std::string();
+
+  std::string dir = this->serverConfig.TimelinePath();
+  if (dir.empty())
+    dir = ignLogDirectory();
+  if (dir.empty())
+    dir = common::cwd();
+
+  if (!common::exists(dir) && !common::createDirectories(dir))
+  {
+    ignerr << "Failed to create timeline directory [" << dir << "]"
+           << std::endl;
+    return std::string();
+  }
+
+  // Name the file after the last finished step
+  auto steps = this->timeline.Steps();
+  const uint64_t iteration = steps.empty() ? 0 : steps.back().iteration;
+  auto path = common::joinPaths(dir, "timeline_" + this->worldName + "_" +
+      std::to_string(iteration) + ".json");
+
+  if (!this->timeline.Save(path))
+  {
+    ignerr << "Failed to write timeline to [" << path << "]" << std::endl;
+    return std::string();
+  }
+  return path;
+}
+
 //////////////////////////////////////////////////
 bool SimulationRunner::GenerateWorldSdf(const msgs::SdfGeneratorConfig &_req,
                                         msgs::StringMsg &_res)
 {
-  // TODO(addisu) This is not thread-safe. Wait until it is safe to access the
-  // ECM.
-  Entity world = this->entityCompMgr.EntityByComponents(components::World());
+  std::future<sdf_generator::WorldSnapshot> snapshotFuture;
+  {
+    std::lock_guard<std::mutex> lock(this->worldSnapshotMutex);
+    if (this->serveWorldSnapshots)
+    {
+      this->worldSnapshotRequests.emplace_back();
+      snapshotFuture = this->worldSnapshotRequests.back().get_future();
+      this->worldSnapshotRequested = true;
+    }
+  }
+
+  // While simulation is running, wait for the snapshot to be taken between
+  // steps. Otherwise nothing is modifying the ECM.
+  sdf_generator::WorldSnapshot snapshot;
+  if (snapshotFuture.valid())
+  {
+    snapshot = snapshotFuture.get();
+  }
+  else
+  {
+    snapshot = sdf_generator::snapshotWorld(this->entityCompMgr,
+        this->entityCompMgr.EntityByComponents(components::World()));
+  }
+
+  // The slow part, generating the elements and the string, runs on this
+  // thread while simulation goes on
   std::optional<std::string> genString = sdf_generator::generateWorld(
-      this->entityCompMgr, world, this->fuelUriMap, _req);
+      snapshot, this->fuelUriMap, _req, &this->sdfGeneratorCache);
   if (genString.has_value())
   {
     _res.set_data(*genString);
@@ -1273,6 +2689,20 @@ bool SimulationRunner::GenerateWorldSdf(const msgs::SdfGeneratorConfig &_req,
   return false;
 }
 
+//////////////////////////////////////////////////
+void SimulationRunner::ServeWorldSnapshotRequests()
+{
+  if (!this->worldSnapshotRequests.empty())
+  {
+    auto snapshot = sdf_generator::snapshotWorld(this->entityCompMgr,
+        this->entityCompMgr.EntityByComponents(components::World()));
+    for (auto &request : this->worldSnapshotRequests)
+      request.set_value(snapshot);
+    this->worldSnapshotRequests.clear();
+  }
+  this->worldSnapshotRequested = false;
+}
+
 //////////////////////////////////////////////////
 void SimulationRunner::SetFuelUriMap(
     const std::unordered_map<std::string, std::string> &_map)
@@ -17,16 +17,24 @@
 #ifndef IGNITION_GAZEBO_SIMULATIONRUNNER_HH_
 #define IGNITION_GAZEBO_SIMULATIONRUNNER_HH_
 
+#include <ignition/msgs/double.pb.h>
 #include <ignition/msgs/gui.pb.h>
 #include <ignition/msgs/log_playback_control.pb.h>
+#include <ignition/msgs/param_v.pb.h>
 #include <ignition/msgs/sdf_generator_config.pb.h>
+#include <ignition/msgs/stringmsg.pb.h>
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <future>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -44,6 +52,7 @@
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/EventManager.hh"
 #include "ignition/gazebo/Export.hh"
+#include "ignition/gazebo/LocalStateChannel.hh"
 #include "ignition/gazebo/ServerConfig.hh"
 #include "ignition/gazebo/System.hh"
 #include "ignition/gazebo/SystemLoader.hh"
@@ -52,7 +61,9 @@
 
 #include "network/NetworkManager.hh"
 #include "LevelManager.hh"
-#include "Barrier.hh"
+#include "Pacer.hh"
+#include "SdfGenerator.hh"
+#include "StepTimeline.hh"
 
 using namespace std::chrono_literals;
 
@@ -82,10 +93,64 @@ namespace ignition
       // cppcheck-suppress unusedStructMember
       bool rewind{false};  // NOLINT
 
+      /// \brief Restore the world to the state it had once it was loaded.
+      /// Resetting also rewinds time.
+      // cppcheck-suppress unusedStructMember
+      bool reset{false};  // NOLINT
+
       /// \brief Sim time to jump to. A negative value means don't seek.
       /// Seeking changes sim time but doesn't affect real time.
       /// It also resets iterations back to zero.
       std::chrono::steady_clock::duration seek{-1};
+
+      /// \brief True to run as fast as possible, ignoring the real time
+      /// factor, false to go back to it. Empty to keep the current mode.
+      std::optional<bool> maxSpeed;
+    };
+
+    /// \brief Rolling timing statistics of one phase of a system, such as
+    /// its PreUpdate calls. Recording a sample is constant time, while the
+    /// statistics are computed on request over the latest samples.
+    class IGNITION_GAZEBO_VISIBLE SystemTiming
+    {
+      /// \brief Number of latest samples which statistics are computed over.
+      public: static constexpr std::size_t kWindowSize{256};
+
+      /// \brief Record the duration of a call.
+      /// \param[in] _duration Duration of the call.
+      public: void Add(const std::chrono::steady_clock::duration &_duration);
+
+      /// \brief Get the number of samples in the window.
+      /// \return Number of samples, up to kWindowSize.
+      public: std::size_t Count() const;
+
+      /// \brief Get the mean duration over the window.
+      /// \return Mean duration, zero if there are no samples.
+      public: std::chrono::steady_clock::duration Mean() const;
+
+      /// \brief Get the maximum duration over the window.
+      /// \return Maximum duration, zero if there are no samples.
+      public: std::chrono::steady_clock::duration Max() const;
+
+      /// \brief Get a percentile of the durations over the window.
+      /// \param[in] _percentile Percentile, between 0 and 100.
+      /// \return Duration at that percentile, zero if there are no samples.
+      public: std::chrono::steady_clock::duration Percentile(
+                  double _percentile) const;
+
+      /// \brief Get an exponentially smoothed duration, which follows
+      /// the recent durations without jumping on every spike.
+      /// \return Smoothed duration.
+      public: std::chrono::steady_clock::duration Smoothed() const;
+
+      /// \brief Latest samples, used as a ring buffer once full.
+      private: std::vector<std::chrono::steady_clock::duration> samples;
+
+      /// \brief Index of the sample to overwrite next once full.
+      private: std::size_t next{0};
+
+      /// \brief Exponentially smoothed duration.
+      private: std::chrono::steady_clock::duration smoothed{0};
     };
 
     /// \brief Class to hold systems internally
@@ -94,10 +159,14 @@ namespace ignition
       /// \brief Constructor
       public: explicit SystemInternal(SystemPluginPtr _systemPlugin)
               : systemPlugin(std::move(_systemPlugin)),
+                name(systemPlugin->Name()),
                 system(systemPlugin->QueryInterface<System>()),
                 preupdate(systemPlugin->QueryInterface<ISystemPreUpdate>()),
                 update(systemPlugin->QueryInterface<ISystemUpdate>()),
-                postupdate(systemPlugin->QueryInterface<ISystemPostUpdate>())
+                postupdate(systemPlugin->QueryInterface<ISystemPostUpdate>()),
+                asyncupdate(
+                    systemPlugin->QueryInterface<ISystemAsyncUpdate>()),
+                access(systemPlugin->QueryInterface<ISystemAccess>())
       {
       }
 
@@ -105,6 +174,9 @@ namespace ignition
       /// class as well as the shared library.
       public: SystemPluginPtr systemPlugin;
 
+      /// \brief Name of the plugin, kept for the step timeline.
+      public: std::string name;
+
       /// \brief Access this system via the `System` interface
       public: System *system = nullptr;
 
@@ -120,19 +192,83 @@ namespace ignition
       /// Will be nullptr if the System doesn't implement this interface.
       public: ISystemPostUpdate *postupdate = nullptr;
 
+      /// \brief Access this system via the ISystemAsyncUpdate interface
+      /// Will be nullptr if the System doesn't implement this interface.
+      public: ISystemAsyncUpdate *asyncupdate = nullptr;
+
+      /// \brief Access this system via the ISystemAccess interface
+      /// Will be nullptr if the System doesn't implement this interface.
+      public: ISystemAccess *access = nullptr;
+
+      /// \brief Timing of the PreUpdate calls.
+      public: SystemTiming preupdateTiming;
+
+      /// \brief Timing of the Update calls.
+      public: SystemTiming updateTiming;
+
+      /// \brief Timing of the PostUpdate calls.
+      public: SystemTiming postupdateTiming;
+
+      /// \brief Timing of the AsyncUpdate calls.
+      public: SystemTiming asyncupdateTiming;
+
       /// \brief Vector of queries and callbacks
       public: std::vector<EntityQueryCallback> updates;
     };
 
+    /// \brief State of a system implementing ISystemAsyncUpdate.
+    class AsyncSystemInternal
+    {
+      /// \brief Result of an AsyncUpdate call.
+      public: struct Result
+      {
+        /// \brief Commands returned by the system.
+        ISystemAsyncUpdate::Commands commands;
+
+        /// \brief Duration of the call.
+        std::chrono::steady_clock::duration duration{0};
+      };
+
+      /// \brief Index into the runner's systems.
+      public: std::size_t system{0};
+
+      /// \brief Iterations between the start of an AsyncUpdate and the
+      /// application of its commands.
+      public: uint64_t iterations{1};
+
+      /// \brief Copy of the ECM read by AsyncUpdate. Only the running
+      /// AsyncUpdate uses it.
+      public: std::unique_ptr<EntityComponentManager> ecm;
+
+      /// \brief Whether ecm was given the full state already, so only
+      /// changes need to be copied.
+      public: bool synced{false};
+
+      /// \brief Changes to apply to ecm before the next AsyncUpdate, in
+      /// order, serialized with EntityComponentManager::BinaryState. They're
+      /// shared among systems.
+      public: std::vector<std::shared_ptr<const std::string>> changes;
+
+      /// \brief Iteration at which the running AsyncUpdate was started.
+      public: uint64_t startIteration{0};
+
+      /// \brief Result of the running AsyncUpdate. Invalid once the commands
+      /// were applied.
+      public: std::future<Result> result;
+    };
+
     class IGNITION_GAZEBO_VISIBLE SimulationRunner
     {
       /// \brief Constructor
       /// \param[in] _world Pointer to the SDF world.
       /// \param[in] _systemLoader Reference to system manager.
       /// \param[in] _useLevels Whether to use levles or not. False by default.
+      /// \param[in] _workerPool Pool of worker threads shared with other
+      /// runners. If nullptr, the runner creates its own.
       public: explicit SimulationRunner(const sdf::World *_world,
                                 const SystemLoaderPtr &_systemLoader,
-                                const ServerConfig &_config = ServerConfig());
+                                const ServerConfig &_config = ServerConfig(),
+                                common::WorkerPool *_workerPool = nullptr);
 
       /// \brief Destructor.
       public: virtual ~SimulationRunner();
@@ -143,14 +279,43 @@ namespace ignition
       /// \brief Internal method for handling stop event (to prevent recursion)
       private: void OnStop();
 
-      /// \brief Stop and join all post update worker threads
-      private: void StopWorkerThreads();
-
       /// \brief Run the simulationrunner.
       /// \param[in] _iterations Number of iterations.
       /// \return True if the operation completed successfully.
       public: bool Run(const uint64_t _iterations);
 
+      /// \brief Get ready to run iterations one at a time with
+      /// RunIteration, for a scheduler stepping several runners. Run calls
+      /// this itself. Not supported for distributed simulation.
+      public: void StartRun();
+
+      /// \brief Run a single iteration, without sleeping to keep up with
+      /// the update period. See NextIterationTime.
+      /// \return Number of iterations processed, which is zero for an
+      /// iteration while paused.
+      public: uint64_t RunIteration();
+
+      /// \brief Stop running iterations started with StartRun.
+      public: void FinishRun();
+
+      /// \brief Get the wall time at which the next iteration should start
+      /// to match the update period. This also applies pending changes to
+      /// the physics parameters.
+      /// \return Start time of the next iteration, which may be in the past.
+      public: std::chrono::steady_clock::time_point NextIterationTime();
+
+      /// \brief Set the maximum number of threads running systems and
+      /// processing entities of this runner at the same time, including the
+      /// calling thread.
+      /// \param[in] _threads Number of threads, or 0 to use one thread per
+      /// hardware core.
+      public: void SetWorkerThreads(unsigned int _threads);
+
+      /// \brief Get the real time factor, averaged over the latest
+      /// iterations.
+      /// \return The real time factor.
+      public: double RealTimeFactor() const;
+
       /// \brief Perform a simulation step:
       /// * Publish stats and process control messages
       /// * Update levels and systems
@@ -170,6 +335,37 @@ namespace ignition
       /// \brief Publish current world statistics.
       public: void PublishStats();
 
+      /// \brief Publish the timing statistics of each system, throttled to
+      /// once per second of real time.
+      private: void PublishSystemStats();
+
+      /// \brief Record a phase of the startup of this world, served on the
+      /// `startup_stats` service. Phases may overlap.
+      /// \param[in] _name Name of the phase.
+      /// \param[in] _start Real time when the phase started.
+      /// \param[in] _end Real time when the phase ended.
+      public: void AddStartupPhase(const std::string &_name,
+                  const std::chrono::steady_clock::time_point &_start,
+                  const std::chrono::steady_clock::time_point &_end);
+
+      /// \brief Get the duration of each recorded startup phase.
+      /// \return Names and durations, in the order the phases started.
+      public: std::vector<std::pair<std::string,
+                  std::chrono::steady_clock::duration>> StartupPhases() const;
+
+      /// \brief Measure the memory used by the entity component manager,
+      /// throttled to once per second of real time, for the stats topic and
+      /// the ECM memory service.
+      private: void UpdateEcmMemoryStats();
+
+      /// \brief Publish the counters of the entity component manager,
+      /// throttled to once per second of real time.
+      private: void PublishCounters();
+
+      /// \brief Append the ECM accesses recorded while tracing to the
+      /// report file, see ServerConfig::SetEcmAccessReportPath.
+      private: void WriteEcmAccessReport() const;
+
       /// \brief Load system plugin for a given entity.
       /// \param[in] _entity Entity
       /// \param[in] _fname Filename of the plugin library
@@ -244,6 +440,11 @@ namespace ignition
       /// \return Reference to the entity component manager.
       public: const EntityComponentManager &EntityCompMgr() const;
 
+      /// \brief Get the mutable EntityComponentManager. Only use it while
+      /// the runner isn't running.
+      /// \return Reference to the entity component manager.
+      public: EntityComponentManager &EntityCompMgr();
+
       /// \brief Return an entity with the provided name.
       /// \details If multiple entities with the same name exist, the first
       /// entity found will be returned.
@@ -302,6 +503,12 @@ namespace ignition
       /// \param[in] _step Step size.
       public: void SetStepSize(const ignition::math::clock::duration &_step);
 
+      /// \brief Get the step size of the current iteration. It's smaller
+      /// than StepSize while a system requested a smaller step through
+      /// events::RequestStepSize.
+      /// \return Step size.
+      public: ignition::math::clock::duration ActiveStepSize() const;
+
       /// \brief World control service callback. This function stores the
       /// the request which will then be processed by the ProcessMessages
       /// function.
@@ -322,11 +529,49 @@ namespace ignition
       private: bool OnPlaybackControl(const msgs::LogPlaybackControl &_req,
                                             msgs::Boolean &_res);
 
+      /// \brief Playback rate service callback. The rate is applied by
+      /// ProcessMessages, like other controls.
+      /// \param[in] _req Sim time advanced by each step, relative to the step
+      /// size. Negative values play the log backward.
+      /// \param[out] _res Response to client, true if successful.
+      /// \return True for success
+      private: bool OnPlaybackRate(const msgs::Double &_req,
+                                   msgs::Boolean &_res);
+
       /// \brief Callback for GUI info service.
       /// \param[out] _res Response containing the latest GUI message.
       /// \return True if successful.
       private: bool GuiInfoService(ignition::msgs::GUI &_res);
 
+      /// \brief Callback for the system statistics service.
+      /// \param[out] _res Response containing the latest system statistics.
+      /// \return True if successful.
+      private: bool SystemStatsService(ignition::msgs::Param_V &_res);
+
+      /// \brief Callback for the startup statistics service.
+      /// \param[out] _res Response with one param per startup phase, holding
+      /// its name, its start since the first phase and its duration, in
+      /// seconds.
+      /// \return True if successful.
+      private: bool StartupStatsService(ignition::msgs::Param_V &_res);
+
+      /// \brief Callback for the ECM memory service.
+      /// \param[out] _res Response containing the latest memory usage of the
+      /// entity component manager. The first param holds totals, followed by
+      /// one param per component type and one per view.
+      /// \return True if successful.
+      private: bool EcmMemoryService(ignition::msgs::Param_V &_res);
+
+      /// \brief Callback for the timeline service, which writes the step
+      /// timeline to a file.
+      /// \param[out] _res Path of the file.
+      /// \return False if the timeline is disabled or couldn't be written.
+      private: bool TimelineService(ignition::msgs::StringMsg &_res);
+
+      /// \brief Write the step timeline to a file in the timeline directory.
+      /// \return Path of the file, empty if it couldn't be written.
+      private: std::string SaveTimeline();
+
       /// \brief Calculate real time factor and populate currentInfo.
       private: void UpdateCurrentInfo();
 
@@ -337,6 +582,23 @@ namespace ignition
       /// \brief Process world control service messages.
       private: void ProcessWorldControl();
 
+      /// \brief Callback for the reset service, which restores the world to
+      /// the state it had once it was loaded.
+      /// \param[out] _res True if the reset was requested.
+      /// \return True if successful.
+      private: bool ResetService(msgs::Boolean &_res);
+
+      /// \brief Keep a snapshot of the ECM, so that the world can be reset
+      /// without loading it again. This is called on the first step, once
+      /// all the systems have been configured.
+      private: void SaveInitialState();
+
+      /// \brief Restore the snapshot taken by SaveInitialState. Component
+      /// values are overwritten in place, entities created later are
+      /// removed, and the physics system is commanded to move models and
+      /// joints back, so that nothing needs to be loaded again.
+      private: void RestoreInitialState();
+
       /// \brief Actually add system to the runner
       /// \param[in] _system System to be added
       public: void AddSystemToRunner(const SystemPluginPtr &_system);
@@ -345,6 +607,53 @@ namespace ignition
       /// added.
       public: void ProcessSystemQueue();
 
+      /// \brief Group the PreUpdate and Update systems into levels of systems
+      /// which can run concurrently, based on the component types they
+      /// declare through ISystemAccess.
+      private: void ScheduleSystems();
+
+      /// \brief Hand the state at the end of Update over to the systems
+      /// which overlap the next step, once they're done with the previous
+      /// step, and start them.
+      private: void StartPostUpdate();
+
+      /// \brief Publish the changes of this step to the GUI runner attached
+      /// to localState.
+      private: void PublishLocalState();
+
+      /// \brief Apply the commands of the AsyncUpdate calls which are due
+      /// this iteration, waiting for them if needed.
+      private: void ApplyAsyncUpdates();
+
+      /// \brief Copy the changes of this step for the AsyncUpdate systems,
+      /// and start those which aren't running.
+      private: void StartAsyncUpdates();
+
+      /// \brief Bring a copy of the ECM up to date with state serialized by
+      /// EntityComponentManager::BinaryState.
+      /// \param[in] _ecm Copy of the ECM.
+      /// \param[in] _state Serialized state.
+      private: static void ApplyCopiedState(EntityComponentManager &_ecm,
+                   const std::string &_state);
+
+      /// \brief Clear the new and removed entities and components, and the
+      /// changes, of a copy of the ECM, like at the end of a step.
+      /// \param[in] _ecm Copy of the ECM.
+      private: static void FinishCopiedStep(EntityComponentManager &_ecm);
+
+      /// \brief Wait for the systems which overlap the next step to be done
+      /// with the previous step.
+      private: void WaitForPostUpdate();
+
+      /// \brief Run the systems which overlap the next step, each time
+      /// StartPostUpdate is called, until StopPostUpdate is called. It runs
+      /// on postUpdateThread.
+      private: void PostUpdateLoop();
+
+      /// \brief Wait for the systems which overlap the next step and join
+      /// postUpdateThread.
+      private: void StopPostUpdate();
+
       /// \brief Generate the current world's SDFormat representation.
       /// \param[in] _req Request message with options for saving a world to an
       /// SDFormat file.
@@ -353,6 +662,11 @@ namespace ignition
       public: bool GenerateWorldSdf(const msgs::SdfGeneratorConfig &_req,
                                     msgs::StringMsg &_res);
 
+      /// \brief Answer pending world snapshot requests from GenerateWorldSdf.
+      /// Called from the simulation thread between steps, with
+      /// worldSnapshotMutex locked.
+      private: void ServeWorldSnapshotRequests();
+
       /// \brief Sets the file path to fuel URI map.
       /// \param[in] _map A populated map of file paths to fuel URIs.
       public: void SetFuelUriMap(
@@ -395,14 +709,29 @@ namespace ignition
       /// \brief Systems implementing Configure
       private: std::vector<ISystemConfigure *> systemsConfigure;
 
-      /// \brief Systems implementing PreUpdate
-      private: std::vector<ISystemPreUpdate *> systemsPreupdate;
+      /// \brief Indices into `systems` of the systems implementing
+      /// PreUpdate, grouped into levels. Levels run in order, and the systems
+      /// within a level run concurrently.
+      private: std::vector<std::vector<std::size_t>> systemsPreupdate;
+
+      /// \brief Indices into `systems` of the systems implementing Update,
+      /// grouped into levels. Levels run in order, and the systems within a
+      /// level run concurrently.
+      private: std::vector<std::vector<std::size_t>> systemsUpdate;
 
-      /// \brief Systems implementing Update
-      private: std::vector<ISystemUpdate *> systemsUpdate;
+      /// \brief Indices into `systems` of the systems implementing
+      /// PostUpdate, sorted from the slowest to the fastest system. This is
+      /// the order in which they're started.
+      private: std::vector<std::size_t> systemsPostupdate;
 
-      /// \brief Systems implementing PostUpdate
-      private: std::vector<ISystemPostUpdate *> systemsPostupdate;
+      /// \brief Indices into `systems` of the systems which only implement
+      /// PostUpdate, when they overlap the next step, sorted like
+      /// systemsPostupdate. See ServerConfig::SetOverlapPostUpdate.
+      private: std::vector<std::size_t> systemsPostupdateOverlap;
+
+      /// \brief Systems implementing AsyncUpdate, in the order they were
+      /// added, which is the order their commands are applied in.
+      private: std::vector<AsyncSystemInternal> systemsAsync;
 
       /// \brief Manager of all events.
       private: EventManager eventMgr;
@@ -416,15 +745,28 @@ namespace ignition
       /// \brief Manager of distributing/receiving network work.
       private: std::unique_ptr<NetworkManager> networkMgr{nullptr};
 
-      /// \brief A pool of worker threads.
-      private: common::WorkerPool workerPool{2};
+      /// \brief Worker pool owned by this runner, if it wasn't given one.
+      private: std::unique_ptr<common::WorkerPool> ownWorkerPool;
+
+      /// \brief A pool of worker threads, shared with the entity component
+      /// manager to process entities in parallel, and possibly with other
+      /// runners.
+      private: common::WorkerPool *workerPool{nullptr};
+
+      /// \brief Maximum number of threads running systems at the same
+      /// time, including the calling thread. Zero uses one thread per
+      /// hardware core.
+      private: unsigned int workerThreads{0};
 
       /// \brief Wall time of the previous update.
       private: std::chrono::steady_clock::time_point prevUpdateRealTime;
 
-      /// \brief A duration used to account for inaccuracies associated with
-      /// sleep durations.
-      private: std::chrono::steady_clock::duration sleepOffset{0};
+      /// \brief Waits until iterations are due.
+      private: Pacer pacer;
+
+      /// \brief How far from their due time iterations start, in either
+      /// direction. Only iterations which had to wait are counted.
+      private: SystemTiming pacingJitter;
 
       /// \brief This is the rate at which the systems are updated.
       /// The default update rate is 500hz, which is a period of 2ms.
@@ -451,6 +793,58 @@ namespace ignition
       /// \brief Clock publisher for the root `/stats` topic.
       private: ignition::transport::Node::Publisher rootStatsPub;
 
+      /// \brief System statistics publisher.
+      private: ignition::transport::Node::Publisher systemStatsPub;
+
+      /// \brief Latest system statistics, returned by the service.
+      private: ignition::msgs::Param_V systemStatsMsg;
+
+      /// \brief Mutex to protect systemStatsMsg.
+      private: std::mutex systemStatsMutex;
+
+      /// \brief Real time when system statistics were last published.
+      private: std::chrono::steady_clock::time_point systemStatsPublishTime;
+
+      /// \brief A recorded phase of the startup.
+      private: struct StartupPhase
+      {
+        /// \brief Name of the phase.
+        std::string name;
+
+        /// \brief Real time when the phase started.
+        std::chrono::steady_clock::time_point start;
+
+        /// \brief Real time when the phase ended.
+        std::chrono::steady_clock::time_point end;
+      };
+
+      /// \brief Recorded startup phases, sorted by start.
+      private: std::vector<StartupPhase> startupPhases;
+
+      /// \brief Mutex to protect startupPhases.
+      private: mutable std::mutex startupMutex;
+
+      /// \brief Whether the first iteration was recorded as a startup phase.
+      private: bool firstIterationRecorded{false};
+
+      /// \brief Entity component manager counters publisher.
+      private: ignition::transport::Node::Publisher countersPub;
+
+      /// \brief Real time when counters were last published.
+      private: std::chrono::steady_clock::time_point countersPublishTime;
+
+      /// \brief Latest memory usage of the ECM, returned by the service.
+      private: ignition::msgs::Param_V ecmMemoryMsg;
+
+      /// \brief Mutex to protect ecmMemoryMsg.
+      private: std::mutex ecmMemoryMutex;
+
+      /// \brief Latest total bytes used by the ECM, for the stats topic.
+      private: std::size_t ecmMemoryBytes{0};
+
+      /// \brief Real time when the ECM memory was last measured.
+      private: std::chrono::steady_clock::time_point ecmMemoryTime;
+
       /// \brief Clock publisher.
       private: ignition::transport::Node::Publisher clockPub;
 
@@ -466,6 +860,17 @@ namespace ignition
       /// \brief Step size
       private: ignition::math::clock::duration stepSize{10ms};
 
+      /// \brief Step size requested through events::RequestStepSize, in
+      /// nanoseconds, or zero to use stepSize. It's atomic because the
+      /// request may come from PostUpdate, which can run on another thread.
+      private: std::atomic<int64_t> requestedStepSize{0};
+
+      /// \brief Step size of the last iteration, to notice changes.
+      private: ignition::math::clock::duration lastStepSize{0};
+
+      /// \brief Value of stepSize on the last iteration.
+      private: ignition::math::clock::duration lastMaxStepSize{0};
+
       /// \brief Desired real time factor
       private: double desiredRtf{1.0};
 
@@ -478,6 +883,9 @@ namespace ignition
       /// \brief Connection to the load plugins event.
       private: common::ConnectionPtr loadPluginsConn;
 
+      /// \brief Connection to the request step size event.
+      private: common::ConnectionPtr requestStepSizeConn;
+
       /// \brief Pointer to the sdf::World object of this runner
       private: const sdf::World *sdfWorld;
 
@@ -492,10 +900,42 @@ namespace ignition
       /// \brief True if user requested to rewind simulation.
       private: bool requestedRewind{false};
 
+      /// \brief True if user requested to reset the world.
+      private: bool requestedReset{false};
+
+      /// \brief True if the reset service was called. Protected by
+      /// msgBufferMutex, and turned into requestedReset by
+      /// ProcessWorldControl.
+      private: bool pendingReset{false};
+
+      /// \brief Snapshot of the ECM once the world was loaded, serialized
+      /// with EntityComponentManager::BinaryState. Empty until the first
+      /// step.
+      private: std::string initialState;
+
+      /// \brief Entities present when the snapshot was taken.
+      private: std::unordered_set<Entity> initialEntities;
+
+      /// \brief Models given velocity commands by the latest reset, to be
+      /// removed once physics applied them.
+      private: std::vector<Entity> resetVelocityCmds;
+
       /// \brief If user asks to seek to a specific sim time, this holds the
       /// time.s A negative value means there's no request from the user.
       private: std::chrono::steady_clock::duration requestedSeek{-1};
 
+      /// \brief True to run iterations as fast as possible, without sleeping
+      /// to match the real time factor. Set through log playback control.
+      private: bool maxSpeed{false};
+
+      /// \brief Sim time advanced by each step, relative to the step size.
+      /// Only changed through log playback, negative plays backward.
+      private: double playbackRate{1.0};
+
+      /// \brief Playback rate requested through the service, applied by
+      /// ProcessWorldControl. Protected by msgBufferMutex.
+      private: std::optional<double> requestedPlaybackRate;
+
       /// \brief Keeps the latest simulation info.
       private: UpdateInfo currentInfo;
 
@@ -511,17 +951,17 @@ namespace ignition
       /// \brief Copy of the server configuration.
       public: ServerConfig serverConfig;
 
-      /// \brief Collection of threads running system PostUpdates
-      private: std::vector<std::thread> postUpdateThreads;
+      /// \brief Timeline of the last steps.
+      private: StepTimeline timeline;
 
-      /// \brief Flag to indicate running status of PostUpdate threads
-      private: std::atomic<bool> postUpdateThreadsRunning{false};
+      /// \brief Step duration above which the timeline is written, zero for
+      /// never.
+      private: std::chrono::steady_clock::duration timelineThreshold{0};
 
-      /// \brief Barrier to signal beginning of PostUpdate thread execution
-      private: std::unique_ptr<Barrier> postUpdateStartBarrier;
+      /// \brief Steps left until the timeline may be written automatically
+      /// again, so each file holds new steps.
+      private: std::size_t timelineHoldoff{0};
 
-      /// \brief Barrier to signal end of PostUpdate thread execution
-      private: std::unique_ptr<Barrier> postUpdateStopBarrier;
 
       /// \brief Map from file paths to Fuel URIs.
       private: std::unordered_map<std::string, std::string> fuelUriMap;
@@ -529,6 +969,82 @@ namespace ignition
       /// \brief True if Server::RunOnce triggered a blocking paused step
       private: bool blockingPausedStepPending{false};
 
+      /// \brief Snapshots of the world requested by GenerateWorldSdf, taken
+      /// by the simulation thread between steps so the world can be
+      /// generated from a consistent state without blocking simulation.
+      private: std::vector<std::promise<sdf_generator::WorldSnapshot>>
+          worldSnapshotRequests;
+
+      /// \brief True if there are pending world snapshot requests.
+      private: std::atomic<bool> worldSnapshotRequested{false};
+
+      /// \brief True while the simulation thread answers snapshot requests.
+      /// Otherwise, snapshots are taken directly by the requester.
+      private: bool serveWorldSnapshots{false};
+
+      /// \brief Protects the world snapshot requests.
+      private: std::mutex worldSnapshotMutex;
+
+      /// \brief Elements reused between calls to GenerateWorldSdf, so only
+      /// models which changed are copied again.
+      private: sdf_generator::ElementCache sdfGeneratorCache;
+
+      /// \brief Whether systems which only implement PostUpdate overlap the
+      /// next step.
+      private: bool overlapPostUpdate{false};
+
+      /// \brief Whether structural changes of systems running concurrently
+      /// are merged in a fixed order. See ServerConfig::SetDeterministic.
+      private: bool deterministic{false};
+
+      /// \brief Path of the ECM access report, empty if accesses aren't
+      /// traced. Systems whose PostUpdate overlaps the next step and
+      /// AsyncUpdate systems work on copies of the ECM, so their accesses
+      /// aren't recorded.
+      private: std::string ecmAccessReportPath;
+
+      /// \brief Passes state to a GUI runner in the same process, if one
+      /// attaches. Null if another runner in this process has a world with
+      /// the same name.
+      private: std::shared_ptr<LocalStateChannel> localState;
+
+      /// \brief Copy of entityCompMgr read by the systems which overlap the
+      /// next step. Only postUpdateThread uses it while postUpdatePending.
+      private: EntityComponentManager postUpdateEcm;
+
+      /// \brief Whether postUpdateEcm was given the full state already, so
+      /// only changes need to be copied.
+      private: bool postUpdateEcmSynced{false};
+
+      /// \brief Changes to apply to postUpdateEcm, serialized with
+      /// EntityComponentManager::BinaryState.
+      private: std::string postUpdateState;
+
+      /// \brief Info of the step whose PostUpdate is pending.
+      private: UpdateInfo postUpdateInfo;
+
+      /// \brief Duration of each overlapping system's latest PostUpdate, in
+      /// the order of systemsPostupdateOverlap.
+      private: std::vector<std::chrono::steady_clock::duration>
+          postUpdateDurations;
+
+      /// \brief Runs the systems which overlap the next step.
+      private: std::thread postUpdateThread;
+
+      /// \brief Protects postUpdatePending, postUpdateStop, and the PostUpdate
+      /// timing of the overlapping systems.
+      private: std::mutex postUpdateMutex;
+
+      /// \brief Notified when a PostUpdate is started or done.
+      private: std::condition_variable postUpdateCv;
+
+      /// \brief True from StartPostUpdate until the overlapping systems are
+      /// done.
+      private: bool postUpdatePending{false};
+
+      /// \brief True to stop postUpdateThread.
+      private: bool postUpdateStop{false};
+
       friend class LevelManager;
     };
     }
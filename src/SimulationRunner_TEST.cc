@@ -18,6 +18,8 @@
 #include <gtest/gtest.h>
 #include <tinyxml2.h>
 
+#include <algorithm>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/transport/Node.hh>
@@ -1057,6 +1059,60 @@ TEST_P(SimulationRunnerTest, Time)
   }
 }
 
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, RequestStepSize)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+  EXPECT_EQ(1ms, runner.StepSize());
+  EXPECT_EQ(1ms, runner.ActiveStepSize());
+  EXPECT_EQ(1ms, runner.UpdatePeriod());
+
+  std::vector<std::chrono::steady_clock::duration> changes;
+  auto conn = runner.EventMgr().Connect<events::StepSizeChanged>(
+      [&](const std::chrono::steady_clock::duration &_step)
+      {
+        changes.push_back(_step);
+      });
+
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(10));
+  EXPECT_TRUE(changes.empty());
+
+  // A smaller step is used from the next iteration, keeping the real time
+  // factor
+  runner.EventMgr().Emit<events::RequestStepSize>(250us);
+  EXPECT_TRUE(runner.Run(10));
+  EXPECT_EQ(20u, runner.CurrentInfo().iterations);
+  EXPECT_EQ(12500us, runner.CurrentInfo().simTime);
+  EXPECT_EQ(250us, runner.CurrentInfo().dt);
+  EXPECT_EQ(1ms, runner.StepSize());
+  EXPECT_EQ(250us, runner.ActiveStepSize());
+  EXPECT_EQ(250us, runner.UpdatePeriod());
+  ASSERT_EQ(1u, changes.size());
+  EXPECT_EQ(250us, changes.back());
+
+  // Larger steps are clamped to the world's step
+  runner.EventMgr().Emit<events::RequestStepSize>(5ms);
+  EXPECT_TRUE(runner.Run(10));
+  EXPECT_EQ(22500us, runner.CurrentInfo().simTime);
+  EXPECT_EQ(1ms, runner.CurrentInfo().dt);
+  EXPECT_EQ(1ms, runner.UpdatePeriod());
+  ASSERT_EQ(2u, changes.size());
+  EXPECT_EQ(1ms, changes.back());
+
+  // A zero step goes back to the world's step, which doesn't change
+  runner.EventMgr().Emit<events::RequestStepSize>(0ms);
+  EXPECT_TRUE(runner.Run(10));
+  EXPECT_EQ(1ms, runner.CurrentInfo().dt);
+  EXPECT_EQ(2u, changes.size());
+}
+
 /////////////////////////////////////////////////
 TEST_P(SimulationRunnerTest, LoadPlugins)
 {
@@ -1417,6 +1473,64 @@ TEST_P(SimulationRunnerTest, GuiInfo)
   EXPECT_EQ(plugin.innerxml().find("<deletion_topic>"), std::string::npos);
 }
 
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, StartupStats)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+
+  auto phaseNames = [&runner]()
+  {
+    std::vector<std::string> names;
+    for (const auto &phase : runner.StartupPhases())
+      names.push_back(phase.first);
+    return names;
+  };
+
+  auto names = phaseNames();
+  for (const auto &name : {"create_world", "preload_plugins",
+      "create_entities", "load_plugins", "transport"})
+  {
+    EXPECT_NE(names.end(), std::find(names.begin(), names.end(), name))
+        << name;
+  }
+  EXPECT_EQ(names.end(),
+      std::find(names.begin(), names.end(), "first_iteration"));
+
+  // The first iteration is recorded once
+  runner.SetPaused(false);
+  runner.Run(2);
+  names = phaseNames();
+  EXPECT_EQ(1, std::count(names.begin(), names.end(), "first_iteration"));
+
+  transport::Node node;
+  bool result{false};
+  unsigned int timeout{5000};
+  msgs::Param_V res;
+  EXPECT_TRUE(node.Request("/world/default/startup_stats", timeout, res,
+      result));
+  EXPECT_TRUE(result);
+  ASSERT_EQ(static_cast<int>(names.size()), res.param_size());
+
+  // Phases are sorted by start
+  double lastStart{0.0};
+  for (const auto &param : res.param())
+  {
+    const auto &params = param.params();
+    ASSERT_NE(params.end(), params.find("name"));
+    ASSERT_NE(params.end(), params.find("start_s"));
+    ASSERT_NE(params.end(), params.find("duration_s"));
+    EXPECT_LE(lastStart, params.at("start_s").double_value());
+    EXPECT_LE(0.0, params.at("duration_s").double_value());
+    lastStart = params.at("start_s").double_value();
+  }
+}
+
 /////////////////////////////////////////////////
 TEST_P(SimulationRunnerTest, GenerateWorldSdf)
 {
@@ -1444,6 +1558,93 @@ TEST_P(SimulationRunnerTest, GenerateWorldSdf)
   EXPECT_EQ(3u, world->ModelCount());
 }
 
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, Reset)
+{
+  // Load SDF file
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+
+  ASSERT_EQ(1u, root.WorldCount());
+
+  // Create simulation runner
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+  runner.SetPaused(false);
+
+  EXPECT_TRUE(runner.Run(10));
+  EXPECT_EQ(10u, runner.CurrentInfo().iterations);
+
+  auto &ecm = runner.EntityCompMgr();
+  const Entity box = ecm.EntityByComponents(components::Model(),
+      components::Name("box"));
+  ASSERT_NE(kNullEntity, box);
+  const auto initialPose = ecm.Component<components::Pose>(box)->Data();
+  const std::size_t initialCount = ecm.EntityCount();
+
+  // Change the world
+  ecm.SetComponentData<components::Pose>(box,
+      initialPose + math::Pose3d(10, 0, 0, 0, 0, 0));
+  const Entity added = ecm.CreateEntity();
+  ecm.CreateComponent(added, components::Name("added"));
+  EXPECT_EQ(initialCount + 1, ecm.EntityCount());
+
+  transport::Node node;
+  msgs::Boolean res;
+  bool result{false};
+  EXPECT_TRUE(node.Request("/world/default/reset", 1000, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+
+  // The request is processed at the end of the next step, and the world is
+  // restored on the following one
+  EXPECT_TRUE(runner.Run(2));
+  EXPECT_FALSE(runner.Paused());
+  EXPECT_LT(runner.CurrentInfo().iterations, 10u);
+  EXPECT_EQ(initialCount, ecm.EntityCount());
+  EXPECT_FALSE(ecm.HasEntity(added));
+  EXPECT_EQ(kNullEntity, ecm.EntityByComponents(components::Name("added")));
+
+  // Physics may have moved the box slightly since then
+  const auto pose = ecm.Component<components::Pose>(box)->Data();
+  EXPECT_NEAR(initialPose.Pos().X(), pose.Pos().X(), 1e-3);
+}
+
+/////////////////////////////////////////////////
+TEST(SystemTiming, Statistics)
+{
+  using std::chrono::milliseconds;
+
+  SystemTiming timing;
+  EXPECT_EQ(0u, timing.Count());
+  EXPECT_EQ(milliseconds(0), timing.Mean());
+  EXPECT_EQ(milliseconds(0), timing.Max());
+  EXPECT_EQ(milliseconds(0), timing.Percentile(99.0));
+
+  // 1 to 100 ms
+  for (int i = 1; i <= 100; ++i)
+    timing.Add(milliseconds(i));
+
+  EXPECT_EQ(100u, timing.Count());
+  EXPECT_EQ(std::chrono::microseconds(50500), timing.Mean());
+  EXPECT_EQ(milliseconds(100), timing.Max());
+  EXPECT_EQ(milliseconds(99), timing.Percentile(99.0));
+  EXPECT_EQ(milliseconds(50), timing.Percentile(50.0));
+  EXPECT_EQ(milliseconds(1), timing.Percentile(0.0));
+  EXPECT_GT(timing.Smoothed(), milliseconds(50));
+  EXPECT_LT(timing.Smoothed(), milliseconds(100));
+
+  // Old samples leave the window
+  for (std::size_t i = 0; i < SystemTiming::kWindowSize; ++i)
+    timing.Add(milliseconds(2));
+
+  EXPECT_EQ(SystemTiming::kWindowSize, timing.Count());
+  EXPECT_EQ(milliseconds(2), timing.Mean());
+  EXPECT_EQ(milliseconds(2), timing.Max());
+  EXPECT_EQ(milliseconds(2), timing.Percentile(99.0));
+}
+
 // Run multiple times. We want to make sure that static globals don't cause
 // problems.
 INSTANTIATE_TEST_SUITE_P(ServerRepeat, SimulationRunnerTest,
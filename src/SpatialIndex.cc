@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+
+#include "ignition/gazebo/components/Geometry.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Performer.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/SpatialIndex.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Cells further than this from the origin, on any axis, share keys
+/// with other cells. They still work, only queries get more candidates.
+static const int64_t kMaxCell{(1 << 20) - 1};
+
+/// \brief An indexed entity
+struct IndexEntry
+{
+  /// \brief Box in the world frame
+  math::Vector3d min;
+
+  /// \brief Box in the world frame
+  math::Vector3d max;
+
+  /// \brief Lowest cell covered by the box
+  math::Vector3<int64_t> minCell;
+
+  /// \brief Highest cell covered by the box
+  math::Vector3<int64_t> maxCell;
+
+  /// \brief Number of the last UpdateModels which saw the entity
+  uint64_t stamp{0};
+};
+
+/// \brief Private data for SpatialIndex
+class ignition::gazebo::SpatialIndexPrivate
+{
+  /// \brief Cell holding a position.
+  /// \param[in] _pos Position in the world frame.
+  /// \return Cell coordinates.
+  public: math::Vector3<int64_t> Cell(const math::Vector3d &_pos) const;
+
+  /// \brief Hash key of a cell.
+  /// \param[in] _x Cell X coordinate.
+  /// \param[in] _y Cell Y coordinate.
+  /// \param[in] _z Cell Z coordinate.
+  /// \return Key.
+  public: static uint64_t Key(int64_t _x, int64_t _y, int64_t _z);
+
+  /// \brief Add an entity to the cells covered by its entry.
+  /// \param[in] _entity Entity.
+  /// \param[in] _entry Its entry.
+  public: void AddToCells(Entity _entity, const IndexEntry &_entry);
+
+  /// \brief Remove an entity from the cells covered by its entry.
+  /// \param[in] _entity Entity.
+  /// \param[in] _entry Its entry.
+  public: void RemoveFromCells(Entity _entity, const IndexEntry &_entry);
+
+  /// \brief Set an entity's box. mutex must be held.
+  /// \param[in] _entity Entity.
+  /// \param[in] _min Box minimum corner.
+  /// \param[in] _max Box maximum corner.
+  /// \return The entity's entry.
+  public: IndexEntry &Set(Entity _entity, const math::Vector3d &_min,
+      const math::Vector3d &_max);
+
+  /// \brief Size of the grid cells, in meters
+  public: double cellSize{10.0};
+
+  /// \brief Indexed entities
+  public: std::unordered_map<Entity, IndexEntry> entries;
+
+  /// \brief Entities in each cell, by cell key
+  public: std::unordered_map<uint64_t, std::vector<Entity>> cells;
+
+  /// \brief Iteration of the last UpdateModels
+  public: uint64_t lastIteration{0};
+
+  /// \brief Number of times UpdateModels refreshed the index
+  public: uint64_t modelUpdates{0};
+
+  /// \brief Protects all of the above
+  public: mutable std::shared_mutex mutex;
+};
+
+/// \brief Mutex for gModelIndices
+static std::mutex gModelIndicesMutex;
+
+/// \brief Shared model indices, by the ECM they index
+static std::map<const EntityComponentManager *, std::weak_ptr<SpatialIndex>>
+    gModelIndices;
+
+/////////////////////////////////////////////////
+math::Vector3<int64_t> SpatialIndexPrivate::Cell(
+    const math::Vector3d &_pos) const
+{
+  auto coord = [this](double _value)
+  {
+    double cell = std::floor(_value / this->cellSize);
+    return static_cast<int64_t>(std::clamp(cell,
+        static_cast<double>(-kMaxCell), static_cast<double>(kMaxCell)));
+  };
+  return {coord(_pos.X()), coord(_pos.Y()), coord(_pos.Z())};
+}
+
+/////////////////////////////////////////////////
+uint64_t SpatialIndexPrivate::Key(int64_t _x, int64_t _y, int64_t _z)
+{
+  const uint64_t mask{0x1FFFFF};
+  return ((static_cast<uint64_t>(_x) & mask) << 42) |
+         ((static_cast<uint64_t>(_y) & mask) << 21) |
+         (static_cast<uint64_t>(_z) & mask);
+}
+
+/////////////////////////////////////////////////
+void SpatialIndexPrivate::AddToCells(Entity _entity, const IndexEntry &_entry)
+{
+  for (auto x = _entry.minCell.X(); x <= _entry.maxCell.X(); ++x)
+    for (auto y = _entry.minCell.Y(); y <= _entry.maxCell.Y(); ++y)
+      for (auto z = _entry.minCell.Z(); z <= _entry.maxCell.Z(); ++z)
+        this->cells[Key(x, y, z)].push_back(_entity);
+}
+
+/////////////////////////////////////////////////
+void SpatialIndexPrivate::RemoveFromCells(Entity _entity,
+    const IndexEntry &_entry)
+{
+  for (auto x = _entry.minCell.X(); x <= _entry.maxCell.X(); ++x)
+  {
+    for (auto y = _entry.minCell.Y(); y <= _entry.maxCell.Y(); ++y)
+    {
+      for (auto z = _entry.minCell.Z(); z <= _entry.maxCell.Z(); ++z)
+      {
+        auto cell = this->cells.find(Key(x, y, z));
+        if (cell == this->cells.end())
+          continue;
+
+        auto &cellEntities = cell->second;
+        auto it = std::find(cellEntities.begin(), cellEntities.end(),
+            _entity);
+        if (it != cellEntities.end())
+        {
+          *it = cellEntities.back();
+          cellEntities.pop_back();
+        }
+        if (cellEntities.empty())
+          this->cells.erase(cell);
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+IndexEntry &SpatialIndexPrivate::Set(Entity _entity,
+    const math::Vector3d &_min, const math::Vector3d &_max)
+{
+  auto minCell = this->Cell(_min);
+  auto maxCell = this->Cell(_max);
+
+  auto [it, inserted] = this->entries.try_emplace(_entity);
+  auto &entry = it->second;
+  if (inserted)
+  {
+    entry.minCell = minCell;
+    entry.maxCell = maxCell;
+    this->AddToCells(_entity, entry);
+  }
+  // Only touch the cells if the entity moved to other ones
+  else if (entry.minCell != minCell || entry.maxCell != maxCell)
+  {
+    this->RemoveFromCells(_entity, entry);
+    entry.minCell = minCell;
+    entry.maxCell = maxCell;
+    this->AddToCells(_entity, entry);
+  }
+  entry.min = _min;
+  entry.max = _max;
+  return entry;
+}
+
+/////////////////////////////////////////////////
+SpatialIndex::SpatialIndex(double _cellSize)
+  : dataPtr(std::make_unique<SpatialIndexPrivate>())
+{
+  if (_cellSize > 0.0)
+    this->dataPtr->cellSize = _cellSize;
+  else
+    ignerr << "Invalid cell size [" << _cellSize << "]" << std::endl;
+}
+
+/////////////////////////////////////////////////
+SpatialIndex::~SpatialIndex() = default;
+
+/////////////////////////////////////////////////
+std::shared_ptr<SpatialIndex> SpatialIndex::Models(
+    const EntityComponentManager &_ecm)
+{
+  std::lock_guard<std::mutex> lock(gModelIndicesMutex);
+
+  // Forget indices nobody uses anymore
+  for (auto it = gModelIndices.begin(); it != gModelIndices.end();)
+  {
+    if (it->second.expired())
+      it = gModelIndices.erase(it);
+    else
+      ++it;
+  }
+
+  auto index = gModelIndices[&_ecm].lock();
+  if (!index)
+  {
+    index = std::make_shared<SpatialIndex>();
+    gModelIndices[&_ecm] = index;
+  }
+  return index;
+}
+
+/////////////////////////////////////////////////
+void SpatialIndex::UpdateModels(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm)
+{
+  std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+  // Systems sharing the index only refresh it once per iteration
+  if (this->dataPtr->modelUpdates > 0 &&
+      this->dataPtr->lastIteration == _info.iterations)
+  {
+    return;
+  }
+  IGN_PROFILE("SpatialIndex::UpdateModels");
+
+  this->dataPtr->lastIteration = _info.iterations;
+  const uint64_t stamp = ++this->dataPtr->modelUpdates;
+
+  _ecm.Each<components::Model, components::Pose>(
+      [&](const Entity &_entity,
+          const components::Model *,
+          const components::Pose *_pose) -> bool
+      {
+        const auto &pos = _pose->Data().Pos();
+        this->dataPtr->Set(_entity, pos, pos).stamp = stamp;
+        return true;
+      });
+
+  _ecm.Each<components::Performer, components::Geometry,
+            components::ParentEntity>(
+      [&](const Entity &_entity,
+          const components::Performer *,
+          const components::Geometry *_geometry,
+          const components::ParentEntity *_parent) -> bool
+      {
+        auto box = _geometry->Data().BoxShape();
+        auto pose = _ecm.Component<components::Pose>(_parent->Data());
+        if (nullptr == box || nullptr == pose)
+          return true;
+
+        const auto &pos = pose->Data().Pos();
+        this->dataPtr->Set(_entity, pos - box->Size() / 2,
+            pos + box->Size() / 2).stamp = stamp;
+        return true;
+      });
+
+  // Remove entities which weren't seen, they were removed
+  for (auto it = this->dataPtr->entries.begin();
+      it != this->dataPtr->entries.end();)
+  {
+    if (it->second.stamp != stamp)
+    {
+      this->dataPtr->RemoveFromCells(it->first, it->second);
+      it = this->dataPtr->entries.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void SpatialIndex::Set(Entity _entity, const math::AxisAlignedBox &_box)
+{
+  std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->Set(_entity, _box.Min(), _box.Max());
+}
+
+/////////////////////////////////////////////////
+bool SpatialIndex::Remove(Entity _entity)
+{
+  std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->entries.find(_entity);
+  if (it == this->dataPtr->entries.end())
+    return false;
+
+  this->dataPtr->RemoveFromCells(it->first, it->second);
+  this->dataPtr->entries.erase(it);
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::vector<Entity> SpatialIndex::Query(
+    const math::AxisAlignedBox &_region) const
+{
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+  const auto &regionMin = _region.Min();
+  const auto &regionMax = _region.Max();
+  auto intersects = [&](const IndexEntry &_entry)
+  {
+    return _entry.min.X() <= regionMax.X() && _entry.max.X() >= regionMin.X()
+        && _entry.min.Y() <= regionMax.Y() && _entry.max.Y() >= regionMin.Y()
+        && _entry.min.Z() <= regionMax.Z() && _entry.max.Z() >= regionMin.Z();
+  };
+
+  std::vector<Entity> result;
+  auto minCell = this->dataPtr->Cell(regionMin);
+  auto maxCell = this->dataPtr->Cell(regionMax);
+  const double cellCount =
+      static_cast<double>(maxCell.X() - minCell.X() + 1) *
+      static_cast<double>(maxCell.Y() - minCell.Y() + 1) *
+      static_cast<double>(maxCell.Z() - minCell.Z() + 1);
+
+  // Regions covering more cells than there are entities are cheaper to
+  // check against every entity
+  if (cellCount >= static_cast<double>(this->dataPtr->entries.size()))
+  {
+    for (const auto &[entity, entry] : this->dataPtr->entries)
+    {
+      if (intersects(entry))
+        result.push_back(entity);
+    }
+    return result;
+  }
+
+  for (auto x = minCell.X(); x <= maxCell.X(); ++x)
+  {
+    for (auto y = minCell.Y(); y <= maxCell.Y(); ++y)
+    {
+      for (auto z = minCell.Z(); z <= maxCell.Z(); ++z)
+      {
+        auto cell = this->dataPtr->cells.find(SpatialIndexPrivate::Key(
+            x, y, z));
+        if (cell == this->dataPtr->cells.end())
+          continue;
+
+        for (auto entity : cell->second)
+        {
+          if (intersects(this->dataPtr->entries.at(entity)))
+            result.push_back(entity);
+        }
+      }
+    }
+  }
+
+  // Boxes spanning several cells are found more than once
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+/////////////////////////////////////////////////
+std::size_t SpatialIndex::Size() const
+{
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->entries.size();
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <sdf/Box.hh>
+#include <sdf/Geometry.hh>
+
+#include "ignition/gazebo/components/Geometry.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Performer.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SpatialIndex.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Sort entities to compare them.
+/// \param[in] _entities Entities.
+/// \return Sorted entities.
+std::vector<Entity> Sorted(std::vector<Entity> _entities)
+{
+  std::sort(_entities.begin(), _entities.end());
+  return _entities;
+}
+
+/////////////////////////////////////////////////
+TEST(SpatialIndexTest, SetQueryRemove)
+{
+  SpatialIndex index(1.0);
+  EXPECT_EQ(0u, index.Size());
+
+  index.Set(1, math::AxisAlignedBox({0, 0, 0}, {0, 0, 0}));
+  index.Set(2, math::AxisAlignedBox({5, 5, 0}, {5, 5, 0}));
+  // Spans several cells
+  index.Set(3, math::AxisAlignedBox({-2, -2, -2}, {2.5, 2.5, 2.5}));
+  EXPECT_EQ(3u, index.Size());
+
+  EXPECT_EQ(std::vector<Entity>({1, 3}), Sorted(index.Query(
+      math::AxisAlignedBox({-0.5, -0.5, -0.5}, {0.5, 0.5, 0.5}))));
+  EXPECT_EQ(std::vector<Entity>({2}), Sorted(index.Query(
+      math::AxisAlignedBox({4.5, 4.5, -0.5}, {5.5, 5.5, 0.5}))));
+  EXPECT_TRUE(index.Query(
+      math::AxisAlignedBox({10, 10, 10}, {11, 11, 11})).empty());
+
+  // Touching counts
+  EXPECT_EQ(std::vector<Entity>({3}), Sorted(index.Query(
+      math::AxisAlignedBox({2.5, 2.5, 2.5}, {3, 3, 3}))));
+
+  // A large region checks every entity
+  EXPECT_EQ(std::vector<Entity>({1, 2, 3}), Sorted(index.Query(
+      math::AxisAlignedBox({-100, -100, -100}, {100, 100, 100}))));
+
+  // Move to another cell
+  index.Set(2, math::AxisAlignedBox({-5, -5, 0}, {-5, -5, 0}));
+  EXPECT_TRUE(index.Query(
+      math::AxisAlignedBox({4.5, 4.5, -0.5}, {5.5, 5.5, 0.5})).empty());
+  EXPECT_EQ(std::vector<Entity>({2}), Sorted(index.Query(
+      math::AxisAlignedBox({-5.5, -5.5, -0.5}, {-4.5, -4.5, 0.5}))));
+
+  EXPECT_TRUE(index.Remove(3));
+  EXPECT_FALSE(index.Remove(3));
+  EXPECT_EQ(std::vector<Entity>({1}), Sorted(index.Query(
+      math::AxisAlignedBox({-0.5, -0.5, -0.5}, {0.5, 0.5, 0.5}))));
+  EXPECT_EQ(2u, index.Size());
+}
+
+/////////////////////////////////////////////////
+TEST(SpatialIndexTest, Models)
+{
+  EntityComponentManager ecm;
+
+  auto model = ecm.CreateEntity();
+  ecm.CreateComponent(model, components::Model());
+  ecm.CreateComponent(model,
+      components::Pose(math::Pose3d(20, 0, 0, 0, 0, 0)));
+
+  auto performerModel = ecm.CreateEntity();
+  ecm.CreateComponent(performerModel, components::Model());
+  ecm.CreateComponent(performerModel,
+      components::Pose(math::Pose3d(0, 0, 0, 0, 0, 0)));
+
+  sdf::Box box;
+  box.SetSize({2, 2, 2});
+  sdf::Geometry geometry;
+  geometry.SetType(sdf::GeometryType::BOX);
+  geometry.SetBoxShape(box);
+
+  auto performer = ecm.CreateEntity();
+  ecm.CreateComponent(performer, components::Performer());
+  ecm.CreateComponent(performer, components::Geometry(geometry));
+  ecm.CreateComponent(performer, components::ParentEntity(performerModel));
+
+  auto index = SpatialIndex::Models(ecm);
+  EXPECT_EQ(index, SpatialIndex::Models(ecm));
+
+  UpdateInfo info;
+  info.iterations = 1;
+  index->UpdateModels(info, ecm);
+  EXPECT_EQ(3u, index->Size());
+
+  // The performer is found by its box, the model by its position
+  EXPECT_EQ(std::vector<Entity>({performer}), Sorted(index->Query(
+      math::AxisAlignedBox({0.9, 0.9, 0.9}, {1.5, 1.5, 1.5}))));
+  EXPECT_EQ(std::vector<Entity>({model}), Sorted(index->Query(
+      math::AxisAlignedBox({19, -1, -1}, {21, 1, 1}))));
+
+  // Not refreshed again on the same iteration
+  ecm.Component<components::Pose>(model)->Data().Pos().X(-20);
+  index->UpdateModels(info, ecm);
+  EXPECT_EQ(std::vector<Entity>({model}), Sorted(index->Query(
+      math::AxisAlignedBox({19, -1, -1}, {21, 1, 1}))));
+
+  info.iterations = 2;
+  index->UpdateModels(info, ecm);
+  EXPECT_TRUE(index->Query(
+      math::AxisAlignedBox({19, -1, -1}, {21, 1, 1})).empty());
+  EXPECT_EQ(std::vector<Entity>({model}), Sorted(index->Query(
+      math::AxisAlignedBox({-21, -1, -1}, {-19, 1, 1}))));
+
+  // Removed entities are dropped
+  ecm.RequestRemoveEntity(model);
+  ecm.ProcessRemoveEntityRequests();
+  info.iterations = 3;
+  index->UpdateModels(info, ecm);
+  EXPECT_EQ(2u, index->Size());
+}
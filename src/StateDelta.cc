@@ -0,0 +1,439 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+
+#include "ignition/gazebo/components/Factory.hh"
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/StateDelta.hh"
+#include "ignition/gazebo/Types.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Components smaller than this are always sent in full.
+static const std::size_t kMinDeltaSize{64};
+
+/// \brief Shortest run of unchanged bytes worth copying from the base
+/// instead of sending as part of a literal.
+static const std::size_t kMinMatch{8};
+
+/// \brief Values sent or received so far, shared by encoders and decoders.
+class StateDeltaValues
+{
+  /// \brief Get whether a component type is delta encoded.
+  /// \param[in] _type Component type.
+  /// \return True if delta encoded.
+  public: bool IsDeltaType(const ComponentTypeId _type)
+  {
+    auto it = this->deltaTypes.find(_type);
+    if (it != this->deltaTypes.end())
+      return it->second;
+
+    bool delta{false};
+    if (components::Factory::Instance()->HasType(_type))
+    {
+      auto comp = components::Factory::Instance()->New(_type);
+      delta = nullptr != comp && comp->DeltaEncoded();
+    }
+    this->deltaTypes[_type] = delta;
+    return delta;
+  }
+
+  /// \brief Forget the values of a component.
+  /// \param[in] _entity Entity.
+  /// \param[in] _type Component type.
+  public: void Erase(const Entity _entity, const ComponentTypeId _type)
+  {
+    auto it = this->values.find(_entity);
+    if (it != this->values.end())
+      it->second.erase(_type);
+  }
+
+  /// \brief Last serialized value of each delta encoded component.
+  public: std::unordered_map<Entity,
+      std::unordered_map<ComponentTypeId, std::string>> values;
+
+  /// \brief Whether each component type seen so far is delta encoded.
+  public: std::unordered_map<ComponentTypeId, bool> deltaTypes;
+};
+
+/// \brief Private data class for StateDeltaEncoder
+class ignition::gazebo::StateDeltaEncoderPrivate : public StateDeltaValues
+{
+};
+
+/// \brief Private data class for StateDeltaDecoder
+class ignition::gazebo::StateDeltaDecoderPrivate : public StateDeltaValues
+{
+};
+
+/////////////////////////////////////////////////
+/// \brief 64-bit FNV-1a hash.
+/// \param[in] _data Data to hash.
+/// \return Hash.
+static uint64_t Hash(const std::string &_data)
+{
+  uint64_t hash{14695981039346656037ull};
+  for (const char c : _data)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/////////////////////////////////////////////////
+/// \brief Append a base 128 varint.
+/// \param[in, out] _out Buffer.
+/// \param[in] _value Value.
+static void PutVarint(std::string &_out, uint64_t _value)
+{
+  while (_value >= 0x80)
+  {
+    _out.push_back(static_cast<char>((_value & 0x7F) | 0x80));
+    _value >>= 7;
+  }
+  _out.push_back(static_cast<char>(_value));
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a base 128 varint, advancing the read position.
+/// \param[in] _in Buffer.
+/// \param[in, out] _pos Read position.
+/// \param[out] _value Value.
+/// \return False if the buffer is too short.
+static bool GetVarint(const std::string &_in, std::size_t &_pos,
+    uint64_t &_value)
+{
+  _value = 0;
+  for (unsigned int shift = 0; shift < 64; shift += 7)
+  {
+    if (_pos >= _in.size())
+      return false;
+    const auto byte = static_cast<unsigned char>(_in[_pos++]);
+    _value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+/// \brief Count the bytes which are equal in two buffers from a position.
+/// \param[in] _a First buffer.
+/// \param[in] _b Second buffer.
+/// \param[in] _pos Position to start at.
+/// \param[in] _end Position to stop at.
+/// \return Number of equal bytes.
+static std::size_t MatchLength(const std::string &_a, const std::string &_b,
+    std::size_t _pos, std::size_t _end)
+{
+  std::size_t length{0};
+  while (_pos + length < _end && _pos + length < _a.size() &&
+      _a[_pos + length] == _b[_pos + length])
+  {
+    ++length;
+  }
+  return length;
+}
+
+/////////////////////////////////////////////////
+/// \brief Encode the difference between two serialized values. Bytes are
+/// compared at the same position, which suits serialized messages whose
+/// fields changed without changing size, and the common suffix is copied
+/// too, in case the size changed. The layout is:
+///
+/// * varint hash of the base
+/// * varint hash of the target
+/// * varint size of the target
+/// * varint size of the suffix copied from the end of the base
+/// * pairs of a varint count of bytes copied from the base, at the same
+///   position, and a varint count of literal bytes followed by them, until
+///   the suffix
+///
+/// \param[in] _base Previous value.
+/// \param[in] _target New value.
+/// \param[out] _delta Delta.
+/// \return False if the delta isn't smaller than the new value.
+static bool EncodeDelta(const std::string &_base, const std::string &_target,
+    std::string &_delta)
+{
+  if (_target.size() < kMinDeltaSize)
+    return false;
+
+  std::size_t suffix{0};
+  const std::size_t maxSuffix = std::min(_base.size(), _target.size());
+  while (suffix < maxSuffix &&
+      _base[_base.size() - suffix - 1] == _target[_target.size() - suffix - 1])
+  {
+    ++suffix;
+  }
+  const std::size_t end = _target.size() - suffix;
+
+  _delta.clear();
+  PutVarint(_delta, Hash(_base));
+  PutVarint(_delta, Hash(_target));
+  PutVarint(_delta, _target.size());
+  PutVarint(_delta, suffix);
+
+  std::size_t pos{0};
+  while (pos < end)
+  {
+    const std::size_t copy = MatchLength(_base, _target, pos, end);
+    pos += copy;
+
+    const std::size_t literalStart = pos;
+    while (pos < end &&
+        MatchLength(_base, _target, pos, std::min(end, pos + kMinMatch)) <
+        std::min(kMinMatch, end - pos))
+    {
+      ++pos;
+    }
+
+    PutVarint(_delta, copy);
+    PutVarint(_delta, pos - literalStart);
+    _delta.append(_target, literalStart, pos - literalStart);
+
+    if (_delta.size() >= _target.size())
+      return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+/// \brief Apply a delta created by EncodeDelta.
+/// \param[in] _base Previous value.
+/// \param[in] _delta Delta.
+/// \param[out] _target New value.
+/// \return False if the delta doesn't apply to the base, or is malformed.
+static bool DecodeDelta(const std::string &_base, const std::string &_delta,
+    std::string &_target)
+{
+  std::size_t in{0};
+  uint64_t baseHash, targetHash, size, suffix;
+  if (!GetVarint(_delta, in, baseHash) || !GetVarint(_delta, in, targetHash) ||
+      !GetVarint(_delta, in, size) || !GetVarint(_delta, in, suffix))
+  {
+    return false;
+  }
+
+  // The delta was already applied, e.g. because a log is replayed from the
+  // keyframe which recorded its result
+  const uint64_t hash = Hash(_base);
+  if (hash == targetHash && _base.size() == size)
+  {
+    _target = _base;
+    return true;
+  }
+
+  if (hash != baseHash || suffix > size || suffix > _base.size())
+    return false;
+
+  const std::size_t end = size - suffix;
+  _target.clear();
+  _target.reserve(size);
+  while (_target.size() < end)
+  {
+    uint64_t copy, literal;
+    if (!GetVarint(_delta, in, copy) || !GetVarint(_delta, in, literal))
+      return false;
+
+    const std::size_t pos = _target.size();
+    if (pos + copy > _base.size() || pos + copy + literal > end ||
+        in + literal > _delta.size())
+    {
+      return false;
+    }
+    _target.append(_base, pos, copy);
+    _target.append(_delta, in, literal);
+    in += literal;
+  }
+  _target.append(_base, _base.size() - suffix, suffix);
+
+  return Hash(_target) == targetHash;
+}
+
+/////////////////////////////////////////////////
+StateDeltaEncoder::StateDeltaEncoder()
+  : dataPtr(std::make_unique<StateDeltaEncoderPrivate>())
+{
+}
+
+/////////////////////////////////////////////////
+StateDeltaEncoder::~StateDeltaEncoder() = default;
+
+/////////////////////////////////////////////////
+void StateDeltaEncoder::Encode(msgs::SerializedStateMap &_msg)
+{
+  IGN_PROFILE("StateDeltaEncoder::Encode");
+  msgs::Header_Map *deltas{nullptr};
+  std::string delta;
+  for (auto &entityIt : *_msg.mutable_entities())
+  {
+    auto &entityMsg = entityIt.second;
+    Entity entity{entityMsg.id()};
+    if (entityMsg.remove())
+    {
+      this->dataPtr->values.erase(entity);
+      continue;
+    }
+
+    for (auto &compIt : *entityMsg.mutable_components())
+    {
+      auto &compMsg = compIt.second;
+      if (compMsg.remove())
+      {
+        this->dataPtr->Erase(entity, compMsg.type());
+        continue;
+      }
+
+      if (compMsg.component().empty() ||
+          !this->dataPtr->IsDeltaType(compMsg.type()))
+      {
+        continue;
+      }
+
+      auto &previous = this->dataPtr->values[entity][compMsg.type()];
+      if (!previous.empty() &&
+          EncodeDelta(previous, compMsg.component(), delta))
+      {
+        previous.swap(*compMsg.mutable_component());
+        compMsg.mutable_component()->swap(delta);
+
+        if (nullptr == deltas)
+        {
+          deltas = _msg.mutable_header()->add_data();
+          deltas->set_key(kStateDeltaKey);
+        }
+        deltas->add_value(std::to_string(entity) + " " +
+            std::to_string(compMsg.type()));
+      }
+      else
+      {
+        previous = compMsg.component();
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void StateDeltaEncoder::Reset()
+{
+  this->dataPtr->values.clear();
+}
+
+/////////////////////////////////////////////////
+StateDeltaDecoder::StateDeltaDecoder()
+  : dataPtr(std::make_unique<StateDeltaDecoderPrivate>())
+{
+}
+
+/////////////////////////////////////////////////
+StateDeltaDecoder::~StateDeltaDecoder() = default;
+
+/////////////////////////////////////////////////
+bool StateDeltaDecoder::Decode(msgs::SerializedStateMap &_msg)
+{
+  IGN_PROFILE("StateDeltaDecoder::Decode");
+
+  // Components holding deltas, the list is removed from the message
+  std::set<std::pair<Entity, ComponentTypeId>> deltas;
+  auto *headerData = _msg.mutable_header()->mutable_data();
+  for (int i = 0; i < headerData->size(); ++i)
+  {
+    if (headerData->Get(i).key() != kStateDeltaKey)
+      continue;
+
+    for (const auto &value : headerData->Get(i).value())
+    {
+      std::istringstream istr(value);
+      Entity entity;
+      ComponentTypeId type;
+      if (istr >> entity >> type)
+        deltas.insert({entity, type});
+    }
+    headerData->DeleteSubrange(i, 1);
+    break;
+  }
+
+  bool result{true};
+  std::string value;
+  for (auto &entityIt : *_msg.mutable_entities())
+  {
+    auto &entityMsg = entityIt.second;
+    Entity entity{entityMsg.id()};
+    if (entityMsg.remove())
+    {
+      this->dataPtr->values.erase(entity);
+      continue;
+    }
+
+    for (auto &compIt : *entityMsg.mutable_components())
+    {
+      auto &compMsg = compIt.second;
+      if (compMsg.remove())
+      {
+        this->dataPtr->Erase(entity, compMsg.type());
+        continue;
+      }
+
+      if (compMsg.component().empty())
+        continue;
+
+      bool isDelta = deltas.find({entity, compMsg.type()}) != deltas.end();
+      if (!isDelta && !this->dataPtr->IsDeltaType(compMsg.type()))
+        continue;
+
+      auto &previous = this->dataPtr->values[entity][compMsg.type()];
+      if (!isDelta)
+      {
+        previous = compMsg.component();
+        continue;
+      }
+
+      if (!DecodeDelta(previous, compMsg.component(), value))
+      {
+        ignwarn << "Failed to apply delta to component of type ["
+                << compMsg.type() << "] of entity [" << entity
+                << "], its previous value is unknown. Skipping it."
+                << std::endl;
+        compMsg.clear_component();
+        this->dataPtr->Erase(entity, compMsg.type());
+        result = false;
+        continue;
+      }
+      compMsg.set_component(value);
+      previous.swap(value);
+    }
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+void StateDeltaDecoder::Reset()
+{
+  this->dataPtr->values.clear();
+}
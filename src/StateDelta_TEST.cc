@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include "ignition/gazebo/components/Factory.hh"
+#include "ignition/gazebo/Entity.hh"
+
+#include "ignition/gazebo/StateDelta.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Serializes strings as they are, opting into delta encoding.
+class BlobSerializer
+{
+  public: static constexpr bool kDeltaEncoded{true};
+
+  public: static std::ostream &Serialize(std::ostream &_out,
+      const std::string &_data)
+  {
+    _out << _data;
+    return _out;
+  }
+
+  public: static std::istream &Deserialize(std::istream &_in,
+      std::string &_data)
+  {
+    _data = std::string(std::istreambuf_iterator<char>(_in), {});
+    return _in;
+  }
+};
+
+using BlobComponent = components::Component<std::string, class BlobTag,
+    BlobSerializer>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.BlobComponent",
+    BlobComponent)
+
+using IntComponent = components::Component<int, class IntComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.IntComponent",
+    IntComponent)
+
+/////////////////////////////////////////////////
+/// \brief Set a component in a state message.
+void SetComponent(msgs::SerializedStateMap &_msg, Entity _entity,
+    const components::BaseComponent &_comp)
+{
+  auto &entityMsg = (*_msg.mutable_entities())[_entity];
+  entityMsg.set_id(_entity);
+  auto &compMsg = (*entityMsg.mutable_components())[_comp.TypeId()];
+  compMsg.set_type(_comp.TypeId());
+  std::ostringstream ostr;
+  _comp.Serialize(ostr);
+  compMsg.set_component(ostr.str());
+}
+
+/////////////////////////////////////////////////
+/// \brief Get a serialized component from a state message.
+std::string Component(const msgs::SerializedStateMap &_msg, Entity _entity,
+    ComponentTypeId _type)
+{
+  return _msg.entities().at(_entity).components().at(_type).component();
+}
+
+/////////////////////////////////////////////////
+TEST(StateDelta, Trait)
+{
+  EXPECT_TRUE(BlobComponent().DeltaEncoded());
+  EXPECT_FALSE(IntComponent().DeltaEncoded());
+}
+
+/////////////////////////////////////////////////
+TEST(StateDelta, RoundTrip)
+{
+  StateDeltaEncoder encoder;
+  StateDeltaDecoder decoder;
+
+  std::string blob(1000, 'a');
+  for (std::size_t i = 0; i < blob.size(); ++i)
+    blob[i] = static_cast<char>('a' + i % 26);
+
+  // The first message is sent in full
+  msgs::SerializedStateMap msg;
+  SetComponent(msg, 1, BlobComponent(blob));
+  SetComponent(msg, 1, IntComponent(3));
+  encoder.Encode(msg);
+  EXPECT_EQ(0, msg.header().data_size());
+  EXPECT_EQ(blob, Component(msg, 1, BlobComponent::typeId));
+  EXPECT_TRUE(decoder.Decode(msg));
+  EXPECT_EQ(blob, Component(msg, 1, BlobComponent::typeId));
+
+  // Small changes are sent as a delta, also when the size changes
+  blob[10] = 'X';
+  blob[500] = 'Y';
+  blob.insert(700, "inserted");
+  msg.Clear();
+  SetComponent(msg, 1, BlobComponent(blob));
+  SetComponent(msg, 1, IntComponent(4));
+  encoder.Encode(msg);
+  ASSERT_EQ(1, msg.header().data_size());
+  EXPECT_EQ(kStateDeltaKey, msg.header().data(0).key());
+  EXPECT_LT(Component(msg, 1, BlobComponent::typeId).size(),
+      blob.size() / 4);
+
+  auto copy = msg;
+  EXPECT_TRUE(decoder.Decode(msg));
+  EXPECT_EQ(0, msg.header().data_size());
+  EXPECT_EQ(blob, Component(msg, 1, BlobComponent::typeId));
+
+  std::ostringstream ostr;
+  IntComponent(4).Serialize(ostr);
+  EXPECT_EQ(ostr.str(), Component(msg, 1, IntComponent::typeId));
+
+  // Decoding the same delta again gives the same value
+  EXPECT_TRUE(decoder.Decode(copy));
+  EXPECT_EQ(blob, Component(copy, 1, BlobComponent::typeId));
+
+  // Without the base, the delta can't be applied and the component is
+  // cleared so it's skipped
+  StateDeltaDecoder lateDecoder;
+  blob[20] = 'Z';
+  msg.Clear();
+  SetComponent(msg, 1, BlobComponent(blob));
+  encoder.Encode(msg);
+  copy = msg;
+  EXPECT_FALSE(lateDecoder.Decode(msg));
+  EXPECT_TRUE(Component(msg, 1, BlobComponent::typeId).empty());
+  EXPECT_TRUE(decoder.Decode(copy));
+  EXPECT_EQ(blob, Component(copy, 1, BlobComponent::typeId));
+
+  // After a reset, values are sent in full again
+  encoder.Reset();
+  blob[30] = 'W';
+  msg.Clear();
+  SetComponent(msg, 1, BlobComponent(blob));
+  encoder.Encode(msg);
+  EXPECT_EQ(0, msg.header().data_size());
+  EXPECT_TRUE(lateDecoder.Decode(msg));
+  EXPECT_EQ(blob, Component(msg, 1, BlobComponent::typeId));
+}
+
+/////////////////////////////////////////////////
+TEST(StateDelta, Removal)
+{
+  StateDeltaEncoder encoder;
+  StateDeltaDecoder decoder;
+  const std::string blob(200, 'b');
+
+  msgs::SerializedStateMap msg;
+  SetComponent(msg, 1, BlobComponent(blob));
+  encoder.Encode(msg);
+  EXPECT_TRUE(decoder.Decode(msg));
+
+  // Removing the entity forgets its values
+  msg.Clear();
+  (*msg.mutable_entities())[1].set_id(1);
+  (*msg.mutable_entities())[1].set_remove(true);
+  encoder.Encode(msg);
+  EXPECT_TRUE(decoder.Decode(msg));
+
+  msg.Clear();
+  SetComponent(msg, 1, BlobComponent(blob + "c"));
+  encoder.Encode(msg);
+  EXPECT_EQ(0, msg.header().data_size());
+  EXPECT_TRUE(decoder.Decode(msg));
+  EXPECT_EQ(blob + "c", Component(msg, 1, BlobComponent::typeId));
+}
@@ -0,0 +1,477 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <ignition/msgs/bytes.pb.h>
+#include <ignition/msgs/stringmsg.pb.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/Uuid.hh>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/Conversions.hh"
+#include "ignition/gazebo/PoseDeltaStream.hh"
+#include "ignition/gazebo/StateMirror.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Private data for StateMirror
+class ignition::gazebo::StateMirrorPrivate
+{
+  /// \brief Request the whole state from the SceneBroadcaster.
+  public: void RequestState();
+
+  /// \brief Callback for the async state service, which receives the
+  /// initial state.
+  /// \param[in] _res Response containing the state.
+  public: void OnStateAsyncService(const msgs::SerializedStepMap &_res);
+
+  /// \brief Callback when a new state is received.
+  /// \param[in] _msg Message containing the state.
+  public: void OnState(const msgs::SerializedStepMap &_msg);
+
+  /// \brief Callback when delta encoded dynamic poses are received.
+  /// \param[in] _msg Message containing an encoded frame.
+  public: void OnPoseDelta(const msgs::Bytes &_msg);
+
+  /// \brief Set pose components from decoded poses. ecmMutex must be held.
+  /// \param[in] _entities Entities to set. Those which are not in the ECM yet
+  /// are skipped, they'll come with the next state.
+  public: void ApplyPoseDeltas(const std::vector<Entity> &_entities);
+
+  /// \brief Name of the mirrored world
+  public: std::string worldName;
+
+  /// \brief Topic where state is received
+  public: std::string stateTopic;
+
+  /// \brief Service which receives the initial state
+  public: std::string stateAsyncService;
+
+  /// \brief Rate at which the update thread runs, in Hz.
+  public: double updateRate{30.0};
+
+  /// \brief Whether the delta encoded dynamic poses are used.
+  public: bool poseDeltaEnabled{false};
+
+  /// \brief Protects pendingState and hasPendingState. It's only held while
+  /// messages are merged or taken, so the transport thread never waits for
+  /// callbacks.
+  public: std::mutex stateMutex;
+
+  /// \brief State received since the last update, merged so that only the
+  /// latest value of each component is kept.
+  public: msgs::SerializedStepMap pendingState;
+
+  /// \brief Whether pendingState holds anything.
+  public: bool hasPendingState{false};
+
+  /// \brief Protects ecm, updateInfo, changes, poseDeltaDecoder, hasState
+  /// and callbacks.
+  public: mutable std::mutex ecmMutex;
+
+  /// \brief The mirrored entity-component manager
+  public: EntityComponentManager ecm;
+
+  /// \brief Time and iteration of the latest state
+  public: UpdateInfo updateInfo;
+
+  /// \brief Changes since the last update
+  public: StateMirrorChanges changes;
+
+  /// \brief Decodes the delta encoded dynamic poses.
+  public: PoseDeltaDecoder poseDeltaDecoder;
+
+  /// \brief Whether any state was applied yet
+  public: bool hasState{false};
+
+  /// \brief Change callbacks, by id
+  public: std::map<uint64_t, StateMirror::ChangeCallback> callbacks;
+
+  /// \brief Id of the next callback
+  public: uint64_t nextCallbackId{0};
+
+  /// \brief Thread which runs the updates
+  public: std::thread updateThread;
+
+  /// \brief Flag used to end the update thread
+  public: std::atomic<bool> running{false};
+
+  /// \brief Transport node
+  public: std::unique_ptr<transport::Node> node;
+};
+
+/////////////////////////////////////////////////
+StateMirror::StateMirror(const std::string &_worldName)
+  : dataPtr(std::make_unique<StateMirrorPrivate>())
+{
+  this->dataPtr->worldName = _worldName;
+}
+
+/////////////////////////////////////////////////
+StateMirror::~StateMirror()
+{
+  this->Stop();
+}
+
+/////////////////////////////////////////////////
+void StateMirror::SetUpdateRate(double _hz)
+{
+  if (_hz < 0.0)
+  {
+    ignerr << "Invalid update rate [" << _hz << "]" << std::endl;
+    return;
+  }
+  this->dataPtr->updateRate = _hz;
+}
+
+/////////////////////////////////////////////////
+void StateMirror::SetPoseDeltaEnabled(bool _enabled)
+{
+  this->dataPtr->poseDeltaEnabled = _enabled;
+}
+
+/////////////////////////////////////////////////
+bool StateMirror::Start()
+{
+  if (this->dataPtr->node)
+  {
+    ignwarn << "State mirror for world [" << this->dataPtr->worldName
+            << "] already started" << std::endl;
+    return true;
+  }
+
+  this->dataPtr->stateTopic = transport::TopicUtils::AsValidTopic("/world/" +
+      this->dataPtr->worldName + "/state");
+  if (this->dataPtr->stateTopic.empty())
+  {
+    ignerr << "Failed to generate valid topic for world ["
+           << this->dataPtr->worldName << "]" << std::endl;
+    return false;
+  }
+
+  // Unique per mirror, so several mirrors can run in one process
+  this->dataPtr->stateAsyncService = transport::TopicUtils::AsValidTopic(
+      "/state_mirror/" + common::Uuid().String() + "/state_async");
+  if (this->dataPtr->stateAsyncService.empty())
+  {
+    ignerr << "Failed to generate valid state service" << std::endl;
+    return false;
+  }
+
+  this->dataPtr->node = std::make_unique<transport::Node>();
+
+  if (this->dataPtr->poseDeltaEnabled)
+  {
+    auto poseDeltaTopic = transport::TopicUtils::AsValidTopic("/world/" +
+        this->dataPtr->worldName + "/dynamic_pose/delta");
+    if (!this->dataPtr->node->Subscribe(poseDeltaTopic,
+        &StateMirrorPrivate::OnPoseDelta, this->dataPtr.get()))
+    {
+      ignerr << "Failed to subscribe to [" << poseDeltaTopic << "]"
+             << std::endl;
+    }
+  }
+
+  igndbg << "Requesting initial state from [" << this->dataPtr->stateTopic
+         << "]..." << std::endl;
+  this->dataPtr->RequestState();
+
+  if (this->dataPtr->updateRate <= 0.0)
+    return true;
+
+  const auto updatePeriod =
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / this->dataPtr->updateRate));
+
+  this->dataPtr->running = true;
+  this->dataPtr->updateThread = std::thread([this, updatePeriod]()
+  {
+    auto nextUpdate = std::chrono::steady_clock::now();
+    while (this->dataPtr->running)
+    {
+      this->Update();
+
+      // Keep the rate even if updates are slow, but don't try to catch up
+      nextUpdate += updatePeriod;
+      const auto now = std::chrono::steady_clock::now();
+      if (nextUpdate < now)
+        nextUpdate = now;
+      std::this_thread::sleep_until(nextUpdate);
+    }
+  });
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void StateMirror::Stop()
+{
+  this->dataPtr->running = false;
+  if (this->dataPtr->updateThread.joinable())
+    this->dataPtr->updateThread.join();
+
+  // Destroying the node unsubscribes from everything
+  this->dataPtr->node.reset();
+}
+
+/////////////////////////////////////////////////
+bool StateMirror::Update()
+{
+  msgs::SerializedStepMap msg;
+  bool newState{false};
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->stateMutex);
+    if (this->dataPtr->hasPendingState)
+    {
+      msg.Swap(&this->dataPtr->pendingState);
+      this->dataPtr->hasPendingState = false;
+      newState = true;
+    }
+  }
+
+  IGN_PROFILE("StateMirror::Update");
+  std::lock_guard<std::mutex> lock(this->dataPtr->ecmMutex);
+  auto &ecm = this->dataPtr->ecm;
+  auto &changes = this->dataPtr->changes;
+  if (newState)
+  {
+    for (const auto &[id, entityMsg] : msg.state().entities())
+    {
+      Entity entity{id};
+      if (entityMsg.remove() || !ecm.HasEntity(entity))
+        changes.entities.insert(entity);
+
+      for (const auto &compIt : entityMsg.components())
+        changes.components[entity].insert(compIt.first);
+    }
+
+    ecm.SetState(msg.state());
+    this->dataPtr->updateInfo = convert<UpdateInfo>(msg.stats());
+    this->dataPtr->hasState = true;
+
+    // Don't let poses from an older state override newer pose deltas
+    if (this->dataPtr->poseDeltaEnabled &&
+        this->dataPtr->poseDeltaDecoder.Time() >
+        this->dataPtr->updateInfo.simTime)
+    {
+      std::vector<Entity> entities;
+      for (const auto &pose : this->dataPtr->poseDeltaDecoder.Poses())
+        entities.push_back(pose.first);
+      this->dataPtr->ApplyPoseDeltas(entities);
+    }
+  }
+
+  const bool changed = !changes.entities.empty() ||
+      !changes.components.empty();
+  if (changed)
+  {
+    for (const auto &cb : this->dataPtr->callbacks)
+      cb.second(this->dataPtr->updateInfo, ecm, changes);
+  }
+
+  changes.entities.clear();
+  changes.components.clear();
+  if (newState)
+  {
+    ecm.ClearNewlyCreatedEntities();
+    ecm.ProcessRemoveEntityRequests();
+  }
+  ecm.ClearRemovedComponents();
+  ecm.SetAllComponentsUnchanged();
+
+  return changed;
+}
+
+/////////////////////////////////////////////////
+uint64_t StateMirror::AddChangeCallback(ChangeCallback _cb)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->ecmMutex);
+  auto id = this->dataPtr->nextCallbackId++;
+  this->dataPtr->callbacks[id] = std::move(_cb);
+  return id;
+}
+
+/////////////////////////////////////////////////
+bool StateMirror::RemoveChangeCallback(uint64_t _id)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->ecmMutex);
+  return this->dataPtr->callbacks.erase(_id) > 0;
+}
+
+/////////////////////////////////////////////////
+void StateMirror::WithState(const std::function<void(const UpdateInfo &,
+    const EntityComponentManager &)> &_fn) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->ecmMutex);
+  _fn(this->dataPtr->updateInfo, this->dataPtr->ecm);
+}
+
+/////////////////////////////////////////////////
+bool StateMirror::HasState() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->ecmMutex);
+  return this->dataPtr->hasState;
+}
+
+/////////////////////////////////////////////////
+void StateMirror::MergeState(msgs::SerializedStepMap &_pending,
+    const msgs::SerializedStepMap &_msg)
+{
+  auto pendingState = _pending.mutable_state();
+  for (const auto &entityIt : _msg.state().entities())
+  {
+    const auto &entityMsg = entityIt.second;
+    auto pendingEntities = pendingState->mutable_entities();
+    auto pendingIt = pendingEntities->find(entityIt.first);
+    if (entityMsg.remove() || pendingIt == pendingEntities->end() ||
+        pendingIt->second.remove())
+    {
+      (*pendingEntities)[entityIt.first] = entityMsg;
+      continue;
+    }
+
+    auto pendingComps = pendingIt->second.mutable_components();
+    for (const auto &compIt : entityMsg.components())
+      (*pendingComps)[compIt.first] = compIt.second;
+  }
+
+  // Keep the newest header and stats, but don't lose one-time changes from
+  // the older message
+  std::string oneTime{"0"};
+  for (const auto &data : pendingState->header().data())
+  {
+    if (data.key() == "has_one_time_component_changes" &&
+        data.value_size() > 0)
+    {
+      oneTime = data.value(0);
+    }
+  }
+  *pendingState->mutable_header() = _msg.state().header();
+  *_pending.mutable_stats() = _msg.stats();
+
+  if (oneTime == "0")
+    return;
+
+  for (auto &data : *pendingState->mutable_header()->mutable_data())
+  {
+    if (data.key() == "has_one_time_component_changes")
+    {
+      data.clear_value();
+      data.add_value(oneTime);
+      return;
+    }
+  }
+  auto data = pendingState->mutable_header()->add_data();
+  data->set_key("has_one_time_component_changes");
+  data->add_value(oneTime);
+}
+
+/////////////////////////////////////////////////
+void StateMirrorPrivate::RequestState()
+{
+  auto advertised = this->node->AdvertisedServices();
+  if (std::find(advertised.begin(), advertised.end(),
+      this->stateAsyncService) == advertised.end())
+  {
+    if (!this->node->Advertise(this->stateAsyncService,
+        &StateMirrorPrivate::OnStateAsyncService, this))
+    {
+      ignerr << "Failed to advertise [" << this->stateAsyncService << "]"
+             << std::endl;
+    }
+  }
+
+  msgs::StringMsg req;
+  req.set_data(this->stateAsyncService);
+  this->node->Request(this->stateTopic + "_async", req);
+}
+
+/////////////////////////////////////////////////
+void StateMirrorPrivate::OnStateAsyncService(
+    const msgs::SerializedStepMap &_res)
+{
+  this->OnState(_res);
+  this->node->UnadvertiseSrv(this->stateAsyncService);
+
+  // Only subscribe to periodic updates after receiving initial state
+  auto subscribed = this->node->SubscribedTopics();
+  if (std::find(subscribed.begin(), subscribed.end(), this->stateTopic) ==
+      subscribed.end())
+  {
+    this->node->Subscribe(this->stateTopic, &StateMirrorPrivate::OnState,
+        this);
+  }
+}
+
+/////////////////////////////////////////////////
+void StateMirrorPrivate::OnState(const msgs::SerializedStepMap &_msg)
+{
+  IGN_PROFILE_THREAD_NAME("StateMirror::OnState");
+  IGN_PROFILE("StateMirror::OnState");
+
+  // State is applied on update, here we only keep the message
+  std::lock_guard<std::mutex> lock(this->stateMutex);
+  if (this->hasPendingState)
+  {
+    StateMirror::MergeState(this->pendingState, _msg);
+  }
+  else
+  {
+    this->pendingState = _msg;
+    this->hasPendingState = true;
+  }
+}
+
+/////////////////////////////////////////////////
+void StateMirrorPrivate::OnPoseDelta(const msgs::Bytes &_msg)
+{
+  IGN_PROFILE("StateMirror::OnPoseDelta");
+  std::lock_guard<std::mutex> lock(this->ecmMutex);
+  std::vector<Entity> changed;
+  if (this->poseDeltaDecoder.Decode(_msg.data(), changed))
+    this->ApplyPoseDeltas(changed);
+}
+
+/////////////////////////////////////////////////
+void StateMirrorPrivate::ApplyPoseDeltas(const std::vector<Entity> &_entities)
+{
+  const auto &poses = this->poseDeltaDecoder.Poses();
+  for (auto entity : _entities)
+  {
+    auto poseComp = this->ecm.Component<components::Pose>(entity);
+    if (nullptr == poseComp)
+      continue;
+
+    poseComp->Data() = poses.at(entity);
+    this->ecm.SetChanged(entity, components::Pose::typeId,
+        ComponentState::PeriodicChange);
+    this->changes.components[entity].insert(components::Pose::typeId);
+  }
+}
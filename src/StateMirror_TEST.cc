@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/msgs/stringmsg.pb.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/StateMirror.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+TEST(StateMirrorTest, MergeState)
+{
+  EntityComponentManager ecm;
+  auto entity = ecm.CreateEntity();
+  ecm.CreateComponent(entity, components::Name("box"));
+  ecm.CreateComponent(entity,
+      components::Pose(math::Pose3d(1, 0, 0, 0, 0, 0)));
+
+  msgs::SerializedStepMap older;
+  ecm.State(*older.mutable_state(), {}, {}, true);
+  older.mutable_stats()->set_iterations(1);
+
+  // Newer message only has the pose
+  ecm.Component<components::Pose>(entity)->Data().Pos().X(2);
+  msgs::SerializedStepMap newer;
+  ecm.State(*newer.mutable_state(), {entity}, {components::Pose::typeId},
+      true);
+  newer.mutable_stats()->set_iterations(2);
+
+  StateMirror::MergeState(older, newer);
+  EXPECT_EQ(2u, older.stats().iterations());
+
+  EntityComponentManager merged;
+  merged.SetState(older.state());
+  ASSERT_TRUE(merged.HasEntity(entity));
+  EXPECT_EQ("box", merged.Component<components::Name>(entity)->Data());
+  EXPECT_DOUBLE_EQ(2.0,
+      merged.Component<components::Pose>(entity)->Data().Pos().X());
+
+  // A removal replaces everything else
+  msgs::SerializedStepMap removal;
+  auto entityMsg = &(*removal.mutable_state()->mutable_entities())[entity];
+  entityMsg->set_id(entity);
+  entityMsg->set_remove(true);
+  StateMirror::MergeState(older, removal);
+  EXPECT_TRUE(older.state().entities().at(entity).remove());
+  EXPECT_TRUE(older.state().entities().at(entity).components().empty());
+}
+
+/////////////////////////////////////////////////
+TEST(StateMirrorTest, MirrorState)
+{
+  const std::string world{"state_mirror_test"};
+
+  EntityComponentManager serverEcm;
+  auto entity = serverEcm.CreateEntity();
+  serverEcm.CreateComponent(entity, components::Name("box"));
+  serverEcm.CreateComponent(entity,
+      components::Pose(math::Pose3d(1, 0, 0, 0, 0, 0)));
+
+  // Answer the initial state request like the SceneBroadcaster does
+  transport::Node node;
+  std::function<void(const msgs::StringMsg &)> stateAsync =
+      [&](const msgs::StringMsg &_req)
+      {
+        msgs::SerializedStepMap msg;
+        serverEcm.State(*msg.mutable_state(), {}, {}, true);
+        msg.mutable_stats()->set_iterations(1);
+        node.Request(_req.data(), msg);
+      };
+  ASSERT_TRUE(node.Advertise("/world/" + world + "/state_async",
+      stateAsync));
+  auto pub = node.Advertise<msgs::SerializedStepMap>(
+      "/world/" + world + "/state");
+
+  StateMirror mirror(world);
+  mirror.SetUpdateRate(0.0);
+
+  int callbackCount{0};
+  bool sawEntity{false};
+  auto id = mirror.AddChangeCallback(
+      [&](const UpdateInfo &, const EntityComponentManager &_ecm,
+          const StateMirrorChanges &_changes)
+      {
+        ++callbackCount;
+        sawEntity = _changes.entities.count(entity) > 0 &&
+            _ecm.HasEntity(entity);
+      });
+
+  EXPECT_FALSE(mirror.HasState());
+  ASSERT_TRUE(mirror.Start());
+
+  for (int sleep = 0; sleep < 50 && !mirror.HasState(); ++sleep)
+  {
+    mirror.Update();
+    std::this_thread::sleep_for(50ms);
+  }
+  ASSERT_TRUE(mirror.HasState());
+  EXPECT_EQ(1, callbackCount);
+  EXPECT_TRUE(sawEntity);
+
+  // Nothing new, no callback
+  EXPECT_FALSE(mirror.Update());
+  EXPECT_EQ(1, callbackCount);
+
+  // Wait for the mirror to subscribe to periodic updates
+  for (int sleep = 0; sleep < 50 && !pub.HasConnections(); ++sleep)
+    std::this_thread::sleep_for(50ms);
+  ASSERT_TRUE(pub.HasConnections());
+
+  // Two periodic messages are merged into one update
+  serverEcm.Component<components::Pose>(entity)->Data().Pos().X(2);
+  msgs::SerializedStepMap msg;
+  serverEcm.State(*msg.mutable_state(), {entity},
+      {components::Pose::typeId}, true);
+  msg.mutable_stats()->set_iterations(2);
+  pub.Publish(msg);
+
+  serverEcm.Component<components::Pose>(entity)->Data().Pos().X(3);
+  msg.Clear();
+  serverEcm.State(*msg.mutable_state(), {entity},
+      {components::Pose::typeId}, true);
+  msg.mutable_stats()->set_iterations(3);
+  pub.Publish(msg);
+
+  uint64_t iterations{0};
+  for (int sleep = 0; sleep < 50 && iterations < 3; ++sleep)
+  {
+    std::this_thread::sleep_for(50ms);
+    mirror.Update();
+    mirror.WithState([&](const UpdateInfo &_info,
+        const EntityComponentManager &)
+    {
+      iterations = _info.iterations;
+    });
+  }
+  EXPECT_EQ(3u, iterations);
+
+  mirror.WithState([&](const UpdateInfo &, const EntityComponentManager &_ecm)
+  {
+    EXPECT_DOUBLE_EQ(3.0,
+        _ecm.Component<components::Pose>(entity)->Data().Pos().X());
+  });
+
+  EXPECT_TRUE(mirror.RemoveChangeCallback(id));
+  EXPECT_FALSE(mirror.RemoveChangeCallback(id));
+  mirror.Stop();
+}
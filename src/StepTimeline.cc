@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "StepTimeline.hh"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Write a string as a JSON string.
+/// \param[out] _out Stream to write to.
+/// \param[in] _str String to write.
+static void WriteJsonString(std::ostream &_out, const std::string &_str)
+{
+  _out << '"';
+  for (const char c : _str)
+  {
+    if (c == '"' || c == '\\')
+    {
+      _out << '\\' << c;
+    }
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      char escaped[7];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      _out << escaped;
+    }
+    else
+    {
+      _out << c;
+    }
+  }
+  _out << '"';
+}
+
+//////////////////////////////////////////////////
+StepTimeline::Scope::Scope(StepTimeline &_timeline, const char *_name,
+    const char *_category)
+  : name(_name), category(_category)
+{
+  if (!_timeline.Enabled())
+    return;
+
+  this->timeline = &_timeline;
+  this->start = Clock::now();
+}
+
+//////////////////////////////////////////////////
+StepTimeline::Scope::~Scope()
+{
+  if (nullptr != this->timeline)
+  {
+    this->timeline->AddEvent(this->name, this->category, this->start,
+        Clock::now());
+  }
+}
+
+//////////////////////////////////////////////////
+StepTimeline::StepTimeline(std::size_t _steps)
+  : steps(_steps)
+{
+}
+
+//////////////////////////////////////////////////
+bool StepTimeline::Enabled() const
+{
+  return !this->steps.empty();
+}
+
+//////////////////////////////////////////////////
+void StepTimeline::BeginStep(uint64_t _iteration)
+{
+  if (!this->Enabled())
+    return;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  // The step being overwritten no longer counts as finished
+  if (this->size == this->steps.size())
+    --this->size;
+
+  auto &step = this->steps[this->current];
+  step.iteration = _iteration;
+  step.thread = ThreadId();
+  step.start = Clock::now();
+  step.duration = Clock::duration::zero();
+  step.values.clear();
+  step.events.clear();
+  this->recording = true;
+}
+
+//////////////////////////////////////////////////
+void StepTimeline::AddEvent(const std::string &_name, const char *_category,
+    const Clock::time_point &_start, const Clock::time_point &_end)
+{
+  if (!this->Enabled())
+    return;
+
+  const uint32_t thread = ThreadId();
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (!this->recording)
+    return;
+
+  auto &event = this->steps[this->current].events.emplace_back();
+  event.name = _name;
+  event.category = _category;
+  event.thread = thread;
+  event.start = _start;
+  event.duration = _end - _start;
+}
+
+//////////////////////////////////////////////////
+void StepTimeline::AddValue(const char *_name, int64_t _value)
+{
+  if (!this->Enabled())
+    return;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->recording)
+    this->steps[this->current].values.emplace_back(_name, _value);
+}
+
+//////////////////////////////////////////////////
+StepTimeline::Clock::duration StepTimeline::EndStep()
+{
+  if (!this->Enabled())
+    return Clock::duration::zero();
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (!this->recording)
+    return Clock::duration::zero();
+
+  auto &step = this->steps[this->current];
+  step.duration = Clock::now() - step.start;
+
+  this->recording = false;
+  this->current = (this->current + 1) % this->steps.size();
+  ++this->size;
+  return step.duration;
+}
+
+//////////////////////////////////////////////////
+std::vector<StepTimeline::Step> StepTimeline::Steps() const
+{
+  std::vector<Step> result;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (0 == this->size)
+    return result;
+  result.reserve(this->size);
+
+  // Finished steps end right before the current one
+  const std::size_t count = this->steps.size();
+  const std::size_t oldest = (this->current + count - this->size) % count;
+  for (std::size_t i = 0; i < this->size; ++i)
+    result.push_back(this->steps[(oldest + i) % count]);
+  return result;
+}
+
+//////////////////////////////////////////////////
+void StepTimeline::Write(std::ostream &_out) const
+{
+  const auto steps = this->Steps();
+
+  // Times are in microseconds since the oldest step
+  const Clock::time_point origin =
+      steps.empty() ? Clock::time_point() : steps.front().start;
+  auto toUs = [](const Clock::duration &_duration)
+  {
+    return std::chrono::duration<double, std::micro>(_duration).count();
+  };
+
+  auto writeEvent = [&](const std::string &_name, const char *_category,
+      uint32_t _thread, const Clock::time_point &_start,
+      const Clock::duration &_duration)
+  {
+    _out << "{\"name\":";
+    WriteJsonString(_out, _name);
+    _out << ",\"cat\":\"" << _category << "\",\"ph\":\"X\",\"pid\":0"
+         << ",\"tid\":" << _thread
+         << ",\"ts\":" << toUs(_start - origin)
+         << ",\"dur\":" << toUs(_duration);
+  };
+
+  // Keep nanoseconds, even far from the origin
+  const auto flags = _out.flags();
+  const auto precision = _out.precision();
+  _out << std::fixed << std::setprecision(3);
+
+  _out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first{true};
+  for (const auto &step : steps)
+  {
+    if (!first)
+      _out << ",";
+    first = false;
+
+    writeEvent("Step", "step", step.thread, step.start, step.duration);
+    _out << ",\"args\":{\"iteration\":" << step.iteration;
+    for (const auto &[name, value] : step.values)
+      _out << ",\"" << name << "\":" << value;
+    _out << "}}";
+
+    for (const auto &event : step.events)
+    {
+      _out << ",";
+      writeEvent(event.name, event.category, event.thread, event.start,
+          event.duration);
+      _out << "}";
+    }
+  }
+  _out << "]}" << std::endl;
+
+  _out.flags(flags);
+  _out.precision(precision);
+}
+
+//////////////////////////////////////////////////
+bool StepTimeline::Save(const std::string &_path) const
+{
+  std::ofstream file(_path);
+  if (!file)
+    return false;
+
+  this->Write(file);
+  return static_cast<bool>(file);
+}
+
+//////////////////////////////////////////////////
+uint32_t StepTimeline::ThreadId()
+{
+  static std::atomic<uint32_t> next{0};
+  thread_local const uint32_t id = next++;
+  return id;
+}
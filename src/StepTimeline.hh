@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_STEPTIMELINE_HH_
+#define IGNITION_GAZEBO_STEPTIMELINE_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Records what happened during the last simulation steps in a
+    /// ring buffer, so a slow step can be looked at after the fact. The
+    /// timeline is written in the Chrome trace event format, which can be
+    /// opened with chrome://tracing or https://ui.perfetto.dev.
+    ///
+    /// Steps are begun and ended from the simulation thread, while events
+    /// may be added from any thread in between.
+    class IGNITION_GAZEBO_VISIBLE StepTimeline
+    {
+      /// \brief Clock used for all times.
+      public: using Clock = std::chrono::steady_clock;
+
+      /// \brief Something which took time during a step.
+      public: struct Event
+      {
+        /// \brief Name, such as a phase or a system.
+        std::string name;
+
+        /// \brief Category, a string literal.
+        const char *category{""};
+
+        /// \brief Identifier of the thread it ran on.
+        uint32_t thread{0};
+
+        /// \brief When it started.
+        Clock::time_point start;
+
+        /// \brief How long it took.
+        Clock::duration duration{0};
+      };
+
+      /// \brief Everything recorded for one step.
+      public: struct Step
+      {
+        /// \brief Simulation iteration.
+        uint64_t iteration{0};
+
+        /// \brief Identifier of the simulation thread.
+        uint32_t thread{0};
+
+        /// \brief When the step started.
+        Clock::time_point start;
+
+        /// \brief How long the step took.
+        Clock::duration duration{0};
+
+        /// \brief Named values, such as the number of entities created.
+        std::vector<std::pair<const char *, int64_t>> values;
+
+        /// \brief Events, in the order they ended.
+        std::vector<Event> events;
+      };
+
+      /// \brief Measures the time until it goes out of scope and adds it to
+      /// the timeline as an event.
+      public: class Scope
+      {
+        /// \brief Constructor
+        /// \param[in] _timeline Timeline to add the event to.
+        /// \param[in] _name Name of the event, a string literal.
+        /// \param[in] _category Category of the event, a string literal.
+        public: Scope(StepTimeline &_timeline, const char *_name,
+                      const char *_category = "phase");
+
+        /// \brief Destructor, adds the event.
+        public: ~Scope();
+
+        /// \brief Timeline to add the event to, null when it's disabled.
+        private: StepTimeline *timeline{nullptr};
+
+        /// \brief Name of the event.
+        private: const char *name;
+
+        /// \brief Category of the event.
+        private: const char *category;
+
+        /// \brief When the scope started.
+        private: Clock::time_point start;
+      };
+
+      /// \brief Constructor
+      /// \param[in] _steps Number of steps to keep, 0 to disable recording.
+      public: explicit StepTimeline(std::size_t _steps = 0);
+
+      /// \brief Whether steps are recorded.
+      /// \return True if the timeline keeps at least one step.
+      public: bool Enabled() const;
+
+      /// \brief Start recording a step, overwriting the oldest one when the
+      /// buffer is full.
+      /// \param[in] _iteration Simulation iteration.
+      public: void BeginStep(uint64_t _iteration);
+
+      /// \brief Add an event to the current step. It's safe to call from
+      /// several threads at once.
+      /// \param[in] _name Name of the event.
+      /// \param[in] _category Category of the event, a string literal.
+      /// \param[in] _start When it started.
+      /// \param[in] _end When it ended.
+      public: void AddEvent(const std::string &_name, const char *_category,
+                  const Clock::time_point &_start,
+                  const Clock::time_point &_end);
+
+      /// \brief Add a named value to the current step.
+      /// \param[in] _name Name of the value, a string literal.
+      /// \param[in] _value The value.
+      public: void AddValue(const char *_name, int64_t _value);
+
+      /// \brief Finish the current step.
+      /// \return How long the step took, zero when disabled.
+      public: Clock::duration EndStep();
+
+      /// \brief Get the recorded steps, oldest first.
+      /// \return Copy of the finished steps.
+      public: std::vector<Step> Steps() const;
+
+      /// \brief Write the recorded steps in the Chrome trace event format.
+      /// \param[out] _out Stream to write to.
+      public: void Write(std::ostream &_out) const;
+
+      /// \brief Write the recorded steps to a file, see Write.
+      /// \param[in] _path Path of the file.
+      /// \return False if the file couldn't be written.
+      public: bool Save(const std::string &_path) const;
+
+      /// \brief Get a small identifier for the calling thread.
+      /// \return Identifier, unique among the threads of the process.
+      public: static uint32_t ThreadId();
+
+      /// \brief Steps, used as a ring buffer.
+      private: std::vector<Step> steps;
+
+      /// \brief Index of the step being recorded, or of the next one.
+      private: std::size_t current{0};
+
+      /// \brief Number of finished steps in the buffer.
+      private: std::size_t size{0};
+
+      /// \brief Whether a step is being recorded.
+      private: bool recording{false};
+
+      /// \brief Protects the steps.
+      private: mutable std::mutex mutex;
+    };
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_STEPTIMELINE_HH_
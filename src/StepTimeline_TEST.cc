@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "StepTimeline.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(StepTimelineTest, Disabled)
+{
+  StepTimeline timeline;
+  EXPECT_FALSE(timeline.Enabled());
+
+  timeline.BeginStep(1);
+  {
+    StepTimeline::Scope scope(timeline, "Phase");
+  }
+  EXPECT_EQ(StepTimeline::Clock::duration::zero(), timeline.EndStep());
+  EXPECT_TRUE(timeline.Steps().empty());
+}
+
+/////////////////////////////////////////////////
+TEST(StepTimelineTest, RingBuffer)
+{
+  StepTimeline timeline(3);
+  EXPECT_TRUE(timeline.Enabled());
+
+  for (uint64_t i = 1; i <= 5; ++i)
+  {
+    timeline.BeginStep(i);
+    {
+      StepTimeline::Scope scope(timeline, "Phase");
+    }
+    timeline.AddValue("entities", static_cast<int64_t>(i));
+    timeline.EndStep();
+  }
+
+  // Only the last steps are kept, oldest first
+  auto steps = timeline.Steps();
+  ASSERT_EQ(3u, steps.size());
+  for (std::size_t i = 0; i < steps.size(); ++i)
+  {
+    EXPECT_EQ(i + 3, steps[i].iteration);
+    ASSERT_EQ(1u, steps[i].events.size());
+    EXPECT_EQ("Phase", steps[i].events[0].name);
+    EXPECT_STREQ("phase", steps[i].events[0].category);
+    EXPECT_GE(steps[i].events[0].start, steps[i].start);
+    EXPECT_LE(steps[i].events[0].duration, steps[i].duration);
+    ASSERT_EQ(1u, steps[i].values.size());
+    EXPECT_EQ(static_cast<int64_t>(i + 3), steps[i].values[0].second);
+  }
+
+  // The step being recorded isn't returned, and replaces the oldest one
+  timeline.BeginStep(6);
+  steps = timeline.Steps();
+  ASSERT_EQ(2u, steps.size());
+  EXPECT_EQ(4u, steps[0].iteration);
+  EXPECT_EQ(5u, steps[1].iteration);
+
+  // Events outside of a step are dropped
+  timeline.EndStep();
+  timeline.AddEvent("Late", "phase", StepTimeline::Clock::now(),
+      StepTimeline::Clock::now());
+  steps = timeline.Steps();
+  ASSERT_EQ(3u, steps.size());
+  EXPECT_EQ(6u, steps.back().iteration);
+  EXPECT_TRUE(steps.back().events.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(StepTimelineTest, Threads)
+{
+  StepTimeline timeline(1);
+  timeline.BeginStep(1);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&timeline]
+    {
+      for (int j = 0; j < 100; ++j)
+      {
+        auto now = StepTimeline::Clock::now();
+        timeline.AddEvent("system", "update", now, now);
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  timeline.EndStep();
+
+  auto steps = timeline.Steps();
+  ASSERT_EQ(1u, steps.size());
+  EXPECT_EQ(400u, steps[0].events.size());
+  EXPECT_NE(steps[0].thread, steps[0].events[0].thread);
+}
+
+/////////////////////////////////////////////////
+TEST(StepTimelineTest, ChromeTrace)
+{
+  StepTimeline timeline(2);
+  timeline.BeginStep(7);
+  auto start = StepTimeline::Clock::now();
+  timeline.AddEvent("my \"system\"", "update", start,
+      start + std::chrono::microseconds(250));
+  timeline.AddValue("entities_created", 2);
+  timeline.EndStep();
+
+  std::ostringstream out;
+  timeline.Write(out);
+  auto json = out.str();
+
+  EXPECT_EQ(0u, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, json.find(
+      "\"name\":\"Step\",\"cat\":\"step\",\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos,
+      json.find("\"args\":{\"iteration\":7,\"entities_created\":2}"));
+  EXPECT_NE(std::string::npos, json.find(
+      "\"name\":\"my \\\"system\\\"\",\"cat\":\"update\",\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos, json.find("\"dur\":250.000"));
+  EXPECT_EQ("]}\n", json.substr(json.size() - 3));
+}
@@ -15,8 +15,11 @@
  *
 */
 
+#include <mutex>
 #include <optional>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <ignition/gazebo/SystemLoader.hh>
@@ -46,18 +49,9 @@ class ignition::gazebo::SystemLoaderPrivate
               const sdf::ElementPtr &/*_sdf*/,
               ignition::plugin::PluginPtr &_plugin)
   {
-    ignition::common::SystemPaths systemPaths;
-    systemPaths.SetPluginPathEnv(pluginPathEnv);
-
-    for (const auto &path : this->systemPluginPaths)
-      systemPaths.AddPluginPaths(path);
-
-    std::string homePath;
-    ignition::common::env(IGN_HOMEDIR, homePath);
-    systemPaths.AddPluginPaths(homePath + "/.ignition/gazebo/plugins");
-    systemPaths.AddPluginPaths(IGN_GAZEBO_PLUGIN_INSTALL_DIR);
+    std::lock_guard<std::mutex> lock(this->mutex);
 
-    auto pathToLib = systemPaths.FindSharedLibrary(_filename);
+    const auto pathToLib = this->FindLibrary(_filename);
     if (pathToLib.empty())
     {
       // We assume ignition::gazebo corresponds to the levels feature
@@ -69,23 +63,8 @@ class ignition::gazebo::SystemLoaderPrivate
       return false;
     }
 
-    auto pluginNames = this->loader.LoadLib(pathToLib);
-    if (pluginNames.empty())
-    {
-      ignerr << "Failed to load system plugin [" << _filename <<
-                "] : couldn't load library on path [" << pathToLib <<
-                "]." << std::endl;
-      return false;
-    }
-
-    auto pluginName = *pluginNames.begin();
-    if (pluginName.empty())
-    {
-      ignerr << "Failed to load system plugin [" << _filename <<
-                "] : couldn't load library on path [" << pathToLib <<
-                "]." << std::endl;
+    if (!this->LoadLibraryOnce(_filename, pathToLib))
       return false;
-    }
 
     _plugin = this->loader.Instantiate(_name);
     if (!_plugin)
@@ -109,6 +88,62 @@ class ignition::gazebo::SystemLoaderPrivate
     return true;
   }
 
+  /// \brief Load a library, unless it was loaded already. Each library is
+  /// loaded once, later plugins are instantiated from the factories it
+  /// already registered. The mutex must be locked.
+  /// \param[in] _filename Name of the library, for messages.
+  /// \param[in] _pathToLib Full path to the library.
+  /// \return True if the library is loaded.
+  public: bool LoadLibraryOnce(const std::string &_filename,
+              const std::string &_pathToLib)
+  {
+    if (this->loadedLibraries.find(_pathToLib) !=
+        this->loadedLibraries.end())
+    {
+      return true;
+    }
+
+    auto pluginNames = this->loader.LoadLib(_pathToLib);
+    if (pluginNames.empty() || pluginNames.begin()->empty())
+    {
+      ignerr << "Failed to load system plugin [" << _filename <<
+                "] : couldn't load library on path [" << _pathToLib <<
+                "]." << std::endl;
+      return false;
+    }
+    this->loadedLibraries.insert(_pathToLib);
+    return true;
+  }
+
+  /// \brief Find a library in the plugin paths. Libraries which were found
+  /// are cached until the paths change. Failures aren't, because the
+  /// library may be found later through the environment.
+  /// \param[in] _filename Name of the library, as in the plugin's
+  /// filename attribute.
+  /// \return Full path to the library, or empty if it wasn't found.
+  public: std::string FindLibrary(const std::string &_filename)
+  {
+    auto cached = this->libraryPaths.find(_filename);
+    if (cached != this->libraryPaths.end())
+      return cached->second;
+
+    ignition::common::SystemPaths systemPaths;
+    systemPaths.SetPluginPathEnv(pluginPathEnv);
+
+    for (const auto &path : this->systemPluginPaths)
+      systemPaths.AddPluginPaths(path);
+
+    std::string homePath;
+    ignition::common::env(IGN_HOMEDIR, homePath);
+    systemPaths.AddPluginPaths(homePath + "/.ignition/gazebo/plugins");
+    systemPaths.AddPluginPaths(IGN_GAZEBO_PLUGIN_INSTALL_DIR);
+
+    auto pathToLib = systemPaths.FindSharedLibrary(_filename);
+    if (!pathToLib.empty())
+      this->libraryPaths[_filename] = pathToLib;
+    return pathToLib;
+  }
+
   // Default plugin search path environment variable
   public: std::string pluginPathEnv{"IGN_GAZEBO_SYSTEM_PLUGIN_PATH"};
 
@@ -120,6 +155,16 @@ class ignition::gazebo::SystemLoaderPrivate
 
   /// \brief System plugins that have instances loaded via the manager.
   public: std::unordered_set<SystemPluginPtr> systemPluginsAdded;
+
+  /// \brief Full path of each library filename which was found.
+  public: std::unordered_map<std::string, std::string> libraryPaths;
+
+  /// \brief Full paths of the libraries loaded by the loader.
+  public: std::unordered_set<std::string> loadedLibraries;
+
+  /// \brief Protects all members, plugins may be loaded from several
+  /// worlds at once.
+  public: std::mutex mutex;
 };
 
 //////////////////////////////////////////////////
@@ -134,7 +179,68 @@ SystemLoader::~SystemLoader() = default;
 //////////////////////////////////////////////////
 void SystemLoader::AddSystemPluginPath(const std::string &_path)
 {
-  this->dataPtr->systemPluginPaths.insert(_path);
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (this->dataPtr->systemPluginPaths.insert(_path).second)
+  {
+    // The new path may take precedence over the cached ones
+    this->dataPtr->libraryPaths.clear();
+  }
+}
+
+//////////////////////////////////////////////////
+bool SystemLoader::PreloadLibrary(const std::string &_filename)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  const auto pathToLib = this->dataPtr->FindLibrary(_filename);
+  if (pathToLib.empty())
+  {
+    ignwarn << "Failed to preload system plugin library [" << _filename
+            << "] : couldn't find shared library." << std::endl;
+    return false;
+  }
+
+  return this->dataPtr->LoadLibraryOnce(_filename, pathToLib);
+}
+
+//////////////////////////////////////////////////
+/// \brief Collect the library names of the plugins within an element.
+/// \param[in] _elem Element.
+/// \param[out] _filenames Library names.
+static void collectPluginFilenames(const sdf::ElementPtr &_elem,
+    std::set<std::string> &_filenames)
+{
+  if (_elem->GetName() == "plugin")
+  {
+    auto filename = _elem->Get<std::string>("filename");
+    if (!filename.empty())
+      _filenames.insert(filename);
+    return;
+  }
+
+  for (auto child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    collectPluginFilenames(child, _filenames);
+  }
+}
+
+//////////////////////////////////////////////////
+std::size_t SystemLoader::PreloadLibraries(const sdf::ElementPtr &_sdf)
+{
+  if (nullptr == _sdf)
+    return 0;
+
+  std::set<std::string> filenames;
+  collectPluginFilenames(_sdf, filenames);
+
+  std::size_t count{0};
+  for (const auto &filename : filenames)
+  {
+    if (this->PreloadLibrary(filename))
+      ++count;
+  }
+  return count;
 }
 
 //////////////////////////////////////////////////
@@ -180,6 +286,7 @@ std::optional<SystemPluginPtr> SystemLoader::LoadPlugin(
 //////////////////////////////////////////////////
 std::string SystemLoader::PrettyStr() const
 {
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
   return this->dataPtr->loader.PrettyStr();
 }
 
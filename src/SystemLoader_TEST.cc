@@ -65,3 +65,28 @@ TEST(SystemLoader, EmptyNames)
   auto system = sm.LoadPlugin("", "", element);
   ASSERT_FALSE(system.has_value());
 }
+
+/////////////////////////////////////////////////
+TEST(SystemLoader, SharedLibrary)
+{
+  gazebo::SystemLoader sm;
+  sm.AddSystemPluginPath(ignition::common::joinPaths(
+      std::string(PROJECT_BINARY_PATH), "lib"));
+
+  // The library is searched for and loaded once, and each call still gets
+  // its own instance
+  const std::string filename = std::string("libignition-gazebo") +
+      IGNITION_GAZEBO_MAJOR_VERSION_STR + "-physics-system.so";
+  sdf::ElementPtr element;
+  auto first = sm.LoadPlugin(filename, "ignition::gazebo::systems::Physics",
+      element);
+  auto second = sm.LoadPlugin(filename, "ignition::gazebo::systems::Physics",
+      element);
+  ASSERT_TRUE(first.has_value());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_NE(*first, *second);
+
+  // Unknown names in a loaded library still fail
+  EXPECT_FALSE(sm.LoadPlugin(filename, "ignition::gazebo::systems::Unknown",
+      element).has_value());
+}
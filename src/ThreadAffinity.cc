@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/StringUtils.hh>
+#include <ignition/common/WorkerPool.hh>
+
+#include "ignition/gazebo/ThreadAffinity.hh"
+
+using namespace ignition;
+
+/// \brief How long pool threads wait for each other while their affinity
+/// is set.
+static constexpr std::chrono::seconds kPoolWait{1};
+
+//////////////////////////////////////////////////
+bool gazebo::ParseCpuList(const std::string &_list,
+    std::vector<unsigned int> &_cpus)
+{
+  _cpus.clear();
+
+  // Parse an index, rejecting signs and trailing characters
+  auto parseIndex = [](const std::string &_str, unsigned int &_index)
+  {
+    if (_str.empty() || _str.find_first_not_of("0123456789") !=
+        std::string::npos || _str.size() > 6)
+    {
+      return false;
+    }
+    _index = static_cast<unsigned int>(std::stoul(_str));
+    return true;
+  };
+
+  for (auto item : common::split(_list, ","))
+  {
+    common::trim(item);
+    const auto dash = item.find('-');
+    unsigned int first{0};
+    unsigned int last{0};
+    if (dash == std::string::npos)
+    {
+      if (!parseIndex(item, first))
+        return false;
+      last = first;
+    }
+    else if (!parseIndex(item.substr(0, dash), first) ||
+        !parseIndex(item.substr(dash + 1), last) || last < first)
+    {
+      return false;
+    }
+
+    for (unsigned int cpu = first; cpu <= last; ++cpu)
+      _cpus.push_back(cpu);
+  }
+
+  std::sort(_cpus.begin(), _cpus.end());
+  _cpus.erase(std::unique(_cpus.begin(), _cpus.end()), _cpus.end());
+  return !_cpus.empty();
+}
+
+//////////////////////////////////////////////////
+bool gazebo::SetThreadCpus(const std::vector<unsigned int> &_cpus)
+{
+  if (_cpus.empty())
+    return true;
+
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const unsigned int cpu : _cpus)
+  {
+    if (cpu >= CPU_SETSIZE)
+    {
+      ignerr << "CPU [" << cpu << "] is out of range." << std::endl;
+      return false;
+    }
+    CPU_SET(cpu, &set);
+  }
+
+  const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (error != 0)
+  {
+    ignerr << "Failed to set thread affinity: " << std::strerror(error)
+           << std::endl;
+    return false;
+  }
+  return true;
+#else
+  ignwarn << "Thread affinity is only supported on Linux." << std::endl;
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool gazebo::SetThreadRealtimePriority(int _priority)
+{
+  if (_priority == 0)
+    return true;
+
+#ifdef __linux__
+  if (_priority < sched_get_priority_min(SCHED_FIFO) ||
+      _priority > sched_get_priority_max(SCHED_FIFO))
+  {
+    ignerr << "Real-time priority [" << _priority << "] is out of range."
+           << std::endl;
+    return false;
+  }
+
+  sched_param param;
+  param.sched_priority = _priority;
+  const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+  if (error != 0)
+  {
+    ignerr << "Failed to set real-time priority [" << _priority << "]: "
+           << std::strerror(error) << std::endl;
+    return false;
+  }
+  return true;
+#else
+  ignwarn << "Real-time priority is only supported on Linux." << std::endl;
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool gazebo::SetWorkerPoolCpus(common::WorkerPool &_pool,
+    unsigned int _minThreads, const std::vector<unsigned int> &_cpus)
+{
+  if (_cpus.empty())
+    return true;
+
+  // The pool creates at least one thread per hardware core
+  const unsigned int threads = std::max({std::thread::hardware_concurrency(),
+      _minThreads, 1u});
+
+  struct Shared
+  {
+    std::mutex mutex;
+    std::condition_variable cv;
+    unsigned int started{0};
+    bool result{true};
+  };
+  auto shared = std::make_shared<Shared>();
+
+  for (unsigned int i = 0; i < threads; ++i)
+  {
+    _pool.AddWork([shared, threads, _cpus]()
+    {
+      const bool set = SetThreadCpus(_cpus);
+
+      // Keep this thread busy until every thread got a task. Don't wait
+      // forever in case the pool has fewer threads than expected.
+      std::unique_lock<std::mutex> lock(shared->mutex);
+      shared->result &= set;
+      ++shared->started;
+      shared->cv.notify_all();
+      shared->cv.wait_for(lock, kPoolWait,
+          [&]{return shared->started >= threads;});
+    });
+  }
+  _pool.WaitForResults();
+
+  std::lock_guard<std::mutex> lock(shared->mutex);
+  return shared->result;
+}
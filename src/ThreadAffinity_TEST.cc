@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include <vector>
+
+#include <ignition/common/WorkerPool.hh>
+
+#include "ignition/gazebo/ThreadAffinity.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(ThreadAffinity, ParseCpuList)
+{
+  std::vector<unsigned int> cpus;
+  EXPECT_TRUE(ParseCpuList("3", cpus));
+  EXPECT_EQ(std::vector<unsigned int>({3u}), cpus);
+
+  EXPECT_TRUE(ParseCpuList("8, 0-2,1", cpus));
+  EXPECT_EQ(std::vector<unsigned int>({0u, 1u, 2u, 8u}), cpus);
+
+  EXPECT_FALSE(ParseCpuList("", cpus));
+  EXPECT_FALSE(ParseCpuList("a", cpus));
+  EXPECT_FALSE(ParseCpuList("-1", cpus));
+  EXPECT_FALSE(ParseCpuList("3-1", cpus));
+  EXPECT_FALSE(ParseCpuList("1,,2", cpus));
+}
+
+/////////////////////////////////////////////////
+TEST(ThreadAffinity, Threads)
+{
+  // Nothing to do
+  EXPECT_TRUE(SetThreadCpus({}));
+  EXPECT_TRUE(SetThreadRealtimePriority(0));
+
+#ifdef __linux__
+  // Keep the thread on a CPU it's already allowed on
+  cpu_set_t set;
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(set), &set));
+  unsigned int allowed{0};
+  while (!CPU_ISSET(allowed, &set))
+    ++allowed;
+
+  EXPECT_TRUE(SetThreadCpus({allowed}));
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(set), &set));
+  EXPECT_EQ(1, CPU_COUNT(&set));
+  EXPECT_TRUE(CPU_ISSET(allowed, &set));
+
+  EXPECT_FALSE(SetThreadCpus({CPU_SETSIZE + 1u}));
+  EXPECT_FALSE(SetThreadRealtimePriority(1000));
+
+  common::WorkerPool pool(2);
+  EXPECT_TRUE(SetWorkerPoolCpus(pool, 2, {allowed}));
+#endif
+}
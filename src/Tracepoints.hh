@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_TRACEPOINTS_HH_
+#define IGNITION_GAZEBO_TRACEPOINTS_HH_
+
+// USDT tracepoints of the `ign_gazebo` provider, for perf, bpftrace and
+// SystemTap on live servers. A tracepoint which isn't being traced is a
+// single nop instruction. They're compiled in when sys/sdt.h is found and
+// the ENABLE_TRACEPOINTS CMake option is on, which is the default.
+//
+// Tracepoints and their arguments:
+//   component_created     entity, component type
+//   component_removed     entity, component type
+//   view_rebuild          number of views
+//   state_serialized      bytes of component data
+//   system_pre_update     system index, duration in nanoseconds
+//   system_update         system index, duration in nanoseconds
+//   system_post_update    system index, duration in nanoseconds
+//
+// For example, to count component creations by type:
+//   bpftrace -p <pid> -e 'usdt:<path to libignition-gazebo>:ign_gazebo:\
+//       component_created { @[arg1] = count(); }' 
+
+#if IGN_GAZEBO_TRACEPOINTS
+#include <sys/sdt.h>
+
+#define IGN_GAZEBO_TRACEPOINT1(_name, _a) \
+  DTRACE_PROBE1(ign_gazebo, _name, _a)
+#define IGN_GAZEBO_TRACEPOINT2(_name, _a, _b) \
+  DTRACE_PROBE2(ign_gazebo, _name, _a, _b)
+#else
+#define IGN_GAZEBO_TRACEPOINT1(_name, _a) \
+  do { static_cast<void>(_a); } while (false)
+#define IGN_GAZEBO_TRACEPOINT2(_name, _a, _b) \
+  do { static_cast<void>(_a); static_cast<void>(_b); } while (false)
+#endif
+
+#endif
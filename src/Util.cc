@@ -30,6 +30,12 @@
   #endif
 #endif
 
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include <ignition/common/Filesystem.hh>
 #include <ignition/common/StringUtils.hh>
 #include <ignition/common/Util.hh>
@@ -57,24 +63,47 @@ namespace gazebo
 // Inline bracket to help doxygen filtering.
 inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 //////////////////////////////////////////////////
-math::Pose3d worldPose(const Entity &_entity,
+/// \brief Whether the ancestors of an entity can be taken from the entity
+/// graph. Entity component managers that are only populated through
+/// SetState, such as the GUI's, keep the hierarchy in ParentEntity
+/// components but not in the graph.
+/// \param[in] _entity Entity.
+/// \param[in] _ecm Entity component manager.
+/// \return True if the graph holds the entity's parent, or if neither the
+/// graph nor the components know of a parent.
+static bool graphHasParent(const Entity _entity,
     const EntityComponentManager &_ecm)
 {
-  // work out pose in world frame
-  math::Pose3d pose = _ecm.Component<components::Pose>(_entity)->Data();
-  auto p = _ecm.Component<components::ParentEntity>(_entity);
-  while (p)
-  {
-    // get pose of parent entity
-    auto parentPose = _ecm.Component<components::Pose>(p->Data());
-    if (!parentPose)
-      break;
-    // transform pose
-    pose = pose + parentPose->Data();
-    // keep going up the tree
-    p = _ecm.Component<components::ParentEntity>(p->Data());
+  return _ecm.ParentEntity(_entity) != kNullEntity ||
+      nullptr == _ecm.Component<components::ParentEntity>(_entity);
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the ancestors of an entity, starting with its parent.
+/// \param[in] _entity Entity.
+/// \param[in] _ecm Entity component manager.
+/// \return Ancestors ordered from the parent up to the root.
+static std::vector<Entity> ancestors(const Entity _entity,
+    const EntityComponentManager &_ecm)
+{
+  if (graphHasParent(_entity, _ecm))
+    return _ecm.Ancestors(_entity);
+
+  std::vector<Entity> result;
+  auto parentComp = _ecm.Component<components::ParentEntity>(_entity);
+  while (parentComp && parentComp->Data() != _entity)
+  {
+    result.push_back(parentComp->Data());
+    parentComp = _ecm.Component<components::ParentEntity>(parentComp->Data());
   }
-  return pose;
+  return result;
+}
+
+//////////////////////////////////////////////////
+math::Pose3d worldPose(const Entity &_entity,
+    const EntityComponentManager &_ecm)
+{
+  return _ecm.WorldPose(_entity);
 }
 
 //////////////////////////////////////////////////
@@ -84,10 +113,13 @@ std::string scopedName(const Entity &_entity,
 {
   std::string result;
 
-  auto entity = _entity;
+  std::vector<Entity> chain = ancestors(_entity, _ecm);
+  chain.insert(chain.begin(), _entity);
 
-  while (true)
+  for (auto entityIt = chain.begin(); entityIt != chain.end(); ++entityIt)
   {
+    const Entity entity = *entityIt;
+
     // Get entity name
     auto nameComp = _ecm.Component<components::Name>(entity);
     if (nullptr == nameComp)
@@ -103,7 +135,6 @@ std::string scopedName(const Entity &_entity,
               << std::endl;
     }
 
-    auto parentComp = _ecm.Component<components::ParentEntity>(entity);
     if (!prefix.empty())
     {
       result.insert(0, name);
@@ -114,13 +145,11 @@ std::string scopedName(const Entity &_entity,
       }
     }
 
-    if (nullptr == parentComp)
+    if (std::next(entityIt) == chain.end())
       break;
 
     if (!prefix.empty())
       result.insert(0, _delim);
-
-    entity = parentComp->Data();
   }
 
   return result;
@@ -222,19 +251,15 @@ std::string entityTypeStr(const Entity &_entity,
 Entity worldEntity(const Entity &_entity,
     const EntityComponentManager &_ecm)
 {
-  auto entity = _entity;
-  while (nullptr == _ecm.Component<components::World>(entity))
+  if (nullptr != _ecm.Component<components::World>(_entity))
+    return _entity;
+
+  for (const Entity ancestor : ancestors(_entity, _ecm))
   {
-    // Keep going up the tree
-    auto parentComp = _ecm.Component<components::ParentEntity>(entity);
-    if (!parentComp)
-    {
-      entity = kNullEntity;
-      break;
-    }
-    entity = parentComp->Data();
+    if (nullptr != _ecm.Component<components::World>(ancestor))
+      return ancestor;
   }
-  return entity;
+  return kNullEntity;
 }
 
 //////////////////////////////////////////////////
@@ -315,6 +340,28 @@ std::string asFullPath(const std::string &_uri, const std::string &_filePath)
   return common::joinPaths(path,  uri);
 }
 
+/// \brief Files remembered by findResource.
+struct ResourceCache
+{
+  /// \brief Protects the members.
+  std::mutex mutex;
+
+  /// \brief Resource path variables the files were found with.
+  std::string paths;
+
+  /// \brief Full paths by URI, empty for files which weren't found.
+  std::unordered_map<std::string, std::string> files;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the cache of findResource.
+/// \return The process-wide cache.
+static ResourceCache &resourceCache()
+{
+  static ResourceCache cache;
+  return cache;
+}
+
 //////////////////////////////////////////////////
 std::vector<std::string> resourcePaths()
 {
@@ -334,6 +381,43 @@ std::vector<std::string> resourcePaths()
   return gzPaths;
 }
 
+//////////////////////////////////////////////////
+std::string findResource(const std::string &_uri)
+{
+  // Paths can also be changed by setting the variables directly
+  std::string paths;
+  for (const auto &env : {kResourcePathEnv,
+      common::systemPaths()->FilePathEnv()})
+  {
+    const char *value = std::getenv(env.c_str());
+    paths += (value ? value : "") + std::string("\n");
+  }
+
+  auto &cache = resourceCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.paths != paths)
+    {
+      cache.files.clear();
+      cache.paths = paths;
+    }
+    else
+    {
+      auto iter = cache.files.find(_uri);
+      if (iter != cache.files.end())
+        return iter->second;
+    }
+  }
+
+  // Not locked, since finding the file may download it
+  auto path = common::findFile(_uri);
+
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (cache.paths == paths)
+    cache.files[_uri] = path;
+  return path;
+}
+
 //////////////////////////////////////////////////
 void addResourcePaths(const std::vector<std::string> &_paths)
 {
@@ -408,28 +492,30 @@ void addResourcePaths(const std::vector<std::string> &_paths)
   // Force re-evaluation
   // SDF is evaluated at find call
   systemPaths->SetFilePathEnv(systemPaths->FilePathEnv());
+
+  // Files may be found in the new paths
+  auto &cache = resourceCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.files.clear();
 }
 
 //////////////////////////////////////////////////
 ignition::gazebo::Entity topLevelModel(const Entity &_entity,
     const EntityComponentManager &_ecm)
 {
-  auto entity = _entity;
+  if (graphHasParent(_entity, _ecm))
+    return _ecm.TopLevelModel(_entity);
 
   // search up the entity tree and find the model with no parent models
   // (there is the possibility of nested models)
   Entity modelEntity = kNullEntity;
-  while (entity)
-  {
-    if (_ecm.Component<components::Model>(entity))
-      modelEntity = entity;
+  if (_ecm.Component<components::Model>(_entity))
+    modelEntity = _entity;
 
-    // stop searching if we are at the root of the tree
-    auto parentComp = _ecm.Component<components::ParentEntity>(entity);
-    if (!parentComp)
-      break;
-
-    entity = parentComp->Data();
+  for (const Entity ancestor : ancestors(_entity, _ecm))
+  {
+    if (_ecm.Component<components::Model>(ancestor))
+      modelEntity = ancestor;
   }
 
   return modelEntity;
@@ -16,7 +16,12 @@
 */
 
 #include <gtest/gtest.h>
+
+#include <fstream>
+
 #include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Util.hh>
 #include <sdf/Actor.hh>
 #include <sdf/Light.hh>
 
@@ -33,6 +38,7 @@
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/Util.hh"
+#include "ignition/gazebo/test_config.hh"
 
 using namespace ignition;
 using namespace gazebo;
@@ -485,6 +491,22 @@ TEST_F(UtilTest, TopLevelModel)
 
   // the world should have no top level model
   EXPECT_EQ(kNullEntity, topLevelModel(worldEntity, ecm));
+
+  // the answers are the same when the entity graph holds the hierarchy too
+  ecm.SetParentEntity(modelAEntity, worldEntity);
+  ecm.SetParentEntity(linkAEntity, modelAEntity);
+  ecm.SetParentEntity(modelBEntity, modelAEntity);
+  ecm.SetParentEntity(linkBEntity, modelBEntity);
+  ecm.SetParentEntity(visualBEntity, linkBEntity);
+  ecm.SetParentEntity(modelCEntity, worldEntity);
+
+  EXPECT_EQ(modelAEntity, topLevelModel(visualBEntity, ecm));
+  EXPECT_EQ(modelAEntity, topLevelModel(modelBEntity, ecm));
+  EXPECT_EQ(modelCEntity, topLevelModel(modelCEntity, ecm));
+  EXPECT_EQ(kNullEntity, topLevelModel(worldEntity, ecm));
+  EXPECT_EQ(worldEntity, gazebo::worldEntity(visualBEntity, ecm));
+  EXPECT_EQ("world_name/modelA_name/modelB_name/linkB_name/visualB_name",
+      scopedName(visualBEntity, ecm, "/", false));
 }
 
 /////////////////////////////////////////////////
@@ -510,3 +532,30 @@ TEST_F(UtilTest, ValidTopic)
   EXPECT_EQ("not_bad", validTopic({fixable, invalid, good}));
   EXPECT_EQ("good", validTopic({invalid, good, fixable}));
 }
+
+/////////////////////////////////////////////////
+TEST_F(UtilTest, FindResource)
+{
+  auto dir = common::joinPaths(std::string(PROJECT_BINARY_PATH),
+      "test_find_resource");
+  common::removeAll(dir);
+  ASSERT_TRUE(common::createDirectories(dir));
+  const auto file = common::joinPaths(dir, "find_resource.txt");
+
+  EXPECT_TRUE(findResource("find_resource.txt").empty());
+
+  // Misses are remembered too
+  std::ofstream(file) << "resource";
+  EXPECT_TRUE(findResource("find_resource.txt").empty());
+
+  // Adding paths clears the cache
+  addResourcePaths({dir});
+  EXPECT_EQ(file, findResource("find_resource.txt"));
+
+  common::removeFile(file);
+  EXPECT_EQ(file, findResource("find_resource.txt"));
+
+  // So does changing the variables directly
+  common::setenv(kResourcePathEnv, "");
+  EXPECT_TRUE(findResource("find_resource.txt").empty());
+}
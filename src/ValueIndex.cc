@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ValueIndex.hh"
+
+#include <algorithm>
+#include <utility>
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Returned for values which no entity has.
+static const std::vector<Entity> kNoEntities;
+
+//////////////////////////////////////////////////
+void ValueIndex::Enable(const ComponentTypeId _type, Hasher _hasher)
+{
+  this->indexes[_type].hasher = std::move(_hasher);
+}
+
+//////////////////////////////////////////////////
+bool ValueIndex::Enabled(const ComponentTypeId _type) const
+{
+  return this->indexes.find(_type) != this->indexes.end();
+}
+
+//////////////////////////////////////////////////
+void ValueIndex::Set(const Entity _entity, const ComponentTypeId _type,
+    const components::BaseComponent &_component)
+{
+  auto iter = this->indexes.find(_type);
+  if (iter == this->indexes.end())
+    return;
+  auto &index = iter->second;
+
+  const std::size_t hash = index.hasher(_component);
+
+  auto [hashIter, inserted] = index.hashes.emplace(_entity, hash);
+  if (!inserted)
+  {
+    // Unchanged, which is the common case when components are marked as
+    // changed
+    if (hashIter->second == hash)
+      return;
+
+    Erase(index, _entity, hashIter->second);
+    hashIter->second = hash;
+  }
+  index.entities[hash].push_back(_entity);
+}
+
+//////////////////////////////////////////////////
+void ValueIndex::Remove(const Entity _entity, const ComponentTypeId _type)
+{
+  auto iter = this->indexes.find(_type);
+  if (iter == this->indexes.end())
+    return;
+  auto &index = iter->second;
+
+  auto hashIter = index.hashes.find(_entity);
+  if (hashIter == index.hashes.end())
+    return;
+
+  Erase(index, _entity, hashIter->second);
+  index.hashes.erase(hashIter);
+}
+
+//////////////////////////////////////////////////
+void ValueIndex::Clear()
+{
+  for (auto &index : this->indexes)
+  {
+    index.second.entities.clear();
+    index.second.hashes.clear();
+  }
+}
+
+//////////////////////////////////////////////////
+const std::vector<Entity> *ValueIndex::Find(const ComponentTypeId _type,
+    const std::size_t _hash) const
+{
+  auto iter = this->indexes.find(_type);
+  if (iter == this->indexes.end())
+    return nullptr;
+
+  auto entitiesIter = iter->second.entities.find(_hash);
+  if (entitiesIter == iter->second.entities.end())
+    return &kNoEntities;
+
+  return &entitiesIter->second;
+}
+
+//////////////////////////////////////////////////
+std::size_t ValueIndex::Bytes() const
+{
+  std::size_t bytes = this->indexes.bucket_count() * sizeof(void *);
+  for (const auto &index : this->indexes)
+  {
+    bytes += sizeof(void *) + sizeof(index) +
+        index.second.entities.bucket_count() * sizeof(void *) +
+        index.second.hashes.bucket_count() * sizeof(void *) +
+        index.second.hashes.size() *
+            (sizeof(void *) + sizeof(std::pair<Entity, std::size_t>));
+    for (const auto &entities : index.second.entities)
+    {
+      bytes += sizeof(void *) + sizeof(entities) +
+          entities.second.capacity() * sizeof(Entity);
+    }
+  }
+  return bytes;
+}
+
+//////////////////////////////////////////////////
+void ValueIndex::Erase(TypeIndex &_index, const Entity _entity,
+    const std::size_t _hash)
+{
+  auto entitiesIter = _index.entities.find(_hash);
+  if (entitiesIter == _index.entities.end())
+    return;
+
+  auto &entities = entitiesIter->second;
+  auto entityIter = std::find(entities.begin(), entities.end(), _entity);
+  if (entityIter != entities.end())
+  {
+    *entityIter = entities.back();
+    entities.pop_back();
+  }
+
+  if (entities.empty())
+    _index.entities.erase(entitiesIter);
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_VALUEINDEX_HH_
+#define IGNITION_GAZEBO_VALUEINDEX_HH_
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/Types.hh>
+#include <ignition/gazebo/components/Component.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Finds the entities whose component of a given type holds a
+    /// given value, without checking every entity.
+    ///
+    /// Entities are grouped by the hash of their component's value, so a
+    /// lookup returns the entities whose value may be equal, and the caller
+    /// compares the values themselves. Only component types which have been
+    /// enabled are indexed.
+    class IGNITION_GAZEBO_VISIBLE ValueIndex
+    {
+      /// \brief Function which hashes the value of a component.
+      public: using Hasher =
+          std::function<std::size_t(const components::BaseComponent &)>;
+
+      /// \brief Start indexing a component type. Components which already
+      /// exist must be added with Set.
+      /// \param[in] _type Component type.
+      /// \param[in] _hasher Hashes the value of components of that type.
+      public: void Enable(const ComponentTypeId _type, Hasher _hasher);
+
+      /// \brief Whether a component type is indexed.
+      /// \param[in] _type Component type.
+      /// \return True if it's indexed.
+      public: bool Enabled(const ComponentTypeId _type) const;
+
+      /// \brief Index the value of an entity's component, replacing the
+      /// value indexed before, if any. Does nothing if the type isn't
+      /// indexed.
+      /// \param[in] _entity Entity.
+      /// \param[in] _type Component type.
+      /// \param[in] _component The component.
+      public: void Set(const Entity _entity, const ComponentTypeId _type,
+                  const components::BaseComponent &_component);
+
+      /// \brief Stop indexing an entity's component.
+      /// \param[in] _entity Entity.
+      /// \param[in] _type Component type.
+      public: void Remove(const Entity _entity, const ComponentTypeId _type);
+
+      /// \brief Forget all indexed values. Types stay enabled.
+      public: void Clear();
+
+      /// \brief Get the entities which may have a component with a value.
+      /// \param[in] _type Component type.
+      /// \param[in] _hash Hash of the value, as given by the type's hasher.
+      /// \return Entities whose component has the same hash, in no
+      /// particular order, or nullptr if the type isn't indexed.
+      public: const std::vector<Entity> *Find(const ComponentTypeId _type,
+                  const std::size_t _hash) const;
+
+      /// \brief Bytes allocated by the index.
+      /// \return Number of bytes.
+      public: std::size_t Bytes() const;
+
+      /// \brief Index of one component type.
+      private: struct TypeIndex
+      {
+        /// \brief Hashes values of this type.
+        Hasher hasher;
+
+        /// \brief Entities by the hash of their component's value.
+        std::unordered_map<std::size_t, std::vector<Entity>> entities;
+
+        /// \brief Hash of each indexed entity's value.
+        std::unordered_map<Entity, std::size_t> hashes;
+      };
+
+      /// \brief Remove an entity from the entities with a hash.
+      /// \param[in] _index Index of the component type.
+      /// \param[in] _entity Entity.
+      /// \param[in] _hash Hash the entity was indexed with.
+      private: static void Erase(TypeIndex &_index, const Entity _entity,
+                   const std::size_t _hash);
+
+      /// \brief Index of each enabled type.
+      private: std::unordered_map<ComponentTypeId, TypeIndex> indexes;
+    };
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_VALUEINDEX_HH_
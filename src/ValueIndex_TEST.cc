@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <string>
+
+#include "ignition/gazebo/components/Component.hh"
+
+#include "ValueIndex.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+using StringComponent =
+    components::Component<std::string, class StringComponentTag>;
+
+/// \brief Hash a string component.
+static std::size_t HashString(const components::BaseComponent &_component)
+{
+  return std::hash<std::string>()(
+      static_cast<const StringComponent &>(_component).Data());
+}
+
+//////////////////////////////////////////////////
+TEST(ValueIndex, SetFindRemove)
+{
+  const ComponentTypeId type{10};
+  const std::size_t hashA = std::hash<std::string>()("a");
+  const std::size_t hashB = std::hash<std::string>()("b");
+
+  ValueIndex index;
+  EXPECT_FALSE(index.Enabled(type));
+  EXPECT_EQ(nullptr, index.Find(type, hashA));
+
+  // Types which aren't enabled are ignored
+  index.Set(1, type, StringComponent("a"));
+  EXPECT_EQ(nullptr, index.Find(type, hashA));
+
+  index.Enable(type, HashString);
+  EXPECT_TRUE(index.Enabled(type));
+  ASSERT_NE(nullptr, index.Find(type, hashA));
+  EXPECT_TRUE(index.Find(type, hashA)->empty());
+
+  index.Set(1, type, StringComponent("a"));
+  index.Set(2, type, StringComponent("a"));
+  index.Set(3, type, StringComponent("b"));
+  ASSERT_EQ(2u, index.Find(type, hashA)->size());
+  ASSERT_EQ(1u, index.Find(type, hashB)->size());
+  EXPECT_EQ(3u, index.Find(type, hashB)->front());
+
+  // Setting the same value again doesn't duplicate the entity
+  index.Set(1, type, StringComponent("a"));
+  EXPECT_EQ(2u, index.Find(type, hashA)->size());
+
+  // A new value moves the entity
+  index.Set(1, type, StringComponent("b"));
+  ASSERT_EQ(1u, index.Find(type, hashA)->size());
+  EXPECT_EQ(2u, index.Find(type, hashA)->front());
+  EXPECT_EQ(2u, index.Find(type, hashB)->size());
+
+  index.Remove(2, type);
+  EXPECT_TRUE(index.Find(type, hashA)->empty());
+
+  // Removing again, or something which was never there, is harmless
+  index.Remove(2, type);
+  index.Remove(4, type);
+  index.Remove(1, type + 1);
+  EXPECT_EQ(2u, index.Find(type, hashB)->size());
+  EXPECT_GT(index.Bytes(), 0u);
+
+  // Clearing keeps the type enabled
+  index.Clear();
+  EXPECT_TRUE(index.Enabled(type));
+  EXPECT_TRUE(index.Find(type, hashB)->empty());
+}
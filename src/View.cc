@@ -15,12 +15,32 @@
  *
 */
 #include "ignition/gazebo/detail/View.hh"
+
+#include <atomic>
+
 #include "ignition/gazebo/EntityComponentManager.hh"
 
 using namespace ignition;
 using namespace gazebo;
 using namespace detail;
 
+//////////////////////////////////////////////////
+std::size_t detail::NextViewSlot()
+{
+  static std::atomic<std::size_t> next{0};
+  return next++;
+}
+
+//////////////////////////////////////////////////
+View::View(const ComponentTypeKey &_types)
+  : columnTypes(_types.begin(), _types.end()),
+    componentIds(_types.size()),
+    componentPtrs(_types.size()),
+    columnStorages(_types.size(), nullptr),
+    columnRelocations(_types.size(), 0u)
+{
+}
+
 //////////////////////////////////////////////////
 void View::AddEntity(const Entity _entity, const bool _new)
 {
@@ -29,19 +49,50 @@ void View::AddEntity(const Entity _entity, const bool _new)
   {
     this->newEntities.insert(_entity);
   }
+
+  if (this->entityRows.find(_entity) != this->entityRows.end())
+    return;
+
+  // Append a new row, its components are filled by AddComponent.
+  this->entityRows[_entity] = this->rows.size();
+  this->rows.push_back(_entity);
+  for (std::size_t c = 0; c < this->columnTypes.size(); ++c)
+  {
+    this->componentIds[c].push_back(kComponentIdInvalid);
+    this->componentPtrs[c].push_back(nullptr);
+  }
 }
 
 //////////////////////////////////////////////////
 void View::AddComponent(const Entity _entity,
     const ComponentTypeId _typeId,
-    const ComponentId _componentId)
+    const ComponentId _componentId,
+    ComponentStorageBase *_storage)
 {
-  this->components.insert(
-      std::make_pair(std::make_pair(_entity, _typeId), _componentId));
+  auto rowIter = this->entityRows.find(_entity);
+  const int column = this->ColumnIndex(_typeId);
+  if (rowIter == this->entityRows.end() || column < 0 || nullptr == _storage)
+    return;
+
+  // Bring the rest of the column up to date before storing a fresh pointer,
+  // so that the column's relocation count is valid for all its rows.
+  if (this->columnStorages[column] != _storage)
+  {
+    this->columnStorages[column] = _storage;
+    this->RefreshColumn(column);
+  }
+  else if (_storage->Relocations() != this->columnRelocations[column])
+  {
+    this->RefreshColumn(column);
+  }
+
+  const std::size_t row = rowIter->second;
+  this->componentIds[column][row] = _componentId;
+  this->componentPtrs[column][row] = _storage->Component(_componentId);
 }
 
 //////////////////////////////////////////////////
-bool View::RemoveEntity(const Entity _entity, const ComponentTypeKey &_key)
+bool View::RemoveEntity(const Entity _entity, const ComponentTypeKey &)
 {
   if (this->entities.find(_entity) == this->entities.end())
     return false;
@@ -51,21 +102,79 @@ bool View::RemoveEntity(const Entity _entity, const ComponentTypeKey &_key)
   this->newEntities.erase(_entity);
   this->toRemoveEntities.erase(_entity);
 
-  // Remove the entity from the components map
-  for (const ComponentTypeId &compTypeId : _key)
-    this->components.erase(std::make_pair(_entity, compTypeId));
+  // Remove the entity's row by moving the last row into its place
+  auto rowIter = this->entityRows.find(_entity);
+  if (rowIter != this->entityRows.end())
+  {
+    const std::size_t row = rowIter->second;
+    const std::size_t last = this->rows.size() - 1;
+    if (row != last)
+    {
+      this->rows[row] = this->rows[last];
+      this->entityRows[this->rows[row]] = row;
+      for (std::size_t c = 0; c < this->columnTypes.size(); ++c)
+      {
+        this->componentIds[c][row] = this->componentIds[c][last];
+        this->componentPtrs[c][row] = this->componentPtrs[c][last];
+      }
+    }
+
+    this->rows.pop_back();
+    for (std::size_t c = 0; c < this->columnTypes.size(); ++c)
+    {
+      this->componentIds[c].pop_back();
+      this->componentPtrs[c].pop_back();
+    }
+    this->entityRows.erase(_entity);
+  }
 
   return true;
 }
 
-/////////////////////////////////////////////////
-const components::BaseComponent *View::ComponentImplementation(
-    const Entity _entity,
-    ComponentTypeId _typeId,
-    const EntityComponentManager *_ecm) const
+//////////////////////////////////////////////////
+void View::Refresh()
+{
+  for (std::size_t c = 0; c < this->columnTypes.size(); ++c)
+  {
+    const ComponentStorageBase *storage = this->columnStorages[c];
+    if (nullptr != storage &&
+        storage->Relocations() != this->columnRelocations[c])
+    {
+      this->RefreshColumn(static_cast<int>(c));
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void View::RefreshColumn(const int _column)
+{
+  ComponentStorageBase *storage = this->columnStorages[_column];
+  if (nullptr == storage)
+    return;
+
+  auto &ids = this->componentIds[_column];
+  auto &ptrs = this->componentPtrs[_column];
+  for (std::size_t row = 0; row < ids.size(); ++row)
+  {
+    ptrs[row] = ids[row] == kComponentIdInvalid ?
+        nullptr : storage->Component(ids[row]);
+  }
+  this->columnRelocations[_column] = storage->Relocations();
+}
+
+//////////////////////////////////////////////////
+void View::Clear()
 {
-  return _ecm->ComponentImplementation(
-      {_typeId, this->components.at({_entity, _typeId})});
+  this->entities.clear();
+  this->newEntities.clear();
+  this->toRemoveEntities.clear();
+  this->rows.clear();
+  this->entityRows.clear();
+  for (std::size_t c = 0; c < this->columnTypes.size(); ++c)
+  {
+    this->componentIds[c].clear();
+    this->componentPtrs[c].clear();
+  }
 }
 
 //////////////////////////////////////////////////
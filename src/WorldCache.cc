@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "WorldCache.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <unordered_set>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Util.hh>
+
+#include "ignition/gazebo/Util.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Elements whose value is a path, which may be relative to the
+/// file the element was read from.
+static const std::unordered_set<std::string> kPathElements{
+    "uri", "filename", "albedo_map", "normal_map", "roughness_map",
+    "metalness_map", "environment_map", "emissive_map", "light_map"};
+
+//////////////////////////////////////////////////
+/// \brief Hash the content of a file.
+/// \param[in] _path Path to the file.
+/// \return The hash, or an empty string if the file can't be read.
+static std::string fileHash(const std::string &_path)
+{
+  std::ifstream file(_path, std::ios::binary);
+  if (!file)
+    return "";
+
+  std::string content{std::istreambuf_iterator<char>(file),
+      std::istreambuf_iterator<char>()};
+  return common::sha1(content);
+}
+
+//////////////////////////////////////////////////
+/// \brief Collect the files an element and its descendants were read from.
+/// \param[in] _elem Element.
+/// \param[out] _files Paths to the files.
+static void collectFiles(const sdf::ElementPtr &_elem,
+    std::set<std::string> &_files)
+{
+  const auto &filePath = _elem->FilePath();
+  if (!filePath.empty() && filePath != "data-string")
+    _files.insert(filePath);
+
+  for (auto child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    collectFiles(child, _files);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Make the relative paths held by an element and its descendants
+/// absolute. The content of plugins is left as is, since only the plugins
+/// know what it means.
+/// \param[in] _elem Element.
+static void absolutePaths(const sdf::ElementPtr &_elem)
+{
+  if (_elem->GetName() == "plugin")
+    return;
+
+  if (kPathElements.count(_elem->GetName()) && _elem->GetValue())
+  {
+    auto value = _elem->Get<std::string>();
+    auto fullPath = asFullPath(value, _elem->FilePath());
+    if (!value.empty() && fullPath != value)
+      _elem->Set(fullPath);
+  }
+
+  for (auto child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    absolutePaths(child);
+  }
+}
+
+//////////////////////////////////////////////////
+WorldCache::WorldCache(const std::string &_dir)
+  : dir(_dir)
+{
+}
+
+//////////////////////////////////////////////////
+bool WorldCache::Load(const std::string &_filePath, std::string &_sdf) const
+{
+  std::ifstream file(this->CacheFile(_filePath), std::ios::binary);
+  if (!file)
+    return false;
+
+  // Files the world was built from, each followed by its hash
+  std::string line;
+  if (!std::getline(file, line))
+    return false;
+
+  std::size_t count{0};
+  std::istringstream(line) >> count;
+  if (count == 0)
+    return false;
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    std::string path;
+    std::string hash;
+    if (!std::getline(file, path) || !std::getline(file, hash))
+      return false;
+
+    if (fileHash(path) != hash)
+    {
+      igndbg << "Ignoring cached world of [" << _filePath << "], ["
+             << path << "] changed." << std::endl;
+      return false;
+    }
+  }
+
+  _sdf.assign(std::istreambuf_iterator<char>(file),
+      std::istreambuf_iterator<char>());
+  return !_sdf.empty();
+}
+
+//////////////////////////////////////////////////
+bool WorldCache::Save(const std::string &_filePath,
+    const sdf::Root &_root) const
+{
+  auto rootElem = _root.Element();
+  if (nullptr == rootElem)
+    return false;
+
+  std::set<std::string> files;
+  files.insert(_filePath);
+  collectFiles(rootElem, files);
+
+  std::ostringstream header;
+  header << files.size() << "\n";
+  for (const auto &path : files)
+  {
+    auto hash = fileHash(path);
+    if (hash.empty())
+      return false;
+    header << path << "\n" << hash << "\n";
+  }
+
+  // Don't modify the loaded world
+  auto elem = rootElem->Clone();
+  absolutePaths(elem);
+
+  if (!common::exists(this->dir) && !common::createDirectories(this->dir))
+  {
+    ignwarn << "Failed to create world cache directory [" << this->dir
+            << "]" << std::endl;
+    return false;
+  }
+
+  // Write to a temporary file first, so other servers never read a
+  // partial world
+  auto cacheFile = this->CacheFile(_filePath);
+  auto tmpFile = cacheFile + "." + std::to_string(IGN_SYSTEM_TIME_NS()) +
+      ".tmp";
+  {
+    std::ofstream file(tmpFile, std::ios::binary);
+    file << header.str() << elem->ToString("");
+    if (!file)
+    {
+      ignwarn << "Failed to write world cache [" << tmpFile << "]"
+              << std::endl;
+      common::removeFile(tmpFile);
+      return false;
+    }
+  }
+
+  if (std::rename(tmpFile.c_str(), cacheFile.c_str()) != 0)
+  {
+    common::removeFile(tmpFile);
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::string WorldCache::CacheFile(const std::string &_filePath) const
+{
+  std::string key = std::string(IGNITION_GAZEBO_VERSION_FULL) + "\n" +
+      _filePath;
+  for (const auto &env : {kResourcePathEnv, kSdfPathEnv,
+      std::string("IGN_FILE_PATH")})
+  {
+    std::string value;
+    common::env(env, value);
+    key += "\n" + value;
+  }
+  return common::joinPaths(this->dir, common::sha1(key) + ".sdf");
+}
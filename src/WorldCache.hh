@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_WORLDCACHE_HH_
+#define IGNITION_GAZEBO_WORLDCACHE_HH_
+
+#include <string>
+
+#include <sdf/Root.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Stores worlds loaded from SDF files with their includes
+    /// expanded, so later loads of the same file parse a single document
+    /// instead of finding, downloading and parsing every included model.
+    ///
+    /// Relative paths are made absolute before storing, since the stored
+    /// world is loaded from a string. Each stored world lists the files it
+    /// was built from with the hash of their content, and is ignored once
+    /// any of them changes.
+    class IGNITION_GAZEBO_VISIBLE WorldCache
+    {
+      /// \brief Constructor.
+      /// \param[in] _dir Directory holding the stored worlds. It's created
+      /// when the first world is stored.
+      public: explicit WorldCache(const std::string &_dir);
+
+      /// \brief Get the stored world of an SDF file.
+      /// \param[in] _filePath Full path to the SDF file.
+      /// \param[out] _sdf The stored world, as an SDF string.
+      /// \return False if there's no stored world, or if the files it was
+      /// built from changed.
+      public: bool Load(const std::string &_filePath, std::string &_sdf) const;
+
+      /// \brief Store the world loaded from an SDF file.
+      /// \param[in] _filePath Full path to the SDF file.
+      /// \param[in] _root The loaded world.
+      /// \return False if the world couldn't be written.
+      public: bool Save(const std::string &_filePath,
+                  const sdf::Root &_root) const;
+
+      /// \brief Path to the stored world of an SDF file. Besides the file's
+      /// path, it depends on the version of this library and on the paths
+      /// used to find included models.
+      /// \param[in] _filePath Full path to the SDF file.
+      /// \return Path within the cache directory.
+      private: std::string CacheFile(const std::string &_filePath) const;
+
+      /// \brief Directory holding the stored worlds.
+      private: std::string dir;
+    };
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_WORLDCACHE_HH_
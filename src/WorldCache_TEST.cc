@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+#include <ignition/common/Filesystem.hh>
+#include <sdf/Root.hh>
+
+#include "ignition/gazebo/test_config.hh"
+
+#include "WorldCache.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+/// \brief Write a world with a mesh at a relative path.
+/// \param[in] _path Path to the world file.
+/// \param[in] _name Name of the world.
+void writeWorld(const std::string &_path, const std::string &_name)
+{
+  std::ofstream file(_path);
+  file << R"(<?xml version="1.0" ?>
+<sdf version="1.6">
+  <world name=")" << _name << R"(">
+    <model name="mesh">
+      <link name="link">
+        <visual name="visual">
+          <geometry>
+            <mesh>
+              <uri>meshes/box.dae</uri>
+            </mesh>
+          </geometry>
+        </visual>
+      </link>
+    </model>
+  </world>
+</sdf>)";
+}
+
+/////////////////////////////////////////////////
+TEST(WorldCache, SaveAndLoad)
+{
+  auto dir = common::joinPaths(std::string(PROJECT_BINARY_PATH),
+      "test_world_cache");
+  common::removeAll(dir);
+  ASSERT_TRUE(common::createDirectories(dir));
+
+  const auto worldPath = common::joinPaths(dir, "world.sdf");
+  writeWorld(worldPath, "cached");
+
+  WorldCache cache(common::joinPaths(dir, "cache"));
+  std::string sdfString;
+  EXPECT_FALSE(cache.Load(worldPath, sdfString));
+
+  sdf::Root root;
+  ASSERT_TRUE(root.Load(worldPath).empty());
+  EXPECT_TRUE(cache.Save(worldPath, root));
+  ASSERT_TRUE(cache.Load(worldPath, sdfString));
+
+  // The relative URI was made absolute
+  sdf::Root cachedRoot;
+  ASSERT_TRUE(cachedRoot.LoadSdfString(sdfString).empty());
+  ASSERT_EQ(1u, cachedRoot.WorldCount());
+  EXPECT_EQ("cached", cachedRoot.WorldByIndex(0)->Name());
+  EXPECT_NE(std::string::npos, sdfString.find(
+      common::joinPaths(dir, "meshes", "box.dae")));
+
+  // Another file isn't found
+  EXPECT_FALSE(cache.Load(common::joinPaths(dir, "other.sdf"), sdfString));
+
+  // Changing the file invalidates the stored world
+  writeWorld(worldPath, "changed");
+  EXPECT_FALSE(cache.Load(worldPath, sdfString));
+}
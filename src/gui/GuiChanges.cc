@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "GuiChanges.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+void GuiChanges::AddEntity(Entity _entity)
+{
+  this->entities.insert(_entity);
+}
+
+/////////////////////////////////////////////////
+void GuiChanges::AddComponent(Entity _entity, ComponentTypeId _type)
+{
+  this->components[_entity].insert(_type);
+}
+
+/////////////////////////////////////////////////
+void GuiChanges::Clear()
+{
+  this->entities.clear();
+  this->components.clear();
+}
+
+/////////////////////////////////////////////////
+bool GuiChanges::Empty() const
+{
+  return this->entities.empty() && this->components.empty();
+}
+
+/////////////////////////////////////////////////
+std::unordered_set<Entity> GuiChanges::Matching(
+    const std::unordered_set<ComponentTypeId> &_types,
+    const std::unordered_set<Entity> &_entities) const
+{
+  std::unordered_set<Entity> result;
+  for (const auto &entity : this->entities)
+  {
+    if (_entities.empty() || _entities.count(entity))
+      result.insert(entity);
+  }
+
+  for (const auto &[entity, types] : this->components)
+  {
+    if (!_entities.empty() && !_entities.count(entity))
+      continue;
+
+    if (_types.empty())
+    {
+      result.insert(entity);
+      continue;
+    }
+
+    for (const auto &type : types)
+    {
+      if (_types.count(type))
+      {
+        result.insert(entity);
+        break;
+      }
+    }
+  }
+  return result;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_GUI_GUICHANGES_HH_
+#define IGNITION_GAZEBO_GUI_GUICHANGES_HH_
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/Export.hh"
+#include "ignition/gazebo/Types.hh"
+#include "ignition/gazebo/config.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+class GuiSystem;
+
+/// \brief Changes made to the GUI's entity-component manager between two
+/// plugin updates, used to skip plugins which subscribed to changes that
+/// didn't happen.
+class IGNITION_GAZEBO_VISIBLE GuiChanges
+{
+  /// \brief Record that an entity was created or removed.
+  /// \param[in] _entity Entity.
+  public: void AddEntity(Entity _entity);
+
+  /// \brief Record that a component was created, updated or removed.
+  /// \param[in] _entity Entity holding the component.
+  /// \param[in] _type Component type.
+  public: void AddComponent(Entity _entity, ComponentTypeId _type);
+
+  /// \brief Forget all changes.
+  public: void Clear();
+
+  /// \brief Whether no changes were recorded.
+  /// \return True if empty.
+  public: bool Empty() const;
+
+  /// \brief Entities with changes matching a subscription. Entities which
+  /// were created or removed always match, the other ones match if one of
+  /// their changed components has one of the given types.
+  /// \param[in] _types Component types, all types if empty.
+  /// \param[in] _entities Entities, all entities if empty.
+  /// \return Matching entities.
+  public: std::unordered_set<Entity> Matching(
+      const std::unordered_set<ComponentTypeId> &_types,
+      const std::unordered_set<Entity> &_entities) const;
+
+  /// \brief Entities which were created or removed.
+  private: std::unordered_set<Entity> entities;
+
+  /// \brief Types of the changed components of each entity.
+  private: std::unordered_map<Entity, std::unordered_set<ComponentTypeId>>
+      components;
+};
+
+/// \brief Set the entities a GUI system will see in
+/// GuiSystem::ChangedEntities during its next update.
+/// \param[in] _system GUI system about to be updated.
+/// \param[in] _changes Changes since the previous update.
+/// \return False if the system subscribed to changes and none of them
+/// happened, so its update can be skipped.
+IGNITION_GAZEBO_VISIBLE
+bool setChangedEntities(const GuiSystem *_system, const GuiChanges &_changes);
+}
+}
+}
+#endif
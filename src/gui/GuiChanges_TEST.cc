@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "GuiChanges.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(GuiChanges, Matching)
+{
+  GuiChanges changes;
+  EXPECT_TRUE(changes.Empty());
+  EXPECT_TRUE(changes.Matching({}, {}).empty());
+
+  changes.AddEntity(1);
+  changes.AddComponent(2, 10);
+  changes.AddComponent(2, 11);
+  changes.AddComponent(3, 12);
+  EXPECT_FALSE(changes.Empty());
+
+  // Everything
+  EXPECT_EQ(std::unordered_set<Entity>({1, 2, 3}), changes.Matching({}, {}));
+
+  // Created or removed entities always match
+  EXPECT_EQ(std::unordered_set<Entity>({1, 2}), changes.Matching({11}, {}));
+  EXPECT_EQ(std::unordered_set<Entity>({1}), changes.Matching({13}, {}));
+
+  // Filter by entity
+  EXPECT_EQ(std::unordered_set<Entity>({3}), changes.Matching({}, {3}));
+  EXPECT_TRUE(changes.Matching({10}, {3}).empty());
+  EXPECT_EQ(std::unordered_set<Entity>({2}), changes.Matching({10, 12}, {2}));
+
+  changes.Clear();
+  EXPECT_TRUE(changes.Empty());
+  EXPECT_TRUE(changes.Matching({}, {}).empty());
+}
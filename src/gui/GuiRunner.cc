@@ -15,17 +15,37 @@
  *
 */
 
+#include <ignition/msgs/bytes.pb.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
+#include <ignition/common/WorkerPool.hh>
 #include <ignition/fuel_tools/Interface.hh>
 #include <ignition/gui/Application.hh>
 #include <ignition/gui/MainWindow.hh>
 
+#include <QPointer>
+
 // Include all components so they have first-class support
 #include "ignition/gazebo/components/components.hh"
+#include "ignition/gazebo/BinaryState.hh"
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/gui/GuiRunner.hh"
 #include "ignition/gazebo/gui/GuiSystem.hh"
+#include "ignition/gazebo/LocalStateChannel.hh"
+#include "ignition/gazebo/PoseDeltaStream.hh"
+#include "ignition/gazebo/StateMirror.hh"
+
+#include "GuiChanges.hh"
+#include "../systems/log/StateCompression.hh"
 
 using namespace ignition;
 using namespace gazebo;
@@ -40,11 +60,87 @@ static std::mutex gUpdateMutex;
 /// \brief The plugin update thread..
 static std::thread gUpdateThread;
 
+/// \brief Environment variable with the rate, in Hz, at which plugins are
+/// updated. It's independent of the rate at which state is received.
+static const std::string kUpdateRateEnv{"IGN_GAZEBO_GUI_UPDATE_RATE"};
+
+/// \brief Default plugin update rate, in Hz.
+static const double kDefaultUpdateRate{30.0};
+
+/// \brief Mutex to protect gPendingState. It's only held while messages are
+/// merged or taken, so the transport thread never waits for plugins.
+static std::mutex gStateMutex;
+
+/// \brief State received since the last plugin update, merged so that only
+/// the latest value of each component is kept. Protected by gStateMutex.
+static msgs::SerializedStepMap gPendingState;
+
+/// \brief Whether gPendingState holds anything. Protected by gStateMutex.
+static bool gHasPendingState = false;
+
+/// \brief Worker pool used by the ECM to deserialize large states in
+/// parallel.
+static std::unique_ptr<common::WorkerPool> gWorkerPool;
+
+/// \brief Channel of the world's runner, when it's in this process. State is
+/// then taken from it instead of being received through transport.
+static std::shared_ptr<LocalStateChannel> gLocalState;
+
+/// \brief GUI systems to update, refreshed when a plugin is added instead of
+/// searching the whole Qt object tree on every update. Plugins which have
+/// been deleted become null. Protected by gUpdateMutex.
+static std::vector<QPointer<GuiSystem>> gPlugins;
+
+/// \brief Changes to the ECM since the last plugin update, given to the
+/// plugins which subscribed to changes. Protected by gUpdateMutex.
+static GuiChanges gChanges;
+
+/// \brief Environment variable which makes the GUI also subscribe to the
+/// delta encoded dynamic poses, so that poses are updated in between state
+/// messages. It's useful with a low `<state_hertz>` in the SceneBroadcaster.
+static const std::string kPoseDeltaEnv{"IGN_GAZEBO_GUI_POSE_DELTA"};
+
+/// \brief Whether the delta encoded dynamic poses are used.
+static bool gPoseDeltaEnabled = false;
+
+/// \brief Environment variable which makes the GUI subscribe to the
+/// compressed state instead, to save bandwidth on slow links to the server.
+static const std::string kCompressedStateEnv{
+    "IGN_GAZEBO_GUI_COMPRESSED_STATE"};
+
+/// \brief Decodes the delta encoded dynamic poses. Protected by
+/// gUpdateMutex.
+static PoseDeltaDecoder gPoseDeltaDecoder;
+
+/// \brief Set pose components from decoded poses.
+/// \param[in] _ecm GUI entity component manager.
+/// \param[in] _entities Entities to set. Those which are not in the ECM yet
+/// are skipped, they'll come with the next state.
+static void applyPoseDeltas(EntityComponentManager &_ecm,
+    const std::vector<Entity> &_entities)
+{
+  const auto &poses = gPoseDeltaDecoder.Poses();
+  for (auto entity : _entities)
+  {
+    auto poseComp = _ecm.Component<components::Pose>(entity);
+    if (nullptr == poseComp)
+      continue;
+
+    poseComp->Data() = poses.at(entity);
+    _ecm.SetChanged(entity, components::Pose::typeId,
+        ComponentState::PeriodicChange);
+    gChanges.AddComponent(entity, components::Pose::typeId);
+  }
+}
+
 /////////////////////////////////////////////////
 GuiRunner::GuiRunner(const std::string &_worldName)
 {
   this->setProperty("worldName", QString::fromStdString(_worldName));
 
+  gWorkerPool = std::make_unique<common::WorkerPool>();
+  this->ecm.SetWorkerPool(gWorkerPool.get());
+
   auto win = gui::App()->findChild<ignition::gui::MainWindow *>();
   auto winWorldNames = win->property("worldNames").toStringList();
   winWorldNames.append(QString::fromStdString(_worldName));
@@ -64,24 +160,102 @@ GuiRunner::GuiRunner(const std::string &_worldName)
     return fuel_tools::fetchResource(_uri.Str());
   });
 
-  igndbg << "Requesting initial state from [" << this->stateTopic << "]..."
-         << std::endl;
+  // A server in this process hands its state over directly
+  gLocalState = LocalStateChannel::Find(_worldName);
+  if (nullptr != gLocalState && !gLocalState->Attach())
+    gLocalState.reset();
+  if (nullptr != gLocalState)
+  {
+    igndbg << "Taking state of world [" << _worldName
+           << "] from the server in this process." << std::endl;
+  }
+
+  // Local state is up to date on every step already
+  std::string poseDeltaEnv;
+  gPoseDeltaEnabled = nullptr == gLocalState &&
+      common::env(kPoseDeltaEnv, poseDeltaEnv) && poseDeltaEnv != "0";
+  if (gPoseDeltaEnabled)
+  {
+    auto poseDeltaTopic = transport::TopicUtils::AsValidTopic("/world/" +
+        _worldName + "/dynamic_pose/delta");
+    std::function<void(const msgs::Bytes &)> poseDeltaCb =
+        [this](const msgs::Bytes &_msg)
+        {
+          IGN_PROFILE("GuiRunner::PoseDelta");
+          std::lock_guard<std::mutex> lock(gUpdateMutex);
+          std::vector<Entity> changed;
+          if (gPoseDeltaDecoder.Decode(_msg.data(), changed))
+            applyPoseDeltas(this->ecm, changed);
+        };
+    if (!this->node.Subscribe(poseDeltaTopic, poseDeltaCb))
+    {
+      ignerr << "Failed to subscribe to [" << poseDeltaTopic << "]"
+             << std::endl;
+    }
+  }
 
-  this->RequestState();
+  if (nullptr == gLocalState)
+  {
+    igndbg << "Requesting initial state from [" << this->stateTopic << "]..."
+           << std::endl;
+
+    this->RequestState();
+  }
 
-  // Periodically update the plugins
+  double updateRate{kDefaultUpdateRate};
+  std::string updateRateEnv;
+  if (common::env(kUpdateRateEnv, updateRateEnv))
+  {
+    try
+    {
+      updateRate = std::stod(updateRateEnv);
+    }
+    catch (...)
+    {
+      updateRate = 0.0;
+    }
+    if (updateRate <= 0.0)
+    {
+      ignwarn << "Invalid [" << kUpdateRateEnv << "] value ["
+              << updateRateEnv << "], using [" << kDefaultUpdateRate
+              << "] Hz." << std::endl;
+      updateRate = kDefaultUpdateRate;
+    }
+  }
+  const auto updatePeriod =
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / updateRate));
+
+  {
+    std::lock_guard<std::mutex> lock(gUpdateMutex);
+    this->RefreshPlugins();
+  }
+
+  // Periodically apply the latest state and update the plugins
   // \todo(anyone) Move the global variables to GuiRunner::Implementation on v5
   gRunning = true;
-  gUpdateThread = std::thread([&]()
+  gUpdateThread = std::thread([&, updatePeriod]()
   {
+    auto nextUpdate = std::chrono::steady_clock::now();
     while (gRunning)
     {
       {
         std::lock_guard<std::mutex> lock(gUpdateMutex);
+        const bool newState = this->ProcessState();
         this->UpdatePlugins();
+        if (newState)
+        {
+          this->ecm.ClearNewlyCreatedEntities();
+          this->ecm.ProcessRemoveEntityRequests();
+        }
       }
-      // This is roughly a 30Hz update rate.
-      std::this_thread::sleep_for(std::chrono::milliseconds(33));
+
+      // Keep the rate even if updates are slow, but don't try to catch up
+      nextUpdate += updatePeriod;
+      const auto now = std::chrono::steady_clock::now();
+      if (nextUpdate < now)
+        nextUpdate = now;
+      std::this_thread::sleep_until(nextUpdate);
     }
   });
 }
@@ -92,6 +266,15 @@ GuiRunner::~GuiRunner()
   gRunning = false;
   if (gUpdateThread.joinable())
     gUpdateThread.join();
+
+  this->ecm.SetWorkerPool(nullptr);
+  gWorkerPool.reset();
+
+  if (nullptr != gLocalState)
+  {
+    gLocalState->Detach();
+    gLocalState.reset();
+  }
 }
 
 /////////////////////////////////////////////////
@@ -138,7 +321,16 @@ void GuiRunner::OnPluginAdded(const QString &_objectName)
     return;
   }
 
-  this->RequestState();
+  {
+    std::lock_guard<std::mutex> lock(gUpdateMutex);
+    this->RefreshPlugins();
+  }
+
+  // New plugins are given all components
+  if (nullptr != gLocalState)
+    gLocalState->RequestFullState();
+  else
+    this->RequestState();
 }
 
 /////////////////////////////////////////////////
@@ -154,33 +346,166 @@ void GuiRunner::OnStateAsyncService(const msgs::SerializedStepMap &_res)
   this->node.UnadvertiseSrv(reqSrv);
 
   // Only subscribe to periodic updates after receiving initial state
-  if (this->node.SubscribedTopics().empty())
-    this->node.Subscribe(this->stateTopic, &GuiRunner::OnState, this);
+  std::string compressedEnv;
+  const bool compressed = common::env(kCompressedStateEnv, compressedEnv) &&
+      compressedEnv != "0";
+  const auto topic = compressed ? this->stateTopic + "/compressed" :
+      this->stateTopic;
+
+  auto subscribed = this->node.SubscribedTopics();
+  if (std::find(subscribed.begin(), subscribed.end(), topic) !=
+      subscribed.end())
+  {
+    return;
+  }
+
+  if (!compressed)
+  {
+    this->node.Subscribe(topic, &GuiRunner::OnState, this);
+    return;
+  }
+
+  std::function<void(const msgs::Bytes &)> compressedCb =
+      [this](const msgs::Bytes &_msg)
+      {
+        IGN_PROFILE("GuiRunner::CompressedState");
+        std::string data;
+        msgs::SerializedStepMap msg;
+        if (!systems::log_system::DecompressData(_msg.data(), data) ||
+            !msg.ParseFromString(data))
+        {
+          ignerr << "Failed to decompress state." << std::endl;
+          return;
+        }
+        this->OnState(msg);
+      };
+  if (!this->node.Subscribe(topic, compressedCb))
+    ignerr << "Failed to subscribe to [" << topic << "]" << std::endl;
 }
 
 /////////////////////////////////////////////////
 void GuiRunner::OnState(const msgs::SerializedStepMap &_msg)
 {
   IGN_PROFILE_THREAD_NAME("GuiRunner::OnState");
-  IGN_PROFILE("GuiRunner::Update");
+  IGN_PROFILE("GuiRunner::OnState");
+
+  // Plugins are updated on the update thread, here we only keep the message
+  std::lock_guard<std::mutex> lock(gStateMutex);
+  if (gHasPendingState)
+  {
+    StateMirror::MergeState(gPendingState, _msg);
+  }
+  else
+  {
+    gPendingState = _msg;
+    gHasPendingState = true;
+  }
+}
 
-  std::lock_guard<std::mutex> lock(gUpdateMutex);
-  this->ecm.SetState(_msg.state());
+/////////////////////////////////////////////////
+bool GuiRunner::ProcessState()
+{
+  if (nullptr != gLocalState)
+  {
+    std::vector<std::string> states;
+    bool full{false};
+    if (!gLocalState->Take(states, full, this->updateInfo))
+      return false;
 
-  // Update all plugins
-  this->updateInfo = convert<UpdateInfo>(_msg.stats());
-  this->UpdatePlugins();
-  this->ecm.ClearNewlyCreatedEntities();
-  this->ecm.ProcessRemoveEntityRequests();
+    IGN_PROFILE("GuiRunner::ProcessState Local");
+    for (std::size_t i = 0; i < states.size(); ++i)
+    {
+      BinaryStateReader reader(states[i].data(), states[i].size());
+      for (const Entity entity : reader.RemovedEntities())
+        gChanges.AddEntity(entity);
+
+      // A full state replaces everything, so entities which aren't in it
+      // are gone
+      std::unordered_set<Entity> present;
+      reader.EachComponent([&](const Entity _entity,
+          const ComponentTypeId _type, std::istream *) -> bool
+      {
+        if (!this->ecm.HasEntity(_entity))
+          gChanges.AddEntity(_entity);
+        gChanges.AddComponent(_entity, _type);
+        if (full && i == 0)
+          present.insert(_entity);
+        return true;
+      });
+
+      if (full && i == 0)
+      {
+        for (const auto &vertex : this->ecm.Entities().Vertices())
+        {
+          if (present.find(vertex.first) == present.end())
+          {
+            this->ecm.RequestRemoveEntity(vertex.first, false);
+            gChanges.AddEntity(vertex.first);
+          }
+        }
+      }
+
+      this->ecm.SetBinaryState(states[i].data(), states[i].size());
+    }
+    return true;
+  }
+
+  msgs::SerializedStepMap msg;
+  {
+    std::lock_guard<std::mutex> lock(gStateMutex);
+    if (!gHasPendingState)
+      return false;
+    msg.Swap(&gPendingState);
+    gHasPendingState = false;
+  }
+
+  IGN_PROFILE("GuiRunner::ProcessState");
+  for (const auto &[id, entityMsg] : msg.state().entities())
+  {
+    Entity entity{id};
+    if (entityMsg.remove() || !this->ecm.HasEntity(entity))
+      gChanges.AddEntity(entity);
+
+    for (const auto &compIt : entityMsg.components())
+      gChanges.AddComponent(entity, compIt.first);
+  }
+
+  this->ecm.SetState(msg.state());
+  this->updateInfo = convert<UpdateInfo>(msg.stats());
+
+  // Don't let poses from an older state override newer pose deltas
+  if (gPoseDeltaEnabled &&
+      gPoseDeltaDecoder.Time() > this->updateInfo.simTime)
+  {
+    std::vector<Entity> entities;
+    for (const auto &pose : gPoseDeltaDecoder.Poses())
+      entities.push_back(pose.first);
+    applyPoseDeltas(this->ecm, entities);
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+void GuiRunner::RefreshPlugins()
+{
+  gPlugins.clear();
+  for (auto plugin : gui::App()->findChildren<GuiSystem *>())
+    gPlugins.emplace_back(plugin);
 }
 
 /////////////////////////////////////////////////
 void GuiRunner::UpdatePlugins()
 {
-  auto plugins = gui::App()->findChildren<GuiSystem *>();
-  for (auto plugin : plugins)
+  IGN_PROFILE("GuiRunner::UpdatePlugins");
+  for (auto &plugin : gPlugins)
   {
-    plugin->Update(this->updateInfo, this->ecm);
+    if (!plugin.isNull() && setChangedEntities(plugin.data(), gChanges))
+      plugin->Update(this->updateInfo, this->ecm);
   }
+  gChanges.Clear();
   this->ecm.ClearRemovedComponents();
+
+  // All plugins have seen this update's changes, so the next update only
+  // sees components changed after this point
+  this->ecm.SetAllComponentsUnchanged();
 }
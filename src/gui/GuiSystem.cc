@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/gui/GuiSystem.hh"
+
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "GuiChanges.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Changes a GUI system subscribed to.
+struct ChangeSubscription
+{
+  /// \brief False after the system unsubscribed.
+  bool active{true};
+
+  /// \brief Component types the system is interested in.
+  std::unordered_set<ComponentTypeId> types;
+
+  /// \brief Entities the system is interested in.
+  std::unordered_set<Entity> entities;
+
+  /// \brief Matching entities which changed before the current update.
+  std::unordered_set<Entity> changed;
+};
+
+/// \todo(anyone) Move to GuiSystem when porting to v5. It's kept outside of
+/// the class so its layout doesn't change.
+/// \brief Subscriptions of all GUI systems which subscribed to changes.
+static std::unordered_map<const GuiSystem *, ChangeSubscription>
+    gSubscriptions;
+
+/// \brief Mutex to protect gSubscriptions.
+static std::mutex gSubscriptionsMutex;
+
+/// \brief Returned to systems which haven't subscribed to changes.
+static const std::unordered_set<Entity> kNoEntities;
+
+/////////////////////////////////////////////////
+void GuiSystem::SubscribeToChanges(
+    const std::unordered_set<ComponentTypeId> &_types,
+    const std::unordered_set<Entity> &_entities)
+{
+  std::lock_guard<std::mutex> lock(gSubscriptionsMutex);
+  auto it = gSubscriptions.find(this);
+  if (it == gSubscriptions.end())
+  {
+    // Forget the subscription when the system is deleted, so that another
+    // system created at the same address doesn't inherit it
+    const GuiSystem *system = this;
+    this->connect(this, &QObject::destroyed, [system]()
+    {
+      std::lock_guard<std::mutex> destroyedLock(gSubscriptionsMutex);
+      gSubscriptions.erase(system);
+    });
+    it = gSubscriptions.emplace(this, ChangeSubscription()).first;
+  }
+  it->second.active = true;
+  it->second.types = _types;
+  it->second.entities = _entities;
+}
+
+/////////////////////////////////////////////////
+void GuiSystem::UnsubscribeFromChanges()
+{
+  std::lock_guard<std::mutex> lock(gSubscriptionsMutex);
+  auto it = gSubscriptions.find(this);
+  if (it == gSubscriptions.end())
+    return;
+
+  // Keep the entry, so the destroyed connection is only made once
+  it->second.active = false;
+  it->second.types.clear();
+  it->second.entities.clear();
+  it->second.changed.clear();
+}
+
+/////////////////////////////////////////////////
+bool GuiSystem::SubscribedToChanges() const
+{
+  std::lock_guard<std::mutex> lock(gSubscriptionsMutex);
+  auto it = gSubscriptions.find(this);
+  return it != gSubscriptions.end() && it->second.active;
+}
+
+/////////////////////////////////////////////////
+const std::unordered_set<Entity> &GuiSystem::ChangedEntities() const
+{
+  std::lock_guard<std::mutex> lock(gSubscriptionsMutex);
+  auto it = gSubscriptions.find(this);
+  if (it == gSubscriptions.end())
+    return kNoEntities;
+  return it->second.changed;
+}
+
+/////////////////////////////////////////////////
+bool ignition::gazebo::setChangedEntities(const GuiSystem *_system,
+    const GuiChanges &_changes)
+{
+  std::lock_guard<std::mutex> lock(gSubscriptionsMutex);
+  auto it = gSubscriptions.find(_system);
+  if (it == gSubscriptions.end() || !it->second.active)
+    return true;
+
+  it->second.changed = _changes.Matching(it->second.types,
+      it->second.entities);
+  return !it->second.changed.empty();
+}
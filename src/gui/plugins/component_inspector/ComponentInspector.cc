@@ -15,6 +15,7 @@
  *
 */
 
+#include <chrono>
 #include <iostream>
 #include <regex>
 #include <ignition/common/Console.hh>
@@ -95,26 +96,61 @@ namespace ignition::gazebo
 
     /// \brief Transport node for making command requests
     public: transport::Node node;
+
+    /// \brief Minimum time between display updates, so values change at
+    /// a rate people can read.
+    public: std::chrono::steady_clock::duration displayPeriod{
+        std::chrono::milliseconds(100)};
+
+    /// \brief Last time the display was updated
+    public: std::chrono::steady_clock::time_point lastDisplayTime;
+
+    /// \brief Entity displayed on the last update
+    public: Entity displayedEntity{kNullEntity};
   };
 }
 
 using namespace ignition;
 using namespace gazebo;
 
+//////////////////////////////////////////////////
+/// \brief Get the identifier of a role, without building the role names on
+/// every call.
+/// \param[in] _name Role name, see ComponentsModel::RoleNames.
+/// \return Role identifier.
+static int roleId(const QByteArray &_name)
+{
+  static const QHash<int, QByteArray> kRoles = ComponentsModel::RoleNames();
+  return kRoles.key(_name);
+}
+
+//////////////////////////////////////////////////
+/// \brief Set an item's data for a role, unless it already holds that
+/// value, so views are only notified of actual changes.
+/// \param[in] _item Item whose data will be set.
+/// \param[in] _value Value to set.
+/// \param[in] _role Role of the value.
+static void setRoleData(QStandardItem *_item, const QVariant &_value,
+    int _role)
+{
+  if (_item->data(_role) != _value)
+    _item->setData(_value, _role);
+}
+
 //////////////////////////////////////////////////
 template<>
 void ignition::gazebo::setData(QStandardItem *_item, const math::Pose3d &_data)
 {
-  _item->setData(QString("Pose3d"),
-      ComponentsModel::RoleNames().key("dataType"));
-  _item->setData(QList({
+  setRoleData(_item, QString("Pose3d"),
+      roleId("dataType"));
+  setRoleData(_item, QList({
     QVariant(_data.Pos().X()),
     QVariant(_data.Pos().Y()),
     QVariant(_data.Pos().Z()),
     QVariant(_data.Rot().Roll()),
     QVariant(_data.Rot().Pitch()),
     QVariant(_data.Rot().Yaw())
-  }), ComponentsModel::RoleNames().key("data"));
+  }), roleId("data"));
 }
 
 //////////////////////////////////////////////////
@@ -135,9 +171,9 @@ void ignition::gazebo::setData(QStandardItem *_item, const msgs::Light &_data)
     lightType = 2;
   }
 
-  _item->setData(QString("Light"),
-      ComponentsModel::RoleNames().key("dataType"));
-  _item->setData(QList({
+  setRoleData(_item, QString("Light"),
+      roleId("dataType"));
+  setRoleData(_item, QList({
     QVariant(_data.specular().r()),
     QVariant(_data.specular().g()),
     QVariant(_data.specular().b()),
@@ -158,7 +194,7 @@ void ignition::gazebo::setData(QStandardItem *_item, const msgs::Light &_data)
     QVariant(_data.spot_outer_angle()),
     QVariant(_data.spot_falloff()),
     QVariant(lightType)
-  }), ComponentsModel::RoleNames().key("data"));
+  }), roleId("data"));
 }
 
 //////////////////////////////////////////////////
@@ -166,23 +202,23 @@ template<>
 void ignition::gazebo::setData(QStandardItem *_item,
     const math::Vector3d &_data)
 {
-  _item->setData(QString("Vector3d"),
-      ComponentsModel::RoleNames().key("dataType"));
-  _item->setData(QList({
+  setRoleData(_item, QString("Vector3d"),
+      roleId("dataType"));
+  setRoleData(_item, QList({
     QVariant(_data.X()),
     QVariant(_data.Y()),
     QVariant(_data.Z())
-  }), ComponentsModel::RoleNames().key("data"));
+  }), roleId("data"));
 }
 
 //////////////////////////////////////////////////
 template<>
 void ignition::gazebo::setData(QStandardItem *_item, const std::string &_data)
 {
-  _item->setData(QString("String"),
-      ComponentsModel::RoleNames().key("dataType"));
-  _item->setData(QString::fromStdString(_data),
-      ComponentsModel::RoleNames().key("data"));
+  setRoleData(_item, QString("String"),
+      roleId("dataType"));
+  setRoleData(_item, QString::fromStdString(_data),
+      roleId("data"));
 }
 
 //////////////////////////////////////////////////
@@ -190,56 +226,56 @@ template<>
 void ignition::gazebo::setData(QStandardItem *_item,
     const std::ostringstream &_data)
 {
-  _item->setData(QString("Raw"),
-      ComponentsModel::RoleNames().key("dataType"));
-  _item->setData(QString::fromStdString(_data.str()),
-      ComponentsModel::RoleNames().key("data"));
+  setRoleData(_item, QString("Raw"),
+      roleId("dataType"));
+  setRoleData(_item, QString::fromStdString(_data.str()),
+      roleId("data"));
 }
 
 //////////////////////////////////////////////////
 template<>
 void ignition::gazebo::setData(QStandardItem *_item, const bool &_data)
 {
-  _item->setData(QString("Boolean"),
-      ComponentsModel::RoleNames().key("dataType"));
-  _item->setData(_data, ComponentsModel::RoleNames().key("data"));
+  setRoleData(_item, QString("Boolean"),
+      roleId("dataType"));
+  setRoleData(_item, _data, roleId("data"));
 }
 
 //////////////////////////////////////////////////
 template<>
 void ignition::gazebo::setData(QStandardItem *_item, const int &_data)
 {
-  _item->setData(QString("Integer"),
-      ComponentsModel::RoleNames().key("dataType"));
-  _item->setData(_data, ComponentsModel::RoleNames().key("data"));
+  setRoleData(_item, QString("Integer"),
+      roleId("dataType"));
+  setRoleData(_item, _data, roleId("data"));
 }
 
 //////////////////////////////////////////////////
 template<>
 void ignition::gazebo::setData(QStandardItem *_item, const double &_data)
 {
-  _item->setData(QString("Float"),
-      ComponentsModel::RoleNames().key("dataType"));
-  _item->setData(_data, ComponentsModel::RoleNames().key("data"));
+  setRoleData(_item, QString("Float"),
+      roleId("dataType"));
+  setRoleData(_item, _data, roleId("data"));
 }
 
 //////////////////////////////////////////////////
 template<>
 void ignition::gazebo::setData(QStandardItem *_item, const sdf::Physics &_data)
 {
-  _item->setData(QString("Physics"),
-      ComponentsModel::RoleNames().key("dataType"));
-  _item->setData(QList({
+  setRoleData(_item, QString("Physics"),
+      roleId("dataType"));
+  setRoleData(_item, QList({
     QVariant(_data.MaxStepSize()),
     QVariant(_data.RealTimeFactor())
-  }), ComponentsModel::RoleNames().key("data"));
+  }), roleId("data"));
 }
 
 //////////////////////////////////////////////////
 void ignition::gazebo::setUnit(QStandardItem *_item, const std::string &_unit)
 {
-  _item->setData(QString::fromStdString(_unit),
-      ComponentsModel::RoleNames().key("unit"));
+  setRoleData(_item, QString::fromStdString(_unit),
+      roleId("unit"));
 }
 
 /////////////////////////////////////////////////
@@ -337,11 +373,36 @@ ComponentInspector::ComponentInspector()
 ComponentInspector::~ComponentInspector() = default;
 
 /////////////////////////////////////////////////
-void ComponentInspector::LoadConfig(const tinyxml2::XMLElement *)
+void ComponentInspector::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
 {
   if (this->title.empty())
     this->title = "Component inspector";
 
+  if (_pluginElem)
+  {
+    if (auto elem = _pluginElem->FirstChildElement("refresh_rate"))
+    {
+      double rate = 0.0;
+      if (elem->QueryDoubleText(&rate) != tinyxml2::XML_SUCCESS ||
+          rate < 0.0)
+      {
+        ignerr << "Failed to parse <refresh_rate> value: "
+               << elem->GetText() << std::endl;
+      }
+      else if (rate == 0.0)
+      {
+        this->dataPtr->displayPeriod =
+            std::chrono::steady_clock::duration::zero();
+      }
+      else
+      {
+        this->dataPtr->displayPeriod =
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / rate));
+      }
+    }
+  }
+
   ignition::gui::App()->findChild<
       ignition::gui::MainWindow *>()->installEventFilter(this);
 
@@ -359,6 +420,17 @@ void ComponentInspector::Update(const UpdateInfo &,
   if (this->dataPtr->paused)
     return;
 
+  // Refresh right away when the entity changes, otherwise at the display
+  // rate
+  auto now = std::chrono::steady_clock::now();
+  if (this->dataPtr->entity == this->dataPtr->displayedEntity &&
+      now - this->dataPtr->lastDisplayTime < this->dataPtr->displayPeriod)
+  {
+    return;
+  }
+  this->dataPtr->lastDisplayTime = now;
+  this->dataPtr->displayedEntity = this->dataPtr->entity;
+
   auto componentTypes = _ecm.ComponentTypes(this->dataPtr->entity);
 
   // List all components
@@ -379,12 +451,17 @@ void ComponentInspector::Update(const UpdateInfo &,
       // check if entity is nested model
       auto parentComp = _ecm.Component<components::ParentEntity>(
            this->dataPtr->entity);
+      bool nestedModel{false};
       if (parentComp)
       {
         auto modelComp = _ecm.Component<components::Model>(parentComp->Data());
-        this->dataPtr->nestedModel = (modelComp);
+        nestedModel = (modelComp);
+      }
+      if (nestedModel != this->dataPtr->nestedModel)
+      {
+        this->dataPtr->nestedModel = nestedModel;
+        this->NestedModelChanged();
       }
-      this->NestedModelChanged();
 
       continue;
     }
@@ -455,9 +532,6 @@ void ComponentInspector::Update(const UpdateInfo &,
           Q_ARG(ignition::gazebo::ComponentTypeId, typeId));
     }
 
-    item->setData(QString::number(this->dataPtr->entity),
-                  ComponentsModel::RoleNames().key("entity"));
-
     if (nullptr == item)
     {
       ignerr << "Failed to get item for component type [" << typeId << "]"
@@ -465,6 +539,9 @@ void ComponentInspector::Update(const UpdateInfo &,
       continue;
     }
 
+    setRoleData(item, QString::number(this->dataPtr->entity),
+        roleId("entity"));
+
     // Populate component-specific data
     if (typeId == components::AngularAcceleration::typeId)
     {
@@ -750,6 +827,9 @@ QString ComponentInspector::Type() const
 /////////////////////////////////////////////////
 void ComponentInspector::SetType(const QString &_type)
 {
+  if (this->dataPtr->type == _type)
+    return;
+
   this->dataPtr->type = _type;
   this->TypeChanged();
 }
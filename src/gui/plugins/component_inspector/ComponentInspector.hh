@@ -157,7 +157,10 @@ namespace gazebo
   /// \brief Displays a tree view with all the entities in the world.
   ///
   /// ## Configuration
-  /// None
+  ///
+  /// * `<refresh_rate>`: Maximum number of times per second the displayed
+  ///   values are refreshed. 0 refreshes on every update. Defaults to 10.
+  ///   Selecting another entity refreshes right away.
   class ComponentInspector : public gazebo::GuiSystem
   {
     Q_OBJECT
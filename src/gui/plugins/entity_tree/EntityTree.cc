@@ -17,7 +17,12 @@
 
 #include "EntityTree.hh"
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <utility>
 #include <vector>
 
 #include <ignition/common/Console.hh>
@@ -60,6 +65,12 @@ namespace ignition::gazebo
 using namespace ignition;
 using namespace gazebo;
 
+/// \brief Number of top level entities given items at a time.
+static const std::size_t kFetchBatch{500};
+
+/// \brief Maximum number of entities shown while filtering.
+static const std::size_t kMaxFilterResults{1000};
+
 //////////////////////////////////////////////////
 QString entityType(Entity _entity,
     const EntityComponentManager &_ecm)
@@ -98,88 +109,201 @@ QString entityType(Entity _entity,
 }
 
 /////////////////////////////////////////////////
-TreeModel::TreeModel() : QStandardItemModel()
+TreeModel::TreeModel() : QStandardItemModel(), rootLimit(kFetchBatch)
 {
 }
 
 /////////////////////////////////////////////////
-void TreeModel::AddEntity(unsigned int _entity, const QString &_entityName,
-    unsigned int _parentEntity, const QString &_type)
+bool TreeModel::hasChildren(const QModelIndex &_parent) const
 {
-  IGN_PROFILE_THREAD_NAME("Qt thread");
-  IGN_PROFILE("TreeModel::AddEntity");
-  QStandardItem *parentItem{nullptr};
+  // Entities may have children which don't have items yet
+  if (!this->filter.isEmpty() || !_parent.isValid())
+    return QStandardItemModel::hasChildren(_parent);
+
+  auto it = this->children.find(this->EntityId(_parent));
+  return it != this->children.end() && !it->second.empty();
+}
 
-  // Root
-  if (_parentEntity == kNullEntity)
+/////////////////////////////////////////////////
+bool TreeModel::canFetchMore(const QModelIndex &_parent) const
+{
+  if (!this->filter.isEmpty())
+    return false;
+
+  auto it = this->children.find(this->EntityId(_parent));
+  if (it == this->children.end())
+    return false;
+
+  auto item = _parent.isValid() ? this->itemFromIndex(_parent) :
+      this->invisibleRootItem();
+  return nullptr != item &&
+      static_cast<std::size_t>(item->rowCount()) < it->second.size();
+}
+
+/////////////////////////////////////////////////
+void TreeModel::fetchMore(const QModelIndex &_parent)
+{
+  if (!this->canFetchMore(_parent))
+    return;
+
+  if (!_parent.isValid())
   {
-    parentItem = this->invisibleRootItem();
+    this->FetchMoreRoots();
+    return;
   }
 
-  // Nested
-  // TODO(louise) There should be a way to easily access these from
-  // QStandardItemModel instead of keeping our own map
-  auto item = this->entityItems.find(_parentEntity);
-  if (item != this->entityItems.end())
+  // Expanded entities get all their children at once
+  auto entity = this->EntityId(_parent);
+  this->FetchChildren(entity, std::numeric_limits<std::size_t>::max());
+  this->fetched.insert(entity);
+}
+
+/////////////////////////////////////////////////
+void TreeModel::FetchMoreRoots()
+{
+  if (!this->filter.isEmpty())
+    return;
+
+  const auto rows = static_cast<std::size_t>(this->rowCount());
+  this->rootLimit = std::max(this->rootLimit, rows) + kFetchBatch;
+  this->FetchChildren(kNullEntity, this->rootLimit - rows);
+}
+
+/////////////////////////////////////////////////
+void TreeModel::QueueChanges(std::vector<EntityInfo> &&_added,
+    std::vector<Entity> &&_removed)
+{
+  if (_added.empty() && _removed.empty())
+    return;
+
+  std::lock_guard<std::mutex> lock(this->queueMutex);
+  if (this->queuedAdded.empty())
+  {
+    this->queuedAdded = std::move(_added);
+  }
+  else
   {
-    parentItem = item->second;
+    this->queuedAdded.insert(this->queuedAdded.end(),
+        std::make_move_iterator(_added.begin()),
+        std::make_move_iterator(_added.end()));
   }
+  this->queuedRemoved.insert(this->queuedRemoved.end(), _removed.begin(),
+      _removed.end());
 
-  if (nullptr == parentItem)
+  if (!this->processScheduled)
   {
-    this->pendingEntities.push_back(
-      {_entity, _entityName, _parentEntity, _type});
-    return;
+    this->processScheduled = true;
+    QMetaObject::invokeMethod(this, "ProcessChanges", Qt::QueuedConnection);
   }
+}
 
-  // New entity item
-  auto entityItem = new QStandardItem(_entityName);
-  entityItem->setData(_entityName, this->roleNames().key("entityName"));
-  entityItem->setData(QString::number(_entity),
-      this->roleNames().key("entity"));
-  entityItem->setData(_type, this->roleNames().key("type"));
+/////////////////////////////////////////////////
+void TreeModel::ProcessChanges()
+{
+  IGN_PROFILE_THREAD_NAME("Qt thread");
+  IGN_PROFILE("TreeModel::ProcessChanges");
 
-  parentItem->appendRow(entityItem);
+  std::vector<EntityInfo> added;
+  std::vector<Entity> removed;
+  {
+    std::lock_guard<std::mutex> lock(this->queueMutex);
+    added.swap(this->queuedAdded);
+    removed.swap(this->queuedRemoved);
+    this->processScheduled = false;
+  }
 
-  this->entityItems[_entity] = entityItem;
+  // Entity IDs aren't reused, so removals can go after all additions
+  for (const auto &info : added)
+    this->AddEntity(info.entity, info.name, info.parentEntity, info.type);
 
-  // Check if there are pending children
-  auto sep = std::partition(this->pendingEntities.begin(),
-      this->pendingEntities.end(), [&_entity](const EntityInfo &_entityInfo)
-      {
-        return _entityInfo.parentEntity != _entity;
-      });
+  for (const auto &entity : removed)
+    this->RemoveEntity(entity);
+}
 
-  for (auto it = sep; it != this->pendingEntities.end(); ++it)
+/////////////////////////////////////////////////
+void TreeModel::AddEntity(unsigned int _entity, const QString &_entityName,
+    unsigned int _parentEntity, const QString &_type)
+{
+  IGN_PROFILE("TreeModel::AddEntity");
+  if (this->entities.find(_entity) != this->entities.end())
+    return;
+
+  EntityInfo info{_entity, _entityName, _parentEntity, _type};
+  this->entities[_entity] = info;
+  auto &siblings = this->children[_parentEntity];
+  siblings.insert(_entity);
+
+  if (!this->filter.isEmpty())
   {
-    this->AddEntity(it->entity, it->name, it->parentEntity, it->type);
+    if (_entityName.contains(this->filter, Qt::CaseInsensitive))
+      this->ShowWithAncestors(_entity);
+    return;
+  }
+
+  // The parent isn't visible, or isn't known yet. If it shows up later, this
+  // entity will be created when the parent is expanded.
+  auto parentItem = this->ParentItem(_parentEntity);
+  if (nullptr == parentItem)
+    return;
+
+  // Only append to parents whose children all have items, otherwise the
+  // entity is created together with its siblings when they're fetched
+  const auto rows = static_cast<std::size_t>(parentItem->rowCount());
+  const bool allFetched = _parentEntity == kNullEntity ?
+      rows + 1 == siblings.size() && rows < this->rootLimit :
+      this->fetched.find(_parentEntity) != this->fetched.end();
+  if (allFetched)
+  {
+    auto item = this->CreateItem(info);
+    parentItem->appendRow(item);
+    this->entityItems[_entity] = item;
+  }
+  // The parent may need to show that it now has children
+  else if (_parentEntity != kNullEntity && siblings.size() == 1)
+  {
+    auto index = parentItem->index();
+    emit this->dataChanged(index, index);
   }
-  this->pendingEntities.erase(sep, this->pendingEntities.end());
 }
 
 /////////////////////////////////////////////////
 void TreeModel::RemoveEntity(unsigned int _entity)
 {
   IGN_PROFILE("TreeModel::RemoveEntity");
-  QStandardItem *item{nullptr};
-  auto itemIt = this->entityItems.find(_entity);
-  if (itemIt != this->entityItems.end())
+
+  // Its descendants may have been removed with an ancestor
+  auto infoIt = this->entities.find(_entity);
+  if (infoIt == this->entities.end())
+    return;
+  const Entity parentEntity = infoIt->second.parentEntity;
+
+  // Forget the entity and all its descendants
+  std::function<void(Entity)> forget = [&](Entity _e)
   {
-    item = itemIt->second;
-  }
+    auto childrenIt = this->children.find(_e);
+    if (childrenIt != this->children.end())
+    {
+      for (const auto &child : childrenIt->second)
+        forget(child);
+      this->children.erase(childrenIt);
+    }
+    this->entities.erase(_e);
+    this->fetched.erase(_e);
+  };
+  forget(_entity);
 
-  if (nullptr == item)
+  auto siblingsIt = this->children.find(parentEntity);
+  if (siblingsIt != this->children.end())
   {
-    // See if it's pending
-    auto toRemove = std::remove_if(this->pendingEntities.begin(),
-        this->pendingEntities.end(), [&_entity](const EntityInfo &_entityInfo)
-        {
-          return _entityInfo.entity == _entity;
-        });
-    this->pendingEntities.erase(toRemove, this->pendingEntities.end());
+    siblingsIt->second.erase(_entity);
+    if (siblingsIt->second.empty())
+      this->children.erase(siblingsIt);
+  }
 
+  auto itemIt = this->entityItems.find(_entity);
+  if (itemIt == this->entityItems.end())
     return;
-  }
+  QStandardItem *item = itemIt->second;
 
   // Remove all children from our custom map
   std::function<void(const QStandardItem *)> removeChildren =
@@ -193,7 +317,7 @@ void TreeModel::RemoveEntity(unsigned int _entity)
           this->roleNames().key("entity")).toUInt());
     }
   };
-  this->entityItems.erase(_entity);
+  this->entityItems.erase(itemIt);
   removeChildren(item);
 
   // Remove from the view
@@ -203,6 +327,168 @@ void TreeModel::RemoveEntity(unsigned int _entity)
     item->parent()->removeRow(item->row());
 }
 
+/////////////////////////////////////////////////
+void TreeModel::SetFilter(const QString &_filter)
+{
+  const auto filterTrimmed = _filter.trimmed();
+  if (filterTrimmed == this->filter)
+    return;
+
+  this->filter = filterTrimmed;
+  this->ApplyFilter();
+}
+
+/////////////////////////////////////////////////
+void TreeModel::ApplyFilter()
+{
+  IGN_PROFILE("TreeModel::ApplyFilter");
+  this->removeRows(0, this->rowCount());
+  this->entityItems.clear();
+  this->fetched.clear();
+
+  if (this->filter.isEmpty())
+  {
+    this->rootLimit = kFetchBatch;
+    this->FetchChildren(kNullEntity, this->rootLimit);
+    return;
+  }
+
+  std::size_t count{0};
+  for (const auto &[entity, info] : this->entities)
+  {
+    if (!info.name.contains(this->filter, Qt::CaseInsensitive))
+      continue;
+
+    if (count++ >= kMaxFilterResults)
+    {
+      ignwarn << "More than [" << kMaxFilterResults << "] entities match ["
+              << this->filter.toStdString() << "], only showing the first "
+              << "ones." << std::endl;
+      break;
+    }
+    this->ShowWithAncestors(entity);
+  }
+}
+
+/////////////////////////////////////////////////
+QStandardItem *TreeModel::ShowWithAncestors(Entity _entity)
+{
+  auto itemIt = this->entityItems.find(_entity);
+  if (itemIt != this->entityItems.end())
+    return itemIt->second;
+
+  auto infoIt = this->entities.find(_entity);
+  if (infoIt == this->entities.end())
+    return nullptr;
+
+  const auto &info = infoIt->second;
+  auto parentItem = info.parentEntity == kNullEntity ?
+      this->invisibleRootItem() : this->ShowWithAncestors(info.parentEntity);
+  if (nullptr == parentItem)
+    return nullptr;
+
+  auto item = this->CreateItem(info);
+  parentItem->appendRow(item);
+  this->entityItems[_entity] = item;
+  return item;
+}
+
+/////////////////////////////////////////////////
+QModelIndex TreeModel::IndexOf(unsigned int _entity)
+{
+  if (this->filter.isEmpty())
+  {
+    // Ancestors, from the entity up to a top level entity
+    std::vector<Entity> ancestors;
+    for (Entity entity = _entity; entity != kNullEntity;)
+    {
+      auto infoIt = this->entities.find(entity);
+      if (infoIt == this->entities.end())
+        return QModelIndex();
+      ancestors.push_back(entity);
+      entity = infoIt->second.parentEntity;
+    }
+
+    // Make sure each of them has an item, from the top
+    for (auto it = ancestors.rbegin(); it != ancestors.rend(); ++it)
+    {
+      if (this->entityItems.find(*it) != this->entityItems.end())
+        continue;
+
+      const auto &info = this->entities.at(*it);
+      if (info.parentEntity == kNullEntity)
+      {
+        // Top level entity which hasn't been reached by scrolling yet
+        auto item = this->CreateItem(info);
+        this->invisibleRootItem()->appendRow(item);
+        this->entityItems[*it] = item;
+      }
+      else
+      {
+        this->FetchChildren(info.parentEntity,
+            std::numeric_limits<std::size_t>::max());
+        this->fetched.insert(info.parentEntity);
+      }
+    }
+  }
+
+  auto itemIt = this->entityItems.find(_entity);
+  if (itemIt == this->entityItems.end())
+    return QModelIndex();
+  return itemIt->second->index();
+}
+
+/////////////////////////////////////////////////
+QStandardItem *TreeModel::CreateItem(const EntityInfo &_info) const
+{
+  auto entityItem = new QStandardItem(_info.name);
+  entityItem->setData(_info.name, this->roleNames().key("entityName"));
+  entityItem->setData(QString::number(_info.entity),
+      this->roleNames().key("entity"));
+  entityItem->setData(_info.type, this->roleNames().key("type"));
+  return entityItem;
+}
+
+/////////////////////////////////////////////////
+void TreeModel::FetchChildren(Entity _parent, std::size_t _max)
+{
+  IGN_PROFILE("TreeModel::FetchChildren");
+  auto parentItem = this->ParentItem(_parent);
+  auto childrenIt = this->children.find(_parent);
+  if (nullptr == parentItem || childrenIt == this->children.end())
+    return;
+
+  // Append them all at once, so the view only updates once
+  QList<QStandardItem *> items;
+  for (const auto &child : childrenIt->second)
+  {
+    if (static_cast<std::size_t>(items.size()) >= _max)
+      break;
+
+    if (this->entityItems.find(child) != this->entityItems.end())
+      continue;
+
+    auto item = this->CreateItem(this->entities.at(child));
+    this->entityItems[child] = item;
+    items.append(item);
+  }
+
+  if (!items.empty())
+    parentItem->appendRows(items);
+}
+
+/////////////////////////////////////////////////
+QStandardItem *TreeModel::ParentItem(Entity _parent) const
+{
+  if (_parent == kNullEntity)
+    return this->invisibleRootItem();
+
+  auto it = this->entityItems.find(_parent);
+  if (it == this->entityItems.end())
+    return nullptr;
+  return it->second;
+}
+
 /////////////////////////////////////////////////
 QString TreeModel::EntityType(const QModelIndex &_index) const
 {
@@ -288,6 +574,11 @@ void EntityTree::LoadConfig(const tinyxml2::XMLElement *)
 void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
 {
   IGN_PROFILE("EntityTree::Update");
+
+  // Changes are given to the model in a single batch
+  std::vector<TreeModel::EntityInfo> added;
+  std::vector<Entity> removed;
+
   // Treat all pre-existent entities as new at startup
   if (!this->dataPtr->initialized)
   {
@@ -320,17 +611,19 @@ void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
         parentEntity = kNullEntity;
       }
 
-      QMetaObject::invokeMethod(&this->dataPtr->treeModel, "AddEntity",
-          Qt::QueuedConnection,
-          Q_ARG(unsigned int, _entity),
-          Q_ARG(QString, QString::fromStdString(_name->Data())),
-          Q_ARG(unsigned int, parentEntity),
-          Q_ARG(QString, entityType(_entity, _ecm)));
+      added.push_back({_entity, QString::fromStdString(_name->Data()),
+          parentEntity, entityType(_entity, _ecm)});
       return true;
     });
 
     if (this->dataPtr->worldEntity != kNullEntity)
+    {
       this->dataPtr->initialized = true;
+
+      // From now on, only new and removed entities matter
+      this->SubscribeToChanges({components::Name::typeId,
+          components::ParentEntity::typeId});
+    }
   }
   else
   {
@@ -350,12 +643,8 @@ void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
         parentEntity = kNullEntity;
       }
 
-      QMetaObject::invokeMethod(&this->dataPtr->treeModel, "AddEntity",
-          Qt::QueuedConnection,
-          Q_ARG(unsigned int, _entity),
-          Q_ARG(QString, QString::fromStdString(_name->Data())),
-          Q_ARG(unsigned int, parentEntity),
-          Q_ARG(QString, entityType(_entity, _ecm)));
+      added.push_back({_entity, QString::fromStdString(_name->Data()),
+          parentEntity, entityType(_entity, _ecm)});
       return true;
     });
   }
@@ -364,11 +653,11 @@ void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
     [&](const Entity &_entity,
         const components::Name *)->bool
   {
-    QMetaObject::invokeMethod(&this->dataPtr->treeModel, "RemoveEntity",
-        Qt::QueuedConnection,
-        Q_ARG(unsigned int, _entity));
+    removed.push_back(_entity);
     return true;
   });
+
+  this->dataPtr->treeModel.QueueChanges(std::move(added), std::move(removed));
 }
 
 /////////////////////////////////////////////////
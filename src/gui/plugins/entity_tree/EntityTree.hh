@@ -20,6 +20,8 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <vector>
 
 #include <ignition/gazebo/gui/GuiSystem.hh>
@@ -30,11 +32,35 @@ namespace gazebo
 {
   class EntityTreePrivate;
 
-  /// \brief TODO
+  /// \brief Tree model of the entities in the world, which only holds items
+  /// for what can be seen.
+  ///
+  /// All entities are indexed, but items are only created for top level
+  /// entities, a batch at a time as the view scrolls down, and for the
+  /// children of entities which have been expanded. When a filter is set,
+  /// only matching entities and their ancestors have items.
   class TreeModel : public QStandardItemModel
   {
     Q_OBJECT
 
+    /// \brief Entity information used to index entities
+    public: struct EntityInfo
+    {
+      /// \brief Entity ID
+      // cppcheck-suppress unusedStructMember
+      unsigned int entity;
+
+      /// \brief Entity name
+      QString name;
+
+      /// \brief Parent ID
+      // cppcheck-suppress unusedStructMember
+      unsigned int parentEntity;
+
+      /// \brief Entity type
+      QString type;
+    };
+
     /// \brief Constructor
     public: explicit TreeModel();
 
@@ -44,6 +70,26 @@ namespace gazebo
     // Documentation inherited
     public: QHash<int, QByteArray> roleNames() const override;
 
+    // Documentation inherited
+    public: bool hasChildren(
+        const QModelIndex &_parent = QModelIndex()) const override;
+
+    // Documentation inherited
+    public: bool canFetchMore(const QModelIndex &_parent) const override;
+
+    // Documentation inherited
+    public: void fetchMore(const QModelIndex &_parent) override;
+
+    /// \brief Queue entities to be added and removed. They're processed
+    /// together on the Qt thread. This can be called from any thread.
+    /// \param[in] _added Entities to add.
+    /// \param[in] _removed Entities to remove.
+    public: void QueueChanges(std::vector<EntityInfo> &&_added,
+        std::vector<Entity> &&_removed);
+
+    /// \brief Process the queued changes.
+    public slots: void ProcessChanges();
+
     /// \brief Add an entity to the tree.
     /// \param[in] _entity Entity to be added
     /// \param[in] _entityName Name of entity to be added
@@ -59,6 +105,22 @@ namespace gazebo
     /// \param[in] _entity Entity to be removed
     public slots: void RemoveEntity(unsigned int _entity);
 
+    /// \brief Only show entities whose name contains the given text, and
+    /// their ancestors.
+    /// \param[in] _filter Text to look for, case insensitive. Empty to show
+    /// all entities.
+    public: Q_INVOKABLE void SetFilter(const QString &_filter);
+
+    /// \brief Load the next batch of top level entities, if any.
+    public: Q_INVOKABLE void FetchMoreRoots();
+
+    /// \brief Get the index of an entity, creating the items of its
+    /// ancestors' children if needed.
+    /// \param[in] _entity Entity ID
+    /// \return Model index, invalid if the entity isn't in the tree or is
+    /// filtered out.
+    public: Q_INVOKABLE QModelIndex IndexOf(unsigned int _entity);
+
     /// \brief Get the entity type of a tree item at specified index
     /// \param[in] _index Model index
     /// \return Type of entity
@@ -74,30 +136,64 @@ namespace gazebo
     /// \return Entity ID
     public: Q_INVOKABLE unsigned int EntityId(const QModelIndex &_index) const;
 
+    /// \brief Create an item for an entity, without adding it to the model.
+    /// \param[in] _info Entity to create the item for.
+    /// \return The new item.
+    private: QStandardItem *CreateItem(const EntityInfo &_info) const;
+
+    /// \brief Create items for the children of an entity which don't have
+    /// one yet.
+    /// \param[in] _parent Parent entity, kNullEntity for top level entities.
+    /// \param[in] _max Maximum number of items to create.
+    private: void FetchChildren(Entity _parent, std::size_t _max);
+
+    /// \brief Recreate all items for the current filter.
+    private: void ApplyFilter();
+
+    /// \brief Create items for an entity and all its ancestors, if they
+    /// don't have one yet. Used while filtering.
+    /// \param[in] _entity Entity.
+    /// \return The entity's item, or null if an ancestor isn't known yet.
+    private: QStandardItem *ShowWithAncestors(Entity _entity);
+
+    /// \brief Get the item of an entity's parent, or the root item for top
+    /// level entities.
+    /// \param[in] _parent Parent entity.
+    /// \return Item, or null if the parent doesn't have one.
+    private: QStandardItem *ParentItem(Entity _parent) const;
+
+    /// \brief All the entities in the tree, including those without items.
+    private: std::map<Entity, EntityInfo> entities;
+
+    /// \brief Children of each entity. Top level entities are the children of
+    /// kNullEntity. Children may show up before their parents.
+    private: std::map<Entity, std::set<Entity>> children;
+
     /// \brief Keep track of which item corresponds to which entity.
     private: std::map<Entity, QStandardItem *> entityItems;
 
-    /// \brief Entity information used to queue the pending entities
-    struct EntityInfo
-    {
-      /// \brief Entity ID
-      // cppcheck-suppress unusedStructMember
-      unsigned int entity;
+    /// \brief Entities whose children all have items, because they've been
+    /// expanded.
+    private: std::set<Entity> fetched;
 
-      /// \brief Entity name
-      QString name;
+    /// \brief Maximum number of top level items, raised as the view scrolls
+    /// down.
+    private: std::size_t rootLimit;
 
-      /// \brief Parent ID
-      // cppcheck-suppress unusedStructMember
-      unsigned int parentEntity;
+    /// \brief Current filter, empty if none.
+    private: QString filter;
 
-      /// \brief Entity type
-      QString type;
-    };
+    /// \brief Protects the queued changes.
+    private: std::mutex queueMutex;
+
+    /// \brief Entities waiting to be added.
+    private: std::vector<EntityInfo> queuedAdded;
+
+    /// \brief Entities waiting to be removed.
+    private: std::vector<Entity> queuedRemoved;
 
-    /// \brief If an entity is added before its parent, we queue it in this
-    /// vector until their parent shows up or they are deleted.
-    private: std::vector<EntityInfo> pendingEntities;
+    /// \brief Whether ProcessChanges has been scheduled.
+    private: bool processScheduled{false};
   };
 
   /// \brief Displays a tree view with all the entities in the world.
@@ -62,33 +62,41 @@ Rectangle {
   }
 
   /*
-   * Iterate through item's children until the one corresponding to _entity is
-   * found and select that.
+   * Callback when an entity selection comes from the C++ code.
+   * For example, if it comes from the 3D window.
+   * The model creates the entity's item if it hasn't been loaded yet.
    */
-  function selectFromCpp(_entity, itemId) {
-    if (EntityTreeModel.data(itemId, 101) == _entity) {
+  function onEntitySelectedFromCpp(_entity) {
+    var itemId = EntityTreeModel.IndexOf(_entity)
+    if (itemId.valid)
       tree.selection.select(itemId, ItemSelectionModel.Select)
-      return
-    }
-    for (var i = 0; i < EntityTreeModel.rowCount(itemId); i++) {
-      selectFromCpp(_entity, EntityTreeModel.index(i, 0, itemId))
-    }
   }
 
-  /*
-   * Callback when an entity selection comes from the C++ code.
-   * For example, if it comes from the 3D window.
+  TextField {
+    id: searchField
+    anchors.top: parent.top
+    anchors.left: parent.left
+    anchors.right: parent.right
+    placeholderText: "Search entities"
+    selectByMouse: true
+    onTextChanged: searchTimer.restart()
+  }
+
+  /**
+   * Don't filter on every keystroke
    */
-  function onEntitySelectedFromCpp(_entity) {
-    for(var i = 0; i < EntityTreeModel.rowCount(); i++) {
-      var itemId = EntityTreeModel.index(i, 0)
-      selectFromCpp(_entity, itemId)
-    }
+  Timer {
+    id: searchTimer
+    interval: 300
+    onTriggered: EntityTreeModel.SetFilter(searchField.text)
   }
 
   TreeView {
     id: tree
-    anchors.fill: parent
+    anchors.top: searchField.bottom
+    anchors.left: parent.left
+    anchors.right: parent.right
+    anchors.bottom: parent.bottom
     model: EntityTreeModel
     selectionMode: SelectionMode.MultiSelection
 
@@ -100,6 +108,15 @@ Rectangle {
       tree.__listView.parent.children[1].color = Material.background
     }
 
+    // Top level entities are loaded in batches as the view scrolls down
+    Connections {
+      target: tree.__listView
+      onAtYEndChanged: {
+        if (tree.__listView.atYEnd)
+          EntityTreeModel.FetchMoreRoots()
+      }
+    }
+
     selection: ItemSelectionModel {
       model: EntityTreeModel
     }
@@ -32,6 +32,28 @@ Rectangle {
   // Horizontal margins
   property int margin: 15
 
+  // Name reported as visible, kept since the model may be gone on destruction
+  property string shownName: ""
+
+  // Delegates only exist for rows in view. The name may be set after the
+  // row is added.
+  property string jointName: model.name !== undefined ? model.name : ""
+
+  function updateShownName() {
+    if (joint.shownName !== "")
+      jointPositionController.onJointVisible(joint.shownName, false);
+    joint.shownName = joint.jointName;
+    if (joint.shownName !== "")
+      jointPositionController.onJointVisible(joint.shownName, true);
+  }
+
+  onJointNameChanged: updateShownName()
+  Component.onCompleted: updateShownName()
+  Component.onDestruction: {
+    if (joint.shownName !== "")
+      jointPositionController.onJointVisible(joint.shownName, false);
+  }
+
   Connections {
     target: joint
     onTargetValueChanged: {
@@ -16,7 +16,12 @@
 */
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <ignition/common/Console.hh>
 #include <ignition/common/Profiler.hh>
 #include <ignition/gui/Application.hh>
@@ -40,8 +45,27 @@
 
 namespace ignition::gazebo::gui
 {
+  /// \brief Joint listed by the plugin.
+  struct JointInfo
+  {
+    /// \brief Item holding the joint's data.
+    QStandardItem *item{nullptr};
+
+    /// \brief Joint name.
+    std::string name;
+
+    /// \brief Position last set on the item.
+    double value{0.0};
+
+    /// \brief Whether the position was ever set on the item.
+    bool valueSet{false};
+  };
+
   class JointPositionControllerPrivate
   {
+    /// \brief Publish the pending commands.
+    public: void PublishCommands();
+
     /// \brief Model holding all the joints.
     public: JointsModel jointsModel;
 
@@ -59,6 +83,41 @@ namespace ignition::gazebo::gui
 
     /// \brief Whether the initial model set from XML has been setup.
     public: bool xmlModelInitialized{true};
+
+    /// \brief Model whose joints are listed.
+    public: Entity jointsModelEntity{kNullEntity};
+
+    /// \brief Joints listed, by joint entity. Only used in Update.
+    public: std::map<Entity, JointInfo> joints;
+
+    /// \brief Minimum time between refreshes of the joint positions.
+    public: std::chrono::steady_clock::duration refreshPeriod{
+        std::chrono::milliseconds(50)};
+
+    /// \brief Last time the joint positions were refreshed.
+    public: std::chrono::steady_clock::time_point lastRefreshTime;
+
+    /// \brief Protects visibleJoints.
+    public: std::mutex visibleMutex;
+
+    /// \brief Names of the joints which have a delegate in the list. The
+    /// list only creates delegates for the rows on screen, so the others
+    /// don't need to be refreshed.
+    public: std::unordered_set<std::string> visibleJoints;
+
+    /// \brief Latest position requested for each joint since commands were
+    /// last published, by joint name. Only used in the Qt thread.
+    public: std::map<std::string, double> pendingCommands;
+
+    /// \brief Whether publishing the pending commands is scheduled.
+    public: bool commandsScheduled{false};
+
+    /// \brief Minimum time between commands to the same joint.
+    public: std::chrono::milliseconds commandPeriod{50};
+
+    /// \brief Publishers of position commands, by topic.
+    public: std::unordered_map<std::string, transport::Node::Publisher>
+        commandPubs;
   };
 }
 
@@ -160,6 +219,49 @@ void JointPositionController::LoadConfig(
       // If model name isn't set, initialization is not complete yet.
       this->dataPtr->xmlModelInitialized = false;
     }
+
+    if (auto elem = _pluginElem->FirstChildElement("refresh_rate"))
+    {
+      double rate = 0.0;
+      if (elem->QueryDoubleText(&rate) != tinyxml2::XML_SUCCESS ||
+          rate < 0.0)
+      {
+        ignerr << "Failed to parse <refresh_rate> value: "
+               << elem->GetText() << std::endl;
+      }
+      else if (rate == 0.0)
+      {
+        this->dataPtr->refreshPeriod =
+            std::chrono::steady_clock::duration::zero();
+      }
+      else
+      {
+        this->dataPtr->refreshPeriod =
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / rate));
+      }
+    }
+
+    if (auto elem = _pluginElem->FirstChildElement("command_rate"))
+    {
+      double rate = 0.0;
+      if (elem->QueryDoubleText(&rate) != tinyxml2::XML_SUCCESS ||
+          rate < 0.0)
+      {
+        ignerr << "Failed to parse <command_rate> value: "
+               << elem->GetText() << std::endl;
+      }
+      else if (rate == 0.0)
+      {
+        this->dataPtr->commandPeriod = std::chrono::milliseconds::zero();
+      }
+      else
+      {
+        this->dataPtr->commandPeriod =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::duration<double>(1.0 / rate));
+      }
+    }
   }
 
   ignition::gui::App()->findChild<
@@ -200,19 +302,76 @@ void JointPositionController::Update(const UpdateInfo &,
     QMetaObject::invokeMethod(&this->dataPtr->jointsModel,
         "Clear",
         Qt::QueuedConnection);
+    this->dataPtr->joints.clear();
+    this->dataPtr->jointsModelEntity = kNullEntity;
     this->SetModelName("No model selected");
     this->SetLocked(false);
     return;
   }
 
-  this->SetModelName(QString::fromStdString(
+  auto modelName = QString::fromStdString(
       _ecm.ComponentData<components::Name>(
-      this->dataPtr->modelEntity).value()));
+      this->dataPtr->modelEntity).value());
+  if (modelName != this->dataPtr->modelName)
+    this->SetModelName(modelName);
+
+  // The joints only need to be listed again when the model or the entities
+  // change
+  bool listJoints = this->dataPtr->jointsModelEntity !=
+      this->dataPtr->modelEntity || _ecm.HasNewEntities() ||
+      _ecm.HasEntitiesMarkedForRemoval();
+
+  // Positions are refreshed at the display rate, which may be much lower
+  // than the rate state is received at
+  auto now = std::chrono::steady_clock::now();
+  if (!listJoints &&
+      now - this->dataPtr->lastRefreshTime < this->dataPtr->refreshPeriod)
+  {
+    return;
+  }
+  this->dataPtr->lastRefreshTime = now;
+
+  if (listJoints)
+    this->ListJoints(_ecm);
+
+  // Only set positions which changed on joints which are displayed, since
+  // each of them makes the list update its delegate. Joints are always
+  // given their first position, and hidden ones are caught up once shown.
+  static const int kValueRole = JointsModel::RoleNames().key("value");
+  std::lock_guard<std::mutex> lock(this->dataPtr->visibleMutex);
+  for (auto &[jointEntity, joint] : this->dataPtr->joints)
+  {
+    if (joint.valueSet && !this->dataPtr->visibleJoints.count(joint.name))
+      continue;
+
+    double value = 0.0;
+    auto posComp = _ecm.Component<components::JointPosition>(jointEntity);
+    if (posComp && !posComp->Data().empty())
+    {
+      value = posComp->Data()[0];
+    }
+
+    if (joint.valueSet && joint.value == value)
+      continue;
+
+    joint.item->setData(value, kValueRole);
+    joint.value = value;
+    joint.valueSet = true;
+  }
+}
+
+//////////////////////////////////////////////////
+void JointPositionController::ListJoints(const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("JointPositionController::ListJoints");
+
+  this->dataPtr->jointsModelEntity = this->dataPtr->modelEntity;
 
   auto jointEntities = _ecm.EntitiesByComponents(components::Joint(),
       components::ParentEntity(this->dataPtr->modelEntity));
 
   // List all joints
+  std::unordered_set<Entity> listed;
   for (const auto &jointEntity : jointEntities)
   {
     auto typeComp = _ecm.Component<components::JointType>(jointEntity);
@@ -229,25 +388,18 @@ void JointPositionController::Update(const UpdateInfo &,
       continue;
     }
 
-    // Get joint item
-    bool newItem{false};
-    QStandardItem *item;
-    auto itemIt = this->dataPtr->jointsModel.items.find(jointEntity);
-    if (itemIt != this->dataPtr->jointsModel.items.end())
-    {
-      item = itemIt->second;
-    }
+    listed.insert(jointEntity);
+    if (this->dataPtr->joints.count(jointEntity))
+      continue;
+
     // Add joint to list
-    else
-    {
-      // TODO(louise) Blocking here is not the best idea
-      QMetaObject::invokeMethod(&this->dataPtr->jointsModel,
-          "AddJoint",
-          Qt::BlockingQueuedConnection,
-          Q_RETURN_ARG(QStandardItem *, item),
-          Q_ARG(Entity, jointEntity));
-      newItem = true;
-    }
+    // TODO(louise) Blocking here is not the best idea
+    QStandardItem *item{nullptr};
+    QMetaObject::invokeMethod(&this->dataPtr->jointsModel,
+        "AddJoint",
+        Qt::BlockingQueuedConnection,
+        Q_RETURN_ARG(QStandardItem *, item),
+        Q_ARG(Entity, jointEntity));
 
     if (nullptr == item)
     {
@@ -256,43 +408,36 @@ void JointPositionController::Update(const UpdateInfo &,
       continue;
     }
 
-    if (newItem)
-    {
-      // Name
-      auto name = _ecm.ComponentData<components::Name>(jointEntity).value();
-      item->setData(QString::fromStdString(name),
-          JointsModel::RoleNames().key("name"));
-
-      // Limits
-      double min = -IGN_PI;
-      double max = IGN_PI;
-      auto axisComp = _ecm.Component<components::JointAxis>(jointEntity);
-      if (axisComp)
-      {
-        min = axisComp->Data().Lower();
-        max = axisComp->Data().Upper();
-      }
-      item->setData(min, JointsModel::RoleNames().key("min"));
-      item->setData(max, JointsModel::RoleNames().key("max"));
-    }
+    // Name
+    auto name = _ecm.ComponentData<components::Name>(jointEntity).value();
+    item->setData(QString::fromStdString(name),
+        JointsModel::RoleNames().key("name"));
 
-    // Value
-    double value = 0.0;
-    auto posComp = _ecm.Component<components::JointPosition>(jointEntity);
-    if (posComp)
+    // Limits
+    double min = -IGN_PI;
+    double max = IGN_PI;
+    auto axisComp = _ecm.Component<components::JointAxis>(jointEntity);
+    if (axisComp)
     {
-      value = posComp->Data()[0];
+      min = axisComp->Data().Lower();
+      max = axisComp->Data().Upper();
     }
-    item->setData(value, JointsModel::RoleNames().key("value"));
+    item->setData(min, JointsModel::RoleNames().key("min"));
+    item->setData(max, JointsModel::RoleNames().key("max"));
+
+    JointInfo joint;
+    joint.item = item;
+    joint.name = name;
+    this->dataPtr->joints[jointEntity] = joint;
   }
 
-  // Remove joints no longer present
+  // Remove joints no longer present, including those of the previous model
   for (auto itemIt : this->dataPtr->jointsModel.items)
   {
     auto jointEntity = itemIt.first;
-    if (std::find(jointEntities.begin(), jointEntities.end(), jointEntity) ==
-        jointEntities.end())
+    if (listed.count(jointEntity) == 0)
     {
+      this->dataPtr->joints.erase(jointEntity);
       QMetaObject::invokeMethod(&this->dataPtr->jointsModel,
           "RemoveJoint",
           Qt::QueuedConnection,
@@ -377,23 +522,25 @@ void JointPositionController::SetLocked(bool _locked)
 /////////////////////////////////////////////////
 void JointPositionController::OnCommand(const QString &_jointName, double _pos)
 {
-  std::string jointName = _jointName.toStdString();
-
-  ignition::msgs::Double msg;
-  msg.set_data(_pos);
-  auto topic = transport::TopicUtils::AsValidTopic("/model/" +
-      this->dataPtr->modelName.toStdString() + "/joint/" + jointName +
-      "/0/cmd_pos");
+  // Sliders request a position on every move. Only the latest one for each
+  // joint is published, at most once per command period.
+  this->dataPtr->pendingCommands[_jointName.toStdString()] = _pos;
+  if (this->dataPtr->commandsScheduled)
+    return;
 
-  if (topic.empty())
+  if (this->dataPtr->commandPeriod.count() == 0)
   {
-    ignerr << "Failed to create valid topic for joint [" << jointName << "]"
-           << std::endl;
+    this->dataPtr->PublishCommands();
     return;
   }
 
-  auto pub = this->dataPtr->node.Advertise<ignition::msgs::Double>(topic);
-  pub.Publish(msg);
+  this->dataPtr->commandsScheduled = true;
+  QTimer::singleShot(static_cast<int>(this->dataPtr->commandPeriod.count()),
+      this, [this]
+      {
+        this->dataPtr->commandsScheduled = false;
+        this->dataPtr->PublishCommands();
+      });
 }
 
 /////////////////////////////////////////////////
@@ -408,23 +555,54 @@ void JointPositionController::OnReset()
       ignerr << "Internal error: failed to get joint name." << std::endl;
       continue;
     }
+    this->dataPtr->pendingCommands[jointName] = 0.0;
+  }
 
-    ignition::msgs::Double msg;
-    msg.set_data(0);
+  // Don't wait for the command period, so the reset isn't reordered with
+  // pending commands
+  this->dataPtr->PublishCommands();
+}
+
+/////////////////////////////////////////////////
+void JointPositionController::OnJointVisible(const QString &_jointName,
+    bool _visible)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->visibleMutex);
+  if (_visible)
+    this->dataPtr->visibleJoints.insert(_jointName.toStdString());
+  else
+    this->dataPtr->visibleJoints.erase(_jointName.toStdString());
+}
+
+/////////////////////////////////////////////////
+void JointPositionControllerPrivate::PublishCommands()
+{
+  for (const auto &[jointName, pos] : this->pendingCommands)
+  {
     auto topic = transport::TopicUtils::AsValidTopic("/model/" +
-        this->dataPtr->modelName.toStdString() + "/joint/" + jointName +
+        this->modelName.toStdString() + "/joint/" + jointName +
         "/0/cmd_pos");
 
     if (topic.empty())
     {
       ignerr << "Failed to create valid topic for joint [" << jointName << "]"
              << std::endl;
-      return;
+      continue;
+    }
+
+    // Advertising a topic is expensive, so publishers are kept
+    auto pubIt = this->commandPubs.find(topic);
+    if (pubIt == this->commandPubs.end())
+    {
+      pubIt = this->commandPubs.emplace(topic,
+          this->node.Advertise<msgs::Double>(topic)).first;
     }
 
-    auto pub = this->dataPtr->node.Advertise<ignition::msgs::Double>(topic);
-    pub.Publish(msg);
+    msgs::Double msg;
+    msg.set_data(pos);
+    pubIt->second.Publish(msg);
   }
+  this->pendingCommands.clear();
 }
 
 // Register this plugin
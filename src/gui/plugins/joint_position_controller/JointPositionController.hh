@@ -83,11 +83,21 @@ namespace gui
   /// When the lock button is checked, the model doesn't change even if it's
   /// deselected.
   ///
+  /// So that models with many joints stay responsive, only the positions of
+  /// joints scrolled into view are refreshed, and sliders only publish the
+  /// latest position of each joint at the command rate.
+  ///
   /// ## Configuration
   ///
   /// `<model_name>`: Load the widget pointed at the given model, so it's not
   /// necessary to select it. If a model is given at startup, the plugin starts
   /// in locked mode.
+  ///
+  /// `<refresh_rate>`: Maximum number of times per second the joint
+  /// positions are refreshed. 0 refreshes on every update. Defaults to 20.
+  ///
+  /// `<command_rate>`: Maximum number of position commands per second sent
+  /// to each joint. 0 sends every command right away. Defaults to 20.
   class JointPositionController : public gazebo::GuiSystem
   {
     Q_OBJECT
@@ -136,6 +146,13 @@ namespace gui
     /// \brief Callback in Qt thread when user requests a reset.
     public: Q_INVOKABLE void OnReset();
 
+    /// \brief Callback in Qt thread when a joint is shown in or hidden from
+    /// the list.
+    /// \param[in] _jointName Name of the joint.
+    /// \param[in] _visible True if shown.
+    public: Q_INVOKABLE void OnJointVisible(const QString &_jointName,
+        bool _visible);
+
     /// \brief Get the model currently controlled.
     /// \return Model entity ID.
     public: Q_INVOKABLE Entity ModelEntity() const;
@@ -172,6 +189,11 @@ namespace gui
     // Documentation inherited
     protected: bool eventFilter(QObject *_obj, QEvent *_event) override;
 
+    /// \brief List the joints of the model, adding new ones to the joints
+    /// model and removing those which are gone.
+    /// \param[in] _ecm Entity component manager.
+    private: void ListJoints(const EntityComponentManager &_ecm);
+
     /// \internal
     /// \brief Pointer to private data.
     private: std::unique_ptr<JointPositionControllerPrivate> dataPtr;
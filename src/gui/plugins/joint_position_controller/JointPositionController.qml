@@ -49,6 +49,13 @@ Rectangle {
     JointPositionController.OnCommand(_jointName, _pos)
   }
 
+  /**
+   * Let C++ know which joints are displayed, so only those are refreshed
+   */
+  function onJointVisible(_jointName, _visible) {
+    JointPositionController.OnJointVisible(_jointName, _visible)
+  }
+
   Connections {
     target: JointPositionController
     onLockedChanged: {
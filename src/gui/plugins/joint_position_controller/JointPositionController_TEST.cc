@@ -16,6 +16,9 @@
 */
 
 #include <gtest/gtest.h>
+
+#include <mutex>
+
 #ifdef _MSC_VER
 #pragma warning(push, 0)
 #endif
@@ -214,6 +217,41 @@ TEST_F(JointPositionControllerGui,
   EXPECT_FALSE(plugin->Locked());
   EXPECT_EQ(1, jointsModel->rowCount());
 
+  // Commands are published after the command period, with the latest
+  // position requested for the joint
+  std::mutex cmdMutex;
+  int cmdCount{0};
+  double cmdPos{0.0};
+  std::function<void(const msgs::Double &)> cmdCb =
+      [&](const msgs::Double &_msg)
+      {
+        std::lock_guard<std::mutex> lock(cmdMutex);
+        ++cmdCount;
+        cmdPos = _msg.data();
+      };
+  node.Subscribe("/model/model_name/joint/joint_name/0/cmd_pos", cmdCb);
+
+  // Keep commanding until the publisher is discovered
+  sleep = 0;
+  while (sleep < maxSleep)
+  {
+    plugin->OnCommand("joint_name", 0.2);
+    plugin->OnCommand("joint_name", 0.5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    QCoreApplication::processEvents();
+    sleep++;
+
+    std::lock_guard<std::mutex> lock(cmdMutex);
+    if (cmdCount > 0)
+      break;
+  }
+  EXPECT_LT(sleep, maxSleep);
+  {
+    std::lock_guard<std::mutex> lock(cmdMutex);
+    EXPECT_LE(cmdCount, sleep);
+    EXPECT_DOUBLE_EQ(0.5, cmdPos);
+  }
+
   // Cleanup
   plugins.clear();
 }
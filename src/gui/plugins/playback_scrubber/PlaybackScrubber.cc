@@ -20,12 +20,17 @@
 #include <ignition/msgs/boolean.pb.h>
 #include <ignition/msgs/stringmsg.pb.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <ctime>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <regex>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <ignition/math/Helpers.hh>
 
@@ -40,8 +45,15 @@
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/LogIndex.hh"
 #include "ignition/gazebo/gui/GuiEvents.hh"
 
+/// \brief Number of sections the activity of the timeline is shown in.
+static const std::size_t kActivitySections{200};
+
+/// \brief Most keyframes shown on the timeline.
+static const std::size_t kMaxKeyframes{500};
+
 namespace ignition::gazebo
 {
   class PlaybackScrubberPrivate
@@ -67,12 +79,73 @@ namespace ignition::gazebo
 
     /// \brief Bool holding if the simulation is currently paused.
     public: bool paused{false};
+
+    /// \brief Load the timeline index and summarize it for the timeline.
+    /// \param[in] _path Path of the index file.
+    /// \return True if loaded.
+    public: bool LoadIndex(const std::string &_path);
+
+    /// \brief Timeline index of the log, mapped from the file provided by
+    /// the playback.
+    public: LogIndex index;
+
+    /// \brief Keyframe positions, from 0 to 1.
+    public: QVariantList keyframes;
+
+    /// \brief Activity of each section of the timeline, from 0 to 1.
+    public: QVariantList activity;
+
+    /// \brief Protects the timeline index and its summary.
+    public: std::mutex indexMutex;
+
+    /// \brief Whether a timeline index request is pending or was answered.
+    public: std::atomic<bool> indexRequested{false};
+
+    /// \brief Wall time of the last timeline index request.
+    public: std::chrono::steady_clock::time_point indexRequestTime;
   };
 }
 
 using namespace ignition;
 using namespace gazebo;
 
+/////////////////////////////////////////////////
+bool PlaybackScrubberPrivate::LoadIndex(const std::string &_path)
+{
+  std::lock_guard<std::mutex> lock(this->indexMutex);
+  if (!this->index.Open(_path))
+    return false;
+
+  this->keyframes.clear();
+  this->activity.clear();
+
+  const auto start = this->index.StartTime();
+  const double duration = std::chrono::duration<double>(
+      this->index.EndTime() - start).count();
+  if (duration <= 0.0)
+    return true;
+
+  const std::size_t keyframeCount = this->index.KeyframeCount();
+  const std::size_t keyframeStep = keyframeCount / kMaxKeyframes + 1;
+  for (std::size_t i = 0; i < keyframeCount; i += keyframeStep)
+  {
+    this->keyframes.push_back(std::chrono::duration<double>(
+        this->index.KeyframeTime(i) - start).count() / duration);
+  }
+
+  // Sum the buckets of each section
+  const std::size_t bucketCount = this->index.BucketCount();
+  const std::size_t sections = std::min(bucketCount, kActivitySections);
+  std::vector<double> sums(sections, 0.0);
+  for (std::size_t i = 0; i < bucketCount; ++i)
+    sums[i * sections / bucketCount] += this->index.Buckets()[i].entities;
+
+  const double maxSum = *std::max_element(sums.begin(), sums.end());
+  for (const double sum : sums)
+    this->activity.push_back(maxSum > 0.0 ? sum / maxSum : 0.0);
+  return true;
+}
+
 /////////////////////////////////////////////////
 PlaybackScrubber::PlaybackScrubber() : GuiSystem(),
   dataPtr(std::make_unique<PlaybackScrubberPrivate>())
@@ -158,6 +231,27 @@ void PlaybackScrubber::Update(const UpdateInfo &_info,
     }
   }
 
+  // Ask the playback for its timeline index, retrying every second until
+  // it's built
+  auto now = std::chrono::steady_clock::now();
+  if (!this->dataPtr->worldName.empty() && !this->dataPtr->indexRequested &&
+      now - this->dataPtr->indexRequestTime > std::chrono::seconds(1))
+  {
+    this->dataPtr->indexRequested = true;
+    this->dataPtr->indexRequestTime = now;
+    std::function<void(const msgs::StringMsg &, const bool)> cb =
+        [this](const msgs::StringMsg &_res, const bool _result)
+    {
+      if (_result && this->dataPtr->LoadIndex(_res.data()))
+        this->timelineChanged();
+      else
+        this->dataPtr->indexRequested = false;
+    };
+    this->dataPtr->node.Request(
+        "/world/" + this->dataPtr->worldName + "/playback/timeline_index",
+        cb);
+  }
+
   auto simTime = math::durationToSecNsec(_info.simTime);
   this->dataPtr->currentTime =
     math::secNsecToTimePoint(simTime.first, simTime.second);
@@ -253,6 +347,20 @@ void PlaybackScrubber::OnDrop(double _value)
       playbackMsg, timeout, res, result);
 }
 
+/////////////////////////////////////////////////
+QVariantList PlaybackScrubber::Keyframes()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->indexMutex);
+  return this->dataPtr->keyframes;
+}
+
+/////////////////////////////////////////////////
+QVariantList PlaybackScrubber::Activity()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->indexMutex);
+  return this->dataPtr->activity;
+}
+
 // Register this plugin
 IGNITION_ADD_PLUGIN(ignition::gazebo::PlaybackScrubber,
                     ignition::gui::Plugin)
@@ -80,9 +80,23 @@ namespace gazebo
     /// \param[in] _time The time in format dd hh:mm:ss.nnn
     public slots: void OnTimeEntered(const QString &_time);
 
+    /// \brief Get the keyframes recorded in the log, from the playback's
+    /// timeline index.
+    /// \return Position of each keyframe on the timeline, from 0 to 1.
+    public slots: QVariantList Keyframes();
+
+    /// \brief Get the activity along the log, from the playback's timeline
+    /// index.
+    /// \return Activity of equally long sections of the timeline, from 0
+    /// to 1, where 1 is the most active section.
+    public slots: QVariantList Activity();
+
     /// \brief Notify that progress has advanced in the log file.
     signals: void newProgress();
 
+    /// \brief Notify that the timeline index was loaded.
+    signals: void timelineChanged();
+
     /// \internal
     /// \brief Pointer to private data.
     private: std::unique_ptr<PlaybackScrubberPrivate> dataPtr;
@@ -52,6 +52,16 @@ GridLayout {
    */
   property var endTime: ""
 
+  /**
+   * Keyframe positions along the timeline, from 0 to 1.
+   */
+  property var keyframes: []
+
+  /**
+   * Activity of each section of the timeline, from 0 to 1.
+   */
+  property var activity: []
+
   /**
    * Update the slider to the new values if it is currently being dragged.
    */
@@ -91,7 +101,45 @@ GridLayout {
       updateEndTime();
       updateCurrentTime();
     }
+    onTimelineChanged: {
+      keyframes = PlaybackScrubber.Keyframes();
+      activity = PlaybackScrubber.Activity();
+    }
   }
+
+  // Activity and keyframes of the log, aligned with the slider's groove
+  Item {
+    id: timeline
+    height: 16
+    Layout.fillWidth: true
+    Layout.columnSpan: 2
+    visible: activity.length > 0 || keyframes.length > 0
+
+    Repeater {
+      model: activity
+      Rectangle {
+        width: Math.max(1, slider.availableWidth / activity.length)
+        height: timeline.height * modelData
+        x: slider.leftPadding +
+           index * slider.availableWidth / activity.length
+        y: timeline.height - height
+        color: Material.accent
+        opacity: 0.4
+      }
+    }
+
+    Repeater {
+      model: keyframes
+      Rectangle {
+        width: 1
+        height: timeline.height
+        x: slider.leftPadding + modelData * slider.availableWidth
+        color: Material.theme == Material.Light ? "black" : "white"
+        opacity: 0.6
+      }
+    }
+  }
+
   Slider {
     id: slider
     height: 40
@@ -17,6 +17,11 @@
 
 #include "Plotting.hh"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
 #include <ignition/plugin/Register.hh>
 #include "ignition/gazebo/components/AngularAcceleration.hh"
 #include "ignition/gazebo/components/AngularVelocity.hh"
@@ -48,6 +53,51 @@ namespace ignition::gazebo
     /// map key: string contains EntityID + "," + ComponentID
     public: std::map<std::string,
       std::shared_ptr<PlotComponent>> components;
+
+    /// \brief Protects components, which are registered from the Qt thread
+    /// and updated from the GUI update thread.
+    public: std::mutex mutex;
+
+    /// \brief Period of simulation time between samples. Zero samples on
+    /// every update.
+    public: std::chrono::steady_clock::duration samplePeriod{
+      std::chrono::milliseconds(50)};
+
+    /// \brief Simulation time of the last sample
+    public: std::chrono::steady_clock::duration lastSampleTime{0};
+
+    /// \brief Whether any sample has been taken yet
+    public: bool sampled{false};
+
+    /// \brief Number of points kept per plotted attribute
+    public: std::size_t bufferSize{2000u};
+
+    /// \brief Number of samples reduced to a min and a max point
+    public: std::size_t decimation{4u};
+  };
+
+  /// \brief Display points of one attribute, kept in a fixed-size ring
+  /// buffer. Point i, counting from the first point ever added, is at index
+  /// i % capacity.
+  struct PlotSeries
+  {
+    /// \brief Buffered points, x is time and y is value
+    std::vector<math::Vector2d> points;
+
+    /// \brief Number of points ever added
+    uint64_t added{0u};
+
+    /// \brief Number of points ever taken for plotting
+    uint64_t taken{0u};
+
+    /// \brief Number of samples in the current bucket
+    std::size_t bucketCount{0u};
+
+    /// \brief Sample with the lowest value in the current bucket
+    math::Vector2d bucketMin;
+
+    /// \brief Sample with the highest value in the current bucket
+    math::Vector2d bucketMax;
   };
 
   class PlotComponentPrivate
@@ -65,21 +115,71 @@ namespace ignition::gazebo
     /// ex: x,y,z attributes in Vector3d type component
     public: std::map<std::string,
       std::shared_ptr<ignition::gui::PlotData>> data;
+
+    /// \brief Display points of each attribute
+    public: std::map<std::string, PlotSeries> series;
+
+    /// \brief Maximum number of points kept per attribute
+    public: std::size_t bufferSize{2000u};
+
+    /// \brief Number of samples reduced to a min and a max point
+    public: std::size_t decimation{4u};
+
+    /// \brief Add a display point to a series, overwriting its oldest
+    /// point if the buffer is full.
+    /// \param[in] _series Series to add to
+    /// \param[in] _point Point to add
+    public: void AddPoint(PlotSeries &_series, const math::Vector2d &_point);
+
+    /// \brief Get the points of a series from a given point on, skipping
+    /// those which have already been overwritten.
+    /// \param[in] _series Series to read
+    /// \param[in] _from Number of the first point to get
+    /// \param[in] _to Number past the last point to get
+    /// \return Points, oldest first
+    public: std::vector<math::Vector2d> Points(const PlotSeries &_series,
+                uint64_t _from, uint64_t _to) const;
   };
 }
 
 using namespace ignition::gazebo;
 using namespace ignition::gui;
 
+//////////////////////////////////////////////////
+void PlotComponentPrivate::AddPoint(PlotSeries &_series,
+                                    const math::Vector2d &_point)
+{
+  if (_series.points.size() < this->bufferSize)
+    _series.points.push_back(_point);
+  else
+    _series.points[_series.added % this->bufferSize] = _point;
+  ++_series.added;
+}
+
+//////////////////////////////////////////////////
+std::vector<math::Vector2d> PlotComponentPrivate::Points(
+    const PlotSeries &_series, uint64_t _from, uint64_t _to) const
+{
+  std::vector<math::Vector2d> result;
+  uint64_t oldest = _series.added - _series.points.size();
+  for (uint64_t i = std::max(_from, oldest); i < _to; ++i)
+    result.push_back(_series.points[i % this->bufferSize]);
+  return result;
+}
+
 //////////////////////////////////////////////////
 PlotComponent::PlotComponent(const std::string &_type,
                              ignition::gazebo::Entity _entity,
-                             ComponentTypeId _typeId) :
+                             ComponentTypeId _typeId,
+                             std::size_t _bufferSize,
+                             std::size_t _decimation) :
     dataPtr(std::make_unique<PlotComponentPrivate>())
 {
   this->dataPtr->entity = _entity;
   this->dataPtr->typeId = _typeId;
   this->dataPtr->type = _type;
+  this->dataPtr->bufferSize = std::max<std::size_t>(_bufferSize, 1u);
+  this->dataPtr->decimation = std::max<std::size_t>(_decimation, 1u);
 
   if (_type == "Vector3d")
   {
@@ -127,6 +227,9 @@ PlotComponent::PlotComponent(const std::string &_type,
   }
   else
     ignwarn << "Invalid Plot Component Type:" << _type << std::endl;
+
+  for (const auto &attribute : this->dataPtr->data)
+    this->dataPtr->series[attribute.first];
 }
 
 //////////////////////////////////////////////////
@@ -173,6 +276,71 @@ void PlotComponent::SetAttributeValue(std::string _attribute,
     this->dataPtr->data[_attribute]->SetValue(_value);
 }
 
+//////////////////////////////////////////////////
+void PlotComponent::Sample(double _time)
+{
+  for (const auto &attribute : this->dataPtr->data)
+  {
+    auto &series = this->dataPtr->series[attribute.first];
+    math::Vector2d sample(_time, attribute.second->Value());
+
+    if (series.bucketCount == 0u)
+    {
+      series.bucketMin = sample;
+      series.bucketMax = sample;
+    }
+    else if (sample.Y() < series.bucketMin.Y())
+      series.bucketMin = sample;
+    else if (sample.Y() > series.bucketMax.Y())
+      series.bucketMax = sample;
+
+    if (++series.bucketCount < this->dataPtr->decimation)
+      continue;
+
+    // Keep the extremes of the bucket, in the order they were sampled
+    if (series.bucketMin.X() < series.bucketMax.X())
+    {
+      this->dataPtr->AddPoint(series, series.bucketMin);
+      this->dataPtr->AddPoint(series, series.bucketMax);
+    }
+    else if (series.bucketMax.X() < series.bucketMin.X())
+    {
+      this->dataPtr->AddPoint(series, series.bucketMax);
+      this->dataPtr->AddPoint(series, series.bucketMin);
+    }
+    else
+    {
+      this->dataPtr->AddPoint(series, series.bucketMin);
+    }
+    series.bucketCount = 0u;
+  }
+}
+
+//////////////////////////////////////////////////
+std::vector<math::Vector2d> PlotComponent::TakeNewPoints(
+    const std::string &_attribute)
+{
+  auto it = this->dataPtr->series.find(_attribute);
+  if (it == this->dataPtr->series.end())
+    return {};
+
+  auto points = this->dataPtr->Points(it->second, it->second.taken,
+      it->second.added);
+  it->second.taken = it->second.added;
+  return points;
+}
+
+//////////////////////////////////////////////////
+std::vector<math::Vector2d> PlotComponent::History(
+    const std::string &_attribute) const
+{
+  auto it = this->dataPtr->series.find(_attribute);
+  if (it == this->dataPtr->series.end())
+    return {};
+
+  return this->dataPtr->Points(it->second, 0u, it->second.taken);
+}
+
 //////////////////////////////////////////////////
 std::map<std::string, std::shared_ptr<PlotData>> PlotComponent::Data() const
 {
@@ -218,10 +386,63 @@ Plotting ::~Plotting()
 }
 
 //////////////////////////////////////////
-void Plotting::LoadConfig(const tinyxml2::XMLElement *)
+void Plotting::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
 {
   if (this->title.empty())
     this->title = "Plotting";
+
+  if (!_pluginElem)
+    return;
+
+  if (auto elem = _pluginElem->FirstChildElement("sample_rate"))
+  {
+    double rate = 0.0;
+    if (elem->QueryDoubleText(&rate) != tinyxml2::XML_SUCCESS || rate < 0.0)
+    {
+      ignerr << "Failed to parse <sample_rate> value: " << elem->GetText()
+             << std::endl;
+    }
+    else if (rate == 0.0)
+    {
+      this->dataPtr->samplePeriod = std::chrono::steady_clock::duration::zero();
+    }
+    else
+    {
+      this->dataPtr->samplePeriod =
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(1.0 / rate));
+    }
+  }
+
+  if (auto elem = _pluginElem->FirstChildElement("buffer_size"))
+  {
+    unsigned int bufferSize = 0u;
+    if (elem->QueryUnsignedText(&bufferSize) != tinyxml2::XML_SUCCESS ||
+        bufferSize == 0u)
+    {
+      ignerr << "Failed to parse <buffer_size> value: " << elem->GetText()
+             << std::endl;
+    }
+    else
+    {
+      this->dataPtr->bufferSize = bufferSize;
+    }
+  }
+
+  if (auto elem = _pluginElem->FirstChildElement("decimation"))
+  {
+    unsigned int decimation = 0u;
+    if (elem->QueryUnsignedText(&decimation) != tinyxml2::XML_SUCCESS ||
+        decimation == 0u)
+    {
+      ignerr << "Failed to parse <decimation> value: " << elem->GetText()
+             << std::endl;
+    }
+    else
+    {
+      this->dataPtr->decimation = decimation;
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -319,13 +540,23 @@ void Plotting::RegisterChartToComponent(uint64_t _entity, uint64_t _typeId,
 {
   std::string Id = std::to_string(_entity) + "," + std::to_string(_typeId);
 
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
   if (this->dataPtr->components.count(Id) == 0)
   {
     this->dataPtr->components[Id] = std::make_shared<PlotComponent>(
-          _type, _entity, _typeId);
+          _type, _entity, _typeId, this->dataPtr->bufferSize,
+          this->dataPtr->decimation);
   }
 
   this->dataPtr->components[Id]->RegisterChart(_attribute, _chart);
+
+  // Fill the new chart with what other charts already show
+  QString attributeName = QString::fromStdString(Id + "," + _attribute);
+  for (const auto &point : this->dataPtr->components[Id]->History(_attribute))
+  {
+    emit this->dataPtr->plottingIface->plot(_chart, attributeName,
+        point.X(), point.Y());
+  }
 }
 
 //////////////////////////////////////////////////
@@ -335,6 +566,7 @@ void Plotting::UnRegisterChartFromComponent(uint64_t _entity, uint64_t _typeId,
   std::string id = std::to_string(_entity) + "," + std::to_string(_typeId);
   igndbg << "UnRegister [" << id  << "]" << std::endl;
 
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
   if (this->dataPtr->components.count(id) == 0)
     return;
 
@@ -361,6 +593,22 @@ std::string Plotting::ComponentName(const uint64_t &_typeId)
 void Plotting ::Update(const ignition::gazebo::UpdateInfo &_info,
                        ignition::gazebo::EntityComponentManager &_ecm)
 {
+  // Rewind if simulation time went back, e.g. on reset
+  if (this->dataPtr->sampled && _info.simTime < this->dataPtr->lastSampleTime)
+    this->dataPtr->sampled = false;
+
+  if (this->dataPtr->sampled)
+  {
+    auto elapsed = _info.simTime - this->dataPtr->lastSampleTime;
+    if (elapsed == elapsed.zero() || elapsed < this->dataPtr->samplePeriod)
+      return;
+  }
+  this->dataPtr->sampled = true;
+  this->dataPtr->lastSampleTime = _info.simTime;
+
+  double x = std::chrono::duration<double>(_info.simTime).count();
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
   for (auto component : this->dataPtr->components)
   {
     auto entity = component.second->Entity();
@@ -487,17 +735,24 @@ void Plotting ::Update(const ignition::gazebo::UpdateInfo &_info,
       }
     }
 
+    component.second->Sample(x);
+
     for (auto attribute : component.second->Data())
     {
-      for (auto chart : attribute.second->Charts())
+      auto charts = attribute.second->Charts();
+      auto points = component.second->TakeNewPoints(attribute.first);
+      if (charts.empty() || points.empty())
+        continue;
+
+      QString attributeName = QString::fromStdString(
+                  component.first + "," + attribute.first);
+      for (auto chart : charts)
       {
-        QString attributeName = QString::fromStdString(
-                    component.first + "," + attribute.first);
-        double y = attribute.second->Value();
-
-        double x = _info.simTime.count() * std::pow(10, -9);
-
-        emit this->dataPtr->plottingIface->plot(chart, attributeName, x, y);
+        for (const auto &point : points)
+        {
+          emit this->dataPtr->plottingIface->plot(chart, attributeName,
+              point.X(), point.Y());
+        }
       }
     }
   }
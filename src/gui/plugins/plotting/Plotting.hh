@@ -21,15 +21,18 @@
 #include <ignition/gui/Application.hh>
 #include <ignition/gui/PlottingInterface.hh>
 #include <ignition/gazebo/gui/GuiSystem.hh>
+#include <ignition/math/Vector2.hh>
 #include <ignition/math/Vector3.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/msgs/light.pb.h>
 
 #include "sdf/Physics.hh"
 
+#include <cstddef>
 #include <map>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace ignition {
 
@@ -38,16 +41,23 @@ namespace gazebo {
 class PlotComponentPrivate;
 
 /// \brief A container of the component data that keeps track of the registered
-/// attributes and update their values and their registered charts
+/// attributes and update their values and their registered charts.
+/// Each attribute keeps a fixed-size ring buffer of the points to display,
+/// where every bucket of samples is decimated to its min and max.
 class PlotComponent
 {
   /// \brief Constructor
   /// \param[in] _type component data type (Pose3d, Vector3d, double)
   /// \param [in] _entity entity id of that component
   /// \param [in] _typeId type identifier unique to each component type
+  /// \param [in] _bufferSize maximum number of points kept per attribute
+  /// \param [in] _decimation number of samples reduced to a min and a max
+  /// point for display. 1 displays every sample.
   public: PlotComponent(const std::string &_type,
                         ignition::gazebo::Entity _entity,
-                        ComponentTypeId _typeId);
+                        ComponentTypeId _typeId,
+                        std::size_t _bufferSize = 2000u,
+                        std::size_t _decimation = 4u);
 
   /// \brief Destructor
   public: ~PlotComponent();
@@ -73,6 +83,24 @@ class PlotComponent
   /// \param[in] _value value to be set to the attribute
   public: void SetAttributeValue(std::string _attribute, const double &_value);
 
+  /// \brief Record the current value of every attribute as a sample
+  /// \param[in] _time time of the sample, in seconds
+  public: void Sample(double _time);
+
+  /// \brief Get the points of an attribute which haven't been plotted yet,
+  /// and mark them as plotted.
+  /// \param[in] _attribute component attribute
+  /// \return New points, oldest first. x is time and y is value.
+  public: std::vector<ignition::math::Vector2d> TakeNewPoints(
+              const std::string &_attribute);
+
+  /// \brief Get all the points of an attribute still in its buffer. Used to
+  /// fill a chart which is registered after plotting started.
+  /// \param[in] _attribute component attribute
+  /// \return Buffered points, oldest first. x is time and y is value.
+  public: std::vector<ignition::math::Vector2d> History(
+              const std::string &_attribute) const;
+
   /// \brief Get all attributes of the component
   /// \return component attributes
   public: std::map<std::string, std::shared_ptr<ignition::gui::PlotData>>
@@ -103,8 +131,15 @@ class Plotting : public ignition::gazebo::GuiSystem
   /// \brief Destructor
   public: ~Plotting();
 
-  // Documentation inherited
-  public: void LoadConfig(const tinyxml2::XMLElement *) override;
+  /// \brief Load the plugin configuration. Accepts:
+  /// * <sample_rate>: Rate in Hz of simulation time at which components are
+  ///   sampled. 0 samples on every update. Defaults to 20.
+  /// * <buffer_size>: Number of points kept per plotted attribute.
+  ///   Defaults to 2000.
+  /// * <decimation>: Number of samples reduced to a min and a max point for
+  ///   display. 1 displays every sample. Defaults to 4.
+  /// \param[in] _pluginElem Plugin configuration
+  public: void LoadConfig(const tinyxml2::XMLElement *_pluginElem) override;
 
   // Documentation inherited
   public: void Update(const ignition::gazebo::UpdateInfo &_info,
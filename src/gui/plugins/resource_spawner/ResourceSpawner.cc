@@ -20,7 +20,11 @@
 #include <ignition/msgs/boolean.pb.h>
 #include <ignition/msgs/stringmsg.pb.h>
 
+#include <sys/stat.h>
+
 #include <algorithm>
+#include <cstdint>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 
@@ -30,6 +34,7 @@
 #include <ignition/common/Console.hh>
 #include <ignition/common/Profiler.hh>
 #include <ignition/common/Filesystem.hh>
+#include <ignition/common/Util.hh>
 #include <ignition/gui/Application.hh>
 #include <ignition/gui/MainWindow.hh>
 #include <ignition/plugin/Register.hh>
@@ -43,8 +48,31 @@
 
 namespace ignition::gazebo
 {
+  /// \brief A local resource, with the modification times of the files it
+  /// was read from, so it's only read again when they change.
+  struct IndexedResource
+  {
+    /// \brief The resource
+    Resource resource;
+
+    /// \brief Modification time of its model.config
+    int64_t configTime{0};
+
+    /// \brief Modification time of its thumbnails directory
+    int64_t thumbnailsTime{0};
+  };
+
   class ResourceSpawnerPrivate
   {
+    /// \brief Load the on-disk index of resources into localIndex and
+    /// ownerModelMap.
+    /// \return True if the index had Fuel resources.
+    public: bool LoadIndex();
+
+    /// \brief Save localIndex and ownerModelMap to the on-disk index.
+    /// resourceMutex must be held.
+    public: void SaveIndex();
+
     /// \brief Ignition communication node.
     public: transport::Node node;
 
@@ -71,12 +99,171 @@ namespace ignition::gazebo
     /// \brief Holds all of the relevant data used by `DisplayData()` in order
     /// to filter and sort the displayed resources as desired by the user.
     public: Display displayData;
+
+    /// \brief Local resources already read, by path of their model.config
+    public: std::unordered_map<std::string, IndexedResource> localIndex;
+
+    /// \brief Whether localIndex changed since the index was saved
+    public: bool localIndexDirty{false};
+
+    /// \brief Protects ownerModelMap and localIndex, which are also written
+    /// by the thread loading Fuel resources.
+    public: std::mutex resourceMutex;
+
+    /// \brief Path of the on-disk index of resources. Empty to not keep one.
+    public: std::string indexPath;
   };
 }
 
 using namespace ignition;
 using namespace gazebo;
 
+/// \brief Version of the on-disk index format. Indices with another version
+/// are ignored.
+static const int kIndexVersion{1};
+
+/////////////////////////////////////////////////
+/// \brief Get the last modification time of a file or directory.
+/// \param[in] _path Path to the file or directory.
+/// \return Seconds since epoch, or 0 if it can't be accessed.
+static int64_t modificationTime(const std::string &_path)
+{
+#ifdef _WIN32
+  struct _stat info;
+  if (_stat(_path.c_str(), &info) != 0)
+    return 0;
+#else
+  struct stat info;
+  if (stat(_path.c_str(), &info) != 0)
+    return 0;
+#endif
+  return static_cast<int64_t>(info.st_mtime);
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a resource from an index element.
+/// \param[in] _elem Element written by writeResource.
+/// \return The resource.
+static Resource readResource(const tinyxml2::XMLElement *_elem)
+{
+  auto attribute = [&](const char *_name) -> std::string
+  {
+    auto value = _elem->Attribute(_name);
+    return value ? value : "";
+  };
+
+  Resource resource;
+  resource.name = attribute("name");
+  resource.owner = attribute("owner");
+  resource.sdfPath = attribute("sdf");
+  resource.thumbnailPath = attribute("thumbnail");
+  resource.isDownloaded = _elem->BoolAttribute("downloaded");
+  return resource;
+}
+
+/////////////////////////////////////////////////
+/// \brief Write a resource to an index element.
+/// \param[in] _resource The resource.
+/// \param[in] _elem Element to write to.
+static void writeResource(const Resource &_resource,
+    tinyxml2::XMLElement *_elem)
+{
+  _elem->SetAttribute("name", _resource.name.c_str());
+  _elem->SetAttribute("owner", _resource.owner.c_str());
+  _elem->SetAttribute("sdf", _resource.sdfPath.c_str());
+  _elem->SetAttribute("thumbnail", _resource.thumbnailPath.c_str());
+  _elem->SetAttribute("downloaded", _resource.isDownloaded);
+}
+
+/////////////////////////////////////////////////
+bool ResourceSpawnerPrivate::LoadIndex()
+{
+  tinyxml2::XMLDocument doc;
+  if (this->indexPath.empty() || !common::isFile(this->indexPath) ||
+      doc.LoadFile(this->indexPath.c_str()) != tinyxml2::XML_SUCCESS)
+  {
+    return false;
+  }
+
+  auto root = doc.FirstChildElement("resource_index");
+  if (!root || root->IntAttribute("version") != kIndexVersion)
+  {
+    igndbg << "Ignoring resource index [" << this->indexPath
+           << "] with another version" << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(this->resourceMutex);
+  for (auto elem = root->FirstChildElement("local"); elem;
+      elem = elem->NextSiblingElement("local"))
+  {
+    auto config = elem->Attribute("config");
+    if (!config)
+      continue;
+
+    IndexedResource indexed;
+    indexed.resource = readResource(elem);
+    indexed.configTime = elem->Int64Attribute("config_time");
+    indexed.thumbnailsTime = elem->Int64Attribute("thumbnails_time");
+    this->localIndex[config] = indexed;
+  }
+
+  bool hasFuel{false};
+  for (auto elem = root->FirstChildElement("fuel"); elem;
+      elem = elem->NextSiblingElement("fuel"))
+  {
+    Resource resource = readResource(elem);
+    resource.isFuel = true;
+    this->ownerModelMap[resource.owner].push_back(resource);
+    hasFuel = true;
+  }
+  return hasFuel;
+}
+
+/////////////////////////////////////////////////
+void ResourceSpawnerPrivate::SaveIndex()
+{
+  if (this->indexPath.empty())
+    return;
+
+  tinyxml2::XMLDocument doc;
+  auto root = doc.NewElement("resource_index");
+  root->SetAttribute("version", kIndexVersion);
+  doc.InsertEndChild(root);
+
+  for (const auto &indexed : this->localIndex)
+  {
+    auto elem = doc.NewElement("local");
+    elem->SetAttribute("config", indexed.first.c_str());
+    elem->SetAttribute("config_time", indexed.second.configTime);
+    elem->SetAttribute("thumbnails_time", indexed.second.thumbnailsTime);
+    writeResource(indexed.second.resource, elem);
+    root->InsertEndChild(elem);
+  }
+
+  for (const auto &owner : this->ownerModelMap)
+  {
+    for (const auto &resource : owner.second)
+    {
+      auto elem = doc.NewElement("fuel");
+      writeResource(resource, elem);
+      root->InsertEndChild(elem);
+    }
+  }
+
+  // Write to a temporary file first, so a crash never leaves a partial index
+  common::createDirectories(common::parentPath(this->indexPath));
+  std::string tmpPath = this->indexPath + ".tmp";
+  if (doc.SaveFile(tmpPath.c_str()) != tinyxml2::XML_SUCCESS ||
+      !common::moveFile(tmpPath, this->indexPath))
+  {
+    ignwarn << "Failed to save resource index [" << this->indexPath << "]"
+            << std::endl;
+    return;
+  }
+  this->localIndexDirty = false;
+}
+
 /////////////////////////////////////////////////
 PathModel::PathModel() : QStandardItemModel()
 {
@@ -268,6 +455,21 @@ Resource ResourceSpawner::LocalResource(const std::string &_path)
   // If we have found model.config, extract thumbnail and sdf
   std::string resourcePath = common::parentPath(_path);
   std::string thumbnailPath = common::joinPaths(resourcePath, "thumbnails");
+
+  // Only read the resource again if its files changed since it was indexed
+  int64_t configTime = modificationTime(_path);
+  int64_t thumbnailsTime = modificationTime(thumbnailPath);
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->resourceMutex);
+    auto indexed = this->dataPtr->localIndex.find(_path);
+    if (indexed != this->dataPtr->localIndex.end() &&
+        indexed->second.configTime == configTime &&
+        indexed->second.thumbnailsTime == thumbnailsTime)
+    {
+      return indexed->second.resource;
+    }
+  }
+
   std::string configFileName = common::joinPaths(resourcePath, "model.config");
   tinyxml2::XMLDocument doc;
   doc.LoadFile(configFileName.c_str());
@@ -285,6 +487,10 @@ Resource ResourceSpawner::LocalResource(const std::string &_path)
 
   // Get first thumbnail image found
   this->SetThumbnail(thumbnailPath, resource);
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->resourceMutex);
+  this->dataPtr->localIndex[_path] = {resource, configTime, thumbnailsTime};
+  this->dataPtr->localIndexDirty = true;
   return resource;
 }
 
@@ -320,6 +526,11 @@ std::vector<Resource> ResourceSpawner::LocalResources(const std::string &_path)
     if (resource.sdfPath != "")
       localResources.push_back(resource);
   }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->resourceMutex);
+  if (this->dataPtr->localIndexDirty)
+    this->dataPtr->SaveIndex();
+
   return localResources;
 }
 
@@ -328,6 +539,7 @@ std::vector<Resource> ResourceSpawner::FuelResources(const std::string &_owner)
 {
   std::vector<Resource> fuelResources;
 
+  std::lock_guard<std::mutex> lock(this->dataPtr->resourceMutex);
   if (this->dataPtr->ownerModelMap.find(_owner) !=
       this->dataPtr->ownerModelMap.end())
   {
@@ -494,6 +706,7 @@ void ResourceSpawner::OnDownloadFuelResource(const QString &_path,
     this->dataPtr->resourceModel.UpdateResourceModel(index, modelResource);
 
     // Update the ground truth ownerModelMap
+    std::lock_guard<std::mutex> lock(this->dataPtr->resourceMutex);
     if (this->dataPtr->ownerModelMap.find(_owner.toStdString()) !=
         this->dataPtr->ownerModelMap.end())
     {
@@ -508,6 +721,7 @@ void ResourceSpawner::OnDownloadFuelResource(const QString &_path,
           resource.sdfPath = modelResource.sdfPath;
           this->SetThumbnail(thumbnailPath, resource);
           this->dataPtr->ownerModelMap[_owner.toStdString()] = fuelResources;
+          this->dataPtr->SaveIndex();
           break;
         }
       }
@@ -550,18 +764,62 @@ void ResourceSpawner::LoadConfig(const tinyxml2::XMLElement *)
     this->AddPath(path);
   }
 
-  auto servers = this->dataPtr->fuelClient->Config().Servers();
-  ignmsg << "Please wait... Loading models from Fuel.\n";
+  std::string home;
+  common::env(IGN_HOMEDIR, home);
+  this->dataPtr->indexPath = common::joinPaths(home, ".ignition", "gazebo",
+      "resource_spawner", "index.xml");
+
+  // Show the resources indexed last time right away, they're refreshed in
+  // the background
+  std::set<std::string> indexedOwners;
+  if (this->dataPtr->LoadIndex())
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->resourceMutex);
+    for (const auto &owner : this->dataPtr->ownerModelMap)
+      indexedOwners.insert(owner.first);
+  }
 
-  // Add notice for the user that fuel resources are being loaded
-  this->dataPtr->ownerModel.AddPath("Please wait... Loading models from Fuel.");
+  if (indexedOwners.empty())
+  {
+    ignmsg << "Please wait... Loading models from Fuel.\n";
+
+    // Add notice for the user that fuel resources are being loaded
+    this->dataPtr->ownerModel.AddPath(
+        "Please wait... Loading models from Fuel.");
+  }
+  else
+  {
+    for (const auto &owner : indexedOwners)
+      this->dataPtr->ownerModel.AddPath(owner);
+  }
+
+  auto servers = this->dataPtr->fuelClient->Config().Servers();
 
   // Pull in fuel models asynchronously
-  std::thread t([this, servers]
+  std::thread t([this, servers, indexedOwners]
   {
+    // Thumbnails already indexed for downloaded models, by owner and name,
+    // so their directories aren't scanned again
+    std::unordered_map<std::string, std::string> indexedThumbnails;
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->resourceMutex);
+      for (const auto &owner : this->dataPtr->ownerModelMap)
+      {
+        for (const auto &resource : owner.second)
+        {
+          if (resource.isDownloaded && !resource.thumbnailPath.empty())
+          {
+            indexedThumbnails[resource.owner + "/" + resource.name] =
+                resource.thumbnailPath;
+          }
+        }
+      }
+    }
+
     // A set isn't necessary to keep track of the owners, but it
     // maintains alphabetical order
     std::set<std::string> ownerSet;
+    std::unordered_map<std::string, std::vector<Resource>> ownerModelMap;
     for (auto const &server : servers)
     {
       std::vector<ignition::fuel_tools::ModelIdentifier> models;
@@ -588,15 +846,39 @@ void ResourceSpawner::LoadConfig(const tinyxml2::XMLElement *)
         {
           resource.isDownloaded = true;
           resource.sdfPath = ignition::common::joinPaths(path, "model.sdf");
-          std::string thumbnailPath = common::joinPaths(path, "thumbnails");
-          this->SetThumbnail(thumbnailPath, resource);
+
+          auto indexed = indexedThumbnails.find(id.Owner() + "/" + id.Name());
+          if (indexed != indexedThumbnails.end() &&
+              common::isFile(indexed->second))
+          {
+            resource.thumbnailPath = indexed->second;
+          }
+          else
+          {
+            std::string thumbnailPath = common::joinPaths(path, "thumbnails");
+            this->SetThumbnail(thumbnailPath, resource);
+          }
         }
         ownerSet.insert(id.Owner());
-        this->dataPtr->ownerModelMap[id.Owner()].push_back(resource);
+        ownerModelMap[id.Owner()].push_back(resource);
       }
     }
 
-    // Clear the loading message
+    // Keep the index if Fuel couldn't be reached
+    if (ownerModelMap.empty() && !indexedOwners.empty())
+    {
+      ignwarn << "No models found on Fuel, keeping the indexed resources."
+              << std::endl;
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->resourceMutex);
+      this->dataPtr->ownerModelMap = std::move(ownerModelMap);
+      this->dataPtr->SaveIndex();
+    }
+
+    // Clear the loading message or the indexed owners
     this->dataPtr->ownerModel.clear();
 
     // Add all unique owners to the owner model
@@ -140,6 +140,12 @@ namespace gazebo
 
   /// \brief Provides interface for communicating to backend for generation
   /// of local models
+  ///
+  /// Discovered resources and their thumbnails are kept in an index at
+  /// `$HOME/.ignition/gazebo/resource_spawner/index.xml`. Local resources are
+  /// only read again when their `model.config` or `thumbnails` directory
+  /// change, and Fuel resources from the index are shown while the list is
+  /// refreshed in the background.
   class ResourceSpawner : public ignition::gui::Plugin
   {
     Q_OBJECT
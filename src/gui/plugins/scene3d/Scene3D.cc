@@ -18,6 +18,7 @@
 #include "Scene3D.hh"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <condition_variable>
 #include <limits>
@@ -39,7 +40,6 @@
 #include <ignition/common/MeshManager.hh>
 #include <ignition/common/Profiler.hh>
 #include <ignition/common/Uuid.hh>
-#include <ignition/common/VideoEncoder.hh>
 
 #include <ignition/plugin/Register.hh>
 
@@ -65,7 +65,9 @@
 #include "ignition/gazebo/components/RenderEngineGuiPlugin.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/PoseDeltaStream.hh"
 #include "ignition/gazebo/gui/GuiEvents.hh"
+#include "ignition/gazebo/rendering/AsyncVideoEncoder.hh"
 #include "ignition/gazebo/rendering/RenderUtil.hh"
 
 /// \brief condition variable for lockstepping video recording
@@ -73,6 +75,11 @@
 /// multiple viewports in the future.
 std::condition_variable g_renderCv;
 
+/// \brief Shortest real time between two hover broadcasts. Each one runs a
+/// ray query against the scene, which is too slow to do on every mouse move
+/// of a large scene.
+static const std::chrono::milliseconds kHoverPeriod{50};
+
 Q_DECLARE_METATYPE(std::string)
 
 namespace ignition
@@ -167,6 +174,13 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \brief Flag to indicate if hover event is dirty
     public: bool hoverDirty = false;
 
+    /// \brief Flag to indicate if the hovered position still has to be
+    /// broadcast, see kHoverPeriod.
+    public: bool hoverBroadcastDirty = false;
+
+    /// \brief Real time when the hovered position was last broadcast.
+    public: std::chrono::steady_clock::time_point hoverBroadcastTime;
+
     /// \brief Mouse event
     public: common::MouseEvent mouseEvent;
 
@@ -308,7 +322,7 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     public: rendering::Image cameraImage;
 
     /// \brief Video encoder
-    public: common::VideoEncoder videoEncoder;
+    public: AsyncVideoEncoder videoEncoder;
 
     /// \brief Ray query for mouse clicks
     public: rendering::RayQueryPtr rayQuery;
@@ -316,6 +330,10 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \brief View control focus target
     public: math::Vector3d target;
 
+    /// \brief Camera pose when the last frame was rendered. Used in render
+    /// on demand mode.
+    public: std::optional<math::Pose3d> lastRenderCameraPose;
+
     /// \brief Rendering utility
     public: RenderUtil renderUtil;
 
@@ -435,6 +453,20 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 
     /// \brief View collisions service
     public: std::string viewCollisionsService;
+
+    /// \brief Server pose stream applied directly to the scene, bypassing
+    /// the ECM: "info" for dynamic_pose/info, "delta" for
+    /// dynamic_pose/delta. Empty to only use poses from the ECM.
+    public: std::string poseStream;
+
+    /// \brief Whether the pose stream has been subscribed to
+    public: bool poseStreamSubscribed{false};
+
+    /// \brief Decodes the delta encoded pose stream
+    public: PoseDeltaDecoder poseDeltaDecoder;
+
+    /// \brief Protects poseDeltaDecoder
+    public: std::mutex poseDeltaMutex;
   };
 }
 }
@@ -470,20 +502,26 @@ RenderUtil *IgnRenderer::RenderUtil() const
 }
 
 /////////////////////////////////////////////////
-void IgnRenderer::Render()
+bool IgnRenderer::Render()
 {
   rendering::ScenePtr scene = this->dataPtr->renderUtil.Scene();
   if (!scene)
   {
     ignwarn << "Scene is null. The render step will not occur in Scene3D."
       << std::endl;
-    return;
+    return true;
   }
 
   this->dataPtr->renderThreadId = std::this_thread::get_id();
 
   IGN_PROFILE_THREAD_NAME("RenderThread");
   IGN_PROFILE("IgnRenderer::Render");
+
+  // Decide before the events below are consumed
+  bool rendered = true;
+  bool needsRender = !this->renderOnDemand || this->textureDirty ||
+      this->ToolActive();
+
   if (this->textureDirty)
   {
     this->dataPtr->camera->SetImageWidth(this->textureSize.width());
@@ -505,6 +543,9 @@ void IgnRenderer::Render()
   this->dataPtr->renderUtil.SetTransformActive(
       this->dataPtr->transformControl.Active());
   this->dataPtr->renderUtil.Update();
+  this->dataPtr->renderUtil.SceneManager().UpdateLod(
+      {this->dataPtr->camera->WorldPosition()});
+  needsRender = needsRender || this->dataPtr->renderUtil.SceneChanged();
 
   // view control
   this->HandleMouseEvent();
@@ -541,11 +582,25 @@ void IgnRenderer::Render()
       this->dataPtr->recordVideoUpdateTime = t;
   }
 
+  // in render on demand mode, skip the frame if nothing changed since the
+  // last one
+  if (!needsRender)
+  {
+    needsRender = this->dataPtr->lastRenderCameraPose !=
+        this->dataPtr->camera->WorldPose();
+  }
+  if (!needsRender)
+  {
+    update = false;
+    rendered = false;
+  }
+
   // update and render to texture
   if (update)
   {
     IGN_PROFILE("IgnRenderer::Render Update camera");
     this->dataPtr->camera->Update();
+    this->dataPtr->lastRenderCameraPose = this->dataPtr->camera->WorldPose();
   }
 
   // record video is requested
@@ -565,8 +620,6 @@ void IgnRenderer::Render()
       // Video recorder is on. Add more frames to it
       if (this->dataPtr->videoEncoder.IsEncoding())
       {
-        this->dataPtr->camera->Copy(this->dataPtr->cameraImage);
-
         std::chrono::steady_clock::time_point t =
             std::chrono::steady_clock::now();
         if (this->dataPtr->recordVideoUseSimTime)
@@ -574,28 +627,19 @@ void IgnRenderer::Render()
           t = std::chrono::steady_clock::time_point(
               this->dataPtr->renderUtil.SimTime());
         }
-        bool frameAdded = this->dataPtr->videoEncoder.AddFrame(
-            this->dataPtr->cameraImage.Data<unsigned char>(), width, height, t);
 
-        if (frameAdded)
+        // Reading the frame back stalls the render thread, so it's only
+        // done for frames the video keeps. The GUI usually renders faster
+        // than the video's frame rate.
+        if (this->dataPtr->videoEncoder.WantsFrame(t))
         {
-          // publish recorder stats
-          if (this->dataPtr->recordStartTime ==
-              std::chrono::steady_clock::time_point(
-              std::chrono::duration(std::chrono::seconds(0))))
-          {
-            // start time, i.e. time when first frame is added
-            this->dataPtr->recordStartTime = t;
-          }
+          this->dataPtr->camera->Copy(this->dataPtr->cameraImage);
 
-          std::chrono::steady_clock::duration dt;
-          dt = t - this->dataPtr->recordStartTime;
-          int64_t sec, nsec;
-          std::tie(sec, nsec) = ignition::math::durationToSecNsec(dt);
-          msgs::Time msg;
-          msg.set_sec(sec);
-          msg.set_nsec(nsec);
-          this->dataPtr->recorderStatsPub.Publish(msg);
+          // The frame is encoded on the encoder's thread, recorder stats
+          // are published from there once the frame is encoded
+          this->dataPtr->videoEncoder.AddFrame(
+              this->dataPtr->cameraImage.Data<unsigned char>(), width,
+              height, t);
         }
       }
       // Video recorder is idle. Start recording.
@@ -614,11 +658,35 @@ void IgnRenderer::Render()
         }
         ignmsg << "Recording video using bitrate: "
                << this->dataPtr->recordVideoBitrate <<  std::endl;
-        this->dataPtr->videoEncoder.Start(this->dataPtr->recordVideoFormat,
-            this->dataPtr->recordVideoSavePath, width, height, 25,
-            this->dataPtr->recordVideoBitrate);
         this->dataPtr->recordStartTime = std::chrono::steady_clock::time_point(
             std::chrono::duration(std::chrono::seconds(0)));
+        this->dataPtr->videoEncoder.SetFrameEncodedCallback(
+            [this](const std::chrono::steady_clock::time_point &_t)
+        {
+          // publish recorder stats
+          if (this->dataPtr->recordStartTime ==
+              std::chrono::steady_clock::time_point(
+              std::chrono::duration(std::chrono::seconds(0))))
+          {
+            // start time, i.e. time when first frame is added
+            this->dataPtr->recordStartTime = _t;
+          }
+
+          std::chrono::steady_clock::duration dt;
+          dt = _t - this->dataPtr->recordStartTime;
+          int64_t sec, nsec;
+          std::tie(sec, nsec) = ignition::math::durationToSecNsec(dt);
+          msgs::Time msg;
+          msg.set_sec(sec);
+          msg.set_nsec(nsec);
+          this->dataPtr->recorderStatsPub.Publish(msg);
+        });
+        // Lockstep recording needs every frame, so wait for the encoder
+        // instead of dropping frames when it falls behind
+        this->dataPtr->videoEncoder.Start(this->dataPtr->recordVideoFormat,
+            this->dataPtr->recordVideoSavePath, width, height, 25,
+            this->dataPtr->recordVideoBitrate, 8,
+            !this->dataPtr->recordVideoLockstep);
       }
     }
     else if (this->dataPtr->videoEncoder.IsEncoding())
@@ -685,7 +753,7 @@ void IgnRenderer::Render()
   {
     IGN_PROFILE("IgnRenderer::Render Follow");
     if (!this->dataPtr->moveToTarget.empty())
-      return;
+      return rendered;
     rendering::NodePtr followTarget = this->dataPtr->camera->FollowTarget();
     if (!this->dataPtr->followTarget.empty())
     {
@@ -852,6 +920,32 @@ void IgnRenderer::Render()
   // only has an effect in video recording lockstep mode
   // this notifes ECM to continue updating the scene
   g_renderCv.notify_one();
+
+  return rendered;
+}
+
+/////////////////////////////////////////////////
+bool IgnRenderer::ToolActive()
+{
+  {
+    // Hovering alone doesn't change the image, placing a model is handled
+    // below
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    if (this->dataPtr->mouseDirty)
+      return true;
+  }
+
+  return this->dataPtr->recordVideo ||
+      this->dataPtr->viewAngle ||
+      this->dataPtr->isSpawning ||
+      this->dataPtr->isPlacing ||
+      this->dataPtr->escapeReleased ||
+      this->dataPtr->moveToPoseValue ||
+      !this->dataPtr->moveToTarget.empty() ||
+      !this->dataPtr->followTarget.empty() ||
+      !this->dataPtr->viewCollisionsTarget.empty() ||
+      this->dataPtr->transformMode != rendering::TransformMode::TM_NONE ||
+      !this->dataPtr->moveToHelper.Idle();
 }
 
 /////////////////////////////////////////////////
@@ -952,15 +1046,22 @@ void IgnRenderer::HandleMouseEvent()
 /////////////////////////////////////////////////
 void IgnRenderer::BroadcastHoverPos()
 {
-  if (this->dataPtr->hoverDirty)
-  {
-    math::Vector3d pos = this->ScreenToScene(this->dataPtr->mouseHoverPos);
+  if (!this->dataPtr->hoverBroadcastDirty)
+    return;
 
-    ignition::gui::events::HoverToScene hoverToSceneEvent(pos);
-    ignition::gui::App()->sendEvent(
-        ignition::gui::App()->findChild<ignition::gui::MainWindow *>(),
-        &hoverToSceneEvent);
-  }
+  // The latest position is kept and broadcast once the period is over
+  auto now = std::chrono::steady_clock::now();
+  if (now - this->dataPtr->hoverBroadcastTime < kHoverPeriod)
+    return;
+  this->dataPtr->hoverBroadcastTime = now;
+  this->dataPtr->hoverBroadcastDirty = false;
+
+  math::Vector3d pos = this->ScreenToScene(this->dataPtr->mouseHoverPos);
+
+  ignition::gui::events::HoverToScene hoverToSceneEvent(pos);
+  ignition::gui::App()->sendEvent(
+      ignition::gui::App()->findChild<ignition::gui::MainWindow *>(),
+      &hoverToSceneEvent);
 }
 
 /////////////////////////////////////////////////
@@ -1016,8 +1117,9 @@ void IgnRenderer::HandleMouseContextMenu()
     if (dt.Length() > 5.0)
       return;
 
-    rendering::VisualPtr visual = this->dataPtr->camera->Scene()->VisualAt(
-          this->dataPtr->camera,
+    // The camera picks from its selection buffer, which is only rendered
+    // when needed
+    rendering::VisualPtr visual = this->dataPtr->camera->VisualAt(
           this->dataPtr->mouseEvent.Pos());
 
     if (!visual)
@@ -1452,11 +1554,7 @@ void IgnRenderer::HandleMouseTransformControl()
       // Select entity
       else if (!this->dataPtr->mouseEvent.Dragging())
       {
-        rendering::VisualPtr v = this->dataPtr->camera->VisualAt(
-              this->dataPtr->mouseEvent.Pos());
-
-        rendering::VisualPtr visual = this->dataPtr->camera->Scene()->VisualAt(
-              this->dataPtr->camera,
+        rendering::VisualPtr visual = this->dataPtr->camera->VisualAt(
               this->dataPtr->mouseEvent.Pos());
 
         if (!visual)
@@ -2053,6 +2151,7 @@ void IgnRenderer::NewHoverEvent(const math::Vector2i &_hoverPos)
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
   this->dataPtr->mouseHoverPos = _hoverPos;
   this->dataPtr->hoverDirty = true;
+  this->dataPtr->hoverBroadcastDirty = true;
 }
 
 /////////////////////////////////////////////////
@@ -2152,11 +2251,41 @@ void RenderThread::RenderNext()
     return;
   }
 
-  this->ignRenderer.Render();
+  // Without a limit, render on demand checks for changes at 60 Hz
+  std::chrono::steady_clock::duration period = std::chrono::milliseconds(16);
+  if (this->ignRenderer.maxFrameRate > 0.0)
+  {
+    period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / this->ignRenderer.maxFrameRate));
+
+    auto sinceLastFrame = std::chrono::steady_clock::now() -
+        this->lastFrameTime;
+    if (sinceLastFrame < period)
+    {
+      this->RetryRenderNext(period - sinceLastFrame);
+      return;
+    }
+  }
+
+  if (!this->ignRenderer.Render())
+  {
+    this->RetryRenderNext(period);
+    return;
+  }
+  this->lastFrameTime = std::chrono::steady_clock::now();
 
   emit TextureReady(this->ignRenderer.textureId, this->ignRenderer.textureSize);
 }
 
+/////////////////////////////////////////////////
+void RenderThread::RetryRenderNext(std::chrono::steady_clock::duration _delay)
+{
+  // No new texture is sent, so the scene graph won't ask for the next frame
+  auto ms = std::chrono::ceil<std::chrono::milliseconds>(_delay);
+  QTimer::singleShot(static_cast<int>(ms.count()), this,
+      &RenderThread::RenderNext);
+}
+
 /////////////////////////////////////////////////
 void RenderThread::ShutDown()
 {
@@ -2506,6 +2635,41 @@ void Scene3D::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
       this->dataPtr->renderUtil->SetAmbientLight(ambient);
     }
 
+    if (auto elem = _pluginElem->FirstChildElement("lod_distances"))
+    {
+      std::vector<double> distances;
+      std::stringstream distancesStr;
+      distancesStr << std::string(elem->GetText());
+      for (double distance; distancesStr >> distance;)
+        distances.push_back(distance);
+      this->dataPtr->renderUtil->SceneManager().SetLodDistances(distances);
+    }
+
+    // Meshes are loaded in the background by default, so spawning large
+    // models doesn't freeze the view
+    bool asyncMeshLoading{true};
+    if (auto elem = _pluginElem->FirstChildElement("async_mesh_loading"))
+      elem->QueryBoolText(&asyncMeshLoading);
+    this->dataPtr->renderUtil->SceneManager().SetAsyncMeshLoading(
+        asyncMeshLoading);
+
+    // Large scenes are built over several frames, so the view can be used
+    // before all visuals are in
+    double creationBudget{10.0};
+    if (auto elem = _pluginElem->FirstChildElement("creation_budget"))
+    {
+      if (elem->QueryDoubleText(&creationBudget) != tinyxml2::XML_SUCCESS ||
+          creationBudget < 0.0)
+      {
+        ignerr << "Failed to parse <creation_budget> value: "
+               << elem->GetText() << std::endl;
+        creationBudget = 10.0;
+      }
+    }
+    this->dataPtr->renderUtil->SetCreationBudget(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(creationBudget)));
+
     if (auto elem = _pluginElem->FirstChildElement("background_color"))
     {
       math::Color bgColor;
@@ -2628,6 +2792,48 @@ void Scene3D::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
       }
     }
 
+    if (auto elem = _pluginElem->FirstChildElement("render_on_demand"))
+    {
+      bool renderOnDemand = false;
+      if (elem->QueryBoolText(&renderOnDemand) != tinyxml2::XML_SUCCESS)
+      {
+        ignerr << "Failed to parse <render_on_demand> value: "
+               << elem->GetText() << std::endl;
+      }
+      else
+      {
+        renderWindow->SetRenderOnDemand(renderOnDemand);
+      }
+    }
+
+    if (auto elem = _pluginElem->FirstChildElement("max_frame_rate"))
+    {
+      double rate = 0.0;
+      if (elem->QueryDoubleText(&rate) != tinyxml2::XML_SUCCESS || rate < 0.0)
+      {
+        ignerr << "Failed to parse <max_frame_rate> value: "
+               << elem->GetText() << std::endl;
+      }
+      else
+      {
+        renderWindow->SetMaxFrameRate(rate);
+      }
+    }
+
+    if (auto elem = _pluginElem->FirstChildElement("pose_stream"))
+    {
+      std::string poseStream = elem->GetText() ? elem->GetText() : "";
+      if (poseStream == "info" || poseStream == "delta")
+      {
+        this->dataPtr->poseStream = poseStream;
+      }
+      else if (!poseStream.empty())
+      {
+        ignerr << "Invalid <pose_stream> [" << poseStream
+               << "], expected [info] or [delta]" << std::endl;
+      }
+    }
+
     if (auto elem = _pluginElem->FirstChildElement("visibility_mask"))
     {
       uint32_t visibilityMask = 0xFFFFFFFFu;
@@ -2735,6 +2941,7 @@ void Scene3D::Update(const UpdateInfo &_info,
     if (!this->dataPtr->worldName.empty())
     {
       renderWindow->SetWorldName(this->dataPtr->worldName);
+      this->SubscribePoseStream();
       auto renderEngineGuiComp =
         _ecm.Component<components::RenderEngineGuiPlugin>(worldEntity);
       if (renderEngineGuiComp && !renderEngineGuiComp->Data().empty())
@@ -2768,6 +2975,72 @@ void Scene3D::Update(const UpdateInfo &_info,
   }
 }
 
+/////////////////////////////////////////////////
+void Scene3D::SubscribePoseStream()
+{
+  if (this->dataPtr->poseStream.empty() ||
+      this->dataPtr->poseStreamSubscribed)
+  {
+    return;
+  }
+
+  auto topic = transport::TopicUtils::AsValidTopic("/world/" +
+      this->dataPtr->worldName + "/dynamic_pose/" +
+      this->dataPtr->poseStream);
+
+  bool subscribed{false};
+  if (this->dataPtr->poseStream == "delta")
+  {
+    subscribed = this->dataPtr->node.Subscribe(topic,
+        &Scene3D::OnDynamicPoseDelta, this);
+  }
+  else
+  {
+    subscribed = this->dataPtr->node.Subscribe(topic,
+        &Scene3D::OnDynamicPoses, this);
+  }
+
+  if (!subscribed)
+  {
+    ignerr << "Failed to subscribe to [" << topic << "]" << std::endl;
+    return;
+  }
+  this->dataPtr->poseStreamSubscribed = true;
+  ignmsg << "Applying poses from [" << topic << "]" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void Scene3D::OnDynamicPoses(const msgs::Pose_V &_msg)
+{
+  IGN_PROFILE("Scene3D::OnDynamicPoses");
+  std::vector<std::pair<Entity, math::Pose3d>> poses;
+  poses.reserve(_msg.pose_size());
+  for (const auto &pose : _msg.pose())
+    poses.emplace_back(pose.id(), msgs::Convert(pose));
+
+  this->dataPtr->renderUtil->UpdateFromPoses(poses);
+}
+
+/////////////////////////////////////////////////
+void Scene3D::OnDynamicPoseDelta(const msgs::Bytes &_msg)
+{
+  IGN_PROFILE("Scene3D::OnDynamicPoseDelta");
+  std::vector<std::pair<Entity, math::Pose3d>> poses;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->poseDeltaMutex);
+    std::vector<Entity> changed;
+    if (!this->dataPtr->poseDeltaDecoder.Decode(_msg.data(), changed))
+      return;
+
+    const auto &decoded = this->dataPtr->poseDeltaDecoder.Poses();
+    poses.reserve(changed.size());
+    for (auto entity : changed)
+      poses.emplace_back(entity, decoded.at(entity));
+  }
+
+  this->dataPtr->renderUtil->UpdateFromPoses(poses);
+}
+
 /////////////////////////////////////////////////
 bool Scene3D::OnTransformMode(const msgs::StringMsg &_msg,
   msgs::Boolean &_res)
@@ -3202,6 +3475,18 @@ void RenderWindowItem::SetVisibilityMask(uint32_t _mask)
   this->dataPtr->renderThread->ignRenderer.visibilityMask = _mask;
 }
 
+/////////////////////////////////////////////////
+void RenderWindowItem::SetRenderOnDemand(bool _renderOnDemand)
+{
+  this->dataPtr->renderThread->ignRenderer.renderOnDemand = _renderOnDemand;
+}
+
+/////////////////////////////////////////////////
+void RenderWindowItem::SetMaxFrameRate(double _rate)
+{
+  this->dataPtr->renderThread->ignRenderer.maxFrameRate = _rate;
+}
+
 /////////////////////////////////////////////////
 void RenderWindowItem::OnHovered(const ignition::math::Vector2i &_hoverPos)
 {
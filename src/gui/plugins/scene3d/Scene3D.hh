@@ -19,11 +19,14 @@
 #define IGNITION_GAZEBO_GUI_SCENE3D_HH_
 
 #include <ignition/msgs/boolean.pb.h>
+#include <ignition/msgs/bytes.pb.h>
 #include <ignition/msgs/gui_camera.pb.h>
+#include <ignition/msgs/pose_v.pb.h>
 #include <ignition/msgs/stringmsg.pb.h>
 #include <ignition/msgs/vector3d.pb.h>
 #include <ignition/msgs/video_record.pb.h>
 
+#include <chrono>
 #include <string>
 #include <memory>
 #include <mutex>
@@ -76,6 +79,18 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
   ///     * \<p_gain\>    : Camera follow movement p gain.
   ///     * \<target\>    : Target to follow.
   /// * \<fullscreen\> : Optional starting the window in fullscreen.
+  /// * \<lod_distances\> : Optional space separated distances at which mesh
+  ///                       visuals switch to simpler levels of detail, loaded
+  ///                       from `<mesh name>_lod<N>.<extension>` files next
+  ///                       to the meshes. Disabled if unset.
+  /// * \<async_mesh_loading\> : Optional, whether meshes are loaded on
+  ///                            background threads and shown once ready,
+  ///                            instead of blocking rendering. Defaults to
+  ///                            true.
+  /// * \<creation_budget\> : Optional, milliseconds each frame may spend
+  ///                         creating visuals. Large scenes are then shown
+  ///                         over several frames. Zero for no limit.
+  ///                         Defaults to 10.
   class Scene3D : public ignition::gazebo::GuiSystem
   {
     Q_OBJECT
@@ -161,6 +176,19 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     private: bool OnViewCollisions(const msgs::StringMsg &_msg,
         msgs::Boolean &_res);
 
+    /// \brief Subscribe to the pose stream chosen with <pose_stream>, once
+    /// the world name is known.
+    private: void SubscribePoseStream();
+
+    /// \brief Callback for dynamic poses, when <pose_stream> is "info".
+    /// \param[in] _msg Poses of the dynamic models and links
+    private: void OnDynamicPoses(const msgs::Pose_V &_msg);
+
+    /// \brief Callback for delta encoded dynamic poses, when <pose_stream>
+    /// is "delta".
+    /// \param[in] _msg Frame written by PoseDeltaEncoder
+    private: void OnDynamicPoseDelta(const msgs::Bytes &_msg);
+
     /// \internal
     /// \brief Pointer to private data.
     private: std::unique_ptr<Scene3DPrivate> dataPtr;
@@ -183,7 +211,10 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     public: ~IgnRenderer() override;
 
     ///  \brief Main render function
-    public: void Render();
+    /// \return True if a frame was rendered. In render on demand mode, no
+    /// frame is rendered unless the scene changed, the camera moved or a
+    /// tool is active.
+    public: bool Render();
 
     /// \brief Initialize the render engine
     public: void Initialize();
@@ -418,6 +449,11 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \return Pose of the camera.
     public: math::Pose3d CameraPose() const;
 
+    /// \brief Whether user input, a camera animation or an active tool
+    /// require rendering even if the scene didn't change.
+    /// \return True if a frame should be rendered.
+    private: bool ToolActive();
+
     /// \brief Callback when a move to animation is complete
     private: void OnMoveToComplete();
 
@@ -461,6 +497,13 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \brief Camera visibility mask
     public: uint32_t visibilityMask = 0xFFFFFFFFu;
 
+    /// \brief True to only render when something changed, see Render.
+    public: bool renderOnDemand = false;
+
+    /// \brief Maximum number of frames rendered per second. 0 to only be
+    /// limited by the Qt scene graph.
+    public: double maxFrameRate = 0.0;
+
     /// \brief True if engine has been initialized;
     public: bool initialized = false;
 
@@ -506,6 +549,13 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 
     /// \brief Ign-rendering renderer
     public: IgnRenderer ignRenderer;
+
+    /// \brief Try RenderNext again later, without rendering now.
+    /// \param[in] _delay Time to wait
+    private: void RetryRenderNext(std::chrono::steady_clock::duration _delay);
+
+    /// \brief Time the last frame was rendered
+    private: std::chrono::steady_clock::time_point lastFrameTime;
   };
 
 
@@ -540,6 +590,14 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \param[in] _mask Visibility mask to set to
     public: void SetVisibilityMask(uint32_t _mask);
 
+    /// \brief Set whether to only render when something changed
+    /// \param[in] _renderOnDemand True to render on demand
+    public: void SetRenderOnDemand(bool _renderOnDemand);
+
+    /// \brief Set the maximum frame rate
+    /// \param[in] _rate Frames per second, 0 for no limit
+    public: void SetMaxFrameRate(double _rate);
+
     /// \brief Set the transform mode
     /// \param[in] _mode New transform mode to set to
     public: void SetTransformMode(const std::string &_mode);
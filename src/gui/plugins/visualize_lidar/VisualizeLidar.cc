@@ -17,6 +17,7 @@
 
 #include "VisualizeLidar.hh"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -85,8 +86,38 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
     /// \brief URI sequence to the lidar link
     public: std::string lidarString{""};
 
-    /// \brief LaserScan message from sensor
-    public: msgs::LaserScan msg;
+    /// \brief Ranges of the latest scan, decimated, to be applied to the
+    /// visual on the render thread. Kept across scans so its memory is
+    /// reused.
+    public: std::vector<double> points;
+
+    /// \brief Number of horizontal rays in points
+    public: unsigned int horizontalRayCount{0u};
+
+    /// \brief Number of vertical rays in points
+    public: unsigned int verticalRayCount{0u};
+
+    /// \brief Angle of the first horizontal ray in points
+    public: double minHorizontalAngle{0.0};
+
+    /// \brief Angle of the last horizontal ray in points
+    public: double maxHorizontalAngle{0.0};
+
+    /// \brief Angle of the first vertical ray in points
+    public: double minVerticalAngle{0.0};
+
+    /// \brief Angle of the last vertical ray in points
+    public: double maxVerticalAngle{0.0};
+
+    /// \brief Keep one horizontal ray out of this many
+    public: unsigned int horizontalDecimation{1u};
+
+    /// \brief Keep one vertical ray out of this many
+    public: unsigned int verticalDecimation{1u};
+
+    /// \brief Maximum number of points displayed. Scans with more points
+    /// are decimated further. 0 for no limit.
+    public: std::size_t maxPoints{50000u};
 
     /// \brief Pose of the lidar visual
     public: math::Pose3d lidarPose{math::Pose3d::Zero};
@@ -108,8 +139,8 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
 
     /// \brief Mutex for variable mutated by the checkbox and spinboxes
     /// callbacks.
-    /// The variables are: msg, visualType, minVisualRange and
-    /// maxVisualRange
+    /// The variables are: points and its ray counts and angles, visualType,
+    /// minVisualRange and maxVisualRange
     public: std::mutex serviceMutex;
 
     /// \brief Initialization flag
@@ -131,6 +162,41 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
 using namespace ignition;
 using namespace gazebo;
 
+/////////////////////////////////////////////////
+/// \brief Increase the decimation of a scan until it has at most a given
+/// number of points. The direction with the most rays left is decimated
+/// first.
+/// \param[in] _horizontalCount Number of horizontal rays in the scan
+/// \param[in] _verticalCount Number of vertical rays in the scan
+/// \param[in] _maxPoints Maximum number of points, 0 for no limit
+/// \param[in,out] _horizontalStride Keep one horizontal ray out of this many
+/// \param[in,out] _verticalStride Keep one vertical ray out of this many
+static void fitToMaxPoints(unsigned int _horizontalCount,
+    unsigned int _verticalCount, std::size_t _maxPoints,
+    unsigned int &_horizontalStride, unsigned int &_verticalStride)
+{
+  if (_maxPoints == 0u)
+    return;
+
+  while (true)
+  {
+    std::size_t horizontal =
+        (_horizontalCount + _horizontalStride - 1) / _horizontalStride;
+    std::size_t vertical =
+        (_verticalCount + _verticalStride - 1) / _verticalStride;
+    if (horizontal * vertical <= _maxPoints ||
+        (horizontal <= 1u && vertical <= 1u))
+    {
+      return;
+    }
+
+    if (horizontal >= vertical)
+      ++_horizontalStride;
+    else
+      ++_verticalStride;
+  }
+}
+
 /////////////////////////////////////////////////
 VisualizeLidar::VisualizeLidar()
   : GuiSystem(), dataPtr(new VisualizeLidarPrivate)
@@ -209,11 +275,42 @@ void VisualizeLidar::LoadLidar()
 }
 
 /////////////////////////////////////////////////
-void VisualizeLidar::LoadConfig(const tinyxml2::XMLElement *)
+void VisualizeLidar::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
 {
   if (this->title.empty())
     this->title = "Visualize lidar";
 
+  if (_pluginElem)
+  {
+    auto loadUnsigned = [&](const char *_name, unsigned int &_value)
+    {
+      auto elem = _pluginElem->FirstChildElement(_name);
+      if (!elem)
+        return;
+
+      unsigned int value = 0u;
+      if (elem->QueryUnsignedText(&value) != tinyxml2::XML_SUCCESS)
+      {
+        ignerr << "Failed to parse <" << _name << "> value: "
+               << elem->GetText() << std::endl;
+        return;
+      }
+      _value = value;
+    };
+
+    loadUnsigned("horizontal_decimation",
+        this->dataPtr->horizontalDecimation);
+    loadUnsigned("vertical_decimation", this->dataPtr->verticalDecimation);
+    this->dataPtr->horizontalDecimation =
+        std::max(this->dataPtr->horizontalDecimation, 1u);
+    this->dataPtr->verticalDecimation =
+        std::max(this->dataPtr->verticalDecimation, 1u);
+
+    unsigned int maxPoints = this->dataPtr->maxPoints;
+    loadUnsigned("max_points", maxPoints);
+    this->dataPtr->maxPoints = maxPoints;
+  }
+
   ignition::gui::App()->findChild<
     ignition::gui::MainWindow *>()->installEventFilter(this);
 }
@@ -239,8 +336,24 @@ bool VisualizeLidar::eventFilter(QObject *_obj, QEvent *_event)
         this->dataPtr->lidar->ClearPoints();
         this->dataPtr->resetVisual = false;
       }
+      // Only the latest scan is applied, so scans arriving faster than
+      // frames are rendered don't cost a visual update each
       if (this->dataPtr->visualDirty)
       {
+        IGN_PROFILE("VisualizeLidar::Render Update visual");
+        this->dataPtr->lidar->SetVerticalRayCount(
+            this->dataPtr->verticalRayCount);
+        this->dataPtr->lidar->SetHorizontalRayCount(
+            this->dataPtr->horizontalRayCount);
+        this->dataPtr->lidar->SetMinHorizontalAngle(
+            this->dataPtr->minHorizontalAngle);
+        this->dataPtr->lidar->SetMaxHorizontalAngle(
+            this->dataPtr->maxHorizontalAngle);
+        this->dataPtr->lidar->SetMinVerticalAngle(
+            this->dataPtr->minVerticalAngle);
+        this->dataPtr->lidar->SetMaxVerticalAngle(
+            this->dataPtr->maxVerticalAngle);
+        this->dataPtr->lidar->SetPoints(this->dataPtr->points);
         this->dataPtr->lidar->SetWorldPose(this->dataPtr->lidarPose);
         this->dataPtr->lidar->Update();
         this->dataPtr->visualDirty = false;
@@ -456,30 +569,54 @@ void VisualizeLidar::SetTopicList(const QStringList &_topicList)
 //////////////////////////////////////////////////
 void VisualizeLidar::OnScan(const msgs::LaserScan &_msg)
 {
-  std::lock_guard<std::mutex>(this->dataPtr->serviceMutex);
+  IGN_PROFILE("VisualizeLidar::OnScan");
+  std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
   if (this->dataPtr->initialized)
   {
-    this->dataPtr->msg = std::move(_msg);
-    this->dataPtr->lidar->SetVerticalRayCount(
-                                  this->dataPtr->msg.vertical_count());
-    this->dataPtr->lidar->SetHorizontalRayCount(
-                                  this->dataPtr->msg.count());
-    this->dataPtr->lidar->SetMinHorizontalAngle(
-                                  this->dataPtr->msg.angle_min());
-    this->dataPtr->lidar->SetMaxHorizontalAngle(
-                                  this->dataPtr->msg.angle_max());
-    this->dataPtr->lidar->SetMinVerticalAngle(
-                                  this->dataPtr->msg.vertical_angle_min());
-    this->dataPtr->lidar->SetMaxVerticalAngle(
-                                  this->dataPtr->msg.vertical_angle_max());
-
-    this->dataPtr->lidar->SetPoints(std::vector<double>(
-                                  this->dataPtr->msg.ranges().begin(),
-                                  this->dataPtr->msg.ranges().end()));
+    unsigned int horizontalCount = _msg.count();
+    unsigned int verticalCount = std::max(_msg.vertical_count(), 1u);
+    if (static_cast<std::size_t>(_msg.ranges_size()) <
+        static_cast<std::size_t>(horizontalCount) * verticalCount)
+    {
+      ignerr << "LaserScan has [" << _msg.ranges_size()
+             << "] ranges, expected [" << horizontalCount * verticalCount
+             << "]" << std::endl;
+      return;
+    }
+
+    unsigned int horizontalStride = this->dataPtr->horizontalDecimation;
+    unsigned int verticalStride = this->dataPtr->verticalDecimation;
+    fitToMaxPoints(horizontalCount, verticalCount, this->dataPtr->maxPoints,
+        horizontalStride, verticalStride);
+
+    // Keep every stride-th ray, starting from the first one
+    this->dataPtr->horizontalRayCount =
+        (horizontalCount + horizontalStride - 1) / horizontalStride;
+    this->dataPtr->verticalRayCount =
+        (verticalCount + verticalStride - 1) / verticalStride;
+
+    double horizontalStep = horizontalCount > 1 ?
+        (_msg.angle_max() - _msg.angle_min()) / (horizontalCount - 1) : 0.0;
+    double verticalStep = verticalCount > 1 ?
+        (_msg.vertical_angle_max() - _msg.vertical_angle_min()) /
+        (verticalCount - 1) : 0.0;
+    this->dataPtr->minHorizontalAngle = _msg.angle_min();
+    this->dataPtr->maxHorizontalAngle = _msg.angle_min() + horizontalStep *
+        horizontalStride * (this->dataPtr->horizontalRayCount - 1);
+    this->dataPtr->minVerticalAngle = _msg.vertical_angle_min();
+    this->dataPtr->maxVerticalAngle = _msg.vertical_angle_min() +
+        verticalStep * verticalStride * (this->dataPtr->verticalRayCount - 1);
+
+    this->dataPtr->points.clear();
+    for (unsigned int v = 0u; v < verticalCount; v += verticalStride)
+    {
+      for (unsigned int h = 0u; h < horizontalCount; h += horizontalStride)
+        this->dataPtr->points.push_back(_msg.ranges(v * horizontalCount + h));
+    }
 
     this->dataPtr->visualDirty = true;
 
-    for (auto data_values : this->dataPtr->msg.header().data())
+    for (auto data_values : _msg.header().data())
     {
       if (data_values.key() == "frame_id")
       {
@@ -488,8 +625,8 @@ void VisualizeLidar::OnScan(const msgs::LaserScan &_msg)
         {
           this->dataPtr->lidarString = common::trimmed(data_values.value(0));
           this->dataPtr->lidarEntityDirty = true;
-          this->dataPtr->maxVisualRange = this->dataPtr->msg.range_max();
-          this->dataPtr->minVisualRange = this->dataPtr->msg.range_min();
+          this->dataPtr->maxVisualRange = _msg.range_max();
+          this->dataPtr->minVisualRange = _msg.range_min();
           this->dataPtr->lidar->SetMaxRange(this->dataPtr->maxVisualRange);
           this->dataPtr->lidar->SetMinRange(this->dataPtr->minVisualRange);
           this->MinRangeChanged();
@@ -37,6 +37,15 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
   /// checkbox to turn visualization of non-hitting rays on or off and
   /// the textfield to select the message to be visualised. The combobox is
   /// used to select the type of visual for the sensor data.
+  ///
+  /// ## Configuration
+  ///
+  /// * `<horizontal_decimation>`: Keep one horizontal ray out of this many.
+  ///   Defaults to 1.
+  /// * `<vertical_decimation>`: Keep one vertical ray out of this many.
+  ///   Defaults to 1.
+  /// * `<max_points>`: Maximum number of points displayed per scan. Larger
+  ///   scans are decimated further. 0 for no limit. Defaults to 50000.
   class VisualizeLidar : public ignition::gazebo::GuiSystem
   {
     Q_OBJECT
@@ -17,7 +17,16 @@
 
 #include "ign.hh"
 
+#ifndef _WIN32
+  #include <sys/resource.h>
+#endif
+
+#include <chrono>
 #include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -27,10 +36,14 @@
 #include <ignition/fuel_tools/ClientConfig.hh>
 #include <ignition/fuel_tools/Result.hh>
 #include <ignition/fuel_tools/WorldIdentifier.hh>
+#include <ignition/msgs/param_v.pb.h>
+#include <ignition/msgs/stringmsg_v.pb.h>
+#include <ignition/transport/Node.hh>
 
 #include "ignition/gazebo/config.hh"
 #include "ignition/gazebo/Server.hh"
 #include "ignition/gazebo/ServerConfig.hh"
+#include "ignition/gazebo/ServerTemplate.hh"
 
 #include "ignition/gazebo/gui/Gui.hh"
 
@@ -354,6 +367,258 @@ extern "C" IGNITION_GAZEBO_VISIBLE int runServer(const char *_sdfString,
   return 0;
 }
 
+//////////////////////////////////////////////////
+/// \brief Quote a string for JSON.
+/// \param[in] _str String to quote.
+/// \return Quoted string.
+static std::string jsonString(const std::string &_str)
+{
+  std::string result{"\""};
+  for (const char c : _str)
+  {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    if (static_cast<unsigned char>(c) < 0x20)
+      result += ' ';
+    else
+      result += c;
+  }
+  return result + "\"";
+}
+
+//////////////////////////////////////////////////
+/// \brief Write system statistics, as served on
+/// `/world/<world>/system_stats`, as a JSON array.
+/// \param[in] _msg System statistics.
+/// \param[out] _out Stream to write to.
+/// \param[out] _phases Sum of the mean time of all systems in each phase,
+/// in milliseconds, keyed by phase.
+static void writeSystemStats(const ignition::msgs::Param_V &_msg,
+    std::ostream &_out, std::map<std::string, double> &_phases)
+{
+  const std::string meanSuffix{"_mean_ms"};
+
+  _out << "[";
+  for (int i = 0; i < _msg.param_size(); ++i)
+  {
+    // Keys are sorted, so the report is stable
+    const auto &params = _msg.param(i).params();
+    std::map<std::string, ignition::msgs::Any> sorted(params.begin(),
+        params.end());
+
+    _out << (i > 0 ? ",\n" : "\n") << "        {";
+    bool first{true};
+    for (const auto &[key, value] : sorted)
+    {
+      _out << (first ? "" : ", ") << jsonString(key) << ": ";
+      first = false;
+      switch (value.type())
+      {
+        case ignition::msgs::Any::STRING:
+          _out << jsonString(value.string_value());
+          break;
+        case ignition::msgs::Any::INT32:
+          _out << value.int_value();
+          break;
+        case ignition::msgs::Any::DOUBLE:
+          _out << value.double_value();
+          break;
+        default:
+          _out << "null";
+          break;
+      }
+
+      if (value.type() == ignition::msgs::Any::DOUBLE &&
+          key.size() > meanSuffix.size() &&
+          key.compare(key.size() - meanSuffix.size(), meanSuffix.size(),
+          meanSuffix) == 0)
+      {
+        _phases[key.substr(0, key.size() - meanSuffix.size())] +=
+            value.double_value();
+      }
+    }
+    _out << "}";
+  }
+  _out << (_msg.param_size() > 0 ? "\n      ]" : "]");
+}
+
+//////////////////////////////////////////////////
+extern "C" IGNITION_GAZEBO_VISIBLE int runBenchmark(const char *_sdfString,
+    int _iterations, int _levels, const char *_physicsEngine,
+    const char *_renderEngineServer, const char *_file, const char *_output)
+{
+  using Clock = std::chrono::steady_clock;
+  auto seconds = [](const Clock::duration &_duration)
+  {
+    return std::chrono::duration<double>(_duration).count();
+  };
+
+  if (_iterations <= 0)
+  {
+    ignerr << "The number of benchmark iterations must be positive."
+           << std::endl;
+    return -1;
+  }
+
+  ignition::gazebo::ServerConfig serverConfig;
+  if (_sdfString != nullptr && std::strlen(_sdfString) > 0 &&
+      !serverConfig.SetSdfString(_sdfString))
+  {
+    ignerr << "Failed to set SDF string [" << _sdfString << "]" << std::endl;
+    return -1;
+  }
+  if (_file != nullptr)
+    serverConfig.SetSdfFile(_file);
+  if (_levels > 0)
+    serverConfig.SetUseLevels(true);
+  if (_physicsEngine != nullptr && std::strlen(_physicsEngine) > 0)
+    serverConfig.SetPhysicsEngine(_physicsEngine);
+  if (_renderEngineServer != nullptr && std::strlen(_renderEngineServer) > 0)
+    serverConfig.SetRenderEngineServer(_renderEngineServer);
+
+  // Loading goes through a template, so parsing the world is timed apart
+  // from creating its entities and systems
+  const auto loadStart = Clock::now();
+  ignition::gazebo::ServerTemplate serverTemplate(serverConfig);
+  const auto loadEnd = Clock::now();
+  auto server = serverTemplate.CreateServer();
+  const auto createEnd = Clock::now();
+  if (nullptr == server)
+  {
+    ignerr << "Failed to load the world to benchmark." << std::endl;
+    return -1;
+  }
+
+  // Run as fast as possible
+  unsigned int worldCount{0};
+  while (server->IterationCount(worldCount))
+  {
+    server->SetUpdatePeriod(Clock::duration::zero(), worldCount);
+    ++worldCount;
+  }
+
+  // The first iteration is timed on its own, since systems create most of
+  // their data, such as physics entities, on it
+  server->RunOnce(false);
+  const auto firstEnd = Clock::now();
+  if (_iterations > 1)
+    server->Run(true, _iterations - 1, false);
+  const auto runEnd = Clock::now();
+
+  // Reuse the statistics each world serves
+  ignition::transport::Node node;
+  ignition::msgs::StringMsg_V worlds;
+  bool result{false};
+  node.Request("/gazebo/worlds", 5000, worlds, result);
+
+  std::ostringstream report;
+  report << "{\n"
+         << "  \"iterations\": " << _iterations << ",\n"
+         << "  \"startup_s\": {\n"
+         << "    \"load\": " << seconds(loadEnd - loadStart) << ",\n"
+         << "    \"create\": " << seconds(createEnd - loadEnd) << ",\n"
+         << "    \"first_iteration\": " << seconds(firstEnd - createEnd)
+         << "\n  },\n"
+         << "  \"run_s\": " << seconds(runEnd - firstEnd) << ",\n";
+
+#ifndef _WIN32
+  // Kilobytes on Linux, bytes on macOS
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+  {
+#ifdef __APPLE__
+    const double peakMb = usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    const double peakMb = usage.ru_maxrss / 1024.0;
+#endif
+    report << "  \"peak_memory_mb\": " << peakMb << ",\n";
+  }
+#endif
+
+  report << "  \"worlds\": [";
+  for (unsigned int i = 0; i < worldCount; ++i)
+  {
+    const auto iterations = *server->IterationCount(i);
+    const double simTime = seconds(*server->SimTime(i));
+    const double wallTime = seconds(runEnd - createEnd);
+
+    std::string name;
+    if (result && static_cast<int>(i) < worlds.data_size())
+      name = worlds.data(static_cast<int>(i));
+
+    report << (i > 0 ? ",\n" : "\n")
+           << "    {\n"
+           << "      \"name\": " << jsonString(name) << ",\n"
+           << "      \"iterations\": " << iterations << ",\n"
+           << "      \"sim_time_s\": " << simTime << ",\n"
+           << "      \"real_time_factor\": "
+           << (wallTime > 0 ? simTime / wallTime : 0.0) << ",\n"
+           << "      \"iterations_per_s\": "
+           << (wallTime > 0 ? iterations / wallTime : 0.0) << ",\n";
+
+    ignition::msgs::Param_V stats;
+    bool statsResult{false};
+    std::map<std::string, double> phases;
+    std::ostringstream systems;
+    if (!name.empty() && node.Request("/world/" + name + "/system_stats",
+        5000, stats, statsResult) && statsResult)
+    {
+      writeSystemStats(stats, systems, phases);
+    }
+    else
+    {
+      systems << "[]";
+    }
+
+    report << "      \"phases_mean_ms\": {";
+    bool first{true};
+    for (const auto &[phase, mean] : phases)
+    {
+      report << (first ? "" : ", ") << jsonString(phase) << ": " << mean;
+      first = false;
+    }
+    // Startup phases have the same layout, without means to sum
+    ignition::msgs::Param_V startup;
+    std::map<std::string, double> unused;
+    std::ostringstream startupPhases;
+    if (!name.empty() && node.Request("/world/" + name + "/startup_stats",
+        5000, startup, statsResult) && statsResult)
+    {
+      writeSystemStats(startup, startupPhases, unused);
+    }
+    else
+    {
+      startupPhases << "[]";
+    }
+
+    report << "},\n"
+           << "      \"startup_phases\": " << startupPhases.str() << ",\n"
+           << "      \"systems\": " << systems.str() << "\n"
+           << "    }";
+  }
+  report << (worldCount > 0 ? "\n  ]\n" : "]\n") << "}\n";
+
+  if (_output != nullptr && std::strlen(_output) > 0)
+  {
+    std::ofstream file(_output);
+    file << report.str();
+    if (!file)
+    {
+      ignerr << "Failed to write benchmark report [" << _output << "]"
+             << std::endl;
+      return -1;
+    }
+    ignmsg << "Benchmark report written to [" << _output << "]"
+           << std::endl;
+  }
+  else
+  {
+    std::cout << report.str() << std::flush;
+  }
+
+  return 0;
+}
+
 //////////////////////////////////////////////////
 extern "C" IGNITION_GAZEBO_VISIBLE int runGui(const char *_guiConfig)
 {
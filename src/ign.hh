@@ -64,6 +64,21 @@ extern "C" IGNITION_GAZEBO_VISIBLE int runServer(const char *_sdfString,
     const char *_renderEngineGui, const char *_file,
     const char *_recordTopics);
 
+/// \brief External hook to run a world headless, as fast as possible, and
+/// report how long it took.
+/// \param[in] _sdfString SDF file to run, as a string.
+/// \param[in] _iterations --benchmark option, number of iterations to run.
+/// \param[in] _levels --levels option
+/// \param[in] _physicsEngine --physics-engine option
+/// \param[in] _renderEngineServer --render-engine-server option
+/// \param[in] _file Path to file being loaded
+/// \param[in] _output --benchmark-output option, path of the JSON report.
+/// Leave empty to print it.
+/// \return 0 if successful, -1 if not.
+extern "C" IGNITION_GAZEBO_VISIBLE int runBenchmark(const char *_sdfString,
+    int _iterations, int _levels, const char *_physicsEngine,
+    const char *_renderEngineServer, const char *_file, const char *_output);
+
 /// \brief External hook to run simulation GUI.
 /// \param[in] _guiConfig Path to Ignition GUI configuration file.
 /// \return 0 if successful, 1 if not.
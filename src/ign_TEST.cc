@@ -86,6 +86,26 @@ TEST(CmdLine, Server)
   }
 }
 
+/////////////////////////////////////////////////
+TEST(CmdLine, Benchmark)
+{
+  std::string cmd = kIgnCommand + " --benchmark 20 " +
+    std::string(PROJECT_SOURCE_PATH) + "/test/worlds/shapes.sdf";
+
+  std::cout << "Running command [" << cmd << "]" << std::endl;
+
+  std::string output = customExecStr(cmd);
+  EXPECT_NE(output.find("\"iterations\": 20"), std::string::npos) << output;
+  EXPECT_NE(output.find("\"name\": \"default\""), std::string::npos)
+      << output;
+  EXPECT_NE(output.find("\"real_time_factor\""), std::string::npos)
+      << output;
+  EXPECT_NE(output.find("\"startup_s\""), std::string::npos) << output;
+  EXPECT_NE(output.find("\"startup_phases\""), std::string::npos)
+      << output;
+  EXPECT_NE(output.find("\"systems\""), std::string::npos) << output;
+}
+
 /////////////////////////////////////////////////
 TEST(CmdLine, CachedFuelWorld)
 {
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "LoadBalancer.hh"
+
+#include <algorithm>
+#include <vector>
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Weight of a new sample in the smoothed step time.
+static const double kSmoothing{0.05};
+
+/// \brief Number of periods a performer stays on a secondary after moving.
+static const uint64_t kMigrationCooldown{4};
+
+//////////////////////////////////////////////////
+LoadBalancer::LoadBalancer(double _threshold, uint64_t _period)
+  : threshold(_threshold), period(_period)
+{
+}
+
+//////////////////////////////////////////////////
+void LoadBalancer::AddStepTime(const std::string &_secondary,
+    const std::chrono::steady_clock::duration &_time)
+{
+  const double seconds = std::chrono::duration<double>(_time).count();
+
+  auto it = this->stepTimes.find(_secondary);
+  if (it == this->stepTimes.end())
+    this->stepTimes[_secondary] = seconds;
+  else
+    it->second += kSmoothing * (seconds - it->second);
+}
+
+//////////////////////////////////////////////////
+void LoadBalancer::RemoveSecondary(const std::string &_secondary)
+{
+  this->stepTimes.erase(_secondary);
+}
+
+//////////////////////////////////////////////////
+double LoadBalancer::StepTime(const std::string &_secondary) const
+{
+  auto it = this->stepTimes.find(_secondary);
+  if (it == this->stepTimes.end())
+    return 0.0;
+  return it->second;
+}
+
+//////////////////////////////////////////////////
+std::optional<PerformerMigration> LoadBalancer::Balance(uint64_t _iteration,
+    const std::map<Entity, std::string> &_affinities,
+    const std::map<Entity, std::set<Entity>> &_levels)
+{
+  if (!this->lastBalance)
+    this->lastBalance = _iteration;
+
+  if (_iteration < *this->lastBalance + this->period ||
+      this->stepTimes.size() < 2)
+  {
+    return std::nullopt;
+  }
+
+  // Slowest and fastest secondaries
+  auto [fastest, slowest] = std::minmax_element(this->stepTimes.begin(),
+      this->stepTimes.end(), [](const auto &_a, const auto &_b)
+      {
+        return _a.second < _b.second;
+      });
+
+  if (slowest->second <= 0.0 ||
+      (slowest->second - fastest->second) / slowest->second <
+      this->threshold)
+  {
+    return std::nullopt;
+  }
+
+  std::vector<Entity> onSlowest;
+  std::set<Entity> fastestLevels;
+  for (const auto &[performer, secondary] : _affinities)
+  {
+    if (secondary == slowest->first)
+    {
+      onSlowest.push_back(performer);
+    }
+    else if (secondary == fastest->first)
+    {
+      auto levels = _levels.find(performer);
+      if (levels != _levels.end())
+        fastestLevels.insert(levels->second.begin(), levels->second.end());
+    }
+  }
+
+  // Moving the only performer would just move the bottleneck
+  if (onSlowest.size() < 2)
+    return std::nullopt;
+
+  // Assume performers cost the same. Don't move if that would make the
+  // fastest secondary the bottleneck.
+  const double cost = slowest->second / static_cast<double>(onSlowest.size());
+  if (fastest->second + cost >= slowest->second - cost)
+    return std::nullopt;
+
+  // Among the performers which haven't moved recently, prefer the one
+  // sharing the most levels with performers on the fastest secondary.
+  // onSlowest is sorted, so ties go to the lowest entity.
+  std::optional<Entity> best;
+  std::size_t bestShared{0};
+  for (const auto &performer : onSlowest)
+  {
+    auto last = this->lastMigrations.find(performer);
+    if (last != this->lastMigrations.end() &&
+        _iteration < last->second + kMigrationCooldown * this->period)
+    {
+      continue;
+    }
+
+    std::size_t shared{0};
+    auto levels = _levels.find(performer);
+    if (levels != _levels.end())
+    {
+      for (const auto &level : levels->second)
+        shared += fastestLevels.count(level);
+    }
+
+    if (!best || shared > bestShared)
+    {
+      best = performer;
+      bestShared = shared;
+    }
+  }
+
+  if (!best)
+    return std::nullopt;
+
+  this->lastBalance = _iteration;
+  this->lastMigrations[*best] = _iteration;
+
+  PerformerMigration migration;
+  migration.performer = *best;
+  migration.from = slowest->first;
+  migration.to = fastest->first;
+  return migration;
+}
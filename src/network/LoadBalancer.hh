@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_NETWORK_LOADBALANCER_HH_
+#define IGNITION_GAZEBO_NETWORK_LOADBALANCER_HH_
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Entity.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief A performer to be moved to another secondary.
+    struct PerformerMigration
+    {
+      /// \brief Performer entity.
+      Entity performer{kNullEntity};
+
+      /// \brief Prefix of the secondary the performer is leaving.
+      std::string from;
+
+      /// \brief Prefix of the secondary the performer is moving to.
+      std::string to;
+    };
+
+    /// \brief Decides when performers should move between secondaries, so
+    /// that no secondary holds the others back.
+    ///
+    /// The primary feeds it the step time each secondary reports in its step
+    /// acknowledgement. Every period, if the slowest secondary is slower than
+    /// the fastest one by more than a threshold, one performer is moved from
+    /// the slowest to the fastest. Hysteresis comes from three rules:
+    ///
+    /// * A move only happens if it's expected to reduce the difference
+    ///   instead of reversing it.
+    /// * There's at most one move per period, so the step times can settle.
+    /// * A performer which moved stays put for several periods.
+    class IGNITION_GAZEBO_VISIBLE LoadBalancer
+    {
+      /// \brief Constructor
+      /// \param[in] _threshold Minimum difference between the slowest and
+      /// the fastest secondaries, relative to the slowest, before a
+      /// performer is moved.
+      /// \param[in] _period Minimum number of iterations between moves.
+      public: explicit LoadBalancer(double _threshold = 0.25,
+                  uint64_t _period = 500);
+
+      /// \brief Record the time a secondary took to run one step.
+      /// \param[in] _secondary Prefix of the secondary.
+      /// \param[in] _time Duration of the step.
+      public: void AddStepTime(const std::string &_secondary,
+                  const std::chrono::steady_clock::duration &_time);
+
+      /// \brief Forget a secondary which left the simulation.
+      /// \param[in] _secondary Prefix of the secondary.
+      public: void RemoveSecondary(const std::string &_secondary);
+
+      /// \brief Smoothed step time of a secondary.
+      /// \param[in] _secondary Prefix of the secondary.
+      /// \return Step time in seconds, or zero if nothing was recorded.
+      public: double StepTime(const std::string &_secondary) const;
+
+      /// \brief Decide whether a performer should move now.
+      /// \param[in] _iteration Current iteration.
+      /// \param[in] _affinities Current secondary of each performer.
+      /// \param[in] _levels Current levels of each performer. A performer
+      /// sharing levels with performers on the destination is preferred,
+      /// because the destination already has those levels loaded.
+      /// \return The move to make, if any.
+      public: std::optional<PerformerMigration> Balance(uint64_t _iteration,
+                  const std::map<Entity, std::string> &_affinities,
+                  const std::map<Entity, std::set<Entity>> &_levels);
+
+      /// \brief Minimum relative difference between step times.
+      private: double threshold;
+
+      /// \brief Minimum number of iterations between moves.
+      private: uint64_t period;
+
+      /// \brief Smoothed step time of each secondary, in seconds.
+      private: std::map<std::string, double> stepTimes;
+
+      /// \brief Iteration in which each performer last moved.
+      private: std::map<Entity, uint64_t> lastMigrations;
+
+      /// \brief Iteration of the last move, or of the first call to
+      /// Balance.
+      private: std::optional<uint64_t> lastBalance;
+    };
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_NETWORK_LOADBALANCER_HH_
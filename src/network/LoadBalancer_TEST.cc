@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "LoadBalancer.hh"
+
+using namespace ignition::gazebo;
+using namespace std::chrono_literals;
+
+//////////////////////////////////////////////////
+TEST(LoadBalancer, StepTime)
+{
+  LoadBalancer balancer;
+  EXPECT_DOUBLE_EQ(0.0, balancer.StepTime("a"));
+
+  // The first sample is used as is, later ones are smoothed
+  balancer.AddStepTime("a", 10ms);
+  EXPECT_DOUBLE_EQ(0.01, balancer.StepTime("a"));
+
+  balancer.AddStepTime("a", 20ms);
+  EXPECT_GT(balancer.StepTime("a"), 0.01);
+  EXPECT_LT(balancer.StepTime("a"), 0.02);
+
+  balancer.RemoveSecondary("a");
+  EXPECT_DOUBLE_EQ(0.0, balancer.StepTime("a"));
+}
+
+//////////////////////////////////////////////////
+TEST(LoadBalancer, Balance)
+{
+  LoadBalancer balancer(0.25, 100);
+
+  // Secondary "a" has 4 performers, "b" has 1
+  std::map<Entity, std::string> affinities{
+    {1, "a"}, {2, "a"}, {3, "a"}, {4, "a"}, {5, "b"}};
+  std::map<Entity, std::set<Entity>> levels{
+    {1, {10}}, {2, {10}}, {3, {11}}, {4, {12}}, {5, {11}}};
+
+  balancer.AddStepTime("a", 40ms);
+  balancer.AddStepTime("b", 10ms);
+
+  // The first call starts the period
+  EXPECT_FALSE(balancer.Balance(0, affinities, levels));
+  EXPECT_FALSE(balancer.Balance(99, affinities, levels));
+
+  // Performer 3 shares level 11 with performer 5
+  auto migration = balancer.Balance(100, affinities, levels);
+  ASSERT_TRUE(migration);
+  EXPECT_EQ(3u, migration->performer);
+  EXPECT_EQ("a", migration->from);
+  EXPECT_EQ("b", migration->to);
+  affinities[3] = "b";
+
+  // Nothing moves again during the same period
+  EXPECT_FALSE(balancer.Balance(150, affinities, levels));
+
+  // Next period, another performer moves, but not the one which just moved
+  migration = balancer.Balance(200, affinities, levels);
+  ASSERT_TRUE(migration);
+  EXPECT_NE(3u, migration->performer);
+  EXPECT_EQ("a", affinities[migration->performer]);
+}
+
+//////////////////////////////////////////////////
+TEST(LoadBalancer, Hysteresis)
+{
+  LoadBalancer balancer(0.25, 100);
+  std::map<Entity, std::string> affinities{{1, "a"}, {2, "a"}, {3, "b"}};
+  std::map<Entity, std::set<Entity>> levels;
+
+  EXPECT_FALSE(balancer.Balance(0, affinities, levels));
+
+  // Within the threshold
+  balancer.AddStepTime("a", 12ms);
+  balancer.AddStepTime("b", 10ms);
+  EXPECT_FALSE(balancer.Balance(100, affinities, levels));
+
+  // Above the threshold, but moving one of the 2 performers would just
+  // make "b" the slowest
+  LoadBalancer other(0.25, 100);
+  EXPECT_FALSE(other.Balance(0, affinities, levels));
+  other.AddStepTime("a", 20ms);
+  other.AddStepTime("b", 14ms);
+  EXPECT_FALSE(other.Balance(100, affinities, levels));
+
+  // A single performer is never moved
+  LoadBalancer single(0.25, 100);
+  std::map<Entity, std::string> lonely{{1, "a"}};
+  EXPECT_FALSE(single.Balance(0, lonely, levels));
+  single.AddStepTime("a", 50ms);
+  single.AddStepTime("b", 1ms);
+  EXPECT_FALSE(single.Balance(100, lonely, levels));
+}
@@ -17,6 +17,8 @@
 #ifndef IGNITION_GAZEBO_NETWORK_NETWORKCONFIG_HH_
 #define IGNITION_GAZEBO_NETWORK_NETWORKCONFIG_HH_
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -52,6 +54,55 @@ namespace ignition
 
       /// \brief Expect number of network secondaries.
       public: size_t numSecondariesExpected { 0 };
+
+      /// \brief Whether the primary moves performers between secondaries
+      /// to even out their step times.
+      public: bool loadBalancing { true };
+
+      /// \brief Minimum difference between the step times of the slowest
+      /// and fastest secondaries, relative to the slowest, before a
+      /// performer is moved.
+      public: double loadBalanceThreshold { 0.25 };
+
+      /// \brief Minimum number of iterations between performer moves.
+      public: uint64_t loadBalancePeriod { 500 };
+
+      /// \brief Whether the primary steps its own systems while the
+      /// secondaries run the same step, instead of waiting for them first.
+      /// The primary then applies the secondaries' state one step late, so
+      /// this is only suitable when performers on different secondaries
+      /// don't interact.
+      public: bool pipelined { false };
+
+      /// \brief Whether secondaries acknowledge steps with compact
+      /// private_msgs::StepAck messages, holding a binary state and
+      /// quantized pose deltas, instead of msgs::SerializedStateMap.
+      public: bool binaryStepAcks { true };
+
+      /// \brief Whether the primary sends each secondary its own step
+      /// message, on "<prefix>/step", instead of a single message to all
+      /// of them on "step". The state of a performer which moves to a
+      /// secondary is then only sent to that secondary.
+      public: bool filteredSteps { true };
+
+      /// \brief Period at which peers publish heartbeats.
+      public: std::chrono::steady_clock::duration heartbeatPeriod {
+          std::chrono::milliseconds(100)};
+
+      /// \brief Number of heartbeat periods without hearing from a peer
+      /// before it's considered stale. Together with heartbeatPeriod, this
+      /// can be set to detect failures within a fraction of a second.
+      public: size_t staleMultiplier { 100 };
+
+      /// \brief Maximum time the primary waits for the secondaries to
+      /// acknowledge a step.
+      public: std::chrono::steady_clock::duration stepTimeout {
+          std::chrono::seconds(10)};
+
+      /// \brief Whether simulation continues when a secondary is lost, with
+      /// its performers reassigned to the remaining secondaries. Otherwise,
+      /// losing any peer stops simulation.
+      public: bool reassignLostPerformers { false };
     };
     }
   }  // namespace gazebo
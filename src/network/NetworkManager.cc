@@ -105,6 +105,8 @@ NetworkManager::NetworkManager(
   this->dataPtr->eventMgr = _eventMgr;
   this->dataPtr->tracker = std::make_unique<PeerTracker>(
       this->dataPtr->peerInfo, _eventMgr, _options);
+  this->dataPtr->tracker->SetHeartbeatPeriod(_config.heartbeatPeriod);
+  this->dataPtr->tracker->SetStaleMultiplier(_config.staleMultiplier);
 
   if (_eventMgr)
   {
@@ -117,7 +119,7 @@ NetworkManager::NetworkManager(
     this->dataPtr->peerRemovedConn = _eventMgr->Connect<PeerRemoved>(
         [this](PeerInfo _info)
     {
-      if (_info.Namespace() != this->Namespace())
+      if (_info.Namespace() != this->Namespace() && !this->OnPeerLost(_info))
       {
         ignmsg << "Peer [" << _info.Namespace()
                << "] removed, stopping simulation" << std::endl;
@@ -128,7 +130,7 @@ NetworkManager::NetworkManager(
     this->dataPtr->peerStaleConn = _eventMgr->Connect<PeerStale>(
         [this](PeerInfo _info)
     {
-      if (_info.Namespace() != this->Namespace())
+      if (_info.Namespace() != this->Namespace() && !this->OnPeerLost(_info))
       {
         ignerr << "Peer [" << _info.Namespace()
                << "] went stale, stopping simulation" << std::endl;
@@ -175,3 +177,9 @@ NetworkConfig NetworkManager::Config() const
 {
   return this->dataPtr->config;
 }
+
+//////////////////////////////////////////////////
+bool NetworkManager::OnPeerLost(const PeerInfo &)
+{
+  return false;
+}
@@ -28,6 +28,7 @@
 #include <ignition/gazebo/EventManager.hh>
 
 #include "NetworkConfig.hh"
+#include "PeerInfo.hh"
 
 namespace ignition
 {
@@ -118,6 +119,13 @@ namespace ignition
       /// \return The manager's config.
       public: NetworkConfig Config() const;
 
+      /// \brief Called when another peer disconnects or goes stale. This
+      /// runs on the peer tracker's threads, not the simulation thread.
+      /// \param[in] _info The peer which was lost.
+      /// \return True if simulation can carry on without that peer. Otherwise
+      /// simulation is stopped.
+      protected: virtual bool OnPeerLost(const PeerInfo &_info);
+
       /// \brief Private data
       protected: std::unique_ptr<NetworkManagerPrivate> dataPtr;
     };
@@ -18,10 +18,13 @@
 #include "NetworkManagerPrimary.hh"
 
 #include <algorithm>
-#include <future>
+#include <chrono>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
+#include <variant>
+#include <vector>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
@@ -29,9 +32,12 @@
 
 #include "msgs/peer_control.pb.h"
 #include "msgs/simulation_step.pb.h"
+#include "msgs/step_ack.pb.h"
 
+#include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/PerformerAffinity.hh"
 #include "ignition/gazebo/components/PerformerLevels.hh"
+#include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
@@ -50,11 +56,14 @@ NetworkManagerPrimary::NetworkManagerPrimary(
     EntityComponentManager &_ecm, EventManager *_eventMgr,
     const NetworkConfig &_config, const NodeOptions &_options):
   NetworkManager(_stepFunction, _ecm, _eventMgr, _config, _options),
-  node(_options)
+  node(_options),
+  loadBalancer(_config.loadBalanceThreshold, _config.loadBalancePeriod)
 {
   this->simStepPub = this->node.Advertise<private_msgs::SimulationStep>("step");
 
   this->node.Subscribe("step_ack", &NetworkManagerPrimary::OnStepAck, this);
+  this->node.Subscribe("step_ack_binary",
+      &NetworkManagerPrimary::OnBinaryStepAck, this);
 }
 
 //////////////////////////////////////////////////
@@ -83,6 +92,20 @@ void NetworkManagerPrimary::Handshake()
       {
         ignmsg << "Peer initialized [" << sc->prefix << "]" << std::endl;
         sc->ready = true;
+
+        if (this->dataPtr->config.filteredSteps)
+        {
+          sc->stepPub = this->node.Advertise<private_msgs::SimulationStep>(
+              sc->prefix + "/step");
+
+          // The secondary subscribed before answering, give discovery some
+          // time so the first steps aren't lost
+          for (unsigned int i = 0; i < timeout / 10 &&
+              !sc->stepPub.HasConnections(); ++i)
+          {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          }
+        }
       }
       else
       {
@@ -132,6 +155,11 @@ bool NetworkManagerPrimary::Step(const UpdateInfo &_info)
   private_msgs::SimulationStep step;
   step.mutable_stats()->CopyFrom(convert<msgs::WorldStatistics>(_info));
 
+  // Performers of lost secondaries go first, so they aren't balanced back
+  // onto a secondary which is gone
+  if (!this->ReassignLostPerformers(step))
+    return false;
+
   // Affinities that changed this step
   this->PopulateAffinities(step);
 
@@ -143,36 +171,30 @@ bool NetworkManagerPrimary::Step(const UpdateInfo &_info)
   }
 
   // Send step to all secondaries
-  this->secondaryStates.clear();
-  this->secondaryStatesPromise = std::promise<void>{};
-  auto future = this->secondaryStatesPromise.get_future();
-  this->simStepPub.Publish(step);
+  const uint64_t sequence = ++this->stepSequence;
+  step.set_sequence(sequence);
+  this->PublishStep(step);
 
-  // Block until all secondaries are done
+  std::vector<StepAck> states;
+  if (!this->dataPtr->config.pipelined)
   {
-    IGN_PROFILE("Waiting for secondaries");
-
-    auto result = future.wait_for(10s);
-
-    if (std::future_status::ready != result)
-    {
-      ignerr << "Waited 10 s and got only [" << this->secondaryStates.size()
-             << " / " << this->secondaries.size()
-             << "] responses from secondaries. Stopping simulation."
-             << std::endl;
-      this->dataPtr->eventMgr->Emit<events::Stop>();
+    // Block until all secondaries are done
+    if (!this->WaitForStates(sequence, states))
       return false;
-    }
+    this->ApplyStates(states);
   }
-
-  // Update primary state with states received from secondaries
+  else
   {
-    IGN_PROFILE("Updating primary state");
-    for (const auto &msg : this->secondaryStates)
+    // The secondaries run this step while the primary does. Only block on
+    // the previous step, which is likely done by now, and this step will be
+    // applied in the next iteration.
+    if (this->pendingSequence)
     {
-      this->dataPtr->ecm->SetState(msg);
+      if (!this->WaitForStates(*this->pendingSequence, states))
+        return false;
+      this->ApplyStates(states);
     }
-    this->secondaryStates.clear();
+    this->pendingSequence = sequence;
   }
 
   // Step all systems
@@ -199,13 +221,330 @@ std::map<std::string, SecondaryControl::Ptr>
 //////////////////////////////////////////////////
 void NetworkManagerPrimary::OnStepAck(const msgs::SerializedStateMap &_msg)
 {
-  this->secondaryStates.push_back(_msg);
-  if (this->secondaryStates.size() == this->secondaries.size())
+  this->AddStepAck(_msg.header(), _msg);
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::OnBinaryStepAck(const private_msgs::StepAck &_msg)
+{
+  this->AddStepAck(_msg.header(), _msg);
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::AddStepAck(const msgs::Header &_header,
+    StepAck &&_ack)
+{
+  uint64_t sequence{0};
+  std::string prefix;
+  for (const auto &data : _header.data())
+  {
+    if (data.value_size() == 0)
+      continue;
+    if (data.key() == "step_sequence")
+      sequence = std::stoull(data.value(0));
+    else if (data.key() == "secondary_prefix")
+      prefix = data.value(0);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+    this->secondaryStates[sequence][prefix] = std::move(_ack);
+  }
+  this->secondaryStatesCv.notify_all();
+}
+
+//////////////////////////////////////////////////
+bool NetworkManagerPrimary::WaitForStates(uint64_t _sequence,
+    std::vector<StepAck> &_states)
+{
+  IGN_PROFILE("Waiting for secondaries");
+
+  std::unique_lock<std::mutex> lock(this->secondaryStatesMutex);
+
+  // Secondaries which haven't acknowledged the step and haven't been lost
+  auto missing = [&]
+  {
+    std::vector<std::string> result;
+    auto it = this->secondaryStates.find(_sequence);
+    for (const auto &secondary : this->secondaries)
+    {
+      if (this->lostSecondaries.count(secondary.first) == 0 &&
+          (it == this->secondaryStates.end() ||
+           it->second.count(secondary.first) == 0))
+      {
+        result.push_back(secondary.first);
+      }
+    }
+    return result;
+  };
+
+  // Lost secondaries wake this up, so it doesn't wait for the timeout
+  const auto &timeout = this->dataPtr->config.stepTimeout;
+  bool received = this->secondaryStatesCv.wait_for(lock, timeout, [&]
+      {
+        return missing().empty();
+      });
+
+  if (!received)
+  {
+    const auto late = missing();
+    const double seconds = std::chrono::duration<double>(timeout).count();
+    if (!this->dataPtr->config.reassignLostPerformers)
+    {
+      ignerr << "Waited " << seconds << " s and got only ["
+             << this->secondaries.size() - late.size() << " / "
+             << this->secondaries.size()
+             << "] responses from secondaries. Stopping simulation."
+             << std::endl;
+      this->dataPtr->eventMgr->Emit<events::Stop>();
+      return false;
+    }
+
+    // Carry on without the secondaries which didn't answer
+    for (const auto &prefix : late)
+    {
+      ignerr << "Secondary [" << prefix << "] didn't answer within "
+             << seconds << " s, reassigning its performers." << std::endl;
+      this->lostSecondaries.insert(prefix);
+    }
+  }
+
+  // Acknowledgements from lost secondaries are dropped, their performers
+  // belong to other secondaries now
+  for (auto &[prefix, ack] : this->secondaryStates[_sequence])
+  {
+    if (this->secondaries.find(prefix) != this->secondaries.end() &&
+        this->lostSecondaries.count(prefix) == 0)
+    {
+      _states.push_back(std::move(ack));
+    }
+  }
+
+  // Drop this step and any older ones which will never complete
+  this->secondaryStates.erase(this->secondaryStates.begin(),
+      this->secondaryStates.upper_bound(_sequence));
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::ApplyStates(std::vector<StepAck> &_states)
+{
+  IGN_PROFILE("Updating primary state");
+  for (auto &ack : _states)
+  {
+    const auto &header = std::holds_alternative<msgs::SerializedStateMap>(ack) ?
+        std::get<msgs::SerializedStateMap>(ack).header() :
+        std::get<private_msgs::StepAck>(ack).header();
+
+    // Each secondary encodes its own stream of states, and reports how long
+    // its step took
+    std::string prefix;
+    std::chrono::nanoseconds stepTime{-1};
+    for (const auto &data : header.data())
+    {
+      if (data.value_size() == 0)
+        continue;
+      if (data.key() == "secondary_prefix")
+        prefix = data.value(0);
+      else if (data.key() == "step_time")
+        stepTime = std::chrono::nanoseconds(std::stoll(data.value(0)));
+    }
+    if (!prefix.empty() && stepTime.count() >= 0)
+      this->loadBalancer.AddStepTime(prefix, stepTime);
+
+    if (auto msg = std::get_if<msgs::SerializedStateMap>(&ack))
+    {
+      if (!prefix.empty())
+        this->stateDecoders[prefix].Decode(*msg);
+      this->dataPtr->ecm->SetState(*msg);
+    }
+    else
+    {
+      this->ApplyBinaryStepAck(prefix, std::get<private_msgs::StepAck>(ack));
+    }
+  }
+  _states.clear();
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::ApplyBinaryStepAck(const std::string &_prefix,
+    const private_msgs::StepAck &_msg)
+{
+  auto &ecm = *this->dataPtr->ecm;
+
+  // Create entities and components first, so poses have somewhere to go
+  if (!_msg.state().empty())
+    ecm.SetBinaryState(_msg.state().data(), _msg.state().size());
+
+  if (_msg.poses().empty())
+    return;
+
+  std::vector<Entity> changed;
+  auto &decoder = this->poseDecoders[_prefix];
+  if (!decoder.Decode(_msg.poses(), changed))
+  {
+    // Deltas are dropped until the next keyframe
+    igndbg << "Skipped a pose frame from secondary [" << _prefix << "]"
+           << std::endl;
+    return;
+  }
+
+  const auto &poses = decoder.Poses();
+  for (const auto &entity : changed)
+  {
+    if (!ecm.HasEntity(entity))
+      continue;
+
+    const auto &pose = poses.at(entity);
+    auto poseComp = ecm.Component<components::Pose>(entity);
+    if (nullptr == poseComp)
+    {
+      ecm.CreateComponent(entity, components::Pose(pose));
+      continue;
+    }
+
+    poseComp->Data() = pose;
+    ecm.SetChanged(entity, components::Pose::typeId,
+        ComponentState::PeriodicChange);
+  }
+}
+
+//////////////////////////////////////////////////
+bool NetworkManagerPrimary::OnPeerLost(const PeerInfo &_info)
+{
+  if (!this->dataPtr->config.reassignLostPerformers ||
+      _info.role != NetworkRole::SimulationSecondary)
+  {
+    return false;
+  }
+
+  ignerr << "Lost secondary [" << _info.Namespace()
+         << "], its performers will be reassigned." << std::endl;
+
+  {
+    std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+    this->lostSecondaries.insert(_info.id.substr(0, 8));
+  }
+
+  // Stop waiting for its acknowledgements
+  this->secondaryStatesCv.notify_all();
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool NetworkManagerPrimary::ReassignLostPerformers(
+    private_msgs::SimulationStep &_msg)
+{
+  std::set<std::string> lost;
+  {
+    std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+    for (const auto &prefix : this->lostSecondaries)
+    {
+      if (this->secondaries.erase(prefix) > 0)
+        lost.insert(prefix);
+    }
+  }
+
+  if (lost.empty())
+    return true;
+
+  if (this->secondaries.empty())
+  {
+    ignerr << "All secondaries were lost. Stopping simulation." << std::endl;
+    this->dataPtr->eventMgr->Emit<events::Stop>();
+    return false;
+  }
+
+  for (const auto &prefix : lost)
+  {
+    this->stateDecoders.erase(prefix);
+    this->poseDecoders.erase(prefix);
+    this->loadBalancer.RemoveSecondary(prefix);
+  }
+
+  std::vector<Entity> orphans;
+  this->dataPtr->ecm->Each<components::PerformerAffinity>(
+      [&](const Entity &_entity,
+          const components::PerformerAffinity *_affinity) -> bool
+      {
+        if (lost.find(_affinity->Data()) != lost.end())
+          orphans.push_back(_entity);
+        return true;
+      });
+
+  // Round-robin the orphans across the remaining secondaries. They resume
+  // from the last state the primary received.
+  auto secondaryIt = this->secondaries.begin();
+  for (const auto &performer : orphans)
+  {
+    ignmsg << "Reassigning performer [" << performer << "] to secondary ["
+           << secondaryIt->first << "]." << std::endl;
+
+    auto affinityMsg = _msg.add_affinity();
+    this->SetAffinity(performer, secondaryIt->first, affinityMsg);
+    this->PopulatePerformerState(performer, affinityMsg);
+
+    secondaryIt++;
+    if (secondaryIt == this->secondaries.end())
+      secondaryIt = this->secondaries.begin();
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::PopulatePerformerState(Entity _performer,
+    private_msgs::PerformerAffinity *_msg)
+{
+  // Secondaries remove the models of performers assigned elsewhere
+  auto parent = this->dataPtr->ecm->Component<components::ParentEntity>(
+      _performer);
+  if (nullptr != parent)
   {
-    this->secondaryStatesPromise.set_value();
+    this->dataPtr->ecm->State(*_msg->mutable_state(),
+        this->dataPtr->ecm->Descendants(parent->Data()), {}, true);
   }
 }
 
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::PublishStep(private_msgs::SimulationStep &_msg)
+{
+  IGN_PROFILE("NetworkManagerPrimary::PublishStep");
+
+  if (!this->dataPtr->config.filteredSteps)
+  {
+    this->simStepPub.Publish(_msg);
+    return;
+  }
+
+  // Every secondary needs all affinities, to remove performers assigned
+  // elsewhere, but a performer's state is only needed where it moves to.
+  // States are swapped in and out instead of copied.
+  const int count = _msg.affinity_size();
+  std::vector<msgs::SerializedStateMap> states(count);
+  for (int i = 0; i < count; ++i)
+    states[i].Swap(_msg.mutable_affinity(i)->mutable_state());
+
+  for (const auto &secondary : this->secondaries)
+  {
+    for (int i = 0; i < count; ++i)
+    {
+      if (_msg.affinity(i).secondary_prefix() == secondary.first)
+        states[i].Swap(_msg.mutable_affinity(i)->mutable_state());
+    }
+
+    secondary.second->stepPub.Publish(_msg);
+
+    for (int i = 0; i < count; ++i)
+    {
+      if (_msg.affinity(i).secondary_prefix() == secondary.first)
+        states[i].Swap(_msg.mutable_affinity(i)->mutable_state());
+    }
+  }
+
+  for (int i = 0; i < count; ++i)
+    states[i].Swap(_msg.mutable_affinity(i)->mutable_state());
+}
+
 //////////////////////////////////////////////////
 bool NetworkManagerPrimary::SecondariesCanStep() const
 {
@@ -213,7 +552,15 @@ bool NetworkManagerPrimary::SecondariesCanStep() const
   // number of expected secondaries, but there's no interface for that
   // on ign-transport yet:
   // https://github.com/ignitionrobotics/ign-transport/issues/39
-  return this->simStepPub.HasConnections();
+  if (!this->dataPtr->config.filteredSteps)
+    return this->simStepPub.HasConnections();
+
+  for (const auto &secondary : this->secondaries)
+  {
+    if (!secondary.second->stepPub.HasConnections())
+      return false;
+  }
+  return !this->secondaries.empty();
 }
 
 //////////////////////////////////////////////////
@@ -232,6 +579,9 @@ void NetworkManagerPrimary::PopulateAffinities(
   // Updated performer-to-level mapping - used to update affinities
   std::map<Entity, std::set<Entity>> lToPNew;
 
+  // Updated level-to-performer mapping - used to balance load
+  std::map<Entity, std::set<Entity>> pToLNew;
+
   // All performers
   std::set<Entity> allPerformers;
 
@@ -256,6 +606,7 @@ void NetworkManagerPrimary::PopulateAffinities(
       {
         lToPNew[level].insert(_entity);
       }
+      pToLNew[_entity] = _perfLevels->Data();
 
       return true;
     });
@@ -301,6 +652,28 @@ void NetworkManagerPrimary::PopulateAffinities(
   }
 
   // TODO(louise) Process level changes
+
+  if (!this->dataPtr->config.loadBalancing)
+    return;
+
+  // Move a performer away from the slowest secondary
+  auto migration = this->loadBalancer.Balance(_msg.stats().iterations(),
+      pToSPrevious, pToLNew);
+  if (!migration)
+    return;
+
+  ignmsg << "Moving performer [" << migration->performer << "] from secondary ["
+         << migration->from << "] (" << this->loadBalancer.StepTime(
+         migration->from) * 1e3 << " ms per step) to secondary ["
+         << migration->to << "] (" << this->loadBalancer.StepTime(
+         migration->to) * 1e3 << " ms per step)." << std::endl;
+
+  auto affinityMsg = _msg.add_affinity();
+  this->SetAffinity(migration->performer, migration->to, affinityMsg);
+
+  // The destination removed the performer's model when it was first assigned
+  // elsewhere, so send it along
+  this->PopulatePerformerState(migration->performer, affinityMsg);
 }
 
 //////////////////////////////////////////////////
@@ -18,19 +18,27 @@
 #define IGNITION_GAZEBO_NETWORK_NETWORKMANAGERPRIMARY_HH_
 
 #include <atomic>
-#include <future>
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <string>
+#include <variant>
 #include <vector>
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/Export.hh>
 #include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/PoseDeltaStream.hh>
+#include <ignition/gazebo/StateDelta.hh>
 #include <ignition/transport/Node.hh>
 
 #include "msgs/simulation_step.pb.h"
+#include "msgs/step_ack.pb.h"
 
+#include "LoadBalancer.hh"
 #include "NetworkManager.hh"
 
 namespace ignition
@@ -50,6 +58,10 @@ namespace ignition
       /// \brief prefix namespace of the secondary peer
       std::string prefix;
 
+      /// \brief Publisher of the steps meant for this secondary only, used
+      /// with NetworkConfig::filteredSteps.
+      ignition::transport::Node::Publisher stepPub;
+
       /// \brief Convenience alias for unique_ptr.
       using Ptr = std::unique_ptr<SecondaryControl>;
     };
@@ -88,18 +100,71 @@ namespace ignition
       /// peers.
       public: std::map<std::string, SecondaryControl::Ptr>& Secondaries();
 
+      /// \brief Step acknowledgement from a secondary, in either format.
+      private: using StepAck =
+          std::variant<msgs::SerializedStateMap, private_msgs::StepAck>;
+
       /// \brief Callback for step ack messages.
       /// \param[in] _msg Message containing secondary's updated state.
       private: void OnStepAck(const msgs::SerializedStateMap &_msg);
 
-      /// \brief Check if the step publisher has connections.
+      /// \brief Callback for compact step ack messages.
+      /// \param[in] _msg Message containing secondary's updated state.
+      private: void OnBinaryStepAck(const private_msgs::StepAck &_msg);
+
+      /// \brief Store a step acknowledgement until its step is applied.
+      /// \param[in] _header Header of the acknowledgement.
+      /// \param[in] _ack The acknowledgement.
+      private: void AddStepAck(const msgs::Header &_header, StepAck &&_ack);
+
+      /// \brief Apply a compact step acknowledgement to the primary's state.
+      /// \param[in] _prefix Prefix of the secondary which sent it.
+      /// \param[in] _msg The acknowledgement.
+      private: void ApplyBinaryStepAck(const std::string &_prefix,
+          const private_msgs::StepAck &_msg);
+
+      /// \brief Send a step to the secondaries, either as a single message
+      /// or filtered for each secondary.
+      /// \param[in] _msg Step message. Its performer states are moved around
+      /// while publishing, but it's left unchanged.
+      private: void PublishStep(private_msgs::SimulationStep &_msg);
+
+      /// \brief Check if the step publishers have connections.
       private: bool SecondariesCanStep() const;
 
+      /// \brief Block until all secondaries acknowledged a step.
+      /// \param[in] _sequence Sequence number of the step.
+      /// \param[out] _states States received from the secondaries.
+      /// \return False if some secondaries didn't answer in time.
+      private: bool WaitForStates(uint64_t _sequence,
+          std::vector<StepAck> &_states);
+
+      /// \brief Update the primary's state with states received from
+      /// secondaries.
+      /// \param[in] _states States received from the secondaries.
+      private: void ApplyStates(std::vector<StepAck> &_states);
+
       /// \brief Populate the step message with the latest affinities according
       /// to levels.
       /// \param[in] _msg Step message.
       private: void PopulateAffinities(private_msgs::SimulationStep &_msg);
 
+      // Documentation inherited
+      protected: bool OnPeerLost(const PeerInfo &_info) override;
+
+      /// \brief Reassign the performers of lost secondaries to the remaining
+      /// ones.
+      /// \param[in] _msg Step message, populated with the new affinities.
+      /// \return False if no secondaries are left.
+      private: bool ReassignLostPerformers(private_msgs::SimulationStep &_msg);
+
+      /// \brief Populate an affinity message with the full state of the
+      /// performer's model, for a secondary which doesn't have it.
+      /// \param[in] _performer Performer entity.
+      /// \param[out] _msg Message to be populated.
+      private: void PopulatePerformerState(Entity _performer,
+          private_msgs::PerformerAffinity *_msg);
+
       /// \brief Set the performer to secondary affinity.
       /// \param[in] _performer Performer entity.
       /// \param[in] _secondary Secondary identifier.
@@ -116,11 +181,38 @@ namespace ignition
       /// \brief Publisher for network step sync
       private: ignition::transport::Node::Publisher simStepPub;
 
-      /// \brief Keep track of states received from secondaries.
-      private: std::vector<msgs::SerializedStateMap> secondaryStates;
+      /// \brief States received from secondaries, keyed by the sequence
+      /// number of the step they answer, then by secondary prefix.
+      private: std::map<uint64_t, std::map<std::string, StepAck>>
+          secondaryStates;
+
+      /// \brief Prefixes of secondaries which disconnected, went stale or
+      /// didn't answer in time, and whose performers must be reassigned.
+      private: std::set<std::string> lostSecondaries;
+
+      /// \brief Protects secondaryStates and lostSecondaries.
+      private: std::mutex secondaryStatesMutex;
+
+      /// \brief Notified when a state is received from a secondary.
+      private: std::condition_variable secondaryStatesCv;
+
+      /// \brief Sequence number of the last step sent to secondaries.
+      private: uint64_t stepSequence{0};
+
+      /// \brief In pipelined mode, the sequence number of the step whose
+      /// acknowledgements haven't been applied yet.
+      private: std::optional<uint64_t> pendingSequence;
+
+      /// \brief Restores the delta encoded components of each secondary's
+      /// states, keyed by secondary prefix.
+      private: std::map<std::string, StateDeltaDecoder> stateDecoders;
+
+      /// \brief Restores the poses of each secondary's compact
+      /// acknowledgements, keyed by secondary prefix.
+      private: std::map<std::string, PoseDeltaDecoder> poseDecoders;
 
-      /// \brief Promise used to notify when all secondaryStates where received.
-      private: std::promise<void> secondaryStatesPromise;
+      /// \brief Moves performers away from the slowest secondaries.
+      private: LoadBalancer loadBalancer;
     };
     }
   }  // namespace gazebo
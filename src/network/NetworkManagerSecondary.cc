@@ -16,7 +16,10 @@
 */
 
 #include <algorithm>
+#include <chrono>
+#include <map>
 #include <string>
+#include <unordered_set>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
@@ -24,7 +27,12 @@
 
 #include "msgs/peer_control.pb.h"
 
+#include "ignition/gazebo/components/Collision.hh"
 #include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/PerformerAffinity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/Static.hh"
+#include "ignition/gazebo/components/Visual.hh"
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
@@ -59,9 +67,21 @@ NetworkManagerSecondary::NetworkManagerSecondary(
       << std::endl;
   }
 
+  // The primary sends steps on one of these, see NetworkConfig::filteredSteps
   this->node.Subscribe("step", &NetworkManagerSecondary::OnStep, this);
+  this->node.Subscribe(this->Namespace() + "/step",
+      &NetworkManagerSecondary::OnStep, this);
 
-  this->stepAckPub = this->node.Advertise<msgs::SerializedStateMap>("step_ack");
+  if (this->dataPtr->config.binaryStepAcks)
+  {
+    this->stepAckPub =
+        this->node.Advertise<private_msgs::StepAck>("step_ack_binary");
+  }
+  else
+  {
+    this->stepAckPub =
+        this->node.Advertise<msgs::SerializedStateMap>("step_ack");
+  }
 }
 
 //////////////////////////////////////////////////
@@ -96,6 +116,15 @@ bool NetworkManagerSecondary::OnControl(const private_msgs::PeerControl &_req,
   return true;
 }
 
+//////////////////////////////////////////////////
+bool NetworkManagerSecondary::OnPeerLost(const PeerInfo &_info)
+{
+  // The primary reassigns the performers of other secondaries, but nothing
+  // can go on without the primary
+  return this->dataPtr->config.reassignLostPerformers &&
+      _info.role == NetworkRole::SimulationSecondary;
+}
+
 /////////////////////////////////////////////////
 void NetworkManagerSecondary::OnStep(
     const private_msgs::SimulationStep &_msg)
@@ -117,7 +146,21 @@ void NetworkManagerSecondary::OnStep(
 
     if (affinityMsg.secondary_prefix() == this->Namespace())
     {
+      // A performer moving from another secondary comes with its state
+      if (!this->dataPtr->ecm->HasEntity(entityId) &&
+          affinityMsg.state().entities_size() > 0)
+      {
+        this->dataPtr->ecm->SetState(affinityMsg.state());
+      }
+
       this->performers.insert(entityId);
+      this->MarkUnchanging(entityId);
+
+      // The level manager only loads levels for performers assigned here
+      this->dataPtr->ecm->RemoveComponent<components::PerformerAffinity>(
+          entityId);
+      this->dataPtr->ecm->CreateComponent(entityId,
+          components::PerformerAffinity(this->Namespace()));
 
       ignmsg << "Secondary [" << this->Namespace()
              << "] assigned affinity to performer [" << entityId << "]."
@@ -126,9 +169,19 @@ void NetworkManagerSecondary::OnStep(
     // If performer has been assigned to another secondary, remove it
     else
     {
+      // The performer may have been removed already, when it was first
+      // assigned to another secondary
       auto parent =
           this->dataPtr->ecm->Component<components::ParentEntity>(entityId);
-      this->dataPtr->ecm->RequestRemoveEntity(parent->Data());
+      if (nullptr != parent)
+      {
+        for (const auto &entity :
+            this->dataPtr->ecm->Descendants(parent->Data()))
+        {
+          this->unchangingEntities.erase(entity);
+        }
+        this->dataPtr->ecm->RequestRemoveEntity(parent->Data());
+      }
 
       if (this->performers.find(entityId) != this->performers.end())
       {
@@ -144,7 +197,9 @@ void NetworkManagerSecondary::OnStep(
   auto info = convert<UpdateInfo>(_msg.stats());
 
   // Step runner
+  auto stepStart = std::chrono::steady_clock::now();
   this->dataPtr->stepFunction(info);
+  auto stepTime = std::chrono::steady_clock::now() - stepStart;
 
   // Update state with all the performer's entities
   std::unordered_set<Entity> entities;
@@ -164,18 +219,120 @@ void NetworkManagerSecondary::OnStep(
     entities.insert(children.begin(), children.end());
   }
 
-  msgs::SerializedStateMap stateMsg;
-  if (!entities.empty())
-    this->dataPtr->ecm->State(stateMsg, entities);
-  // Note on merging forward:
-  // `has_one_time_component_changes` field is available in Edifice so this
-  // workaround can be removed
-  auto data = stateMsg.mutable_header()->add_data();
-  data->set_key("has_one_time_component_changes");
-  data->add_value(this->dataPtr->ecm->HasOneTimeComponentChanges() ? "1" : "0");
+  auto headerData = [&](msgs::Header *_header)
+  {
+    // The primary keeps decoders per secondary
+    auto data = _header->add_data();
+    data->set_key("secondary_prefix");
+    data->add_value(this->Namespace());
+
+    // Lets the primary match acknowledgements to steps
+    data = _header->add_data();
+    data->set_key("step_sequence");
+    data->add_value(std::to_string(_msg.sequence()));
+
+    // The primary balances performers according to step times
+    data = _header->add_data();
+    data->set_key("step_time");
+    data->add_value(std::to_string(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+        stepTime).count()));
+  };
+
+  if (this->dataPtr->config.binaryStepAcks)
+  {
+    private_msgs::StepAck ackMsg;
+    this->BinaryStepAck(entities, info, ackMsg);
+    headerData(ackMsg.mutable_header());
+    this->stepAckPub.Publish(ackMsg);
+  }
+  else
+  {
+    msgs::SerializedStateMap stateMsg;
+    if (!entities.empty())
+      this->dataPtr->ecm->State(stateMsg, entities);
+    // Note on merging forward:
+    // `has_one_time_component_changes` field is available in Edifice so this
+    // workaround can be removed
+    auto data = stateMsg.mutable_header()->add_data();
+    data->set_key("has_one_time_component_changes");
+    data->add_value(
+        this->dataPtr->ecm->HasOneTimeComponentChanges() ? "1" : "0");
 
-  this->stepAckPub.Publish(stateMsg);
+    this->stateEncoder.Encode(stateMsg);
+    headerData(stateMsg.mutable_header());
+    this->stepAckPub.Publish(stateMsg);
+  }
 
   this->dataPtr->ecm->SetAllComponentsUnchanged();
 }
 
+/////////////////////////////////////////////////
+void NetworkManagerSecondary::BinaryStepAck(
+    const std::unordered_set<Entity> &_entities, const UpdateInfo &_info,
+    private_msgs::StepAck &_msg)
+{
+  IGN_PROFILE("NetworkManagerSecondary::BinaryStepAck");
+
+  if (_entities.empty())
+    return;
+
+  auto &ecm = *this->dataPtr->ecm;
+
+  // Poses make up most of each step, so they go in the pose stream instead,
+  // quantized and only when they moved.
+  std::unordered_set<ComponentTypeId> types;
+  std::map<Entity, math::Pose3d> poses;
+  bool unchangingMoved{false};
+  for (const auto &entity : _entities)
+  {
+    auto entityTypes = ecm.ComponentTypes(entity);
+    types.insert(entityTypes.begin(), entityTypes.end());
+
+    auto pose = ecm.Component<components::Pose>(entity);
+    if (nullptr == pose)
+      continue;
+
+    // Entities which can't move are left out of the stream, so keyframes
+    // don't carry them. If one is moved anyway, for example by a user
+    // command, its pose goes in the state.
+    if (this->unchangingEntities.find(entity) !=
+        this->unchangingEntities.end())
+    {
+      unchangingMoved |= ecm.ComponentState(entity,
+          components::Pose::typeId) != ComponentState::NoChange;
+      continue;
+    }
+    poses[entity] = pose->Data();
+  }
+  if (!unchangingMoved)
+    types.erase(components::Pose::typeId);
+
+  // An empty set would mean all types
+  if (!types.empty())
+    ecm.BinaryState(*_msg.mutable_state(), _entities, types);
+
+  this->poseEncoder.Encode(poses, _info.simTime, *_msg.mutable_poses());
+}
+
+/////////////////////////////////////////////////
+void NetworkManagerSecondary::MarkUnchanging(Entity _performer)
+{
+  auto &ecm = *this->dataPtr->ecm;
+  auto parent = ecm.Component<components::ParentEntity>(_performer);
+  if (nullptr == parent)
+    return;
+
+  // Nothing in a static model moves, and visuals and collisions are fixed to
+  // their links
+  auto staticComp = ecm.Component<components::Static>(parent->Data());
+  const bool isStatic = nullptr != staticComp && staticComp->Data();
+  for (const auto &entity : ecm.Descendants(parent->Data()))
+  {
+    if (isStatic || nullptr != ecm.Component<components::Visual>(entity) ||
+        nullptr != ecm.Component<components::Collision>(entity))
+    {
+      this->unchangingEntities.insert(entity);
+    }
+  }
+}
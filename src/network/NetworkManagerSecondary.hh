@@ -24,10 +24,13 @@
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/PoseDeltaStream.hh>
+#include <ignition/gazebo/StateDelta.hh>
 #include <ignition/transport/Node.hh>
 
 #include "msgs/simulation_step.pb.h"
 #include "msgs/peer_control.pb.h"
+#include "msgs/step_ack.pb.h"
 
 #include "NetworkManager.hh"
 
@@ -66,10 +69,28 @@ namespace ignition
       public: bool OnControl(const private_msgs::PeerControl &_req,
                              private_msgs::PeerControl &_resp);
 
+      // Documentation inherited
+      protected: bool OnPeerLost(const PeerInfo &_info) override;
+
       /// \brief Callback when step commands are received from the primary
       /// \param[in] _msg Step message.
       private: void OnStep(const private_msgs::SimulationStep &_msg);
 
+      /// \brief Populate a compact step acknowledgement with the state of
+      /// the performers' entities.
+      /// \param[in] _entities Entities belonging to the performers.
+      /// \param[in] _info Info of the step which just ran.
+      /// \param[out] _msg Message to be populated.
+      private: void BinaryStepAck(const std::unordered_set<Entity> &_entities,
+          const UpdateInfo &_info, private_msgs::StepAck &_msg);
+
+      /// \brief Find the entities of a performer's model which never move,
+      /// when the performer is assigned to this secondary. They're left out
+      /// of the pose stream of compact step acknowledgements, since the
+      /// primary already has their poses.
+      /// \param[in] _performer Performer entity.
+      private: void MarkUnchanging(Entity _performer);
+
       /// \brief Flag to control enabling/disabling simulation secondary.
       private: std::atomic<bool> enableSim {false};
 
@@ -81,6 +102,18 @@ namespace ignition
 
       /// \brief Collection of performers associated with this secondary.
       private: std::unordered_set<Entity> performers;
+
+      /// \brief Entities of the performers' models which never move, see
+      /// MarkUnchanging.
+      private: std::unordered_set<Entity> unchangingEntities;
+
+      /// \brief Delta encodes large components of the step
+      /// acknowledgements.
+      private: StateDeltaEncoder stateEncoder;
+
+      /// \brief Quantizes and delta encodes the poses of compact step
+      /// acknowledgements.
+      private: PoseDeltaEncoder poseEncoder;
     };
     }
   }  // namespace gazebo
@@ -127,13 +127,19 @@ void PeerTracker::HeartbeatLoop()
     lastUpdateTime = Clock::now();
     this->heartbeatPub.Publish(toProto(this->info));
 
+    // Stale peers are handled outside the lock, so their events don't hold
+    // up heartbeats received meanwhile
     std::vector<PeerInfo> toRemove;
-    for (auto peer : this->peers)
     {
-      auto age = Clock::now() - peer.second.lastSeen;
-      if (age > (this->staleMultiplier * this->heartbeatPeriod))
+      auto lock = PeerLock(this->peersMutex);
+      const auto now = Clock::now();
+      for (const auto &peer : this->peers)
       {
-        toRemove.push_back(peer.second.info);
+        auto age = now - peer.second.lastSeen;
+        if (age > (this->staleMultiplier * this->heartbeatPeriod))
+        {
+          toRemove.push_back(peer.second.info);
+        }
       }
     }
 
@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/VideoEncoder.hh>
+
+#include "ignition/gazebo/rendering/AsyncVideoEncoder.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief A frame waiting to be encoded.
+struct QueuedFrame
+{
+  /// \brief RGB data.
+  std::vector<unsigned char> data;
+
+  /// \brief Width in pixels.
+  unsigned int width{0};
+
+  /// \brief Height in pixels.
+  unsigned int height{0};
+
+  /// \brief Time of the frame.
+  std::chrono::steady_clock::time_point timestamp;
+};
+
+/// \brief Private data class for AsyncVideoEncoder
+class ignition::gazebo::AsyncVideoEncoderPrivate
+{
+  /// \brief Encoder thread.
+  public: void EncodeLoop();
+
+  /// \brief Underlying encoder, only used by the encoder thread once
+  /// started.
+  public: common::VideoEncoder encoder;
+
+  /// \brief Frames waiting to be encoded, oldest first.
+  public: std::deque<QueuedFrame> queue;
+
+  /// \brief Buffers of encoded frames, reused for new frames.
+  public: std::vector<std::vector<unsigned char>> freeBuffers;
+
+  /// \brief Maximum queue size.
+  public: std::size_t queueSize{8};
+
+  /// \brief True to drop frames when the queue is full.
+  public: bool dropFrames{true};
+
+  /// \brief Time between frames of the video.
+  public: std::chrono::duration<double> period{0.0};
+
+  /// \brief Time of the latest queued frame, only used by the thread adding
+  /// frames.
+  public: std::optional<std::chrono::steady_clock::time_point> lastFrameTime;
+
+  /// \brief True to stop once the queue is empty.
+  public: bool stop{false};
+
+  /// \brief Protects the queue, buffers and stop flag.
+  public: std::mutex mutex;
+
+  /// \brief Notifies about new frames, free space and stopping.
+  public: std::condition_variable cv;
+
+  /// \brief Encoder thread.
+  public: std::thread thread;
+
+  /// \brief Result of stopping the underlying encoder.
+  public: bool stopResult{false};
+
+  /// \brief Called when the underlying encoder accepts a frame.
+  public: std::function<void(const std::chrono::steady_clock::time_point &)>
+      frameEncodedCb;
+
+  /// \brief Frame statistics.
+  public: std::atomic<uint64_t> queued{0};
+
+  /// \brief Frame statistics.
+  public: std::atomic<uint64_t> encoded{0};
+
+  /// \brief Frame statistics.
+  public: std::atomic<uint64_t> dropped{0};
+};
+
+/////////////////////////////////////////////////
+void AsyncVideoEncoderPrivate::EncodeLoop()
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (true)
+  {
+    this->cv.wait(lock, [this]
+    {
+      return this->stop || !this->queue.empty();
+    });
+    if (this->queue.empty())
+      break;
+
+    QueuedFrame frame = std::move(this->queue.front());
+    this->queue.pop_front();
+    auto cb = this->frameEncodedCb;
+    lock.unlock();
+    this->cv.notify_all();
+
+    {
+      IGN_PROFILE("AsyncVideoEncoder::EncodeLoop AddFrame");
+      if (this->encoder.AddFrame(frame.data.data(), frame.width,
+          frame.height, frame.timestamp))
+      {
+        ++this->encoded;
+        if (cb)
+          cb(frame.timestamp);
+      }
+    }
+
+    lock.lock();
+    this->freeBuffers.push_back(std::move(frame.data));
+  }
+  lock.unlock();
+
+  this->stopResult = this->encoder.Stop();
+}
+
+/////////////////////////////////////////////////
+AsyncVideoEncoder::AsyncVideoEncoder()
+  : dataPtr(std::make_unique<AsyncVideoEncoderPrivate>())
+{
+}
+
+/////////////////////////////////////////////////
+AsyncVideoEncoder::~AsyncVideoEncoder()
+{
+  this->Stop();
+}
+
+/////////////////////////////////////////////////
+bool AsyncVideoEncoder::Start(const std::string &_format,
+    const std::string &_filename, unsigned int _width, unsigned int _height,
+    unsigned int _fps, unsigned int _bitRate, std::size_t _queueSize,
+    bool _dropFrames)
+{
+  if (this->IsEncoding())
+  {
+    ignwarn << "Video encoder already started." << std::endl;
+    return false;
+  }
+
+  if (!this->dataPtr->encoder.Start(_format, _filename, _width, _height,
+      _fps, _bitRate))
+  {
+    return false;
+  }
+
+  this->dataPtr->queueSize = std::max<std::size_t>(1u, _queueSize);
+  this->dataPtr->dropFrames = _dropFrames;
+  this->dataPtr->period = std::chrono::duration<double>(
+      1.0 / std::max(1u, _fps));
+  this->dataPtr->lastFrameTime.reset();
+  this->dataPtr->stop = false;
+  this->dataPtr->queued = 0;
+  this->dataPtr->encoded = 0;
+  this->dataPtr->dropped = 0;
+  this->dataPtr->thread = std::thread(&AsyncVideoEncoderPrivate::EncodeLoop,
+      this->dataPtr.get());
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool AsyncVideoEncoder::IsEncoding() const
+{
+  return this->dataPtr->thread.joinable();
+}
+
+/////////////////////////////////////////////////
+bool AsyncVideoEncoder::WantsFrame(
+    const std::chrono::steady_clock::time_point &_timestamp) const
+{
+  if (!this->IsEncoding())
+    return false;
+
+  // Same as the underlying encoder, which skips frames arriving faster than
+  // the frame rate
+  return !this->dataPtr->lastFrameTime ||
+      _timestamp - *this->dataPtr->lastFrameTime >= this->dataPtr->period;
+}
+
+/////////////////////////////////////////////////
+bool AsyncVideoEncoder::AddFrame(const unsigned char *_frame,
+    unsigned int _width, unsigned int _height,
+    const std::chrono::steady_clock::time_point &_timestamp)
+{
+  IGN_PROFILE("AsyncVideoEncoder::AddFrame");
+
+  // Frames which would be skipped don't take a place in the queue
+  if (!this->WantsFrame(_timestamp))
+    return false;
+
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  if (this->dataPtr->queue.size() >= this->dataPtr->queueSize)
+  {
+    if (this->dataPtr->dropFrames)
+    {
+      if (this->dataPtr->dropped++ == 0)
+      {
+        ignwarn << "Video encoder can't keep up, dropping frames."
+                << std::endl;
+      }
+      return false;
+    }
+    this->dataPtr->cv.wait(lock, [this]
+    {
+      return this->dataPtr->queue.size() < this->dataPtr->queueSize;
+    });
+  }
+
+  QueuedFrame frame;
+  if (!this->dataPtr->freeBuffers.empty())
+  {
+    frame.data = std::move(this->dataPtr->freeBuffers.back());
+    this->dataPtr->freeBuffers.pop_back();
+  }
+  // 3 bytes per pixel, as expected by the encoder
+  frame.data.assign(_frame, _frame + _width * _height * 3);
+  frame.width = _width;
+  frame.height = _height;
+  frame.timestamp = _timestamp;
+  this->dataPtr->queue.push_back(std::move(frame));
+  ++this->dataPtr->queued;
+  this->dataPtr->lastFrameTime = _timestamp;
+  lock.unlock();
+
+  this->dataPtr->cv.notify_all();
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool AsyncVideoEncoder::Stop()
+{
+  if (!this->IsEncoding())
+    return false;
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->cv.notify_all();
+  this->dataPtr->thread.join();
+
+  if (this->dataPtr->dropped > 0)
+  {
+    ignwarn << "Dropped [" << this->dataPtr->dropped << "] of ["
+            << this->dataPtr->queued + this->dataPtr->dropped
+            << "] video frames because the encoder couldn't keep up."
+            << std::endl;
+  }
+  return this->dataPtr->stopResult;
+}
+
+/////////////////////////////////////////////////
+void AsyncVideoEncoder::SetFrameEncodedCallback(
+    const std::function<void(const std::chrono::steady_clock::time_point &)>
+    &_cb)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->frameEncodedCb = _cb;
+}
+
+/////////////////////////////////////////////////
+uint64_t AsyncVideoEncoder::QueuedFrames() const
+{
+  return this->dataPtr->queued;
+}
+
+/////////////////////////////////////////////////
+uint64_t AsyncVideoEncoder::EncodedFrames() const
+{
+  return this->dataPtr->encoded;
+}
+
+/////////////////////////////////////////////////
+uint64_t AsyncVideoEncoder::DroppedFrames() const
+{
+  return this->dataPtr->dropped;
+}
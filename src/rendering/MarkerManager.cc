@@ -20,6 +20,8 @@
 #include <map>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <ignition/msgs.hh>
 #include <ignition/transport/Node.hh>
@@ -28,6 +30,7 @@
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/common/Console.hh"
 #include "ignition/rendering/Marker.hh"
+#include "ignition/rendering/Material.hh"
 #include "ignition/rendering/RenderingIface.hh"
 #include "ignition/rendering/Scene.hh"
 
@@ -60,6 +63,12 @@ class ignition::gazebo::MarkerManagerPrivate
   /// \brief Updates the markers.
   public: void Update();
 
+  /// \brief Drop queued messages whose effect is undone by later ones, such
+  /// as a marker modified many times, or created and then deleted, before
+  /// the next update.
+  /// \param[in, out] _msgs Messages, oldest first.
+  public: static void Coalesce(std::list<ignition::msgs::Marker> &_msgs);
+
   /// \brief Callback that receives marker messages.
   /// \param[in] _req The marker message.
   public: void OnMarkerMsg(const ignition::msgs::Marker &_req);
@@ -105,6 +114,9 @@ class ignition::gazebo::MarkerManagerPrivate
   /// \brief List of marker message to process.
   public: std::list<ignition::msgs::Marker> markerMsgs;
 
+  /// \brief Whether the last Update processed marker messages
+  public: bool changed{false};
+
   /// \brief Pointer to the scene
   public: rendering::ScenePtr scene;
 
@@ -148,6 +160,12 @@ void MarkerManager::Update()
   return this->dataPtr->Update();
 }
 
+/////////////////////////////////////////////////
+bool MarkerManager::Changed() const
+{
+  return this->dataPtr->changed;
+}
+
 /////////////////////////////////////////////////
 bool MarkerManager::Init(const ignition::rendering::ScenePtr &_scene)
 {
@@ -210,6 +228,11 @@ void MarkerManagerPrivate::Update()
 {
   std::lock_guard<std::mutex> lock(this->mutex);
 
+  this->changed = !this->markerMsgs.empty();
+
+  // Publishers sending many updates per frame only need the latest
+  this->Coalesce(this->markerMsgs);
+
   // Process the marker messages.
   for (auto markerIter = this->markerMsgs.begin();
        markerIter != this->markerMsgs.end();)
@@ -254,6 +277,101 @@ void MarkerManagerPrivate::Update()
   this->lastSimTime = this->simTime;
 }
 
+/////////////////////////////////////////////////
+/// \brief Whether a marker message replaces everything an earlier message
+/// for the same marker set. Messages only change the fields they have, so
+/// this is only the case when the later one sets them all.
+/// \param[in] _later Later message.
+/// \param[in] _earlier Earlier message.
+/// \return True if the earlier message can be dropped.
+static bool replaces(const ignition::msgs::Marker &_later,
+    const ignition::msgs::Marker &_earlier)
+{
+  return _later.has_pose() && _later.has_scale() && _later.has_material() &&
+      _later.type() != ignition::msgs::Marker::NONE &&
+      (_later.point_size() > 0 || _earlier.point_size() == 0) &&
+      (_earlier.parent().empty() || _earlier.parent() == _later.parent());
+}
+
+/////////////////////////////////////////////////
+void MarkerManagerPrivate::Coalesce(std::list<ignition::msgs::Marker> &_msgs)
+{
+  if (_msgs.size() < 2)
+    return;
+
+  std::vector<std::list<ignition::msgs::Marker>::iterator> msgs;
+  msgs.reserve(_msgs.size());
+  for (auto it = _msgs.begin(); it != _msgs.end(); ++it)
+    msgs.push_back(it);
+  std::vector<bool> keep(msgs.size(), true);
+
+  // Latest creation or modification of each marker, by namespace and id
+  std::map<std::pair<std::string, uint64_t>, std::size_t> latest;
+
+  // Messages without a type use the type of the message processed before
+  // them, so messages before them must stay
+  std::size_t typeBarrier{0};
+
+  for (std::size_t i = 0; i < msgs.size(); ++i)
+  {
+    const auto &msg = *msgs[i];
+    if (msg.action() == ignition::msgs::Marker::DELETE_ALL)
+    {
+      // Everything before, in the namespace or in all of them, is deleted
+      for (std::size_t j = 0; j < i; ++j)
+      {
+        if (msg.ns().empty() || msgs[j]->ns() == msg.ns())
+          keep[j] = false;
+      }
+      if (msg.ns().empty())
+      {
+        latest.clear();
+      }
+      else
+      {
+        auto it = latest.lower_bound(std::make_pair(msg.ns(), uint64_t{0}));
+        while (it != latest.end() && it->first.first == msg.ns())
+          it = latest.erase(it);
+      }
+      continue;
+    }
+
+    if (msg.action() == ignition::msgs::Marker::ADD_MODIFY &&
+        msg.type() == ignition::msgs::Marker::NONE)
+    {
+      typeBarrier = i;
+    }
+
+    // Markers without an id get a new one each time
+    if (msg.id() == 0)
+      continue;
+
+    auto key = std::make_pair(msg.ns(), msg.id());
+    auto it = latest.find(key);
+    if (msg.action() == ignition::msgs::Marker::DELETE_MARKER)
+    {
+      if (it != latest.end())
+      {
+        keep[it->second] = false;
+        latest.erase(it);
+      }
+    }
+    else if (msg.action() == ignition::msgs::Marker::ADD_MODIFY)
+    {
+      if (it != latest.end() && it->second >= typeBarrier &&
+          replaces(msg, *msgs[it->second]))
+        keep[it->second] = false;
+      latest[key] = i;
+    }
+  }
+
+  for (std::size_t i = 0; i < msgs.size(); ++i)
+  {
+    if (!keep[i])
+      _msgs.erase(msgs[i]);
+  }
+}
+
 /////////////////////////////////////////////////
 void MarkerManagerPrivate::SetSimTime(
     const std::chrono::steady_clock::duration &_time)
@@ -301,6 +419,23 @@ void MarkerManagerPrivate::SetVisual(const ignition::msgs::Marker &_msg,
   // todo(anyone) Update Marker Visibility
 }
 
+/////////////////////////////////////////////////
+/// \brief Whether a rendering material has the properties of a marker
+/// message's material.
+/// \param[in] _material Rendering material, may be null.
+/// \param[in] _msg Marker message.
+/// \return True if they match.
+static bool sameMaterial(const rendering::MaterialPtr &_material,
+    const ignition::msgs::Marker &_msg)
+{
+  return _material &&
+      _material->Ambient() == msgs::Convert(_msg.material().ambient()) &&
+      _material->Diffuse() == msgs::Convert(_msg.material().diffuse()) &&
+      _material->Specular() == msgs::Convert(_msg.material().specular()) &&
+      _material->Emissive() == msgs::Convert(_msg.material().emissive()) &&
+      _material->LightingEnabled() == _msg.material().lighting();
+}
+
 /////////////////////////////////////////////////
 void MarkerManagerPrivate::SetMarker(const ignition::msgs::Marker &_msg,
                            const rendering::MarkerPtr &_markerPtr)
@@ -322,8 +457,9 @@ void MarkerManagerPrivate::SetMarker(const ignition::msgs::Marker &_msg,
   ignition::rendering::MarkerType markerType = MsgToType(_msg);
   _markerPtr->SetType(markerType);
 
-  // Set Marker Material
-  if (_msg.has_material())
+  // Set Marker Material, unless unchanged, which is common for markers
+  // updated at a high rate
+  if (_msg.has_material() && !sameMaterial(_markerPtr->Material(), _msg))
   {
     rendering::MaterialPtr materialPtr = MsgToMaterial(_msg);
     _markerPtr->SetMaterial(materialPtr, true /* clone */);
@@ -15,16 +15,24 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 
 #include <sdf/Actor.hh>
+#include <sdf/Camera.hh>
 #include <sdf/Collision.hh>
 #include <sdf/Element.hh>
+#include <sdf/Lidar.hh>
 #include <sdf/Light.hh>
 #include <sdf/Link.hh>
 #include <sdf/Model.hh>
@@ -50,6 +58,7 @@
 #include <ignition/rendering/Scene.hh>
 
 #include "ignition/gazebo/components/Actor.hh"
+#include "ignition/gazebo/components/AxisAlignedBox.hh"
 #include "ignition/gazebo/components/Camera.hh"
 #include "ignition/gazebo/components/CastShadows.hh"
 #include "ignition/gazebo/components/Collision.hh"
@@ -155,6 +164,14 @@ class ignition::gazebo::RenderUtilPrivate
   /// [0] entity id, [1], SDF DOM, [2] parent entity id
   public: std::vector<std::tuple<Entity, sdf::Visual, Entity>> newVisuals;
 
+  /// \brief Real time Update may spend creating visuals, zero for no limit.
+  public: std::chrono::steady_clock::duration creationBudget{0};
+
+  /// \brief Visuals left over by Update because of creationBudget, created
+  /// before newer ones. Only used by the thread calling Update.
+  public: std::vector<std::tuple<Entity, sdf::Visual, Entity>>
+      pendingVisuals;
+
   /// \brief New actors to be created. The elements in the tuple are:
   /// [0] entity id, [1], SDF DOM, [2] parent entity id
   public: std::vector<std::tuple<Entity, sdf::Actor, Entity>> newActors;
@@ -179,6 +196,11 @@ class ignition::gazebo::RenderUtilPrivate
   public: std::unordered_map<Entity, msgs::ParticleEmitter>
       newParticleEmittersCmds;
 
+  /// \brief Buffer swapped with newParticleEmittersCmds by Update, kept to
+  /// reuse its buckets.
+  public: std::unordered_map<Entity, msgs::ParticleEmitter>
+      appliedParticleEmittersCmds;
+
   /// \brief A list of entities with particle emitter cmds to remove
   public: std::vector<Entity> particleCmdsToRemove;
 
@@ -186,8 +208,67 @@ class ignition::gazebo::RenderUtilPrivate
   /// remove request is received
   public: std::unordered_map<Entity, uint64_t> removeEntities;
 
-  /// \brief A map of entity ids and pose updates.
-  public: std::unordered_map<Entity, math::Pose3d> entityPoses;
+  /// \brief Pose updates since the last Update, in the order they were
+  /// queued. Each entity appears at most once, see entityPoseSlots.
+  public: std::vector<std::pair<Entity, math::Pose3d>> entityPoses;
+
+  /// \brief Buffer swapped with entityPoses by Update, kept to reuse its
+  /// capacity.
+  public: std::vector<std::pair<Entity, math::Pose3d>> appliedPoses;
+
+  /// \brief Index of each entity in entityPoses. An entry is only valid if
+  /// its generation equals poseGeneration, so the map doesn't need to be
+  /// cleared when entityPoses is swapped.
+  public: std::unordered_map<Entity, std::pair<uint64_t, std::size_t>>
+      entityPoseSlots;
+
+  /// \brief Incremented each time entityPoses is swapped.
+  public: uint64_t poseGeneration{0};
+
+  /// \brief Whether the last Update changed the scene
+  public: bool sceneChanged{true};
+
+  /// \brief Simulation time at the last Update
+  public: std::chrono::steady_clock::duration lastUpdateSimTime{-1};
+
+  /// \brief Latest pose of each entity received through UpdateFromPoses.
+  /// These take precedence over the poses in the ECM.
+  public: std::unordered_map<Entity, math::Pose3d> streamedPoses;
+
+  /// \brief Whether poses have been copied from the ECM at least once.
+  /// Until then all poses are copied, afterwards only changed ones.
+  public: bool posesSynced{false};
+
+  /// \brief Latest pose of each actor. Kept for all actors, not only changed
+  /// ones, since actor animation is composed with it every update.
+  public: std::unordered_map<Entity, math::Pose3d> actorPoses;
+
+  /// \brief Queue a pose update, replacing an update of the same entity
+  /// which hasn't been applied yet.
+  /// \param[in] _entity Entity.
+  /// \param[in] _pose Pose.
+  public: void QueuePose(const Entity _entity, const math::Pose3d &_pose);
+
+  /// \brief Whether to skip pose updates of models which are out of range
+  /// of all rendering sensors.
+  public: bool sensorCulling{false};
+
+  /// \brief Distance added to each sensor's range when culling, in meters.
+  public: double cullingMargin{0.0};
+
+  /// \brief Top level models which are out of range of all rendering
+  /// sensors in the current update.
+  public: std::unordered_set<Entity> culledModels;
+
+  /// \brief Entities whose pose updates were skipped because their top
+  /// level model was culled, mapped to that model.
+  public: std::unordered_map<Entity, Entity> culledPoses;
+
+  /// \brief Find top level models which are out of range of all rendering
+  /// sensors, and queue the latest poses of entities whose models came
+  /// back in range.
+  /// \param[in] _ecm The entity-component manager
+  public: void UpdateCulledModels(const EntityComponentManager &_ecm);
 
   /// \brief A map of entity ids and light updates.
   public: std::unordered_map<Entity, msgs::Light> entityLights;
@@ -211,7 +292,13 @@ class ignition::gazebo::RenderUtilPrivate
   /// signature, respectively.
   ///
   /// All temperatures are in Kelvin.
-  public: std::map<Entity, std::tuple<float, float, std::string>> entityTemp;
+  public: std::unordered_map<Entity, std::tuple<float, float, std::string>>
+      entityTemp;
+
+  /// \brief Buffer swapped with entityTemp by Update, kept to reuse its
+  /// buckets.
+  public: std::unordered_map<Entity, std::tuple<float, float, std::string>>
+      appliedEntityTemp;
 
   /// \brief A map of entity ids and wire boxes
   public: std::unordered_map<Entity, ignition::rendering::WireBoxPtr> wireBoxes;
@@ -306,17 +393,19 @@ class ignition::gazebo::RenderUtilPrivate
   public: std::vector<Entity> newCollisionLinks;
 
   /// \brief A map of collision entity ids and their SDF DOM
-  public: std::map<Entity, sdf::Collision> entityCollisions;
+  public: std::unordered_map<Entity, sdf::Collision> entityCollisions;
 
   /// \brief A map of model entities and their corresponding children links
-  public: std::map<Entity, std::vector<Entity>> modelToLinkEntities;
+  public: std::unordered_map<Entity, std::vector<Entity>>
+      modelToLinkEntities;
 
   /// \brief A map of link entities and their corresponding children collisions
-  public: std::map<Entity, std::vector<Entity>> linkToCollisionEntities;
+  public: std::unordered_map<Entity, std::vector<Entity>>
+      linkToCollisionEntities;
 
   /// \brief A map of created collision entities and if they are currently
   /// visible
-  public: std::map<Entity, bool> viewingCollisions;
+  public: std::unordered_map<Entity, bool> viewingCollisions;
 
   /// \brief A map of entity id to thermal camera sensor configuration
   /// properties. The elements in the tuple are:
@@ -461,6 +550,25 @@ void RenderUtil::UpdateFromECM(const UpdateInfo &_info,
   this->dataPtr->FindCollisionLinks(_ecm);
 }
 
+//////////////////////////////////////////////////
+bool RenderUtil::SceneChanged() const
+{
+  return this->dataPtr->sceneChanged;
+}
+
+//////////////////////////////////////////////////
+void RenderUtil::UpdateFromPoses(
+    const std::vector<std::pair<Entity, math::Pose3d>> &_poses)
+{
+  IGN_PROFILE("RenderUtil::UpdateFromPoses");
+  std::lock_guard<std::mutex> lock(this->dataPtr->updateMutex);
+  for (const auto &pose : _poses)
+  {
+    this->dataPtr->streamedPoses[pose.first] = pose.second;
+    this->dataPtr->QueuePose(pose.first, pose.second);
+  }
+}
+
 //////////////////////////////////////////////////
 void RenderUtilPrivate::FindCollisionLinks(const EntityComponentManager &_ecm)
 {
@@ -529,15 +637,27 @@ void RenderUtil::Update()
   auto newActors = std::move(this->dataPtr->newActors);
   auto newLights = std::move(this->dataPtr->newLights);
   auto newParticleEmitters = std::move(this->dataPtr->newParticleEmitters);
-  auto newParticleEmittersCmds =
-    std::move(this->dataPtr->newParticleEmittersCmds);
+  // Swap the particle emitter command buffers
+  this->dataPtr->appliedParticleEmittersCmds.clear();
+  this->dataPtr->appliedParticleEmittersCmds.swap(
+      this->dataPtr->newParticleEmittersCmds);
+  const auto &newParticleEmittersCmds =
+      this->dataPtr->appliedParticleEmittersCmds;
   auto removeEntities = std::move(this->dataPtr->removeEntities);
-  auto entityPoses = std::move(this->dataPtr->entityPoses);
+  // Swap the pose buffers, invalidating all slots at once
+  this->dataPtr->appliedPoses.clear();
+  this->dataPtr->appliedPoses.swap(this->dataPtr->entityPoses);
+  ++this->dataPtr->poseGeneration;
+  const auto &entityPoses = this->dataPtr->appliedPoses;
+  auto actorPoses = this->dataPtr->actorPoses;
   auto entityLights = std::move(this->dataPtr->entityLights);
   auto trajectoryPoses = std::move(this->dataPtr->trajectoryPoses);
   auto actorTransforms = std::move(this->dataPtr->actorTransforms);
   auto actorAnimationData = std::move(this->dataPtr->actorAnimationData);
-  auto entityTemp = std::move(this->dataPtr->entityTemp);
+  // Swap the temperature buffers
+  this->dataPtr->appliedEntityTemp.clear();
+  this->dataPtr->appliedEntityTemp.swap(this->dataPtr->entityTemp);
+  const auto &entityTemp = this->dataPtr->appliedEntityTemp;
   auto newCollisionLinks = std::move(this->dataPtr->newCollisionLinks);
   auto thermalCameraData = std::move(this->dataPtr->thermalCameraData);
 
@@ -548,14 +668,11 @@ void RenderUtil::Update()
   this->dataPtr->newActors.clear();
   this->dataPtr->newLights.clear();
   this->dataPtr->newParticleEmitters.clear();
-  this->dataPtr->newParticleEmittersCmds.clear();
   this->dataPtr->removeEntities.clear();
-  this->dataPtr->entityPoses.clear();
   this->dataPtr->entityLights.clear();
   this->dataPtr->trajectoryPoses.clear();
   this->dataPtr->actorTransforms.clear();
   this->dataPtr->actorAnimationData.clear();
-  this->dataPtr->entityTemp.clear();
   this->dataPtr->newCollisionLinks.clear();
   this->dataPtr->thermalCameraData.clear();
 
@@ -567,6 +684,19 @@ void RenderUtil::Update()
     newSensors = std::move(this->dataPtr->newSensors);
     this->dataPtr->newSensors.clear();
   }
+
+  this->dataPtr->sceneChanged =
+      this->dataPtr->simTime != this->dataPtr->lastUpdateSimTime ||
+      this->dataPtr->markerManager.Changed() ||
+      !newScenes.empty() || !newModels.empty() || !newLinks.empty() ||
+      !newVisuals.empty() || !newActors.empty() || !newLights.empty() ||
+      !newParticleEmitters.empty() || !newParticleEmittersCmds.empty() ||
+      !removeEntities.empty() || !entityPoses.empty() ||
+      !entityLights.empty() || !trajectoryPoses.empty() ||
+      !actorTransforms.empty() || !actorAnimationData.empty() ||
+      !entityTemp.empty() || !newCollisionLinks.empty() ||
+      !thermalCameraData.empty() || !newSensors.empty();
+  this->dataPtr->lastUpdateSimTime = this->dataPtr->simTime;
   this->dataPtr->updateMutex.unlock();
 
   // scene - only one scene is supported for now
@@ -641,12 +771,54 @@ void RenderUtil::Update()
           std::get<0>(link), std::get<1>(link), std::get<2>(link));
     }
 
-    for (const auto &visual : newVisuals)
+    // Visuals left over on previous updates go first, unless they were
+    // removed meanwhile
+    if (!this->dataPtr->pendingVisuals.empty())
     {
+      auto &pending = this->dataPtr->pendingVisuals;
+      pending.erase(std::remove_if(pending.begin(), pending.end(),
+          [&removeEntities](const auto &_visual)
+          {
+            return removeEntities.find(std::get<0>(_visual)) !=
+                removeEntities.end();
+          }), pending.end());
+      pending.insert(pending.end(), std::make_move_iterator(newVisuals.begin()),
+          std::make_move_iterator(newVisuals.end()));
+      newVisuals = std::move(pending);
+      pending.clear();
+    }
+
+    // Models and links are cheap and parent everything else, so only
+    // visuals are spread over several updates
+    const auto budget = this->dataPtr->creationBudget;
+    const auto createStart = std::chrono::steady_clock::now();
+    std::size_t created{0};
+    for (; created < newVisuals.size(); ++created)
+    {
+      // The clock is only checked every few visuals
+      if (budget > std::chrono::steady_clock::duration::zero() &&
+          created > 0 && created % 16 == 0 &&
+          std::chrono::steady_clock::now() - createStart > budget)
+      {
+        break;
+      }
+
+      const auto &visual = newVisuals[created];
       this->dataPtr->sceneManager.CreateVisual(
           std::get<0>(visual), std::get<1>(visual), std::get<2>(visual));
     }
 
+    if (created < newVisuals.size())
+    {
+      this->dataPtr->pendingVisuals.assign(
+          std::make_move_iterator(newVisuals.begin() + created),
+          std::make_move_iterator(newVisuals.end()));
+      this->dataPtr->sceneChanged = true;
+    }
+
+    if (this->dataPtr->sceneManager.AddLoadedMeshes())
+      this->dataPtr->sceneChanged = true;
+
     for (const auto &actor : newActors)
     {
       this->dataPtr->sceneManager.CreateActor(
@@ -842,9 +1014,9 @@ void RenderUtil::Update()
         }
 
         math::Pose3d globalPose;
-        if (entityPoses.find(tf.first) != entityPoses.end())
+        if (actorPoses.find(tf.first) != actorPoses.end())
         {
-          globalPose = entityPoses[tf.first];
+          globalPose = actorPoses[tf.first];
         }
 
         math::Pose3d trajPose;
@@ -905,15 +1077,10 @@ void RenderUtil::Update()
           // the animation being played. This is needed if trajectory animation
           // is enabled. We need to let the trajectory animation set the
           // position of the actor instead
-          common::SkeletonPtr skeleton =
-              this->dataPtr->sceneManager.ActorSkeletonById(it.first);
-          if (skeleton)
-          {
-            float rootBoneWeight = (animData.followTrajectory) ? 0.0 : 1.0;
-            std::unordered_map<std::string, float> weights;
-            weights[skeleton->RootNode()->Name()] = rootBoneWeight;
-            actorMesh->SetSkeletonWeights(weights);
-          }
+          float rootBoneWeight = (animData.followTrajectory) ? 0.0 : 1.0;
+          std::unordered_map<std::string, float> weights;
+          weights[actorSkel->RootNode()->Name()] = rootBoneWeight;
+          actorMesh->SetSkeletonWeights(weights);
         }
         // Update skeleton animation by setting animation time.
         // Note that animation time is different from sim time. An actor can
@@ -926,18 +1093,16 @@ void RenderUtil::Update()
         // animation
         if (animData.followTrajectory)
         {
-          common::SkeletonPtr skeleton =
-              this->dataPtr->sceneManager.ActorSkeletonById(it.first);
           std::map<std::string, math::Matrix4d> rootTf;
-          rootTf[skeleton->RootNode()->Name()] = animData.rootTransform;
+          rootTf[actorSkel->RootNode()->Name()] = animData.rootTransform;
           actorMesh->SetSkeletonLocalTransforms(rootTf);
         }
 
         // update actor trajectory animation
         math::Pose3d globalPose;
-        if (entityPoses.find(it.first) != entityPoses.end())
+        if (actorPoses.find(it.first) != actorPoses.end())
         {
-          globalPose = entityPoses[it.first];
+          globalPose = actorPoses[it.first];
         }
 
         math::Pose3d trajPose;
@@ -1143,13 +1308,16 @@ void RenderUtilPrivate::CreateRenderingEntities(
           return true;
         });
 
-    // visuals
-    _ecm.Each<components::Visual, components::Name, components::Pose,
-              components::Geometry,
-              components::CastShadows,
-              components::Transparency,
-              components::VisibilityFlags,
-              components::ParentEntity>(
+    // visuals, which are usually the most numerous, are copied in parallel
+    std::mutex visualsMutex;
+    const auto visualCount = this->newVisuals.size();
+    _ecm.ParallelEach<components::Visual, components::Name,
+                      components::Pose,
+                      components::Geometry,
+                      components::CastShadows,
+                      components::Transparency,
+                      components::VisibilityFlags,
+                      components::ParentEntity>(
         [&](const Entity &_entity,
             const components::Visual *,
             const components::Name *_name,
@@ -1158,7 +1326,7 @@ void RenderUtilPrivate::CreateRenderingEntities(
             const components::CastShadows *_castShadows,
             const components::Transparency *_transparency,
             const components::VisibilityFlags *_visibilityFlags,
-            const components::ParentEntity *_parent)->bool
+            const components::ParentEntity *_parent)
         {
           sdf::Visual visual;
           visual.SetName(_name->Data());
@@ -1181,12 +1349,12 @@ void RenderUtilPrivate::CreateRenderingEntities(
             visual.SetLaserRetro(laserRetro->Data());
           }
 
+          std::optional<std::tuple<float, float, std::string>> temperature;
           if (auto temp = _ecm.Component<components::Temperature>(_entity))
           {
             // get the uniform temperature for the entity
-            this->entityTemp[_entity] =
-              std::make_tuple<float, float, std::string>(
-                  temp->Data().Kelvin(), 0.0, "");
+            temperature = std::make_tuple<float, float, std::string>(
+                temp->Data().Kelvin(), 0.0, "");
           }
           else
           {
@@ -1198,17 +1366,26 @@ void RenderUtilPrivate::CreateRenderingEntities(
                _ecm.Component<components::TemperatureRange>(_entity);
             if (heatSignature && tempRange)
             {
-              this->entityTemp[_entity] =
-                std::make_tuple<float, float, std::string>(
-                    tempRange->Data().min.Kelvin(),
-                    tempRange->Data().max.Kelvin(),
-                    std::string(heatSignature->Data()));
+              temperature = std::make_tuple<float, float, std::string>(
+                  tempRange->Data().min.Kelvin(),
+                  tempRange->Data().max.Kelvin(),
+                  std::string(heatSignature->Data()));
             }
           }
 
+          std::lock_guard<std::mutex> lock(visualsMutex);
+          if (temperature)
+            this->entityTemp[_entity] = std::move(*temperature);
           this->newVisuals.push_back(
-              std::make_tuple(_entity, visual, _parent->Data()));
-          return true;
+              std::make_tuple(_entity, std::move(visual), _parent->Data()));
+        });
+
+    // Keep the order of a sequential pass, so the scene is built the same
+    // way every time
+    std::sort(this->newVisuals.begin() + visualCount, this->newVisuals.end(),
+        [](const auto &_a, const auto &_b)
+        {
+          return std::get<0>(_a) < std::get<0>(_b);
         });
 
     // actors
@@ -1554,12 +1731,47 @@ void RenderUtilPrivate::UpdateRenderingEntities(
     const EntityComponentManager &_ecm)
 {
   IGN_PROFILE("RenderUtilPrivate::UpdateRenderingEntities");
+
+  // After the first update, only copy poses which changed since the last
+  // iteration
+  const bool allPoses = !this->posesSynced;
+  this->posesSynced = true;
+  if (this->sensorCulling)
+    this->UpdateCulledModels(_ecm);
+
+  auto queueIfChanged = [&](const Entity _entity,
+      const components::Pose *_pose)
+  {
+    if (!allPoses && _ecm.ComponentState(_entity, components::Pose::typeId)
+        == ComponentState::NoChange)
+    {
+      return;
+    }
+
+    if (!this->culledModels.empty())
+    {
+      auto model = topLevelModel(_entity, _ecm);
+      if (this->culledModels.find(model) != this->culledModels.end())
+      {
+        this->culledPoses[_entity] = model;
+        return;
+      }
+    }
+
+    // Poses received directly are newer than those in the ECM
+    auto streamed = this->streamedPoses.find(_entity);
+    if (streamed != this->streamedPoses.end())
+      this->QueuePose(_entity, streamed->second);
+    else
+      this->QueuePose(_entity, _pose->Data());
+  };
+
   _ecm.Each<components::Model, components::Pose>(
       [&](const Entity &_entity,
         const components::Model *,
         const components::Pose *_pose)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        queueIfChanged(_entity, _pose);
         return true;
       });
 
@@ -1568,7 +1780,7 @@ void RenderUtilPrivate::UpdateRenderingEntities(
         const components::Link *,
         const components::Pose *_pose)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        queueIfChanged(_entity, _pose);
         return true;
       });
 
@@ -1578,7 +1790,7 @@ void RenderUtilPrivate::UpdateRenderingEntities(
         const components::Visual *,
         const components::Pose *_pose)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        queueIfChanged(_entity, _pose);
         return true;
       });
 
@@ -1589,7 +1801,8 @@ void RenderUtilPrivate::UpdateRenderingEntities(
         const components::Pose *_pose)->bool
       {
         // Trajectory origin
-        this->entityPoses[_entity] = _pose->Data();
+        this->actorPoses[_entity] = _pose->Data();
+        queueIfChanged(_entity, _pose);
 
         auto animTimeComp = _ecm.Component<components::AnimationTime>(_entity);
         auto animNameComp = _ecm.Component<components::AnimationName>(_entity);
@@ -1638,7 +1851,7 @@ void RenderUtilPrivate::UpdateRenderingEntities(
         const components::Light *,
         const components::Pose *_pose)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        queueIfChanged(_entity, _pose);
         return true;
       });
 
@@ -1648,7 +1861,7 @@ void RenderUtilPrivate::UpdateRenderingEntities(
         const components::Camera *,
         const components::Pose *_pose)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        queueIfChanged(_entity, _pose);
         return true;
       });
 
@@ -1658,7 +1871,7 @@ void RenderUtilPrivate::UpdateRenderingEntities(
         const components::DepthCamera *,
         const components::Pose *_pose)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        queueIfChanged(_entity, _pose);
         return true;
       });
 
@@ -1668,7 +1881,7 @@ void RenderUtilPrivate::UpdateRenderingEntities(
         const components::RgbdCamera *,
         const components::Pose *_pose)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        queueIfChanged(_entity, _pose);
         return true;
       });
 
@@ -1678,7 +1891,7 @@ void RenderUtilPrivate::UpdateRenderingEntities(
         const components::GpuLidar *,
         const components::Pose *_pose)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        queueIfChanged(_entity, _pose);
         return true;
       });
 
@@ -1688,11 +1901,145 @@ void RenderUtilPrivate::UpdateRenderingEntities(
         const components::ThermalCamera *,
         const components::Pose *_pose)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        queueIfChanged(_entity, _pose);
         return true;
       });
 }
 
+//////////////////////////////////////////////////
+void RenderUtilPrivate::QueuePose(const Entity _entity,
+    const math::Pose3d &_pose)
+{
+  auto &slot = this->entityPoseSlots[_entity];
+  if (slot.first == this->poseGeneration &&
+      slot.second < this->entityPoses.size() &&
+      this->entityPoses[slot.second].first == _entity)
+  {
+    this->entityPoses[slot.second].second = _pose;
+    return;
+  }
+  slot = {this->poseGeneration, this->entityPoses.size()};
+  this->entityPoses.emplace_back(_entity, _pose);
+}
+
+//////////////////////////////////////////////////
+void RenderUtilPrivate::UpdateCulledModels(const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("RenderUtilPrivate::UpdateCulledModels");
+  this->culledModels.clear();
+
+  // Approximate each sensor's view volume with a sphere around it
+  std::vector<std::pair<math::Vector3d, double>> volumes;
+  std::unordered_set<Entity> sensorModels;
+  auto addVolume = [&](const Entity &_entity, const sdf::Sensor &_sensor)
+  {
+    double range{0.0};
+    if (_sensor.CameraSensor())
+      range = _sensor.CameraSensor()->FarClip();
+    else if (_sensor.LidarSensor())
+      range = _sensor.LidarSensor()->RangeMax();
+    volumes.emplace_back(worldPose(_entity, _ecm).Pos(),
+        range + this->cullingMargin);
+
+    // Never cull the model carrying a sensor, or the sensor would stop
+    // following it
+    sensorModels.insert(topLevelModel(_entity, _ecm));
+    return true;
+  };
+
+  _ecm.Each<components::Camera>(
+      [&](const Entity &_entity, const components::Camera *_sensor)->bool
+      {
+        return addVolume(_entity, _sensor->Data());
+      });
+  _ecm.Each<components::DepthCamera>(
+      [&](const Entity &_entity, const components::DepthCamera *_sensor)->bool
+      {
+        return addVolume(_entity, _sensor->Data());
+      });
+  _ecm.Each<components::RgbdCamera>(
+      [&](const Entity &_entity, const components::RgbdCamera *_sensor)->bool
+      {
+        return addVolume(_entity, _sensor->Data());
+      });
+  _ecm.Each<components::ThermalCamera>(
+      [&](const Entity &_entity,
+          const components::ThermalCamera *_sensor)->bool
+      {
+        return addVolume(_entity, _sensor->Data());
+      });
+  _ecm.Each<components::GpuLidar>(
+      [&](const Entity &_entity, const components::GpuLidar *_sensor)->bool
+      {
+        return addVolume(_entity, _sensor->Data());
+      });
+
+  // Without sensors nothing is rendered, keep everything up to date
+  if (!volumes.empty())
+  {
+    _ecm.Each<components::Model, components::Pose, components::ParentEntity>(
+        [&](const Entity &_entity, const components::Model *,
+            const components::Pose *_pose,
+            const components::ParentEntity *_parent)->bool
+        {
+          if (nullptr == _ecm.Component<components::World>(_parent->Data()) ||
+              sensorModels.find(_entity) != sensorModels.end())
+          {
+            return true;
+          }
+
+          // Use the model's bounding box in the world frame if it has one,
+          // otherwise its origin
+          auto box = _ecm.Component<components::AxisAlignedBox>(_entity);
+          bool useBox = box && box->Data().Min().X() <= box->Data().Max().X();
+          const auto &pos = _pose->Data().Pos();
+
+          for (const auto &volume : volumes)
+          {
+            double distance;
+            if (useBox)
+            {
+              const auto &min = box->Data().Min();
+              const auto &max = box->Data().Max();
+              math::Vector3d delta(
+                  std::max({min.X() - volume.first.X(), 0.0,
+                      volume.first.X() - max.X()}),
+                  std::max({min.Y() - volume.first.Y(), 0.0,
+                      volume.first.Y() - max.Y()}),
+                  std::max({min.Z() - volume.first.Z(), 0.0,
+                      volume.first.Z() - max.Z()}));
+              distance = delta.Length();
+            }
+            else
+            {
+              distance = pos.Distance(volume.first);
+            }
+
+            if (distance <= volume.second)
+              return true;
+          }
+
+          this->culledModels.insert(_entity);
+          return true;
+        });
+  }
+
+  // Entities of models which came back in range get their latest pose
+  for (auto it = this->culledPoses.begin(); it != this->culledPoses.end();)
+  {
+    if (this->culledModels.find(it->second) != this->culledModels.end())
+    {
+      ++it;
+      continue;
+    }
+
+    auto pose = _ecm.Component<components::Pose>(it->first);
+    if (pose)
+      this->QueuePose(it->first, pose->Data());
+    it = this->culledPoses.erase(it);
+  }
+}
+
 //////////////////////////////////////////////////
 void RenderUtilPrivate::RemoveRenderingEntities(
     const EntityComponentManager &_ecm, const UpdateInfo &_info)
@@ -1787,6 +2134,14 @@ void RenderUtilPrivate::RemoveRenderingEntities(
         this->entityCollisions.erase(_entity);
         return true;
       });
+
+  for (const auto &removed : this->removeEntities)
+  {
+    this->entityPoseSlots.erase(removed.first);
+    this->actorPoses.erase(removed.first);
+    this->culledPoses.erase(removed.first);
+    this->streamedPoses.erase(removed.first);
+  }
 }
 
 /////////////////////////////////////////////////
@@ -1912,6 +2267,22 @@ void RenderUtil::SetEnableSensors(bool _enable,
   this->dataPtr->createSensorCb = std::move(_createSensorCb);
 }
 
+/////////////////////////////////////////////////
+void RenderUtil::SetCreationBudget(
+    const std::chrono::steady_clock::duration &_budget)
+{
+  this->dataPtr->creationBudget = _budget;
+}
+
+/////////////////////////////////////////////////
+void RenderUtil::SetSensorCulling(bool _enable, double _margin)
+{
+  this->dataPtr->sensorCulling = _enable;
+  this->dataPtr->cullingMargin = _margin;
+  if (!_enable)
+    this->dataPtr->culledModels.clear();
+}
+
 /////////////////////////////////////////////////
 void RenderUtil::SetRemoveSensorCb(
     std::function<void(const gazebo::Entity &)> _removeSensorCb)
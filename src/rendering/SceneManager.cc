@@ -16,7 +16,15 @@
  */
 
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <sdf/Box.hh>
 #include <sdf/Collision.hh>
@@ -30,8 +38,13 @@
 #include <ignition/common/Console.hh>
 #include <ignition/common/KeyFrame.hh>
 #include <ignition/common/MeshManager.hh>
+#include <ignition/common/NodeAnimation.hh>
+#include <ignition/common/Profiler.hh>
 #include <ignition/common/Skeleton.hh>
 #include <ignition/common/SkeletonAnimation.hh>
+#include <ignition/common/WorkerPool.hh>
+
+#include <ignition/math/Helpers.hh>
 
 #include <ignition/msgs/Utility.hh>
 
@@ -52,6 +65,10 @@ using namespace std::chrono_literals;
 
 using TP = std::chrono::steady_clock::time_point;
 
+/// \brief Samples per second of actor animations evaluated by
+/// SceneManager::ActorSkeletonTransformsAt.
+static const double kAnimationSampleRate{60.0};
+
 /// \brief Private data class.
 class ignition::gazebo::SceneManagerPrivate
 {
@@ -64,27 +81,101 @@ class ignition::gazebo::SceneManagerPrivate
   public: rendering::ScenePtr scene;
 
   /// \brief Map of visual entity in Gazebo to visual pointers.
-  public: std::map<Entity, rendering::VisualPtr> visuals;
+  public: std::unordered_map<Entity, rendering::VisualPtr> visuals;
 
   /// \brief Map of actor entity in Gazebo to actor pointers.
-  public: std::map<Entity, rendering::MeshPtr> actors;
+  public: std::unordered_map<Entity, rendering::MeshPtr> actors;
 
   /// \brief Map of actor entity in Gazebo to actor animations.
-  public: std::map<Entity, common::SkeletonPtr> actorSkeletons;
+  public: std::unordered_map<Entity, common::SkeletonPtr> actorSkeletons;
 
   /// \brief Map of actor entity to the associated trajectories.
-  public: std::map<Entity, std::vector<common::TrajectoryInfo>>
+  public: std::unordered_map<Entity, std::vector<common::TrajectoryInfo>>
                     actorTrajectories;
 
   /// \brief Map of light entity in Gazebo to light pointers.
-  public: std::map<Entity, rendering::LightPtr> lights;
+  public: std::unordered_map<Entity, rendering::LightPtr> lights;
 
   /// \brief Map of particle emitter entity in Gazebo to particle emitter
   /// rendering pointers.
-  public: std::map<Entity, rendering::ParticleEmitterPtr> particleEmitters;
+  public: std::unordered_map<Entity, rendering::ParticleEmitterPtr>
+      particleEmitters;
 
   /// \brief Map of sensor entity in Gazebo to sensor pointers.
-  public: std::map<Entity, rendering::SensorPtr> sensors;
+  public: std::unordered_map<Entity, rendering::SensorPtr> sensors;
+
+  /// \brief Nodes of all entities in visuals, lights, particleEmitters and
+  /// sensors, so NodeById needs a single lookup.
+  public: std::unordered_map<Entity, rendering::NodePtr> nodes;
+
+  /// \brief Whether visuals with identical materials share a single
+  /// rendering material.
+  public: bool shareMaterials{false};
+
+  /// \brief Materials shared between visuals, keyed by their serialized
+  /// SDF material, transparency and shadow casting.
+  public: std::unordered_map<std::string, rendering::MaterialPtr>
+      sharedMaterials;
+
+  /// \brief Distances at which mesh visuals switch to the next level of
+  /// detail, in increasing order. Empty if levels of detail are disabled.
+  public: std::vector<double> lodDistances;
+
+  /// \brief Levels of detail of a mesh visual.
+  public: struct LodVisual
+  {
+    /// \brief Child visual shown within each distance band, there's one
+    /// more band than there are distances. Bands without their own mesh
+    /// reuse the previous level.
+    public: std::vector<rendering::VisualPtr> bands;
+
+    /// \brief Band currently shown.
+    public: std::size_t current{0};
+  };
+
+  /// \brief Levels of detail of visuals which have them.
+  public: std::unordered_map<Entity, LodVisual> lodVisuals;
+
+  /// \brief Whether meshes which aren't loaded yet are loaded in the
+  /// background.
+  public: bool asyncMeshLoading{false};
+
+  /// \brief Threads loading meshes in the background, created on first use.
+  public: std::unique_ptr<common::WorkerPool> meshPool;
+
+  /// \brief Meshes being loaded in the background, by full path, each with
+  /// whether it's done.
+  public: std::unordered_map<std::string, std::shared_ptr<std::atomic<bool>>>
+      meshLoads;
+
+  /// \brief A visual waiting for its mesh to be loaded.
+  public: struct PendingVisual
+  {
+    /// \brief Whether the mesh is loaded.
+    public: std::shared_ptr<std::atomic<bool>> loaded;
+
+    /// \brief The visual's SDF, to add its geometry once loaded.
+    public: sdf::Visual visual;
+  };
+
+  /// \brief Visuals waiting for their mesh, which have no geometry yet.
+  public: std::unordered_map<Entity, PendingVisual> pendingVisuals;
+
+  /// \brief Start loading a mesh and its levels of detail in the
+  /// background, unless it's loaded already.
+  /// \param[in] _mesh Mesh.
+  /// \return Whether the mesh is loaded, which the background thread sets
+  /// to true, or nullptr if it's loaded already.
+  public: std::shared_ptr<std::atomic<bool>> LoadMeshAsync(
+      const sdf::Mesh &_mesh);
+
+  /// \brief Load the simplified meshes of a mesh, which are found next to it
+  /// as `<name>_lod<N>.<extension>`, N starting at 1.
+  /// \param[in] _mesh Full resolution mesh.
+  /// \return One geometry per entry in lodDistances, null where there's
+  /// no mesh for that level.
+  public: std::vector<rendering::GeometryPtr> LoadLodMeshes(
+      const sdf::Mesh &_mesh);
 
   /// \brief Helper function to compute actor trajectory at specified tiime
   /// \param[in] _id Actor entity's unique id
@@ -93,6 +184,44 @@ class ignition::gazebo::SceneManagerPrivate
   /// also sets the time point in which the animation should be played
   public: AnimationUpdateData ActorTrajectoryAt(
       Entity _id, const std::chrono::steady_clock::duration &_time) const;
+
+  /// \brief Skin transforms of a skeleton animation, sampled at a fixed
+  /// rate once and then shared by all actors with that skeleton.
+  public: struct SampledAnimation
+  {
+    /// \brief Name of each skin node.
+    public: std::vector<std::string> skinNames;
+
+    /// \brief Seconds between samples.
+    public: double step{0.0};
+
+    /// \brief Number of samples, the last one is at the end of the
+    /// animation.
+    public: std::size_t sampleCount{0};
+
+    /// \brief Pose of each skin node at each sample, sample after sample.
+    public: std::vector<math::Pose3d> poses;
+  };
+
+  /// \brief Sampled animations by skeleton and animation index.
+  public: mutable std::map<std::pair<const common::Skeleton *, unsigned int>,
+      SampledAnimation> sampledAnimations;
+
+  /// \brief Get a sampled skeleton animation, sampling it the first time.
+  /// \param[in] _skel Skeleton.
+  /// \param[in] _animIndex Index of the animation in the skeleton.
+  /// \return The sampled animation.
+  public: const SampledAnimation &SampledAnimationOf(
+      const common::SkeletonPtr &_skel, unsigned int _animIndex) const;
+
+  /// \brief Get skin transforms at a time, interpolated between the two
+  /// nearest samples.
+  /// \param[in] _sampled Sampled animation.
+  /// \param[in] _time Time within the animation, in seconds.
+  /// \param[in] _loop Whether the animation loops.
+  /// \param[out] _frames Transforms by skin node name.
+  public: void SampledPosesAt(const SampledAnimation &_sampled, double _time,
+      bool _loop, std::map<std::string, math::Matrix4d> &_frames) const;
 };
 
 
@@ -109,6 +238,61 @@ SceneManager::~SceneManager() = default;
 void SceneManager::SetScene(rendering::ScenePtr _scene)
 {
   this->dataPtr->scene = std::move(_scene);
+  this->dataPtr->sharedMaterials.clear();
+  this->dataPtr->lodVisuals.clear();
+  this->dataPtr->pendingVisuals.clear();
+}
+
+/////////////////////////////////////////////////
+void SceneManager::SetLodDistances(const std::vector<double> &_distances)
+{
+  this->dataPtr->lodDistances = _distances;
+  std::sort(this->dataPtr->lodDistances.begin(),
+      this->dataPtr->lodDistances.end());
+}
+
+/////////////////////////////////////////////////
+void SceneManager::UpdateLod(const std::vector<math::Vector3d> &_viewpoints)
+{
+  if (this->dataPtr->lodVisuals.empty())
+    return;
+
+  IGN_PROFILE("SceneManager::UpdateLod");
+  std::vector<math::Vector3d> viewpoints = _viewpoints;
+  if (viewpoints.empty())
+  {
+    for (const auto &sensor : this->dataPtr->sensors)
+      viewpoints.push_back(sensor.second->WorldPosition());
+  }
+  if (viewpoints.empty())
+    return;
+
+  const auto &distances = this->dataPtr->lodDistances;
+  for (auto &lod : this->dataPtr->lodVisuals)
+  {
+    auto &bands = lod.second.bands;
+    auto pos = bands[0]->WorldPosition();
+
+    // The scene is shared by all viewpoints, so use the closest one
+    double distance{std::numeric_limits<double>::max()};
+    for (const auto &viewpoint : viewpoints)
+      distance = std::min(distance, pos.Distance(viewpoint));
+
+    std::size_t band = static_cast<std::size_t>(std::upper_bound(
+        distances.begin(), distances.end(), distance) - distances.begin());
+    if (bands[band] != bands[lod.second.current])
+    {
+      bands[lod.second.current]->SetVisible(false);
+      bands[band]->SetVisible(true);
+    }
+    lod.second.current = band;
+  }
+}
+
+/////////////////////////////////////////////////
+void SceneManager::SetShareMaterials(bool _share)
+{
+  this->dataPtr->shareMaterials = _share;
 }
 
 /////////////////////////////////////////////////
@@ -175,6 +359,7 @@ rendering::VisualPtr SceneManager::CreateModel(Entity _id,
   modelVis->SetUserData("pause-update", static_cast<int>(0));
   modelVis->SetLocalPose(_model.RawPose());
   this->dataPtr->visuals[_id] = modelVis;
+  this->dataPtr->nodes[_id] = modelVis;
 
   if (parent)
     parent->AddChild(modelVis);
@@ -221,6 +406,7 @@ rendering::VisualPtr SceneManager::CreateLink(Entity _id,
   linkVis->SetLocalPose(_link.RawPose());
   linkVis->SetUserData("gazebo-entity", static_cast<int>(_id));
   this->dataPtr->visuals[_id] = linkVis;
+  this->dataPtr->nodes[_id] = linkVis;
 
   if (parent)
     parent->AddChild(linkVis);
@@ -272,6 +458,37 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
     visualVis->SetUserData("laser_retro", _visual.LaserRetro());
   }
 
+  // Meshes which aren't loaded yet are loaded in the background, and added
+  // to the visual once ready
+  std::shared_ptr<std::atomic<bool>> meshLoaded;
+  if (this->dataPtr->asyncMeshLoading &&
+      _visual.Geom()->Type() == sdf::GeometryType::MESH)
+  {
+    meshLoaded = this->dataPtr->LoadMeshAsync(*_visual.Geom()->MeshShape());
+  }
+
+  if (meshLoaded)
+    this->dataPtr->pendingVisuals[_id] = {meshLoaded, _visual};
+  else
+    this->AddGeometry(_id, _visual, visualVis);
+
+  // visibility flags
+  visualVis->SetVisibilityFlags(_visual.VisibilityFlags());
+
+  this->dataPtr->visuals[_id] = visualVis;
+  this->dataPtr->nodes[_id] = visualVis;
+  if (parent)
+    parent->AddChild(visualVis);
+
+  return visualVis;
+}
+
+/////////////////////////////////////////////////
+void SceneManager::AddGeometry(Entity _id, const sdf::Visual &_visual,
+    const rendering::VisualPtr &_visualVis)
+{
+  const std::string name = _visualVis->Name();
+
   math::Vector3d scale = math::Vector3d::One;
   math::Pose3d localPose;
   rendering::GeometryPtr geom =
@@ -279,6 +496,19 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
 
   if (geom)
   {
+    std::vector<rendering::GeometryPtr> lodGeoms;
+    if (!this->dataPtr->lodDistances.empty() &&
+        _visual.Geom()->Type() == sdf::GeometryType::MESH &&
+        localPose == math::Pose3d::Zero)
+    {
+      lodGeoms = this->dataPtr->LoadLodMeshes(*_visual.Geom()->MeshShape());
+      if (std::none_of(lodGeoms.begin(), lodGeoms.end(),
+          [](const rendering::GeometryPtr &_geom) {return _geom != nullptr;}))
+      {
+        lodGeoms.clear();
+      }
+    }
+
     /// localPose is currently used to handle the normal vector in plane visuals
     /// In general, this can be used to store any local transforms between the
     /// parent Visual and geometry.
@@ -288,18 +518,48 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
           this->dataPtr->scene->CreateVisual(name + "_geom");
       geomVis->AddGeometry(geom);
       geomVis->SetLocalPose(localPose);
-      visualVis->AddChild(geomVis);
+      _visualVis->AddChild(geomVis);
+    }
+    else if (!lodGeoms.empty())
+    {
+      // Each level goes in its own child, so levels can be hidden
+      rendering::VisualPtr lodVis =
+          this->dataPtr->scene->CreateVisual(name + "_lod0");
+      lodVis->AddGeometry(geom);
+      lodVis->SetVisibilityFlags(_visual.VisibilityFlags());
+      _visualVis->AddChild(lodVis);
+      this->dataPtr->lodVisuals[_id].bands.push_back(lodVis);
     }
     else
     {
-      visualVis->AddGeometry(geom);
+      _visualVis->AddGeometry(geom);
     }
 
-    visualVis->SetLocalScale(scale);
+    _visualVis->SetLocalScale(scale);
+
+    // Visuals with the same material share it, so the render engine can
+    // batch their draws. Meshes using their own materials are not shared.
+    std::string materialKey;
+    if (this->dataPtr->shareMaterials &&
+        (_visual.Material() ||
+        _visual.Geom()->Type() != sdf::GeometryType::MESH))
+    {
+      materialKey = _visual.Material() ?
+          convert<msgs::Material>(*_visual.Material()).SerializeAsString() +
+          _visual.Material()->FilePath() : "ign-grey";
+      materialKey += "\n" + std::to_string(_visual.Transparency()) +
+          (_visual.CastShadows() ? "1" : "0");
+    }
+    auto sharedIt = this->dataPtr->sharedMaterials.find(materialKey);
 
     // set material
     rendering::MaterialPtr material{nullptr};
-    if (_visual.Material())
+    if (!materialKey.empty() &&
+        sharedIt != this->dataPtr->sharedMaterials.end())
+    {
+      geom->SetMaterial(sharedIt->second, false);
+    }
+    else if (_visual.Material())
     {
       material = this->LoadMaterial(*_visual.Material());
     }
@@ -347,12 +607,46 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
       // cast shadows
       material->SetCastShadows(_visual.CastShadows());
 
-      geom->SetMaterial(material);
-      // todo(anyone) SetMaterial function clones the input material.
-      // but does not take ownership of it so we need to destroy it here.
-      // This is not ideal. We should let ign-rendering handle the lifetime
-      // of this material
-      this->dataPtr->scene->DestroyMaterial(material);
+      if (!materialKey.empty())
+      {
+        // Keep a clone, as the default ign-grey material is destroyed and
+        // recreated by other visuals
+        auto shared = material->Clone();
+        this->dataPtr->scene->DestroyMaterial(material);
+        geom->SetMaterial(shared, false);
+        this->dataPtr->sharedMaterials[materialKey] = shared;
+      }
+      else
+      {
+        geom->SetMaterial(material);
+        // todo(anyone) SetMaterial function clones the input material.
+        // but does not take ownership of it so we need to destroy it here.
+        // This is not ideal. We should let ign-rendering handle the lifetime
+        // of this material
+        this->dataPtr->scene->DestroyMaterial(material);
+      }
+    }
+
+    // Simplified levels start hidden and use the same SDF material as the
+    // full resolution mesh, if any
+    for (std::size_t i = 0; i < lodGeoms.size(); ++i)
+    {
+      auto &bands = this->dataPtr->lodVisuals[_id].bands;
+      if (!lodGeoms[i])
+      {
+        bands.push_back(bands.back());
+        continue;
+      }
+
+      rendering::VisualPtr lodVis = this->dataPtr->scene->CreateVisual(
+          name + "_lod" + std::to_string(i + 1));
+      lodVis->AddGeometry(lodGeoms[i]);
+      if (_visual.Material() && geom->Material())
+        lodGeoms[i]->SetMaterial(geom->Material());
+      lodVis->SetVisibilityFlags(_visual.VisibilityFlags());
+      lodVis->SetVisible(false);
+      _visualVis->AddChild(lodVis);
+      bands.push_back(lodVis);
     }
   }
   else
@@ -360,15 +654,130 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
     ignerr << "Failed to load geometry for visual: " << _visual.Name()
            << std::endl;
   }
+}
 
-  // visibility flags
-  visualVis->SetVisibilityFlags(_visual.VisibilityFlags());
+/////////////////////////////////////////////////
+/// \brief Get the path of a mesh's simplified level of detail.
+/// \param[in] _fullPath Full path to the mesh.
+/// \param[in] _level Level, starting at 1.
+/// \return `<name>_lod<level>.<extension>` next to the mesh.
+static std::string lodMeshPath(const std::string &_fullPath,
+    std::size_t _level)
+{
+  auto slash = _fullPath.find_last_of("/\\");
+  auto dot = _fullPath.find_last_of('.');
+  if (dot == std::string::npos ||
+      (slash != std::string::npos && dot < slash))
+  {
+    dot = _fullPath.size();
+  }
+  return _fullPath.substr(0, dot) + "_lod" + std::to_string(_level) +
+      _fullPath.substr(dot);
+}
 
-  this->dataPtr->visuals[_id] = visualVis;
-  if (parent)
-    parent->AddChild(visualVis);
+/////////////////////////////////////////////////
+std::vector<rendering::GeometryPtr> SceneManagerPrivate::LoadLodMeshes(
+    const sdf::Mesh &_mesh)
+{
+  std::vector<rendering::GeometryPtr> geoms(this->lodDistances.size());
 
-  return visualVis;
+  auto fullPath = asFullPath(_mesh.Uri(), _mesh.FilePath());
+  auto *meshManager = common::MeshManager::Instance();
+  for (std::size_t i = 0; i < geoms.size(); ++i)
+  {
+    std::string lodPath = lodMeshPath(fullPath, i + 1);
+    if (findResource(lodPath).empty())
+      continue;
+
+    rendering::MeshDescriptor descriptor;
+    descriptor.meshName = lodPath;
+    descriptor.subMeshName = _mesh.Submesh();
+    descriptor.centerSubMesh = _mesh.CenterSubmesh();
+    descriptor.mesh = meshManager->Load(descriptor.meshName);
+    if (descriptor.mesh)
+      geoms[i] = this->scene->CreateMesh(descriptor);
+  }
+  return geoms;
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<std::atomic<bool>> SceneManagerPrivate::LoadMeshAsync(
+    const sdf::Mesh &_mesh)
+{
+  auto fullPath = asFullPath(_mesh.Uri(), _mesh.FilePath());
+  if (fullPath.empty() || common::MeshManager::Instance()->HasMesh(fullPath))
+    return nullptr;
+
+  // Visuals sharing a mesh wait for the same load
+  auto &loaded = this->meshLoads[fullPath];
+  if (loaded)
+    return loaded;
+  loaded = std::make_shared<std::atomic<bool>>(false);
+
+  if (!this->meshPool)
+    this->meshPool = std::make_unique<common::WorkerPool>(2u);
+
+  std::vector<std::string> paths{fullPath};
+  for (std::size_t i = 0; i < this->lodDistances.size(); ++i)
+    paths.push_back(lodMeshPath(fullPath, i + 1));
+
+  this->meshPool->AddWork([paths, loaded]()
+  {
+    auto *meshManager = common::MeshManager::Instance();
+    meshManager->Load(paths[0]);
+    for (std::size_t i = 1; i < paths.size(); ++i)
+    {
+      if (!findResource(paths[i]).empty())
+        meshManager->Load(paths[i]);
+    }
+    *loaded = true;
+  });
+  return loaded;
+}
+
+/////////////////////////////////////////////////
+bool SceneManager::AddLoadedMeshes()
+{
+  if (this->dataPtr->pendingVisuals.empty())
+    return false;
+
+  IGN_PROFILE("SceneManager::AddLoadedMeshes");
+  bool added{false};
+  for (auto it = this->dataPtr->pendingVisuals.begin();
+       it != this->dataPtr->pendingVisuals.end();)
+  {
+    if (!*it->second.loaded)
+    {
+      ++it;
+      continue;
+    }
+
+    auto visualIt = this->dataPtr->visuals.find(it->first);
+    if (visualIt != this->dataPtr->visuals.end())
+    {
+      this->AddGeometry(it->first, it->second.visual, visualIt->second);
+      visualIt->second->SetVisibilityFlags(
+          it->second.visual.VisibilityFlags());
+      added = true;
+    }
+    it = this->dataPtr->pendingVisuals.erase(it);
+  }
+
+  for (auto it = this->dataPtr->meshLoads.begin();
+       it != this->dataPtr->meshLoads.end();)
+  {
+    if (*it->second)
+      it = this->dataPtr->meshLoads.erase(it);
+    else
+      ++it;
+  }
+  return added;
+}
+
+/////////////////////////////////////////////////
+void SceneManager::SetAsyncMeshLoading(bool _async)
+{
+  this->dataPtr->asyncMeshLoading = _async;
 }
 
 /////////////////////////////////////////////////
@@ -504,7 +913,7 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
       std::string roughnessMap = metal->RoughnessMap();
       if (!roughnessMap.empty())
       {
-        std::string fullPath = common::findFile(
+        std::string fullPath = findResource(
             asFullPath(roughnessMap, _material.FilePath()));
         if (!fullPath.empty())
           material->SetRoughnessMap(fullPath);
@@ -516,7 +925,7 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
       std::string metalnessMap = metal->MetalnessMap();
       if (!metalnessMap.empty())
       {
-        std::string fullPath = common::findFile(
+        std::string fullPath = findResource(
             asFullPath(metalnessMap, _material.FilePath()));
         if (!fullPath.empty())
           material->SetMetalnessMap(fullPath);
@@ -535,7 +944,7 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
     std::string albedoMap = workflow->AlbedoMap();
     if (!albedoMap.empty())
     {
-      std::string fullPath = common::findFile(
+      std::string fullPath = findResource(
           asFullPath(albedoMap, _material.FilePath()));
       if (!fullPath.empty())
       {
@@ -551,7 +960,7 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
     std::string normalMap = workflow->NormalMap();
     if (!normalMap.empty())
     {
-      std::string fullPath = common::findFile(
+      std::string fullPath = findResource(
           asFullPath(normalMap, _material.FilePath()));
       if (!fullPath.empty())
         material->SetNormalMap(fullPath);
@@ -564,7 +973,7 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
     std::string environmentMap = workflow->EnvironmentMap();
     if (!environmentMap.empty())
     {
-      std::string fullPath = common::findFile(
+      std::string fullPath = findResource(
           asFullPath(environmentMap, _material.FilePath()));
       if (!fullPath.empty())
         material->SetEnvironmentMap(fullPath);
@@ -576,7 +985,7 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
     std::string emissiveMap = workflow->EmissiveMap();
     if (!emissiveMap.empty())
     {
-      std::string fullPath = common::findFile(
+      std::string fullPath = findResource(
           asFullPath(emissiveMap, _material.FilePath()));
       if (!fullPath.empty())
         material->SetEmissiveMap(fullPath);
@@ -882,6 +1291,7 @@ rendering::VisualPtr SceneManager::CreateActor(Entity _id,
   actorVisual->SetUserData("pause-update", static_cast<int>(0));
 
   this->dataPtr->visuals[_id] = actorVisual;
+  this->dataPtr->nodes[_id] = actorVisual;
   this->dataPtr->actors[_id] = actorMesh;
 
 
@@ -968,6 +1378,7 @@ rendering::LightPtr SceneManager::CreateLight(Entity _id,
   light->SetCastShadows(_light.CastShadows());
 
   this->dataPtr->lights[_id] = light;
+  this->dataPtr->nodes[_id] = light;
 
   if (parent)
     parent->AddChild(light);
@@ -1013,6 +1424,7 @@ rendering::ParticleEmitterPtr SceneManager::CreateParticleEmitter(
   emitter = this->dataPtr->scene->CreateParticleEmitter(name);
 
   this->dataPtr->particleEmitters[_id] = emitter;
+  this->dataPtr->nodes[_id] = emitter;
 
   if (parent)
     parent->AddChild(emitter);
@@ -1172,6 +1584,7 @@ bool SceneManager::AddSensor(Entity _gazeboId, const std::string &_sensorName,
   }
 
   this->dataPtr->sensors[_gazeboId] = sensor;
+  this->dataPtr->nodes[_gazeboId] = sensor;
   return true;
 }
 
@@ -1189,25 +1602,10 @@ bool SceneManager::HasEntity(Entity _id) const
 /////////////////////////////////////////////////
 rendering::NodePtr SceneManager::NodeById(Entity _id) const
 {
-  auto vIt = this->dataPtr->visuals.find(_id);
-  if (vIt != this->dataPtr->visuals.end())
-  {
-    return vIt->second;
-  }
-  auto lIt = this->dataPtr->lights.find(_id);
-  if (lIt != this->dataPtr->lights.end())
-  {
-    return lIt->second;
-  }
-  auto sIt = this->dataPtr->sensors.find(_id);
-  if (sIt != this->dataPtr->sensors.end())
-  {
-    return sIt->second;
-  }
-  auto pIt = this->dataPtr->particleEmitters.find(_id);
-  if (pIt != this->dataPtr->particleEmitters.end())
+  auto it = this->dataPtr->nodes.find(_id);
+  if (it != this->dataPtr->nodes.end())
   {
-    return pIt->second;
+    return it->second;
   }
 
   return rendering::NodePtr();
@@ -1234,6 +1632,34 @@ common::SkeletonPtr SceneManager::ActorSkeletonById(Entity _id) const
   return common::SkeletonPtr();
 }
 
+/////////////////////////////////////////////////
+/// \brief Get the time at which a node animation reaches a distance along
+/// x. The logic is taken from common::SkeletonAnimation::PoseAtX, which
+/// computes the poses of all nodes at that time.
+/// \param[in] _node Animation of the skeleton's root node.
+/// \param[in] _x Distance along x.
+/// \param[in] _loop Whether the animation loops.
+/// \return Time within the animation, in seconds.
+static double timeAtX(const common::NodeAnimation *_node, double _x,
+    bool _loop)
+{
+  double firstX = _node->KeyFrame(0).second.Translation().X();
+  double lastX = _node->KeyFrame(
+      _node->FrameCount() - 1).second.Translation().X();
+  double x = std::max(_x, firstX);
+  if (x > lastX && !_loop)
+    x = lastX;
+
+  // Wrap in one step, since the distance grows with sim time
+  if (x > lastX && lastX > 0.0)
+  {
+    x = std::fmod(x, lastX);
+    if (x <= 0.0)
+      x += lastX;
+  }
+  return _node->TimeAtX(x);
+}
+
 /////////////////////////////////////////////////
 AnimationUpdateData SceneManager::ActorAnimationAt(
     Entity _id, std::chrono::steady_clock::duration _time) const
@@ -1261,29 +1687,13 @@ AnimationUpdateData SceneManager::ActorAnimationAt(
     if (animData.trajectory.Waypoints()->InterpolateX() &&
         !math::equal(distance, 0.0))
     {
-      // logic here is mostly taken from
-      // common::SkeletonAnimation::PoseAtX
-      // We should consider refactoring part of that function to return
-      // PoseAtX for only one skeleton node in addition to the current
-      // function that computes PoseAtX for all skeleton nodes
       common::NodeAnimation *rootNode =
           skel->Animation(animIndex)->NodeAnimationByName(rootNodeName);
-      math::Matrix4d lastPos = rootNode->KeyFrame(
-          rootNode->FrameCount() - 1).second;
-      math::Matrix4d firstPos = rootNode->KeyFrame(0).second;
-      double x = distance;
-      if (x < firstPos.Translation().X())
-        x = firstPos.Translation().X();
-      double lastX = lastPos.Translation().X();
-      if (x > lastX && !animData.loop)
-        x = lastX;
-      while (x > lastX)
-        x -= lastX;
 
       // update animation timepoint for root node
       // this should be the time that is used in the
       // SkeletonAnimationEnabled call
-      double time = rootNode->TimeAtX(x);
+      double time = timeAtX(rootNode, distance, animData.loop);
 
       // get raw skeleton transform for root node. Needed to keep skeleton
       // animation in sync with trajectory animation
@@ -1348,43 +1758,28 @@ std::map<std::string, math::Matrix4d> SceneManager::ActorSkeletonTransformsAt(
   {
     auto skel = vIt->second;
     unsigned int animIndex = traj.AnimIndex();
-    std::map<std::string, math::Matrix4d> rawFrames;
 
     double timeSeconds = std::chrono::duration<double>(time).count();
+    bool loop = !noLoop;
 
     if (followTraj)
     {
       double distance = traj.DistanceSoFar(time);
       // check interpolate x.
-      // todo(anyone) there is a problem with PoseAtX that causes
-      // it to go into an infinite loop if the animation has no x displacement
-      // e.g. a person standing that does not move in x direction
       if (traj.Waypoints()->InterpolateX() && !math::equal(distance, 0.0))
       {
-        rawFrames = skel->Animation(animIndex)->PoseAtX(distance,
-                                        skel->RootNode()->Name());
-      }
-      else
-      {
-        rawFrames = skel->Animation(animIndex)->PoseAt(timeSeconds, !noLoop);
+        auto rootNode = skel->Animation(animIndex)->NodeAnimationByName(
+            skel->RootNode()->Name());
+        if (nullptr != rootNode)
+        {
+          timeSeconds = timeAtX(rootNode, distance, true);
+          loop = true;
+        }
       }
     }
-    else
-    {
-      rawFrames = skel->Animation(animIndex)->PoseAt(timeSeconds, !noLoop);
-    }
-
-    for (auto pair : rawFrames)
-    {
-      std::string nodeName = pair.first;
-      auto nodeTf = pair.second;
 
-      std::string skinName = skel->NodeNameAnimToSkin(animIndex, nodeName);
-      math::Matrix4d skinTf = skel->AlignTranslation(animIndex, nodeName)
-              * nodeTf * skel->AlignRotation(animIndex, nodeName);
-
-      allFrames[skinName] = skinTf;
-    }
+    const auto &sampled = this->dataPtr->SampledAnimationOf(skel, animIndex);
+    this->dataPtr->SampledPosesAt(sampled, timeSeconds, loop, allFrames);
   }
 
   // correct animation root pose
@@ -1417,6 +1812,9 @@ void SceneManager::RemoveEntity(Entity _id)
     {
       this->dataPtr->scene->DestroyVisual(it->second);
       this->dataPtr->visuals.erase(it);
+      this->dataPtr->nodes.erase(_id);
+      this->dataPtr->lodVisuals.erase(_id);
+      this->dataPtr->pendingVisuals.erase(_id);
       return;
     }
   }
@@ -1427,6 +1825,7 @@ void SceneManager::RemoveEntity(Entity _id)
     {
       this->dataPtr->scene->DestroyLight(it->second);
       this->dataPtr->lights.erase(it);
+      this->dataPtr->nodes.erase(_id);
       return;
     }
   }
@@ -1437,6 +1836,7 @@ void SceneManager::RemoveEntity(Entity _id)
     {
       this->dataPtr->scene->DestroyVisual(it->second);
       this->dataPtr->particleEmitters.erase(it);
+      this->dataPtr->nodes.erase(_id);
       return;
     }
   }
@@ -1448,6 +1848,7 @@ void SceneManager::RemoveEntity(Entity _id)
       // Stop keeping track of it but don't destroy it;
       // ign-sensors is the one responsible for that.
       this->dataPtr->sensors.erase(it);
+      this->dataPtr->nodes.erase(_id);
       return;
     }
   }
@@ -1530,7 +1931,7 @@ AnimationUpdateData SceneManagerPrivate::ActorTrajectoryAt(
   if (trajIt == this->actorTrajectories.end())
     return animData;
 
-  auto trajs = trajIt->second;
+  const auto &trajs = trajIt->second;
   bool followTraj = true;
   if (1 == trajs.size() && nullptr == trajs[0].Waypoints())
     followTraj = false;
@@ -1560,9 +1961,12 @@ AnimationUpdateData SceneManagerPrivate::ActorTrajectoryAt(
 
   if (!noLoop || time <= totalTime)
   {
-    while (time > totalTime)
+    // Wrap into (0, totalTime] in one step, instead of once per elapsed
+    // cycle, which grows with sim time
+    if (time > totalTime && totalTime.count() > 0)
     {
-      time = time - totalTime;
+      const std::chrono::steady_clock::duration tick(1);
+      time = (time - tick) % totalTime + tick;
     }
     if (followTraj)
     {
@@ -1589,3 +1993,84 @@ AnimationUpdateData SceneManagerPrivate::ActorTrajectoryAt(
   animData.valid = true;
   return animData;
 }
+
+/////////////////////////////////////////////////
+const SceneManagerPrivate::SampledAnimation &
+    SceneManagerPrivate::SampledAnimationOf(
+    const common::SkeletonPtr &_skel, unsigned int _animIndex) const
+{
+  auto key = std::make_pair(_skel.get(), _animIndex);
+  auto it = this->sampledAnimations.find(key);
+  if (it != this->sampledAnimations.end())
+    return it->second;
+
+  auto &sampled = this->sampledAnimations[key];
+  auto anim = _skel->Animation(_animIndex);
+  if (nullptr == anim)
+    return sampled;
+
+  double length = anim->Length();
+  sampled.sampleCount = std::max(static_cast<std::size_t>(
+      std::ceil(length * kAnimationSampleRate)), std::size_t{1}) + 1;
+  sampled.step = length / (sampled.sampleCount - 1);
+
+  std::vector<std::string> nodeNames;
+  for (const auto &frame : anim->PoseAt(0.0, false))
+  {
+    nodeNames.push_back(frame.first);
+    sampled.skinNames.push_back(
+        _skel->NodeNameAnimToSkin(_animIndex, frame.first));
+  }
+
+  sampled.poses.reserve(sampled.sampleCount * nodeNames.size());
+  for (std::size_t i = 0; i < sampled.sampleCount; ++i)
+  {
+    auto rawFrames = anim->PoseAt(sampled.step * i, false);
+    for (const auto &nodeName : nodeNames)
+    {
+      math::Matrix4d skinTf = _skel->AlignTranslation(_animIndex, nodeName)
+          * rawFrames[nodeName] * _skel->AlignRotation(_animIndex, nodeName);
+      sampled.poses.push_back(skinTf.Pose());
+    }
+  }
+  return sampled;
+}
+
+/////////////////////////////////////////////////
+void SceneManagerPrivate::SampledPosesAt(const SampledAnimation &_sampled,
+    double _time, bool _loop,
+    std::map<std::string, math::Matrix4d> &_frames) const
+{
+  if (_sampled.skinNames.empty())
+    return;
+
+  double length = _sampled.step * (_sampled.sampleCount - 1);
+  double time = _time;
+  if (_loop && time > length && length > 0.0)
+    time = std::fmod(time, length);
+  time = math::clamp(time, 0.0, length);
+
+  std::size_t index = _sampled.sampleCount - 1;
+  double ratio = 0.0;
+  if (time < length)
+  {
+    double position = time / _sampled.step;
+    index = static_cast<std::size_t>(position);
+    ratio = position - index;
+  }
+
+  const std::size_t nodeCount = _sampled.skinNames.size();
+  const math::Pose3d *first = &_sampled.poses[index * nodeCount];
+  const math::Pose3d *second = first;
+  if (index + 1 < _sampled.sampleCount)
+    second += nodeCount;
+
+  for (std::size_t i = 0; i < nodeCount; ++i)
+  {
+    math::Pose3d pose(
+        first[i].Pos() + (second[i].Pos() - first[i].Pos()) * ratio,
+        math::Quaterniond::Slerp(ratio, first[i].Rot(), second[i].Rot(),
+        true));
+    _frames[_sampled.skinNames[i]] = math::Matrix4d(pose);
+  }
+}
@@ -148,6 +148,12 @@ class ignition::gazebo::systems::LinearBatteryPluginPrivate
   /// \brief Model interface
   public: Model model{kNullEntity};
 
+  /// \brief Joints of the model, whose commands start the battery draining.
+  public: std::vector<Entity> joints;
+
+  /// \brief Whether joints has been filled.
+  public: bool jointsInitialized{false};
+
   /// \brief Ignition communication node
   public: transport::Node node;
 
@@ -402,14 +408,22 @@ void LinearBatteryPlugin::PreUpdate(
 {
   IGN_PROFILE("LinearBatteryPlugin::PreUpdate");
   this->dataPtr->startDraining = false;
-  // Start draining the battery if the robot has started moving
-  if (!this->dataPtr->startDraining)
+
+  // The model's joints only change when entities are added or removed, so
+  // they're not searched for on every step
+  if (!this->dataPtr->jointsInitialized || _ecm.HasNewEntities() ||
+      _ecm.HasEntitiesMarkedForRemoval())
   {
-    const std::vector<Entity> joints = _ecm.ChildrenByComponents(
+    this->dataPtr->joints = _ecm.ChildrenByComponents(
       this->dataPtr->model.Entity(),
       components::Joint());
+    this->dataPtr->jointsInitialized = true;
+  }
 
-    for (Entity jointEntity : joints)
+  // Start draining the battery if the robot has started moving
+  if (!this->dataPtr->startDraining)
+  {
+    for (Entity jointEntity : this->dataPtr->joints)
     {
       const auto *jointVelocityCmd =
         _ecm.Component<components::JointVelocityCmd>(jointEntity);
@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <iterator>
 #include <string>
+#include <unordered_set>
 #include <utility>
 
 #include <ignition/common/Profiler.hh>
@@ -198,6 +199,20 @@ void Breadcrumbs::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
 
     auto poseComp = _ecm.Component<components::Pose>(this->model.Entity());
 
+    // Names of all models, collected once for all deployments of this step
+    // and updated as breadcrumbs are spawned
+    std::unordered_set<std::string> modelNames;
+    if (!cmds.empty())
+    {
+      _ecm.Each<components::Name, components::Model>(
+          [&modelNames](const Entity &, const components::Name *_name,
+                        const components::Model *)
+          {
+            modelNames.insert(_name->Data());
+            return true;
+          });
+    }
+
     for (std::size_t i = 0; i < cmds.size(); ++i)
     {
       if (this->maxDeployments < 0 ||
@@ -207,18 +222,8 @@ void Breadcrumbs::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
         std::string desiredName =
             modelToSpawn.Name() + "_" + std::to_string(this->numDeployments);
 
-        std::vector<std::string> modelNames;
-        _ecm.Each<components::Name, components::Model>(
-            [&modelNames](const Entity &, const components::Name *_name,
-                          const components::Model *)
-            {
-              modelNames.push_back(_name->Data());
-              return true;
-            });
-
         // Check if there's a model with the same name.
-        auto it = std::find(modelNames.begin(), modelNames.end(), desiredName);
-        if (it != modelNames.end())
+        if (modelNames.count(desiredName) > 0)
         {
           if (!this->allowRenaming)
           {
@@ -231,8 +236,7 @@ void Breadcrumbs::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
 
           std::string newName = desiredName;
           int counter = 0;
-          while (std::find(modelNames.begin(), modelNames.end(), newName) !=
-                 modelNames.end())
+          while (modelNames.count(newName) > 0)
           {
             newName = desiredName + "_" + std::to_string(++counter);
           }
@@ -240,6 +244,7 @@ void Breadcrumbs::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
         }
 
         modelToSpawn.SetName(desiredName);
+        modelNames.insert(desiredName);
         modelToSpawn.SetRawPose(poseComp->Data() * modelToSpawn.RawPose());
         ignmsg << "Deploying " << modelToSpawn.Name() << " at "
                << modelToSpawn.RawPose() << std::endl;
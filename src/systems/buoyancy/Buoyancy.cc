@@ -16,6 +16,9 @@
  */
 #include <ignition/msgs/wrench.pb.h>
 
+#include <algorithm>
+#include <iterator>
+#include <map>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -54,35 +57,110 @@ using namespace systems;
 
 class ignition::gazebo::systems::BuoyancyPrivate
 {
-  /// \brief Get the fluid density based on a pose. This function can be
-  /// used to adjust the fluid density based on the pose of an object in the
-  /// world. This function currently returns a constant value, see the todo
-  /// in the function implementation.
-  /// \param[in] _pose The pose to use when computing the fluid density. The
-  /// pose frame is left undefined because this function currently returns
-  /// a constant value, see the todo in the function implementation.
-  /// \return The fluid density at the givein pose.
+  /// \brief Get the fluid density based on a pose. The density is constant
+  /// unless graded densities were given, in which case it depends on the
+  /// height of the pose.
+  /// \param[in] _pose The pose to use when computing the fluid density, in
+  /// the world frame.
+  /// \return The fluid density at the given pose.
   public: double FluidDensity(const math::Pose3d &_pose) const;
 
+  /// \brief Rebuild the list of buoyant links from the volume and center of
+  /// volume components.
+  /// \param[in] _ecm Entity component manager.
+  public: void RefreshLinks(const EntityComponentManager &_ecm);
+
+  /// \brief Stop applying buoyancy to a link.
+  /// \param[in] _entity Link entity.
+  public: void RemoveLink(Entity _entity);
+
   /// \brief Model interface
   public: Entity world{kNullEntity};
 
   /// \brief The density of the fluid in which the object is submerged in
   /// kg/m^3. Defaults to 1000, the fluid density of water.
   public: double fluidDensity{1000};
+
+  /// \brief Fluid densities above given heights in the world frame, in
+  /// kg/m^3. Below the lowest height, fluidDensity is used.
+  public: std::map<double, double> gradedDensities;
+
+  /// \brief Links which have a volume and center of volume. Their data is
+  /// kept in the following vectors, at the same index, so that forces are
+  /// computed over contiguous memory.
+  public: std::vector<Entity> links;
+
+  /// \brief Volume of each link in links
+  public: std::vector<double> volumes;
+
+  /// \brief Center of volume of each link in links, in the link frame
+  public: std::vector<math::Vector3d> centersOfVolume;
+
+  /// \brief World pose of each link in links, refreshed every update
+  public: std::vector<math::Pose3d> poses;
+
+  /// \brief Whether links need to be rebuilt because buoyant links were
+  /// added
+  public: bool linksDirty{true};
 };
 
 //////////////////////////////////////////////////
-double BuoyancyPrivate::FluidDensity(const math::Pose3d & /*_pose*/) const
+double BuoyancyPrivate::FluidDensity(const math::Pose3d &_pose) const
 {
-  // \todo(nkoenig) Adjust the fluid density based on the provided pose.
-  // This could take into acount:
-  //   1. Transition from water to air. Currently this function is used for
-  //   a whole link, but when transitioning between mediums a link may span
-  //   both mediums. Surface tension could also be a factor.
-  //   2. Fluid density changes based on depth below the water surface and
-  //   height above water surface.
-  return this->fluidDensity;
+  // \todo(nkoenig) A link spanning two layers, such as water and air, gets
+  // the density at its center of volume. Surface tension could also be a
+  // factor.
+  if (this->gradedDensities.empty())
+    return this->fluidDensity;
+
+  // Density of the highest layer below the pose
+  auto layer = this->gradedDensities.upper_bound(_pose.Pos().Z());
+  if (layer == this->gradedDensities.begin())
+    return this->fluidDensity;
+  return std::prev(layer)->second;
+}
+
+//////////////////////////////////////////////////
+void BuoyancyPrivate::RefreshLinks(const EntityComponentManager &_ecm)
+{
+  this->links.clear();
+  this->volumes.clear();
+  this->centersOfVolume.clear();
+
+  _ecm.Each<components::Link,
+            components::Volume,
+            components::CenterOfVolume>(
+      [&](const Entity &_entity,
+          const components::Link *,
+          const components::Volume *_volume,
+          const components::CenterOfVolume *_centerOfVolume) -> bool
+  {
+    this->links.push_back(_entity);
+    this->volumes.push_back(_volume->Data());
+    this->centersOfVolume.push_back(_centerOfVolume->Data());
+    return true;
+  });
+
+  this->poses.resize(this->links.size());
+  this->linksDirty = false;
+}
+
+//////////////////////////////////////////////////
+void BuoyancyPrivate::RemoveLink(Entity _entity)
+{
+  auto it = std::find(this->links.begin(), this->links.end(), _entity);
+  if (it == this->links.end())
+    return;
+
+  // Move the last link into the removed one's place
+  auto index = static_cast<std::size_t>(it - this->links.begin());
+  this->links[index] = this->links.back();
+  this->volumes[index] = this->volumes.back();
+  this->centersOfVolume[index] = this->centersOfVolume.back();
+  this->links.pop_back();
+  this->volumes.pop_back();
+  this->centersOfVolume.pop_back();
+  this->poses.resize(this->links.size());
 }
 
 //////////////////////////////////////////////////
@@ -114,6 +192,26 @@ void Buoyancy::Configure(const Entity &_entity,
   {
     this->dataPtr->fluidDensity = _sdf->Get<double>("uniform_fluid_density");
   }
+  else if (_sdf->HasElement("graded_buoyancy"))
+  {
+    auto gradedElem = _sdf->GetElementImpl("graded_buoyancy");
+    this->dataPtr->fluidDensity = gradedElem->Get<double>("default_density",
+        this->dataPtr->fluidDensity).first;
+
+    for (auto changeElem = gradedElem->GetElementImpl("density_change");
+        changeElem; changeElem = changeElem->GetNextElement("density_change"))
+    {
+      if (!changeElem->HasElement("above_depth") ||
+          !changeElem->HasElement("density"))
+      {
+        ignerr << "<density_change> needs <above_depth> and <density>, "
+               << "ignoring it." << std::endl;
+        continue;
+      }
+      this->dataPtr->gradedDensities[changeElem->Get<double>("above_depth")] =
+          changeElem->Get<double>("density");
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -228,42 +326,71 @@ void Buoyancy::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
     return true;
   });
 
-  // Only update if not paused.
-  if (_info.paused)
-    return;
+  // Volumes only change with geometry, so links are only looked up again
+  // when new ones are added
+  if (!this->dataPtr->linksDirty)
+  {
+    _ecm.EachNew<components::Link,
+                 components::Volume,
+                 components::CenterOfVolume>(
+        [&](const Entity &,
+            const components::Link *,
+            const components::Volume *,
+            const components::CenterOfVolume *) -> bool
+    {
+      this->dataPtr->linksDirty = true;
+      return false;
+    });
+  }
+  if (this->dataPtr->linksDirty)
+    this->dataPtr->RefreshLinks(_ecm);
 
-  _ecm.Each<components::Link,
-            components::Volume,
-            components::CenterOfVolume>(
+  // Links being removed are still in the ECM, so drop them here
+  _ecm.EachRemoved<components::Link,
+                   components::Volume,
+                   components::CenterOfVolume>(
       [&](const Entity &_entity,
           const components::Link *,
-          const components::Volume *_volume,
-          const components::CenterOfVolume *_centerOfVolume) -> bool
-    {
-      // World pose of the link.
-      math::Pose3d linkWorldPose = worldPose(_entity, _ecm);
+          const components::Volume *,
+          const components::CenterOfVolume *) -> bool
+  {
+    this->dataPtr->RemoveLink(_entity);
+    return true;
+  });
 
-      // By Archimedes' principle,
-      // buoyancy = -(mass*gravity)*fluid_density/object_density
-      // object_density = mass/volume, so the mass term cancels.
-      math::Vector3d buoyancy =
-        -this->dataPtr->FluidDensity(linkWorldPose) *
-        _volume->Data() * gravity->Data();
-
-      // Convert the center of volume to the world frame
-      math::Vector3d offsetWorld = linkWorldPose.Rot().RotateVector(
-          _centerOfVolume->Data());
-      // Compute the torque that should be applied due to buoyancy and
-      // the center of volume.
-      math::Vector3d torque = offsetWorld.Cross(buoyancy);
-
-      // Apply the wrench to the link. This wrench is applied in the
-      // Physics System.
-      Link link(_entity);
-      link.AddWorldWrench(_ecm, buoyancy, torque);
+  // Only update if not paused.
+  if (_info.paused)
+    return;
 
-      return true;
-  });
+  auto &links = this->dataPtr->links;
+  auto &poses = this->dataPtr->poses;
+  for (std::size_t i = 0; i < links.size(); ++i)
+    poses[i] = worldPose(links[i], _ecm);
+
+  const math::Vector3d &gravityVec = gravity->Data();
+  for (std::size_t i = 0; i < links.size(); ++i)
+  {
+    // Convert the center of volume to the world frame
+    math::Vector3d offsetWorld = poses[i].Rot().RotateVector(
+        this->dataPtr->centersOfVolume[i]);
+
+    // By Archimedes' principle,
+    // buoyancy = -(mass*gravity)*fluid_density/object_density
+    // object_density = mass/volume, so the mass term cancels.
+    math::Vector3d buoyancy =
+      -this->dataPtr->FluidDensity(
+          math::Pose3d(poses[i].Pos() + offsetWorld, poses[i].Rot())) *
+      this->dataPtr->volumes[i] * gravityVec;
+
+    // Compute the torque that should be applied due to buoyancy and
+    // the center of volume.
+    math::Vector3d torque = offsetWorld.Cross(buoyancy);
+
+    // Apply the wrench to the link. This wrench is applied in the
+    // Physics System.
+    Link link(links[i]);
+    link.AddWorldWrench(_ecm, buoyancy, torque);
+  }
 }
 
 IGNITION_ADD_PLUGIN(Buoyancy,
@@ -47,6 +47,19 @@ namespace systems
   ///
   /// * <uniform_fluid_density> sets the density of the fluid that surrounds
   /// the buoyant object.
+  /// * <graded_buoyancy> instead of a uniform density, sets densities which
+  /// depend on the height in the world frame, such as water below the
+  /// surface and air above it. Each link gets the density at its center of
+  /// volume.
+  ///   * <default_density> density below all the given heights, defaults to
+  ///   1000.
+  ///   * <density_change> may be repeated, each one holds:
+  ///     * <above_depth> height above which the density applies.
+  ///     * <density> density above that height, up to the next change.
+  ///
+  /// The volume and center of volume of each link are computed once, so
+  /// changes to a link's collisions after it was created aren't taken into
+  /// account.
   ///
   /// ## Example
   ///
@@ -15,13 +15,13 @@
  *
 */
 
+#include <chrono>
 #include <regex>
 #include <set>
 #include <string>
 #include <unordered_map>
 
 #include <ignition/common/Profiler.hh>
-#include <ignition/common/VideoEncoder.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
 
@@ -30,6 +30,7 @@
 #include <ignition/rendering/RenderingIface.hh>
 #include <ignition/rendering/Scene.hh>
 
+#include "ignition/gazebo/rendering/AsyncVideoEncoder.hh"
 #include "ignition/gazebo/rendering/Events.hh"
 
 #include "ignition/gazebo/components/Camera.hh"
@@ -92,7 +93,7 @@ class ignition::gazebo::systems::CameraVideoRecorderPrivate
   public: rendering::Image cameraImage;
 
   /// \brief Video encoder
-  public: common::VideoEncoder videoEncoder;
+  public: AsyncVideoEncoder videoEncoder;
 
   /// \brief Video encoding format
   public: std::string recordVideoFormat;
@@ -313,7 +314,8 @@ void CameraVideoRecorderPrivate::OnPostRender()
     {
       this->camera->Copy(this->cameraImage);
       this->videoEncoder.AddFrame(
-          this->cameraImage.Data<unsigned char>(), width, height);
+          this->cameraImage.Data<unsigned char>(), width, height,
+          std::chrono::steady_clock::now());
     }
     // Video recorder is idle. Start recording.
     else
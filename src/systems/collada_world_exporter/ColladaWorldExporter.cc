@@ -15,7 +15,12 @@
  *
  */
 
+#include <array>
+#include <map>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <ignition/plugin/Register.hh>
@@ -53,96 +58,146 @@ using namespace gazebo;
 using namespace systems;
 
 
+/// \brief A visual to be added to the exported mesh. Meshes are referenced,
+/// not copied, so visuals sharing a mesh cost the same as primitives until
+/// the world mesh is written.
+struct ExportVisual
+{
+  /// \brief Mesh owned by the MeshManager.
+  const common::Mesh *mesh{nullptr};
+
+  /// \brief Whether only the first submesh is used, which is the case for
+  /// the unit primitives.
+  bool primitive{true};
+
+  /// \brief Material used by submeshes which don't have one. Visuals with
+  /// the same colors share it.
+  common::MaterialPtr material;
+
+  /// \brief Scale applied to the submeshes.
+  math::Vector3d scale;
+
+  /// \brief World transform of the visual.
+  math::Matrix4d matrix;
+};
+
 class ignition::gazebo::systems::ColladaWorldExporterPrivate
 {
   // Default constructor
   public: ColladaWorldExporterPrivate() = default;
 
+  /// \brief Wait for a background export to finish.
+  public: ~ColladaWorldExporterPrivate()
+  {
+    if (this->exportThread.joinable())
+      this->exportThread.join();
+  }
+
   /// \brief Has the world already been exported?.
   private: bool exported{false};
 
-  /// \brief Exports the world to a mesh.
-  /// \param[_ecm] _ecm Mutable reference to the EntityComponentManager.
-  public: void Export(const EntityComponentManager &_ecm)
+  /// \brief Write the mesh on a separate thread.
+  public: bool background{false};
+
+  /// \brief Thread writing the mesh when exporting in the background.
+  private: std::thread exportThread;
+
+  /// \brief Colors and transparency of a material, used to share
+  /// materials between visuals.
+  private: using MaterialKey = std::array<float, 17>;
+
+  /// \brief Get the material for a visual, reusing an existing one with
+  /// the same colors.
+  /// \param[in] _material Material component, may be null.
+  /// \param[in] _transparency Transparency of the visual.
+  /// \param[in, out] _materials Materials created so far.
+  /// \return The material.
+  private: static common::MaterialPtr SharedMaterial(
+      const components::Material *_material, double _transparency,
+      std::map<MaterialKey, common::MaterialPtr> &_materials)
   {
-    if (this->exported) return;
+    MaterialKey key{};
+    if (_material != nullptr)
+    {
+      const auto &data = _material->Data();
+      std::size_t i = 0;
+      for (const auto &color : {data.Diffuse(), data.Ambient(),
+          data.Emissive(), data.Specular()})
+      {
+        key[i++] = color.R();
+        key[i++] = color.G();
+        key[i++] = color.B();
+        key[i++] = color.A();
+      }
+    }
+    key[16] = static_cast<float>(_transparency);
 
-    common::Mesh worldMesh;
-    std::vector<math::Matrix4d> subMeshMatrix;
+    auto &mat = _materials[key];
+    if (mat)
+      return mat;
+
+    mat = std::make_shared<common::Material>();
+    if (_material != nullptr)
+    {
+      mat->SetDiffuse(_material->Data().Diffuse());
+      mat->SetAmbient(_material->Data().Ambient());
+      mat->SetEmissive(_material->Data().Emissive());
+      mat->SetSpecular(_material->Data().Specular());
+    }
+    mat->SetTransparency(_transparency);
+    return mat;
+  }
 
+  /// \brief Collect the visuals of the world. Meshes are loaded here, so
+  /// the MeshManager is only used from the simulation thread.
+  /// \param[in] _ecm Entity component manager.
+  /// \param[out] _visuals Visuals to export.
+  /// \return Name of the world.
+  private: std::string Collect(const EntityComponentManager &_ecm,
+      std::vector<ExportVisual> &_visuals)
+  {
+    std::string worldName;
     _ecm.Each<components::World, components::Name>(
       [&](const Entity /*& _entity*/,
         const components::World *,
         const components::Name * _name)->bool
     {
-      worldMesh.SetName(_name->Data());
+      worldName = _name->Data();
       return true;
     });
 
+    std::map<MaterialKey, common::MaterialPtr> materials;
+    ignition::common::MeshManager *meshManager =
+        ignition::common::MeshManager::Instance();
+
     _ecm.Each<components::Visual,
-            components::Name,
             components::Geometry,
             components::Transparency>(
     [&](const ignition::gazebo::Entity &_entity,
         const components::Visual *,
-        const components::Name *_name,
         const components::Geometry *_geom,
         const components::Transparency *_transparency)->bool
     {
-      std::string name = _name->Data().empty() ? std::to_string(_entity) :
-          _name->Data();
-
       math::Pose3d worldPose = gazebo::worldPose(_entity, _ecm);
 
-      common::MaterialPtr mat = std::make_shared<common::Material>();
-      auto material = _ecm.Component<components::Material>(_entity);
-      if (material != nullptr)
-      {
-        mat->SetDiffuse(material->Data().Diffuse());
-        mat->SetAmbient(material->Data().Ambient());
-        mat->SetEmissive(material->Data().Emissive());
-        mat->SetSpecular(material->Data().Specular());
-      }
-      mat->SetTransparency(_transparency->Data());
-
-      const ignition::common::Mesh *mesh;
-      std::weak_ptr<ignition::common::SubMesh> subm;
-      math::Vector3d scale;
-      math::Matrix4d matrix(worldPose);
-      ignition::common::MeshManager *meshManager =
-          ignition::common::MeshManager::Instance();
-
-      auto addSubmeshFunc = [&](int i) {
-          subm = worldMesh.AddSubMesh(
-              *mesh->SubMeshByIndex(0).lock().get());
-          subm.lock()->SetMaterialIndex(i);
-          subm.lock()->Scale(scale);
-          subMeshMatrix.push_back(matrix);
-      };
+      ExportVisual visual;
 
       if (_geom->Data().Type() == sdf::GeometryType::BOX)
       {
         if (meshManager->HasMesh("unit_box"))
         {
-          mesh = meshManager->MeshByName("unit_box");
-          scale = _geom->Data().BoxShape()->Size();
-          int i = worldMesh.AddMaterial(mat);
-
-          addSubmeshFunc(i);
+          visual.mesh = meshManager->MeshByName("unit_box");
+          visual.scale = _geom->Data().BoxShape()->Size();
         }
       }
       else if (_geom->Data().Type() == sdf::GeometryType::CYLINDER)
       {
         if (meshManager->HasMesh("unit_cylinder"))
         {
-          mesh = meshManager->MeshByName("unit_cylinder");
-          scale.X() = _geom->Data().CylinderShape()->Radius() * 2;
-          scale.Y() = scale.X();
-          scale.Z() = _geom->Data().CylinderShape()->Length();
-
-          int i = worldMesh.AddMaterial(mat);
-
-          addSubmeshFunc(i);
+          visual.mesh = meshManager->MeshByName("unit_cylinder");
+          visual.scale.X() = _geom->Data().CylinderShape()->Radius() * 2;
+          visual.scale.Y() = visual.scale.X();
+          visual.scale.Z() = _geom->Data().CylinderShape()->Length();
         }
       }
       else if (_geom->Data().Type() == sdf::GeometryType::PLANE)
@@ -151,10 +206,10 @@ class ignition::gazebo::systems::ColladaWorldExporterPrivate
         {
           // Create a rotation for the plane mesh to account
           // for the normal vector.
-          mesh = meshManager->MeshByName("unit_plane");
+          visual.mesh = meshManager->MeshByName("unit_plane");
 
-          scale.X() = _geom->Data().PlaneShape()->Size().X();
-          scale.Y() = _geom->Data().PlaneShape()->Size().Y();
+          visual.scale.X() = _geom->Data().PlaneShape()->Size().X();
+          visual.scale.Y() = _geom->Data().PlaneShape()->Size().Y();
 
           // // The rotation is the angle between the +z(0,0,1) vector and the
           // // normal, which are both expressed in the local (Visual) frame.
@@ -162,26 +217,17 @@ class ignition::gazebo::systems::ColladaWorldExporterPrivate
           math::Quaterniond normalRot;
           normalRot.From2Axes(math::Vector3d::UnitZ, normal.Normalized());
           worldPose.Rot() = worldPose.Rot() * normalRot;
-
-          matrix = math::Matrix4d(worldPose);
-
-          int i = worldMesh.AddMaterial(mat);
-          addSubmeshFunc(i);
         }
       }
       else if (_geom->Data().Type() == sdf::GeometryType::SPHERE)
       {
         if (meshManager->HasMesh("unit_sphere"))
         {
-          mesh = meshManager->MeshByName("unit_sphere");
-
-          scale.X() = _geom->Data().SphereShape()->Radius() * 2;
-          scale.Y() = scale.X();
-          scale.Z() = scale.X();
+          visual.mesh = meshManager->MeshByName("unit_sphere");
 
-          int i = worldMesh.AddMaterial(mat);
-
-          addSubmeshFunc(i);
+          visual.scale.X() = _geom->Data().SphereShape()->Radius() * 2;
+          visual.scale.Y() = visual.scale.X();
+          visual.scale.Z() = visual.scale.X();
         }
       }
       else if (_geom->Data().Type() == sdf::GeometryType::MESH)
@@ -194,51 +240,111 @@ class ignition::gazebo::systems::ColladaWorldExporterPrivate
           ignerr << "Mesh geometry missing uri" << std::endl;
           return true;
         }
-        mesh = meshManager->Load(fullPath);
+        visual.mesh = meshManager->Load(fullPath);
 
-        if (!mesh) {
+        if (!visual.mesh) {
           ignerr << "mesh not found!" << std::endl;
           return true;
         }
 
-        for (unsigned int k = 0; k < mesh->SubMeshCount(); k++)
-        {
-          auto subMeshLock = mesh->SubMeshByIndex(k).lock();
-          int j = subMeshLock->MaterialIndex();
-
-          int i = 0;
-          if (j != -1)
-          {
-            i = worldMesh.IndexOfMaterial(mesh->MaterialByIndex(j).get());
-            if (i < 0)
-            {
-              i = worldMesh.AddMaterial(mesh->MaterialByIndex(j));
-            }
-          }
-          else
-          {
-            i = worldMesh.AddMaterial(mat);
-          }
-
-          scale = _geom->Data().MeshShape()->Scale();
-
-          addSubmeshFunc(i);
-        }
+        visual.primitive = false;
+        visual.scale = _geom->Data().MeshShape()->Scale();
       }
       else
       {
         ignwarn << "Unsupported geometry type" << std::endl;
       }
 
+      if (visual.mesh == nullptr)
+        return true;
+
+      visual.material = SharedMaterial(
+          _ecm.Component<components::Material>(_entity),
+          _transparency->Data(), materials);
+      visual.matrix = math::Matrix4d(worldPose);
+      _visuals.push_back(std::move(visual));
+
       return true;
     });
 
+    return worldName;
+  }
+
+  /// \brief Build the world mesh and write it to disk.
+  /// \param[in] _name Name of the world, used for the output directory.
+  /// \param[in] _visuals Visuals to export.
+  private: static void Write(const std::string &_name,
+      const std::vector<ExportVisual> &_visuals)
+  {
+    common::Mesh worldMesh;
+    worldMesh.SetName(_name);
+    std::vector<math::Matrix4d> subMeshMatrix;
+
+    // Index of each material in the world mesh, so shared materials are
+    // only added once
+    std::unordered_map<const common::Material *, int> materialIndices;
+    auto materialIndex = [&](const common::MaterialPtr &_mat)
+    {
+      auto it = materialIndices.find(_mat.get());
+      if (it != materialIndices.end())
+        return it->second;
+      int i = worldMesh.AddMaterial(_mat);
+      materialIndices[_mat.get()] = i;
+      return i;
+    };
+
+    for (const auto &visual : _visuals)
+    {
+      unsigned int count = visual.primitive ? 1u :
+          visual.mesh->SubMeshCount();
+      for (unsigned int k = 0; k < count; ++k)
+      {
+        auto subMeshLock = visual.mesh->SubMeshByIndex(k).lock();
+        if (!subMeshLock)
+          continue;
+
+        int i;
+        int j = subMeshLock->MaterialIndex();
+        if (!visual.primitive && j != -1)
+          i = materialIndex(visual.mesh->MaterialByIndex(j));
+        else
+          i = materialIndex(visual.material);
+
+        auto subm = worldMesh.AddSubMesh(*subMeshLock).lock();
+        subm->SetMaterialIndex(i);
+        subm->Scale(visual.scale);
+        subMeshMatrix.push_back(visual.matrix);
+      }
+    }
+
     common::ColladaExporter exporter;
     exporter.Export(&worldMesh, "./" + worldMesh.Name(), true,
                     subMeshMatrix);
     ignmsg << "The world has been exported into the "
            << "./" + worldMesh.Name() << " directory." << std::endl;
+  }
+
+  /// \brief Exports the world to a mesh.
+  /// \param[_ecm] _ecm Mutable reference to the EntityComponentManager.
+  public: void Export(const EntityComponentManager &_ecm)
+  {
+    if (this->exported) return;
     this->exported = true;
+
+    std::vector<ExportVisual> visuals;
+    auto name = this->Collect(_ecm, visuals);
+
+    if (!this->background)
+    {
+      Write(name, visuals);
+      return;
+    }
+
+    this->exportThread = std::thread(
+        [name, visuals = std::move(visuals)]
+        {
+          Write(name, visuals);
+        });
   }
 };
 
@@ -251,6 +357,16 @@ ColladaWorldExporter::ColladaWorldExporter() : System(),
 /////////////////////////////////////////////////
 ColladaWorldExporter::~ColladaWorldExporter() = default;
 
+/////////////////////////////////////////////////
+void ColladaWorldExporter::Configure(const Entity &/*_entity*/,
+    const std::shared_ptr<const sdf::Element> &_sdf,
+    EntityComponentManager &/*_ecm*/,
+    EventManager &/*_eventMgr*/)
+{
+  this->dataPtr->background = _sdf->Get<bool>("background",
+      this->dataPtr->background).first;
+}
+
 /////////////////////////////////////////////////
 void ColladaWorldExporter::PostUpdate(const UpdateInfo & /*_info*/,
     const EntityComponentManager &_ecm)
@@ -260,6 +376,7 @@ void ColladaWorldExporter::PostUpdate(const UpdateInfo & /*_info*/,
 
 IGNITION_ADD_PLUGIN(ColladaWorldExporter,
                     System,
+                    ColladaWorldExporter::ISystemConfigure,
                     ColladaWorldExporter::ISystemPostUpdate)
 
 IGNITION_ADD_PLUGIN_ALIAS(ColladaWorldExporter,
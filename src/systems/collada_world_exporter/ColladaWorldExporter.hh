@@ -35,8 +35,20 @@ namespace systems
   /// \brief A plugin that exports a world to a mesh.
   /// When loaded the plugin will dump a mesh containing all the models in
   /// the world to the current directory.
+  ///
+  /// Visuals sharing a mesh reference the mesh loaded by the MeshManager
+  /// until the world mesh is written, and visuals with the same colors
+  /// share a material.
+  ///
+  /// ## System Parameters
+  ///
+  /// `<background>` If true, the world mesh is built and written on a
+  /// separate thread, so simulation isn't blocked while exporting large
+  /// worlds. Defaults to false, which finishes the export within the
+  /// first iteration.
   class IGNITION_GAZEBO_VISIBLE ColladaWorldExporter:
     public System,
+    public ISystemConfigure,
     public ISystemPostUpdate
   {
     /// \brief Constructor
@@ -45,6 +57,12 @@ namespace systems
     /// \brief Destructor
     public: ~ColladaWorldExporter() final;
 
+    // Documentation inherited
+    public: void Configure(const Entity &_entity,
+                           const std::shared_ptr<const sdf::Element> &_sdf,
+                           EntityComponentManager &_ecm,
+                           EventManager &_eventMgr) final;
+
     // Documentation inherited
     public: void PostUpdate(const UpdateInfo &_info,
                            const EntityComponentManager &_ecm);
@@ -105,6 +105,16 @@ void DetachableJoint::Configure(const Entity &_entity,
       "/detachable_joint/detach");
   this->topic = validTopic(topics);
 
+  // Setup attach topic
+  std::vector<std::string> attachTopics;
+  if (_sdf->HasElement("attach_topic"))
+  {
+    attachTopics.push_back(_sdf->Get<std::string>("attach_topic"));
+  }
+  attachTopics.push_back("/model/" + this->model.Name(_ecm) +
+      "/detachable_joint/attach");
+  this->attachTopic = validTopic(attachTopics);
+
   this->suppressChildWarning =
       _sdf->Get<bool>("suppress_child_warning", this->suppressChildWarning)
           .first;
@@ -140,14 +150,7 @@ void DetachableJoint::PreUpdate(
 
       if (kNullEntity != this->childLinkEntity)
       {
-        // Attach the models
-        // We do this by creating a detachable joint entity.
-        this->detachableJointEntity = _ecm.CreateEntity();
-
-        _ecm.CreateComponent(
-            this->detachableJointEntity,
-            components::DetachableJoint({this->parentLinkEntity,
-                                         this->childLinkEntity, "fixed"}));
+        this->Attach(_ecm);
 
         this->node.Subscribe(
             this->topic, &DetachableJoint::OnDetachRequest, this);
@@ -155,6 +158,12 @@ void DetachableJoint::PreUpdate(
         ignmsg << "DetachableJoint subscribing to messages on "
                << "[" << this->topic << "]" << std::endl;
 
+        this->node.Subscribe(
+            this->attachTopic, &DetachableJoint::OnAttachRequest, this);
+
+        ignmsg << "DetachableJoint subscribing to messages on "
+               << "[" << this->attachTopic << "]" << std::endl;
+
         this->initialized = true;
       }
       else
@@ -172,23 +181,61 @@ void DetachableJoint::PreUpdate(
 
   if (this->initialized)
   {
-    if (this->detachRequested && (kNullEntity != this->detachableJointEntity))
+    if (this->detachRequested)
     {
-      // Detach the models
-      igndbg << "Removing entity: " << this->detachableJointEntity << std::endl;
-      _ecm.RequestRemoveEntity(this->detachableJointEntity);
-      this->detachableJointEntity = kNullEntity;
       this->detachRequested = false;
+      if (kNullEntity != this->detachableJointEntity)
+      {
+        // Detach the models
+        igndbg << "Removing entity: " << this->detachableJointEntity
+               << std::endl;
+        _ecm.RequestRemoveEntity(this->detachableJointEntity);
+        this->detachableJointEntity = kNullEntity;
+      }
+    }
+    else if (this->attachRequested)
+    {
+      this->attachRequested = false;
+      // The links are already known, so attaching again doesn't look anything
+      // up
+      if (kNullEntity == this->detachableJointEntity &&
+          _ecm.HasEntity(this->parentLinkEntity) &&
+          _ecm.HasEntity(this->childLinkEntity))
+      {
+        this->Attach(_ecm);
+      }
     }
   }
 }
 
+//////////////////////////////////////////////////
+void DetachableJoint::Attach(EntityComponentManager &_ecm)
+{
+  // Attach the models
+  // We do this by creating a detachable joint entity.
+  this->detachableJointEntity = _ecm.CreateEntity();
+
+  _ecm.CreateComponent(
+      this->detachableJointEntity,
+      components::DetachableJoint({this->parentLinkEntity,
+                                   this->childLinkEntity, "fixed"}));
+  igndbg << "Created entity: " << this->detachableJointEntity << std::endl;
+}
+
 //////////////////////////////////////////////////
 void DetachableJoint::OnDetachRequest(const msgs::Empty &)
 {
+  this->attachRequested = false;
   this->detachRequested = true;
 }
 
+//////////////////////////////////////////////////
+void DetachableJoint::OnAttachRequest(const msgs::Empty &)
+{
+  this->detachRequested = false;
+  this->attachRequested = true;
+}
+
 IGNITION_ADD_PLUGIN(DetachableJoint,
                     ignition::gazebo::System,
                     DetachableJoint::ISystemConfigure,
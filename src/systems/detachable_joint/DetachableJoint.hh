@@ -50,6 +50,12 @@ namespace systems
   ///
   /// <topic> (optional): Topic name to be used for detaching connections
   ///
+  /// <attach_topic> (optional): Topic name to be used for attaching the
+  /// models again after they've been detached. Defaults to
+  /// `/model/<model name>/detachable_joint/attach`. Requests received on
+  /// the same step are coalesced, so only the last of them takes effect,
+  /// and redundant requests are ignored.
+  ///
   /// <suppress_child_warning> (optional): If true, the system
   /// will not print a warning message if a child model does not exist yet.
   /// Otherwise, a warning message is printed. Defaults to false.
@@ -76,6 +82,13 @@ namespace systems
     /// \brief Callback for detach request topic
     private: void OnDetachRequest(const msgs::Empty &_msg);
 
+    /// \brief Callback for attach request topic
+    private: void OnAttachRequest(const msgs::Empty &_msg);
+
+    /// \brief Create the joint entity which attaches the models.
+    /// \param[in] _ecm Entity component manager.
+    private: void Attach(EntityComponentManager &_ecm);
+
     /// \brief The model associated with this system.
     private: Model model;
 
@@ -88,6 +101,9 @@ namespace systems
     /// \brief Topic to be used for detaching connections
     private: std::string topic;
 
+    /// \brief Topic to be used for attaching again
+    private: std::string attachTopic;
+
     /// \brief Whether to suppress warning about missing child model.
     private: bool suppressChildWarning{false};
 
@@ -103,6 +119,10 @@ namespace systems
     /// \brief Whether detachment has been requested
     private: std::atomic<bool> detachRequested{false};
 
+    /// \brief Whether attachment has been requested. Only one of this and
+    /// detachRequested is set at a time, by the latest request.
+    private: std::atomic<bool> attachRequested{false};
+
     /// \brief Ignition communication node.
     public: transport::Node node;
 
@@ -18,8 +18,11 @@
 #include "DiffDrive.hh"
 
 #include <ignition/msgs/odometry.pb.h>
+#include <ignition/msgs/pose_v.pb.h>
 
+#include <functional>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <string>
@@ -34,6 +37,10 @@
 #include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/JointPosition.hh"
 #include "ignition/gazebo/components/JointVelocityCmd.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Link.hh"
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/Util.hh"
@@ -56,34 +63,117 @@ struct Commands
   Commands() : lin(0.0), ang(0.0) {}
 };
 
+/// \brief A vehicle driven by the system.
+struct Vehicle
+{
+  /// \brief Name of the model.
+  std::string name;
+
+  /// \brief Model interface
+  Model model{kNullEntity};
+
+  /// \brief The model's canonical link.
+  Link canonicalLink{kNullEntity};
+
+  /// \brief Entity of the left joint
+  std::vector<Entity> leftJoints;
+
+  /// \brief Entity of the right joint
+  std::vector<Entity> rightJoints;
+
+  /// \brief Calculated speed of left joint
+  double leftJointSpeed{0};
+
+  /// \brief Calculated speed of right joint
+  double rightJointSpeed{0};
+
+  /// \brief Last sim time odom was published.
+  std::chrono::steady_clock::duration lastOdomPubTime{0};
+
+  /// \brief Diff drive odometry.
+  math::DiffDriveOdometry odom;
+
+  /// \brief Diff drive odometry message publisher.
+  transport::Node::Publisher odomPub;
+
+  /// \brief Diff drive tf message publisher. Unused in fleet mode, where
+  /// the transforms of all vehicles are published together.
+  transport::Node::Publisher tfPub;
+
+  /// \brief Linear velocity limiter.
+  std::unique_ptr<SpeedLimiter> limiterLin;
+
+  /// \brief Angular velocity limiter.
+  std::unique_ptr<SpeedLimiter> limiterAng;
+
+  /// \brief Previous control command.
+  Commands last0Cmd;
+
+  /// \brief Previous control command to last0Cmd.
+  Commands last1Cmd;
+
+  /// \brief Last target velocity requested, protected by
+  /// DiffDrivePrivate::mutex.
+  msgs::Twist targetVel;
+
+  /// \brief frame_id from sdf.
+  std::string sdfFrameId;
+
+  /// \brief child_frame_id from sdf.
+  std::string sdfChildFrameId;
+};
+
 class ignition::gazebo::systems::DiffDrivePrivate
 {
-  /// \brief Callback for velocity subscription
-  /// \param[in] _msg Velocity message
-  public: void OnCmdVel(const ignition::msgs::Twist &_msg);
+  /// \brief Set up a vehicle's limiters, odometry, subscription and
+  /// publishers.
+  /// \param[in] _vehicle Vehicle, with its name set.
+  /// \param[in] _sdf The system's SDF.
+  public: void SetupVehicle(Vehicle &_vehicle,
+    const std::shared_ptr<const sdf::Element> &_sdf);
+
+  /// \brief Look for the joints of a vehicle, and start creating the
+  /// components it needs.
+  /// \param[in] _vehicle Vehicle.
+  /// \param[in] _ecm The EntityComponentManager of the given simulation
+  /// instance.
+  /// \return True if all joints were found.
+  public: bool FindJoints(Vehicle &_vehicle,
+    ignition::gazebo::EntityComponentManager &_ecm);
 
   /// \brief Update odometry and publish an odometry message.
+  /// \param[in] _vehicle Vehicle.
   /// \param[in] _info System update information.
   /// \param[in] _ecm The EntityComponentManager of the given simulation
   /// instance.
-  public: void UpdateOdometry(const ignition::gazebo::UpdateInfo &_info,
-    const ignition::gazebo::EntityComponentManager &_ecm);
+  /// \param[out] _tfMsg Message to add the vehicle's transform to, if it's
+  /// published.
+  public: void UpdateOdometry(Vehicle &_vehicle,
+    const ignition::gazebo::UpdateInfo &_info,
+    const ignition::gazebo::EntityComponentManager &_ecm,
+    msgs::Pose_V &_tfMsg);
 
   /// \brief Update the linear and angular velocities.
+  /// \param[in] _vehicle Vehicle.
   /// \param[in] _info System update information.
-  /// \param[in] _ecm The EntityComponentManager of the given simulation
-  /// instance.
-  public: void UpdateVelocity(const ignition::gazebo::UpdateInfo &_info,
-    const ignition::gazebo::EntityComponentManager &_ecm);
+  public: void UpdateVelocity(Vehicle &_vehicle,
+    const ignition::gazebo::UpdateInfo &_info);
 
   /// \brief Ignition communication node.
   public: transport::Node node;
 
-  /// \brief Entity of the left joint
-  public: std::vector<Entity> leftJoints;
+  /// \brief Vehicles driven by the system. There's a single one unless the
+  /// system is attached to a world.
+  public: std::vector<std::unique_ptr<Vehicle>> vehicles;
 
-  /// \brief Entity of the right joint
-  public: std::vector<Entity> rightJoints;
+  /// \brief Whether the system is attached to a world and drives a fleet.
+  public: bool fleet{false};
+
+  /// \brief World entity, in fleet mode.
+  public: Entity world{kNullEntity};
+
+  /// \brief Transform message publisher for the whole fleet.
+  public: transport::Node::Publisher fleetTfPub;
 
   /// \brief Name of left joint
   public: std::vector<std::string> leftJointNames;
@@ -91,62 +181,34 @@ class ignition::gazebo::systems::DiffDrivePrivate
   /// \brief Name of right joint
   public: std::vector<std::string> rightJointNames;
 
-  /// \brief Calculated speed of left joint
-  public: double leftJointSpeed{0};
-
-  /// \brief Calculated speed of right joint
-  public: double rightJointSpeed{0};
-
   /// \brief Distance between wheels
   public: double wheelSeparation{1.0};
 
   /// \brief Wheel radius
   public: double wheelRadius{0.2};
 
-  /// \brief Model interface
-  public: Model model{kNullEntity};
-
-  /// \brief The model's canonical link.
-  public: Link canonicalLink{kNullEntity};
-
   /// \brief Update period calculated from <odom__publish_frequency>.
   public: std::chrono::steady_clock::duration odomPubPeriod{0};
 
-  /// \brief Last sim time odom was published.
-  public: std::chrono::steady_clock::duration lastOdomPubTime{0};
-
-  /// \brief Diff drive odometry.
-  public: math::DiffDriveOdometry odom;
-
-  /// \brief Diff drive odometry message publisher.
-  public: transport::Node::Publisher odomPub;
+  /// \brief Whether velocities are limited.
+  public: bool hasVelocityLimits{false};
 
-  /// \brief Diff drive tf message publisher.
-  public: transport::Node::Publisher tfPub;
+  /// \brief Whether accelerations are limited.
+  public: bool hasAccelerationLimits{false};
 
-  /// \brief Linear velocity limiter.
-  public: std::unique_ptr<SpeedLimiter> limiterLin;
+  /// \brief Whether jerks are limited.
+  public: bool hasJerkLimits{false};
 
-  /// \brief Angular velocity limiter.
-  public: std::unique_ptr<SpeedLimiter> limiterAng;
+  /// \brief Minimum and maximum velocity, acceleration and jerk.
+  public: double minVel{std::numeric_limits<double>::lowest()};
+  public: double maxVel{std::numeric_limits<double>::max()};
+  public: double minAccel{std::numeric_limits<double>::lowest()};
+  public: double maxAccel{std::numeric_limits<double>::max()};
+  public: double minJerk{std::numeric_limits<double>::lowest()};
+  public: double maxJerk{std::numeric_limits<double>::max()};
 
-  /// \brief Previous control command.
-  public: Commands last0Cmd;
-
-  /// \brief Previous control command to last0Cmd.
-  public: Commands last1Cmd;
-
-  /// \brief Last target velocity requested.
-  public: msgs::Twist targetVel;
-
-  /// \brief A mutex to protect the target velocity command.
+  /// \brief A mutex to protect the target velocity commands.
   public: std::mutex mutex;
-
-  /// \brief frame_id from sdf.
-  public: std::string sdfFrameId;
-
-  /// \brief child_frame_id from sdf.
-  public: std::string sdfChildFrameId;
 };
 
 //////////////////////////////////////////////////
@@ -161,25 +223,42 @@ void DiffDrive::Configure(const Entity &_entity,
     EntityComponentManager &_ecm,
     EventManager &/*_eventMgr*/)
 {
-  this->dataPtr->model = Model(_entity);
-
-  // Get the canonical link
-  std::vector<Entity> links = _ecm.ChildrenByComponents(
-      this->dataPtr->model.Entity(), components::CanonicalLink());
-  if (!links.empty())
-    this->dataPtr->canonicalLink = Link(links[0]);
-
-  if (!this->dataPtr->model.Valid(_ecm))
-  {
-    ignerr << "DiffDrive plugin should be attached to a model entity. "
-           << "Failed to initialize." << std::endl;
-    return;
-  }
-
   // Ugly, but needed because the sdf::Element::GetElement is not a const
   // function and _sdf is a const shared pointer to a const sdf::Element.
   auto ptr = const_cast<sdf::Element *>(_sdf.get());
 
+  std::vector<std::string> modelNames;
+  if (nullptr != _ecm.Component<components::World>(_entity))
+  {
+    this->dataPtr->fleet = true;
+    this->dataPtr->world = _entity;
+    if (ptr->HasElement("model"))
+    {
+      for (auto elem = ptr->GetElement("model"); elem;
+           elem = elem->GetNextElement("model"))
+      {
+        modelNames.push_back(elem->Get<std::string>());
+      }
+    }
+    if (modelNames.empty())
+    {
+      ignerr << "DiffDrive plugin attached to a world needs at least one "
+             << "<model>. Failed to initialize." << std::endl;
+      return;
+    }
+  }
+  else
+  {
+    Model model(_entity);
+    if (!model.Valid(_ecm))
+    {
+      ignerr << "DiffDrive plugin should be attached to a model entity. "
+             << "Failed to initialize." << std::endl;
+      return;
+    }
+    modelNames.push_back(model.Name(_ecm));
+  }
+
   // Get params from SDF
   sdf::ElementPtr sdfElem = ptr->GetElement("left_joint");
   while (sdfElem)
@@ -200,56 +279,37 @@ void DiffDrive::Configure(const Entity &_entity,
       this->dataPtr->wheelRadius).first;
 
   // Parse speed limiter parameters.
-  bool hasVelocityLimits     = false;
-  bool hasAccelerationLimits = false;
-  bool hasJerkLimits         = false;
-  double minVel              = std::numeric_limits<double>::lowest();
-  double maxVel              = std::numeric_limits<double>::max();
-  double minAccel            = std::numeric_limits<double>::lowest();
-  double maxAccel            = std::numeric_limits<double>::max();
-  double minJerk             = std::numeric_limits<double>::lowest();
-  double maxJerk             = std::numeric_limits<double>::max();
-
   if (_sdf->HasElement("min_velocity"))
   {
-    minVel = _sdf->Get<double>("min_velocity");
-    hasVelocityLimits = true;
+    this->dataPtr->minVel = _sdf->Get<double>("min_velocity");
+    this->dataPtr->hasVelocityLimits = true;
   }
   if (_sdf->HasElement("max_velocity"))
   {
-    maxVel = _sdf->Get<double>("max_velocity");
-    hasVelocityLimits = true;
+    this->dataPtr->maxVel = _sdf->Get<double>("max_velocity");
+    this->dataPtr->hasVelocityLimits = true;
   }
   if (_sdf->HasElement("min_acceleration"))
   {
-    minAccel = _sdf->Get<double>("min_acceleration");
-    hasAccelerationLimits = true;
+    this->dataPtr->minAccel = _sdf->Get<double>("min_acceleration");
+    this->dataPtr->hasAccelerationLimits = true;
   }
   if (_sdf->HasElement("max_acceleration"))
   {
-    maxAccel = _sdf->Get<double>("max_acceleration");
-    hasAccelerationLimits = true;
+    this->dataPtr->maxAccel = _sdf->Get<double>("max_acceleration");
+    this->dataPtr->hasAccelerationLimits = true;
   }
   if (_sdf->HasElement("min_jerk"))
   {
-    minJerk = _sdf->Get<double>("min_jerk");
-    hasJerkLimits = true;
+    this->dataPtr->minJerk = _sdf->Get<double>("min_jerk");
+    this->dataPtr->hasJerkLimits = true;
   }
   if (_sdf->HasElement("max_jerk"))
   {
-    maxJerk = _sdf->Get<double>("max_jerk");
-    hasJerkLimits = true;
+    this->dataPtr->maxJerk = _sdf->Get<double>("max_jerk");
+    this->dataPtr->hasJerkLimits = true;
   }
 
-  // Instantiate the speed limiters.
-  this->dataPtr->limiterLin = std::make_unique<SpeedLimiter>(
-    hasVelocityLimits, hasAccelerationLimits, hasJerkLimits,
-    minVel, maxVel, minAccel, maxAccel, minJerk, maxJerk);
-
-  this->dataPtr->limiterAng = std::make_unique<SpeedLimiter>(
-    hasVelocityLimits, hasAccelerationLimits, hasJerkLimits,
-    minVel, maxVel, minAccel, maxAccel, minJerk, maxJerk);
-
   double odomFreq = _sdf->Get<double>("odom_publish_frequency", 50).first;
   if (odomFreq > 0)
   {
@@ -258,49 +318,120 @@ void DiffDrive::Configure(const Entity &_entity,
       std::chrono::duration_cast<std::chrono::steady_clock::duration>(odomPer);
   }
 
-  // Setup odometry.
-  this->dataPtr->odom.SetWheelParams(this->dataPtr->wheelSeparation,
-      this->dataPtr->wheelRadius, this->dataPtr->wheelRadius);
+  if (this->dataPtr->fleet)
+  {
+    for (const std::string &element : {"topic", "odom_topic", "frame_id",
+        "child_frame_id"})
+    {
+      if (_sdf->HasElement(element))
+      {
+        ignwarn << "DiffDrive ignores <" << element << "> when attached to "
+                << "a world, each model uses its default." << std::endl;
+      }
+    }
 
-  // Subscribe to commands
-  std::vector<std::string> topics;
-  if (_sdf->HasElement("topic"))
+    std::string tfTopic;
+    if (_sdf->HasElement("tf_topic"))
+    {
+      tfTopic = _sdf->Get<std::string>("tf_topic");
+    }
+    else
+    {
+      auto worldName = _ecm.Component<components::Name>(_entity);
+      tfTopic = "/world/" + (worldName ? worldName->Data() : "default") +
+          "/diff_drive/tf";
+    }
+    this->dataPtr->fleetTfPub = this->dataPtr->node.Advertise<msgs::Pose_V>(
+        tfTopic);
+  }
+
+  for (const auto &name : modelNames)
   {
-    topics.push_back(_sdf->Get<std::string>("topic"));
+    auto vehicle = std::make_unique<Vehicle>();
+    vehicle->name = name;
+    if (!this->dataPtr->fleet)
+    {
+      vehicle->model = Model(_entity);
+
+      // Get the canonical link
+      std::vector<Entity> links = _ecm.ChildrenByComponents(
+          _entity, components::CanonicalLink());
+      if (!links.empty())
+        vehicle->canonicalLink = Link(links[0]);
+    }
+    this->dataPtr->vehicles.push_back(std::move(vehicle));
   }
-  topics.push_back("/model/" + this->dataPtr->model.Name(_ecm) + "/cmd_vel");
-  auto topic = validTopic(topics);
 
-  this->dataPtr->node.Subscribe(topic, &DiffDrivePrivate::OnCmdVel,
-      this->dataPtr.get());
+  for (std::size_t i = 0; i < this->dataPtr->vehicles.size(); ++i)
+  {
+    auto &vehicle = *this->dataPtr->vehicles[i];
+    this->dataPtr->SetupVehicle(vehicle, _sdf);
+
+    // Subscribe to commands
+    std::vector<std::string> topics;
+    if (!this->dataPtr->fleet && _sdf->HasElement("topic"))
+    {
+      topics.push_back(_sdf->Get<std::string>("topic"));
+    }
+    topics.push_back("/model/" + vehicle.name + "/cmd_vel");
+    auto topic = validTopic(topics);
+
+    auto impl = this->dataPtr.get();
+    std::function<void(const msgs::Twist &)> onCmdVel =
+        [impl, i](const msgs::Twist &_msg)
+        {
+          std::lock_guard<std::mutex> lock(impl->mutex);
+          impl->vehicles[i]->targetVel = _msg;
+        };
+    this->dataPtr->node.Subscribe(topic, onCmdVel);
+
+    ignmsg << "DiffDrive subscribing to twist messages on [" << topic << "]"
+           << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void DiffDrivePrivate::SetupVehicle(Vehicle &_vehicle,
+    const std::shared_ptr<const sdf::Element> &_sdf)
+{
+  // Instantiate the speed limiters.
+  _vehicle.limiterLin = std::make_unique<SpeedLimiter>(
+    this->hasVelocityLimits, this->hasAccelerationLimits, this->hasJerkLimits,
+    this->minVel, this->maxVel, this->minAccel, this->maxAccel,
+    this->minJerk, this->maxJerk);
+
+  _vehicle.limiterAng = std::make_unique<SpeedLimiter>(
+    this->hasVelocityLimits, this->hasAccelerationLimits, this->hasJerkLimits,
+    this->minVel, this->maxVel, this->minAccel, this->maxAccel,
+    this->minJerk, this->maxJerk);
+
+  // Setup odometry.
+  _vehicle.odom.SetWheelParams(this->wheelSeparation,
+      this->wheelRadius, this->wheelRadius);
 
   std::vector<std::string> odomTopics;
-  if (_sdf->HasElement("odom_topic"))
+  if (!this->fleet && _sdf->HasElement("odom_topic"))
   {
     odomTopics.push_back(_sdf->Get<std::string>("odom_topic"));
   }
-  odomTopics.push_back("/model/" + this->dataPtr->model.Name(_ecm) +
-      "/odometry");
+  odomTopics.push_back("/model/" + _vehicle.name + "/odometry");
   auto odomTopic = validTopic(odomTopics);
 
-  this->dataPtr->odomPub = this->dataPtr->node.Advertise<msgs::Odometry>(
-      odomTopic);
+  _vehicle.odomPub = this->node.Advertise<msgs::Odometry>(odomTopic);
 
-  std::string tfTopic{"/model/" + this->dataPtr->model.Name(_ecm) +
-    "/tf"};
+  if (this->fleet)
+    return;
+
+  std::string tfTopic{"/model/" + _vehicle.name + "/tf"};
   if (_sdf->HasElement("tf_topic"))
     tfTopic = _sdf->Get<std::string>("tf_topic");
-  this->dataPtr->tfPub = this->dataPtr->node.Advertise<msgs::Pose_V>(
-      tfTopic);
+  _vehicle.tfPub = this->node.Advertise<msgs::Pose_V>(tfTopic);
 
   if (_sdf->HasElement("frame_id"))
-    this->dataPtr->sdfFrameId = _sdf->Get<std::string>("frame_id");
+    _vehicle.sdfFrameId = _sdf->Get<std::string>("frame_id");
 
   if (_sdf->HasElement("child_frame_id"))
-    this->dataPtr->sdfChildFrameId = _sdf->Get<std::string>("child_frame_id");
-
-  ignmsg << "DiffDrive subscribing to twist messages on [" << topic << "]"
-         << std::endl;
+    _vehicle.sdfChildFrameId = _sdf->Get<std::string>("child_frame_id");
 }
 
 //////////////////////////////////////////////////
@@ -317,107 +448,134 @@ void DiffDrive::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
         << "s]. System may not work properly." << std::endl;
   }
 
-  // If the joints haven't been identified yet, look for them
-  static std::set<std::string> warnedModels;
-  auto modelName = this->dataPtr->model.Name(_ecm);
-  if (this->dataPtr->leftJoints.empty() ||
-      this->dataPtr->rightJoints.empty())
+  for (auto &vehicle : this->dataPtr->vehicles)
   {
-    bool warned{false};
-    for (const std::string &name : this->dataPtr->leftJointNames)
+    if (!this->dataPtr->FindJoints(*vehicle, _ecm))
+      continue;
+
+    // Nothing left to do if paused.
+    if (_info.paused)
+      continue;
+
+    for (Entity joint : vehicle->leftJoints)
     {
-      Entity joint = this->dataPtr->model.JointByName(_ecm, name);
-      if (joint != kNullEntity)
-        this->dataPtr->leftJoints.push_back(joint);
-      else if (warnedModels.find(modelName) == warnedModels.end())
+      // Update wheel velocity
+      auto vel = _ecm.Component<components::JointVelocityCmd>(joint);
+
+      if (vel == nullptr)
       {
-        ignwarn << "Failed to find left joint [" << name << "] for model ["
-                << modelName << "]" << std::endl;
-        warned = true;
+        _ecm.CreateComponent(
+            joint, components::JointVelocityCmd({vehicle->leftJointSpeed}));
+      }
+      else
+      {
+        *vel = components::JointVelocityCmd({vehicle->leftJointSpeed});
       }
     }
 
-    for (const std::string &name : this->dataPtr->rightJointNames)
+    for (Entity joint : vehicle->rightJoints)
     {
-      Entity joint = this->dataPtr->model.JointByName(_ecm, name);
-      if (joint != kNullEntity)
-        this->dataPtr->rightJoints.push_back(joint);
-      else if (warnedModels.find(modelName) == warnedModels.end())
+      // Update wheel velocity
+      auto vel = _ecm.Component<components::JointVelocityCmd>(joint);
+
+      if (vel == nullptr)
       {
-        ignwarn << "Failed to find right joint [" << name << "] for model ["
-                << modelName << "]" << std::endl;
-        warned = true;
+        _ecm.CreateComponent(joint,
+            components::JointVelocityCmd({vehicle->rightJointSpeed}));
       }
+      else
+      {
+        *vel = components::JointVelocityCmd({vehicle->rightJointSpeed});
+      }
+    }
+
+    // Create the left and right side joint position components if they
+    // don't exist.
+    auto leftPos = _ecm.Component<components::JointPosition>(
+        vehicle->leftJoints[0]);
+    if (!leftPos)
+    {
+      _ecm.CreateComponent(vehicle->leftJoints[0],
+          components::JointPosition());
     }
-    if (warned)
+
+    auto rightPos = _ecm.Component<components::JointPosition>(
+        vehicle->rightJoints[0]);
+    if (!rightPos)
     {
-      warnedModels.insert(modelName);
+      _ecm.CreateComponent(vehicle->rightJoints[0],
+          components::JointPosition());
     }
   }
+}
 
-  if (this->dataPtr->leftJoints.empty() || this->dataPtr->rightJoints.empty())
-    return;
+//////////////////////////////////////////////////
+bool DiffDrivePrivate::FindJoints(Vehicle &_vehicle,
+    ignition::gazebo::EntityComponentManager &_ecm)
+{
+  if (!_vehicle.leftJoints.empty() && !_vehicle.rightJoints.empty())
+    return true;
 
-  if (warnedModels.find(modelName) != warnedModels.end())
+  // In fleet mode, models are found by name the first time
+  if (_vehicle.model.Entity() == kNullEntity)
   {
-    ignmsg << "Found joints for model [" << modelName
-           << "], plugin will start working." << std::endl;
-    warnedModels.erase(modelName);
+    auto entity = _ecm.EntityByComponents(components::Model(),
+        components::Name(_vehicle.name),
+        components::ParentEntity(this->world));
+    if (entity == kNullEntity)
+      return false;
+
+    _vehicle.model = Model(entity);
+    std::vector<Entity> links = _ecm.ChildrenByComponents(
+        entity, components::CanonicalLink());
+    if (!links.empty())
+      _vehicle.canonicalLink = Link(links[0]);
   }
 
-  // Nothing left to do if paused.
-  if (_info.paused)
-    return;
-
-  for (Entity joint : this->dataPtr->leftJoints)
+  // If the joints haven't been identified yet, look for them
+  static std::set<std::string> warnedModels;
+  const auto &modelName = _vehicle.name;
+  bool warned{false};
+  for (const std::string &name : this->leftJointNames)
   {
-    // Update wheel velocity
-    auto vel = _ecm.Component<components::JointVelocityCmd>(joint);
-
-    if (vel == nullptr)
+    Entity joint = _vehicle.model.JointByName(_ecm, name);
+    if (joint != kNullEntity)
+      _vehicle.leftJoints.push_back(joint);
+    else if (warnedModels.find(modelName) == warnedModels.end())
     {
-      _ecm.CreateComponent(
-          joint, components::JointVelocityCmd({this->dataPtr->leftJointSpeed}));
-    }
-    else
-    {
-      *vel = components::JointVelocityCmd({this->dataPtr->leftJointSpeed});
+      ignwarn << "Failed to find left joint [" << name << "] for model ["
+              << modelName << "]" << std::endl;
+      warned = true;
     }
   }
 
-  for (Entity joint : this->dataPtr->rightJoints)
+  for (const std::string &name : this->rightJointNames)
   {
-    // Update wheel velocity
-    auto vel = _ecm.Component<components::JointVelocityCmd>(joint);
-
-    if (vel == nullptr)
+    Entity joint = _vehicle.model.JointByName(_ecm, name);
+    if (joint != kNullEntity)
+      _vehicle.rightJoints.push_back(joint);
+    else if (warnedModels.find(modelName) == warnedModels.end())
     {
-      _ecm.CreateComponent(joint,
-          components::JointVelocityCmd({this->dataPtr->rightJointSpeed}));
-    }
-    else
-    {
-      *vel = components::JointVelocityCmd({this->dataPtr->rightJointSpeed});
+      ignwarn << "Failed to find right joint [" << name << "] for model ["
+              << modelName << "]" << std::endl;
+      warned = true;
     }
   }
-
-  // Create the left and right side joint position components if they
-  // don't exist.
-  auto leftPos = _ecm.Component<components::JointPosition>(
-      this->dataPtr->leftJoints[0]);
-  if (!leftPos)
+  if (warned)
   {
-    _ecm.CreateComponent(this->dataPtr->leftJoints[0],
-        components::JointPosition());
+    warnedModels.insert(modelName);
   }
 
-  auto rightPos = _ecm.Component<components::JointPosition>(
-      this->dataPtr->rightJoints[0]);
-  if (!rightPos)
+  if (_vehicle.leftJoints.empty() || _vehicle.rightJoints.empty())
+    return false;
+
+  if (warnedModels.find(modelName) != warnedModels.end())
   {
-    _ecm.CreateComponent(this->dataPtr->rightJoints[0],
-        components::JointPosition());
+    ignmsg << "Found joints for model [" << modelName
+           << "], plugin will start working." << std::endl;
+    warnedModels.erase(modelName);
   }
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -429,29 +587,52 @@ void DiffDrive::PostUpdate(const UpdateInfo &_info,
   if (_info.paused)
     return;
 
-  this->dataPtr->UpdateVelocity(_info, _ecm);
-  this->dataPtr->UpdateOdometry(_info, _ecm);
+  // In fleet mode, the transforms of all vehicles are published at once
+  msgs::Pose_V fleetTfMsg;
+  for (auto &vehicle : this->dataPtr->vehicles)
+  {
+    this->dataPtr->UpdateVelocity(*vehicle, _info);
+
+    if (this->dataPtr->fleet)
+    {
+      if (vehicle->model.Entity() == kNullEntity)
+        continue;
+      this->dataPtr->UpdateOdometry(*vehicle, _info, _ecm, fleetTfMsg);
+      continue;
+    }
+
+    msgs::Pose_V tfMsg;
+    this->dataPtr->UpdateOdometry(*vehicle, _info, _ecm, tfMsg);
+    if (tfMsg.pose_size() > 0)
+      vehicle->tfPub.Publish(tfMsg);
+  }
+
+  if (fleetTfMsg.pose_size() > 0)
+    this->dataPtr->fleetTfPub.Publish(fleetTfMsg);
 }
 
 //////////////////////////////////////////////////
-void DiffDrivePrivate::UpdateOdometry(const ignition::gazebo::UpdateInfo &_info,
-    const ignition::gazebo::EntityComponentManager &_ecm)
+void DiffDrivePrivate::UpdateOdometry(Vehicle &_vehicle,
+    const ignition::gazebo::UpdateInfo &_info,
+    const ignition::gazebo::EntityComponentManager &_ecm,
+    msgs::Pose_V &_tfMsg)
 {
   IGN_PROFILE("DiffDrive::UpdateOdometry");
   // Initialize, if not already initialized.
-  if (!this->odom.Initialized())
+  if (!_vehicle.odom.Initialized())
   {
-    this->odom.Init(std::chrono::steady_clock::time_point(_info.simTime));
+    _vehicle.odom.Init(std::chrono::steady_clock::time_point(_info.simTime));
     return;
   }
 
-  if (this->leftJoints.empty() || this->rightJoints.empty())
+  if (_vehicle.leftJoints.empty() || _vehicle.rightJoints.empty())
     return;
 
   // Get the first joint positions for the left and right side.
-  auto leftPos = _ecm.Component<components::JointPosition>(this->leftJoints[0]);
+  auto leftPos = _ecm.Component<components::JointPosition>(
+      _vehicle.leftJoints[0]);
   auto rightPos = _ecm.Component<components::JointPosition>(
-      this->rightJoints[0]);
+      _vehicle.rightJoints[0]);
 
   // Abort if the joints were not found or just created.
   if (!leftPos || !rightPos || leftPos->Data().empty() ||
@@ -460,28 +641,30 @@ void DiffDrivePrivate::UpdateOdometry(const ignition::gazebo::UpdateInfo &_info,
     return;
   }
 
-  this->odom.Update(leftPos->Data()[0], rightPos->Data()[0],
+  _vehicle.odom.Update(leftPos->Data()[0], rightPos->Data()[0],
       std::chrono::steady_clock::time_point(_info.simTime));
 
   // Throttle publishing
-  auto diff = _info.simTime - this->lastOdomPubTime;
+  auto diff = _info.simTime - _vehicle.lastOdomPubTime;
   if (diff > std::chrono::steady_clock::duration::zero() &&
       diff < this->odomPubPeriod)
   {
     return;
   }
-  this->lastOdomPubTime = _info.simTime;
+  _vehicle.lastOdomPubTime = _info.simTime;
 
   // Construct the odometry message and publish it.
   msgs::Odometry msg;
-  msg.mutable_pose()->mutable_position()->set_x(this->odom.X());
-  msg.mutable_pose()->mutable_position()->set_y(this->odom.Y());
+  msg.mutable_pose()->mutable_position()->set_x(_vehicle.odom.X());
+  msg.mutable_pose()->mutable_position()->set_y(_vehicle.odom.Y());
 
-  math::Quaterniond orientation(0, 0, *this->odom.Heading());
+  math::Quaterniond orientation(0, 0, *_vehicle.odom.Heading());
   msgs::Set(msg.mutable_pose()->mutable_orientation(), orientation);
 
-  msg.mutable_twist()->mutable_linear()->set_x(this->odom.LinearVelocity());
-  msg.mutable_twist()->mutable_angular()->set_z(*this->odom.AngularVelocity());
+  msg.mutable_twist()->mutable_linear()->set_x(
+      _vehicle.odom.LinearVelocity());
+  msg.mutable_twist()->mutable_angular()->set_z(
+      *_vehicle.odom.AngularVelocity());
 
   // Set the time stamp in the header
   msg.mutable_header()->mutable_stamp()->CopyFrom(
@@ -490,48 +673,45 @@ void DiffDrivePrivate::UpdateOdometry(const ignition::gazebo::UpdateInfo &_info,
   // Set the frame id.
   auto frame = msg.mutable_header()->add_data();
   frame->set_key("frame_id");
-  if (this->sdfFrameId.empty())
+  if (_vehicle.sdfFrameId.empty())
   {
-    frame->add_value(this->model.Name(_ecm) + "/odom");
+    frame->add_value(_vehicle.name + "/odom");
   }
   else
   {
-    frame->add_value(this->sdfFrameId);
+    frame->add_value(_vehicle.sdfFrameId);
   }
 
-  std::optional<std::string> linkName = this->canonicalLink.Name(_ecm);
-  if (this->sdfChildFrameId.empty())
+  std::optional<std::string> linkName = _vehicle.canonicalLink.Name(_ecm);
+  if (_vehicle.sdfChildFrameId.empty())
   {
     if (linkName)
     {
       auto childFrame = msg.mutable_header()->add_data();
       childFrame->set_key("child_frame_id");
-      childFrame->add_value(this->model.Name(_ecm) + "/" + *linkName);
+      childFrame->add_value(_vehicle.name + "/" + *linkName);
     }
   }
   else
   {
     auto childFrame = msg.mutable_header()->add_data();
     childFrame->set_key("child_frame_id");
-    childFrame->add_value(this->sdfChildFrameId);
+    childFrame->add_value(_vehicle.sdfChildFrameId);
   }
 
-  // Construct the Pose_V/tf message and publish it.
-  msgs::Pose_V tfMsg;
-  ignition::msgs::Pose *tfMsgPose = nullptr;
-  tfMsgPose = tfMsg.add_pose();
-  tfMsgPose->mutable_header()->CopyFrom(*msg.mutable_header());
-  tfMsgPose->mutable_position()->CopyFrom(msg.mutable_pose()->position());
-  tfMsgPose->mutable_orientation()->CopyFrom(msg.mutable_pose()->orientation());
-
-  // Publish the messages
-  this->odomPub.Publish(msg);
-  this->tfPub.Publish(tfMsg);
+  // Add the transform to the Pose_V/tf message.
+  ignition::msgs::Pose *tfMsgPose = _tfMsg.add_pose();
+  tfMsgPose->mutable_header()->CopyFrom(msg.header());
+  tfMsgPose->mutable_position()->CopyFrom(msg.pose().position());
+  tfMsgPose->mutable_orientation()->CopyFrom(msg.pose().orientation());
+
+  // Publish the message
+  _vehicle.odomPub.Publish(msg);
 }
 
 //////////////////////////////////////////////////
-void DiffDrivePrivate::UpdateVelocity(const ignition::gazebo::UpdateInfo &_info,
-    const ignition::gazebo::EntityComponentManager &/*_ecm*/)
+void DiffDrivePrivate::UpdateVelocity(Vehicle &_vehicle,
+    const ignition::gazebo::UpdateInfo &_info)
 {
   IGN_PROFILE("DiffDrive::UpdateVelocity");
 
@@ -539,35 +719,30 @@ void DiffDrivePrivate::UpdateVelocity(const ignition::gazebo::UpdateInfo &_info,
   double angVel;
   {
     std::lock_guard<std::mutex> lock(this->mutex);
-    linVel = this->targetVel.linear().x();
-    angVel = this->targetVel.angular().z();
+    linVel = _vehicle.targetVel.linear().x();
+    angVel = _vehicle.targetVel.angular().z();
   }
 
   const double dt = std::chrono::duration<double>(_info.dt).count();
 
   // Limit the target velocity if needed.
-  this->limiterLin->Limit(linVel, this->last0Cmd.lin, this->last1Cmd.lin, dt);
-  this->limiterAng->Limit(angVel, this->last0Cmd.ang, this->last1Cmd.ang, dt);
+  _vehicle.limiterLin->Limit(linVel, _vehicle.last0Cmd.lin,
+      _vehicle.last1Cmd.lin, dt);
+  _vehicle.limiterAng->Limit(angVel, _vehicle.last0Cmd.ang,
+      _vehicle.last1Cmd.ang, dt);
 
   // Update history of commands.
-  this->last1Cmd = last0Cmd;
-  this->last0Cmd.lin = linVel;
-  this->last0Cmd.ang = angVel;
+  _vehicle.last1Cmd = _vehicle.last0Cmd;
+  _vehicle.last0Cmd.lin = linVel;
+  _vehicle.last0Cmd.ang = angVel;
 
   // Convert the target velocities to joint velocities.
-  this->rightJointSpeed =
+  _vehicle.rightJointSpeed =
     (linVel + angVel * this->wheelSeparation / 2.0) / this->wheelRadius;
-  this->leftJointSpeed =
+  _vehicle.leftJointSpeed =
     (linVel - angVel * this->wheelSeparation / 2.0) / this->wheelRadius;
 }
 
-//////////////////////////////////////////////////
-void DiffDrivePrivate::OnCmdVel(const msgs::Twist &_msg)
-{
-  std::lock_guard<std::mutex> lock(this->mutex);
-  this->targetVel = _msg;
-}
-
 IGNITION_ADD_PLUGIN(DiffDrive,
                     ignition::gazebo::System,
                     DiffDrive::ISystemConfigure,
@@ -77,6 +77,17 @@ namespace systems
   /// `ignition.msgs.Pose_V` message and the `<odom_topic>`
   /// `ignition.msgs.Odometry` message. This element if optional,
   ///  and the default value is `{name_of_model}/{name_of_link}`.
+  ///
+  /// # Fleet mode
+  ///
+  /// When attached to a world, a single instance drives every model listed
+  /// in a `<model>` element, by name. All models share the parameters above,
+  /// and are updated in one pass per step instead of one system per model.
+  /// Each model subscribes and publishes odometry on its default topics,
+  /// and `<topic>`, `<odom_topic>`, `<frame_id>` and `<child_frame_id>` are
+  /// ignored. The transforms of all models are published together, in a
+  /// single `ignition.msgs.Pose_V` message on `<tf_topic>`, which defaults
+  /// to `/world/{name_of_world}/diff_drive/tf`.
   class DiffDrive
       : public System,
         public ISystemConfigure,
@@ -19,6 +19,7 @@
 
 #include <ignition/msgs/model.pb.h>
 
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -89,6 +90,27 @@ void JointStatePublisher::Configure(
       this->CreateComponents(_ecm, joint);
     }
   }
+
+  double updateRate = _sdf->Get<double>("update_rate", 0.0).first;
+  if (updateRate > 0)
+  {
+    std::chrono::duration<double> period{1 / updateRate};
+    this->updatePeriod =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+  }
+
+  this->changeTolerance = _sdf->Get<double>("change_tolerance",
+      this->changeTolerance).first;
+
+  // Build the parts of the message which don't change
+  this->msg.set_name(this->model.Name(_ecm));
+  this->msg.set_id(this->model.Entity());
+  for (const Entity &joint : this->joints)
+  {
+    msgs::Joint *jointMsg = this->msg.add_joint();
+    jointMsg->set_name(_ecm.Component<components::Name>(joint)->Data());
+    jointMsg->set_id(joint);
+  }
 }
 
 //////////////////////////////////////////////////
@@ -154,31 +176,100 @@ void JointStatePublisher::PostUpdate(const UpdateInfo &_info,
   if (!this->modelPub)
     return;
 
-  // Create the message
-  msgs::Model msg;
-  msg.mutable_header()->mutable_stamp()->CopyFrom(
-      convert<msgs::Time>(_info.simTime));
+  // Skip if the last message was published too recently. If time went
+  // backward, publish and let the time be reset.
+  auto diff = _info.simTime - this->lastPubTime;
+  if (this->published &&
+      (diff > std::chrono::steady_clock::duration::zero()) &&
+      (diff < this->updatePeriod))
+  {
+    return;
+  }
 
-  // Set the name and ID.
-  msg.set_name(this->model.Name(_ecm));
-  msg.set_id(this->model.Entity());
+  // Skip if no joint changed enough
+  if (this->published && this->changeTolerance >= 0 &&
+      !this->JointsChanged(_ecm))
+  {
+    return;
+  }
+
+  this->msg.mutable_header()->mutable_stamp()->CopyFrom(
+      convert<msgs::Time>(_info.simTime));
 
   // Set the model pose
   const auto *pose = _ecm.Component<components::Pose>(
       this->model.Entity());
   if (pose)
-    msgs::Set(msg.mutable_pose(), pose->Data());
+    msgs::Set(this->msg.mutable_pose(), pose->Data());
+
+  this->FillJoints(_ecm);
 
+  // Publish the message.
+  this->modelPub->Publish(this->msg);
+  this->lastPubTime = _info.simTime;
+  this->published = true;
+}
+
+//////////////////////////////////////////////////
+bool JointStatePublisher::JointsChanged(
+    const EntityComponentManager &_ecm) const
+{
+  auto changed = [&](const std::vector<double> &_values,
+      const msgs::Joint &_jointMsg, double (msgs::Axis::*_get)() const)
+  {
+    if (_values.size() > 0 && (!_jointMsg.has_axis1() ||
+        std::abs((_jointMsg.axis1().*_get)() - _values[0]) >
+        this->changeTolerance))
+    {
+      return true;
+    }
+    return _values.size() > 1 && (!_jointMsg.has_axis2() ||
+        std::abs((_jointMsg.axis2().*_get)() - _values[1]) >
+        this->changeTolerance);
+  };
+
+  int i = 0;
+  for (const Entity &joint : this->joints)
+  {
+    const msgs::Joint &jointMsg = this->msg.joint(i++);
+
+    const auto *jointPositions =
+      _ecm.Component<components::JointPosition>(joint);
+    if (jointPositions &&
+        changed(jointPositions->Data(), jointMsg, &msgs::Axis::position))
+    {
+      return true;
+    }
+
+    const auto *jointVelocity =
+      _ecm.Component<components::JointVelocity>(joint);
+    if (jointVelocity &&
+        changed(jointVelocity->Data(), jointMsg, &msgs::Axis::velocity))
+    {
+      return true;
+    }
+
+    const auto *jointForce = _ecm.Component<components::JointForce>(joint);
+    if (jointForce &&
+        changed(jointForce->Data(), jointMsg, &msgs::Axis::force))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+void JointStatePublisher::FillJoints(const EntityComponentManager &_ecm)
+{
   // Process each joint
+  int index = 0;
   for (const Entity &joint : this->joints)
   {
-    // Add a joint message.
-    msgs::Joint *jointMsg = msg.add_joint();
-    jointMsg->set_name(_ecm.Component<components::Name>(joint)->Data());
-    jointMsg->set_id(joint);
+    msgs::Joint *jointMsg = this->msg.mutable_joint(index++);
 
     // Set the joint pose
-    pose = _ecm.Component<components::Pose>(joint);
+    const auto *pose = _ecm.Component<components::Pose>(joint);
     if (pose)
       msgs::Set(jointMsg->mutable_pose(), pose->Data());
 
@@ -230,9 +321,6 @@ void JointStatePublisher::PostUpdate(const UpdateInfo &_info,
       }
     }
   }
-
-  // Publish the message.
-  this->modelPub->Publish(msg);
 }
 
 IGNITION_ADD_PLUGIN(JointStatePublisher,
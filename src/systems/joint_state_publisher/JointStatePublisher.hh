@@ -18,6 +18,9 @@
 #ifndef IGNITION_GAZEBO_SYSTEMS_STATE_PUBLISHER_HH_
 #define IGNITION_GAZEBO_SYSTEMS_STATE_PUBLISHER_HH_
 
+#include <ignition/msgs/model.pb.h>
+
+#include <chrono>
 #include <memory>
 #include <set>
 #include <ignition/gazebo/Model.hh>
@@ -45,6 +48,14 @@ namespace systems
   /// `<joint_name>`: Name of a joint to publish. This parameter can be
   /// specified multiple times, and is optional. All joints in a model will
   /// be published if joint names are not specified.
+  ///
+  /// `<update_rate>`: Maximum rate of publications in Hz. Optional, states
+  /// are published on every iteration by default.
+  ///
+  /// `<change_tolerance>`: If set, a state is only published when the
+  /// position, velocity or force of a joint changed by more than this
+  /// tolerance since the last published state. Optional, states are
+  /// published regardless of changes by default.
   class JointStatePublisher
       : public System,
         public ISystemConfigure,
@@ -71,6 +82,16 @@ namespace systems
     private: void CreateComponents(EntityComponentManager &_ecm,
                                    gazebo::Entity _joint);
 
+    /// \brief Check whether a joint state changed by more than the change
+    /// tolerance since the last published message.
+    /// \param[in] _ecm The EntityComponentManager.
+    /// \return True if any joint changed.
+    private: bool JointsChanged(const EntityComponentManager &_ecm) const;
+
+    /// \brief Fill the joint states of the message.
+    /// \param[in] _ecm The EntityComponentManager.
+    private: void FillJoints(const EntityComponentManager &_ecm);
+
     /// \brief The model
     private: Model model;
 
@@ -82,6 +103,24 @@ namespace systems
 
     /// \brief The joints that will be published.
     private: std::set<Entity> joints;
+
+    /// \brief The message, built once and updated in place before each
+    /// publication. Its joints are in the same order as `joints`.
+    private: msgs::Model msg;
+
+    /// \brief Minimum time between publications, zero to publish on every
+    /// iteration.
+    private: std::chrono::steady_clock::duration updatePeriod{0};
+
+    /// \brief Last time a message was published.
+    private: std::chrono::steady_clock::duration lastPubTime{0};
+
+    /// \brief Change of a joint state needed to publish, negative to publish
+    /// regardless of changes.
+    private: double changeTolerance{-1.0};
+
+    /// \brief Whether a message has been published yet.
+    private: bool published{false};
   };
   }
 }
@@ -251,6 +251,14 @@ class Trajectory
   /// \brief Trajectory defined in terms of temporal points, whose members are
   /// ordered according to `jointNames`
   public: std::vector<ignition::msgs::JointTrajectoryPoint> points;
+
+  /// \brief Time from start of each point, converted once when the
+  /// trajectory is received
+  public: std::vector<std::chrono::steady_clock::duration> pointTimes;
+
+  /// \brief Actuated joint for each of `jointNames`, or null if the joint
+  /// isn't controlled by the plugin. Resolved when the trajectory is received
+  public: std::vector<ActuatedJoint *> joints;
 };
 
 /// \brief Private data of the JointTrajectoryController plugin
@@ -481,20 +489,19 @@ void JointTrajectoryController::PreUpdate(
     if (isTargetUpdateRequired &&
         this->dataPtr->trajectory.status != Trajectory::Reached)
     {
-      const auto targetPoint =
+      const auto &targetPoint =
           this->dataPtr->trajectory.points[this->dataPtr->trajectory
                                                .pointIndex];
       for (auto jointIndex = 0u;
-           jointIndex < this->dataPtr->trajectory.jointNames.size();
+           jointIndex < this->dataPtr->trajectory.joints.size();
            ++jointIndex)
       {
-        const auto jointName = this->dataPtr->trajectory.jointNames[jointIndex];
-        if (this->dataPtr->actuatedJoints.count(jointName) == 0)
+        auto *joint = this->dataPtr->trajectory.joints[jointIndex];
+        if (nullptr == joint)
         {
-          // Warning about unconfigured joint is already logged above
+          // Warning about unconfigured joint is already logged on reception
           continue;
         }
-        auto *joint = &this->dataPtr->actuatedJoints[jointName];
         joint->SetTarget(targetPoint, jointIndex);
       }
 
@@ -642,7 +649,7 @@ void JointTrajectoryControllerPrivate::JointTrajectoryCallback(
 
   // Warn user that accelerations are currently ignored if the first point
   // contains them
-  if (_msg.points(0).accelerations_size() > 0)
+  if (_msg.points_size() > 0 && _msg.points(0).accelerations_size() > 0)
   {
     ignwarn << "[JointTrajectoryController] JointTrajectory message contains"
                " acceleration commands, which are currently ignored.\n";
@@ -677,14 +684,36 @@ void JointTrajectoryControllerPrivate::JointTrajectoryCallback(
   // Reset for a new trajectory
   this->trajectory.Reset();
 
-  // Extract joint names and points
+  // Extract joint names and points, and resolve everything the update loop
+  // needs so it doesn't look anything up
+  this->trajectory.jointNames.reserve(_msg.joint_names_size());
+  this->trajectory.joints.reserve(_msg.joint_names_size());
   for (const auto &joint_name : _msg.joint_names())
   {
     this->trajectory.jointNames.push_back(joint_name);
+
+    auto it = this->actuatedJoints.find(joint_name);
+    if (it == this->actuatedJoints.end())
+    {
+      ignwarn << "[JointTrajectoryController] Joint [" << joint_name
+              << "] of the JointTrajectory message isn't controlled by this"
+                 " plugin, it will be ignored.\n";
+      this->trajectory.joints.push_back(nullptr);
+      continue;
+    }
+    this->trajectory.joints.push_back(&it->second);
   }
+
+  this->trajectory.points.reserve(_msg.points_size());
+  this->trajectory.pointTimes.reserve(_msg.points_size());
   for (const auto &point : _msg.points())
   {
     this->trajectory.points.push_back(point);
+
+    const auto &pointTFS = point.time_from_start();
+    this->trajectory.pointTimes.push_back(
+        std::chrono::seconds(pointTFS.sec()) +
+        std::chrono::nanoseconds(pointTFS.nsec()));
   }
 }
 
@@ -1011,10 +1040,7 @@ bool Trajectory::UpdateCurrentPoint(
     }
 
     // Break if point needs to be followed
-    const auto pointTFS = this->points[this->pointIndex].time_from_start();
-    const auto pointTime = std::chrono::seconds(pointTFS.sec()) +
-                           std::chrono::nanoseconds(pointTFS.nsec());
-    if (pointTime >= trajectoryTime)
+    if (this->pointTimes[this->pointIndex] >= trajectoryTime)
     {
       break;
     }
@@ -1055,6 +1081,8 @@ void Trajectory::Reset()
   this->pointIndex = 0;
   this->jointNames.clear();
   this->points.clear();
+  this->pointTimes.clear();
+  this->joints.clear();
 }
 
 // Register plugin
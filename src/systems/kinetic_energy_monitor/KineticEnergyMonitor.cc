@@ -18,12 +18,17 @@
 #include <google/protobuf/message.h>
 #include <ignition/msgs/double.pb.h>
 
+#include <chrono>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <ignition/gazebo/components/AngularVelocity.hh>
 #include <ignition/gazebo/components/Link.hh>
 #include <ignition/gazebo/components/LinearVelocity.hh>
+#include <ignition/gazebo/components/Model.hh>
 #include <ignition/gazebo/components/Name.hh>
+#include <ignition/gazebo/components/ParentEntity.hh>
 #include <ignition/gazebo/components/Pose.hh>
 #include <ignition/gazebo/components/World.hh>
 #include <ignition/gazebo/components/Inertial.hh>
@@ -42,26 +47,51 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
-/// \brief Private data class
-class ignition::gazebo::systems::KineticEnergyMonitorPrivate
+/// \brief A monitored link.
+struct MonitoredLink
 {
-  /// \brief Link of the model.
-  public: Entity linkEntity;
+  /// \brief Link entity.
+  Entity linkEntity{kNullEntity};
 
-  /// \brief Name of the model this plugin is attached to.
-  public: std::string modelName;
+  /// \brief Name of the link's model.
+  std::string modelName;
 
-  /// \brief Kinetic energy during the previous step.
-  public: double prevKineticEnergy {0.0};
+  /// \brief Kinetic energy during the previous update.
+  double prevKineticEnergy{0.0};
+
+  /// \brief Ignition communication publisher.
+  transport::Node::Publisher pub;
+};
+
+/// \brief Private data class
+class ignition::gazebo::systems::KineticEnergyMonitorPrivate
+{
+  /// \brief Start monitoring a link of a model.
+  /// \param[in] _model Model.
+  /// \param[in] _linkName Name of the link within the model.
+  /// \param[in] _topic Topic to publish on, empty for the default.
+  /// \param[in] _ecm Entity component manager.
+  /// \return False if the link wasn't found.
+  public: bool AddLink(const Model &_model, const std::string &_linkName,
+      const std::string &_topic, EntityComponentManager &_ecm);
+
+  /// \brief Monitored links.
+  public: std::vector<MonitoredLink> links;
 
   /// \brief Kinetic energy threshold.
   public: double keThreshold {7.0};
 
-  /// \brief Ignition communication publisher.
-  public: transport::Node::Publisher pub;
+  /// \brief Sim time between updates, zero to update every step.
+  public: std::chrono::steady_clock::duration updatePeriod{0};
+
+  /// \brief Sim time of the last update.
+  public: std::chrono::steady_clock::duration lastUpdateTime{0};
 
-  /// \brief The model this plugin is attached to.
-  public: Model model;
+  /// \brief Whether an update has been done.
+  public: bool updated{false};
+
+  /// \brief Ignition communication node.
+  public: transport::Node node;
 };
 
 //////////////////////////////////////////////////
@@ -79,18 +109,50 @@ void KineticEnergyMonitor::Configure(const Entity &_entity,
         EntityComponentManager &_ecm,
         EventManager &/*_eventMgr*/)
 {
-  this->dataPtr->model = Model(_entity);
+  auto sdfClone = _sdf->Clone();
 
-  if (!this->dataPtr->model.Valid(_ecm))
+  // Attached to a world, the listed models are monitored
+  std::vector<Model> models;
+  const bool multiModel =
+      nullptr != _ecm.Component<components::World>(_entity);
+  if (multiModel)
   {
-    ignerr << "KineticEnergyMonitor should be attached to a model "
-      << "entity. Failed to initialize." << std::endl;
-    return;
+    if (sdfClone->HasElement("model"))
+    {
+      for (auto elem = sdfClone->GetElement("model"); elem;
+           elem = elem->GetNextElement("model"))
+      {
+        auto name = elem->Get<std::string>();
+        auto entity = _ecm.EntityByComponents(components::Model(),
+            components::Name(name), components::ParentEntity(_entity));
+        if (entity == kNullEntity)
+        {
+          ignerr << "Model [" << name << "] could not be found, it won't "
+                 << "be monitored." << std::endl;
+          continue;
+        }
+        models.emplace_back(entity);
+      }
+    }
+    if (models.empty())
+    {
+      ignerr << "KineticEnergyMonitor attached to a world needs at least "
+             << "one <model>. Failed to initialize." << std::endl;
+      return;
+    }
+  }
+  else
+  {
+    Model model(_entity);
+    if (!model.Valid(_ecm))
+    {
+      ignerr << "KineticEnergyMonitor should be attached to a model "
+        << "entity. Failed to initialize." << std::endl;
+      return;
+    }
+    models.push_back(model);
   }
 
-  this->dataPtr->modelName = this->dataPtr->model.Name(_ecm);
-
-  auto sdfClone = _sdf->Clone();
   std::string linkName;
   if (sdfClone->HasElement("link_name"))
   {
@@ -104,89 +166,134 @@ void KineticEnergyMonitor::Configure(const Entity &_entity,
     return;
   }
 
+  this->dataPtr->keThreshold = sdfClone->Get<double>(
+      "kinetic_energy_threshold", 7.0).first;
+
+  double rate = sdfClone->Get<double>("update_rate", 0.0).first;
+  if (rate > 0.0)
+  {
+    this->dataPtr->updatePeriod = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / rate));
+  }
+
+  // Each model publishes on its default topic when there are several
+  std::string topic;
+  if (!multiModel)
+    topic = sdfClone->Get<std::string>("topic", topic).first;
+  else if (sdfClone->HasElement("topic"))
+  {
+    ignwarn << "KineticEnergyMonitor ignores <topic> when attached to a "
+            << "world, each model uses its default." << std::endl;
+  }
+
+  for (const auto &model : models)
+  {
+    this->dataPtr->AddLink(model, linkName, topic, _ecm);
+  }
+}
+
+//////////////////////////////////////////////////
+bool KineticEnergyMonitorPrivate::AddLink(const Model &_model,
+    const std::string &_linkName, const std::string &_topic,
+    EntityComponentManager &_ecm)
+{
+  MonitoredLink link;
+  link.modelName = _model.Name(_ecm);
+
   // Get the link entity
-  this->dataPtr->linkEntity = this->dataPtr->model.LinkByName(_ecm, linkName);
+  link.linkEntity = _model.LinkByName(_ecm, _linkName);
 
-  if (this->dataPtr->linkEntity == kNullEntity)
+  if (link.linkEntity == kNullEntity)
   {
-    ignerr << "Link " << linkName
+    ignerr << "Link " << _linkName
       << " could not be found. Failed to initialize.\n";
-    return;
+    return false;
   }
 
-  this->dataPtr->keThreshold = sdfClone->Get<double>(
-      "kinetic_energy_threshold", 7.0).first;
-
-  std::string defaultTopic{"/model/" + this->dataPtr->modelName +
-    "/kinetic_energy"};
-  std::string topic = sdfClone->Get<std::string>("topic", defaultTopic).first;
+  std::string topic{_topic};
+  if (topic.empty())
+    topic = "/model/" + link.modelName + "/kinetic_energy";
 
   ignmsg << "KineticEnergyMonitor publishing messages on "
     << "[" << topic << "]" << std::endl;
 
-  transport::Node node;
-  this->dataPtr->pub = node.Advertise<msgs::Double>(topic);
+  link.pub = this->node.Advertise<msgs::Double>(topic);
 
-  if (!_ecm.Component<components::WorldPose>(this->dataPtr->linkEntity))
+  if (!_ecm.Component<components::WorldPose>(link.linkEntity))
   {
-    _ecm.CreateComponent(this->dataPtr->linkEntity,
-        components::WorldPose());
+    _ecm.CreateComponent(link.linkEntity, components::WorldPose());
   }
 
-  if (!_ecm.Component<components::Inertial>(this->dataPtr->linkEntity))
+  if (!_ecm.Component<components::Inertial>(link.linkEntity))
   {
-    _ecm.CreateComponent(this->dataPtr->linkEntity, components::Inertial());
+    _ecm.CreateComponent(link.linkEntity, components::Inertial());
   }
 
   // Create a world linear velocity component if one is not present.
-  if (!_ecm.Component<components::WorldLinearVelocity>(
-        this->dataPtr->linkEntity))
+  if (!_ecm.Component<components::WorldLinearVelocity>(link.linkEntity))
   {
-    _ecm.CreateComponent(this->dataPtr->linkEntity,
+    _ecm.CreateComponent(link.linkEntity,
         components::WorldLinearVelocity());
   }
 
   // Create an angular velocity component if one is not present.
-  if (!_ecm.Component<components::AngularVelocity>(
-        this->dataPtr->linkEntity))
+  if (!_ecm.Component<components::AngularVelocity>(link.linkEntity))
   {
-    _ecm.CreateComponent(this->dataPtr->linkEntity,
-        components::AngularVelocity());
+    _ecm.CreateComponent(link.linkEntity, components::AngularVelocity());
   }
 
   // Create an angular velocity component if one is not present.
-  if (!_ecm.Component<components::WorldAngularVelocity>(
-        this->dataPtr->linkEntity))
+  if (!_ecm.Component<components::WorldAngularVelocity>(link.linkEntity))
   {
-    _ecm.CreateComponent(this->dataPtr->linkEntity,
+    _ecm.CreateComponent(link.linkEntity,
         components::WorldAngularVelocity());
   }
+
+  this->links.push_back(std::move(link));
+  return true;
 }
 
 //////////////////////////////////////////////////
-void KineticEnergyMonitor::PostUpdate(const UpdateInfo &/*_info*/,
+void KineticEnergyMonitor::PostUpdate(const UpdateInfo &_info,
     const EntityComponentManager &_ecm)
 {
-  if (this->dataPtr->linkEntity != kNullEntity)
+  // Throttle updates, the change in energy is then measured over the
+  // update period
+  if (this->dataPtr->updated &&
+      this->dataPtr->updatePeriod > std::chrono::steady_clock::duration(0))
   {
-    Link link(this->dataPtr->linkEntity);
-    if (std::nullopt != link.WorldKineticEnergy(_ecm))
+    auto diff = _info.simTime - this->dataPtr->lastUpdateTime;
+    if (diff > std::chrono::steady_clock::duration::zero() &&
+        diff < this->dataPtr->updatePeriod)
     {
-      double currKineticEnergy = *link.WorldKineticEnergy(_ecm);
+      return;
+    }
+  }
+  this->dataPtr->updated = true;
+  this->dataPtr->lastUpdateTime = _info.simTime;
 
-      // We only care about positive values of this (the links looses energy)
-      double deltaKE = this->dataPtr->prevKineticEnergy - currKineticEnergy;
-      this->dataPtr->prevKineticEnergy = currKineticEnergy;
+  for (auto &monitored : this->dataPtr->links)
+  {
+    Link link(monitored.linkEntity);
+    auto kineticEnergy = link.WorldKineticEnergy(_ecm);
+    if (std::nullopt == kineticEnergy)
+      continue;
 
-      if (deltaKE > this->dataPtr->keThreshold)
-      {
-        ignmsg << this->dataPtr->modelName
-          << " Change in kinetic energy above threshold - deltaKE: "
-          << deltaKE << std::endl;
-        msgs::Double msg;
-        msg.set_data(deltaKE);
-        this->dataPtr->pub.Publish(msg);
-      }
+    double currKineticEnergy = *kineticEnergy;
+
+    // We only care about positive values of this (the links looses energy)
+    double deltaKE = monitored.prevKineticEnergy - currKineticEnergy;
+    monitored.prevKineticEnergy = currKineticEnergy;
+
+    if (deltaKE > this->dataPtr->keThreshold)
+    {
+      ignmsg << monitored.modelName
+        << " Change in kinetic energy above threshold - deltaKE: "
+        << deltaKE << std::endl;
+      msgs::Double msg;
+      msg.set_data(deltaKE);
+      monitored.pub.Publish(msg);
     }
   }
 }
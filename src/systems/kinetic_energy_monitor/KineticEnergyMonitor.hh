@@ -52,6 +52,17 @@ namespace systems
   /// energy surpasses the threshold. This element if optional, and the
   /// default value is `/model/{name_of_model}/kinetic_energy`.
   ///
+  /// `<update_rate>`: Rate, in Hz of sim time, at which the kinetic energy
+  /// is checked. The change is then measured over the update period.
+  /// Defaults to zero, which checks on every iteration.
+  ///
+  /// # Monitoring several models
+  ///
+  /// When attached to a world, the system monitors the link named
+  /// `<link_name>` in each top level model listed in a `<model>` element,
+  /// all in a single pass. Each model publishes on its default topic, and
+  /// `<topic>` is ignored.
+  ///
   /// # Example Usage
   ///
   /** \verbatim
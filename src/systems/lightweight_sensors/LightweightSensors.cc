@@ -0,0 +1,624 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "LightweightSensors.hh"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/WorkerPool.hh>
+#include <ignition/plugin/Register.hh>
+
+#include <sdf/AirPressure.hh>
+#include <sdf/Altimeter.hh>
+#include <sdf/Imu.hh>
+#include <sdf/Magnetometer.hh>
+#include <sdf/Noise.hh>
+#include <sdf/Sensor.hh>
+
+#include <ignition/sensors/AirPressureSensor.hh>
+#include <ignition/sensors/AltimeterSensor.hh>
+#include <ignition/sensors/ImuSensor.hh>
+#include <ignition/sensors/MagnetometerSensor.hh>
+#include <ignition/sensors/SensorFactory.hh>
+
+#include "ignition/gazebo/components/AirPressureSensor.hh"
+#include "ignition/gazebo/components/Altimeter.hh"
+#include "ignition/gazebo/components/AngularVelocity.hh"
+#include "ignition/gazebo/components/Gravity.hh"
+#include "ignition/gazebo/components/Imu.hh"
+#include "ignition/gazebo/components/LinearAcceleration.hh"
+#include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/MagneticField.hh"
+#include "ignition/gazebo/components/Magnetometer.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/Sensor.hh"
+#include "ignition/gazebo/components/World.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/ParallelTasks.hh"
+#include "ignition/gazebo/Util.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/// \brief Number of sensors updated by each parallel task
+static const std::size_t kSensorsPerTask{32};
+
+/// \brief Sensors of one type, stored contiguously so they can be split
+/// into batches.
+template <typename SensorT>
+class SensorGroup
+{
+  /// \brief Add a sensor.
+  /// \param[in] _entity Sensor entity
+  /// \param[in] _sensor Sensor
+  /// \param[in] _noisy True if the sensor samples noise.
+  public: void Add(Entity _entity, std::unique_ptr<SensorT> _sensor,
+      bool _noisy)
+  {
+    this->indices[_entity] = this->entities.size();
+    this->entities.push_back(_entity);
+    this->sensors.push_back(std::move(_sensor));
+    this->noisy.push_back(_noisy);
+  }
+
+  /// \brief Remove a sensor, moving the last one in its place.
+  /// \param[in] _entity Sensor entity
+  /// \return False if there was no sensor for the entity.
+  public: bool Remove(Entity _entity)
+  {
+    auto it = this->indices.find(_entity);
+    if (it == this->indices.end())
+      return false;
+
+    std::size_t index = it->second;
+    this->indices.erase(it);
+
+    std::size_t last = this->entities.size() - 1;
+    if (index != last)
+    {
+      this->entities[index] = this->entities[last];
+      this->sensors[index] = std::move(this->sensors[last]);
+      this->noisy[index] = this->noisy[last];
+      this->indices[this->entities[index]] = index;
+    }
+    this->entities.pop_back();
+    this->sensors.pop_back();
+    this->noisy.pop_back();
+    return true;
+  }
+
+  /// \brief Number of batches the sensors are split into.
+  /// \return Number of batches.
+  public: std::size_t Batches() const
+  {
+    return (this->entities.size() + kSensorsPerTask - 1) / kSensorsPerTask;
+  }
+
+  /// \brief Sensor entities
+  public: std::vector<Entity> entities;
+
+  /// \brief Sensors, in the same order as entities
+  public: std::vector<std::unique_ptr<SensorT>> sensors;
+
+  /// \brief Whether each sensor samples noise, in the same order as entities
+  public: std::vector<bool> noisy;
+
+  /// \brief Index of each entity's sensor
+  private: std::unordered_map<Entity, std::size_t> indices;
+};
+
+/// \brief Private LightweightSensors data class.
+class ignition::gazebo::systems::LightweightSensorsPrivate
+{
+  /// \brief Create sensors for new sensor entities
+  /// \param[in] _ecm Mutable reference to ECM.
+  public: void CreateSensors(EntityComponentManager &_ecm);
+
+  /// \brief Create a sensor, with the name, topic and parent used by the
+  /// single sensor systems.
+  /// \param[in] _ecm Mutable reference to ECM.
+  /// \param[in] _entity Sensor entity
+  /// \param[in] _sdf Sensor description
+  /// \param[in] _parent Parent entity of the sensor
+  /// \param[in] _topicSuffix Suffix of the default topic
+  /// \return The sensor, or nullptr if it couldn't be created.
+  public: template <typename SensorT>
+          std::unique_ptr<SensorT> CreateSensor(EntityComponentManager &_ecm,
+              Entity _entity, sdf::Sensor _sdf, Entity _parent,
+              const std::string &_topicSuffix);
+
+  /// \brief Update the sensors of a batch
+  /// \param[in] _group Sensors
+  /// \param[in] _batch Index of the batch
+  /// \param[in] _ecm Immutable reference to ECM.
+  /// \param[in] _time Simulation time
+  public: template <typename SensorT>
+          void UpdateBatch(SensorGroup<SensorT> &_group, std::size_t _batch,
+              const EntityComponentManager &_ecm,
+              const std::chrono::steady_clock::duration &_time);
+
+  /// \brief Update the sensors which sample noise, which were skipped by
+  /// UpdateBatch.
+  /// \param[in] _group Sensors
+  /// \param[in] _time Simulation time
+  public: template <typename SensorT>
+          void UpdateNoisy(SensorGroup<SensorT> &_group,
+              const std::chrono::steady_clock::duration &_time);
+
+  /// \brief Remove sensors if their entities have been removed from
+  /// simulation.
+  /// \param[in] _ecm Immutable reference to ECM.
+  public: void RemoveSensors(const EntityComponentManager &_ecm);
+
+  /// \brief IMU sensors
+  public: SensorGroup<sensors::ImuSensor> imus;
+
+  /// \brief Altimeter sensors
+  public: SensorGroup<sensors::AltimeterSensor> altimeters;
+
+  /// \brief Magnetometer sensors
+  public: SensorGroup<sensors::MagnetometerSensor> magnetometers;
+
+  /// \brief Air pressure sensors
+  public: SensorGroup<sensors::AirPressureSensor> airPressures;
+
+  /// \brief Ign-sensors sensor factory for creating sensors
+  public: sensors::SensorFactory sensorFactory;
+
+  /// \brief World entity
+  public: Entity worldEntity{kNullEntity};
+
+  /// \brief Maximum number of threads updating sensors, zero for one per
+  /// hardware core.
+  public: unsigned int threads{0};
+
+  /// \brief Pool of threads updating sensors, created on first use.
+  public: std::unique_ptr<common::WorkerPool> pool;
+};
+
+//////////////////////////////////////////////////
+/// \brief Set the data of an IMU from the ECM.
+/// \param[in] _sensor Sensor
+/// \param[in] _entity Sensor entity
+/// \param[in] _ecm Immutable reference to ECM.
+static void setSensorData(sensors::ImuSensor &_sensor, Entity _entity,
+    const EntityComponentManager &_ecm)
+{
+  auto worldPose = _ecm.Component<components::WorldPose>(_entity);
+  if (worldPose)
+    _sensor.SetWorldPose(worldPose->Data());
+
+  // Angular velocity and linear acceleration are in the imu's local frame
+  auto angularVel = _ecm.Component<components::AngularVelocity>(_entity);
+  if (angularVel)
+    _sensor.SetAngularVelocity(angularVel->Data());
+
+  auto linearAccel = _ecm.Component<components::LinearAcceleration>(_entity);
+  if (linearAccel)
+    _sensor.SetLinearAcceleration(linearAccel->Data());
+}
+
+//////////////////////////////////////////////////
+/// \brief Set the data of an altimeter from the ECM.
+/// \param[in] _sensor Sensor
+/// \param[in] _entity Sensor entity
+/// \param[in] _ecm Immutable reference to ECM.
+static void setSensorData(sensors::AltimeterSensor &_sensor, Entity _entity,
+    const EntityComponentManager &_ecm)
+{
+  auto worldPose = _ecm.Component<components::WorldPose>(_entity);
+  if (worldPose)
+    _sensor.SetPosition(worldPose->Data().Pos().Z());
+
+  auto linearVel = _ecm.Component<components::WorldLinearVelocity>(_entity);
+  if (linearVel)
+    _sensor.SetVerticalVelocity(linearVel->Data().Z());
+}
+
+//////////////////////////////////////////////////
+/// \brief Set the data of a magnetometer from the ECM.
+/// \param[in] _sensor Sensor
+/// \param[in] _entity Sensor entity
+/// \param[in] _ecm Immutable reference to ECM.
+static void setSensorData(sensors::MagnetometerSensor &_sensor,
+    Entity _entity, const EntityComponentManager &_ecm)
+{
+  auto worldPose = _ecm.Component<components::WorldPose>(_entity);
+  if (worldPose)
+    _sensor.SetWorldPose(worldPose->Data());
+}
+
+//////////////////////////////////////////////////
+/// \brief Set the data of an air pressure sensor from the ECM.
+/// \param[in] _sensor Sensor
+/// \param[in] _entity Sensor entity
+/// \param[in] _ecm Immutable reference to ECM.
+static void setSensorData(sensors::AirPressureSensor &_sensor,
+    Entity _entity, const EntityComponentManager &_ecm)
+{
+  auto worldPose = _ecm.Component<components::WorldPose>(_entity);
+  if (worldPose)
+    _sensor.SetPose(worldPose->Data());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check whether a noise model samples random values.
+/// \param[in] _noise Noise
+/// \return True if it does.
+static bool isNoisy(const sdf::Noise &_noise)
+{
+  return _noise.Type() != sdf::NoiseType::NONE;
+}
+
+//////////////////////////////////////////////////
+LightweightSensors::LightweightSensors()
+    : System(), dataPtr(std::make_unique<LightweightSensorsPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+LightweightSensors::~LightweightSensors() = default;
+
+//////////////////////////////////////////////////
+void LightweightSensors::Configure(const Entity &/*_entity*/,
+    const std::shared_ptr<const sdf::Element> &_sdf,
+    EntityComponentManager &/*_ecm*/,
+    EventManager &/*_eventMgr*/)
+{
+  int threads = _sdf->Get<int>("threads", 0).first;
+  if (threads < 0)
+  {
+    ignwarn << "Parameter <threads> can't be negative, using one thread per "
+            << "hardware core." << std::endl;
+    threads = 0;
+  }
+  this->dataPtr->threads = static_cast<unsigned int>(threads);
+}
+
+//////////////////////////////////////////////////
+void LightweightSensors::PreUpdate(const UpdateInfo &/*_info*/,
+    EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("LightweightSensors::PreUpdate");
+  this->dataPtr->CreateSensors(_ecm);
+}
+
+//////////////////////////////////////////////////
+void LightweightSensors::PostUpdate(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("LightweightSensors::PostUpdate");
+
+  // \TODO(anyone) Support rewind
+  if (_info.dt < std::chrono::steady_clock::duration::zero())
+  {
+    ignwarn << "Detected jump back in time ["
+        << std::chrono::duration_cast<std::chrono::seconds>(_info.dt).count()
+        << "s]. System may not work properly." << std::endl;
+  }
+
+  // Only update and publish if not paused.
+  if (!_info.paused)
+  {
+    auto &imus = this->dataPtr->imus;
+    auto &altimeters = this->dataPtr->altimeters;
+    auto &magnetometers = this->dataPtr->magnetometers;
+    auto &airPressures = this->dataPtr->airPressures;
+
+    // Batches of all sensor types, one after the other
+    std::size_t imuEnd = imus.Batches();
+    std::size_t altimeterEnd = imuEnd + altimeters.Batches();
+    std::size_t magnetometerEnd = altimeterEnd + magnetometers.Batches();
+    std::size_t batches = magnetometerEnd + airPressures.Batches();
+
+    if (batches > 1 && !this->dataPtr->pool && this->dataPtr->threads != 1)
+      this->dataPtr->pool = std::make_unique<common::WorkerPool>();
+
+    {
+      IGN_PROFILE("LightweightSensors::UpdateBatches");
+      RunParallelTasks(this->dataPtr->pool.get(), this->dataPtr->threads,
+          batches, [&](std::size_t _index)
+          {
+            if (_index < imuEnd)
+            {
+              this->dataPtr->UpdateBatch(imus, _index, _ecm, _info.simTime);
+            }
+            else if (_index < altimeterEnd)
+            {
+              this->dataPtr->UpdateBatch(altimeters, _index - imuEnd, _ecm,
+                  _info.simTime);
+            }
+            else if (_index < magnetometerEnd)
+            {
+              this->dataPtr->UpdateBatch(magnetometers,
+                  _index - altimeterEnd, _ecm, _info.simTime);
+            }
+            else
+            {
+              this->dataPtr->UpdateBatch(airPressures,
+                  _index - magnetometerEnd, _ecm, _info.simTime);
+            }
+          });
+    }
+
+    {
+      IGN_PROFILE("LightweightSensors::UpdateNoisy");
+      this->dataPtr->UpdateNoisy(imus, _info.simTime);
+      this->dataPtr->UpdateNoisy(altimeters, _info.simTime);
+      this->dataPtr->UpdateNoisy(magnetometers, _info.simTime);
+      this->dataPtr->UpdateNoisy(airPressures, _info.simTime);
+    }
+  }
+
+  this->dataPtr->RemoveSensors(_ecm);
+}
+
+//////////////////////////////////////////////////
+template <typename SensorT>
+std::unique_ptr<SensorT> LightweightSensorsPrivate::CreateSensor(
+    EntityComponentManager &_ecm, Entity _entity, sdf::Sensor _sdf,
+    Entity _parent, const std::string &_topicSuffix)
+{
+  std::string sensorScopedName =
+      removeParentScope(scopedName(_entity, _ecm, "::", false), "::");
+  _sdf.SetName(sensorScopedName);
+  // check topic
+  if (_sdf.Topic().empty())
+  {
+    std::string topic = scopedName(_entity, _ecm) + "/" + _topicSuffix;
+    _sdf.SetTopic(topic);
+  }
+  std::unique_ptr<SensorT> sensor =
+      this->sensorFactory.CreateSensor<SensorT>(_sdf);
+  if (nullptr == sensor)
+  {
+    ignerr << "Failed to create sensor [" << sensorScopedName << "]"
+           << std::endl;
+    return nullptr;
+  }
+
+  // set sensor parent
+  std::string parentName = _ecm.Component<components::Name>(_parent)->Data();
+  sensor->SetParent(parentName);
+
+  // Set topic
+  _ecm.CreateComponent(_entity, components::SensorTopic(sensor->Topic()));
+
+  return sensor;
+}
+
+//////////////////////////////////////////////////
+void LightweightSensorsPrivate::CreateSensors(EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("LightweightSensorsPrivate::CreateSensors");
+  if (kNullEntity == this->worldEntity)
+    this->worldEntity = _ecm.EntityByComponents(components::World());
+  if (kNullEntity == this->worldEntity)
+  {
+    ignerr << "Missing world entity." << std::endl;
+    return;
+  }
+
+  // Create IMUs
+  _ecm.EachNew<components::Imu, components::ParentEntity>(
+    [&](const Entity &_entity,
+        const components::Imu *_imu,
+        const components::ParentEntity *_parent)->bool
+      {
+        // Get the world acceleration (defined in world frame)
+        auto gravity = _ecm.Component<components::Gravity>(this->worldEntity);
+        if (nullptr == gravity)
+        {
+          ignerr << "World missing gravity." << std::endl;
+          return true;
+        }
+
+        auto sensor = this->CreateSensor<sensors::ImuSensor>(_ecm, _entity,
+            _imu->Data(), _parent->Data(), "imu");
+        if (nullptr == sensor)
+          return true;
+
+        // set gravity - assume it remains fixed
+        sensor->SetGravity(gravity->Data());
+
+        // The WorldPose component was just created and so it's empty
+        // We'll compute the world pose manually here
+        sensor->SetOrientationReference(worldPose(_entity, _ecm).Rot());
+
+        bool noisy{false};
+        if (auto imu = _imu->Data().ImuSensor())
+        {
+          noisy = isNoisy(imu->LinearAccelerationXNoise()) ||
+              isNoisy(imu->LinearAccelerationYNoise()) ||
+              isNoisy(imu->LinearAccelerationZNoise()) ||
+              isNoisy(imu->AngularVelocityXNoise()) ||
+              isNoisy(imu->AngularVelocityYNoise()) ||
+              isNoisy(imu->AngularVelocityZNoise());
+        }
+        this->imus.Add(_entity, std::move(sensor), noisy);
+        return true;
+      });
+
+  // Create altimeters
+  _ecm.EachNew<components::Altimeter, components::ParentEntity>(
+    [&](const Entity &_entity,
+        const components::Altimeter *_altimeter,
+        const components::ParentEntity *_parent)->bool
+      {
+        auto sensor = this->CreateSensor<sensors::AltimeterSensor>(_ecm,
+            _entity, _altimeter->Data(), _parent->Data(), "altimeter");
+        if (nullptr == sensor)
+          return true;
+
+        // Get initial pose of sensor and set the reference z pos
+        double verticalReference = worldPose(_entity, _ecm).Pos().Z();
+        sensor->SetVerticalReference(verticalReference);
+        sensor->SetPosition(verticalReference);
+
+        bool noisy{false};
+        if (auto altimeter = _altimeter->Data().AltimeterSensor())
+        {
+          noisy = isNoisy(altimeter->VerticalPositionNoise()) ||
+              isNoisy(altimeter->VerticalVelocityNoise());
+        }
+        this->altimeters.Add(_entity, std::move(sensor), noisy);
+        return true;
+      });
+
+  // Create magnetometers
+  _ecm.EachNew<components::Magnetometer, components::ParentEntity>(
+    [&](const Entity &_entity,
+        const components::Magnetometer *_magnetometer,
+        const components::ParentEntity *_parent)->bool
+      {
+        // Get the world magnetic field (defined in world frame)
+        auto worldField =
+            _ecm.Component<components::MagneticField>(this->worldEntity);
+        if (nullptr == worldField)
+        {
+          ignerr << "World missing magnetic field." << std::endl;
+          return true;
+        }
+
+        auto sensor = this->CreateSensor<sensors::MagnetometerSensor>(_ecm,
+            _entity, _magnetometer->Data(), _parent->Data(), "magnetometer");
+        if (nullptr == sensor)
+          return true;
+
+        // set world magnetic field. Assume uniform in world and does not
+        // change throughout simulation
+        sensor->SetWorldMagneticField(worldField->Data());
+        sensor->SetWorldPose(worldPose(_entity, _ecm));
+
+        bool noisy{false};
+        if (auto magnetometer = _magnetometer->Data().MagnetometerSensor())
+        {
+          noisy = isNoisy(magnetometer->XNoise()) ||
+              isNoisy(magnetometer->YNoise()) ||
+              isNoisy(magnetometer->ZNoise());
+        }
+        this->magnetometers.Add(_entity, std::move(sensor), noisy);
+        return true;
+      });
+
+  // Create air pressure sensors
+  _ecm.EachNew<components::AirPressureSensor, components::ParentEntity>(
+    [&](const Entity &_entity,
+        const components::AirPressureSensor *_airPressure,
+        const components::ParentEntity *_parent)->bool
+      {
+        auto sensor = this->CreateSensor<sensors::AirPressureSensor>(_ecm,
+            _entity, _airPressure->Data(), _parent->Data(), "air_pressure");
+        if (nullptr == sensor)
+          return true;
+
+        sensor->SetPose(worldPose(_entity, _ecm));
+
+        bool noisy{false};
+        if (auto airPressure = _airPressure->Data().AirPressureSensor())
+          noisy = isNoisy(airPressure->PressureNoise());
+        this->airPressures.Add(_entity, std::move(sensor), noisy);
+        return true;
+      });
+}
+
+//////////////////////////////////////////////////
+template <typename SensorT>
+void LightweightSensorsPrivate::UpdateBatch(SensorGroup<SensorT> &_group,
+    std::size_t _batch, const EntityComponentManager &_ecm,
+    const std::chrono::steady_clock::duration &_time)
+{
+  std::size_t begin = _batch * kSensorsPerTask;
+  std::size_t end = std::min(begin + kSensorsPerTask, _group.entities.size());
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    setSensorData(*_group.sensors[i], _group.entities[i], _ecm);
+
+    // Noisy sensors are updated later on the calling thread
+    if (!_group.noisy[i])
+    {
+      static_cast<sensors::Sensor *>(_group.sensors[i].get())->Update(
+          _time, false);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+template <typename SensorT>
+void LightweightSensorsPrivate::UpdateNoisy(SensorGroup<SensorT> &_group,
+    const std::chrono::steady_clock::duration &_time)
+{
+  for (std::size_t i = 0; i < _group.entities.size(); ++i)
+  {
+    if (_group.noisy[i])
+    {
+      static_cast<sensors::Sensor *>(_group.sensors[i].get())->Update(
+          _time, false);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void LightweightSensorsPrivate::RemoveSensors(
+    const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("LightweightSensorsPrivate::RemoveSensors");
+  _ecm.EachRemoved<components::Imu>(
+    [&](const Entity &_entity, const components::Imu *)->bool
+      {
+        this->imus.Remove(_entity);
+        return true;
+      });
+
+  _ecm.EachRemoved<components::Altimeter>(
+    [&](const Entity &_entity, const components::Altimeter *)->bool
+      {
+        this->altimeters.Remove(_entity);
+        return true;
+      });
+
+  _ecm.EachRemoved<components::Magnetometer>(
+    [&](const Entity &_entity, const components::Magnetometer *)->bool
+      {
+        this->magnetometers.Remove(_entity);
+        return true;
+      });
+
+  _ecm.EachRemoved<components::AirPressureSensor>(
+    [&](const Entity &_entity, const components::AirPressureSensor *)->bool
+      {
+        this->airPressures.Remove(_entity);
+        return true;
+      });
+}
+
+IGNITION_ADD_PLUGIN(LightweightSensors, System,
+  LightweightSensors::ISystemConfigure,
+  LightweightSensors::ISystemPreUpdate,
+  LightweightSensors::ISystemPostUpdate
+)
+
+IGNITION_ADD_PLUGIN_ALIAS(LightweightSensors,
+                          "ignition::gazebo::systems::LightweightSensors")
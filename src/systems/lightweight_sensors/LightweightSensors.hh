@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GAZEBO_SYSTEMS_LIGHTWEIGHTSENSORS_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LIGHTWEIGHTSENSORS_HH_
+
+#include <memory>
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/System.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  // Forward declarations.
+  class LightweightSensorsPrivate;
+
+  /// \class LightweightSensors LightweightSensors.hh
+  /// ignition/gazebo/systems/LightweightSensors.hh
+  /// \brief This system manages all IMU, altimeter, magnetometer and air
+  /// pressure sensors in simulation, which don't need rendering. It replaces
+  /// the Imu, Altimeter, Magnetometer and AirPressure systems, and shouldn't
+  /// be loaded together with them.
+  ///
+  /// All sensors are updated in a single pass, split into batches which run
+  /// on worker threads. Sensors with noise are updated on the simulation
+  /// thread after the batches, because noise is sampled from a random
+  /// generator shared by all sensors.
+  ///
+  /// ## System Parameters
+  ///
+  /// `<threads>`: Maximum number of threads updating sensors at the same
+  /// time, including the simulation thread. Optional, zero by default, which
+  /// uses one thread per hardware core. Set to 1 to update all sensors on
+  /// the simulation thread.
+  class LightweightSensors:
+    public System,
+    public ISystemConfigure,
+    public ISystemPreUpdate,
+    public ISystemPostUpdate
+  {
+    /// \brief Constructor
+    public: explicit LightweightSensors();
+
+    /// \brief Destructor
+    public: ~LightweightSensors() override;
+
+    // Documentation inherited
+    public: void Configure(const Entity &_entity,
+                           const std::shared_ptr<const sdf::Element> &_sdf,
+                           EntityComponentManager &_ecm,
+                           EventManager &_eventMgr) final;
+
+    /// Documentation inherited
+    public: void PreUpdate(const UpdateInfo &_info,
+                           EntityComponentManager &_ecm) final;
+
+    /// Documentation inherited
+    public: void PostUpdate(const UpdateInfo &_info,
+                            const EntityComponentManager &_ecm) final;
+
+    /// \brief Private data pointer.
+    private: std::unique_ptr<LightweightSensorsPrivate> dataPtr;
+  };
+  }
+}
+}
+}
+#endif
@@ -19,20 +19,32 @@
 
 #include <ignition/msgs/pose_v.pb.h>
 #include <ignition/msgs/log_playback_stats.pb.h>
+#include <ignition/msgs/stringmsg.pb.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <ignition/common/Filesystem.hh>
 #include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
 #include <ignition/fuel_tools/Zip.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/msgs/Utility.hh>
 #include <ignition/plugin/RegisterMore.hh>
+#include <ignition/transport/log/Descriptor.hh>
+#include <ignition/transport/log/QualifiedTime.hh>
 #include <ignition/transport/log/QueryOptions.hh>
 #include <ignition/transport/log/Log.hh>
 #include <ignition/transport/log/Message.hh>
+#include <ignition/transport/Node.hh>
 
 #include <sdf/Geometry.hh>
 #include <sdf/Mesh.hh>
@@ -40,17 +52,50 @@
 
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/Events.hh"
+#include "ignition/gazebo/LogIndex.hh"
 #include "ignition/gazebo/SdfEntityCreator.hh"
+#include "ignition/gazebo/StateDelta.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/LogPlaybackStatistics.hh"
 #include "ignition/gazebo/components/Material.hh"
+#include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "StateCompression.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+/// \brief Forward jumps longer than this look for a keyframe to seek to,
+/// instead of replaying every change in between.
+static const std::chrono::steady_clock::duration kKeyframeSeekThreshold{
+    std::chrono::seconds(1)};
+
+/// \brief A recorded message, decompressed and ready to be played.
+struct PlaybackMessage
+{
+  /// \brief Time the message was recorded at.
+  std::chrono::steady_clock::duration time;
+
+  /// \brief Message type.
+  std::string type;
+
+  /// \brief Serialized message.
+  std::string data;
+};
+
+/// \brief Messages recorded within a time range.
+struct PrefetchedChunk
+{
+  /// \brief End of the time range, inclusive.
+  std::chrono::steady_clock::duration end;
+
+  /// \brief Messages in the range, in recording order.
+  std::vector<PlaybackMessage> messages;
+};
+
 /// \brief Private LogPlayback data class.
 class ignition::gazebo::systems::LogPlaybackPrivate
 {
@@ -87,11 +132,13 @@ class ignition::gazebo::systems::LogPlaybackPrivate
   public: void Parse(EntityComponentManager &_ecm,
       const msgs::SerializedState &_msg);
 
-  /// \brief Updates the ECM according to the given message.
+  /// \brief Updates the ECM according to the given message, after
+  /// restoring any delta encoded components.
   /// \param[in] _ecm Mutable ECM.
-  /// \param[in] _msg Message containing state updates.
+  /// \param[in] _msg Message containing state updates, which is decoded in
+  /// place.
   public: void Parse(EntityComponentManager &_ecm,
-      const msgs::SerializedStateMap &_msg);
+      msgs::SerializedStateMap &_msg);
 
   /// \brief A batch of data from log file, of all pose messages
   public: transport::log::Batch batch;
@@ -122,8 +169,155 @@ class ignition::gazebo::systems::LogPlaybackPrivate
   public: bool doReplaceResourceURIs{true};
 
   /// \brief Saves which entity poses have changed according to the latest
-  /// LogPlaybackPrivate::Parse call.
-  public: std::unordered_map<Entity, msgs::Pose> recentEntityPoseUpdates;
+  /// LogPlaybackPrivate::Parse call. Poses are converted once, when parsed,
+  /// and set straight into the Pose components of these entities.
+  public: std::unordered_map<Entity, math::Pose3d> recentEntityPoseUpdates;
+
+  /// \brief Get the type and data of a recorded message, decompressing it
+  /// if it was recorded compressed.
+  /// \param[in] _msg Recorded message.
+  /// \param[out] _type Message type, without the compression suffix.
+  /// \param[out] _buffer Holds the decompressed data, if compressed.
+  /// \return Reference to the message data, which is empty if it failed to
+  /// be decompressed.
+  public: static const std::string &MessageData(
+      const transport::log::Message &_msg, std::string &_type,
+      std::string &_buffer);
+
+  /// \brief Topic holding full state keyframes, empty if the log has none.
+  public: std::string keyframeTopic;
+
+  /// \brief Restores components which LogRecord delta encoded. It's reset
+  /// whenever playback jumps.
+  public: StateDeltaDecoder stateDecoder;
+
+  /// \brief Latest keyframe set by SeekKeyframe and the time it was
+  /// recorded at. Playing backward rebuilds every step from the same
+  /// keyframe, so it's only read and parsed once.
+  public: std::optional<std::pair<std::chrono::steady_clock::duration,
+      msgs::SerializedStateMap>> cachedKeyframe;
+
+  /// \brief Whether the cost of stepping backward without keyframes was
+  /// reported.
+  public: bool warnedNoKeyframes{false};
+
+  /// \brief Set the ECM to the latest keyframe recorded within a time range.
+  /// \param[in] _ecm Mutable ECM.
+  /// \param[in] _start Start of the time range.
+  /// \param[in] _end End of the time range.
+  /// \param[out] _time Time at which the keyframe was recorded.
+  /// \param[out] _entitiesToRemove Entities which are in the ECM but not in
+  /// the keyframe.
+  /// \return True if a keyframe was found and set.
+  public: bool SeekKeyframe(EntityComponentManager &_ecm,
+      const std::chrono::steady_clock::duration &_start,
+      const std::chrono::steady_clock::duration &_end,
+      std::chrono::steady_clock::duration &_time,
+      std::set<Entity> &_entitiesToRemove);
+
+  /// \brief Get the messages to play within a time range from the log,
+  /// skipping keyframes.
+  /// \param[in] _log Log to query.
+  /// \param[in] _range Time range.
+  /// \param[out] _messages Messages are appended here.
+  public: void ReadMessages(transport::log::Log &_log,
+      const transport::log::QualifiedTimeRange &_range,
+      std::vector<PlaybackMessage> &_messages) const;
+
+  /// \brief Prefetch thread, reads the chunks after the playhead.
+  /// \param[in] _dbPath Path to the log file.
+  public: void PrefetchLoop(const std::string &_dbPath);
+
+  /// \brief Drop all prefetched chunks and prefetch from the given time.
+  /// \param[in] _time Messages after this time are prefetched.
+  public: void ResetPrefetch(const std::chrono::steady_clock::duration &_time);
+
+  /// \brief Get the prefetched messages recorded after the last call and up
+  /// to a time, waiting for the prefetch thread if needed.
+  /// \param[in] _start Start of the step, which must be where the last call
+  /// or ResetPrefetch left off.
+  /// \param[in] _end End of the step, inclusive.
+  /// \param[out] _messages Messages are appended here.
+  /// \return False if the step doesn't continue from where the prefetching
+  /// is, or prefetching stopped.
+  public: bool TakePrefetched(const std::chrono::steady_clock::duration &_start,
+      const std::chrono::steady_clock::duration &_end,
+      std::vector<PlaybackMessage> &_messages);
+
+  /// \brief Stop the prefetch thread.
+  public: void StopPrefetch();
+
+  /// \brief True to read the log ahead of the playhead from a thread.
+  public: bool prefetch{false};
+
+  /// \brief Sim time covered by each prefetched chunk.
+  public: std::chrono::steady_clock::duration prefetchWindow{
+      std::chrono::seconds(1)};
+
+  /// \brief Maximum number of chunks prefetched ahead of the playhead.
+  public: std::size_t prefetchChunks{4};
+
+  /// \brief Prefetched chunks, oldest first.
+  public: std::deque<PrefetchedChunk> prefetched;
+
+  /// \brief End of the last prefetched chunk, where the next one starts.
+  public: std::chrono::steady_clock::duration prefetchTime{0};
+
+  /// \brief Time up to which prefetched messages have been played. Empty
+  /// until the first ResetPrefetch.
+  public: std::optional<std::chrono::steady_clock::duration> playedTime;
+
+  /// \brief Incremented on every reset, so chunks read before a reset are
+  /// dropped.
+  public: uint64_t prefetchGeneration{0};
+
+  /// \brief Protects the prefetch state above.
+  public: std::mutex prefetchMutex;
+
+  /// \brief Notifies about new chunks, resets and stopping.
+  public: std::condition_variable prefetchCv;
+
+  /// \brief True to stop the prefetch thread.
+  public: bool stopPrefetch{false};
+
+  /// \brief Thread prefetching chunks.
+  public: std::thread prefetchThread;
+
+  /// \brief Find an up to date timeline index of the log, or build one,
+  /// and make it available to SeekKeyframe and the timeline service.
+  /// \param[in] _dbPath Path to the log file.
+  /// \param[in] _startTime Start time of the log.
+  /// \param[in] _endTime End time of the log.
+  public: void LoadIndex(const std::string &_dbPath,
+      const std::chrono::steady_clock::duration &_startTime,
+      const std::chrono::steady_clock::duration &_endTime);
+
+  /// \brief Service providing the path of the timeline index.
+  /// \param[out] _res Path of the index file.
+  /// \return False while the index isn't ready.
+  public: bool OnTimelineIndex(msgs::StringMsg &_res);
+
+  /// \brief True to provide a timeline index of the log.
+  public: bool timelineIndex{true};
+
+  /// \brief Duration of each bucket of the timeline index.
+  public: std::chrono::steady_clock::duration timelineBucket{
+      std::chrono::milliseconds(100)};
+
+  /// \brief Timeline index, null until it's loaded.
+  public: std::shared_ptr<LogIndex> index;
+
+  /// \brief Path of the timeline index, empty until it's loaded.
+  public: std::string indexPath;
+
+  /// \brief Protects the index and its path.
+  public: std::mutex indexMutex;
+
+  /// \brief Thread loading the index.
+  public: std::thread indexThread;
+
+  /// \brief Node providing the timeline index service.
+  public: transport::Node node;
 };
 
 bool LogPlaybackPrivate::started{false};
@@ -137,6 +331,9 @@ LogPlayback::LogPlayback()
 //////////////////////////////////////////////////
 LogPlayback::~LogPlayback()
 {
+  this->dataPtr->StopPrefetch();
+  if (this->dataPtr->indexThread.joinable())
+    this->dataPtr->indexThread.join();
   if (!this->dataPtr->extDest.empty())
   {
     common::removeAll(this->dataPtr->extDest);
@@ -152,10 +349,12 @@ void LogPlaybackPrivate::Parse(const msgs::Pose_V &_msg, bool &_clear)
     this->recentEntityPoseUpdates.clear();
 
   // save the new entity pose updates
+  this->recentEntityPoseUpdates.reserve(_msg.pose_size());
   for (auto i=0; i < _msg.pose_size(); ++i)
   {
     const auto &pose = _msg.pose(i);
-    this->recentEntityPoseUpdates.insert_or_assign(pose.id(), pose);
+    this->recentEntityPoseUpdates.insert_or_assign(pose.id(),
+        msgs::Convert(pose));
   }
 
   // make sure that any future detected pose updates from the same Update
@@ -165,8 +364,9 @@ void LogPlaybackPrivate::Parse(const msgs::Pose_V &_msg, bool &_clear)
 
 //////////////////////////////////////////////////
 void LogPlaybackPrivate::Parse(EntityComponentManager &_ecm,
-    const msgs::SerializedStateMap &_msg)
+    msgs::SerializedStateMap &_msg)
 {
+  this->stateDecoder.Decode(_msg);
   _ecm.SetState(_msg);
 }
 
@@ -177,6 +377,342 @@ void LogPlaybackPrivate::Parse(EntityComponentManager &_ecm,
   _ecm.SetState(_msg);
 }
 
+//////////////////////////////////////////////////
+const std::string &LogPlaybackPrivate::MessageData(
+    const transport::log::Message &_msg, std::string &_type,
+    std::string &_buffer)
+{
+  _type = _msg.Type();
+  if (!log_system::IsCompressedType(_type))
+    return _msg.Data();
+
+  _type.resize(_type.size() - log_system::kCompressedTypeSuffix.size());
+  if (!log_system::DecompressData(_msg.Data(), _buffer))
+  {
+    ignerr << "Failed to decompress message of type [" << _type
+           << "] on [" << _msg.Topic() << "]" << std::endl;
+    _buffer.clear();
+  }
+  return _buffer;
+}
+
+//////////////////////////////////////////////////
+bool LogPlaybackPrivate::SeekKeyframe(EntityComponentManager &_ecm,
+    const std::chrono::steady_clock::duration &_start,
+    const std::chrono::steady_clock::duration &_end,
+    std::chrono::steady_clock::duration &_time,
+    std::set<Entity> &_entitiesToRemove)
+{
+  if (this->keyframeTopic.empty() || _end < _start)
+    return false;
+
+  IGN_PROFILE("LogPlaybackPrivate::SeekKeyframe");
+
+  std::string keyframeData;
+  std::string keyframeType;
+  std::string buffer;
+  bool found{false};
+
+  // The timeline index knows the keyframe times, so only that keyframe is
+  // read from the log
+  std::shared_ptr<LogIndex> logIndex;
+  {
+    std::lock_guard<std::mutex> lock(this->indexMutex);
+    logIndex = this->index;
+  }
+  bool searchLog{true};
+  if (logIndex)
+  {
+    auto keyframeTime = logIndex->KeyframeBefore(_end);
+    if (!keyframeTime || *keyframeTime < _start)
+      return false;
+
+    if (this->cachedKeyframe && this->cachedKeyframe->first == *keyframeTime)
+    {
+      _time = *keyframeTime;
+      found = true;
+    }
+    else
+    {
+      for (const auto &msg : this->log->QueryMessages(
+          transport::log::TopicList(this->keyframeTopic,
+          {*keyframeTime, *keyframeTime})))
+      {
+        keyframeData = MessageData(msg, keyframeType, buffer);
+        _time = msg.TimeReceived();
+        found = true;
+      }
+    }
+    searchLog = !found;
+  }
+
+  // Otherwise search backwards from the end in growing windows, so only the
+  // few keyframes closest to the end are read from the log
+  std::chrono::steady_clock::duration window = std::chrono::seconds(1);
+  auto windowEnd = _end;
+  while (searchLog && !found)
+  {
+    auto windowStart = windowEnd - window > _start ?
+        windowEnd - window : _start;
+    auto keyframes = this->log->QueryMessages(transport::log::TopicList(
+        this->keyframeTopic, {windowStart, windowEnd}));
+    for (const auto &msg : keyframes)
+    {
+      keyframeData = MessageData(msg, keyframeType, buffer);
+      _time = msg.TimeReceived();
+      found = true;
+    }
+
+    if (windowStart == _start)
+      break;
+    windowEnd = windowStart;
+    window *= 2;
+  }
+
+  if (!found)
+    return false;
+
+  if (!this->cachedKeyframe || this->cachedKeyframe->first != _time)
+  {
+    msgs::SerializedStateMap parsed;
+    if (!parsed.ParseFromString(keyframeData))
+    {
+      ignerr << "Failed to parse keyframe recorded at ["
+             << std::chrono::duration<double>(_time).count() << "]s"
+             << std::endl;
+      return false;
+    }
+    this->cachedKeyframe.emplace(_time, std::move(parsed));
+  }
+
+  // Decoding modifies the message, so the cached keyframe is copied
+  auto msg = this->cachedKeyframe->second;
+
+  // The keyframe holds all entities, anything else doesn't exist yet or
+  // anymore at that time
+  _entitiesToRemove.clear();
+  for (const auto &vertex : _ecm.Entities().Vertices())
+  {
+    Entity entity{vertex.first};
+    if (msg.entities().find(entity) == msg.entities().end())
+      _entitiesToRemove.insert(entity);
+  }
+
+  // Deltas recorded after the keyframe are based on its values
+  this->stateDecoder.Reset();
+  this->Parse(_ecm, msg);
+  this->ReplaceResourceURIs(_ecm);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::LoadIndex(const std::string &_dbPath,
+    const std::chrono::steady_clock::duration &_startTime,
+    const std::chrono::steady_clock::duration &_endTime)
+{
+  IGN_PROFILE_THREAD_NAME("LogPlayback index");
+
+  // Next to the log, or in the home directory if the log's directory isn't
+  // writable
+  std::string homePath;
+  common::env(IGN_HOMEDIR, homePath);
+  const std::vector<std::string> candidates{
+      common::joinPaths(this->logPath, "timeline.idx"),
+      common::joinPaths(homePath, ".ignition", "gazebo", "log_index",
+          common::sha1(_dbPath) + ".idx")};
+
+  auto logIndex = std::make_shared<LogIndex>();
+  std::string path;
+  for (const auto &candidate : candidates)
+  {
+    if (logIndex->Open(candidate) && logIndex->StartTime() == _startTime &&
+        logIndex->EndTime() == _endTime)
+    {
+      path = candidate;
+      break;
+    }
+  }
+
+  for (std::size_t i = 0; path.empty() && i < candidates.size(); ++i)
+  {
+    common::createDirectories(common::parentPath(candidates[i]));
+    if (LogIndex::Build(_dbPath, candidates[i], this->timelineBucket) &&
+        logIndex->Open(candidates[i]))
+    {
+      path = candidates[i];
+    }
+  }
+
+  if (path.empty())
+  {
+    ignwarn << "Failed to build a timeline index of [" << _dbPath << "]"
+            << std::endl;
+    return;
+  }
+
+  igndbg << "Loaded timeline index [" << path << "]" << std::endl;
+  std::lock_guard<std::mutex> lock(this->indexMutex);
+  this->index = logIndex;
+  this->indexPath = path;
+}
+
+//////////////////////////////////////////////////
+bool LogPlaybackPrivate::OnTimelineIndex(msgs::StringMsg &_res)
+{
+  std::lock_guard<std::mutex> lock(this->indexMutex);
+  _res.set_data(this->indexPath);
+  return !this->indexPath.empty();
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::ReadMessages(transport::log::Log &_log,
+    const transport::log::QualifiedTimeRange &_range,
+    std::vector<PlaybackMessage> &_messages) const
+{
+  std::string buffer;
+  for (const auto &msg : _log.QueryMessages(
+      transport::log::AllTopics(_range)))
+  {
+    // Keyframes are only used to seek
+    if (msg.Topic() == this->keyframeTopic)
+      continue;
+
+    PlaybackMessage playbackMsg;
+    playbackMsg.time = msg.TimeReceived();
+    playbackMsg.data = MessageData(msg, playbackMsg.type, buffer);
+    _messages.push_back(std::move(playbackMsg));
+  }
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::PrefetchLoop(const std::string &_dbPath)
+{
+  // SQLite connections shouldn't be shared between threads
+  transport::log::Log prefetchLog;
+  if (!prefetchLog.Open(_dbPath))
+  {
+    ignerr << "Failed to open log file [" << _dbPath << "] for prefetching"
+           << std::endl;
+    std::lock_guard<std::mutex> lock(this->prefetchMutex);
+    this->stopPrefetch = true;
+    this->prefetchCv.notify_all();
+    return;
+  }
+  const auto logEnd = prefetchLog.EndTime();
+
+  std::unique_lock<std::mutex> lock(this->prefetchMutex);
+  while (true)
+  {
+    this->prefetchCv.wait(lock, [&]
+    {
+      return this->stopPrefetch || (this->playedTime &&
+          this->prefetched.size() < this->prefetchChunks &&
+          this->prefetchTime < logEnd);
+    });
+    if (this->stopPrefetch)
+      break;
+
+    auto generation = this->prefetchGeneration;
+    auto start = this->prefetchTime;
+    PrefetchedChunk chunk;
+    chunk.end = start + this->prefetchWindow;
+
+    // Read without holding the lock, so the simulation thread can keep
+    // taking chunks already prefetched
+    lock.unlock();
+    {
+      IGN_PROFILE("LogPlaybackPrivate::PrefetchLoop Read");
+      this->ReadMessages(prefetchLog, transport::log::QualifiedTimeRange(
+          transport::log::QualifiedTime(start,
+          transport::log::QualifiedTime::Qualifier::EXCLUSIVE),
+          transport::log::QualifiedTime(chunk.end)), chunk.messages);
+    }
+    lock.lock();
+
+    // Drop the chunk if playback jumped while reading it
+    if (generation != this->prefetchGeneration)
+      continue;
+
+    this->prefetchTime = chunk.end;
+    this->prefetched.push_back(std::move(chunk));
+    this->prefetchCv.notify_all();
+  }
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::ResetPrefetch(
+    const std::chrono::steady_clock::duration &_time)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->prefetchMutex);
+    this->prefetched.clear();
+    this->prefetchTime = _time;
+    this->playedTime = _time;
+    ++this->prefetchGeneration;
+  }
+  this->prefetchCv.notify_all();
+}
+
+//////////////////////////////////////////////////
+bool LogPlaybackPrivate::TakePrefetched(
+    const std::chrono::steady_clock::duration &_start,
+    const std::chrono::steady_clock::duration &_end,
+    std::vector<PlaybackMessage> &_messages)
+{
+  IGN_PROFILE("LogPlaybackPrivate::TakePrefetched");
+  std::unique_lock<std::mutex> lock(this->prefetchMutex);
+  if (this->stopPrefetch || !this->playedTime || *this->playedTime != _start)
+    return false;
+
+  const auto logEnd = this->log->EndTime();
+  while (true)
+  {
+    // Wait for the chunk holding the end of the step, unless the log ends
+    // before it
+    this->prefetchCv.wait(lock, [&]
+    {
+      return this->stopPrefetch || !this->prefetched.empty() ||
+          this->prefetchTime >= logEnd;
+    });
+    if (this->stopPrefetch)
+      return false;
+    if (this->prefetched.empty())
+      break;
+
+    auto &chunk = this->prefetched.front();
+    auto msgIt = chunk.messages.begin();
+    while (msgIt != chunk.messages.end() && msgIt->time <= _end)
+    {
+      _messages.push_back(std::move(*msgIt));
+      ++msgIt;
+    }
+    chunk.messages.erase(chunk.messages.begin(), msgIt);
+
+    if (chunk.end > _end)
+      break;
+
+    this->prefetched.pop_front();
+    this->prefetchCv.notify_all();
+  }
+
+  this->playedTime = _end;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::StopPrefetch()
+{
+  if (!this->prefetchThread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(this->prefetchMutex);
+    this->stopPrefetch = true;
+  }
+  this->prefetchCv.notify_all();
+  this->prefetchThread.join();
+}
+
 //////////////////////////////////////////////////
 void LogPlayback::Configure(const Entity &,
     const std::shared_ptr<const sdf::Element> &_sdf,
@@ -185,6 +721,28 @@ void LogPlayback::Configure(const Entity &,
   // Get directory paths from SDF
   this->dataPtr->logPath = _sdf->Get<std::string>("playback_path");
 
+  this->dataPtr->prefetch = _sdf->Get<bool>("prefetch", false).first;
+  auto window = _sdf->Get<double>("prefetch_window", 1.0).first;
+  if (window > 0.0)
+  {
+    this->dataPtr->prefetchWindow = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(window));
+  }
+  auto chunks = _sdf->Get<int>("prefetch_chunks", 4).first;
+  if (chunks > 0)
+    this->dataPtr->prefetchChunks = static_cast<std::size_t>(chunks);
+
+  this->dataPtr->timelineIndex =
+      _sdf->Get<bool>("timeline_index", true).first;
+  auto bucket = _sdf->Get<double>("timeline_bucket", 0.1).first;
+  if (bucket > 0.0)
+  {
+    this->dataPtr->timelineBucket = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(bucket));
+  }
+
   this->dataPtr->eventManager = &_eventMgr;
 
   // Prepend working directory if path is relative
@@ -250,6 +808,21 @@ bool LogPlaybackPrivate::Start(EntityComponentManager &_ecm)
     ignerr << "Failed to open log file [" << dbPath << "]" << std::endl;
   }
 
+  // Find keyframes recorded by LogRecord, if any
+  const std::string keyframeSuffix{"/changed_state_keyframe"};
+  for (const auto &topic : this->log->Descriptor()->TopicsToMsgTypesToId())
+  {
+    if (topic.first.size() > keyframeSuffix.size() &&
+        topic.first.compare(topic.first.size() - keyframeSuffix.size(),
+        keyframeSuffix.size(), keyframeSuffix) == 0)
+    {
+      this->keyframeTopic = topic.first;
+      igndbg << "Seeking with keyframes from [" << topic.first << "]"
+             << std::endl;
+      break;
+    }
+  }
+
   // Access all messages in .tlog file
   this->batch = this->log->QueryMessages();
   auto iter = this->batch.begin();
@@ -261,20 +834,22 @@ bool LogPlaybackPrivate::Start(EntityComponentManager &_ecm)
 
   // Look for the first SerializedState message and use it to set the initial
   // state of the world. Messages received before this are ignored.
+  std::string msgType;
+  std::string buffer;
   for (; iter != this->batch.end(); ++iter)
   {
-    auto msgType = iter->Type();
+    const auto &data = MessageData(*iter, msgType, buffer);
     if (msgType == "ignition.msgs.SerializedState")
     {
       msgs::SerializedState msg;
-      msg.ParseFromString(iter->Data());
+      msg.ParseFromString(data);
       this->Parse(_ecm, msg);
       break;
     }
     else if (msgType == "ignition.msgs.SerializedStateMap")
     {
       msgs::SerializedStateMap msg;
-      msg.ParseFromString(iter->Data());
+      msg.ParseFromString(data);
       this->Parse(_ecm, msg);
       break;
     }
@@ -310,6 +885,31 @@ bool LogPlaybackPrivate::Start(EntityComponentManager &_ecm)
 
   this->ReplaceResourceURIs(_ecm);
 
+  if (this->prefetch)
+  {
+    igndbg << "Prefetching log in chunks of ["
+           << std::chrono::duration<double>(this->prefetchWindow).count()
+           << "]s" << std::endl;
+    this->prefetchThread = std::thread(&LogPlaybackPrivate::PrefetchLoop,
+        this, dbPath);
+  }
+
+  if (this->timelineIndex)
+  {
+    auto worldName = _ecm.Component<components::Name>(worldEntity);
+    if (nullptr != worldName)
+    {
+      std::string service{"/world/" + worldName->Data() +
+          "/playback/timeline_index"};
+      this->node.Advertise(service, &LogPlaybackPrivate::OnTimelineIndex,
+          this);
+      igndbg << "Timeline index service on [" << service << "]"
+             << std::endl;
+    }
+    this->indexThread = std::thread(&LogPlaybackPrivate::LoadIndex, this,
+        dbPath, this->log->StartTime(), this->log->EndTime());
+  }
+
   this->instStarted = true;
   LogPlaybackPrivate::started = true;
   return true;
@@ -484,38 +1084,78 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
     return;
 
   // Get all messages from this timestep
-  // TODO(anyone) Jumping forward can be expensive for long jumps. For now,
-  // just playing every single step so we don't miss insertions and deletions.
   auto startTime = _info.simTime - _info.dt;
   auto endTime = _info.simTime;
 
   bool seekRewind = false;
   std::set<Entity> entitiesToRemove;
+  std::chrono::steady_clock::duration keyframeTime;
   if (_info.dt < std::chrono::steady_clock::duration::zero())
   {
-    // Detected jumping back in time. This can be expensive.
-    // To rewind / seek backward in time, we also need to play every single
-    // step from the beginning so we don't miss insertions and deletions
-    // This is because each serialized state is a changed state and not an
-    // absolute state.
-    // todo(anyone) Record absolute states during recording, i.e. key frames,
-    // so that playback can jump to these states without the need to
-    // incrementally build the states from the beginning
-
-    // Create a list of entities to be removed. The list will be updated later
-    // as the log steps forward below
+    // Detected jumping back in time. Each serialized state is a changed
+    // state and not an absolute state, so we need to start from the latest
+    // keyframe before the target time, or from the beginning if there's
+    // none, so we don't miss insertions and deletions.
+    seekRewind = true;
+    if (this->dataPtr->SeekKeyframe(_ecm,
+        std::chrono::steady_clock::duration::zero(), endTime, keyframeTime,
+        entitiesToRemove))
+    {
+      startTime = keyframeTime;
+    }
+    else
+    {
+      if (!this->dataPtr->warnedNoKeyframes &&
+          endTime > std::chrono::steady_clock::duration::zero())
+      {
+        ignwarn << "The log has no keyframes, so going back in time replays "
+                << "it from the start. Record with <keyframe_period> to make "
+                << "backward playback cheap." << std::endl;
+        this->dataPtr->warnedNoKeyframes = true;
+      }
+
+      // Create a list of entities to be removed. The list will be updated
+      // later as the log steps forward below
+      const auto &entities = _ecm.Entities().Vertices();
+      for (const auto &entity : entities)
+        entitiesToRemove.insert(Entity(entity.first));
+
+      startTime = std::chrono::steady_clock::duration::zero();
+      this->dataPtr->stateDecoder.Reset();
+    }
+  }
+  else if (_info.dt > kKeyframeSeekThreshold &&
+      this->dataPtr->SeekKeyframe(_ecm, startTime, endTime, keyframeTime,
+      entitiesToRemove))
+  {
+    // Jumping forward past a keyframe, skip the changes before it
     seekRewind = true;
-    const auto &entities = _ecm.Entities().Vertices();
-    for (const auto &entity : entities)
-      entitiesToRemove.insert(Entity(entity.first));
+    startTime = keyframeTime;
+  }
 
-    startTime = std::chrono::steady_clock::duration::zero();
+  std::vector<PlaybackMessage> messages;
+  if (!this->dataPtr->prefetch || seekRewind ||
+      !this->dataPtr->TakePrefetched(startTime, endTime, messages))
+  {
+    this->dataPtr->ReadMessages(*this->dataPtr->log, {startTime, endTime},
+        messages);
+
+    // Jumped, prefetch from here on. Reading ahead is useless while playing
+    // backward.
+    if (this->dataPtr->prefetch &&
+        _info.dt > std::chrono::steady_clock::duration::zero())
+    {
+      this->dataPtr->ResetPrefetch(endTime);
+    }
   }
 
-  this->dataPtr->batch = this->dataPtr->log->QueryMessages(
-      transport::log::AllTopics({startTime, endTime}));
+  // Poses cached before a jump belong to another time
+  if (seekRewind)
+    this->dataPtr->recentEntityPoseUpdates.clear();
 
-  msgs::Pose_V queuedPose;
+  // Only the last of a sequence of poses is set, so the ones before it
+  // aren't parsed at all
+  const std::string *queuedPose{nullptr};
 
   // If new pose updates are received, make sure that only the cached poses
   // from a previous Update cycle are cleared.
@@ -530,27 +1170,35 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
   // is called).
   bool clearCachedPoseUpdates = true;
 
-  auto iter = this->dataPtr->batch.begin();
-  while (iter != this->dataPtr->batch.end())
+  auto parseQueuedPose = [&]
+  {
+    if (nullptr == queuedPose)
+      return;
+
+    msgs::Pose_V msg;
+    if (msg.ParseFromString(*queuedPose))
+      this->dataPtr->Parse(msg, clearCachedPoseUpdates);
+    queuedPose = nullptr;
+  };
+
+  for (const auto &message : messages)
   {
-    auto msgType = iter->Type();
+    const auto &msgType = message.type;
+    const auto &data = message.data;
 
     // Only set the last pose of a sequence of poses.
-    if (msgType != "ignition.msgs.Pose_V" && queuedPose.pose_size() > 0)
-    {
-      this->dataPtr->Parse(queuedPose, clearCachedPoseUpdates);
-      queuedPose.Clear();
-    }
+    if (msgType != "ignition.msgs.Pose_V")
+      parseQueuedPose();
 
     if (msgType == "ignition.msgs.Pose_V")
     {
       // Queue poses to be set later
-      queuedPose.ParseFromString(iter->Data());
+      queuedPose = &data;
     }
     else if (msgType == "ignition.msgs.SerializedState")
     {
       msgs::SerializedState msg;
-      msg.ParseFromString(iter->Data());
+      msg.ParseFromString(data);
 
       // For seeking back in time only:
       // While stepping, update the list of entities to be removed
@@ -576,7 +1224,7 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
     else if (msgType == "ignition.msgs.SerializedStateMap")
     {
       msgs::SerializedStateMap msg;
-      msg.ParseFromString(iter->Data());
+      msg.ParseFromString(data);
 
       // For seeking back in time only:
       // While stepping, update the list of entities to be removed
@@ -610,31 +1258,23 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
               << msgType << "]" << std::endl;
     }
     this->dataPtr->ReplaceResourceURIs(_ecm);
-    ++iter;
   }
 
-  if (queuedPose.pose_size() > 0)
-  {
-    this->dataPtr->Parse(queuedPose, clearCachedPoseUpdates);
-  }
+  parseQueuedPose();
 
   // flag changed entity poses as periodically changed based on
-  // the latest LogPlaybackPrivate::Parse results
-  _ecm.Each<components::Pose>(
-      [&](const Entity &_entity, components::Pose *_poseComp) -> bool
+  // the latest LogPlaybackPrivate::Parse results. Only the logged entities
+  // are visited, instead of every entity with a pose.
+  for (const auto &[entity, pose] : this->dataPtr->recentEntityPoseUpdates)
   {
-    if (this->dataPtr->recentEntityPoseUpdates.find(_entity) ==
-        this->dataPtr->recentEntityPoseUpdates.end())
-      return true;
-
-    msgs::Pose pose = this->dataPtr->recentEntityPoseUpdates.at(_entity);
-    *_poseComp = components::Pose(msgs::Convert(pose));
+    auto poseComp = _ecm.Component<components::Pose>(entity);
+    if (nullptr == poseComp)
+      continue;
 
-    _ecm.SetChanged(_entity, components::Pose::typeId,
+    poseComp->Data() = pose;
+    _ecm.SetChanged(entity, components::Pose::typeId,
         ComponentState::PeriodicChange);
-
-    return true;
-  });
+  }
 
   // for seek back in time only
   // remove entities that should not be present in the current time step
@@ -37,6 +37,40 @@ namespace systems
   /// \class LogPlayback LogPlayback.hh
   ///   ignition/gazebo/systems/log/LogPlayback.hh
   /// \brief Log state playback
+  ///
+  /// If the log holds keyframes recorded with LogRecord's
+  /// `<keyframe_period>`, seeking backward or forward by more than a second
+  /// starts from the latest keyframe before the target time, instead of
+  /// replaying every change from the start of the log.
+  ///
+  /// The `/world/<world name>/playback/rate` service (msgs::Double) sets the
+  /// sim time moved through the log on each step, relative to the step
+  /// size. Negative rates play the log backward: each step is rebuilt from
+  /// the latest keyframe before it plus the changes recorded since, so its
+  /// cost depends on the keyframe period rather than on the position in
+  /// the log. The keyframe is only read once while stepping backward.
+  ///
+  /// ## System Parameters
+  ///
+  /// - `<playback_path>` Directory or compressed file to play back.
+  /// - `<prefetch>` True to read the log from a thread, ahead of the
+  ///   playhead, so steps don't wait on the database. Defaults to false.
+  /// - `<prefetch_window>` Sim time in seconds read at once by the prefetch
+  ///   thread. Defaults to 1.
+  /// - `<prefetch_chunks>` Number of windows read ahead of the playhead.
+  ///   Defaults to 4.
+  /// - `<timeline_index>` True to build a LogIndex of the log from a
+  ///   thread, stored as `timeline.idx` next to the log, or under
+  ///   `~/.ignition/gazebo/log_index` if that's not writable. An up to
+  ///   date index is reused. Keyframes are then found through the index,
+  ///   and its path is provided by the
+  ///   `/world/<world name>/playback/timeline_index` service, so tools
+  ///   like the playback scrubber can map it. Defaults to true.
+  /// - `<timeline_bucket>` Sim time in seconds covered by each bucket of
+  ///   the timeline index. Defaults to 0.1.
+  ///
+  /// Setting `forward` on a log playback control request plays the log as
+  /// fast as possible, until a request without it is received.
   class LogPlayback:
     public System,
     public ISystemConfigure,
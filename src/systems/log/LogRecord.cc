@@ -18,13 +18,24 @@
 #include "LogRecord.hh"
 
 #include <sys/stat.h>
+#include <unistd.h>
 #include <ignition/msgs/stringmsg.pb.h>
 
+#include <condition_variable>
 #include <string>
 #include <fstream>
 #include <ctime>
+#include <iterator>
 #include <set>
 #include <list>
+#include <mutex>
+#include <optional>
+#include <regex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Filesystem.hh>
@@ -48,6 +59,7 @@
 #include <sdf/Visual.hh>
 #include <sdf/World.hh>
 
+#include "ignition/gazebo/components/Factory.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Light.hh"
 #include "ignition/gazebo/components/Link.hh"
@@ -59,8 +71,11 @@
 #include "ignition/gazebo/components/Visual.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "ignition/gazebo/StateDelta.hh"
 #include "ignition/gazebo/Util.hh"
 
+#include "StateCompression.hh"
+
 using namespace ignition;
 using namespace ignition::gazebo::systems;
 
@@ -104,6 +119,54 @@ class ignition::gazebo::systems::LogRecordPrivate
   /// \brief Compress model resource files and state file into one file.
   public: void CompressStateAndResources();
 
+  /// \brief Copy a directory of resources, storing each distinct file only
+  /// once. Files which were already saved, or are in the resource store,
+  /// are hard linked instead of copied.
+  /// \param[in] _src Directory to copy.
+  /// \param[in] _dest Destination directory.
+  /// \return True if all files were copied.
+  public: bool CopyResources(const std::string &_src,
+      const std::string &_dest);
+
+  /// \brief Save a resource file, see CopyResources.
+  /// \param[in] _src File to copy.
+  /// \param[in] _dest Destination file.
+  /// \return True if successful.
+  public: bool SaveResourceFile(const std::string &_src,
+      const std::string &_dest);
+
+  /// \brief Record a message generated by this system. It's either published
+  /// for the recorder, or queued for the writer thread if writing directly.
+  /// \param[in] _pub Publisher used when not writing directly.
+  /// \param[in] _topic Topic to record the message on.
+  /// \param[in] _msg Message to record.
+  /// \param[in] _time Sim time to timestamp the message with.
+  public: void Record(transport::Node::Publisher &_pub,
+      const std::string &_topic, const google::protobuf::Message &_msg,
+      const std::chrono::steady_clock::duration &_time);
+
+  /// \brief Writer thread, inserts queued messages into the direct log.
+  public: void WriterLoop();
+
+  /// \brief Stop the writer thread after it has written all queued messages.
+  public: void StopWriter();
+
+  /// \brief Load the recording filters from the plugin SDF.
+  /// \param[in] _sdf Plugin SDF.
+  public: void LoadFilters(const std::shared_ptr<const sdf::Element> &_sdf);
+
+  /// \brief Resolve the component names in the filters into type IDs. This
+  /// is done once all systems, and the components they register, are loaded.
+  public: void ResolveFilters();
+
+  /// \brief Get the changed state of the entities and components which pass
+  /// the recording filters.
+  /// \param[in] _info Update info.
+  /// \param[in] _ecm Entity component manager.
+  /// \param[out] _state Changed state.
+  public: void FilteredState(const UpdateInfo &_info,
+      const EntityComponentManager &_ecm, msgs::SerializedStateMap &_state);
+
   /// \brief Indicator of whether any recorder instance has ever been started.
   /// Currently, only one instance is allowed. This enforcement may be removed
   /// in the future.
@@ -143,6 +206,15 @@ class ignition::gazebo::systems::LogRecordPrivate
   /// \brief Publisher for state changes
   public: transport::Node::Publisher statePub;
 
+  /// \brief Publisher for full state keyframes
+  public: transport::Node::Publisher keyframePub;
+
+  /// \brief Sim time between full state keyframes, zero to disable them.
+  public: std::chrono::steady_clock::duration keyframePeriod{0};
+
+  /// \brief Sim time of the last keyframe, if any.
+  public: std::optional<std::chrono::steady_clock::duration> keyframeTime;
+
   /// \brief Message holding SDF string of world
   public: msgs::StringMsg sdfMsg;
 
@@ -157,6 +229,110 @@ class ignition::gazebo::systems::LogRecordPrivate
 
   /// \brief List of saved models if record with resources is enabled.
   public: std::set<std::string> savedModels;
+
+  /// \brief Store identical resource files only once.
+  public: bool deduplicateResources{false};
+
+  /// \brief Directory holding resource files shared between logs, named by
+  /// their hash. Empty to not share resources.
+  public: std::string resourceStore;
+
+  /// \brief Hash of each resource file saved to this log, and its path.
+  public: std::unordered_map<std::string, std::string> savedResources;
+
+  /// \brief Write our own messages straight to the log file from a writer
+  /// thread, instead of publishing them for the recorder.
+  public: bool directWrite{false};
+
+  /// \brief Compress state and keyframe messages as they're written.
+  public: bool compressState{false};
+
+  /// \brief Send large components of state messages as deltas against
+  /// their previously recorded value.
+  public: bool deltaComponents{false};
+
+  /// \brief Delta encodes state messages, reset on every keyframe.
+  public: StateDeltaEncoder stateEncoder;
+
+  /// \brief Log written by the writer thread when writing directly.
+  public: std::unique_ptr<transport::log::Log> directLog;
+
+  /// \brief A message waiting to be written to the direct log.
+  public: struct QueuedMessage
+  {
+    /// \brief Sim time the message is recorded at.
+    std::chrono::steady_clock::duration time;
+
+    /// \brief Topic name.
+    std::string topic;
+
+    /// \brief Message type name.
+    std::string type;
+
+    /// \brief Serialized message.
+    std::string data;
+
+    /// \brief True to compress the data before writing it.
+    bool compress{false};
+  };
+
+  /// \brief Messages waiting for the writer thread.
+  public: std::vector<QueuedMessage> writerQueue;
+
+  /// \brief Protects writerQueue and stopWriter.
+  public: std::mutex writerMutex;
+
+  /// \brief Signals the writer thread that messages are queued.
+  public: std::condition_variable writerCv;
+
+  /// \brief True to stop the writer thread once the queue is empty.
+  public: bool stopWriter{false};
+
+  /// \brief Thread writing to the direct log.
+  public: std::thread writerThread;
+
+  /// \brief Name of the topic the SDF is recorded on.
+  public: std::string sdfTopic;
+
+  /// \brief Name of the topic state changes are recorded on.
+  public: std::string stateTopic;
+
+  /// \brief Name of the topic keyframes are recorded on.
+  public: std::string keyframeTopic;
+
+  /// \brief True if any recording filter is set.
+  public: bool filtered{false};
+
+  /// \brief Names of the only component types to record.
+  public: std::vector<std::string> recordComponentNames;
+
+  /// \brief Names of component types not to record.
+  public: std::vector<std::string> excludeComponentNames;
+
+  /// \brief Names of component types to record at a lower rate, and the
+  /// rate in Hz.
+  public: std::vector<std::pair<std::string, double>> componentRateNames;
+
+  /// \brief Only entities whose name, or whose ancestor's name, matches one
+  /// of these is recorded. Empty to record all entities.
+  public: std::vector<std::regex> entityRegexes;
+
+  /// \brief Whether ResolveFilters has been called.
+  public: bool filtersResolved{false};
+
+  /// \brief Component types to record. Empty to record all types.
+  public: std::unordered_set<ComponentTypeId> recordTypes;
+
+  /// \brief Sim time between recordings of rate limited component types.
+  public: std::unordered_map<ComponentTypeId,
+      std::chrono::steady_clock::duration> typePeriods;
+
+  /// \brief Sim time each rate limited type was last recorded.
+  public: std::unordered_map<ComponentTypeId,
+      std::chrono::steady_clock::duration> typeRecordTimes;
+
+  /// \brief Entities which pass the entity filters.
+  public: std::unordered_set<Entity> recordedEntities;
 };
 
 bool LogRecordPrivate::started{false};
@@ -174,6 +350,325 @@ std::string LogRecordPrivate::AppendExtension(const std::string &_dir,
   return rv;
 }
 
+//////////////////////////////////////////////////
+void LogRecordPrivate::Record(transport::Node::Publisher &_pub,
+    const std::string &_topic, const google::protobuf::Message &_msg,
+    const std::chrono::steady_clock::duration &_time)
+{
+  if (!this->directWrite)
+  {
+    _pub.Publish(_msg);
+    return;
+  }
+
+  if (_topic.empty())
+    return;
+
+  QueuedMessage queued;
+  queued.time = _time;
+  queued.topic = _topic;
+  queued.type = _msg.GetTypeName();
+  queued.compress = this->compressState && _topic != this->sdfTopic;
+  if (!_msg.SerializeToString(&queued.data))
+  {
+    ignerr << "Failed to serialize message to record on [" << _topic << "]"
+           << std::endl;
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->writerMutex);
+    this->writerQueue.push_back(std::move(queued));
+  }
+  this->writerCv.notify_one();
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::WriterLoop()
+{
+  std::vector<QueuedMessage> batch;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->writerMutex);
+      this->writerCv.wait(lock, [this]
+      {
+        return this->stopWriter || !this->writerQueue.empty();
+      });
+
+      if (this->writerQueue.empty())
+        break;
+
+      // Take everything queued so far, so the simulation thread is never
+      // blocked on the database
+      batch.swap(this->writerQueue);
+    }
+
+    // The log groups consecutive inserts into transactions
+    std::string compressed;
+    for (auto &msg : batch)
+    {
+      // Compress here, so it doesn't slow down the simulation thread
+      if (msg.compress)
+      {
+        if (log_system::CompressData(msg.data, compressed))
+        {
+          msg.data.swap(compressed);
+          msg.type += log_system::kCompressedTypeSuffix;
+        }
+        else
+        {
+          ignerr << "Failed to compress message on [" << msg.topic
+                 << "], writing it uncompressed" << std::endl;
+        }
+      }
+
+      if (!this->directLog->InsertMessage(msg.time, msg.topic, msg.type,
+          msg.data.data(), msg.data.size()))
+      {
+        ignerr << "Failed to write message on [" << msg.topic
+               << "] to the log" << std::endl;
+      }
+    }
+    batch.clear();
+  }
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::StopWriter()
+{
+  if (!this->writerThread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(this->writerMutex);
+    this->stopWriter = true;
+  }
+  this->writerCv.notify_one();
+  this->writerThread.join();
+
+  // Destroying the log commits the last transaction
+  this->directLog.reset();
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::LoadFilters(
+    const std::shared_ptr<const sdf::Element> &_sdf)
+{
+  for (auto elem = _sdf->GetElementImpl("record_component"); elem;
+      elem = elem->GetNextElement("record_component"))
+  {
+    this->recordComponentNames.push_back(elem->Get<std::string>());
+  }
+
+  for (auto elem = _sdf->GetElementImpl("exclude_component"); elem;
+      elem = elem->GetNextElement("exclude_component"))
+  {
+    this->excludeComponentNames.push_back(elem->Get<std::string>());
+  }
+
+  for (auto elem = _sdf->GetElementImpl("component_rate"); elem;
+      elem = elem->GetNextElement("component_rate"))
+  {
+    auto name = elem->Get<std::string>("component", "").first;
+    auto rate = elem->Get<double>();
+    if (name.empty() || rate <= 0.0)
+    {
+      ignerr << "A <component_rate> needs a component attribute and a "
+             << "positive rate, ignoring it." << std::endl;
+      continue;
+    }
+    this->componentRateNames.push_back({name, rate});
+  }
+
+  for (auto elem = _sdf->GetElementImpl("record_entity"); elem;
+      elem = elem->GetNextElement("record_entity"))
+  {
+    auto pattern = elem->Get<std::string>();
+    try
+    {
+      this->entityRegexes.push_back(std::regex(pattern));
+    }
+    catch (const std::regex_error &_e)
+    {
+      ignerr << "Invalid <record_entity> regular expression [" << pattern
+             << "]: " << _e.what() << std::endl;
+    }
+  }
+
+  this->filtered = !this->recordComponentNames.empty() ||
+      !this->excludeComponentNames.empty() ||
+      !this->componentRateNames.empty() || !this->entityRegexes.empty();
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::ResolveFilters()
+{
+  this->filtersResolved = true;
+
+  // Component names may be given with or without their namespace, i.e.
+  // "ign_gazebo_components.Pose" or "Pose"
+  auto factory = components::Factory::Instance();
+  auto typeIdByName = [&](const std::string &_name)
+  {
+    for (auto typeId : factory->TypeIds())
+    {
+      auto typeName = factory->Name(typeId);
+      if (typeName == _name || (typeName.size() > _name.size() &&
+          typeName.compare(typeName.size() - _name.size() - 1,
+          std::string::npos, "." + _name) == 0))
+      {
+        return std::optional<ComponentTypeId>(typeId);
+      }
+    }
+    ignerr << "Unknown component type [" << _name
+           << "] in recording filters." << std::endl;
+    return std::optional<ComponentTypeId>();
+  };
+
+  for (const auto &name : this->recordComponentNames)
+  {
+    if (auto typeId = typeIdByName(name))
+      this->recordTypes.insert(*typeId);
+  }
+
+  // Excluded and rate limited types need the full list of types to record
+  if (this->recordTypes.empty() && (!this->excludeComponentNames.empty() ||
+      !this->componentRateNames.empty()))
+  {
+    for (auto typeId : factory->TypeIds())
+      this->recordTypes.insert(typeId);
+  }
+
+  for (const auto &name : this->excludeComponentNames)
+  {
+    if (auto typeId = typeIdByName(name))
+      this->recordTypes.erase(*typeId);
+  }
+
+  for (const auto &[name, rate] : this->componentRateNames)
+  {
+    if (auto typeId = typeIdByName(name))
+    {
+      this->typePeriods[*typeId] = std::chrono::duration_cast<
+          std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(1.0 / rate));
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::FilteredState(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm, msgs::SerializedStateMap &_state)
+{
+  IGN_PROFILE("LogRecordPrivate::FilteredState");
+  if (!this->filtersResolved)
+    this->ResolveFilters();
+
+  const bool filterEntities = !this->entityRegexes.empty();
+  auto nameMatches = [&](Entity _entity)
+  {
+    auto name = _ecm.Component<components::Name>(_entity);
+    if (nullptr == name)
+      return false;
+    for (const auto &regex : this->entityRegexes)
+    {
+      if (std::regex_match(name->Data(), regex))
+        return true;
+    }
+    return false;
+  };
+
+  // New and removed entities are recorded with all their components, even
+  // if their rate limited types aren't due
+  std::unordered_set<Entity> createdOrRemoved;
+  _ecm.EachNew<components::Name>(
+      [&](const Entity &_entity, const components::Name *) -> bool
+  {
+    if (!filterEntities)
+    {
+      createdOrRemoved.insert(_entity);
+      return true;
+    }
+
+    // Record entities below a matching entity, and all ancestors of a
+    // matching entity, so playback can rebuild the hierarchy
+    bool matches{false};
+    for (auto entity = _entity; entity != kNullEntity && !matches;
+        entity = _ecm.ParentEntity(entity))
+    {
+      matches = this->recordedEntities.count(entity) > 0 ||
+          nameMatches(entity);
+    }
+    if (!matches)
+      return true;
+
+    for (auto entity = _entity; entity != kNullEntity;
+        entity = _ecm.ParentEntity(entity))
+    {
+      if (this->recordedEntities.insert(entity).second)
+        createdOrRemoved.insert(entity);
+    }
+    return true;
+  });
+
+  std::vector<Entity> removed;
+  _ecm.EachRemoved<components::Name>(
+      [&](const Entity &_entity, const components::Name *) -> bool
+  {
+    if (!filterEntities || this->recordedEntities.count(_entity) > 0)
+    {
+      createdOrRemoved.insert(_entity);
+      removed.push_back(_entity);
+    }
+    return true;
+  });
+
+  if (!createdOrRemoved.empty())
+  {
+    // New components are marked as changed, so the ancestors which were
+    // created previously also need their full state
+    _ecm.State(_state, createdOrRemoved, this->recordTypes, true);
+  }
+
+  for (auto entity : removed)
+    this->recordedEntities.erase(entity);
+
+  // Changes on other entities, only for the types which are due
+  auto dueTypes = this->recordTypes;
+  for (const auto &[typeId, period] : this->typePeriods)
+  {
+    auto lastIt = this->typeRecordTimes.find(typeId);
+    if (lastIt != this->typeRecordTimes.end() &&
+        _info.simTime - lastIt->second < period)
+    {
+      dueTypes.erase(typeId);
+    }
+    else
+    {
+      this->typeRecordTimes[typeId] = _info.simTime;
+    }
+  }
+
+  // An empty set would mean all types
+  if (dueTypes.empty() && !this->recordTypes.empty())
+    return;
+  if (filterEntities && this->recordedEntities.empty())
+    return;
+
+  msgs::SerializedStateMap changed;
+  _ecm.State(changed, filterEntities ? this->recordedEntities :
+      std::unordered_set<Entity>(), dueTypes, false);
+
+  // Don't overwrite the full state of new entities
+  auto &entities = *_state.mutable_entities();
+  for (auto &entity : *changed.mutable_entities())
+  {
+    if (entities.find(entity.first) == entities.end())
+      entities[entity.first].Swap(&entity.second);
+  }
+}
+
 //////////////////////////////////////////////////
 LogRecord::LogRecord()
   : System(), dataPtr(std::make_unique<LogRecordPrivate>())
@@ -187,6 +682,7 @@ LogRecord::~LogRecord()
   {
     // Use ign-transport directly
     this->dataPtr->recorder.Stop();
+    this->dataPtr->StopWriter();
 
     if (this->dataPtr->compress)
       this->dataPtr->CompressStateAndResources();
@@ -210,6 +706,33 @@ void LogRecord::Configure(const Entity &_entity,
     false).first);
 
   this->dataPtr->compress = _sdf->Get<bool>("compress", false).first;
+
+  this->dataPtr->resourceStore =
+      _sdf->Get<std::string>("resource_store", "").first;
+  this->dataPtr->deduplicateResources =
+      !this->dataPtr->resourceStore.empty() ||
+      _sdf->Get<bool>("deduplicate_resources", false).first;
+
+  this->dataPtr->LoadFilters(_sdf);
+
+  this->dataPtr->directWrite = _sdf->Get<bool>("direct_write", false).first;
+
+  // Only the writer thread can compress messages
+  this->dataPtr->compressState =
+      _sdf->Get<bool>("compress_state", false).first;
+  if (this->dataPtr->compressState)
+    this->dataPtr->directWrite = true;
+
+  this->dataPtr->deltaComponents =
+      _sdf->Get<bool>("delta_components", false).first;
+
+  double keyframePeriod = _sdf->Get<double>("keyframe_period", 0.0).first;
+  if (keyframePeriod > 0.0)
+  {
+    this->dataPtr->keyframePeriod = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(keyframePeriod));
+  }
   this->dataPtr->cmpPath = _sdf->Get<std::string>("compress_path", "").first;
 
   // If plugin is specified in both the SDF tag and on command line, only
@@ -286,8 +809,12 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
   auto validSdfTopic = transport::TopicUtils::AsValidTopic(sdfTopic);
   if (!validSdfTopic.empty())
   {
-    this->sdfPub = this->node.Advertise(validSdfTopic,
-        this->sdfMsg.GetTypeName());
+    this->sdfTopic = validSdfTopic;
+    if (!this->directWrite)
+    {
+      this->sdfPub = this->node.Advertise(validSdfTopic,
+          this->sdfMsg.GetTypeName());
+    }
   }
   else
   {
@@ -300,8 +827,12 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
   auto validStateTopic = transport::TopicUtils::AsValidTopic(stateTopic);
   if (!validStateTopic.empty())
   {
-    this->statePub = this->node.Advertise<msgs::SerializedStateMap>(
-        validStateTopic);
+    this->stateTopic = validStateTopic;
+    if (!this->directWrite)
+    {
+      this->statePub = this->node.Advertise<msgs::SerializedStateMap>(
+          validStateTopic);
+    }
   }
   else
   {
@@ -316,8 +847,56 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
     ignmsg << "Overwriting existing file [" << dbPath << "]\n";
     common::removeFile(dbPath);
   }
+  std::string keyframeTopic = stateTopic + "_keyframe";
+  if (this->keyframePeriod > std::chrono::steady_clock::duration::zero())
+  {
+    auto validKeyframeTopic =
+        transport::TopicUtils::AsValidTopic(keyframeTopic);
+    if (!validKeyframeTopic.empty())
+    {
+      this->keyframeTopic = validKeyframeTopic;
+      if (!this->directWrite)
+      {
+        this->keyframePub = this->node.Advertise<msgs::SerializedStateMap>(
+            validKeyframeTopic);
+      }
+    }
+    else
+    {
+      ignerr << "Failed to generate valid topic to publish keyframes. Tried ["
+             << keyframeTopic << "]." << std::endl;
+    }
+  }
+
   ignmsg << "Recording to log file [" << dbPath << "]" << std::endl;
 
+  // Our own messages are written straight to the state log by the writer
+  // thread, and the recorder writes all other topics to a separate file, so
+  // each database has a single writer.
+  std::string recorderDbPath = dbPath;
+  if (this->directWrite)
+  {
+    this->directLog = std::make_unique<transport::log::Log>();
+    if (!this->directLog->Open(dbPath, std::ios_base::out))
+    {
+      ignerr << "Failed to open log file [" << dbPath << "]. "
+             << "Recording will not take place." << std::endl;
+      this->directLog.reset();
+      LogRecordPrivate::started = false;
+      return false;
+    }
+    this->writerThread = std::thread(&LogRecordPrivate::WriterLoop, this);
+
+    recorderDbPath = common::joinPaths(this->logPath, "topics.tlog");
+    if (common::exists(recorderDbPath))
+    {
+      ignmsg << "Overwriting existing file [" << recorderDbPath << "]\n";
+      common::removeFile(recorderDbPath);
+    }
+    ignmsg << "Recording other topics to log file [" << recorderDbPath
+           << "]" << std::endl;
+  }
+
   // Add default topics if no topics were specified.
   std::string dynPoseTopic = "/world/" + this->worldName +
     "/dynamic_pose/info";
@@ -326,8 +905,17 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
   igndbg << "Recording default topic[" << sdfTopic << "].\n";
   igndbg << "Recording default topic[" << stateTopic << "].\n";
   this->recorder.AddTopic(dynPoseTopic);
-  this->recorder.AddTopic(sdfTopic);
-  this->recorder.AddTopic(stateTopic);
+  if (!this->directWrite)
+  {
+    this->recorder.AddTopic(sdfTopic);
+    this->recorder.AddTopic(stateTopic);
+  }
+  if (!this->keyframeTopic.empty())
+  {
+    igndbg << "Recording default topic[" << keyframeTopic << "].\n";
+    if (!this->directWrite)
+      this->recorder.AddTopic(keyframeTopic);
+  }
 
   // Get the topics to record, if any.
   if (this->sdf->HasElement("record_topic"))
@@ -363,14 +951,22 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
   this->recorder.Sync(this->clock.get());
 
   // This calls Log::Open() and loads sql schema
-  if (this->recorder.Start(dbPath) ==
+  if (this->recorder.Start(recorderDbPath) ==
       ignition::transport::log::RecorderError::SUCCESS)
   {
     this->instStarted = true;
     return true;
   }
-  else
-    return false;
+
+  // The state can still be recorded without the recorder
+  if (this->directWrite)
+  {
+    ignerr << "Failed to start recording to [" << recorderDbPath
+           << "]. Only the state will be recorded." << std::endl;
+    this->instStarted = true;
+    return true;
+  }
+  return false;
 }
 
 //////////////////////////////////////////////////
@@ -524,7 +1120,7 @@ bool LogRecordPrivate::SaveModels(const std::set<std::string> &_models)
     if (fileName[0] == '/')
     {
       // search in gazebo path
-      modelPath = common::findFile(fileName);
+      modelPath = findResource(fileName);
       if (!modelPath.empty())
       {
         fileFound = true;
@@ -591,8 +1187,13 @@ bool LogRecordPrivate::SaveModels(const std::set<std::string> &_models)
       }
 
       // Copy entire model directory
-      if (!common::createDirectories(destPath) ||
-          !common::copyDirectory(srcPath, destPath))
+      bool copied = common::createDirectories(destPath);
+      if (copied && this->deduplicateResources)
+        copied = this->CopyResources(srcPath, destPath);
+      else if (copied)
+        copied = common::copyDirectory(srcPath, destPath);
+
+      if (!copied)
       {
         ignerr << "Failed to copy model directory from [" << srcPath
                << "] to [" << destPath << "]" << std::endl;
@@ -600,7 +1201,9 @@ bool LogRecordPrivate::SaveModels(const std::set<std::string> &_models)
       }
       else
       {
-        // Overwrite model SDF with newly generated SDF with relative paths
+        // Overwrite model SDF with newly generated SDF with relative paths.
+        // Remove it first, in case it's linked to a stored file.
+        common::removeFile(destModelPath);
         std::ofstream ofs(destModelPath);
         ofs << root.Element()->ToString("").c_str();
         ofs.close();
@@ -616,6 +1219,97 @@ bool LogRecordPrivate::SaveModels(const std::set<std::string> &_models)
   return !saveError;
 }
 
+//////////////////////////////////////////////////
+bool LogRecordPrivate::CopyResources(const std::string &_src,
+    const std::string &_dest)
+{
+  if (!common::createDirectories(_dest))
+    return false;
+
+  bool result{true};
+  for (common::DirIter file(_src); file != common::DirIter(); ++file)
+  {
+    auto dest = common::joinPaths(_dest, common::basename(*file));
+    if (common::isDirectory(*file))
+      result = this->CopyResources(*file, dest) && result;
+    else if (common::isFile(*file))
+      result = this->SaveResourceFile(*file, dest) && result;
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool LogRecordPrivate::SaveResourceFile(const std::string &_src,
+    const std::string &_dest)
+{
+  std::ifstream ifs(_src, std::ios::binary);
+  if (!ifs.is_open())
+  {
+    ignerr << "Failed to read resource [" << _src << "]" << std::endl;
+    return false;
+  }
+  std::string content((std::istreambuf_iterator<char>(ifs)),
+      std::istreambuf_iterator<char>());
+  auto hash = common::sha1(content);
+
+  // Hard links fail across file systems, in which case the file is copied
+  auto linkOrWrite = [&](const std::string &_existing)
+  {
+    if (common::exists(_dest))
+      common::removeFile(_dest);
+    if (link(_existing.c_str(), _dest.c_str()) == 0)
+      return true;
+
+    std::ofstream ofs(_dest, std::ios::binary);
+    ofs.write(content.data(), content.size());
+    return ofs.good();
+  };
+
+  // Saved to this log already
+  auto savedIt = this->savedResources.find(hash);
+  if (savedIt != this->savedResources.end())
+    return linkOrWrite(savedIt->second);
+
+  bool result{false};
+  if (!this->resourceStore.empty())
+  {
+    auto storeDir = common::joinPaths(this->resourceStore, hash.substr(0, 2));
+    auto storePath = common::joinPaths(storeDir, hash);
+    if (!common::exists(storePath))
+    {
+      // Write under a temporary name, so other logs never link to a
+      // partially written file
+      auto tmpPath = storePath + "." + std::to_string(getpid()) + ".tmp";
+      std::ofstream ofs;
+      if (common::createDirectories(storeDir))
+        ofs.open(tmpPath, std::ios::binary);
+      ofs.write(content.data(), content.size());
+      ofs.close();
+      if (!ofs.good() || !common::moveFile(tmpPath, storePath))
+      {
+        ignwarn << "Failed to add [" << _src << "] to the resource store ["
+                << this->resourceStore << "]" << std::endl;
+        common::removeFile(tmpPath);
+      }
+    }
+    if (common::exists(storePath))
+      result = linkOrWrite(storePath);
+  }
+
+  if (!result)
+  {
+    std::ofstream ofs(_dest, std::ios::binary);
+    ofs.write(content.data(), content.size());
+    result = ofs.good();
+  }
+
+  if (result)
+    this->savedResources[hash] = _dest;
+  else
+    ignerr << "Failed to save resource [" << _dest << "]" << std::endl;
+  return result;
+}
+
 //////////////////////////////////////////////////
 void LogRecordPrivate::CompressStateAndResources()
 {
@@ -692,7 +1386,8 @@ void LogRecord::PostUpdate(const UpdateInfo &_info,
         this->dataPtr->sdfMsg.set_data(
             worldSdfComp->Data().Element()->ToString(""));
 
-        this->dataPtr->sdfPub.Publish(this->dataPtr->sdfMsg);
+        this->dataPtr->Record(this->dataPtr->sdfPub,
+            this->dataPtr->sdfTopic, this->dataPtr->sdfMsg, _info.simTime);
         this->dataPtr->sdfPublished = true;
       }
     }
@@ -700,14 +1395,45 @@ void LogRecord::PostUpdate(const UpdateInfo &_info,
 
   // TODO(louise) Use the SceneBroadcaster's topic once that publishes
   // the changed state
-  // \todo(anyone) A potential enhancement here is have a keyframe mechanism
-  // to store complete state periodically, and then store incremental from
-  // that. It would reduce some of the compute on replaying
-  // (especially in tools like plotting or seeking through logs).
   msgs::SerializedStateMap stateMsg;
-  _ecm.ChangedState(stateMsg);
+  if (this->dataPtr->filtered)
+    this->dataPtr->FilteredState(_info, _ecm, stateMsg);
+  else
+    _ecm.ChangedState(stateMsg);
   if (!stateMsg.entities().empty())
-    this->dataPtr->statePub.Publish(stateMsg);
+  {
+    if (this->dataPtr->deltaComponents)
+      this->dataPtr->stateEncoder.Encode(stateMsg);
+    this->dataPtr->Record(this->dataPtr->statePub, this->dataPtr->stateTopic,
+        stateMsg, _info.simTime);
+  }
+
+  // Periodically store the complete state, so playback can seek to the
+  // latest keyframe and only apply the changes recorded after it
+  if (!this->dataPtr->keyframeTopic.empty() &&
+      (!this->dataPtr->keyframeTime ||
+      _info.simTime - *this->dataPtr->keyframeTime >=
+      this->dataPtr->keyframePeriod))
+  {
+    IGN_PROFILE("LogRecord::PostUpdate Keyframe");
+    msgs::SerializedStateMap keyframeMsg;
+    if (!this->dataPtr->filtered)
+      _ecm.State(keyframeMsg, {}, {}, true);
+    else if (this->dataPtr->entityRegexes.empty())
+      _ecm.State(keyframeMsg, {}, this->dataPtr->recordTypes, true);
+    else if (!this->dataPtr->recordedEntities.empty())
+    {
+      _ecm.State(keyframeMsg, this->dataPtr->recordedEntities,
+          this->dataPtr->recordTypes, true);
+    }
+    this->dataPtr->Record(this->dataPtr->keyframePub,
+        this->dataPtr->keyframeTopic, keyframeMsg, _info.simTime);
+    this->dataPtr->keyframeTime = _info.simTime;
+
+    // Playback which seeks to this keyframe doesn't know the values
+    // recorded before it
+    this->dataPtr->stateEncoder.Reset();
+  }
 
   // If there are new models loaded, save meshes and textures
   if (this->dataPtr->RecordResources() && _ecm.HasNewEntities())
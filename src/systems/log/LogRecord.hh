@@ -36,6 +36,51 @@ namespace systems
 
   /// \class LogRecord LogRecord.hh ignition/gazebo/systems/log/LogRecord.hh
   /// \brief Log state recorder
+  ///
+  /// ## System Parameters
+  ///
+  /// - `<record_path>` Directory to record to.
+  /// - `<record_resources>` True to also record meshes and textures.
+  /// - `<deduplicate_resources>` True to store identical resource files only
+  ///   once per log, hard linking the duplicates. Defaults to false.
+  /// - `<resource_store>` Directory where resource files are shared between
+  ///   logs, named by their SHA-1 hash. Recorded resources are hard linked
+  ///   to the store, or copied if it's on another file system. Implies
+  ///   `<deduplicate_resources>`.
+  /// - `<record_topic>` Additional topic to record, may be a regular
+  ///   expression. Can be repeated.
+  /// - `<compress>` True to compress the recording when done.
+  /// - `<compress_path>` Path of the compressed recording.
+  /// - `<keyframe_period>` Sim time in seconds between recordings of the
+  ///   complete state, on `/world/<world name>/changed_state_keyframe`.
+  ///   LogPlayback seeks to the latest keyframe instead of replaying all
+  ///   changes from the start. Defaults to 0, which records no keyframes.
+  /// - `<direct_write>` True to write the SDF, state and keyframes straight
+  ///   to `state.tlog` from a writer thread, instead of publishing them for
+  ///   the transport recorder. All other topics are then recorded to
+  ///   `topics.tlog`. Defaults to false.
+  /// - `<compress_state>` True to compress each state and keyframe message
+  ///   with zlib on the writer thread as it's written. Implies
+  ///   `<direct_write>`. LogPlayback decompresses messages as it plays them,
+  ///   so the recording can be played back without `<compress>`'s zip
+  ///   archive and its extraction. Defaults to false.
+  /// - `<delta_components>` True to record changes of large components,
+  ///   such as joint positions and contacts, as deltas against the value
+  ///   recorded last, when that's smaller. Each keyframe starts over from
+  ///   full values. Only changed components are affected, which are
+  ///   recorded when any of the filters below is set. Defaults to false.
+  ///
+  /// The following filters reduce what's recorded. All of them can be
+  /// repeated. When any is set, changed components of the recorded entities
+  /// are recorded too, not only new and removed entities.
+  ///
+  /// - `<record_component>` Only record this component type, e.g. `Pose`
+  ///   or `ign_gazebo_components.Pose`.
+  /// - `<exclude_component>` Don't record this component type.
+  /// - `<component_rate component="<type>">` Record changes of this
+  ///   component type at most at this rate, in Hz.
+  /// - `<record_entity>` Only record entities whose name matches this
+  ///   regular expression, together with their descendants and ancestors.
   class LogRecord:
     public System,
     public ISystemConfigure,
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef IGNITION_GAZEBO_SYSTEMS_LOG_STATE_COMPRESSION_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LOG_STATE_COMPRESSION_HH_
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/gzip_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "ignition/gazebo/config.hh"
+
+namespace ignition::gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems::log_system
+{
+  /// \brief Appended to the message type of messages recorded compressed,
+  /// e.g. "ignition.msgs.SerializedStateMap+zlib".
+  static const std::string kCompressedTypeSuffix{"+zlib"};
+
+  /// \brief Whether a recorded message type is compressed.
+  /// \param[in] _type Recorded message type.
+  /// \return True if the type ends with kCompressedTypeSuffix.
+  inline bool IsCompressedType(const std::string &_type)
+  {
+    return _type.size() > kCompressedTypeSuffix.size() &&
+        _type.compare(_type.size() - kCompressedTypeSuffix.size(),
+        kCompressedTypeSuffix.size(), kCompressedTypeSuffix) == 0;
+  }
+
+  /// \brief Compress a serialized message with zlib. The uncompressed size
+  /// is stored in front of the zlib stream, so truncated data is detected.
+  /// \param[in] _data Data to compress.
+  /// \param[out] _compressed Compressed data.
+  /// \return True if successful.
+  inline bool CompressData(const std::string &_data, std::string &_compressed)
+  {
+    _compressed.clear();
+    google::protobuf::io::StringOutputStream stringStream(&_compressed);
+    {
+      google::protobuf::io::CodedOutputStream sizeStream(&stringStream);
+      sizeStream.WriteVarint64(_data.size());
+    }
+
+    google::protobuf::io::GzipOutputStream::Options options;
+    options.format = google::protobuf::io::GzipOutputStream::ZLIB;
+    google::protobuf::io::GzipOutputStream zipStream(&stringStream, options);
+
+    void *buffer{nullptr};
+    int size{0};
+    std::size_t written{0};
+    while (written < _data.size())
+    {
+      if (!zipStream.Next(&buffer, &size))
+        return false;
+      std::size_t count = std::min(static_cast<std::size_t>(size),
+          _data.size() - written);
+      _data.copy(static_cast<char *>(buffer), count, written);
+      written += count;
+      if (count < static_cast<std::size_t>(size))
+        zipStream.BackUp(size - static_cast<int>(count));
+    }
+    return zipStream.Close();
+  }
+
+  /// \brief Decompress data compressed with CompressData.
+  /// \param[in] _compressed Compressed data.
+  /// \param[out] _data Decompressed data.
+  /// \return True if successful.
+  inline bool DecompressData(const std::string &_compressed,
+      std::string &_data)
+  {
+    _data.clear();
+    google::protobuf::io::ArrayInputStream arrayStream(_compressed.data(),
+        static_cast<int>(_compressed.size()));
+    uint64_t dataSize{0};
+    {
+      google::protobuf::io::CodedInputStream sizeStream(&arrayStream);
+      if (!sizeStream.ReadVarint64(&dataSize))
+        return false;
+    }
+
+    google::protobuf::io::GzipInputStream zipStream(&arrayStream,
+        google::protobuf::io::GzipInputStream::ZLIB);
+
+    const void *buffer{nullptr};
+    int size{0};
+    while (zipStream.Next(&buffer, &size))
+      _data.append(static_cast<const char *>(buffer), size);
+
+    return zipStream.ZlibErrorCode() >= 0 && _data.size() == dataSize;
+  }
+}
+}
+}
+#endif
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "StateCompression.hh"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace ignition::gazebo::systems::log_system;
+
+/////////////////////////////////////////////////
+TEST(StateCompression, CompressedType)
+{
+  EXPECT_TRUE(IsCompressedType("ignition.msgs.SerializedStateMap+zlib"));
+  EXPECT_FALSE(IsCompressedType("ignition.msgs.SerializedStateMap"));
+  EXPECT_FALSE(IsCompressedType("+zlib"));
+  EXPECT_FALSE(IsCompressedType(""));
+}
+
+/////////////////////////////////////////////////
+TEST(StateCompression, RoundTrip)
+{
+  // Repetitive, larger than the stream buffers
+  std::string data;
+  for (int i = 0; i < 100000; ++i)
+    data += "pose " + std::to_string(i % 100) + ";";
+
+  std::string compressed;
+  ASSERT_TRUE(CompressData(data, compressed));
+  EXPECT_LT(compressed.size(), data.size() / 4);
+
+  std::string decompressed;
+  ASSERT_TRUE(DecompressData(compressed, decompressed));
+  EXPECT_EQ(data, decompressed);
+
+  // Empty data
+  ASSERT_TRUE(CompressData("", compressed));
+  ASSERT_TRUE(DecompressData(compressed, decompressed));
+  EXPECT_TRUE(decompressed.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(StateCompression, Invalid)
+{
+  std::string decompressed;
+  EXPECT_FALSE(DecompressData("not compressed", decompressed));
+
+  std::string compressed;
+  ASSERT_TRUE(CompressData(std::string(1000, 'a'), compressed));
+  compressed.resize(compressed.size() / 2);
+  EXPECT_FALSE(DecompressData(compressed, decompressed));
+}
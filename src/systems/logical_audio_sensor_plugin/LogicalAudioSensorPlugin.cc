@@ -17,13 +17,16 @@
 
 #include "LogicalAudioSensorPlugin.hh"
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <ignition/gazebo/components/LogicalAudio.hh>
 #include <ignition/gazebo/components/Model.hh>
@@ -35,6 +38,7 @@
 #include <ignition/transport.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/gazebo/SdfEntityCreator.hh>
+#include <ignition/gazebo/SpatialIndex.hh>
 #include <ignition/gazebo/Util.hh>
 #include <sdf/Element.hh>
 #include "LogicalAudio.hh"
@@ -77,6 +81,12 @@ class ignition::gazebo::systems::LogicalAudioSensorPluginPrivate
   public: bool DurationExceeded(const UpdateInfo &_simTimeInfo,
                const logical_audio::SourcePlayInfo &_sourcePlayInfo);
 
+  /// \brief Index the sources which can currently be heard, by the box
+  /// around the sphere they can be heard in, so that each microphone only
+  /// checks the sources near it.
+  /// \param[in] _ecm The simulation's EntityComponentManager.
+  public: void IndexAudibleSources(const EntityComponentManager &_ecm);
+
   /// \brief Node used to create publishers and services
   public: ignition::transport::Node node;
 
@@ -106,6 +116,20 @@ class ignition::gazebo::systems::LogicalAudioSensorPluginPrivate
   /// \brief A mutex used to ensure that the stop source service call does
   /// not interfere with the source's state in the PreUpdate step.
   public: std::mutex stopSourceMutex;
+
+  /// \brief Sources which can currently be heard, by the sphere they can be
+  /// heard in.
+  public: std::unique_ptr<SpatialIndex> sourceIndex;
+
+  /// \brief Largest radius a source in sourceIndex can be heard from. The
+  /// index's cells are twice as large, so each source spans few cells.
+  public: double sourceIndexRadius{0.0};
+
+  /// \brief World poses of the sources in sourceIndex
+  public: std::unordered_map<Entity, math::Pose3d> sourcePoses;
+
+  /// \brief Scoped names of sources, which are put in detection messages
+  public: std::unordered_map<Entity, std::string> sourceNames;
 };
 
 //////////////////////////////////////////////////
@@ -212,49 +236,120 @@ void LogicalAudioSensorPlugin::PostUpdate(const UpdateInfo &_info,
     std::chrono::duration_cast<std::chrono::nanoseconds>(_info.simTime);
   const auto nanosecondOffset = (simNanoseconds - simSeconds).count();
 
+  if (this->dataPtr->micEntities.empty())
+    return;
+
+  this->dataPtr->IndexAudibleSources(_ecm);
+
   for (auto & [micEntity, detectionPub] : this->dataPtr->micEntities)
   {
     const auto micPose = worldPose(micEntity, _ecm);
     const auto micInfo = _ecm.Component<components::LogicalMicrophone>(
         micEntity)->Data();
 
-    _ecm.Each<components::LogicalAudioSource,
-              components::LogicalAudioSourcePlayInfo>(
-      [&, &publisher = detectionPub](const Entity &_entity,
-          const components::LogicalAudioSource *_source,
-          const components::LogicalAudioSourcePlayInfo *_playInfo)
+    // Only the sources whose sphere holds the microphone can be heard
+    for (auto sourceEntity : this->dataPtr->sourceIndex->Query(
+        math::AxisAlignedBox(micPose.Pos(), micPose.Pos())))
+    {
+      const auto &source =
+          _ecm.Component<components::LogicalAudioSource>(sourceEntity)->Data();
+      const auto vol = logical_audio::computeVolume(
+          true,
+          source.attFunc,
+          source.attShape,
+          source.emissionVolume,
+          source.innerRadius,
+          source.falloffDistance,
+          this->dataPtr->sourcePoses[sourceEntity],
+          micPose);
+
+      if (logical_audio::detect(vol, micInfo.volumeDetectionThreshold))
       {
-        const auto sourcePose = worldPose(_entity, _ecm);
-        const auto vol = logical_audio::computeVolume(
-            _playInfo->Data().playing,
-            _source->Data().attFunc,
-            _source->Data().attShape,
-            _source->Data().emissionVolume,
-            _source->Data().innerRadius,
-            _source->Data().falloffDistance,
-            sourcePose,
-            micPose);
-
-        if (logical_audio::detect(vol, micInfo.volumeDetectionThreshold))
+        auto nameIt = this->dataPtr->sourceNames.find(sourceEntity);
+        if (nameIt == this->dataPtr->sourceNames.end())
         {
-          // publish the source that the microphone heard, along with the
-          // volume level the microphone detected. The detected source's
-          // ID is embedded in the message's header
-          ignition::msgs::Double msg;
-          auto header = msg.mutable_header();
-          auto timeStamp = header->mutable_stamp();
-          timeStamp->set_sec(simSeconds.count());
-          timeStamp->set_nsec(nanosecondOffset);
-          auto headerData = header->add_data();
-          headerData->set_key(scopedName(_entity, _ecm));
-          msg.set_data(vol);
-
-          publisher.Publish(msg);
+          nameIt = this->dataPtr->sourceNames.emplace(sourceEntity,
+              scopedName(sourceEntity, _ecm)).first;
         }
 
+        // publish the source that the microphone heard, along with the
+        // volume level the microphone detected. The detected source's
+        // ID is embedded in the message's header
+        ignition::msgs::Double msg;
+        auto header = msg.mutable_header();
+        auto timeStamp = header->mutable_stamp();
+        timeStamp->set_sec(simSeconds.count());
+        timeStamp->set_nsec(nanosecondOffset);
+        auto headerData = header->add_data();
+        headerData->set_key(nameIt->second);
+        msg.set_data(vol);
+
+        detectionPub.Publish(msg);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void LogicalAudioSensorPluginPrivate::IndexAudibleSources(
+    const EntityComponentManager &_ecm)
+{
+  // Sources which aren't playing, or are silent, can't be heard
+  struct AudibleSource
+  {
+    Entity entity;
+    math::Pose3d pose;
+    double radius;
+  };
+  std::vector<AudibleSource> audible;
+  double maxRadius{0.0};
+  _ecm.Each<components::LogicalAudioSource,
+            components::LogicalAudioSourcePlayInfo>(
+    [&](const Entity &_entity,
+        const components::LogicalAudioSource *_source,
+        const components::LogicalAudioSourcePlayInfo *_playInfo)
+    {
+      if (!_playInfo->Data().playing ||
+          _source->Data().emissionVolume < 0.00001)
+      {
         return true;
-      });
+      }
+
+      double radius = std::max(_source->Data().innerRadius,
+          _source->Data().falloffDistance);
+      audible.push_back({_entity, worldPose(_entity, _ecm), radius});
+      maxRadius = std::max(maxRadius, radius);
+      return true;
+    });
+
+  // Start over with larger cells if a source can be heard from further away
+  if (!this->sourceIndex || maxRadius > this->sourceIndexRadius)
+  {
+    this->sourceIndexRadius = std::max(maxRadius, 1.0);
+    this->sourceIndex =
+        std::make_unique<SpatialIndex>(2.0 * this->sourceIndexRadius);
+    this->sourcePoses.clear();
+  }
+
+  std::unordered_map<Entity, math::Pose3d> poses;
+  for (const auto &source : audible)
+  {
+    const math::Vector3d extent(source.radius, source.radius, source.radius);
+    this->sourceIndex->Set(source.entity, math::AxisAlignedBox(
+        source.pose.Pos() - extent, source.pose.Pos() + extent));
+    poses[source.entity] = source.pose;
+  }
+
+  // Remove the sources which can't be heard anymore
+  for (const auto &source : this->sourcePoses)
+  {
+    if (poses.find(source.first) == poses.end())
+    {
+      this->sourceIndex->Remove(source.first);
+      this->sourceNames.erase(source.first);
+    }
   }
+  this->sourcePoses = std::move(poses);
 }
 
 //////////////////////////////////////////////////
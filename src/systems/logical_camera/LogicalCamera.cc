@@ -19,16 +19,21 @@
 
 #include <ignition/msgs/logical_camera_image.pb.h>
 
+#include <algorithm>
+#include <cmath>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
 #include <ignition/plugin/Register.hh>
 
 #include <sdf/Sensor.hh>
 
+#include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/Helpers.hh>
 #include <ignition/transport/Node.hh>
 
@@ -43,6 +48,7 @@
 #include "ignition/gazebo/components/Sensor.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SpatialIndex.hh"
 #include "ignition/gazebo/Util.hh"
 
 using namespace ignition;
@@ -59,13 +65,23 @@ class ignition::gazebo::systems::LogicalCameraPrivate
   /// \brief Ign-sensors sensor factory for creating sensors
   public: sensors::SensorFactory sensorFactory;
 
+  /// \brief Corners of each logicalCamera's frustum, in the sensor frame.
+  /// They're used to find the models which may be seen by the camera.
+  public: std::unordered_map<Entity, std::vector<math::Vector3d>>
+      frustumCorners;
+
+  /// \brief Index of the world's models, shared with other systems
+  public: std::shared_ptr<SpatialIndex> modelIndex;
+
   /// \brief Create logicalCamera sensor
   /// \param[in] _ecm Mutable reference to ECM.
   public: void CreateLogicalCameraEntities(EntityComponentManager &_ecm);
 
   /// \brief Update logicalCamera sensor data based on physics data
+  /// \param[in] _info Current simulation iteration.
   /// \param[in] _ecm Immutable reference to ECM.
-  public: void UpdateLogicalCameras(const EntityComponentManager &_ecm);
+  public: void UpdateLogicalCameras(const UpdateInfo &_info,
+      const EntityComponentManager &_ecm);
 
   /// \brief Remove logicalCamera sensors if their entities have been removed
   /// from simulation.
@@ -107,7 +123,7 @@ void LogicalCamera::PostUpdate(const UpdateInfo &_info,
   // Only update and publish if not paused.
   if (!_info.paused)
   {
-    this->dataPtr->UpdateLogicalCameras(_ecm);
+    this->dataPtr->UpdateLogicalCameras(_info, _ecm);
 
     for (auto &it : this->dataPtr->entitySensorMap)
     {
@@ -165,6 +181,30 @@ void LogicalCameraPrivate::CreateLogicalCameraEntities(
         // Set topic
         _ecm.CreateComponent(_entity, components::SensorTopic(sensor->Topic()));
 
+        // Frustum corners, looking along +X. The vertical extent is
+        // bounded generously so it holds whichever way the aspect ratio is
+        // applied.
+        auto cameraElem = data->GetElement("logical_camera");
+        double nearClip = cameraElem->Get<double>("near");
+        double farClip = cameraElem->Get<double>("far");
+        double tanHalfFov = std::tan(
+            cameraElem->Get<double>("horizontal_fov") / 2.0);
+        double aspect = cameraElem->Get<double>("aspect_ratio");
+        double tanHalfVertical = aspect > 0.0 ?
+            std::max(tanHalfFov, tanHalfFov / aspect) : tanHalfFov;
+        auto &corners = this->frustumCorners[_entity];
+        for (double distance : {nearClip, farClip})
+        {
+          for (double y : {-1.0, 1.0})
+          {
+            for (double z : {-1.0, 1.0})
+            {
+              corners.emplace_back(distance, y * distance * tanHalfFov,
+                  z * distance * tanHalfVertical);
+            }
+          }
+        }
+
         this->entitySensorMap.insert(
             std::make_pair(_entity, std::move(sensor)));
 
@@ -177,20 +217,12 @@ void LogicalCameraPrivate::UpdateLogicalCameras(
     const EntityComponentManager &_ecm)
 {
   IGN_PROFILE("LogicalCameraPrivate::UpdateLogicalCameras");
-  std::map<std::string, math::Pose3d> modelPoses;
-
-  _ecm.Each<components::Model, components::Name, components::Pose>(
-      [&](const Entity &,
-        const components::Model *,
-        const components::Name *_name,
-        const components::Pose *_pose)->bool
-      {
-        /// todo(anyone) We currently assume there are only top level models
-        /// Update to retrieve world pose when nested models are supported.
-        modelPoses[_name->Data()] = _pose->Data();
-        return true;
-      });
+  if (this->entitySensorMap.empty())
+    return;
 
+  if (!this->modelIndex)
+    this->modelIndex = SpatialIndex::Models(_ecm);
+  this->modelIndex->UpdateModels(_info, _ecm);
 
   _ecm.Each<components::LogicalCamera, components::WorldPose>(
     [&](const Entity &_entity,
@@ -202,16 +234,39 @@ void LogicalCameraPrivate::UpdateLogicalCameras(
         {
           const math::Pose3d &worldPose = _worldPose->Data();
           it->second->SetPose(worldPose);
-          // Make a copy of modelPoses s.t. SetModelPoses can take ownership
-          auto modelPoses_ = modelPoses;
-          it->second->SetModelPoses(std::move(modelPoses_));
+
+          // Only give the sensor the models within the frustum's bounding
+          // box, the sensor checks which ones are within the frustum
+          math::Vector3d min{math::MAX_D, math::MAX_D, math::MAX_D};
+          math::Vector3d max{math::LOW_D, math::LOW_D, math::LOW_D};
+          for (const auto &corner : this->frustumCorners[_entity])
+          {
+            auto worldCorner = worldPose.CoordPositionAdd(corner);
+            min.Min(worldCorner);
+            max.Max(worldCorner);
+          }
+
+          /// todo(anyone) We currently assume there are only top level models
+          /// Update to retrieve world pose when nested models are supported.
+          std::map<std::string, math::Pose3d> modelPoses;
+          for (auto model : this->modelIndex->Query(
+              math::AxisAlignedBox(min, max)))
+          {
+            auto name = _ecm.Component<components::Name>(model);
+            auto pose = _ecm.Component<components::Pose>(model);
+            if (nullptr != name && nullptr != pose &&
+                nullptr != _ecm.Component<components::Model>(model))
+            {
+              modelPoses[name->Data()] = pose->Data();
+            }
+          }
+          it->second->SetModelPoses(std::move(modelPoses));
         }
         else
         {
           ignerr << "Failed to update logicalCamera: " << _entity << ". "
                  << "Entity not found." << std::endl;
         }
-
         return true;
       });
 }
@@ -23,8 +23,11 @@
 
 #include "MulticopterMotorModel.hh"
 
+#include <algorithm>
+#include <map>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
 
@@ -115,13 +118,29 @@ enum class MotorType {
   kForce
 };
 
+class RotorBank;
+
 class ignition::gazebo::systems::MulticopterMotorModelPrivate
 {
+  /// \brief Destructor, removes the rotor from its bank.
+  public: ~MulticopterMotorModelPrivate();
+
   /// \brief Callback for actuator commands.
   public: void OnActuatorMsg(const ignition::msgs::Actuators &_msg);
 
-  /// \brief Apply link forces and moments based on propeller state.
-  public: void UpdateForcesAndMoments(EntityComponentManager &_ecm);
+  /// \brief Update the reference input from the latest actuators message,
+  /// if there's a new one.
+  /// \param[in] _ecm Entity component manager.
+  /// \return False if the message doesn't have this motor's index.
+  public: bool UpdateRefMotorInput(const EntityComponentManager &_ecm);
+
+  /// \brief Bank which updates this rotor. It's shared by all the rotors of
+  /// the world in batched mode, and only holds this rotor otherwise.
+  public: std::shared_ptr<RotorBank> bank;
+
+  /// \brief Whether the entities and components needed to update the rotor
+  /// are available.
+  public: bool ready{false};
 
   /// \brief Joint Entity
   public: Entity jointEntity;
@@ -218,6 +237,97 @@ class ignition::gazebo::systems::MulticopterMotorModelPrivate
   public: transport::Node node;
 };
 
+/// \brief Rotors which are updated together, with their state laid out in
+/// contiguous arrays so the forces are computed in tight loops. The first
+/// rotor of the bank to run on an iteration updates all of them.
+class RotorBank
+{
+  /// \brief Add a rotor.
+  /// \param[in] _rotor Rotor, which must outlive its membership.
+  public: void Add(MulticopterMotorModelPrivate *_rotor);
+
+  /// \brief Remove a rotor.
+  /// \param[in] _rotor Rotor.
+  public: void Remove(MulticopterMotorModelPrivate *_rotor);
+
+  /// \brief Apply link forces and moments based on the state of all
+  /// propellers.
+  /// \param[in] _info Simulation update info.
+  /// \param[in] _ecm Entity component manager.
+  public: void UpdateForcesAndMoments(const UpdateInfo &_info,
+              EntityComponentManager &_ecm);
+
+  /// \brief Iteration on which the bank was last updated.
+  public: uint64_t lastIteration{0};
+
+  /// \brief All rotors of the bank.
+  public: std::vector<MulticopterMotorModelPrivate *> rotors;
+
+  /// \brief Rotors updated on the current iteration. The following arrays
+  /// have one element per active rotor, and are kept as members to avoid
+  /// allocations.
+  public: std::vector<MulticopterMotorModelPrivate *> active;
+
+  /// \brief Rotor velocity used to compute thrust, in rad/s.
+  public: std::vector<double> realMotorVelocity;
+
+  /// \brief Turning direction of each rotor.
+  public: std::vector<double> turningDirection;
+
+  /// \brief Thrust coefficient of each rotor.
+  public: std::vector<double> motorConstant;
+
+  /// \brief Moment constant of each rotor.
+  public: std::vector<double> momentConstant;
+
+  /// \brief Rotor drag coefficient of each rotor.
+  public: std::vector<double> rotorDragCoefficient;
+
+  /// \brief Rolling moment coefficient of each rotor.
+  public: std::vector<double> rollingMomentCoefficient;
+
+  /// \brief World pose of each rotor link.
+  public: std::vector<math::Pose3d> linkPose;
+
+  /// \brief World pose of each rotor's parent link.
+  public: std::vector<math::Pose3d> parentPose;
+
+  /// \brief Rotor axis of each joint, in the world frame.
+  public: std::vector<math::Vector3d> jointAxis;
+
+  /// \brief Link velocity relative to the wind, in the world frame.
+  public: std::vector<math::Vector3d> relativeWindVelocity;
+
+  /// \brief Thrust of each rotor.
+  public: std::vector<double> thrust;
+
+  /// \brief Force on each rotor link, in the world frame.
+  public: std::vector<math::Vector3d> linkForce;
+
+  /// \brief Torque on each parent link, in the world frame.
+  public: std::vector<math::Vector3d> parentTorque;
+};
+
+/// \brief Get the bank shared by all batched rotors of a world.
+/// \param[in] _ecm The world's entity component manager.
+/// \return The bank, which lives as long as one of its rotors holds it.
+std::shared_ptr<RotorBank> SharedRotorBank(const EntityComponentManager &_ecm)
+{
+  static std::mutex mutex;
+  static std::map<const EntityComponentManager *, std::weak_ptr<RotorBank>>
+      banks;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &weakBank = banks[&_ecm];
+  auto bank = weakBank.lock();
+  if (!bank)
+  {
+    bank = std::make_shared<RotorBank>();
+    weakBank = bank;
+  }
+  return bank;
+}
+
 //////////////////////////////////////////////////
 MulticopterMotorModel::MulticopterMotorModel()
   : dataPtr(std::make_unique<MulticopterMotorModelPrivate>())
@@ -356,6 +466,12 @@ void MulticopterMotorModel::Configure(const Entity &_entity,
           this->dataPtr->timeConstantUp, this->dataPtr->timeConstantDown,
           this->dataPtr->refMotorInput);
 
+  if (sdfClone->Get<bool>("batched", false).first)
+    this->dataPtr->bank = SharedRotorBank(_ecm);
+  else
+    this->dataPtr->bank = std::make_shared<RotorBank>();
+  this->dataPtr->bank->Add(this->dataPtr.get());
+
   // Subscribe to actuator command messages
   std::string topic = transport::TopicUtils::AsValidTopic(
       this->dataPtr->robotNamespace + "/" + this->dataPtr->commandSubTopic);
@@ -406,9 +522,11 @@ void MulticopterMotorModel::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
         this->dataPtr->model.LinkByName(_ecm, this->dataPtr->parentLinkName);
   }
 
+  this->dataPtr->ready = false;
   if (this->dataPtr->jointEntity == kNullEntity ||
       this->dataPtr->linkEntity == kNullEntity ||
-      this->dataPtr->parentLinkEntity == kNullEntity)
+      this->dataPtr->parentLinkEntity == kNullEntity ||
+      !this->dataPtr->bank)
     return;
 
   // skip UpdateForcesAndMoments if needed components are missing
@@ -455,16 +573,25 @@ void MulticopterMotorModel::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
     doUpdateForcesAndMoments = false;
   }
 
+  this->dataPtr->ready = doUpdateForcesAndMoments;
+
   // Nothing left to do if paused.
   if (_info.paused)
     return;
 
-  this->dataPtr->samplingTime =
-    std::chrono::duration<double>(_info.dt).count();
-  if (doUpdateForcesAndMoments)
-  {
-    this->dataPtr->UpdateForcesAndMoments(_ecm);
-  }
+  // The first rotor of the bank to run on this iteration updates all of them
+  auto &bank = *this->dataPtr->bank;
+  if (bank.lastIteration == _info.iterations)
+    return;
+  bank.lastIteration = _info.iterations;
+  bank.UpdateForcesAndMoments(_info, _ecm);
+}
+
+//////////////////////////////////////////////////
+MulticopterMotorModelPrivate::~MulticopterMotorModelPrivate()
+{
+  if (this->bank)
+    this->bank->Remove(this);
 }
 
 //////////////////////////////////////////////////
@@ -476,11 +603,9 @@ void MulticopterMotorModelPrivate::OnActuatorMsg(
 }
 
 //////////////////////////////////////////////////
-void MulticopterMotorModelPrivate::UpdateForcesAndMoments(
-    EntityComponentManager &_ecm)
+bool MulticopterMotorModelPrivate::UpdateRefMotorInput(
+    const EntityComponentManager &_ecm)
 {
-  IGN_PROFILE("MulticopterMotorModelPrivate::UpdateForcesAndMoments");
-
   std::optional<msgs::Actuators> msg;
   auto actuatorMsgComp =
       _ecm.Component<components::Actuators>(this->model.Entity());
@@ -508,7 +633,7 @@ void MulticopterMotorModelPrivate::UpdateForcesAndMoments(
       ignerr << "You tried to access index " << this->motorNumber
         << " of the Actuator velocity array which is of size "
         << msg->velocity_size() << std::endl;
-      return;
+      return false;
     }
 
     if (this->motorType == MotorType::kVelocity)
@@ -523,150 +648,202 @@ void MulticopterMotorModelPrivate::UpdateForcesAndMoments(
       this->refMotorInput = msg->velocity(this->motorNumber);
     }
   }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void RotorBank::Add(MulticopterMotorModelPrivate *_rotor)
+{
+  this->rotors.push_back(_rotor);
+}
 
-  switch (this->motorType)
+//////////////////////////////////////////////////
+void RotorBank::Remove(MulticopterMotorModelPrivate *_rotor)
+{
+  this->rotors.erase(
+      std::remove(this->rotors.begin(), this->rotors.end(), _rotor),
+      this->rotors.end());
+}
+
+//////////////////////////////////////////////////
+void RotorBank::UpdateForcesAndMoments(const UpdateInfo &_info,
+    EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("RotorBank::UpdateForcesAndMoments");
+
+  using Pose = ignition::math::Pose3d;
+  using Vector3 = ignition::math::Vector3d;
+
+  const double samplingTime = std::chrono::duration<double>(_info.dt).count();
+
+  // The wind is the same for all rotors
+  Vector3 windSpeedWorld;
+  Entity windEntity = _ecm.EntityByComponents(components::Wind());
+  auto windLinearVel =
+      _ecm.Component<components::WorldLinearVelocity>(windEntity);
+  if (windLinearVel)
+    windSpeedWorld = windLinearVel->Data();
+
+  this->active.clear();
+  this->realMotorVelocity.clear();
+  this->turningDirection.clear();
+  this->motorConstant.clear();
+  this->momentConstant.clear();
+  this->rotorDragCoefficient.clear();
+  this->rollingMomentCoefficient.clear();
+  this->linkPose.clear();
+  this->parentPose.clear();
+  this->jointAxis.clear();
+  this->relativeWindVelocity.clear();
+
+  // Gather the state of all rotors
+  for (auto *rotor : this->rotors)
   {
-    case (MotorType::kPosition):
+    rotor->samplingTime = samplingTime;
+    if (!rotor->ready || !rotor->UpdateRefMotorInput(_ecm))
+      continue;
+
+    // MotorType::kPosition and MotorType::kForce aren't supported yet
+    if (rotor->motorType != MotorType::kVelocity)
+      continue;
+
+    const auto jointVelocity = _ecm.Component<components::JointVelocity>(
+        rotor->jointEntity);
+    const auto worldPose = _ecm.Component<components::WorldPose>(
+        rotor->linkEntity);
+    const auto worldLinearVel =
+        _ecm.Component<components::WorldLinearVelocity>(rotor->linkEntity);
+    const auto parentWorldPose = _ecm.Component<components::WorldPose>(
+        rotor->parentLinkEntity);
+    if (!jointVelocity || jointVelocity->Data().empty() || !worldPose ||
+        !worldLinearVel || !parentWorldPose)
     {
-      // double err = joint_->GetAngle(0).Radian() - this->refMotorInput;
-      // double force = pids_.Update(err, this->samplingTime);
-      // joint_->SetForce(0, force);
-      break;
+      continue;
     }
-    case (MotorType::kForce):
+
+    const auto jointPose = _ecm.Component<components::Pose>(
+        rotor->jointEntity);
+    if (!jointPose)
     {
-      // joint_->SetForce(0, this->refMotorInput);
-      break;
+      ignerr << "joint " << rotor->jointName << " has no Pose"
+             << "component" << std::endl;
+      continue;
     }
-    default:  // MotorType::kVelocity
+
+    const auto jointAxisComp = _ecm.Component<components::JointAxis>(
+        rotor->jointEntity);
+    if (!jointAxisComp)
     {
-      const auto jointVelocity = _ecm.Component<components::JointVelocity>(
-          this->jointEntity);
-      double motorRotVel = jointVelocity->Data()[0];
-      if (motorRotVel / (2 * IGN_PI) > 1 / (2 * this->samplingTime))
-      {
-        ignerr << "Aliasing on motor [" << this->motorNumber
-              << "] might occur. Consider making smaller simulation time "
-                 "steps or raising the rotorVelocitySlowdownSim param.\n";
-      }
-      double realMotorVelocity =
-          motorRotVel * this->rotorVelocitySlowdownSim;
-      // Get the direction of the rotor rotation.
-      int realMotorVelocitySign =
-          (realMotorVelocity > 0) - (realMotorVelocity < 0);
-      // Assuming symmetric propellers (or rotors) for the thrust calculation.
-      double thrust = this->turningDirection * realMotorVelocitySign *
-                      realMotorVelocity * realMotorVelocity *
-                      this->motorConstant;
-
-      using Pose = ignition::math::Pose3d;
-      using Vector3 = ignition::math::Vector3d;
-
-      Link link(this->linkEntity);
-      const auto worldPose = link.WorldPose(_ecm);
-
-      // Apply a force to the link.
-      link.AddWorldForce(_ecm,
-                         worldPose->Rot().RotateVector(Vector3(0, 0, thrust)));
-
-      const auto jointPose = _ecm.Component<components::Pose>(
-          this->jointEntity);
-      if (!jointPose)
-      {
-        ignerr << "joint " << this->jointName << " has no Pose"
-               << "component" << std::endl;
-        return;
-      }
-      // computer joint world pose by multiplying child link WorldPose
-      // with joint Pose
-      Pose jointWorldPose = *worldPose * jointPose->Data();
-
-      const auto jointAxisComp = _ecm.Component<components::JointAxis>(
-          this->jointEntity);
-      if (!jointAxisComp)
-      {
-        ignerr << "joint " << this->jointName << " has no JointAxis"
-               << "component" << std::endl;
-        return;
-      }
-
-      const auto worldLinearVel = link.WorldLinearVelocity(_ecm);
-
-      Entity windEntity = _ecm.EntityByComponents(components::Wind());
-      auto windLinearVel =
-          _ecm.Component<components::WorldLinearVelocity>(windEntity);
-      Vector3 windSpeedWorld = windLinearVel->Data();
-
-      // Forces from Philppe Martin's and Erwan Salaun's
-      // 2010 IEEE Conference on Robotics and Automation paper
-      // The True Role of Accelerometer Feedback in Quadrotor Control
-      // - \omega * \lambda_1 * V_A^{\perp}
-      Vector3 jointAxis =
-          jointWorldPose.Rot().RotateVector(jointAxisComp->Data().Xyz());
-      Vector3 bodyVelocityWorld = *worldLinearVel;
-      Vector3 relativeWindVelocityWorld = bodyVelocityWorld - windSpeedWorld;
-      Vector3 bodyVelocityPerpendicular =
-          relativeWindVelocityWorld -
-          (relativeWindVelocityWorld.Dot(jointAxis) * jointAxis);
-      Vector3 airDrag = -std::abs(realMotorVelocity) *
-                               this->rotorDragCoefficient *
-                               bodyVelocityPerpendicular;
-
-      // Apply air drag to link.
-      link.AddWorldForce(_ecm, airDrag);
-      // Moments get the parent link, such that the resulting torques can be
-      // applied.
-      Vector3 parentWorldTorque;
-      auto parentWrenchComp =
-        _ecm.Component<components::ExternalWorldWrenchCmd>(
-          this->parentLinkEntity);
-      // gazebo_motor_model.cpp subtracts the GetWorldCoGPose() of the
-      // child link from the parent but only uses the rotation component.
-      // Since GetWorldCoGPose() uses the link frame orientation, it
-      // is equivalent to use WorldPose().Rot().
-      Link parentLink(this->parentLinkEntity);
-      const auto parentWorldPose = parentLink.WorldPose(_ecm);
-      // The tansformation from the parent_link to the link_.
-      // Pose poseDifference =
-      //  link_->GetWorldCoGPose() - parent_links.at(0)->GetWorldCoGPose();
-      Pose poseDifference = *worldPose - *parentWorldPose;
-      Vector3 dragTorque(
-          0, 0, -this->turningDirection * thrust * this->momentConstant);
-      // Transforming the drag torque into the parent frame to handle
-      // arbitrary rotor orientations.
-      Vector3 dragTorqueParentFrame =
-          poseDifference.Rot().RotateVector(dragTorque);
-      parentWorldTorque =
-          parentWorldPose->Rot().RotateVector(dragTorqueParentFrame);
-
-      Vector3 rollingMoment;
-      // - \omega * \mu_1 * V_A^{\perp}
-      rollingMoment = -std::abs(realMotorVelocity) *
-                       this->rollingMomentCoefficient *
-                       bodyVelocityPerpendicular;
-      parentWorldTorque += rollingMoment;
-      if (!parentWrenchComp)
-      {
-        components::ExternalWorldWrenchCmd wrench;
-        msgs::Set(wrench.Data().mutable_torque(), parentWorldTorque);
-        _ecm.CreateComponent(this->parentLinkEntity, wrench);
-      }
-      else
-      {
-        msgs::Set(parentWrenchComp->Data().mutable_torque(),
-          msgs::Convert(parentWrenchComp->Data().torque()) + parentWorldTorque);
-      }
-      // Apply the filter on the motor's velocity.
-      double refMotorRotVel;
-      refMotorRotVel = this->rotorVelocityFilter->UpdateFilter(
-          this->refMotorInput, this->samplingTime);
-
-      const auto jointVelCmd = _ecm.Component<components::JointVelocityCmd>(
-          this->jointEntity);
-      *jointVelCmd = components::JointVelocityCmd(
-          {this->turningDirection * refMotorRotVel
-                              / this->rotorVelocitySlowdownSim});
+      ignerr << "joint " << rotor->jointName << " has no JointAxis"
+             << "component" << std::endl;
+      continue;
     }
+
+    double motorRotVel = jointVelocity->Data()[0];
+    if (motorRotVel / (2 * IGN_PI) > 1 / (2 * samplingTime))
+    {
+      ignerr << "Aliasing on motor [" << rotor->motorNumber
+            << "] might occur. Consider making smaller simulation time "
+               "steps or raising the rotorVelocitySlowdownSim param.\n";
+    }
+
+    // computer joint world pose by multiplying child link WorldPose
+    // with joint Pose
+    Pose jointWorldPose = worldPose->Data() * jointPose->Data();
+
+    this->active.push_back(rotor);
+    this->realMotorVelocity.push_back(
+        motorRotVel * rotor->rotorVelocitySlowdownSim);
+    this->turningDirection.push_back(rotor->turningDirection);
+    this->motorConstant.push_back(rotor->motorConstant);
+    this->momentConstant.push_back(rotor->momentConstant);
+    this->rotorDragCoefficient.push_back(rotor->rotorDragCoefficient);
+    this->rollingMomentCoefficient.push_back(
+        rotor->rollingMomentCoefficient);
+    this->linkPose.push_back(worldPose->Data());
+    this->parentPose.push_back(parentWorldPose->Data());
+    this->jointAxis.push_back(
+        jointWorldPose.Rot().RotateVector(jointAxisComp->Data().Xyz()));
+    this->relativeWindVelocity.push_back(
+        worldLinearVel->Data() - windSpeedWorld);
+  }
+
+  const std::size_t count = this->active.size();
+
+  // Assuming symmetric propellers (or rotors) for the thrust calculation.
+  // This is the same as multiplying the squared velocity by its sign.
+  this->thrust.resize(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    this->thrust[i] = this->turningDirection[i] * this->realMotorVelocity[i] *
+        std::abs(this->realMotorVelocity[i]) * this->motorConstant[i];
+  }
+
+  this->linkForce.resize(count);
+  this->parentTorque.resize(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    // Forces from Philppe Martin's and Erwan Salaun's
+    // 2010 IEEE Conference on Robotics and Automation paper
+    // The True Role of Accelerometer Feedback in Quadrotor Control
+    // - \omega * \lambda_1 * V_A^{\perp}
+    const Vector3 &axis = this->jointAxis[i];
+    const Vector3 &relativeWindVelocityWorld = this->relativeWindVelocity[i];
+    Vector3 bodyVelocityPerpendicular =
+        relativeWindVelocityWorld -
+        (relativeWindVelocityWorld.Dot(axis) * axis);
+    const double absMotorVelocity = std::abs(this->realMotorVelocity[i]);
+    Vector3 airDrag = -absMotorVelocity * this->rotorDragCoefficient[i] *
+                      bodyVelocityPerpendicular;
+
+    // Thrust and air drag are both applied to the link.
+    this->linkForce[i] = this->linkPose[i].Rot().RotateVector(
+        Vector3(0, 0, this->thrust[i])) + airDrag;
+
+    // gazebo_motor_model.cpp subtracts the GetWorldCoGPose() of the
+    // child link from the parent but only uses the rotation component.
+    // Since GetWorldCoGPose() uses the link frame orientation, it
+    // is equivalent to use WorldPose().Rot().
+    // The tansformation from the parent_link to the link_.
+    Pose poseDifference = this->linkPose[i] - this->parentPose[i];
+    Vector3 dragTorque(0, 0, -this->turningDirection[i] * this->thrust[i] *
+        this->momentConstant[i]);
+    // Transforming the drag torque into the parent frame to handle
+    // arbitrary rotor orientations.
+    Vector3 dragTorqueParentFrame =
+        poseDifference.Rot().RotateVector(dragTorque);
+
+    // - \omega * \mu_1 * V_A^{\perp}
+    Vector3 rollingMoment = -absMotorVelocity *
+        this->rollingMomentCoefficient[i] * bodyVelocityPerpendicular;
+
+    this->parentTorque[i] =
+        this->parentPose[i].Rot().RotateVector(dragTorqueParentFrame) +
+        rollingMoment;
+  }
+
+  // Apply the results
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    auto *rotor = this->active[i];
+
+    Link link(rotor->linkEntity);
+    link.AddWorldForce(_ecm, this->linkForce[i]);
+
+    // Moments get the parent link, such that the resulting torques can be
+    // applied.
+    Link parentLink(rotor->parentLinkEntity);
+    parentLink.AddWorldWrench(_ecm, Vector3::Zero, this->parentTorque[i]);
+
+    // Apply the filter on the motor's velocity.
+    double refMotorRotVel = rotor->rotorVelocityFilter->UpdateFilter(
+        rotor->refMotorInput, samplingTime);
+
+    const auto jointVelCmd = _ecm.Component<components::JointVelocityCmd>(
+        rotor->jointEntity);
+    *jointVelCmd = components::JointVelocityCmd(
+        {rotor->turningDirection * refMotorRotVel
+                            / rotor->rotorVelocitySlowdownSim});
   }
 }
 
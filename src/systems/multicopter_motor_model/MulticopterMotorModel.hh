@@ -33,6 +33,13 @@ namespace systems
 
   /// \brief This system applies a thrust force to models with spinning
   /// propellers. See examples/worlds/quadcopter.sdf for a demonstration.
+  ///
+  /// Each instance handles one rotor. When `<batched>` is true, the rotors
+  /// of all instances in the world which also set it are updated together
+  /// by whichever of them runs first on each iteration, with their state
+  /// gathered into contiguous arrays. This is meant for worlds with many
+  /// vehicles, and gives the same results as updating rotors one by one.
+  /// Defaults to false.
   class MulticopterMotorModel
       : public System,
         public ISystemConfigure,
@@ -16,8 +16,12 @@
  */
 
 #include <algorithm>
+#include <condition_variable>
+#include <cstring>
 #include <optional>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <ignition/common/Profiler.hh>
@@ -48,8 +52,34 @@ using namespace gazebo;
 using namespace systems;
 using namespace optical_tactile_sensor;
 
+/// \brief Coordinates of a set of points, stored in separate arrays so loops
+/// over the points can be vectorized by the compiler.
+struct PointArrays
+{
+  /// \brief Resize all coordinate arrays
+  /// \param[in] _size Number of points
+  void Resize(std::size_t _size)
+  {
+    this->x.resize(_size);
+    this->y.resize(_size);
+    this->z.resize(_size);
+  }
+
+  /// \brief X coordinates
+  std::vector<float> x;
+
+  /// \brief Y coordinates
+  std::vector<float> y;
+
+  /// \brief Z coordinates
+  std::vector<float> z;
+};
+
 class ignition::gazebo::systems::OpticalTactilePluginPrivate
 {
+  /// \brief Destructor, stops the worker thread.
+  public: ~OpticalTactilePluginPrivate();
+
   /// \brief Load the Contact sensor from an sdf element
   /// \param[in] _ecm Immutable reference to the EntityComponentManager
   public: void Load(const EntityComponentManager &_ecm);
@@ -63,25 +93,28 @@ class ignition::gazebo::systems::OpticalTactilePluginPrivate
   public: void DepthCameraCallback(
     const ignition::msgs::PointCloudPacked &_msg);
 
-  /// \brief Map the (i,j) coordinates defined in the top-left corner of the
-  /// camera into its corresponding (X,Y,Z) measurement with respect to the
-  /// camera's origin in the world frame
-  /// \param[in] _i Horizontal camera coordinate defined in the top-left corner
-  /// of the image, pointing rightwards
+  /// \brief Read the (X,Y,Z) measurements of the pixels of an image row,
+  /// with respect to the camera's origin. Pixels are read every
+  /// visualizationResolution columns.
+  /// \param[in] _msg Message from the depth camera
   /// \param[in] _j Vertical camera coordinate defined in the top-left corner
   /// of the image, pointing downwards
-  /// \param[in] _msgBuffer Buffer with the point cloud data
-  /// \returns The corresponding (X,Y,Z) point
-  public: ignition::math::Vector3f MapPointCloudData(const uint64_t &_i,
-    const uint64_t &_j, const char *_msgBuffer);
-
-  /// \brief Check if a specific point from the depth camera is inside
-  /// the contact surface.
-  /// \param[in] _point Point from the depth camera
-  public: bool PointInsideSensor(ignition::math::Vector3f _point);
+  /// \param[in] _i Horizontal camera coordinate of the first pixel, defined in
+  /// the top-left corner of the image, pointing rightwards
+  /// \param[out] _points Points, already sized to the number of pixels to
+  /// read. Points outside the sensor are set to infinity.
+  public: void GatherPoints(const ignition::msgs::PointCloudPacked &_msg,
+    uint64_t _j, uint64_t _i, PointArrays &_points) const;
+
+  /// \brief Set the points from the depth camera which aren't inside the
+  /// contact surface to infinity.
+  /// \param[in, out] _points Points from the depth camera
+  public: void MaskPointsOutsideSensor(PointArrays &_points) const;
 
   /// \brief Computes the normal forces of the Optical Tactile sensor
   /// \param[in] _msg Message from the depth camera
+  /// \param[in] _sensorWorldPose Pose of the sensor when the message was
+  /// processed
   /// \param[in] _visualizeForces Whether to visualize the forces or not
   ///
   /// Implementation inspired by
@@ -90,8 +123,13 @@ class ignition::gazebo::systems::OpticalTactilePluginPrivate
   /// using-neighboring-pixels-cross-produc
   public: void ComputeNormalForces(
     const ignition::msgs::PointCloudPacked &_msg,
+    ignition::math::Pose3f _sensorWorldPose,
     const bool _visualizeForces);
 
+  /// \brief Process depth camera messages as they arrive, until stopped.
+  /// Runs on the worker thread.
+  public: void ProcessCameraMsgs();
+
   /// \brief Resolution of the visualization in pixels to skip.
   public: int visualizationResolution{30};
 
@@ -141,10 +179,45 @@ class ignition::gazebo::systems::OpticalTactilePluginPrivate
   /// \brief Message returned by the depth camera
   public: ignition::msgs::PointCloudPacked cameraMsg;
 
-  /// \brief Mutex for variables mutated by the camera callback.
-  /// The variables are: newCameraMsg, cameraMsg.
+  /// \brief Message being processed. It's swapped with cameraMsg so the
+  /// camera callback isn't blocked while processing.
+  public: ignition::msgs::PointCloudPacked processingMsg;
+
+  /// \brief Mutex for variables shared with the camera callback and the
+  /// worker thread. The variables are: newCameraMsg, cameraMsg, stopWorker
+  /// and, when using the worker thread, tactileSensorWorldPose.
   public: std::mutex serviceMutex;
 
+  /// \brief Whether to process camera messages on the worker thread
+  public: bool useWorkerThread{false};
+
+  /// \brief Thread processing camera messages, if useWorkerThread is true
+  public: std::thread workerThread;
+
+  /// \brief Signals the worker thread about a new message or stopping
+  public: std::condition_variable workerCv;
+
+  /// \brief True to stop the worker thread
+  public: bool stopWorker{false};
+
+  /// \brief Points to the right of the sampled pixels
+  public: PointArrays rightPoints;
+
+  /// \brief Points to the left of the sampled pixels
+  public: PointArrays leftPoints;
+
+  /// \brief Points below the sampled pixels
+  public: PointArrays lowerPoints;
+
+  /// \brief Points above the sampled pixels
+  public: PointArrays upperPoints;
+
+  /// \brief Sampled points
+  public: PointArrays centerPoints;
+
+  /// \brief Normal forces at the sampled pixels
+  public: PointArrays normalForces;
+
   /// \brief If true, the plugin will draw a marker in the place of the
   /// contact sensor so it's easy to know its position
   public: bool visualizeSensor{false};
@@ -166,6 +239,18 @@ class ignition::gazebo::systems::OpticalTactilePluginPrivate
   public: bool initErrorPrinted{false};
 };
 
+//////////////////////////////////////////////////
+OpticalTactilePluginPrivate::~OpticalTactilePluginPrivate()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->serviceMutex);
+    this->stopWorker = true;
+  }
+  this->workerCv.notify_one();
+  if (this->workerThread.joinable())
+    this->workerThread.join();
+}
+
 //////////////////////////////////////////////////
 OpticalTactilePlugin::OpticalTactilePlugin()
   : System(), dataPtr(std::make_unique<OpticalTactilePluginPrivate>())
@@ -273,6 +358,9 @@ void OpticalTactilePlugin::Configure(const Entity &_entity,
       this->dataPtr->forceLength = _sdf->Get<double>("force_length");
     }
   }
+
+  this->dataPtr->useWorkerThread = _sdf->Get<bool>("worker_thread",
+    this->dataPtr->useWorkerThread).first;
 }
 
 //////////////////////////////////////////////////
@@ -312,6 +400,12 @@ void OpticalTactilePlugin::PreUpdate(const UpdateInfo &_info,
       _ecm.Component<components::Pose>(
         this->dataPtr->model.Entity())->Data();
 
+    // The worker thread reads the pose
+    std::unique_lock<std::mutex> lock(this->dataPtr->serviceMutex,
+      std::defer_lock);
+    if (this->dataPtr->useWorkerThread)
+      lock.lock();
+
     // Depth camera data is float, so convert Pose3d to Pose3f
     this->dataPtr->tactileSensorWorldPose = ignition::math::Pose3f(
       tactileSensorPose.Pos().X(),
@@ -337,18 +431,25 @@ void OpticalTactilePlugin::PostUpdate(
 
   // TODO(anyone) Get ContactSensor data and merge it with DepthCamera data
 
-  // Process camera message if it's new
+  // Process camera message if it's new, unless the worker thread does it
+  bool process{false};
+  if (!this->dataPtr->useWorkerThread)
   {
     std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
     if (this->dataPtr->newCameraMsg)
     {
-      this->dataPtr->ComputeNormalForces(this->dataPtr->cameraMsg,
-        this->dataPtr->visualizeForces);
-
+      std::swap(this->dataPtr->cameraMsg, this->dataPtr->processingMsg);
       this->dataPtr->newCameraMsg = false;
+      process = true;
     }
   }
 
+  if (process)
+  {
+    this->dataPtr->ComputeNormalForces(this->dataPtr->processingMsg,
+      this->dataPtr->tactileSensorWorldPose, this->dataPtr->visualizeForces);
+  }
+
   // Publish sensor marker if required and sensor pose has changed
   if (this->dataPtr->visualizeSensor &&
     (this->dataPtr->tactileSensorWorldPose !=
@@ -521,6 +622,12 @@ void OpticalTactilePluginPrivate::Load(const EntityComponentManager &_ecm)
       this->visualizationResolution);
 
   this->initialized = true;
+
+  if (this->useWorkerThread)
+  {
+    this->workerThread = std::thread(
+      &OpticalTactilePluginPrivate::ProcessCameraMsgs, this);
+  }
 }
 
 //////////////////////////////////////////////////
@@ -558,86 +665,99 @@ void OpticalTactilePluginPrivate::DepthCameraCallback(
     this->cameraMsg = _msg;
     this->newCameraMsg = true;
   }
+  if (this->useWorkerThread)
+    this->workerCv.notify_one();
 }
 
 //////////////////////////////////////////////////
-ignition::math::Vector3f OpticalTactilePluginPrivate::MapPointCloudData(
-  const uint64_t &_i, const uint64_t &_j, const char *_msgBuffer)
+void OpticalTactilePluginPrivate::ProcessCameraMsgs()
 {
-  IGN_PROFILE("OpticalTactilePlugin::MapPointCloudData");
-
-  // Initialize return variable
-  ignition::math::Vector3f measuredPoint(0, 0, 0);
-
-  // Nothing left to do if failed to initialize.
-  if (!this->initialized)
-    return measuredPoint;
-
-  // Save original position of the pointer
-  const char *temporaryMsgBuffer = _msgBuffer;
+  while (true)
+  {
+    ignition::math::Pose3f sensorWorldPose;
+    {
+      std::unique_lock<std::mutex> lock(this->serviceMutex);
+      this->workerCv.wait(lock, [this]
+      {
+        return this->newCameraMsg || this->stopWorker;
+      });
 
-  // Number of bytes from the beginning of the pointer (image coordinates at
-  // 0,0) to the desired (i,j) position
-  uint32_t msgBufferIndex =
-    _j*this->cameraMsg.row_step() + _i*this->cameraMsg.point_step();
+      if (this->stopWorker)
+        return;
 
-  temporaryMsgBuffer += msgBufferIndex;
-  int fieldIndex = 0;
+      // Only the latest message is processed if several arrived meanwhile
+      std::swap(this->cameraMsg, this->processingMsg);
+      this->newCameraMsg = false;
+      sensorWorldPose = this->tactileSensorWorldPose;
+    }
 
-  // X coordinate
-  measuredPoint.X() = *reinterpret_cast<const float *>(
-    temporaryMsgBuffer + this->cameraMsg.field(fieldIndex++).offset());
-  // Y coordinate
-  measuredPoint.Y() = *reinterpret_cast<const float *>(
-    temporaryMsgBuffer + this->cameraMsg.field(fieldIndex++).offset());
-  // Z coordinate
-  measuredPoint.Z() = *reinterpret_cast<const float *>(
-    temporaryMsgBuffer + this->cameraMsg.field(fieldIndex).offset());
+    this->ComputeNormalForces(this->processingMsg, sensorWorldPose,
+      this->visualizeForces);
+  }
+}
 
-  // Check if point is inside the sensor
-  bool pointInside = this->PointInsideSensor(measuredPoint);
-  if (!pointInside)
+//////////////////////////////////////////////////
+void OpticalTactilePluginPrivate::GatherPoints(
+  const ignition::msgs::PointCloudPacked &_msg, uint64_t _j, uint64_t _i,
+  PointArrays &_points) const
+{
+  // Number of bytes from the beginning of the buffer (image coordinates at
+  // 0,0) to the first pixel
+  const char *point = _msg.data().data() + _j * _msg.row_step() +
+    _i * _msg.point_step();
+  const uint64_t stride = static_cast<uint64_t>(
+    std::max(1, this->visualizationResolution)) * _msg.point_step();
+
+  const uint32_t xOffset = _msg.field(0).offset();
+  const uint32_t yOffset = _msg.field(1).offset();
+  const uint32_t zOffset = _msg.field(2).offset();
+
+  for (std::size_t k = 0; k < _points.x.size(); ++k, point += stride)
   {
-    measuredPoint.X() = ignition::math::INF_F;
-    measuredPoint.Y() = ignition::math::INF_F;
-    measuredPoint.Z() = ignition::math::INF_F;
+    std::memcpy(&_points.x[k], point + xOffset, sizeof(float));
+    std::memcpy(&_points.y[k], point + yOffset, sizeof(float));
+    std::memcpy(&_points.z[k], point + zOffset, sizeof(float));
   }
 
-  return measuredPoint;
+  this->MaskPointsOutsideSensor(_points);
 }
 
 //////////////////////////////////////////////////
-bool OpticalTactilePluginPrivate::PointInsideSensor(
-  ignition::math::Vector3f _point)
+void OpticalTactilePluginPrivate::MaskPointsOutsideSensor(
+  PointArrays &_points) const
 {
-  IGN_PROFILE("OpticalTactilePlugin::PointInsideSensor");
-
-  // Nothing left to do if failed to initialize.
-  if (!this->initialized)
-    return false;
-
   // We assume that the depth camera is placed behind the contact surface, i.e.
   // displaced in the -X direction with respect to the model's origin
-  bool insideX =
-    (_point.X() >= std::abs(this->depthCameraOffset.X()) -
-      this->extendedSensing) &&
-    (_point.X() <= (std::abs(this->depthCameraOffset.X()) +
-      this->sensorSize.X() + this->extendedSensing));
-
-  bool insideY =
-    (_point.Y() <= this->sensorSize.Y() / 2 + this->extendedSensing) &&
-    (_point.Y() >= - this->sensorSize.Y() / 2 - this->extendedSensing);
-
-  bool insideZ =
-    (_point.Z() <= this->sensorSize.Z() / 2 + this->extendedSensing) &&
-    (_point.Z() >= - this->sensorSize.Z() / 2 - this->extendedSensing);
-
-  return (insideX && insideY && insideZ);
+  const float minX = static_cast<float>(
+    std::abs(this->depthCameraOffset.X()) - this->extendedSensing);
+  const float maxX = static_cast<float>(std::abs(this->depthCameraOffset.X()) +
+    this->sensorSize.X() + this->extendedSensing);
+  const float maxY =
+    static_cast<float>(this->sensorSize.Y() / 2 + this->extendedSensing);
+  const float maxZ =
+    static_cast<float>(this->sensorSize.Z() / 2 + this->extendedSensing);
+  const float inf = ignition::math::INF_F;
+
+  float *x = _points.x.data();
+  float *y = _points.y.data();
+  float *z = _points.z.data();
+  const std::size_t size = _points.x.size();
+
+  // Branchless, so the compiler can vectorize it
+  for (std::size_t k = 0; k < size; ++k)
+  {
+    const bool inside = (x[k] >= minX) & (x[k] <= maxX) &
+      (y[k] <= maxY) & (y[k] >= -maxY) & (z[k] <= maxZ) & (z[k] >= -maxZ);
+    x[k] = inside ? x[k] : inf;
+    y[k] = inside ? y[k] : inf;
+    z[k] = inside ? z[k] : inf;
+  }
 }
 
 //////////////////////////////////////////////////
 void OpticalTactilePluginPrivate::ComputeNormalForces(
   const ignition::msgs::PointCloudPacked &_msg,
+  ignition::math::Pose3f _sensorWorldPose,
   const bool _visualizeForces)
 {
   IGN_PROFILE("OpticalTactilePlugin::ComputeNormalForces");
@@ -646,51 +766,75 @@ void OpticalTactilePluginPrivate::ComputeNormalForces(
   if (!this->initialized)
     return;
 
-  // Get data from the message
-  const char *msgBuffer = _msg.data().data();
+  // We don't get the image's edges because there are no adjacent points to
+  // compute the forces
+  if (_msg.height() < 3 || _msg.width() < 3 || _msg.field_size() < 3 ||
+      _msg.data().size() <
+      static_cast<std::size_t>(_msg.height()) * _msg.row_step())
+  {
+    return;
+  }
 
-  // Declare variables for storing the XYZ points
-  ignition::math::Vector3f p1, p2, p3, p4, markerPosition;
+  const uint64_t step = std::max(1, this->visualizationResolution);
+  const std::size_t columns = (_msg.width() - 3) / step + 1;
+  for (auto *points : {&this->rightPoints, &this->leftPoints,
+      &this->lowerPoints, &this->upperPoints, &this->centerPoints,
+      &this->normalForces})
+  {
+    points->Resize(columns);
+  }
 
   // Marker messages representing the normal forces
   ignition::msgs::Marker positionMarkerMsg;
   ignition::msgs::Marker forceMarkerMsg;
 
-  // We don't get the image's edges because there are no adjacent points to
-  // compute the forces
-  for (uint64_t j = 1; j < (_msg.height() - 1);
-      j += this->visualizationResolution)
+  for (uint64_t j = 1; j < (_msg.height() - 1); j += step)
   {
-    for (uint64_t i = 1; i < (_msg.width() - 1);
-        i += this->visualizationResolution)
+    // Get points for computing normal forces, for the whole row at once
+    this->GatherPoints(_msg, j, 2, this->rightPoints);
+    this->GatherPoints(_msg, j, 0, this->leftPoints);
+    this->GatherPoints(_msg, j + 1, 1, this->lowerPoints);
+    this->GatherPoints(_msg, j - 1, 1, this->upperPoints);
+
+    const float *p1x = this->rightPoints.x.data();
+    const float *p1y = this->rightPoints.y.data();
+    const float *p2x = this->leftPoints.x.data();
+    const float *p2y = this->leftPoints.y.data();
+    const float *p3x = this->lowerPoints.x.data();
+    const float *p3z = this->lowerPoints.z.data();
+    const float *p4x = this->upperPoints.x.data();
+    const float *p4z = this->upperPoints.z.data();
+    float *nx = this->normalForces.x.data();
+    float *ny = this->normalForces.y.data();
+    float *nz = this->normalForces.z.data();
+
+    // Normalized (-1, -dxdi, -dxdj). Its length is never below 1, so there's
+    // no need to check for zero.
+    for (std::size_t k = 0; k < columns; ++k)
     {
-      // Get points for computing normal forces
-      p1 = this->MapPointCloudData(i + 1, j, msgBuffer);
-      p2 = this->MapPointCloudData(i - 1, j, msgBuffer);
-      p3 = this->MapPointCloudData(i, j + 1, msgBuffer);
-      p4 = this->MapPointCloudData(i, j - 1, msgBuffer);
-
-      float dxdi = (p1.X() - p2.X()) / std::abs(p1.Y() - p2.Y());
-      float dxdj =  (p3.X() - p4.X()) / std::abs(p3.Z() - p4.Z());
-
-      ignition::math::Vector3f direction(-1, -dxdi, -dxdj);
-
-      // todo(anyone) multiply vector by contact forces info
+      const float dxdi = (p1x[k] - p2x[k]) / std::abs(p1y[k] - p2y[k]);
+      const float dxdj = (p3x[k] - p4x[k]) / std::abs(p3z[k] - p4z[k]);
+      const float length = std::sqrt(1.0f + dxdi * dxdi + dxdj * dxdj);
+      nx[k] = -1.0f / length;
+      ny[k] = -dxdi / length;
+      nz[k] = -dxdj / length;
+    }
 
-      // todo(anyone) Replace with MatrixX and use vector multiplication instead
-      // of for-loops once the following issue is completed:
-      // https://github.com/ignitionrobotics/ign-math/issues/144
-      ignition::math::Vector3f normalForce = direction.Normalized();
+    // todo(anyone) multiply vector by contact forces info
 
-      // todo(mcres) Normal forces are computed even if visualization
-      // is turned off. These forces should be published in the future.
-      if (!_visualizeForces)
-        continue;
+    // todo(mcres) Normal forces are computed even if visualization
+    // is turned off. These forces should be published in the future.
+    if (!_visualizeForces)
+      continue;
 
-      markerPosition = this->MapPointCloudData(i, j, msgBuffer);
+    this->GatherPoints(_msg, j, 1, this->centerPoints);
+    for (std::size_t k = 0; k < columns; ++k)
+    {
+      ignition::math::Vector3f markerPosition(this->centerPoints.x[k],
+        this->centerPoints.y[k], this->centerPoints.z[k]);
+      ignition::math::Vector3f normalForce(nx[k], ny[k], nz[k]);
       this->visualizePtr->AddNormalForceToMarkerMsgs(positionMarkerMsg,
-        forceMarkerMsg, markerPosition, normalForce,
-        this->tactileSensorWorldPose);
+        forceMarkerMsg, markerPosition, normalForce, _sensorWorldPose);
     }
   }
 
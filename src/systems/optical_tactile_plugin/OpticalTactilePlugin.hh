@@ -65,6 +65,12 @@ namespace systems
     ///
     /// <visualize_sensor> Whether to visualize the sensor or not. This element
     /// is optional, and the default value is false.
+    ///
+    /// <worker_thread> Set this to true to compute the normal forces on a
+    /// separate thread as depth images arrive, instead of during the
+    /// simulation step. Only the latest image is processed if several arrive
+    /// while the previous one is being processed. This element is optional,
+    /// and the default value is false.
 
     class IGNITION_GAZEBO_VISIBLE OpticalTactilePlugin :
       public System,
@@ -17,6 +17,9 @@
 
 #include <ignition/msgs/pose.pb.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <ignition/common/Profiler.hh>
 #include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/Vector3.hh>
@@ -27,6 +30,7 @@
 #include <sdf/Geometry.hh>
 
 #include "ignition/gazebo/Model.hh"
+#include "ignition/gazebo/SpatialIndex.hh"
 #include "ignition/gazebo/Util.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Model.hh"
@@ -159,45 +163,66 @@ void PerformerDetector::PostUpdate(
   auto region = this->detectorGeometry -
     (-(modelPose.Pos() + modelPose.Rot() * this->poseOffset.Pos()));
 
-  _ecm.Each<components::Performer, components::Geometry,
-            components::ParentEntity>(
-      [&](const Entity &_entity, const components::Performer *,
-          const components::Geometry *_geometry,
-          const components::ParentEntity *_parent) -> bool
+  if (!this->modelIndex)
+    this->modelIndex = SpatialIndex::Models(_ecm);
+  this->modelIndex->UpdateModels(_info, _ecm);
+
+  // Only check the performers which may be in the region, and those which
+  // were detected before, since they may have left it
+  std::vector<Entity> candidates = this->modelIndex->Query(region);
+  candidates.insert(candidates.end(), this->detectedEntities.begin(),
+      this->detectedEntities.end());
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+      candidates.end());
+
+  for (auto entity : candidates)
+  {
+    // The index also holds models
+    auto geometry = _ecm.Component<components::Geometry>(entity);
+    auto parent = _ecm.Component<components::ParentEntity>(entity);
+    if (nullptr == _ecm.Component<components::Performer>(entity) ||
+        nullptr == geometry || nullptr == parent)
+    {
+      continue;
+    }
+
+    auto poseComp = _ecm.Component<components::Pose>(parent->Data());
+    auto nameComp = _ecm.Component<components::Name>(parent->Data());
+    if (nullptr == poseComp || nullptr == nameComp)
+      continue;
+
+    const auto &pose = poseComp->Data();
+    const auto &name = nameComp->Data();
+    const math::Pose3d relPose = modelPose.Inverse() * pose;
+
+    // We assume the geometry contains a box.
+    auto perfBox = geometry->Data().BoxShape();
+    if (nullptr == perfBox)
+    {
+      ignerr << "Internal error: geometry of performer [" << entity
+             << "] missing box." << std::endl;
+      continue;
+    }
+
+    math::AxisAlignedBox performerVolume{pose.Pos() - perfBox->Size() / 2,
+                                         pose.Pos() + perfBox->Size() / 2};
+
+    bool alreadyDetected = this->IsAlreadyDetected(entity);
+    if (region.Intersects(performerVolume))
+    {
+      if (!alreadyDetected)
       {
-        auto pose = _ecm.Component<components::Pose>(_parent->Data())->Data();
-        auto name = _ecm.Component<components::Name>(_parent->Data())->Data();
-        const math::Pose3d relPose = modelPose.Inverse() * pose;
-
-        // We assume the geometry contains a box.
-        auto perfBox = _geometry->Data().BoxShape();
-        if (nullptr == perfBox)
-        {
-          ignerr << "Internal error: geometry of performer [" << _entity
-                 << "] missing box." << std::endl;
-          return true;
-        }
-
-        math::AxisAlignedBox performerVolume{pose.Pos() - perfBox->Size() / 2,
-                                             pose.Pos() + perfBox->Size() / 2};
-
-        bool alreadyDetected = this->IsAlreadyDetected(_entity);
-        if (region.Intersects(performerVolume))
-        {
-          if (!alreadyDetected)
-          {
-            this->AddToDetected(_entity);
-            this->Publish(_entity, name, true, relPose, _info.simTime);
-          }
-        }
-        else if (alreadyDetected)
-        {
-          this->RemoveFromDetected(_entity);
-          this->Publish(_entity, name, false, relPose, _info.simTime);
-        }
-
-        return true;
-      });
+        this->AddToDetected(entity);
+        this->Publish(entity, name, true, relPose, _info.simTime);
+      }
+    }
+    else if (alreadyDetected)
+    {
+      this->RemoveFromDetected(entity);
+      this->Publish(entity, name, false, relPose, _info.simTime);
+    }
+  }
 }
 
 //////////////////////////////////////////////////
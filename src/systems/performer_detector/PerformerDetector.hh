@@ -26,6 +26,7 @@
 #include <ignition/transport/Node.hh>
 
 #include "ignition/gazebo/Model.hh"
+#include "ignition/gazebo/SpatialIndex.hh"
 #include "ignition/gazebo/System.hh"
 
 namespace ignition
@@ -145,6 +146,10 @@ namespace systems
 
     /// \brief Optional extra header data.
     private: std::map<std::string, std::string> extraHeaderData;
+
+    /// \brief Index of the world's models and performers, shared with other
+    /// systems
+    private: std::shared_ptr<SpatialIndex> modelIndex;
   };
 
   }
@@ -19,22 +19,35 @@
 
 #include <ignition/msgs/contact.pb.h>
 #include <ignition/msgs/contacts.pb.h>
+#include <ignition/msgs/double_v.pb.h>
 #include <ignition/msgs/entity.pb.h>
 #include <ignition/msgs/Utility.hh>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <iostream>
-#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include <ignition/common/ColladaLoader.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Mesh.hh>
 #include <ignition/common/MeshManager.hh>
+#include <ignition/common/OBJLoader.hh>
 #include <ignition/common/Profiler.hh>
+#include <ignition/common/STLLoader.hh>
 #include <ignition/common/SystemPaths.hh>
+#include <ignition/common/WorkerPool.hh>
 #include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/eigen3/Conversions.hh>
+#include <ignition/math/Helpers.hh>
 #include <ignition/math/Vector3.hh>
 #include <ignition/physics/config.hh>
 #include <ignition/physics/FeatureList.hh>
@@ -65,6 +78,7 @@
 #include <ignition/plugin/Loader.hh>
 #include <ignition/plugin/PluginPtr.hh>
 #include <ignition/plugin/Register.hh>
+#include <ignition/transport/Node.hh>
 
 // SDF
 #include <sdf/Collision.hh>
@@ -76,6 +90,8 @@
 #include <sdf/World.hh>
 
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/Events.hh"
+#include "ignition/gazebo/ParallelTasks.hh"
 #include "ignition/gazebo/Util.hh"
 
 // Components
@@ -87,6 +103,7 @@
 #include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/ChildLinkName.hh"
 #include "ignition/gazebo/components/Collision.hh"
+#include "ignition/gazebo/components/ContactChanges.hh"
 #include "ignition/gazebo/components/ContactSensorData.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Gravity.hh"
@@ -110,6 +127,7 @@
 #include "ignition/gazebo/components/ParentLinkName.hh"
 #include "ignition/gazebo/components/ExternalWorldWrenchCmd.hh"
 #include "ignition/gazebo/components/JointForceCmd.hh"
+#include "ignition/gazebo/components/Physics.hh"
 #include "ignition/gazebo/components/PhysicsEnginePlugin.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/PoseCmd.hh"
@@ -170,6 +188,26 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// \param[in] _ecm Constant reference to ECM.
   public: void CreatePhysicsEntities(const EntityComponentManager &_ecm);
 
+  /// \brief Call a function for each entity with the given components which
+  /// is either new this iteration and not deferred, or whose deferred
+  /// creation became ready this iteration.
+  /// \param[in] _ecm Constant reference to ECM.
+  /// \param[in] _f Function with the same signature as for ECM::EachNew.
+  public: template <typename ...ComponentTypeTs, typename FunctionT>
+          void EachNewOrReady(const EntityComponentManager &_ecm,
+              FunctionT _f);
+
+  /// \brief Get the mesh for a mesh geometry, loading it the first time.
+  /// \param[in] _meshSdf Mesh geometry.
+  /// \return The mesh, or nullptr if it couldn't be loaded.
+  public: const common::Mesh *CachedMesh(const sdf::Mesh &_meshSdf);
+
+  /// \brief When creation is asynchronous, hold back new subtrees which
+  /// have mesh collisions that aren't loaded yet, start loading those meshes
+  /// on the creation pool, and release subtrees whose meshes are done.
+  /// \param[in] _ecm Constant reference to ECM.
+  public: void DeferMeshSubtrees(const EntityComponentManager &_ecm);
+
   /// \brief Remove physics entities if they are removed from the ECM
   /// \param[in] _ecm Constant reference to ECM.
   public: void RemovePhysicsEntities(const EntityComponentManager &_ecm);
@@ -178,6 +216,19 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// \param[in] _ecm Mutable reference to ECM.
   public: void UpdatePhysics(EntityComponentManager &_ecm);
 
+  /// \brief Update AxisAlignedBox components of models which moved since
+  /// their box was last computed, at most at boundingBoxUpdateRate.
+  /// \param[in] _info Current simulation information.
+  /// \param[in] _ecm Mutable reference to ECM.
+  public: void UpdateBoundingBoxes(const UpdateInfo &_info,
+      EntityComponentManager &_ecm);
+
+  /// \brief Apply commands which are held for the whole iteration, such as
+  /// joint forces and link wrenches. Engines clear these after each step,
+  /// so they're applied again before every sub-step.
+  /// \param[in] _ecm Constant reference to ECM.
+  public: void ApplyHeldCommands(const EntityComponentManager &_ecm);
+
   /// \brief Step the simulation for each world
   /// \param[in] _dt Duration
   public: void Step(const std::chrono::steady_clock::duration &_dt);
@@ -191,11 +242,12 @@ class ignition::gazebo::systems::PhysicsPrivate
   public: void UpdateCollisions(EntityComponentManager &_ecm);
 
   /// \brief FrameData relative to world at a given offset pose
-  /// \param[in] _link ign-physics link
+  /// \param[in] _linkFrameData Frame data of a link relative to world
   /// \param[in] _pose Offset pose in which to compute the frame data
   /// \returns FrameData at the given offset pose
   public: physics::FrameData3d LinkFrameDataAtOffset(
-      const LinkPtrType &_link, const math::Pose3d &_pose) const;
+      const physics::FrameData3d &_linkFrameData,
+      const math::Pose3d &_pose) const;
 
   /// \brief Get transform from one ancestor entity to a descendant entity
   /// that are in the same model.
@@ -212,14 +264,9 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// \brief Keep track of what entities are static (models and links).
   public: std::unordered_set<Entity> staticEntities;
 
-  /// \brief Keep track of poses for links attached to non-static models.
-  /// This allows for skipping pose updates if a link's pose didn't change
-  /// after a physics step.
-  public: std::unordered_map<Entity, ignition::math::Pose3d> linkWorldPoses;
-
-  /// \brief A map between model entity ids in the ECM to whether its battery
-  /// has drained.
-  public: std::unordered_map<Entity, bool> entityOffMap;
+  /// \brief Models whose battery has drained. It's usually empty, so joints
+  /// only look up their model when some battery has drained.
+  public: std::unordered_set<Entity> drainedModels;
 
   /// \brief Entities whose pose commands have been processed and should be
   /// deleted the following iteration.
@@ -228,6 +275,195 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// \brief used to store whether physics objects have been created.
   public: bool initialized = false;
 
+  /// \brief A contact point between two collisions, as gathered by
+  /// UpdateCollisions.
+  public: struct ContactEntry
+  {
+    /// \brief Collision which has a ContactSensorData component.
+    Entity collision1{kNullEntity};
+
+    /// \brief The other collision.
+    Entity collision2{kNullEntity};
+
+    /// \brief Order in which the engine reported the contact, used to keep
+    /// points in that order after sorting.
+    std::size_t order{0};
+
+    /// \brief Contact position in world frame.
+    Eigen::Vector3d point;
+  };
+
+  /// \brief Contacts of the last step, sorted by collision pair. Cleared
+  /// and refilled by UpdateCollisions, keeping its capacity.
+  public: std::vector<ContactEntry> contactArena;
+
+  /// \brief Sorted collisions which have a ContactSensorData component.
+  /// Refilled by UpdateCollisions, keeping its capacity.
+  public: std::vector<Entity> contactSensorCollisions;
+
+  /// \brief Collisions touched by one collision, used by UpdateCollisions
+  /// to fill ContactChanges components, keeping its capacity.
+  public: std::vector<Entity> contactTouching;
+
+  /// \brief Whether to step worlds concurrently. Set from the
+  /// `<parallel_step>` SDF element.
+  public: bool parallelStep = false;
+
+  /// \brief Pool used to step worlds concurrently, created the first time
+  /// there is more than one world to step.
+  public: std::unique_ptr<common::WorkerPool> stepPool;
+
+  /// \brief Number of steps a link's pose must stay unchanged before it's
+  /// considered asleep and UpdateSim stops polling it. Zero disables
+  /// sleeping. Set from the `<sleep_steps>` SDF element.
+  public: unsigned int sleepSteps = 0;
+
+  /// \brief Number of links currently asleep.
+  public: std::size_t sleepingLinkCount = 0;
+
+  /// \brief Maximum rate in Hz at which AxisAlignedBox components are
+  /// updated, in sim time. Zero updates them every iteration. Set from the
+  /// `<bounding_box_update_rate>` SDF element.
+  public: double boundingBoxUpdateRate = 0.0;
+
+  /// \brief Sim time of the last AxisAlignedBox update.
+  public: std::chrono::steady_clock::duration lastBoundingBoxUpdate{0};
+
+  /// \brief Whether some model has an AxisAlignedBox component, so moved
+  /// models are tracked.
+  public: bool trackBoundingBoxes = false;
+
+  /// \brief Top level models which moved since AxisAlignedBox components
+  /// were last updated.
+  public: std::unordered_set<Entity> movedModels;
+
+  /// \brief Last box computed for each model with an AxisAlignedBox. A
+  /// model is computed again if it moved, or if its component no longer
+  /// holds this box.
+  public: std::unordered_map<Entity, math::AxisAlignedBox> boundingBoxes;
+
+  /// \brief Phases of an iteration whose wall time is accumulated when
+  /// timing is published, in the order they're published.
+  public: enum TimingPhase
+  {
+    TIMING_UPDATE_PHYSICS = 0,
+    TIMING_STEP,
+    TIMING_UPDATE_SIM,
+    TIMING_UPDATE_COLLISIONS,
+    TIMING_PHASE_COUNT
+  };
+
+  /// \brief Whether to publish the wall time spent in each phase. Set from
+  /// the `<publish_timing>` SDF element.
+  public: bool publishTiming = false;
+
+  /// \brief Number of iterations timed so far.
+  public: uint64_t timedIterations = 0;
+
+  /// \brief Accumulated wall time spent in each phase.
+  public: std::array<std::chrono::steady_clock::duration, TIMING_PHASE_COUNT>
+      phaseTimes{};
+
+  /// \brief Node used to publish timing.
+  public: transport::Node node;
+
+  /// \brief Publisher of timing.
+  public: transport::Node::Publisher timingPub;
+
+  /// \brief Number of physics steps per iteration, each advancing an equal
+  /// part of the iteration's time step. Set from the `<substeps>` SDF
+  /// element.
+  public: unsigned int substeps = 1;
+
+  /// \brief Whether to request smaller steps while the world is busy. Set
+  /// from the `<adaptive_step>` SDF element.
+  public: bool adaptiveStep = false;
+
+  /// \brief Smallest step which may be requested.
+  public: std::chrono::steady_clock::duration minStepSize{
+      std::chrono::microseconds(100)};
+
+  /// \brief Number of contacts from which the step shrinks, 0 to ignore
+  /// contacts.
+  public: std::size_t contactThreshold = 0;
+
+  /// \brief Link speed in m/s from which the step shrinks, 0 to ignore
+  /// velocities.
+  public: double velocityThreshold = 0.0;
+
+  /// \brief Factor applied to the step while the world is busy.
+  public: double shrinkFactor = 0.5;
+
+  /// \brief Factor applied to the step after quietSteps quiet iterations.
+  public: double growFactor = 2.0;
+
+  /// \brief Number of consecutive quiet iterations before growing the
+  /// step.
+  public: unsigned int quietSteps = 10;
+
+  /// \brief Consecutive quiet iterations so far.
+  public: unsigned int quietCount = 0;
+
+  /// \brief Step last requested, zero while using the world's step.
+  public: std::chrono::steady_clock::duration requestedStepSize{0};
+
+  /// \brief Event manager used to request step sizes.
+  public: EventManager *eventMgr = nullptr;
+
+  /// \brief Request a smaller or larger step for the next iterations,
+  /// based on the contacts and link velocities of the last step.
+  /// \param[in] _info Info of the current iteration.
+  /// \param[in] _ecm Constant reference to ECM.
+  public: void UpdateStepSize(const UpdateInfo &_info,
+      const EntityComponentManager &_ecm);
+
+  /// \brief Meshes used by collisions, keyed by URI and the path of the
+  /// file which referenced it. Repeated meshes, such as those of many copies
+  /// of one model, skip the path resolution and file search done by the mesh
+  /// manager. Meshes which failed to load are cached as nullptr, so they're
+  /// only attempted and reported once.
+  public: std::unordered_map<std::string, const common::Mesh *> meshCache;
+
+  /// \brief Whether meshes of newly spawned subtrees are loaded off the
+  /// simulation thread. Set from the `<async_creation>` SDF element.
+  public: bool asyncCreation = false;
+
+  /// \brief A subtree whose creation is held back until its meshes are
+  /// loaded.
+  public: struct DeferredSubtree
+  {
+    /// \brief Meshes still being loaded.
+    std::unordered_set<std::string> meshes;
+
+    /// \brief Entities held back, including the root.
+    std::vector<Entity> entities;
+  };
+
+  /// \brief Deferred subtrees, keyed by their root. The root is a new top
+  /// level model, or a new collision on a model which already exists.
+  public: std::unordered_map<Entity, DeferredSubtree> deferredSubtrees;
+
+  /// \brief Entities held back, mapped to the root of their subtree.
+  public: std::unordered_map<Entity, Entity> deferredEntities;
+
+  /// \brief Entities whose deferred creation is ready this iteration, sorted
+  /// so that parents come before children.
+  public: std::vector<Entity> readyEntities;
+
+  /// \brief Mesh files being loaded on the creation pool.
+  public: std::unordered_set<std::string> loadingMeshes;
+
+  /// \brief Protects loadedMeshes.
+  public: std::mutex loadedMeshesMutex;
+
+  /// \brief Meshes loaded by the creation pool and not yet handed to the
+  /// mesh manager. A null mesh means loading failed.
+  public: std::vector<std::pair<std::string, common::Mesh *>> loadedMeshes;
+
+  /// \brief Pool which loads meshes for asynchronous creation. Declared
+  /// after the members its work uses, so it's destroyed first.
+  public: std::unique_ptr<common::WorkerPool> creationPool;
+
   /// \brief Pointer to the underlying ign-physics Engine entity.
   public: EnginePtrType engine = nullptr;
 
@@ -409,6 +645,70 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// ign-physics.
   public: EntityLinkMap entityLinkMap;
 
+  /// \brief Everything UpdateSim needs to know about a link, cached when the
+  /// link is created so that the per-step pass over links doesn't need any
+  /// map lookups.
+  public: struct LinkRecord
+  {
+    /// \brief Link entity.
+    Entity entity{kNullEntity};
+
+    /// \brief Parent entity of the link.
+    Entity parent{kNullEntity};
+
+    /// \brief Top level model containing the link.
+    Entity topLevelModel{kNullEntity};
+
+    /// \brief Link in the physics engine.
+    EntityLinkMap::RequiredEntityPtr link;
+
+    /// \brief Whether the link belongs to a static model.
+    bool isStatic{false};
+
+    /// \brief Whether this is the canonical link of its model.
+    bool canonical{false};
+
+    /// \brief Whether worldPose has been set.
+    bool hasWorldPose{false};
+
+    /// \brief Whether the link is asleep, see PhysicsPrivate::sleepSteps.
+    bool asleep{false};
+
+    /// \brief Whether the link's frame data was read back this step.
+    bool polled{true};
+
+    /// \brief Number of consecutive steps the link has been at rest.
+    unsigned int restingSteps{0};
+
+    /// \brief World pose of the link after the last step. This allows for
+    /// skipping pose updates if a link's pose didn't change after a step.
+    math::Pose3d worldPose;
+  };
+
+  /// \brief Dense list of links, iterated by UpdateSim.
+  public: std::vector<LinkRecord> linkRecords;
+
+  /// \brief Index of each link entity in linkRecords.
+  public: std::unordered_map<Entity, std::size_t> linkRecordIndices;
+
+  /// \brief Frame data relative to world of each link, in the same order as
+  /// linkRecords. Filled once per step by UpdateSim and kept around to avoid
+  /// reallocating it.
+  public: std::vector<physics::FrameData3d> linkFrameData;
+
+  /// \brief Remove a link from linkRecords.
+  /// \param[in] _entity Link entity.
+  public: void RemoveLinkRecord(const Entity _entity);
+
+  /// \brief Wake a sleeping link so it's polled every step again.
+  /// \param[in] _record Record of the link.
+  public: void WakeLink(LinkRecord &_record);
+
+  /// \brief Wake sleeping links which are touched by an awake body, or
+  /// whose model received a command this step.
+  /// \param[in] _ecm Constant reference to ECM.
+  public: void WakeSleepingLinks(const EntityComponentManager &_ecm);
+
   /// \brief Joint EntityFeatureMap
   public: using EntityJointMap = EntityFeatureMap3d<
             physics::Joint,
@@ -421,6 +721,30 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// ign-physics
   public: EntityJointMap entityJointMap;
 
+  /// \brief A joint whose state is copied to JointPosition and
+  /// JointVelocity components by UpdateSim.
+  public: struct JointRecord
+  {
+    /// \brief Joint entity.
+    Entity entity{kNullEntity};
+
+    /// \brief Joint in the physics engine.
+    EntityJointMap::RequiredEntityPtr joint;
+
+    /// \brief Number of degrees of freedom of the joint.
+    std::size_t dofs{0};
+  };
+
+  /// \brief Dense list of joints, iterated by UpdateSim.
+  public: std::vector<JointRecord> jointRecords;
+
+  /// \brief Index of each joint entity in jointRecords.
+  public: std::unordered_map<Entity, std::size_t> jointRecordIndices;
+
+  /// \brief Remove a joint from jointRecords.
+  /// \param[in] _entity Joint entity.
+  public: void RemoveJointRecord(const Entity _entity);
+
   /// \brief Collision EntityFeatureMap
   public: using EntityCollisionMap = EntityFeatureMap3d<
             physics::Shape,
@@ -455,7 +779,7 @@ Physics::Physics() : System(), dataPtr(std::make_unique<PhysicsPrivate>())
 void Physics::Configure(const Entity &_entity,
     const std::shared_ptr<const sdf::Element> &_sdf,
     EntityComponentManager &_ecm,
-    EventManager &/*_eventMgr*/)
+    EventManager &_eventMgr)
 {
   std::string pluginLib;
 
@@ -473,6 +797,51 @@ void Physics::Configure(const Entity &_entity,
     pluginLib = engineElem->Get<std::string>("filename", pluginLib).first;
   }
 
+  this->dataPtr->parallelStep =
+      _sdf->Get<bool>("parallel_step", false).first;
+  this->dataPtr->sleepSteps =
+      _sdf->Get<unsigned int>("sleep_steps", 0u).first;
+  this->dataPtr->asyncCreation =
+      _sdf->Get<bool>("async_creation", false).first;
+  this->dataPtr->substeps =
+      std::max(1u, _sdf->Get<unsigned int>("substeps", 1u).first);
+  this->dataPtr->boundingBoxUpdateRate = std::max(0.0,
+      _sdf->Get<double>("bounding_box_update_rate", 0.0).first);
+
+  if (_sdf->HasElement("adaptive_step"))
+  {
+    auto sdfClone = _sdf->Clone();
+    auto adaptiveElem = sdfClone->GetElement("adaptive_step");
+    this->dataPtr->adaptiveStep = true;
+    this->dataPtr->eventMgr = &_eventMgr;
+    auto minStep = adaptiveElem->Get<double>("min_step_size", 0.0001).first;
+    this->dataPtr->minStepSize = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(std::max(1e-9, minStep)));
+    this->dataPtr->contactThreshold = adaptiveElem->Get<unsigned int>(
+        "contact_threshold", 0u).first;
+    this->dataPtr->velocityThreshold = std::max(0.0,
+        adaptiveElem->Get<double>("velocity_threshold", 0.0).first);
+    this->dataPtr->shrinkFactor = math::clamp(
+        adaptiveElem->Get<double>("shrink_factor", 0.5).first, 0.01, 1.0);
+    this->dataPtr->growFactor = std::max(1.0,
+        adaptiveElem->Get<double>("grow_factor", 2.0).first);
+    this->dataPtr->quietSteps = std::max(1u,
+        adaptiveElem->Get<unsigned int>("quiet_steps", 10u).first);
+  }
+
+  this->dataPtr->publishTiming =
+      _sdf->Get<bool>("publish_timing", false).first;
+  auto worldName = _ecm.Component<components::Name>(_entity);
+  if (this->dataPtr->publishTiming && worldName)
+  {
+    const std::string topic = "/world/" + worldName->Data() +
+        "/physics/timing";
+    this->dataPtr->timingPub =
+        this->dataPtr->node.Advertise<msgs::Double_V>(topic);
+    igndbg << "Publishing physics timing on [" << topic << "]" << std::endl;
+  }
+
   // 3. Use DART by default
   if (pluginLib.empty())
   {
@@ -582,14 +951,61 @@ void Physics::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
 
   if (this->dataPtr->engine)
   {
+    // Accumulate the wall time of a phase if timing is being published
+    const bool timing = this->dataPtr->publishTiming;
+    auto phaseStart = std::chrono::steady_clock::now();
+    auto endPhase = [&](PhysicsPrivate::TimingPhase _phase)
+    {
+      if (!timing)
+        return;
+      const auto now = std::chrono::steady_clock::now();
+      this->dataPtr->phaseTimes[_phase] += now - phaseStart;
+      phaseStart = now;
+    };
+
     this->dataPtr->CreatePhysicsEntities(_ecm);
     this->dataPtr->UpdatePhysics(_ecm);
+    this->dataPtr->UpdateBoundingBoxes(_info, _ecm);
+    endPhase(PhysicsPrivate::TIMING_UPDATE_PHYSICS);
+
     // Only step if not paused.
     if (!_info.paused)
     {
-      this->dataPtr->Step(_info.dt);
+      // Components are only read before the first sub-step and written
+      // after the last one. The last sub-step absorbs the remainder of the
+      // division.
+      const auto substeps = this->dataPtr->substeps;
+      const auto dt = _info.dt / substeps;
+      for (unsigned int i = 0; i + 1 < substeps; ++i)
+      {
+        this->dataPtr->Step(dt);
+        this->dataPtr->ApplyHeldCommands(_ecm);
+      }
+      this->dataPtr->Step(_info.dt - dt * (substeps - 1));
     }
+    endPhase(PhysicsPrivate::TIMING_STEP);
+
     this->dataPtr->UpdateSim(_ecm);
+    endPhase(PhysicsPrivate::TIMING_UPDATE_SIM);
+
+    if (this->dataPtr->adaptiveStep && !_info.paused)
+      this->dataPtr->UpdateStepSize(_info, _ecm);
+
+    // TODO(louise) Skip this if there are no collision features
+    this->dataPtr->UpdateCollisions(_ecm);
+    endPhase(PhysicsPrivate::TIMING_UPDATE_COLLISIONS);
+
+    if (timing)
+    {
+      ++this->dataPtr->timedIterations;
+      msgs::Double_V msg;
+      msg.add_data(static_cast<double>(this->dataPtr->timedIterations));
+      for (const auto &phaseTime : this->dataPtr->phaseTimes)
+      {
+        msg.add_data(std::chrono::duration<double>(phaseTime).count());
+      }
+      this->dataPtr->timingPub.Publish(msg);
+    }
 
     // Entities scheduled to be removed should be removed from physics after the
     // simulation step. Otherwise, since the to-be-removed entity still shows up
@@ -598,11 +1014,219 @@ void Physics::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
   }
 }
 
+//////////////////////////////////////////////////
+template <typename ...ComponentTypeTs, typename FunctionT>
+void PhysicsPrivate::EachNewOrReady(const EntityComponentManager &_ecm,
+    FunctionT _f)
+{
+  bool keepGoing{true};
+  _ecm.EachNew<ComponentTypeTs...>(
+      [&](const Entity &_entity,
+          const ComponentTypeTs *..._components) -> bool
+      {
+        if (!this->deferredEntities.empty() &&
+            this->deferredEntities.find(_entity) !=
+            this->deferredEntities.end())
+        {
+          return true;
+        }
+        keepGoing = _f(_entity, _components...);
+        return keepGoing;
+      });
+
+  if (!keepGoing)
+    return;
+
+  for (const Entity entity : this->readyEntities)
+  {
+    if (!(... && (nullptr != _ecm.Component<ComponentTypeTs>(entity))))
+      continue;
+
+    if (!_f(entity, _ecm.Component<ComponentTypeTs>(entity)...))
+      break;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check whether a wrench command applies no force nor torque.
+/// \param[in] _wrench Wrench command.
+/// \return True if all its values are zero, or if it has none.
+static bool isZeroWrench(const msgs::Wrench &_wrench)
+{
+  const auto &force = _wrench.force();
+  const auto &torque = _wrench.torque();
+  return force.x() == 0.0 && force.y() == 0.0 && force.z() == 0.0 &&
+      torque.x() == 0.0 && torque.y() == 0.0 && torque.z() == 0.0;
+}
+
+//////////////////////////////////////////////////
+/// \brief Load a mesh file without going through the mesh manager, so it
+/// can be done from any thread.
+/// \param[in] _path Full path to the mesh file.
+/// \return The mesh, or nullptr if it couldn't be loaded.
+static common::Mesh *loadMeshFile(const std::string &_path)
+{
+  std::string extension = _path.substr(_path.rfind('.') + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      ::tolower);
+
+  common::Mesh *mesh{nullptr};
+  if (extension == "dae")
+    mesh = common::ColladaLoader().Load(_path);
+  else if (extension == "stl" || extension == "stlb" || extension == "stla")
+    mesh = common::STLLoader().Load(_path);
+  else if (extension == "obj")
+    mesh = common::OBJLoader().Load(_path);
+
+  if (nullptr != mesh)
+    mesh->SetName(_path);
+  return mesh;
+}
+
+//////////////////////////////////////////////////
+const common::Mesh *PhysicsPrivate::CachedMesh(const sdf::Mesh &_meshSdf)
+{
+  const std::string key = _meshSdf.Uri() + '\n' + _meshSdf.FilePath();
+  auto it = this->meshCache.find(key);
+  if (it != this->meshCache.end())
+    return it->second;
+
+  auto &meshManager = *ignition::common::MeshManager::Instance();
+  auto fullPath = asFullPath(_meshSdf.Uri(), _meshSdf.FilePath());
+  const common::Mesh *mesh = meshManager.Load(fullPath);
+  if (nullptr == mesh)
+  {
+    ignwarn << "Failed to load mesh from [" << fullPath
+            << "]." << std::endl;
+  }
+  this->meshCache[key] = mesh;
+  return mesh;
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::DeferMeshSubtrees(const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("PhysicsPrivate::DeferMeshSubtrees");
+  auto &meshManager = *ignition::common::MeshManager::Instance();
+
+  // Hand meshes loaded since the last iteration to the mesh manager, so the
+  // collision pass finds them already loaded
+  std::vector<std::pair<std::string, common::Mesh *>> loaded;
+  {
+    std::lock_guard<std::mutex> lock(this->loadedMeshesMutex);
+    loaded.swap(this->loadedMeshes);
+  }
+  for (const auto &[path, mesh] : loaded)
+  {
+    this->loadingMeshes.erase(path);
+    if (nullptr == mesh)
+    {
+      ignwarn << "Failed to load mesh from [" << path << "] asynchronously."
+              << std::endl;
+    }
+    else if (!meshManager.HasMesh(path))
+    {
+      meshManager.AddMesh(mesh);
+    }
+    else
+    {
+      delete mesh;
+    }
+
+    for (auto &subtree : this->deferredSubtrees)
+      subtree.second.meshes.erase(path);
+  }
+
+  // Release subtrees which aren't waiting for any meshes anymore
+  for (auto it = this->deferredSubtrees.begin();
+       it != this->deferredSubtrees.end();)
+  {
+    if (!it->second.meshes.empty())
+    {
+      ++it;
+      continue;
+    }
+    for (const Entity entity : it->second.entities)
+    {
+      this->deferredEntities.erase(entity);
+      this->readyEntities.push_back(entity);
+    }
+    it = this->deferredSubtrees.erase(it);
+  }
+  std::sort(this->readyEntities.begin(), this->readyEntities.end());
+
+  // Hold back new subtrees with meshes which aren't loaded yet
+  _ecm.EachNew<components::Collision, components::Geometry>(
+      [&](const Entity &_entity, const components::Collision *,
+          const components::Geometry *_geom) -> bool
+      {
+        if (_geom->Data().Type() != sdf::GeometryType::MESH)
+          return true;
+
+        const sdf::Mesh *meshSdf = _geom->Data().MeshShape();
+        if (nullptr == meshSdf)
+          return true;
+
+        if (this->meshCache.find(meshSdf->Uri() + '\n' +
+            meshSdf->FilePath()) != this->meshCache.end())
+        {
+          return true;
+        }
+
+        // Meshes which can't be found are left to the collision pass to
+        // report
+        const auto fullPath = asFullPath(meshSdf->Uri(), meshSdf->FilePath());
+        if (meshManager.HasMesh(fullPath) || !common::exists(fullPath))
+          return true;
+
+        Entity root = topLevelModel(_entity, _ecm);
+        if (this->entityModelMap.HasEntity(root))
+          root = _entity;
+
+        auto deferredIt = this->deferredEntities.find(root);
+        if (deferredIt != this->deferredEntities.end())
+        {
+          root = deferredIt->second;
+        }
+        else
+        {
+          auto &subtree = this->deferredSubtrees[root];
+          subtree.entities.push_back(root);
+          if (root != _entity)
+          {
+            for (const Entity descendant : _ecm.Descendants(root))
+              subtree.entities.push_back(descendant);
+          }
+          for (const Entity entity : subtree.entities)
+            this->deferredEntities[entity] = root;
+        }
+        this->deferredSubtrees[root].meshes.insert(fullPath);
+
+        if (!this->loadingMeshes.insert(fullPath).second)
+          return true;
+
+        if (!this->creationPool)
+          this->creationPool = std::make_unique<common::WorkerPool>();
+
+        this->creationPool->AddWork([this, fullPath]()
+        {
+          auto mesh = loadMeshFile(fullPath);
+          std::lock_guard<std::mutex> lock(this->loadedMeshesMutex);
+          this->loadedMeshes.emplace_back(fullPath, mesh);
+        });
+        return true;
+      });
+}
+
 //////////////////////////////////////////////////
 void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
 {
+  if (this->asyncCreation)
+    this->DeferMeshSubtrees(_ecm);
+
   // Get all the new worlds
-  _ecm.EachNew<components::World, components::Name, components::Gravity>(
+  this->EachNewOrReady<components::World, components::Name,
+            components::Gravity>(
       [&](const Entity &_entity,
         const components::World * /* _world */,
         const components::Name *_name,
@@ -626,7 +1250,7 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
         return true;
       });
 
-  _ecm.EachNew<components::Model, components::Name, components::Pose,
+  this->EachNewOrReady<components::Model, components::Name, components::Pose,
             components::ParentEntity>(
       [&](const Entity &_entity,
           const components::Model *,
@@ -754,7 +1378,7 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
         return true;
       });
 
-  _ecm.EachNew<components::Link, components::Name, components::Pose,
+  this->EachNewOrReady<components::Link, components::Name, components::Pose,
             components::ParentEntity>(
       [&](const Entity &_entity,
         const components::Link * /* _link */,
@@ -802,8 +1426,21 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
 
         auto linkPtrPhys = modelPtrPhys->ConstructLink(link);
         this->entityLinkMap.AddEntity(_entity, linkPtrPhys);
+        const Entity topLevelModelEnt = topLevelModel(_entity, _ecm);
         this->topLevelModelMap.insert(std::make_pair(_entity,
-            topLevelModel(_entity, _ecm)));
+            topLevelModelEnt));
+
+        LinkRecord record;
+        record.entity = _entity;
+        record.parent = _parent->Data();
+        record.topLevelModel = topLevelModelEnt;
+        record.link = linkPtrPhys;
+        record.isStatic =
+            this->staticEntities.find(_entity) != this->staticEntities.end();
+        record.canonical =
+            nullptr != _ecm.Component<components::CanonicalLink>(_entity);
+        this->linkRecordIndices[_entity] = this->linkRecords.size();
+        this->linkRecords.push_back(std::move(record));
 
         return true;
       });
@@ -811,8 +1448,9 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
   // We don't need to add visuals to the physics engine.
 
   // collisions
-  _ecm.EachNew<components::Collision, components::Name, components::Pose,
-            components::Geometry, components::CollisionElement,
+  this->EachNewOrReady<components::Collision, components::Name,
+            components::Pose, components::Geometry,
+            components::CollisionElement,
             components::ParentEntity>(
       [&](const Entity &_entity,
           const components::Collision *,
@@ -858,15 +1496,9 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
             return true;
           }
 
-          auto &meshManager = *ignition::common::MeshManager::Instance();
-          auto fullPath = asFullPath(meshSdf->Uri(), meshSdf->FilePath());
-          auto *mesh = meshManager.Load(fullPath);
+          auto *mesh = this->CachedMesh(*meshSdf);
           if (nullptr == mesh)
-          {
-            ignwarn << "Failed to load mesh from [" << fullPath
-                    << "]." << std::endl;
             return true;
-          }
 
           auto linkMeshFeature =
               this->entityLinkMap.EntityCast<MeshFeatureList>(_parent->Data());
@@ -941,8 +1573,9 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
       });
 
   // joints
-  _ecm.EachNew<components::Joint, components::Name, components::JointType,
-               components::Pose, components::ThreadPitch,
+  this->EachNewOrReady<components::Joint, components::Name,
+               components::JointType, components::Pose,
+               components::ThreadPitch,
                components::ParentEntity, components::ParentLinkName,
                components::ChildLinkName>(
       [&](const Entity &_entity,
@@ -1021,21 +1654,19 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
           this->entityJointMap.AddEntity(_entity, jointPtrPhys);
           this->topLevelModelMap.insert(std::make_pair(_entity,
               topLevelModel(_entity, _ecm)));
-        }
-        return true;
-      });
 
-  _ecm.EachNew<components::BatterySoC>(
-      [&](const Entity & _entity, const components::BatterySoC *)->bool
-      {
-        // Parent entity of battery is model entity
-        this->entityOffMap.insert(std::make_pair(
-          _ecm.ParentEntity(_entity), false));
+          JointRecord record;
+          record.entity = _entity;
+          record.joint = this->entityJointMap.Get(_entity);
+          record.dofs = record.joint->GetDegreesOfFreedom();
+          this->jointRecordIndices[_entity] = this->jointRecords.size();
+          this->jointRecords.push_back(std::move(record));
+        }
         return true;
       });
 
   // Detachable joints
-  _ecm.EachNew<components::DetachableJoint>(
+  this->EachNewOrReady<components::DetachableJoint>(
       [&](const Entity &_entity,
           const components::DetachableJoint *_jointInfo) -> bool
       {
@@ -1121,6 +1752,8 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
         }
         return true;
       });
+
+  this->readyEntities.clear();
 }
 
 //////////////////////////////////////////////////
@@ -1137,6 +1770,15 @@ void PhysicsPrivate::RemovePhysicsEntities(const EntityComponentManager &_ecm)
       [&](const Entity &_entity, const components::Model *
           /* _model */) -> bool
       {
+        // Drop the model if its creation was still deferred
+        auto deferredIt = this->deferredSubtrees.find(_entity);
+        if (deferredIt != this->deferredSubtrees.end())
+        {
+          for (const Entity entity : deferredIt->second.entities)
+            this->deferredEntities.erase(entity);
+          this->deferredSubtrees.erase(deferredIt);
+        }
+
         // Remove model if found
         if (auto modelPtrPhys = this->entityModelMap.Get(_entity))
         {
@@ -1153,13 +1795,14 @@ void PhysicsPrivate::RemovePhysicsEntities(const EntityComponentManager &_ecm)
             this->entityLinkMap.Remove(childLink);
             this->topLevelModelMap.erase(childLink);
             this->staticEntities.erase(childLink);
-            this->linkWorldPoses.erase(childLink);
+            this->RemoveLinkRecord(childLink);
           }
 
           for (const auto &childJoint :
                _ecm.ChildrenByComponents(_entity, components::Joint()))
           {
             this->entityJointMap.Remove(childJoint);
+            this->RemoveJointRecord(childJoint);
             this->topLevelModelMap.erase(childJoint);
           }
 
@@ -1169,6 +1812,7 @@ void PhysicsPrivate::RemovePhysicsEntities(const EntityComponentManager &_ecm)
           this->entityModelMap.Remove(_entity);
           this->topLevelModelMap.erase(_entity);
           this->staticEntities.erase(_entity);
+          this->boundingBoxes.erase(_entity);
         }
         return true;
       });
@@ -1216,205 +1860,113 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
   _ecm.Each<components::BatterySoC>(
       [&](const Entity & _entity, const components::BatterySoC *_bat)
       {
+        // Parent entity of battery is model entity
         if (_bat->Data() <= 0)
-          entityOffMap[_ecm.ParentEntity(_entity)] = true;
-        else
-          entityOffMap[_ecm.ParentEntity(_entity)] = false;
+          this->drainedModels.insert(_ecm.ParentEntity(_entity));
+        else if (!this->drainedModels.empty())
+          this->drainedModels.erase(_ecm.ParentEntity(_entity));
         return true;
       });
 
-  // Handle joint state
-  _ecm.Each<components::Joint, components::Name>(
+  // Handle joint state. Only joints with reset components are visited, so
+  // the cost doesn't grow with the number of joints in the world.
+  auto isDrained = [&](const Entity &_joint)
+  {
+    // Model is out of battery, its joint forces are zeroed by
+    // ApplyHeldCommands
+    return !this->drainedModels.empty() &&
+        this->drainedModels.count(_ecm.ParentEntity(_joint)) > 0;
+  };
+
+  // Reset the velocity
+  _ecm.Each<components::Joint, components::Name,
+            components::JointVelocityReset>(
       [&](const Entity &_entity, const components::Joint *,
-          const components::Name *_name)
+          const components::Name *_name,
+          const components::JointVelocityReset *_velReset)
       {
         auto jointPhys = this->entityJointMap.Get(_entity);
-        if (nullptr == jointPhys)
+        if (nullptr == jointPhys || isDrained(_entity))
           return true;
 
-        // Model is out of battery
-        if (this->entityOffMap[_ecm.ParentEntity(_entity)])
+        auto &jointVelocity = _velReset->Data();
+
+        if (jointVelocity.size() != jointPhys->GetDegreesOfFreedom())
         {
-          std::size_t nDofs = jointPhys->GetDegreesOfFreedom();
-          for (std::size_t i = 0; i < nDofs; ++i)
-          {
-            jointPhys->SetForce(i, 0);
-          }
-          return true;
+          ignwarn << "There is a mismatch in the degrees of freedom "
+                  << "between Joint [" << _name->Data() << "(Entity="
+                  << _entity << ")] and its JointVelocityReset "
+                  << "component. The joint has "
+                  << jointPhys->GetDegreesOfFreedom()
+                  << " while the component has "
+                  << jointVelocity.size() << ".\n";
         }
 
-        auto posReset = _ecm.Component<components::JointPositionReset>(
-            _entity);
-        auto velReset = _ecm.Component<components::JointVelocityReset>(
-            _entity);
+        std::size_t nDofs = std::min(
+            jointVelocity.size(), jointPhys->GetDegreesOfFreedom());
 
-        // Reset the velocity
-        if (velReset)
+        for (std::size_t i = 0; i < nDofs; ++i)
         {
-          auto& jointVelocity = velReset->Data();
+          jointPhys->SetVelocity(i, jointVelocity[i]);
+        }
+        return true;
+      });
 
-          if (jointVelocity.size() != jointPhys->GetDegreesOfFreedom())
-          {
-            ignwarn << "There is a mismatch in the degrees of freedom "
-                    << "between Joint [" << _name->Data() << "(Entity="
-                    << _entity << ")] and its JointVelocityReset "
-                    << "component. The joint has "
-                    << jointPhys->GetDegreesOfFreedom()
-                    << " while the component has "
-                    << jointVelocity.size() << ".\n";
-            }
+  // Reset the position
+  _ecm.Each<components::Joint, components::Name,
+            components::JointPositionReset>(
+      [&](const Entity &_entity, const components::Joint *,
+          const components::Name *_name,
+          const components::JointPositionReset *_posReset)
+      {
+        auto jointPhys = this->entityJointMap.Get(_entity);
+        if (nullptr == jointPhys || isDrained(_entity))
+          return true;
 
-            std::size_t nDofs = std::min(
-                jointVelocity.size(), jointPhys->GetDegreesOfFreedom());
+        auto &jointPosition = _posReset->Data();
 
-            for (std::size_t i = 0; i < nDofs; ++i)
-            {
-              jointPhys->SetVelocity(i, jointVelocity[i]);
-            }
+        if (jointPosition.size() != jointPhys->GetDegreesOfFreedom())
+        {
+          ignwarn << "There is a mismatch in the degrees of freedom "
+                  << "between Joint [" << _name->Data() << "(Entity="
+                  << _entity << ")] and its JointPositionyReset "
+                  << "component. The joint has "
+                  << jointPhys->GetDegreesOfFreedom()
+                  << " while the component has "
+                  << jointPosition.size() << ".\n";
         }
-
-        // Reset the position
-        if (posReset)
+        std::size_t nDofs = std::min(
+            jointPosition.size(), jointPhys->GetDegreesOfFreedom());
+        for (std::size_t i = 0; i < nDofs; ++i)
         {
-          auto &jointPosition = posReset->Data();
-
-          if (jointPosition.size() != jointPhys->GetDegreesOfFreedom())
-          {
-            ignwarn << "There is a mismatch in the degrees of freedom "
-                    << "between Joint [" << _name->Data() << "(Entity="
-                    << _entity << ")] and its JointPositionyReset "
-                    << "component. The joint has "
-                    << jointPhys->GetDegreesOfFreedom()
-                    << " while the component has "
-                    << jointPosition.size() << ".\n";
-            }
-            std::size_t nDofs = std::min(
-                jointPosition.size(), jointPhys->GetDegreesOfFreedom());
-            for (std::size_t i = 0; i < nDofs; ++i)
-            {
-              jointPhys->SetPosition(i, jointPosition[i]);
-            }
+          jointPhys->SetPosition(i, jointPosition[i]);
         }
 
-        auto force = _ecm.Component<components::JointForceCmd>(_entity);
-        auto velCmd = _ecm.Component<components::JointVelocityCmd>(_entity);
-
-        if (force)
+        if (this->trackBoundingBoxes)
         {
-          if (force->Data().size() != jointPhys->GetDegreesOfFreedom())
-          {
-            ignwarn << "There is a mismatch in the degrees of freedom between "
-                    << "Joint [" << _name->Data() << "(Entity=" << _entity
-                    << ")] and its JointForceCmd component. The joint has "
-                    << jointPhys->GetDegreesOfFreedom() << " while the "
-                    << " component has " << force->Data().size() << ".\n";
-          }
-          std::size_t nDofs = std::min(force->Data().size(),
-                                       jointPhys->GetDegreesOfFreedom());
-          for (std::size_t i = 0; i < nDofs; ++i)
-          {
-            jointPhys->SetForce(i, force->Data()[i]);
-          }
+          auto topLevelIt =
+              this->topLevelModelMap.find(_ecm.ParentEntity(_entity));
+          if (topLevelIt != this->topLevelModelMap.end())
+            this->movedModels.insert(topLevelIt->second);
         }
-        // Only set joint velocity if joint force is not set.
-        // If both the cmd and reset components are found, cmd is ignored.
-        else if (velCmd)
-        {
-          auto velocityCmd = velCmd->Data();
-
-          if (velReset)
-          {
-            ignwarn << "Found both JointVelocityReset and "
-                    << "JointVelocityCmd components for Joint ["
-                    << _name->Data() << "(Entity=" << _entity
-                    << "]). Ignoring JointVelocityCmd component."
-                    << std::endl;
-            return true;
-          }
+        return true;
+      });
 
-          if (velocityCmd.size() != jointPhys->GetDegreesOfFreedom())
-          {
-            ignwarn << "There is a mismatch in the degrees of freedom"
-                    << " between Joint [" << _name->Data()
-                    << "(Entity=" << _entity<< ")] and its "
-                    << "JointVelocityCmd component. The joint has "
-                    << jointPhys->GetDegreesOfFreedom()
-                    << " while the component has "
-                    << velocityCmd.size() << ".\n";
-          }
+  this->ApplyHeldCommands(_ecm);
 
-          auto jointVelFeature =
-              this->entityJointMap.EntityCast<JointVelocityCommandFeatureList>(
-                  _entity);
-          if (!jointVelFeature)
-          {
-            return true;
-          }
+  // Update model pose
+  auto olderWorldPoseCmdsToRemove = std::move(this->worldPoseCmdsToRemove);
+  this->worldPoseCmdsToRemove.clear();
 
-          std::size_t nDofs = std::min(
-            velocityCmd.size(),
-            jointPhys->GetDegreesOfFreedom());
+  _ecm.Each<components::Model, components::WorldPoseCmd>(
+      [&](const Entity &_entity, const components::Model *,
+          const components::WorldPoseCmd *_poseCmd)
+      {
+        this->worldPoseCmdsToRemove.insert(_entity);
 
-          for (std::size_t i = 0; i < nDofs; ++i)
-          {
-            jointVelFeature->SetVelocityCommand(i, velocityCmd[i]);
-          }
-        }
-
-        return true;
-      });
-
-  // Link wrenches
-  _ecm.Each<components::ExternalWorldWrenchCmd>(
-      [&](const Entity &_entity,
-          const components::ExternalWorldWrenchCmd *_wrenchComp)
-      {
-        if (!this->entityLinkMap.HasEntity(_entity))
-        {
-          ignwarn << "Failed to find link [" << _entity
-                  << "]." << std::endl;
-          return true;
-        }
-
-        auto linkForceFeature =
-            this->entityLinkMap.EntityCast<LinkForceFeatureList>(_entity);
-        if (!linkForceFeature)
-        {
-          static bool informed{false};
-          if (!informed)
-          {
-            igndbg << "Attempting to apply a wrench, but the physics "
-                   << "engine doesn't support feature "
-                   << "[AddLinkExternalForceTorque]. Wrench will be ignored."
-                   << std::endl;
-            informed = true;
-          }
-
-          // Break Each call since no ExternalWorldWrenchCmd's can be processed
-          return false;
-        }
-
-        math::Vector3 force = msgs::Convert(_wrenchComp->Data().force());
-        math::Vector3 torque = msgs::Convert(_wrenchComp->Data().torque());
-        linkForceFeature->AddExternalForce(math::eigen3::convert(force));
-        linkForceFeature->AddExternalTorque(math::eigen3::convert(torque));
-
-        return true;
-      });
-
-  // Update model pose
-  auto olderWorldPoseCmdsToRemove = std::move(this->worldPoseCmdsToRemove);
-  this->worldPoseCmdsToRemove.clear();
-
-  _ecm.Each<components::Model, components::WorldPoseCmd>(
-      [&](const Entity &_entity, const components::Model *,
-          const components::WorldPoseCmd *_poseCmd)
-      {
-        this->worldPoseCmdsToRemove.insert(_entity);
-
-        auto modelPtrPhys = this->entityModelMap.Get(_entity);
-        if (nullptr == modelPtrPhys)
-          return true;
+        auto modelPtrPhys = this->entityModelMap.Get(_entity);
+        if (nullptr == modelPtrPhys)
+          return true;
 
         // world pose cmd currently not supported for nested models
         if (_entity != this->topLevelModelMap[_entity])
@@ -1447,6 +1999,8 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
 
         freeGroup->SetWorldPose(math::eigen3::convert(_poseCmd->Data() *
                                 linkPose));
+        if (this->trackBoundingBoxes)
+          this->movedModels.insert(_entity);
 
         // Process pose commands for static models here, as one-time changes
         if (this->staticEntities.find(_entity) != this->staticEntities.end())
@@ -1608,14 +2162,49 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
 
         return true;
       });
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::UpdateBoundingBoxes(const UpdateInfo &_info,
+    EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("PhysicsPrivate::UpdateBoundingBoxes");
+
+  if (this->boundingBoxUpdateRate > 0.0 && this->trackBoundingBoxes)
+  {
+    auto period = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(std::chrono::duration<double>(
+        1.0 / this->boundingBoxUpdateRate));
+    if (_info.simTime >= this->lastBoundingBoxUpdate &&
+        _info.simTime - this->lastBoundingBoxUpdate < period)
+    {
+      return;
+    }
+  }
+  this->lastBoundingBoxUpdate = _info.simTime;
 
   // Populate bounding box info
   // Only compute bounding box if component exists to avoid unnecessary
-  // computations
+  // computations. Models which haven't moved keep their box.
+  bool found{false};
   _ecm.Each<components::Model, components::AxisAlignedBox>(
       [&](const Entity &_entity, const components::Model *,
           components::AxisAlignedBox *_bbox)
       {
+        found = true;
+
+        auto cachedIt = this->boundingBoxes.find(_entity);
+        if (cachedIt != this->boundingBoxes.end() &&
+            cachedIt->second == _bbox->Data())
+        {
+          auto topLevelIt = this->topLevelModelMap.find(_entity);
+          if (topLevelIt != this->topLevelModelMap.end() &&
+              this->movedModels.count(topLevelIt->second) == 0)
+          {
+            return true;
+          }
+        }
+
         if (!this->entityModelMap.HasEntity(_entity))
         {
           ignwarn << "Failed to find model [" << _entity << "]." << std::endl;
@@ -1647,6 +2236,169 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
             ComponentState::OneTimeChange :
             ComponentState::NoChange;
         _ecm.SetChanged(_entity, components::AxisAlignedBox::typeId, state);
+        this->boundingBoxes[_entity] = _bbox->Data();
+
+        return true;
+      });
+
+  this->trackBoundingBoxes = found;
+  this->movedModels.clear();
+  if (!found)
+    this->boundingBoxes.clear();
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::ApplyHeldCommands(const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("PhysicsPrivate::ApplyHeldCommands");
+
+  // Joints of models which are out of battery
+  for (const Entity &model : this->drainedModels)
+  {
+    for (const Entity &joint :
+        _ecm.ChildrenByComponents(model, components::Joint()))
+    {
+      auto jointPhys = this->entityJointMap.Get(joint);
+      if (nullptr == jointPhys)
+        continue;
+
+      std::size_t nDofs = jointPhys->GetDegreesOfFreedom();
+      for (std::size_t i = 0; i < nDofs; ++i)
+      {
+        jointPhys->SetForce(i, 0);
+      }
+    }
+  }
+
+  auto isDrained = [&](const Entity &_joint)
+  {
+    return !this->drainedModels.empty() &&
+        this->drainedModels.count(_ecm.ParentEntity(_joint)) > 0;
+  };
+
+  // Joint commands. Only commanded joints are visited, so the cost doesn't
+  // grow with the number of joints in the world.
+  _ecm.Each<components::Joint, components::Name, components::JointForceCmd>(
+      [&](const Entity &_entity, const components::Joint *,
+          const components::Name *_name,
+          const components::JointForceCmd *_force)
+      {
+        auto jointPhys = this->entityJointMap.Get(_entity);
+        if (nullptr == jointPhys || isDrained(_entity))
+          return true;
+
+        if (_force->Data().size() != jointPhys->GetDegreesOfFreedom())
+        {
+          ignwarn << "There is a mismatch in the degrees of freedom between "
+                  << "Joint [" << _name->Data() << "(Entity=" << _entity
+                  << ")] and its JointForceCmd component. The joint has "
+                  << jointPhys->GetDegreesOfFreedom() << " while the "
+                  << " component has " << _force->Data().size() << ".\n";
+        }
+        std::size_t nDofs = std::min(_force->Data().size(),
+                                     jointPhys->GetDegreesOfFreedom());
+        for (std::size_t i = 0; i < nDofs; ++i)
+        {
+          jointPhys->SetForce(i, _force->Data()[i]);
+        }
+        return true;
+      });
+
+  _ecm.Each<components::Joint, components::Name,
+            components::JointVelocityCmd>(
+      [&](const Entity &_entity, const components::Joint *,
+          const components::Name *_name,
+          const components::JointVelocityCmd *_velCmd)
+      {
+        auto jointPhys = this->entityJointMap.Get(_entity);
+        if (nullptr == jointPhys || isDrained(_entity))
+          return true;
+
+        // Only set joint velocity if joint force is not set.
+        if (nullptr != _ecm.Component<components::JointForceCmd>(_entity))
+          return true;
+
+        // If both the cmd and reset components are found, cmd is ignored.
+        if (nullptr != _ecm.Component<components::JointVelocityReset>(
+            _entity))
+        {
+          ignwarn << "Found both JointVelocityReset and "
+                  << "JointVelocityCmd components for Joint ["
+                  << _name->Data() << "(Entity=" << _entity
+                  << "]). Ignoring JointVelocityCmd component."
+                  << std::endl;
+          return true;
+        }
+
+        const auto &velocityCmd = _velCmd->Data();
+        if (velocityCmd.size() != jointPhys->GetDegreesOfFreedom())
+        {
+          ignwarn << "There is a mismatch in the degrees of freedom"
+                  << " between Joint [" << _name->Data()
+                  << "(Entity=" << _entity<< ")] and its "
+                  << "JointVelocityCmd component. The joint has "
+                  << jointPhys->GetDegreesOfFreedom()
+                  << " while the component has "
+                  << velocityCmd.size() << ".\n";
+        }
+
+        auto jointVelFeature =
+            this->entityJointMap.EntityCast<JointVelocityCommandFeatureList>(
+                _entity);
+        if (!jointVelFeature)
+        {
+          return true;
+        }
+
+        std::size_t nDofs = std::min(
+          velocityCmd.size(),
+          jointPhys->GetDegreesOfFreedom());
+
+        for (std::size_t i = 0; i < nDofs; ++i)
+        {
+          jointVelFeature->SetVelocityCommand(i, velocityCmd[i]);
+        }
+        return true;
+      });
+
+  // Link wrenches
+  _ecm.Each<components::ExternalWorldWrenchCmd>(
+      [&](const Entity &_entity,
+          const components::ExternalWorldWrenchCmd *_wrenchComp)
+      {
+        // Cleared commands are kept, with zero values
+        if (isZeroWrench(_wrenchComp->Data()))
+          return true;
+
+        if (!this->entityLinkMap.HasEntity(_entity))
+        {
+          ignwarn << "Failed to find link [" << _entity
+                  << "]." << std::endl;
+          return true;
+        }
+
+        auto linkForceFeature =
+            this->entityLinkMap.EntityCast<LinkForceFeatureList>(_entity);
+        if (!linkForceFeature)
+        {
+          static bool informed{false};
+          if (!informed)
+          {
+            igndbg << "Attempting to apply a wrench, but the physics "
+                   << "engine doesn't support feature "
+                   << "[AddLinkExternalForceTorque]. Wrench will be ignored."
+                   << std::endl;
+            informed = true;
+          }
+
+          // Break Each call since no ExternalWorldWrenchCmd's can be processed
+          return false;
+        }
+
+        math::Vector3 force = msgs::Convert(_wrenchComp->Data().force());
+        math::Vector3 torque = msgs::Convert(_wrenchComp->Data().torque());
+        linkForceFeature->AddExternalForce(math::eigen3::convert(force));
+        linkForceFeature->AddExternalTorque(math::eigen3::convert(torque));
 
         return true;
       });
@@ -1662,10 +2414,35 @@ void PhysicsPrivate::Step(const std::chrono::steady_clock::duration &_dt)
 
   input.Get<std::chrono::steady_clock::duration>() = _dt;
 
-  for (const auto &world : this->entityWorldMap.Map())
+  const auto &worlds = this->entityWorldMap.Map();
+  if (!this->parallelStep || worlds.size() < 2)
   {
-    world.second->Step(output, state, input);
+    for (const auto &world : worlds)
+    {
+      world.second->Step(output, state, input);
+    }
+    return;
   }
+
+  // Worlds don't share state, so they can be stepped concurrently. Components
+  // are only read before and written after all worlds are stepped, in
+  // UpdatePhysics and UpdateSim, so the ECM isn't touched from the pool.
+  std::vector<const WorldEntityMap::RequiredEntityPtr *> worldPtrs;
+  worldPtrs.reserve(worlds.size());
+  for (const auto &world : worlds)
+    worldPtrs.push_back(&world.second);
+
+  if (!this->stepPool)
+    this->stepPool = std::make_unique<common::WorkerPool>();
+
+  RunParallelTasks(this->stepPool.get(), 0, worldPtrs.size(),
+      [&](std::size_t _index)
+      {
+        IGN_PROFILE("PhysicsPrivate::Step world");
+        ignition::physics::ForwardStep::State worldState;
+        ignition::physics::ForwardStep::Output worldOutput;
+        (*worldPtrs[_index])->Step(worldOutput, worldState, input);
+      });
 }
 
 //////////////////////////////////////////////////
@@ -1705,336 +2482,531 @@ ignition::math::Pose3d PhysicsPrivate::RelativePose(const Entity &_from,
 }
 
 //////////////////////////////////////////////////
-void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm)
+void PhysicsPrivate::RemoveLinkRecord(const Entity _entity)
 {
-  IGN_PROFILE("PhysicsPrivate::UpdateSim");
-
-  // Link poses, velocities...
-  IGN_PROFILE_BEGIN("Links");
-  _ecm.Each<components::Link, components::Pose, components::ParentEntity>(
-      [&](const Entity &_entity, components::Link * /*_link*/,
-          components::Pose *_pose,
-          const components::ParentEntity *_parent)->bool
-      {
-        // If parent is static, don't process pose changes as periodic
-        if (this->staticEntities.find(_entity) != this->staticEntities.end())
-          return true;
+  auto it = this->linkRecordIndices.find(_entity);
+  if (it == this->linkRecordIndices.end())
+    return;
 
-        auto linkPhys = this->entityLinkMap.Get(_entity);
-        if (nullptr == linkPhys)
-        {
-          ignerr << "Internal error: link [" << _entity
-                 << "] not in entity map" << std::endl;
-          return true;
-        }
+  // Swap with the last record so the list stays dense
+  const std::size_t index = it->second;
+  this->linkRecordIndices.erase(it);
+  if (this->linkRecords[index].asleep)
+    --this->sleepingLinkCount;
 
-        IGN_PROFILE_BEGIN("Local pose");
-        // get top level model of this link
-        auto topLevelModelEnt = this->topLevelModelMap[_parent->Data()];
+  if (index + 1 != this->linkRecords.size())
+  {
+    this->linkRecords[index] = std::move(this->linkRecords.back());
+    this->linkRecordIndices[this->linkRecords[index].entity] = index;
+    if (this->linkFrameData.size() == this->linkRecords.size())
+      this->linkFrameData[index] = this->linkFrameData.back();
+  }
+  this->linkRecords.pop_back();
+  if (this->linkFrameData.size() > this->linkRecords.size())
+    this->linkFrameData.pop_back();
+}
 
-        auto canonicalLink =
-            _ecm.Component<components::CanonicalLink>(_entity);
+//////////////////////////////////////////////////
+void PhysicsPrivate::RemoveJointRecord(const Entity _entity)
+{
+  auto it = this->jointRecordIndices.find(_entity);
+  if (it == this->jointRecordIndices.end())
+    return;
 
-        auto frameData = linkPhys->FrameDataRelativeToWorld();
-        const auto &worldPose = frameData.pose;
+  // Swap with the last record so the list stays dense
+  const std::size_t index = it->second;
+  this->jointRecordIndices.erase(it);
+  if (index + 1 != this->jointRecords.size())
+  {
+    this->jointRecords[index] = std::move(this->jointRecords.back());
+    this->jointRecordIndices[this->jointRecords[index].entity] = index;
+  }
+  this->jointRecords.pop_back();
+}
 
-        // update the link or top level model pose if this is the first update,
-        // or if the link pose has changed since the last update
-        // (if the link pose hasn't changed, there's no need for a pose update)
-        const auto worldPoseMath3d = ignition::math::eigen3::convert(worldPose);
-        if ((this->linkWorldPoses.find(_entity) == this->linkWorldPoses.end())
-            || !this->pose3Eql(this->linkWorldPoses[_entity], worldPoseMath3d))
-        {
-          // cache the updated link pose to check if the link pose has changed
-          // during the next iteration
-          this->linkWorldPoses[_entity] = worldPoseMath3d;
+//////////////////////////////////////////////////
+void PhysicsPrivate::WakeLink(LinkRecord &_record)
+{
+  _record.restingSteps = 0;
+  if (_record.asleep)
+  {
+    _record.asleep = false;
+    --this->sleepingLinkCount;
+  }
+}
 
-          if (canonicalLink)
-          {
-            // This is the canonical link, update the top level model.
-            // The pose of this link w.r.t its top level model never changes
-            // because it's "fixed" to the model. Instead, we change
-            // the top level model's pose here. The physics engine gives us the
-            // pose of this link relative to world so to set the top level
-            // model's pose, we have to post-multiply it by the inverse of the
-            // transform of the link w.r.t to its top level model.
-            math::Pose3d linkPoseFromTopLevelModel;
-            linkPoseFromTopLevelModel =
-                this->RelativePose(topLevelModelEnt, _entity, _ecm);
-
-            // update top level model's pose
-            auto mutableModelPose =
-               _ecm.Component<components::Pose>(topLevelModelEnt);
-            *(mutableModelPose) = components::Pose(
-                math::eigen3::convert(worldPose) *
-                linkPoseFromTopLevelModel.Inverse());
-
-            _ecm.SetChanged(topLevelModelEnt, components::Pose::typeId,
-                ComponentState::PeriodicChange);
-          }
-          else
-          {
-            // Compute the relative pose of this link from the top level model
-            // first get the world pose of the top level model
-            auto worldComp =
-                _ecm.Component<components::ParentEntity>(topLevelModelEnt);
-            // if the worldComp is a nullptr, something is wrong with ECS
-            if (!worldComp)
-            {
-              ignerr << "The parent component of " << topLevelModelEnt
-                     << " could not be found. This should never happen!\n";
-              return true;
-            }
-            math::Pose3d parentWorldPose =
-                this->RelativePose(worldComp->Data(), _parent->Data(), _ecm);
-
-            // Unlike canonical links, pose of regular links can move relative
-            // to the parent. Same for links inside nested models.
-            *_pose = components::Pose(math::eigen3::convert(worldPose) +
-                                      parentWorldPose.Inverse());
-            _ecm.SetChanged(_entity, components::Pose::typeId,
-                ComponentState::PeriodicChange);
-          }
-        }
-        IGN_PROFILE_END();
+//////////////////////////////////////////////////
+void PhysicsPrivate::WakeSleepingLinks(const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("PhysicsPrivate::WakeSleepingLinks");
 
-        // Populate world poses, velocities and accelerations of the link. For
-        // now these components are updated only if another system has created
-        // the corresponding component on the entity.
-        auto worldPoseComp = _ecm.Component<components::WorldPose>(_entity);
-        if (worldPoseComp)
-        {
-          auto state =
-              worldPoseComp->SetData(math::eigen3::convert(frameData.pose),
-              this->pose3Eql) ?
-              ComponentState::PeriodicChange :
-              ComponentState::NoChange;
-          _ecm.SetChanged(_entity, components::WorldPose::typeId, state);
-        }
+  // Top level models which were commanded this step. Commands are still in
+  // the ECM at this point, they're cleared at the end of UpdateSim.
+  std::unordered_set<Entity> wakeModels;
+  auto wakeModel = [&](const Entity _entity)
+  {
+    auto it = this->topLevelModelMap.find(_entity);
+    if (it != this->topLevelModelMap.end())
+      wakeModels.insert(it->second);
+  };
 
-        // Velocity in world coordinates
-        auto worldLinVelComp =
-            _ecm.Component<components::WorldLinearVelocity>(_entity);
-        if (worldLinVelComp)
-        {
-          auto state = worldLinVelComp->SetData(
-                math::eigen3::convert(frameData.linearVelocity),
-                this->vec3Eql) ?
-                ComponentState::PeriodicChange :
-                ComponentState::NoChange;
-          _ecm.SetChanged(_entity,
-              components::WorldLinearVelocity::typeId, state);
-        }
-
-        // Angular velocity in world frame coordinates
-        auto worldAngVelComp =
-            _ecm.Component<components::WorldAngularVelocity>(_entity);
-        if (worldAngVelComp)
-        {
-          auto state = worldAngVelComp->SetData(
-              math::eigen3::convert(frameData.angularVelocity),
-              this->vec3Eql) ?
-              ComponentState::PeriodicChange :
-              ComponentState::NoChange;
-          _ecm.SetChanged(_entity,
-              components::WorldAngularVelocity::typeId, state);
-        }
-
-        // Acceleration in world frame coordinates
-        auto worldLinAccelComp =
-            _ecm.Component<components::WorldLinearAcceleration>(_entity);
-        if (worldLinAccelComp)
-        {
-          auto state = worldLinAccelComp->SetData(
-              math::eigen3::convert(frameData.linearAcceleration),
-              this->vec3Eql) ?
-              ComponentState::PeriodicChange :
-              ComponentState::NoChange;
-          _ecm.SetChanged(_entity,
-              components::WorldLinearAcceleration::typeId, state);
-        }
-
-        // Angular acceleration in world frame coordinates
-        auto worldAngAccelComp =
-            _ecm.Component<components::WorldAngularAcceleration>(_entity);
-
-        if (worldAngAccelComp)
-        {
-          auto state = worldAngAccelComp->SetData(
-              math::eigen3::convert(frameData.angularAcceleration),
-              this->vec3Eql) ?
-              ComponentState::PeriodicChange :
-              ComponentState::NoChange;
-          _ecm.SetChanged(_entity,
-              components::WorldAngularAcceleration::typeId, state);
-        }
-
-        const Eigen::Matrix3d R_bs = worldPose.linear().transpose(); // NOLINT
-
-        // Velocity in body-fixed frame coordinates
-        auto bodyLinVelComp =
-            _ecm.Component<components::LinearVelocity>(_entity);
-        if (bodyLinVelComp)
-        {
-          Eigen::Vector3d bodyLinVel = R_bs * frameData.linearVelocity;
-          auto state =
-              bodyLinVelComp->SetData(math::eigen3::convert(bodyLinVel),
-              this->vec3Eql) ?
-              ComponentState::PeriodicChange :
-              ComponentState::NoChange;
-          _ecm.SetChanged(_entity, components::LinearVelocity::typeId, state);
-        }
-
-        // Angular velocity in body-fixed frame coordinates
-        auto bodyAngVelComp =
-            _ecm.Component<components::AngularVelocity>(_entity);
-        if (bodyAngVelComp)
-        {
-          Eigen::Vector3d bodyAngVel = R_bs * frameData.angularVelocity;
-          auto state =
-              bodyAngVelComp->SetData(math::eigen3::convert(bodyAngVel),
-              this->vec3Eql) ?
-              ComponentState::PeriodicChange :
-              ComponentState::NoChange;
-          _ecm.SetChanged(_entity, components::AngularVelocity::typeId,
-              state);
-        }
-
-        // Acceleration in body-fixed frame coordinates
-        auto bodyLinAccelComp =
-            _ecm.Component<components::LinearAcceleration>(_entity);
-        if (bodyLinAccelComp)
-        {
-          Eigen::Vector3d bodyLinAccel = R_bs * frameData.linearAcceleration;
-          auto state =
-              bodyLinAccelComp->SetData(math::eigen3::convert(bodyLinAccel),
-              this->vec3Eql)?
-              ComponentState::PeriodicChange :
-              ComponentState::NoChange;
-          _ecm.SetChanged(_entity, components::LinearAcceleration::typeId,
-              state);
-        }
-
-        // Angular acceleration in world frame coordinates
-        auto bodyAngAccelComp =
-            _ecm.Component<components::AngularAcceleration>(_entity);
-        if (bodyAngAccelComp)
-        {
-          Eigen::Vector3d bodyAngAccel = R_bs * frameData.angularAcceleration;
-          auto state =
-              bodyAngAccelComp->SetData(math::eigen3::convert(bodyAngAccel),
-              this->vec3Eql) ?
-              ComponentState::PeriodicChange :
-              ComponentState::NoChange;
-          _ecm.SetChanged(_entity, components::AngularAcceleration::typeId,
-              state);
-        }
+  _ecm.Each<components::Model, components::WorldPoseCmd>(
+      [&](const Entity &_entity, const components::Model *,
+          const components::WorldPoseCmd *) -> bool
+      {
+        wakeModel(_entity);
         return true;
       });
-  IGN_PROFILE_END();
 
-  // pose/velocity/acceleration of non-link entities such as sensors /
-  // collisions. These get updated only if another system has created a
-  // components::WorldPose component for the entity.
-  // Populated components:
-  // * WorldPose
-  // * WorldLinearVelocity
-  // * AngularVelocity
-  // * LinearAcceleration
+  _ecm.Each<components::Model, components::LinearVelocityCmd>(
+      [&](const Entity &_entity, const components::Model *,
+          const components::LinearVelocityCmd *) -> bool
+      {
+        wakeModel(_entity);
+        return true;
+      });
 
-  IGN_PROFILE_BEGIN("Sensors / collisions");
-  // world pose
-  _ecm.Each<components::Pose, components::WorldPose,
-            components::ParentEntity>(
-      [&](const Entity &,
-          const components::Pose *_pose, components::WorldPose *_worldPose,
-          const components::ParentEntity *_parent)->bool
+  _ecm.Each<components::Model, components::AngularVelocityCmd>(
+      [&](const Entity &_entity, const components::Model *,
+          const components::AngularVelocityCmd *) -> bool
       {
-        // check if parent entity is a link, e.g. entity is sensor / collision
-        if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
-        {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
+        wakeModel(_entity);
+        return true;
+      });
 
-          *_worldPose = components::WorldPose(
-              math::eigen3::convert(entityFrameData.pose));
-        }
+  auto nonZero = [](const std::vector<double> &_values)
+  {
+    return std::any_of(_values.begin(), _values.end(),
+        [](double _value) { return _value != 0.0; });
+  };
 
+  _ecm.Each<components::Joint, components::JointForceCmd>(
+      [&](const Entity &_entity, const components::Joint *,
+          const components::JointForceCmd *_force) -> bool
+      {
+        if (nonZero(_force->Data()))
+          wakeModel(_entity);
         return true;
       });
 
-  // world linear velocity
-  _ecm.Each<components::Pose, components::WorldLinearVelocity,
-            components::ParentEntity>(
-      [&](const Entity &,
-          const components::Pose *_pose,
-          components::WorldLinearVelocity *_worldLinearVel,
-          const components::ParentEntity *_parent)->bool
+  _ecm.Each<components::Joint, components::JointVelocityCmd>(
+      [&](const Entity &_entity, const components::Joint *,
+          const components::JointVelocityCmd *_vel) -> bool
       {
-        // check if parent entity is a link, e.g. entity is sensor / collision
-        if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
-        {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
-
-          // set entity world linear velocity
-          *_worldLinearVel = components::WorldLinearVelocity(
-              math::eigen3::convert(entityFrameData.linearVelocity));
-        }
-
+        if (nonZero(_vel->Data()))
+          wakeModel(_entity);
         return true;
       });
 
-  // body angular velocity
-  _ecm.Each<components::Pose, components::AngularVelocity,
-            components::ParentEntity>(
-      [&](const Entity &,
-          const components::Pose *_pose,
-          components::AngularVelocity *_angularVel,
-          const components::ParentEntity *_parent)->bool
+  _ecm.Each<components::Joint, components::JointPositionReset>(
+      [&](const Entity &_entity, const components::Joint *,
+          const components::JointPositionReset *) -> bool
       {
-        // check if parent entity is a link, e.g. entity is sensor / collision
-        if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
-        {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
+        wakeModel(_entity);
+        return true;
+      });
 
-          auto entityWorldPose = math::eigen3::convert(entityFrameData.pose);
-          ignition::math::Vector3d entityWorldAngularVel =
-              math::eigen3::convert(entityFrameData.angularVelocity);
+  _ecm.Each<components::Joint, components::JointVelocityReset>(
+      [&](const Entity &_entity, const components::Joint *,
+          const components::JointVelocityReset *) -> bool
+      {
+        wakeModel(_entity);
+        return true;
+      });
 
-          auto entityBodyAngularVel =
-              entityWorldPose.Rot().RotateVectorReverse(entityWorldAngularVel);
-          *_angularVel = components::AngularVelocity(entityBodyAngularVel);
-        }
+  _ecm.Each<components::ExternalWorldWrenchCmd>(
+      [&](const Entity &_entity,
+          const components::ExternalWorldWrenchCmd *_wrench) -> bool
+      {
+        if (isZeroWrench(_wrench->Data()))
+          return true;
 
+        auto it = this->linkRecordIndices.find(_entity);
+        if (it != this->linkRecordIndices.end())
+          this->WakeLink(this->linkRecords[it->second]);
         return true;
       });
 
-  // body linear acceleration
-  _ecm.Each<components::Pose, components::LinearAcceleration,
-            components::ParentEntity>(
-      [&](const Entity &,
-          const components::Pose *_pose,
-          components::LinearAcceleration *_linearAcc,
-          const components::ParentEntity *_parent)->bool
+  if (!wakeModels.empty())
+  {
+    for (auto &record : this->linkRecords)
+    {
+      if (wakeModels.find(record.topLevelModel) != wakeModels.end())
+        this->WakeLink(record);
+    }
+  }
+
+  if (0 == this->sleepingLinkCount)
+    return;
+
+  // Wake sleeping links touched by a body which is awake. Links resting on
+  // each other or on static bodies stay asleep.
+  auto linkOfCollision = [&](const ShapePtrType &_shape) -> LinkRecord *
+  {
+    const Entity collision = this->entityCollisionMap.Get(_shape);
+    if (kNullEntity == collision)
+      return nullptr;
+    auto parent = _ecm.Component<components::ParentEntity>(collision);
+    if (nullptr == parent)
+      return nullptr;
+    auto it = this->linkRecordIndices.find(parent->Data());
+    if (it == this->linkRecordIndices.end())
+      return nullptr;
+    return &this->linkRecords[it->second];
+  };
+
+  for (const auto &world : this->entityWorldMap.Map())
+  {
+    auto worldCollisionFeature =
+        this->entityWorldMap.EntityCast<ContactFeatureList>(world.first);
+    if (!worldCollisionFeature)
+      continue;
+
+    const auto allContacts = worldCollisionFeature->GetContactsFromLastStep();
+    for (const auto &contactComposite : allContacts)
+    {
+      const auto &contact =
+          contactComposite.Get<WorldShapeType::ContactPoint>();
+      auto link1 = linkOfCollision(ShapePtrType(contact.collision1));
+      auto link2 = linkOfCollision(ShapePtrType(contact.collision2));
+      if (nullptr == link1 || nullptr == link2)
+        continue;
+
+      if (link1->asleep && !link2->asleep && !link2->isStatic)
+        this->WakeLink(*link1);
+      else if (link2->asleep && !link1->asleep && !link1->isStatic)
+        this->WakeLink(*link2);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("PhysicsPrivate::UpdateSim");
+
+  // Read back the kinematic state of all links at once. Everything below
+  // works from this buffer instead of querying the physics engine again.
+  // Sleeping links are only polled once every sleepSteps steps, in case
+  // something moved them without waking them explicitly.
+  if (this->sleepingLinkCount > 0)
+    this->WakeSleepingLinks(_ecm);
+
+  IGN_PROFILE_BEGIN("Frame data");
+  this->linkFrameData.resize(this->linkRecords.size());
+  for (std::size_t i = 0; i < this->linkRecords.size(); ++i)
+  {
+    auto &record = this->linkRecords[i];
+    record.polled = !record.asleep ||
+        (++record.restingSteps % this->sleepSteps) == 0;
+    if (record.polled)
+      this->linkFrameData[i] = record.link->FrameDataRelativeToWorld();
+  }
+  IGN_PROFILE_END();
+
+  // Link poses, velocities...
+  IGN_PROFILE_BEGIN("Links");
+  for (std::size_t i = 0; i < this->linkRecords.size(); ++i)
+  {
+    auto &record = this->linkRecords[i];
+
+    // If parent is static, don't process pose changes as periodic
+    if (record.isStatic || !record.polled)
+      continue;
+
+    const Entity entity = record.entity;
+    auto pose = _ecm.Component<components::Pose>(entity);
+    if (nullptr == pose)
+      continue;
+
+    IGN_PROFILE_BEGIN("Local pose");
+    const Entity topLevelModelEnt = record.topLevelModel;
+
+    const auto &frameData = this->linkFrameData[i];
+    const auto &worldPose = frameData.pose;
+
+    // update the link or top level model pose if this is the first update,
+    // or if the link pose has changed since the last update
+    // (if the link pose hasn't changed, there's no need for a pose update)
+    const auto worldPoseMath3d = ignition::math::eigen3::convert(worldPose);
+    const bool moved = !record.hasWorldPose ||
+        !this->pose3Eql(record.worldPose, worldPoseMath3d);
+    if (this->sleepSteps > 0)
+    {
+      if (moved)
       {
-        if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
-        {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
+        this->WakeLink(record);
+      }
+      else if (!record.asleep && ++record.restingSteps >= this->sleepSteps)
+      {
+        record.asleep = true;
+        ++this->sleepingLinkCount;
+      }
+    }
 
-          auto entityWorldPose = math::eigen3::convert(entityFrameData.pose);
-          ignition::math::Vector3d entityWorldLinearAcc =
-              math::eigen3::convert(entityFrameData.linearAcceleration);
+    if (moved)
+    {
+      // cache the updated link pose to check if the link pose has changed
+      // during the next iteration
+      record.worldPose = worldPoseMath3d;
+      record.hasWorldPose = true;
+      if (this->trackBoundingBoxes)
+        this->movedModels.insert(topLevelModelEnt);
+
+      if (record.canonical)
+      {
+        // This is the canonical link, update the top level model.
+        // The pose of this link w.r.t its top level model never changes
+        // because it's "fixed" to the model. Instead, we change
+        // the top level model's pose here. The physics engine gives us the
+        // pose of this link relative to world so to set the top level
+        // model's pose, we have to post-multiply it by the inverse of the
+        // transform of the link w.r.t to its top level model.
+        math::Pose3d linkPoseFromTopLevelModel;
+        linkPoseFromTopLevelModel =
+            this->RelativePose(topLevelModelEnt, entity, _ecm);
+
+        // update top level model's pose
+        auto mutableModelPose =
+           _ecm.Component<components::Pose>(topLevelModelEnt);
+        *(mutableModelPose) = components::Pose(
+            math::eigen3::convert(worldPose) *
+            linkPoseFromTopLevelModel.Inverse());
+
+        _ecm.SetChanged(topLevelModelEnt, components::Pose::typeId,
+            ComponentState::PeriodicChange);
+      }
+      else
+      {
+        // Compute the relative pose of this link from the top level model
+        // first get the world pose of the top level model
+        auto worldComp =
+            _ecm.Component<components::ParentEntity>(topLevelModelEnt);
+        // if the worldComp is a nullptr, something is wrong with ECS
+        if (!worldComp)
+        {
+          ignerr << "The parent component of " << topLevelModelEnt
+                 << " could not be found. This should never happen!\n";
+          continue;
+        }
+        math::Pose3d parentWorldPose =
+            this->RelativePose(worldComp->Data(), record.parent, _ecm);
+
+        // Unlike canonical links, pose of regular links can move relative
+        // to the parent. Same for links inside nested models.
+        *pose = components::Pose(math::eigen3::convert(worldPose) +
+                                  parentWorldPose.Inverse());
+        _ecm.SetChanged(entity, components::Pose::typeId,
+            ComponentState::PeriodicChange);
+      }
+    }
+    IGN_PROFILE_END();
 
-          auto entityBodyLinearAcc =
-              entityWorldPose.Rot().RotateVectorReverse(entityWorldLinearAcc);
-          *_linearAcc = components::LinearAcceleration(entityBodyLinearAcc);
-        }
+    // Populate world poses, velocities and accelerations of the link. For
+    // now these components are updated only if another system has created
+    // the corresponding component on the entity.
+    auto worldPoseComp = _ecm.Component<components::WorldPose>(entity);
+    if (worldPoseComp)
+    {
+      auto state =
+          worldPoseComp->SetData(math::eigen3::convert(frameData.pose),
+          this->pose3Eql) ?
+          ComponentState::PeriodicChange :
+          ComponentState::NoChange;
+      _ecm.SetChanged(entity, components::WorldPose::typeId, state);
+    }
 
-        return true;
-      });
+    // Velocity in world coordinates
+    auto worldLinVelComp =
+        _ecm.Component<components::WorldLinearVelocity>(entity);
+    if (worldLinVelComp)
+    {
+      auto state = worldLinVelComp->SetData(
+            math::eigen3::convert(frameData.linearVelocity),
+            this->vec3Eql) ?
+            ComponentState::PeriodicChange :
+            ComponentState::NoChange;
+      _ecm.SetChanged(entity,
+          components::WorldLinearVelocity::typeId, state);
+    }
+
+    // Angular velocity in world frame coordinates
+    auto worldAngVelComp =
+        _ecm.Component<components::WorldAngularVelocity>(entity);
+    if (worldAngVelComp)
+    {
+      auto state = worldAngVelComp->SetData(
+          math::eigen3::convert(frameData.angularVelocity),
+          this->vec3Eql) ?
+          ComponentState::PeriodicChange :
+          ComponentState::NoChange;
+      _ecm.SetChanged(entity,
+          components::WorldAngularVelocity::typeId, state);
+    }
+
+    // Acceleration in world frame coordinates
+    auto worldLinAccelComp =
+        _ecm.Component<components::WorldLinearAcceleration>(entity);
+    if (worldLinAccelComp)
+    {
+      auto state = worldLinAccelComp->SetData(
+          math::eigen3::convert(frameData.linearAcceleration),
+          this->vec3Eql) ?
+          ComponentState::PeriodicChange :
+          ComponentState::NoChange;
+      _ecm.SetChanged(entity,
+          components::WorldLinearAcceleration::typeId, state);
+    }
+
+    // Angular acceleration in world frame coordinates
+    auto worldAngAccelComp =
+        _ecm.Component<components::WorldAngularAcceleration>(entity);
+
+    if (worldAngAccelComp)
+    {
+      auto state = worldAngAccelComp->SetData(
+          math::eigen3::convert(frameData.angularAcceleration),
+          this->vec3Eql) ?
+          ComponentState::PeriodicChange :
+          ComponentState::NoChange;
+      _ecm.SetChanged(entity,
+          components::WorldAngularAcceleration::typeId, state);
+    }
+
+    const Eigen::Matrix3d R_bs = worldPose.linear().transpose(); // NOLINT
+
+    // Velocity in body-fixed frame coordinates
+    auto bodyLinVelComp =
+        _ecm.Component<components::LinearVelocity>(entity);
+    if (bodyLinVelComp)
+    {
+      Eigen::Vector3d bodyLinVel = R_bs * frameData.linearVelocity;
+      auto state =
+          bodyLinVelComp->SetData(math::eigen3::convert(bodyLinVel),
+          this->vec3Eql) ?
+          ComponentState::PeriodicChange :
+          ComponentState::NoChange;
+      _ecm.SetChanged(entity, components::LinearVelocity::typeId, state);
+    }
+
+    // Angular velocity in body-fixed frame coordinates
+    auto bodyAngVelComp =
+        _ecm.Component<components::AngularVelocity>(entity);
+    if (bodyAngVelComp)
+    {
+      Eigen::Vector3d bodyAngVel = R_bs * frameData.angularVelocity;
+      auto state =
+          bodyAngVelComp->SetData(math::eigen3::convert(bodyAngVel),
+          this->vec3Eql) ?
+          ComponentState::PeriodicChange :
+          ComponentState::NoChange;
+      _ecm.SetChanged(entity, components::AngularVelocity::typeId,
+          state);
+    }
+
+    // Acceleration in body-fixed frame coordinates
+    auto bodyLinAccelComp =
+        _ecm.Component<components::LinearAcceleration>(entity);
+    if (bodyLinAccelComp)
+    {
+      Eigen::Vector3d bodyLinAccel = R_bs * frameData.linearAcceleration;
+      auto state =
+          bodyLinAccelComp->SetData(math::eigen3::convert(bodyLinAccel),
+          this->vec3Eql)?
+          ComponentState::PeriodicChange :
+          ComponentState::NoChange;
+      _ecm.SetChanged(entity, components::LinearAcceleration::typeId,
+          state);
+    }
+
+    // Angular acceleration in world frame coordinates
+    auto bodyAngAccelComp =
+        _ecm.Component<components::AngularAcceleration>(entity);
+    if (bodyAngAccelComp)
+    {
+      Eigen::Vector3d bodyAngAccel = R_bs * frameData.angularAcceleration;
+      auto state =
+          bodyAngAccelComp->SetData(math::eigen3::convert(bodyAngAccel),
+          this->vec3Eql) ?
+          ComponentState::PeriodicChange :
+          ComponentState::NoChange;
+      _ecm.SetChanged(entity, components::AngularAcceleration::typeId,
+          state);
+    }
+  }
+  IGN_PROFILE_END();
+
+  // pose/velocity/acceleration of non-link entities such as sensors /
+  // collisions. These get updated only if another system has created a
+  // components::WorldPose component for the entity.
+  // Populated components:
+  // * WorldPose
+  // * WorldLinearVelocity
+  // * AngularVelocity
+  // * LinearAcceleration
+
+  IGN_PROFILE_BEGIN("Sensors / collisions");
+  if (_ecm.HasComponentType(components::WorldPose::typeId) ||
+      _ecm.HasComponentType(components::WorldLinearVelocity::typeId) ||
+      _ecm.HasComponentType(components::AngularVelocity::typeId) ||
+      _ecm.HasComponentType(components::LinearAcceleration::typeId))
+  {
+    _ecm.Each<components::Pose, components::ParentEntity>(
+        [&](const Entity &_entity, const components::Pose *_pose,
+            const components::ParentEntity *_parent)->bool
+        {
+          // check if parent entity is a link, e.g. entity is sensor /
+          // collision
+          auto linkIt = this->linkRecordIndices.find(_parent->Data());
+          if (linkIt == this->linkRecordIndices.end())
+            return true;
+
+          auto worldPoseComp = _ecm.Component<components::WorldPose>(_entity);
+          auto worldLinVelComp =
+              _ecm.Component<components::WorldLinearVelocity>(_entity);
+          auto angVelComp =
+              _ecm.Component<components::AngularVelocity>(_entity);
+          auto linAccComp =
+              _ecm.Component<components::LinearAcceleration>(_entity);
+          if (!worldPoseComp && !worldLinVelComp && !angVelComp &&
+              !linAccComp)
+          {
+            return true;
+          }
+
+          const auto entityFrameData = this->LinkFrameDataAtOffset(
+              this->linkFrameData[linkIt->second], _pose->Data());
+          const auto entityWorldPose =
+              math::eigen3::convert(entityFrameData.pose);
+
+          if (worldPoseComp)
+            *worldPoseComp = components::WorldPose(entityWorldPose);
+
+          if (worldLinVelComp)
+          {
+            *worldLinVelComp = components::WorldLinearVelocity(
+                math::eigen3::convert(entityFrameData.linearVelocity));
+          }
+
+          // body angular velocity
+          if (angVelComp)
+          {
+            *angVelComp = components::AngularVelocity(
+                entityWorldPose.Rot().RotateVectorReverse(
+                math::eigen3::convert(entityFrameData.angularVelocity)));
+          }
+
+          // body linear acceleration
+          if (linAccComp)
+          {
+            *linAccComp = components::LinearAcceleration(
+                entityWorldPose.Rot().RotateVectorReverse(
+                math::eigen3::convert(entityFrameData.linearAcceleration)));
+          }
+
+          return true;
+        });
+  }
   IGN_PROFILE_END();
 
   // Clear reset components
@@ -2065,7 +3037,8 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm)
     _ecm.RemoveComponent<components::JointVelocityReset>(entity);
   }
 
-  // Clear pending commands
+  // Clear pending commands. Command components are zeroed in place and
+  // kept, so commanding again every step doesn't add or remove components.
   _ecm.Each<components::JointForceCmd>(
       [&](const Entity &, components::JointForceCmd *_force) -> bool
       {
@@ -2076,7 +3049,15 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm)
   _ecm.Each<components::ExternalWorldWrenchCmd >(
       [&](const Entity &, components::ExternalWorldWrenchCmd *_wrench) -> bool
       {
-        _wrench->Data().Clear();
+        // Zero the values instead of clearing the message, so the force
+        // and torque messages aren't freed and allocated again by the next
+        // command
+        auto &wrench = _wrench->Data();
+        if (wrench.has_force())
+          msgs::Set(wrench.mutable_force(), math::Vector3d::Zero);
+        if (wrench.has_torque())
+          msgs::Set(wrench.mutable_torque(), math::Vector3d::Zero);
+        wrench.clear_header();
         return true;
       });
 
@@ -2097,44 +3078,112 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm)
 
   // Update joint positions
   IGN_PROFILE_BEGIN("Joints");
-  _ecm.Each<components::Joint, components::JointPosition>(
-      [&](const Entity &_entity, components::Joint *,
-          components::JointPosition *_jointPos) -> bool
+  // Positions and velocities are written in a single pass over the dense
+  // joint list. Vectors are only resized when the number of degrees of
+  // freedom differs, so they're updated in place after the first step.
+  const bool hasPositions =
+      _ecm.HasComponentType(components::JointPosition::typeId);
+  const bool hasVelocities =
+      _ecm.HasComponentType(components::JointVelocity::typeId);
+  if (hasPositions || hasVelocities)
+  {
+    for (const auto &record : this->jointRecords)
+    {
+      auto jointPos = hasPositions ?
+          _ecm.Component<components::JointPosition>(record.entity) : nullptr;
+      if (jointPos)
       {
-        if (auto jointPhys = this->entityJointMap.Get(_entity))
-        {
-          _jointPos->Data().resize(jointPhys->GetDegreesOfFreedom());
-          for (std::size_t i = 0; i < jointPhys->GetDegreesOfFreedom();
-               ++i)
-          {
-            _jointPos->Data()[i] = jointPhys->GetPosition(i);
-          }
-          _ecm.SetChanged(_entity, components::JointPosition::typeId,
-              ComponentState::PeriodicChange);
-        }
-        return true;
-      });
-
-  // Update joint Velocities
-  _ecm.Each<components::Joint, components::JointVelocity>(
-      [&](const Entity &_entity, components::Joint *,
-          components::JointVelocity *_jointVel) -> bool
+        auto &positions = jointPos->Data();
+        if (positions.size() != record.dofs)
+          positions.resize(record.dofs);
+        for (std::size_t i = 0; i < record.dofs; ++i)
+          positions[i] = record.joint->GetPosition(i);
+
+        _ecm.SetChanged(record.entity, components::JointPosition::typeId,
+            ComponentState::PeriodicChange);
+      }
+
+      auto jointVel = hasVelocities ?
+          _ecm.Component<components::JointVelocity>(record.entity) : nullptr;
+      if (jointVel)
       {
-        if (auto jointPhys = this->entityJointMap.Get(_entity))
-        {
-          _jointVel->Data().resize(jointPhys->GetDegreesOfFreedom());
-          for (std::size_t i = 0; i < jointPhys->GetDegreesOfFreedom();
-               ++i)
-          {
-            _jointVel->Data()[i] = jointPhys->GetVelocity(i);
-          }
-        }
-        return true;
-      });
+        auto &velocities = jointVel->Data();
+        if (velocities.size() != record.dofs)
+          velocities.resize(record.dofs);
+        for (std::size_t i = 0; i < record.dofs; ++i)
+          velocities[i] = record.joint->GetVelocity(i);
+      }
+    }
+  }
   IGN_PROFILE_END();
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::UpdateStepSize(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("PhysicsPrivate::UpdateStepSize");
+
+  bool busy{false};
+  if (this->velocityThreshold > 0.0)
+  {
+    const double threshold = this->velocityThreshold * this->velocityThreshold;
+    for (std::size_t i = 0; i < this->linkRecords.size() && !busy; ++i)
+    {
+      const auto &record = this->linkRecords[i];
+      busy = !record.isStatic && record.polled &&
+          this->linkFrameData[i].linearVelocity.squaredNorm() >= threshold;
+    }
+  }
 
-  // TODO(louise) Skip this if there are no collision features
-  this->UpdateCollisions(_ecm);
+  Entity worldEntity = _ecm.EntityByComponents(components::World());
+  if (!busy && this->contactThreshold > 0 &&
+      this->entityWorldMap.HasEntity(worldEntity))
+  {
+    auto worldCollisionFeature =
+        this->entityWorldMap.EntityCast<ContactFeatureList>(worldEntity);
+    busy = worldCollisionFeature &&
+        worldCollisionFeature->GetContactsFromLastStep().size() >=
+        this->contactThreshold;
+  }
+
+  auto request = [this](const std::chrono::steady_clock::duration &_step)
+  {
+    if (_step == this->requestedStepSize)
+      return;
+    this->requestedStepSize = _step;
+    this->eventMgr->Emit<events::RequestStepSize>(_step);
+  };
+
+  if (busy)
+  {
+    this->quietCount = 0;
+    auto step = std::max(this->minStepSize,
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        _info.dt * this->shrinkFactor));
+    if (step < _info.dt)
+      request(step);
+    return;
+  }
+
+  // Grow back one factor at a time, until the world's step is reached
+  if (this->requestedStepSize.count() == 0 ||
+      ++this->quietCount < this->quietSteps)
+  {
+    return;
+  }
+  this->quietCount = 0;
+
+  auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      _info.dt * this->growFactor);
+  auto physicsComp = _ecm.Component<components::Physics>(worldEntity);
+  if (nullptr == physicsComp || step >= std::chrono::duration_cast<
+      std::chrono::steady_clock::duration>(std::chrono::duration<double>(
+      physicsComp->Data().MaxStepSize())))
+  {
+    step = std::chrono::steady_clock::duration::zero();
+  }
+  request(step);
 }
 
 //////////////////////////////////////////////////
@@ -2178,22 +3227,31 @@ void PhysicsPrivate::UpdateCollisions(EntityComponentManager &_ecm)
     return;
   }
 
+  // Only gather contacts for collisions which have a consumer
+  this->contactSensorCollisions.clear();
+  _ecm.Each<components::Collision, components::ContactSensorData>(
+      [&](const Entity &_collEntity, const components::Collision *,
+          const components::ContactSensorData *) -> bool
+      {
+        this->contactSensorCollisions.push_back(_collEntity);
+        return true;
+      });
+  std::sort(this->contactSensorCollisions.begin(),
+      this->contactSensorCollisions.end());
+
+  auto hasConsumer = [this](const Entity _entity)
+  {
+    return std::binary_search(this->contactSensorCollisions.begin(),
+        this->contactSensorCollisions.end(), _entity);
+  };
+
   // Each contact object we get from ign-physics contains the EntityPtrs of the
   // two colliding entities and other data about the contact such as the
-  // position. This map groups contacts so that it is easy to query all the
-  // contacts of one entity.
-  using EntityContactMap = std::unordered_map<Entity,
-      std::deque<const WorldShapeType::ContactPoint *>>;
-
-  // This data structure is essentially a mapping between a pair of entities and
-  // a list of pointers to their contact object. We use a map inside a map to
-  // create msgs::Contact objects conveniently later on.
-  std::unordered_map<Entity, EntityContactMap> entityContactMap;
-
-  // Note that we are temporarily storing pointers to elements in this
-  // ("allContacts") container. Thus, we must make sure it doesn't get destroyed
-  // until the end of this function.
-  auto allContacts = worldCollisionFeature->GetContactsFromLastStep();
+  // position. Flatten them into the arena, once for each collision which
+  // consumes it, and sort by collision pair so that all contacts of one
+  // collision are contiguous.
+  this->contactArena.clear();
+  const auto allContacts = worldCollisionFeature->GetContactsFromLastStep();
   for (const auto &contactComposite : allContacts)
   {
     const auto &contact = contactComposite.Get<WorldShapeType::ContactPoint>();
@@ -2202,58 +3260,116 @@ void PhysicsPrivate::UpdateCollisions(EntityComponentManager &_ecm)
     auto coll2Entity =
       this->entityCollisionMap.Get(ShapePtrType(contact.collision2));
 
+    if (coll1Entity == kNullEntity || coll2Entity == kNullEntity)
+      continue;
 
-    if (coll1Entity != kNullEntity && coll2Entity != kNullEntity)
+    const std::size_t order = this->contactArena.size();
+    if (hasConsumer(coll1Entity))
     {
-      entityContactMap[coll1Entity][coll2Entity].push_back(&contact);
-      entityContactMap[coll2Entity][coll1Entity].push_back(&contact);
+      this->contactArena.push_back(
+          {coll1Entity, coll2Entity, order, contact.point});
+    }
+    if (hasConsumer(coll2Entity))
+    {
+      this->contactArena.push_back(
+          {coll2Entity, coll1Entity, order, contact.point});
     }
   }
+  std::sort(this->contactArena.begin(), this->contactArena.end(),
+      [](const ContactEntry &_a, const ContactEntry &_b)
+      {
+        return std::tie(_a.collision1, _a.collision2, _a.order) <
+               std::tie(_b.collision1, _b.collision2, _b.order);
+      });
 
   // Go through each collision entity that has a ContactData component and
-  // set the component value to the list of contacts that correspond to
-  // the collision entity
+  // update the component value in place, so that protobuf can reuse the
+  // messages allocated in previous steps.
+  auto arenaIt = this->contactArena.begin();
   _ecm.Each<components::Collision, components::ContactSensorData>(
       [&](const Entity &_collEntity1, components::Collision *,
           components::ContactSensorData *_contacts) -> bool
       {
-        if (entityContactMap.find(_collEntity1) == entityContactMap.end())
+        auto &contactsMsg = _contacts->Data();
+        contactsMsg.Clear();
+
+        // Each iterates in arbitrary order, so search from the start if the
+        // arena is past this collision
+        if (arenaIt == this->contactArena.end() ||
+            arenaIt->collision1 > _collEntity1)
         {
-          // Clear the last contact data
-          *_contacts = components::ContactSensorData();
-          return true;
+          arenaIt = this->contactArena.begin();
         }
+        arenaIt = std::lower_bound(arenaIt, this->contactArena.end(),
+            _collEntity1, [](const ContactEntry &_entry, const Entity _entity)
+            {
+              return _entry.collision1 < _entity;
+            });
 
-        const auto &contactMap = entityContactMap[_collEntity1];
-
-        msgs::Contacts contactsComp;
-
-        for (const auto &[collEntity2, contactData] : contactMap)
+        msgs::Contact *contactMsg{nullptr};
+        for (; arenaIt != this->contactArena.end() &&
+               arenaIt->collision1 == _collEntity1; ++arenaIt)
         {
-          msgs::Contact *contactMsg = contactsComp.add_contact();
-          contactMsg->mutable_collision1()->set_id(_collEntity1);
-          contactMsg->mutable_collision2()->set_id(collEntity2);
-          for (const auto &contact : contactData)
+          if (nullptr == contactMsg ||
+              static_cast<Entity>(contactMsg->collision2().id()) !=
+              arenaIt->collision2)
           {
-            auto *position = contactMsg->add_position();
-            position->set_x(contact->point.x());
-            position->set_y(contact->point.y());
-            position->set_z(contact->point.z());
+            contactMsg = contactsMsg.add_contact();
+            contactMsg->mutable_collision1()->set_id(_collEntity1);
+            contactMsg->mutable_collision2()->set_id(arenaIt->collision2);
           }
+          auto *position = contactMsg->add_position();
+          position->set_x(arenaIt->point.x());
+          position->set_y(arenaIt->point.y());
+          position->set_z(arenaIt->point.z());
+        }
+
+        // Compare with the previous step for systems which only need to
+        // know when contacts begin or end
+        auto changesComp = _ecm.Component<components::ContactChanges>(
+            _collEntity1);
+        if (nullptr != changesComp)
+        {
+          auto &changes = changesComp->Data();
+          this->contactTouching.clear();
+          for (const auto &contact : contactsMsg.contact())
+            this->contactTouching.push_back(contact.collision2().id());
+
+          changes.began.clear();
+          changes.ended.clear();
+          std::set_difference(this->contactTouching.begin(),
+              this->contactTouching.end(), changes.touching.begin(),
+              changes.touching.end(), std::back_inserter(changes.began));
+          std::set_difference(changes.touching.begin(),
+              changes.touching.end(), this->contactTouching.begin(),
+              this->contactTouching.end(), std::back_inserter(changes.ended));
+          changes.touching.swap(this->contactTouching);
         }
-        *_contacts = components::ContactSensorData(contactsComp);
 
         return true;
       });
 }
 
 physics::FrameData3d PhysicsPrivate::LinkFrameDataAtOffset(
-      const LinkPtrType &_link, const math::Pose3d &_pose) const
+      const physics::FrameData3d &_linkFrameData,
+      const math::Pose3d &_pose) const
 {
-  physics::FrameData3d parent;
-  parent.pose = math::eigen3::convert(_pose);
-  physics::RelativeFrameData3d relFrameData(_link->GetFrameID(), parent);
-  return this->engine->Resolve(relFrameData, physics::FrameID::World());
+  // The offset frame is rigidly attached to the link, so its motion follows
+  // from the link's motion without another query to the physics engine.
+  physics::FrameData3d result;
+  result.pose = _linkFrameData.pose * math::eigen3::convert(_pose);
+
+  const Eigen::Vector3d r = _linkFrameData.pose.linear() *
+      math::eigen3::convert(_pose.Pos());
+  const Eigen::Vector3d &w = _linkFrameData.angularVelocity;
+  const Eigen::Vector3d &alpha = _linkFrameData.angularAcceleration;
+
+  result.linearVelocity = _linkFrameData.linearVelocity + w.cross(r);
+  result.angularVelocity = w;
+  result.linearAcceleration = _linkFrameData.linearAcceleration +
+      alpha.cross(r) + w.cross(w.cross(r));
+  result.angularAcceleration = alpha;
+  return result;
 }
 
 IGNITION_ADD_PLUGIN(Physics,
@@ -62,6 +62,50 @@ namespace systems
 
   /// \class Physics Physics.hh ignition/gazebo/systems/Physics.hh
   /// \brief Base class for a System.
+  ///
+  /// ## System Parameters
+  ///
+  /// - `<parallel_step>`: Set to true to step each physics world
+  /// concurrently on a worker pool. Defaults to false.
+  /// - `<sleep_steps>`: Number of steps a link's pose must stay unchanged
+  /// before the system stops updating its components. A sleeping link is
+  /// woken by contact with an awake body, by commands on its model, joints
+  /// or itself, and is polled again every `sleep_steps` steps in case it was
+  /// moved otherwise. Defaults to 0, which disables sleeping.
+  /// - `<async_creation>`: Set to true to load the collision meshes of
+  /// newly spawned models on a worker thread. The model is added to the
+  /// physics engine as a whole, at the start of the first iteration after
+  /// all its meshes are loaded. Defaults to false.
+  /// - `<substeps>`: Number of physics steps taken per iteration, each
+  /// advancing an equal part of the iteration's step size. Components are
+  /// read once before the first sub-step and written once after the last.
+  /// Joint force and velocity commands and link wrenches are held for all
+  /// sub-steps. Defaults to 1.
+  /// - `<bounding_box_update_rate>`: Maximum rate in Hz, in sim time, at
+  /// which AxisAlignedBox components of models are updated. Only models
+  /// which moved since their last update are queried. Defaults to 0, which
+  /// updates them every iteration.
+  /// - `<adaptive_step>`: Shrink the step size while the world is busy,
+  /// and grow it back to the world's `<max_step_size>` while it's quiet.
+  /// The step is requested from the simulation runner through
+  /// events::RequestStepSize, and UpdateInfo::dt holds the step in use.
+  /// It may contain:
+  ///   - `<min_step_size>`: Smallest step in seconds. Defaults to 0.0001.
+  ///   - `<contact_threshold>`: Number of contacts from which the world is
+  ///   busy. Defaults to 0, which ignores contacts.
+  ///   - `<velocity_threshold>`: Link speed in m/s from which the world is
+  ///   busy. Defaults to 0, which ignores velocities.
+  ///   - `<shrink_factor>`: Factor applied to the step on each busy
+  ///   iteration. Defaults to 0.5.
+  ///   - `<grow_factor>`: Factor applied to the step after `<quiet_steps>`
+  ///   quiet iterations. Defaults to 2.
+  ///   - `<quiet_steps>`: Defaults to 10.
+  /// - `<publish_timing>`: Set to true to publish the wall time spent in
+  /// each phase of the system's update on
+  /// `/world/<world>/physics/timing`, as an ignition::msgs::Double_V.
+  /// The data holds the number of timed iterations, followed by the total
+  /// seconds spent in UpdatePhysics, Step, UpdateSim and UpdateCollisions.
+  /// Defaults to false.
   class Physics:
     public System,
     public ISystemConfigure,
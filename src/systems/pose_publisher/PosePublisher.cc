@@ -19,6 +19,7 @@
 
 #include <ignition/msgs/pose.pb.h>
 
+#include <algorithm>
 #include <stack>
 #include <string>
 #include <unordered_map>
@@ -47,6 +48,7 @@
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/Sensor.hh"
 #include "ignition/gazebo/components/Visual.hh"
+#include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/Model.hh"
 
@@ -54,20 +56,63 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+/// \brief Topics poses are published on, and the entities whose poses are
+/// published on them
+struct PoseOutput
+{
+  /// \brief Model served by this output. Null for the aggregated world topic.
+  Entity model{kNullEntity};
+
+  /// \brief Publisher for pose data
+  transport::Node::Publisher posePub;
+
+  /// \brief Publisher for static pose data
+  transport::Node::Publisher poseStaticPub;
+
+  /// \brief Entities whose poses are published, in the order they were found
+  std::vector<Entity> entities;
+};
+
 /// \brief Private data class for PosePublisher
 class ignition::gazebo::systems::PosePublisherPrivate
 {
-  /// \brief Initializes internal caches for entities whose poses are to be
-  /// published and their names
+  /// \brief Initializes internal caches for entities of a model whose poses
+  /// are to be published and their names
+  /// \param[in] _ecm Immutable reference to the entity component manager
+  /// \param[in] _model Model whose entities are published
+  /// \param[out] _output Output the entities are added to
+  public: void InitializeEntitiesToPublish(const EntityComponentManager &_ecm,
+      Entity _model, PoseOutput &_output);
+
+  /// \brief Create the publishers of an output
+  /// \param[in] _output Output to advertise
+  /// \param[in] _topic Dynamic pose topic. Static poses are published on the
+  /// same topic with a "_static" suffix.
+  public: void Advertise(PoseOutput &_output, const std::string &_topic);
+
+  /// \brief Start and stop serving the world's models as they're added and
+  /// removed. Only used when attached to a world.
   /// \param[in] _ecm Immutable reference to the entity component manager
-  public: void InitializeEntitiesToPublish(const EntityComponentManager &_ecm);
+  public: void UpdateWorldModels(const EntityComponentManager &_ecm);
+
+  /// \brief Start serving a top level model of the world
+  /// \param[in] _ecm Immutable reference to the entity component manager
+  /// \param[in] _model Model entity
+  public: void AddWorldModel(const EntityComponentManager &_ecm,
+      Entity _model);
+
+  /// \brief Stop serving a top level model of the world
+  /// \param[in] _model Model entity
+  public: void RemoveWorldModel(Entity _model);
 
   /// \brief Helper function to collect entity pose data
   /// \param[in] _ecm Immutable reference to the entity component manager
+  /// \param[in] _entities Entities whose poses are collected
   /// \param[out] _poses Pose vector to be filled
   /// \param[in] _static True to fill only static transforms,
   /// false to fill only dynamic transforms
   public: void FillPoses(const EntityComponentManager &_ecm,
+      const std::vector<Entity> &_entities,
       std::vector<std::pair<Entity, math::Pose3d>> &_poses,
       bool _static);
 
@@ -84,18 +129,33 @@ class ignition::gazebo::systems::PosePublisherPrivate
   /// \brief Ignition communication node.
   public: transport::Node node;
 
-  /// \brief publisher for pose data
-  public: transport::Node::Publisher posePub;
+  /// \brief Topics poses are published on. There's a single output when
+  /// attached to a model, or when all of a world's models are aggregated on
+  /// one topic, and one output per model otherwise.
+  public: std::vector<PoseOutput> outputs;
 
   /// \brief True to publish static transforms to a separate topic
   public: bool staticPosePublisher = false;
 
-  /// \brief publisher for pose data
-  public: transport::Node::Publisher poseStaticPub;
-
   /// \brief Model interface
   public: Model model{kNullEntity};
 
+  /// \brief World entity, if attached to a world
+  public: Entity world{kNullEntity};
+
+  /// \brief Names of the top level models served when attached to a world.
+  /// Empty to serve all of them.
+  public: std::unordered_set<std::string> modelNames;
+
+  /// \brief True to publish each model of the world on its own topic
+  public: bool perModelTopics{false};
+
+  /// \brief Top level model each published entity belongs to
+  public: std::unordered_map<Entity, Entity> entityModels;
+
+  /// \brief Whether the world's models have been collected
+  public: bool worldInitialized{false};
+
   /// \brief True to publish link pose
   public: bool publishLinkPose = true;
 
@@ -129,8 +189,8 @@ class ignition::gazebo::systems::PosePublisherPrivate
   /// static_update_frequency parameter
   public: std::chrono::steady_clock::duration staticUpdatePeriod{0};
 
-  /// \brief Cache of entities, their frame names and their child frame names.
-  /// The key is the entity whose pose is to be published.
+  /// \brief Cache of entities, their frame names and their child frame names,
+  /// for all outputs. The key is the entity whose pose is to be published.
   /// The frame name is the scoped name of the parent entity.
   /// The child frame name is the scoped name of the entity (the key)
   public: std::unordered_map<Entity, std::pair<std::string, std::string>>
@@ -182,10 +242,14 @@ void PosePublisher::Configure(const Entity &_entity,
 {
   this->dataPtr->model = Model(_entity);
 
-  if (!this->dataPtr->model.Valid(_ecm))
+  if (_ecm.Component<components::World>(_entity))
+  {
+    this->dataPtr->world = _entity;
+  }
+  else if (!this->dataPtr->model.Valid(_ecm))
   {
-    ignerr << "PosePublisher plugin should be attached to a model entity. "
-      << "Failed to initialize." << std::endl;
+    ignerr << "PosePublisher plugin should be attached to a model or world "
+      << "entity. Failed to initialize." << std::endl;
     return;
   }
 
@@ -241,32 +305,29 @@ void PosePublisher::Configure(const Entity &_entity,
   this->dataPtr->usePoseV =
     _sdf->Get<bool>("use_pose_vector_msg", this->dataPtr->usePoseV).first;
 
-  std::string poseTopic = scopedName(_entity, _ecm) + "/pose";
-  std::string staticPoseTopic = poseTopic + "_static";
-
-  if (this->dataPtr->usePoseV)
-  {
-    this->dataPtr->posePub =
-      this->dataPtr->node.Advertise<ignition::msgs::Pose_V>(poseTopic);
-
-    if (this->dataPtr->staticPosePublisher)
-    {
-      this->dataPtr->poseStaticPub =
-          this->dataPtr->node.Advertise<ignition::msgs::Pose_V>(
-          staticPoseTopic);
-    }
-  }
-  else
+  if (this->dataPtr->world != kNullEntity)
   {
-    this->dataPtr->posePub =
-      this->dataPtr->node.Advertise<ignition::msgs::Pose>(poseTopic);
-    if (this->dataPtr->staticPosePublisher)
+    if (_sdf->HasElement("model"))
     {
-      this->dataPtr->poseStaticPub =
-          this->dataPtr->node.Advertise<ignition::msgs::Pose>(
-          staticPoseTopic);
+      auto ptr = const_cast<sdf::Element *>(_sdf.get());
+      for (auto modelElem = ptr->GetElement("model"); modelElem;
+           modelElem = modelElem->GetNextElement("model"))
+      {
+        this->dataPtr->modelNames.insert(modelElem->Get<std::string>());
+      }
     }
+
+    this->dataPtr->perModelTopics = _sdf->Get<bool>("per_model_topics",
+        this->dataPtr->perModelTopics).first;
+
+    // Per model outputs are added as models are found
+    if (this->dataPtr->perModelTopics)
+      return;
   }
+
+  this->dataPtr->outputs.emplace_back();
+  this->dataPtr->Advertise(this->dataPtr->outputs.back(),
+      scopedName(_entity, _ecm) + "/pose");
 }
 
 //////////////////////////////////////////////////
@@ -283,6 +344,10 @@ void PosePublisher::PostUpdate(const UpdateInfo &_info,
         << "s]. System may not work properly." << std::endl;
   }
 
+  // Keep track of the world's models even while paused, so none are missed
+  if (this->dataPtr->world != kNullEntity)
+    this->dataPtr->UpdateWorldModels(_ecm);
+
   // Nothing left to do if paused.
   if (_info.paused)
     return;
@@ -312,50 +377,194 @@ void PosePublisher::PostUpdate(const UpdateInfo &_info,
 
   if (!this->dataPtr->initialized)
   {
-    this->dataPtr->InitializeEntitiesToPublish(_ecm);
+    if (this->dataPtr->world == kNullEntity &&
+        !this->dataPtr->outputs.empty())
+    {
+      this->dataPtr->InitializeEntitiesToPublish(_ecm,
+          this->dataPtr->model.Entity(), this->dataPtr->outputs.front());
+    }
     this->dataPtr->initialized = true;
   }
 
+  auto stampMsg = convert<msgs::Time>(_info.simTime);
+  for (auto &output : this->dataPtr->outputs)
+  {
+    // if static transforms are published through a different topic
+    if (this->dataPtr->staticPosePublisher)
+    {
+      if (publishStatic)
+      {
+        this->dataPtr->staticPoses.clear();
+        this->dataPtr->FillPoses(_ecm, output.entities,
+            this->dataPtr->staticPoses, true);
+        this->dataPtr->PublishPoses(this->dataPtr->staticPoses, stampMsg,
+            output.poseStaticPub);
+      }
 
-  // if static transforms are published through a different topic
-  if (this->dataPtr->staticPosePublisher)
+      if (publish)
+      {
+        this->dataPtr->poses.clear();
+        this->dataPtr->FillPoses(_ecm, output.entities, this->dataPtr->poses,
+            false);
+        this->dataPtr->PublishPoses(this->dataPtr->poses, stampMsg,
+            output.posePub);
+      }
+    }
+    // publish all transforms to the same topic
+    else if (publish)
+    {
+      this->dataPtr->poses.clear();
+      this->dataPtr->FillPoses(_ecm, output.entities, this->dataPtr->poses,
+          true);
+      this->dataPtr->FillPoses(_ecm, output.entities, this->dataPtr->poses,
+          false);
+      this->dataPtr->PublishPoses(this->dataPtr->poses, stampMsg,
+          output.posePub);
+    }
+  }
+
+  if (publishStatic)
+    this->dataPtr->lastStaticPosePubTime = _info.simTime;
+  if (publish)
+    this->dataPtr->lastPosePubTime = _info.simTime;
+}
+
+//////////////////////////////////////////////////
+void PosePublisherPrivate::Advertise(PoseOutput &_output,
+    const std::string &_topic)
+{
+  std::string staticPoseTopic = _topic + "_static";
+
+  if (this->usePoseV)
+  {
+    _output.posePub = this->node.Advertise<ignition::msgs::Pose_V>(_topic);
+
+    if (this->staticPosePublisher)
+    {
+      _output.poseStaticPub =
+          this->node.Advertise<ignition::msgs::Pose_V>(staticPoseTopic);
+    }
+  }
+  else
   {
-    if (publishStatic)
+    _output.posePub = this->node.Advertise<ignition::msgs::Pose>(_topic);
+    if (this->staticPosePublisher)
     {
-      this->dataPtr->staticPoses.clear();
-      this->dataPtr->FillPoses(_ecm, this->dataPtr->staticPoses, true);
-      this->dataPtr->PublishPoses(this->dataPtr->staticPoses,
-          convert<msgs::Time>(_info.simTime), this->dataPtr->poseStaticPub);
-      this->dataPtr->lastStaticPosePubTime = _info.simTime;
+      _output.poseStaticPub =
+          this->node.Advertise<ignition::msgs::Pose>(staticPoseTopic);
     }
+  }
+}
+
+//////////////////////////////////////////////////
+void PosePublisherPrivate::UpdateWorldModels(
+    const EntityComponentManager &_ecm)
+{
+  auto addModel = [&](const Entity &_entity, const components::Model *,
+      const components::ParentEntity *_parent) -> bool
+  {
+    if (_parent->Data() == this->world)
+      this->AddWorldModel(_ecm, _entity);
+    return true;
+  };
 
-    if (publish)
+  // All models are new to the system on its first update
+  if (!this->worldInitialized)
+  {
+    _ecm.Each<components::Model, components::ParentEntity>(addModel);
+    this->worldInitialized = true;
+  }
+  else
+  {
+    _ecm.EachNew<components::Model, components::ParentEntity>(addModel);
+  }
+
+  _ecm.EachRemoved<components::Model>(
+      [&](const Entity &_entity, const components::Model *) -> bool
+      {
+        this->RemoveWorldModel(_entity);
+        return true;
+      });
+}
+
+//////////////////////////////////////////////////
+void PosePublisherPrivate::AddWorldModel(const EntityComponentManager &_ecm,
+    Entity _model)
+{
+  if (this->entityModels.find(_model) != this->entityModels.end())
+    return;
+
+  auto name = _ecm.Component<components::Name>(_model);
+  if (!name || (!this->modelNames.empty() &&
+      this->modelNames.find(name->Data()) == this->modelNames.end()))
+  {
+    return;
+  }
+
+  if (this->perModelTopics)
+  {
+    this->outputs.emplace_back();
+    this->outputs.back().model = _model;
+    this->Advertise(this->outputs.back(), scopedName(_model, _ecm) + "/pose");
+  }
+
+  if (this->outputs.empty())
+    return;
+
+  // Remember the model even if none of its entities are published, so it's
+  // not checked again
+  this->entityModels[_model] = _model;
+  this->InitializeEntitiesToPublish(_ecm, _model, this->outputs.back());
+}
+
+//////////////////////////////////////////////////
+void PosePublisherPrivate::RemoveWorldModel(Entity _model)
+{
+  if (this->entityModels.find(_model) == this->entityModels.end())
+    return;
+
+  for (auto outputIt = this->outputs.begin();
+       outputIt != this->outputs.end(); ++outputIt)
+  {
+    if (outputIt->model == _model)
     {
-      this->dataPtr->poses.clear();
-      this->dataPtr->FillPoses(_ecm, this->dataPtr->poses, false);
-      this->dataPtr->PublishPoses(this->dataPtr->poses,
-          convert<msgs::Time>(_info.simTime), this->dataPtr->posePub);
-      this->dataPtr->lastPosePubTime = _info.simTime;
+      this->outputs.erase(outputIt);
+      break;
     }
   }
-  // publish all transforms to the same topic
-  else if (publish)
+
+  for (auto it = this->entityModels.begin(); it != this->entityModels.end();)
   {
-    this->dataPtr->poses.clear();
-    this->dataPtr->FillPoses(_ecm, this->dataPtr->poses, true);
-    this->dataPtr->FillPoses(_ecm, this->dataPtr->poses, false);
-    this->dataPtr->PublishPoses(this->dataPtr->poses,
-        convert<msgs::Time>(_info.simTime), this->dataPtr->posePub);
-    this->dataPtr->lastPosePubTime = _info.simTime;
+    if (it->second != _model)
+    {
+      ++it;
+      continue;
+    }
+
+    this->entitiesToPublish.erase(it->first);
+    this->dynamicEntities.erase(it->first);
+    it = this->entityModels.erase(it);
+  }
+
+  // The aggregated output keeps the other models' entities
+  if (!this->perModelTopics && !this->outputs.empty())
+  {
+    auto &entities = this->outputs.front().entities;
+    entities.erase(std::remove_if(entities.begin(), entities.end(),
+        [this](Entity _entity)
+        {
+          return this->entitiesToPublish.find(_entity) ==
+              this->entitiesToPublish.end();
+        }), entities.end());
   }
 }
 
 //////////////////////////////////////////////////
 void PosePublisherPrivate::InitializeEntitiesToPublish(
-    const EntityComponentManager &_ecm)
+    const EntityComponentManager &_ecm, Entity _model, PoseOutput &_output)
 {
   std::stack<Entity> toCheck;
-  toCheck.push(this->model.Entity());
+  toCheck.push(_model);
   std::vector<Entity> visited;
   while (!toCheck.empty())
   {
@@ -376,7 +585,10 @@ void PosePublisherPrivate::InitializeEntitiesToPublish(
         (collision && this->publishCollisionPose) ||
         (sensor && this->publishSensorPose);
 
-    if (fillPose)
+    // Skip entities already published, i.e. a nested model which is also
+    // served on its own
+    if (fillPose &&
+        this->entitiesToPublish.find(entity) == this->entitiesToPublish.end())
     {
       std::string frame;
       std::string childFrame;
@@ -397,6 +609,9 @@ void PosePublisherPrivate::InitializeEntitiesToPublish(
         }
       }
       this->entitiesToPublish[entity] = std::make_pair(frame, childFrame);
+      _output.entities.push_back(entity);
+      if (this->world != kNullEntity)
+        this->entityModels[entity] = _model;
     }
 
     // get dynamic entities
@@ -414,10 +629,10 @@ void PosePublisherPrivate::InitializeEntitiesToPublish(
 
         auto parentLinkEntity = _ecm.EntityByComponents(
             components::Name(parentLinkName), components::Link(),
-            components::ParentEntity(this->model.Entity()));
+            components::ParentEntity(_model));
         auto childLinkEntity = _ecm.EntityByComponents(
             components::Name(childLinkName), components::Link(),
-            components::ParentEntity(this->model.Entity()));
+            components::ParentEntity(_model));
 
         // add to list if not a canonical link
         if (!_ecm.Component<components::CanonicalLink>(parentLinkEntity))
@@ -470,21 +685,22 @@ void PosePublisherPrivate::InitializeEntitiesToPublish(
 
 //////////////////////////////////////////////////
 void PosePublisherPrivate::FillPoses(const EntityComponentManager &_ecm,
+    const std::vector<Entity> &_entities,
     std::vector<std::pair<Entity, math::Pose3d>> &_poses, bool _static)
 {
   IGN_PROFILE("PosePublisher::FillPose");
 
-  for (const auto &entity : this->entitiesToPublish)
+  for (const auto &entity : _entities)
   {
-    auto pose = _ecm.Component<components::Pose>(entity.first);
+    auto pose = _ecm.Component<components::Pose>(entity);
     if (!pose)
       continue;
 
-    bool isStatic = this->dynamicEntities.find(entity.first) ==
+    bool isStatic = this->dynamicEntities.find(entity) ==
           this->dynamicEntities.end();
 
     if (_static == isStatic)
-      _poses.emplace_back(entity.first, pose->Data());
+      _poses.emplace_back(entity, pose->Data());
   }
 }
 
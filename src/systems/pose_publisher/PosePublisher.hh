@@ -33,7 +33,7 @@ namespace systems
   // Forward declaration
   class PosePublisherPrivate;
 
-  /// \brief Pose publisher system. Attach to an entity to publish the
+  /// \brief Pose publisher system. Attach to a model to publish the
   /// transform of its child entities in the form of ignition::msgs::Pose
   /// messages, or a single ignition::msgs::Pose_V message if
   /// "use_pose_vector_msg" is true.
@@ -63,6 +63,21 @@ namespace systems
   ///                             negative frequency publishes as fast as
   ///                             possible (i.e, at the rate of the simulation
   ///                             step).
+  ///
+  /// The system can also be attached to a world, to publish the poses of
+  /// many models from a single system instead of one system per model. The
+  /// parameters above apply to every model, and these are also used:
+  ///
+  /// model                     : Name of a top level model to publish. Repeat
+  ///                             to serve several models. If omitted, all top
+  ///                             level models are served, including those
+  ///                             spawned later.
+  /// per_model_topics          : Set to true to publish the poses of each
+  ///                             model on its own "<scoped_model_name>/pose"
+  ///                             topic, as if it had its own PosePublisher.
+  ///                             By default, the poses of all models are
+  ///                             published together on the
+  ///                             "<scoped_world_name>/pose" topic.
   class PosePublisher
       : public System,
         public ISystemConfigure,
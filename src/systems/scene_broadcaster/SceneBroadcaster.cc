@@ -17,19 +17,33 @@
 
 #include "SceneBroadcaster.hh"
 
+#include <ignition/msgs/bytes.pb.h>
 #include <ignition/msgs/scene.pb.h>
+#include <ignition/msgs/stringmsg_v.pb.h>
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
+#include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/graph/Graph.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
 
+#include "ignition/gazebo/BinaryState.hh"
 #include "ignition/gazebo/components/CastShadows.hh"
+#include "ignition/gazebo/components/Factory.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Light.hh"
 #include "ignition/gazebo/components/Link.hh"
@@ -43,6 +57,9 @@
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/PoseDeltaStream.hh"
+
+#include "../log/StateCompression.hh"
 
 using namespace std::chrono_literals;
 
@@ -50,6 +67,73 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+/// \brief Find a component type from its name or id.
+/// \param[in] _type Component type name, such as
+/// `ign_gazebo_components.Pose`, or id.
+/// \param[out] _typeId Component type id.
+/// \return True if the type was found.
+static bool componentTypeFromString(const std::string &_type,
+    ComponentTypeId &_typeId)
+{
+  for (auto typeId : components::Factory::Instance()->TypeIds())
+  {
+    if (_type == components::Factory::Instance()->Name(typeId) ||
+        _type == std::to_string(typeId))
+    {
+      _typeId = typeId;
+      return true;
+    }
+  }
+  return false;
+}
+
+/// \brief Area of interest registered through the state filter service.
+/// Subscribers with identical filters share one publisher, so the state is
+/// serialized once for all of them.
+class StateFilter
+{
+  /// \brief Parse a filter request. Each string of the request is one of:
+  /// * `model <name>`: the model and everything inside it
+  /// * `entity <id>`: the entity and all its descendants
+  /// * `region <min x> <min y> <min z> <max x> <max y> <max z>`: top level
+  ///   models whose origin is inside the box, in the world frame
+  /// * `component <type name or id>`: only send these component types,
+  ///   defaults to all types
+  /// \param[in] _req Request.
+  /// \param[out] _error Error message if parsing failed.
+  /// \return True if successful.
+  public: bool Parse(const msgs::StringMsg_V &_req, std::string &_error);
+
+  /// \brief Get a string which is the same for identical filters.
+  /// \return Key.
+  public: std::string Key() const;
+
+  /// \brief Find the entities of interest.
+  /// \param[in] _ecm Entity component manager.
+  /// \param[in] _worldEntity World entity.
+  /// \return Entities of interest.
+  public: std::unordered_set<Entity> Entities(
+      const EntityComponentManager &_ecm, const Entity _worldEntity) const;
+
+  /// \brief Names of models of interest.
+  public: std::set<std::string> models;
+
+  /// \brief Entities of interest.
+  public: std::set<Entity> entities;
+
+  /// \brief Region of interest.
+  public: std::optional<math::AxisAlignedBox> region;
+
+  /// \brief Component types of interest, all if empty.
+  public: std::set<ComponentTypeId> types;
+
+  /// \brief Topic of the filtered state.
+  public: std::string topic;
+
+  /// \brief Publisher for the filtered state.
+  public: transport::Node::Publisher pub;
+};
+
 // Private data class.
 class ignition::gazebo::systems::SceneBroadcasterPrivate
 {
@@ -80,6 +164,69 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \param[out] _res Response containing the last available full state.
   public: void StateAsyncService(const ignition::msgs::StringMsg &_req);
 
+  /// \brief Callback for the state filter service, which registers an area
+  /// of interest. See StateFilter::Parse for the request format.
+  /// \param[in] _req Filter request.
+  /// \param[out] _res Topic where the filtered state is published.
+  /// \return True if the filter is valid.
+  public: bool StateFilterService(const ignition::msgs::StringMsg_V &_req,
+      ignition::msgs::StringMsg &_res);
+
+  /// \brief State captured in PostUpdate, to be converted and published by
+  /// the state publication thread.
+  public: struct StateSnapshot
+  {
+    /// \brief Update information of the iteration.
+    UpdateInfo info;
+
+    /// \brief State written by EntityComponentManager::BinaryState, which
+    /// is much cheaper than EntityComponentManager::State. There may be
+    /// several buffers, which are merged into one message. It's empty if
+    /// there's no state to send, just the update information.
+    std::vector<std::string> states;
+
+    /// \brief Whether the snapshot must not be dropped, because it has
+    /// change events such as new entities, or rate limited components which
+    /// won't be sent again soon.
+    bool keep{false};
+
+    /// \brief Publisher to publish the state with. Publishers are never
+    /// removed, so the pointer stays valid.
+    transport::Node::Publisher *pub{nullptr};
+
+    /// \brief Publisher to also publish the state with, compressed. It's
+    /// null if the state isn't sent compressed.
+    transport::Node::Publisher *compressedPub{nullptr};
+  };
+
+  /// \brief Destructor, stops the state publication thread.
+  public: ~SceneBroadcasterPrivate();
+
+  /// \brief Queue a snapshot for the state publication thread, starting the
+  /// thread if needed. If the queue is full, the oldest snapshot for the
+  /// same publisher that isn't kept is dropped, since its periodic
+  /// components are superseded by the newer snapshots.
+  /// \param[in] _snapshot Snapshot to publish.
+  public: void EnqueueState(StateSnapshot &&_snapshot);
+
+  /// \brief Body of the state publication thread, which converts snapshots
+  /// to messages and publishes them, so that the simulation thread never
+  /// waits on serialization and transport.
+  public: void StatePublishLoop();
+
+  /// \brief Whether any filtered state topic has subscribers.
+  /// \return True if there are subscribers.
+  public: bool HasFilteredConnections();
+
+  /// \brief Serialize and publish the state of every filter with
+  /// subscribers.
+  /// \param[in] _info The update information
+  /// \param[in] _manager The entity component manager
+  /// \param[in] _full True to send all components of the entities of
+  /// interest, false to only send components with periodic changes.
+  public: void PublishFilteredStates(const UpdateInfo &_info,
+      const EntityComponentManager &_manager, bool _full);
+
   /// \brief Updates the scene graph when entities are added
   /// \param[in] _manager The entity component manager
   public: void SceneGraphAddEntities(const EntityComponentManager &_manager);
@@ -148,9 +295,31 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \brief Rate at which to publish dynamic poses
   public: int dyPoseHertz{60};
 
+  /// \brief Delta encoded dynamic pose publisher, an alternative to
+  /// dyPosePub which only sends the entities that moved.
+  public: transport::Node::Publisher dyPoseDeltaPub;
+
+  /// \brief Encodes dynamic poses for dyPoseDeltaPub.
+  public: PoseDeltaEncoder poseDeltaEncoder;
+
+  /// \brief Whether dyPoseDeltaPub had connections on the last update, so
+  /// that the first subscriber gets a keyframe straight away.
+  public: bool poseDeltaConnected{false};
+
+  /// \brief Last time a delta encoded frame was considered. The pose delta
+  /// stream is throttled here because frames dropped by transport would
+  /// break the chain of deltas.
+  public: std::chrono::time_point<std::chrono::system_clock>
+      lastPoseDeltaTime;
+
   /// \brief Scene publisher
   public: transport::Node::Publisher scenePub;
 
+  /// \brief Scene message published when entities are added. Cleared and
+  /// refilled each time, so its models, links and visuals are reused
+  /// instead of reallocated.
+  public: msgs::Scene sceneMsg;
+
   /// \brief Request publisher.
   /// This is used to request entities to be removed
   public: transport::Node::Publisher deletionPub;
@@ -158,6 +327,9 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \brief State publisher
   public: transport::Node::Publisher statePub;
 
+  /// \brief State publisher, compressed.
+  public: transport::Node::Publisher compressedStatePub;
+
   /// \brief Graph containing latest information from entities.
   /// The data in each node is the message associated with that entity only.
   /// i.e, a model node only has a message about the model. It will not
@@ -176,6 +348,16 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \brief Protects scene graph.
   public: std::mutex graphMutex;
 
+  /// \brief Response of the scene info service, built from the scene graph
+  /// on the first request and then patched as top level models and lights
+  /// are added and removed. Protected by graphMutex.
+  public: msgs::Scene sceneInfo;
+
+  /// \brief Whether sceneInfo matches the scene graph. Changes the patches
+  /// don't handle, such as a link added to an existing model, clear it, so
+  /// the next request rebuilds the message.
+  public: bool sceneInfoValid{false};
+
   /// \brief Protects stepMsg.
   public: std::mutex stateMutex;
 
@@ -193,13 +375,279 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   public: std::chrono::duration<int64_t, std::ratio<1, 1000>>
       statePublishPeriod{std::chrono::milliseconds(1000/60)};
 
+  /// \brief Publish periods of component types with their own rate.
+  /// Periodic changes to other types are sent at statePublishPeriod.
+  public: std::unordered_map<ComponentTypeId,
+      std::chrono::duration<int64_t, std::ratio<1, 1000>>> componentPeriods;
+
+  /// \brief Last time each rate limited component type was sent.
+  public: std::unordered_map<ComponentTypeId,
+      std::chrono::time_point<std::chrono::system_clock>> lastRateTypePubTime;
+
+  /// \brief Rate limited component types which changed since they were
+  /// last sent.
+  public: std::unordered_set<ComponentTypeId> pendingRateTypes;
+
   /// \brief Flag used to indicate if the state service was called.
   public: bool stateServiceRequest{false};
 
   /// \brief A list of async state requests
   public: std::unordered_set<std::string> stateRequests;
+
+  /// \brief Registered state filters, by key.
+  public: std::map<std::string, StateFilter> stateFilters;
+
+  /// \brief Protects stateFilters.
+  public: std::mutex stateFiltersMutex;
+
+  /// \brief Snapshots waiting to be published.
+  public: std::deque<StateSnapshot> stateQueue;
+
+  /// \brief Maximum number of snapshots which aren't kept in the queue,
+  /// per publisher.
+  public: std::size_t stateQueueSize{2};
+
+  /// \brief Protects stateQueue and stopStatePublish.
+  public: std::mutex stateQueueMutex;
+
+  /// \brief Notifies the state publication thread.
+  public: std::condition_variable stateQueueCv;
+
+  /// \brief Set to stop the state publication thread.
+  public: bool stopStatePublish{false};
+
+  /// \brief State publication thread.
+  public: std::thread statePublishThread;
 };
 
+//////////////////////////////////////////////////
+SceneBroadcasterPrivate::~SceneBroadcasterPrivate()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->stateQueueMutex);
+    this->stopStatePublish = true;
+  }
+  this->stateQueueCv.notify_all();
+  if (this->statePublishThread.joinable())
+    this->statePublishThread.join();
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::EnqueueState(StateSnapshot &&_snapshot)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->stateQueueMutex);
+    if (!this->statePublishThread.joinable())
+    {
+      this->statePublishThread =
+          std::thread(&SceneBroadcasterPrivate::StatePublishLoop, this);
+    }
+
+    // Each publisher has its own bound
+    auto droppable = [&_snapshot](const StateSnapshot &_queued)
+    {
+      return !_queued.keep && _queued.pub == _snapshot.pub;
+    };
+    std::size_t periodic = std::count_if(this->stateQueue.begin(),
+        this->stateQueue.end(), droppable);
+    if (!_snapshot.keep && periodic >= this->stateQueueSize)
+    {
+      this->stateQueue.erase(std::find_if(this->stateQueue.begin(),
+          this->stateQueue.end(), droppable));
+    }
+    this->stateQueue.push_back(std::move(_snapshot));
+  }
+  this->stateQueueCv.notify_one();
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::StatePublishLoop()
+{
+  IGN_PROFILE_THREAD_NAME("SceneBroadcaster::StatePublish");
+  while (true)
+  {
+    StateSnapshot snapshot;
+    {
+      std::unique_lock<std::mutex> lock(this->stateQueueMutex);
+      this->stateQueueCv.wait(lock, [this]
+      {
+        return this->stopStatePublish || !this->stateQueue.empty();
+      });
+      if (this->stopStatePublish)
+        return;
+
+      snapshot = std::move(this->stateQueue.front());
+      this->stateQueue.pop_front();
+    }
+
+    IGN_PROFILE("SceneBroadcast::Publish State");
+    msgs::SerializedStepMap msg;
+    set(msg.mutable_stats(), snapshot.info);
+
+    bool valid{true};
+    for (const auto &state : snapshot.states)
+    {
+      BinaryStateReader reader(state.data(), state.size());
+      valid = valid && reader.ToMsg(*msg.mutable_state());
+    }
+
+    if (!valid)
+    {
+      ignerr << "Failed to convert state snapshot, it won't be published."
+             << std::endl;
+      continue;
+    }
+
+    if (snapshot.pub->HasConnections())
+      snapshot.pub->Publish(msg);
+
+    if (nullptr != snapshot.compressedPub &&
+        snapshot.compressedPub->HasConnections())
+    {
+      IGN_PROFILE("SceneBroadcast::Compress State");
+      msgs::Bytes compressedMsg;
+      if (!log_system::CompressData(msg.SerializeAsString(),
+          *compressedMsg.mutable_data()))
+      {
+        ignerr << "Failed to compress state." << std::endl;
+        continue;
+      }
+      snapshot.compressedPub->Publish(compressedMsg);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+bool StateFilter::Parse(const msgs::StringMsg_V &_req, std::string &_error)
+{
+  for (const auto &entry : _req.data())
+  {
+    std::istringstream stream(entry);
+    std::string kind;
+    stream >> kind;
+
+    if (kind == "model")
+    {
+      std::string name;
+      std::getline(stream >> std::ws, name);
+      if (name.empty())
+      {
+        _error = "Missing model name in [" + entry + "]";
+        return false;
+      }
+      this->models.insert(name);
+    }
+    else if (kind == "entity")
+    {
+      Entity entity;
+      if (!(stream >> entity))
+      {
+        _error = "Invalid entity in [" + entry + "]";
+        return false;
+      }
+      this->entities.insert(entity);
+    }
+    else if (kind == "region")
+    {
+      double minX, minY, minZ, maxX, maxY, maxZ;
+      if (!(stream >> minX >> minY >> minZ >> maxX >> maxY >> maxZ))
+      {
+        _error = "Invalid region in [" + entry + "]";
+        return false;
+      }
+      this->region = math::AxisAlignedBox(
+          math::Vector3d(minX, minY, minZ), math::Vector3d(maxX, maxY, maxZ));
+    }
+    else if (kind == "component")
+    {
+      std::string type;
+      stream >> type;
+
+      ComponentTypeId typeId;
+      if (!componentTypeFromString(type, typeId))
+      {
+        _error = "Unknown component type in [" + entry + "]";
+        return false;
+      }
+      this->types.insert(typeId);
+    }
+    else
+    {
+      _error = "Unknown filter [" + entry + "]";
+      return false;
+    }
+  }
+
+  if (this->models.empty() && this->entities.empty() && !this->region)
+  {
+    _error = "Filter has no model, entity or region";
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::string StateFilter::Key() const
+{
+  std::ostringstream key;
+  for (const auto &model : this->models)
+    key << "m" << model.size() << ":" << model;
+  for (auto entity : this->entities)
+    key << "e" << entity;
+  if (this->region)
+    key << "r" << this->region->Min() << " " << this->region->Max();
+  for (auto type : this->types)
+    key << "c" << type;
+  return key.str();
+}
+
+//////////////////////////////////////////////////
+std::unordered_set<Entity> StateFilter::Entities(
+    const EntityComponentManager &_ecm, const Entity _worldEntity) const
+{
+  std::unordered_set<Entity> result;
+  auto addTree = [&](const Entity _entity)
+  {
+    auto descendants = _ecm.Descendants(_entity);
+    result.insert(descendants.begin(), descendants.end());
+  };
+
+  for (const auto &name : this->models)
+  {
+    _ecm.Each<components::Model, components::Name>(
+        [&](const Entity &_entity, const components::Model *,
+            const components::Name *_name) -> bool
+        {
+          if (_name->Data() == name)
+            addTree(_entity);
+          return true;
+        });
+  }
+
+  for (auto entity : this->entities)
+  {
+    if (_ecm.HasEntity(entity))
+      addTree(entity);
+  }
+
+  if (this->region)
+  {
+    _ecm.Each<components::Model, components::ParentEntity>(
+        [&](const Entity &_entity, const components::Model *,
+            const components::ParentEntity *_parent) -> bool
+        {
+          if (_parent->Data() == _worldEntity &&
+              this->region->Contains(_ecm.WorldPose(_entity).Pos()))
+          {
+            addTree(_entity);
+          }
+          return true;
+        });
+  }
+
+  return result;
+}
+
 //////////////////////////////////////////////////
 SceneBroadcaster::SceneBroadcaster()
   : System(), dataPtr(std::make_unique<SceneBroadcasterPrivate>())
@@ -226,6 +674,69 @@ void SceneBroadcaster::Configure(
   auto readHertz = _sdf->Get<int>("dynamic_pose_hertz", 60);
   this->dataPtr->dyPoseHertz = readHertz.first;
 
+  auto sdfClone = _sdf->Clone();
+  if (sdfClone->HasElement("pose_delta"))
+  {
+    auto deltaElem = sdfClone->GetElement("pose_delta");
+    auto &encoder = this->dataPtr->poseDeltaEncoder;
+    if (deltaElem->HasElement("position_resolution"))
+    {
+      encoder.SetPositionResolution(
+          deltaElem->Get<double>("position_resolution"));
+    }
+    if (deltaElem->HasElement("orientation_resolution"))
+    {
+      encoder.SetOrientationResolution(
+          deltaElem->Get<double>("orientation_resolution"));
+    }
+    if (deltaElem->HasElement("position_tolerance"))
+    {
+      encoder.SetPositionTolerance(
+          deltaElem->Get<double>("position_tolerance"));
+    }
+    if (deltaElem->HasElement("orientation_tolerance"))
+    {
+      encoder.SetOrientationTolerance(
+          deltaElem->Get<double>("orientation_tolerance"));
+    }
+    if (deltaElem->HasElement("keyframe_period"))
+    {
+      encoder.SetKeyframePeriod(
+          deltaElem->Get<unsigned int>("keyframe_period"));
+    }
+  }
+
+  if (sdfClone->HasElement("component_hertz"))
+  {
+    for (auto elem = sdfClone->GetElement("component_hertz"); elem;
+         elem = elem->GetNextElement("component_hertz"))
+    {
+      auto type = elem->Get<std::string>("type");
+      auto hertz = elem->Get<double>();
+
+      ComponentTypeId typeId;
+      if (!componentTypeFromString(type, typeId))
+      {
+        ignerr << "Unknown component type [" << type
+               << "] in <component_hertz>, ignoring." << std::endl;
+        continue;
+      }
+      if (hertz <= 0)
+      {
+        ignerr << "Invalid rate [" << hertz << "] for component type ["
+               << type << "], ignoring." << std::endl;
+        continue;
+      }
+
+      this->dataPtr->componentPeriods[typeId] =
+          std::chrono::duration<int64_t, std::ratio<1, 1000>>(
+          static_cast<int64_t>(1000 / hertz));
+    }
+  }
+
+  auto queueSize = _sdf->Get<int>("state_queue_size", 2);
+  this->dataPtr->stateQueueSize = std::max(1, queueSize.first);
+
   auto stateHerz = _sdf->Get<int>("state_hertz", 60);
   this->dataPtr->statePublishPeriod =
       std::chrono::duration<int64_t, std::ratio<1, 1000>>(
@@ -254,7 +765,8 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
 
   // Create and send pose update if transport connections exist.
   if (this->dataPtr->dyPosePub.HasConnections() ||
-      this->dataPtr->posePub.HasConnections())
+      this->dataPtr->posePub.HasConnections() ||
+      this->dataPtr->dyPoseDeltaPub.HasConnections())
   {
     this->dataPtr->PoseUpdate(_info, _manager);
   }
@@ -278,56 +790,177 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
   auto now = std::chrono::system_clock::now();
   bool itsPubTime = !_info.paused && (now - this->dataPtr->lastStatePubTime >
        this->dataPtr->statePublishPeriod);
-  auto shouldPublish = this->dataPtr->statePub.HasConnections() &&
-       (changeEvent || itsPubTime);
+  bool stateConnections = this->dataPtr->statePub.HasConnections() ||
+      this->dataPtr->compressedStatePub.HasConnections();
+  auto shouldPublish = stateConnections && (changeEvent || itsPubTime);
+  auto shouldPublishFiltered = (changeEvent || itsPubTime) &&
+       this->dataPtr->HasFilteredConnections();
+
+  // Remember changes to rate limited types on every iteration, so they're
+  // sent when the type is due even if they stopped changing
+  if (!this->dataPtr->componentPeriods.empty() && stateConnections)
+  {
+    for (auto type : _manager.ComponentTypesWithPeriodicChanges())
+    {
+      if (this->dataPtr->componentPeriods.count(type) > 0)
+        this->dataPtr->pendingRateTypes.insert(type);
+    }
+  }
 
-  if (this->dataPtr->stateServiceRequest || shouldPublish)
+  if (this->dataPtr->stateServiceRequest)
   {
     std::unique_lock<std::mutex> lock(this->dataPtr->stateMutex);
     this->dataPtr->stepMsg.Clear();
 
     set(this->dataPtr->stepMsg.mutable_stats(), _info);
 
-    // Publish full state if there are change events
-    if (changeEvent || this->dataPtr->stateServiceRequest)
+    // Full state on demand
+    _manager.State(*this->dataPtr->stepMsg.mutable_state(), {}, {}, true);
+
+    this->dataPtr->stateServiceRequest = false;
+    this->dataPtr->stateCv.notify_all();
+
+    // process async state requests
+    if (!this->dataPtr->stateRequests.empty())
+    {
+      for (const auto &reqSrv : this->dataPtr->stateRequests)
+      {
+        this->dataPtr->node->Request(reqSrv, this->dataPtr->stepMsg);
+      }
+      this->dataPtr->stateRequests.clear();
+    }
+  }
+
+  // Poses periodically + change events
+  // TODO(louise) Send changed state periodically instead, once it reflects
+  // changed components
+  if (shouldPublish)
+  {
+    IGN_PROFILE("SceneBroadcast::PostUpdate Snapshot State");
+    SceneBroadcasterPrivate::StateSnapshot snapshot;
+    snapshot.info = _info;
+    snapshot.keep = changeEvent;
+    snapshot.pub = &this->dataPtr->statePub;
+    snapshot.compressedPub = &this->dataPtr->compressedStatePub;
+
+    // Full state if there are change events
+    if (changeEvent)
     {
-      _manager.State(*this->dataPtr->stepMsg.mutable_state(), {}, {}, true);
+      snapshot.states.emplace_back();
+      _manager.BinaryState(snapshot.states.back(), {}, {}, true);
+
+      // Every type has just been sent
+      this->dataPtr->pendingRateTypes.clear();
+      for (auto &[type, lastTime] : this->dataPtr->lastRateTypePubTime)
+        lastTime = now;
     }
-    // Otherwise publish just periodic change components
+    // Otherwise just periodic change components
     else
     {
-      IGN_PROFILE("SceneBroadcast::PostUpdate UpdateState");
-      auto periodicComponents = _manager.ComponentTypesWithPeriodicChanges();
-      _manager.State(*this->dataPtr->stepMsg.mutable_state(),
-          {}, periodicComponents);
+      std::unordered_set<ComponentTypeId> changedTypes;
+      for (auto type : _manager.ComponentTypesWithPeriodicChanges())
+      {
+        if (this->dataPtr->componentPeriods.count(type) == 0)
+          changedTypes.insert(type);
+      }
+
+      // Rate limited types which are due. Their changes may have happened
+      // in any iteration since they were last sent, so send all their
+      // components
+      std::unordered_set<ComponentTypeId> dueTypes;
+      for (auto it = this->dataPtr->pendingRateTypes.begin();
+           it != this->dataPtr->pendingRateTypes.end();)
+      {
+        auto &lastTime = this->dataPtr->lastRateTypePubTime[*it];
+        if (now - lastTime < this->dataPtr->componentPeriods.at(*it))
+        {
+          ++it;
+          continue;
+        }
+        lastTime = now;
+        dueTypes.insert(*it);
+        it = this->dataPtr->pendingRateTypes.erase(it);
+      }
+
+      // An empty set of types would mean all of them
+      if (!changedTypes.empty())
+      {
+        snapshot.states.emplace_back();
+        _manager.BinaryState(snapshot.states.back(), {}, changedTypes);
+      }
+      if (!dueTypes.empty())
+      {
+        snapshot.states.emplace_back();
+        _manager.BinaryState(snapshot.states.back(), {}, dueTypes, true);
+        snapshot.keep = true;
+      }
     }
+    this->dataPtr->EnqueueState(std::move(snapshot));
+  }
 
-    // Full state on demand
-    if (this->dataPtr->stateServiceRequest)
+  if (shouldPublishFiltered)
+    this->dataPtr->PublishFilteredStates(_info, _manager, changeEvent);
+
+  if (shouldPublish || shouldPublishFiltered)
+    this->dataPtr->lastStatePubTime = now;
+}
+
+//////////////////////////////////////////////////
+bool SceneBroadcasterPrivate::HasFilteredConnections()
+{
+  std::lock_guard<std::mutex> lock(this->stateFiltersMutex);
+  for (auto &filter : this->stateFilters)
+  {
+    if (filter.second.pub.HasConnections())
+      return true;
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::PublishFilteredStates(const UpdateInfo &_info,
+    const EntityComponentManager &_manager, bool _full)
+{
+  IGN_PROFILE("SceneBroadcast::PublishFilteredStates");
+
+  std::unordered_set<ComponentTypeId> periodicComponents;
+  if (!_full)
+    periodicComponents = _manager.ComponentTypesWithPeriodicChanges();
+
+  std::lock_guard<std::mutex> lock(this->stateFiltersMutex);
+  for (auto &[key, filter] : this->stateFilters)
+  {
+    if (!filter.pub.HasConnections())
+      continue;
+
+    std::unordered_set<ComponentTypeId> types;
+    if (_full)
     {
-      this->dataPtr->stateServiceRequest = false;
-      this->dataPtr->stateCv.notify_all();
+      types.insert(filter.types.begin(), filter.types.end());
     }
-
-    // process async state requests
-    if (!this->dataPtr->stateRequests.empty())
+    else
     {
-      for (const auto &reqSrv : this->dataPtr->stateRequests)
+      for (auto type : periodicComponents)
       {
-        this->dataPtr->node->Request(reqSrv, this->dataPtr->stepMsg);
+        if (filter.types.empty() || filter.types.count(type) > 0)
+          types.insert(type);
       }
-      this->dataPtr->stateRequests.clear();
     }
 
-    // Poses periodically + change events
-    // TODO(louise) Send changed state periodically instead, once it reflects
-    // changed components
-    if (shouldPublish)
+    StateSnapshot snapshot;
+    snapshot.info = _info;
+    snapshot.keep = _full;
+    snapshot.pub = &filter.pub;
+
+    // An empty set of entities or types would mean all of them
+    auto entities = filter.Entities(_manager, this->worldEntity);
+    if (!entities.empty() && (_full || !types.empty()))
     {
-      IGN_PROFILE("SceneBroadcast::PostUpdate Publish State");
-      this->dataPtr->statePub.Publish(this->dataPtr->stepMsg);
-      this->dataPtr->lastStatePubTime = now;
+      snapshot.states.emplace_back();
+      _manager.BinaryState(snapshot.states.back(), entities, types, _full);
     }
+
+    this->EnqueueState(std::move(snapshot));
   }
 }
 
@@ -341,6 +974,26 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
   bool dyPoseConnections = this->dyPosePub.HasConnections();
   bool poseConnections = this->posePub.HasConnections();
 
+  bool deltaConnections = this->dyPoseDeltaPub.HasConnections();
+  if (deltaConnections && !this->poseDeltaConnected)
+    this->poseDeltaEncoder.ForceKeyframe();
+  this->poseDeltaConnected = deltaConnections;
+
+  std::map<Entity, math::Pose3d> deltaPoses;
+  if (deltaConnections)
+  {
+    auto now = std::chrono::system_clock::now();
+    if (now - this->lastPoseDeltaTime <
+        std::chrono::milliseconds(1000 / std::max(1, this->dyPoseHertz)))
+    {
+      deltaConnections = false;
+    }
+    else
+    {
+      this->lastPoseDeltaTime = now;
+    }
+  }
+
   // Models
   _manager.Each<components::Model, components::Name, components::Pose,
                 components::Static>(
@@ -366,6 +1019,9 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
           dyPose->set_name(_nameComp->Data());
           dyPose->set_id(_entity);
         }
+
+        if (deltaConnections && !_staticComp->Data())
+          deltaPoses[_entity] = _poseComp->Data();
         return true;
       });
 
@@ -398,6 +1054,9 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
           dyPose->set_id(_entity);
         }
 
+        if (deltaConnections && !staticComp->Data())
+          deltaPoses[_entity] = _poseComp->Data();
+
         return true;
       });
 
@@ -410,6 +1069,14 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
     this->dyPosePub.Publish(dyPoseMsg);
   }
 
+  // Nothing is published if no entity moved since the last frame
+  msgs::Bytes deltaMsg;
+  if (deltaConnections && this->poseDeltaEncoder.Encode(deltaPoses,
+      _info.simTime, *deltaMsg.mutable_data()))
+  {
+    this->dyPoseDeltaPub.Publish(deltaMsg);
+  }
+
   // Visuals
   if (poseConnections)
   {
@@ -500,6 +1167,15 @@ void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
   ignmsg << "Serving full state (async) on [" << opts.NameSpace() << "/"
          << stateAsyncService << "]" << std::endl;
 
+  // State filter service
+  std::string stateFilterService{"state/filter"};
+
+  this->node->Advertise(stateFilterService,
+      &SceneBroadcasterPrivate::StateFilterService, this);
+
+  ignmsg << "Serving state filters on [" << opts.NameSpace() << "/"
+         << stateFilterService << "]" << std::endl;
+
   // Scene info topic
   std::string sceneTopic{ns + "/scene/info"};
 
@@ -526,6 +1202,10 @@ void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
   ignmsg << "Publishing state changes on [" << stateTopic << "]"
       << std::endl;
 
+  std::string compressedStateTopic{stateTopic + "/compressed"};
+  this->compressedStatePub =
+      this->node->Advertise<msgs::Bytes>(compressedStateTopic);
+
   // Pose info publisher
   std::string poseTopic{"pose/info"};
 
@@ -547,6 +1227,15 @@ void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
 
   ignmsg << "Publishing dynamic pose messages on [" << opts.NameSpace() << "/"
          << dyPoseTopic << "]" << std::endl;
+
+  // Delta encoded dynamic pose publisher. It's not throttled by transport,
+  // see lastPoseDeltaTime.
+  std::string dyPoseDeltaTopic{"dynamic_pose/delta"};
+
+  this->dyPoseDeltaPub = this->node->Advertise<msgs::Bytes>(dyPoseDeltaTopic);
+
+  ignmsg << "Publishing delta encoded dynamic pose messages on ["
+         << opts.NameSpace() << "/" << dyPoseDeltaTopic << "]" << std::endl;
 }
 
 //////////////////////////////////////////////////
@@ -554,16 +1243,23 @@ bool SceneBroadcasterPrivate::SceneInfoService(ignition::msgs::Scene &_res)
 {
   std::lock_guard<std::mutex> lock(this->graphMutex);
 
-  _res.Clear();
+  // Traversing the graph is expensive for large worlds, and every client
+  // asks for the scene when it connects
+  if (!this->sceneInfoValid)
+  {
+    IGN_PROFILE("SceneBroadcasterPrivate::SceneInfoService Rebuild");
+    this->sceneInfo.Clear();
 
-  // Populate scene message
+    // Add models
+    AddModels(&this->sceneInfo, this->worldEntity, this->sceneGraph);
 
-  // Add models
-  AddModels(&_res, this->worldEntity, this->sceneGraph);
+    // Add lights
+    AddLights(&this->sceneInfo, this->worldEntity, this->sceneGraph);
 
-  // Add lights
-  AddLights(&_res, this->worldEntity, this->sceneGraph);
+    this->sceneInfoValid = true;
+  }
 
+  _res.CopyFrom(this->sceneInfo);
   return true;
 }
 
@@ -576,6 +1272,43 @@ void SceneBroadcasterPrivate::StateAsyncService(
   this->stateRequests.insert(_req.data());
 }
 
+//////////////////////////////////////////////////
+bool SceneBroadcasterPrivate::StateFilterService(
+    const ignition::msgs::StringMsg_V &_req, ignition::msgs::StringMsg &_res)
+{
+  StateFilter filter;
+  std::string error;
+  if (!filter.Parse(_req, error))
+  {
+    ignerr << "Invalid state filter: " << error << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(this->stateFiltersMutex);
+
+  // Identical filters share a topic
+  auto key = filter.Key();
+  auto it = this->stateFilters.find(key);
+  if (it == this->stateFilters.end())
+  {
+    filter.topic = this->node->Options().NameSpace() + "/state/filtered/" +
+        std::to_string(this->stateFilters.size());
+    filter.pub = this->node->Advertise<msgs::SerializedStepMap>(filter.topic);
+    if (!filter.pub)
+    {
+      ignerr << "Failed to advertise [" << filter.topic << "]" << std::endl;
+      return false;
+    }
+
+    igndbg << "Publishing filtered state on [" << filter.topic << "]"
+           << std::endl;
+    it = this->stateFilters.emplace(key, std::move(filter)).first;
+  }
+
+  _res.set_data(it->second.topic);
+  return true;
+}
+
 //////////////////////////////////////////////////
 bool SceneBroadcasterPrivate::StateService(
     ignition::msgs::SerializedStepMap &_res)
@@ -647,7 +1380,7 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         auto modelMsg = std::make_shared<msgs::Model>();
         modelMsg->set_id(_entity);
         modelMsg->set_name(_nameComp->Data());
-        modelMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(modelMsg->mutable_pose(), _poseComp->Data());
 
         // Add to graph
         newGraph.AddVertex(_nameComp->Data(), modelMsg, _entity);
@@ -668,7 +1401,7 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         auto linkMsg = std::make_shared<msgs::Link>();
         linkMsg->set_id(_entity);
         linkMsg->set_name(_nameComp->Data());
-        linkMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(linkMsg->mutable_pose(), _poseComp->Data());
 
         // Add to graph
         newGraph.AddVertex(_nameComp->Data(), linkMsg, _entity);
@@ -693,23 +1426,21 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         visualMsg->set_id(_entity);
         visualMsg->set_parent_id(_parentComp->Data());
         visualMsg->set_name(_nameComp->Data());
-        visualMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(visualMsg->mutable_pose(), _poseComp->Data());
         visualMsg->set_cast_shadows(_castShadowsComp->Data());
 
         // Geometry is optional
         auto geometryComp = _manager.Component<components::Geometry>(_entity);
         if (geometryComp)
         {
-          visualMsg->mutable_geometry()->CopyFrom(
-              convert<msgs::Geometry>(geometryComp->Data()));
+          set(visualMsg->mutable_geometry(), geometryComp->Data());
         }
 
         // Material is optional
         auto materialComp = _manager.Component<components::Material>(_entity);
         if (materialComp)
         {
-          visualMsg->mutable_material()->CopyFrom(
-              convert<msgs::Material>(materialComp->Data()));
+          set(visualMsg->mutable_material(), materialComp->Data());
         }
 
         // Add to graph
@@ -729,11 +1460,11 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
           const components::Pose *_poseComp) -> bool
       {
         auto lightMsg = std::make_shared<msgs::Light>();
-        lightMsg->CopyFrom(convert<msgs::Light>(_lightComp->Data()));
+        set(lightMsg.get(), _lightComp->Data());
         lightMsg->set_id(_entity);
         lightMsg->set_parent_id(_parentComp->Data());
         lightMsg->set_name(_nameComp->Data());
-        lightMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(lightMsg->mutable_pose(), _poseComp->Data());
 
         // Add to graph
         newGraph.AddVertex(_nameComp->Data(), lightMsg, _entity);
@@ -746,6 +1477,20 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
   // Update the whole scene graph from the new graph
   {
     std::lock_guard<std::mutex> lock(this->graphMutex);
+
+    // The cached scene info can only be patched if the new entities form
+    // new subtrees of the world, see below. Edges to existing entities
+    // aren't in the new graph, so those entities lack a parent there.
+    for (const auto &vertex : newGraph.Vertices())
+    {
+      if (vertex.first != this->worldEntity &&
+          newGraph.IncidentsTo(vertex.first).empty())
+      {
+        this->sceneInfoValid = false;
+        break;
+      }
+    }
+
     for (const auto &[id, vert] : newGraph.Vertices())
     {
       // Add the vertex only if it's not already in the graph
@@ -761,6 +1506,12 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         this->sceneGraph.AddEdge(edge.get().Vertices(), edge.get().Data());
       }
     }
+
+    if (newEntity && this->sceneInfoValid)
+    {
+      AddModels(&this->sceneInfo, this->worldEntity, newGraph);
+      AddLights(&this->sceneInfo, this->worldEntity, newGraph);
+    }
   }
 
   if (newEntity)
@@ -770,13 +1521,13 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
     if (!this->node)
       this->SetupTransport(this->worldName);
 
-    msgs::Scene sceneMsg;
+    this->sceneMsg.Clear();
 
-    AddModels(&sceneMsg, this->worldEntity, newGraph);
+    AddModels(&this->sceneMsg, this->worldEntity, newGraph);
 
     // Add lights
-    AddLights(&sceneMsg, this->worldEntity, newGraph);
-    this->scenePub.Publish(sceneMsg);
+    AddLights(&this->sceneMsg, this->worldEntity, newGraph);
+    this->scenePub.Publish(this->sceneMsg);
   }
 }
 
@@ -797,8 +1548,6 @@ void SceneBroadcasterPrivate::SceneGraphRemoveEntities(
       [&](const Entity &_entity, const components::Model *) -> bool
       {
         removedEntities.push_back(_entity);
-        // Remove from graph
-        RemoveFromGraph(_entity, this->sceneGraph);
         return true;
       });
 
@@ -807,13 +1556,60 @@ void SceneBroadcasterPrivate::SceneGraphRemoveEntities(
       [&](const Entity &_entity, const components::Light *) -> bool
       {
         removedEntities.push_back(_entity);
-        // Remove from graph
-        RemoveFromGraph(_entity, this->sceneGraph);
         return true;
       });
 
   if (!removedEntities.empty())
   {
+    // Children of the world can be removed from the cached scene info.
+    // Entities within removed ones go with them. Anything else invalidates
+    // it.
+    std::unordered_set<Entity> topLevel;
+    const std::unordered_set<Entity> removed(removedEntities.begin(),
+        removedEntities.end());
+    for (const auto &entity : removedEntities)
+    {
+      if (this->sceneGraph.EdgeFromVertices(this->worldEntity, entity)
+          .Valid())
+      {
+        topLevel.insert(entity);
+        continue;
+      }
+
+      // Look for a removed ancestor, such as the model of a link's light
+      bool withAncestor{false};
+      for (auto parentComp =
+               _manager.Component<components::ParentEntity>(entity);
+           nullptr != parentComp && !withAncestor;
+           parentComp = _manager.Component<components::ParentEntity>(
+               parentComp->Data()))
+      {
+        withAncestor = removed.count(parentComp->Data()) > 0;
+      }
+      if (!withAncestor)
+        this->sceneInfoValid = false;
+    }
+
+    if (this->sceneInfoValid)
+    {
+      auto removeTopLevel = [&topLevel](auto *_field)
+      {
+        auto end = std::remove_if(_field->begin(), _field->end(),
+            [&topLevel](const auto &_msg)
+            {
+              return topLevel.count(_msg.id()) > 0;
+            });
+        _field->DeleteSubrange(static_cast<int>(end - _field->begin()),
+            static_cast<int>(_field->end() - end));
+      };
+      removeTopLevel(this->sceneInfo.mutable_model());
+      removeTopLevel(this->sceneInfo.mutable_light());
+    }
+
+    // Remove from graph
+    for (const auto &entity : removedEntities)
+      RemoveFromGraph(entity, this->sceneGraph);
+
     // Send the list of deleted entities
     msgs::UInt32_V deletionMsg;
 
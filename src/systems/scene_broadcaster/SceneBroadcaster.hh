@@ -38,6 +38,60 @@ namespace systems
   **/
   /// \brief System which periodically publishes an ignition::msgs::Scene
   /// message with updated information.
+  ///
+  /// The state is captured with EntityComponentManager::BinaryState during
+  /// PostUpdate, and converted and published by a background thread, so the
+  /// simulation doesn't wait on transport. `<state_queue_size>` bounds how
+  /// many periodic states can wait to be published, defaults to 2. When the
+  /// queue is full the oldest periodic state is dropped. States with change
+  /// events, such as new or removed entities, are never dropped.
+  ///
+  /// Periodic changes are sent at `<state_hertz>`, defaults to 60. Component
+  /// types can be given a lower rate, with their changes coalesced until
+  /// they're due:
+  ///
+  /// <component_hertz type="ign_gazebo_components.BatterySoC">1
+  /// </component_hertz>
+  ///
+  /// Rates higher than `<state_hertz>` are capped to it.
+  ///
+  /// The same state is published zlib compressed as an
+  /// ignition::msgs::Bytes on `state/compressed`, for subscribers on slow
+  /// links. The data is compressed with
+  /// systems::log_system::CompressData, and it's only done while the topic
+  /// has subscribers. The GUI uses it when the
+  /// `IGN_GAZEBO_GUI_COMPRESSED_STATE` environment variable is set.
+  ///
+  /// Besides the full ignition::msgs::Pose_V on `dynamic_pose/info`, the
+  /// poses of non-static models and links are published as an
+  /// ignition::msgs::Bytes on `dynamic_pose/delta`, encoded by
+  /// PoseDeltaEncoder and decoded by PoseDeltaDecoder. It is throttled to
+  /// the same rate and can be configured with:
+  ///
+  /// <pose_delta>
+  ///   <position_resolution>: Quantization in meters, defaults to 1e-4.
+  ///   <orientation_resolution>: Quantization of quaternion components,
+  ///                             defaults to 1e-5.
+  ///   <position_tolerance>: Distance in meters an entity must move to be
+  ///                         sent again, defaults to 1e-4.
+  ///   <orientation_tolerance>: Angle in radians an entity must rotate to be
+  ///                            sent again, defaults to 1e-4.
+  ///   <keyframe_period>: Frames between keyframes, defaults to 60.
+  /// </pose_delta>
+  ///
+  /// Subscribers which only need part of the world can register an area of
+  /// interest with the `state/filter` service, which takes an
+  /// ignition::msgs::StringMsg_V and responds with the topic where the
+  /// filtered ignition::msgs::SerializedStepMap is published. Each string of
+  /// the request is one of:
+  ///
+  /// * `model <name>`: the model and everything inside it
+  /// * `entity <id>`: the entity and all its descendants
+  /// * `region <min x> <min y> <min z> <max x> <max y> <max z>`: top level
+  ///   models whose origin is inside the box
+  /// * `component <type name or id>`: only send these component types
+  ///
+  /// Identical filters share a topic, so their state is serialized once.
   class SceneBroadcaster:
     public System,
     public ISystemConfigure,
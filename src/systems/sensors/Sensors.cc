@@ -17,15 +17,28 @@
 
 #include "Sensors.hh"
 
+#include <ignition/msgs/camera_info.pb.h>
+#include <ignition/msgs/image.pb.h>
+#include <ignition/msgs/param_v.pb.h>
+#include <ignition/msgs/pointcloud_packed.pb.h>
+
+#include <algorithm>
+#include <functional>
 #include <map>
+#include <memory>
 #include <set>
+#include <sstream>
+#include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <ignition/common/Profiler.hh>
 #include <ignition/plugin/Register.hh>
+#include <ignition/transport/Node.hh>
 
+#include <sdf/Camera.hh>
 #include <sdf/Sensor.hh>
 
 #include <ignition/math/Helpers.hh>
@@ -40,15 +53,18 @@
 #include "ignition/gazebo/components/Camera.hh"
 #include "ignition/gazebo/components/DepthCamera.hh"
 #include "ignition/gazebo/components/GpuLidar.hh"
+#include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/components/RenderEngineServerPlugin.hh"
 #include "ignition/gazebo/components/RgbdCamera.hh"
 #include "ignition/gazebo/components/ThermalCamera.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Events.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/ThreadAffinity.hh"
 
 #include "ignition/gazebo/rendering/Events.hh"
 #include "ignition/gazebo/rendering/RenderUtil.hh"
+#include "ignition/gazebo/rendering/SceneManager.hh"
 
 using namespace ignition;
 using namespace gazebo;
@@ -106,6 +122,9 @@ class ignition::gazebo::systems::SensorsPrivate
   /// \brief Thread that rendering will occur in
   public: std::thread renderThread;
 
+  /// \brief CPUs the render thread runs on, empty for any.
+  public: std::vector<unsigned int> renderCpus;
+
   /// \brief Mutex to protect rendering data
   public: std::mutex renderMutex;
 
@@ -125,12 +144,155 @@ class ignition::gazebo::systems::SensorsPrivate
   /// \brief Sensors to include in the next rendering iteration
   public: std::vector<sensors::RenderingSensor *> activeSensors;
 
-  /// \brief Mutex to protect sensorMask
+  /// \brief Sensors included in the rendering iteration currently running.
+  /// Only accessed from the rendering thread.
+  public: std::vector<sensors::RenderingSensor *> renderingSensors;
+
+  /// \brief Update time of the rendering iteration currently running.
+  public: std::chrono::steady_clock::duration renderingTime;
+
+  /// \brief True to let PostUpdate hand over the next rendering iteration
+  /// while the current one is still running, instead of waiting for it to
+  /// finish. Rendering is then at most one iteration behind simulation.
+  public: bool pipelined{false};
+
+  /// \brief Mutex to protect renderingIds and activeSensors
   public: std::mutex sensorMaskMutex;
 
-  /// \brief Mask sensor updates for sensors currently being rendered
-  public: std::map<sensors::SensorId,
-    std::chrono::steady_clock::duration> sensorMask;
+  /// \brief Sensors which have been handed over to the rendering thread and
+  /// haven't finished rendering yet. Their next update time isn't updated
+  /// until they render, so they mustn't be handed over again until then.
+  public: std::set<sensors::SensorId> renderingIds;
+
+  /// \brief Sensors which are due within this fraction of their update
+  /// period are rendered together with sensors which are already due, so
+  /// they share the same scene update. Zero disables batching.
+  public: double batchTolerance{0.0};
+
+  /// \brief Whether cameras and depth cameras with the same view as an
+  /// RGBD camera take their data from it instead of being rendered, set
+  /// through `<share_rgbd_passes>`.
+  public: bool shareRgbdPasses{false};
+
+  /// \brief What a camera sees. Sensors with equal views render the same
+  /// images.
+  public: struct CameraView
+  {
+    /// \brief Type of the sensor.
+    public: sdf::SensorType type{sdf::SensorType::NONE};
+
+    /// \brief Scoped name of the parent.
+    public: std::string parent;
+
+    /// \brief Pose of the sensor.
+    public: math::Pose3d sensorPose;
+
+    /// \brief Pose of the camera within the sensor.
+    public: math::Pose3d cameraPose;
+
+    /// \brief Image width in pixels.
+    public: unsigned int width{0};
+
+    /// \brief Image height in pixels.
+    public: unsigned int height{0};
+
+    /// \brief Horizontal field of view in radians.
+    public: double hfov{0.0};
+
+    /// \brief Near clip distance.
+    public: double nearClip{0.0};
+
+    /// \brief Far clip distance.
+    public: double farClip{0.0};
+
+    /// \brief Update rate in Hz.
+    public: double updateRate{0.0};
+
+    /// \brief Whether two sensors see the same images, at the same rate.
+    /// \param[in] _other The other view.
+    /// \return True if the views are equal, regardless of the type.
+    public: bool SameAs(const CameraView &_other) const
+    {
+      return this->parent == _other.parent &&
+          this->sensorPose == _other.sensorPose &&
+          this->cameraPose == _other.cameraPose &&
+          this->width == _other.width && this->height == _other.height &&
+          math::equal(this->hfov, _other.hfov) &&
+          math::equal(this->nearClip, _other.nearClip) &&
+          math::equal(this->farClip, _other.farClip) &&
+          math::equal(this->updateRate, _other.updateRate);
+    }
+  };
+
+  /// \brief Views of cameras, depth cameras and RGBD cameras, if
+  /// shareRgbdPasses is set.
+  public: std::map<sensors::SensorId, CameraView> views;
+
+  /// \brief A camera or depth camera whose data is relayed from an RGBD
+  /// camera with the same view, instead of being rendered.
+  public: struct SharedPass
+  {
+    /// \brief RGBD camera whose data is relayed.
+    public: sensors::SensorId rgbdId{sensors::NO_SENSOR};
+
+    /// \brief Node relaying the data.
+    public: std::unique_ptr<transport::Node> node;
+  };
+
+  /// \brief Sensors which aren't rendered, keyed by sensor. Protected by
+  /// sensorMaskMutex.
+  public: std::map<sensors::SensorId, SharedPass> sharedPasses;
+
+  /// \brief Let a new sensor share the pass of an RGBD camera with the
+  /// same view, or let cameras with the same view as a new RGBD camera
+  /// share its pass.
+  /// \param[in] _id The new sensor.
+  public: void ShareRgbdPasses(const sensors::SensorId _id);
+
+  /// \brief Relay the data of an RGBD camera on the topics of a camera or
+  /// depth camera with the same view, and stop rendering the latter.
+  /// \param[in] _rgbdId The RGBD camera.
+  /// \param[in] _id The camera or depth camera.
+  public: void RelayRgbdPass(const sensors::SensorId _rgbdId,
+      const sensors::SensorId _id);
+
+  /// \brief Rendering statistics of a sensor since stats were last
+  /// published.
+  public: struct SensorStats
+  {
+    /// \brief Number of updates.
+    public: unsigned int updates{0};
+
+    /// \brief Total wall time spent updating.
+    public: std::chrono::steady_clock::duration renderTime{0};
+
+    /// \brief Longest wall time spent on one update.
+    public: std::chrono::steady_clock::duration maxRenderTime{0};
+  };
+
+  /// \brief Statistics of each sensor. Only accessed from the rendering
+  /// thread.
+  public: std::map<sensors::SensorId, SensorStats> sensorStats;
+
+  /// \brief Sim time at which the current statistics window started.
+  public: std::chrono::steady_clock::duration statsSimTime{0};
+
+  /// \brief Wall time at which statistics were last published.
+  public: std::chrono::steady_clock::time_point statsWallTime;
+
+  /// \brief Whether to publish sensor statistics, set through the
+  /// `<publish_stats>` SDF element.
+  public: bool publishStats{false};
+
+  /// \brief Node used to publish sensor statistics.
+  public: transport::Node node;
+
+  /// \brief Publisher of sensor statistics.
+  public: transport::Node::Publisher statsPub;
+
+  /// \brief Publish sensor statistics if enough time has passed since they
+  /// were last published, and start a new statistics window.
+  private: void PublishStats();
 
   /// \brief Pointer to the event manager
   public: EventManager *eventManager{nullptr};
@@ -167,6 +329,12 @@ class ignition::gazebo::systems::SensorsPrivate
   //
   /// The caller of PostUpdate will be blocked if there is a rendering
   /// operation currently ongoing, until that completes.
+  ///
+  /// In pipelined mode, RunOnce takes the request and clears
+  /// updateAvailable before rendering, without holding renderMutex while it
+  /// renders. The caller of PostUpdate is then only blocked if the previous
+  /// request hasn't been taken yet, i.e. while one iteration is rendering and
+  /// another one is already waiting.
   private: void RenderThread();
 
   /// \brief Launch the rendering thread
@@ -222,32 +390,29 @@ void SensorsPrivate::RunOnce()
 
   IGN_PROFILE("SensorsPrivate::RunOnce");
   {
-    IGN_PROFILE("Update");
-    this->renderUtil.Update();
+    std::lock_guard<std::mutex> maskLock(this->sensorMaskMutex);
+    this->renderingSensors.swap(this->activeSensors);
+    this->activeSensors.clear();
   }
+  this->renderingTime = this->updateTime;
 
+  if (this->pipelined)
+  {
+    // Free the request so PostUpdate can hand over the next one while
+    // this one renders
+    this->updateAvailable = false;
+    lock.unlock();
+    this->renderCv.notify_one();
+  }
 
-  if (!this->activeSensors.empty())
   {
-    this->sensorMaskMutex.lock();
-    // Check the active sensors against masked sensors.
-    //
-    // The internal state of a rendering sensor is not updated until the
-    // rendering operation is complete, which can leave us in a position
-    // where the sensor is falsely indicating that an update is needed.
-    //
-    // To prevent this, add sensors that are currently being rendered to
-    // a mask. Sensors are removed from the mask when 90% of the update
-    // delta has passed, which will allow rendering to proceed.
-    for (const auto & sensor : this->activeSensors)
-    {
-      // 90% of update delta (1/UpdateRate());
-      auto delta = std::chrono::duration_cast< std::chrono::milliseconds>(
-        std::chrono::duration< double >(0.9 / sensor->UpdateRate()));
-      this->sensorMask[sensor->Id()] = this->updateTime + delta;
-    }
-    this->sensorMaskMutex.unlock();
+    IGN_PROFILE("Update");
+    this->renderUtil.Update();
+    this->renderUtil.SceneManager().UpdateLod({});
+  }
 
+  if (!this->renderingSensors.empty())
+  {
     {
       IGN_PROFILE("PreRender");
       this->eventManager->Emit<events::PreRender>();
@@ -261,16 +426,97 @@ void SensorsPrivate::RunOnce()
     {
       // publish data
       IGN_PROFILE("RunOnce");
-      this->sensorManager.RunOnce(this->updateTime);
+      for (auto sensor : this->renderingSensors)
+      {
+        // Sensors batched ahead of their update time are stamped with it,
+        // so their data stays periodic
+        auto start = std::chrono::steady_clock::now();
+        sensor->Update(std::max(this->renderingTime,
+            sensor->NextDataUpdateTime()), false);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        auto &stats = this->sensorStats[sensor->Id()];
+        ++stats.updates;
+        stats.renderTime += elapsed;
+        stats.maxRenderTime = std::max(stats.maxRenderTime, elapsed);
+      }
       this->eventManager->Emit<events::PostRender>();
     }
 
-    this->activeSensors.clear();
+    {
+      std::lock_guard<std::mutex> maskLock(this->sensorMaskMutex);
+      for (auto sensor : this->renderingSensors)
+        this->renderingIds.erase(sensor->Id());
+    }
+    this->renderingSensors.clear();
+
+    if (this->publishStats)
+      this->PublishStats();
   }
 
-  this->updateAvailable = false;
-  lock.unlock();
-  this->renderCv.notify_one();
+  if (!this->pipelined)
+  {
+    this->updateAvailable = false;
+    lock.unlock();
+    this->renderCv.notify_one();
+  }
+}
+
+//////////////////////////////////////////////////
+void SensorsPrivate::PublishStats()
+{
+  auto now = std::chrono::steady_clock::now();
+  if (now - this->statsWallTime < std::chrono::seconds(1))
+    return;
+
+  auto simTime = this->renderingTime - this->statsSimTime;
+  bool first = this->statsWallTime ==
+      std::chrono::steady_clock::time_point();
+  this->statsWallTime = now;
+  this->statsSimTime = this->renderingTime;
+  if (first || simTime <= std::chrono::steady_clock::duration::zero())
+  {
+    this->sensorStats.clear();
+    return;
+  }
+
+  auto toMs = [](const std::chrono::steady_clock::duration &_duration)
+  {
+    return std::chrono::duration<double, std::milli>(_duration).count();
+  };
+
+  auto setDouble = [](msgs::Param &_param, const std::string &_key,
+      double _value)
+  {
+    auto &any = (*_param.mutable_params())[_key];
+    any.set_type(msgs::Any::DOUBLE);
+    any.set_double_value(_value);
+  };
+
+  msgs::Param_V msg;
+  for (auto id : this->sensorIds)
+  {
+    auto sensor = this->sensorManager.Sensor(id);
+    if (nullptr == sensor)
+      continue;
+
+    const auto &stats = this->sensorStats[id];
+    auto *param = msg.add_param();
+
+    auto &name = (*param->mutable_params())["name"];
+    name.set_type(msgs::Any::STRING);
+    name.set_string_value(sensor->Name());
+
+    setDouble(*param, "rate", sensor->UpdateRate());
+    setDouble(*param, "achieved_rate", stats.updates /
+        std::chrono::duration<double>(simTime).count());
+    setDouble(*param, "render_time_mean_ms", stats.updates == 0 ? 0.0 :
+        toMs(stats.renderTime) / stats.updates);
+    setDouble(*param, "render_time_max_ms", toMs(stats.maxRenderTime));
+  }
+  this->statsPub.Publish(msg);
+
+  this->sensorStats.clear();
 }
 
 //////////////////////////////////////////////////
@@ -280,6 +526,8 @@ void SensorsPrivate::RenderThread()
 
   igndbg << "SensorsPrivate::RenderThread started" << std::endl;
 
+  SetThreadCpus(this->renderCpus);
+
   // We have to wait for rendering sensors to be available
   this->WaitForInit();
 
@@ -325,6 +573,96 @@ void SensorsPrivate::Stop()
   }
 }
 
+//////////////////////////////////////////////////
+void SensorsPrivate::ShareRgbdPasses(const sensors::SensorId _id)
+{
+  auto viewIt = this->views.find(_id);
+  if (viewIt == this->views.end())
+    return;
+  const auto &view = viewIt->second;
+
+  for (const auto &[otherId, otherView] : this->views)
+  {
+    if (otherId == _id || !view.SameAs(otherView))
+      continue;
+
+    if (view.type == sdf::SensorType::RGBD_CAMERA &&
+        otherView.type != sdf::SensorType::RGBD_CAMERA &&
+        this->sharedPasses.find(otherId) == this->sharedPasses.end())
+    {
+      this->RelayRgbdPass(_id, otherId);
+    }
+    else if (view.type != sdf::SensorType::RGBD_CAMERA &&
+        otherView.type == sdf::SensorType::RGBD_CAMERA)
+    {
+      this->RelayRgbdPass(otherId, _id);
+      return;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void SensorsPrivate::RelayRgbdPass(const sensors::SensorId _rgbdId,
+    const sensors::SensorId _id)
+{
+  auto rgbd = dynamic_cast<sensors::CameraSensor *>(
+      this->sensorManager.Sensor(_rgbdId));
+  auto sensor = dynamic_cast<sensors::CameraSensor *>(
+      this->sensorManager.Sensor(_id));
+  if (nullptr == rgbd || nullptr == sensor)
+    return;
+
+  SharedPass pass;
+  pass.rgbdId = _rgbdId;
+  pass.node = std::make_unique<transport::Node>();
+
+  // Republish a message with the frame of the sensor it's relayed to
+  const std::string frame = sensor->Name();
+  auto relay = [&](const auto &_msgType, const std::string &_from,
+      const std::string &_to)
+  {
+    using MsgT = std::decay_t<decltype(_msgType)>;
+    if (_from.empty() || _to.empty())
+      return;
+    auto pub = std::make_shared<transport::Node::Publisher>(
+        pass.node->Advertise<MsgT>(_to));
+    std::function<void(const MsgT &)> cb =
+        [pub, frame](const MsgT &_msg)
+        {
+          MsgT msg(_msg);
+          for (auto &data : *msg.mutable_header()->mutable_data())
+          {
+            if (data.key() == "frame_id")
+            {
+              data.clear_value();
+              data.add_value(frame);
+            }
+          }
+          pub->Publish(msg);
+        };
+    pass.node->Subscribe(_from, cb);
+  };
+
+  const auto type = this->views[_id].type;
+  if (type == sdf::SensorType::CAMERA)
+  {
+    relay(msgs::Image(), rgbd->Topic() + "/image", sensor->Topic());
+  }
+  else
+  {
+    relay(msgs::Image(), rgbd->Topic() + "/depth_image", sensor->Topic());
+    relay(msgs::PointCloudPacked(), rgbd->Topic() + "/points",
+        sensor->Topic() + "/points");
+  }
+  relay(msgs::CameraInfo(), rgbd->InfoTopic(), sensor->InfoTopic());
+
+  igndbg << "Sensor [" << sensor->Name() << "] shares the rendering pass of ["
+         << rgbd->Name() << "]" << std::endl;
+
+  std::lock_guard<std::mutex> lock(this->sensorMaskMutex);
+  this->sharedPasses[_id] = std::move(pass);
+}
+
 //////////////////////////////////////////////////
 void Sensors::RemoveSensor(const Entity &_entity)
 {
@@ -344,7 +682,34 @@ void Sensors::RemoveSensor(const Entity &_entity)
       {
         this->dataPtr->activeSensors.erase(activeSensorIt);
       }
+
+      // This is called from the rendering thread, before the sensors being
+      // rendered are used
+      auto renderingSensorIt = std::find(
+          this->dataPtr->renderingSensors.begin(),
+          this->dataPtr->renderingSensors.end(), rs);
+      if (renderingSensorIt != this->dataPtr->renderingSensors.end())
+      {
+        this->dataPtr->renderingSensors.erase(renderingSensorIt);
+      }
+      this->dataPtr->renderingIds.erase(idIter->second);
+    }
+    {
+      // Sensors which shared the pass of a removed RGBD camera are
+      // rendered again
+      std::unique_lock<std::mutex> lock(this->dataPtr->sensorMaskMutex);
+      auto &passes = this->dataPtr->sharedPasses;
+      passes.erase(idIter->second);
+      for (auto it = passes.begin(); it != passes.end();)
+      {
+        if (it->second.rgbdId == idIter->second)
+          it = passes.erase(it);
+        else
+          ++it;
+      }
     }
+    this->dataPtr->views.erase(idIter->second);
+    this->dataPtr->sensorStats.erase(idIter->second);
     this->dataPtr->sensorIds.erase(idIter->second);
     this->dataPtr->sensorManager.Remove(idIter->second);
     this->dataPtr->entityToIdMap.erase(idIter);
@@ -374,6 +739,51 @@ void Sensors::Configure(const Entity &/*_id*/,
       _sdf->Get<std::string>("render_engine", "ogre2").first;
 
   this->dataPtr->renderUtil.SetEngineName(engineName);
+
+  this->dataPtr->pipelined = _sdf->Get<bool>("pipelined",
+      this->dataPtr->pipelined).first;
+  if (this->dataPtr->pipelined)
+    igndbg << "Rendering sensors in pipelined mode" << std::endl;
+
+  this->dataPtr->batchTolerance = std::clamp(_sdf->Get<double>(
+      "batch_tolerance", this->dataPtr->batchTolerance).first, 0.0, 1.0);
+  this->dataPtr->publishStats = _sdf->Get<bool>("publish_stats",
+      this->dataPtr->publishStats).first;
+  this->dataPtr->shareRgbdPasses = _sdf->Get<bool>("share_rgbd_passes",
+      this->dataPtr->shareRgbdPasses).first;
+
+  if (_sdf->Get<bool>("share_materials", false).first)
+    this->dataPtr->renderUtil.SceneManager().SetShareMaterials(true);
+
+  // Sensors see the exact geometry unless told otherwise
+  if (_sdf->Get<bool>("async_mesh_loading", false).first)
+    this->dataPtr->renderUtil.SceneManager().SetAsyncMeshLoading(true);
+
+  if (_sdf->HasElement("lod_distances"))
+  {
+    std::vector<double> distances;
+    std::stringstream distancesStr(
+        _sdf->Get<std::string>("lod_distances"));
+    for (double distance; distancesStr >> distance;)
+      distances.push_back(distance);
+    this->dataPtr->renderUtil.SceneManager().SetLodDistances(distances);
+  }
+
+  if (_sdf->HasElement("render_cpus") &&
+      !ParseCpuList(_sdf->Get<std::string>("render_cpus"),
+      this->dataPtr->renderCpus))
+  {
+    ignerr << "Failed to parse <render_cpus> ["
+           << _sdf->Get<std::string>("render_cpus")
+           << "], the render thread may run on any CPU." << std::endl;
+    this->dataPtr->renderCpus.clear();
+  }
+
+  if (_sdf->Get<bool>("sensor_culling", false).first)
+  {
+    this->dataPtr->renderUtil.SetSensorCulling(true,
+        _sdf->Get<double>("culling_margin", 10.0).first);
+  }
   this->dataPtr->renderUtil.SetEnableSensors(true,
       std::bind(&Sensors::CreateSensor, this,
       std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
@@ -394,6 +804,17 @@ void Sensors::Configure(const Entity &/*_id*/,
           atmosphereSdf.TemperatureGradient();
     }
 
+    auto worldName = _ecm.Component<components::Name>(worldEntity);
+    if (this->dataPtr->publishStats && worldName)
+    {
+      const std::string topic = "/world/" + worldName->Data() +
+          "/sensors/stats";
+      this->dataPtr->statsPub =
+          this->dataPtr->node.Advertise<msgs::Param_V>(topic);
+      igndbg << "Publishing sensor statistics on [" << topic << "]"
+             << std::endl;
+    }
+
     // Set render engine if specified from command line
     auto renderEngineServerComp =
       _ecm.Component<components::RenderEngineServerPlugin>(worldEntity);
@@ -458,31 +879,50 @@ void Sensors::PostUpdate(const UpdateInfo &_info,
     auto t = math::secNsecToDuration(time.first, time.second);
 
     std::vector<sensors::RenderingSensor *> activeSensors;
+    std::vector<sensors::RenderingSensor *> upcomingSensors;
 
     this->dataPtr->sensorMaskMutex.lock();
     for (auto id : this->dataPtr->sensorIds)
     {
+      // Skip sensors which are still being rendered, or whose data comes
+      // from another sensor
+      if (this->dataPtr->renderingIds.find(id) !=
+          this->dataPtr->renderingIds.end() ||
+          this->dataPtr->sharedPasses.find(id) !=
+          this->dataPtr->sharedPasses.end())
+      {
+        continue;
+      }
+
       sensors::Sensor *s = this->dataPtr->sensorManager.Sensor(id);
       auto rs = dynamic_cast<sensors::RenderingSensor *>(s);
+      if (!rs)
+        continue;
 
-      auto it = this->dataPtr->sensorMask.find(id);
-      if (it != this->dataPtr->sensorMask.end())
+      if (rs->NextDataUpdateTime() <= t)
       {
-        if (it->second <= t)
-        {
-          this->dataPtr->sensorMask.erase(it);
-        }
-        else
-        {
-          continue;
-        }
+        activeSensors.push_back(rs);
       }
-
-      if (rs && rs->NextDataUpdateTime() <= t)
+      else if (this->dataPtr->batchTolerance > 0.0 && rs->UpdateRate() > 0.0)
       {
-        activeSensors.push_back(rs);
+        auto tolerance = std::chrono::duration_cast<
+            std::chrono::steady_clock::duration>(std::chrono::duration<double>(
+            this->dataPtr->batchTolerance / rs->UpdateRate()));
+        if (rs->NextDataUpdateTime() <= t + tolerance)
+          upcomingSensors.push_back(rs);
       }
     }
+
+    // Sensors which are about to be due join a frame which is rendered
+    // anyway, instead of triggering another scene update shortly after
+    if (!activeSensors.empty())
+    {
+      activeSensors.insert(activeSensors.end(), upcomingSensors.begin(),
+          upcomingSensors.end());
+    }
+
+    for (auto rs : activeSensors)
+      this->dataPtr->renderingIds.insert(rs->Id());
     this->dataPtr->sensorMaskMutex.unlock();
 
     if (!activeSensors.empty() ||
@@ -497,7 +937,12 @@ void Sensors::PostUpdate(const UpdateInfo &_info,
         return;
       }
 
-      this->dataPtr->activeSensors = std::move(activeSensors);
+      {
+        // The rendering thread may be removing sensors while rendering in
+        // pipelined mode
+        std::lock_guard<std::mutex> maskLock(this->dataPtr->sensorMaskMutex);
+        this->dataPtr->activeSensors = std::move(activeSensors);
+      }
       this->dataPtr->updateTime = t;
       this->dataPtr->updateAvailable = true;
       this->dataPtr->renderCv.notify_one();
@@ -576,6 +1021,28 @@ std::string Sensors::CreateSensor(const Entity &_entity,
     }
   }
 
+  if (this->dataPtr->shareRgbdPasses &&
+      (_sdf.Type() == sdf::SensorType::CAMERA ||
+      _sdf.Type() == sdf::SensorType::DEPTH_CAMERA ||
+      _sdf.Type() == sdf::SensorType::RGBD_CAMERA) &&
+      nullptr != _sdf.CameraSensor())
+  {
+    const auto *camSdf = _sdf.CameraSensor();
+    SensorsPrivate::CameraView view;
+    view.type = _sdf.Type();
+    view.parent = _parentName;
+    view.sensorPose = _sdf.RawPose();
+    view.cameraPose = camSdf->RawPose();
+    view.width = camSdf->ImageWidth();
+    view.height = camSdf->ImageHeight();
+    view.hfov = camSdf->HorizontalFov().Radian();
+    view.nearClip = camSdf->NearClip();
+    view.farClip = camSdf->FarClip();
+    view.updateRate = _sdf.UpdateRate();
+    this->dataPtr->views[sensorId] = view;
+    this->dataPtr->ShareRgbdPasses(sensorId);
+  }
+
   // Sensor-specific settings
   auto thermalSensor = dynamic_cast<sensors::ThermalCameraSensor *>(sensor);
   if (nullptr != thermalSensor)
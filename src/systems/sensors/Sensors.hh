@@ -39,6 +39,53 @@ namespace systems
   /// \class Sensors Sensors.hh ignition/gazebo/systems/Sensors.hh
   /// \brief TODO(louise) Have one system for all sensors, or one per
   /// sensor / sensor type?
+  ///
+  /// ## System Parameters
+  ///
+  /// - `<render_engine>` Name of the render engine, defaults to `ogre2`.
+  /// - `<pipelined>` If true, simulation doesn't wait for a sensor rendering
+  ///   iteration to finish before handing over the next one, so rendering
+  ///   runs at most one iteration behind simulation. Defaults to false.
+  /// - `<batch_tolerance>` Sensors which will be due within this fraction of
+  ///   their update period are rendered together with sensors which are
+  ///   already due, so they share one scene update. Their data is still
+  ///   stamped with their own update time. Between 0 and 1, defaults to 0.
+  /// - `<publish_stats>` If true, the achieved update rate and render time of
+  ///   each sensor are published about once per second as
+  ///   `ignition.msgs.Param_V` on `/world/<world name>/sensors/stats`.
+  ///   Defaults to false.
+  /// - `<sensor_culling>` If true, pose updates of top level models which are
+  ///   farther from all rendering sensors than their far clip distance or
+  ///   maximum range are skipped until the models come back in range.
+  ///   Models' `AxisAlignedBox` components are used if present. Defaults to
+  ///   false.
+  /// - `<culling_margin>` Distance in meters added to each sensor's range
+  ///   when culling. Defaults to 10.
+  /// - `<share_rgbd_passes>` If true, cameras and depth cameras with the
+  ///   same parent, pose, resolution, field of view, clip distances and
+  ///   update rate as an RGBD camera aren't rendered. The RGBD camera renders
+  ///   color and depth in one pass, and its images, point clouds and camera
+  ///   info are republished on their topics, with their frame. Defaults to
+  ///   false.
+  /// - `<share_materials>` If true, visuals with identical materials share a
+  ///   single rendering material, so the render engine can batch draws of
+  ///   repeated visuals. Defaults to false.
+  /// - `<lod_distances>` Space separated distances in meters at which mesh
+  ///   visuals switch to simpler levels of detail, loaded from
+  ///   `<mesh name>_lod<N>.<extension>` files next to the meshes. The level
+  ///   shown depends on the distance to the closest sensor. Disabled if
+  ///   unset.
+  /// - `<async_mesh_loading>` If true, meshes are loaded on background
+  ///   threads and visuals have no geometry until theirs is ready, so
+  ///   sensors may briefly not see them. Defaults to false.
+  /// - `<render_cpus>` CPUs the render thread runs on, as comma separated
+  ///   indices and ranges such as `6-7`, see ParseCpuList. Only supported on
+  ///   Linux. Any CPU if unset.
+  ///
+  /// All rendering sensors are rendered from a single thread into a single
+  /// scene. Render engines are loaded once per process and their scenes
+  /// aren't safe to render from several threads, so sensors can't be
+  /// sharded across render threads or GPUs from within one server.
   class Sensors:
     public System,
     public ISystemConfigure,
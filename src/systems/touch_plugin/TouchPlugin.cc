@@ -29,6 +29,7 @@
 #include <sdf/Element.hh>
 
 #include "ignition/gazebo/components/ContactSensor.hh"
+#include "ignition/gazebo/components/ContactChanges.hh"
 #include "ignition/gazebo/components/ContactSensorData.hh"
 #include "ignition/gazebo/components/Collision.hh"
 #include "ignition/gazebo/components/Link.hh"
@@ -109,6 +110,13 @@ class ignition::gazebo::systems::TouchPluginPrivate
   /// \brief Whether the plugin is enabled.
   public: bool enabled{false};
 
+  /// \brief Whether the model touched a target after the last update.
+  public: bool touching{false};
+
+  /// \brief Whether touching is up to date, so it only needs to be
+  /// checked again when contacts begin or end.
+  public: bool touchingKnown{false};
+
   /// \brief Mutex for variables mutated by the service callback.
   /// The variables are: touchPub, touchStart, enabled
   public: std::mutex serviceMutex;
@@ -247,36 +255,78 @@ void TouchPluginPrivate::Update(const UpdateInfo &_info,
   {
     std::lock_guard<std::mutex> lock(this->serviceMutex);
     if (!this->enabled)
+    {
+      // Contact changes are missed while disabled
+      this->touchingKnown = false;
       return;
+    }
   }
 
   if (_info.paused)
+  {
+    this->touchingKnown = false;
     return;
+  }
 
-  bool touching{false};
-  // Iterate through all the target entities and check if there is a contact
-  // between the target entity and this model
+  // Only check the touched collisions again if contacts began or ended
+  bool changed{!this->touchingKnown};
   for (const Entity colEntity : this->collisionEntities)
   {
-    auto *contacts = _ecm.Component<components::ContactSensorData>(colEntity);
-    if (contacts)
+    auto *changes = _ecm.Component<components::ContactChanges>(colEntity);
+    if (nullptr == changes || changes->Data().Changed())
     {
-      // Check if the contacts include one of the target entities.
-      for (const auto &contact : contacts->Data().contact())
+      changed = true;
+      break;
+    }
+  }
+
+  if (changed)
+  {
+    this->touchingKnown = true;
+    this->touching = false;
+
+    // Iterate through all the target entities and check if there is a
+    // contact between the target entity and this model
+    for (const Entity colEntity : this->collisionEntities)
+    {
+      auto *changes = _ecm.Component<components::ContactChanges>(colEntity);
+      if (changes)
+      {
+        for (auto touched : changes->Data().touching)
+        {
+          if (std::binary_search(this->targetEntities.begin(),
+              this->targetEntities.end(), touched))
+          {
+            this->touching = true;
+          }
+        }
+        continue;
+      }
+
+      // Not filled by physics yet, fall back to the contact points
+      this->touchingKnown = false;
+      auto *contacts =
+          _ecm.Component<components::ContactSensorData>(colEntity);
+      if (contacts)
       {
-        bool col1Target = std::binary_search(this->targetEntities.begin(),
-            this->targetEntities.end(),
-            contact.collision1().id());
-        bool col2Target = std::binary_search(this->targetEntities.begin(),
-            this->targetEntities.end(),
-            contact.collision2().id());
-        if (col1Target || col2Target)
+        // Check if the contacts include one of the target entities.
+        for (const auto &contact : contacts->Data().contact())
         {
-          touching = true;
+          bool col1Target = std::binary_search(this->targetEntities.begin(),
+              this->targetEntities.end(),
+              contact.collision1().id());
+          bool col2Target = std::binary_search(this->targetEntities.begin(),
+              this->targetEntities.end(),
+              contact.collision2().id());
+          if (col1Target || col2Target)
+          {
+            this->touching = true;
+          }
         }
       }
     }
   }
+  const bool touching = this->touching;
 
   if (!touching)
   {
@@ -338,6 +388,9 @@ void TouchPluginPrivate::AddTargetEntities(const EntityComponentManager &_ecm,
   if (_entities.empty())
     return;
 
+  // New targets may already be touching
+  this->touchingKnown = false;
+
   for (Entity entity : _entities)
   {
     // The target name can be a substring of the desired collision name so we
@@ -379,6 +432,14 @@ void TouchPlugin::PreUpdate(const UpdateInfo &, EntityComponentManager &_ecm)
     // that all entities have been created when Configure is called
     this->dataPtr->Load(_ecm, this->dataPtr->sdfConfig);
     this->dataPtr->initialized = true;
+
+    // Have the Physics system report when contacts begin or end, so they
+    // don't need to be scanned on every update
+    for (const Entity colEntity : this->dataPtr->collisionEntities)
+    {
+      if (nullptr == _ecm.Component<components::ContactChanges>(colEntity))
+        _ecm.CreateComponent(colEntity, components::ContactChanges());
+    }
   }
 
   // This is not an "else" because "initialized" can be set in the if block
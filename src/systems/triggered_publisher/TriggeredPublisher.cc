@@ -20,7 +20,10 @@
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
 
+#include <cmath>
+#include <cstdint>
 #include <limits>
+#include <string>
 #include <utility>
 
 #include <ignition/common/Profiler.hh>
@@ -82,6 +85,9 @@ class systems::InputMatcher
   /// \brief State of the matcher
   protected: bool valid{false};
 
+  /// \brief Tolerance for float comparisons
+  protected: double tol{1e-8};
+
   /// \brief Field comparator used by MessageDifferencer. This is where
   /// tolerance for float comparisons is set
   protected: google::protobuf::util::DefaultFieldComparator comparator;
@@ -166,6 +172,17 @@ class FieldMatcher : public InputMatcher
                      &_fieldDesc,
                  transport::ProtoMsg **_subMsg);
 
+  /// \brief Store the value of a singular scalar field, so it can be
+  /// compared directly against input messages instead of through the
+  /// MessageDifferencer.
+  /// \param[in] _subMsg Submessage of the matcher containing the field
+  protected: void Compile(const transport::ProtoMsg &_subMsg);
+
+  /// \brief Compare the stored value of a compiled field against the input.
+  /// \param[in] _subMsg Submessage of the input containing the field
+  /// \return True if the values are equal.
+  protected: bool CompiledCompare(const transport::ProtoMsg &_subMsg) const;
+
   /// \brief Logic type of this matcher
   protected: const bool logicType;
 
@@ -175,6 +192,21 @@ class FieldMatcher : public InputMatcher
   /// \brief Field descriptor of the field compared by this matcher
   protected: std::vector<const google::protobuf::FieldDescriptor *>
                  fieldDescMatcher;
+
+  /// \brief True if the field is compared with CompiledCompare.
+  protected: bool compiled{false};
+
+  /// \brief Value of a compiled float field
+  protected: double doubleValue{0.0};
+
+  /// \brief Value of a compiled signed integer, bool or enum field
+  protected: int64_t intValue{0};
+
+  /// \brief Value of a compiled unsigned integer field
+  protected: uint64_t uintValue{0};
+
+  /// \brief Value of a compiled string field
+  protected: std::string stringValue;
 };
 
 //////////////////////////////////////////////////
@@ -199,6 +231,7 @@ bool InputMatcher::Match(const transport::ProtoMsg &_input) const
 
 void InputMatcher::SetTolerance(double _tol)
 {
+  this->tol = _tol;
   this->comparator.SetDefaultFractionAndMargin(
       std::numeric_limits<double>::min(), _tol);
 }
@@ -291,9 +324,95 @@ FieldMatcher::FieldMatcher(const std::string &_msgType, bool _logicType,
     return;
   }
 
+  this->Compile(*matcherSubMsg);
   this->valid = true;
 }
 
+//////////////////////////////////////////////////
+void FieldMatcher::Compile(const transport::ProtoMsg &_subMsg)
+{
+  using google::protobuf::FieldDescriptor;
+
+  auto *fieldDesc = this->fieldDescMatcher.back();
+  if (fieldDesc->is_repeated())
+    return;
+
+  auto *refl = _subMsg.GetReflection();
+  this->compiled = true;
+  switch (fieldDesc->cpp_type())
+  {
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      this->doubleValue = refl->GetDouble(_subMsg, fieldDesc);
+      break;
+    case FieldDescriptor::CPPTYPE_FLOAT:
+      this->doubleValue = refl->GetFloat(_subMsg, fieldDesc);
+      break;
+    case FieldDescriptor::CPPTYPE_INT32:
+      this->intValue = refl->GetInt32(_subMsg, fieldDesc);
+      break;
+    case FieldDescriptor::CPPTYPE_INT64:
+      this->intValue = refl->GetInt64(_subMsg, fieldDesc);
+      break;
+    case FieldDescriptor::CPPTYPE_UINT32:
+      this->uintValue = refl->GetUInt32(_subMsg, fieldDesc);
+      break;
+    case FieldDescriptor::CPPTYPE_UINT64:
+      this->uintValue = refl->GetUInt64(_subMsg, fieldDesc);
+      break;
+    case FieldDescriptor::CPPTYPE_BOOL:
+      this->intValue = refl->GetBool(_subMsg, fieldDesc);
+      break;
+    case FieldDescriptor::CPPTYPE_ENUM:
+      this->intValue = refl->GetEnumValue(_subMsg, fieldDesc);
+      break;
+    case FieldDescriptor::CPPTYPE_STRING:
+      this->stringValue = refl->GetString(_subMsg, fieldDesc);
+      break;
+    // Submessages are left to the MessageDifferencer
+    default:
+      this->compiled = false;
+      break;
+  }
+}
+
+//////////////////////////////////////////////////
+bool FieldMatcher::CompiledCompare(const transport::ProtoMsg &_subMsg) const
+{
+  using google::protobuf::FieldDescriptor;
+
+  auto *fieldDesc = this->fieldDescMatcher.back();
+  auto *refl = _subMsg.GetReflection();
+  switch (fieldDesc->cpp_type())
+  {
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+    case FieldDescriptor::CPPTYPE_FLOAT:
+    {
+      double value = fieldDesc->cpp_type() == FieldDescriptor::CPPTYPE_DOUBLE ?
+          refl->GetDouble(_subMsg, fieldDesc) :
+          refl->GetFloat(_subMsg, fieldDesc);
+      // Same as the DefaultFieldComparator with a margin of tol
+      return value == this->doubleValue ||
+          std::abs(value - this->doubleValue) <= this->tol;
+    }
+    case FieldDescriptor::CPPTYPE_INT32:
+      return refl->GetInt32(_subMsg, fieldDesc) == this->intValue;
+    case FieldDescriptor::CPPTYPE_INT64:
+      return refl->GetInt64(_subMsg, fieldDesc) == this->intValue;
+    case FieldDescriptor::CPPTYPE_UINT32:
+      return refl->GetUInt32(_subMsg, fieldDesc) == this->uintValue;
+    case FieldDescriptor::CPPTYPE_UINT64:
+      return refl->GetUInt64(_subMsg, fieldDesc) == this->uintValue;
+    case FieldDescriptor::CPPTYPE_BOOL:
+      return refl->GetBool(_subMsg, fieldDesc) == (this->intValue != 0);
+    case FieldDescriptor::CPPTYPE_ENUM:
+      return refl->GetEnumValue(_subMsg, fieldDesc) == this->intValue;
+    case FieldDescriptor::CPPTYPE_STRING:
+      return refl->GetString(_subMsg, fieldDesc) == this->stringValue;
+    default:
+      return false;
+  }
+}
+
 //////////////////////////////////////////////////
 bool FieldMatcher::FindFieldSubMessage(
     transport::ProtoMsg *_msg, const std::string &_fieldName,
@@ -374,8 +493,6 @@ bool FieldMatcher::FindFieldSubMessage(
 bool FieldMatcher::DoMatch(
     const transport::ProtoMsg &_input) const
 {
-  google::protobuf::util::DefaultFieldComparator comp;
-
   auto *matcherRefl = this->matchMsg->GetReflection();
   auto *inputRefl = _input.GetReflection();
   const transport::ProtoMsg *subMsgMatcher = this->matchMsg.get();
@@ -391,11 +508,15 @@ bool FieldMatcher::DoMatch(
     }
     else
     {
-      subMsgMatcher = &matcherRefl->GetMessage(*subMsgMatcher, fieldDesc);
+      if (!this->compiled)
+        subMsgMatcher = &matcherRefl->GetMessage(*subMsgMatcher, fieldDesc);
       subMsgInput = &inputRefl->GetMessage(*subMsgInput, fieldDesc);
     }
   }
 
+  if (this->compiled)
+    return this->logicType == this->CompiledCompare(*subMsgInput);
+
   return this->logicType ==
          this->diff.CompareWithFields(*subMsgMatcher, *subMsgInput,
                                       {this->fieldDescMatcher.back()},
@@ -22,9 +22,14 @@
 #include <ignition/msgs/entity_factory.pb.h>
 #include <ignition/msgs/light.pb.h>
 #include <ignition/msgs/pose.pb.h>
+#include <ignition/msgs/pose_v.pb.h>
 #include <ignition/msgs/physics.pb.h>
 
+#include <chrono>
+#include <deque>
+#include <future>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -39,6 +44,7 @@
 #include <ignition/transport/Node.hh>
 
 #include "ignition/common/Profiler.hh"
+#include "ignition/common/WorkerPool.hh"
 
 #include "ignition/gazebo/components/Light.hh"
 #include "ignition/gazebo/components/LightCmd.hh"
@@ -98,6 +104,16 @@ class UserCommandBase
   /// \return True if command was properly executed.
   public: virtual bool Execute() = 0;
 
+  /// \brief Block until the command can be executed. Commands which do
+  /// some of their work off the simulation thread wait for it here.
+  public: virtual void Wait();
+
+  /// \brief Key identifying what the command modifies, if executing only
+  /// the latest of several queued commands with the same key has the same
+  /// effect as executing all of them.
+  /// \return Key, or an empty string if the command can't be coalesced.
+  public: virtual std::string CoalesceKey() const;
+
   /// \brief Message containing command.
   protected: google::protobuf::Message *msg{nullptr};
 
@@ -114,8 +130,31 @@ class CreateCommand : public UserCommandBase
   public: CreateCommand(msgs::EntityFactory *_msg,
       std::shared_ptr<UserCommandsInterface> &_iface);
 
+  /// \brief Parse the SDF in the message, resolving any URIs. This doesn't
+  /// touch the ECM, so it can run on any thread, but only once.
+  public: void Prepare();
+
   // Documentation inherited
   public: bool Execute() final;
+
+  // Documentation inherited
+  public: void Wait() final;
+
+  /// \brief Parsed SDF, if the message has an SDF string or file.
+  private: sdf::Root root;
+
+  /// \brief Light, if the message has a light.
+  private: sdf::Light lightSdf;
+
+  /// \brief Whether Prepare found something which can be spawned.
+  private: bool valid{false};
+
+  /// \brief Set once Prepare is done. Members above are only read by
+  /// Execute after this is set.
+  private: std::promise<void> prepared;
+
+  /// \brief Future of the prepared promise.
+  private: std::future<void> preparedFuture{prepared.get_future()};
 };
 
 /// \brief Command to remove an entity from simulation.
@@ -143,6 +182,9 @@ class LightCommand : public UserCommandBase
   // Documentation inherited
   public: bool Execute() final;
 
+  // Documentation inherited
+  public: std::string CoalesceKey() const final;
+
   /// \brief Light equality comparison function.
   public: std::function<bool(const msgs::Light &, const msgs::Light &)>
           lightEql { [](const msgs::Light &_a, const msgs::Light &_b)
@@ -207,6 +249,9 @@ class PoseCommand : public UserCommandBase
   // Documentation inherited
   public: bool Execute() final;
 
+  // Documentation inherited
+  public: std::string CoalesceKey() const final;
+
   /// \brief Pose3d equality comparison function.
   public: std::function<bool(const math::Pose3d &, const math::Pose3d &)>
           pose3Eql { [](const math::Pose3d &_a, const math::Pose3d &_b)
@@ -230,6 +275,9 @@ class PhysicsCommand : public UserCommandBase
 
   // Documentation inherited
   public: bool Execute() final;
+
+  // Documentation inherited
+  public: std::string CoalesceKey() const final;
 };
 }
 }
@@ -277,6 +325,20 @@ class ignition::gazebo::systems::UserCommandsPrivate
   /// \return True if successful.
   public: bool PoseService(const msgs::Pose &_req, msgs::Boolean &_res);
 
+  /// \brief Callback for pose vector service
+  /// \param[in] _req Request containing pose updates of several entities.
+  /// \param[in] _res True if message successfully received and queued.
+  /// It does not mean that the entities will be successfully moved.
+  /// \return True if successful.
+  public: bool PoseVectorService(const msgs::Pose_V &_req,
+      msgs::Boolean &_res);
+
+  /// \brief Drop queued commands which are superseded by a later command
+  /// with the same coalesce key. Commands without a key, like create and
+  /// remove, aren't reordered across, since they may change which entity a
+  /// name refers to.
+  public: void CoalesceCommands();
+
   /// \brief Callback for physics service
   /// \param[in] _req Request containing updates to the physics parameters.
   /// \param[in] _res True if message successfully received and queued.
@@ -284,9 +346,25 @@ class ignition::gazebo::systems::UserCommandsPrivate
   /// \return True if successful.
   public: bool PhysicsService(const msgs::Physics &_req, msgs::Boolean &_res);
 
+  /// \brief Queue a create command, and start parsing its SDF on the
+  /// worker pool.
+  /// \param[in] _msg Factory message, the command takes ownership of it.
+  /// \return The command, which must be queued under the pending mutex.
+  public: std::unique_ptr<UserCommandBase> PrepareCreateCommand(
+      msgs::EntityFactory *_msg);
+
   /// \brief Queue of commands pending execution.
   public: std::vector<std::unique_ptr<UserCommandBase>> pendingCmds;
 
+  /// \brief Commands moved out of the pending queue which haven't been
+  /// executed yet, in order of reception. Only used on the simulation
+  /// thread.
+  public: std::deque<std::unique_ptr<UserCommandBase>> cmdQueue;
+
+  /// \brief Maximum time spent executing commands on each step. Zero means
+  /// there's no limit.
+  public: std::chrono::steady_clock::duration timeBudget{0};
+
   /// \brief Ignition communication node.
   public: transport::Node node;
 
@@ -295,6 +373,10 @@ class ignition::gazebo::systems::UserCommandsPrivate
 
   /// \brief Mutex to protect pending queue.
   public: std::mutex pendingMutex;
+
+  /// \brief Parses the SDF of create commands. Declared last so it's
+  /// destroyed, and its threads joined, before the commands they use.
+  public: common::WorkerPool createPool;
 };
 
 //////////////////////////////////////////////////
@@ -308,10 +390,21 @@ UserCommands::~UserCommands() = default;
 
 //////////////////////////////////////////////////
 void UserCommands::Configure(const Entity &_entity,
-    const std::shared_ptr<const sdf::Element> &,
+    const std::shared_ptr<const sdf::Element> &_sdf,
     EntityComponentManager &_ecm,
     EventManager &_eventManager)
 {
+  if (_sdf->HasElement("time_budget"))
+  {
+    auto budget = _sdf->Get<double>("time_budget");
+    if (budget > 0)
+    {
+      this->dataPtr->timeBudget =
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(budget));
+    }
+  }
+
   // Create interfaces shared among commands
   this->dataPtr->iface = std::make_shared<UserCommandsInterface>();
   this->dataPtr->iface->worldEntity = _entity;
@@ -358,6 +451,15 @@ void UserCommands::Configure(const Entity &_entity,
 
   ignmsg << "Pose service on [" << poseService << "]" << std::endl;
 
+  // Pose vector service
+  std::string poseVectorService{"/world/" + validWorldName +
+      "/set_pose_vector"};
+  this->dataPtr->node.Advertise(poseVectorService,
+      &UserCommandsPrivate::PoseVectorService, this->dataPtr.get());
+
+  ignmsg << "Pose vector service on [" << poseVectorService << "]"
+         << std::endl;
+
   // Light service
   std::string lightService{"/world/" + validWorldName + "/light_config"};
   this->dataPtr->node.Advertise(lightService,
@@ -379,24 +481,44 @@ void UserCommands::PreUpdate(const UpdateInfo &/*_info*/,
     EntityComponentManager &)
 {
   IGN_PROFILE("UserCommands::PreUpdate");
-  // make a copy the cmds so execution does not block receiving other
+  // move the cmds out so execution does not block receiving other
   // incoming cmds
-  std::vector<std::unique_ptr<UserCommandBase>> cmds;
   {
     std::lock_guard<std::mutex> lock(this->dataPtr->pendingMutex);
-    if (this->dataPtr->pendingCmds.empty())
-      return;
-    cmds = std::move(this->dataPtr->pendingCmds);
+    for (auto &cmd : this->dataPtr->pendingCmds)
+      this->dataPtr->cmdQueue.push_back(std::move(cmd));
     this->dataPtr->pendingCmds.clear();
   }
+  auto &cmds = this->dataPtr->cmdQueue;
+  if (cmds.empty())
+    return;
+
+  this->dataPtr->CoalesceCommands();
 
   // TODO(louise) Record current world state for undo
 
-  // Execute pending commands
-  for (auto &cmd : cmds)
+  // Execute pending commands in order, until the time budget is spent. At
+  // least one command is executed on each step. Commands being prepared on
+  // the worker pool are waited for, so they take effect on the step after
+  // they're received, like the others.
+  auto start = std::chrono::steady_clock::now();
+  while (!cmds.empty())
   {
+    auto cmd = std::move(cmds.front());
+    cmds.pop_front();
+
     // Execute
-    if (!cmd->Execute())
+    cmd->Wait();
+    bool executed = cmd->Execute();
+
+    if (this->dataPtr->timeBudget.count() > 0 &&
+        std::chrono::steady_clock::now() - start >=
+        this->dataPtr->timeBudget)
+    {
+      break;
+    }
+
+    if (!executed)
       continue;
 
     // TODO(louise) Update command with current world state
@@ -411,15 +533,21 @@ void UserCommands::PreUpdate(const UpdateInfo &/*_info*/,
 bool UserCommandsPrivate::CreateServiceMultiple(
     const msgs::EntityFactory_V &_req, msgs::Boolean &_res)
 {
-  std::lock_guard<std::mutex> lock(this->pendingMutex);
+  std::vector<std::unique_ptr<UserCommandBase>> cmds;
   for (int i = 0; i < _req.data_size(); ++i)
   {
     const msgs::EntityFactory &msg = _req.data(i);
-    // Create command and push it to queue
+    // Create command and start parsing it
     auto msgCopy = msg.New();
     msgCopy->CopyFrom(msg);
-    auto cmd = std::make_unique<CreateCommand>(msgCopy, this->iface);
-    this->pendingCmds.push_back(std::move(cmd));
+    cmds.push_back(this->PrepareCreateCommand(msgCopy));
+  }
+
+  // Push to pending
+  {
+    std::lock_guard<std::mutex> lock(this->pendingMutex);
+    for (auto &cmd : cmds)
+      this->pendingCmds.push_back(std::move(cmd));
   }
 
   _res.set_data(true);
@@ -430,10 +558,10 @@ bool UserCommandsPrivate::CreateServiceMultiple(
 bool UserCommandsPrivate::CreateService(const msgs::EntityFactory &_req,
     msgs::Boolean &_res)
 {
-  // Create command and push it to queue
+  // Create command and start parsing it
   auto msg = _req.New();
   msg->CopyFrom(_req);
-  auto cmd = std::make_unique<CreateCommand>(msg, this->iface);
+  auto cmd = this->PrepareCreateCommand(msg);
 
   // Push to pending
   {
@@ -445,6 +573,43 @@ bool UserCommandsPrivate::CreateService(const msgs::EntityFactory &_req,
   return true;
 }
 
+//////////////////////////////////////////////////
+void UserCommandsPrivate::CoalesceCommands()
+{
+  IGN_PROFILE("UserCommandsPrivate::CoalesceCommands");
+  // Walk from the newest command, keeping the first one seen for each key
+  std::unordered_set<std::string> seen;
+  auto kept = this->cmdQueue.rbegin();
+  for (auto it = this->cmdQueue.rbegin(); it != this->cmdQueue.rend(); ++it)
+  {
+    auto key = (*it)->CoalesceKey();
+    if (key.empty())
+      seen.clear();
+    else if (!seen.insert(key).second)
+      continue;
+
+    if (kept != it)
+      *kept = std::move(*it);
+    ++kept;
+  }
+  this->cmdQueue.erase(this->cmdQueue.begin(), kept.base());
+}
+
+//////////////////////////////////////////////////
+std::unique_ptr<UserCommandBase> UserCommandsPrivate::PrepareCreateCommand(
+    msgs::EntityFactory *_msg)
+{
+  auto cmd = std::make_unique<CreateCommand>(_msg, this->iface);
+
+  // The command outlives the task, because the pool is destroyed first
+  auto cmdPtr = cmd.get();
+  this->createPool.AddWork([cmdPtr]
+  {
+    cmdPtr->Prepare();
+  });
+  return cmd;
+}
+
 //////////////////////////////////////////////////
 bool UserCommandsPrivate::RemoveService(const msgs::Entity &_req,
     msgs::Boolean &_res)
@@ -502,6 +667,30 @@ bool UserCommandsPrivate::PoseService(const msgs::Pose &_req,
   return true;
 }
 
+//////////////////////////////////////////////////
+bool UserCommandsPrivate::PoseVectorService(const msgs::Pose_V &_req,
+    msgs::Boolean &_res)
+{
+  // Create commands
+  std::vector<std::unique_ptr<UserCommandBase>> cmds;
+  for (int i = 0; i < _req.pose_size(); ++i)
+  {
+    auto msg = _req.pose(i).New();
+    msg->CopyFrom(_req.pose(i));
+    cmds.push_back(std::make_unique<PoseCommand>(msg, this->iface));
+  }
+
+  // Push to pending
+  {
+    std::lock_guard<std::mutex> lock(this->pendingMutex);
+    for (auto &cmd : cmds)
+      this->pendingCmds.push_back(std::move(cmd));
+  }
+
+  _res.set_data(true);
+  return true;
+}
+
 //////////////////////////////////////////////////
 bool UserCommandsPrivate::PhysicsService(const msgs::Physics &_req,
     msgs::Boolean &_res)
@@ -535,6 +724,17 @@ UserCommandBase::~UserCommandBase()
   this->msg = nullptr;
 }
 
+//////////////////////////////////////////////////
+void UserCommandBase::Wait()
+{
+}
+
+//////////////////////////////////////////////////
+std::string UserCommandBase::CoalesceKey() const
+{
+  return std::string();
+}
+
 //////////////////////////////////////////////////
 CreateCommand::CreateCommand(msgs::EntityFactory *_msg,
     std::shared_ptr<UserCommandsInterface> &_iface)
@@ -543,18 +743,21 @@ CreateCommand::CreateCommand(msgs::EntityFactory *_msg,
 }
 
 //////////////////////////////////////////////////
-bool CreateCommand::Execute()
+void CreateCommand::Prepare()
 {
+  IGN_PROFILE("CreateCommand::Prepare");
+  this->valid = false;
   auto createMsg = dynamic_cast<const msgs::EntityFactory *>(this->msg);
   if (nullptr == createMsg)
   {
     ignerr << "Internal error, null create message" << std::endl;
-    return false;
+    this->prepared.set_value();
+    return;
   }
 
   // Load SDF
-  sdf::Root root;
-  sdf::Light lightSdf;
+  auto &root = this->root;
+  auto &lightSdf = this->lightSdf;
   sdf::Errors errors;
   switch (createMsg->from_case())
   {
@@ -572,7 +775,8 @@ bool CreateCommand::Execute()
     {
       // TODO(louise) Support model msg
       ignerr << "model field not yet supported." << std::endl;
-      return false;
+      this->prepared.set_value();
+      return;
     }
     case msgs::EntityFactory::kLight:
     {
@@ -583,12 +787,14 @@ bool CreateCommand::Execute()
     {
       // TODO(louise) Implement clone
       ignerr << "Cloning an entity is not yet supported." << std::endl;
-      return false;
+      this->prepared.set_value();
+      return;
     }
     default:
     {
       ignerr << "Missing [from] field in create message." << std::endl;
-      return false;
+      this->prepared.set_value();
+      return;
     }
   }
 
@@ -596,8 +802,30 @@ bool CreateCommand::Execute()
   {
     for (auto &err : errors)
       ignerr << err << std::endl;
-    return false;
   }
+  else
+  {
+    this->valid = true;
+  }
+  this->prepared.set_value();
+}
+
+//////////////////////////////////////////////////
+void CreateCommand::Wait()
+{
+  IGN_PROFILE("CreateCommand::Wait");
+  this->preparedFuture.wait();
+}
+
+//////////////////////////////////////////////////
+bool CreateCommand::Execute()
+{
+  if (!this->valid)
+    return false;
+
+  auto createMsg = dynamic_cast<const msgs::EntityFactory *>(this->msg);
+  auto &root = this->root;
+  auto &lightSdf = this->lightSdf;
 
   bool isModel{false};
   bool isLight{false};
@@ -895,6 +1123,22 @@ bool LightCommand::Execute()
   return true;
 }
 
+//////////////////////////////////////////////////
+std::string LightCommand::CoalesceKey() const
+{
+  auto lightMsg = dynamic_cast<const msgs::Light *>(this->msg);
+  if (nullptr == lightMsg)
+    return std::string();
+
+  // A light command without a pose doesn't replace the pose set by an
+  // earlier one, so they're kept apart
+  std::string key{lightMsg->has_pose() ? "light:" : "light_no_pose:"};
+  if (lightMsg->id() != kNullEntity)
+    return key + "id:" + std::to_string(lightMsg->id());
+  return key + "name:" + lightMsg->name() + ":" +
+      std::to_string(lightMsg->parent_id());
+}
+
 //////////////////////////////////////////////////
 PoseCommand::PoseCommand(msgs::Pose *_msg,
     std::shared_ptr<UserCommandsInterface> &_iface)
@@ -953,6 +1197,18 @@ bool PoseCommand::Execute()
   return true;
 }
 
+//////////////////////////////////////////////////
+std::string PoseCommand::CoalesceKey() const
+{
+  auto poseMsg = dynamic_cast<const msgs::Pose *>(this->msg);
+  if (nullptr == poseMsg)
+    return std::string();
+
+  if (poseMsg->id() != kNullEntity && poseMsg->id() != 0)
+    return "pose:id:" + std::to_string(poseMsg->id());
+  return "pose:name:" + poseMsg->name();
+}
+
 //////////////////////////////////////////////////
 PhysicsCommand::PhysicsCommand(msgs::Physics *_msg,
     std::shared_ptr<UserCommandsInterface> &_iface)
@@ -987,6 +1243,12 @@ bool PhysicsCommand::Execute()
   return true;
 }
 
+//////////////////////////////////////////////////
+std::string PhysicsCommand::CoalesceKey() const
+{
+  return "physics";
+}
+
 IGNITION_ADD_PLUGIN(UserCommands, System,
   UserCommands::ISystemConfigure,
   UserCommands::ISystemPreUpdate
@@ -54,7 +54,32 @@ namespace systems
   /// * **Request type*: ignition.msgs.EntityFactory_V
   /// * **Response type*: ignition.msgs.Boolean
   ///
+  /// # Set the pose of multiple entities
+  ///
+  /// * **Service**: `/world/<world name>/set_pose_vector`
+  /// * **Request type*: ignition.msgs.Pose_V
+  /// * **Response type*: ignition.msgs.Boolean
+  ///
   /// Try some examples described on examples/worlds/empty.sdf
+  ///
+  /// Pose, light and physics commands which are superseded by a later
+  /// command for the same target before they're executed are dropped, so
+  /// only the latest one takes effect. For example, only the last of many
+  /// poses received for an entity during a step is applied. Commands aren't
+  /// coalesced across spawn and remove commands.
+  ///
+  /// The SDF of spawned entities is parsed, and any URIs resolved, on a
+  /// worker pool as soon as a request arrives. Only the creation of the
+  /// entities happens on the simulation thread.
+  ///
+  /// ## System Parameters
+  ///
+  /// - `<time_budget>`: Maximum time in seconds spent executing commands
+  /// on each step. Commands which don't fit are executed on the following
+  /// steps, in order, so entities requested together through
+  /// `create_multiple` may be spawned over several iterations. At least one
+  /// command is executed on each step. Defaults to 0, which means there's
+  /// no limit.
   class UserCommands:
     public System,
     public ISystemConfigure,
@@ -73,7 +98,8 @@ namespace systems
                            EventManager &_eventMgr) override;
 
     /// \brief All received commands are queued in order of reception and
-    /// executed in order during PreUpdate.
+    /// executed in order during PreUpdate, once they're ready and as long
+    /// as the time budget allows.
     /// \param[in] _info Contains information about the current simulation
     /// iteration.
     /// \param[in] _ecm The entity component manager.
@@ -79,6 +79,15 @@ class ignition::gazebo::systems::WindEffectsPrivate
   public: void ApplyWindForce(const UpdateInfo &_info,
                               EntityComponentManager &_ecm);
 
+  /// \brief Create the components this system needs on a link, if it's
+  /// affected by wind.
+  /// \param[in] _entity Link entity.
+  /// \param[in] _windMode Wind mode of the link.
+  /// \param[in] _ecm Mutable reference to the EntityComponentManager.
+  public: void InitializeLink(const Entity &_entity,
+                              const components::WindMode *_windMode,
+                              EntityComponentManager &_ecm);
+
   /// \brief Callback for topic for setting the wind seed velocity and enabling
   /// this system.
   /// \param[in] _msg msgs::Wind message.
@@ -165,6 +174,24 @@ class ignition::gazebo::systems::WindEffectsPrivate
   /// \brief Current wind velocity seed and global enable/disable state.
   /// This is set by a transport message.
   public: msgs::Wind currentWindInfo;
+
+  /// \brief Links affected by wind on the current step. This and the
+  /// following vectors are gathered on every step, and kept as members to
+  /// avoid allocations.
+  public: std::vector<Entity> windLinks;
+
+  /// \brief Mass of each link, times the force approximation scaling factor.
+  public: std::vector<double> windLinkScaledMasses;
+
+  /// \brief World linear velocity of each link.
+  public: std::vector<math::Vector3d> windLinkVelocities;
+
+  /// \brief Position of each link's center of mass relative to its origin,
+  /// in world coordinates.
+  public: std::vector<math::Vector3d> windLinkComOffsets;
+
+  /// \brief Wind force on each link.
+  public: std::vector<math::Vector3d> windLinkForces;
 };
 
 /////////////////////////////////////////////////
@@ -408,20 +435,26 @@ void WindEffectsPrivate::ApplyWindForce(const UpdateInfo &,
                                         EntityComponentManager &_ecm)
 {
   IGN_PROFILE("WindEffectsPrivate::ApplyWindForce");
-  auto windVel =
+  auto windVelComp =
       _ecm.Component<components::WorldLinearVelocity>(this->windEntity);
-  if (!windVel)
+  if (!windVelComp)
     return;
+  const math::Vector3d windVel = windVelComp->Data();
 
-  Link link;
+  this->windLinks.clear();
+  this->windLinkScaledMasses.clear();
+  this->windLinkVelocities.clear();
+  this->windLinkComOffsets.clear();
 
+  // Gather the data of all links affected by wind in one pass
   _ecm.Each<components::Link, components::Inertial, components::WindMode,
-            components::WorldLinearVelocity>(
+            components::WorldLinearVelocity, components::WorldPose>(
       [&](const Entity &_entity,
           components::Link *,
           components::Inertial *_inertial,
           components::WindMode *_windMode,
-          components::WorldLinearVelocity *_linkVel) -> bool
+          components::WorldLinearVelocity *_linkVel,
+          components::WorldPose *_linkPose) -> bool
       {
         // Skip links for which the wind is disabled
         if (!_windMode->Data())
@@ -429,19 +462,57 @@ void WindEffectsPrivate::ApplyWindForce(const UpdateInfo &,
           return true;
         }
 
-        link.ResetEntity(_entity);
-
-        math::Vector3d windForce = _inertial->Data().MassMatrix().Mass() *
-                                   this->forceApproximationScalingFactor *
-                                   (windVel->Data() - _linkVel->Data());
+        this->windLinks.push_back(_entity);
+        this->windLinkScaledMasses.push_back(
+            _inertial->Data().MassMatrix().Mass() *
+            this->forceApproximationScalingFactor);
+        this->windLinkVelocities.push_back(_linkVel->Data());
 
-        // Apply force at center of mass
-        link.AddWorldForce(_ecm, windForce);
+        // We want the force to be applied at the center of mass, but
+        // ExternalWorldWrenchCmd applies the force at the link origin
+        this->windLinkComOffsets.push_back(_linkPose->Data().Rot().RotateVector(
+            _inertial->Data().Pose().Pos()));
 
         return true;
       });
+
+  // Compute all forces in a tight loop
+  const std::size_t count = this->windLinks.size();
+  this->windLinkForces.resize(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    this->windLinkForces[i] = this->windLinkScaledMasses[i] *
+        (windVel - this->windLinkVelocities[i]);
+  }
+
+  // Apply force at center of mass
+  Link link;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    link.ResetEntity(this->windLinks[i]);
+    link.AddWorldWrench(_ecm, this->windLinkForces[i],
+        this->windLinkComOffsets[i].Cross(this->windLinkForces[i]));
+  }
 }
 
+//////////////////////////////////////////////////
+void WindEffectsPrivate::InitializeLink(const Entity &_entity,
+    const components::WindMode *_windMode, EntityComponentManager &_ecm)
+{
+  if (!_windMode->Data())
+    return;
+
+  // Create a WorldLinearVelocity component on the link so that
+  // physics can populate it
+  if (!_ecm.Component<components::WorldLinearVelocity>(_entity))
+  {
+    _ecm.CreateComponent(_entity, components::WorldLinearVelocity());
+  }
+  if (!_ecm.Component<components::WorldPose>(_entity))
+  {
+    _ecm.CreateComponent(_entity, components::WorldPose());
+  }
+}
 
 //////////////////////////////////////////////////
 void WindEffectsPrivate::OnWindMsg(const msgs::Wind &_msg)
@@ -558,20 +629,7 @@ void WindEffects::PreUpdate(const UpdateInfo &_info,
           [&](const Entity &_entity, components::Link *,
               components::WindMode *_windMode) -> bool
           {
-            if (_windMode->Data())
-            {
-              // Create a WorldLinearVelocity component on the link so that
-              // physics can populate it
-              if (!_ecm.Component<components::WorldLinearVelocity>(_entity))
-              {
-                _ecm.CreateComponent(_entity,
-                                     components::WorldLinearVelocity());
-              }
-              if (!_ecm.Component<components::WorldPose>(_entity))
-              {
-                _ecm.CreateComponent(_entity, components::WorldPose());
-              }
-            }
+            this->dataPtr->InitializeLink(_entity, _windMode, _ecm);
             return true;
           });
 
@@ -579,6 +637,15 @@ void WindEffects::PreUpdate(const UpdateInfo &_info,
     }
     else
     {
+      // Links spawned after the first step
+      _ecm.EachNew<components::Link, components::WindMode>(
+          [&](const Entity &_entity, components::Link *,
+              components::WindMode *_windMode) -> bool
+          {
+            this->dataPtr->InitializeLink(_entity, _windMode, _ecm);
+            return true;
+          });
+
       if (_info.paused)
         return;
 
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+#include <vector>
+
+#include "../../src/Barrier.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Cross a barrier once per benchmark iteration, with _st.range(0)
+/// helper threads plus the benchmark thread.
+/// \param[in] _st Benchmark state.
+/// \param[in] _maxSpin Maximum spins before blocking, zero always blocks.
+static void CrossBarrier(benchmark::State &_st, unsigned int _maxSpin)
+{
+  const auto helperCount = static_cast<unsigned int>(_st.range(0));
+  Barrier barrier(helperCount + 1, _maxSpin);
+
+  std::vector<std::thread> helpers;
+  for (unsigned int i = 0; i < helperCount; ++i)
+  {
+    helpers.emplace_back([&barrier]()
+    {
+      while (barrier.Wait() != Barrier::ExitStatus::CANCELLED)
+      {
+      }
+    });
+  }
+
+  for (auto _ : _st)
+    barrier.Wait();
+
+  barrier.Cancel();
+  for (auto &helper : helpers)
+    helper.join();
+}
+
+// NOLINTNEXTLINE
+void BM_BarrierBlocking(benchmark::State &_st)
+{
+  CrossBarrier(_st, 0);
+}
+
+// NOLINTNEXTLINE
+void BM_BarrierAdaptive(benchmark::State &_st)
+{
+  CrossBarrier(_st, Barrier::kDefaultMaxSpin);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_BarrierBlocking)
+  ->RangeMultiplier(2)
+  ->Range(1, 32)
+  ->UseRealTime()
+  ->Unit(benchmark::kMicrosecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_BarrierAdaptive)
+  ->RangeMultiplier(2)
+  ->Range(1, 32)
+  ->UseRealTime()
+  ->Unit(benchmark::kMicrosecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+#include "ignition/gazebo/components/Factory.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace components
+{
+using IntComponent = components::Component<int, class IntComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.IntComponent",
+    IntComponent)
+
+using DoubleComponent = components::Component<double, class DoubleComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.DoubleComponent",
+    DoubleComponent)
+}
+}
+}
+}
+
+using namespace ignition;
+using namespace gazebo;
+using namespace components;
+
+class ComponentLookupFixture: public benchmark::Fixture
+{
+  protected: void SetUp(const ::benchmark::State &_state) override
+  {
+    this->mgr = std::make_unique<EntityComponentManager>();
+    auto entityCount = _state.range(0);
+    for (int i = 0; i < entityCount; ++i)
+    {
+      Entity entity = this->mgr->CreateEntity();
+      this->mgr->CreateComponent(entity, IntComponent(i));
+
+      // Half the entities have a second component
+      if (i % 2 == 0)
+        this->mgr->CreateComponent(entity, DoubleComponent(1.0));
+
+      this->entities.push_back(entity);
+    }
+  }
+
+  protected: void TearDown(const ::benchmark::State &) override
+  {
+    this->entities.clear();
+    this->mgr.reset();
+  }
+
+  protected: std::unique_ptr<EntityComponentManager> mgr;
+
+  protected: std::vector<Entity> entities;
+};
+
+BENCHMARK_DEFINE_F(ComponentLookupFixture, Component)
+(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    for (const auto &entity : this->entities)
+      benchmark::DoNotOptimize(this->mgr->Component<IntComponent>(entity));
+  }
+  _st.SetItemsProcessed(_st.iterations() * this->entities.size());
+}
+
+BENCHMARK_DEFINE_F(ComponentLookupFixture, ComponentMissing)
+(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    // Half the lookups fail
+    for (const auto &entity : this->entities)
+      benchmark::DoNotOptimize(this->mgr->Component<DoubleComponent>(entity));
+  }
+  _st.SetItemsProcessed(_st.iterations() * this->entities.size());
+}
+
+BENCHMARK_DEFINE_F(ComponentLookupFixture, ComponentConst)
+(benchmark::State &_st)
+{
+  const EntityComponentManager &constMgr = *this->mgr;
+  for (auto _ : _st)
+  {
+    for (const auto &entity : this->entities)
+      benchmark::DoNotOptimize(constMgr.Component<IntComponent>(entity));
+  }
+  _st.SetItemsProcessed(_st.iterations() * this->entities.size());
+}
+
+BENCHMARK_DEFINE_F(ComponentLookupFixture, EntityHasComponentType)
+(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    for (const auto &entity : this->entities)
+    {
+      benchmark::DoNotOptimize(this->mgr->EntityHasComponentType(entity,
+          DoubleComponent::typeId));
+    }
+  }
+  _st.SetItemsProcessed(_st.iterations() * this->entities.size());
+}
+
+BENCHMARK_REGISTER_F(ComponentLookupFixture, Component)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ComponentLookupFixture, ComponentMissing)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ComponentLookupFixture, ComponentConst)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ComponentLookupFixture, EntityHasComponentType)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMicrosecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
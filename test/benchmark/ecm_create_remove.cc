@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+#include "ignition/gazebo/components/Factory.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace components
+{
+using IntComponent = components::Component<int, class IntComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.IntComponent",
+    IntComponent)
+
+using DoubleComponent = components::Component<double, class DoubleComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.DoubleComponent",
+    DoubleComponent)
+}
+}
+}
+}
+
+using namespace ignition;
+using namespace gazebo;
+using namespace components;
+
+/// \brief Exposes the protected functions which process removals.
+class EntityCompMgrBenchmark : public EntityComponentManager
+{
+  public: void ProcessEntityRemovals()
+  {
+    this->ProcessRemoveEntityRequests();
+  }
+};
+
+// NOLINTNEXTLINE
+void BM_CreateEntity(benchmark::State &_st)
+{
+  auto entityCount = _st.range(0);
+  for (auto _ : _st)
+  {
+    _st.PauseTiming();
+    auto mgr = std::make_unique<EntityComponentManager>();
+    _st.ResumeTiming();
+
+    for (int i = 0; i < entityCount; ++i)
+      benchmark::DoNotOptimize(mgr->CreateEntity());
+
+    _st.PauseTiming();
+    mgr.reset();
+    _st.ResumeTiming();
+  }
+  _st.SetItemsProcessed(_st.iterations() * entityCount);
+}
+
+// NOLINTNEXTLINE
+void BM_CreateComponent(benchmark::State &_st)
+{
+  auto entityCount = _st.range(0);
+  for (auto _ : _st)
+  {
+    _st.PauseTiming();
+    auto mgr = std::make_unique<EntityComponentManager>();
+    std::vector<Entity> entities;
+    for (int i = 0; i < entityCount; ++i)
+      entities.push_back(mgr->CreateEntity());
+    _st.ResumeTiming();
+
+    for (const auto &entity : entities)
+    {
+      mgr->CreateComponent(entity, IntComponent(1));
+      mgr->CreateComponent(entity, DoubleComponent(1.0));
+    }
+
+    _st.PauseTiming();
+    mgr.reset();
+    _st.ResumeTiming();
+  }
+  _st.SetItemsProcessed(_st.iterations() * entityCount * 2);
+}
+
+// NOLINTNEXTLINE
+void BM_RemoveEntity(benchmark::State &_st)
+{
+  auto entityCount = _st.range(0);
+  // Percentage of the entities which are removed
+  auto removePercent = _st.range(1);
+  for (auto _ : _st)
+  {
+    _st.PauseTiming();
+    auto mgr = std::make_unique<EntityCompMgrBenchmark>();
+    std::vector<Entity> entities;
+    for (int i = 0; i < entityCount; ++i)
+    {
+      Entity entity = mgr->CreateEntity();
+      mgr->CreateComponent(entity, IntComponent(i));
+      mgr->CreateComponent(entity, DoubleComponent(1.0));
+      entities.push_back(entity);
+    }
+
+    // Create a view, so its maintenance is measured too
+    mgr->Each<IntComponent, DoubleComponent>(
+        [&](const Entity &, const IntComponent *,
+            const DoubleComponent *) -> bool
+        {
+          return true;
+        });
+    _st.ResumeTiming();
+
+    for (int i = 0; i < entityCount; ++i)
+    {
+      if (i * 100 < entityCount * removePercent)
+        mgr->RequestRemoveEntity(entities[i], false);
+    }
+    mgr->ProcessEntityRemovals();
+
+    _st.PauseTiming();
+    mgr.reset();
+    _st.ResumeTiming();
+  }
+  _st.counters["removed"] = entityCount * removePercent / 100;
+}
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_CreateEntity)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_CreateComponent)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMillisecond);
+
+/// Method to generate the entity count and removed percentage combinations.
+static void RemoveArgs(benchmark::internal::Benchmark *_b)
+{
+  for (int entityCount = 100; entityCount <= 100000; entityCount *= 10)
+  {
+    for (int removePercent : {1, 10, 100})
+      _b->Args({entityCount, removePercent});
+  }
+}
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_RemoveEntity)
+  ->Apply(RemoveArgs)
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Populate a tree under a root entity. The root has one child per
+/// model, and each model has _linksPerModel children.
+/// \return The root entity.
+static Entity Populate(EntityComponentManager &_mgr, int _entityCount,
+    int _linksPerModel)
+{
+  Entity root = _mgr.CreateEntity();
+  int created = 1;
+  while (created < _entityCount)
+  {
+    Entity model = _mgr.CreateEntity();
+    _mgr.SetParentEntity(model, root);
+    ++created;
+
+    for (int i = 0; i < _linksPerModel && created < _entityCount; ++i)
+    {
+      Entity link = _mgr.CreateEntity();
+      _mgr.SetParentEntity(link, model);
+      ++created;
+    }
+  }
+  return root;
+}
+
+// NOLINTNEXTLINE
+void BM_DescendantsCached(benchmark::State &_st)
+{
+  EntityComponentManager mgr;
+  Entity root = Populate(mgr, _st.range(0), 4);
+
+  // Fill the cache
+  auto count = mgr.Descendants(root).size();
+
+  for (auto _ : _st)
+  {
+    benchmark::DoNotOptimize(mgr.Descendants(root));
+  }
+  _st.counters["descendants"] = count;
+}
+
+// NOLINTNEXTLINE
+void BM_DescendantsUncached(benchmark::State &_st)
+{
+  EntityComponentManager mgr;
+  Entity root = Populate(mgr, _st.range(0), 4);
+
+  for (auto _ : _st)
+  {
+    // Creating an entity clears the cache
+    _st.PauseTiming();
+    mgr.CreateEntity();
+    _st.ResumeTiming();
+
+    benchmark::DoNotOptimize(mgr.Descendants(root));
+  }
+}
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_DescendantsCached)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMicrosecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_DescendantsUncached)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMicrosecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+#include "ignition/gazebo/components/Factory.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace components
+{
+using IntComponent = components::Component<int, class IntComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.IntComponent",
+    IntComponent)
+
+using DoubleComponent = components::Component<double, class DoubleComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.DoubleComponent",
+    DoubleComponent)
+
+using FloatComponent = components::Component<float, class FloatComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.FloatComponent",
+    FloatComponent)
+
+using BoolComponent = components::Component<bool, class BoolComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.BoolComponent",
+    BoolComponent)
+
+using UIntComponent =
+    components::Component<unsigned int, class UIntComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.UIntComponent",
+    UIntComponent)
+
+using Int64Component = components::Component<int64_t, class Int64ComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Int64Component",
+    Int64Component)
+}
+}
+}
+}
+
+using namespace ignition;
+using namespace gazebo;
+using namespace components;
+
+/// \brief Populate an ECM. A percentage of the entities, given by
+/// _hitPercent, has all component types. The others only have IntComponent,
+/// so they only match single component queries.
+/// \return Number of entities with all component types.
+static int Populate(EntityComponentManager &_mgr, int _entityCount,
+    int _hitPercent)
+{
+  int matching = 0;
+  for (int i = 0; i < _entityCount; ++i)
+  {
+    Entity entity = _mgr.CreateEntity();
+    _mgr.CreateComponent(entity, IntComponent(i));
+
+    if (i * 100 >= _entityCount * _hitPercent)
+      continue;
+
+    _mgr.CreateComponent(entity, DoubleComponent(1.0));
+    _mgr.CreateComponent(entity, FloatComponent(1.0f));
+    _mgr.CreateComponent(entity, BoolComponent(true));
+    _mgr.CreateComponent(entity, UIntComponent(1u));
+    _mgr.CreateComponent(entity, Int64Component(1));
+    ++matching;
+  }
+  return matching;
+}
+
+/// \brief Iterate over an existing view.
+template<typename ...ComponentTypeTs>
+void BM_Each(benchmark::State &_st)
+{
+  EntityComponentManager mgr;
+  int expected = Populate(mgr, _st.range(0), _st.range(1));
+  if (sizeof...(ComponentTypeTs) == 1)
+    expected = _st.range(0);
+
+  // Build the view before timing
+  mgr.Each<ComponentTypeTs...>(
+      [&](const Entity &, const ComponentTypeTs *...) -> bool
+      {
+        return true;
+      });
+
+  for (auto _ : _st)
+  {
+    int matched = 0;
+    mgr.Each<ComponentTypeTs...>(
+        [&](const Entity &, const ComponentTypeTs *..._components) -> bool
+        {
+          (benchmark::DoNotOptimize(_components), ...);
+          ++matched;
+          return true;
+        });
+
+    if (matched != expected)
+      _st.SkipWithError("Failed to match correct number of entities");
+  }
+  _st.counters["matched"] = expected;
+  _st.SetItemsProcessed(_st.iterations() * expected);
+}
+
+/// \brief Build a view on the first call to Each.
+template<typename ...ComponentTypeTs>
+void BM_EachCreateView(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    _st.PauseTiming();
+    auto mgr = std::make_unique<EntityComponentManager>();
+    Populate(*mgr, _st.range(0), _st.range(1));
+    _st.ResumeTiming();
+
+    mgr->Each<ComponentTypeTs...>(
+        [&](const Entity &, const ComponentTypeTs *...) -> bool
+        {
+          return true;
+        });
+
+    _st.PauseTiming();
+    mgr.reset();
+    _st.ResumeTiming();
+  }
+}
+
+/// Method to generate the entity count and hit rate combinations.
+static void EachArgs(benchmark::internal::Benchmark *_b)
+{
+  for (int entityCount = 100; entityCount <= 100000; entityCount *= 10)
+  {
+    for (int hitPercent : {1, 10, 50, 100})
+      _b->Args({entityCount, hitPercent});
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_Each, IntComponent)
+  ->Apply(EachArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_Each, IntComponent, DoubleComponent)
+  ->Apply(EachArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_Each, IntComponent, DoubleComponent, FloatComponent)
+  ->Apply(EachArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_Each, IntComponent, DoubleComponent, FloatComponent,
+    BoolComponent)
+  ->Apply(EachArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_Each, IntComponent, DoubleComponent, FloatComponent,
+    BoolComponent, UIntComponent)
+  ->Apply(EachArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_Each, IntComponent, DoubleComponent, FloatComponent,
+    BoolComponent, UIntComponent, Int64Component)
+  ->Apply(EachArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_EachCreateView, IntComponent, DoubleComponent)
+  ->Apply(EachArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_EachCreateView, IntComponent, DoubleComponent,
+    FloatComponent, BoolComponent, UIntComponent, Int64Component)
+  ->Apply(EachArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
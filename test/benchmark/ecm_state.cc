@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+#include "ignition/gazebo/components/Factory.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace components
+{
+using IntComponent = components::Component<int, class IntComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.IntComponent",
+    IntComponent)
+
+using DoubleComponent = components::Component<double, class DoubleComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.DoubleComponent",
+    DoubleComponent)
+}
+}
+}
+}
+
+using namespace ignition;
+using namespace gazebo;
+using namespace components;
+
+/// \brief Exposes the protected function which clears change tracking.
+class EntityCompMgrBenchmark : public EntityComponentManager
+{
+  public: void RunSetAllComponentsUnchanged()
+  {
+    this->SetAllComponentsUnchanged();
+  }
+};
+
+/// \brief Populate an ECM where every entity has two components.
+static std::vector<Entity> Populate(EntityComponentManager &_mgr,
+    int _entityCount)
+{
+  std::vector<Entity> entities;
+  for (int i = 0; i < _entityCount; ++i)
+  {
+    Entity entity = _mgr.CreateEntity();
+    _mgr.CreateComponent(entity, IntComponent(i));
+    _mgr.CreateComponent(entity, DoubleComponent(1.0));
+    entities.push_back(entity);
+  }
+  return entities;
+}
+
+// NOLINTNEXTLINE
+void BM_ChangedState(benchmark::State &_st)
+{
+  auto entityCount = _st.range(0);
+  // Percentage of the entities with a changed component
+  auto changePercent = _st.range(1);
+
+  EntityCompMgrBenchmark mgr;
+  auto entities = Populate(mgr, entityCount);
+  mgr.RunSetAllComponentsUnchanged();
+
+  for (int i = 0; i < entityCount; ++i)
+  {
+    if (i * 100 < entityCount * changePercent)
+    {
+      mgr.SetChanged(entities[i], IntComponent::typeId,
+          ComponentState::PeriodicChange);
+    }
+  }
+
+  size_t serializedSize = 0;
+  for (auto _ : _st)
+  {
+    msgs::SerializedStateMap stateMsg;
+    mgr.ChangedState(stateMsg);
+#if GOOGLE_PROTOBUF_VERSION >= 3004000
+    serializedSize = stateMsg.ByteSizeLong();
+#else
+    serializedSize = stateMsg.ByteSize();
+#endif
+  }
+  _st.counters["serialized_size"] = serializedSize;
+}
+
+// NOLINTNEXTLINE
+void BM_SetStateCreate(benchmark::State &_st)
+{
+  auto entityCount = _st.range(0);
+
+  EntityComponentManager source;
+  Populate(source, entityCount);
+  msgs::SerializedStateMap stateMsg;
+  source.State(stateMsg);
+
+  for (auto _ : _st)
+  {
+    _st.PauseTiming();
+    auto mgr = std::make_unique<EntityComponentManager>();
+    _st.ResumeTiming();
+
+    // All entities and components are new
+    mgr->SetState(stateMsg);
+
+    _st.PauseTiming();
+    mgr.reset();
+    _st.ResumeTiming();
+  }
+  _st.SetItemsProcessed(_st.iterations() * entityCount);
+}
+
+// NOLINTNEXTLINE
+void BM_SetStateUpdate(benchmark::State &_st)
+{
+  auto entityCount = _st.range(0);
+
+  EntityComponentManager source;
+  Populate(source, entityCount);
+  msgs::SerializedStateMap stateMsg;
+  source.State(stateMsg);
+
+  // All entities and components already exist, so only data is updated
+  EntityComponentManager mgr;
+  mgr.SetState(stateMsg);
+
+  for (auto _ : _st)
+  {
+    mgr.SetState(stateMsg);
+  }
+  _st.SetItemsProcessed(_st.iterations() * entityCount);
+}
+
+// NOLINTNEXTLINE
+void BM_FullState(benchmark::State &_st)
+{
+  auto entityCount = _st.range(0);
+
+  EntityComponentManager mgr;
+  Populate(mgr, entityCount);
+
+  for (auto _ : _st)
+  {
+    msgs::SerializedStateMap stateMsg;
+    mgr.State(stateMsg, {}, {}, true);
+    std::string data = stateMsg.SerializeAsString();
+    benchmark::DoNotOptimize(data);
+  }
+  _st.SetItemsProcessed(_st.iterations() * entityCount);
+}
+
+// NOLINTNEXTLINE
+void BM_FullBinaryState(benchmark::State &_st)
+{
+  auto entityCount = _st.range(0);
+
+  EntityComponentManager mgr;
+  Populate(mgr, entityCount);
+
+  std::string buffer;
+  for (auto _ : _st)
+  {
+    mgr.BinaryState(buffer, {}, {}, true);
+    benchmark::DoNotOptimize(buffer);
+  }
+  _st.SetItemsProcessed(_st.iterations() * entityCount);
+  _st.counters["serialized_size"] = buffer.size();
+}
+
+// NOLINTNEXTLINE
+void BM_SetBinaryStateUpdate(benchmark::State &_st)
+{
+  auto entityCount = _st.range(0);
+
+  EntityComponentManager source;
+  Populate(source, entityCount);
+  std::string buffer;
+  source.BinaryState(buffer, {}, {}, true);
+
+  // All entities and components already exist, so only data is updated
+  EntityComponentManager mgr;
+  mgr.SetBinaryState(buffer.data(), buffer.size());
+
+  for (auto _ : _st)
+  {
+    mgr.SetBinaryState(buffer.data(), buffer.size());
+  }
+  _st.SetItemsProcessed(_st.iterations() * entityCount);
+}
+
+/// Method to generate the entity count and change ratio combinations.
+static void ChangedStateArgs(benchmark::internal::Benchmark *_b)
+{
+  for (int entityCount = 100; entityCount <= 100000; entityCount *= 10)
+  {
+    for (int changePercent : {0, 1, 10, 100})
+      _b->Args({entityCount, changePercent});
+  }
+}
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_ChangedState)
+  ->Apply(ChangedStateArgs)
+  ->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_SetStateCreate)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_SetStateUpdate)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_FullState)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_FullBinaryState)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_SetBinaryStateUpdate)
+  ->RangeMultiplier(10)
+  ->Range(100, 100000)
+  ->Unit(benchmark::kMillisecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
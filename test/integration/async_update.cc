@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Util.hh>
+
+#include "ignition/gazebo/components/Factory.hh"
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/SystemLoader.hh"
+#include "ignition/gazebo/test_config.hh"  // NOLINT(build/include)
+
+#include "../plugins/MockAsyncSystem.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+using IntComponent = components::Component<int, class IntComponentTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.IntComponent",
+    IntComponent)
+
+class AsyncUpdateTest : public ::testing::Test
+{
+  protected: void SetUp() override
+  {
+    common::Console::SetVerbosity(4);
+    common::setenv("IGN_GAZEBO_SYSTEM_PLUGIN_PATH",
+      (std::string(PROJECT_BINARY_PATH) + "/lib").c_str());
+  }
+};
+
+/////////////////////////////////////////////////
+TEST_F(AsyncUpdateTest, CommandsAppliedAfterIterations)
+{
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  Server server(serverConfig);
+  server.SetUpdatePeriod(1ns);
+
+  SystemLoader loader;
+  auto plugin = loader.LoadPlugin("libMockAsyncSystem.so",
+      "ignition::gazebo::MockAsyncSystem", nullptr);
+  ASSERT_TRUE(plugin.has_value());
+  auto mockSystem = static_cast<MockAsyncSystem *>(
+      plugin.value()->QueryInterface<System>());
+  ASSERT_NE(nullptr, mockSystem);
+  mockSystem->iterations = 5;
+
+  // Each call sees the entities created by the commands of the previous one,
+  // and creates one more
+  std::mutex mutex;
+  std::vector<uint64_t> started;
+  std::vector<int> seen;
+  std::vector<uint64_t> applied;
+  mockSystem->asyncUpdateCallback =
+      [&](const UpdateInfo &_info, const EntityComponentManager &_ecm)
+      -> ISystemAsyncUpdate::Commands
+  {
+    int count{0};
+    _ecm.Each<IntComponent>([&](const Entity &, const IntComponent *)
+        {
+          ++count;
+          return true;
+        });
+
+    // Slower than the steps it spans
+    IGN_SLEEP_MS(20);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    started.push_back(_info.iterations);
+    seen.push_back(count);
+
+    return [&, count](const UpdateInfo &_cmdInfo,
+        EntityComponentManager &_cmdEcm)
+    {
+      applied.push_back(_cmdInfo.iterations);
+      _cmdEcm.CreateComponent(_cmdEcm.CreateEntity(), IntComponent(count));
+    };
+  };
+
+  EXPECT_TRUE(*server.AddSystem(plugin.value()));
+  server.Run(true, 20, false);
+
+  // The last call may still be running
+  for (int sleep = 0; sleep < 50; ++sleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (started.size() == 4u)
+        break;
+    }
+    IGN_SLEEP_MS(20);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(std::vector<uint64_t>({1u, 6u, 11u, 16u}), started);
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3}), seen);
+  EXPECT_EQ(std::vector<uint64_t>({6u, 11u, 16u}), applied);
+}
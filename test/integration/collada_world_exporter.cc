@@ -72,6 +72,25 @@ TEST_F(ColladaWorldExporterFixture, ExportWorld)
   common::removeAll("./collada_world_exporter_box_test");
 }
 
+/////////////////////////////////////////////////
+TEST_F(ColladaWorldExporterFixture, ExportWorldBackground)
+{
+  this->LoadWorld(common::joinPaths("test", "worlds",
+        "collada_world_exporter_background.sdf"));
+
+  common::removeAll("./collada_world_exporter_background_test");
+  EXPECT_FALSE(common::exists("./collada_world_exporter_background_test"));
+
+  // The export is written on another thread, which the system waits for
+  // when it's destroyed.
+  server->Run(true, 1, false);
+  this->server.reset();
+
+  EXPECT_TRUE(common::exists("./collada_world_exporter_background_test"));
+
+  common::removeAll("./collada_world_exporter_background_test");
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int _argc, char **_argv)
@@ -40,6 +40,7 @@
 #include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/ChildLinkName.hh"
 #include "ignition/gazebo/components/Collision.hh"
+#include "ignition/gazebo/components/ContactChanges.hh"
 #include "ignition/gazebo/components/DetachableJoint.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Gravity.hh"
@@ -277,8 +278,14 @@ TEST_F(ComponentsTest, AngularVelocity)
   // Stream operators
   std::ostringstream ostr;
   comp11.Serialize(ostr);
-  EXPECT_EQ("1 2 3", ostr.str());
-
+  // Serialized as binary, which round trips exactly
+  EXPECT_EQ(1 + 3 * sizeof(double), ostr.str().size());
+  std::istringstream binaryIstr(ostr.str());
+  decltype(comp11) roundTrip;
+  roundTrip.Deserialize(binaryIstr);
+  EXPECT_EQ(comp11.Data(), roundTrip.Data());
+
+  // Text is still deserialized
   std::istringstream istr("3 2 1");
   components::AngularVelocity comp3(math::Vector3d::Zero);
   comp3.Deserialize(istr);
@@ -379,6 +386,40 @@ TEST_F(ComponentsTest, Collision)
   comp3.Deserialize(istr);
 }
 
+/////////////////////////////////////////////////
+TEST_F(ComponentsTest, ContactChanges)
+{
+  ContactPairChanges changes1;
+  changes1.began = {3};
+  changes1.ended = {4, 5};
+  changes1.touching = {2, 3};
+
+  ContactPairChanges changes2;
+  changes2.touching = {2, 3};
+
+  EXPECT_TRUE(changes1.Changed());
+  EXPECT_FALSE(changes2.Changed());
+
+  // Create components
+  auto comp1 = components::ContactChanges(changes1);
+  auto comp2 = components::ContactChanges(changes2);
+
+  // Equality operators
+  EXPECT_NE(comp1, comp2);
+  EXPECT_FALSE(comp1 == comp2);
+  EXPECT_TRUE(comp1 != comp2);
+
+  // Stream operators
+  std::ostringstream ostr;
+  comp1.Serialize(ostr);
+  EXPECT_EQ("1 3 2 4 5 2 2 3 ", ostr.str());
+
+  std::istringstream istr(ostr.str());
+  components::ContactChanges comp3;
+  comp3.Deserialize(istr);
+  EXPECT_EQ(comp1, comp3);
+}
+
 /////////////////////////////////////////////////
 TEST_F(ComponentsTest, DetachableJoint)
 {
@@ -455,8 +496,14 @@ TEST_F(ComponentsTest, Gravity)
   // Stream operators
   std::ostringstream ostr;
   comp11.Serialize(ostr);
-  EXPECT_EQ("1 2 3", ostr.str());
-
+  // Serialized as binary, which round trips exactly
+  EXPECT_EQ(1 + 3 * sizeof(double), ostr.str().size());
+  std::istringstream binaryIstr(ostr.str());
+  decltype(comp11) roundTrip;
+  roundTrip.Deserialize(binaryIstr);
+  EXPECT_EQ(comp11.Data(), roundTrip.Data());
+
+  // Text is still deserialized
   std::istringstream istr("3 2 1");
   components::Gravity comp3(math::Vector3d::Zero);
   comp3.Deserialize(istr);
@@ -698,8 +745,14 @@ TEST_F(ComponentsTest, LevelBuffer)
   // Stream operators
   std::ostringstream ostr;
   comp11.Serialize(ostr);
-  EXPECT_EQ("1.5", ostr.str());
-
+  // Serialized as binary, which round trips exactly
+  EXPECT_EQ(1 + sizeof(double), ostr.str().size());
+  std::istringstream binaryIstr(ostr.str());
+  decltype(comp11) roundTrip;
+  roundTrip.Deserialize(binaryIstr);
+  EXPECT_EQ(comp11.Data(), roundTrip.Data());
+
+  // Text is still deserialized
   std::istringstream istr("3.3");
   components::LevelBuffer comp3;
   comp3.Deserialize(istr);
@@ -807,8 +860,14 @@ TEST_F(ComponentsTest, LinearAcceleration)
   // Stream operators
   std::ostringstream ostr;
   comp11.Serialize(ostr);
-  EXPECT_EQ("1 2 3", ostr.str());
-
+  // Serialized as binary, which round trips exactly
+  EXPECT_EQ(1 + 3 * sizeof(double), ostr.str().size());
+  std::istringstream binaryIstr(ostr.str());
+  decltype(comp11) roundTrip;
+  roundTrip.Deserialize(binaryIstr);
+  EXPECT_EQ(comp11.Data(), roundTrip.Data());
+
+  // Text is still deserialized
   std::istringstream istr("3 2 1");
   components::LinearAcceleration comp3(math::Vector3d::Zero);
   comp3.Deserialize(istr);
@@ -834,8 +893,14 @@ TEST_F(ComponentsTest, LinearVelocity)
   // Stream operators
   std::ostringstream ostr;
   comp11.Serialize(ostr);
-  EXPECT_EQ("1 2 3", ostr.str());
-
+  // Serialized as binary, which round trips exactly
+  EXPECT_EQ(1 + 3 * sizeof(double), ostr.str().size());
+  std::istringstream binaryIstr(ostr.str());
+  decltype(comp11) roundTrip;
+  roundTrip.Deserialize(binaryIstr);
+  EXPECT_EQ(comp11.Data(), roundTrip.Data());
+
+  // Text is still deserialized
   std::istringstream istr("3 2 1");
   components::LinearVelocity comp3(math::Vector3d::Zero);
   comp3.Deserialize(istr);
@@ -1156,8 +1221,14 @@ TEST_F(ComponentsTest, ParentEntity)
   // Stream operators
   std::ostringstream ostr;
   comp11.Serialize(ostr);
-  EXPECT_EQ("1", ostr.str());
-
+  // Serialized as binary, which round trips exactly
+  EXPECT_EQ(1 + sizeof(Entity), ostr.str().size());
+  std::istringstream binaryIstr(ostr.str());
+  decltype(comp11) roundTrip;
+  roundTrip.Deserialize(binaryIstr);
+  EXPECT_EQ(comp11.Data(), roundTrip.Data());
+
+  // Text is still deserialized
   std::istringstream istr("3");
   components::ParentEntity comp3(kNullEntity);
   comp3.Deserialize(istr);
@@ -1306,8 +1377,14 @@ TEST_F(ComponentsTest, Pose)
   // Stream operators
   std::ostringstream ostr;
   comp11.Serialize(ostr);
-  EXPECT_EQ("1 2 3 0.1 0.2 0.3", ostr.str());
-
+  // Serialized as binary, which round trips exactly
+  EXPECT_EQ(1 + 7 * sizeof(double), ostr.str().size());
+  std::istringstream binaryIstr(ostr.str());
+  decltype(comp11) roundTrip;
+  roundTrip.Deserialize(binaryIstr);
+  EXPECT_EQ(comp11.Data(), roundTrip.Data());
+
+  // Text is still deserialized
   std::istringstream istr("3 2 1 0.3 0.2 0.1");
   components::Pose comp3(math::Pose3d::Zero);
   comp3.Deserialize(istr);
@@ -1430,8 +1507,14 @@ TEST_F(ComponentsTest, ThreadPitch)
   // Stream operators
   std::ostringstream ostr;
   comp11.Serialize(ostr);
-  EXPECT_EQ("1.2", ostr.str());
-
+  // Serialized as binary, which round trips exactly
+  EXPECT_EQ(1 + sizeof(double), ostr.str().size());
+  std::istringstream binaryIstr(ostr.str());
+  decltype(comp11) roundTrip;
+  roundTrip.Deserialize(binaryIstr);
+  EXPECT_EQ(comp11.Data(), roundTrip.Data());
+
+  // Text is still deserialized
   std::istringstream istr("3.4");
   components::ThreadPitch comp3;
   comp3.Deserialize(istr);
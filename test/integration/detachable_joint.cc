@@ -139,6 +139,26 @@ TEST_F(DetachableJointTest, StartConnected)
   // Due integration error, we check that the travelled distance is greater than
   // the expected distance.
   EXPECT_GT(m2Poses.front().Pos().Z() - m2Poses.back().Pos().Z(), expDist);
+
+  m1Poses.clear();
+  m2Poses.clear();
+
+  // Attach again while Model2 is falling
+  auto attachPub =
+      node.Advertise<msgs::Empty>("/model/M1/detachable_joint/attach");
+  attachPub.Publish(msgs::Empty());
+  std::this_thread::sleep_for(250ms);
+
+  const std::size_t nItersAfterAttach{100};
+  this->server->Run(true, nItersAfterAttach, false);
+
+  ASSERT_EQ(nItersAfterAttach, m1Poses.size());
+  ASSERT_EQ(nItersAfterAttach, m2Poses.size());
+
+  // Model2 is connected to Model1 again, so it stops falling once the joint
+  // is created
+  EXPECT_EQ(m1Poses.front(), m1Poses.back());
+  EXPECT_NEAR(m2Poses[10].Pos().Z(), m2Poses.back().Pos().Z(), 1e-3);
 }
 
 /////////////////////////////////////////////////
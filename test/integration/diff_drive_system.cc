@@ -16,6 +16,12 @@
 */
 
 #include <gtest/gtest.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/math/Pose3.hh>
@@ -604,6 +610,99 @@ TEST_P(DiffDriveTest, Pose_VCustomTfTopic)
   EXPECT_EQ(5u, odomPosesCount);
 }
 
+/////////////////////////////////////////////////
+TEST_P(DiffDriveTest, Fleet)
+{
+  // Start server
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/diff_drive_fleet.sdf");
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  server.SetUpdatePeriod(0ns);
+
+  // Record the poses of both vehicles
+  std::map<std::string, std::vector<math::Pose3d>> poses;
+  test::Relay testSystem;
+  testSystem.OnPostUpdate([&poses](const gazebo::UpdateInfo &,
+    const gazebo::EntityComponentManager &_ecm)
+    {
+      for (const std::string name : {"vehicle_blue", "vehicle_green"})
+      {
+        auto id = _ecm.EntityByComponents(
+          components::Model(),
+          components::Name(name));
+        ASSERT_NE(kNullEntity, id);
+
+        auto poseComp = _ecm.Component<components::Pose>(id);
+        ASSERT_NE(nullptr, poseComp);
+        poses[name].push_back(poseComp->Data());
+      }
+    });
+  server.AddSystem(testSystem.systemPtr);
+
+  // Each vehicle publishes its own odometry, and all transforms are
+  // published together
+  std::mutex mutex;
+  unsigned int greenOdomCount{0};
+  unsigned int tfCount{0};
+  std::function<void(const msgs::Odometry &)> odomCb =
+    [&](const msgs::Odometry &)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++greenOdomCount;
+    };
+  std::function<void(const msgs::Pose_V &)> tfCb =
+    [&](const msgs::Pose_V &_msg)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      EXPECT_EQ(2, _msg.pose_size());
+      ++tfCount;
+    };
+
+  transport::Node node;
+  node.Subscribe("/model/vehicle_green/odometry", odomCb);
+  node.Subscribe("/world/diff_drive_fleet/diff_drive/tf", tfCb);
+
+  // Only the green vehicle is commanded
+  auto pub = node.Advertise<msgs::Twist>("/model/vehicle_green/cmd_vel");
+  test::Relay velocityRamp;
+  velocityRamp.OnPreUpdate(
+      [&](const gazebo::UpdateInfo &,
+          const gazebo::EntityComponentManager &)
+      {
+        msgs::Twist msg;
+        msgs::Set(msg.mutable_linear(), math::Vector3d(0.5, 0, 0));
+        pub.Publish(msg);
+      });
+  server.AddSystem(velocityRamp.systemPtr);
+
+  server.Run(true, 1000, false);
+
+  int sleep = 0;
+  int maxSleep = 30;
+  for (; sleep < maxSleep; ++sleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (greenOdomCount >= 40 && tfCount >= 40)
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  ASSERT_NE(maxSleep, sleep);
+
+  ASSERT_EQ(1000u, poses["vehicle_blue"].size());
+  ASSERT_EQ(1000u, poses["vehicle_green"].size());
+  EXPECT_NEAR(poses["vehicle_blue"].front().Pos().X(),
+      poses["vehicle_blue"].back().Pos().X(), tol);
+  EXPECT_LT(poses["vehicle_green"].front().Pos().X() + 0.1,
+      poses["vehicle_green"].back().Pos().X());
+}
+
 // Run multiple times
 INSTANTIATE_TEST_SUITE_P(ServerRepeat, DiffDriveTest,
     ::testing::Range(1, 2));
@@ -16,6 +16,9 @@
 */
 
 #include <gtest/gtest.h>
+
+#include <thread>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/transport/Node.hh>
@@ -145,3 +148,38 @@ TEST_F(JointStatePublisherTest, LimitedPublisher)
   // Make sure the callback was triggered at least once.
   EXPECT_GT(count, 0);
 }
+
+/////////////////////////////////////////////////
+TEST_F(JointStatePublisherTest, RateLimitedPublisher)
+{
+  // Start server
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/diff_drive_rate_limited_joint_pub.sdf");
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  server.SetUpdatePeriod(0ns);
+
+  int count = 0;
+  std::function<void(const msgs::Model &)> jointStateCb =
+    [&](const msgs::Model &_msg)
+    {
+      EXPECT_EQ(3, _msg.joint_size());
+      count++;
+    };
+
+  transport::Node node;
+  node.Subscribe("/world/diff_drive/model/vehicle/joint_state", jointStateCb);
+
+  // 100 ms of simulation at 100 Hz
+  server.Run(true, 100, false);
+
+  // Wait for the last messages
+  for (int sleep = 0; sleep < 30 && count < 10; ++sleep)
+    std::this_thread::sleep_for(10ms);
+
+  EXPECT_EQ(10, count);
+}
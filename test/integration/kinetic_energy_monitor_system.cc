@@ -18,7 +18,11 @@
 #include <gtest/gtest.h>
 
 #include <ignition/msgs/double.pb.h>
+#include <functional>
 #include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <ignition/common/Console.hh>
 #include <ignition/math/Pose3.hh>
@@ -98,3 +102,129 @@ TEST_F(KineticEnergyMonitorTest, ModelFalling)
   mutex.unlock();
   EXPECT_GT(firstMsg.data(), 2);
 }
+
+/////////////////////////////////////////////////
+// The test checks that a system attached to the world monitors several
+// models at once
+TEST_F(KineticEnergyMonitorTest, MultipleModels)
+{
+  const std::string boxModel = R"(
+    <model name="{name}">
+      <pose>{x} 0 {z} 0 0 0</pose>
+      <link name="link">
+        <inertial>
+          <mass>1.0</mass>
+          <inertia>
+            <ixx>0.001667</ixx>
+            <iyy>0.001667</iyy>
+            <izz>0.001667</izz>
+          </inertia>
+        </inertial>
+        <collision name="collision">
+          <geometry>
+            <box>
+              <size>0.1 0.1 0.1</size>
+            </box>
+          </geometry>
+        </collision>
+      </link>
+    </model>)";
+
+  auto model = [&boxModel](const std::string &_name, const std::string &_x,
+      const std::string &_z)
+  {
+    auto result = boxModel;
+    for (const auto &[key, value] : {std::make_pair("{name}", _name),
+        std::make_pair("{x}", _x), std::make_pair("{z}", _z)})
+    {
+      result.replace(result.find(key), std::string(key).size(), value);
+    }
+    return result;
+  };
+
+  const std::string sdf = R"(<?xml version="1.0" ?>
+<sdf version="1.6">
+  <world name="kinetic_energy">
+    <physics name="1ms" type="ode">
+      <max_step_size>0.001</max_step_size>
+      <real_time_factor>1.0</real_time_factor>
+    </physics>
+    <plugin
+      filename="ignition-gazebo-physics-system"
+      name="ignition::gazebo::systems::Physics">
+    </plugin>
+    <plugin
+      filename="ignition-gazebo-kinetic-energy-monitor-system"
+      name="ignition::gazebo::systems::KineticEnergyMonitor">
+      <model>box_high</model>
+      <model>box_low</model>
+      <link_name>link</link_name>
+      <kinetic_energy_threshold>5</kinetic_energy_threshold>
+    </plugin>
+    <model name="ground_plane">
+      <static>true</static>
+      <link name="link">
+        <collision name="collision">
+          <geometry>
+            <plane>
+              <normal>0 0 1</normal>
+              <size>100 100</size>
+            </plane>
+          </geometry>
+        </collision>
+      </link>
+    </model>)" + model("box_high", "0", "3") + model("box_low", "2", "2") +
+    R"(
+  </world>
+</sdf>)";
+
+  ServerConfig serverConfig;
+  serverConfig.SetSdfString(sdf);
+
+  Server server(serverConfig);
+
+  std::mutex highMutex;
+  std::vector<msgs::Double> highMsgs;
+  std::function<void(const msgs::Double &)> highCb =
+      [&](const msgs::Double &_msg)
+      {
+        std::lock_guard<std::mutex> lock(highMutex);
+        highMsgs.push_back(_msg);
+      };
+
+  std::mutex lowMutex;
+  std::vector<msgs::Double> lowMsgs;
+  std::function<void(const msgs::Double &)> lowCb =
+      [&](const msgs::Double &_msg)
+      {
+        std::lock_guard<std::mutex> lock(lowMutex);
+        lowMsgs.push_back(_msg);
+      };
+
+  transport::Node node;
+  node.Subscribe("/model/box_high/kinetic_energy", highCb);
+  node.Subscribe("/model/box_low/kinetic_energy", lowCb);
+
+  server.Run(true, 1000u, false);
+
+  for (int sleep = 0; sleep < 30; ++sleep)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::lock_guard<std::mutex> highLock(highMutex);
+    std::lock_guard<std::mutex> lowLock(lowMutex);
+    if (!highMsgs.empty() && !lowMsgs.empty())
+      break;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(highMutex);
+    ASSERT_FALSE(highMsgs.empty());
+    EXPECT_GT(highMsgs.front().data(), 5);
+  }
+  {
+    std::lock_guard<std::mutex> lock(lowMutex);
+    ASSERT_FALSE(lowMsgs.empty());
+    EXPECT_GT(lowMsgs.front().data(), 5);
+  }
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <ignition/msgs/altimeter.pb.h>
+#include <ignition/msgs/fluid_pressure.pb.h>
+#include <ignition/msgs/imu.pb.h>
+#include <ignition/msgs/magnetometer.pb.h>
+
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Util.hh>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/test_config.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Test LightweightSensors system
+class LightweightSensorsTest : public ::testing::Test
+{
+  // Documentation inherited
+  protected: void SetUp() override
+  {
+    ignition::common::Console::SetVerbosity(4);
+    ignition::common::setenv("IGN_GAZEBO_SYSTEM_PLUGIN_PATH",
+           (std::string(PROJECT_BINARY_PATH) + "/lib").c_str());
+  }
+};
+
+/////////////////////////////////////////////////
+// The test checks that all sensor types are updated by a single system
+TEST_F(LightweightSensorsTest, AllSensors)
+{
+  // Start server
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/lightweight_sensors.sdf");
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  std::mutex mutex;
+  std::vector<msgs::IMU> imuMsgs;
+  std::vector<msgs::Altimeter> altimeterMsgs;
+  std::vector<msgs::Magnetometer> magnetometerMsgs;
+  std::vector<msgs::FluidPressure> airPressureMsgs;
+
+  transport::Node node;
+  std::function<void(const msgs::IMU &)> imuCb =
+      [&](const msgs::IMU &_msg)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        imuMsgs.push_back(_msg);
+      };
+  std::function<void(const msgs::Altimeter &)> altimeterCb =
+      [&](const msgs::Altimeter &_msg)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        altimeterMsgs.push_back(_msg);
+      };
+  std::function<void(const msgs::Magnetometer &)> magnetometerCb =
+      [&](const msgs::Magnetometer &_msg)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        magnetometerMsgs.push_back(_msg);
+      };
+  std::function<void(const msgs::FluidPressure &)> airPressureCb =
+      [&](const msgs::FluidPressure &_msg)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        airPressureMsgs.push_back(_msg);
+      };
+  EXPECT_TRUE(node.Subscribe("/imu", imuCb));
+  EXPECT_TRUE(node.Subscribe("/altimeter", altimeterCb));
+  EXPECT_TRUE(node.Subscribe("/magnetometer", magnetometerCb));
+  EXPECT_TRUE(node.Subscribe("/air_pressure", airPressureCb));
+
+  // 100 ms of simulation with sensors at 100 Hz
+  server.Run(true, 100, false);
+
+  for (int sleep = 0; sleep < 30; ++sleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (imuMsgs.size() >= 10 && altimeterMsgs.size() >= 10 &&
+          magnetometerMsgs.size() >= 10 && airPressureMsgs.size() >= 10)
+      {
+        break;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(10u, imuMsgs.size());
+  EXPECT_EQ(10u, altimeterMsgs.size());
+  EXPECT_EQ(10u, magnetometerMsgs.size());
+  EXPECT_EQ(10u, airPressureMsgs.size());
+
+  // The model is static, so the noiseless sensors read their references
+  ASSERT_FALSE(magnetometerMsgs.empty());
+  EXPECT_NEAR(0.94, magnetometerMsgs.back().field_tesla().x(), 1e-4);
+  EXPECT_NEAR(0.76, magnetometerMsgs.back().field_tesla().y(), 1e-4);
+  EXPECT_NEAR(-0.12, magnetometerMsgs.back().field_tesla().z(), 1e-4);
+
+  // The altimeter is noisy, and updated separately
+  ASSERT_FALSE(altimeterMsgs.empty());
+  EXPECT_NEAR(0.0, altimeterMsgs.back().vertical_position(), 0.1);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/LocalStateChannel.hh"
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/test_config.hh"  // NOLINT(build/include)
+
+using namespace ignition;
+using namespace gazebo;
+
+class LocalStateChannelTest : public ::testing::Test
+{
+  protected: void SetUp() override
+  {
+    common::Console::SetVerbosity(4);
+  }
+};
+
+/////////////////////////////////////////////////
+TEST_F(LocalStateChannelTest, MirrorsServer)
+{
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  Server server(serverConfig);
+
+  // Nothing is published until a consumer attaches
+  auto channel = LocalStateChannel::Find("default");
+  ASSERT_NE(nullptr, channel);
+  server.Run(true, 5, false);
+
+  std::vector<std::string> states;
+  bool full{false};
+  UpdateInfo info;
+  EXPECT_FALSE(channel->Take(states, full, info));
+
+  // The first state is full, and the next ones only hold changes
+  ASSERT_TRUE(channel->Attach());
+  server.Run(true, 10, false);
+  ASSERT_TRUE(channel->Take(states, full, info));
+  EXPECT_TRUE(full);
+  EXPECT_EQ(10u, states.size());
+  EXPECT_EQ(15u, info.iterations);
+  EXPECT_LT(states.back().size(), states.front().size());
+
+  EntityComponentManager mirror;
+  for (const auto &state : states)
+    EXPECT_TRUE(mirror.SetBinaryState(state.data(), state.size()));
+  EXPECT_EQ(*server.EntityCount(), mirror.EntityCount());
+
+  Entity box = mirror.EntityByComponents(components::Name("box"),
+      components::Model());
+  EXPECT_NE(kNullEntity, box);
+
+  // Removals reach the mirror
+  EXPECT_TRUE(server.RequestRemoveEntity("box"));
+  server.Run(true, 1, false);
+  ASSERT_TRUE(channel->Take(states, full, info));
+  EXPECT_FALSE(full);
+  for (const auto &state : states)
+    EXPECT_TRUE(mirror.SetBinaryState(state.data(), state.size()));
+  bool removed{false};
+  mirror.EachRemoved<components::Model>(
+      [&](const Entity &_entity, const components::Model *) -> bool
+      {
+        removed = removed || _entity == box;
+        return true;
+      });
+  EXPECT_TRUE(removed);
+
+  channel->Detach();
+}
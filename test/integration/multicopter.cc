@@ -19,6 +19,7 @@
 #include <gtest/gtest.h>
 
 #include <optional>
+#include <string>
 
 #include <ignition/msgs.hh>
 
@@ -69,14 +70,17 @@ class MulticopterTest : public ::testing::Test
     server->SetUpdatePeriod(1ns);
     return server;
   }
+
+  /// \brief Check that commanded motor speed is applied.
+  /// \param[in] _filePath World file, relative to the source directory.
+  protected: void CheckCommandedMotorSpeed(const std::string &_filePath);
 };
 
 /////////////////////////////////////////////////
-// Test that commanded motor speed is applied
-TEST_F(MulticopterTest, CommandedMotorSpeed)
+void MulticopterTest::CheckCommandedMotorSpeed(const std::string &_filePath)
 {
   // Start server
-  auto server = this->StartServer("/test/worlds/quadcopter.sdf");
+  auto server = this->StartServer(_filePath);
 
   test::Relay testSystem;
   transport::Node node;
@@ -138,6 +142,21 @@ TEST_F(MulticopterTest, CommandedMotorSpeed)
   server->Run(true, iterTestStart + nIters, false);
 }
 
+/////////////////////////////////////////////////
+// Test that commanded motor speed is applied
+TEST_F(MulticopterTest, CommandedMotorSpeed)
+{
+  this->CheckCommandedMotorSpeed("/test/worlds/quadcopter.sdf");
+}
+
+/////////////////////////////////////////////////
+// Test that commanded motor speed is applied when all rotors are updated
+// together
+TEST_F(MulticopterTest, CommandedMotorSpeedBatched)
+{
+  this->CheckCommandedMotorSpeed("/test/worlds/quadcopter_batched.sdf");
+}
+
 /////////////////////////////////////////////////
 TEST_F(MulticopterTest, MulticopterVelocityControl)
 {
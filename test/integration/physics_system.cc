@@ -18,6 +18,9 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <ignition/common/Console.hh>
@@ -882,6 +885,77 @@ TEST_F(PhysicsSystemFixture, GetBoundingBox)
 }
 
 
+/////////////////////////////////////////////////
+// Bounding boxes of moving models are kept up to date, while those of
+// models which don't move are only computed once
+TEST_F(PhysicsSystemFixture, BoundingBoxFollowsModel)
+{
+  ignition::gazebo::ServerConfig serverConfig;
+
+  const auto sdfFile = std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/contact.sdf";
+  serverConfig.SetSdfFile(sdfFile);
+
+  gazebo::Server server(serverConfig);
+
+  server.SetUpdatePeriod(1ns);
+
+  // Boxes of each model, one per iteration
+  std::map<std::string, std::vector<ignition::math::AxisAlignedBox>> boxes;
+
+  test::Relay testSystem;
+  testSystem.OnPreUpdate(
+    [&](const gazebo::UpdateInfo &_info,
+    gazebo::EntityComponentManager &_ecm)
+    {
+      if (_info.iterations != 1)
+        return;
+
+      for (const std::string name : {"box1", "contact_model"})
+      {
+        auto entity = _ecm.EntityByComponents(components::Model(),
+            components::Name(name));
+        ASSERT_NE(kNullEntity, entity);
+        _ecm.CreateComponent(entity, components::AxisAlignedBox());
+      }
+    });
+
+  testSystem.OnPostUpdate(
+    [&](const gazebo::UpdateInfo &,
+    const gazebo::EntityComponentManager &_ecm)
+    {
+      _ecm.Each<components::Model, components::Name,
+        components::AxisAlignedBox>(
+        [&](const ignition::gazebo::Entity &, const components::Model *,
+        const components::Name *_name,
+        const components::AxisAlignedBox *_aabb)->bool
+        {
+          boxes[_name->Data()].push_back(_aabb->Data());
+          return true;
+        });
+    });
+
+  server.AddSystem(testSystem.systemPtr);
+  server.Run(true, 3, false);
+
+  ASSERT_EQ(2u, boxes.size());
+
+  const auto &staticBoxes = boxes["box1"];
+  ASSERT_EQ(3u, staticBoxes.size());
+  for (const auto &box : staticBoxes)
+  {
+    EXPECT_EQ(ignition::math::AxisAlignedBox(
+        ignition::math::Vector3d(-1.25, -2, 0),
+        ignition::math::Vector3d(-0.25, 2, 1)), box);
+  }
+
+  // The model falls, so each box is lower than the previous one
+  const auto &fallingBoxes = boxes["contact_model"];
+  ASSERT_EQ(3u, fallingBoxes.size());
+  EXPECT_LT(fallingBoxes[1].Min().Z(), fallingBoxes[0].Min().Z());
+  EXPECT_LT(fallingBoxes[2].Min().Z(), fallingBoxes[1].Min().Z());
+}
+
 /////////////////////////////////////////////////
 // This tests whether nested models can be loaded correctly
 TEST_F(PhysicsSystemFixture, NestedModel)
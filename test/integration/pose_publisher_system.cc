@@ -17,6 +17,7 @@
 
 #include <gtest/gtest.h>
 #include <mutex>
+#include <set>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
@@ -745,3 +746,66 @@ TEST_F(PosePublisherTest, NestedModelLoadPlugin)
 
   EXPECT_TRUE(!poseMsgs.empty());
 }
+
+/////////////////////////////////////////////////
+TEST_F(PosePublisherTest, WorldPlugin)
+{
+  // Start server
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/pose_publisher_world.sdf");
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    poseMsgs.clear();
+    poseVMsgs.clear();
+  }
+
+  // One topic for the requested models, and one topic for each model
+  transport::Node node;
+  node.Subscribe(std::string("/world/pose_publisher_world/pose"), &poseVCb);
+  node.Subscribe(std::string("/model/model_c/pose"), &poseCb);
+
+  // Run server
+  unsigned int iters = 100u;
+  server.Run(true, iters, false);
+
+  // Wait for messages to be received
+  for (int sleep = 0; sleep < 300; ++sleep)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (poseVMsgs.size() == iters && poseMsgs.size() == iters)
+      break;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(iters, poseVMsgs.size());
+  EXPECT_EQ(iters, poseMsgs.size());
+
+  // Only the requested models are aggregated
+  for (const auto &msg : poseVMsgs)
+  {
+    ASSERT_EQ(2, msg.pose_size());
+    std::set<std::string> names;
+    for (const auto &pose : msg.pose())
+    {
+      names.insert(pose.name());
+      EXPECT_EQ(math::Pose3d::Zero, msgs::Convert(pose));
+    }
+    EXPECT_EQ(std::set<std::string>({"model_a::link", "model_b::link"}),
+        names);
+  }
+
+  for (const auto &msg : poseMsgs)
+  {
+    EXPECT_EQ("model_c::link", msg.name());
+    ASSERT_EQ(2, msg.header().data_size());
+    EXPECT_EQ("model_c", msg.header().data(0).value(0));
+  }
+}
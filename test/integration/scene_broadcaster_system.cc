@@ -18,15 +18,25 @@
 #include <gtest/gtest.h>
 #include <google/protobuf/util/message_differencer.h>
 
+#include <algorithm>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
+
+#include <ignition/msgs/bytes.pb.h>
+#include <ignition/msgs/stringmsg_v.pb.h>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/transport/Node.hh>
 
+#include "ignition/gazebo/PoseDeltaStream.hh"
 #include "ignition/gazebo/Server.hh"
 #include "ignition/gazebo/test_config.hh"
 
+#include "../../src/systems/log/StateCompression.hh"
+
 using namespace ignition;
 
 /// \brief Test SceneBroadcaster system
@@ -91,6 +101,54 @@ TEST_P(SceneBroadcasterTest, PoseInfo)
   EXPECT_TRUE(received);
 }
 
+/////////////////////////////////////////////////
+TEST_P(SceneBroadcasterTest, PoseDelta)
+{
+  // Start server
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  EXPECT_EQ(16u, *server.EntityCount());
+
+  // Create pose delta subscriber
+  transport::Node node;
+
+  std::mutex mutex;
+  gazebo::PoseDeltaDecoder decoder;
+  unsigned int decoded{0u};
+  std::function<void(const msgs::Bytes &)> cb = [&](const msgs::Bytes &_msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<gazebo::Entity> changed;
+    if (decoder.Decode(_msg.data(), changed))
+      ++decoded;
+  };
+  EXPECT_TRUE(node.Subscribe("/world/default/dynamic_pose/delta", cb));
+
+  // Run server, the shapes fall so there are deltas after the keyframe
+  server.Run(true, 100, false);
+
+  unsigned int sleep{0u};
+  unsigned int maxSleep{10u};
+  while (sleep++ < maxSleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (decoded > 0u)
+        break;
+    }
+    IGN_SLEEP_MS(100);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_LT(0u, decoded);
+
+  // Models and links
+  EXPECT_EQ(6u, decoder.Poses().size());
+}
+
 /////////////////////////////////////////////////
 TEST_P(SceneBroadcasterTest, SceneInfo)
 {
@@ -137,6 +195,54 @@ TEST_P(SceneBroadcasterTest, SceneInfo)
   EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(res, res2));
 }
 
+/////////////////////////////////////////////////
+TEST_P(SceneBroadcasterTest, OverlapPostUpdate)
+{
+  // The broadcaster only implements PostUpdate, so it reads a copy of the
+  // ECM while the next step runs
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+  serverConfig.SetOverlapPostUpdate(true);
+
+  gazebo::Server server(serverConfig);
+  EXPECT_EQ(16u, *server.EntityCount());
+
+  transport::Node node;
+
+  std::mutex mutex;
+  int poseCount{0};
+  std::function<void(const msgs::Pose_V &)> cb = [&](const msgs::Pose_V &_msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    poseCount = _msg.pose_size();
+  };
+  EXPECT_TRUE(node.Subscribe("/world/default/pose/info", cb));
+
+  server.Run(true, 100, false);
+
+  // The copy follows the world, and the last PostUpdate is done once Run
+  // returns
+  bool result{false};
+  ignition::msgs::Scene res;
+  EXPECT_TRUE(node.Request("/world/default/scene/info", 5000, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_EQ(3, res.model_size());
+
+  for (int sleep = 0; sleep < 10; ++sleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (poseCount > 0)
+        break;
+    }
+    IGN_SLEEP_MS(100);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(10, poseCount);
+}
+
 /////////////////////////////////////////////////
 TEST_P(SceneBroadcasterTest, SceneGraph)
 {
@@ -351,6 +457,83 @@ TEST_P(SceneBroadcasterTest, SpawnedModel)
   EXPECT_EQ(initEntityCount + 3, *server.EntityCount());
 }
 
+/////////////////////////////////////////////////
+/// Test that the scene info stays up to date after it's first requested,
+/// as models are removed and spawned.
+TEST_P(SceneBroadcasterTest, SceneInfoUpdates)
+{
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+                          "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  server.Run(true, 1, false);
+
+  transport::Node node;
+  auto sceneInfo = [&node]()
+  {
+    msgs::Scene rep;
+    bool result{false};
+    EXPECT_TRUE(node.Request("/world/default/scene/info", 5000, rep,
+        result));
+    EXPECT_TRUE(result);
+    return rep;
+  };
+  auto hasModel = [](const msgs::Scene &_scene, const std::string &_name)
+  {
+    return std::any_of(_scene.model().begin(), _scene.model().end(),
+        [&_name](const msgs::Model &_model)
+        {
+          return _model.name() == _name;
+        });
+  };
+
+  auto scene = sceneInfo();
+  const int modelCount = scene.model_size();
+  EXPECT_TRUE(hasModel(scene, "cylinder"));
+
+  // Removed models are gone
+  auto cylinderModelId = server.EntityByName("cylinder");
+  ASSERT_TRUE(cylinderModelId.has_value());
+  server.RequestRemoveEntity(cylinderModelId.value(), true);
+  server.Run(true, 1, false);
+
+  scene = sceneInfo();
+  EXPECT_EQ(modelCount - 1, scene.model_size());
+  EXPECT_FALSE(hasModel(scene, "cylinder"));
+
+  // Spawned models appear, with their links and visuals
+  msgs::EntityFactory req;
+  req.set_sdf(R"(
+<?xml version="1.0" ?>
+<sdf version='1.6'>
+  <model name='spawned_model'>
+    <link name='link'>
+      <visual name='visual'>
+        <geometry><sphere><radius>1.0</radius></sphere></geometry>
+      </visual>
+    </link>
+  </model>
+</sdf>)");
+  msgs::Boolean res;
+  bool result{false};
+  EXPECT_TRUE(node.Request("/world/default/create", req, 5000, res,
+      result));
+  EXPECT_TRUE(result);
+  server.Run(true, 1, false);
+
+  scene = sceneInfo();
+  EXPECT_EQ(modelCount, scene.model_size());
+  ASSERT_TRUE(hasModel(scene, "spawned_model"));
+  for (const auto &model : scene.model())
+  {
+    if (model.name() != "spawned_model")
+      continue;
+    ASSERT_EQ(1, model.link_size());
+    EXPECT_EQ(1, model.link(0).visual_size());
+  }
+}
+
 /////////////////////////////////////////////////
 TEST_P(SceneBroadcasterTest, State)
 {
@@ -462,6 +645,141 @@ TEST_P(SceneBroadcasterTest, State)
   EXPECT_TRUE(received);
 }
 
+/////////////////////////////////////////////////
+TEST_P(SceneBroadcasterTest, StateFilter)
+{
+  // Start server
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  EXPECT_EQ(16u, *server.EntityCount());
+
+  // Run server so the transport is set up
+  server.Run(true, 1, false);
+
+  transport::Node node;
+  bool result{false};
+  unsigned int timeout{5000};
+
+  // Invalid filters
+  msgs::StringMsg_V req;
+  msgs::StringMsg res;
+  req.add_data("banana");
+  EXPECT_TRUE(node.Request("/world/default/state/filter", req, timeout, res,
+      result));
+  EXPECT_FALSE(result);
+
+  req.Clear();
+  req.add_data("component ign_gazebo_components.Pose");
+  EXPECT_TRUE(node.Request("/world/default/state/filter", req, timeout, res,
+      result));
+  EXPECT_FALSE(result);
+
+  // Identical filters share a topic
+  req.Clear();
+  req.add_data("model box");
+  EXPECT_TRUE(node.Request("/world/default/state/filter", req, timeout, res,
+      result));
+  EXPECT_TRUE(result);
+  auto topic = res.data();
+  EXPECT_FALSE(topic.empty());
+
+  EXPECT_TRUE(node.Request("/world/default/state/filter", req, timeout, res,
+      result));
+  EXPECT_TRUE(result);
+  EXPECT_EQ(topic, res.data());
+
+  req.add_data("component ign_gazebo_components.Pose");
+  EXPECT_TRUE(node.Request("/world/default/state/filter", req, timeout, res,
+      result));
+  EXPECT_TRUE(result);
+  EXPECT_NE(topic, res.data());
+
+  // Only the box model, its link, visual and collision are sent
+  std::mutex mutex;
+  bool received{false};
+  std::function<void(const msgs::SerializedStepMap &)> cb =
+      [&](const msgs::SerializedStepMap &_msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_TRUE(_msg.has_stats());
+    for (const auto &entity : _msg.state().entities())
+    {
+      EXPECT_LE(4u, entity.first);
+      EXPECT_GE(7u, entity.first);
+    }
+    received = true;
+  };
+  EXPECT_TRUE(node.Subscribe(topic, cb));
+
+  unsigned int sleep{0u};
+  unsigned int maxSleep{10u};
+  while (sleep++ < maxSleep)
+  {
+    server.Run(true, 1, false);
+    IGN_SLEEP_MS(100);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (received)
+      break;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_TRUE(received);
+}
+
+/////////////////////////////////////////////////
+TEST_P(SceneBroadcasterTest, StateCompressed)
+{
+  // Start server
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  EXPECT_EQ(16u, *server.EntityCount());
+
+  // Run server so the transport is set up
+  server.Run(true, 1, false);
+
+  std::mutex mutex;
+  bool received{false};
+  std::function<void(const msgs::Bytes &)> cb =
+      [&](const msgs::Bytes &_msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string data;
+    ASSERT_TRUE(gazebo::systems::log_system::DecompressData(_msg.data(), data));
+    EXPECT_LT(_msg.data().size(), data.size());
+
+    msgs::SerializedStepMap stateMsg;
+    ASSERT_TRUE(stateMsg.ParseFromString(data));
+    ASSERT_TRUE(stateMsg.has_stats());
+    EXPECT_EQ(1000000, stateMsg.stats().step_size().nsec());
+    received = true;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/world/default/state/compressed", cb));
+
+  unsigned int sleep{0u};
+  unsigned int maxSleep{10u};
+  while (sleep++ < maxSleep)
+  {
+    server.Run(true, 1, false);
+    IGN_SLEEP_MS(100);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (received)
+      break;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_TRUE(received);
+}
+
 /////////////////////////////////////////////////
 TEST_P(SceneBroadcasterTest, StateStatic)
 {
@@ -18,7 +18,11 @@
 #include <gtest/gtest.h>
 
 #include <ignition/msgs/entity_factory.pb.h>
+#include <ignition/msgs/entity_factory_v.pb.h>
 #include <ignition/msgs/light.pb.h>
+#include <ignition/msgs/pose_v.pb.h>
+
+#include <string>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
@@ -695,6 +699,69 @@ TEST_F(UserCommandsTest, Pose)
   EXPECT_NEAR(500.0, poseComp->Data().Pos().Y(), 0.2);
 }
 
+/////////////////////////////////////////////////
+TEST_F(UserCommandsTest, PoseVector)
+{
+  // Start server
+  ServerConfig serverConfig;
+  const auto sdfFile = std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/shapes.sdf";
+  serverConfig.SetSdfFile(sdfFile);
+
+  Server server(serverConfig);
+
+  // Create a system just to get the ECM
+  EntityComponentManager *ecm{nullptr};
+  test::Relay testSystem;
+  testSystem.OnPreUpdate([&](const gazebo::UpdateInfo &,
+                             gazebo::EntityComponentManager &_ecm)
+      {
+        ecm = &_ecm;
+      });
+
+  server.AddSystem(testSystem.systemPtr);
+  server.Run(true, 1, false);
+  ASSERT_NE(nullptr, ecm);
+
+  auto boxEntity = ecm->EntityByComponents(components::Name("box"));
+  EXPECT_NE(kNullEntity, boxEntity);
+  auto sphereEntity = ecm->EntityByComponents(components::Name("sphere"));
+  EXPECT_NE(kNullEntity, sphereEntity);
+
+  // Move both models, the box twice
+  msgs::Pose_V req;
+  auto poseMsg = req.add_pose();
+  poseMsg->set_name("box");
+  poseMsg->mutable_position()->set_y(10.0);
+  poseMsg = req.add_pose();
+  poseMsg->set_name("sphere");
+  poseMsg->mutable_position()->set_y(30.0);
+  poseMsg = req.add_pose();
+  poseMsg->set_name("box");
+  poseMsg->mutable_position()->set_y(20.0);
+
+  msgs::Boolean res;
+  bool result;
+  unsigned int timeout = 5000;
+  std::string service{"/world/default/set_pose_vector"};
+
+  transport::Node node;
+  EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+
+  // Run an iteration and check they were moved, the box to its latest pose
+  server.Run(true, 1, false);
+
+  auto poseComp = ecm->Component<components::Pose>(boxEntity);
+  ASSERT_NE(nullptr, poseComp);
+  EXPECT_NEAR(20.0, poseComp->Data().Pos().Y(), 0.2);
+
+  poseComp = ecm->Component<components::Pose>(sphereEntity);
+  ASSERT_NE(nullptr, poseComp);
+  EXPECT_NEAR(30.0, poseComp->Data().Pos().Y(), 0.2);
+}
+
 /////////////////////////////////////////////////
 TEST_F(UserCommandsTest, Light)
 {
@@ -982,3 +1049,76 @@ TEST_F(UserCommandsTest, Physics)
   EXPECT_DOUBLE_EQ(0.123, physicsComp->Data().MaxStepSize());
   EXPECT_DOUBLE_EQ(4.567, physicsComp->Data().RealTimeFactor());
 }
+
+/////////////////////////////////////////////////
+TEST_F(UserCommandsTest, CreateMultipleTimeBudget)
+{
+  // Start server
+  ServerConfig serverConfig;
+  const auto sdfFile = std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/user_commands_time_budget.sdf";
+  serverConfig.SetSdfFile(sdfFile);
+
+  Server server(serverConfig);
+
+  // Create a system just to get the ECM
+  EntityComponentManager *ecm{nullptr};
+  test::Relay testSystem;
+  testSystem.OnPreUpdate([&](const gazebo::UpdateInfo &,
+                             gazebo::EntityComponentManager &_ecm)
+      {
+        ecm = &_ecm;
+      });
+
+  server.AddSystem(testSystem.systemPtr);
+  server.Run(true, 1, false);
+  ASSERT_NE(nullptr, ecm);
+
+  // Request several models at once
+  msgs::EntityFactory_V req;
+  for (int i = 0; i < 3; ++i)
+  {
+    auto modelStr = std::string("<?xml version=\"1.0\" ?>") +
+        "<sdf version='1.6'>" +
+        "<model name='model_" + std::to_string(i) + "'>" +
+        "<link name='link'/>" +
+        "</model>" +
+        "</sdf>";
+    req.add_data()->set_sdf(modelStr);
+  }
+
+  msgs::Boolean res;
+  bool result;
+  unsigned int timeout = 5000;
+  std::string service{"/world/time_budget/create_multiple"};
+
+  transport::Node node;
+  EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+
+  auto modelCount = [&]()
+  {
+    std::size_t count{0};
+    ecm->Each<components::Model>(
+        [&](const Entity &, const components::Model *) -> bool
+        {
+          ++count;
+          return true;
+        });
+    return count;
+  };
+
+  // The budget only allows one command per step, in order
+  for (std::size_t i = 1; i <= 3; ++i)
+  {
+    server.Run(true, 1, false);
+    EXPECT_EQ(i, modelCount());
+    EXPECT_NE(kNullEntity, ecm->EntityByComponents(components::Model(),
+        components::Name("model_" + std::to_string(i - 1))));
+  }
+
+  // Nothing left
+  server.Run(true, 1, false);
+  EXPECT_EQ(3u, modelCount());
+}
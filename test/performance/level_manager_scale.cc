@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Util.hh>
+
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/test_config.hh"  // NOLINT(build/include)
+
+#include "../helpers/Relay.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/// \brief Number of iterations to time.
+static const uint64_t kIterations = 2000;
+
+/// \brief Side of a level, in meters.
+static const double kLevelSize = 20.0;
+
+/// \brief Buffer zone of each level, in meters.
+static const double kLevelBuffer = 5.0;
+
+/// \brief Distance covered by a performer in one iteration, in meters.
+static const double kPerformerSpeed = 0.1;
+
+//////////////////////////////////////////////////
+/// \brief A static model with a single box link.
+std::string staticBox(const std::string &_name, double _x, double _y)
+{
+  std::ostringstream model;
+  model << "<model name='" << _name << "'><static>true</static>"
+        << "<pose>" << _x << " " << _y << " 0.5 0 0 0</pose>"
+        << "<link name='link'><collision name='collision'><geometry>"
+        << "<box><size>1 1 1</size></box></geometry></collision>"
+        << "<visual name='visual'><geometry>"
+        << "<box><size>1 1 1</size></box></geometry></visual></link>"
+        << "</model>";
+  return model.str();
+}
+
+//////////////////////////////////////////////////
+/// \brief Number of levels along each side of a square city.
+std::size_t citySide(std::size_t _levelCount)
+{
+  return static_cast<std::size_t>(
+      std::ceil(std::sqrt(static_cast<double>(_levelCount))));
+}
+
+//////////////////////////////////////////////////
+/// \brief A world shaped like a city: _levelCount levels laid out on a
+/// square grid, each holding _modelsPerLevel static models, and
+/// _performerCount performers.
+std::string cityWorld(std::size_t _levelCount, std::size_t _performerCount,
+    std::size_t _modelsPerLevel)
+{
+  const std::size_t side = citySide(_levelCount);
+
+  std::ostringstream models;
+  std::ostringstream levels;
+  for (std::size_t i = 0; i < _levelCount; ++i)
+  {
+    const double x = kLevelSize * static_cast<double>(i % side);
+    const double y = kLevelSize * static_cast<double>(i / side);
+
+    levels << "<level name='level_" << i << "'>"
+           << "<pose>" << x << " " << y << " 5 0 0 0</pose>"
+           << "<geometry><box><size>" << kLevelSize << " " << kLevelSize
+           << " 10</size></box></geometry>"
+           << "<buffer>" << kLevelBuffer << "</buffer>";
+
+    for (std::size_t m = 0; m < _modelsPerLevel; ++m)
+    {
+      const std::string name =
+          "building_" + std::to_string(i) + "_" + std::to_string(m);
+      const double offset = kLevelSize * 0.8 *
+          (static_cast<double>(m + 1) / (_modelsPerLevel + 1) - 0.5);
+      models << staticBox(name, x + offset, y - offset);
+      levels << "<ref>" << name << "</ref>";
+    }
+    levels << "</level>";
+  }
+
+  std::ostringstream performers;
+  for (std::size_t i = 0; i < _performerCount; ++i)
+  {
+    const std::string name = "vehicle_" + std::to_string(i);
+    models << "<model name='" << name << "'>"
+           << "<pose>0 0 0.5 0 0 0</pose>"
+           << "<link name='link'/></model>";
+    performers << "<performer name='perf_" << name << "'>"
+               << "<ref>" << name << "</ref>"
+               << "<geometry><box><size>2 2 2</size></box></geometry>"
+               << "</performer>";
+  }
+
+  std::ostringstream sdf;
+  sdf << "<?xml version='1.0'?><sdf version='1.6'>"
+      << "<world name='city'>"
+      << "<physics name='1ms' type='ignored'>"
+      << "<max_step_size>0.001</max_step_size>"
+      << "<real_time_factor>0</real_time_factor></physics>"
+      << models.str()
+      << "<plugin name='ignition::gazebo' filename='dummy'>"
+      << performers.str() << levels.str()
+      << "</plugin></world></sdf>";
+  return sdf.str();
+}
+
+//////////////////////////////////////////////////
+/// \brief Scripted path of a performer: it drives back and forth along a
+/// street of the city, with each performer on a different street and phase.
+/// \param[in] _index Performer index.
+/// \param[in] _performerCount Number of performers.
+/// \param[in] _side Number of levels along each side of the city.
+/// \param[in] _iteration Current iteration.
+math::Pose3d performerPose(std::size_t _index, std::size_t _performerCount,
+    std::size_t _side, uint64_t _iteration)
+{
+  const double extent =
+      kLevelSize * static_cast<double>(std::max<std::size_t>(_side, 2) - 1);
+  const double street = kLevelSize * static_cast<double>(
+      (_index * _side / std::max<std::size_t>(_performerCount, 1)) % _side);
+
+  // Triangle wave between 0 and extent
+  double travel = kPerformerSpeed * static_cast<double>(_iteration) +
+      extent * static_cast<double>(_index) / _performerCount;
+  travel = std::fmod(travel, 2.0 * extent);
+  const double along = travel < extent ? travel : 2.0 * extent - travel;
+
+  // Odd performers drive north-south, even ones east-west
+  if (_index % 2)
+    return math::Pose3d(street, along, 0.5, 0, 0, 0);
+  return math::Pose3d(along, street, 0.5, 0, 0, 0);
+}
+
+//////////////////////////////////////////////////
+/// \brief Summary of a set of durations.
+struct Summary
+{
+  std::size_t count{0};
+  double mean{0.0};
+  double p99{0.0};
+  double max{0.0};
+};
+
+//////////////////////////////////////////////////
+/// \brief Summarize durations given in microseconds.
+Summary summarize(std::vector<double> _samples)
+{
+  Summary summary;
+  summary.count = _samples.size();
+  if (_samples.empty())
+    return summary;
+
+  std::sort(_samples.begin(), _samples.end());
+  summary.mean = std::accumulate(_samples.begin(), _samples.end(), 0.0) /
+      static_cast<double>(_samples.size());
+  summary.p99 = _samples[static_cast<std::size_t>(
+      0.99 * static_cast<double>(_samples.size() - 1))];
+  summary.max = _samples.back();
+  return summary;
+}
+
+//////////////////////////////////////////////////
+std::ostream &operator<<(std::ostream &_out, const Summary &_summary)
+{
+  _out << _summary.count << " steps, mean " << _summary.mean << " us, p99 "
+       << _summary.p99 << " us, max " << _summary.max << " us";
+  return _out;
+}
+
+/// \brief Parameters are the number of levels, the number of performers and
+/// the number of models in each level.
+class LevelManagerScale : public ::testing::TestWithParam<
+    std::tuple<std::size_t, std::size_t, std::size_t>>
+{
+};
+
+//////////////////////////////////////////////////
+TEST_P(LevelManagerScale, MovingPerformers)
+{
+  using Clock = std::chrono::steady_clock;
+
+  common::Console::SetVerbosity(1);
+  common::setenv("IGN_GAZEBO_SYSTEM_PLUGIN_PATH",
+      (std::string(PROJECT_BINARY_PATH) + "/lib").c_str());
+
+  const auto &[levelCount, performerCount, modelsPerLevel] = GetParam();
+  const std::size_t side = citySide(levelCount);
+
+  ServerConfig serverConfig;
+  serverConfig.SetSdfString(
+      cityWorld(levelCount, performerCount, modelsPerLevel));
+  serverConfig.SetUseLevels(true);
+
+  auto start = Clock::now();
+  Server server(serverConfig);
+  const auto loadTime = Clock::now() - start;
+
+  std::vector<Entity> performers;
+  std::size_t lastEntityCount{0};
+  std::size_t peakEntityCount{0};
+  Clock::time_point lastPostUpdate;
+  bool timing{false};
+
+  // Time between the end of one iteration's systems and the start of the
+  // next one's. This covers the removals requested while unloading, and
+  // UpdateLevelsState, which runs before PreUpdate.
+  std::vector<double> idleSteps;
+  std::vector<double> loadSteps;
+  std::vector<double> unloadSteps;
+
+  test::Relay testSystem;
+  testSystem.OnPreUpdate(
+      [&](const UpdateInfo &_info, EntityComponentManager &_ecm)
+      {
+        const auto now = Clock::now();
+        const std::size_t entityCount = _ecm.EntityCount();
+        peakEntityCount = std::max(peakEntityCount, entityCount);
+
+        if (timing)
+        {
+          const double elapsed =
+              std::chrono::duration<double, std::micro>(
+              now - lastPostUpdate).count();
+          if (entityCount > lastEntityCount)
+            loadSteps.push_back(elapsed);
+          else if (entityCount < lastEntityCount)
+            unloadSteps.push_back(elapsed);
+          else
+            idleSteps.push_back(elapsed);
+        }
+        lastEntityCount = entityCount;
+
+        if (performers.empty())
+        {
+          for (std::size_t i = 0; i < performerCount; ++i)
+          {
+            performers.push_back(_ecm.EntityByComponents(components::Model(),
+                components::Name("vehicle_" + std::to_string(i))));
+          }
+        }
+
+        // Move the performers along their paths
+        for (std::size_t i = 0; i < performers.size(); ++i)
+        {
+          auto pose = _ecm.Component<components::Pose>(performers[i]);
+          if (nullptr == pose)
+            continue;
+          pose->Data() = performerPose(i, performerCount, side,
+              _info.iterations);
+          _ecm.SetChanged(performers[i], components::Pose::typeId,
+              ComponentState::PeriodicChange);
+        }
+      });
+  testSystem.OnPostUpdate(
+      [&](const UpdateInfo &, const EntityComponentManager &)
+      {
+        lastPostUpdate = Clock::now();
+        timing = true;
+      });
+  server.AddSystem(testSystem.systemPtr);
+
+  server.SetUpdatePeriod(1ns);
+  start = Clock::now();
+  server.Run(true, kIterations, false);
+  const auto runTime = Clock::now() - start;
+
+  EXPECT_FALSE(idleSteps.empty());
+  EXPECT_FALSE(loadSteps.empty());
+
+  std::vector<double> allSteps(idleSteps);
+  allSteps.insert(allSteps.end(), loadSteps.begin(), loadSteps.end());
+  allSteps.insert(allSteps.end(), unloadSteps.begin(), unloadSteps.end());
+
+  const std::size_t worldEntityCount =
+      levelCount * modelsPerLevel + performerCount;
+
+  std::cout << "\n" << levelCount << " levels, " << performerCount
+            << " performers, " << modelsPerLevel << " models per level, "
+            << kIterations << " iterations\n"
+            << "  Load world:      "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+               loadTime).count() << " ms\n"
+            << "  Run:             "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+               runTime).count() << " ms\n"
+            << "  Level update:    " << summarize(allSteps) << "\n"
+            << "    without loads: " << summarize(idleSteps) << "\n"
+            << "    loading:       " << summarize(loadSteps) << "\n"
+            << "    unloading:     " << summarize(unloadSteps) << "\n"
+            << "  Peak entities:   " << peakEntityCount << " (world has "
+            << worldEntityCount << " top level models)\n";
+}
+
+// The last case matches the scale of large production worlds.
+INSTANTIATE_TEST_SUITE_P(Cities, LevelManagerScale,
+    ::testing::Values(
+      std::make_tuple(100u, 5u, 2u),
+      std::make_tuple(500u, 20u, 2u),
+      std::make_tuple(2000u, 50u, 3u)));
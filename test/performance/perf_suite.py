@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+
+"""Run the canonical performance worlds with PERFORMANCE_sdf_runner and
+write the results as one JSON file, which can be compared against the
+results of another commit."""
+
+import argparse
+import datetime
+import json
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+
+# Canonical worlds: name, SDF file relative to the source directory,
+# iterations, and whether levels are enabled
+WORLDS = [
+    ('shapes', 'test/worlds/shapes.sdf', 5000, False),
+    ('many_cubes', 'examples/worlds/3k_shapes.sdf', 1000, False),
+    ('articulated', 'test/worlds/joint_trajectory_controller.sdf', 5000,
+     False),
+    ('sensors', 'test/worlds/lightweight_sensors.sdf', 5000, False),
+    ('levels', 'test/worlds/level_performance.sdf', 2000, True),
+]
+
+# Metrics compared between runs, lower is better
+METRICS = [
+    ('load_ms', lambda r: r['load_ms']),
+    ('step_mean_ms', lambda r: r['step_ms']['mean']),
+    ('step_p99_ms', lambda r: r['step_ms']['p99']),
+    ('peak_rss_bytes', lambda r: r['peak_rss_bytes']),
+    ('ecm_bytes', lambda r: r['ecm'].get('bytes', 0)),
+]
+
+
+def git_commit(source_dir):
+    try:
+        return subprocess.check_output(
+            ['git', 'rev-parse', 'HEAD'], cwd=source_dir,
+            stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return ''
+
+
+def run_world(runner, source_dir, name, sdf, iterations, levels,
+              repetitions):
+    results = []
+    for _ in range(repetitions):
+        with tempfile.TemporaryDirectory() as tmp:
+            out = os.path.join(tmp, 'result.json')
+            cmd = [runner, os.path.join(source_dir, sdf), str(iterations),
+                   '1000000', '--json', out]
+            if levels:
+                cmd.append('--levels')
+            # The runner also writes data.csv to its working directory
+            subprocess.run(cmd, cwd=tmp, check=True,
+                           stdout=subprocess.DEVNULL,
+                           stderr=subprocess.DEVNULL)
+            with open(out) as f:
+                results.append(json.load(f))
+
+    # Keep the fastest repetition, which is the least disturbed by noise
+    best = min(results, key=lambda r: r['step_ms']['mean'])
+    best['name'] = name
+    best['repetitions'] = repetitions
+    return best
+
+
+def compare(baseline, current, threshold):
+    base_worlds = {w['name']: w for w in baseline['worlds']}
+    regressions = []
+    print(f"{'world':<14}{'metric':<16}{'baseline':>14}{'current':>14}"
+          f"{'change':>10}")
+    for world in current['worlds']:
+        base = base_worlds.get(world['name'])
+        if base is None:
+            continue
+        for metric, get in METRICS:
+            old = get(base)
+            new = get(world)
+            change = 100.0 * (new - old) / old if old else 0.0
+            flag = ''
+            if change > threshold:
+                flag = ' !'
+                regressions.append((world['name'], metric, change))
+            print(f"{world['name']:<14}{metric:<16}{old:>14.3f}{new:>14.3f}"
+                  f"{change:>9.1f}%{flag}")
+    return regressions
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--runner', default='./PERFORMANCE_sdf_runner',
+                        help='path to PERFORMANCE_sdf_runner')
+    parser.add_argument('--source', default=os.path.join(
+                        os.path.dirname(os.path.abspath(__file__)), '..',
+                        '..'), help='source directory')
+    parser.add_argument('--output', default='perf_suite.json',
+                        help='file to write the results to')
+    parser.add_argument('--worlds', nargs='*',
+                        help='names of the worlds to run, all by default')
+    parser.add_argument('--repetitions', type=int, default=3,
+                        help='runs of each world, the fastest is kept')
+    parser.add_argument('--compare', metavar='BASELINE',
+                        help='results of another commit to compare against')
+    parser.add_argument('--threshold', type=float, default=10.0,
+                        help='percent increase counted as a regression')
+    args = parser.parse_args()
+
+    results = {
+        'commit': git_commit(args.source),
+        'date': datetime.datetime.now().isoformat(),
+        'host': platform.node(),
+        'cpus': os.cpu_count(),
+        'worlds': [],
+    }
+    for name, sdf, iterations, levels in WORLDS:
+        if args.worlds and name not in args.worlds:
+            continue
+        print(f'Running {name}...', flush=True)
+        results['worlds'].append(run_world(
+            os.path.abspath(args.runner), os.path.abspath(args.source), name,
+            sdf, iterations, levels, args.repetitions))
+
+    with open(args.output, 'w') as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+    print(f'Wrote {args.output}')
+
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f)
+        regressions = compare(baseline, results, args.threshold)
+        if regressions:
+            print(f'{len(regressions)} regressions above {args.threshold}%')
+            sys.exit(1)
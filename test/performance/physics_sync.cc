@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Util.hh>
+#include <ignition/msgs/double_v.pb.h>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/test_config.hh"  // NOLINT(build/include)
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/// \brief Number of models in each world.
+static const std::size_t kModelCount = 100;
+
+/// \brief Number of iterations to time.
+static const uint64_t kIterations = 1000;
+
+//////////////////////////////////////////////////
+/// \brief A box link with unit mass and a collision.
+std::string boxLink(const std::string &_name, const std::string &_pose,
+    const std::string &_size)
+{
+  std::ostringstream link;
+  link << "<link name='" << _name << "'>"
+       << "<pose>" << _pose << "</pose>"
+       << "<inertial><mass>1</mass><inertia>"
+       << "<ixx>0.1</ixx><iyy>0.1</iyy><izz>0.1</izz>"
+       << "</inertia></inertial>"
+       << "<collision name='collision'><geometry><box><size>" << _size
+       << "</size></box></geometry></collision>"
+       << "</link>";
+  return link.str();
+}
+
+//////////////////////////////////////////////////
+/// \brief Revolute joint between two links.
+std::string revoluteJoint(const std::string &_name,
+    const std::string &_parent, const std::string &_child,
+    const std::string &_axis)
+{
+  return "<joint name='" + _name + "' type='revolute'>"
+      "<parent>" + _parent + "</parent><child>" + _child + "</child>"
+      "<axis><xyz>" + _axis + "</xyz></axis></joint>";
+}
+
+//////////////////////////////////////////////////
+/// \brief A world with the Physics system publishing its timing, a ground
+/// plane and _count copies of a model.
+/// \param[in] _engine Physics engine plugin.
+/// \param[in] _scenario One of "boxes", "arms" or "robots".
+/// \param[in] _count Number of models.
+std::string parametricWorld(const std::string &_engine,
+    const std::string &_scenario, std::size_t _count)
+{
+  std::ostringstream sdf;
+  sdf << "<?xml version='1.0'?><sdf version='1.6'>"
+      << "<world name='physics_sync'>"
+      << "<physics name='1ms' type='ignored'>"
+      << "<max_step_size>0.001</max_step_size>"
+      << "<real_time_factor>0</real_time_factor></physics>"
+      << "<plugin filename='ignition-gazebo-physics-system' "
+      << "name='ignition::gazebo::systems::Physics'>"
+      << "<engine><filename>" << _engine << "</filename></engine>"
+      << "<publish_timing>true</publish_timing></plugin>"
+      << "<model name='ground'><static>true</static>"
+      << boxLink("link", "0 0 -0.5 0 0 0", "1000 1000 1") << "</model>";
+
+  const std::size_t side = static_cast<std::size_t>(
+      std::ceil(std::sqrt(static_cast<double>(_count))));
+  for (std::size_t i = 0; i < _count; ++i)
+  {
+    const double x = 2.0 * static_cast<double>(i % side);
+    const double y = 2.0 * static_cast<double>(i / side);
+    sdf << "<model name='model_" << i << "'>"
+        << "<pose>" << x << " " << y << " 0 0 0 0</pose>";
+
+    if (_scenario == "boxes")
+    {
+      sdf << boxLink("box", "0 0 0.5 0 0 0", "0.5 0.5 0.5");
+    }
+    else if (_scenario == "arms")
+    {
+      sdf << boxLink("base", "0 0 0.05 0 0 0", "0.3 0.3 0.1")
+          << boxLink("upper", "0 0 0.35 0 0 0", "0.1 0.1 0.5")
+          << boxLink("lower", "0 0 0.85 0 0 0", "0.1 0.1 0.5")
+          << "<joint name='fix' type='fixed'>"
+          << "<parent>world</parent><child>base</child></joint>"
+          << revoluteJoint("shoulder", "base", "upper", "0 1 0")
+          << revoluteJoint("elbow", "upper", "lower", "0 1 0");
+    }
+    else
+    {
+      sdf << boxLink("chassis", "0 0 0.2 0 0 0", "0.6 0.4 0.1")
+          << boxLink("left_wheel", "0 0.25 0.1 -1.5707 0 0", "0.2 0.2 0.05")
+          << boxLink("right_wheel", "0 -0.25 0.1 -1.5707 0 0",
+                     "0.2 0.2 0.05")
+          << revoluteJoint("left_wheel_joint", "chassis", "left_wheel",
+                           "0 0 1")
+          << revoluteJoint("right_wheel_joint", "chassis", "right_wheel",
+                           "0 0 1")
+          << "<plugin filename='ignition-gazebo-diff-drive-system' "
+          << "name='ignition::gazebo::systems::DiffDrive'>"
+          << "<left_joint>left_wheel_joint</left_joint>"
+          << "<right_joint>right_wheel_joint</right_joint>"
+          << "<wheel_separation>0.5</wheel_separation>"
+          << "<wheel_radius>0.1</wheel_radius>"
+          << "</plugin>";
+    }
+    sdf << "</model>";
+  }
+  sdf << "</world></sdf>";
+  return sdf.str();
+}
+
+/// \brief Parameters are the engine plugin and the scenario.
+class PhysicsSyncPerformance :
+  public ::testing::TestWithParam<std::tuple<std::string, std::string>>
+{
+};
+
+//////////////////////////////////////////////////
+TEST_P(PhysicsSyncPerformance, Phases)
+{
+  common::Console::SetVerbosity(3);
+  common::setenv("IGN_GAZEBO_SYSTEM_PLUGIN_PATH",
+      (std::string(PROJECT_BINARY_PATH) + "/lib").c_str());
+
+  const auto &[engine, scenario] = GetParam();
+
+  std::mutex mutex;
+  msgs::Double_V timing;
+  std::function<void(const msgs::Double_V &)> onTiming =
+      [&](const msgs::Double_V &_msg)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        timing = _msg;
+      };
+  transport::Node node;
+  node.Subscribe("/world/physics_sync/physics/timing", onTiming);
+
+  ServerConfig serverConfig;
+  serverConfig.SetSdfString(parametricWorld(engine, scenario, kModelCount));
+
+  Server server(serverConfig);
+  server.SetUpdatePeriod(1ns);
+  server.Run(true, kIterations, false);
+
+  // Timing is published asynchronously, wait for the last message
+  for (int sleep = 0; sleep < 100; ++sleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (timing.data_size() == 5 &&
+          static_cast<uint64_t>(timing.data(0)) >= kIterations)
+      {
+        break;
+      }
+    }
+    std::this_thread::sleep_for(10ms);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(5, timing.data_size());
+  const double iterations = timing.data(0);
+  ASSERT_GT(iterations, 0.0);
+
+  auto perIteration = [&](int _index)
+  {
+    return 1e6 * timing.data(_index) / iterations;
+  };
+
+  std::cout << "\n" << engine << ", " << kModelCount << " " << scenario
+            << ", " << iterations << " iterations, us per iteration:\n"
+            << "  UpdatePhysics:    " << perIteration(1) << "\n"
+            << "  Step:             " << perIteration(2) << "\n"
+            << "  UpdateSim:        " << perIteration(3) << "\n"
+            << "  UpdateCollisions: " << perIteration(4) << "\n";
+}
+
+INSTANTIATE_TEST_SUITE_P(Engines, PhysicsSyncPerformance,
+    ::testing::Combine(
+      ::testing::Values("ignition-physics-dartsim-plugin",
+                        "ignition-physics-tpe-plugin"),
+      ::testing::Values("boxes", "arms", "robots")));
@@ -15,11 +15,18 @@
  *
  */
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
 
 #include <ignition/msgs.hh>
 #include <ignition/math/Stopwatch.hh>
 #include <ignition/common/Console.hh>
+#include <sdf/Root.hh>
+#include <sdf/World.hh>
 
 #include "ignition/transport/Node.hh"
 
@@ -30,29 +37,99 @@
 using namespace ignition;
 using namespace gazebo;
 
+//////////////////////////////////////////////////
+/// \brief Peak resident memory of this process.
+/// \return Bytes, or 0 where it can't be read.
+uint64_t peakRss()
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (line.rfind("VmHWM:", 0) == 0)
+      return std::stoull(line.substr(6)) * 1024u;
+  }
+  return 0u;
+}
+
+//////////////////////////////////////////////////
+/// \brief Write a message's params as JSON objects.
+/// \param[in] _out Stream to write to.
+/// \param[in] _msg Params holding doubles, integers and strings.
+/// \param[in] _first Index of the first param to write.
+/// \param[in] _last Index after the last param to write.
+void writeParams(std::ostream &_out, const msgs::Param_V &_msg, int _first,
+    int _last)
+{
+  for (int i = _first; i < std::min(_last, _msg.param_size()); ++i)
+  {
+    if (i > _first)
+      _out << ",";
+    _out << "{";
+
+    // Sort keys so files can be compared line by line
+    std::vector<std::string> keys;
+    for (const auto &param : _msg.param(i).params())
+      keys.push_back(param.first);
+    std::sort(keys.begin(), keys.end());
+
+    bool firstKey{true};
+    for (const auto &key : keys)
+    {
+      const auto &any = _msg.param(i).params().at(key);
+      if (!firstKey)
+        _out << ",";
+      firstKey = false;
+      _out << "\"" << key << "\":";
+      if (any.type() == msgs::Any::DOUBLE)
+        _out << any.double_value();
+      else if (any.type() == msgs::Any::INT32)
+        _out << any.int_value();
+      else
+        _out << "\"" << any.string_value() << "\"";
+    }
+    _out << "}";
+  }
+}
+
 //////////////////////////////////////////////////
 int main(int _argc, char** _argv)
 {
   ignition::common::Console::SetVerbosity(4);
 
+  // Options start with "--", the other arguments are positional
+  std::string jsonFile;
+  bool useLevels{false};
+  std::vector<std::string> args;
+  for (int i = 1; i < _argc; ++i)
+  {
+    const std::string arg{_argv[i]};
+    if (arg == "--json" && i + 1 < _argc)
+      jsonFile = _argv[++i];
+    else if (arg == "--levels")
+      useLevels = true;
+    else
+      args.push_back(arg);
+  }
+
   std::string sdfFile{""};
-  if (_argc >= 2)
+  if (args.size() >= 1)
   {
-    sdfFile = _argv[1];
+    sdfFile = args[0];
   }
   igndbg << "SDF file: " << sdfFile << std::endl;
 
   unsigned int iterations{10000};
-  if (_argc >= 3)
+  if (args.size() >= 2)
   {
-    iterations = atoi(_argv[2]);
+    iterations = static_cast<unsigned int>(std::stoul(args[1]));
   }
   igndbg << "Iterations: " << iterations << std::endl;
 
   double updateRate{-1};
-  if (_argc >= 4)
+  if (args.size() >= 3)
   {
-    updateRate = atoi(_argv[3]);
+    updateRate = std::stod(args[2]);
   }
   igndbg << "Update rate: " << updateRate << std::endl;
 
@@ -67,8 +144,19 @@ int main(int _argc, char** _argv)
   if (updateRate > 0.0)
     serverConfig.SetUpdateRate(updateRate);
 
+  serverConfig.SetUseLevels(useLevels);
+
+  // The world name is needed for its services
+  sdf::Root root;
+  root.Load(sdfFile);
+  std::string worldName{"default"};
+  if (root.WorldCount() > 0)
+    worldName = root.WorldByIndex(0)->Name();
+
   // Create the Gazebo server
+  auto loadStart = std::chrono::steady_clock::now();
   ignition::gazebo::Server server(serverConfig);
+  auto loadTime = std::chrono::steady_clock::now() - loadStart;
 
   ignition::transport::Node node;
 
@@ -99,7 +187,9 @@ int main(int _argc, char** _argv)
   node.Subscribe("/stats", cb2);
 
   // Run the server
+  auto runStart = std::chrono::steady_clock::now();
   server.Run(true, iterations, false);
+  auto runTime = std::chrono::steady_clock::now() - runStart;
 
   std::ofstream ofs("data.csv", std::ofstream::out);
 
@@ -114,5 +204,67 @@ int main(int _argc, char** _argv)
         << msg.sim().sec() << ", " << msg.sim().nsec() << std::endl;
   }
 
+  if (jsonFile.empty())
+    return 0;
+
+  // Step durations, from the real time between clock messages
+  auto toSec = [](const msgs::Time &_time)
+  {
+    return static_cast<double>(_time.sec()) + 1e-9 * _time.nsec();
+  };
+  std::vector<double> stepMs;
+  for (std::size_t i = 1; i < msgs.size(); ++i)
+    stepMs.push_back(1e3 * (toSec(msgs[i].real()) - toSec(msgs[i-1].real())));
+  std::sort(stepMs.begin(), stepMs.end());
+
+  auto percentile = [&](double _percent)
+  {
+    if (stepMs.empty())
+      return 0.0;
+    auto index = static_cast<std::size_t>(
+        _percent / 100.0 * static_cast<double>(stepMs.size() - 1));
+    return stepMs[index];
+  };
+  double meanMs{0.0};
+  for (auto ms : stepMs)
+    meanMs += ms;
+  if (!stepMs.empty())
+    meanMs /= static_cast<double>(stepMs.size());
+
+  const double runSec = std::chrono::duration<double>(runTime).count();
+  const double simSec = msgs.empty() ? 0.0 : toSec(msgs.back().sim());
+
+  // Timing of each system and memory of the ECM, from the world's services
+  const std::string prefix{"/world/" + worldName + "/"};
+  msgs::Param_V systemStats;
+  msgs::Param_V ecmMemory;
+  bool result{false};
+  node.Request(prefix + "system_stats", 5000, systemStats, result);
+  node.Request(prefix + "ecm/memory", 5000, ecmMemory, result);
+
+  std::ofstream json(jsonFile);
+  json << "{\"sdf\":\"" << sdfFile << "\",\"world\":\"" << worldName
+       << "\",\"iterations\":" << iterations
+       << ",\"update_rate\":" << updateRate
+       << ",\"levels\":" << (useLevels ? "true" : "false")
+       << ",\"load_ms\":"
+       << std::chrono::duration<double, std::milli>(loadTime).count()
+       << ",\"run_s\":" << runSec
+       << ",\"rtf\":" << (runSec > 0.0 ? simSec / runSec : 0.0)
+       << ",\"step_ms\":{\"mean\":" << meanMs
+       << ",\"p50\":" << percentile(50)
+       << ",\"p90\":" << percentile(90)
+       << ",\"p99\":" << percentile(99)
+       << ",\"max\":" << (stepMs.empty() ? 0.0 : stepMs.back()) << "}"
+       << ",\"peak_rss_bytes\":" << peakRss()
+       << ",\"ecm\":";
+  if (ecmMemory.param_size() > 0)
+    writeParams(json, ecmMemory, 0, 1);
+  else
+    json << "{}";
+  json << ",\"systems\":[";
+  writeParams(json, systemStats, 0, systemStats.param_size());
+  json << "]}" << std::endl;
+
   return 0;
 }
@@ -0,0 +1,7 @@
+#include "MockAsyncSystem.hh"
+
+#include <ignition/plugin/Register.hh>
+
+IGNITION_ADD_PLUGIN(ignition::gazebo::MockAsyncSystem,
+    ignition::gazebo::System,
+    ignition::gazebo::MockAsyncSystem::ISystemAsyncUpdate)
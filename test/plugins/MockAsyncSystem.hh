@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_TEST_MOCKASYNCSYSTEM_HH_
+#define IGNITION_GAZEBO_TEST_MOCKASYNCSYSTEM_HH_
+
+#include <functional>
+
+#include "ignition/gazebo/System.hh"
+
+namespace ignition {
+  namespace gazebo {
+    class IGNITION_GAZEBO_VISIBLE MockAsyncSystem :
+      public gazebo::System,
+      public gazebo::ISystemAsyncUpdate
+    {
+      public: using CallbackType = std::function<Commands(
+              const gazebo::UpdateInfo &,
+              const gazebo::EntityComponentManager &)>;
+
+      public: uint64_t iterations{1};
+
+      public: CallbackType asyncUpdateCallback;
+
+      public: uint64_t AsyncUpdateIterations() const override final
+              {
+                return this->iterations;
+              }
+
+      public: Commands AsyncUpdate(const gazebo::UpdateInfo &_info,
+                  const gazebo::EntityComponentManager &_manager)
+                  override final
+              {
+                if (this->asyncUpdateCallback)
+                  return this->asyncUpdateCallback(_info, _manager);
+                return nullptr;
+              }
+    };
+  }
+}
+
+#endif